@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <folly/Bits.h>
+#include <folly/hash/Hash.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+
+/**
+ * A concurrent set of integers, optimized for keys that mostly fall in a
+ * known dense range.
+ *
+ * Keys in [denseBegin, denseBegin + denseSize) are stored in an atomic
+ * bitmap, as in ConcurrentBitSet, at one bit per possible key: insert(),
+ * erase() and contains() on them are a single atomic operation. Other keys
+ * go to a fixed-capacity, lock-free, linear-probing overflow table.
+ *
+ * Unlike AtomicHashArray, no key value needs to be reserved by the user: the
+ * overflow table marks its empty slots with denseBegin, which can never be
+ * stored there. denseSize must therefore be at least 1.
+ *
+ * A slot of the overflow table is claimed for good by the first insertion
+ * of its key, and then only flips between present and erased, so erasing
+ * and inserting the same key again reuses its slot. Slots are not reclaimed
+ * for other keys, since that could let two concurrent insertions of the
+ * same key both succeed: every distinct key ever inserted there counts once
+ * against overflowCapacity, and insert() throws std::length_error once it
+ * is exhausted.
+ */
+template <typename T>
+class AtomicIntegerSet {
+  static_assert(std::is_integral<T>::value, "");
+  using U = std::make_unsigned_t<T>;
+  using Block = uint64_t;
+  static constexpr size_t kBitsPerBlock = std::numeric_limits<Block>::digits;
+
+ public:
+  using value_type = T;
+
+  AtomicIntegerSet(T denseBegin, size_t denseSize, size_t overflowCapacity)
+      : denseBegin_(denseBegin),
+        denseSize_(denseSize),
+        emptyKey_(denseBegin),
+        blocks_(new std::atomic<Block>[numBlocks(denseSize)]()),
+        overflowMask_(tableSize(overflowCapacity) - 1),
+        overflowCapacity_(overflowCapacity),
+        slots_(new Slot[overflowMask_ + 1]) {
+    if (denseSize < 1 ||
+        U(U(std::numeric_limits<T>::max()) - U(denseBegin)) < denseSize - 1) {
+      throw_exception<std::invalid_argument>(
+          "AtomicIntegerSet: dense range must hold 1 or more valid keys");
+    }
+    for (size_t i = 0; i <= overflowMask_; ++i) {
+      slots_[i].key.store(emptyKey_, std::memory_order_relaxed);
+    }
+  }
+
+  AtomicIntegerSet(const AtomicIntegerSet&) = delete;
+  AtomicIntegerSet& operator=(const AtomicIntegerSet&) = delete;
+
+  /**
+   * Returns true if key was not present and has been inserted. Throws
+   * std::length_error if key belongs to the overflow table and that is full.
+   */
+  bool insert(T key) {
+    size_t idx;
+    if (denseIndex(key, idx)) {
+      Block mask = Block(1) << (idx % kBitsPerBlock);
+      return !(
+          blocks_[idx / kBitsPerBlock].fetch_or(
+              mask, std::memory_order_acq_rel) &
+          mask);
+    }
+    return overflowInsert(key);
+  }
+
+  /**
+   * Returns true if key was present and has been erased.
+   */
+  bool erase(T key) {
+    size_t idx;
+    if (denseIndex(key, idx)) {
+      Block mask = Block(1) << (idx % kBitsPerBlock);
+      return blocks_[idx / kBitsPerBlock].fetch_and(
+                 ~mask, std::memory_order_acq_rel) &
+          mask;
+    }
+    auto slot = overflowFind(key);
+    return slot && slot->present.exchange(false, std::memory_order_acq_rel);
+  }
+
+  bool contains(T key) const {
+    size_t idx;
+    if (denseIndex(key, idx)) {
+      Block mask = Block(1) << (idx % kBitsPerBlock);
+      return blocks_[idx / kBitsPerBlock].load(std::memory_order_acquire) &
+          mask;
+    }
+    auto slot = overflowFind(key);
+    return slot && slot->present.load(std::memory_order_acquire);
+  }
+
+  T denseBegin() const { return denseBegin_; }
+
+  size_t denseSize() const { return denseSize_; }
+
+  size_t overflowCapacity() const { return overflowCapacity_; }
+
+ private:
+  struct Slot {
+    std::atomic<T> key;
+    std::atomic<bool> present{false};
+  };
+
+  static size_t numBlocks(size_t denseSize) {
+    return (denseSize + kBitsPerBlock - 1) / kBitsPerBlock;
+  }
+
+  // Keep the load factor of the overflow table at or below 3/4. Probing is
+  // bounded by the table size, so even a full table terminates.
+  static size_t tableSize(size_t capacity) {
+    return nextPowTwo(std::max<size_t>(1, capacity + capacity / 3 + 1));
+  }
+
+  bool denseIndex(T key, size_t& idx) const {
+    idx = size_t(U(U(key) - U(denseBegin_)));
+    return U(U(key) - U(denseBegin_)) < denseSize_;
+  }
+
+  size_t overflowHome(T key) const {
+    return size_t(hash::twang_mix64(uint64_t(U(key)))) & overflowMask_;
+  }
+
+  bool overflowInsert(T key) {
+    auto index = overflowHome(key);
+    for (size_t probes = 0; probes <= overflowMask_; ++probes) {
+      auto& slot = slots_[index];
+      T cur = slot.key.load(std::memory_order_acquire);
+      if (cur == emptyKey_) {
+        if (used_.fetch_add(1, std::memory_order_relaxed) >=
+            overflowCapacity_) {
+          used_.fetch_sub(1, std::memory_order_relaxed);
+          break;
+        }
+        if (!slot.key.compare_exchange_strong(
+                cur, key, std::memory_order_acq_rel)) {
+          used_.fetch_sub(1, std::memory_order_relaxed);
+        } else {
+          cur = key;
+        }
+        // Otherwise lost the slot, maybe to the same key.
+      }
+      if (cur == key) {
+        // Of concurrent insertions of key, only one sets it present.
+        return !slot.present.exchange(true, std::memory_order_acq_rel);
+      }
+      index = (index + 1) & overflowMask_;
+    }
+    throw_exception<std::length_error>(
+        "AtomicIntegerSet: overflow table is full");
+  }
+
+  // Returns the slot claimed by key, present or not, or nullptr.
+  Slot* overflowFind(T key) const {
+    auto index = overflowHome(key);
+    for (size_t probes = 0; probes <= overflowMask_; ++probes) {
+      auto& slot = slots_[index];
+      T cur = slot.key.load(std::memory_order_acquire);
+      if (cur == key) {
+        return &slot;
+      }
+      if (cur == emptyKey_) {
+        break;
+      }
+      index = (index + 1) & overflowMask_;
+    }
+    return nullptr;
+  }
+
+  const T denseBegin_;
+  const size_t denseSize_;
+  const T emptyKey_;
+  std::unique_ptr<std::atomic<Block>[]> blocks_;
+  const size_t overflowMask_;
+  const size_t overflowCapacity_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<size_t> used_{0};
+};
+
+} // namespace folly
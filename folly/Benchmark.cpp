@@ -24,12 +24,15 @@
 #include <map>
 #include <memory>
 #include <numeric>
+#include <random>
+#include <set>
 #include <utility>
 #include <vector>
 
 #include <folly/FileUtil.h>
 #include <folly/MapUtil.h>
 #include <folly/String.h>
+#include <folly/detail/PerfEventCounters.h>
 #include <folly/detail/PerfScoped.h>
 #include <folly/json/json.h>
 
@@ -57,6 +60,13 @@ FOLLY_GFLAGS_DEFINE_string(
     "initialization. The first iteration of the benchmark is also "
     "skipped to allow for all statics to be set up. This requires perf "
     " to be available on the system. Example: --bm_perf_args=\"record -g\"");
+
+FOLLY_GFLAGS_DEFINE_bool(
+    bm_perf_counters,
+    false,
+    "Report hardware performance counters per iteration (cycles, "
+    "instructions, L1d and LLC load misses, branch misses), read with "
+    "perf_event_open in an extra run of each benchmark.");
 #endif
 
 FOLLY_GFLAGS_DEFINE_bool(
@@ -84,6 +94,12 @@ FOLLY_GFLAGS_DEFINE_string(
 FOLLY_GFLAGS_DEFINE_string(
     bm_regex, "", "Only benchmarks whose names match this regex will be run.");
 
+FOLLY_GFLAGS_DEFINE_bool(
+    bm_mt_sweep,
+    false,
+    "Run each BENCHMARK_MT on 1, 2, 4, ... threads up to its number of "
+    "threads, relative to 1 thread.");
+
 FOLLY_GFLAGS_DEFINE_int64(
     bm_min_usec,
     100,
@@ -116,8 +132,45 @@ BenchmarkingState<std::chrono::high_resolution_clock>& globalBenchmarkState() {
   return state;
 }
 
+double hardwareTimestampTicksPerNs() {
+  static const double ticksPerNs = [] {
+    using std::chrono::steady_clock;
+    auto const start = steady_clock::now();
+    auto const startTicks = hardware_timestamp();
+    auto now = start;
+    while (now - start < std::chrono::milliseconds(10)) {
+      now = steady_clock::now();
+    }
+    auto const ticks = hardware_timestamp() - startTicks;
+    auto const ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - start);
+    return std::max(double(ticks) / double(ns.count()), 1e-9);
+  }();
+  return ticksPerNs;
+}
+
 } // namespace detail
 
+BenchmarkLatencyRecorder::BenchmarkLatencyRecorder(UserCounters& counters)
+    : counters_(counters) {
+  BenchmarkSuspender suspender;
+  histogram_ = std::make_unique<LogLinearHistogram<>>();
+  ticksPerNs_ = detail::hardwareTimestampTicksPerNs();
+}
+
+BenchmarkLatencyRecorder::~BenchmarkLatencyRecorder() {
+  BenchmarkSuspender suspender;
+  // The estimates interpolate within buckets, which may overshoot the max.
+  auto const quantileNs = [&](double q) {
+    auto const ticks = std::min(histogram_->estimateQuantile(q), maxTicks_);
+    return static_cast<int64_t>(std::llround(double(ticks) / ticksPerNs_));
+  };
+  counters_["p50_ns"] = quantileNs(0.5);
+  counters_["p99_ns"] = quantileNs(0.99);
+  counters_["p999_ns"] = quantileNs(0.999);
+  counters_["max_ns"] = quantileNs(1);
+}
+
 using BenchmarkFun = std::function<detail::TimeIterData(unsigned int)>;
 
 #define FB_FOLLY_GLOBAL_BENCHMARK_BASELINE fbFollyGlobalBenchmarkBaseline
@@ -316,6 +369,52 @@ static std::pair<double, UserCounters> runProfilingGetNSPerIteration(
   return std::make_pair(nsecIter, std::move(timeIterData.userCounters));
 }
 
+static bool perfCountersEnabled() {
+#if FOLLY_PERF_IS_SUPPORTED
+  return FLAGS_bm_perf_counters;
+#else
+  return false;
+#endif
+}
+
+// Runs the benchmark once more, for about --bm_min_usec, with the hardware
+// counters of this thread enabled, and returns them per iteration. Unlike the
+// time, they include what runs under a BenchmarkSuspender.
+static std::unordered_map<std::string, double> runBenchmarkGetPerfCounters(
+    const BenchmarkFun& fun, const double nsPerIter) {
+  detail::PerfEventCounters counters;
+  if (counters.names().empty()) {
+    return {};
+  }
+
+  const double minNanoseconds =
+      std::max(100000.0, double(FLAGS_bm_min_usec) * 1000);
+  const auto iters = std::min(
+      std::max(minNanoseconds / std::max(nsPerIter, 1.0), 1.0),
+      double(std::max<int64_t>(FLAGS_bm_max_iters, 1)));
+
+  counters.start();
+  detail::TimeIterData timeIterData = fun(static_cast<unsigned int>(iters));
+  auto values = counters.stop();
+
+  std::unordered_map<std::string, double> result;
+  for (size_t i = 0; i < values.size(); ++i) {
+    result[counters.names()[i]] =
+        values[i] / std::max(timeIterData.niter, 1u);
+  }
+  return result;
+}
+
+static void subtractPerfCounters(
+    std::unordered_map<std::string, double>& perfCounters,
+    const std::unordered_map<std::string, double>& baseline) {
+  for (auto& [name, value] : perfCounters) {
+    if (auto ptr = folly::get_ptr(baseline, name)) {
+      value = std::max(0.0, value - *ptr);
+    }
+  }
+}
+
 struct ScaleInfo {
   double boundary;
   const char* suffix;
@@ -381,6 +480,12 @@ static string metricReadable(double n, unsigned int decimals) {
   return humanReadable(n, decimals, kMetricSuffixes);
 }
 
+// Hardware counters per iteration are often small fractions, which the milli
+// and smaller suffixes would only obscure.
+static string countReadable(double n) {
+  return fabs(n) < 1E3 ? stringPrintf("%.2f", n) : metricReadable(n, 2);
+}
+
 namespace {
 
 constexpr std::string_view kUnitHeaders = "relative  time/iter   iters/s";
@@ -419,13 +524,13 @@ void printSeparator(char pad, unsigned int columns) {
 class BenchmarkResultsPrinter {
  public:
   BenchmarkResultsPrinter() : columns_(FLAGS_bm_result_width_chars) {}
-  explicit BenchmarkResultsPrinter(std::set<std::string> counterNames)
+  explicit BenchmarkResultsPrinter(
+      std::set<std::string> counterNames,
+      std::vector<std::string> perfCounterNames = {})
       : counterNames_(std::move(counterNames)),
-        namesLength_{std::accumulate(
-            counterNames_.begin(),
-            counterNames_.end(),
-            size_t{0},
-            [](size_t acc, auto&& name) { return acc + 2 + name.length(); })},
+        perfCounterNames_(std::move(perfCounterNames)),
+        namesLength_{
+            namesLength(counterNames_) + namesLength(perfCounterNames_)},
         columns_(FLAGS_bm_result_width_chars + namesLength_) {}
 
   void separator(char pad) { printSeparator(pad, columns_); }
@@ -436,6 +541,9 @@ class BenchmarkResultsPrinter {
     for (auto const& name : counterNames_) {
       printf("  %s", name.c_str());
     }
+    for (auto const& name : perfCounterNames_) {
+      printf("  %s", name.c_str());
+    }
     printf("\n");
     separator('=');
   }
@@ -512,28 +620,68 @@ class BenchmarkResultsPrinter {
           printf("  %*s", int(name.length()), "NaN");
         }
       }
+      for (auto const& name : perfCounterNames_) {
+        auto ptr = folly::get_ptr(datum.perfCounters, name);
+        printf(
+            "  %*s",
+            int(name.length()),
+            ptr ? countReadable(*ptr).c_str() : "NaN");
+      }
       printf("\n");
     }
   }
 
  private:
+  template <typename Names>
+  static size_t namesLength(const Names& names) {
+    return std::accumulate(
+        names.begin(), names.end(), size_t{0}, [](size_t acc, auto&& name) {
+          return acc + 2 + name.length();
+        });
+  }
+
   bool isBaselineSet() {
     return baselineNsPerIter_ != numeric_limits<double>::max();
   }
 
   std::set<std::string> counterNames_;
+  std::vector<std::string> perfCounterNames_;
   size_t namesLength_{0};
   size_t columns_{0};
   double baselineNsPerIter_{numeric_limits<double>::max()};
   string lastFile_;
 };
+
+// The hardware counters reported for any of the results, in the order of
+// PerfEventCounters::allNames().
+std::vector<std::string> perfCounterNames(
+    const vector<detail::BenchmarkResult>& data) {
+  std::vector<std::string> names;
+  for (auto const& name : detail::PerfEventCounters::allNames()) {
+    if (std::any_of(data.begin(), data.end(), [&](auto const& datum) {
+          return datum.perfCounters.count(name) != 0;
+        })) {
+      names.push_back(name);
+    }
+  }
+  return names;
+}
+
 } // namespace
 
 static void printBenchmarkResultsAsJson(
     const vector<detail::BenchmarkResult>& data) {
   dynamic d = dynamic::object;
   for (auto& datum : data) {
-    d[datum.name] = datum.timeInNs * 1000.;
+    if (datum.perfCounters.empty()) {
+      d[datum.name] = datum.timeInNs * 1000.;
+      continue;
+    }
+    dynamic obj = dynamic::object("time", datum.timeInNs * 1000.);
+    for (auto& counter : datum.perfCounters) {
+      obj[counter.first] = counter.second;
+    }
+    d[datum.name] = std::move(obj);
   }
 
   printf("%s\n", toPrettyJson(d).c_str());
@@ -543,7 +691,9 @@ void benchmarkResultsToDynamic(
     const vector<detail::BenchmarkResult>& data, dynamic& out) {
   out = dynamic::array;
   for (auto& datum : data) {
-    if (!datum.counters.empty()) {
+    dynamic result = dynamic::array(datum.file, datum.name, datum.timeInNs);
+    // The hardware counters follow the user counters, which may be empty.
+    if (!datum.counters.empty() || !datum.perfCounters.empty()) {
       dynamic obj = dynamic::object;
       for (auto& counter : datum.counters) {
         dynamic counterInfo = dynamic::object;
@@ -551,11 +701,16 @@ void benchmarkResultsToDynamic(
         counterInfo["type"] = static_cast<int>(counter.second.type);
         obj[counter.first] = counterInfo;
       }
-      out.push_back(
-          dynamic::array(datum.file, datum.name, datum.timeInNs, obj));
-    } else {
-      out.push_back(dynamic::array(datum.file, datum.name, datum.timeInNs));
+      result.push_back(std::move(obj));
+    }
+    if (!datum.perfCounters.empty()) {
+      dynamic obj = dynamic::object;
+      for (auto& counter : datum.perfCounters) {
+        obj[counter.first] = counter.second;
+      }
+      result.push_back(std::move(obj));
     }
+    out.push_back(std::move(result));
   }
 }
 
@@ -567,6 +722,12 @@ void benchmarkResultsFromDynamic(
          datum[1].asString(),
          datum[2].asDouble(),
          UserCounters{}});
+    if (datum.size() > 4) {
+      for (auto& counter : datum[4].items()) {
+        results.back().perfCounters[counter.first.asString()] =
+            counter.second.asDouble();
+      }
+    }
   }
 }
 
@@ -578,27 +739,38 @@ static pair<StringPiece, StringPiece> resultKey(
 void printResultComparison(
     const vector<detail::BenchmarkResult>& base,
     const vector<detail::BenchmarkResult>& test) {
-  map<pair<StringPiece, StringPiece>, double> baselines;
+  map<pair<StringPiece, StringPiece>, const detail::BenchmarkResult*> baselines;
 
   for (auto& baseResult : base) {
-    baselines[resultKey(baseResult)] = baseResult.timeInNs;
+    baselines[resultKey(baseResult)] = &baseResult;
   }
 
-  // Width available
+  // Width available for the time; each hardware counter gets a column wide
+  // enough for its value and the change from the baseline.
   const size_t columns = FLAGS_bm_result_width_chars;
+  const auto perfNames = perfCounterNames(test);
+  std::vector<int> perfWidths;
+  size_t totalColumns = columns;
+  for (auto const& name : perfNames) {
+    perfWidths.push_back(static_cast<int>(std::max<size_t>(name.size(), 16)));
+    totalColumns += 2 + perfWidths.back();
+  }
 
   auto header = [&](const string_view& file) {
-    printSeparator('=', columns);
+    printSeparator('=', totalColumns);
     printDefaultHeaderContents(file, columns);
+    for (size_t i = 0; i < perfNames.size(); ++i) {
+      printf("  %*s", perfWidths[i], perfNames[i].c_str());
+    }
     printf("\n");
-    printSeparator('=', columns);
+    printSeparator('=', totalColumns);
   };
 
   string lastFile;
 
   for (auto& datum : test) {
-    folly::Optional<double> baseline =
-        folly::get_optional(baselines, resultKey(datum));
+    const detail::BenchmarkResult* baseline =
+        folly::get_default(baselines, resultKey(datum), nullptr);
     auto file = datum.file;
     if (file != lastFile) {
       // New file starting
@@ -608,7 +780,7 @@ void printResultComparison(
 
     string s = datum.name;
     if (s == "-") {
-      printSeparator('-', columns);
+      printSeparator('-', totalColumns);
       continue;
     }
     if (s[0] == '%') {
@@ -623,24 +795,268 @@ void printResultComparison(
     if (!baseline) {
       // Print without baseline
       printf(
-          "%*s           %9s  %7s\n",
+          "%*s           %9s  %7s",
           static_cast<int>(s.size()),
           s.c_str(),
           readableTime(secPerIter, 2).c_str(),
           metricReadable(itersPerSec, 2).c_str());
     } else {
       // Print with baseline
-      auto rel = *baseline / nsPerIter * 100.0;
+      auto rel = baseline->timeInNs / nsPerIter * 100.0;
       printf(
-          "%*s %7.2f%%  %9s  %7s\n",
+          "%*s %7.2f%%  %9s  %7s",
           static_cast<int>(s.size()),
           s.c_str(),
           rel,
           readableTime(secPerIter, 2).c_str(),
           metricReadable(itersPerSec, 2).c_str());
     }
+    for (size_t i = 0; i < perfNames.size(); ++i) {
+      auto ptr = folly::get_ptr(datum.perfCounters, perfNames[i]);
+      auto basePtr =
+          baseline ? folly::get_ptr(baseline->perfCounters, perfNames[i])
+                   : nullptr;
+      string cell = ptr ? countReadable(*ptr) : "NaN";
+      if (ptr && basePtr && *basePtr != 0) {
+        cell += stringPrintf(" (%+.1f%%)", (*ptr / *basePtr - 1) * 100.0);
+      }
+      printf("  %*s", perfWidths[i], cell.c_str());
+    }
+    printf("\n");
+  }
+  printSeparator('=', totalColumns);
+}
+
+namespace detail {
+
+double mannWhitneyPValue(
+    const std::vector<double>& a, const std::vector<double>& b) {
+  const size_t m = a.size();
+  const size_t n = b.size();
+  if (m == 0 || n == 0) {
+    return 1;
+  }
+
+  // U counts the pairs in which a is larger, and half of the ties.
+  double u = 0;
+  for (double x : a) {
+    for (double y : b) {
+      u += x > y ? 1 : x == y ? 0.5 : 0;
+    }
+  }
+
+  std::vector<double> all(a);
+  all.insert(all.end(), b.begin(), b.end());
+  std::sort(all.begin(), all.end());
+  double ties = 0;
+  for (size_t i = 0; i < all.size();) {
+    size_t j = i;
+    while (j < all.size() && all[j] == all[i]) {
+      ++j;
+    }
+    double t = double(j - i);
+    ties += t * t * t - t;
+    i = j;
+  }
+
+  if (ties == 0 && m <= 20 && n <= 20) {
+    // counts[j][k]: the number of orderings of i values of a and j of b in
+    // which k pairs have a larger, built up one value of a at a time.
+    const size_t maxU = m * n;
+    std::vector<std::vector<double>> counts(
+        n + 1, std::vector<double>(maxU + 1, 0));
+    for (size_t j = 0; j <= n; ++j) {
+      counts[j][0] = 1;
+    }
+    for (size_t i = 1; i <= m; ++i) {
+      std::vector<std::vector<double>> next(
+          n + 1, std::vector<double>(maxU + 1, 0));
+      next[0][0] = 1;
+      for (size_t j = 1; j <= n; ++j) {
+        for (size_t k = 0; k <= maxU; ++k) {
+          // The largest value is either of a, larger than all j of b, or of b.
+          next[j][k] = next[j - 1][k] + (k >= j ? counts[j][k - j] : 0);
+        }
+      }
+      counts = std::move(next);
+    }
+    double total = 0;
+    double below = 0;
+    double above = 0;
+    for (size_t k = 0; k <= maxU; ++k) {
+      total += counts[n][k];
+      below += double(k) <= u ? counts[n][k] : 0;
+      above += double(k) >= u ? counts[n][k] : 0;
+    }
+    return std::min(1.0, 2 * std::min(below, above) / total);
+  }
+
+  const double size = double(m + n);
+  const double mean = double(m) * double(n) / 2;
+  const double variance = double(m) * double(n) / 12 *
+      ((size + 1) - ties / (size * (size - 1)));
+  if (variance <= 0) {
+    return 1;
+  }
+  const double z =
+      std::max(0.0, std::fabs(u - mean) - 0.5) / std::sqrt(variance);
+  return std::erfc(z / std::sqrt(2.0));
+}
+
+} // namespace detail
+
+namespace {
+
+double median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  const size_t mid = values.size() / 2;
+  return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+}
+
+double relativeMedianAbsoluteDeviation(const std::vector<double>& values) {
+  const double med = median(values);
+  if (med == 0) {
+    return 0;
+  }
+  std::vector<double> deviations;
+  deviations.reserve(values.size());
+  for (double v : values) {
+    deviations.push_back(std::fabs(v - med));
+  }
+  return median(std::move(deviations)) / med;
+}
+
+} // namespace
+
+std::vector<BenchmarkComparison> compareBenchmarkRuns(
+    const std::vector<std::vector<detail::BenchmarkResult>>& base,
+    const std::vector<std::vector<detail::BenchmarkResult>>& test,
+    double threshold,
+    double confidence) {
+  using Key = pair<std::string, std::string>;
+  auto collect = [](const std::vector<std::vector<detail::BenchmarkResult>>&
+                        runs) {
+    map<Key, std::vector<double>> times;
+    for (auto const& run : runs) {
+      for (auto const& result : run) {
+        if (result.name != "-") {
+          times[{result.file, result.name}].push_back(result.timeInNs);
+        }
+      }
+    }
+    return times;
+  };
+  const auto baseTimes = collect(base);
+  const auto testTimes = collect(test);
+
+  // Results in the order of the first test run they are in.
+  std::vector<Key> keys;
+  std::set<Key> seen;
+  for (auto const& run : test) {
+    for (auto const& result : run) {
+      Key key{result.file, result.name};
+      if (baseTimes.count(key) && testTimes.count(key) &&
+          seen.insert(key).second) {
+        keys.push_back(std::move(key));
+      }
+    }
+  }
+
+  // A fixed seed, so that the same dumps give the same intervals.
+  std::mt19937 rng(0);
+  constexpr size_t kResamples = 1000;
+  const double alpha = 1 - confidence;
+
+  std::vector<BenchmarkComparison> comparisons;
+  for (auto const& key : keys) {
+    auto const& b = baseTimes.at(key);
+    auto const& t = testTimes.at(key);
+    BenchmarkComparison c;
+    c.file = key.first;
+    c.name = key.second;
+    c.baseNs = median(b);
+    c.testNs = median(t);
+    c.change = c.baseNs > 0 ? c.testNs / c.baseNs - 1 : 0;
+
+    std::vector<double> changes;
+    changes.reserve(kResamples);
+    std::vector<double> bs(b.size());
+    std::vector<double> ts(t.size());
+    std::uniform_int_distribution<size_t> pickBase(0, b.size() - 1);
+    std::uniform_int_distribution<size_t> pickTest(0, t.size() - 1);
+    for (size_t i = 0; i < kResamples; ++i) {
+      for (auto& v : bs) {
+        v = b[pickBase(rng)];
+      }
+      for (auto& v : ts) {
+        v = t[pickTest(rng)];
+      }
+      const double baseNs = median(bs);
+      changes.push_back(baseNs > 0 ? median(ts) / baseNs - 1 : 0);
+    }
+    std::sort(changes.begin(), changes.end());
+    auto percentile = [&](double q) {
+      return changes[std::min(
+          changes.size() - 1, static_cast<size_t>(q * changes.size()))];
+    };
+    c.changeLow = percentile(alpha / 2);
+    c.changeHigh = percentile(1 - alpha / 2);
+
+    c.pValue = detail::mannWhitneyPValue(t, b);
+    c.noise = std::max(
+        relativeMedianAbsoluteDeviation(b), relativeMedianAbsoluteDeviation(t));
+    const bool significant = c.pValue < alpha;
+    c.regression = significant && c.change > threshold;
+    c.improvement = significant && c.change < -threshold;
+    comparisons.push_back(std::move(c));
+  }
+  return comparisons;
+}
+
+void printBenchmarkComparisons(
+    const std::vector<BenchmarkComparison>& comparisons, double confidence) {
+  constexpr std::string_view kStatsHeaders =
+      "     base      test   change        interval  p-value  noise";
+  const size_t columns = FLAGS_bm_result_width_chars + 16;
+  const size_t nameChars = columns - kStatsHeaders.size();
+
+  string lastFile;
+  for (auto const& c : comparisons) {
+    if (c.file != lastFile) {
+      printSeparator('=', columns);
+      std::string file = c.file;
+      if (file.size() > nameChars) {
+        file = "[...]" + file.substr(file.size() - nameChars + 5);
+      }
+      printf(
+          "%-*s%.*s\n",
+          static_cast<int>(nameChars),
+          file.c_str(),
+          static_cast<int>(kStatsHeaders.size()),
+          kStatsHeaders.data());
+      printSeparator('=', columns);
+      lastFile = c.file;
+    }
+    string s = c.name[0] == '%' ? c.name.substr(1) : c.name;
+    s.resize(nameChars, ' ');
+    printf(
+        "%s %8s  %8s  %+6.1f%%  [%+5.1f,%+5.1f]%%  %7.4f  %4.1f%%%s\n",
+        s.c_str(),
+        readableTime(c.baseNs / 1E9, 2).c_str(),
+        readableTime(c.testNs / 1E9, 2).c_str(),
+        c.change * 100,
+        c.changeLow * 100,
+        c.changeHigh * 100,
+        c.pValue,
+        c.noise * 100,
+        c.regression        ? "  REGRESSION"
+            : c.improvement ? "  improvement"
+                            : "");
   }
   printSeparator('=', columns);
+  printf(
+      "interval: %g%% bootstrap confidence interval of the change\n",
+      confidence * 100);
 }
 
 void checkRunMode() {
@@ -657,19 +1073,33 @@ struct BenchmarksToRun {
   const detail::BenchmarkRegistration* baseline = nullptr;
   std::vector<const detail::BenchmarkRegistration*> benchmarks;
   std::vector<size_t> separatorsAfter;
+  // The BENCHMARK_MT benchmarks on the numbers of threads they run on.
+  std::vector<std::unique_ptr<detail::BenchmarkRegistration>> onThreads;
 };
 
 void addSeparator(BenchmarksToRun& res) {
-  size_t separatorAfter = res.benchmarks.size();
-  if (separatorAfter == 0) {
+  if (res.benchmarks.empty()) {
     return;
   }
+  size_t separatorAfter = res.benchmarks.size() - 1;
   if (res.separatorsAfter.empty() ||
       res.separatorsAfter.back() != separatorAfter) {
-    res.separatorsAfter.push_back(res.benchmarks.size() - 1);
+    res.separatorsAfter.push_back(separatorAfter);
   }
 }
 
+void addOnThreads(
+    BenchmarksToRun& res,
+    const detail::BenchmarkRegistration& bm,
+    std::string name,
+    unsigned threads) {
+  name += folly::to<std::string>("(threads=", threads, ")");
+  res.onThreads.push_back(std::make_unique<detail::BenchmarkRegistration>(
+      detail::BenchmarkRegistration{
+          bm.file, std::move(name), bm.withThreads(threads), true}));
+  res.benchmarks.push_back(res.onThreads.back().get());
+}
+
 BenchmarksToRun selectBenchmarksToRun(
     const std::vector<detail::BenchmarkRegistration>& benchmarks) {
   BenchmarksToRun res;
@@ -693,6 +1123,30 @@ BenchmarksToRun selectBenchmarksToRun(
       continue;
     }
 
+    if (bm.withThreads && FLAGS_bm_mt_sweep) {
+      // Each sweep is relative to 1 thread, and set off by lines.
+      std::string name = bm.name[0] == '%' ? bm.name.substr(1) : bm.name;
+      if (bmRegex && !boost::regex_search(name, *bmRegex)) {
+        continue;
+      }
+      addSeparator(res);
+      for (unsigned threads = 1; threads < bm.threads; threads *= 2) {
+        addOnThreads(res, bm, threads == 1 ? name : "%" + name, threads);
+      }
+      addOnThreads(res, bm, bm.threads == 1 ? name : "%" + name, bm.threads);
+      addSeparator(res);
+      continue;
+    }
+
+    if (bm.withThreads) {
+      std::string name =
+          folly::to<std::string>(bm.name, "(threads=", bm.threads, ")");
+      if (!bmRegex || boost::regex_search(name, *bmRegex)) {
+        addOnThreads(res, bm, bm.name, bm.threads);
+      }
+      continue;
+    }
+
     if (!bmRegex || boost::regex_search(bm.name, *bmRegex)) {
       res.benchmarks.push_back(&bm);
     }
@@ -758,6 +1212,9 @@ runBenchmarksWithPrinterImpl(
 
   auto const globalBaseline =
       runBenchmarkGetNSPerIteration(toRun.baseline->func, 0);
+  auto const globalBaselinePerfCounters = perfCountersEnabled()
+      ? runBenchmarkGetPerfCounters(toRun.baseline->func, globalBaseline.first)
+      : std::unordered_map<std::string, double>{};
 
   std::set<std::string> counterNames;
   ShouldDrawLineTracker shouldDrawLineTracker(toRun);
@@ -774,16 +1231,29 @@ runBenchmarksWithPrinterImpl(
           : runBenchmarkGetNSPerIteration(bm.func, globalBaseline.first);
     }
 
+    std::unordered_map<std::string, double> perfCounters;
+    if (perfCountersEnabled()) {
+      perfCounters = runBenchmarkGetPerfCounters(
+          bm.func, elapsed.first + globalBaseline.first);
+      subtractPerfCounters(perfCounters, globalBaselinePerfCounters);
+    }
+
     // if customized user counters is used, it cannot print the result in real
     // time as it needs to run all cases first to know the complete set of
     // counters have been used, then the header can be printed out properly
     if (printer != nullptr) {
-      printer->print({{bm.file, bm.name, elapsed.first, elapsed.second}});
+      printer->print(
+          {{bm.file, bm.name, elapsed.first, elapsed.second, perfCounters}});
       if (shoudDrawLineAfter) {
         printer->separator('-');
       }
     }
-    results.push_back({bm.file, bm.name, elapsed.first, elapsed.second});
+    results.push_back(
+        {bm.file,
+         bm.name,
+         elapsed.first,
+         elapsed.second,
+         std::move(perfCounters)});
 
     // get all counter names
     for (auto const& kv : elapsed.second) {
@@ -829,7 +1299,7 @@ bool operator==(const BenchmarkResult& x, const BenchmarkResult& y) {
   auto xtime = static_cast<std::uint64_t>(x.timeInNs * 1000);
   auto ytime = static_cast<std::uint64_t>(y.timeInNs * 1000);
   return x.name == y.name && x.file == y.file && xtime == ytime &&
-      x.counters == y.counters;
+      x.counters == y.counters && x.perfCounters == y.perfCounters;
 }
 
 std::chrono::high_resolution_clock::duration BenchmarkSuspenderBase::timeSpent;
@@ -840,6 +1310,23 @@ void BenchmarkingStateBase::addBenchmarkImpl(
   benchmarks_.push_back({file, name.str(), std::move(fun), useCounter});
 }
 
+void BenchmarkingStateBase::addMtBenchmarkImpl(
+    const char* file,
+    StringPiece name,
+    unsigned threads,
+    std::function<BenchmarkFun(unsigned)> withThreads) {
+  CHECK_GT(threads, 0u);
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto fun = withThreads(threads);
+  benchmarks_.push_back(
+      {file,
+       name.str(),
+       std::move(fun),
+       true,
+       threads,
+       std::move(withThreads)});
+}
+
 bool BenchmarkingStateBase::useCounters() const {
   std::lock_guard<std::mutex> guard(mutex_);
   return std::any_of(
@@ -908,8 +1395,9 @@ void runBenchmarks() {
 
   // PLEASE KEEP QUIET. MEASUREMENTS IN PROGRESS.
 
-  const bool shouldPrintInline =
-      FLAGS_bm_relative_to.empty() && !FLAGS_json && !useCounter;
+  // The hardware counters that can be read are only known after running.
+  const bool shouldPrintInline = FLAGS_bm_relative_to.empty() && !FLAGS_json &&
+      !useCounter && !perfCountersEnabled();
   auto benchmarkResults =
       state.runBenchmarksWithPrinter(shouldPrintInline ? &printer : nullptr);
 
@@ -921,7 +1409,9 @@ void runBenchmarks() {
     printResultComparison(
         resultsFromFile(FLAGS_bm_relative_to), benchmarkResults.second);
   } else if (!shouldPrintInline) {
-    printer = BenchmarkResultsPrinter{std::move(benchmarkResults.first)};
+    printer = BenchmarkResultsPrinter{
+        std::move(benchmarkResults.first),
+        perfCounterNames(benchmarkResults.second)};
     printer.print(benchmarkResults.second);
     printer.separator('=');
   }
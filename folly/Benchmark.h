@@ -22,19 +22,26 @@
 #include <folly/Range.h>
 #include <folly/ScopeGuard.h>
 #include <folly/Traits.h>
+#include <folly/chrono/Hardware.h>
 #include <folly/functional/Invoke.h>
 #include <folly/lang/Hint.h>
 #include <folly/portability/GFlags.h>
+#include <folly/stats/LogLinearHistogram.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <functional>
 #include <iosfwd>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <set>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/function_types/function_arity.hpp>
 #include <glog/logging.h>
@@ -95,6 +102,10 @@ struct BenchmarkRegistration {
   std::string name;
   BenchmarkFun func;
   bool useCounter = false;
+  // For BENCHMARK_MT: the number of threads to run on, and func for any
+  // number of threads, which --bm_mt_sweep runs it on in turn.
+  unsigned threads = 0;
+  std::function<BenchmarkFun(unsigned)> withThreads;
 };
 
 struct BenchmarkResult {
@@ -102,6 +113,9 @@ struct BenchmarkResult {
   std::string name;
   double timeInNs;
   UserCounters counters;
+  // Hardware counters per iteration, by PerfEventCounters name; only filled
+  // in with --bm_perf_counters.
+  std::unordered_map<std::string, double> perfCounters{};
 
   friend std::ostream& operator<<(std::ostream&, const BenchmarkResult&);
 
@@ -188,6 +202,57 @@ struct BenchmarkSuspender : BenchmarkSuspenderBase {
   TimePoint start;
 };
 
+/**
+ * Runs lambda(times) on each of the given number of threads, which all start
+ * at once after a barrier. The duration is from the start until the last
+ * thread is done, and the number of iterations the total of all threads. The
+ * "fairness" counter is the time of the fastest thread in percent of that
+ * of the slowest.
+ */
+template <typename Clock, typename Lambda>
+TimeIterData runOnThreads(
+    unsigned threads, unsigned int times, const Lambda& lambda) {
+  std::atomic<unsigned> ready{0};
+  std::atomic<bool> go{false};
+  std::vector<unsigned> niters(threads);
+  std::vector<decltype(Clock::now())> ends(threads);
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (unsigned i = 0; i < threads; ++i) {
+    workers.emplace_back([&, i] {
+      ready.fetch_add(1, std::memory_order_acq_rel);
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      niters[i] = lambda(times);
+      ends[i] = Clock::now();
+    });
+  }
+  while (ready.load(std::memory_order_acquire) != threads) {
+    std::this_thread::yield();
+  }
+
+  // CORE MEASUREMENT STARTS
+  auto start = Clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  // CORE MEASUREMENT ENDS
+
+  auto [first, last] = std::minmax_element(ends.begin(), ends.end());
+  auto fastest = std::max(*first - start, decltype(*first - start){1});
+  UserCounters counters;
+  counters["fairness"] = UserMetric(static_cast<int64_t>(
+      100.0 * fastest.count() /
+      std::max(*last - start, fastest).count()));
+  unsigned niter = 0;
+  for (auto n : niters) {
+    niter += n;
+  }
+  return TimeIterData{*last - start, niter, std::move(counters)};
+}
+
 class PerfScoped;
 
 class BenchmarkingStateBase {
@@ -205,6 +270,12 @@ class BenchmarkingStateBase {
   void addBenchmarkImpl(
       const char* file, StringPiece name, BenchmarkFun, bool useCounter);
 
+  void addMtBenchmarkImpl(
+      const char* file,
+      StringPiece name,
+      unsigned threads,
+      std::function<BenchmarkFun(unsigned)> withThreads);
+
  protected:
   // There is no need for this virtual but we overcome a check
   virtual ~BenchmarkingStateBase() = default;
@@ -293,10 +364,37 @@ class BenchmarkingState : public BenchmarkingStateBase {
       return niter;
     });
   }
+
+  template <typename Lambda>
+  void addMtBenchmark(
+      const char* file, StringPiece name, unsigned threads, Lambda&& lambda) {
+    auto body = [lambda](unsigned int times) -> unsigned int {
+      if constexpr (folly::is_invocable_v<Lambda, unsigned>) {
+        return lambda(times);
+      } else {
+        unsigned int niter = 0;
+        while (times-- > 0) {
+          niter += lambda();
+        }
+        return niter;
+      }
+    };
+    this->addMtBenchmarkImpl(file, name, threads, [=](unsigned n) {
+      return BenchmarkFun([=](unsigned int times) {
+        return runOnThreads<Clock>(n, times, body);
+      });
+    });
+  }
 };
 
 BenchmarkingState<std::chrono::high_resolution_clock>& globalBenchmarkState();
 
+/**
+ * The number of hardware_timestamp() ticks per nanosecond, measured once
+ * against std::chrono::steady_clock.
+ */
+double hardwareTimestampTicksPerNs();
+
 /**
  * Runs all benchmarks defined in the program, doesn't print by default.
  * Usually used when customized printing of results is desired.
@@ -324,6 +422,63 @@ struct BenchmarkSuspender
   using Impl::Impl;
 };
 
+/**
+ * Records the latency of each operation of a benchmark, with the hardware
+ * timestamp counter (rdtsc on x86), in a LogLinearHistogram, and reports its
+ * percentiles in nanoseconds as the user counters p50_ns, p99_ns, p999_ns
+ * and max_ns when destroyed. This shows the tail latency that the time per
+ * iteration averages away, e.g. rehashes or deferred reclamation. Example:
+ *
+ * BENCHMARK_COUNTERS(insert, counters, iters) {
+ *   folly::F14FastSet<unsigned> set;
+ *   folly::BenchmarkLatencyRecorder latency(counters);
+ *   for (unsigned int i = 0; i < iters; ++i) {
+ *     latency.measure([&] { set.insert(i); });
+ *   }
+ * }
+ *
+ * Setting up and reporting don't count towards the time of the benchmark,
+ * but reading the counter and recording do, some tens of nanoseconds per
+ * operation. The counters are
+ * those of the run that the reported time comes from. Not thread-safe; use a
+ * recorder per thread.
+ */
+class BenchmarkLatencyRecorder {
+ public:
+  explicit BenchmarkLatencyRecorder(UserCounters& counters);
+  ~BenchmarkLatencyRecorder();
+
+  BenchmarkLatencyRecorder(const BenchmarkLatencyRecorder&) = delete;
+  BenchmarkLatencyRecorder& operator=(const BenchmarkLatencyRecorder&) =
+      delete;
+
+  template <typename F>
+  auto measure(F&& f) -> invoke_result_t<F> {
+    auto const begin = start();
+    SCOPE_EXIT {
+      stop(begin);
+    };
+    return static_cast<F&&>(f)();
+  }
+
+  /* For operations that don't fit in a lambda: stop(start()) */
+  uint64_t start() const noexcept { return hardware_timestamp(); }
+
+  void stop(uint64_t begin) noexcept { record(hardware_timestamp() - begin); }
+
+  /* Records a latency in hardware_timestamp() ticks */
+  void record(uint64_t ticks) noexcept {
+    histogram_->addValue(ticks);
+    maxTicks_ = std::max(maxTicks_, ticks);
+  }
+
+ private:
+  UserCounters& counters_;
+  std::unique_ptr<LogLinearHistogram<>> histogram_;
+  uint64_t maxTicks_{0};
+  double ticksPerNs_{1};
+};
+
 /**
  * Adds a benchmark. Usually not called directly but instead through
  * the macro BENCHMARK defined below.
@@ -340,6 +495,18 @@ void addBenchmark(const char* file, StringPiece name, Lambda&& lambda) {
   detail::globalBenchmarkState().addBenchmark(file, name, lambda);
 }
 
+/**
+ * Adds a benchmark that runs on the given number of threads at once. Usually
+ * not called directly but instead through the macro BENCHMARK_MT defined
+ * below. The lambda takes zero parameters or the number of iterations, like
+ * for addBenchmark(), and each thread runs it with that number.
+ */
+template <typename Lambda>
+void addMtBenchmark(
+    const char* file, StringPiece name, unsigned threads, Lambda&& lambda) {
+  detail::globalBenchmarkState().addMtBenchmark(file, name, threads, lambda);
+}
+
 struct dynamic;
 
 void benchmarkResultsToDynamic(
@@ -352,6 +519,55 @@ void printResultComparison(
     const std::vector<detail::BenchmarkResult>& base,
     const std::vector<detail::BenchmarkResult>& test);
 
+/**
+ * The comparison of a benchmark over several runs of a baseline and of a
+ * test version, e.g. several --bm_json_verbose dumps of each.
+ */
+struct BenchmarkComparison {
+  std::string file;
+  std::string name;
+  // The median time per iteration of the runs of each.
+  double baseNs;
+  double testNs;
+  // testNs / baseNs - 1, with its bootstrap confidence interval.
+  double change;
+  double changeLow;
+  double changeHigh;
+  // Of the two-sided Mann-Whitney U test that the times of the runs of both
+  // come from the same distribution.
+  double pValue;
+  // The larger relative median absolute deviation of the runs of each.
+  double noise;
+  // Slower, or faster, by more than the threshold with significance.
+  bool regression;
+  bool improvement;
+};
+
+/**
+ * Compares the runs of each benchmark that is in both base and test. A
+ * change is significant if pValue < 1 - confidence, which takes a few runs
+ * of each: at least 4 for a confidence of 0.95. threshold is relative, e.g.
+ * 0.03 for 3%.
+ */
+std::vector<BenchmarkComparison> compareBenchmarkRuns(
+    const std::vector<std::vector<detail::BenchmarkResult>>& base,
+    const std::vector<std::vector<detail::BenchmarkResult>>& test,
+    double threshold,
+    double confidence = 0.95);
+
+void printBenchmarkComparisons(
+    const std::vector<BenchmarkComparison>& comparisons,
+    double confidence = 0.95);
+
+namespace detail {
+/**
+ * The p-value of the two-sided Mann-Whitney U test: exact for small samples
+ * without ties, and with the normal approximation otherwise.
+ */
+double mannWhitneyPValue(
+    const std::vector<double>& a, const std::vector<double>& b);
+} // namespace detail
+
 } // namespace folly
 
 /**
@@ -389,6 +605,21 @@ void printResultComparison(
   static void funName([[maybe_unused]] ::folly::UserCounters& counters       \
                           FOLLY_PP_DETAIL_APPEND_VA_ARG(paramType paramName))
 
+#define BENCHMARK_MT_IMPL(                                                   \
+    funName, stringName, threads, rv, paramType, paramName)                  \
+  static void funName(paramType);                                            \
+  [[maybe_unused]] static bool FB_ANONYMOUS_VARIABLE(follyBenchmarkUnused) = \
+      (::folly::addMtBenchmark(                                              \
+           __FILE__,                                                         \
+           stringName,                                                       \
+           threads,                                                          \
+           [](paramType paramName) -> unsigned {                             \
+             funName(paramName);                                             \
+             return rv;                                                      \
+           }),                                                               \
+       true);                                                                \
+  static void funName(paramType paramName)
+
 /**
  * Introduces a benchmark function with support for returning the actual
  * number of iterations. Used internally, see BENCHMARK_MULTI and friends
@@ -431,6 +662,33 @@ void printResultComparison(
       FB_ONE_OR_NONE(unsigned, ##__VA_ARGS__), \
       __VA_ARGS__)
 
+/**
+ * Like BENCHMARK, but the body runs on the given number of threads at once,
+ * for measuring contention. Each thread runs the given number of iterations;
+ * the time and iterations per second are of all threads together, and the
+ * "fairness" column is the time of the fastest thread in percent of that of
+ * the slowest. The threads are started before, and released together after,
+ * the measurement starts. BENCHMARK_SUSPEND can't be used in the body.
+ *
+ * With --bm_mt_sweep, the benchmark also runs on 1, 2, 4, ... threads up to
+ * the given number, each relative to 1 thread, which shows how it scales.
+ * Example:
+ *
+ * BENCHMARK_MT(sharedMutexLockShared, 8, iters) {
+ *   for (unsigned int i = 0; i < iters; ++i) {
+ *     std::shared_lock<folly::SharedMutex> lock(mutex);
+ *   }
+ * }
+ */
+#define BENCHMARK_MT(name, threads, ...)       \
+  BENCHMARK_MT_IMPL(                           \
+      name,                                    \
+      FOLLY_PP_STRINGIZE(name),                \
+      threads,                                 \
+      FB_ARG_2_OR_1(1, ##__VA_ARGS__),         \
+      FB_ONE_OR_NONE(unsigned, ##__VA_ARGS__), \
+      __VA_ARGS__)
+
 /**
  * Allow users to record customized counter during benchmarking,
  * there will be one extra column showing in the output result for each counter
@@ -584,6 +842,20 @@ void printResultComparison(
       FB_ONE_OR_NONE(unsigned, ##__VA_ARGS__), \
       __VA_ARGS__)
 
+/**
+ * Just like BENCHMARK_MT, but prints the time relative to the most recent
+ * BENCHMARK() or BENCHMARK_MT(), e.g. to compare two synchronization
+ * primitives on the same number of threads.
+ */
+#define BENCHMARK_RELATIVE_MT(name, threads, ...) \
+  BENCHMARK_MT_IMPL(                              \
+      name,                                       \
+      "%" FOLLY_PP_STRINGIZE(name),               \
+      threads,                                    \
+      FB_ARG_2_OR_1(1, ##__VA_ARGS__),            \
+      FB_ONE_OR_NONE(unsigned, ##__VA_ARGS__),    \
+      __VA_ARGS__)
+
 #define BENCHMARK_COUNTERS_RELATIVE(name, counters, ...) \
   BENCHMARK_IMPL_COUNTERS(                               \
       name,                                              \
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/BucketedTimeoutQueue.h>
+
+#include <algorithm>
+
+#include <folly/lang/Bits.h>
+
+namespace folly {
+
+BucketedTimeoutQueue::BucketedTimeoutQueue(
+    int64_t granularity, size_t numBuckets)
+    : granularity_(std::max<int64_t>(granularity, 1)),
+      mask_(nextPowTwo(std::max<size_t>(numBuckets, 1)) - 1),
+      buckets_(mask_ + 1) {}
+
+int64_t BucketedTimeoutQueue::tickOf(int64_t time) const {
+  // Round towards negative infinity so that negative times still map to
+  // monotonically increasing ticks.
+  auto tick = time / granularity_;
+  return (time % granularity_ < 0) ? tick - 1 : tick;
+}
+
+BucketedTimeoutQueue::Id BucketedTimeoutQueue::add(
+    int64_t now, int64_t delay, Callback callback) {
+  return insert(now, delay, -1, std::move(callback));
+}
+
+BucketedTimeoutQueue::Id BucketedTimeoutQueue::addRepeating(
+    int64_t now, int64_t interval, Callback callback) {
+  return insert(now, interval, interval, std::move(callback));
+}
+
+BucketedTimeoutQueue::Id BucketedTimeoutQueue::insert(
+    int64_t now, int64_t delay, int64_t interval, Callback&& callback) {
+  if (ids_.empty()) {
+    curTick_ = tickOf(now);
+  }
+  uint32_t index;
+  if (!freeNodes_.empty()) {
+    index = freeNodes_.back();
+    freeNodes_.pop_back();
+  } else {
+    index = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+  }
+  Id id = nextId_++;
+  auto& node = nodes_[index];
+  node.id = id;
+  node.repeatInterval = interval;
+  node.callback = std::move(callback);
+  ids_.emplace(id, index);
+  link(index, now + delay);
+  return id;
+}
+
+void BucketedTimeoutQueue::link(uint32_t index, int64_t expiration) {
+  auto& node = nodes_[index];
+  node.expiration = expiration;
+  node.tick = std::max(tickOf(expiration), curTick_);
+  auto& bucket = buckets_[static_cast<size_t>(node.tick) & mask_];
+  node.prev = bucket.tail;
+  node.next = kNil;
+  if (bucket.tail != kNil) {
+    nodes_[bucket.tail].next = index;
+  } else {
+    bucket.head = index;
+  }
+  bucket.tail = index;
+  if (nextExpirationValid_) {
+    nextExpiration_ = std::min(nextExpiration_, expiration);
+  }
+}
+
+void BucketedTimeoutQueue::unlink(uint32_t index) {
+  auto& node = nodes_[index];
+  auto& bucket = buckets_[static_cast<size_t>(node.tick) & mask_];
+  if (node.prev != kNil) {
+    nodes_[node.prev].next = node.next;
+  } else {
+    bucket.head = node.next;
+  }
+  if (node.next != kNil) {
+    nodes_[node.next].prev = node.prev;
+  } else {
+    bucket.tail = node.prev;
+  }
+}
+
+void BucketedTimeoutQueue::release(uint32_t index) {
+  nodes_[index].callback = nullptr;
+  freeNodes_.push_back(index);
+}
+
+bool BucketedTimeoutQueue::erase(Id id) {
+  auto it = ids_.find(id);
+  if (it == ids_.end()) {
+    return false;
+  }
+  auto index = it->second;
+  ids_.erase(it);
+  unlink(index);
+  if (nodes_[index].expiration <= nextExpiration_) {
+    nextExpirationValid_ = false;
+  }
+  release(index);
+  return true;
+}
+
+void BucketedTimeoutQueue::collectExpired(
+    int64_t now, std::vector<Expired>& out, bool callbacks) {
+  const auto target = tickOf(now);
+  if (ids_.empty()) {
+    curTick_ = std::max(curTick_, target);
+    return;
+  }
+  // Every linked node has tick >= curTick_, and anything due is at most
+  // target, so only the buckets in [curTick_, target] can hold due events.
+  // When the clock moved by a full revolution or more, each bucket is
+  // visited once and may yield events from several ticks.
+  const auto numBuckets = static_cast<int64_t>(mask_ + 1);
+  const auto span = target < curTick_ ? 1 : target - curTick_ + 1;
+  const bool wrapped = span >= numBuckets;
+  const auto count = wrapped ? numBuckets : span;
+  const auto start = out.size();
+
+  for (int64_t i = 0; i < count; ++i) {
+    const auto bucketStart = out.size();
+    auto index = buckets_[static_cast<size_t>(curTick_ + i) & mask_].head;
+    while (index != kNil) {
+      auto& node = nodes_[index];
+      const auto next = node.next;
+      if (node.expiration <= now) {
+        unlink(index);
+        if (node.repeatInterval >= 0) {
+          out.push_back(
+              {node.id,
+               node.expiration,
+               index,
+               callbacks ? node.callback : Callback()});
+        } else {
+          out.push_back(
+              {node.id, node.expiration, kNil, std::move(node.callback)});
+          ids_.erase(node.id);
+          release(index);
+        }
+      }
+      index = next;
+    }
+    // Buckets are appended to in insertion order, so a stable sort keeps
+    // events with equal expirations in the order they were added.
+    if (!wrapped) {
+      std::stable_sort(
+          out.begin() + bucketStart,
+          out.end(),
+          [](const Expired& a, const Expired& b) {
+            return a.expiration < b.expiration;
+          });
+    }
+  }
+  if (wrapped) {
+    std::stable_sort(
+        out.begin() + start, out.end(), [](const Expired& a, const Expired& b) {
+          return a.expiration < b.expiration;
+        });
+  }
+
+  curTick_ = std::max(curTick_, target);
+  nextExpirationValid_ = false;
+
+  // Reschedule repeating events only after the scan, so that each one fires
+  // at most once per call, and before executing callbacks so the callbacks
+  // have a chance to call erase.
+  for (auto it = out.begin() + start; it != out.end(); ++it) {
+    if (it->node != kNil) {
+      auto& node = nodes_[it->node];
+      link(it->node, now + node.repeatInterval);
+    }
+  }
+}
+
+int64_t BucketedTimeoutQueue::runInternal(int64_t now, bool onceOnly) {
+  int64_t nextExp;
+  do {
+    std::vector<Expired> expired;
+    expired.swap(scratch_);
+    expired.clear();
+    collectExpired(now, expired, true);
+    for (const auto& event : expired) {
+      if (event.callback) {
+        event.callback(event.id, now);
+      }
+    }
+    expired.clear();
+    scratch_.swap(expired);
+    nextExp = nextExpiration();
+  } while (!onceOnly && nextExp <= now);
+  return nextExp;
+}
+
+int64_t BucketedTimeoutQueue::runOnce(int64_t now, std::vector<Id>& expired) {
+  std::vector<Expired> events;
+  events.swap(scratch_);
+  events.clear();
+  collectExpired(now, events, false);
+  for (const auto& event : events) {
+    expired.push_back(event.id);
+  }
+  events.clear();
+  scratch_.swap(events);
+  return nextExpiration();
+}
+
+int64_t BucketedTimeoutQueue::nextExpiration() const {
+  if (!nextExpirationValid_) {
+    nextExpiration_ = computeNextExpiration();
+    nextExpirationValid_ = true;
+  }
+  return nextExpiration_;
+}
+
+int64_t BucketedTimeoutQueue::computeNextExpiration() const {
+  auto result = std::numeric_limits<int64_t>::max();
+  if (ids_.empty()) {
+    return result;
+  }
+  // The earliest event lives in the first bucket, starting from the current
+  // tick, that holds a node scheduled for that very tick.
+  for (size_t i = 0; i <= mask_; ++i) {
+    const auto tick = curTick_ + static_cast<int64_t>(i);
+    auto index = buckets_[static_cast<size_t>(tick) & mask_].head;
+    bool found = false;
+    for (; index != kNil; index = nodes_[index].next) {
+      const auto& node = nodes_[index];
+      if (node.tick == tick) {
+        result = std::min(result, node.expiration);
+        found = true;
+      }
+    }
+    if (found) {
+      return result;
+    }
+  }
+  // Everything is more than a revolution away.
+  for (const auto& entry : ids_) {
+    result = std::min(result, nodes_[entry.second].expiration);
+  }
+  return result;
+}
+
+} // namespace folly
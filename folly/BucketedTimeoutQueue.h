@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Timer-wheel timeout queue for very large numbers of short-lived timeouts.
+ *
+ * BucketedTimeoutQueue has the same interface and firing semantics as
+ * TimeoutQueue, but instead of keeping every event in a balanced tree it
+ * hashes events into a fixed ring of buckets by expiration "tick" (expiration
+ * divided by the bucket granularity). Adding and erasing an event are O(1)
+ * and do not allocate once the node pool has grown to its working size;
+ * expiring an event costs O(1) amortized plus a scan of the buckets that the
+ * clock passed over.
+ *
+ * The wheel is cheapest when most timeouts are shorter than one revolution
+ * (granularity * numBuckets time units). Longer timeouts are still handled
+ * correctly, but stay in their bucket and are re-examined once per
+ * revolution until they are due.
+ *
+ * Events that expire in the same call to run*() fire in expiration order,
+ * and in insertion order among events with the same expiration, just like
+ * TimeoutQueue. For callers that track their timeouts by id, the batch
+ * overload of runOnce() hands back all expired ids at once without invoking
+ * any callbacks.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <folly/container/F14Map.h>
+
+namespace folly {
+
+class BucketedTimeoutQueue {
+ public:
+  typedef int64_t Id;
+  typedef std::function<void(Id, int64_t)> Callback;
+
+  /**
+   * Each bucket covers `granularity` time units; numBuckets is rounded up to
+   * a power of two. Expiration times are exact regardless of granularity:
+   * an event never fires before its expiration, coarser buckets only mean
+   * that more events share a bucket.
+   */
+  explicit BucketedTimeoutQueue(
+      int64_t granularity = 1, size_t numBuckets = 4096);
+
+  BucketedTimeoutQueue(const BucketedTimeoutQueue&) = delete;
+  BucketedTimeoutQueue& operator=(const BucketedTimeoutQueue&) = delete;
+
+  /**
+   * Add a one-time timeout event that will fire "delay" time units from "now"
+   * (that is, the first time that run*() is called with a time value >= now
+   * + delay).
+   */
+  Id add(int64_t now, int64_t delay, Callback callback);
+
+  /**
+   * Add a repeating timeout event that will fire every "interval" time units
+   * (it will first fire when run*() is called with a time value >=
+   * now + interval).
+   *
+   * run*() will always invoke each repeating event at most once, even if
+   * more than one "interval" period has passed.
+   */
+  Id addRepeating(int64_t now, int64_t interval, Callback callback);
+
+  /**
+   * Erase a given timeout event, returns true if the event was actually
+   * erased and false if it didn't exist in our queue.
+   */
+  bool erase(Id id);
+
+  /**
+   * Process all events that are due at times <= "now" by calling their
+   * callbacks. Same semantics as TimeoutQueue::runOnce() and
+   * TimeoutQueue::runLoop().
+   *
+   * Return the time that the next event will be due (same as
+   * nextExpiration(), below)
+   */
+  int64_t runOnce(int64_t now) { return runInternal(now, true); }
+  int64_t runLoop(int64_t now) { return runInternal(now, false); }
+
+  /**
+   * Remove all events that are due at times <= "now" and append their ids to
+   * "expired" in firing order, without calling their callbacks. Repeating
+   * events are rescheduled as usual. Callbacks may be empty for events that
+   * are only ever expired this way.
+   *
+   * Return the time that the next event will be due.
+   */
+  int64_t runOnce(int64_t now, std::vector<Id>& expired);
+
+  /**
+   * Return the time that the next event will be due.
+   */
+  int64_t nextExpiration() const;
+
+  size_t size() const { return ids_.size(); }
+  bool empty() const { return ids_.empty(); }
+
+ private:
+  static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+
+  struct Node {
+    Id id;
+    int64_t expiration;
+    int64_t repeatInterval;
+    // Tick of the bucket the node is linked into; at least the current tick
+    // at the time it was scheduled, even if the event was already due.
+    int64_t tick;
+    uint32_t prev;
+    uint32_t next;
+    Callback callback;
+  };
+
+  struct Bucket {
+    uint32_t head = kNil;
+    uint32_t tail = kNil;
+  };
+
+  struct Expired {
+    Id id;
+    int64_t expiration;
+    // Node to reschedule for repeating events, kNil otherwise.
+    uint32_t node;
+    Callback callback;
+  };
+
+  int64_t tickOf(int64_t time) const;
+  Id insert(int64_t now, int64_t delay, int64_t interval, Callback&& callback);
+  void link(uint32_t index, int64_t expiration);
+  void unlink(uint32_t index);
+  void release(uint32_t index);
+  void collectExpired(int64_t now, std::vector<Expired>& out, bool callbacks);
+  int64_t runInternal(int64_t now, bool onceOnly);
+  int64_t computeNextExpiration() const;
+
+  const int64_t granularity_;
+  const size_t mask_;
+  std::vector<Bucket> buckets_;
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> freeNodes_;
+  F14FastMap<Id, uint32_t> ids_;
+  std::vector<Expired> scratch_;
+  int64_t curTick_{0};
+  // Lazily recomputed; kept exact on add, invalidated by erase and run*().
+  mutable int64_t nextExpiration_{std::numeric_limits<int64_t>::max()};
+  mutable bool nextExpirationValid_{true};
+  Id nextId_{1};
+};
+
+} // namespace folly
@@ -15,6 +15,7 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <limits>
 #include <tuple>
@@ -411,18 +412,6 @@ CancellationStateWithData<Data...>::create(Args&&... data) {
   return {CancellationStateSourcePtr{state}, &state->data_};
 }
 
-inline bool variadicDisjunction() {
-  return false;
-}
-
-inline bool variadicDisjunction(bool first) {
-  return first;
-}
-
-template <typename... Bools>
-bool variadicDisjunction(bool first, Bools... bools) {
-  return first || variadicDisjunction(bools...);
-}
 } // namespace detail
 
 template <typename... Data, typename... Args>
@@ -438,12 +427,28 @@ std::pair<CancellationSource, std::tuple<Data...>*> CancellationSource::create(
 
 template <typename... Ts>
 inline CancellationToken CancellationToken::merge(Ts&&... tokens) {
-  bool canBeCancelled = detail::variadicDisjunction(tokens.canBeCancelled()...);
-  return canBeCancelled
-      ? CancellationToken(
-            detail::FixedMergingCancellationState<sizeof...(Ts)>::create(
-                std::forward<Ts>(tokens)...))
-      : CancellationToken();
+  // Only allocate a merging state if at least two distinct tokens can be
+  // cancelled. Commonly a parent token that can't be cancelled is merged with
+  // the token of a local CancellationSource, and that token is returned as is.
+  const std::array<const CancellationToken*, sizeof...(Ts)> tokenPtrs{
+      {&static_cast<const CancellationToken&>(tokens)...}};
+  const CancellationToken* cancellable = nullptr;
+  for (const CancellationToken* token : tokenPtrs) {
+    if (!token->canBeCancelled() ||
+        (cancellable != nullptr && *cancellable == *token)) {
+      continue;
+    }
+    if (token->isCancellationRequested()) {
+      return *token;
+    }
+    if (cancellable != nullptr) {
+      return CancellationToken(
+          detail::FixedMergingCancellationState<sizeof...(Ts)>::create(
+              std::forward<Ts>(tokens)...));
+    }
+    cancellable = token;
+  }
+  return cancellable != nullptr ? *cancellable : CancellationToken();
 }
 
 } // namespace folly
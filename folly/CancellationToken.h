@@ -118,6 +118,10 @@ class CancellationToken {
    * tokens do.
    * This token is cancellable if any of the passed-in tokens are at the time of
    * construction.
+   *
+   * If at most one distinct passed-in token can be cancelled, or one of them
+   * already has had cancellation requested, that token is returned and no
+   * merging state is allocated.
    */
   template <typename... Ts>
   static CancellationToken merge(Ts&&... tokens);
@@ -0,0 +1,684 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// A ConcurrentSkipList variant whose removed nodes are reclaimed through
+// hazard pointers (folly/synchronization/Hazptr.h).
+//
+// ConcurrentSkipList defers all node reclamation until no Accessor is alive,
+// so a long scan that overlaps heavy deletion keeps every node removed during
+// the scan alive. ConcurrentHazptrSkipList instead retires each node to the
+// default hazptr domain once it is unlinked. Readers and iterators protect
+// only the node they currently stand on, so a removed node is reclaimed as
+// soon as no reader stands on it, and memory stays proportional to the live
+// size of the list plus the number of active readers.
+//
+// The insertion and removal algorithms are the same lock-based ones as in
+// ConcurrentSkipList (per-node spinlocks, lock-free reads). Lookups restart
+// from the head whenever the node they stand on is removed under them.
+//
+// Differences from ConcurrentSkipList:
+//  - There is no Accessor: the list is used directly and must outlive all
+//    of its iterators.
+//  - Iterators are forward-only and const. An iterator whose element has
+//    been removed stays dereferenceable, and incrementing it moves to the
+//    first element greater than the removed one.
+//  - The head is allocated at MAX_HEIGHT up front, so the list never needs
+//    to replace it when it grows.
+//
+// Sample usage:
+//
+//   ConcurrentHazptrSkipList<int64_t> index;
+//   index.add(42);
+//   for (auto it = index.lower_bound(10); it != index.end(); ++it) {
+//     if (*it > 100) {
+//       break;
+//     }
+//     // Concurrent erase() of *it is safe, its node stays alive until
+//     // the iterator moves on.
+//   }
+//   index.remove(42);
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#include <folly/ConcurrentSkipList.h>
+#include <folly/ScopeGuard.h>
+#include <folly/synchronization/Hazptr.h>
+#include <folly/synchronization/MicroSpinLock.h>
+
+namespace folly {
+
+namespace detail {
+
+template <typename T, template <typename> class Atom>
+class HazptrSkipListNode;
+
+template <typename T, template <typename> class Atom>
+struct HazptrSkipListNodeDeleter {
+  void operator()(HazptrSkipListNode<T, Atom>* node) const {
+    HazptrSkipListNode<T, Atom>::destroy(node);
+  }
+};
+
+template <typename T, template <typename> class Atom>
+class HazptrSkipListNode : public hazptr_obj_base<
+                               HazptrSkipListNode<T, Atom>,
+                               Atom,
+                               HazptrSkipListNodeDeleter<T, Atom>> {
+  enum : uint16_t {
+    IS_HEAD_NODE = 1,
+    MARKED_FOR_REMOVAL = (1 << 1),
+    FULLY_LINKED = (1 << 2),
+  };
+
+ public:
+  typedef T value_type;
+
+  template <typename... Args>
+  static HazptrSkipListNode* create(int height, bool isHead, Args&&... args) {
+    DCHECK(height >= 1 && height < 64) << height;
+
+    size_t size = sizeof(HazptrSkipListNode) +
+        height * sizeof(Atom<HazptrSkipListNode*>);
+    void* storage = ::operator new(size);
+    auto guard = makeGuard([&] { ::operator delete(storage); });
+    auto node = new (storage) HazptrSkipListNode(
+        uint8_t(height), isHead, std::forward<Args>(args)...);
+    guard.dismiss();
+    return node;
+  }
+
+  static void destroy(HazptrSkipListNode* node) {
+    node->~HazptrSkipListNode();
+    ::operator delete(node);
+  }
+
+  HazptrSkipListNode* skip(int layer) const {
+    DCHECK_LT(layer, height_);
+    return skip_[layer].load(std::memory_order_acquire);
+  }
+
+  // The link itself, for hazard pointer protection.
+  const Atom<HazptrSkipListNode*>& skipLink(int layer) const {
+    DCHECK_LT(layer, height_);
+    return skip_[layer];
+  }
+
+  void setSkip(uint8_t h, HazptrSkipListNode* next) {
+    DCHECK_LT(h, height_);
+    skip_[h].store(next, std::memory_order_release);
+  }
+
+  const value_type& data() const { return data_; }
+  int maxLayer() const { return height_ - 1; }
+  int height() const { return height_; }
+
+  std::unique_lock<MicroSpinLock> acquireGuard() {
+    return std::unique_lock<MicroSpinLock>(spinLock_);
+  }
+
+  bool fullyLinked() const { return getFlags() & FULLY_LINKED; }
+  bool markedForRemoval() const { return getFlags() & MARKED_FOR_REMOVAL; }
+  bool isHeadNode() const { return getFlags() & IS_HEAD_NODE; }
+
+  void setFullyLinked() { setFlags(uint16_t(getFlags() | FULLY_LINKED)); }
+  void setMarkedForRemoval() {
+    setFlags(uint16_t(getFlags() | MARKED_FOR_REMOVAL));
+  }
+
+ private:
+  template <typename... Args>
+  HazptrSkipListNode(uint8_t height, bool isHead, Args&&... args)
+      : height_(height), data_(std::forward<Args>(args)...) {
+    spinLock_.init();
+    setFlags(0);
+    if (isHead) {
+      setIsHeadNode();
+    }
+    for (uint8_t i = 0; i < height_; ++i) {
+      new (&skip_[i]) Atom<HazptrSkipListNode*>(nullptr);
+    }
+  }
+
+  ~HazptrSkipListNode() {
+    for (uint8_t i = 0; i < height_; ++i) {
+      skip_[i].~Atom<HazptrSkipListNode*>();
+    }
+  }
+
+  void setIsHeadNode() { setFlags(uint16_t(getFlags() | IS_HEAD_NODE)); }
+
+  uint16_t getFlags() const { return flags_.load(std::memory_order_acquire); }
+  void setFlags(uint16_t flags) {
+    flags_.store(flags, std::memory_order_release);
+  }
+
+  Atom<uint16_t> flags_;
+  const uint8_t height_;
+  MicroSpinLock spinLock_;
+
+  value_type data_;
+
+  Atom<HazptrSkipListNode*> skip_[0];
+};
+
+} // namespace detail
+
+template <
+    typename T,
+    typename Comp = std::less<T>,
+    int MAX_HEIGHT = 24,
+    template <typename> class Atom = std::atomic>
+class ConcurrentHazptrSkipList {
+  static_assert(
+      MAX_HEIGHT >= 2 && MAX_HEIGHT < 64,
+      "MAX_HEIGHT can only be in the range of [2, 64)");
+  typedef std::unique_lock<folly::MicroSpinLock> ScopedLocker;
+  typedef detail::HazptrSkipListNode<T, Atom> NodeType;
+
+ public:
+  typedef T value_type;
+  typedef T key_type;
+
+  class const_iterator;
+  typedef const_iterator iterator;
+
+  ConcurrentHazptrSkipList()
+      : head_(NodeType::create(MAX_HEIGHT, true, value_type())) {}
+
+  ConcurrentHazptrSkipList(const ConcurrentHazptrSkipList&) = delete;
+  ConcurrentHazptrSkipList& operator=(const ConcurrentHazptrSkipList&) =
+      delete;
+
+  // Removed nodes belong to the hazptr domain by now, so only the nodes
+  // still linked are destroyed here. No iterator may outlive the list.
+  ~ConcurrentHazptrSkipList() {
+    for (NodeType* current = head_; current;) {
+      NodeType* tmp = current->skip(0);
+      NodeType::destroy(current);
+      current = tmp;
+    }
+  }
+
+  size_t size() const { return size_.load(std::memory_order_relaxed); }
+  bool empty() const { return size() == 0; }
+
+  /**
+   * Inserts data if no equal element is present.
+   * @return an iterator to the element equal to data, and whether the
+   *     insertion took place.
+   */
+  template <typename U>
+  std::pair<const_iterator, bool> insert(U&& data) {
+    auto hp = make_hazard_pointer<Atom>();
+    auto ret = addOrGetData(std::forward<U>(data), hp);
+    return std::make_pair(
+        const_iterator(this, ret.first, std::move(hp)), ret.second);
+  }
+
+  /// Returns true if data was not present and has been inserted.
+  template <typename U>
+  bool add(U&& data) {
+    auto hp = make_hazard_pointer<Atom>();
+    return addOrGetData(std::forward<U>(data), hp).second;
+  }
+
+  /// Returns true if data was present and has been removed.
+  bool remove(const key_type& data);
+
+  size_t erase(const key_type& data) { return remove(data); }
+
+  bool contains(const key_type& data) const {
+    auto hps = make_hazard_pointer_array<2, Atom>();
+    auto node = findFirst<false>(data, hps[0], hps[1]);
+    return node && !less(data, node) && !node->markedForRemoval();
+  }
+
+  size_t count(const key_type& data) const { return contains(data); }
+
+  const_iterator find(const key_type& data) const {
+    auto it = lower_bound(data);
+    if (it.node_ && !less(data, it.node_)) {
+      return it;
+    }
+    return end();
+  }
+
+  /// Returns an iterator to the first element not less than data.
+  const_iterator lower_bound(const key_type& data) const {
+    auto hp = make_hazard_pointer<Atom>();
+    auto pred = make_hazard_pointer<Atom>();
+    auto node = findFirst<false>(data, hp, pred);
+    return const_iterator(this, node, std::move(hp));
+  }
+
+  const_iterator begin() const {
+    auto hp = make_hazard_pointer<Atom>();
+    auto node = hp.protect(head_->skipLink(0));
+    return const_iterator(this, node, std::move(hp));
+  }
+
+  const_iterator end() const { return const_iterator(); }
+
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+ private:
+  // Hazard pointers used by a single insertion or removal. Each pred is
+  // protected by the holder of the highest layer it is a pred on, so only
+  // the layers on which the search stepped right take a holder.
+  struct UpdateHazptrs {
+    hazptr_holder<Atom> node = make_hazard_pointer<Atom>();
+    hazptr_holder<Atom> found = make_hazard_pointer<Atom>();
+    hazptr_holder<Atom> preds[MAX_HEIGHT];
+  };
+
+  static bool greater(const value_type& data, const NodeType* node) {
+    return node && Comp()(node->data(), data);
+  }
+
+  static bool less(const value_type& data, const NodeType* node) {
+    return (node == nullptr) || Comp()(data, node->data());
+  }
+
+  // Whether a search for data steps over node: for lower bound searches if
+  // node is less than data, for upper bound searches if it is not greater.
+  template <bool Upper>
+  static bool precedes(const value_type& data, const NodeType* node) {
+    return Upper ? !less(data, node) : greater(data, node);
+  }
+
+  size_t incrementSize(int delta) {
+    return size_.fetch_add(delta, std::memory_order_relaxed) + delta;
+  }
+
+  // Returns the first node at the bottom layer that the search for data
+  // does not step over, protected by nodeHp, or nullptr. The result may be
+  // marked for removal.
+  //
+  // Stepping from pred to its successor node is only safe once node is
+  // protected and pred is known to still be linked: a pred that is not
+  // marked for removal has not been unlinked, so neither has the node it
+  // links to. Otherwise the search restarts from the head.
+  template <bool Upper>
+  NodeType* findFirst(
+      const value_type& data,
+      hazptr_holder<Atom>& nodeHp,
+      hazptr_holder<Atom>& predHp) const {
+    while (true) {
+      NodeType* pred = head_;
+      NodeType* node = nullptr;
+      bool valid = true;
+      int layer = height_.load(std::memory_order_acquire) - 1;
+      for (; valid && layer >= 0; --layer) {
+        while (true) {
+          node = nodeHp.protect(pred->skipLink(layer));
+          if (pred->markedForRemoval()) {
+            valid = false;
+            break;
+          }
+          if (!precedes<Upper>(data, node)) {
+            break;
+          }
+          pred = node;
+          predHp.swap(nodeHp);
+        }
+      }
+      if (valid) {
+        return node;
+      }
+    }
+  }
+
+  // Fills preds and succs for every layer below *height, and returns the
+  // highest layer on which a node equal to data was found, or -1. See
+  // findFirst for the protocol protecting each step.
+  int findInsertionPoint(
+      const value_type& data,
+      NodeType* preds[],
+      NodeType* succs[],
+      UpdateHazptrs& hps,
+      int* height) const {
+    while (true) {
+      int foundLayer = -1;
+      NodeType* pred = head_;
+      NodeType* foundNode = nullptr;
+      bool valid = true;
+      *height = height_.load(std::memory_order_acquire);
+      for (int layer = *height - 1; layer >= 0; --layer) {
+        NodeType* node;
+        while (true) {
+          node = hps.node.protect(pred->skipLink(layer));
+          if (pred->markedForRemoval()) {
+            valid = false;
+            break;
+          }
+          if (!greater(data, node)) {
+            break;
+          }
+          if (!hps.preds[layer].hprec()) {
+            hps.preds[layer] = make_hazard_pointer<Atom>();
+          }
+          pred = node;
+          hps.preds[layer].swap(hps.node);
+        }
+        if (!valid) {
+          break;
+        }
+        if (foundLayer == -1 && !less(data, node)) { // the two keys equal
+          foundLayer = layer;
+          foundNode = node;
+          hps.found.reset_protection(node);
+        }
+        preds[layer] = pred;
+
+        // if found, succs[0..foundLayer] need to point to the cached foundNode,
+        // as foundNode might be deleted at the same time thus pred->skip() can
+        // return nullptr or another node.
+        succs[layer] = foundNode ? foundNode : node;
+      }
+      if (valid) {
+        return foundLayer;
+      }
+    }
+  }
+
+  // lock all the necessary nodes for changing (adding or removing) the list.
+  // returns true if all the lock acquired successfully and the related nodes
+  // are all validate (not in certain pending states), false otherwise.
+  //
+  // A succ is only dereferenced once its pred is validated under the pred's
+  // lock, which keeps succ from being unlinked and retired.
+  static bool lockNodesForChange(
+      int nodeHeight,
+      ScopedLocker guards[MAX_HEIGHT],
+      NodeType* preds[MAX_HEIGHT],
+      NodeType* succs[MAX_HEIGHT],
+      bool adding = true) {
+    NodeType *pred, *succ, *prevPred = nullptr;
+    bool valid = true;
+    for (int layer = 0; valid && layer < nodeHeight; ++layer) {
+      pred = preds[layer];
+      DCHECK(pred != nullptr) << "layer=" << layer;
+      succ = succs[layer];
+      if (pred != prevPred) {
+        guards[layer] = pred->acquireGuard();
+        prevPred = pred;
+      }
+      valid = !pred->markedForRemoval() &&
+          pred->skip(layer) == succ; // check again after locking
+
+      if (adding) { // when adding a node, the succ shouldn't be going away
+        valid = valid && (succ == nullptr || !succ->markedForRemoval());
+      }
+    }
+
+    return valid;
+  }
+
+  static bool okToDelete(NodeType* candidate, int layer) {
+    DCHECK(candidate != nullptr);
+    return candidate->fullyLinked() && candidate->maxLayer() == layer &&
+        !candidate->markedForRemoval();
+  }
+
+  // Returns the node equal to data, protected by hp, and whether it has
+  // just been added.
+  template <typename U>
+  std::pair<NodeType*, bool> addOrGetData(U&& data, hazptr_holder<Atom>& hp);
+
+  NodeType* const head_;
+  Atom<int> height_{1};
+  Atom<size_t> size_{0};
+};
+
+template <
+    typename T,
+    typename Comp,
+    int MAX_HEIGHT,
+    template <typename>
+    class Atom>
+class ConcurrentHazptrSkipList<T, Comp, MAX_HEIGHT, Atom>::const_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const T*;
+  using reference = const T&;
+
+  const_iterator() = default;
+
+  const_iterator(const const_iterator& other)
+      : list_(other.list_), node_(other.node_) {
+    if (node_) {
+      // other protects node_, so the protection can be copied over.
+      hp_ = make_hazard_pointer<Atom>();
+      hp_.reset_protection(node_);
+    }
+  }
+
+  const_iterator(const_iterator&& other) noexcept
+      : list_(std::exchange(other.list_, nullptr)),
+        node_(std::exchange(other.node_, nullptr)),
+        hp_(std::move(other.hp_)) {}
+
+  const_iterator& operator=(const const_iterator& other) {
+    const_iterator(other).swap(*this);
+    return *this;
+  }
+
+  const_iterator& operator=(const_iterator&& other) noexcept {
+    const_iterator(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  reference operator*() const { return node_->data(); }
+  pointer operator->() const { return &node_->data(); }
+
+  const_iterator& operator++() {
+    step();
+    skipRemoved();
+    return *this;
+  }
+
+  const_iterator operator++(int) {
+    const_iterator prev(*this);
+    ++*this;
+    return prev;
+  }
+
+  friend bool operator==(const const_iterator& a, const const_iterator& b) {
+    return a.node_ == b.node_;
+  }
+
+  friend bool operator!=(const const_iterator& a, const const_iterator& b) {
+    return a.node_ != b.node_;
+  }
+
+  void swap(const_iterator& other) noexcept {
+    std::swap(list_, other.list_);
+    std::swap(node_, other.node_);
+    hp_.swap(other.hp_);
+  }
+
+ private:
+  friend class ConcurrentHazptrSkipList;
+
+  // hp protects node.
+  const_iterator(
+      const ConcurrentHazptrSkipList* list,
+      NodeType* node,
+      hazptr_holder<Atom>&& hp)
+      : list_(list), node_(node), hp_(std::move(hp)) {
+    skipRemoved();
+  }
+
+  // Moves to the successor of node_ at the bottom layer. If node_ has been
+  // removed, its link may point to a node that has been removed and
+  // reclaimed since, so the successor is looked up from the head instead.
+  void step() {
+    auto next = make_hazard_pointer<Atom>();
+    NodeType* node = next.protect(node_->skipLink(0));
+    if (node_->markedForRemoval()) {
+      auto pred = make_hazard_pointer<Atom>();
+      node = list_->template findFirst<true>(node_->data(), next, pred);
+    }
+    node_ = node;
+    hp_.swap(next);
+  }
+
+  void skipRemoved() {
+    while (node_ && node_->markedForRemoval()) {
+      step();
+    }
+  }
+
+  const ConcurrentHazptrSkipList* list_{nullptr};
+  NodeType* node_{nullptr};
+  hazptr_holder<Atom> hp_;
+};
+
+template <
+    typename T,
+    typename Comp,
+    int MAX_HEIGHT,
+    template <typename>
+    class Atom>
+template <typename U>
+std::pair<detail::HazptrSkipListNode<T, Atom>*, bool>
+ConcurrentHazptrSkipList<T, Comp, MAX_HEIGHT, Atom>::addOrGetData(
+    U&& data, hazptr_holder<Atom>& hp) {
+  NodeType *preds[MAX_HEIGHT], *succs[MAX_HEIGHT];
+  UpdateHazptrs hps;
+  NodeType* newNode;
+  size_t newSize;
+  while (true) {
+    int height = 0;
+    int layer = findInsertionPoint(data, preds, succs, hps, &height);
+
+    if (layer >= 0) {
+      NodeType* nodeFound = succs[layer];
+      DCHECK(nodeFound != nullptr);
+      if (nodeFound->markedForRemoval()) {
+        continue; // if it's getting deleted retry finding node.
+      }
+      // wait until fully linked.
+      while (FOLLY_UNLIKELY(!nodeFound->fullyLinked())) {
+      }
+      hp.reset_protection(nodeFound);
+      return std::make_pair(nodeFound, false);
+    }
+
+    int nodeHeight =
+        detail::SkipListRandomHeight::instance()->getHeight(height);
+
+    ScopedLocker guards[MAX_HEIGHT];
+    if (!lockNodesForChange(nodeHeight, guards, preds, succs)) {
+      continue; // give up the locks and retry until all valid
+    }
+
+    // locks acquired and all valid, need to modify the links under the locks.
+    newNode = NodeType::create(nodeHeight, false, std::forward<U>(data));
+    // Protect the new node before it becomes reachable, and thus removable.
+    hp.reset_protection(newNode);
+    for (int k = 0; k < nodeHeight; ++k) {
+      newNode->setSkip(k, succs[k]);
+      preds[k]->setSkip(k, newNode);
+    }
+
+    newNode->setFullyLinked();
+    newSize = incrementSize(1);
+    break;
+  }
+
+  int hgt = height_.load(std::memory_order_relaxed);
+  size_t sizeLimit =
+      detail::SkipListRandomHeight::instance()->getSizeLimit(hgt);
+
+  if (hgt < MAX_HEIGHT && newSize > sizeLimit) {
+    // The head already has MAX_HEIGHT layers, so growing only means
+    // starting searches from a higher layer. Losing this race means
+    // someone else has grown the list already.
+    height_.compare_exchange_strong(hgt, hgt + 1, std::memory_order_release);
+  }
+  return std::make_pair(newNode, true);
+}
+
+template <
+    typename T,
+    typename Comp,
+    int MAX_HEIGHT,
+    template <typename>
+    class Atom>
+bool ConcurrentHazptrSkipList<T, Comp, MAX_HEIGHT, Atom>::remove(
+    const key_type& data) {
+  NodeType* nodeToDelete = nullptr;
+  ScopedLocker nodeGuard;
+  bool isMarked = false;
+  int nodeHeight = 0;
+  NodeType *preds[MAX_HEIGHT], *succs[MAX_HEIGHT];
+  UpdateHazptrs hps;
+  hazptr_holder<Atom> deleteHp;
+
+  while (true) {
+    int height = 0;
+    int layer = findInsertionPoint(data, preds, succs, hps, &height);
+    if (!isMarked && (layer < 0 || !okToDelete(succs[layer], layer))) {
+      return false;
+    }
+
+    if (!isMarked) {
+      nodeToDelete = succs[layer];
+      // Keep nodeToDelete protected across the searches below.
+      hps.found.swap(deleteHp);
+      hps.found = make_hazard_pointer<Atom>();
+      nodeHeight = nodeToDelete->height();
+      nodeGuard = nodeToDelete->acquireGuard();
+      if (nodeToDelete->markedForRemoval()) {
+        return false;
+      }
+      nodeToDelete->setMarkedForRemoval();
+      isMarked = true;
+    }
+
+    // acquire pred locks from bottom layer up
+    ScopedLocker guards[MAX_HEIGHT];
+    if (!lockNodesForChange(nodeHeight, guards, preds, succs, false)) {
+      continue; // this will unlock all the locks
+    }
+
+    for (int k = nodeHeight - 1; k >= 0; --k) {
+      preds[k]->setSkip(k, nodeToDelete->skip(k));
+    }
+
+    incrementSize(-1);
+    break;
+  }
+  // Reclamation may happen during retire(), so the lock must not be held.
+  nodeGuard.unlock();
+  nodeToDelete->retire();
+  return true;
+}
+
+} // namespace folly
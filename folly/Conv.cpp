@@ -17,6 +17,11 @@
 #include <folly/Conv.h>
 
 #include <array>
+#include <cstring>
+
+#if FOLLY_CONV_USE_TO_CHARS
+#include <charconv>
+#endif
 
 namespace folly {
 namespace detail {
@@ -337,6 +342,115 @@ Expected<bool, ConversionCode> str_to_bool(StringPiece* src) noexcept {
   return result;
 }
 
+#if FOLLY_CONV_USE_TO_CHARS
+
+size_t shortestToChars(
+    double value,
+    bool single,
+    int flags,
+    char (&out)[kConvShortestToCharsSize]) noexcept {
+  using Converter = double_conversion::DoubleToStringConverter;
+  constexpr int kHandledFlags = Converter::EMIT_POSITIVE_EXPONENT_SIGN |
+      Converter::EMIT_TRAILING_DECIMAL_POINT |
+      Converter::EMIT_TRAILING_ZERO_AFTER_POINT | Converter::UNIQUE_ZERO;
+  if (flags & ~kHandledFlags) {
+    return 0;
+  }
+  if (single) {
+    value = double(static_cast<float>(value));
+  }
+
+  char* o = out;
+  if (std::isnan(value)) {
+    std::memcpy(o, "NaN", 3);
+    return 3;
+  }
+  if (std::signbit(value) &&
+      !(value == 0 && (flags & Converter::UNIQUE_ZERO))) {
+    *o++ = '-';
+  }
+  if (std::isinf(value)) {
+    std::memcpy(o, "Infinity", 8);
+    return size_t(o + 8 - out);
+  }
+
+  // The shortest digits that round-trip, as d.ddde[+-]xx
+  char sci[kConvShortestToCharsSize];
+  auto const res = single
+      ? std::to_chars(
+            sci, sci + sizeof(sci), float(value), std::chars_format::scientific)
+      : std::to_chars(
+            sci, sci + sizeof(sci), value, std::chars_format::scientific);
+  assert(res.ec == std::errc());
+  char const* p = sci + (sci[0] == '-');
+  char digits[kConvShortestToCharsSize];
+  int length = 0;
+  digits[length++] = *p++;
+  if (*p == '.') {
+    for (++p; *p != 'e'; ++p) {
+      digits[length++] = *p;
+    }
+  }
+  ++p;
+  bool const negativeExponent = *p++ == '-';
+  int exponent = 0;
+  for (; p != res.ptr; ++p) {
+    exponent = exponent * 10 + (*p - '0');
+  }
+  if (negativeExponent) {
+    exponent = -exponent;
+  }
+
+  // Laid out as DoubleToStringConverter does
+  auto const copy = [&](int begin, int end) {
+    std::memcpy(o, digits + begin, size_t(end - begin));
+    o += end - begin;
+  };
+  auto const pad = [&](int n) {
+    std::memset(o, '0', size_t(n));
+    o += n;
+  };
+  int const decimalPoint = exponent + 1;
+  if (exponent < kConvMaxDecimalInShortestLow ||
+      exponent >= kConvMaxDecimalInShortestHigh) {
+    *o++ = digits[0];
+    if (length > 1) {
+      *o++ = '.';
+      copy(1, length);
+    }
+    *o++ = 'E';
+    if (exponent < 0) {
+      *o++ = '-';
+      exponent = -exponent;
+    } else if (flags & Converter::EMIT_POSITIVE_EXPONENT_SIGN) {
+      *o++ = '+';
+    }
+    o += to_ascii_decimal(
+        o, out + kConvShortestToCharsSize, uint64_t(exponent));
+  } else if (decimalPoint <= 0) {
+    *o++ = '0';
+    *o++ = '.';
+    pad(-decimalPoint);
+    copy(0, length);
+  } else if (decimalPoint >= length) {
+    copy(0, length);
+    pad(decimalPoint - length);
+    if (flags & Converter::EMIT_TRAILING_DECIMAL_POINT) {
+      *o++ = '.';
+    }
+    if (flags & Converter::EMIT_TRAILING_ZERO_AFTER_POINT) {
+      *o++ = '0';
+    }
+  } else {
+    copy(0, decimalPoint);
+    *o++ = '.';
+    copy(decimalPoint, length);
+  }
+  return size_t(o - out);
+}
+
+#endif
+
 /**
  * StringPiece to double, with progress information. Alters the
  * StringPiece parameter to munch the already-parsed characters.
@@ -344,6 +458,25 @@ Expected<bool, ConversionCode> str_to_bool(StringPiece* src) noexcept {
 template <class Tgt>
 Expected<Tgt, ConversionCode> str_to_floating(StringPiece* src) noexcept {
   using namespace double_conversion;
+
+#if FOLLY_CONV_USE_TO_CHARS
+  // Plain decimal numbers, where std::from_chars() reads as much as
+  // double-conversion would, and to the same value. Others, such as
+  // "+1", " 1", "inf" or those out of range, are left to double-conversion.
+  {
+    char const* b = src->begin();
+    char const* e = src->end();
+    char const* d = b + (b != e && *b == '-');
+    if (d != e && ((*d >= '0' && *d <= '9') || *d == '.')) {
+      Tgt value;
+      auto const res = std::from_chars(b, e, value);
+      if (res.ec == std::errc()) {
+        src->assign(res.ptr, e);
+        return value;
+      }
+    }
+  }
+#endif
   static StringToDoubleConverter conv(
       StringToDoubleConverter::ALLOW_TRAILING_JUNK |
           StringToDoubleConverter::ALLOW_LEADING_SPACES,
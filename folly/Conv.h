@@ -114,6 +114,7 @@
 #include <climits>
 #include <cmath>
 #include <cstddef>
+#include <cstring>
 #include <limits>
 #include <stdexcept>
 #include <string>
@@ -638,9 +639,46 @@ estimateSpaceNeeded(Src value) {
  * Conversions from floating-point types to string types.
  */
 
+/**
+ * FOLLY_CONV_USE_TO_CHARS selects std::to_chars() and std::from_chars() for
+ * the common floating-point conversions, where the standard library has
+ * them: toAppend() in the SHORTEST and SHORTEST_SINGLE modes, and to<double>()
+ * and to<float>() of plain decimal numbers. Their shortest round-trip and
+ * correctly rounded algorithms are several times faster than
+ * double-conversion's, and the results are laid out as double-conversion
+ * would, so the output is unchanged. The FIXED and PRECISION modes, and other
+ * inputs such as "inf" or leading whitespace, still use double-conversion.
+ *
+ * Define it to 0 to use double-conversion throughout.
+ */
+#ifndef FOLLY_CONV_USE_TO_CHARS
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define FOLLY_CONV_USE_TO_CHARS 1
+#else
+#define FOLLY_CONV_USE_TO_CHARS 0
+#endif
+#endif
+
 namespace detail {
 constexpr int kConvMaxDecimalInShortestLow = -6;
 constexpr int kConvMaxDecimalInShortestHigh = 21;
+
+#if FOLLY_CONV_USE_TO_CHARS
+// Room for the output of shortestToChars(), e.g. -1.2345678901234567E-308
+constexpr size_t kConvShortestToCharsSize = 32;
+
+/**
+ * Format value as DoubleToStringConverter::ToShortest(), or
+ * ToShortestSingle() of the value as a float if single, would with the
+ * converter of toAppend() below. Returns the length of the output, or 0 for
+ * flags that it doesn't handle.
+ */
+size_t shortestToChars(
+    double value,
+    bool single,
+    int flags,
+    char (&out)[kConvShortestToCharsSize]) noexcept;
+#endif
 } // namespace detail
 
 /** Wrapper around DoubleToStringConverter */
@@ -655,6 +693,20 @@ toAppend(
     double_conversion::DoubleToStringConverter::Flags flags =
         double_conversion::DoubleToStringConverter::NO_FLAGS) {
   using namespace double_conversion;
+#if FOLLY_CONV_USE_TO_CHARS
+  if (mode == DoubleToStringConverter::SHORTEST ||
+      mode == DoubleToStringConverter::SHORTEST_SINGLE) {
+    char buffer[detail::kConvShortestToCharsSize];
+    if (const size_t length = detail::shortestToChars(
+            double(value),
+            mode == DoubleToStringConverter::SHORTEST_SINGLE,
+            flags,
+            buffer)) {
+      result->append(buffer, length);
+      return;
+    }
+  }
+#endif
   DoubleToStringConverter conv(
       flags,
       "Infinity",
@@ -992,6 +1044,64 @@ void toAppendDelimFit(const Delimiter& delim, const Ts&... vs) {
 template <class De, class Ts>
 void toAppendDelimFit(const De&, const Ts&) {}
 
+/**
+ * @overloadbrief Append a sequence of integers with a delimiter in between.
+ *
+ * As toAppendDelim(delim, values[0], values[1], ..., result), for sequences
+ * whose length is only known at runtime, such as a batch of metrics. The
+ * exact size of the output is computed in a first pass, so the string grows
+ * once, and the digits are then written in place.
+ *
+ *   std::vector<int64_t> v = {1, -2, 3};
+ *   std::string s;
+ *   toAppendDelimVec(range(v), ',', &s); // s == "1,-2,3"
+ */
+template <class Int, class Tgt>
+typename std::enable_if<
+    is_integral_v<Int> && !std::is_same<std::remove_cv_t<Int>, bool>::value &&
+    !std::is_same<std::remove_cv_t<Int>, char>::value && sizeof(Int) <= 8 &&
+    IsSomeString<Tgt>::value>::type
+toAppendDelimVec(Range<Int*> values, StringPiece delim, Tgt* result) {
+  if (values.empty()) {
+    return;
+  }
+  auto const magnitude = [](Int v) {
+    if constexpr (is_signed_v<Int>) {
+      return v < 0 ? ~static_cast<uint64_t>(v) + 1 : static_cast<uint64_t>(v);
+    } else {
+      return static_cast<uint64_t>(v);
+    }
+  };
+  size_t size = delim.size() * (values.size() - 1);
+  for (auto v : values) {
+    size += size_t(is_negative(v)) + to_ascii_size_decimal(magnitude(v));
+  }
+  auto const offset = result->size();
+  result->resize(offset + size);
+  char* out = &(*result)[offset];
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (i != 0) {
+      std::memcpy(out, delim.data(), delim.size());
+      out += delim.size();
+    }
+    auto const v = values[i];
+    if (is_negative(v)) {
+      *out++ = '-';
+    }
+    auto const u = magnitude(v);
+    auto const n = to_ascii_size_decimal(u);
+    detail::to_ascii_with_route<10, to_ascii_alphabet_lower>(out, n, u);
+    out += n;
+  }
+  assert(out == result->data() + result->size());
+}
+
+template <class Int, class Tgt>
+auto toAppendDelimVec(Range<Int*> values, char delim, Tgt* result)
+    -> decltype(toAppendDelimVec(values, StringPiece(), result)) {
+  toAppendDelimVec(values, StringPiece(&delim, 1), result);
+}
+
 /**
  * to<SomeString>(v1, v2, ...) uses toAppend() (see below) as back-end
  * for all types.
@@ -63,6 +63,12 @@ class Executor {
   /// This is up to the implementation to enforce
   virtual void addWithPriority(Func, int8_t priority);
 
+  /// Enqueue all the functions of funcs, which are moved from. Equivalent to
+  /// calling add() on each of them, which is what the default implementation
+  /// does; executors that can enqueue many functions at once more cheaply,
+  /// e.g. by waking up their workers once for the whole batch, override it.
+  virtual void addBatch(Range<Func*> funcs);
+
   virtual uint8_t getNumPriorities() const { return 1; }
 
   static constexpr int8_t LO_PRI = SCHAR_MIN;
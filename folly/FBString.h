@@ -437,6 +437,35 @@ class fbstring_core {
     return category() == Category::isLarge && RefCounted::refs(ml_.data_) > 1;
   }
 
+  // Relinquishes the mallocated block of a medium or unshared large
+  // string, leaving the string empty. The caller frees the block with
+  // free(). Sets *offset to the byte offset of the data within the block
+  // and *allocatedSize to the size of the block. Small and shared strings
+  // have no block to give up, so they are left alone and nullptr is
+  // returned.
+  void* releaseMallocatedBlock(size_t* offset, size_t* allocatedSize) noexcept {
+    void* block;
+    switch (category()) {
+      case Category::isMedium:
+        block = ml_.data_;
+        *offset = 0;
+        break;
+      case Category::isLarge:
+        if (RefCounted::refs(ml_.data_) > 1) {
+          return nullptr;
+        }
+        block = RefCounted::fromData(ml_.data_);
+        *offset = RefCounted::getDataOffset();
+        break;
+      case Category::isSmall:
+      default:
+        return nullptr;
+    }
+    *allocatedSize = *offset + (ml_.capacity() + 1) * sizeof(Char);
+    reset();
+    return block;
+  }
+
  private:
   Char* c_str() {
     Char* ptr = ml_.data_;
@@ -1101,6 +1130,16 @@ class basic_fbstring {
       value_type* s, size_type n, size_type c, AcquireMallocatedString a)
       : store_(s, n, c, a) {}
 
+  // Nonstandard: the reverse of the constructor above. Gives up the
+  // mallocated block that holds the string, if it has one to itself, and
+  // leaves the string empty; the caller frees the block with free(). The
+  // characters start at *offset bytes into the block, of *allocatedSize
+  // bytes. Returns nullptr and leaves the string alone otherwise.
+  void* releaseMallocatedBlock(
+      size_type* offset, size_type* allocatedSize) noexcept {
+    return store_.releaseMallocatedBlock(offset, allocatedSize);
+  }
+
   // Construction from initialization list
   FOLLY_NOINLINE
   basic_fbstring(std::initializer_list<value_type> il) {
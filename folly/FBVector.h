@@ -956,6 +956,18 @@ class fbvector {
 
   size_type capacity() const noexcept { return size_type(impl_.z_ - impl_.b_); }
 
+  // Bytes allocated for the elements; see F14's visitAllocationClasses().
+  std::size_t getAllocatedMemorySize() const noexcept {
+    return capacity() * sizeof(T);
+  }
+
+  template <typename V>
+  void visitAllocationClasses(V&& visitor) const {
+    if (capacity() != 0) {
+      visitor(capacity() * sizeof(T), 1);
+    }
+  }
+
   bool empty() const noexcept { return impl_.b_ == impl_.e_; }
 
   void reserve(size_type n) {
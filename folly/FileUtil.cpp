@@ -16,11 +16,17 @@
 
 #include <folly/FileUtil.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <cstring>
+#include <memory>
 #include <string>
 #include <system_error>
+#include <thread>
 #include <vector>
 
+#include <folly/Memory.h>
 #include <folly/detail/FileUtilDetail.h>
 #include <folly/detail/FileUtilVectorDetail.h>
 #include <folly/net/NetOps.h>
@@ -225,6 +231,216 @@ WriteFileAtomicOptions& WriteFileAtomicOptions::setTemporaryDirectory(
   return *this;
 }
 
+ParallelFileOptions& ParallelFileOptions::setThreads(size_t _threads) {
+  threads = _threads;
+  return *this;
+}
+
+ParallelFileOptions& ParallelFileOptions::setChunkSize(size_t _chunkSize) {
+  chunkSize = _chunkSize;
+  return *this;
+}
+
+ParallelFileOptions& ParallelFileOptions::setDirectIO(bool _directIO) {
+  directIO = _directIO;
+  return *this;
+}
+
+WriteFileAtomicOptions& WriteFileAtomicOptions::setParallel(
+    ParallelFileOptions _parallel) {
+  parallel = _parallel;
+  return *this;
+}
+
+namespace {
+constexpr size_t kDirectIOAlignment = ParallelFileOptions::kDirectIOAlignment;
+
+bool isDirectIOAligned(uintptr_t value) {
+  return (value & (kDirectIOAlignment - 1)) == 0;
+}
+
+uint64_t alignDownForDirectIO(uint64_t value) {
+  return value & ~uint64_t(kDirectIOAlignment - 1);
+}
+
+uint64_t alignUpForDirectIO(uint64_t value) {
+  return alignDownForDirectIO(value + kDirectIOAlignment - 1);
+}
+
+// Calls fn(begin, length) for each chunk of [0, size) from up to
+// options.threads threads, the calling one included. Returns 0, or the first
+// errno value returned by fn, after which no further chunks are started.
+template <typename Fn>
+int forEachChunkParallel(
+    size_t size, const ParallelFileOptions& options, Fn fn) {
+  auto chunkSize = std::max<size_t>(options.chunkSize, 1);
+  if (options.directIO) {
+    chunkSize = size_t(alignUpForDirectIO(chunkSize));
+  }
+  const size_t numChunks = (size + chunkSize - 1) / chunkSize;
+  std::atomic<size_t> next{0};
+  std::atomic<int> error{0};
+  auto work = [&] {
+    size_t i;
+    while ((i = next.fetch_add(1, std::memory_order_relaxed)) < numChunks &&
+           error.load(std::memory_order_relaxed) == 0) {
+      const size_t begin = i * chunkSize;
+      if (int rc = fn(begin, std::min(chunkSize, size - begin))) {
+        int expected = 0;
+        error.compare_exchange_strong(expected, rc);
+      }
+    }
+  };
+
+  const auto numThreads =
+      std::min(std::max<size_t>(options.threads, 1), numChunks);
+  std::vector<std::thread> threads;
+  if (numThreads > 1) {
+    threads.reserve(numThreads - 1);
+    try {
+      while (threads.size() < numThreads - 1) {
+        threads.emplace_back(work);
+      }
+    } catch (const std::system_error&) {
+      // Out of threads: carry on with the ones already started.
+    }
+  }
+  work();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return error.load();
+}
+
+// Reads from an O_DIRECT fd; buf, count and offset must all be aligned.
+// Stops at the first read that ends short of an alignment boundary, which
+// only happens at the end of the file.
+ssize_t preadDirect(int fd, void* buf, size_t count, off_t offset) {
+  size_t soFar = 0;
+  while (soFar < count) {
+    auto n = preadNoInt(
+        fd, static_cast<char*>(buf) + soFar, count - soFar, offset + soFar);
+    if (n == -1) {
+      return -1;
+    }
+    soFar += size_t(n);
+    if (n == 0 || !isDirectIOAligned(size_t(n))) {
+      break;
+    }
+  }
+  return ssize_t(soFar);
+}
+
+// Reads an arbitrary range from an O_DIRECT fd through an aligned buffer.
+ssize_t preadDirectBounce(int fd, void* buf, size_t count, off_t offset) {
+  const auto start = alignDownForDirectIO(uint64_t(offset));
+  const auto skip = size_t(uint64_t(offset) - start);
+  const auto length = size_t(alignUpForDirectIO(skip + count));
+  std::unique_ptr<void, decltype(&aligned_free)> bounce(
+      aligned_malloc(length, kDirectIOAlignment), &aligned_free);
+  if (!bounce) {
+    errno = ENOMEM;
+    return -1;
+  }
+  auto n = preadDirect(fd, bounce.get(), length, off_t(start));
+  if (n == -1) {
+    return -1;
+  }
+  const auto got = size_t(n) > skip ? std::min(count, size_t(n) - skip) : 0;
+  std::memcpy(buf, static_cast<char*>(bounce.get()) + skip, got);
+  return ssize_t(got);
+}
+
+ssize_t preadChunk(
+    int fd, unsigned char* buf, size_t count, off_t offset, bool directIO) {
+  if (!directIO) {
+    return preadFull(fd, buf, count, offset);
+  }
+  if (!isDirectIOAligned(reinterpret_cast<uintptr_t>(buf)) ||
+      !isDirectIOAligned(uintptr_t(offset))) {
+    return preadDirectBounce(fd, buf, count, offset);
+  }
+  // Read the aligned part in place; only the tail needs to bounce.
+  const auto aligned = size_t(alignDownForDirectIO(count));
+  auto n = preadDirect(fd, buf, aligned, offset);
+  if (n == -1 || size_t(n) < aligned || aligned == count) {
+    return n;
+  }
+  auto tail =
+      preadDirectBounce(fd, buf + aligned, count - aligned, offset + aligned);
+  return tail == -1 ? -1 : ssize_t(aligned) + tail;
+}
+
+int pwriteParallelImpl(
+    int fd,
+    ByteRange data,
+    off_t offset,
+    const ParallelFileOptions& options,
+    bool startWriteback) {
+  auto opts = options;
+  opts.directIO = false;
+  return forEachChunkParallel(data.size(), opts, [&](size_t begin, size_t n) {
+    auto chunkOffset = off_t(offset + begin);
+    if (pwriteFull(fd, data.data() + begin, n, chunkOffset) == -1) {
+      return errno;
+    }
+#ifdef __linux__
+    // Kick off writeback now instead of leaving all of it to the final
+    // fsync(); failures are reported by that fsync() anyway.
+    if (startWriteback) {
+      sync_file_range(fd, chunkOffset, off_t(n), SYNC_FILE_RANGE_WRITE);
+    }
+#else
+    (void)startWriteback;
+#endif
+    return 0;
+  });
+}
+} // namespace
+
+ssize_t preadParallel(
+    int fd,
+    MutableByteRange buf,
+    off_t offset,
+    const ParallelFileOptions& options) {
+  // Chunks past the end of the file read nothing; the result is where the
+  // first short chunk stopped.
+  std::atomic<size_t> end{buf.size()};
+  auto readChunk = [&](size_t begin, size_t n) {
+    auto got = preadChunk(
+        fd, buf.data() + begin, n, off_t(offset + begin), options.directIO);
+    if (got == -1) {
+      return errno;
+    }
+    if (size_t(got) < n) {
+      auto prev = end.load(std::memory_order_relaxed);
+      while (begin + size_t(got) < prev &&
+             !end.compare_exchange_weak(prev, begin + size_t(got))) {
+      }
+    }
+    return 0;
+  };
+  int rc = forEachChunkParallel(buf.size(), options, readChunk);
+  if (rc != 0) {
+    errno = rc;
+    return -1;
+  }
+  return ssize_t(end.load());
+}
+
+ssize_t pwriteParallel(
+    int fd,
+    ByteRange data,
+    off_t offset,
+    const ParallelFileOptions& options) {
+  int rc = pwriteParallelImpl(fd, data, offset, options, false);
+  if (rc != 0) {
+    errno = rc;
+    return -1;
+  }
+  return ssize_t(data.size());
+}
+
 namespace {
 void throwIfWriteFileAtomicFailed(
     StringPiece function, StringPiece filename, std::int64_t rc) {
@@ -265,9 +481,27 @@ int writeFileAtomicNoThrowImpl(
     }
   };
 
-  auto rc = writevFull(tmpFD, iov, count);
-  if (rc == -1) {
-    return errno;
+  ssize_t rc = 0;
+  if (options.parallel.threads > 1) {
+    off_t offset = 0;
+    for (int i = 0; i < count; ++i) {
+      ByteRange data(
+          static_cast<const unsigned char*>(iov[i].iov_base), iov[i].iov_len);
+      if (int err = pwriteParallelImpl(
+              tmpFD,
+              data,
+              offset,
+              options.parallel,
+              options.syncType == SyncType::WITH_SYNC)) {
+        return err;
+      }
+      offset += off_t(data.size());
+    }
+  } else {
+    rc = writevFull(tmpFD, iov, count);
+    if (rc == -1) {
+      return errno;
+    }
   }
 
   rc = fchmod(tmpFD, options.permissions);
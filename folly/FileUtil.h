@@ -20,6 +20,7 @@
 #include <sys/types.h>
 
 #include <cassert>
+#include <cerrno>
 #include <limits>
 
 #include <folly/Portability.h>
@@ -27,6 +28,7 @@
 #include <folly/ScopeGuard.h>
 #include <folly/net/NetworkSocket.h>
 #include <folly/portability/Fcntl.h>
+#include <folly/portability/SysStat.h>
 #include <folly/portability/SysUio.h>
 #include <folly/portability/Unistd.h>
 
@@ -191,6 +193,115 @@ bool readFile(
   return readFile(fd, out, num_bytes);
 }
 
+class ParallelFileOptions {
+ public:
+  ParallelFileOptions() = default;
+
+  // Maximum number of threads issuing I/O, including the calling thread
+  size_t threads{4};
+  // Size of the ranges handed to each thread
+  size_t chunkSize{size_t(8) << 20};
+  // Reads only: the fd was (or, for readFileParallel(), should be) opened
+  // with O_DIRECT, so every read must use kDirectIOAlignment aligned buffers,
+  // offsets and lengths. Unaligned parts bounce through an aligned buffer.
+  bool directIO{false};
+
+  static constexpr size_t kDirectIOAlignment = 4096;
+
+  ParallelFileOptions& setThreads(size_t);
+  ParallelFileOptions& setChunkSize(size_t);
+  ParallelFileOptions& setDirectIO(bool);
+};
+
+/**
+ * Reads buf.size() bytes at offset from fd into buf, splitting the range into
+ * chunks read concurrently with pread() from up to options.threads threads.
+ * Meant for loading large files from fast storage, where a single reader
+ * cannot keep enough requests in flight.
+ *
+ * Returns the number of bytes read, which is less than buf.size() only if
+ * the file ends first, or -1 on error with errno set by the failing call.
+ */
+ssize_t preadParallel(
+    int fd,
+    MutableByteRange buf,
+    off_t offset,
+    const ParallelFileOptions& options = {});
+
+/**
+ * Writes data at offset to fd with pwrite() from up to options.threads
+ * threads. Returns data.size() on success or -1 with errno set.
+ */
+ssize_t pwriteParallel(
+    int fd,
+    ByteRange data,
+    off_t offset,
+    const ParallelFileOptions& options = {});
+
+/**
+ * Same as readFile(file_name, out), but reads regular files with
+ * preadParallel() straight into the preallocated container. Files that
+ * don't report their size (e.g. under /proc) are read sequentially.
+ *
+ * With options.directIO the file is opened with O_DIRECT, bypassing the page
+ * cache; filesystems that don't support it fall back to buffered reads.
+ */
+template <class Container>
+bool readFileParallel(
+    const char* file_name,
+    Container& out,
+    const ParallelFileOptions& options = {}) {
+  static_assert(
+      sizeof(out[0]) == 1,
+      "readFileParallel: only containers with byte-sized elements accepted");
+  assert(file_name);
+
+  auto opts = options;
+  int fd = -1;
+#ifdef O_DIRECT
+  if (opts.directIO) {
+    fd = openNoInt(file_name, O_RDONLY | O_CLOEXEC | O_DIRECT);
+    if (fd == -1 && errno != EINVAL) {
+      return false;
+    }
+  }
+#endif
+  if (fd == -1) {
+    opts.directIO = false;
+    fd = openNoInt(file_name, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+      return false;
+    }
+  }
+  SCOPE_EXIT {
+    // Ignore errors when closing the file
+    closeNoInt(fd);
+  };
+
+  struct stat buf;
+  if (fstat(fd, &buf) == -1) {
+    return false;
+  }
+  if (!S_ISREG(buf.st_mode) || buf.st_size <= 0) {
+    out.clear();
+    return opts.directIO ? readFile(file_name, out) : readFile(fd, out);
+  }
+
+  out.resize(size_t(buf.st_size));
+  auto n = preadParallel(
+      fd,
+      MutableByteRange(reinterpret_cast<unsigned char*>(&out[0]), out.size()),
+      0,
+      opts);
+  if (n == -1) {
+    out.clear();
+    return false;
+  }
+  // The file may have been truncated while reading
+  out.resize(size_t(n));
+  return true;
+}
+
 /**
  * Writes container to file. The container is assumed to be
  * contiguous, with element size equal to 1, and offering STL-like
@@ -237,6 +348,7 @@ class WriteFileAtomicOptions {
   mode_t permissions{0644};
   SyncType syncType{SyncType::WITHOUT_SYNC};
   std::string temporaryDirectory;
+  ParallelFileOptions parallel{ParallelFileOptions{}.setThreads(1)};
 
   // The mode bits used for the temporary file
   WriteFileAtomicOptions& setPermissions(mode_t);
@@ -255,6 +367,12 @@ class WriteFileAtomicOptions {
   // within this directory.  The temporary filenames themselves are
   // implementation defined.
   WriteFileAtomicOptions& setTemporaryDirectory(std::string);
+
+  // With more than one thread, data is written to the temporary file with
+  // pwriteParallel() instead of a single writev(). With WITH_SYNC, each
+  // chunk's writeback is started as soon as it is written, so the final
+  // fsync() only waits for the tail.
+  WriteFileAtomicOptions& setParallel(ParallelFileOptions);
 };
 
 /*
@@ -42,7 +42,9 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include <folly/Range.h>
 
@@ -89,12 +91,14 @@ FOLLY_DECLARE_FINGERPRINT_TABLES(128);
 
 } // namespace detail
 
+template <int BITS>
+class RollingFingerprint;
+
 /**
  * Compute the Rabin fingerprint.
  *
- * TODO(tudorb): Extend this to allow removing values from the computed
- * fingerprint (so we can fingerprint a sliding window, as in the Rabin-Karp
- * string matching algorithm)
+ * To fingerprint a sliding window, as in the Rabin-Karp string matching
+ * algorithm, use RollingFingerprint.
  *
  * update* methods return *this, so you can chain them together:
  * Fingerprint<96>().update8(x).update(str).update64(val).write(output);
@@ -179,9 +183,105 @@ class Fingerprint {
   uint32_t shlor32(uint32_t v);
   uint64_t shlor64(uint64_t v);
 
+  template <int>
+  friend class RollingFingerprint;
+
   uint64_t fp_[detail::poly_size(BITS)];
 };
 
+/**
+ * Compute the Rabin fingerprint of the last window() bytes of a stream.
+ *
+ * After every roll(), write() gives the same value as a Fingerprint<BITS>
+ * updated with just the last window() bytes rolled in (or with all of them,
+ * until there are that many).
+ *
+ * Fingerprints are linear over GF(2), so the byte b that leaves the window
+ * takes b * x^(8 * window) mod P away from the fingerprint. That is looked
+ * up in a table computed at construction, so a roll costs two table
+ * lookups, the same as update8() plus one.
+ */
+template <int BITS>
+class RollingFingerprint {
+ public:
+  explicit RollingFingerprint(size_t window) : bytes_(window) {
+    // outTab_[b] removes b, and also the difference the longer history
+    // makes to the contribution of the starting value.
+    auto zeros = [&](size_t n) {
+      Fingerprint<BITS> fp;
+      for (size_t i = 0; i < n; i++) {
+        fp.update8(0);
+      }
+      return fp;
+    };
+    auto const base = zeros(window);
+    auto const shifted = zeros(window + 1);
+    std::array<Value, 8> bitTab;
+    for (int k = 0; k < 8; k++) {
+      Fingerprint<BITS> fp;
+      fp.update8(uint8_t(1 << k));
+      for (size_t i = 0; i < window; i++) {
+        fp.update8(0);
+      }
+      for (int i = 0; i < size(); i++) {
+        bitTab[k][i] = fp.fp_[i] ^ shifted.fp_[i];
+      }
+    }
+    for (int b = 0; b < 256; b++) {
+      for (int i = 0; i < size(); i++) {
+        outTab_[b][i] = shifted.fp_[i] ^ base.fp_[i];
+        for (int k = 0; k < 8; k++) {
+          if (b & (1 << k)) {
+            outTab_[b][i] ^= bitTab[k][i];
+          }
+        }
+      }
+    }
+  }
+
+  RollingFingerprint& roll(uint8_t in) {
+    if (bytes_.empty()) {
+      return *this;
+    }
+    fp_.update8(in);
+    if (filled_ == bytes_.size()) {
+      fp_.xortab(outTab_[bytes_[pos_]]);
+    } else {
+      filled_++;
+    }
+    bytes_[pos_] = in;
+    if (++pos_ == bytes_.size()) {
+      pos_ = 0;
+    }
+    return *this;
+  }
+
+  RollingFingerprint& roll(StringPiece str) {
+    for (auto c : str) {
+      roll(uint8_t(c));
+    }
+    return *this;
+  }
+
+  size_t window() const { return bytes_.size(); }
+
+  constexpr static int size() { return Fingerprint<BITS>::size(); }
+
+  /**
+   * Write the fingerprint of the window, as Fingerprint<BITS>::write().
+   */
+  void write(uint64_t* out) const { fp_.write(out); }
+
+ private:
+  using Value = std::array<uint64_t, detail::poly_size(BITS)>;
+
+  Fingerprint<BITS> fp_;
+  std::array<Value, 256> outTab_;
+  std::vector<uint8_t> bytes_; // ring buffer of the window
+  size_t pos_ = 0; // next byte of bytes_ to replace
+  size_t filled_ = 0;
+};
+
 // Convenience functions
 
 /**
@@ -295,6 +295,29 @@ void baseFormatterCallImpl(
   }
 }
 
+// As baseFormatterCallImpl(), for a format string parsed at compile time,
+// where only the dynamic field widths remain to be checked.
+template <class Output>
+void baseFormatterCallSegmentsImpl(
+    Output& out,
+    const int widths[],
+    BaseFormatterBase::DoFormatFn<Output>* const funs[],
+    const BaseFormatterBase& base) {
+  for (auto const& segment : base.segments_) {
+    if (segment.argIndex < 0) {
+      out(segment.literal);
+      continue;
+    }
+    FormatArg arg = segment.arg;
+    if (segment.widthArgIndex >= 0) {
+      auto w = widths[segment.widthArgIndex];
+      arg.enforce(w >= 0, "dynamic field width argument must be integral");
+      arg.width = w;
+    }
+    funs[segment.argIndex](base, arg, out);
+  }
+}
+
 } // namespace detail
 
 template <class Derived, bool containerMode, size_t... I, class... Args>
@@ -311,6 +334,10 @@ void BaseFormatterImpl<
   constexpr auto in = unsafe_default_initialized;
   int widths[nargs + 1] = {conditional_t<!alignof(Args), int, int>{in}..., in};
   getSizeArg(widths);
+  if (!segments_.empty()) {
+    detail::baseFormatterCallSegmentsImpl(out, widths, funs.data, *this);
+    return;
+  }
   detail::baseFormatterCallImpl<containerMode, RecordUsedSizeArgs::value>(
       out, nargs, widths, *used, funs.data, *this);
 }
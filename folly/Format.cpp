@@ -28,21 +28,6 @@
 namespace folly {
 namespace detail {
 
-//  ctor for items in the align table
-struct format_table_align_make_item {
-  static constexpr std::size_t size = 256;
-  constexpr FormatArg::Align operator()(std::size_t index) const {
-    // clang-format off
-    return
-        index == '<' ? FormatArg::Align::LEFT:
-        index == '>' ? FormatArg::Align::RIGHT :
-        index == '=' ? FormatArg::Align::PAD_AFTER_SIGN :
-        index == '^' ? FormatArg::Align::CENTER :
-        FormatArg::Align::INVALID;
-    // clang-format on
-  }
-};
-
 //  ctor for items in the conv tables for representing parts of nonnegative
 //  integers into ascii digits of length Size, over a given base Base
 template <std::size_t Base, std::size_t Size, bool Upper = false>
@@ -63,25 +48,7 @@ struct format_table_conv_make_item {
   }
 };
 
-//  ctor for items in the sign table
-struct format_table_sign_make_item {
-  static constexpr std::size_t size = 256;
-  constexpr FormatArg::Sign operator()(std::size_t index) const {
-    // clang-format off
-    return
-        index == '+' ? FormatArg::Sign::PLUS_OR_MINUS :
-        index == '-' ? FormatArg::Sign::MINUS :
-        index == ' ' ? FormatArg::Sign::SPACE_OR_MINUS :
-        FormatArg::Sign::INVALID;
-    // clang-format on
-  }
-};
-
 //  the tables
-FOLLY_STORAGE_CONSTEXPR auto formatAlignTable =
-    make_array_with<256>(format_table_align_make_item{});
-FOLLY_STORAGE_CONSTEXPR auto formatSignTable =
-    make_array_with<256>(format_table_sign_make_item{});
 FOLLY_STORAGE_CONSTEXPR decltype(formatHexLower) formatHexLower =
     make_array_with<256>(format_table_conv_make_item<16, 2, false>{});
 FOLLY_STORAGE_CONSTEXPR decltype(formatHexUpper) formatHexUpper =
@@ -229,164 +196,6 @@ void FormatValue<double>::formatHelper(
   piece = fbstring(p, size_t(len));
 }
 
-void FormatArg::initSlow() {
-  auto b = fullArgString.begin();
-  auto end = fullArgString.end();
-
-  // Parse key
-  auto p = static_cast<const char*>(memchr(b, ':', size_t(end - b)));
-  if (!p) {
-    key_ = StringPiece(b, end);
-    return;
-  }
-  key_ = StringPiece(b, p);
-
-  if (*p == ':') {
-    // parse format spec
-    if (++p == end) {
-      return;
-    }
-
-    // fill/align, or just align
-    Align a;
-    if (p + 1 != end &&
-        (a = formatAlignTable[static_cast<unsigned char>(p[1])]) !=
-            Align::INVALID) {
-      fill = *p;
-      align = a;
-      p += 2;
-      if (p == end) {
-        return;
-      }
-    } else if (
-        (a = formatAlignTable[static_cast<unsigned char>(*p)]) !=
-        Align::INVALID) {
-      align = a;
-      if (++p == end) {
-        return;
-      }
-    }
-
-    Sign s;
-    auto uSign = static_cast<unsigned char>(*p);
-    if ((s = formatSignTable[uSign]) != Sign::INVALID) {
-      sign = s;
-      if (++p == end) {
-        return;
-      }
-    }
-
-    if (*p == '#') {
-      basePrefix = true;
-      if (++p == end) {
-        return;
-      }
-    }
-
-    if (*p == '0') {
-      enforce(align == Align::DEFAULT, "alignment specified twice");
-      fill = '0';
-      align = Align::PAD_AFTER_SIGN;
-      if (++p == end) {
-        return;
-      }
-    }
-
-    auto readInt = [&] {
-      auto const c = p;
-      do {
-        ++p;
-      } while (p != end && *p >= '0' && *p <= '9');
-      return to<int>(StringPiece(c, p));
-    };
-
-    if (*p == '*') {
-      width = kDynamicWidth;
-      ++p;
-
-      if (p == end) {
-        return;
-      }
-
-      if (*p >= '0' && *p <= '9') {
-        widthIndex = readInt();
-      }
-
-      if (p == end) {
-        return;
-      }
-    } else if (*p >= '0' && *p <= '9') {
-      width = readInt();
-
-      if (p == end) {
-        return;
-      }
-    }
-
-    if (*p == ',') {
-      thousandsSeparator = true;
-      if (++p == end) {
-        return;
-      }
-    }
-
-    if (*p == '.') {
-      auto d = ++p;
-      while (p != end && *p >= '0' && *p <= '9') {
-        ++p;
-      }
-      if (p != d) {
-        precision = to<int>(StringPiece(d, p));
-        if (p != end && *p == '.') {
-          trailingDot = true;
-          ++p;
-        }
-      } else {
-        trailingDot = true;
-      }
-
-      if (p == end) {
-        return;
-      }
-    }
-
-    presentation = *p;
-    if (++p == end) {
-      return;
-    }
-  }
-
-  error("extra characters in format string");
-}
-
-void FormatArg::validate(Type type) const {
-  enforce(keyEmpty(), "index not allowed");
-  switch (type) {
-    case Type::INTEGER:
-      enforce(
-          precision == kDefaultPrecision, "precision not allowed on integers");
-      break;
-    case Type::FLOAT:
-      enforce(
-          !basePrefix, "base prefix ('#') specifier only allowed on integers");
-      enforce(
-          !thousandsSeparator,
-          "thousands separator (',') only allowed on integers");
-      break;
-    case Type::OTHER:
-      enforce(
-          align != Align::PAD_AFTER_SIGN,
-          "'='alignment only allowed on numbers");
-      enforce(sign == Sign::DEFAULT, "sign specifier only allowed on numbers");
-      enforce(
-          !basePrefix, "base prefix ('#') specifier only allowed on integers");
-      enforce(
-          !thousandsSeparator,
-          "thousands separator (',') only allowed on integers");
-      break;
-  }
-}
-
 namespace detail {
 void insertThousandsGroupingUnsafe(char* start_buffer, char** end_buffer) {
   auto remaining_digits = uint32_t(*end_buffer - start_buffer);
@@ -33,6 +33,8 @@
 #pragma once
 #define FOLLY_FORMAT_H_
 
+#include <array>
+#include <climits>
 #include <cstdio>
 #include <ios>
 #include <stdexcept>
@@ -61,16 +63,31 @@ template <class C>
 Formatter<true, C> vformat(StringPiece fmt, C&& container);
 template <class T, class Enable = void>
 class FormatValue;
+template <class S>
+struct StaticFormat;
 
 // meta-attribute to identify formatters in this sea of template weirdness
 namespace detail {
 class FormatterTag {};
 
+// A piece of a format string parsed at compile time: either literal text or
+// an argument, with its spec already parsed.
+struct FormatSegment {
+  StringPiece literal;
+  int argIndex = -1; // -1 for literal text
+  int widthArgIndex = -1; // the argument giving a dynamic width, if any
+  FormatArg arg{StringPiece()};
+};
+
 struct BaseFormatterBase {
   template <class Callback>
   using DoFormatFn = void(const BaseFormatterBase&, FormatArg&, Callback&);
 
   StringPiece str_;
+  // str_ parsed at compile time, for FOLLY_FMT format strings
+  Range<const FormatSegment*> segments_{};
+  // Bytes to reserve when appending to a string
+  size_t sizeHint_{0};
 
   static std::false_type recordUsedArg(const BaseFormatterBase&, size_t) {
     return {};
@@ -142,6 +159,9 @@ class BaseFormatterImpl<
   template <class Str>
   typename std::enable_if<IsSomeString<Str>::value>::type appendTo(
       Str& str) const {
+    if (sizeHint_) {
+      str.reserve(str.size() + sizeHint_);
+    }
     detail::BaseFormatterAppendToString<Str> out{str};
     (*this)(out);
   }
@@ -190,6 +210,14 @@ class BaseFormatterImpl<
       : detail::BaseFormatterBase{str},
         values_(std::in_place, static_cast<Args&&>(args)...) {}
 
+  BaseFormatterImpl(
+      StringPiece str,
+      Range<const detail::FormatSegment*> segments,
+      size_t sizeHint,
+      Args&&... args)
+      : detail::BaseFormatterBase{str, segments, sizeHint},
+        values_(std::in_place, static_cast<Args&&>(args)...) {}
+
   // Not copyable
   BaseFormatterImpl(const BaseFormatterImpl&) = delete;
   BaseFormatterImpl& operator=(const BaseFormatterImpl&) = delete;
@@ -249,10 +277,284 @@ class Formatter : public BaseFormatter<
       Str* out, StringPiece fmt, A&&... args);
   template <class... A>
   friend std::string sformat(StringPiece fmt, A&&... arg);
+  template <class S, class... A>
+  friend Formatter<false, A...> format(StaticFormat<S> fmt, A&&... arg);
   template <class C>
   friend Formatter<true, C> vformat(StringPiece fmt, C&& container);
 };
 
+/**
+ * A format string parsed, and checked against the types of the arguments, at
+ * compile time. Formatting then only copies the literal text and formats the
+ * arguments, and errors that format() would throw, such as a bad spec or a
+ * missing argument, fail to compile instead.
+ *
+ * std::string s = sformat(FOLLY_FMT("{} {:08x}"), name, id);
+ */
+#define FOLLY_FMT(fmt)                                             \
+  ([] {                                                            \
+    struct FollyFormatString {                                     \
+      static constexpr ::folly::StringPiece value() { return fmt; } \
+    };                                                             \
+    return ::folly::StaticFormat<FollyFormatString>{};             \
+  }())
+
+namespace detail {
+
+constexpr const char* formatFind(const char* b, const char* e, char c) {
+  for (; b != e && *b != c; ++b) {
+  }
+  return b;
+}
+
+// Split a format string into segments as baseFormatterCallImpl() would,
+// passing each to emit, and throw the same errors.
+template <class Emit>
+constexpr void formatParse(StringPiece str, Emit&& emit) {
+  auto emitLiteral = [&](const char* b, const char* e) {
+    FormatSegment segment;
+    segment.literal = StringPiece(b, e);
+    emit(segment);
+  };
+  // Translate "}}" to "}", and throw if we see any lone "}"
+  auto literal = [&](const char* b, const char* e) {
+    while (b != e) {
+      auto q = formatFind(b, e, '}');
+      if (q == e) {
+        emitLiteral(b, e);
+        break;
+      }
+      ++q;
+      emitLiteral(b, q);
+      b = q;
+      if (b == e || *b != '}') {
+        throw_exception<BadFormatArg>(
+            "folly::format: single '}' in format string");
+      }
+      ++b;
+    }
+  };
+
+  auto p = str.begin();
+  auto end = str.end();
+  int nextArg = 0;
+  bool hasDefaultArgIndex = false;
+  bool hasExplicitArgIndex = false;
+  while (p != end) {
+    auto q = formatFind(p, end, '{');
+    literal(p, q);
+    if (q == end) {
+      break;
+    }
+    p = q + 1;
+
+    if (p == end) {
+      throw_exception<BadFormatArg>(
+          "folly::format: '}' at end of format string");
+    }
+
+    // "{{" -> "{"
+    if (*p == '{') {
+      emitLiteral(p, p + 1);
+      ++p;
+      continue;
+    }
+
+    q = formatFind(p, end, '}');
+    if (q == end) {
+      throw_exception<BadFormatArg>("folly::format: missing ending '}'");
+    }
+    FormatSegment segment;
+    segment.arg = FormatArg(StringPiece(p, q));
+    p = q + 1;
+
+    auto& arg = segment.arg;
+    auto piece = arg.splitKey<true>(); // empty key component is okay
+    if (piece.empty()) {
+      if (arg.width == FormatArg::kDynamicWidth) {
+        arg.enforce(
+            arg.widthIndex == FormatArg::kNoIndex,
+            "cannot provide width arg index without value arg index");
+        segment.widthArgIndex = nextArg++;
+      }
+      segment.argIndex = nextArg++;
+      hasDefaultArgIndex = true;
+    } else {
+      if (arg.width == FormatArg::kDynamicWidth) {
+        arg.enforce(
+            arg.widthIndex != FormatArg::kNoIndex,
+            "cannot provide value arg index without width arg index");
+        segment.widthArgIndex = arg.widthIndex;
+      }
+      arg.enforce(
+          *piece.begin() != '-', "argument index must be non-negative");
+      int index = 0;
+      for (char c : piece) {
+        arg.enforce(
+            c >= '0' && c <= '9' && index <= (INT_MAX - (c - '0')) / 10,
+            "argument index must be integer");
+        index = index * 10 + (c - '0');
+      }
+      segment.argIndex = index;
+      hasExplicitArgIndex = true;
+    }
+
+    if (hasDefaultArgIndex && hasExplicitArgIndex) {
+      throw_exception<BadFormatArg>(
+          "folly::format: may not have both default and explicit arg indexes");
+    }
+    emit(segment);
+  }
+}
+
+template <class S>
+constexpr size_t formatSegmentCount() {
+  size_t count = 0;
+  formatParse(S::value(), [&](const FormatSegment&) { ++count; });
+  return count;
+}
+
+template <class S>
+constexpr std::array<FormatSegment, formatSegmentCount<S>()> formatSegments() {
+  std::array<FormatSegment, formatSegmentCount<S>()> segments{};
+  size_t i = 0;
+  formatParse(S::value(), [&](const FormatSegment& segment) {
+    segments[i++] = segment;
+  });
+  return segments;
+}
+
+template <class S>
+inline constexpr auto formatSegmentsOf = formatSegments<S>();
+
+template <class S>
+constexpr size_t formatLiteralSize() {
+  size_t size = 0;
+  for (auto const& segment : formatSegmentsOf<S>) {
+    size += segment.literal.size();
+  }
+  return size;
+}
+
+constexpr bool formatIsOneOf(char c, StringPiece chars) {
+  return formatFind(chars.begin(), chars.end(), c) != chars.end();
+}
+
+// Check the spec of an argument against its type, for the types whose
+// FormatValue is known here; the same checks are made at runtime.
+template <class T>
+constexpr void formatCheckArg(const FormatArg& arg) {
+  if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value) {
+    arg.validate(FormatArg::Type::INTEGER);
+    arg.enforce(
+        arg.presentation == FormatArg::kDefaultPresentation ||
+            formatIsOneOf(arg.presentation, "ndcoOxXbB"),
+        "invalid specifier '",
+        arg.presentation,
+        "'");
+  } else if constexpr (std::is_floating_point<T>::value) {
+    arg.validate(FormatArg::Type::FLOAT);
+    arg.enforce(
+        arg.presentation == FormatArg::kDefaultPresentation ||
+            formatIsOneOf(arg.presentation, "%fFeEngG"),
+        "invalid specifier '",
+        arg.presentation,
+        "'");
+  } else if constexpr (
+      !std::is_pointer<T>::value && std::is_convertible<T, StringPiece>::value) {
+    if (arg.keyEmpty()) {
+      arg.validate(FormatArg::Type::OTHER);
+      arg.enforce(
+          arg.presentation == FormatArg::kDefaultPresentation ||
+              arg.presentation == 's',
+          "invalid specifier '",
+          arg.presentation,
+          "'");
+    }
+  }
+}
+
+template <class S, class... Args>
+constexpr bool formatCheckArgs() {
+  constexpr size_t nargs = sizeof...(Args);
+  constexpr bool integral[] = {
+      (std::is_integral<Args>::value && !std::is_same<Args, bool>::value)...,
+      false};
+  constexpr void (*checks[])(const FormatArg&) = {
+      &formatCheckArg<Args>..., nullptr};
+  for (auto const& segment : formatSegmentsOf<S>) {
+    if (segment.argIndex < 0) {
+      continue;
+    }
+    auto const& arg = segment.arg;
+    if (segment.widthArgIndex >= 0) {
+      auto const w = size_t(segment.widthArgIndex);
+      arg.enforce(w < nargs, "argument index out of range, max=", nargs);
+      arg.enforce(
+          integral[w], "dynamic field width argument must be integral");
+    }
+    auto const i = size_t(segment.argIndex);
+    arg.enforce(i < nargs, "argument index out of range, max=", nargs);
+    checks[i](arg);
+  }
+  return true;
+}
+
+template <class T>
+size_t formatEstimateSpace(const T& value) {
+  if constexpr (
+      std::is_arithmetic<T>::value ||
+      (!std::is_pointer<T>::value &&
+       std::is_convertible<T, StringPiece>::value)) {
+    return estimateSpaceNeeded(value);
+  } else {
+    return 0;
+  }
+}
+
+} // namespace detail
+
+/**
+ * The type of FOLLY_FMT(...), which see.
+ */
+template <class S>
+struct StaticFormat {
+  static constexpr StringPiece str() { return S::value(); }
+};
+
+/**
+ * As format() and sformat(), with a format string parsed at compile time.
+ *
+ * std::string formatted = sformat(FOLLY_FMT("{} {:>8}"), 23, "x");
+ */
+template <class S, class... Args>
+Formatter<false, Args...> format(StaticFormat<S> fmt, Args&&... args) {
+  static_assert(
+      detail::formatCheckArgs<S, std::decay_t<Args>...>(),
+      "invalid format string");
+  size_t sizeHint = detail::formatLiteralSize<S>();
+  using _ = int[];
+  void(_{(sizeHint += detail::formatEstimateSpace(args), 0)..., 0});
+  auto const& segments = detail::formatSegmentsOf<S>;
+  return Formatter<false, Args...>(
+      fmt.str(),
+      Range<const detail::FormatSegment*>(
+          segments.data(), segments.data() + segments.size()),
+      sizeHint,
+      static_cast<Args&&>(args)...);
+}
+
+template <class S, class... Args>
+inline std::string sformat(StaticFormat<S> fmt, Args&&... args) {
+  return format(fmt, static_cast<Args&&>(args)...).str();
+}
+
+template <class Str, class S, class... Args>
+typename std::enable_if<IsSomeString<Str>::value>::type format(
+    Str* out, StaticFormat<S> fmt, Args&&... args) {
+  format(fmt, static_cast<Args&&>(args)...).appendTo(*out);
+}
+
 namespace detail {
 template <typename Out>
 struct FormatterOstreamInsertionWriterFn {
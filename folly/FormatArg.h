@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <climits>
 #include <stdexcept>
 
 #include <folly/CPortability.h>
@@ -54,8 +55,11 @@ struct FormatArg {
   /**
    * Parse a format argument from a string.  Keeps a reference to the
    * passed-in string -- does not copy the given characters.
+   *
+   * Parsing is constexpr, so that format strings known at compile time can be
+   * parsed, and checked, then; see FOLLY_FMT in Format.h.
    */
-  explicit FormatArg(StringPiece sp)
+  constexpr explicit FormatArg(StringPiece sp)
       : fullArgString(sp),
         fill(kDefaultFill),
         align(Align::DEFAULT),
@@ -67,6 +71,7 @@ struct FormatArg {
         widthIndex(kNoIndex),
         precision(kDefaultPrecision),
         presentation(kDefaultPresentation),
+        nextIntKey_(0),
         nextKeyMode_(NextKeyMode::NONE) {
     if (!sp.empty()) {
       initSlow();
@@ -81,7 +86,7 @@ struct FormatArg {
   /**
    * Validate the argument for the given type; throws on error.
    */
-  void validate(Type type) const;
+  constexpr void validate(Type type) const;
 
   /**
    * Throw an exception if the first argument is false.  The exception
@@ -89,7 +94,7 @@ struct FormatArg {
    * arguments to enforce, formatted using folly::to<std::string>.
    */
   template <typename Check, typename... Args>
-  void enforce(Check const& v, Args&&... args) const {
+  constexpr void enforce(Check const& v, Args&&... args) const {
     static_assert(std::is_constructible<bool, Check>::value, "not castable");
     if (FOLLY_UNLIKELY(!v)) {
       error(static_cast<Args&&>(args)...);
@@ -176,12 +181,12 @@ struct FormatArg {
    * is thrown otherwise).
    */
   template <bool emptyOk = false>
-  StringPiece splitKey();
+  constexpr StringPiece splitKey();
 
   /**
    * Is the entire key empty?
    */
-  bool keyEmpty() const {
+  constexpr bool keyEmpty() const {
     return nextKeyMode_ == NextKeyMode::NONE && key_.empty();
   }
 
@@ -191,22 +196,59 @@ struct FormatArg {
    */
   int splitIntKey();
 
-  void setNextIntKey(int val) {
+  constexpr void setNextIntKey(int val) {
     assert(nextKeyMode_ == NextKeyMode::NONE);
     nextKeyMode_ = NextKeyMode::INT;
     nextIntKey_ = val;
   }
 
-  void setNextKey(StringPiece val) {
+  constexpr void setNextKey(StringPiece val) {
     assert(nextKeyMode_ == NextKeyMode::NONE);
     nextKeyMode_ = NextKeyMode::STRING;
     nextKey_ = val;
   }
 
  private:
-  void initSlow();
+  constexpr void initSlow();
   template <bool emptyOk>
-  StringPiece doSplitKey();
+  constexpr StringPiece doSplitKey();
+
+  static constexpr Align alignOf(char c) {
+    switch (c) {
+      case '<':
+        return Align::LEFT;
+      case '>':
+        return Align::RIGHT;
+      case '=':
+        return Align::PAD_AFTER_SIGN;
+      case '^':
+        return Align::CENTER;
+      default:
+        return Align::INVALID;
+    }
+  }
+
+  static constexpr Sign signOf(char c) {
+    switch (c) {
+      case '+':
+        return Sign::PLUS_OR_MINUS;
+      case '-':
+        return Sign::MINUS;
+      case ' ':
+        return Sign::SPACE_OR_MINUS;
+      default:
+        return Sign::INVALID;
+    }
+  }
+
+  static constexpr const char* find(const char* b, const char* e, char c) {
+    for (; b != e; ++b) {
+      if (*b == c) {
+        return b;
+      }
+    }
+    return nullptr;
+  }
 
   StringPiece key_;
   int nextIntKey_;
@@ -219,6 +261,161 @@ struct FormatArg {
   NextKeyMode nextKeyMode_;
 };
 
+constexpr void FormatArg::initSlow() {
+  auto b = fullArgString.begin();
+  auto end = fullArgString.end();
+
+  // Parse key
+  auto p = find(b, end, ':');
+  if (!p) {
+    key_ = StringPiece(b, end);
+    return;
+  }
+  key_ = StringPiece(b, p);
+
+  if (*p == ':') {
+    // parse format spec
+    if (++p == end) {
+      return;
+    }
+
+    // fill/align, or just align
+    Align a = Align::INVALID;
+    if (p + 1 != end && (a = alignOf(p[1])) != Align::INVALID) {
+      fill = *p;
+      align = a;
+      p += 2;
+      if (p == end) {
+        return;
+      }
+    } else if ((a = alignOf(*p)) != Align::INVALID) {
+      align = a;
+      if (++p == end) {
+        return;
+      }
+    }
+
+    Sign s = signOf(*p);
+    if (s != Sign::INVALID) {
+      sign = s;
+      if (++p == end) {
+        return;
+      }
+    }
+
+    if (*p == '#') {
+      basePrefix = true;
+      if (++p == end) {
+        return;
+      }
+    }
+
+    if (*p == '0') {
+      enforce(align == Align::DEFAULT, "alignment specified twice");
+      fill = '0';
+      align = Align::PAD_AFTER_SIGN;
+      if (++p == end) {
+        return;
+      }
+    }
+
+    // Digits, as to<int>() would read them, which also throws on overflow
+    auto readInt = [&] {
+      auto const c = p;
+      int value = 0;
+      bool overflow = false;
+      do {
+        overflow = overflow || value > (INT_MAX - (*p - '0')) / 10;
+        value = value * 10 + (overflow ? 0 : *p - '0');
+        ++p;
+      } while (p != end && *p >= '0' && *p <= '9');
+      return overflow ? to<int>(StringPiece(c, p)) : value;
+    };
+
+    if (*p == '*') {
+      width = kDynamicWidth;
+      ++p;
+
+      if (p == end) {
+        return;
+      }
+
+      if (*p >= '0' && *p <= '9') {
+        widthIndex = readInt();
+      }
+
+      if (p == end) {
+        return;
+      }
+    } else if (*p >= '0' && *p <= '9') {
+      width = readInt();
+
+      if (p == end) {
+        return;
+      }
+    }
+
+    if (*p == ',') {
+      thousandsSeparator = true;
+      if (++p == end) {
+        return;
+      }
+    }
+
+    if (*p == '.') {
+      ++p;
+      if (p != end && *p >= '0' && *p <= '9') {
+        precision = readInt();
+        if (p != end && *p == '.') {
+          trailingDot = true;
+          ++p;
+        }
+      } else {
+        trailingDot = true;
+      }
+
+      if (p == end) {
+        return;
+      }
+    }
+
+    presentation = *p;
+    if (++p == end) {
+      return;
+    }
+  }
+
+  error("extra characters in format string");
+}
+
+constexpr void FormatArg::validate(Type type) const {
+  enforce(keyEmpty(), "index not allowed");
+  switch (type) {
+    case Type::INTEGER:
+      enforce(
+          precision == kDefaultPrecision, "precision not allowed on integers");
+      break;
+    case Type::FLOAT:
+      enforce(
+          !basePrefix, "base prefix ('#') specifier only allowed on integers");
+      enforce(
+          !thousandsSeparator,
+          "thousands separator (',') only allowed on integers");
+      break;
+    case Type::OTHER:
+      enforce(
+          align != Align::PAD_AFTER_SIGN,
+          "'='alignment only allowed on numbers");
+      enforce(sign == Sign::DEFAULT, "sign specifier only allowed on numbers");
+      enforce(
+          !basePrefix, "base prefix ('#') specifier only allowed on integers");
+      enforce(
+          !thousandsSeparator,
+          "thousands separator (',') only allowed on integers");
+      break;
+  }
+}
+
 template <typename... Args>
 [[noreturn]] inline void FormatArg::error(Args&&... args) const {
   // take advantage of throw_exception decaying char const (&)[N} to char const*
@@ -228,13 +425,13 @@ template <typename... Args>
 }
 
 template <bool emptyOk>
-inline StringPiece FormatArg::splitKey() {
+constexpr StringPiece FormatArg::splitKey() {
   enforce(nextKeyMode_ != NextKeyMode::INT, "integer key expected");
   return doSplitKey<emptyOk>();
 }
 
 template <bool emptyOk>
-inline StringPiece FormatArg::doSplitKey() {
+constexpr StringPiece FormatArg::doSplitKey() {
   if (nextKeyMode_ == NextKeyMode::STRING) {
     nextKeyMode_ = NextKeyMode::NONE;
     if (!emptyOk) { // static
@@ -252,19 +449,19 @@ inline StringPiece FormatArg::doSplitKey() {
 
   const char* b = key_.begin();
   const char* e = key_.end();
-  const char* p;
+  const char* p = nullptr;
   if (e[-1] == ']') {
     --e;
-    p = static_cast<const char*>(memchr(b, '[', size_t(e - b)));
+    p = find(b, e, '[');
     enforce(p != nullptr, "unmatched ']'");
   } else {
-    p = static_cast<const char*>(memchr(b, '.', size_t(e - b)));
+    p = find(b, e, '.');
   }
   if (p) {
-    key_.assign(p + 1, e);
+    key_ = StringPiece(p + 1, e);
   } else {
     p = e;
-    key_.clear();
+    key_ = StringPiece();
   }
   if (!emptyOk) { // static
     enforce(b != p, "non-empty key required");
@@ -214,6 +214,7 @@
 #include <folly/lang/Align.h>
 #include <folly/lang/Exception.h>
 #include <folly/lang/New.h>
+#include <folly/memory/SmallObjectAllocator.h>
 
 namespace folly {
 
@@ -520,7 +521,7 @@ struct DispatchBigTrivial {
         IsAlignLarge
             ? operator_delete(
                   src->big, src->bigt.size, std::align_val_t(src->bigt.align))
-            : operator_delete(src->big, src->bigt.size);
+            : SmallObjectAllocator::deallocate(src->big, src->bigt.size);
         break;
       case Op::HEAP:
         break;
@@ -537,15 +538,59 @@ struct DispatchBigTrivial {
       std::size_t align) noexcept {
     // cannot use type-specific new since type-specific new is overrideable
     // in concert with type-specific delete
-    data.bigt.big = is_align_large(align)
-        ? operator_new(size, std::align_val_t(align))
-        : operator_new(size);
+    if (is_align_large(align)) {
+      data.bigt.big = operator_new(size, std::align_val_t(align));
+    } else if (align <= SmallObjectAllocator::kAlign) {
+      data.bigt.big = smallObjectAllocate(size);
+    } else {
+      data.bigt.big = operator_new(size);
+    }
     data.bigt.size = size;
     data.bigt.align = align;
     std::memcpy(data.bigt.big, fun, size);
   }
 };
 
+template <typename Fun, typename = void>
+constexpr bool HasClassNew = false;
+template <typename Fun>
+constexpr bool HasClassNew<Fun, std::void_t<decltype(Fun::operator new(0))>> =
+    true;
+
+// Heap storage for a non-trivial Fun: from SmallObjectAllocator if the global
+// policy opts in, unless Fun brings its own operator new.
+template <typename Fun, typename... A>
+Fun* newBig(A&&... a) {
+  if constexpr (
+      sizeof(Fun) <= SmallObjectAllocator::kMaxSize &&
+      alignof(Fun) <= SmallObjectAllocator::kAlign && !HasClassNew<Fun>) {
+    if (SmallObjectAllocator::useForInternals()) {
+      struct Storage {
+        void* p = SmallObjectAllocator::allocate(sizeof(Fun));
+        ~Storage() { SmallObjectAllocator::deallocate(p, sizeof(Fun)); }
+      } storage; // freed if the ctor throws
+      auto fun = ::new (storage.p) Fun(static_cast<A&&>(a)...);
+      storage.p = nullptr;
+      return fun;
+    }
+  }
+  return new Fun(static_cast<A&&>(a)...);
+}
+
+template <typename Fun>
+void deleteBig(Fun* fun) noexcept {
+  if constexpr (
+      sizeof(Fun) <= SmallObjectAllocator::kMaxSize &&
+      alignof(Fun) <= SmallObjectAllocator::kAlign && !HasClassNew<Fun>) {
+    if (SmallObjectAllocator::owns(fun)) {
+      fun->~Fun();
+      SmallObjectAllocator::deallocate(fun, sizeof(Fun));
+      return;
+    }
+  }
+  delete fun;
+}
+
 struct DispatchSmall {
   static constexpr bool is_in_situ = true;
   static constexpr bool is_trivial = false;
@@ -579,7 +624,7 @@ struct DispatchBig {
         src->big = nullptr;
         break;
       case Op::NUKE:
-        delete static_cast<Fun*>(src->big);
+        deleteBig(static_cast<Fun*>(src->big));
         break;
       case Op::HEAP:
         break;
@@ -648,7 +693,7 @@ class Function final : private detail::function::FunctionTraits<FunctionType> {
   Function(Function<Signature>&& fun, CoerceTag) {
     using Fun = Function<Signature>;
     if (fun) {
-      data_.big = new Fun(static_cast<Fun&&>(fun));
+      data_.big = detail::function::newBig<Fun>(static_cast<Fun&&>(fun));
       call_ = Traits::template call<Fun, false>;
       exec_ = Exec(detail::function::DispatchBig::exec<Fun>);
     }
@@ -737,7 +782,7 @@ class Function final : private detail::function::FunctionTraits<FunctionType> {
       if constexpr (Dispatch::is_trivial) {
         Dispatch::ctor(data_, &fun, sizeof(Fun), alignof(Fun));
       } else {
-        data_.big = new Fun(static_cast<Fun&&>(fun));
+        data_.big = detail::function::newBig<Fun>(static_cast<Fun&&>(fun));
       }
     }
     call_ = Traits::template call<Fun, Dispatch::is_in_situ>;
@@ -88,6 +88,10 @@ class IPAddress {
       return IPAddress();
     }
     std::string str() const { return ""; }
+    size_t toBuffer(char* out) const noexcept {
+      (void)out;
+      return 0;
+    }
     std::string toFullyQualified() const { return ""; }
     void toFullyQualifiedAppend(std::string& out) const {
       (void)out;
@@ -540,6 +544,14 @@ class IPAddress {
     return pick([&](auto& _) { return _.str(); });
   }
 
+  /**
+   * Writes str() to `out`, without a terminating NUL, and returns its
+   * length. `out` must have room for IPAddressV6::kMaxStrSize characters.
+   */
+  size_t toBuffer(char* out) const {
+    return pick([&](auto& _) { return _.toBuffer(out); });
+  }
+
   /**
    * Return the fully qualified string representation of the address.
    *
@@ -66,9 +66,9 @@ IPAddressV4 IPAddressV4::fromLongHBO(uint32_t src) {
 
 // static public
 uint32_t IPAddressV4::toLong(StringPiece ip) {
-  auto str = ip.str();
   in_addr addr;
-  if (inet_pton(AF_INET, str.c_str(), &addr) != 1) {
+  if (!detail::tryParseIpv4(
+          ip.begin(), ip.end(), reinterpret_cast<uint8_t*>(&addr))) {
     throw IPAddressFormatException(
         fmt::format("Can't convert invalid IP '{}' to long", ip));
   }
@@ -98,11 +98,11 @@ IPAddressV4::IPAddressV4(StringPiece addr) : addr_() {
 
 Expected<IPAddressV4, IPAddressFormatError> IPAddressV4::tryFromString(
     StringPiece str) noexcept {
-  struct in_addr inAddr;
-  if (inet_pton(AF_INET, str.str().c_str(), &inAddr) != 1) {
+  ByteArray4 bytes;
+  if (!detail::tryParseIpv4(str.begin(), str.end(), bytes.data())) {
     return makeUnexpected(IPAddressFormatError::INVALID_IP);
   }
-  return IPAddressV4(inAddr);
+  return IPAddressV4(bytes);
 }
 
 // in_addr constructor
@@ -257,6 +257,11 @@ string IPAddressV4::str() const {
   return detail::fastIpv4ToString(addr_.inAddr_);
 }
 
+// public
+size_t IPAddressV4::toBuffer(char* out) const noexcept {
+  return detail::fastIpV4ToBufferUnsafe(addr_.inAddr_, out);
+}
+
 // public
 void IPAddressV4::toFullyQualifiedAppend(std::string& out) const {
   detail::fastIpv4AppendToString(addr_.inAddr_, out);
@@ -297,6 +297,12 @@ class IPAddressV4 {
    */
   std::string str() const;
 
+  /**
+   * Writes str() to `out`, without a terminating NUL, and returns its
+   * length. `out` must have room for kMaxToFullyQualifiedSize characters.
+   */
+  size_t toBuffer(char* out) const noexcept;
+
   /**
    * Create the inverse arpa representation of the IP address.
    *
@@ -96,6 +96,16 @@ Expected<IPAddressV6, IPAddressFormatError> IPAddressV6::tryFromString(
       ? str.subpiece(1, std::min(str.size() - 2, kMaxSize))
       : str.subpiece(0, std::min(str.size(), kMaxSize));
 
+  // Only scoped addresses ("fe80::1%eth0") need getaddrinfo(), to look up
+  // the interface.
+  if (std::find(ip.begin(), ip.end(), '%') == ip.end()) {
+    ByteArray16 bytes;
+    if (!detail::tryParseIpv6(ip.begin(), ip.end(), bytes.data())) {
+      return makeUnexpected(IPAddressFormatError::INVALID_IP);
+    }
+    return IPAddressV6(bytes);
+  }
+
   std::array<char, kMaxSize + 1> ipBuffer;
   std::copy(ip.begin(), ip.end(), ipBuffer.begin());
   ipBuffer[ip.size()] = '\0';
@@ -443,30 +453,35 @@ IPAddressV6 IPAddressV6::mask(size_t numBits) const {
 
 // public
 string IPAddressV6::str() const {
-  char buffer[INET6_ADDRSTRLEN + IFNAMSIZ + 1];
+  char buffer[kMaxStrSize];
+  return string(buffer, toBuffer(buffer));
+}
 
-  if (!inet_ntop(AF_INET6, toAddr().s6_addr, buffer, INET6_ADDRSTRLEN)) {
-    throw IPAddressFormatException(fmt::format(
-        "Invalid address with hex '{}' with error {}",
-        detail::Bytes::toHex(bytes(), 16),
-        errnoStr(errno)));
-  }
+// public
+size_t IPAddressV6::toBuffer(char* out) const {
+  size_t len = detail::fastIpv6ToCompressedBufferUnsafe(addr_.in6Addr_, out);
 
   auto scopeId = getScopeId();
   if (scopeId != 0) {
-    auto len = strlen(buffer);
-    buffer[len] = '%';
+    out[len++] = '%';
 
+    char ifName[IFNAMSIZ];
     auto errsv = errno;
-    if (!if_indextoname(scopeId, buffer + len + 1)) {
+    if (if_indextoname(scopeId, ifName)) {
+      size_t ifLen = strnlen(ifName, IFNAMSIZ - 1);
+      memcpy(out + len, ifName, ifLen);
+      len += ifLen;
+    } else {
       // if we can't map the if because eg. it no longer exists,
       // append the if index instead
-      snprintf(buffer + len + 1, IFNAMSIZ, "%u", scopeId);
+      char* end = out + len;
+      detail::writeIntegerString<uint32_t, 10>(scopeId, &end);
+      len = end - out;
     }
     errno = errsv;
   }
 
-  return string(buffer);
+  return len;
 }
 
 // public
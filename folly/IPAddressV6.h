@@ -99,6 +99,13 @@ class IPAddressV6 {
   static constexpr size_t kToFullyQualifiedSize =
       8 /*words*/ * 4 /*hex chars per word*/ + 7 /*separators*/;
 
+  /**
+   * Max size of the std::string returned by str(): an IPv4-mapped address
+   * with a scope interface name.
+   */
+  static constexpr size_t kMaxStrSize = 6 /*words*/ * 4 /*hex chars*/ +
+      6 /*separators*/ + 15 /*IPv4 tail*/ + 1 /*%*/ + 15 /*interface name*/;
+
   /**
    * Return true if the input string can be parsed as an IPv6 addres
    */
@@ -435,14 +442,20 @@ class IPAddressV6 {
   std::string toInverseArpaName() const;
 
   /**
-   * Provides a string representation of address.
-   *
-   * Throws an IPAddressFormatException on `inet_ntop` error.
+   * Provides a string representation of address, in the form inet_ntop()
+   * produces, followed by "%" and the interface name or index if the
+   * address has a scope id.
    *
    * The string representation is calculated on demand.
    */
   std::string str() const;
 
+  /**
+   * Writes str() to `out`, without a terminating NUL, and returns its
+   * length. `out` must have room for kMaxStrSize characters.
+   */
+  size_t toBuffer(char* out) const;
+
   /**
    * Returns the version of the IP Address.
    *
@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <folly/IPAddress.h>
+#include <folly/Optional.h>
+#include <folly/ScopeGuard.h>
+#include <folly/synchronization/Rcu.h>
+
+namespace folly {
+
+/**
+ * IPPrefixTable maps IPv4 and IPv6 networks (CIDRNetwork) to values, and
+ * finds the value of the longest network that contains an address.
+ *
+ * Lookups are lock-free and wait-free, and take one memory access per byte
+ * of the address at most: each address family has a multibit trie with a
+ * stride of 8 bits, in which a network of length L is expanded to the
+ * 2^(8 - L % 8) slots it covers in the node for its last byte (controlled
+ * prefix expansion). A lookup walks down the trie one byte at a time and
+ * keeps the last value it passed, so an IPv4 lookup reads at most four
+ * nodes.
+ *
+ * Updates never block lookups. Writers are serialized, copy the nodes they
+ * change, publish the new trie with a single atomic store, and retire the
+ * replaced nodes and values through RCU, once no lookup can still see them.
+ * update() applies many changes with one publication, modifying the nodes
+ * it has already copied in place.
+ *
+ * IPv4-mapped IPv6 addresses are looked up as IPv6 addresses.
+ *
+ * Example:
+ *   IPPrefixTable<uint32_t> routes;
+ *   routes.insert(IPAddress::createNetwork("10.0.0.0/8"), 1);
+ *   routes.insert(IPAddress::createNetwork("10.1.0.0/16"), 2);
+ *   routes.lookup(IPAddress("10.1.2.3")); // 2
+ *   routes.lookup(IPAddress("10.2.3.4")); // 1
+ *   routes.lookup(IPAddress("11.0.0.1")); // none
+ *
+ * Value must be copy constructible. Values replaced or erased are destroyed
+ * on the RCU domain's executor.
+ */
+template <typename Value>
+class IPPrefixTable {
+  struct Entry;
+  struct Node;
+  struct Root;
+
+ public:
+  /**
+   * Applies changes to an IPPrefixTable as part of one update().
+   */
+  class Updater {
+   public:
+    /**
+     * Maps `network` to `value`, replacing the value it had if any. The
+     * address is masked to the network's length first. Returns true if the
+     * network was not in the table before.
+     *
+     * @throws std::invalid_argument if the address is neither IPv4 nor IPv6,
+     *         or the length exceeds its bit count.
+     */
+    bool insert(const CIDRNetwork& network, Value value) {
+      return table_.insertImpl(network, std::move(value));
+    }
+
+    /**
+     * Removes `network`. Returns false if it was not in the table.
+     */
+    bool erase(const CIDRNetwork& network) {
+      return table_.eraseImpl(network);
+    }
+
+   private:
+    friend class IPPrefixTable;
+    explicit Updater(IPPrefixTable& table) : table_(table) {}
+
+    IPPrefixTable& table_;
+  };
+
+  IPPrefixTable() : root_(new Root()) {}
+
+  IPPrefixTable(const IPPrefixTable&) = delete;
+  IPPrefixTable& operator=(const IPPrefixTable&) = delete;
+
+  /**
+   * There must be no concurrent lookups or updates.
+   */
+  ~IPPrefixTable() {
+    auto root = root_.load(std::memory_order_relaxed);
+    for (auto node : root->nodes) {
+      deleteTree(node);
+    }
+    delete root;
+    for (auto& entry : entries_) {
+      delete entry.second;
+    }
+  }
+
+  /**
+   * Returns the value of the longest network containing `addr`, if any.
+   */
+  Optional<Value> lookup(const IPAddress& addr) const {
+    std::scoped_lock<rcu_domain> guard(rcu_default_domain());
+    if (auto entry = find(addr)) {
+      return entry->value;
+    }
+    return none;
+  }
+
+  /**
+   * Returns the longest network containing `addr` and its value, if any.
+   */
+  Optional<std::pair<CIDRNetwork, Value>> lookupNetwork(
+      const IPAddress& addr) const {
+    std::scoped_lock<rcu_domain> guard(rcu_default_domain());
+    if (auto entry = find(addr)) {
+      return std::make_pair(entry->network, entry->value);
+    }
+    return none;
+  }
+
+  /**
+   * Same as Updater::insert(), published right away.
+   */
+  bool insert(const CIDRNetwork& network, Value value) {
+    bool inserted = false;
+    update([&](Updater& updater) {
+      inserted = updater.insert(network, std::move(value));
+    });
+    return inserted;
+  }
+
+  /**
+   * Same as Updater::erase(), published right away.
+   */
+  bool erase(const CIDRNetwork& network) {
+    bool erased = false;
+    update([&](Updater& updater) { erased = updater.erase(network); });
+    return erased;
+  }
+
+  /**
+   * Calls `func` with an Updater, and publishes all the changes it made at
+   * once: concurrent lookups see either none or all of them.
+   */
+  template <typename Func>
+  void update(Func&& func) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    auto oldRoot = root_.load(std::memory_order_relaxed);
+    ++generation_;
+    batchRoot_ = new Root(*oldRoot);
+    Updater updater(*this);
+    // Publish whatever was applied even if func throws, since the changes
+    // are already in entries_.
+    SCOPE_EXIT {
+      root_.store(batchRoot_, std::memory_order_release);
+      batchRoot_ = nullptr;
+      rcu_retire(oldRoot);
+      for (auto node : retiredNodes_) {
+        rcu_retire(node);
+      }
+      for (auto entry : retiredEntries_) {
+        rcu_retire(entry);
+      }
+      retiredNodes_.clear();
+      retiredEntries_.clear();
+    };
+    func(updater);
+  }
+
+  /**
+   * Returns the number of networks in the table.
+   */
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    return entries_.size();
+  }
+
+ private:
+  static constexpr size_t kFanout = 256;
+
+  struct Entry {
+    Entry(const CIDRNetwork& network_, Value&& value_)
+        : network(network_), value(std::move(value_)) {}
+
+    const CIDRNetwork network;
+    const Value value;
+  };
+
+  struct Slot {
+    const Node* child{nullptr};
+    // The longest network of this node's stride that covers the slot.
+    const Entry* entry{nullptr};
+  };
+
+  struct Node {
+    Slot slots[kFanout];
+    // The update() that created the node, which may modify it in place.
+    uint64_t generation{0};
+  };
+
+  // One trie root and network of length 0 for IPv4, then for IPv6.
+  struct Root {
+    const Node* nodes[2]{};
+    const Entry* defaults[2]{};
+  };
+
+  const Entry* find(const IPAddress& addr) const {
+    if (addr.empty()) {
+      return nullptr;
+    }
+    auto root = root_.load(std::memory_order_acquire);
+    size_t family = addr.isV4() ? 0 : 1;
+    const uint8_t* bytes = addr.bytes();
+    size_t byteCount = addr.byteCount();
+    const Entry* best = root->defaults[family];
+    const Node* node = root->nodes[family];
+    for (size_t i = 0; node != nullptr && i < byteCount; ++i) {
+      const Slot& slot = node->slots[bytes[i]];
+      if (slot.entry != nullptr) {
+        best = slot.entry;
+      }
+      node = slot.child;
+    }
+    return best;
+  }
+
+  static CIDRNetwork normalize(const CIDRNetwork& network) {
+    const auto& addr = network.first;
+    if (addr.empty()) {
+      throw std::invalid_argument("IPPrefixTable: empty address");
+    }
+    if (network.second > addr.bitCount()) {
+      throw std::invalid_argument("IPPrefixTable: invalid network length");
+    }
+    return {addr.mask(network.second), network.second};
+  }
+
+  static void deleteTree(const Node* node) {
+    if (node == nullptr) {
+      return;
+    }
+    for (const auto& slot : node->slots) {
+      deleteTree(slot.child);
+    }
+    delete node;
+  }
+
+  // Returns a node that the current update() may modify: `node` itself if
+  // this update() created it, otherwise a copy that replaces it.
+  Node* writable(const Node*& node) {
+    if (node == nullptr) {
+      auto copy = new Node();
+      copy->generation = generation_;
+      node = copy;
+      return copy;
+    }
+    if (node->generation == generation_) {
+      return const_cast<Node*>(node);
+    }
+    auto copy = new Node(*node);
+    copy->generation = generation_;
+    retiredNodes_.push_back(node);
+    node = copy;
+    return copy;
+  }
+
+  // Returns the nodes from the root down to the one holding networks of
+  // `length`, writable by the current update().
+  std::vector<Node*> writablePath(
+      size_t family, const uint8_t* bytes, uint8_t length) {
+    std::vector<Node*> path;
+    const Node** link = &batchRoot_->nodes[family];
+    size_t depth = (length - 1) / 8;
+    for (size_t i = 0;; ++i) {
+      auto node = writable(*link);
+      path.push_back(node);
+      if (i == depth) {
+        return path;
+      }
+      link = &node->slots[bytes[i]].child;
+    }
+  }
+
+  // The range of slots that a network of `length` covers in its node.
+  static std::pair<size_t, size_t> slotRange(
+      const uint8_t* bytes, uint8_t length) {
+    size_t bits = length - (length - 1) / 8 * 8;
+    size_t count = size_t(1) << (8 - bits);
+    return {bytes[(length - 1) / 8] & ~(count - 1), count};
+  }
+
+  bool insertImpl(const CIDRNetwork& network, Value&& value) {
+    auto key = normalize(network);
+    size_t family = key.first.isV4() ? 0 : 1;
+    auto entry = new Entry(key, std::move(value));
+
+    const Entry* old = nullptr;
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      old = it->second;
+      it->second = entry;
+      retiredEntries_.push_back(old);
+    } else {
+      entries_.emplace(key, entry);
+    }
+
+    uint8_t length = key.second;
+    if (length == 0) {
+      batchRoot_->defaults[family] = entry;
+      return old == nullptr;
+    }
+
+    const uint8_t* bytes = key.first.bytes();
+    auto node = writablePath(family, bytes, length).back();
+    auto range = slotRange(bytes, length);
+    for (size_t i = range.first; i < range.first + range.second; ++i) {
+      auto& slot = node->slots[i];
+      if (slot.entry == nullptr || slot.entry->network.second <= length) {
+        slot.entry = entry;
+      }
+    }
+    return old == nullptr;
+  }
+
+  bool eraseImpl(const CIDRNetwork& network) {
+    auto key = normalize(network);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      return false;
+    }
+    const Entry* entry = it->second;
+    entries_.erase(it);
+    retiredEntries_.push_back(entry);
+
+    size_t family = key.first.isV4() ? 0 : 1;
+    uint8_t length = key.second;
+    if (length == 0) {
+      batchRoot_->defaults[family] = nullptr;
+      return true;
+    }
+
+    // The slots that had the network fall back to the longest shorter
+    // network of the same node that covers them, if any.
+    const uint8_t* bytes = key.first.bytes();
+    uint8_t nodeStart = uint8_t((length - 1) / 8 * 8);
+    const Entry* replacement = nullptr;
+    for (uint8_t len = length - 1; len > nodeStart; --len) {
+      auto shorter = entries_.find({key.first.mask(len), len});
+      if (shorter != entries_.end()) {
+        replacement = shorter->second;
+        break;
+      }
+    }
+
+    auto path = writablePath(family, bytes, length);
+    auto range = slotRange(bytes, length);
+    for (size_t i = range.first; i < range.first + range.second; ++i) {
+      auto& slot = path.back()->slots[i];
+      if (slot.entry == entry) {
+        slot.entry = replacement;
+      }
+    }
+
+    // Unlink the nodes left empty, from the bottom up. They were all created
+    // by this update(), so nothing else refers to them.
+    for (size_t depth = path.size(); depth-- > 0;) {
+      auto node = path[depth];
+      for (const auto& slot : node->slots) {
+        if (slot.child != nullptr || slot.entry != nullptr) {
+          return true;
+        }
+      }
+      if (depth == 0) {
+        batchRoot_->nodes[family] = nullptr;
+      } else {
+        path[depth - 1]->slots[bytes[depth - 1]].child = nullptr;
+      }
+      delete node;
+    }
+    return true;
+  }
+
+  std::atomic<Root*> root_;
+
+  // Writer state, guarded by writeMutex_.
+  mutable std::mutex writeMutex_;
+  std::map<CIDRNetwork, const Entry*> entries_;
+  uint64_t generation_{0};
+  Root* batchRoot_{nullptr};
+  std::vector<const Node*> retiredNodes_;
+  std::vector<const Entry*> retiredEntries_;
+};
+
+} // namespace folly
@@ -20,6 +20,7 @@
 #include <errno.h>
 #include <stdint.h>
 
+#include <memory>
 #include <type_traits>
 
 #include <folly/Portability.h>
@@ -27,6 +28,7 @@
 #include <folly/portability/SysMman.h>
 #include <folly/portability/Unistd.h>
 #include <folly/synchronization/AtomicStruct.h>
+#include <folly/system/NumaTopology.h>
 
 // Ignore shadowing warnings within this file, so includers can use -Wshadow.
 FOLLY_PUSH_WARNING
@@ -149,6 +151,15 @@ using IndexedMemPoolTraitsEagerRecycle = IndexedMemPoolTraits<T, true, true>;
 /// constructed, but delays element construction.  This means that only
 /// elements that are actually returned to the caller get paged into the
 /// process's resident set (RSS).
+///
+/// In NUMA mode (see the constructor that takes a NumaTopology) the slots
+/// are split into one contiguous range per node, and each node has its own
+/// global free list and its own share of the local lists.  Threads allocate
+/// from their node's range, so its pages are first touched, and placed, on
+/// that node, and a slot recycled by a thread on another node goes back to
+/// the free list of the node it belongs to.  Only when a node has no free
+/// slot left does it take one from another node.  numaStats() counts the
+/// slots that cross nodes either way.
 template <
     typename T,
     uint32_t NumLocalLists_ = 32,
@@ -214,13 +225,31 @@ struct IndexedMemPool {
     }
   }
 
+  /// Constructs a pool in NUMA mode, with the slots split evenly between
+  /// the nodes of topology.  The capacity is that of the whole pool, as
+  /// nodes take slots from each other when they run out.
+  IndexedMemPool(uint32_t capacity, NumaTopology topology)
+      : IndexedMemPool(capacity) {
+    numa_ = std::make_unique<Numa>(std::move(topology), actualCapacity_);
+  }
+
   /// Destroys all of the contained elements
   ~IndexedMemPool() {
     using A = Atom<uint32_t>;
-    for (uint32_t i = maxAllocatedIndex(); i > 0; --i) {
-      Traits::cleanup(slots_[i].elemPtr());
-      slots_[i].localNext.~A();
-      slots_[i].globalNext.~A();
+    auto cleanup = [&](uint32_t first, uint32_t last) {
+      for (uint32_t i = last; i >= first && i > 0; --i) {
+        Traits::cleanup(slots_[i].elemPtr());
+        slots_[i].localNext.~A();
+        slots_[i].globalNext.~A();
+      }
+    };
+    if (numa_) {
+      for (size_t n = 0; n < numa_->numNodes; ++n) {
+        auto& node = numa_->nodes[n];
+        cleanup(node.begin, node.begin + node.constructed() - 1);
+      }
+    } else {
+      cleanup(1, maxAllocatedIndex());
     }
     munmap(slots_, mmapLength_);
   }
@@ -234,12 +263,46 @@ struct IndexedMemPool {
   /// Returns the maximum index of elements ever allocated in this pool
   /// including elements that have been recycled.
   uint32_t maxAllocatedIndex() const {
+    if (numa_) {
+      uint32_t rv = 0;
+      for (size_t n = 0; n < numa_->numNodes; ++n) {
+        auto& node = numa_->nodes[n];
+        if (auto constructed = node.constructed()) {
+          rv = std::max(rv, node.begin + constructed - 1);
+        }
+      }
+      return rv;
+    }
     // Take the minimum since it is possible that size_ > actualCapacity_.
     // This can happen if there are multiple concurrent requests
     // when size_ == actualCapacity_ - 1.
     return std::min(uint32_t(size_), uint32_t(actualCapacity_));
   }
 
+  struct NumaStats {
+    /// Slots allocated by a thread on a node other than their own, because
+    /// its node had none left
+    uint64_t crossNodeAllocs{0};
+    /// Slots recycled by a thread on a node other than their own
+    uint64_t crossNodeRecycles{0};
+  };
+
+  /// Returns the counts of slots that crossed nodes, summed over all
+  /// nodes.  All zero if the pool is not in NUMA mode.
+  NumaStats numaStats() const {
+    NumaStats stats;
+    if (numa_) {
+      for (size_t n = 0; n < numa_->numNodes; ++n) {
+        auto& node = numa_->nodes[n];
+        stats.crossNodeAllocs +=
+            node.crossNodeAllocs.load(std::memory_order_relaxed);
+        stats.crossNodeRecycles +=
+            node.crossNodeRecycles.load(std::memory_order_relaxed);
+      }
+    }
+    return stats;
+  }
+
   /// Finds a slot with a non-zero index, emplaces a T there if we're
   /// using the eager recycle lifecycle mode, and returns the index,
   /// or returns 0 if no elements are available.  Passes a pointer to
@@ -247,7 +310,7 @@ struct IndexedMemPool {
   /// allocated.
   template <typename... Args>
   uint32_t allocIndex(Args&&... args) {
-    auto idx = localPop(localHead());
+    auto idx = FOLLY_UNLIKELY(numa_) ? numaPop() : localPop(localHead());
     if (idx != 0) {
       Slot& s = slot(idx);
       Traits::onAllocate(s.elemPtr(), std::forward<Args>(args)...);
@@ -270,7 +333,11 @@ struct IndexedMemPool {
   /// Gives up ownership previously granted by alloc()
   void recycleIndex(uint32_t idx) {
     assert(isAllocated(idx));
-    localPush(localHead(), idx);
+    if (FOLLY_UNLIKELY(numa_)) {
+      numaPush(idx);
+    } else {
+      localPush(localHead(), idx);
+    }
   }
 
   /// Provides access to the pooled element referenced by idx
@@ -361,6 +428,47 @@ struct IndexedMemPool {
     LocalList() : head(TaggedPtr{}) {}
   };
 
+  /// The slots of a node in NUMA mode, slots_[begin..begin+count), and the
+  /// counterparts of size_ and globalHead_ for them
+  struct alignas(hardware_destructive_interference_size) NumaNode {
+    uint32_t begin{0};
+    uint32_t count{0};
+    Atom<uint32_t> size{0};
+    AtomicStruct<TaggedPtr, Atom> globalHead{TaggedPtr{}};
+    // Like globalHead, but for lists shorter than the full ones a local
+    // list spills, such as slots recycled on another node.  They are taken
+    // one slot at a time, never adopted whole by a local list, so that the
+    // size of a local list stays exact.
+    AtomicStruct<TaggedPtr, Atom> partialHead{TaggedPtr{}};
+    Atom<uint64_t> crossNodeAllocs{0};
+    Atom<uint64_t> crossNodeRecycles{0};
+
+    uint32_t constructed() const { return std::min(uint32_t(size), count); }
+  };
+
+  struct Numa {
+    Numa(NumaTopology t, uint32_t capacity)
+        : topology(std::move(t)),
+          numNodes(std::min<size_t>(topology.numNodes(), capacity)),
+          slotsPerNode(capacity / uint32_t(numNodes)),
+          listsPerNode(std::max<uint32_t>(
+              1, NumLocalLists / uint32_t(numNodes))),
+          nodes(new NumaNode[numNodes]) {
+      for (size_t n = 0; n < numNodes; ++n) {
+        nodes[n].begin = 1 + uint32_t(n) * slotsPerNode;
+        nodes[n].count = n + 1 < numNodes
+            ? slotsPerNode
+            : capacity - uint32_t(n) * slotsPerNode;
+      }
+    }
+
+    const NumaTopology topology;
+    const size_t numNodes;
+    const uint32_t slotsPerNode;
+    const uint32_t listsPerNode;
+    std::unique_ptr<NumaNode[]> nodes;
+  };
+
   ////////// fields
 
   /// the number of bytes allocated from mmap, which is a multiple of
@@ -393,12 +501,18 @@ struct IndexedMemPool {
   alignas(hardware_destructive_interference_size)
       AtomicStruct<TaggedPtr, Atom> globalHead_;
 
+  /// per-node slots and free lists, in NUMA mode only
+  std::unique_ptr<Numa> numa_;
+
   ///////////// private methods
 
   uint32_t slotIndex(uint32_t idx) const {
     assert(
         0 < idx && idx <= actualCapacity_ &&
-        idx <= size_.load(std::memory_order_acquire));
+        (numa_ ? idx < numa_->nodes[homeNode(idx)].begin +
+                     numa_->nodes[homeNode(idx)].size.load(
+                         std::memory_order_acquire)
+               : idx <= size_.load(std::memory_order_acquire)));
     return idx;
   }
 
@@ -408,11 +522,14 @@ struct IndexedMemPool {
 
   // localHead references a full list chained by localNext.  s should
   // reference slot(localHead), it is passed as a micro-optimization
-  void globalPush(Slot& s, uint32_t localHead) {
+  void globalPush(
+      Slot& s,
+      uint32_t localHead,
+      AtomicStruct<TaggedPtr, Atom>& globalHead) {
     while (true) {
-      TaggedPtr gh = globalHead_.load(std::memory_order_acquire);
+      TaggedPtr gh = globalHead.load(std::memory_order_acquire);
       s.globalNext.store(gh.idx, std::memory_order_relaxed);
-      if (globalHead_.compare_exchange_strong(gh, gh.withIdx(localHead))) {
+      if (globalHead.compare_exchange_strong(gh, gh.withIdx(localHead))) {
         // success
         return;
       }
@@ -421,6 +538,13 @@ struct IndexedMemPool {
 
   // idx references a single node
   void localPush(AtomicStruct<TaggedPtr, Atom>& head, uint32_t idx) {
+    localPush(head, idx, globalHead_);
+  }
+
+  void localPush(
+      AtomicStruct<TaggedPtr, Atom>& head,
+      uint32_t idx,
+      AtomicStruct<TaggedPtr, Atom>& globalHead) {
     Slot& s = slot(idx);
     TaggedPtr h = head.load(std::memory_order_acquire);
     bool recycled = false;
@@ -435,7 +559,7 @@ struct IndexedMemPool {
         // push will overflow local list, steal it instead
         if (head.compare_exchange_strong(h, h.withEmpty())) {
           // steal was successful, put everything in the global list
-          globalPush(s, idx);
+          globalPush(s, idx, globalHead);
           return;
         }
       } else {
@@ -450,11 +574,11 @@ struct IndexedMemPool {
   }
 
   // returns 0 if empty
-  uint32_t globalPop() {
+  uint32_t globalPop(AtomicStruct<TaggedPtr, Atom>& globalHead) {
     while (true) {
-      TaggedPtr gh = globalHead_.load(std::memory_order_acquire);
+      TaggedPtr gh = globalHead.load(std::memory_order_acquire);
       if (gh.idx == 0 ||
-          globalHead_.compare_exchange_strong(
+          globalHead.compare_exchange_strong(
               gh,
               gh.withIdx(
                   slot(gh.idx).globalNext.load(std::memory_order_relaxed)))) {
@@ -466,6 +590,18 @@ struct IndexedMemPool {
 
   // returns 0 if allocation failed
   uint32_t localPop(AtomicStruct<TaggedPtr, Atom>& head) {
+    return localPop(head, globalHead_, [&] {
+      return constructSlot(size_, 1, actualCapacity_);
+    });
+  }
+
+  // fresh() constructs and returns a slot that was never allocated, or
+  // returns 0 if there is none left
+  template <typename Fresh>
+  uint32_t localPop(
+      AtomicStruct<TaggedPtr, Atom>& head,
+      AtomicStruct<TaggedPtr, Atom>& globalHead,
+      Fresh fresh) {
     while (true) {
       TaggedPtr h = head.load(std::memory_order_acquire);
       if (h.idx != 0) {
@@ -479,23 +615,10 @@ struct IndexedMemPool {
         continue;
       }
 
-      uint32_t idx = globalPop();
+      uint32_t idx = globalPop(globalHead);
       if (idx == 0) {
         // global list is empty, allocate and construct new slot
-        if (size_.load(std::memory_order_relaxed) >= actualCapacity_ ||
-            (idx = ++size_) > actualCapacity_) {
-          // allocation failed
-          return 0;
-        }
-        Slot& s = slot(idx);
-        // Atom is enforced above to be nothrow-default-constructible
-        // As an optimization, use default-initialization (no parens) rather
-        // than direct-initialization (with parens): these locations are
-        // stored-to before they are loaded-from
-        new (&s.localNext) Atom<uint32_t>;
-        new (&s.globalNext) Atom<uint32_t>;
-        Traits::initialize(s.elemPtr());
-        return idx;
+        return fresh();
       }
 
       Slot& s = slot(idx);
@@ -506,10 +629,105 @@ struct IndexedMemPool {
         return idx;
       }
       // local bulk push failed, return idx to the global list and try again
-      globalPush(s, idx);
+      globalPush(s, idx, globalHead);
     }
   }
 
+  // Constructs slot base + size++ if that is within count slots of base,
+  // otherwise returns 0
+  uint32_t constructSlot(Atom<uint32_t>& size, uint32_t base, uint32_t count) {
+    uint32_t n;
+    if (size.load(std::memory_order_relaxed) >= count ||
+        (n = ++size) > count) {
+      // allocation failed
+      return 0;
+    }
+    uint32_t idx = base + n - 1;
+    Slot& s = slot(idx);
+    // Atom is enforced above to be nothrow-default-constructible
+    // As an optimization, use default-initialization (no parens) rather
+    // than direct-initialization (with parens): these locations are
+    // stored-to before they are loaded-from
+    new (&s.localNext) Atom<uint32_t>;
+    new (&s.globalNext) Atom<uint32_t>;
+    Traits::initialize(s.elemPtr());
+    return idx;
+  }
+
+  uint32_t homeNode(uint32_t idx) const {
+    return std::min(
+        uint32_t(numa_->numNodes - 1), (idx - 1) / numa_->slotsPerNode);
+  }
+
+  size_t currentNode() const {
+    return std::min(numa_->topology.currentNode(), numa_->numNodes - 1);
+  }
+
+  AtomicStruct<TaggedPtr, Atom>& localHead(size_t node) {
+    auto first = std::min<size_t>(
+        node * numa_->listsPerNode, NumLocalLists - numa_->listsPerNode);
+    return local_[first + AccessSpreader<Atom>::current(numa_->listsPerNode)]
+        .head;
+  }
+
+  // Takes the first slot of the first list on globalHead, and pushes the
+  // rest of that list, if any, to partialHead.  Returns 0 if empty
+  uint32_t partialPop(
+      AtomicStruct<TaggedPtr, Atom>& globalHead,
+      AtomicStruct<TaggedPtr, Atom>& partialHead) {
+    auto idx = globalPop(globalHead);
+    if (idx != 0) {
+      auto next = slot(idx).localNext.load(std::memory_order_relaxed);
+      if (next != 0) {
+        globalPush(slot(next), next, partialHead);
+      }
+    }
+    return idx;
+  }
+
+  uint32_t numaPop() {
+    auto n = currentNode();
+    auto& node = numa_->nodes[n];
+    auto idx = localPop(localHead(n), node.globalHead, [&] {
+      auto recycled = partialPop(node.partialHead, node.partialHead);
+      return recycled != 0
+          ? recycled
+          : constructSlot(node.size, node.begin, node.count);
+    });
+    // The local node is out of slots; take one from another node, recycled
+    // before fresh.
+    for (size_t k = 1; idx == 0 && k < numa_->numNodes; ++k) {
+      auto& other = numa_->nodes[(n + k) % numa_->numNodes];
+      idx = partialPop(other.partialHead, other.partialHead);
+      if (idx == 0) {
+        idx = partialPop(other.globalHead, other.partialHead);
+      }
+    }
+    for (size_t k = 1; idx == 0 && k < numa_->numNodes; ++k) {
+      auto& other = numa_->nodes[(n + k) % numa_->numNodes];
+      idx = constructSlot(other.size, other.begin, other.count);
+    }
+    if (idx != 0 && homeNode(idx) != n) {
+      node.crossNodeAllocs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return idx;
+  }
+
+  void numaPush(uint32_t idx) {
+    auto n = currentNode();
+    auto home = homeNode(idx);
+    if (home == n) {
+      localPush(localHead(n), idx, numa_->nodes[n].globalHead);
+      return;
+    }
+    // Return the slot straight to its own node, as a list of one
+    Slot& s = slot(idx);
+    s.localNext.store(0, std::memory_order_release);
+    Traits::onRecycle(s.elemPtr());
+    globalPush(s, idx, numa_->nodes[home].partialHead);
+    numa_->nodes[n].crossNodeRecycles.fetch_add(1, std::memory_order_relaxed);
+  }
+
   AtomicStruct<TaggedPtr, Atom>& localHead() {
     auto stripe = AccessSpreader<Atom>::current(NumLocalLists);
     return local_[stripe].head;
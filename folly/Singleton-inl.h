@@ -293,6 +293,7 @@ void SingletonHolder<T>::createInstance() {
   auto print_destructor_stack_trace =
       std::make_shared<std::atomic<bool>>(false);
 
+  auto const createStart = std::chrono::steady_clock::now();
   // Can't use make_shared -- no support for a custom deleter, sadly.
   std::shared_ptr<T> instance(
       create_(),
@@ -302,6 +303,7 @@ void SingletonHolder<T>::createInstance() {
           detail::singletonPrintDestructionStackTrace(type);
         }
       });
+  auto const createDuration = std::chrono::steady_clock::now() - createStart;
 
   // We should schedule destroyInstances() only after the singleton was
   // created. This will ensure it will be destroyed before singletons,
@@ -324,6 +326,9 @@ void SingletonHolder<T>::createInstance() {
   state_.store(SingletonHolderState::Living, std::memory_order_release);
 
   vault_.creationOrder_.wlock()->push_back(type());
+  vault_.creationTimes_.wlock()->push_back(
+      {type().name(),
+       std::chrono::duration_cast<std::chrono::nanoseconds>(createDuration)});
   vault_.instantiatedAtLeastOnce_.wlock()->insert(type());
 }
 
@@ -207,6 +207,97 @@ FatalHelper fatalHelper;
 FatalHelper __attribute__((__init_priority__(101))) fatalHelper;
 #endif
 
+// The eager singletons and their declared dependencies, ordered so that each
+// singleton comes after its dependencies.
+struct EagerInitGraph {
+  std::vector<detail::SingletonHolderBase*> singletons;
+  // For each singleton, the indices of the singletons that depend on it.
+  std::vector<std::vector<size_t>> dependents;
+  // For each singleton, the number of its declared dependencies.
+  std::vector<size_t> dependencyCounts;
+};
+
+EagerInitGraph makeEagerInitGraph(
+    const std::unordered_set<detail::SingletonHolderBase*>& eagerInit,
+    const std::unordered_map<
+        detail::SingletonHolderBase*,
+        std::vector<detail::SingletonHolderBase*>>& dependencies) {
+  auto dependenciesOf = [&](detail::SingletonHolderBase* singleton)
+      -> const std::vector<detail::SingletonHolderBase*>& {
+    static const std::vector<detail::SingletonHolderBase*> kNone;
+    auto it = dependencies.find(singleton);
+    return it == dependencies.end() ? kNone : it->second;
+  };
+
+  std::unordered_map<detail::SingletonHolderBase*, size_t> index;
+  std::vector<detail::SingletonHolderBase*> singletons;
+  std::vector<detail::SingletonHolderBase*> pending(
+      eagerInit.begin(), eagerInit.end());
+  while (!pending.empty()) {
+    auto* singleton = pending.back();
+    pending.pop_back();
+    if (index.emplace(singleton, singletons.size()).second) {
+      singletons.push_back(singleton);
+      for (auto* dependency : dependenciesOf(singleton)) {
+        pending.push_back(dependency);
+      }
+    }
+  }
+
+  std::vector<std::vector<size_t>> dependents(singletons.size());
+  std::vector<size_t> dependencyCounts(singletons.size());
+  for (size_t i = 0; i < singletons.size(); ++i) {
+    for (auto* dependency : dependenciesOf(singletons[i])) {
+      dependents[index.at(dependency)].push_back(i);
+      ++dependencyCounts[i];
+    }
+  }
+
+  // Kahn's algorithm; whatever is left unordered is on a cycle.
+  std::vector<size_t> order;
+  order.reserve(singletons.size());
+  auto remaining = dependencyCounts;
+  for (size_t i = 0; i < singletons.size(); ++i) {
+    if (remaining[i] == 0) {
+      order.push_back(i);
+    }
+  }
+  for (size_t next = 0; next < order.size(); ++next) {
+    for (auto dependent : dependents[order[next]]) {
+      if (--remaining[dependent] == 0) {
+        order.push_back(dependent);
+      }
+    }
+  }
+  if (order.size() != singletons.size()) {
+    for (size_t i = 0; i < singletons.size(); ++i) {
+      if (remaining[i] != 0) {
+        throw std::logic_error(
+            "Dependency cycle among singletons, involving " +
+            singletons[i]->type().name());
+      }
+    }
+  }
+
+  std::vector<size_t> position(singletons.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    position[order[i]] = i;
+  }
+  EagerInitGraph graph;
+  graph.singletons.resize(singletons.size());
+  graph.dependents.resize(singletons.size());
+  graph.dependencyCounts.resize(singletons.size());
+  for (size_t i = 0; i < singletons.size(); ++i) {
+    auto& dependentsAt = graph.dependents[position[i]];
+    graph.singletons[position[i]] = singletons[i];
+    graph.dependencyCounts[position[i]] = dependencyCounts[i];
+    for (auto dependent : dependents[i]) {
+      dependentsAt.push_back(position[dependent]);
+    }
+  }
+  return graph;
+}
+
 } // namespace
 
 SingletonVault::SingletonVault(Type type) noexcept : type_(type) {
@@ -286,6 +377,28 @@ void SingletonVault::addEagerInitOnReenableSingleton(
   eagerInitOnReenableSingletons->insert(entry);
 }
 
+void SingletonVault::addSingletonDependency(
+    detail::SingletonHolderBase* entry,
+    detail::SingletonHolderBase* dependency) {
+  auto state = state_.rlock();
+  state->check(detail::SingletonVaultState::Type::Running);
+
+  if (FOLLY_UNLIKELY(state->registrationComplete) &&
+      type_.load(std::memory_order_relaxed) == Type::Strict) {
+    LOG(ERROR) << "Registering a dependency after registrationComplete().";
+  }
+
+  CHECK_THROW(singletons_.rlock()->count(entry->type()), std::logic_error);
+
+  auto dependencies = dependencies_.wlock();
+  auto& entryDependencies = (*dependencies)[entry];
+  if (std::find(
+          entryDependencies.begin(), entryDependencies.end(), dependency) ==
+      entryDependencies.end()) {
+    entryDependencies.push_back(dependency);
+  }
+}
+
 void SingletonVault::registrationComplete() {
   scheduleDestroyInstances();
 
@@ -319,8 +432,9 @@ void SingletonVault::doEagerInit() {
     }
   }
 
-  auto eagerInitSingletons = eagerInitSingletons_.rlock();
-  for (auto* single : *eagerInitSingletons) {
+  auto graph = makeEagerInitGraph(
+      *eagerInitSingletons_.rlock(), *dependencies_.rlock());
+  for (auto* single : graph.singletons) {
     single->createInstance();
   }
 }
@@ -334,31 +448,62 @@ void SingletonVault::doEagerInitVia(Executor& exe, folly::Baton<>* done) {
     }
   }
 
-  auto eagerInitSingletons = eagerInitSingletons_.rlock();
-  auto countdown =
-      std::make_shared<std::atomic<size_t>>(eagerInitSingletons->size());
-  for (auto* single : *eagerInitSingletons) {
-    // countdown is retained by shared_ptr, and will be alive until last lambda
-    // is done.  notifyBaton is provided by the caller, and expected to remain
-    // present (if it's non-nullptr).  singletonSet can go out of scope but
-    // its values, which are SingletonHolderBase pointers, are alive as long as
-    // SingletonVault is not being destroyed.
-    exe.add([=] {
-      // decrement counter and notify if requested, whether initialization
-      // was successful, was skipped (already initialized), or exception thrown.
-      SCOPE_EXIT {
-        if (--(*countdown) == 0) {
-          if (done != nullptr) {
-            done->post();
+  struct EagerInitState {
+    EagerInitGraph graph;
+    std::unique_ptr<std::atomic<size_t>[]> remainingDependencies;
+    std::atomic<size_t> countdown;
+    Executor* exe;
+    folly::Baton<>* done;
+
+    void schedule(std::shared_ptr<EagerInitState> self, size_t i) {
+      // self is retained by every scheduled lambda, and will be alive until
+      // the last one is done.  done is provided by the caller, and expected to
+      // remain present (if it's non-nullptr).  The SingletonHolderBase
+      // pointers are alive as long as SingletonVault is not being destroyed.
+      exe->add([self = std::move(self), i] {
+        // Schedule the dependents whose dependencies are now all done, then
+        // decrement counter and notify if requested, whether initialization
+        // was successful, was skipped (already initialized), or exception
+        // thrown.
+        SCOPE_EXIT {
+          for (auto dependent : self->graph.dependents[i]) {
+            if (--self->remainingDependencies[dependent] == 0) {
+              self->schedule(self, dependent);
+            }
+          }
+          if (--self->countdown == 0) {
+            if (self->done != nullptr) {
+              self->done->post();
+            }
           }
+        };
+        // if initialization is in progress in another thread, don't try to
+        // init here.  Otherwise the current thread will block on
+        // 'createInstance'.
+        auto* single = self->graph.singletons[i];
+        if (!single->creationStarted()) {
+          single->createInstance();
         }
-      };
-      // if initialization is in progress in another thread, don't try to init
-      // here.  Otherwise the current thread will block on 'createInstance'.
-      if (!single->creationStarted()) {
-        single->createInstance();
-      }
-    });
+      });
+    }
+  };
+
+  auto state = std::make_shared<EagerInitState>();
+  state->graph = makeEagerInitGraph(
+      *eagerInitSingletons_.rlock(), *dependencies_.rlock());
+  auto const size = state->graph.singletons.size();
+  state->remainingDependencies =
+      std::make_unique<std::atomic<size_t>[]>(size);
+  for (size_t i = 0; i < size; ++i) {
+    state->remainingDependencies[i] = state->graph.dependencyCounts[i];
+  }
+  state->countdown = size;
+  state->exe = &exe;
+  state->done = done;
+  for (size_t i = 0; i < size; ++i) {
+    if (state->graph.dependencyCounts[i] == 0) {
+      state->schedule(state, i);
+    }
   }
 }
 
@@ -406,6 +551,7 @@ void SingletonVault::destroyInstances() {
     auto creationOrder = creationOrder_.wlock();
     creationOrder->clear();
   }
+  creationTimes_.wlock()->clear();
 }
 
 void SingletonVault::reenableInstances() {
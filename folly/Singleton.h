@@ -113,6 +113,19 @@
 // if the program opted-in to that feature by calling "doEagerInit" or
 // "doEagerInitVia" during its startup.
 //
+// Eager singletons whose create functions use other singletons can declare
+// that with dependsOn():
+//
+// auto the_singleton =
+//     folly::Singleton<MyExpensiveService>()
+//     .dependsOn<MyConfig>()
+//     .shouldEagerInit();
+//
+// doEagerInitVia then builds each singleton only after the ones it declared
+// as dependencies, and builds singletons that don't depend on each other in
+// parallel on the given executor, without workers blocking on each other.
+// SingletonVault::getCreationTimes() tells how long each of them took.
+//
 // What if you need to destroy all of your singletons?  Say, some of
 // your singletons manage threads, but you need to fork?  Or your unit
 // test wants to clean up all global state?  Then you can call
@@ -142,6 +155,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <list>
@@ -445,15 +459,26 @@ class SingletonVault {
 
   void addEagerInitOnReenableSingleton(detail::SingletonHolderBase* entry);
 
+  /**
+   * Called by `Singleton<T>.dependsOn<U>()` to record that the create
+   * function of entry uses dependency. Eager initialization creates declared
+   * dependencies before their dependents; see `doEagerInitVia`.
+   */
+  void addSingletonDependency(
+      detail::SingletonHolderBase* entry,
+      detail::SingletonHolderBase* dependency);
+
   // Mark registration is complete; no more singletons can be
   // registered at this point.
   void registrationComplete();
 
   /**
    * Initialize all singletons which were marked as eager-initialized
-   * (using `shouldEagerInit()`).  No return value.  Propagates exceptions
+   * (using `shouldEagerInit()`), and their declared dependencies, each after
+   * its dependencies.  No return value.  Propagates exceptions
    * from constructors / create functions, as is the usual case when calling
-   * for example `Singleton<Foo>::get_weak()`.
+   * for example `Singleton<Foo>::get_weak()`.  Throws std::logic_error if
+   * the declared dependencies form a cycle.
    */
   void doEagerInit();
 
@@ -467,6 +492,12 @@ class SingletonVault {
    * and future attempts to `try_get` or `get_weak` the failed singleton will
    * retry initialization.
    *
+   * A singleton is only scheduled once all the singletons it declared as
+   * dependencies (using `dependsOn()`) have been initialized, so that the
+   * executor's threads build independent singletons in parallel instead of
+   * waiting for one another.  Throws std::logic_error, without scheduling
+   * anything, if the declared dependencies form a cycle.
+   *
    * Sample usage:
    *
    *   folly::IOThreadPoolExecutor executor(max_concurrency_level);
@@ -501,6 +532,21 @@ class SingletonVault {
    */
   bool eagerInitComplete() const;
 
+  struct CreationTime {
+    std::string name;
+    // Time spent in the create function. Dependencies that are created from
+    // it, rather than before it, are included.
+    std::chrono::nanoseconds duration;
+  };
+
+  /**
+   * How long each living singleton took to create, in creation order. Meant
+   * for startup reports, e.g. after doEagerInit[Via].
+   */
+  std::vector<CreationTime> getCreationTimes() const {
+    return creationTimes_.copy();
+  }
+
   size_t livingSingletonCount() const {
     auto singletons = singletons_.rlock();
 
@@ -591,8 +637,15 @@ class SingletonVault {
       std::unordered_set<detail::SingletonHolderBase*>,
       SharedMutexSuppressTSAN>
       eagerInitOnReenableSingletons_;
+  Synchronized<
+      std::unordered_map<
+          detail::SingletonHolderBase*,
+          std::vector<detail::SingletonHolderBase*>>,
+      SharedMutexSuppressTSAN>
+      dependencies_;
   Synchronized<std::vector<detail::TypeDescriptor>, SharedMutexSuppressTSAN>
       creationOrder_;
+  Synchronized<std::vector<CreationTime>> creationTimes_;
   Synchronized<
       std::unordered_set<detail::TypeDescriptor, detail::TypeDescriptorHasher>,
       SharedMutexSuppressTSAN>
@@ -767,6 +820,24 @@ class Singleton {
     return *this;
   }
 
+  /**
+   * Declare that the create function of this singleton uses
+   * Singleton<U, UTag>. Optional; it lets doEagerInit[Via] create U first,
+   * and create singletons that don't depend on each other in parallel.
+   *
+   * Use like:
+   *   auto gFooInstance =
+   *       Singleton<Foo>(...).dependsOn<Bar>().shouldEagerInit();
+   */
+  template <typename U, typename UTag = detail::DefaultTag>
+  Singleton& dependsOn() {
+    auto vault = SingletonVault::singleton<VaultTag>();
+    vault->addSingletonDependency(
+        &getEntry(),
+        &detail::SingletonHolder<U>::template singleton<UTag, VaultTag>());
+    return *this;
+  }
+
   /**
    * Inject a mock singleton, for testing.
    *
@@ -34,6 +34,7 @@
 #include <fmt/core.h>
 
 #include <folly/Exception.h>
+#include <folly/detail/IPAddressSource.h>
 #include <folly/hash/Hash.h>
 #include <folly/net/NetOps.h>
 #include <folly/net/NetworkSocket.h>
@@ -399,12 +400,32 @@ bool SocketAddress::isFamilyInet() const {
 }
 
 void SocketAddress::getAddressStr(char* buf, size_t buflen) const {
-  auto ret = getAddressStr();
-  size_t len = std::min(buflen - 1, ret.size());
-  memcpy(buf, ret.data(), len);
+  if (!isFamilyInet()) {
+    throw std::invalid_argument("Can't get address str for non ip address");
+  }
+  char str[IPAddressV6::kMaxStrSize];
+  size_t len = std::min(buflen - 1, storage_.addr.toBuffer(str));
+  memcpy(buf, str, len);
   buf[len] = '\0';
 }
 
+size_t SocketAddress::ipPortToBuffer(char* out) const {
+  if (!isFamilyInet()) {
+    throw std::invalid_argument("Can't get address str for non ip address");
+  }
+  char* buf = out;
+  if (getFamily() == AF_INET6) {
+    *(buf++) = '[';
+    buf += storage_.addr.toBuffer(buf);
+    *(buf++) = ']';
+  } else {
+    buf += storage_.addr.toBuffer(buf);
+  }
+  *(buf++) = ':';
+  detail::writeIntegerString<uint16_t, 5>(port_, &buf);
+  return buf - out;
+}
+
 uint16_t SocketAddress::getPort() const {
   switch (getFamily()) {
     case AF_INET:
@@ -500,20 +521,10 @@ std::string SocketAddress::describe() const {
   switch (getFamily()) {
     case AF_UNSPEC:
       return "<uninitialized address>";
-    case AF_INET: {
-      char buf[NI_MAXHOST + 16];
-      getAddressStr(buf, sizeof(buf));
-      size_t iplen = strlen(buf);
-      snprintf(buf + iplen, sizeof(buf) - iplen, ":%" PRIu16, getPort());
-      return buf;
-    }
+    case AF_INET:
     case AF_INET6: {
-      char buf[NI_MAXHOST + 18];
-      buf[0] = '[';
-      getAddressStr(buf + 1, sizeof(buf) - 1);
-      size_t iplen = strlen(buf);
-      snprintf(buf + iplen, sizeof(buf) - iplen, "]:%" PRIu16, getPort());
-      return buf;
+      char buf[kMaxIpPortStrSize];
+      return std::string(buf, ipPortToBuffer(buf));
     }
     default: {
       char buf[64];
@@ -536,6 +536,25 @@ class SocketAddress {
    */
   void getAddressStr(char* buf, size_t buflen) const;
 
+  /**
+   * Max size of the string written by ipPortToBuffer().
+   */
+  static constexpr size_t kMaxIpPortStrSize =
+      IPAddressV6::kMaxStrSize + 2 /*[]*/ + 6 /*:port*/;
+
+  /**
+   * Write "ip:port", or "[ip]:port" for IPv6, to a buffer without allocating:
+   * the same string as describe() returns for IP addresses.
+   *
+   * Raises std::invalid_argument if the address is not an IPv4 or IPv6
+   * address.
+   *
+   * @param out Char buffer with room for kMaxIpPortStrSize characters. No
+   *            terminating NUL is written.
+   * @return The number of characters written
+   */
+  size_t ipPortToBuffer(char* out) const;
+
   /**
    * Return whether this address is a valid IPv4 or IPv6 address.
    *
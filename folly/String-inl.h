@@ -267,11 +267,17 @@ inline size_t delimSize(char) {
 inline size_t delimSize(StringPiece s) {
   return s.size();
 }
-inline bool atDelim(const char* s, char c) {
-  return *s == c;
+inline size_t delimSize(AnyCharOf) {
+  return 1;
+}
+inline size_t findDelim(StringPiece s, char c) {
+  return s.find(c);
 }
-inline bool atDelim(const char* s, StringPiece sp) {
-  return !std::memcmp(s, sp.start(), sp.size());
+inline size_t findDelim(StringPiece s, StringPiece sp) {
+  return sp.size() < 2 ? s.find(sp) : simdFindSubstr(s, sp);
+}
+inline size_t findDelim(StringPiece s, AnyCharOf set) {
+  return simdFindAnyOf(s, set.chars());
 }
 
 // These are used to short-circuit internalSplit() in the case of
@@ -326,7 +332,6 @@ void internalSplit(
     DelimT delim, StringPiece sp, OutputIterator out, bool ignoreEmpty) {
   assert(sp.empty() || sp.start() != nullptr);
 
-  const char* s = sp.start();
   const size_t strSize = sp.size();
   const size_t dSize = delimSize(delim);
 
@@ -336,28 +341,32 @@ void internalSplit(
     }
     return;
   }
-  if (std::is_same<DelimT, StringPiece>::value && dSize == 1) {
-    // Call the char version because it is significantly faster.
-    return internalSplitRecurseChar<OutStringT>(
-        delimFront(delim), sp, out, ignoreEmpty);
+  if constexpr (std::is_same<DelimT, StringPiece>::value) {
+    if (dSize == 1) {
+      // Call the char version because it is significantly faster.
+      return internalSplitRecurseChar<OutStringT>(
+          delimFront(delim), sp, out, ignoreEmpty);
+    }
+  }
+  if constexpr (std::is_same<DelimT, AnyCharOf>::value) {
+    if (delim.chars().size() == 1) {
+      return internalSplitRecurseChar<OutStringT>(
+          delim.chars().front(), sp, out, ignoreEmpty);
+    }
   }
 
   size_t tokenStartPos = 0;
-  size_t tokenSize = 0;
-  for (size_t i = 0; i <= strSize - dSize; ++i) {
-    if (atDelim(&s[i], delim)) {
-      if (!ignoreEmpty || tokenSize > 0) {
-        *out++ = to<OutStringT>(sp.subpiece(tokenStartPos, tokenSize));
-      }
-
-      tokenStartPos = i + dSize;
-      tokenSize = 0;
-      i += dSize - 1;
-    } else {
-      ++tokenSize;
+  for (;;) {
+    const size_t tokenSize = findDelim(sp.subpiece(tokenStartPos), delim);
+    if (tokenSize == std::string::npos) {
+      break;
+    }
+    if (!ignoreEmpty || tokenSize > 0) {
+      *out++ = to<OutStringT>(sp.subpiece(tokenStartPos, tokenSize));
     }
+    tokenStartPos += tokenSize + dSize;
   }
-  tokenSize = strSize - tokenStartPos;
+  const size_t tokenSize = strSize - tokenStartPos;
   if (!ignoreEmpty || tokenSize > 0) {
     *out++ = to<OutStringT>(sp.subpiece(tokenStartPos, tokenSize));
   }
@@ -370,6 +379,9 @@ StringPiece prepareDelim(const String& s) {
 inline char prepareDelim(char c) {
   return c;
 }
+inline AnyCharOf prepareDelim(AnyCharOf set) {
+  return set;
+}
 
 template <class OutputType>
 void toOrIgnore(StringPiece input, OutputType& output) {
@@ -380,7 +392,8 @@ inline void toOrIgnore(StringPiece, decltype(std::ignore)&) {}
 
 template <bool exact, class Delim, class OutputType>
 bool splitFixed(const Delim& delimiter, StringPiece input, OutputType& output) {
-  if (exact && FOLLY_UNLIKELY(std::string::npos != input.find(delimiter))) {
+  if (exact &&
+      FOLLY_UNLIKELY(std::string::npos != findDelim(input, delimiter))) {
     return false;
   }
   toOrIgnore(input, output);
@@ -393,7 +406,7 @@ bool splitFixed(
     StringPiece input,
     OutputType& outHead,
     OutputTypes&... outTail) {
-  size_t cut = input.find(delimiter);
+  size_t cut = findDelim(input, delimiter);
   if (FOLLY_UNLIKELY(cut == std::string::npos)) {
     return false;
   }
@@ -510,6 +523,20 @@ internalJoin(Delim delimiter, Iterator begin, Iterator end, String& output) {
   if (begin == end) {
     return;
   }
+  if constexpr (std::is_base_of<
+                    std::forward_iterator_tag,
+                    typename std::iterator_traits<
+                        Iterator>::iterator_category>::value) {
+    // Reserve an upper bound of the size in one pass, as toAppendFit() does,
+    // so that the output is not reallocated as it grows.
+    const size_t dsize = delimSize(delimiter);
+    Iterator it = begin;
+    size_t size = estimateSpaceNeeded(*it);
+    while (++it != end) {
+      size += dsize + estimateSpaceNeeded(*it);
+    }
+    output.reserve(size);
+  }
   internalJoinAppend(delimiter, begin, end, output);
 }
 
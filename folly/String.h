@@ -470,6 +470,24 @@ struct IsSimdSupportedDelim<char> : std::true_type {};
 
 } // namespace detail
 
+/**
+ * A delimiter for split() that matches any one of a set of characters, like
+ * the delimiters of strtok(). The set refers to the characters, which must
+ * outlive the call to split().
+ *
+ *   std::vector<folly::StringPiece> v;
+ *   folly::split(folly::AnyCharOf(",;"), "asd,bsd;csd", v);
+ */
+class AnyCharOf {
+ public:
+  constexpr explicit AnyCharOf(StringPiece chars) noexcept : chars_(chars) {}
+
+  constexpr StringPiece chars() const noexcept { return chars_; }
+
+ private:
+  StringPiece chars_;
+};
+
 /**
  * Split a string into a list of tokens by delimiter.
  *
@@ -497,6 +515,9 @@ struct IsSimdSupportedDelim<char> : std::true_type {};
  *   folly::splitTo<StringPiece>("::", "asd::bsd::asd::csd",
  *    std::inserter(s, s.begin()));
  *
+ * The delimiter is a char, a string or an AnyCharOf set of chars. Each is
+ * searched for with SIMD where the platform has it.
+ *
  * Split also takes a flag (ignoreEmpty) that indicates whether adjacent
  * delimiters should be treated as one single separator (ignoring empty tokens)
  * or not (generating empty tokens).
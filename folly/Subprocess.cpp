@@ -27,6 +27,7 @@
 
 #include <algorithm>
 #include <array>
+#include <climits>
 #include <system_error>
 #include <thread>
 
@@ -52,6 +53,14 @@
 constexpr int kExecFailure = 127;
 constexpr int kChildFailure = 126;
 
+#ifdef __linux__
+#ifdef SYS_pidfd_open
+constexpr long kSysPidfdOpen = SYS_pidfd_open;
+#else
+constexpr long kSysPidfdOpen = 434; // Same on all architectures
+#endif
+#endif
+
 namespace folly {
 
 ProcessReturnCode ProcessReturnCode::make(int status) {
@@ -543,6 +552,16 @@ void Subprocess::spawnInternal(
   // we have no way of cleaning up the child.
   pid_ = pid;
   returnCode_ = ProcessReturnCode::makeRunning();
+#ifdef __linux__
+  if (options.usePidfd_ && !options.detach_) {
+    // The child can't have been waited for yet, so its pid can't have been
+    // reused. Failure (ENOSYS before Linux 5.3) leaves pidfd() at -1.
+    int fd = int(syscall(kSysPidfdOpen, pid, 0));
+    if (fd >= 0) {
+      pidfd_ = File(fd, /*ownsFd=*/true);
+    }
+  }
+#endif
 }
 FOLLY_POP_WARNING
 
@@ -763,6 +782,7 @@ ProcessReturnCode Subprocess::poll(struct rusage* ru) {
     // since its descendants may still be using them.
     returnCode_ = ProcessReturnCode::make(status);
     pid_ = -1;
+    pidfd_ = File();
   }
   return returnCode_;
 }
@@ -791,6 +811,7 @@ ProcessReturnCode Subprocess::wait() {
   DCHECK_EQ(found, pid_);
   returnCode_ = ProcessReturnCode::make(status);
   pid_ = -1;
+  pidfd_ = File();
   return returnCode_;
 }
 
@@ -824,12 +845,21 @@ ProcessReturnCode Subprocess::waitTimeout(TimeoutDuration timeout) {
       // Change pid_ to -1 to detect programming error like calling
       // this method multiple times.
       pid_ = -1;
+      pidfd_ = File();
       return returnCode_;
     }
     if (now > pollUntil) {
       // Timed out: still running().
       return returnCode_;
     }
+    if (pidfd_) {
+      // Sleep until the child exits, rather than polling waitpid().
+      auto remaining =
+          std::chrono::ceil<std::chrono::milliseconds>(pollUntil - now);
+      pollfd pfd{pidfd_.fd(), POLLIN, 0};
+      ::poll(&pfd, 1, int(std::min<int64_t>(remaining.count(), INT_MAX)));
+      continue;
+    }
     // The subprocess is still running, sleep for increasing periods of time.
     std::this_thread::sleep_for(sleepDuration);
     sleepDuration =
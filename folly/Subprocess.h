@@ -530,6 +530,18 @@ class Subprocess {
     }
 #endif
 
+#if defined(__linux__)
+    /**
+     * Also open a pidfd for the child (pidfd_open(2), Linux >= 5.3); see
+     * Subprocess::pidfd(). Ignored with detach(), and on kernels without
+     * pidfd support.
+     */
+    Options& usePidfd() {
+      usePidfd_ = true;
+      return *this;
+    }
+#endif
+
    private:
     typedef boost::container::flat_map<int, int> FdMap;
     FdMap fdActions_;
@@ -555,6 +567,9 @@ class Subprocess {
 #endif
 #if defined(__linux__)
     Optional<cpu_set_t> cpuSet_;
+#endif
+#if defined(__linux__)
+    bool usePidfd_{false};
 #endif
   };
 
@@ -623,6 +638,14 @@ class Subprocess {
    */
   pid_t pid() const;
 
+  /**
+   * Return the pidfd opened for the child with Options::usePidfd(), or -1.
+   * It becomes readable once the child exits, so it can be polled or
+   * registered with an event loop (see SubprocessExitWatcher) instead of
+   * blocking in wait(). Closed once the child has been waited for.
+   */
+  int pidfd() const { return pidfd_.fd(); }
+
   /**
    * Return the child's status (as per wait()) if the process has already
    * been waited on, -1 if the process is still running, or -2 if the
@@ -1023,6 +1046,7 @@ class Subprocess {
 
   pid_t pid_{-1};
   ProcessReturnCode returnCode_;
+  File pidfd_;
   TimeoutDuration::rep destroyBehavior_ = DestroyBehaviorFatal;
 
   /**
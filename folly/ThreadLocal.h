@@ -28,6 +28,11 @@
  * to be held while destroying thread-local elements which could cause
  * deadlocks. We gate this mode behind the AccessModeStrict template parameter.
  *
+ * reduceAllThreads() aggregates the child objects of all threads like a loop
+ * over accessAllThreads() would, but releases the global lock between batches
+ * of threads, so that periodic aggregation over many threads doesn't stall
+ * thread creation and exit.
+ *
  * Intended use is for frequent write, infrequent read data access patterns such
  * as counters.
  *
@@ -80,6 +85,16 @@ class ThreadLocal {
   typedef typename ThreadLocalPtr<T, Tag, AccessMode>::Accessor Accessor;
   Accessor accessAllThreads() const { return tlp_.accessAllThreads(); }
 
+  template <typename R, typename F>
+  R reduceAllThreads(
+      R init,
+      F&& reduce,
+      size_t batchSize =
+          ThreadLocalPtr<T, Tag, AccessMode>::kReduceBatchSize) const {
+    return tlp_.reduceAllThreads(
+        std::move(init), std::forward<F>(reduce), batchSize);
+  }
+
   // movable
   ThreadLocal(ThreadLocal&&) = default;
   ThreadLocal& operator=(ThreadLocal&&) = default;
@@ -423,6 +438,34 @@ class ThreadLocalPtr {
     return Accessor(id_.getOrAllocate(StaticMeta::instance()));
   }
 
+  static constexpr size_t kReduceBatchSize = 64;
+
+  // Folds the elements of all threads into init, calling
+  // init = reduce(std::move(init), element) for each of them, in no
+  // particular order. Unlike accessAllThreads(), this doesn't hold the global
+  // lock for <Tag> for the whole walk: it is released after every batchSize
+  // elements, so that threads starting, exiting or resetting their element
+  // are only held up for one batch. A thread that starts or exits during the
+  // walk may or may not be included. reduce runs under the lock, so it
+  // should be cheap and must not access ThreadLocals with the same Tag.
+  template <typename R, typename F>
+  R reduceAllThreads(
+      R init, F&& reduce, size_t batchSize = kReduceBatchSize) const {
+    static_assert(
+        AccessAllThreadsEnabled::value,
+        "Must use a unique Tag to use the reduceAllThreads feature");
+    auto& meta = StaticMeta::instance();
+    meta.forEachElementBatched(
+        id_.getOrAllocate(meta),
+        batchSize,
+        [&](void* const* elements, size_t count) {
+          for (size_t i = 0; i < count; ++i) {
+            init = reduce(std::move(init), *static_cast<T*>(elements[i]));
+          }
+        });
+    return init;
+  }
+
  private:
   void destroy() { StaticMeta::instance().destroy(&id_); }
 
@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <memory>
 #include <thread>
 
 #include <folly/ConstexprMath.h>
@@ -667,7 +668,210 @@ class BasicTokenBucket {
   double burstSize_;
 };
 
+/**
+ * Token bucket that scales consume() across cores.
+ *
+ * BasicTokenBucket keeps its whole state in one atomic; at millions of
+ * consume() calls per second from many cores that cache line becomes the
+ * bottleneck. This variant fronts a shared BasicDynamicTokenBucket with a
+ * set of per-core token caches (shards, selected via AccessSpreader). A
+ * consume() is normally served from the caller's shard with a single CAS on
+ * a core-local cache line; when the shard runs dry it borrows enough tokens
+ * for the request plus borrowGranularity extra from the shared bucket in
+ * one operation.
+ *
+ * Accuracy: each shard caches at most about borrowGranularity tokens, so at
+ * most numShards() * borrowGranularity() tokens can have been taken from the
+ * shared bucket without being consumed yet. Consequently a burst may exceed
+ * burstSize by up to that amount, and a consume() may fail while another
+ * shard still holds cached tokens. A granularity of 0 caches nothing beyond
+ * the current request and degenerates into the plain shared bucket. Pick a
+ * granularity that is small relative to burstSize, e.g. rate * 1ms.
+ *
+ * Returned tokens always go to the shared bucket. flush() moves all cached
+ * tokens back to it, e.g. before reading available() precisely.
+ *
+ * @tparam Policy A policy.
+ */
+template <typename Policy = TokenBucketPolicyDefault>
+class BasicShardedTokenBucket {
+  template <typename T>
+  using Atom = typename Policy::template atom<T>;
+  using Align = typename Policy::align;
+  using Impl = BasicDynamicTokenBucket<Policy>;
+
+ public:
+  /**
+   * Construct a sharded token bucket.
+   *
+   * @param genRate Number of tokens to generate per second.
+   * @param burstSize Maximum burst size. Must be greater than 0.
+   * @param borrowGranularity Number of extra tokens a shard borrows from the
+   *                          shared bucket when it runs dry.
+   * @param numShards Number of per-core caches. 0 picks one per CPU.
+   * @param zeroTime Initial time at which to consider the token bucket
+   *                 starting to fill. Defaults to 0, so by default token
+   *                 bucket is "empty" after construction.
+   */
+  BasicShardedTokenBucket(
+      double genRate,
+      double burstSize,
+      double borrowGranularity,
+      size_t numShards = 0,
+      double zeroTime = 0)
+      : tokenBucket_(zeroTime),
+        rate_(genRate),
+        burstSize_(burstSize),
+        borrowGranularity_(borrowGranularity),
+        numShards_(std::min<size_t>(
+            numShards ? numShards : CacheLocality::system().numCpus,
+            AccessSpreader<>::maxStripeValue())),
+        shards_(new Shard[numShards_]) {
+    assert(rate_ > 0);
+    assert(burstSize_ > 0);
+    assert(borrowGranularity_ >= 0);
+  }
+
+  BasicShardedTokenBucket(const BasicShardedTokenBucket&) = delete;
+  BasicShardedTokenBucket& operator=(const BasicShardedTokenBucket&) = delete;
+
+  /**
+   * Returns the current time in seconds since Epoch.
+   */
+  static double defaultClockNow() noexcept(noexcept(Impl::defaultClockNow())) {
+    return Impl::defaultClockNow();
+  }
+
+  /**
+   * Attempts to consume some number of tokens, from the calling core's cache
+   * if possible and from the shared bucket otherwise.
+   *
+   * Thread-safe.
+   *
+   * @param toConsume The number of tokens to consume.
+   * @param nowInSeconds Current time in seconds. Should be monotonically
+   *                     increasing from the nowInSeconds specified in
+   *                     this token bucket's constructor.
+   * @return True if the rate limit check passed, false otherwise.
+   */
+  bool consume(double toConsume, double nowInSeconds = defaultClockNow()) {
+    auto& cached = shard().tokens;
+    auto tokens = cached.load(std::memory_order_relaxed);
+    while (tokens >= toConsume) {
+      if (cached.compare_exchange_weak(
+              tokens, tokens - toConsume, std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+
+    // Slow path: take whatever the shard holds and borrow the rest, plus
+    // borrowGranularity_ to refill the shard, in a single shared update.
+    tokens = cached.exchange(0, std::memory_order_relaxed);
+    double need = toConsume - tokens;
+    double borrowed = 0;
+    if (need > 0) {
+      double request = need + borrowGranularity_;
+      borrowed = tokenBucket_.consumeOrDrain(
+          request, rate_, burstSize_, nowInSeconds);
+      if (borrowed < need) {
+        addTokens(cached, tokens + borrowed);
+        return false;
+      }
+    }
+    addTokens(cached, tokens + borrowed - toConsume);
+    return true;
+  }
+
+  /**
+   * Returns extra tokens to the shared bucket.
+   *
+   * Thread-safe.
+   */
+  void returnTokens(double tokensToReturn) {
+    tokenBucket_.returnTokens(tokensToReturn, rate_);
+  }
+
+  /**
+   * Moves every shard's cached tokens back to the shared bucket.
+   *
+   * Thread-safe.
+   */
+  void flush() {
+    double total = 0;
+    for (size_t i = 0; i < numShards_; ++i) {
+      total += shards_[i].tokens.exchange(0, std::memory_order_relaxed);
+    }
+    if (total > 0) {
+      tokenBucket_.returnTokens(total, rate_);
+    }
+  }
+
+  /**
+   * Returns the tokens available at specified time (zero if in debt),
+   * including those cached by the shards.
+   *
+   * Thread-safe (but returned value may immediately be outdated).
+   */
+  double available(double nowInSeconds = defaultClockNow()) const noexcept {
+    double total = tokenBucket_.available(rate_, burstSize_, nowInSeconds);
+    for (size_t i = 0; i < numShards_; ++i) {
+      total += shards_[i].tokens.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  /**
+   * Returns the number of tokens generated per second.
+   */
+  double rate() const noexcept { return rate_; }
+
+  /**
+   * Returns the maximum burst size.
+   */
+  double burst() const noexcept { return burstSize_; }
+
+  /**
+   * Returns the number of extra tokens a shard borrows when it runs dry.
+   */
+  double borrowGranularity() const noexcept { return borrowGranularity_; }
+
+  /**
+   * Returns the number of per-core token caches.
+   */
+  size_t numShards() const noexcept { return numShards_; }
+
+ private:
+  static constexpr size_t AlignShard =
+      constexpr_max(Align::value, alignof(Atom<double>));
+
+  struct alignas(AlignShard) Shard {
+    Atom<double> tokens{0};
+  };
+
+  static void addTokens(Atom<double>& cached, double delta) {
+    if (delta == 0) {
+      return;
+    }
+    auto tokens = cached.load(std::memory_order_relaxed);
+    while (!cached.compare_exchange_weak(
+        tokens, tokens + delta, std::memory_order_relaxed)) {
+    }
+  }
+
+  Shard& shard() {
+    return shards_[AccessSpreader<>::cachedCurrent(numShards_)];
+  }
+
+  Impl tokenBucket_;
+  const double rate_;
+  const double burstSize_;
+  const double borrowGranularity_;
+  const size_t numShards_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
 using TokenBucket = BasicTokenBucket<>;
 using DynamicTokenBucket = BasicDynamicTokenBucket<>;
+using ShardedTokenBucket = BasicShardedTokenBucket<>;
 
 } // namespace folly
@@ -16,9 +16,22 @@
 
 #include <folly/Unicode.h>
 
+#include <cstring>
 #include <initializer_list>
 
 #include <folly/Conv.h>
+#include <folly/Portability.h>
+#include <folly/lang/Bits.h>
+
+#if FOLLY_SSE_PREREQ(4, 2)
+#include <immintrin.h>
+#define FOLLY_UNICODE_SIMD 1
+#elif FOLLY_AARCH64
+#include <arm_neon.h>
+#define FOLLY_UNICODE_SIMD 1
+#else
+#define FOLLY_UNICODE_SIMD 0
+#endif
 
 namespace folly {
 
@@ -198,4 +211,472 @@ char32_t utf8ToCodePoint(
   throw std::runtime_error("folly::utf8ToCodePoint encoding length maxed out");
 }
 
+namespace {
+
+// The length of the well-formed sequence at p, or 0 if there is none, per
+// table 3-7 of the Unicode standard.
+size_t utf8SequenceLength(const unsigned char* p, const unsigned char* e) {
+  unsigned char const c = p[0];
+  size_t n;
+  unsigned char lo = 0x80;
+  unsigned char hi = 0xbf;
+  if (c < 0x80) {
+    return 1;
+  } else if (c < 0xc2) {
+    return 0;
+  } else if (c < 0xe0) {
+    n = 2;
+  } else if (c < 0xf0) {
+    n = 3;
+    lo = c == 0xe0 ? 0xa0 : lo;
+    hi = c == 0xed ? 0x9f : hi;
+  } else if (c < 0xf5) {
+    n = 4;
+    lo = c == 0xf0 ? 0x90 : lo;
+    hi = c == 0xf4 ? 0x8f : hi;
+  } else {
+    return 0;
+  }
+  if (size_t(e - p) < n || p[1] < lo || p[1] > hi) {
+    return 0;
+  }
+  for (size_t i = 2; i < n; ++i) {
+    if ((p[i] & 0xc0) != 0x80) {
+      return 0;
+    }
+  }
+  return n;
+}
+
+// Decode a sequence that is known to be well-formed.
+char32_t utf8DecodeValid(const unsigned char*& p) {
+  unsigned char const c = *p++;
+  if (c < 0x80) {
+    return c;
+  }
+  if (c < 0xe0) {
+    return (char32_t(c & 0x1f) << 6) | (*p++ & 0x3f);
+  }
+  if (c < 0xf0) {
+    char32_t cp = (char32_t(c & 0x0f) << 12) | (char32_t(p[0] & 0x3f) << 6) |
+        (p[1] & 0x3f);
+    p += 2;
+    return cp;
+  }
+  char32_t cp = (char32_t(c & 0x07) << 18) | (char32_t(p[0] & 0x3f) << 12) |
+      (char32_t(p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+  p += 3;
+  return cp;
+}
+
+#if !FOLLY_UNICODE_SIMD
+
+bool isAsciiWord(uint64_t w) {
+  return !(w & 0x8080808080808080);
+}
+
+bool isValidUtf8Scalar(const unsigned char* p, const unsigned char* e) {
+  while (p < e) {
+    if (e - p >= 8 && isAsciiWord(loadUnaligned<uint64_t>(p))) {
+      p += 8;
+      continue;
+    }
+    auto n = utf8SequenceLength(p, e);
+    if (n == 0) {
+      return false;
+    }
+    p += n;
+  }
+  return true;
+}
+
+#else
+
+#if FOLLY_SSE_PREREQ(4, 2)
+
+struct Utf8SimdPlatform {
+  using reg_t = __m128i;
+
+  static reg_t zero() { return _mm_setzero_si128(); }
+  static reg_t broadcast(uint8_t c) { return _mm_set1_epi8(char(c)); }
+  static reg_t table(const uint8_t (&t)[16]) { return loadu(t); }
+  static reg_t loadu(const void* p) {
+    return _mm_loadu_si128(static_cast<const reg_t*>(p));
+  }
+  static bool isAscii(reg_t r) { return !_mm_movemask_epi8(r); }
+  static bool any(reg_t r) { return !_mm_testz_si128(r, r); }
+  // The register ending N bytes before the end of cur.
+  template <int N>
+  static reg_t prev(reg_t cur, reg_t prev) {
+    return _mm_alignr_epi8(cur, prev, 16 - N);
+  }
+  static reg_t lookup(reg_t t, reg_t idx) { return _mm_shuffle_epi8(t, idx); }
+  static reg_t highNibbles(reg_t r) {
+    return _mm_and_si128(_mm_srli_epi16(r, 4), broadcast(0x0f));
+  }
+  static reg_t lowNibbles(reg_t r) { return _mm_and_si128(r, broadcast(0x0f)); }
+  static reg_t bitAnd(reg_t a, reg_t b) { return _mm_and_si128(a, b); }
+  static reg_t bitOr(reg_t a, reg_t b) { return _mm_or_si128(a, b); }
+  static reg_t bitXor(reg_t a, reg_t b) { return _mm_xor_si128(a, b); }
+  static reg_t subs(reg_t a, reg_t b) { return _mm_subs_epu8(a, b); }
+
+  static void widen(reg_t r, char16_t* out) {
+    _mm_storeu_si128(
+        reinterpret_cast<reg_t*>(out), _mm_unpacklo_epi8(r, zero()));
+    _mm_storeu_si128(
+        reinterpret_cast<reg_t*>(out + 8), _mm_unpackhi_epi8(r, zero()));
+  }
+  static void widen(reg_t r, char32_t* out) {
+    auto lo = _mm_unpacklo_epi8(r, zero());
+    auto hi = _mm_unpackhi_epi8(r, zero());
+    auto* o = reinterpret_cast<reg_t*>(out);
+    _mm_storeu_si128(o + 0, _mm_unpacklo_epi16(lo, zero()));
+    _mm_storeu_si128(o + 1, _mm_unpackhi_epi16(lo, zero()));
+    _mm_storeu_si128(o + 2, _mm_unpacklo_epi16(hi, zero()));
+    _mm_storeu_si128(o + 3, _mm_unpackhi_epi16(hi, zero()));
+  }
+  // Narrow 16 code units to bytes if they are all ASCII.
+  static bool narrowAscii(const char16_t* in, unsigned char* out) {
+    auto a = loadu(in);
+    auto b = loadu(in + 8);
+    if (!_mm_testz_si128(_mm_or_si128(a, b), _mm_set1_epi16(-0x80))) {
+      return false;
+    }
+    _mm_storeu_si128(reinterpret_cast<reg_t*>(out), _mm_packus_epi16(a, b));
+    return true;
+  }
+};
+
+#else
+
+struct Utf8SimdPlatform {
+  using reg_t = uint8x16_t;
+
+  static reg_t zero() { return vdupq_n_u8(0); }
+  static reg_t broadcast(uint8_t c) { return vdupq_n_u8(c); }
+  static reg_t table(const uint8_t (&t)[16]) { return vld1q_u8(t); }
+  static reg_t loadu(const void* p) {
+    return vld1q_u8(static_cast<const uint8_t*>(p));
+  }
+  static bool isAscii(reg_t r) { return vmaxvq_u8(r) < 0x80; }
+  static bool any(reg_t r) { return vmaxvq_u8(r) != 0; }
+  // The register ending N bytes before the end of cur.
+  template <int N>
+  static reg_t prev(reg_t cur, reg_t prev) {
+    return vextq_u8(prev, cur, 16 - N);
+  }
+  static reg_t lookup(reg_t t, reg_t idx) { return vqtbl1q_u8(t, idx); }
+  static reg_t highNibbles(reg_t r) { return vshrq_n_u8(r, 4); }
+  static reg_t lowNibbles(reg_t r) { return vandq_u8(r, broadcast(0x0f)); }
+  static reg_t bitAnd(reg_t a, reg_t b) { return vandq_u8(a, b); }
+  static reg_t bitOr(reg_t a, reg_t b) { return vorrq_u8(a, b); }
+  static reg_t bitXor(reg_t a, reg_t b) { return veorq_u8(a, b); }
+  static reg_t subs(reg_t a, reg_t b) { return vqsubq_u8(a, b); }
+
+  static void widen(reg_t r, char16_t* out) {
+    auto* o = reinterpret_cast<uint16_t*>(out);
+    vst1q_u16(o, vmovl_u8(vget_low_u8(r)));
+    vst1q_u16(o + 8, vmovl_high_u8(r));
+  }
+  static void widen(reg_t r, char32_t* out) {
+    auto lo = vmovl_u8(vget_low_u8(r));
+    auto hi = vmovl_high_u8(r);
+    auto* o = reinterpret_cast<uint32_t*>(out);
+    vst1q_u32(o + 0, vmovl_u16(vget_low_u16(lo)));
+    vst1q_u32(o + 4, vmovl_high_u16(lo));
+    vst1q_u32(o + 8, vmovl_u16(vget_low_u16(hi)));
+    vst1q_u32(o + 12, vmovl_high_u16(hi));
+  }
+  // Narrow 16 code units to bytes if they are all ASCII.
+  static bool narrowAscii(const char16_t* in, unsigned char* out) {
+    auto* i = reinterpret_cast<const uint16_t*>(in);
+    auto a = vld1q_u16(i);
+    auto b = vld1q_u16(i + 8);
+    if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80) {
+      return false;
+    }
+    vst1q_u8(out, vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+    return true;
+  }
+};
+
+#endif
+
+constexpr size_t kUtf8SimdWidth = 16;
+
+// Keiser and Lemire's validation: the high and low nibbles of each byte and
+// the high nibble of the next one each look up the errors that they allow,
+// and a pair of bytes is in error if all three agree. Third and fourth bytes
+// of a sequence are the continuations that no pair explains.
+class Utf8SimdValidator {
+  using P = Utf8SimdPlatform;
+  using reg_t = P::reg_t;
+
+  // clang-format off
+  static constexpr uint8_t kTooShort = 1 << 0; // 11______ 0_______
+                                               // 11______ 11______
+  static constexpr uint8_t kTooLong = 1 << 1; // 0_______ 10______
+  static constexpr uint8_t kOverlong3 = 1 << 2; // 11100000 100_____
+  static constexpr uint8_t kTooLarge = 1 << 3; // 11110100 1001____
+                                               // 11110100 101_____
+                                               // 11110101 1001____ ...
+  static constexpr uint8_t kSurrogate = 1 << 4; // 11101101 101_____
+  static constexpr uint8_t kOverlong2 = 1 << 5; // 1100000_ 10______
+  static constexpr uint8_t kTooLarge1000 = 1 << 6; // 11110101 1000____ ...
+  static constexpr uint8_t kOverlong4 = 1 << 6; // 11110000 1000____
+  static constexpr uint8_t kTwoConts = 1 << 7; // 10______ 10______
+  static constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+  static constexpr uint8_t kByte1High[16] = {
+      // 0_______ ________
+      kTooLong, kTooLong, kTooLong, kTooLong,
+      kTooLong, kTooLong, kTooLong, kTooLong,
+      // 10______ ________
+      kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+      // 1100____ ________
+      kTooShort | kOverlong2,
+      // 1101____ ________
+      kTooShort,
+      // 1110____ ________
+      kTooShort | kOverlong3 | kSurrogate,
+      // 1111____ ________
+      kTooShort | kTooLarge | kTooLarge1000 | kOverlong4,
+  };
+  static constexpr uint8_t kByte1Low[16] = {
+      // ____0000 ________
+      kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+      // ____0001 ________
+      kCarry | kOverlong2,
+      // ____001_ ________
+      kCarry,
+      kCarry,
+      // ____0100 ________
+      kCarry | kTooLarge,
+      // ____0101 ________
+      kCarry | kTooLarge | kTooLarge1000,
+      // ____011_ ________
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      // ____1___ ________
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      // ____1101 ________
+      kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+  };
+  static constexpr uint8_t kByte2High[16] = {
+      // ________ 0_______
+      kTooShort, kTooShort, kTooShort, kTooShort,
+      kTooShort, kTooShort, kTooShort, kTooShort,
+      // ________ 1000____
+      kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 |
+          kOverlong4,
+      // ________ 1001____
+      kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+      // ________ 101_____
+      kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+      kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+      // ________ 11______
+      kTooShort, kTooShort, kTooShort, kTooShort,
+  };
+  // Bytes past which the last three bytes of a register start a sequence
+  // that it doesn't finish.
+  static constexpr uint8_t kIncomplete[16] = {
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1,
+  };
+  // clang-format on
+
+ public:
+  Utf8SimdValidator()
+      : byte1High_(P::table(kByte1High)),
+        byte1Low_(P::table(kByte1Low)),
+        byte2High_(P::table(kByte2High)),
+        incomplete_(P::table(kIncomplete)),
+        error_(P::zero()),
+        prevInput_(P::zero()),
+        prevIncomplete_(P::zero()) {}
+
+  void check(reg_t input) {
+    if (P::isAscii(input)) {
+      // Only a sequence left open by the previous register can fail.
+      error_ = P::bitOr(error_, prevIncomplete_);
+    } else {
+      auto prev1 = P::prev<1>(input, prevInput_);
+      auto special = P::bitAnd(
+          P::bitAnd(
+              P::lookup(byte1High_, P::highNibbles(prev1)),
+              P::lookup(byte1Low_, P::lowNibbles(prev1))),
+          P::lookup(byte2High_, P::highNibbles(input)));
+      auto third = P::subs(P::prev<2>(input, prevInput_), P::broadcast(0x60));
+      auto fourth = P::subs(P::prev<3>(input, prevInput_), P::broadcast(0x70));
+      auto must23 = P::bitAnd(P::bitOr(third, fourth), P::broadcast(0x80));
+      error_ = P::bitOr(error_, P::bitXor(must23, special));
+      prevIncomplete_ = P::subs(input, incomplete_);
+    }
+    prevInput_ = input;
+  }
+
+  // Check the last, partial register; the zeros after it end any sequence
+  // that it leaves open.
+  bool finish(const unsigned char* p, const unsigned char* e) {
+    unsigned char buf[kUtf8SimdWidth] = {};
+    std::memcpy(buf, p, size_t(e - p));
+    check(P::loadu(buf));
+    return !P::any(error_);
+  }
+
+ private:
+  reg_t const byte1High_;
+  reg_t const byte1Low_;
+  reg_t const byte2High_;
+  reg_t const incomplete_;
+  reg_t error_;
+  reg_t prevInput_;
+  reg_t prevIncomplete_;
+};
+
+bool isValidUtf8Simd(const unsigned char* p, const unsigned char* e) {
+  Utf8SimdValidator validator;
+  for (; size_t(e - p) >= kUtf8SimdWidth; p += kUtf8SimdWidth) {
+    validator.check(Utf8SimdPlatform::loadu(p));
+  }
+  return validator.finish(p, e);
+}
+
+#endif
+
+// Copy a run of ASCII from in to out, widening or narrowing it, and advance
+// both past it.
+template <class In, class Out>
+void copyAsciiRun(const In*& in, const In* e, Out*& out) {
+#if FOLLY_UNICODE_SIMD
+  using P = Utf8SimdPlatform;
+  if constexpr (sizeof(In) == 1) {
+    while (size_t(e - in) >= kUtf8SimdWidth) {
+      auto r = P::loadu(in);
+      if (!P::isAscii(r)) {
+        break;
+      }
+      P::widen(r, out);
+      in += kUtf8SimdWidth;
+      out += kUtf8SimdWidth;
+    }
+  } else if constexpr (sizeof(In) == 2) {
+    while (size_t(e - in) >= kUtf8SimdWidth &&
+           P::narrowAscii(in, reinterpret_cast<unsigned char*>(out))) {
+      in += kUtf8SimdWidth;
+      out += kUtf8SimdWidth;
+    }
+  }
+#endif
+  while (in < e && *in < 0x80) {
+    *out++ = Out(*in++);
+  }
+}
+
+template <class String>
+String utf8ToUtf(StringPiece s, const char* fn) {
+  auto* p = reinterpret_cast<const unsigned char*>(s.begin());
+  auto* e = reinterpret_cast<const unsigned char*>(s.end());
+  if (!isValidUtf8(s)) {
+    // The scan stops at the first ill-formed sequence, before e.
+    auto* q = p;
+    while (size_t n = utf8SequenceLength(q, e)) {
+      q += n;
+    }
+    throw_exception<unicode_error>(
+        to<std::string>("folly::", fn, " invalid utf8 at offset ", q - p));
+  }
+  using Unit = typename String::value_type;
+  // Never more code units than bytes
+  String ret(s.size(), Unit());
+  Unit* out = &ret[0];
+  while (p < e) {
+    copyAsciiRun(p, e, out);
+    if (p == e) {
+      break;
+    }
+    char32_t cp = utf8DecodeValid(p);
+    if (sizeof(Unit) == 2 && cp >= 0x10000) {
+      *out++ = Unit(0xd800 + ((cp - 0x10000) >> 10));
+      *out++ = Unit(0xdc00 + ((cp - 0x10000) & 0x3ff));
+    } else {
+      *out++ = Unit(cp);
+    }
+  }
+  ret.resize(size_t(out - ret.data()));
+  return ret;
+}
+
+char* appendUtf8(char32_t cp, char* out) {
+  codePointToUtf8Impl(cp, [&](std::initializer_list<char> data) {
+    std::memcpy(out, data.begin(), data.size());
+    out += data.size();
+  });
+  return out;
+}
+
+} // namespace
+
+bool isValidUtf8(StringPiece s) noexcept {
+  auto* p = reinterpret_cast<const unsigned char*>(s.begin());
+  auto* e = reinterpret_cast<const unsigned char*>(s.end());
+#if FOLLY_UNICODE_SIMD
+  return isValidUtf8Simd(p, e);
+#else
+  return isValidUtf8Scalar(p, e);
+#endif
+}
+
+std::u16string utf8ToUtf16(StringPiece s) {
+  return utf8ToUtf<std::u16string>(s, "utf8ToUtf16");
+}
+
+std::u32string utf8ToUtf32(StringPiece s) {
+  return utf8ToUtf<std::u32string>(s, "utf8ToUtf32");
+}
+
+std::string utf16ToUtf8(std::u16string_view s) {
+  auto* p = s.data();
+  auto* e = p + s.size();
+  // At most 3 bytes per code unit, as a surrogate pair takes 4 bytes
+  std::string ret(s.size() * 3, '\0');
+  char* out = &ret[0];
+  while (p < e) {
+    copyAsciiRun(p, e, out);
+    if (p == e) {
+      break;
+    }
+    char32_t cp = *p++;
+    if (!utf16_code_unit_is_bmp(char16_t(cp))) {
+      if (p == e) {
+        throw_exception<unicode_error>("invalid high surrogate");
+      }
+      cp = unicode_code_point_from_utf16_surrogate_pair(char16_t(cp), *p++);
+    }
+    out = appendUtf8(cp, out);
+  }
+  ret.resize(size_t(out - ret.data()));
+  return ret;
+}
+
+std::string utf32ToUtf8(std::u32string_view s) {
+  std::string ret(s.size() * 4, '\0');
+  char* out = &ret[0];
+  for (char32_t cp : s) {
+    if (cp > 0x10ffff || (cp >= 0xd800 && cp < 0xe000)) {
+      throw_exception<unicode_error>(to<std::string>(
+          "folly::utf32ToUtf8 invalid code point ", uint32_t(cp)));
+    }
+    out = appendUtf8(cp, out);
+  }
+  ret.resize(size_t(out - ret.data()));
+  return ret;
+}
+
 } // namespace folly
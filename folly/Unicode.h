@@ -21,7 +21,9 @@
 #include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
+#include <folly/Range.h>
 #include <folly/lang/Exception.h>
 
 namespace folly {
@@ -89,6 +91,30 @@ void appendCodePointToUtf8(char32_t cp, std::string& out);
 char32_t utf8ToCodePoint(
     const unsigned char*& p, const unsigned char* const e, bool skipOnError);
 
+/*
+ * Check that a byte sequence is well-formed UTF-8, accepting exactly what
+ * utf8ToCodePoint() accepts: no overlong encodings, surrogates, code points
+ * past U+10FFFF or truncated sequences.
+ *
+ * Where SSE4.2 or NEON is available, whole registers are validated at a time
+ * with the lookup tables of Keiser and Lemire, "Validating UTF-8 In Less Than
+ * One Instruction Per Byte", and ASCII runs are skipped a register at a time.
+ */
+bool isValidUtf8(StringPiece s) noexcept;
+
+/*
+ * Transcode between UTF-8 and UTF-16 or UTF-32, throwing unicode_error on
+ * invalid input: ill-formed UTF-8, unpaired surrogates in UTF-16, surrogates
+ * or values past U+10FFFF in UTF-32.
+ *
+ * UTF-8 input is validated as by isValidUtf8() before it is decoded, and ASCII
+ * runs are widened or narrowed a register at a time.
+ */
+std::u16string utf8ToUtf16(StringPiece s);
+std::u32string utf8ToUtf32(StringPiece s);
+std::string utf16ToUtf8(std::u16string_view s);
+std::string utf32ToUtf8(std::u32string_view s);
+
 //////////////////////////////////////////////////////////////////////
 
 } // namespace folly
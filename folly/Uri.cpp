@@ -18,20 +18,165 @@
 
 #include <algorithm>
 #include <cctype>
-
-#include <boost/regex.hpp>
+#include <limits>
 
 namespace folly {
 
 namespace {
 
-std::string submatch(const boost::cmatch& m, int idx) {
-  const auto& sub = m[idx];
-  return std::string(sub.first, sub.second);
+bool isSchemeChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '+' ||
+      c == '.' || c == '-';
+}
+
+bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// Parses "host[:port]" where host is either an IP-literal in square brackets
+// or a run of characters other than '[' and ':'. The port is a possibly empty
+// run of digits.
+Expected<Unit, UriFormatError> parseHostAndPort(
+    StringPiece str, StringPiece& host, uint16_t& port) noexcept {
+  size_t hostEnd;
+  if (!str.empty() && str.front() == '[') {
+    hostEnd = str.find(']');
+    if (hostEnd == StringPiece::npos) {
+      return makeUnexpected(UriFormatError::INVALID_URI_AUTHORITY);
+    }
+    ++hostEnd;
+  } else {
+    hostEnd = std::min(str.find_first_of("[:"), str.size());
+  }
+  host = str.subpiece(0, hostEnd);
+  str.advance(hostEnd);
+  if (str.empty()) {
+    return unit;
+  }
+  if (str.front() != ':' ||
+      !std::all_of(str.begin() + 1, str.end(), isDigit)) {
+    return makeUnexpected(UriFormatError::INVALID_URI_AUTHORITY);
+  }
+  uint32_t value = 0;
+  for (char c : str.subpiece(1)) {
+    value = value * 10 + (c - '0');
+    if (value > std::numeric_limits<uint16_t>::max()) {
+      return makeUnexpected(UriFormatError::INVALID_URI_PORT);
+    }
+  }
+  port = static_cast<uint16_t>(value);
+  return unit;
 }
 
 } // namespace
 
+Expected<UriView, UriFormatError> UriView::tryParse(StringPiece str) noexcept {
+  UriView result;
+
+  // scheme: [a-zA-Z][a-zA-Z0-9+.-]* followed by ':'. find_first_of() and
+  // friends below dispatch to folly's SSE4.2 byte-set scan where available.
+  auto colon = str.find(':');
+  if (colon == StringPiece::npos || colon == 0 ||
+      !std::isalpha(static_cast<unsigned char>(str.front())) ||
+      !std::all_of(str.begin() + 1, str.begin() + colon, isSchemeChar)) {
+    return makeUnexpected(UriFormatError::INVALID_URI);
+  }
+  result.scheme_ = str.subpiece(0, colon);
+  str.advance(colon + 1);
+
+  // authority and path run up to the first '?' or '#', the query up to '#'.
+  auto end = std::min(str.find_first_of("?#"), str.size());
+  StringPiece authorityAndPath = str.subpiece(0, end);
+  str.advance(end);
+  if (str.startsWith('?')) {
+    end = std::min(str.find('#'), str.size());
+    result.query_ = str.subpiece(1, end - 1);
+    str.advance(end);
+  }
+  if (str.startsWith('#')) {
+    result.fragment_ = str.subpiece(1);
+  }
+
+  if (!authorityAndPath.removePrefix("//")) {
+    // Does not start with //, doesn't have authority
+    result.path_ = authorityAndPath;
+    return result;
+  }
+
+  auto slash = std::min(authorityAndPath.find('/'), authorityAndPath.size());
+  StringPiece authority = authorityAndPath.subpiece(0, slash);
+  result.path_ = authorityAndPath.subpiece(slash);
+  result.authority_ = authority;
+  result.hasAuthority_ = true;
+
+  // Optional "username[:password]@" up to the first '@'. If the rest is not a
+  // valid host and port, the '@' may still belong to a plain host.
+  auto at = authority.find('@');
+  if (at != StringPiece::npos) {
+    StringPiece userInfo = authority.subpiece(0, at);
+    auto parsed = parseHostAndPort(
+        authority.subpiece(at + 1), result.host_, result.port_);
+    if (parsed.hasValue()) {
+      auto passwordColon = userInfo.find(':');
+      result.username_ = userInfo.subpiece(0, passwordColon);
+      if (passwordColon != StringPiece::npos) {
+        result.password_ = userInfo.subpiece(passwordColon + 1);
+      }
+      return result;
+    }
+    if (parsed.error() == UriFormatError::INVALID_URI_PORT) {
+      return makeUnexpected(parsed.error());
+    }
+    result.port_ = 0;
+  }
+  auto parsed = parseHostAndPort(authority, result.host_, result.port_);
+  if (parsed.hasError()) {
+    return makeUnexpected(parsed.error());
+  }
+  return result;
+}
+
+StringPiece UriView::hostname() const {
+  if (!host_.empty() && host_.front() == '[') {
+    // If it starts with '[', then it should end with ']', this is ensured by
+    // the parser
+    return host_.subpiece(1, host_.size() - 2);
+  }
+  return host_;
+}
+
+void UriView::QueryParamIterator::advance() {
+  while (rest_.data() != nullptr) {
+    StringPiece param;
+    auto amp = rest_.find('&');
+    if (amp == StringPiece::npos) {
+      param = rest_;
+      rest_ = StringPiece();
+    } else {
+      param = rest_.subpiece(0, amp);
+      rest_.advance(amp + 1);
+    }
+    StringPiece key = param;
+    StringPiece value(param.end(), param.end());
+    auto eq = param.find('=');
+    if (eq != StringPiece::npos) {
+      key = param.subpiece(0, eq);
+      value = param.subpiece(eq + 1);
+      if (value.find('=') != StringPiece::npos) {
+        // more than one '=', we don't know which one is the delimiter
+        continue;
+      }
+    }
+    if (key.empty()) {
+      // key is empty, ignore it
+      continue;
+    }
+    param_ = {key, value};
+    return;
+  }
+  param_ = {};
+}
+
 // private default contructor
 Uri::Uri() : hasAuthority_(false), port_(0) {}
 
@@ -54,73 +199,26 @@ Uri::Uri(StringPiece str) : hasAuthority_(false), port_(0) {
 }
 
 Expected<Uri, UriFormatError> Uri::tryFromString(StringPiece str) noexcept {
-  Uri result;
-
-  static const boost::regex uriRegex(
-      "([a-zA-Z][a-zA-Z0-9+.-]*):" // scheme:
-      "([^?#]*)" // authority and path
-      "(?:\\?([^#]*))?" // ?query
-      "(?:#(.*))?"); // #fragment
-  static const boost::regex authorityAndPathRegex("//([^/]*)(/.*)?");
-
-  boost::cmatch match;
-  if (FOLLY_UNLIKELY(
-          !boost::regex_match(str.begin(), str.end(), match, uriRegex))) {
-    return makeUnexpected(UriFormatError::INVALID_URI);
+  auto view = UriView::tryParse(str);
+  if (FOLLY_UNLIKELY(view.hasError())) {
+    return makeUnexpected(view.error());
   }
 
-  result.scheme_ = submatch(match, 1);
+  Uri result;
+  result.scheme_ = view->scheme().str();
   std::transform(
       result.scheme_.begin(),
       result.scheme_.end(),
       result.scheme_.begin(),
       ::tolower);
-
-  StringPiece authorityAndPath(match[2].first, match[2].second);
-  boost::cmatch authorityAndPathMatch;
-  if (!boost::regex_match(
-          authorityAndPath.begin(),
-          authorityAndPath.end(),
-          authorityAndPathMatch,
-          authorityAndPathRegex)) {
-    // Does not start with //, doesn't have authority
-    result.hasAuthority_ = false;
-    result.path_ = authorityAndPath.str();
-  } else {
-    static const boost::regex authorityRegex(
-        "(?:([^@:]*)(?::([^@]*))?@)?" // username, password
-        "(\\[[^\\]]*\\]|[^\\[:]*)" // host (IP-literal (e.g. '['+IPv6+']',
-                                   // dotted-IPv4, or named host)
-        "(?::(\\d*))?"); // port
-
-    const auto authority = authorityAndPathMatch[1];
-    boost::cmatch authorityMatch;
-    if (!boost::regex_match(
-            authority.first,
-            authority.second,
-            authorityMatch,
-            authorityRegex)) {
-      return makeUnexpected(UriFormatError::INVALID_URI_AUTHORITY);
-    }
-
-    StringPiece port(authorityMatch[4].first, authorityMatch[4].second);
-    if (!port.empty()) {
-      try {
-        result.port_ = to<uint16_t>(port);
-      } catch (ConversionError const&) {
-        return makeUnexpected(UriFormatError::INVALID_URI_PORT);
-      }
-    }
-
-    result.hasAuthority_ = true;
-    result.username_ = submatch(authorityMatch, 1);
-    result.password_ = submatch(authorityMatch, 2);
-    result.host_ = submatch(authorityMatch, 3);
-    result.path_ = submatch(authorityAndPathMatch, 2);
-  }
-
-  result.query_ = submatch(match, 3);
-  result.fragment_ = submatch(match, 4);
+  result.hasAuthority_ = view->hasAuthority();
+  result.username_ = view->username().str();
+  result.password_ = view->password().str();
+  result.host_ = view->host().str();
+  result.port_ = view->port();
+  result.path_ = view->path().str();
+  result.query_ = view->query().str();
+  result.fragment_ = view->fragment().str();
 
   return result;
 }
@@ -155,7 +253,7 @@ std::string Uri::authority() const {
 std::string Uri::hostname() const {
   if (!host_.empty() && host_[0] == '[') {
     // If it starts with '[', then it should end with ']', this is ensured by
-    // regex
+    // the parser
     return host_.substr(1, host_.size() - 2);
   }
   return host_;
@@ -163,25 +261,8 @@ std::string Uri::hostname() const {
 
 const std::vector<std::pair<std::string, std::string>>& Uri::getQueryParams() {
   if (!query_.empty() && queryParams_.empty()) {
-    // Parse query string
-    static const boost::regex queryParamRegex(
-        "(^|&)" /*start of query or start of parameter "&"*/
-        "([^=&]*)=?" /*parameter name and "=" if value is expected*/
-        "([^=&]*)" /*parameter value*/
-        "(?=(&|$))" /*forward reference, next should be end of query or
-                      start of next parameter*/);
-    const boost::cregex_iterator paramBeginItr(
-        query_.data(), query_.data() + query_.size(), queryParamRegex);
-    boost::cregex_iterator paramEndItr;
-    for (auto itr = paramBeginItr; itr != paramEndItr; ++itr) {
-      if (itr->length(2) == 0) {
-        // key is empty, ignore it
-        continue;
-      }
-      queryParams_.emplace_back(
-          std::string((*itr)[2].first, (*itr)[2].second), // parameter name
-          std::string((*itr)[3].first, (*itr)[3].second) // parameter value
-      );
+    for (auto param : UriView::QueryParams(query_)) {
+      queryParams_.emplace_back(param.first.str(), param.second.str());
     }
   }
   return queryParams_;
@@ -17,7 +17,10 @@
 #pragma once
 #define FOLLY_URI_H_
 
+#include <cstddef>
+#include <iterator>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <folly/Expected.h>
@@ -33,6 +36,124 @@ enum class UriFormatError {
   INVALID_URI_PORT,
 };
 
+/**
+ * Allocation-free view of a parsed URI.
+ *
+ * All components are StringPieces into the string passed to tryParse(), which
+ * must outlive the view. Parsing is hand-written (no regex) and accepts exactly
+ * the same inputs as Uri, which is built on top of it. Unlike Uri, the scheme
+ * is returned as written; compare it case-insensitively.
+ *
+ * Query parameters are split lazily while iterating queryParams(), with the
+ * same rules as Uri::getQueryParams():
+ *
+ *   for (auto [key, value] : view.queryParams()) { ... }
+ */
+class UriView {
+ public:
+  /**
+   * Parse a URI. On failure, returns UriFormatError.
+   */
+  static Expected<UriView, UriFormatError> tryParse(StringPiece str) noexcept;
+
+  StringPiece scheme() const { return scheme_; }
+  StringPiece username() const { return username_; }
+  StringPiece password() const { return password_; }
+  /**
+   * Raw authority, e.g. "user:pass@host:80"; empty if !hasAuthority().
+   */
+  StringPiece authority() const { return authority_; }
+  /**
+   * Host part of the URI, with the square brackets of IPv6 addresses.
+   */
+  StringPiece host() const { return host_; }
+  /**
+   * Host part of the URI, without the square brackets of IPv6 addresses.
+   */
+  StringPiece hostname() const;
+  uint16_t port() const { return port_; }
+  StringPiece path() const { return path_; }
+  StringPiece query() const { return query_; }
+  StringPiece fragment() const { return fragment_; }
+  bool hasAuthority() const { return hasAuthority_; }
+
+  /**
+   * Forward iterator over the (key, value) pairs of a query string. Splits
+   * one parameter per increment; nothing is copied.
+   */
+  class QueryParamIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<StringPiece, StringPiece>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    QueryParamIterator() = default;
+    explicit QueryParamIterator(StringPiece query) {
+      if (!query.empty()) {
+        rest_ = query;
+        advance();
+      }
+    }
+
+    reference operator*() const { return param_; }
+    pointer operator->() const { return &param_; }
+
+    QueryParamIterator& operator++() {
+      advance();
+      return *this;
+    }
+    QueryParamIterator operator++(int) {
+      auto copy = *this;
+      advance();
+      return copy;
+    }
+
+    friend bool operator==(
+        const QueryParamIterator& a, const QueryParamIterator& b) {
+      return a.param_.first.begin() == b.param_.first.begin() &&
+          a.rest_.begin() == b.rest_.begin();
+    }
+    friend bool operator!=(
+        const QueryParamIterator& a, const QueryParamIterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    void advance();
+
+    StringPiece rest_;
+    value_type param_;
+  };
+
+  class QueryParams {
+   public:
+    explicit QueryParams(StringPiece query) : query_(query) {}
+    QueryParamIterator begin() const { return QueryParamIterator(query_); }
+    QueryParamIterator end() const { return QueryParamIterator(); }
+
+   private:
+    StringPiece query_;
+  };
+
+  QueryParams queryParams() const { return QueryParams(query_); }
+
+ private:
+  UriView() = default;
+
+  StringPiece scheme_;
+  StringPiece authority_;
+  StringPiece username_;
+  StringPiece password_;
+  StringPiece host_;
+  StringPiece path_;
+  StringPiece query_;
+  StringPiece fragment_;
+  uint16_t port_{0};
+  bool hasAuthority_{false};
+};
+
 /**
  * Class representing a URI.
  *
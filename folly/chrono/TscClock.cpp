@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/chrono/TscClock.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <thread>
+
+#include <folly/FileUtil.h>
+#include <folly/Portability.h>
+#include <folly/ScopeGuard.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#if defined(_MSC_VER) && (FOLLY_X64 || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__GNUC__) && (FOLLY_X64 || defined(__i386__))
+#include <cpuid.h>
+#endif
+
+namespace folly {
+
+namespace detail {
+
+std::atomic<const TscCalibration*> tsc_clock_calibration{nullptr};
+
+} // namespace detail
+
+namespace {
+
+constexpr auto kCalibrationInterval = std::chrono::milliseconds(10);
+
+// Whether the counter ticks at a constant rate regardless of frequency
+// scaling and sleep states.
+bool hasInvariantCounter() {
+#if defined(_MSC_VER) && (FOLLY_X64 || defined(_M_IX86))
+  int reg[4];
+  __cpuid(reg, 0x80000000);
+  if (static_cast<unsigned>(reg[0]) < 0x80000007) {
+    return false;
+  }
+  __cpuid(reg, 0x80000007);
+  return (reg[3] & (1 << 8)) != 0;
+#elif defined(__GNUC__) && (FOLLY_X64 || defined(__i386__))
+  unsigned a, b, c, d;
+  if (!__get_cpuid(0x80000007, &a, &b, &c, &d)) {
+    return false;
+  }
+  return (d & (1u << 8)) != 0;
+#elif FOLLY_AARCH64 && !FOLLY_MOBILE
+  // The generic timer runs at a fixed frequency and is synchronized across
+  // cores by the architecture.
+  return true;
+#else
+  return false;
+#endif
+}
+
+// The kernel drops the TSC from the available clocksources when its own
+// watchdog finds it unstable or unsynchronized across cores.
+bool kernelTrustsCounter() {
+#if defined(__linux__) && (FOLLY_X64 || defined(__i386__))
+  std::string sources;
+  if (!readFile(
+          "/sys/devices/system/clocksource/clocksource0/available_clocksource",
+          sources)) {
+    // No sysfs (e.g. some containers); go by CPUID alone.
+    return true;
+  }
+  for (auto& ch : sources) {
+    if (ch == '\n') {
+      ch = ' ';
+    }
+  }
+  return (" " + sources + " ").find(" tsc ") != std::string::npos;
+#else
+  return true;
+#endif
+}
+
+struct Sample {
+  std::uint64_t ticks;
+  std::int64_t nanos;
+};
+
+// Reads the counter and steady_clock as close together as possible, keeping
+// the tightest of a few attempts.
+Sample samplePair() {
+  Sample best{0, 0};
+  auto bestSpread = std::numeric_limits<std::uint64_t>::max();
+  for (int i = 0; i < 8; ++i) {
+    auto before = hardware_timestamp();
+    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+                     .count();
+    auto after = hardware_timestamp();
+    if (after >= before && after - before < bestSpread) {
+      bestSpread = after - before;
+      best = {before + (after - before) / 2, nanos};
+    }
+  }
+  return best;
+}
+
+detail::TscCalibration measure() {
+  detail::TscCalibration cal{};
+  if (!hasInvariantCounter() || !kernelTrustsCounter()) {
+    return cal;
+  }
+
+  auto start = samplePair();
+  std::this_thread::sleep_for(kCalibrationInterval);
+  auto end = samplePair();
+  if (end.ticks <= start.ticks || end.nanos <= start.nanos) {
+    return cal;
+  }
+
+#if FOLLY_AARCH64 && !FOLLY_MOBILE && !defined(_MSC_VER)
+  std::uint64_t frequency;
+  asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+  double ticksPerSecond = static_cast<double>(frequency);
+#else
+  double ticksPerSecond = static_cast<double>(end.ticks - start.ticks) * 1e9 /
+      static_cast<double>(end.nanos - start.nanos);
+#endif
+  if (!(ticksPerSecond >= 1e6)) {
+    return cal;
+  }
+
+  // Largest shift (at most 32) that keeps the multiplier below 2^32.
+  double nanosPerTick = 1e9 / ticksPerSecond;
+  std::uint32_t shift = 32;
+  while (shift > 0 && std::ldexp(nanosPerTick, shift) >= 4294967296.0) {
+    --shift;
+  }
+
+  cal.reliable = true;
+  cal.shift = shift;
+  cal.mult = static_cast<std::uint64_t>(
+      std::llround(std::ldexp(nanosPerTick, shift)));
+  cal.baseTicks = end.ticks;
+  cal.baseNanos = end.nanos;
+  cal.ticksPerSecond = ticksPerSecond;
+  return cal;
+}
+
+} // namespace
+
+namespace detail {
+
+const TscCalibration& tsc_clock_calibrate() noexcept {
+  static const TscCalibration calibration = measure();
+  tsc_clock_calibration.store(&calibration, std::memory_order_release);
+  return calibration;
+}
+
+} // namespace detail
+
+bool tsc_clock::check_cross_core_consistency(
+    std::chrono::nanoseconds tolerance) {
+  auto const& cal = calibration();
+  if (!cal.reliable) {
+    return true;
+  }
+#if defined(__linux__)
+  cpu_set_t original;
+  if (sched_getaffinity(0, sizeof(original), &original) != 0) {
+    return false;
+  }
+  SCOPE_EXIT {
+    sched_setaffinity(0, sizeof(original), &original);
+  };
+
+  bool first = true;
+  std::int64_t reference = 0;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (!CPU_ISSET(cpu, &original)) {
+      continue;
+    }
+    cpu_set_t single;
+    CPU_ZERO(&single);
+    CPU_SET(cpu, &single);
+    if (sched_setaffinity(0, sizeof(single), &single) != 0) {
+      return false;
+    }
+    auto sample = samplePair();
+    // Comparing offsets between CPUs cancels out any drift accumulated
+    // since calibration.
+    auto offset = cal.toNanos(sample.ticks) - sample.nanos;
+    if (first) {
+      reference = offset;
+      first = false;
+    } else if (std::llabs(offset - reference) > tolerance.count()) {
+      return false;
+    }
+  }
+  return true;
+#else
+  (void)tolerance;
+  return false;
+#endif
+}
+
+} // namespace folly
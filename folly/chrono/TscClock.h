@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <folly/CPortability.h>
+#include <folly/Likely.h>
+#include <folly/chrono/Hardware.h>
+
+namespace folly {
+
+namespace detail {
+
+/**
+ * Mapping from timestamp-counter ticks to steady_clock nanoseconds, measured
+ * once per process. ns = baseNanos + ((ticks - baseTicks) * mult) >> shift.
+ */
+struct TscCalibration {
+  bool reliable;
+  std::uint32_t shift;
+  std::uint64_t mult;
+  std::uint64_t baseTicks;
+  std::int64_t baseNanos;
+  double ticksPerSecond;
+
+  std::int64_t toNanos(std::uint64_t ticks) const noexcept {
+    if (FOLLY_LIKELY(ticks >= baseTicks)) {
+      return baseNanos + static_cast<std::int64_t>(scale(ticks - baseTicks));
+    }
+    // Another core's counter may trail the calibrating core's slightly.
+    return baseNanos - static_cast<std::int64_t>(scale(baseTicks - ticks));
+  }
+
+  // (delta * mult) >> shift without a 128-bit product; shift <= 32 and
+  // mult < 2^32.
+  std::uint64_t scale(std::uint64_t delta) const noexcept {
+    return ((delta >> 32) * mult << (32 - shift)) +
+        ((delta & 0xffffffff) * mult >> shift);
+  }
+};
+
+extern std::atomic<const TscCalibration*> tsc_clock_calibration;
+
+const TscCalibration& tsc_clock_calibrate() noexcept;
+
+} // namespace detail
+
+/**
+ * tsc_clock
+ *
+ * A steady TrivialClock that reads the CPU timestamp counter (rdtsc on x86,
+ * cntvct_el0 on aarch64) and converts it to nanoseconds with a per-process
+ * calibration, without a syscall or a vDSO call. A read costs a few
+ * nanoseconds, which makes it suitable for hot-path instrumentation.
+ *
+ * The counter is used only when it is known to tick at a constant rate and
+ * to be synchronized across cores: on x86 the CPU must advertise an
+ * invariant TSC and, on Linux, the kernel must not have disqualified the TSC
+ * as a clocksource. Everywhere else now() falls back to
+ * std::chrono::steady_clock, so tsc_clock is always safe to use.
+ *
+ * The first call calibrates the counter against steady_clock, which takes a
+ * few milliseconds; call calibrate() at startup to keep that off the hot
+ * path. Time points share steady_clock's epoch at calibration time, but the
+ * two clocks may slowly drift apart by the calibration error (a few parts per
+ * million), so do not mix their time points in long-lived comparisons.
+ */
+struct tsc_clock {
+  using duration = std::chrono::nanoseconds;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = std::chrono::time_point<tsc_clock>;
+  constexpr static bool is_steady = true;
+
+  static time_point now() noexcept {
+    auto const& cal = calibration();
+    if (FOLLY_UNLIKELY(!cal.reliable)) {
+      return time_point(std::chrono::duration_cast<duration>(
+          std::chrono::steady_clock::now().time_since_epoch()));
+    }
+    return time_point(duration(cal.toNanos(hardware_timestamp())));
+  }
+
+  /**
+   * Performs the calibration if it has not happened yet.
+   */
+  static void calibrate() noexcept { (void)calibration(); }
+
+  /**
+   * Whether now() reads the timestamp counter rather than falling back to
+   * steady_clock.
+   */
+  static bool is_tsc_reliable() noexcept { return calibration().reliable; }
+
+  /**
+   * The measured counter frequency, or 0 when the counter is not used.
+   */
+  static double ticks_per_second() noexcept {
+    return calibration().ticksPerSecond;
+  }
+
+  /**
+   * Migrates the calling thread to each CPU in its affinity mask in turn and
+   * checks that the counters, mapped to nanoseconds, agree with steady_clock
+   * to within `tolerance` relative to the first CPU. The thread's affinity is
+   * restored afterwards. Returns true when the check passes or the counter is
+   * not in use; returns false when the counters disagree or the affinity
+   * cannot be changed.
+   *
+   * This is expensive on large machines and is meant for startup or
+   * diagnostics, not for the hot path.
+   */
+  static bool check_cross_core_consistency(
+      std::chrono::nanoseconds tolerance = std::chrono::microseconds(50));
+
+ private:
+  static const detail::TscCalibration& calibration() noexcept {
+    auto cal = detail::tsc_clock_calibration.load(std::memory_order_acquire);
+    return FOLLY_LIKELY(cal != nullptr) ? *cal
+                                        : detail::tsc_clock_calibrate();
+  }
+};
+
+} // namespace folly
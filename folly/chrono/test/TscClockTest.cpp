@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/chrono/TscClock.h>
+
+#include <thread>
+
+#include <folly/portability/GTest.h>
+
+using namespace std::chrono_literals;
+
+TEST(TscClockTest, Monotonic) {
+  auto prev = folly::tsc_clock::now();
+  for (int i = 0; i < 100000; ++i) {
+    auto cur = folly::tsc_clock::now();
+    EXPECT_LE(prev, cur);
+    prev = cur;
+  }
+}
+
+TEST(TscClockTest, TracksSteadyClock) {
+  folly::tsc_clock::calibrate();
+  if (folly::tsc_clock::is_tsc_reliable()) {
+    EXPECT_GT(folly::tsc_clock::ticks_per_second(), 1e6);
+  }
+
+  auto steadyStart = std::chrono::steady_clock::now();
+  auto tscStart = folly::tsc_clock::now();
+  std::this_thread::sleep_for(100ms);
+  auto tscEnd = folly::tsc_clock::now();
+  auto steadyEnd = std::chrono::steady_clock::now();
+
+  auto tscElapsed = tscEnd - tscStart;
+  auto steadyElapsed = steadyEnd - steadyStart;
+  EXPECT_GE(tscElapsed, 99ms);
+  EXPECT_LE(tscElapsed, steadyElapsed + 1ms);
+
+  // Time points start out on steady_clock's epoch.
+  auto offset = tscStart.time_since_epoch() - steadyStart.time_since_epoch();
+  EXPECT_LT(std::chrono::abs(offset), 10ms);
+}
+
+TEST(TscClockTest, CrossCoreConsistency) {
+  if (!folly::kIsLinux) {
+    GTEST_SKIP() << "affinity control is Linux-only";
+  }
+  EXPECT_TRUE(folly::tsc_clock::check_cross_core_consistency());
+}
@@ -16,8 +16,12 @@
 
 #include <folly/cli/ProgramOptions.h>
 
+#include <mutex>
+#include <typeindex>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <boost/version.hpp>
 #include <glog/logging.h>
@@ -27,6 +31,7 @@
 #endif
 
 #include <folly/Conv.h>
+#include <folly/ExceptionString.h>
 #include <folly/Portability.h>
 #include <folly/portability/GFlags.h>
 
@@ -341,4 +346,102 @@ NestedCommandLineParseResult parseNestedCommandLine(
       po::command_line_parser(cmdline), desc, style);
 }
 
+namespace detail {
+
+namespace {
+
+struct CachedGFlagRegistry {
+  std::mutex mutex;
+  std::unordered_map<
+      std::string,
+      std::vector<
+          std::pair<std::type_index, std::shared_ptr<CachedGFlagSlotBase>>>>
+      slots;
+
+  static CachedGFlagRegistry& get() {
+    static auto* registry = new CachedGFlagRegistry();
+    return *registry;
+  }
+
+  // Must hold mutex.
+  void refresh(const std::string& name) {
+    auto it = slots.find(name);
+    if (it == slots.end()) {
+      return;
+    }
+    std::string value;
+    CHECK(gflags::GetCommandLineOption(name.c_str(), &value));
+    for (auto& slot : it->second) {
+      // A cache may read the flag as a narrower type than the flag's own
+      // (e.g. int32_t for a string flag), so not every value converts.
+      // Such a cache keeps its last value rather than failing the caller.
+      try {
+        slot.second->update(value);
+      } catch (const std::exception& e) {
+        LOG(ERROR) << "Can't update cached flag " << name << " to '"
+                   << value << "': " << exceptionStr(e);
+      }
+    }
+  }
+};
+
+} // namespace
+
+std::shared_ptr<CachedGFlagSlotBase> getCachedGFlagSlot(
+    StringPiece name,
+    const std::type_info& type,
+    std::shared_ptr<CachedGFlagSlotBase> (*makeSlot)()) {
+  auto& registry = CachedGFlagRegistry::get();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto key = name.str();
+  auto& slots = registry.slots[key];
+  for (auto& slot : slots) {
+    if (slot.first == type) {
+      return slot.second;
+    }
+  }
+  std::string value;
+  if (!gflags::GetCommandLineOption(key.c_str(), &value)) {
+    if (slots.empty()) {
+      registry.slots.erase(key);
+    }
+    return nullptr;
+  }
+  auto slot = makeSlot();
+  try {
+    slot->update(value);
+  } catch (...) {
+    if (slots.empty()) {
+      registry.slots.erase(key);
+    }
+    throw;
+  }
+  slots.emplace_back(type, slot);
+  return slot;
+}
+
+} // namespace detail
+
+bool setGFlag(StringPiece name, StringPiece value) {
+  auto key = name.str();
+  if (gflags::SetCommandLineOption(key.c_str(), value.str().c_str())
+          .empty()) {
+    return false;
+  }
+  auto& registry = detail::CachedGFlagRegistry::get();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  // Reads the current value rather than using `value`, so that concurrent
+  // setGFlag() calls leave the cache matching whichever one won.
+  registry.refresh(key);
+  return true;
+}
+
+void refreshCachedGFlags() {
+  auto& registry = detail::CachedGFlagRegistry::get();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto& entry : registry.slots) {
+    registry.refresh(entry.first);
+  }
+}
+
 } // namespace folly
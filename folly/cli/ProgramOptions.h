@@ -16,9 +16,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <type_traits>
+
 #include <boost/program_options.hpp>
 
+#include <folly/Conv.h>
 #include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/concurrency/AtomicSharedPtr.h>
 #include <folly/portability/GFlags.h>
 
 namespace folly {
@@ -87,4 +95,95 @@ NestedCommandLineParseResult parseNestedCommandLine(
     boost::program_options::command_line_style::style_t style =
         boost::program_options::command_line_style::default_style);
 
+namespace detail {
+
+// One cached copy of a GFlag's value, as a T. Slots are shared by all the
+// CachedGFlag<T> of the same flag and live as long as the process.
+class CachedGFlagSlotBase {
+ public:
+  virtual ~CachedGFlagSlotBase() = default;
+  virtual void update(const std::string& value) = 0;
+};
+
+template <class T, bool = std::is_arithmetic_v<T>>
+class CachedGFlagSlot : public CachedGFlagSlotBase {
+ public:
+  void update(const std::string& value) override {
+    value_.store(folly::to<T>(value), std::memory_order_release);
+  }
+  T get() const { return value_.load(std::memory_order_acquire); }
+
+ private:
+  std::atomic<T> value_{};
+};
+
+template <class T>
+class CachedGFlagSlot<T, false> : public CachedGFlagSlotBase {
+ public:
+  void update(const std::string& value) override {
+    value_.store(std::make_shared<const T>(folly::to<T>(value)));
+  }
+  T get() const { return *value_.load(); }
+
+ private:
+  folly::atomic_shared_ptr<const T> value_;
+};
+
+// Returns the slot for flag `name` (creating and filling it if needed), or
+// nullptr if there's no such flag. makeSlot is only called for new slots.
+std::shared_ptr<CachedGFlagSlotBase> getCachedGFlagSlot(
+    StringPiece name,
+    const std::type_info& type,
+    std::shared_ptr<CachedGFlagSlotBase> (*makeSlot)());
+
+} // namespace detail
+
+// Reads a GFlag by name without going through gflags on every read.
+//
+// gflags::GetCommandLineOption() takes the gflags registry lock and parses
+// the value for each call. A CachedGFlag keeps the value in an atomic
+// (arithmetic types) or an atomically swapped immutable snapshot (anything
+// else, e.g. std::string), so get() never blocks, even while the flag is
+// being updated.
+//
+// The cache is kept up to date by setGFlag(). Flags changed any other way,
+// e.g. by assigning to FLAGS_foo or calling gflags::SetCommandLineOption()
+// directly, are picked up by the next refreshCachedGFlags().
+//
+// T need not be the flag's own type, as long as folly::to<T>() accepts the
+// flag's value. If a later value doesn't convert, the cache keeps its old
+// value and the failure is logged.
+template <class T>
+class CachedGFlag {
+ public:
+  // Throws std::invalid_argument if there is no flag with this name, or
+  // folly::ConversionError if its current value isn't a valid T.
+  explicit CachedGFlag(StringPiece name)
+      : slot_(std::static_pointer_cast<detail::CachedGFlagSlot<T>>(
+            detail::getCachedGFlagSlot(name, typeid(T), &makeSlot))) {
+    if (!slot_) {
+      throw std::invalid_argument("no such flag: " + name.str());
+    }
+  }
+
+  T get() const { return slot_->get(); }
+  T operator*() const { return get(); }
+
+ private:
+  static std::shared_ptr<detail::CachedGFlagSlotBase> makeSlot() {
+    return std::make_shared<detail::CachedGFlagSlot<T>>();
+  }
+
+  std::shared_ptr<detail::CachedGFlagSlot<T>> slot_;
+};
+
+// Sets a GFlag through gflags::SetCommandLineOption(), then updates every
+// CachedGFlag of it. Returns false if there is no such flag, or the value
+// is invalid for it.
+bool setGFlag(StringPiece name, StringPiece value);
+
+// Reloads every CachedGFlag from gflags, to pick up changes that didn't go
+// through setGFlag().
+void refreshCachedGFlags();
+
 } // namespace folly
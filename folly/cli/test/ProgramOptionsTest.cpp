@@ -22,8 +22,13 @@
 #include <folly/portability/GTest.h>
 
 #include <cstdlib>
+#include <thread>
 #include <glog/logging.h>
 
+FOLLY_GFLAGS_DEFINE_int32(cached_gflag_test_int, 1, "For CachedGFlag tests");
+FOLLY_GFLAGS_DEFINE_string(
+    cached_gflag_test_string, "a", "For CachedGFlag tests");
+
 namespace folly {
 namespace test {
 
@@ -206,5 +211,78 @@ TEST(ProgramOptionsTest, GNUStyleSubCommandUnrecognizedOptionFirst) {
           }));
 }
 
+TEST(CachedGFlagTest, GetAndSet) {
+  CachedGFlag<int32_t> intFlag("cached_gflag_test_int");
+  CachedGFlag<std::string> stringFlag("cached_gflag_test_string");
+  EXPECT_EQ(1, intFlag.get());
+  EXPECT_EQ("a", *stringFlag);
+
+  EXPECT_TRUE(setGFlag("cached_gflag_test_int", "42"));
+  EXPECT_TRUE(setGFlag("cached_gflag_test_string", "hello"));
+  EXPECT_EQ(42, intFlag.get());
+  EXPECT_EQ(42, FLAGS_cached_gflag_test_int);
+  EXPECT_EQ("hello", stringFlag.get());
+  // Caches created later see the current value, and read it as their type.
+  EXPECT_EQ(42, CachedGFlag<int64_t>("cached_gflag_test_int").get());
+  EXPECT_EQ("42", CachedGFlag<std::string>("cached_gflag_test_int").get());
+
+  EXPECT_FALSE(setGFlag("cached_gflag_test_int", "not a number"));
+  EXPECT_EQ(42, intFlag.get());
+  EXPECT_FALSE(setGFlag("cached_gflag_test_no_such_flag", "1"));
+  EXPECT_THROW(
+      CachedGFlag<int>("cached_gflag_test_no_such_flag"),
+      std::invalid_argument);
+
+  // Direct assignments show up after a refresh.
+  FLAGS_cached_gflag_test_int = 7;
+  EXPECT_EQ(42, intFlag.get());
+  refreshCachedGFlags();
+  EXPECT_EQ(7, intFlag.get());
+}
+
+TEST(CachedGFlagTest, UnconvertibleValue) {
+  ASSERT_TRUE(setGFlag("cached_gflag_test_string", "not a number"));
+  EXPECT_THROW(
+      CachedGFlag<int32_t>("cached_gflag_test_string"), ConversionError);
+
+  ASSERT_TRUE(setGFlag("cached_gflag_test_string", "5"));
+  CachedGFlag<int32_t> intFlag("cached_gflag_test_string");
+  CachedGFlag<std::string> stringFlag("cached_gflag_test_string");
+  EXPECT_EQ(5, intFlag.get());
+
+  // The flag is still set, and the caches that can hold it are updated.
+  EXPECT_TRUE(setGFlag("cached_gflag_test_string", "five"));
+  EXPECT_EQ("five", FLAGS_cached_gflag_test_string);
+  EXPECT_EQ("five", stringFlag.get());
+  EXPECT_EQ(5, intFlag.get());
+
+  FLAGS_cached_gflag_test_string = "six";
+  refreshCachedGFlags();
+  EXPECT_EQ("six", stringFlag.get());
+  EXPECT_EQ(5, intFlag.get());
+
+  EXPECT_TRUE(setGFlag("cached_gflag_test_string", "6"));
+  EXPECT_EQ(6, intFlag.get());
+  ASSERT_TRUE(setGFlag("cached_gflag_test_string", "aaa"));
+}
+
+TEST(CachedGFlagTest, ConcurrentReads) {
+  CachedGFlag<std::string> flag("cached_gflag_test_string");
+  std::atomic<bool> done{false};
+  std::thread reader([&] {
+    while (!done.load()) {
+      auto value = flag.get();
+      EXPECT_TRUE(value.size() == 3 && value[0] == value[2]) << value;
+    }
+  });
+  for (int i = 0; i < 1000; ++i) {
+    auto value = std::string(3, char('a' + i % 26));
+    ASSERT_TRUE(setGFlag("cached_gflag_test_string", value));
+    EXPECT_EQ(value, flag.get());
+  }
+  done = true;
+  reader.join();
+}
+
 } // namespace test
 } // namespace folly
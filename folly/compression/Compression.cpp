@@ -50,22 +50,30 @@
 #endif
 
 #include <algorithm>
+#include <exception>
 #include <unordered_set>
 
 #include <folly/Conv.h>
+#include <folly/Executor.h>
+#include <folly/Function.h>
 #include <folly/Memory.h>
 #include <folly/Portability.h>
 #include <folly/Random.h>
 #include <folly/ScopeGuard.h>
 #include <folly/Varint.h>
+#include <folly/compression/CompressionContextPoolSingletons.h>
 #include <folly/compression/Utils.h>
 #include <folly/io/Cursor.h>
+#include <folly/io/IOBufQueue.h>
 #include <folly/lang/Bits.h>
 #include <folly/stop_watch.h>
+#include <folly/synchronization/Baton.h>
 
 using folly::io::compression::detail::dataStartsWithLE;
 using folly::io::compression::detail::prefixToStringLE;
 
+namespace contexts = folly::compression::contexts;
+
 namespace folly {
 namespace io {
 
@@ -323,6 +331,73 @@ bool StreamCodec::uncompressStream(
   return done;
 }
 
+/* static */ std::pair<ByteRange, bool> StreamCodec::nextQueueInput(
+    IOBufQueue& input) {
+  while (input.front() && input.front()->length() == 0 &&
+         input.front()->isChained()) {
+    input.pop_front();
+  }
+  auto const head = input.front();
+  if (!head) {
+    return {ByteRange(), true};
+  }
+  return {ByteRange(head->data(), head->length()), !head->isChained()};
+}
+
+bool StreamCodec::compressToQueue(
+    IOBufQueue& input, IOBufQueue& output, StreamCodec::FlushOp flushOp) {
+  if (input.empty() && flushOp == StreamCodec::FlushOp::NONE) {
+    return false;
+  }
+  for (;;) {
+    auto next = nextQueueInput(input);
+    auto& in = next.first;
+    bool const last = next.second;
+    auto const op = last ? flushOp : StreamCodec::FlushOp::NONE;
+    auto const space =
+        output.preallocate(kMinQueueOutputSpace, kQueueOutputAllocationSize);
+    MutableByteRange out(static_cast<uint8_t*>(space.first), space.second);
+
+    size_t const inSize = in.size();
+    bool const done = compressStream(in, out, op);
+    input.trimStart(inSize - in.size());
+    output.postallocate(space.second - out.size());
+
+    if (last && (op == StreamCodec::FlushOp::NONE ? in.empty() : done)) {
+      return done;
+    }
+  }
+}
+
+bool StreamCodec::uncompressToQueue(
+    IOBufQueue& input, IOBufQueue& output, StreamCodec::FlushOp flushOp) {
+  if (input.empty() && flushOp == StreamCodec::FlushOp::NONE) {
+    return false;
+  }
+  for (;;) {
+    auto next = nextQueueInput(input);
+    auto& in = next.first;
+    bool const last = next.second;
+    auto const op = last ? flushOp : StreamCodec::FlushOp::NONE;
+    auto const space =
+        output.preallocate(kMinQueueOutputSpace, kQueueOutputAllocationSize);
+    MutableByteRange out(static_cast<uint8_t*>(space.first), space.second);
+
+    size_t const inSize = in.size();
+    bool const done = uncompressStream(in, out, op);
+    input.trimStart(inSize - in.size());
+    output.postallocate(space.second - out.size());
+
+    if (done) {
+      return true;
+    }
+    // Once the output isn't full, all that the input gives is out.
+    if (last && in.empty() && !out.empty()) {
+      return false;
+    }
+  }
+}
+
 static std::unique_ptr<IOBuf> addOutputBuffer(
     MutableByteRange& output, uint64_t size) {
   DCHECK(output.empty());
@@ -721,9 +796,16 @@ class LZ4FrameCodec final : public Codec {
 
   int level_;
 #ifdef FOLLY_USE_LZ4_FAST_RESET
-  LZ4F_compressionContext_t cctx_{nullptr};
+  // The pool singletons are always available with fast reset.
+  contexts::LZ4F_CCtx_Pool::Ref cctx_{contexts::getNULL_LZ4F_CCtx()};
 #endif
+#ifdef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
+  contexts::LZ4F_DCtx_Pool::Ref dctx_{contexts::getNULL_LZ4F_DCtx()};
+  LZ4F_decompressionContext_t dctx() const { return dctx_.get(); }
+#else
   LZ4F_decompressionContext_t dctx_{nullptr};
+  LZ4F_decompressionContext_t dctx() const { return dctx_; }
+#endif
   bool dirty_{false};
 };
 
@@ -762,10 +844,18 @@ void LZ4FrameCodec::resetDCtx() {
   if (dctx_ && !dirty_) {
     return;
   }
+#ifdef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
+  if (dctx_) {
+    LZ4F_resetDecompressionContext(dctx_.get());
+  } else {
+    dctx_ = contexts::getLZ4F_DCtx(); // Gives us a clean context
+  }
+#else
   if (dctx_) {
     LZ4F_freeDecompressionContext(dctx_);
   }
   lz4FrameThrowOnError(LZ4F_createDecompressionContext(&dctx_, 100));
+#endif
   dirty_ = false;
 }
 
@@ -786,13 +876,10 @@ LZ4FrameCodec::LZ4FrameCodec(int level, CodecType type)
 }
 
 LZ4FrameCodec::~LZ4FrameCodec() {
+#ifndef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
   if (dctx_) {
     LZ4F_freeDecompressionContext(dctx_);
   }
-#ifdef FOLLY_USE_LZ4_FAST_RESET
-  if (cctx_) {
-    LZ4F_freeCompressionContext(cctx_);
-  }
 #endif
 }
 
@@ -806,7 +893,7 @@ std::unique_ptr<IOBuf> LZ4FrameCodec::doCompress(const IOBuf* data) {
 
 #ifdef FOLLY_USE_LZ4_FAST_RESET
   if (!cctx_) {
-    lz4FrameThrowOnError(LZ4F_createCompressionContext(&cctx_, LZ4F_VERSION));
+    cctx_ = contexts::getLZ4F_CCtx();
   }
 #endif
 
@@ -820,7 +907,7 @@ std::unique_ptr<IOBuf> LZ4FrameCodec::doCompress(const IOBuf* data) {
   const size_t written = lz4FrameThrowOnError(
 #ifdef FOLLY_USE_LZ4_FAST_RESET
       LZ4F_compressFrame_usingCDict(
-          cctx_,
+          cctx_.get(),
           buf->writableTail(),
           buf->tailroom(),
           data->data(),
@@ -884,7 +971,7 @@ std::unique_ptr<IOBuf> LZ4FrameCodec::doUncompress(
     // Decompress
     size_t inSize = in.size();
     code = lz4FrameThrowOnError(
-        LZ4F_decompress(dctx_, out, &outSize, in.data(), &inSize, &options));
+        LZ4F_decompress(dctx(), out, &outSize, in.data(), &inSize, &options));
     if (in.empty() && outSize == 0 && code != 0) {
       // We passed no input, no output was produced, and the frame isn't over
       // No more forward progress is possible
@@ -901,6 +988,53 @@ std::unique_ptr<IOBuf> LZ4FrameCodec::doUncompress(
   return queue.move();
 }
 
+/**
+ * Returns the length of the LZ4 frame, or skippable frame, at the start of
+ * data, walking its block headers.
+ */
+size_t lz4FrameLength(ByteRange data) {
+  constexpr uint32_t kSkippableMagicMask = 0xFFFFFFF0;
+  constexpr uint32_t kSkippableMagicLE = 0x184D2A50;
+  size_t pos = 0;
+  auto skip = [&](size_t n) {
+    if (data.size() - pos < n) {
+      throw std::runtime_error("LZ4Frame error: Incomplete frame");
+    }
+    pos += n;
+  };
+  auto read8 = [&] {
+    skip(1);
+    return data[pos - 1];
+  };
+  auto read32 = [&] {
+    skip(4);
+    return Endian::little(loadUnaligned<uint32_t>(data.data() + pos - 4));
+  };
+
+  auto const magic = read32();
+  if ((magic & kSkippableMagicMask) == kSkippableMagicLE) {
+    skip(read32());
+    return pos;
+  }
+  if (magic != kLZ4FrameMagicLE) {
+    throw std::runtime_error("LZ4Frame error: Invalid magic number");
+  }
+  auto const flags = read8();
+  bool const blockChecksum = flags & 0x10;
+  bool const contentSize = flags & 0x08;
+  bool const contentChecksum = flags & 0x04;
+  bool const dictId = flags & 0x01;
+  // Block descriptor, optional content size and dictionary id, and checksum
+  skip(1 + (contentSize ? 8 : 0) + (dictId ? 4 : 0) + 1);
+  while (auto blockSize = read32()) {
+    skip((blockSize & 0x7FFFFFFF) + (blockChecksum ? 4 : 0));
+  }
+  if (contentChecksum) {
+    skip(4);
+  }
+  return pos;
+}
+
 #endif // LZ4_VERSION_NUMBER >= 10301
 #endif // FOLLY_HAVE_LIBLZ4
 
@@ -1056,7 +1190,6 @@ class LZMA2StreamCodec final : public StreamCodec {
   static std::unique_ptr<Codec> createCodec(int level, CodecType type);
   static std::unique_ptr<StreamCodec> createStream(int level, CodecType type);
   explicit LZMA2StreamCodec(int level, CodecType type);
-  ~LZMA2StreamCodec() override;
 
   std::vector<std::string> validPrefixes() const override;
   bool canUncompress(
@@ -1086,8 +1219,8 @@ class LZMA2StreamCodec final : public StreamCodec {
   bool flushVarintBuffer(MutableByteRange& output);
   void resetVarintBuffer();
 
-  Optional<lzma_stream> cstream_{};
-  Optional<lzma_stream> dstream_{};
+  contexts::LZMA_Stream_Pool::Ref cstream_{contexts::getNULL_LZMA_Stream()};
+  contexts::LZMA_Stream_Pool::Ref dstream_{contexts::getNULL_LZMA_Stream()};
 
   std::array<uint8_t, kMaxVarintLength64> varintBuffer_;
   ByteRange varintToEncode_;
@@ -1153,17 +1286,6 @@ LZMA2StreamCodec::LZMA2StreamCodec(int level, CodecType type)
   level_ = level;
 }
 
-LZMA2StreamCodec::~LZMA2StreamCodec() {
-  if (cstream_) {
-    lzma_end(cstream_.get_pointer());
-    cstream_.reset();
-  }
-  if (dstream_) {
-    lzma_end(dstream_.get_pointer());
-    dstream_.reset();
-  }
-}
-
 uint64_t LZMA2StreamCodec::doMaxUncompressedLength() const {
   // From lzma/base.h: "Stream is roughly 8 EiB (2^63 bytes)"
   return uint64_t(1) << 63;
@@ -1181,10 +1303,10 @@ void LZMA2StreamCodec::doResetStream() {
 
 void LZMA2StreamCodec::resetCStream() {
   if (!cstream_) {
-    cstream_.assign(LZMA_STREAM_INIT);
+    cstream_ = contexts::getLZMA_EncoderStream();
   }
   lzma_ret const rc =
-      lzma_easy_encoder(cstream_.get_pointer(), level_, LZMA_CHECK_NONE);
+      lzma_easy_encoder(cstream_.get(), level_, LZMA_CHECK_NONE);
   if (rc != LZMA_OK) {
     throw std::runtime_error(folly::to<std::string>(
         "LZMA2StreamCodec: lzma_easy_encoder error: ", rc));
@@ -1193,10 +1315,10 @@ void LZMA2StreamCodec::resetCStream() {
 
 void LZMA2StreamCodec::resetDStream() {
   if (!dstream_) {
-    dstream_.assign(LZMA_STREAM_INIT);
+    dstream_ = contexts::getLZMA_DecoderStream();
   }
   lzma_ret const rc = lzma_auto_decoder(
-      dstream_.get_pointer(), std::numeric_limits<uint64_t>::max(), 0);
+      dstream_.get(), std::numeric_limits<uint64_t>::max(), 0);
   if (rc != LZMA_OK) {
     throw std::runtime_error(folly::to<std::string>(
         "LZMA2StreamCodec: lzma_auto_decoder error: ", rc));
@@ -1281,7 +1403,7 @@ bool LZMA2StreamCodec::doCompressStream(
     output.uncheckedAdvance(output.size() - cstream_->avail_out);
   };
   lzma_ret const rc = lzmaThrowOnError(
-      lzma_code(cstream_.get_pointer(), lzmaTranslateFlush(flushOp)));
+      lzma_code(cstream_.get(), lzmaTranslateFlush(flushOp)));
   switch (flushOp) {
     case StreamCodec::FlushOp::NONE:
       return false;
@@ -1370,10 +1492,10 @@ bool LZMA2StreamCodec::doUncompressStream(
   switch (flushOp) {
     case StreamCodec::FlushOp::NONE:
     case StreamCodec::FlushOp::FLUSH:
-      rc = lzmaThrowOnError(lzma_code(dstream_.get_pointer(), LZMA_RUN));
+      rc = lzmaThrowOnError(lzma_code(dstream_.get(), LZMA_RUN));
       break;
     case StreamCodec::FlushOp::END:
-      rc = lzmaThrowOnError(lzma_code(dstream_.get_pointer(), LZMA_FINISH));
+      rc = lzmaThrowOnError(lzma_code(dstream_.get(), LZMA_FINISH));
       break;
     default:
       throw std::invalid_argument("LZMA2StreamCodec: invalid flush");
@@ -1977,6 +2099,78 @@ Factory const& getFactory(CodecType type) {
   }
   return codecFactories[idx];
 }
+
+void checkParallelCodec(CodecType type) {
+  if (!hasParallelCodec(type)) {
+    throw std::invalid_argument(to<std::string>(
+        "Compression type ", type, " doesn't support parallel compression"));
+  }
+}
+
+/**
+ * Returns the length of the frame at the start of data.
+ */
+size_t frameLength(CodecType type, ByteRange data) {
+  switch (type) {
+#if FOLLY_HAVE_LIBZSTD
+    case CodecType::ZSTD:
+    case CodecType::ZSTD_FAST: {
+      size_t const rc = ZSTD_findFrameCompressedSize(data.data(), data.size());
+      if (ZSTD_isError(rc)) {
+        throw std::runtime_error(
+            to<std::string>("ZSTD returned an error: ", ZSTD_getErrorName(rc)));
+      }
+      return rc;
+    }
+#endif
+#if (FOLLY_HAVE_LIBLZ4 && LZ4_VERSION_NUMBER >= 10301)
+    case CodecType::LZ4_FRAME:
+      return lz4FrameLength(data);
+#endif
+    default:
+      checkParallelCodec(type);
+      throw std::logic_error("Unreachable");
+  }
+}
+
+/**
+ * Calls fn(0), ..., fn(n - 1) on the executor, and rethrows the first
+ * exception once they are all done.
+ */
+void runParallel(Executor& executor, size_t n, FunctionRef<void(size_t)> fn) {
+  std::vector<Baton<>> done(n);
+  std::vector<std::exception_ptr> errors(n);
+  size_t submitted = 0;
+  SCOPE_EXIT {
+    for (size_t i = 0; i < submitted; ++i) {
+      done[i].wait();
+    }
+  };
+  for (; submitted < n; ++submitted) {
+    executor.add([&, i = submitted] {
+      try {
+        fn(i);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+      done[i].post();
+    });
+  }
+  for (size_t i = 0; i < n; ++i) {
+    done[i].wait();
+    if (errors[i]) {
+      std::rethrow_exception(errors[i]);
+    }
+  }
+}
+
+std::unique_ptr<IOBuf> concat(std::vector<std::unique_ptr<IOBuf>> bufs) {
+  auto result = std::move(bufs[0]);
+  for (size_t i = 1; i < bufs.size(); ++i) {
+    result->prependChain(std::move(bufs[i]));
+  }
+  return result;
+}
 } // namespace
 
 bool hasCodec(CodecType type) {
@@ -2009,6 +2203,67 @@ std::unique_ptr<StreamCodec> getStreamCodec(CodecType type, int level) {
   return codec;
 }
 
+bool hasParallelCodec(CodecType type) {
+  switch (type) {
+    case CodecType::ZSTD:
+    case CodecType::ZSTD_FAST:
+    case CodecType::LZ4_FRAME:
+      return hasCodec(type);
+    default:
+      return false;
+  }
+}
+
+std::unique_ptr<IOBuf> compressParallel(
+    const IOBuf* data,
+    Executor& executor,
+    CodecType type,
+    int level,
+    size_t frameSize) {
+  checkParallelCodec(type);
+  if (frameSize == 0) {
+    throw std::invalid_argument("Codec: frameSize must be positive");
+  }
+  // The frames share the input buffers.
+  std::vector<std::unique_ptr<IOBuf>> frames;
+  Cursor cursor(data);
+  do {
+    std::unique_ptr<IOBuf> frame;
+    cursor.clone(frame, std::min(frameSize, cursor.totalLength()));
+    frames.push_back(std::move(frame));
+  } while (!cursor.isAtEnd());
+
+  std::vector<std::unique_ptr<IOBuf>> outputs(frames.size());
+  runParallel(executor, frames.size(), [&](size_t i) {
+    outputs[i] = getCodec(type, level)->compress(frames[i].get());
+  });
+  return concat(std::move(outputs));
+}
+
+std::unique_ptr<IOBuf> uncompressParallel(
+    const IOBuf* data, Executor& executor, CodecType type) {
+  checkParallelCodec(type);
+  ByteRange in = *data->begin();
+  IOBuf clone;
+  if (data->isChained()) {
+    clone = data->cloneCoalescedAsValue();
+    in = clone.coalesce();
+  }
+  std::vector<ByteRange> frames;
+  do {
+    auto const length = frameLength(type, in);
+    frames.push_back(in.subpiece(0, length));
+    in.advance(length);
+  } while (!in.empty());
+
+  std::vector<std::unique_ptr<IOBuf>> outputs(frames.size());
+  runParallel(executor, frames.size(), [&](size_t i) {
+    auto const frame = IOBuf::wrapBufferAsValue(frames[i]);
+    outputs[i] = getCodec(type)->uncompress(&frame);
+  });
+  return concat(std::move(outputs));
+}
+
 std::unique_ptr<Codec> getAutoUncompressionCodec(
     std::vector<std::unique_ptr<Codec>> customCodecs,
     std::unique_ptr<Codec> terminalCodec) {
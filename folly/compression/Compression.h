@@ -20,6 +20,7 @@
 #include <limits>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <folly/Optional.h>
@@ -31,6 +32,10 @@
  */
 
 namespace folly {
+
+class Executor;
+class IOBufQueue;
+
 namespace io {
 
 enum class CodecType {
@@ -389,6 +394,34 @@ class StreamCodec : public Codec {
       folly::MutableByteRange& output,
       FlushOp flushOp = StreamCodec::FlushOp::NONE);
 
+  /**
+   * Like compressStream(), but compresses all of the input queue, one buffer
+   * at a time without coalescing it, and appends the output to the output
+   * queue, writing into the tailroom of its last buffer when there is enough
+   * of it. New output buffers are allocated as by IOBufQueue::preallocate(),
+   * so they come from the queue's IOBufPool, if it has one.
+   *
+   * flushOp applies to the end of the input: with FLUSH or END, all of it is
+   * flushed to the output, and the function returns true.
+   */
+  bool compressToQueue(
+      IOBufQueue& input,
+      IOBufQueue& output,
+      FlushOp flushOp = StreamCodec::FlushOp::NONE);
+
+  /**
+   * Like uncompressStream(), but uncompresses from the input queue, one
+   * buffer at a time without coalescing it, and appends the output to the
+   * output queue as compressToQueue() does. Consumes the input up to the end
+   * of the frame, or all of it if the frame doesn't end.
+   *
+   * Returns true at the end of a frame.
+   */
+  bool uncompressToQueue(
+      IOBufQueue& input,
+      IOBufQueue& output,
+      FlushOp flushOp = StreamCodec::FlushOp::NONE);
+
  protected:
   StreamCodec(
       CodecType type,
@@ -403,6 +436,15 @@ class StreamCodec : public Codec {
   }
 
  private:
+  // Output space that compressToQueue() and uncompressToQueue() make sure of
+  // before each call, and the size of the buffers they allocate for it.
+  static constexpr size_t kMinQueueOutputSpace = 4096;
+  static constexpr size_t kQueueOutputAllocationSize = 64 * 1024;
+
+  // Returns the first buffer of the input with data, and whether it is the
+  // last one, dropping the empty buffers before it.
+  static std::pair<ByteRange, bool> nextQueueInput(IOBufQueue& input);
+
   // default: Implemented using the streaming API.
   std::unique_ptr<IOBuf> doCompress(const folly::IOBuf* data) override;
   std::unique_ptr<IOBuf> doUncompress(
@@ -531,6 +573,41 @@ bool hasCodec(CodecType type);
  */
 bool hasStreamCodec(CodecType type);
 
+/**
+ * Check if a specified codec supports parallel compression, i.e. if its
+ * format allows concatenating independent frames: ZSTD, ZSTD_FAST and
+ * LZ4_FRAME.
+ */
+bool hasParallelCodec(CodecType type);
+
+constexpr size_t kDefaultParallelFrameSize = size_t(4) << 20;
+
+/**
+ * Compress data as independent frames of frameSize bytes of input each,
+ * compressed concurrently on the executor, and concatenated in order.
+ *
+ * The result is valid data of the codec's format for tools that decompress
+ * concatenated frames, such as the zstd and lz4 command line tools, but
+ * Codec::uncompress() only handles a single frame: use uncompressParallel().
+ * Blocks until done. Throws std::invalid_argument if !hasParallelCodec(type).
+ */
+std::unique_ptr<IOBuf> compressParallel(
+    const IOBuf* data,
+    Executor& executor,
+    CodecType type,
+    int level = COMPRESSION_LEVEL_DEFAULT,
+    size_t frameSize = kDefaultParallelFrameSize);
+
+/**
+ * Uncompress data made of concatenated frames, such as the output of
+ * compressParallel(). The frames are found by walking their headers, without
+ * uncompressing them, and are then uncompressed concurrently on the executor.
+ * Blocks until done. Throws std::invalid_argument if !hasParallelCodec(type),
+ * and std::runtime_error on invalid data.
+ */
+std::unique_ptr<IOBuf> uncompressParallel(
+    const IOBuf* data, Executor& executor, CodecType type);
+
 /**
  * Added here so users of folly can figure out whether the header
  * folly/compression/CompressionContextPoolSingletons.h is present, and
@@ -56,7 +56,8 @@ class CompressionContextPool {
         deleter_(std::move(deleter)),
         resetter_(std::move(resetter)),
         stack_(),
-        created_(0) {}
+        created_(0),
+        hits_(0) {}
 
   Ref get() {
     auto stack = stack_.wlock();
@@ -74,11 +75,20 @@ class CompressionContextPool {
       throw_exception<std::logic_error>(
           "A nullptr snuck into our context pool!?!?");
     }
+    hits_.fetch_add(1, std::memory_order_relaxed);
     return Ref(ptr.release(), get_deleter());
   }
 
+  /**
+   * Number of objects created, i.e. of get() calls that missed the pool.
+   */
   size_t created_count() const { return created_.load(); }
 
+  /**
+   * Number of get() calls served by a pooled object.
+   */
+  size_t hit_count() const { return hits_.load(std::memory_order_relaxed); }
+
   size_t size() { return stack_.rlock()->size(); }
 
   ReturnToPoolDeleter get_deleter() { return ReturnToPoolDeleter(this); }
@@ -109,6 +119,7 @@ class CompressionContextPool {
   folly::Synchronized<std::vector<InternalRef>> stack_;
 
   std::atomic<size_t> created_;
+  std::atomic<size_t> hits_;
 };
 } // namespace compression
 } // namespace folly
@@ -40,6 +40,8 @@
 #include <zstd.h>
 #endif
 
+#include <new>
+
 namespace folly {
 namespace compression {
 namespace contexts {
@@ -145,6 +147,106 @@ size_t get_zstd_dctx_created_count() {
 
 #endif // FOLLY_HAVE_LIBZSTD
 
+#if FOLLY_HAVE_LIBLZ4 && LZ4_VERSION_NUMBER >= 10800
+namespace {
+LZ4F_CCtx_Pool lz4f_cctx_pool_singleton;
+LZ4F_DCtx_Pool lz4f_dctx_pool_singleton;
+} // anonymous namespace
+
+LZ4F_cctx* LZ4F_CCtx_Creator::operator()() const noexcept {
+  LZ4F_cctx* ctx = nullptr;
+  if (LZ4F_isError(LZ4F_createCompressionContext(&ctx, LZ4F_VERSION))) {
+    return nullptr;
+  }
+  return ctx;
+}
+
+LZ4F_dctx* LZ4F_DCtx_Creator::operator()() const noexcept {
+  LZ4F_dctx* ctx = nullptr;
+  if (LZ4F_isError(LZ4F_createDecompressionContext(&ctx, LZ4F_VERSION))) {
+    return nullptr;
+  }
+  return ctx;
+}
+
+void LZ4F_CCtx_Deleter::operator()(LZ4F_cctx* ctx) const noexcept {
+  LZ4F_freeCompressionContext(ctx);
+}
+
+void LZ4F_DCtx_Deleter::operator()(LZ4F_dctx* ctx) const noexcept {
+  LZ4F_freeDecompressionContext(ctx);
+}
+
+void LZ4F_DCtx_Resetter::operator()(LZ4F_dctx* ctx) const noexcept {
+  LZ4F_resetDecompressionContext(ctx);
+}
+
+LZ4F_CCtx_Pool::Ref getLZ4F_CCtx() {
+  return lz4f_cctx_pool_singleton.get();
+}
+
+LZ4F_DCtx_Pool::Ref getLZ4F_DCtx() {
+  return lz4f_dctx_pool_singleton.get();
+}
+
+LZ4F_CCtx_Pool::Ref getNULL_LZ4F_CCtx() {
+  return lz4f_cctx_pool_singleton.getNull();
+}
+
+LZ4F_DCtx_Pool::Ref getNULL_LZ4F_DCtx() {
+  return lz4f_dctx_pool_singleton.getNull();
+}
+
+LZ4F_CCtx_Pool& lz4f_cctx_pool() {
+  return lz4f_cctx_pool_singleton;
+}
+
+LZ4F_DCtx_Pool& lz4f_dctx_pool() {
+  return lz4f_dctx_pool_singleton;
+}
+#endif // FOLLY_HAVE_LIBLZ4 && LZ4_VERSION_NUMBER >= 10800
+
+#if FOLLY_HAVE_LIBLZMA
+namespace {
+LZMA_Stream_Pool lzma_encoder_stream_pool_singleton;
+LZMA_Stream_Pool lzma_decoder_stream_pool_singleton;
+} // anonymous namespace
+
+lzma_stream* LZMA_Stream_Creator::operator()() const noexcept {
+  auto stream = new (std::nothrow) lzma_stream;
+  if (stream != nullptr) {
+    lzma_stream const init = LZMA_STREAM_INIT;
+    *stream = init;
+  }
+  return stream;
+}
+
+void LZMA_Stream_Deleter::operator()(lzma_stream* stream) const noexcept {
+  lzma_end(stream);
+  delete stream;
+}
+
+LZMA_Stream_Pool::Ref getLZMA_EncoderStream() {
+  return lzma_encoder_stream_pool_singleton.get();
+}
+
+LZMA_Stream_Pool::Ref getLZMA_DecoderStream() {
+  return lzma_decoder_stream_pool_singleton.get();
+}
+
+LZMA_Stream_Pool::Ref getNULL_LZMA_Stream() {
+  return lzma_encoder_stream_pool_singleton.getNull();
+}
+
+LZMA_Stream_Pool& lzma_encoder_stream_pool() {
+  return lzma_encoder_stream_pool_singleton;
+}
+
+LZMA_Stream_Pool& lzma_decoder_stream_pool() {
+  return lzma_decoder_stream_pool_singleton;
+}
+#endif // FOLLY_HAVE_LIBLZMA
+
 } // namespace contexts
 } // namespace compression
 } // namespace folly
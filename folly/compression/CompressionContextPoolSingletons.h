@@ -22,6 +22,17 @@
 #include <zstd.h>
 #endif
 
+#if FOLLY_HAVE_LIBLZ4
+#include <lz4.h>
+#if LZ4_VERSION_NUMBER >= 10800
+#include <lz4frame.h>
+#endif
+#endif
+
+#if FOLLY_HAVE_LIBLZMA
+#include <lzma.h>
+#endif
+
 #include <folly/compression/CompressionCoreLocalContextPool.h>
 
 // When this header is present, folly/compression/Compression.h defines
@@ -97,6 +108,112 @@ size_t get_zstd_dctx_created_count();
 
 #endif // FOLLY_HAVE_LIBZSTD
 
+#if FOLLY_HAVE_LIBLZ4 && LZ4_VERSION_NUMBER >= 10800
+
+// Feature test macro for the LZ4 frame singletons.
+#define FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
+
+struct LZ4F_CCtx_Creator {
+  LZ4F_cctx* operator()() const noexcept;
+};
+
+struct LZ4F_DCtx_Creator {
+  LZ4F_dctx* operator()() const noexcept;
+};
+
+struct LZ4F_CCtx_Deleter {
+  void operator()(LZ4F_cctx* ctx) const noexcept;
+};
+
+struct LZ4F_DCtx_Deleter {
+  void operator()(LZ4F_dctx* ctx) const noexcept;
+};
+
+// Compressing a frame resets the context.
+struct LZ4F_CCtx_Resetter {
+  void operator()(LZ4F_cctx*) const noexcept {}
+};
+
+struct LZ4F_DCtx_Resetter {
+  void operator()(LZ4F_dctx* ctx) const noexcept;
+};
+
+using LZ4F_CCtx_Pool = CompressionCoreLocalContextPool<
+    LZ4F_cctx,
+    LZ4F_CCtx_Creator,
+    LZ4F_CCtx_Deleter,
+    LZ4F_CCtx_Resetter,
+    4>;
+using LZ4F_DCtx_Pool = CompressionCoreLocalContextPool<
+    LZ4F_dctx,
+    LZ4F_DCtx_Creator,
+    LZ4F_DCtx_Deleter,
+    LZ4F_DCtx_Resetter,
+    4>;
+
+LZ4F_CCtx_Pool::Ref getLZ4F_CCtx();
+
+/**
+ * Returns a clean LZ4F_dctx.
+ */
+LZ4F_DCtx_Pool::Ref getLZ4F_DCtx();
+
+LZ4F_CCtx_Pool::Ref getNULL_LZ4F_CCtx();
+
+LZ4F_DCtx_Pool::Ref getNULL_LZ4F_DCtx();
+
+LZ4F_CCtx_Pool& lz4f_cctx_pool();
+
+LZ4F_DCtx_Pool& lz4f_dctx_pool();
+
+#endif // FOLLY_HAVE_LIBLZ4 && LZ4_VERSION_NUMBER >= 10800
+
+#if FOLLY_HAVE_LIBLZMA
+
+// Feature test macro for the LZMA singletons.
+#define FOLLY_COMPRESSION_HAS_LZMA_CONTEXT_POOL_SINGLETONS
+
+struct LZMA_Stream_Creator {
+  lzma_stream* operator()() const noexcept;
+};
+
+struct LZMA_Stream_Deleter {
+  void operator()(lzma_stream* stream) const noexcept;
+};
+
+// The streams are reset by initializing a coder, which reuses the memory of
+// the previous one if it is of the same kind.
+struct LZMA_Stream_Resetter {
+  void operator()(lzma_stream*) const noexcept {}
+};
+
+using LZMA_Stream_Pool = CompressionCoreLocalContextPool<
+    lzma_stream,
+    LZMA_Stream_Creator,
+    LZMA_Stream_Deleter,
+    LZMA_Stream_Resetter,
+    4>;
+
+/**
+ * Returns a stream last used for encoding, if any, so that its encoder
+ * memory is reused.
+ */
+LZMA_Stream_Pool::Ref getLZMA_EncoderStream();
+
+/**
+ * Returns a stream last used for decoding, if any, so that its decoder
+ * memory is reused.
+ */
+LZMA_Stream_Pool::Ref getLZMA_DecoderStream();
+
+LZMA_Stream_Pool::Ref getNULL_LZMA_Stream();
+
+LZMA_Stream_Pool& lzma_encoder_stream_pool();
+
+LZMA_Stream_Pool& lzma_decoder_stream_pool();
+
+#endif // FOLLY_HAVE_LIBLZMA
+
 } // namespace contexts
 } // namespace compression
 } // namespace folly
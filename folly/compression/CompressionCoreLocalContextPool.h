@@ -49,9 +49,11 @@ class CompressionCoreLocalContextPool {
    */
   class alignas(folly::hardware_destructive_interference_size) Storage {
    public:
-    Storage() : ptr(nullptr) {}
+    Storage() : ptr(nullptr), hits(0) {}
 
     std::atomic<T*> ptr;
+    // Counted per stripe, so as not to share a cache line between cores.
+    std::atomic<size_t> hits;
   };
 
   class ReturnToPoolDeleter {
@@ -88,19 +90,42 @@ class CompressionCoreLocalContextPool {
   ~CompressionCoreLocalContextPool() { flush_shallow(); }
 
   Ref get() {
-    auto ptr = local().ptr.exchange(nullptr);
+    auto& storage = local();
+    auto ptr = storage.ptr.exchange(nullptr);
     if (ptr == nullptr) {
       // no local ctx, get from backing pool
       ptr = pool_.get().release();
       DCHECK(ptr);
+    } else {
+      storage.hits.fetch_add(1, std::memory_order_relaxed);
     }
     return Ref(ptr, get_deleter());
   }
 
   Ref getNull() { return Ref(nullptr, get_deleter()); }
 
+  /**
+   * Number of objects created, i.e. of get() calls that missed the pool.
+   */
   size_t created_count() const { return pool_.created_count(); }
 
+  /**
+   * Number of get() calls served by a pooled object, from the local caches
+   * or the backing pool.
+   */
+  size_t hit_count() const { return local_hit_count() + pool_.hit_count(); }
+
+  /**
+   * Number of get() calls served by the local caches.
+   */
+  size_t local_hit_count() const {
+    size_t hits = 0;
+    for (auto& cache : caches_) {
+      hits += cache.hits.load(std::memory_order_relaxed);
+    }
+    return hits;
+  }
+
   void flush_deep() {
     flush_shallow();
     pool_.flush_deep();
@@ -18,12 +18,15 @@
 
 #if FOLLY_HAVE_LIBZSTD
 
+#include <cassert>
 #include <stdexcept>
 #include <string>
 
+#include <zdict.h>
 #include <zstd.h>
 
 #include <folly/Conv.h>
+#include <folly/Optional.h>
 #include <folly/Range.h>
 #include <folly/ScopeGuard.h>
 #include <folly/compression/CompressionContextPoolSingletons.h>
@@ -67,6 +70,7 @@ ZSTD_EndDirective zstdTranslateFlush(StreamCodec::FlushOp flush) {
 class ZSTDStreamCodec final : public StreamCodec {
  public:
   explicit ZSTDStreamCodec(Options options);
+  explicit ZSTDStreamCodec(std::shared_ptr<const Dictionary> dictionary);
 
   std::vector<std::string> validPrefixes() const override;
   bool canUncompress(
@@ -91,9 +95,25 @@ class ZSTDStreamCodec final : public StreamCodec {
   void resetCCtx();
   void resetDCtx();
 
-  Options options_;
+  Options const& options() const {
+    return dictionary_ ? dictionary_->options() : *options_;
+  }
+  ZSTD_CCtx* cctx() const {
+    return dictCCtx_ ? dictCCtx_->get() : cctx_.get();
+  }
+  ZSTD_DCtx* dctx() const {
+    return dictDCtx_ ? dictDCtx_->get() : dctx_.get();
+  }
+
+  // Exactly one of options_ and dictionary_ is set.
+  Optional<Options> options_;
+  std::shared_ptr<const Dictionary> dictionary_;
   ZSTD_CCtx_Pool::Ref cctx_{getNULL_ZSTD_CCtx()};
   ZSTD_DCtx_Pool::Ref dctx_{getNULL_ZSTD_DCtx()};
+  // Contexts of the dictionary, if any, which come with the options applied
+  // and the dictionary referenced.
+  Optional<Dictionary::CCtxPool::Ref> dictCCtx_;
+  Optional<Dictionary::DCtxPool::Ref> dictDCtx_;
 };
 
 constexpr uint32_t kZSTDMagicLE = 0xFD2FB528;
@@ -117,6 +137,11 @@ ZSTDStreamCodec::ZSTDStreamCodec(Options options)
     : StreamCodec(codecType(options), options.level()),
       options_(std::move(options)) {}
 
+ZSTDStreamCodec::ZSTDStreamCodec(std::shared_ptr<const Dictionary> dictionary)
+    : StreamCodec(
+          codecType(dictionary->options()), dictionary->options().level()),
+      dictionary_(std::move(dictionary)) {}
+
 bool ZSTDStreamCodec::doNeedsUncompressedLength() const {
   return false;
 }
@@ -144,21 +169,27 @@ Optional<uint64_t> ZSTDStreamCodec::doGetUncompressedLength(
 void ZSTDStreamCodec::doResetStream() {
   cctx_.reset(nullptr);
   dctx_.reset(nullptr);
+  dictCCtx_.reset();
+  dictDCtx_.reset();
 }
 
 void ZSTDStreamCodec::resetCCtx() {
-  DCHECK(cctx_ == nullptr);
-  cctx_ = getZSTD_CCtx(); // Gives us a clean context
-  DCHECK(cctx_ != nullptr);
-  zstdThrowIfError(
-      ZSTD_CCtx_setParametersUsingCCtxParams(cctx_.get(), options_.params()));
+  DCHECK(cctx() == nullptr);
+  if (dictionary_) {
+    dictCCtx_ = dictionary_->getCCtx();
+  } else {
+    cctx_ = getZSTD_CCtx(); // Gives us a clean context
+    zstdThrowIfError(ZSTD_CCtx_setParametersUsingCCtxParams(
+        cctx_.get(), options_->params()));
+  }
+  DCHECK(cctx() != nullptr);
   zstdThrowIfError(ZSTD_CCtx_setPledgedSrcSize(
-      cctx_.get(), uncompressedLength().value_or(ZSTD_CONTENTSIZE_UNKNOWN)));
+      cctx(), uncompressedLength().value_or(ZSTD_CONTENTSIZE_UNKNOWN)));
 }
 
 bool ZSTDStreamCodec::doCompressStream(
     ByteRange& input, MutableByteRange& output, StreamCodec::FlushOp flushOp) {
-  if (cctx_ == nullptr) {
+  if (cctx() == nullptr) {
     resetCCtx();
   }
   ZSTD_inBuffer in = {input.data(), input.size(), 0};
@@ -168,7 +199,7 @@ bool ZSTDStreamCodec::doCompressStream(
     output.uncheckedAdvance(out.pos);
   };
   size_t const rc = zstdThrowIfError(ZSTD_compressStream2(
-      cctx_.get(), &out, &in, zstdTranslateFlush(flushOp)));
+      cctx(), &out, &in, zstdTranslateFlush(flushOp)));
   switch (flushOp) {
     case StreamCodec::FlushOp::NONE:
       return false;
@@ -186,18 +217,23 @@ bool ZSTDStreamCodec::doCompressStream(
 }
 
 void ZSTDStreamCodec::resetDCtx() {
-  DCHECK(dctx_ == nullptr);
+  DCHECK(dctx() == nullptr);
+  if (dictionary_) {
+    dictDCtx_ = dictionary_->getDCtx();
+    DCHECK(dctx() != nullptr);
+    return;
+  }
   dctx_ = getZSTD_DCtx(); // Gives us a clean context
   DCHECK(dctx_ != nullptr);
-  if (options_.maxWindowSize() != 0) {
+  if (options_->maxWindowSize() != 0) {
     zstdThrowIfError(
-        ZSTD_DCtx_setMaxWindowSize(dctx_.get(), options_.maxWindowSize()));
+        ZSTD_DCtx_setMaxWindowSize(dctx_.get(), options_->maxWindowSize()));
   }
 }
 
 bool ZSTDStreamCodec::doUncompressStream(
     ByteRange& input, MutableByteRange& output, StreamCodec::FlushOp) {
-  if (dctx_ == nullptr) {
+  if (dctx() == nullptr) {
     resetDCtx();
   }
   ZSTD_inBuffer in = {input.data(), input.size(), 0};
@@ -207,7 +243,7 @@ bool ZSTDStreamCodec::doUncompressStream(
     output.uncheckedAdvance(out.pos);
   };
   size_t const rc =
-      zstdThrowIfError(ZSTD_decompressStream(dctx_.get(), &out, &in));
+      zstdThrowIfError(ZSTD_decompressStream(dctx(), &out, &in));
   if (rc == 0) {
     // Surrender our dctx_
     doResetStream();
@@ -235,6 +271,99 @@ void Options::set(ZSTD_cParameter param, unsigned value) {
   ZSTD_freeCCtxParams(params);
 }
 
+std::string trainDictionary(
+    const std::vector<ByteRange>& samples, size_t maxSize) {
+  std::string buffer;
+  std::vector<size_t> sizes;
+  sizes.reserve(samples.size());
+  for (auto sample : samples) {
+    buffer.append(reinterpret_cast<const char*>(sample.data()), sample.size());
+    sizes.push_back(sample.size());
+  }
+  std::string dictionary(maxSize, '\0');
+  size_t const rc = ZDICT_trainFromBuffer(
+      &dictionary[0],
+      dictionary.size(),
+      buffer.data(),
+      sizes.data(),
+      static_cast<unsigned>(sizes.size()));
+  if (ZDICT_isError(rc)) {
+    throw std::runtime_error(to<std::string>(
+        "ZSTD dictionary training failed: ", ZDICT_getErrorName(rc)));
+  }
+  dictionary.resize(rc);
+  return dictionary;
+}
+
+Dictionary::Dictionary(ByteRange data, Options options)
+    : options_(std::move(options)),
+      cdict_(ZSTD_createCDict(data.data(), data.size(), options_.level())),
+      ddict_(ZSTD_createDDict(data.data(), data.size())),
+      cctxPool_(CCtxCreator{this}),
+      dctxPool_(DCtxCreator{this}) {
+  if (cdict_ == nullptr || ddict_ == nullptr) {
+    throw std::bad_alloc{};
+  }
+}
+
+Dictionary::~Dictionary() = default;
+
+unsigned Dictionary::id() const {
+  return ZSTD_getDictID_fromDDict(ddict_.get());
+}
+
+ZSTD_CCtx* Dictionary::CCtxCreator::operator()() const noexcept {
+  ZSTD_CCtx* ctx = ZSTD_CCtx_Creator()();
+  if (ctx == nullptr) {
+    return nullptr;
+  }
+  // The parameters can't be changed once the dictionary is referenced.
+  auto const& options = dictionary->options();
+  if (ZSTD_isError(
+          ZSTD_CCtx_setParametersUsingCCtxParams(ctx, options.params())) ||
+      ZSTD_isError(ZSTD_CCtx_refCDict(ctx, dictionary->cdict()))) {
+    ZSTD_CCtx_Deleter()(ctx);
+    return nullptr;
+  }
+  return ctx;
+}
+
+ZSTD_DCtx* Dictionary::DCtxCreator::operator()() const noexcept {
+  ZSTD_DCtx* ctx = ZSTD_DCtx_Creator()();
+  if (ctx == nullptr) {
+    return nullptr;
+  }
+  auto const& options = dictionary->options();
+  if ((options.maxWindowSize() != 0 &&
+       ZSTD_isError(
+           ZSTD_DCtx_setMaxWindowSize(ctx, options.maxWindowSize()))) ||
+      ZSTD_isError(ZSTD_DCtx_refDDict(ctx, dictionary->ddict()))) {
+    ZSTD_DCtx_Deleter()(ctx);
+    return nullptr;
+  }
+  return ctx;
+}
+
+void Dictionary::CCtxResetter::operator()(ZSTD_CCtx* ctx) const noexcept {
+  size_t const err = ZSTD_CCtx_reset(ctx, ZSTD_reset_session_only);
+  assert(!ZSTD_isError(err)); // This function doesn't actually fail
+  (void)err;
+}
+
+void Dictionary::DCtxResetter::operator()(ZSTD_DCtx* ctx) const noexcept {
+  size_t const err = ZSTD_DCtx_reset(ctx, ZSTD_reset_session_only);
+  assert(!ZSTD_isError(err)); // This function doesn't actually fail
+  (void)err;
+}
+
+/* static */ void Dictionary::freeCDict(ZSTD_CDict* cdict) {
+  ZSTD_freeCDict(cdict);
+}
+
+/* static */ void Dictionary::freeDDict(ZSTD_DDict* ddict) {
+  ZSTD_freeDDict(ddict);
+}
+
 std::unique_ptr<Codec> getCodec(Options options) {
   return std::make_unique<ZSTDStreamCodec>(std::move(options));
 }
@@ -243,6 +372,15 @@ std::unique_ptr<StreamCodec> getStreamCodec(Options options) {
   return std::make_unique<ZSTDStreamCodec>(std::move(options));
 }
 
+std::unique_ptr<Codec> getCodec(std::shared_ptr<const Dictionary> dictionary) {
+  return std::make_unique<ZSTDStreamCodec>(std::move(dictionary));
+}
+
+std::unique_ptr<StreamCodec> getStreamCodec(
+    std::shared_ptr<const Dictionary> dictionary) {
+  return std::make_unique<ZSTDStreamCodec>(std::move(dictionary));
+}
+
 } // namespace zstd
 } // namespace io
 } // namespace folly
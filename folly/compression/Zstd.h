@@ -18,8 +18,13 @@
 
 #include <memory.h>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <folly/Memory.h>
 #include <folly/Portability.h>
+#include <folly/Range.h>
 #include <folly/compression/Compression.h>
 
 #if FOLLY_HAVE_LIBZSTD
@@ -29,6 +34,8 @@
 #endif
 #include <zstd.h>
 
+#include <folly/compression/CompressionContextPoolSingletons.h>
+
 namespace folly {
 namespace io {
 namespace zstd {
@@ -80,11 +87,108 @@ class Options {
   int level_;
 };
 
+/**
+ * Train a dictionary of at most `maxSize` bytes from `samples` of the data
+ * to be compressed with it. This pays off for small messages, which share
+ * too little data among themselves to compress well on their own. zstd
+ * recommends on the order of 100 samples per KB of dictionary.
+ * Throws std::runtime_error if training fails, e.g. for too few samples.
+ */
+std::string trainDictionary(
+    const std::vector<ByteRange>& samples, size_t maxSize = 110 * 1024);
+
+/**
+ * A dictionary, digested once for compression with the given options and for
+ * decompression, so that neither is repeated for each message.
+ *
+ * The dictionary also pools the compression contexts bound to it, with the
+ * options applied and the dictionary referenced, which the codecs using it
+ * share. It is thread-safe, and must outlive the contexts and codecs, which
+ * the codecs ensure by holding a shared_ptr.
+ */
+class Dictionary {
+ public:
+  Dictionary(ByteRange data, Options options);
+  ~Dictionary();
+
+  Dictionary(const Dictionary&) = delete;
+  Dictionary& operator=(const Dictionary&) = delete;
+
+  ZSTD_CDict const* cdict() const { return cdict_.get(); }
+  ZSTD_DDict const* ddict() const { return ddict_.get(); }
+
+  /// Get the options that the dictionary was digested with.
+  Options const& options() const { return options_; }
+
+  /// Get the dictionary id, 0 for a raw content dictionary.
+  unsigned id() const;
+
+ private:
+  struct CCtxCreator {
+    ZSTD_CCtx* operator()() const noexcept;
+    Dictionary const* dictionary;
+  };
+  struct DCtxCreator {
+    ZSTD_DCtx* operator()() const noexcept;
+    Dictionary const* dictionary;
+  };
+  // Unlike the global pools, keeps the parameters and the dictionary.
+  struct CCtxResetter {
+    void operator()(ZSTD_CCtx* ctx) const noexcept;
+  };
+  struct DCtxResetter {
+    void operator()(ZSTD_DCtx* ctx) const noexcept;
+  };
+
+ public:
+  using CCtxPool = folly::compression::CompressionCoreLocalContextPool<
+      ZSTD_CCtx,
+      CCtxCreator,
+      folly::compression::contexts::ZSTD_CCtx_Deleter,
+      CCtxResetter,
+      4>;
+  using DCtxPool = folly::compression::CompressionCoreLocalContextPool<
+      ZSTD_DCtx,
+      DCtxCreator,
+      folly::compression::contexts::ZSTD_DCtx_Deleter,
+      DCtxResetter,
+      4>;
+
+  /// Get a compression context bound to the dictionary.
+  CCtxPool::Ref getCCtx() const { return cctxPool_.get(); }
+  /// Get a decompression context bound to the dictionary.
+  DCtxPool::Ref getDCtx() const { return dctxPool_.get(); }
+
+  CCtxPool::Ref getNullCCtx() const { return cctxPool_.getNull(); }
+  DCtxPool::Ref getNullDCtx() const { return dctxPool_.getNull(); }
+
+  size_t cctxCreatedCount() const { return cctxPool_.created_count(); }
+  size_t dctxCreatedCount() const { return dctxPool_.created_count(); }
+
+ private:
+  static void freeCDict(ZSTD_CDict* cdict);
+  static void freeDDict(ZSTD_DDict* ddict);
+
+  Options options_;
+  std::unique_ptr<ZSTD_CDict, static_function_deleter<ZSTD_CDict, &freeCDict>>
+      cdict_;
+  std::unique_ptr<ZSTD_DDict, static_function_deleter<ZSTD_DDict, &freeDDict>>
+      ddict_;
+  mutable CCtxPool cctxPool_;
+  mutable DCtxPool dctxPool_;
+};
+
 /// Get a zstd Codec with the given options.
 std::unique_ptr<Codec> getCodec(Options options);
 /// Get a zstd StreamCodec with the given options.
 std::unique_ptr<StreamCodec> getStreamCodec(Options options);
 
+/// Get a zstd Codec that uses the dictionary, with its options.
+std::unique_ptr<Codec> getCodec(std::shared_ptr<const Dictionary> dictionary);
+/// Get a zstd StreamCodec that uses the dictionary, with its options.
+std::unique_ptr<StreamCodec> getStreamCodec(
+    std::shared_ptr<const Dictionary> dictionary);
+
 } // namespace zstd
 } // namespace io
 } // namespace folly
@@ -18,6 +18,7 @@
 
 #include <folly/portability/GTest.h>
 
+#include <folly/compression/Compression.h>
 #include <folly/compression/CompressionContextPool.h>
 #include <folly/compression/CompressionContextPoolSingletons.h>
 #include <folly/compression/CompressionCoreLocalContextPool.h>
@@ -218,6 +219,16 @@ TEST_F(CompressionContextPoolTest, testFlush) {
   EXPECT_EQ(pool_->created_count(), 2);
 }
 
+TEST_F(CompressionContextPoolTest, testHitCount) {
+  EXPECT_EQ(pool_->hit_count(), 0);
+  pool_->get();
+  EXPECT_EQ(pool_->hit_count(), 0);
+  pool_->get();
+  pool_->get();
+  EXPECT_EQ(pool_->hit_count(), 2);
+  EXPECT_EQ(pool_->created_count(), 1);
+}
+
 class CompressionCoreLocalContextPoolTest : public testing::Test {
  protected:
   using Pool = CompressionCoreLocalContextPool<
@@ -251,6 +262,28 @@ TEST_F(CompressionCoreLocalContextPoolTest, testSame) {
   }
 }
 
+TEST_F(CompressionCoreLocalContextPoolTest, testHitCount) {
+  pool_->get();
+  EXPECT_EQ(pool_->hit_count(), 0);
+  pool_->get();
+  EXPECT_EQ(pool_->hit_count(), 1);
+  EXPECT_EQ(pool_->local_hit_count(), 1);
+  {
+    auto ptr1 = pool_->get();
+    // Misses the local cache, and the backing pool is empty.
+    auto ptr2 = pool_->get();
+  }
+  EXPECT_EQ(pool_->hit_count(), 2);
+  EXPECT_EQ(pool_->created_count(), 2);
+  // One of them went back to the backing pool.
+  pool_->get();
+  auto ptr1 = pool_->get();
+  auto ptr2 = pool_->get();
+  EXPECT_EQ(pool_->hit_count(), 5);
+  EXPECT_EQ(pool_->local_hit_count(), 4);
+  EXPECT_EQ(pool_->created_count(), 2);
+}
+
 TEST_F(CompressionCoreLocalContextPoolTest, testDifferent) {
   auto ptr1 = pool_->get();
   auto ptr2 = pool_->get();
@@ -345,5 +378,36 @@ TEST(CompressionContextPoolSingletonsTest, testSingletonsNull) {
 
 #endif // FOLLY_COMPRESSION_HAS_ZSTD_CONTEXT_POOL_SINGLETONS
 
+#ifdef FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
+
+TEST(CompressionContextPoolSingletonsTest, testLZ4FSingletons) {
+  EXPECT_NE(contexts::getLZ4F_CCtx(), nullptr);
+  EXPECT_NE(contexts::getLZ4F_DCtx(), nullptr);
+  EXPECT_EQ(contexts::getNULL_LZ4F_CCtx(), nullptr);
+  EXPECT_EQ(contexts::getNULL_LZ4F_DCtx(), nullptr);
+}
+
+#endif // FOLLY_COMPRESSION_HAS_LZ4F_CONTEXT_POOL_SINGLETONS
+
+#ifdef FOLLY_COMPRESSION_HAS_LZMA_CONTEXT_POOL_SINGLETONS
+
+TEST(CompressionContextPoolSingletonsTest, testLZMASingletons) {
+  EXPECT_NE(contexts::getLZMA_EncoderStream(), nullptr);
+  EXPECT_NE(contexts::getLZMA_DecoderStream(), nullptr);
+  EXPECT_EQ(contexts::getNULL_LZMA_Stream(), nullptr);
+
+  // The codecs take their streams from the pools.
+  auto& pool = contexts::lzma_encoder_stream_pool();
+  auto const hits = pool.hit_count();
+  auto const created = pool.created_count();
+  for (int i = 0; i < 10; ++i) {
+    io::getCodec(io::CodecType::LZMA2)->compress("data");
+  }
+  EXPECT_EQ(pool.hit_count() + pool.created_count(), hits + created + 10);
+  EXPECT_GT(pool.hit_count(), hits);
+}
+
+#endif // FOLLY_COMPRESSION_HAS_LZMA_CONTEXT_POOL_SINGLETONS
+
 } // namespace compression
 } // namespace folly
@@ -27,7 +27,9 @@
 
 #include <folly/Random.h>
 #include <folly/Varint.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/hash/Hash.h>
+#include <folly/io/IOBufPool.h>
 #include <folly/io/IOBufQueue.h>
 #include <folly/portability/GTest.h>
 
@@ -802,6 +804,7 @@ class StreamingCompressionTest
   void runCompressStreamTest(DataHolder const& dh);
   void runUncompressStreamTest(DataHolder const& dh);
   void runFlushTest(DataHolder const& dh);
+  void runQueueTest(DataHolder const& dh);
 
  private:
   std::vector<ByteRange> split(ByteRange data) const;
@@ -991,6 +994,56 @@ TEST_P(StreamingCompressionTest, testFlush) {
   runFlushTest(randomDataHolder);
 }
 
+void StreamingCompressionTest::runQueueTest(DataHolder const& dh) {
+  auto hashQueue = [](IOBufQueue const& queue) {
+    IOBuf empty;
+    return hashIOBuf(queue.front() ? queue.front() : &empty);
+  };
+  IOBufPool pool;
+  IOBufQueue::Options options;
+  options.pool = &pool;
+
+  // Chain the input, with an empty buffer in the middle.
+  IOBufQueue input;
+  auto const inputs = split(dh.data(uncompressedLength_));
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    input.append(IOBuf::wrapBuffer(inputs[i]));
+    if (i == inputs.size() / 2) {
+      input.append(IOBuf::create(0));
+    }
+  }
+
+  IOBufQueue compressed(options);
+  codec_->resetStream(uncompressedLength_);
+  EXPECT_TRUE(
+      codec_->compressToQueue(input, compressed, StreamCodec::FlushOp::END));
+  EXPECT_TRUE(input.empty());
+  {
+    auto const uncompressed = codec_->uncompress(compressed.front());
+    EXPECT_EQ(dh.hash(uncompressedLength_), hashIOBuf(uncompressed.get()));
+  }
+
+  // Uncompress from the compressed chain, followed by another frame.
+  auto const data = IOBuf::wrapBuffer(dh.data(uncompressedLength_));
+  compressed.append(codec_->compress(data.get()));
+  IOBufQueue uncompressed(options);
+  codec_->resetStream();
+  EXPECT_TRUE(codec_->uncompressToQueue(compressed, uncompressed));
+  EXPECT_EQ(dh.hash(uncompressedLength_), hashQueue(uncompressed));
+  EXPECT_FALSE(compressed.empty());
+
+  uncompressed.reset();
+  codec_->resetStream();
+  EXPECT_TRUE(codec_->uncompressToQueue(compressed, uncompressed));
+  EXPECT_EQ(dh.hash(uncompressedLength_), hashQueue(uncompressed));
+  EXPECT_TRUE(compressed.empty());
+}
+
+TEST_P(StreamingCompressionTest, queue) {
+  runQueueTest(constantDataHolder);
+  runQueueTest(randomDataHolder);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     StreamingCompressionTest,
     StreamingCompressionTest,
@@ -1325,6 +1378,81 @@ INSTANTIATE_TEST_SUITE_P(
     TerminalCodecTest,
     testing::ValuesIn(autoUncompressionCodecTypes));
 
+class ParallelCompressionTest : public testing::TestWithParam<CodecType> {};
+
+TEST_P(ParallelCompressionTest, RoundTrip) {
+  auto const type = GetParam();
+  CPUThreadPoolExecutor executor(4);
+  for (auto const* dh :
+       {static_cast<const DataHolder*>(&randomDataHolder),
+        static_cast<const DataHolder*>(&constantDataHolder)}) {
+    for (size_t length : {size_t(0), size_t(1000), size_t(10) << 20}) {
+      // Split the input into a chain, unaligned with the frames.
+      auto data = dh->data(length);
+      IOBufQueue queue;
+      for (size_t pos = 0; pos < length; pos += 300000) {
+        auto piece = data.subpiece(pos, 300000);
+        queue.append(IOBuf::wrapBuffer(piece.data(), piece.size()));
+      }
+      auto input = queue.move();
+      if (!input) {
+        input = IOBuf::create(0);
+      }
+      auto const compressed = compressParallel(
+          input.get(), executor, type, COMPRESSION_LEVEL_DEFAULT, 1 << 20);
+      auto const uncompressed =
+          uncompressParallel(compressed.get(), executor, type);
+      EXPECT_EQ(length, uncompressed->computeChainDataLength());
+      EXPECT_EQ(dh->hash(length), hashIOBuf(uncompressed.get()));
+    }
+  }
+}
+
+TEST_P(ParallelCompressionTest, Frames) {
+  auto const type = GetParam();
+  CPUThreadPoolExecutor executor(4);
+  auto const data = IOBuf::wrapBuffer(randomDataHolder.data(5 << 20));
+  auto const compressed =
+      compressParallel(data.get(), executor, type, COMPRESSION_LEVEL_DEFAULT);
+  // A single frame is valid data for the codec.
+  auto const codec = getCodec(type);
+  auto const frame = compressParallel(
+      data.get(),
+      executor,
+      type,
+      COMPRESSION_LEVEL_DEFAULT,
+      data->computeChainDataLength());
+  EXPECT_EQ(
+      randomDataHolder.hash(5 << 20),
+      hashIOBuf(codec->uncompress(frame.get()).get()));
+  EXPECT_EQ(
+      randomDataHolder.hash(5 << 20),
+      hashIOBuf(uncompressParallel(compressed.get(), executor, type).get()));
+
+  // Truncated data
+  auto truncated = compressed->cloneCoalesced();
+  truncated->trimEnd(1);
+  EXPECT_THROW(
+      uncompressParallel(truncated.get(), executor, type), std::runtime_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParallelCompressionTest,
+    ParallelCompressionTest,
+    testing::ValuesIn(supportedCodecs({
+        CodecType::ZSTD,
+        CodecType::LZ4_FRAME,
+    })));
+
+TEST(ParallelCompressionTest, Unsupported) {
+  CPUThreadPoolExecutor executor(1);
+  auto const data = IOBuf::copyBuffer("data");
+  EXPECT_FALSE(hasParallelCodec(CodecType::SNAPPY));
+  EXPECT_THROW(
+      compressParallel(data.get(), executor, CodecType::SNAPPY),
+      std::invalid_argument);
+}
+
 TEST(ValidPrefixesTest, CustomCodec) {
   std::vector<std::unique_ptr<Codec>> codecs;
   codecs.push_back(CustomCodec::create("none", CodecType::NO_COMPRESSION));
@@ -1468,6 +1596,56 @@ TEST(ZstdTest, NegativeLevels) {
   EXPECT_EQ(original, uncompressed);
 }
 
+TEST(ZstdTest, Dictionary) {
+  // Small messages sharing most of their content
+  std::vector<std::string> messages;
+  for (int i = 0; i < 1000; ++i) {
+    messages.push_back(to<std::string>(
+        "{\"id\": ",
+        i,
+        ", \"name\": \"user",
+        i % 37,
+        "\", \"status\": \"",
+        i % 3 ? "active" : "inactive",
+        "\", \"tags\": [\"alpha\", \"beta\", \"gamma\"]}"));
+  }
+  std::vector<ByteRange> samples;
+  for (auto const& message : messages) {
+    samples.emplace_back(StringPiece(message));
+  }
+  auto const trained = zstd::trainDictionary(samples, 4096);
+  EXPECT_GT(trained.size(), 0);
+  EXPECT_LE(trained.size(), 4096);
+
+  auto dictionary = std::make_shared<zstd::Dictionary>(
+      ByteRange(StringPiece(trained)), zstd::Options(3));
+  EXPECT_NE(0, dictionary->id());
+  auto codec = zstd::getCodec(dictionary);
+  auto plainCodec = zstd::getCodec(zstd::Options(3));
+
+  size_t size = 0;
+  size_t plainSize = 0;
+  for (auto const& message : messages) {
+    auto const compressed = codec->compress(message);
+    size += compressed.size();
+    plainSize += plainCodec->compress(message).size();
+    EXPECT_EQ(message, codec->uncompress(compressed));
+    // The frames can't be decompressed without the dictionary.
+    EXPECT_THROW(plainCodec->uncompress(compressed), std::runtime_error);
+  }
+  EXPECT_LT(size, plainSize / 2);
+
+  // The contexts of the dictionary are reused across messages and codecs.
+  auto streamCodec = zstd::getStreamCodec(dictionary);
+  EXPECT_EQ(messages[0], streamCodec->uncompress(codec->compress(messages[0])));
+  EXPECT_EQ(1, dictionary->cctxCreatedCount());
+  EXPECT_EQ(1, dictionary->dctxCreatedCount());
+
+  EXPECT_THROW(
+      zstd::trainDictionary({ByteRange(StringPiece("x"))}, 4096),
+      std::runtime_error);
+}
+
 #endif
 
 #if FOLLY_HAVE_LIBZ
@@ -21,6 +21,7 @@
 #include <thread>
 
 #include <folly/PackedSyncPtr.h>
+#include <folly/ThreadLocal.h>
 #include <folly/concurrency/detail/AtomicSharedPtr-detail.h>
 #include <folly/memory/SanitizeLeak.h>
 #include <folly/synchronization/AtomicStruct.h>
@@ -64,6 +65,15 @@
  * move it global every once in a while.  This means load() is usually
  * only a single atomic operation, instead of 3.  For this trick to work,
  * we probably need at least 8 bits to make batching worth it.
+ *
+ * load() still writes to the shared pointer word, and the returned
+ * shared_ptr writes to the control block when it is copied or destroyed, so
+ * wide read-mostly workloads bounce both cache lines.
+ * read_cached_atomic_shared_ptr, below, adds load_borrowed(), which avoids
+ * both: each thread keeps its own reference to the current value, refreshed
+ * only when the stored pointer changes, and lends it out through a
+ * borrowed_ptr guard.  The fast path is a plain load of the pointer word and
+ * thread-local bookkeeping, so it scales with the number of cores.
  */
 
 // A note on noexcept: If the pointer is an aliased pointer,
@@ -223,6 +233,9 @@ class atomic_shared_ptr {
   }
 
  private:
+  template <typename, template <typename> class, typename>
+  friend class read_cached_atomic_shared_ptr;
+
   // Matches packed_sync_pointer.  Must be > max number of local
   // counts.  This is the max number of threads that can access this
   // atomic_shared_ptr at once before we start blocking.
@@ -384,4 +397,120 @@ class atomic_shared_ptr {
   mutable AtomicStruct<PackedPtr, Atom> ptr_;
 };
 
+/* An atomic_shared_ptr with load_borrowed(), for wide read-mostly
+ * workloads. It is a separate type because every instance holds a
+ * ThreadLocalPtr, which makes it larger than an atomic_shared_ptr and uses
+ * up a ThreadLocal id once it is read with load_borrowed().
+ */
+template <
+    typename T,
+    template <typename> class Atom = std::atomic,
+    typename CountedDetail = detail::shared_ptr_internals>
+class read_cached_atomic_shared_ptr
+    : public atomic_shared_ptr<T, Atom, CountedDetail> {
+  using Base = atomic_shared_ptr<T, Atom, CountedDetail>;
+  using SharedPtr = typename Base::SharedPtr;
+  using BasePtr = typename Base::BasePtr;
+
+ public:
+  using Base::Base;
+  using Base::operator=;
+
+  class borrowed_ptr;
+
+  /* Borrow the current value without touching any shared reference count.
+   * The value is at least as recent as a load() with acquire ordering.
+   *
+   * The guard must be destroyed on the thread that created it, before this
+   * read_cached_atomic_shared_ptr is destroyed. A thread's reference to a
+   * replaced value is only dropped on its next load_borrowed(), or when
+   * this read_cached_atomic_shared_ptr is destroyed.
+   */
+  borrowed_ptr load_borrowed() const {
+    auto cache = readCache_.get();
+    if (FOLLY_UNLIKELY(cache == nullptr)) {
+      cache = new ReadCache();
+      readCache_.reset(cache);
+    }
+    auto current = this->ptr_.load(std::memory_order_acquire).get();
+    if (FOLLY_UNLIKELY(!cache->valid || cache->base != current)) {
+      if (cache->pins != 0) {
+        // The cached value is lent out, fall back to an owned copy.
+        return borrowed_ptr(this->load(std::memory_order_acquire));
+      }
+      refresh(*cache);
+    }
+    return borrowed_ptr(*cache);
+  }
+
+ private:
+  // Per-thread reference to the value last seen by load_borrowed().
+  struct ReadCache {
+    // Identifies the stored value; value keeps it from being reused.
+    BasePtr* base = nullptr;
+    bool valid = false;
+    // Number of live borrowed_ptrs lending value out.
+    size_t pins = 0;
+    SharedPtr value;
+    // For aliased pointers base is the wrapper, which value does not own.
+    typename CountedDetail::template CountedPtr<SharedPtr> wrapper;
+  };
+
+  void refresh(ReadCache& cache) const noexcept {
+    auto local = this->takeOwnedBase(std::memory_order_acquire);
+    cache.wrapper = {};
+    if (local.extra() & Base::ALIASED_PTR) {
+      cache.wrapper =
+          CountedDetail::template get_shared_ptr_from_counted_base<SharedPtr>(
+              local.get(), true);
+    }
+    cache.value =
+        local.get() ? this->get_shared_ptr(local, false) : SharedPtr();
+    cache.base = local.get();
+    cache.valid = true;
+  }
+
+  mutable ThreadLocalPtr<ReadCache> readCache_;
+};
+
+/* A value lent out by read_cached_atomic_shared_ptr::load_borrowed(). It is
+ * neither copyable nor movable, and it must not outlive the
+ * read_cached_atomic_shared_ptr or leave the thread that created it; use
+ * to_shared() for an owned copy.
+ */
+template <typename T, template <typename> class Atom, typename CountedDetail>
+class read_cached_atomic_shared_ptr<T, Atom, CountedDetail>::borrowed_ptr {
+ public:
+  borrowed_ptr(const borrowed_ptr&) = delete;
+  borrowed_ptr& operator=(const borrowed_ptr&) = delete;
+
+  ~borrowed_ptr() {
+    if (cache_ != nullptr) {
+      --cache_->pins;
+    }
+  }
+
+  T* get() const noexcept { return ptr_->get(); }
+  T& operator*() const noexcept { return *get(); }
+  T* operator->() const noexcept { return get(); }
+  explicit operator bool() const noexcept { return get() != nullptr; }
+
+  SharedPtr to_shared() const { return *ptr_; }
+
+ private:
+  friend class read_cached_atomic_shared_ptr;
+
+  explicit borrowed_ptr(ReadCache& cache) noexcept
+      : ptr_(&cache.value), cache_(&cache) {
+    ++cache.pins;
+  }
+  explicit borrowed_ptr(SharedPtr owned) noexcept
+      : ptr_(&owned_), owned_(std::move(owned)) {}
+
+  const SharedPtr* ptr_;
+  SharedPtr owned_;
+  ReadCache* cache_ = nullptr;
+};
+
+
 } // namespace folly
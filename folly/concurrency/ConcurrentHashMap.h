@@ -18,10 +18,14 @@
 
 #include <atomic>
 #include <mutex>
+#include <vector>
 
+#include <folly/ExceptionWrapper.h>
+#include <folly/Executor.h>
 #include <folly/Optional.h>
 #include <folly/concurrency/detail/ConcurrentHashMap-detail.h>
 #include <folly/synchronization/Hazptr.h>
+#include <folly/synchronization/Latch.h>
 
 namespace folly {
 
@@ -154,6 +158,10 @@ class ConcurrentHashMap {
       Impl>;
   using SegmentTAllocator = typename std::allocator_traits<
       Allocator>::template rebind_alloc<SegmentT>;
+  using SizeCounterT = detail::concurrenthashmap::SizeCounter;
+  using CohortT = detail::concurrenthashmap::Cohort<Atom>;
+  using SizeCounterAllocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<SizeCounterT>;
   template <typename K, typename T>
   using EnableHeterogeneousFind = std::enable_if_t<
       detail::EligibleForHeterogeneousFind<KeyType, HashFn, KeyEqual, K>::value,
@@ -224,6 +232,10 @@ class ConcurrentHashMap {
     }
     cohort_.store(o.cohort(), std::memory_order_relaxed);
     o.cohort_.store(nullptr, std::memory_order_relaxed);
+    sizeCounter_.store(
+        o.sizeCounter_.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    o.sizeCounter_.store(nullptr, std::memory_order_relaxed);
     beginSeg_.store(
         o.beginSeg_.load(std::memory_order_relaxed), std::memory_order_relaxed);
     o.beginSeg_.store(NumShards, std::memory_order_relaxed);
@@ -247,8 +259,13 @@ class ConcurrentHashMap {
     size_ = o.size_;
     max_size_ = o.max_size_;
     cohort_shutdown_cleanup();
+    destroySizeCounter();
     cohort_.store(o.cohort(), std::memory_order_relaxed);
     o.cohort_.store(nullptr, std::memory_order_relaxed);
+    sizeCounter_.store(
+        o.sizeCounter_.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    o.sizeCounter_.store(nullptr, std::memory_order_relaxed);
     beginSeg_.store(
         o.beginSeg_.load(std::memory_order_relaxed), std::memory_order_relaxed);
     o.beginSeg_.store(NumShards, std::memory_order_relaxed);
@@ -269,6 +286,7 @@ class ConcurrentHashMap {
       }
     }
     cohort_shutdown_cleanup();
+    destroySizeCounter();
   }
 
   bool empty() const noexcept {
@@ -539,6 +557,34 @@ class ConcurrentHashMap {
     }
   }
 
+  /**
+   * An O(1) estimate of size() that only reads a single counter, for use in
+   * hot paths such as admission control. Size changes are accumulated in
+   * cpu-local stripes and published in batches, so the estimate may lag the
+   * exact size by up to a few hundred elements (see SizeCounter).
+   */
+  size_t approximate_size() const noexcept {
+    auto counter = sizeCounter_.load(std::memory_order_acquire);
+    return counter ? counter->approximate() : 0;
+  }
+
+  /**
+   * The current size of each shard, indexed by shard. A large spread
+   * between shards betrays a hash function that is skewed in its low bits.
+   */
+  std::vector<size_t> shard_sizes() const {
+    std::vector<size_t> res(NumShards, 0);
+    uint64_t begin = beginSeg_.load(std::memory_order_acquire);
+    uint64_t end = endSeg_.load(std::memory_order_acquire);
+    for (uint64_t i = begin; i < end; ++i) {
+      auto seg = segments_[i].load(std::memory_order_acquire);
+      if (seg) {
+        res[i] = seg->size();
+      }
+    }
+    return res;
+  }
+
   // This is a rolling size, and is not exact at any moment in time.
   size_t size() const noexcept {
     size_t res = 0;
@@ -553,6 +599,74 @@ class ConcurrentHashMap {
     return res;
   }
 
+  /**
+   * The number of bytes allocated by the map, as the sum over
+   * visitAllocationClasses().
+   */
+  std::size_t getAllocatedMemorySize() const {
+    std::size_t res = 0;
+    visitAllocationClasses(
+        [&](std::size_t bytes, std::size_t count) { res += bytes * count; });
+    return res;
+  }
+
+  /**
+   * Calls visitor(allocationSize, allocationCount) for each class of memory
+   * blocks allocated by the map, like F14's visitAllocationClasses(): its
+   * shards, their bucket (or chunk) arrays and nodes, and the nodes and
+   * arrays that were retired to hazard pointers but not yet reclaimed. The
+   * retired arrays are reported as one block. Retired nodes are only
+   * reported after countRetiredNodes(). Keys and values that are not
+   * nothrow copy constructible, which are held out of line, are not
+   * included. Like size(), this is not exact during concurrent updates.
+   */
+  template <typename V>
+  void visitAllocationClasses(V&& visitor) const {
+    using Node = typename SegmentT::Node;
+    size_t nodes = 0;
+    size_t tableBytes = 0;
+    uint64_t begin = beginSeg_.load(std::memory_order_acquire);
+    uint64_t end = endSeg_.load(std::memory_order_acquire);
+    for (uint64_t i = begin; i < end; ++i) {
+      auto seg = segments_[i].load(std::memory_order_acquire);
+      if (seg) {
+        auto segNodes = seg->size();
+        auto segTableBytes = seg->tableBytes();
+        visitor(sizeof(SegmentT), 1);
+        visitor(segTableBytes, 1);
+        visitor(sizeof(Node), segNodes);
+        nodes += segNodes;
+        tableBytes += segTableBytes;
+      }
+    }
+    if (auto c = cohort()) {
+      visitor(sizeof(CohortT), 1);
+      auto allNodes = c->countsNodes() ? c->nodes() : 0;
+      if (allNodes > nodes) {
+        visitor(sizeof(Node), allNodes - nodes);
+      }
+      auto allTableBytes = c->tableBytes();
+      if (allTableBytes > tableBytes) {
+        visitor(allTableBytes - tableBytes, 1);
+      }
+    }
+    if (sizeCounter_.load(std::memory_order_acquire)) {
+      visitor(sizeof(SizeCounterT), 1);
+    }
+  }
+
+  /**
+   * Counts nodes from allocation until they are reclaimed, so that
+   * visitAllocationClasses() also reports the nodes that were retired but
+   * not yet reclaimed. That costs an update of a striped counter whenever a
+   * node is created or destroyed, so it is off by default. Only takes
+   * effect if called before the first insertion; returns whether nodes are
+   * counted.
+   */
+  bool countRetiredNodes() {
+    return ensureCohort(/* countNodes = */ true)->countsNodes();
+  }
+
   float max_load_factor() const { return load_factor_; }
 
   void max_load_factor(float factor) {
@@ -566,6 +680,84 @@ class ConcurrentHashMap {
     }
   }
 
+  /**
+   * Visits every element with one task per non-empty shard, run on
+   * executor, and blocks until all of them are done.
+   *
+   * fn(const value_type&) is called concurrently for different shards, so it
+   * must be thread-safe. Each shard is scanned while holding its writer
+   * lock: the elements visited for a shard form a consistent snapshot of
+   * it, at the cost of blocking writers to that shard (but not readers)
+   * while it is scanned. There is no consistency across shards.
+   *
+   * fn must not modify this map (insert, assign, erase, clear, ...): the
+   * writer lock is not recursive, so a write to the shard being scanned
+   * deadlocks, and a write to another shard can deadlock with the task
+   * scanning that one. Lookups and iteration are fine, as readers do not
+   * take the lock.
+   *
+   * progress(shardsDone, shardsTotal) is called after each shard completes,
+   * from the thread that scanned it. Sleeping in it throttles the scan.
+   *
+   * If fn throws, the remaining elements of that shard are skipped, other
+   * shards are still visited, and the first exception is rethrown once all
+   * tasks are done.
+   *
+   * Must not be called from a thread that the executor needs to run the
+   * tasks, e.g. with an InlineExecutor it runs serially, but with a
+   * single-threaded executor from its own thread it deadlocks.
+   */
+  template <typename Fn, typename Progress>
+  void forEachShardParallel(Executor& executor, Fn fn, Progress progress) {
+    std::vector<SegmentT*> segs;
+    uint64_t begin = beginSeg_.load(std::memory_order_acquire);
+    uint64_t end = endSeg_.load(std::memory_order_acquire);
+    for (uint64_t i = begin; i < end; ++i) {
+      auto seg = segments_[i].load(std::memory_order_acquire);
+      if (seg && !seg->empty()) {
+        segs.push_back(seg);
+      }
+    }
+    if (segs.empty()) {
+      return;
+    }
+
+    Latch done(static_cast<ptrdiff_t>(segs.size()));
+    std::atomic<size_t> shardsDone{0};
+    std::mutex errorMutex;
+    exception_wrapper error;
+    for (auto seg : segs) {
+      executor.add([&, seg] {
+        try {
+          seg->forEachLocked(fn);
+        } catch (...) {
+          std::lock_guard<std::mutex> g(errorMutex);
+          if (!error) {
+            error = exception_wrapper(std::current_exception());
+          }
+        }
+        try {
+          progress(++shardsDone, segs.size());
+        } catch (...) {
+          std::lock_guard<std::mutex> g(errorMutex);
+          if (!error) {
+            error = exception_wrapper(std::current_exception());
+          }
+        }
+        done.count_down();
+      });
+    }
+    done.wait();
+    if (error) {
+      error.throw_exception();
+    }
+  }
+
+  template <typename Fn>
+  void forEachShardParallel(Executor& executor, Fn fn) {
+    forEachShardParallel(executor, std::move(fn), [](size_t, size_t) {});
+  }
+
   class ConstIterator {
    public:
     friend class ConcurrentHashMap;
@@ -729,9 +921,14 @@ class ConcurrentHashMap {
     SegmentT* seg = segments_[i].load(std::memory_order_acquire);
     if (!seg) {
       auto b = ensureCohort();
+      auto counter = ensureSizeCounter();
       SegmentT* newseg = SegmentTAllocator().allocate(1);
-      newseg = new (newseg)
-          SegmentT(size_ >> ShardBits, load_factor_, max_size_ >> ShardBits, b);
+      newseg = new (newseg) SegmentT(
+          size_ >> ShardBits,
+          load_factor_,
+          max_size_ >> ShardBits,
+          b,
+          counter);
       if (!segments_[i].compare_exchange_strong(seg, newseg)) {
         // seg is updated with new value, delete ours.
         newseg->~SegmentT();
@@ -758,20 +955,20 @@ class ConcurrentHashMap {
         expval, newval, std::memory_order_acq_rel, std::memory_order_acquire);
   }
 
-  hazptr_obj_cohort<Atom>* cohort() const noexcept {
+  CohortT* cohort() const noexcept {
     return cohort_.load(std::memory_order_acquire);
   }
 
-  hazptr_obj_cohort<Atom>* ensureCohort() const {
+  CohortT* ensureCohort(bool countNodes = false) const {
     auto b = cohort();
     if (!b) {
-      auto storage = Allocator().allocate(sizeof(hazptr_obj_cohort<Atom>));
-      auto newcohort = new (storage) hazptr_obj_cohort<Atom>();
+      auto storage = Allocator().allocate(sizeof(CohortT));
+      auto newcohort = new (storage) CohortT(countNodes);
       if (cohort_.compare_exchange_strong(b, newcohort)) {
         b = newcohort;
       } else {
-        newcohort->~hazptr_obj_cohort<Atom>();
-        Allocator().deallocate(storage, sizeof(hazptr_obj_cohort<Atom>));
+        newcohort->~CohortT();
+        Allocator().deallocate(storage, sizeof(CohortT));
       }
     }
     return b;
@@ -780,15 +977,38 @@ class ConcurrentHashMap {
   void cohort_shutdown_cleanup() {
     auto b = cohort();
     if (b) {
-      b->~hazptr_obj_cohort<Atom>();
-      Allocator().deallocate((uint8_t*)b, sizeof(hazptr_obj_cohort<Atom>));
+      b->~CohortT();
+      Allocator().deallocate((uint8_t*)b, sizeof(CohortT));
+    }
+  }
+
+  SizeCounterT* ensureSizeCounter() const {
+    auto c = sizeCounter_.load(std::memory_order_acquire);
+    if (!c) {
+      auto newcounter = new (SizeCounterAllocator().allocate(1)) SizeCounterT();
+      if (sizeCounter_.compare_exchange_strong(c, newcounter)) {
+        c = newcounter;
+      } else {
+        newcounter->~SizeCounterT();
+        SizeCounterAllocator().deallocate(newcounter, 1);
+      }
+    }
+    return c;
+  }
+
+  void destroySizeCounter() {
+    auto c = sizeCounter_.load(std::memory_order_relaxed);
+    if (c) {
+      c->~SizeCounterT();
+      SizeCounterAllocator().deallocate(c, 1);
     }
   }
 
   mutable Atom<SegmentT*> segments_[NumShards];
   size_t size_{0};
   size_t max_size_{0};
-  mutable Atom<hazptr_obj_cohort<Atom>*> cohort_{nullptr};
+  mutable Atom<CohortT*> cohort_{nullptr};
+  mutable Atom<SizeCounterT*> sizeCounter_{nullptr};
   mutable Atom<uint64_t> beginSeg_{NumShards};
   mutable Atom<uint64_t> endSeg_{0};
 };
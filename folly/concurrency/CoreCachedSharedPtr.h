@@ -19,18 +19,28 @@
 #include <array>
 #include <atomic>
 #include <memory>
+#include <mutex>
+#include <utility>
 
 #include <folly/CppAttributes.h>
 #include <folly/Portability.h>
 #include <folly/Unit.h>
 #include <folly/concurrency/CacheLocality.h>
+#include <folly/lang/Align.h>
 #include <folly/synchronization/Hazptr.h>
+#include <folly/synchronization/MicroSpinLock.h>
 
 namespace folly {
 
+// Passed as kMaxSlots to size the slots at runtime, one per L1 cache as
+// reported by CacheLocality, with no compile-time cap. The slots are then
+// allocated on the heap rather than inline.
+constexpr size_t kCoreCachedSharedPtrDynamicSlots = 0;
+
 // On mobile we do not expect high concurrency, and memory is more important, so
 // use more conservative caching.
-constexpr size_t kCoreCachedSharedPtrDefaultMaxSlots = kIsMobile ? 4 : 64;
+constexpr size_t kCoreCachedSharedPtrDefaultMaxSlots =
+    kIsMobile ? 4 : kCoreCachedSharedPtrDynamicSlots;
 
 namespace core_cached_shared_ptr_detail {
 
@@ -42,7 +52,10 @@ class SlotsConfig {
       // We need at most as many slots as the number of L1 caches, so we can
       // avoid wasting memory if more slots are requested.
       const auto l1Caches = CacheLocality::system().numCachesByLevel.front();
-      num_ = std::min(std::max<size_t>(1, l1Caches), kMaxSlots);
+      const size_t maxSlots = kMaxSlots == kCoreCachedSharedPtrDynamicSlots
+          ? AccessSpreader<>::maxStripeValue()
+          : kMaxSlots;
+      num_ = std::min(std::max<size_t>(1, l1Caches), maxSlots);
       return unit;
     }();
   }
@@ -58,6 +71,61 @@ class SlotsConfig {
 template <size_t kMaxSlots>
 std::atomic<size_t> SlotsConfig<kMaxSlots>::num_{1};
 
+// Inline storage for the slots when their number is bounded at compile time.
+template <class P, size_t kMaxSlots>
+class SlotArray {
+ public:
+  P* data() { return slots_.data(); }
+  const P* data() const { return slots_.data(); }
+
+  // Return storage for at least n slots.
+  P* allocate(size_t n) {
+    DCHECK_LE(n, kMaxSlots);
+    return slots_.data();
+  }
+
+ private:
+  std::array<P, kMaxSlots> slots_;
+};
+
+// Heap storage for dynamically sized slots, allocated on first use. data()
+// is null until then.
+template <class P>
+class SlotArray<P, kCoreCachedSharedPtrDynamicSlots> {
+ public:
+  SlotArray() = default;
+  SlotArray(const SlotArray& other) { *this = other; }
+  SlotArray(SlotArray&&) noexcept = default;
+
+  SlotArray& operator=(const SlotArray& other) {
+    if (this != &other) {
+      slots_.reset();
+      size_ = 0;
+      if (other.slots_) {
+        std::copy_n(other.slots_.get(), other.size_, allocate(other.size_));
+      }
+    }
+    return *this;
+  }
+  SlotArray& operator=(SlotArray&&) noexcept = default;
+
+  P* data() { return slots_.get(); }
+  const P* data() const { return slots_.get(); }
+
+  P* allocate(size_t n) {
+    if (!slots_) {
+      slots_ = std::make_unique<P[]>(n);
+      size_ = n;
+    }
+    DCHECK_LE(n, size_);
+    return slots_.get();
+  }
+
+ private:
+  std::unique_ptr<P[]> slots_;
+  size_t size_ = 0;
+};
+
 template <size_t kMaxSlots, class T>
 void makeSlots(std::shared_ptr<T> p, folly::Range<std::shared_ptr<T>*> slots) {
   // Allocate each holder and its control block in a different CoreAllocator
@@ -105,7 +173,8 @@ class CoreCachedSharedPtr {
   void reset(std::shared_ptr<T> p = nullptr) {
     SlotsConfig::initialize();
 
-    folly::Range<std::shared_ptr<T>*> slots{slots_.data(), SlotsConfig::num()};
+    const size_t num = SlotsConfig::num();
+    folly::Range<std::shared_ptr<T>*> slots{slots_.allocate(num), num};
     for (auto& slot : slots) {
       slot = {};
     }
@@ -115,14 +184,19 @@ class CoreCachedSharedPtr {
   }
 
   std::shared_ptr<T> get() const {
-    return slots_[AccessSpreader<>::cachedCurrent(SlotsConfig::num())];
+    auto slots = slots_.data();
+    if (kMaxSlots == kCoreCachedSharedPtrDynamicSlots && slots == nullptr) {
+      return nullptr;
+    }
+    return slots[AccessSpreader<>::cachedCurrent(SlotsConfig::num())];
   }
 
  private:
   template <class, size_t>
   friend class CoreCachedWeakPtr;
 
-  std::array<std::shared_ptr<T>, kMaxSlots> slots_;
+  core_cached_shared_ptr_detail::SlotArray<std::shared_ptr<T>, kMaxSlots>
+      slots_;
 };
 
 template <class T, size_t kMaxSlots = kCoreCachedSharedPtrDefaultMaxSlots>
@@ -138,22 +212,33 @@ class CoreCachedWeakPtr {
   void reset() { *this = {}; }
   void reset(const CoreCachedSharedPtr<T, kMaxSlots>& p) {
     SlotsConfig::initialize();
-    for (size_t i = 0; i < SlotsConfig::num(); ++i) {
-      slots_[i] = p.slots_[i];
+    const size_t num = SlotsConfig::num();
+    auto slots = slots_.allocate(num);
+    auto src = p.slots_.data();
+    for (size_t i = 0; i < num; ++i) {
+      slots[i] = src != nullptr ? std::weak_ptr<T>(src[i]) : std::weak_ptr<T>();
     }
   }
 
   std::weak_ptr<T> get() const {
-    return slots_[AccessSpreader<>::cachedCurrent(SlotsConfig::num())];
+    auto slots = slots_.data();
+    if (kMaxSlots == kCoreCachedSharedPtrDynamicSlots && slots == nullptr) {
+      return {};
+    }
+    return slots[AccessSpreader<>::cachedCurrent(SlotsConfig::num())];
   }
 
   // Faster than get().lock(), as it avoid one weak count cycle.
   std::shared_ptr<T> lock() const {
-    return slots_[AccessSpreader<>::cachedCurrent(SlotsConfig::num())].lock();
+    auto slots = slots_.data();
+    if (kMaxSlots == kCoreCachedSharedPtrDynamicSlots && slots == nullptr) {
+      return nullptr;
+    }
+    return slots[AccessSpreader<>::cachedCurrent(SlotsConfig::num())].lock();
   }
 
  private:
-  std::array<std::weak_ptr<T>, kMaxSlots> slots_;
+  core_cached_shared_ptr_detail::SlotArray<std::weak_ptr<T>, kMaxSlots> slots_;
 };
 
 /**
@@ -196,8 +281,9 @@ class AtomicCoreCachedSharedPtr {
     std::unique_ptr<Slots> newslots;
     if (!core_cached_shared_ptr_detail::isDefault(p)) {
       newslots = std::make_unique<Slots>();
+      const size_t num = SlotsConfig::num();
       core_cached_shared_ptr_detail::makeSlots<kMaxSlots>(
-          std::move(p), {newslots->slots.data(), SlotsConfig::num()});
+          std::move(p), {newslots->slots.allocate(num), num});
     }
 
     if (auto oldslots = slots_.exchange(newslots.release())) {
@@ -219,14 +305,112 @@ class AtomicCoreCachedSharedPtr {
     if (slots == nullptr) { // Need to check again, try_protect reloads slots.
       return nullptr;
     }
-    return slots->slots[AccessSpreader<>::cachedCurrent(SlotsConfig::num())];
+    return slots->slots
+        .data()[AccessSpreader<>::cachedCurrent(SlotsConfig::num())];
   }
 
  private:
   struct Slots : folly::hazptr_obj_base<Slots> {
-    std::array<std::shared_ptr<T>, kMaxSlots> slots;
+    core_cached_shared_ptr_detail::SlotArray<std::shared_ptr<T>, kMaxSlots>
+        slots;
   };
   std::atomic<Slots*> slots_{nullptr};
 };
 
+/**
+ * A variant of AtomicCoreCachedSharedPtr for pointers that are updated
+ * frequently: reset() is O(1) and only publishes the new pointer and bumps a
+ * version, and each core-local slot is refreshed lazily by the next get() on
+ * that core that observes a newer version.
+ *
+ * All methods are threadsafe. A get() that starts after a reset() returns
+ * always observes the new pointer.
+ *
+ * The cost of cheap updates is that a replaced object stays alive until
+ * every slot holding it has been refreshed or the LazyCoreCachedSharedPtr is
+ * destroyed, and get() takes a core-local spin lock to copy the slot.
+ */
+template <class T, size_t kMaxSlots = kCoreCachedSharedPtrDefaultMaxSlots>
+class LazyCoreCachedSharedPtr {
+  using SlotsConfig = core_cached_shared_ptr_detail::SlotsConfig<kMaxSlots>;
+
+ public:
+  LazyCoreCachedSharedPtr() : LazyCoreCachedSharedPtr(nullptr) {}
+  explicit LazyCoreCachedSharedPtr(std::shared_ptr<T> p)
+      : ptr_(std::move(p)) {
+    SlotsConfig::initialize();
+    numSlots_ = SlotsConfig::num();
+    slots_ = std::make_unique<Slot[]>(numSlots_);
+  }
+
+  LazyCoreCachedSharedPtr(const LazyCoreCachedSharedPtr&) = delete;
+  LazyCoreCachedSharedPtr& operator=(const LazyCoreCachedSharedPtr&) = delete;
+
+  void reset(std::shared_ptr<T> p = nullptr) {
+    std::shared_ptr<T> old;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      old = std::exchange(ptr_, std::move(p));
+      version_.store(
+          version_.load(std::memory_order_relaxed) + 1,
+          std::memory_order_release);
+    }
+    // old is released outside of the lock.
+  }
+
+  std::shared_ptr<T> get() const {
+    const uint64_t version = version_.load(std::memory_order_acquire);
+    const size_t index = AccessSpreader<>::cachedCurrent(numSlots_);
+    auto& slot = slots_[index];
+    // Declared before the guard so that the replaced pointer, which may run
+    // the destructor of T, is released after unlocking.
+    std::shared_ptr<T> stale;
+    std::lock_guard<MicroSpinLock> slotGuard(slot.lock);
+    if (FOLLY_UNLIKELY(slot.version < version)) {
+      stale = refresh(slot, index);
+    }
+    return slot.ptr;
+  }
+
+ private:
+  struct alignas(hardware_destructive_interference_size) Slot {
+    MicroSpinLock lock{};
+    // Version of ptr_ that ptr was copied from, 0 if never.
+    uint64_t version = 0;
+    std::shared_ptr<T> ptr;
+  };
+
+  // Copy the current pointer into the slot, returning the previous one.
+  FOLLY_NOINLINE std::shared_ptr<T> refresh(Slot& slot, size_t index) const {
+    std::shared_ptr<T> p;
+    uint64_t version;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      p = ptr_;
+      version = version_.load(std::memory_order_relaxed);
+    }
+    std::shared_ptr<T> cached;
+    if (!core_cached_shared_ptr_detail::isDefault(p)) {
+      // Give each slot its own control block, allocated in the slot's
+      // CoreAllocator stripe, so that get()s on different cores do not
+      // contend on the reference count.
+      CoreAllocatorGuard guard(numSlots_, index);
+      auto holder = std::allocate_shared<std::shared_ptr<T>>(
+          CoreAllocator<std::shared_ptr<T>>{});
+      auto raw = p.get();
+      *holder = std::move(p);
+      cached = std::shared_ptr<T>(std::move(holder), raw);
+    }
+    slot.version = version;
+    return std::exchange(slot.ptr, std::move(cached));
+  }
+
+  mutable std::mutex mutex_;
+  // Starts at 1 so that unpopulated slots are stale.
+  std::atomic<uint64_t> version_{1};
+  std::shared_ptr<T> ptr_;
+  size_t numSlots_;
+  std::unique_ptr<Slot[]> slots_;
+};
+
 } // namespace folly
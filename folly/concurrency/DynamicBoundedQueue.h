@@ -23,6 +23,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <exception>
 
 namespace folly {
 
@@ -131,6 +132,13 @@ namespace folly {
 ///         Tries to add an element to the end of the queue if
 ///         capacity allows until the expiration of the specified
 ///         duration. Returns true if successful, otherwise false.
+///     void enqueue_bulk(ForwardIt first, ForwardIt last);
+///     bool try_enqueue_bulk(ForwardIt first, ForwardIt last);
+///     bool try_enqueue_bulk_until(ForwardIt, ForwardIt, time_point&);
+///         Same as the above for all the elements of [first, last) at
+///         once: the total weight is debited with a single update, and
+///         either all the elements are added contiguously or none.
+///         The total weight must not exceed the capacity.
 ///
 ///   Consumer functions:
 ///     void dequeue(T&);
@@ -148,6 +156,13 @@ namespace folly {
 ///         if available until the expiration of the specified
 ///         duration.  Returns true if successful. Otherwise Returns
 ///         false.
+///     size_t try_dequeue_bulk(OutputIt out, size_t max);
+///         Tries to extract up to max available elements from the
+///         front of the queue into out, crediting their total weight
+///         with a single update. Returns the number of elements. If
+///         assigning to out throws, the remaining claimed elements are
+///         dropped, all their weight is still credited, and the
+///         exception is rethrown.
 ///
 ///   Secondary functions:
 ///     void reset_capacity(size_t capacity);
@@ -376,6 +391,29 @@ class DynamicBoundedQueue {
     return tryEnqueueForImpl(std::move(v), duration);
   }
 
+  /** enqueue_bulk */
+  template <typename ForwardIt>
+  void enqueue_bulk(ForwardIt first, ForwardIt last) {
+    tryEnqueueBulkUntilImpl(
+        first, last, std::chrono::steady_clock::time_point::max());
+  }
+
+  /** try_enqueue_bulk */
+  template <typename ForwardIt>
+  bool try_enqueue_bulk(ForwardIt first, ForwardIt last) {
+    return tryEnqueueBulkUntilImpl(
+        first, last, std::chrono::steady_clock::time_point::min());
+  }
+
+  /** try_enqueue_bulk_until */
+  template <typename ForwardIt, typename Clock, typename Duration>
+  bool try_enqueue_bulk_until(
+      ForwardIt first,
+      ForwardIt last,
+      const std::chrono::time_point<Clock, Duration>& deadline) {
+    return tryEnqueueBulkUntilImpl(first, last, deadline);
+  }
+
   /// Dequeue functions
 
   /** dequeue */
@@ -443,6 +481,22 @@ class DynamicBoundedQueue {
     return elem;
   }
 
+  /** try_dequeue_bulk */
+  template <typename OutputIt>
+  size_t try_dequeue_bulk(OutputIt out, size_t max) {
+    Weight weight = 0;
+    std::exception_ptr ex;
+    size_t n = q_.try_dequeue_bulk(
+        WeighingIterator<OutputIt>{out, weight, ex}, max);
+    if (n > 0) {
+      addCredit(weight);
+    }
+    if (ex) {
+      std::rethrow_exception(ex);
+    }
+    return n;
+  }
+
   /// Secondary functions
 
   /** reset_capacity */
@@ -510,6 +564,22 @@ class DynamicBoundedQueue {
     return tryEnqueueUntilSlow(std::forward<Arg>(v), deadline);
   }
 
+  template <typename ForwardIt, typename Clock, typename Duration>
+  bool tryEnqueueBulkUntilImpl(
+      ForwardIt first,
+      ForwardIt last,
+      const std::chrono::time_point<Clock, Duration>& deadline) {
+    Weight weight = 0;
+    for (auto it = first; it != last; ++it) {
+      weight += WeightFn()(*it);
+    }
+    if (FOLLY_LIKELY(tryAddDebit(weight)) || canEnqueue(deadline, weight)) {
+      q_.enqueue_bulk(first, last);
+      return true;
+    }
+    return false;
+  }
+
   FOLLY_ALWAYS_INLINE bool tryAddDebit(Weight weight) noexcept {
     Weight capacity = getCapacity();
     Weight before = fetchAddDebit(weight);
@@ -569,6 +639,32 @@ class DynamicBoundedQueue {
     return threshold_.load(std::memory_order_acquire);
   }
 
+  // Output iterator adaptor that sums up the weights of the elements
+  // assigned through it.
+  template <typename OutputIt>
+  /// Credits the weight of every dequeued element, including the ones
+  /// dropped after out throws, so that no capacity is lost.
+  struct WeighingIterator {
+    OutputIt out;
+    Weight& weight;
+    std::exception_ptr& ex;
+
+    WeighingIterator& operator*() { return *this; }
+    WeighingIterator& operator++() { return *this; }
+    WeighingIterator& operator=(T&& elem) noexcept {
+      weight += WeightFn()(elem);
+      if (!ex) {
+        try {
+          *out = std::move(elem);
+          ++out;
+        } catch (...) {
+          ex = std::current_exception();
+        }
+      }
+      return *this;
+    }
+  };
+
   /** Functions called infrequently by producers */
 
   void subDebit(Weight weight) noexcept {
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <folly/Function.h>
+#include <folly/Optional.h>
+#include <folly/container/F14Map.h>
+#include <folly/synchronization/Rcu.h>
+
+namespace folly {
+
+/**
+ * A read-mostly map whose contents are an immutable snapshot, replaced
+ * wholesale on every update and reclaimed with RCU.
+ *
+ * Readers only enter an RCU read-side critical section of the domain and
+ * load the current snapshot: they never block, and never contend with each
+ * other or with writers.
+ *
+ * Writers combine: an update is queued, and whichever writer gets to do the
+ * next rebuild copies the current snapshot once, applies all the queued
+ * updates in order, and publishes the result. That writer then waits for a
+ * grace period (rcu_domain::synchronize()) before freeing the previous
+ * snapshot and letting the next rebuild start, so a storm of writes costs at
+ * most one copy per grace period, and at most two snapshots are alive at any
+ * time. Update calls return as soon as their update is visible to readers,
+ * except for the writer that did the rebuild, which also waits for the grace
+ * period.
+ *
+ * Updates must not be made from within a read-side critical section of the
+ * same domain, including from the functions passed to withSnapshot(), since
+ * the rebuilding writer invokes synchronize(). If a rebuild throws, none of
+ * the updates of that batch are applied, and each of their update calls
+ * rethrows the exception.
+ */
+template <
+    typename Key,
+    typename Value,
+    typename Map = F14FastMap<Key, Value>>
+class RcuMap {
+ public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using map_type = Map;
+  using Update = Function<void(Map&)>;
+
+  /**
+   * Keeps a snapshot alive, by holding an RCU read lock, until destroyed.
+   * Must be destroyed on the thread that created it.
+   */
+  class Snapshot {
+   public:
+    const Map& operator*() const { return *map_; }
+    const Map* operator->() const { return map_; }
+
+   private:
+    friend class RcuMap;
+
+    Snapshot(rcu_domain& domain, const std::atomic<const Map*>& map)
+        : guard_(domain), map_(map.load(std::memory_order_acquire)) {}
+
+    std::unique_lock<rcu_domain> guard_;
+    const Map* map_;
+  };
+
+  explicit RcuMap(rcu_domain& domain = rcu_default_domain())
+      : RcuMap(Map{}, domain) {}
+
+  explicit RcuMap(Map initial, rcu_domain& domain = rcu_default_domain())
+      : domain_(domain), map_(new Map(std::move(initial))) {}
+
+  RcuMap(const RcuMap&) = delete;
+  RcuMap& operator=(const RcuMap&) = delete;
+
+  /// There must be no concurrent readers or writers.
+  ~RcuMap() { delete map_.load(std::memory_order_relaxed); }
+
+  Snapshot snapshot() const { return Snapshot(domain_, map_); }
+
+  /// Calls f(const Map&) on the current snapshot and returns the result.
+  template <typename F>
+  decltype(auto) withSnapshot(F&& f) const {
+    std::scoped_lock<rcu_domain> guard(domain_);
+    return std::forward<F>(f)(*map_.load(std::memory_order_acquire));
+  }
+
+  /// Returns a copy of the value for key, if any.
+  Optional<Value> get(const Key& key) const {
+    return withSnapshot([&](const Map& map) -> Optional<Value> {
+      auto it = map.find(key);
+      if (it == map.end()) {
+        return none;
+      }
+      return it->second;
+    });
+  }
+
+  bool contains(const Key& key) const {
+    return withSnapshot(
+        [&](const Map& map) { return map.find(key) != map.end(); });
+  }
+
+  size_t size() const {
+    return withSnapshot([](const Map& map) { return map.size(); });
+  }
+
+  bool empty() const { return size() == 0; }
+
+  void insert_or_assign(Key key, Value value) {
+    update([key = std::move(key), value = std::move(value)](Map& map) {
+      map.insert_or_assign(key, value);
+    });
+  }
+
+  void erase(Key key) {
+    update([key = std::move(key)](Map& map) { map.erase(key); });
+  }
+
+  void clear() {
+    update([](Map& map) { map.clear(); });
+  }
+
+  /**
+   * Applies f(Map&) to the map. f is called on the copy made for the next
+   * rebuild, possibly from another thread, after the updates queued before
+   * it; it can therefore not rely on what the map looks like when update()
+   * is called.
+   */
+  void update(Update f) {
+    std::exception_ptr error;
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto ticket = ++queued_;
+    pending_.push_back({std::move(f), &error});
+    while (applied_ < ticket && rebuilding_) {
+      cv_.wait(lock);
+    }
+    if (applied_ < ticket) {
+      rebuild(lock);
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  /// Number of snapshots published so far.
+  uint64_t numRebuilds() const {
+    return rebuilds_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Pending {
+    Update update;
+    std::exception_ptr* error;
+  };
+
+  // Called with the lock held, and returns with it held again.
+  void rebuild(std::unique_lock<std::mutex>& lock) {
+    rebuilding_ = true;
+    auto batch = std::move(pending_);
+    pending_.clear();
+    auto upTo = queued_;
+    lock.unlock();
+
+    const Map* old = map_.load(std::memory_order_relaxed);
+    std::unique_ptr<Map> next;
+    try {
+      next = std::make_unique<Map>(*old);
+      for (auto& p : batch) {
+        p.update(*next);
+      }
+    } catch (...) {
+      next.reset();
+      for (auto& p : batch) {
+        *p.error = std::current_exception();
+      }
+    }
+    if (next) {
+      map_.store(next.release(), std::memory_order_release);
+      rebuilds_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    lock.lock();
+    applied_ = upTo;
+    lock.unlock();
+    cv_.notify_all();
+
+    if (map_.load(std::memory_order_relaxed) != old) {
+      domain_.synchronize();
+      delete old;
+    }
+
+    lock.lock();
+    rebuilding_ = false;
+    cv_.notify_all();
+  }
+
+  rcu_domain& domain_;
+  std::atomic<const Map*> map_;
+  std::atomic<uint64_t> rebuilds_{0};
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<Pending> pending_;
+  uint64_t queued_{0};
+  uint64_t applied_{0};
+  bool rebuilding_{false};
+};
+
+} // namespace folly
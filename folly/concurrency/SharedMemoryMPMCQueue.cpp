@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/concurrency/SharedMemoryMPMCQueue.h>
+
+#include <cerrno>
+#include <stdexcept>
+
+#include <folly/Exception.h>
+#include <folly/File.h>
+#include <folly/portability/Fcntl.h>
+#include <folly/portability/SysMman.h>
+#include <folly/portability/Unistd.h>
+
+namespace folly {
+namespace detail {
+
+#ifndef _WIN32
+
+MemoryMapping createSharedMemoryRegion(const std::string& name, size_t size) {
+  int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  checkUnixError(fd, "shm_open(", name, ") failed");
+  File file(fd, /* ownsFd = */ true);
+  if (::ftruncate(fd, off_t(size)) != 0) {
+    int err = errno;
+    ::shm_unlink(name.c_str());
+    throwSystemErrorExplicit(err, "ftruncate(", name, ") failed");
+  }
+  return MemoryMapping(
+      std::move(file), 0, off64_t(size), MemoryMapping::writable());
+}
+
+MemoryMapping openSharedMemoryRegion(const std::string& name) {
+  int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+  checkUnixError(fd, "shm_open(", name, ") failed");
+  return MemoryMapping(
+      File(fd, /* ownsFd = */ true), 0, -1, MemoryMapping::writable());
+}
+
+bool unlinkSharedMemoryRegion(const std::string& name) {
+  if (::shm_unlink(name.c_str()) == 0) {
+    return true;
+  }
+  if (errno == ENOENT) {
+    return false;
+  }
+  throwSystemError("shm_unlink(", name, ") failed");
+}
+
+#else
+
+MemoryMapping createSharedMemoryRegion(const std::string&, size_t) {
+  throw_exception<std::runtime_error>("shared memory queues need shm_open()");
+}
+
+MemoryMapping openSharedMemoryRegion(const std::string&) {
+  throw_exception<std::runtime_error>("shared memory queues need shm_open()");
+}
+
+bool unlinkSharedMemoryRegion(const std::string&) {
+  throw_exception<std::runtime_error>("shared memory queues need shm_open()");
+}
+
+#endif
+
+} // namespace detail
+} // namespace folly
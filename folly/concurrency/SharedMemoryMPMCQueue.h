@@ -0,0 +1,418 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <folly/MPMCQueue.h>
+#include <folly/detail/Futex.h>
+#include <folly/lang/Align.h>
+#include <folly/lang/Exception.h>
+#include <folly/portability/SysTypes.h>
+#include <folly/system/MemoryMapping.h>
+
+namespace folly {
+
+namespace detail {
+
+/// Creates the POSIX shared memory object name, of exactly size bytes, and
+/// maps it. Throws std::system_error if it already exists.
+MemoryMapping createSharedMemoryRegion(const std::string& name, size_t size);
+
+/// Maps the whole of the existing POSIX shared memory object name.
+MemoryMapping openSharedMemoryRegion(const std::string& name);
+
+/// Returns false if there was no shared memory object name.
+bool unlinkSharedMemoryRegion(const std::string& name);
+
+} // namespace detail
+
+/**
+ * A bounded MPMC queue, with the same ticket-based algorithm as MPMCQueue,
+ * whose state lives in POSIX shared memory so that it can be used by
+ * producers and consumers in different processes.
+ *
+ * One process create()s the queue under a name (see shm_open(3)), and the
+ * others open() it by that name once create() has returned; each of them
+ * can then read and write concurrently, as with an MPMCQueue. Everything in
+ * the region is addressed by offset rather than by pointer, so it can be
+ * mapped at a different address by every process.
+ *
+ * Elements are copied into the region, and so must be trivially copyable:
+ * anything they point to is only meaningful in the process that wrote it.
+ * Blocking operations wait with futex() operations that are not private to
+ * a process, so blocking across processes only works on Linux; elsewhere
+ * waiters are only woken up by writers and readers of their own process.
+ *
+ * The queue does not survive the death of a process in the middle of an
+ * operation: if it dies between taking a ticket and completing its turn on
+ * the slot, every later operation on that slot waits forever. The shared
+ * memory object stays around until unlink() is called, even after all the
+ * processes that mapped it exited.
+ */
+template <typename T>
+class SharedMemoryMPMCQueue {
+  static_assert(
+      std::is_trivially_copyable<T>::value,
+      "SharedMemoryMPMCQueue elements must be trivially copyable");
+
+  using Slot = detail::SingleElementQueue<T, detail::SharedFutexAtomic>;
+
+ public:
+  using value_type = T;
+
+  /// Creates the shared memory object name, which must not exist yet, and
+  /// initializes a queue of the given capacity in it.
+  static SharedMemoryMPMCQueue create(
+      const std::string& name, size_t capacity) {
+    if (capacity == 0) {
+      throw_exception<std::invalid_argument>(
+          "SharedMemoryMPMCQueue capacity must be positive");
+    }
+    auto mapping = detail::createSharedMemoryRegion(name, bytesFor(capacity));
+    auto base = mapping.writableRange().data();
+    auto header = new (base) Header();
+    header->elementSize = sizeof(T);
+    header->elementAlign = alignof(T);
+    header->slotSize = sizeof(Slot);
+    header->capacity = capacity;
+    header->stride = computeStride(capacity);
+    auto slots = reinterpret_cast<Slot*>(base + kSlotsOffset);
+    for (size_t i = 0; i < capacity + 2 * kSlotPadding; ++i) {
+      new (slots + i) Slot();
+    }
+    header->magic.store(kMagic, std::memory_order_release);
+    return SharedMemoryMPMCQueue(std::move(mapping));
+  }
+
+  /// Maps the queue created under name by create(). Throws
+  /// std::invalid_argument if it is not such a queue, or one of a different
+  /// element type or layout.
+  static SharedMemoryMPMCQueue open(const std::string& name) {
+    auto mapping = detail::openSharedMemoryRegion(name);
+    auto range = mapping.range();
+    auto header = reinterpret_cast<const Header*>(range.data());
+    if (range.size() < kSlotsOffset ||
+        header->magic.load(std::memory_order_acquire) != kMagic ||
+        header->version != kVersion) {
+      throw_exception<std::invalid_argument>(
+          "not an initialized SharedMemoryMPMCQueue: " + name);
+    }
+    if (header->elementSize != sizeof(T) ||
+        header->elementAlign != alignof(T) ||
+        header->slotSize != sizeof(Slot) || header->capacity == 0 ||
+        range.size() != bytesFor(header->capacity)) {
+      throw_exception<std::invalid_argument>(
+          "SharedMemoryMPMCQueue layout mismatch: " + name);
+    }
+    return SharedMemoryMPMCQueue(std::move(mapping));
+  }
+
+  /// Removes the shared memory object name. Processes that mapped the queue
+  /// can keep using it; it is freed once they all unmapped it.
+  static bool unlink(const std::string& name) {
+    return detail::unlinkSharedMemoryRegion(name);
+  }
+
+  /// Size of the shared memory object of a queue of the given capacity.
+  static constexpr size_t bytesFor(size_t capacity) noexcept {
+    return kSlotsOffset + (capacity + 2 * kSlotPadding) * sizeof(Slot);
+  }
+
+  SharedMemoryMPMCQueue(SharedMemoryMPMCQueue&&) noexcept = default;
+  SharedMemoryMPMCQueue& operator=(SharedMemoryMPMCQueue&&) noexcept =
+      default;
+
+  size_t capacity() const noexcept { return capacity_; }
+
+  /// Returns the number of writes minus the number of reads, which is
+  /// negative if there are blocked readers. Only a snapshot, as for
+  /// MPMCQueue::size().
+  ssize_t size() const noexcept {
+    auto pushes = header_->pushTicket.load(std::memory_order_acquire);
+    auto pops = header_->popTicket.load(std::memory_order_acquire);
+    return ssize_t(pushes - pops);
+  }
+
+  bool isEmpty() const noexcept { return size() <= 0; }
+
+  bool isFull() const noexcept { return size() >= ssize_t(capacity_); }
+
+  /// Enqueues elem if that can be done without waiting.
+  bool write(const T& elem) noexcept {
+    uint64_t ticket;
+    if (!tryObtainReadyPushTicket(ticket)) {
+      return false;
+    }
+    enqueueWithTicket(ticket, elem);
+    return true;
+  }
+
+  /// Enqueues elem unless the queue is full. May wait for a reader that
+  /// took a ticket to finish.
+  bool writeIfNotFull(const T& elem) noexcept {
+    uint64_t ticket;
+    if (!tryObtainPromisedPushTicket(ticket)) {
+      return false;
+    }
+    enqueueWithTicket(ticket, elem);
+    return true;
+  }
+
+  /// Enqueues elem, waiting for room if the queue is full.
+  void blockingWrite(const T& elem) noexcept {
+    enqueueWithTicket(
+        header_->pushTicket.fetch_add(1, std::memory_order_acq_rel), elem);
+  }
+
+  template <class Clock>
+  bool tryWriteUntil(
+      const std::chrono::time_point<Clock>& when, const T& elem) noexcept {
+    uint64_t ticket;
+    while (!tryObtainPromisedPushTicket(ticket)) {
+      if (!slot(ticket).tryWaitForEnqueueTurnUntil(
+              turn(ticket),
+              header_->pushSpinCutoff,
+              (ticket % kAdaptationFreq) == 0,
+              when)) {
+        return false;
+      }
+    }
+    enqueueWithTicket(ticket, elem);
+    return true;
+  }
+
+  template <class Rep, class Period>
+  bool tryWriteFor(
+      const std::chrono::duration<Rep, Period>& duration,
+      const T& elem) noexcept {
+    return tryWriteUntil(std::chrono::steady_clock::now() + duration, elem);
+  }
+
+  /// Dequeues into elem if that can be done without waiting.
+  bool read(T& elem) noexcept {
+    uint64_t ticket;
+    if (!tryObtainReadyPopTicket(ticket)) {
+      return false;
+    }
+    dequeueWithTicket(ticket, elem);
+    return true;
+  }
+
+  /// Dequeues into elem unless the queue is empty. May wait for a writer
+  /// that took a ticket to finish.
+  bool readIfNotEmpty(T& elem) noexcept {
+    uint64_t ticket;
+    if (!tryObtainPromisedPopTicket(ticket)) {
+      return false;
+    }
+    dequeueWithTicket(ticket, elem);
+    return true;
+  }
+
+  /// Dequeues into elem, waiting for an element if the queue is empty.
+  void blockingRead(T& elem) noexcept {
+    dequeueWithTicket(
+        header_->popTicket.fetch_add(1, std::memory_order_acq_rel), elem);
+  }
+
+  template <class Clock>
+  bool tryReadUntil(
+      const std::chrono::time_point<Clock>& when, T& elem) noexcept {
+    uint64_t ticket;
+    while (!tryObtainPromisedPopTicket(ticket)) {
+      if (!slot(ticket).tryWaitForDequeueTurnUntil(
+              turn(ticket),
+              header_->popSpinCutoff,
+              (ticket % kAdaptationFreq) == 0,
+              when)) {
+        return false;
+      }
+    }
+    dequeueWithTicket(ticket, elem);
+    return true;
+  }
+
+  template <class Rep, class Period>
+  bool tryReadFor(
+      const std::chrono::duration<Rep, Period>& duration, T& elem) noexcept {
+    return tryReadUntil(std::chrono::steady_clock::now() + duration, elem);
+  }
+
+ private:
+  static constexpr uint64_t kMagic = 0x5368724d504d4351; // "ShrMPMCQ"
+  static constexpr uint32_t kVersion = 1;
+  static constexpr uint64_t kAdaptationFreq = 128;
+
+  /// The shared state at the start of the region. Only the atomics change
+  /// once create() has published magic.
+  struct Header {
+    std::atomic<uint64_t> magic{0};
+    uint32_t version{kVersion};
+    uint32_t elementSize{0};
+    uint32_t elementAlign{0};
+    uint32_t slotSize{0};
+    uint64_t capacity{0};
+    int stride{1};
+
+    alignas(hardware_destructive_interference_size)
+        detail::SharedFutexAtomic<uint64_t> pushTicket{0};
+    alignas(hardware_destructive_interference_size)
+        detail::SharedFutexAtomic<uint64_t> popTicket{0};
+    alignas(hardware_destructive_interference_size)
+        detail::SharedFutexAtomic<uint32_t> pushSpinCutoff{0};
+    alignas(hardware_destructive_interference_size)
+        detail::SharedFutexAtomic<uint32_t> popSpinCutoff{0};
+  };
+
+  /// As in MPMCQueue, the slots at either end are padding that is never
+  /// used, so that the used ones do not share cache lines with the header.
+  static constexpr size_t kSlotPadding =
+      (hardware_destructive_interference_size - 1) / sizeof(Slot) + 1;
+  static constexpr size_t kSlotsOffset =
+      (sizeof(Header) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+
+  explicit SharedMemoryMPMCQueue(MemoryMapping mapping) noexcept
+      : mapping_(std::move(mapping)),
+        header_(reinterpret_cast<Header*>(mapping_.writableRange().data())),
+        slots_(reinterpret_cast<Slot*>(
+            mapping_.writableRange().data() + kSlotsOffset)),
+        capacity_(header_->capacity),
+        stride_(header_->stride) {}
+
+  /// Same as MPMCQueueBase::computeStride().
+  static int computeStride(size_t capacity) noexcept {
+    static const int smallPrimes[] = {2, 3, 5, 7, 11, 13, 17, 19, 23};
+
+    int bestStride = 1;
+    size_t bestSep = 1;
+    for (int stride : smallPrimes) {
+      if ((stride % capacity) == 0 || (capacity % stride) == 0) {
+        continue;
+      }
+      size_t sep = stride % capacity;
+      sep = std::min(sep, capacity - sep);
+      if (sep > bestSep) {
+        bestStride = stride;
+        bestSep = sep;
+      }
+    }
+    return bestStride;
+  }
+
+  Slot& slot(uint64_t ticket) noexcept {
+    return slots_[((ticket * stride_) % capacity_) + kSlotPadding];
+  }
+
+  uint32_t turn(uint64_t ticket) const noexcept {
+    return uint32_t(ticket / capacity_);
+  }
+
+  // The ticket dispensers below are those of MPMCQueueBase, see there.
+
+  bool tryObtainReadyPushTicket(uint64_t& ticket) noexcept {
+    auto& pushTicket = header_->pushTicket;
+    ticket = pushTicket.load(std::memory_order_acquire);
+    while (true) {
+      if (!slot(ticket).mayEnqueue(turn(ticket))) {
+        auto prev = ticket;
+        ticket = pushTicket.load(std::memory_order_acquire);
+        if (prev == ticket) {
+          return false;
+        }
+      } else if (pushTicket.compare_exchange_strong(ticket, ticket + 1)) {
+        return true;
+      }
+    }
+  }
+
+  bool tryObtainPromisedPushTicket(uint64_t& ticket) noexcept {
+    auto numPushes = header_->pushTicket.load(std::memory_order_acquire);
+    while (true) {
+      ticket = numPushes;
+      auto numPops = header_->popTicket.load(std::memory_order_acquire);
+      if (int64_t(numPushes - numPops) >= int64_t(capacity_)) {
+        return false;
+      }
+      if (header_->pushTicket.compare_exchange_strong(
+              numPushes, numPushes + 1)) {
+        return true;
+      }
+    }
+  }
+
+  bool tryObtainReadyPopTicket(uint64_t& ticket) noexcept {
+    auto& popTicket = header_->popTicket;
+    ticket = popTicket.load(std::memory_order_acquire);
+    while (true) {
+      if (!slot(ticket).mayDequeue(turn(ticket))) {
+        auto prev = ticket;
+        ticket = popTicket.load(std::memory_order_acquire);
+        if (prev == ticket) {
+          return false;
+        }
+      } else if (popTicket.compare_exchange_strong(ticket, ticket + 1)) {
+        return true;
+      }
+    }
+  }
+
+  bool tryObtainPromisedPopTicket(uint64_t& ticket) noexcept {
+    auto numPops = header_->popTicket.load(std::memory_order_acquire);
+    while (true) {
+      ticket = numPops;
+      auto numPushes = header_->pushTicket.load(std::memory_order_acquire);
+      if (numPops >= numPushes) {
+        return false;
+      }
+      if (header_->popTicket.compare_exchange_strong(numPops, numPops + 1)) {
+        return true;
+      }
+    }
+  }
+
+  void enqueueWithTicket(uint64_t ticket, const T& elem) noexcept {
+    slot(ticket).enqueue(
+        turn(ticket),
+        header_->pushSpinCutoff,
+        (ticket % kAdaptationFreq) == 0,
+        elem);
+  }
+
+  void dequeueWithTicket(uint64_t ticket, T& elem) noexcept {
+    slot(ticket).dequeue(
+        turn(ticket),
+        header_->popSpinCutoff,
+        (ticket % kAdaptationFreq) == 0,
+        elem);
+  }
+
+  MemoryMapping mapping_;
+  Header* header_;
+  Slot* slots_;
+  size_t capacity_;
+  int stride_;
+};
+
+} // namespace folly
@@ -17,13 +17,16 @@
 #pragma once
 
 #include <atomic>
+#include <algorithm>
 #include <chrono>
+#include <iterator>
 #include <memory>
 
 #include <glog/logging.h>
 
 #include <folly/ConstexprMath.h>
 #include <folly/Optional.h>
+#include <folly/ScopeGuard.h>
 #include <folly/Traits.h>
 #include <folly/concurrency/CacheLocality.h>
 #include <folly/lang/Align.h>
@@ -79,6 +82,9 @@ namespace folly {
 ///     void enqueue(const T&);
 ///     void enqueue(T&&);
 ///         Adds an element to the end of the queue.
+///     void enqueue_bulk(ForwardIt first, ForwardIt last);
+///         Adds the elements of [first, last) to the end of the queue,
+///         contiguously and in order, with a single ticket update.
 ///
 ///   Consumer operations:
 ///     void dequeue(T&);
@@ -101,6 +107,15 @@ namespace folly {
 ///         Returns pointer to the element at the front of the queue
 ///         if available, or nullptr if the queue is empty. Only for
 ///         SPSC and MPSC.
+///     size_t try_dequeue_bulk(OutputIt out, size_t max);
+///         Extracts up to max elements from the front of the queue, if
+///         available, with a single ticket update, assigns them to
+///         consecutive positions of out, and returns their number.
+///         Like try_dequeue, may wait for elements whose producers
+///         have already taken a ticket but not yet finished enqueueing.
+///         If assigning to out throws, the elements claimed by the call
+///         but not yet assigned are destroyed and the exception is
+///         propagated; the queue itself stays consistent.
 ///
 ///   Secondary functions:
 ///     size_t size();
@@ -270,6 +285,25 @@ class UnboundedQueue {
 
   FOLLY_ALWAYS_INLINE void enqueue(T&& arg) { enqueueImpl(std::move(arg)); }
 
+  /** enqueue_bulk */
+  template <typename ForwardIt>
+  void enqueue_bulk(ForwardIt first, ForwardIt last) {
+    auto n = static_cast<Ticket>(std::distance(first, last));
+    if (n == 0) {
+      return;
+    }
+    if (SPSC) {
+      Segment* s = tail();
+      enqueueBulkCommon(s, first, n);
+    } else {
+      // Using hazptr_holder instead of hazptr_local because it is
+      // possible that the T ctor happens to use hazard pointers.
+      hazptr_holder<Atom> hptr = make_hazard_pointer<Atom>();
+      Segment* s = hptr.protect(p_.tail);
+      enqueueBulkCommon(s, first, n);
+    }
+  }
+
   /** dequeue */
   FOLLY_ALWAYS_INLINE void dequeue(T& item) noexcept { item = dequeueImpl(); }
 
@@ -334,6 +368,23 @@ class UnboundedQueue {
     return tryDequeueUntil(std::chrono::steady_clock::now() + duration);
   }
 
+  /** try_dequeue_bulk */
+  template <typename OutputIt>
+  size_t try_dequeue_bulk(OutputIt out, size_t max) {
+    if (max == 0) {
+      return 0;
+    }
+    if (SingleConsumer) {
+      return tryDequeueBulkSC(out, max);
+    } else {
+      // Using hazptr_holder instead of hazptr_local because it is
+      //  possible to call ~T() and it may happen to use hazard pointers.
+      hazptr_holder<Atom> hptr = make_hazard_pointer<Atom>();
+      Segment* s = hptr.protect(c_.head);
+      return tryDequeueBulkMC(s, out, max);
+    }
+  }
+
   /** try_peek */
   FOLLY_ALWAYS_INLINE const T* try_peek() noexcept {
     static_assert(SingleConsumer, "not single-consumer");
@@ -390,6 +441,30 @@ class UnboundedQueue {
     }
   }
 
+  /** enqueueBulkCommon */
+  template <typename It>
+  void enqueueBulkCommon(Segment* s, It first, Ticket n) {
+    Ticket t = fetchAddProducerTicket(n);
+    for (Ticket end = t + n; t != end; ++t, ++first) {
+      if (SPSC) {
+        s = tail();
+      } else {
+        s = findSegment(s, t);
+      }
+      DCHECK_GE(t, s->minTicket());
+      DCHECK_LT(t, s->minTicket() + SegmentSize);
+      size_t idx = index(t);
+      Entry& e = s->entry(idx);
+      e.putItem(*first);
+      if (responsibleForAlloc(t)) {
+        allocNextSegment(s);
+      }
+      if (responsibleForAdvance(t)) {
+        advanceTail(s);
+      }
+    }
+  }
+
   /** dequeueImpl */
   FOLLY_ALWAYS_INLINE T dequeueImpl() noexcept {
     if (SPSC) {
@@ -486,6 +561,87 @@ class UnboundedQueue {
     }
   }
 
+  /** tryDequeueBulkSC */
+  template <typename OutputIt>
+  size_t tryDequeueBulkSC(OutputIt out, size_t max) {
+    Ticket t = consumerTicket();
+    Ticket p = producerTicket();
+    if (t >= p) {
+      return 0;
+    }
+    Ticket n = std::min<Ticket>(max, p - t);
+    setConsumerTicket(t + n);
+    Ticket end = t + n;
+    auto take = [&](auto&& sink) {
+      for (; t != end; ++t) {
+        Segment* s = head();
+        DCHECK_GE(t, s->minTicket());
+        DCHECK_LT(t, (s->minTicket() + SegmentSize));
+        size_t idx = index(t);
+        Entry& e = s->entry(idx);
+        auto advance = makeGuard([&] {
+          if (responsibleForAdvance(t)) {
+            advanceHead(s);
+          }
+        });
+        sink(e.takeItem());
+      }
+    };
+    try {
+      take([&](T&& item) {
+        *out = std::move(item);
+        ++out;
+      });
+    } catch (...) {
+      // The failed element is gone; drop the rest of the claimed ones.
+      ++t;
+      take([](T&&) noexcept {});
+      throw;
+    }
+    return n;
+  }
+
+  /** tryDequeueBulkMC */
+  template <typename OutputIt>
+  size_t tryDequeueBulkMC(Segment* s, OutputIt out, size_t max) {
+    Ticket t = consumerTicket();
+    Ticket n;
+    do {
+      Ticket p = producerTicket();
+      if (t >= p) {
+        return 0;
+      }
+      n = std::min<Ticket>(max, p - t);
+    } while (!c_.ticket.compare_exchange_weak(
+        t, t + n, std::memory_order_acq_rel, std::memory_order_acquire));
+    Ticket end = t + n;
+    auto take = [&](auto&& sink) {
+      for (; t != end; ++t) {
+        s = findSegment(s, t);
+        size_t idx = index(t);
+        Entry& e = s->entry(idx);
+        auto advance = makeGuard([&] {
+          if (responsibleForAdvance(t)) {
+            advanceHead(s);
+          }
+        });
+        sink(e.takeItem());
+      }
+    };
+    try {
+      take([&](T&& item) {
+        *out = std::move(item);
+        ++out;
+      });
+    } catch (...) {
+      // The failed element is gone; drop the rest of the claimed ones.
+      ++t;
+      take([](T&&) noexcept {});
+      throw;
+    }
+    return n;
+  }
+
   /** tryDequeueWaitElem */
   template <typename Clock, typename Duration>
   FOLLY_ALWAYS_INLINE bool tryDequeueWaitElem(
@@ -746,6 +902,16 @@ class UnboundedQueue {
     }
   }
 
+  FOLLY_ALWAYS_INLINE Ticket fetchAddProducerTicket(Ticket n) noexcept {
+    if (SingleProducer) {
+      Ticket oldval = producerTicket();
+      setProducerTicket(oldval + n);
+      return oldval;
+    } else { // MP
+      return p_.ticket.fetch_add(n, std::memory_order_acq_rel);
+    }
+  }
+
   /**
    *  Entry
    */
@@ -21,8 +21,10 @@
 #include <mutex>
 #include <new>
 
+#include <folly/concurrency/CacheLocality.h>
 #include <folly/container/HeterogeneousAccess.h>
 #include <folly/container/detail/F14Mask.h>
+#include <folly/lang/Align.h>
 #include <folly/lang/Exception.h>
 #include <folly/synchronization/Hazptr.h>
 
@@ -45,6 +47,96 @@ enum class InsertType {
          // value.
 };
 
+// Approximate element count shared by all segments of a map. Segments report
+// size changes to a cpu-local stripe, and a stripe folds its accumulated
+// delta into a single total once it reaches kFlushThreshold in magnitude.
+// Writers thus rarely touch a cache line shared with other cores, and
+// readers only read the total, which lags the exact size by at most
+// kNumStripes * kFlushThreshold elements.
+class alignas(hardware_destructive_interference_size) SizeCounter {
+ public:
+  static constexpr size_t kNumStripes = 16;
+  static constexpr int64_t kFlushThreshold = 32;
+
+  void add(int64_t delta) noexcept {
+    auto& stripe = stripes_[AccessSpreader<>::cachedCurrent(kNumStripes)];
+    auto v = stripe.delta.fetch_add(delta, std::memory_order_relaxed) + delta;
+    if (v >= kFlushThreshold || v <= -kFlushThreshold) {
+      total_.fetch_add(
+          stripe.delta.exchange(0, std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+  }
+
+  size_t approximate() const noexcept {
+    auto total = total_.load(std::memory_order_relaxed);
+    return total > 0 ? size_t(total) : 0;
+  }
+
+  // The total and the deltas not yet folded into it, at the cost of reading
+  // every stripe. Exact when there are no concurrent updates.
+  size_t accurate() const noexcept {
+    auto total = total_.load(std::memory_order_relaxed);
+    for (auto& stripe : stripes_) {
+      total += stripe.delta.load(std::memory_order_relaxed);
+    }
+    return total > 0 ? size_t(total) : 0;
+  }
+
+ private:
+  struct alignas(hardware_destructive_interference_size) Stripe {
+    std::atomic<int64_t> delta{0};
+  };
+
+  std::atomic<int64_t> total_{0};
+  Stripe stripes_[kNumStripes];
+};
+
+// The cohort that a map retires its nodes and tables to. It also counts the
+// bytes of the tables from allocation until they are reclaimed, and, if
+// countNodes, the nodes too, so that memory that is retired but not yet
+// reclaimed can be attributed to the map. Whether nodes are counted is fixed
+// for the life of the cohort, so that every node that is uncounted on
+// destruction was counted on construction.
+template <template <typename> class Atom>
+class Cohort : public hazptr_obj_cohort<Atom> {
+ public:
+  explicit Cohort(bool countNodes = false) noexcept
+      : countNodes_(countNodes) {}
+
+  // Reclaim while the counts are still alive.
+  ~Cohort() { this->shutdown_and_reclaim(); }
+
+  static Cohort* of(hazptr_obj<Atom>* obj) {
+    return static_cast<Cohort*>(obj->cohort());
+  }
+
+  bool countsNodes() const noexcept { return countNodes_; }
+
+  void addNodes(int64_t delta) noexcept {
+    if (countNodes_) {
+      nodes_.add(delta);
+    }
+  }
+
+  void addTableBytes(int64_t delta) noexcept {
+    tableBytes_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  // Only meaningful if countsNodes()
+  size_t nodes() const noexcept { return nodes_.accurate(); }
+
+  size_t tableBytes() const noexcept {
+    auto bytes = tableBytes_.load(std::memory_order_relaxed);
+    return bytes > 0 ? size_t(bytes) : 0;
+  }
+
+ private:
+  const bool countNodes_;
+  SizeCounter nodes_;
+  Atom<int64_t> tableBytes_{0};
+};
+
 template <
     typename KeyType,
     typename ValueType,
@@ -188,13 +280,13 @@ class NodeT : public hazptr_obj_base_linked<
  public:
   typedef std::pair<const KeyType, ValueType> value_type;
 
-  explicit NodeT(hazptr_obj_cohort<Atom>* cohort, NodeT* other)
+  explicit NodeT(Cohort<Atom>* cohort, NodeT* other)
       : item_(other->item_) {
     init(cohort);
   }
 
   template <typename Arg, typename... Args>
-  NodeT(hazptr_obj_cohort<Atom>* cohort, Arg&& k, Args&&... args)
+  NodeT(Cohort<Atom>* cohort, Arg&& k, Args&&... args)
       : item_(
             std::piecewise_construct,
             std::forward<Arg>(k),
@@ -202,6 +294,8 @@ class NodeT : public hazptr_obj_base_linked<
     init(cohort);
   }
 
+  ~NodeT() { Cohort<Atom>::of(this)->addNodes(-1); }
+
   void release() { this->unlink(); }
 
   value_type& getItem() { return item_.getItem(); }
@@ -219,12 +313,13 @@ class NodeT : public hazptr_obj_base_linked<
   Atom<NodeT*> next_{nullptr};
 
  private:
-  void init(hazptr_obj_cohort<Atom>* cohort) {
+  void init(Cohort<Atom>* cohort) {
     DCHECK(cohort);
     this->set_deleter( // defined in hazptr_obj
         concurrenthashmap::HazptrDeleter<Allocator>());
     this->set_cohort_tag(cohort); // defined in hazptr_obj
     this->acquire_link_safe(); // defined in hazptr_obj_base_linked
+    cohort->addNodes(1);
   }
 
   ValueHolder<KeyType, ValueType, Allocator, Atom> item_;
@@ -256,8 +351,11 @@ class alignas(64) BucketTable {
       size_t initial_buckets,
       float load_factor,
       size_t max_size,
-      hazptr_obj_cohort<Atom>* cohort)
-      : load_factor_(load_factor), max_size_(max_size) {
+      Cohort<Atom>* cohort,
+      concurrenthashmap::SizeCounter* sizeCounter = nullptr)
+      : sizeCounter_(sizeCounter),
+        load_factor_(load_factor),
+        max_size_(max_size) {
     DCHECK(cohort);
     initial_buckets = folly::nextPowTwo(initial_buckets);
     DCHECK(
@@ -284,17 +382,34 @@ class alignas(64) BucketTable {
 
   size_t size() { return size_.load(std::memory_order_acquire); }
 
-  void clearSize() { size_.store(0, std::memory_order_release); }
+  // Bytes of the current bucket array
+  size_t tableBytes() {
+    return Buckets::allocationSize(
+        bucket_count_.load(std::memory_order_acquire));
+  }
+
+  void clearSize() {
+    if (sizeCounter_) {
+      sizeCounter_->add(-int64_t(size_.load(std::memory_order_relaxed)));
+    }
+    size_.store(0, std::memory_order_release);
+  }
 
   void incSize() {
     auto sz = size_.load(std::memory_order_relaxed);
     size_.store(sz + 1, std::memory_order_release);
+    if (sizeCounter_) {
+      sizeCounter_->add(1);
+    }
   }
 
   void decSize() {
     auto sz = size_.load(std::memory_order_relaxed);
     DCHECK_GT(sz, 0);
     size_.store(sz - 1, std::memory_order_release);
+    if (sizeCounter_) {
+      sizeCounter_->add(-1);
+    }
   }
 
   bool empty() { return size() == 0; }
@@ -306,7 +421,7 @@ class alignas(64) BucketTable {
       const K& k,
       InsertType type,
       MatchFunc match,
-      hazptr_obj_cohort<Atom>* cohort,
+      Cohort<Atom>* cohort,
       Args&&... args) {
     return doInsert(
         it, h, k, type, match, nullptr, cohort, std::forward<Args>(args)...);
@@ -320,12 +435,12 @@ class alignas(64) BucketTable {
       InsertType type,
       MatchFunc match,
       Node* cur,
-      hazptr_obj_cohort<Atom>* cohort) {
+      Cohort<Atom>* cohort) {
     return doInsert(it, h, k, type, match, cur, cohort, cur);
   }
 
   // Must hold lock.
-  void rehash(size_t bucket_count, hazptr_obj_cohort<Atom>* cohort) {
+  void rehash(size_t bucket_count, Cohort<Atom>* cohort) {
     auto oldcount = bucket_count_.load(std::memory_order_relaxed);
     // bucket_count must be a power of 2
     DCHECK_EQ(bucket_count & (bucket_count - 1), 0);
@@ -460,7 +575,7 @@ class alignas(64) BucketTable {
     return 0;
   }
 
-  void clear(hazptr_obj_cohort<Atom>* cohort) {
+  void clear(Cohort<Atom>* cohort) {
     size_t bcount;
     Buckets* buckets;
     {
@@ -494,6 +609,16 @@ class alignas(64) BucketTable {
 
   Iterator cend() { return Iterator(nullptr); }
 
+  // Calls f on every element while holding the writer lock, so that the
+  // elements visited form a consistent snapshot of this table.
+  template <typename F>
+  void forEachLocked(F&& f) {
+    std::lock_guard<Mutex> g(m_);
+    for (auto it = cbegin(), end = cend(); it != end; ++it) {
+      f(*it);
+    }
+  }
+
  private:
   // Could be optimized to avoid an extra pointer dereference by
   // allocating buckets_ at the same time.
@@ -507,12 +632,16 @@ class alignas(64) BucketTable {
     ~Buckets() {}
 
    public:
-    static Buckets* create(size_t count, hazptr_obj_cohort<Atom>* cohort) {
-      auto buf =
-          Allocator().allocate(sizeof(Buckets) + sizeof(BucketRoot) * count);
+    static size_t allocationSize(size_t count) {
+      return sizeof(Buckets) + sizeof(BucketRoot) * count;
+    }
+
+    static Buckets* create(size_t count, Cohort<Atom>* cohort) {
+      auto buf = Allocator().allocate(allocationSize(count));
       auto buckets = new (buf) Buckets();
       DCHECK(cohort);
       buckets->set_cohort_tag(cohort); // defined in hazptr_obj
+      cohort->addTableBytes(allocationSize(count));
       for (size_t i = 0; i < count; i++) {
         new (&buckets->buckets_[i]) BucketRoot;
       }
@@ -523,9 +652,9 @@ class alignas(64) BucketTable {
       for (size_t i = 0; i < count; i++) {
         buckets_[i].~BucketRoot();
       }
+      Cohort<Atom>::of(this)->addTableBytes(-int64_t(allocationSize(count)));
       this->~Buckets();
-      Allocator().deallocate(
-          (uint8_t*)this, sizeof(BucketRoot) * count + sizeof(*this));
+      Allocator().deallocate((uint8_t*)this, allocationSize(count));
     }
 
     void unlink_and_reclaim_nodes(size_t count) {
@@ -663,7 +792,7 @@ class alignas(64) BucketTable {
       InsertType type,
       MatchFunc match,
       Node* cur,
-      hazptr_obj_cohort<Atom>* cohort,
+      Cohort<Atom>* cohort,
       Args&&... args) {
     std::unique_lock<Mutex> g(m_);
 
@@ -763,6 +892,7 @@ class alignas(64) BucketTable {
     return true;
   }
 
+  concurrenthashmap::SizeCounter* sizeCounter_;
   Mutex m_;
   float load_factor_;
   size_t load_factor_nodes_;
@@ -803,7 +933,7 @@ class NodeT : public hazptr_obj_base<
   typedef std::pair<const KeyType, ValueType> value_type;
 
   template <typename Arg, typename... Args>
-  NodeT(hazptr_obj_cohort<Atom>* cohort, Arg&& k, Args&&... args)
+  NodeT(Cohort<Atom>* cohort, Arg&& k, Args&&... args)
       : item_(
             std::piecewise_construct,
             std::forward_as_tuple(std::forward<Arg>(k)),
@@ -811,14 +941,17 @@ class NodeT : public hazptr_obj_base<
     init(cohort);
   }
 
+  ~NodeT() { Cohort<Atom>::of(this)->addNodes(-1); }
+
   value_type& getItem() { return item_; }
 
  private:
-  void init(hazptr_obj_cohort<Atom>* cohort) {
+  void init(Cohort<Atom>* cohort) {
     DCHECK(cohort);
     this->set_deleter( // defined in hazptr_obj
         HazptrDeleter<Allocator>());
     this->set_cohort_tag(cohort); // defined in hazptr_obj
+    cohort->addNodes(1);
   }
 
   value_type item_;
@@ -996,11 +1129,16 @@ class alignas(64) SIMDTable {
     ~Chunks() {}
 
    public:
-    static Chunks* create(size_t count, hazptr_obj_cohort<Atom>* cohort) {
-      auto buf = Allocator().allocate(sizeof(Chunks) + sizeof(Chunk) * count);
+    static size_t allocationSize(size_t count) {
+      return sizeof(Chunks) + sizeof(Chunk) * count;
+    }
+
+    static Chunks* create(size_t count, Cohort<Atom>* cohort) {
+      auto buf = Allocator().allocate(allocationSize(count));
       auto chunks = new (buf) Chunks();
       DCHECK(cohort);
       chunks->set_cohort_tag(cohort); // defined in hazptr_obj
+      cohort->addTableBytes(allocationSize(count));
       for (size_t i = 0; i < count; i++) {
         new (&chunks->chunks_[i]) Chunk;
         chunks->chunks_[i].clear();
@@ -1012,9 +1150,9 @@ class alignas(64) SIMDTable {
       for (size_t i = 0; i < count; i++) {
         chunks_[i].~Chunk();
       }
+      Cohort<Atom>::of(this)->addTableBytes(-int64_t(allocationSize(count)));
       this->~Chunks();
-      Allocator().deallocate(
-          (uint8_t*)this, sizeof(Chunk) * count + sizeof(*this));
+      Allocator().deallocate((uint8_t*)this, allocationSize(count));
     }
 
     void reclaim_nodes(size_t count) {
@@ -1160,8 +1298,10 @@ class alignas(64) SIMDTable {
       size_t initial_size,
       float load_factor,
       size_t max_size,
-      hazptr_obj_cohort<Atom>* cohort)
-      : load_factor_(load_factor),
+      Cohort<Atom>* cohort,
+      concurrenthashmap::SizeCounter* sizeCounter = nullptr)
+      : sizeCounter_(sizeCounter),
+        load_factor_(load_factor),
         max_size_(max_size),
         chunks_(nullptr),
         chunk_count_(0) {
@@ -1188,17 +1328,33 @@ class alignas(64) SIMDTable {
 
   size_t size() { return size_.load(std::memory_order_acquire); }
 
-  void clearSize() { size_.store(0, std::memory_order_release); }
+  // Bytes of the current chunk array
+  size_t tableBytes() {
+    return Chunks::allocationSize(chunk_count_.load(std::memory_order_acquire));
+  }
+
+  void clearSize() {
+    if (sizeCounter_) {
+      sizeCounter_->add(-int64_t(size_.load(std::memory_order_relaxed)));
+    }
+    size_.store(0, std::memory_order_release);
+  }
 
   void incSize() {
     auto sz = size_.load(std::memory_order_relaxed);
     size_.store(sz + 1, std::memory_order_release);
+    if (sizeCounter_) {
+      sizeCounter_->add(1);
+    }
   }
 
   void decSize() {
     auto sz = size_.load(std::memory_order_relaxed);
     DCHECK_GT(sz, 0);
     size_.store(sz - 1, std::memory_order_release);
+    if (sizeCounter_) {
+      sizeCounter_->add(-1);
+    }
   }
 
   bool empty() { return size() == 0; }
@@ -1210,7 +1366,7 @@ class alignas(64) SIMDTable {
       const K& k,
       InsertType type,
       MatchFunc match,
-      hazptr_obj_cohort<Atom>* cohort,
+      Cohort<Atom>* cohort,
       Args&&... args) {
     Node* node;
     Chunks* chunks;
@@ -1265,7 +1421,7 @@ class alignas(64) SIMDTable {
       InsertType type,
       MatchFunc match,
       Node* cur,
-      hazptr_obj_cohort<Atom>* cohort) {
+      Cohort<Atom>* cohort) {
     DCHECK(cur != nullptr);
     Node* node;
     Chunks* chunks;
@@ -1309,7 +1465,7 @@ class alignas(64) SIMDTable {
     return true;
   }
 
-  void rehash(size_t size, hazptr_obj_cohort<Atom>* cohort) {
+  void rehash(size_t size, Cohort<Atom>* cohort) {
     size_t new_chunk_count = size == 0 ? 0 : (size - 1) / Chunk::kCapacity + 1;
     rehash_internal(folly::nextPowTwo(new_chunk_count), cohort);
   }
@@ -1402,7 +1558,7 @@ class alignas(64) SIMDTable {
     return 1;
   }
 
-  void clear(hazptr_obj_cohort<Atom>* cohort) {
+  void clear(Cohort<Atom>* cohort) {
     size_t ccount;
     Chunks* chunks;
     {
@@ -1441,6 +1597,16 @@ class alignas(64) SIMDTable {
 
   Iterator cend() { return Iterator(nullptr); }
 
+  // Calls f on every element while holding the writer lock, so that the
+  // elements visited form a consistent snapshot of this table.
+  template <typename F>
+  void forEachLocked(F&& f) {
+    std::lock_guard<Mutex> g(m_);
+    for (auto it = cbegin(), end = cend(); it != end; ++it) {
+      f(*it);
+    }
+  }
+
  private:
   static HashPair splitHash(std::size_t hash) {
     std::size_t c = _mm_crc32_u64(0, hash);
@@ -1489,7 +1655,7 @@ class alignas(64) SIMDTable {
       const K& k,
       InsertType type,
       MatchFunc match,
-      hazptr_obj_cohort<Atom>* cohort,
+      Cohort<Atom>* cohort,
       size_t& chunk_idx,
       size_t& tag_idx,
       Node*& node,
@@ -1545,7 +1711,7 @@ class alignas(64) SIMDTable {
   }
 
   void rehash_internal(
-      size_t new_chunk_count, hazptr_obj_cohort<Atom>* cohort) {
+      size_t new_chunk_count, Cohort<Atom>* cohort) {
     DCHECK(isPowTwo(new_chunk_count));
     auto old_chunk_count = chunk_count_.load(std::memory_order_relaxed);
     if (old_chunk_count >= new_chunk_count) {
@@ -1617,6 +1783,7 @@ class alignas(64) SIMDTable {
     return std::make_pair(chunk_idx & (ccount - 1), dst_tag_idx);
   }
 
+  concurrenthashmap::SizeCounter* sizeCounter_;
   Mutex m_;
   float load_factor_; // ceil of 1.0
   size_t grow_threshold_;
@@ -1703,8 +1870,10 @@ class alignas(64) ConcurrentHashMapSegment {
       size_t initial_buckets,
       float load_factor,
       size_t max_size,
-      hazptr_obj_cohort<Atom>* cohort)
-      : impl_(initial_buckets, load_factor, max_size, cohort), cohort_(cohort) {
+      concurrenthashmap::Cohort<Atom>* cohort,
+      concurrenthashmap::SizeCounter* sizeCounter = nullptr)
+      : impl_(initial_buckets, load_factor, max_size, cohort, sizeCounter),
+        cohort_(cohort) {
     DCHECK(cohort);
   }
 
@@ -1712,6 +1881,8 @@ class alignas(64) ConcurrentHashMapSegment {
 
   size_t size() { return impl_.size(); }
 
+  size_t tableBytes() { return impl_.tableBytes(); }
+
   bool empty() { return impl_.empty(); }
 
   template <typename Key>
@@ -1903,9 +2074,14 @@ class alignas(64) ConcurrentHashMapSegment {
 
   Iterator cend() { return impl_.cend(); }
 
+  template <typename F>
+  void forEachLocked(F&& f) {
+    impl_.forEachLocked(std::forward<F>(f));
+  }
+
  private:
   ImplT impl_;
-  hazptr_obj_cohort<Atom>* cohort_;
+  concurrenthashmap::Cohort<Atom>* cohort_;
 };
 } // namespace detail
 } // namespace folly
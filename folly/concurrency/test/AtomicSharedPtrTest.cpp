@@ -248,6 +248,89 @@ TEST(AtomicSharedPtr, StressTest) {
   }
 }
 
+TEST(AtomicSharedPtr, LoadBorrowed) {
+  read_cached_atomic_shared_ptr<int> ptr;
+  EXPECT_FALSE(ptr.load_borrowed());
+
+  auto a = make_shared<int>(1);
+  ptr.store(a);
+  {
+    auto b1 = ptr.load_borrowed();
+    EXPECT_EQ(a.get(), b1.get());
+    // Borrowing does not take references after the first refresh.
+    auto count = a.use_count();
+    auto b2 = ptr.load_borrowed();
+    EXPECT_EQ(1, *b2);
+    EXPECT_EQ(count, a.use_count());
+
+    // While borrowed, a new value is lent out from an owned copy.
+    ptr.store(make_shared<int>(2));
+    auto b3 = ptr.load_borrowed();
+    EXPECT_EQ(2, *b3);
+    EXPECT_EQ(1, *b1);
+    EXPECT_EQ(2, *b3.to_shared());
+  }
+  // Once nothing is borrowed the thread's reference is refreshed, dropping
+  // the old value.
+  EXPECT_EQ(2, *ptr.load_borrowed());
+  EXPECT_EQ(1, a.use_count());
+
+  ptr.store(nullptr);
+  EXPECT_FALSE(ptr.load_borrowed());
+}
+
+TEST(AtomicSharedPtr, LoadBorrowedAliased) {
+  read_cached_atomic_shared_ptr<int> ptr;
+  auto owner = make_shared<int>(0);
+  int values[2] = {1, 2};
+  for (int i = 0; i < 100; i++) {
+    // Each store allocates a new wrapper for the aliased pointer, which may
+    // reuse the address of the previous one if the cache did not hold it.
+    ptr.store(shared_ptr<int>(owner, &values[i % 2]));
+    EXPECT_EQ(&values[i % 2], ptr.load_borrowed().get());
+  }
+}
+
+TEST(AtomicSharedPtr, LoadBorrowedReleasesOnDestruction) {
+  c_count = 0;
+  d_count = 0;
+  {
+    read_cached_atomic_shared_ptr<foo> ptr;
+    ptr.store(make_shared<foo>());
+    std::thread([&] { EXPECT_TRUE(ptr.load_borrowed()); }).join();
+    EXPECT_TRUE(ptr.load_borrowed());
+    ptr.store(nullptr);
+    // Both threads still reference the object.
+    EXPECT_EQ(0, d_count);
+  }
+  EXPECT_EQ(1, c_count);
+  EXPECT_EQ(1, d_count);
+}
+
+TEST(AtomicSharedPtr, LoadBorrowedStressTest) {
+  read_cached_atomic_shared_ptr<size_t> ptr(make_shared<size_t>(0));
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < FLAGS_num_threads; ++tid) {
+    threads.emplace_back([&] {
+      size_t last = 0;
+      while (!done.load(std::memory_order_acquire)) {
+        auto b = ptr.load_borrowed();
+        EXPECT_GE(*b, last);
+        last = *b;
+      }
+    });
+  }
+  for (size_t i = 1; i <= 10000; ++i) {
+    ptr.store(make_shared<size_t>(i));
+  }
+  done = true;
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(10000, *ptr.load_borrowed());
+}
+
 TEST(AtomicSharedPtr, Leak) {
   static auto& ptr = *new atomic_shared_ptr<int>();
   ptr.store(std::make_shared<int>(3), std::memory_order_relaxed);
@@ -19,12 +19,15 @@
 #include <atomic>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <thread>
 #include <vector>
 
 #include <folly/Portability.h>
 #include <folly/Traits.h>
 #include <folly/container/test/TrackingTypes.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/InlineExecutor.h>
 #include <folly/hash/Hash.h>
 #include <folly/portability/GFlags.h>
 #include <folly/portability/GTest.h>
@@ -1188,8 +1191,94 @@ TYPED_TEST_P(ConcurrentHashMapTest, StressTestReclamation) {
 #endif
 }
 
+TYPED_TEST_P(ConcurrentHashMapTest, ForEachShardParallel) {
+  CHM<uint64_t, uint64_t> map;
+  InlineExecutor inlineExecutor;
+  std::atomic<uint64_t> sum{0};
+  map.forEachShardParallel(inlineExecutor, [&](auto&) { ++sum; });
+  EXPECT_EQ(0, sum.load());
+
+  constexpr uint64_t kEntries = 10000;
+  for (uint64_t i = 0; i < kEntries; ++i) {
+    map.insert(i, i);
+  }
+
+  CPUThreadPoolExecutor executor(4);
+  std::atomic<size_t> lastProgress{0};
+  size_t total = 0;
+  map.forEachShardParallel(
+      executor,
+      [&](auto const& kv) { sum += kv.second; },
+      [&](size_t done, size_t shards) {
+        total = shards;
+        auto prev = lastProgress.load();
+        while (prev < done && !lastProgress.compare_exchange_weak(prev, done)) {
+        }
+      });
+  EXPECT_EQ(kEntries * (kEntries - 1) / 2, sum.load());
+  EXPECT_GT(total, 0);
+  EXPECT_EQ(total, lastProgress.load());
+
+  // Writers to a shard being scanned wait, others proceed.
+  lib::thread t([&] {
+    for (uint64_t i = kEntries; i < 2 * kEntries; ++i) {
+      map.insert(i, i);
+    }
+  });
+  std::atomic<uint64_t> seen{0};
+  map.forEachShardParallel(executor, [&](auto&) { ++seen; });
+  join;
+  EXPECT_GE(seen.load(), kEntries);
+  EXPECT_LE(seen.load(), 2 * kEntries);
+
+  EXPECT_THROW(
+      map.forEachShardParallel(
+          executor, [](auto&) { throw std::runtime_error("fail"); }),
+      std::runtime_error);
+}
+
+TYPED_TEST_P(ConcurrentHashMapTest, ApproximateSize) {
+  using Counter = folly::detail::concurrenthashmap::SizeCounter;
+  constexpr size_t kSlack = Counter::kNumStripes * Counter::kFlushThreshold;
+  CHM<uint64_t, uint64_t> map;
+  EXPECT_EQ(0, map.approximate_size());
+
+  constexpr uint64_t kEntries = 10000;
+  std::vector<std::thread> threads;
+  for (uint64_t n = 0; n < 4; ++n) {
+    threads.emplace_back([&, n] {
+      for (uint64_t i = n; i < kEntries; i += 4) {
+        map.insert(i, i);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    join;
+  }
+  EXPECT_EQ(kEntries, map.size());
+  EXPECT_LE(map.approximate_size(), kEntries + kSlack);
+  EXPECT_GE(map.approximate_size() + kSlack, kEntries);
+
+  auto shards = map.shard_sizes();
+  EXPECT_EQ(256, shards.size()); // default ShardBits
+  EXPECT_EQ(kEntries, std::accumulate(shards.begin(), shards.end(), size_t(0)));
+
+  for (uint64_t i = 0; i < kEntries / 2; ++i) {
+    map.erase(i);
+  }
+  EXPECT_LE(map.approximate_size(), kEntries / 2 + kSlack);
+  EXPECT_GE(map.approximate_size() + kSlack, kEntries / 2);
+
+  auto moved = std::move(map);
+  EXPECT_EQ(0, map.approximate_size());
+  moved.clear();
+  EXPECT_LE(moved.approximate_size(), kSlack);
+}
+
 REGISTER_TYPED_TEST_SUITE_P(
     ConcurrentHashMapTest,
+    ApproximateSize,
+    ForEachShardParallel,
     MapTest,
     MaxSizeTest,
     MoveTest,
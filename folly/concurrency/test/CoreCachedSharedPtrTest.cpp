@@ -82,6 +82,31 @@ TEST(CoreCachedSharedPtr, Basic) {
   ASSERT_TRUE(wp2.expired());
 }
 
+TEST(CoreCachedSharedPtr, BoundedSlots) {
+  auto p = std::make_shared<int>(1);
+  folly::CoreCachedSharedPtr<int, 2> cached(p);
+  folly::CoreCachedWeakPtr<int, 2> wcached(cached);
+  parallelRun([&](size_t) {
+    EXPECT_TRUE(cached.get().get() == p.get());
+    EXPECT_EQ(*wcached.lock(), 1);
+  });
+}
+
+TEST(CoreCachedSharedPtr, DynamicSlots) {
+  folly::CoreCachedSharedPtr<int> empty;
+  folly::CoreCachedWeakPtr<int> wempty(empty);
+  EXPECT_EQ(empty.get(), nullptr);
+  EXPECT_TRUE(wempty.get().expired());
+  EXPECT_EQ(wempty.lock(), nullptr);
+
+  auto p = std::make_shared<int>(1);
+  folly::CoreCachedSharedPtr<int> cached(p);
+  auto copy = cached;
+  cached.reset();
+  EXPECT_EQ(cached.get(), nullptr);
+  parallelRun([&](size_t) { EXPECT_TRUE(copy.get().get() == p.get()); });
+}
+
 TEST(CoreCachedSharedPtr, AtomicCoreCachedSharedPtr) {
   constexpr size_t kIters = 2000;
   {
@@ -123,6 +148,72 @@ TEST(CoreCachedSharedPtr, AtomicCoreCachedSharedPtr) {
   }
 }
 
+TEST(CoreCachedSharedPtr, LazyCoreCachedSharedPtr) {
+  constexpr size_t kIters = 2000;
+  {
+    auto p = std::make_shared<int>(1);
+    std::weak_ptr<int> wp(p);
+    folly::LazyCoreCachedSharedPtr<int> cached(p);
+    parallelRun([&](size_t) { EXPECT_TRUE(cached.get().get() == p.get()); });
+
+    // The update is visible immediately, while the old object is only kept
+    // alive by the stale slots.
+    cached.reset(std::make_shared<int>(2));
+    EXPECT_EQ(*cached.get(), 2);
+    p.reset();
+    parallelRun([&](size_t) { EXPECT_EQ(*cached.get(), 2); });
+
+    cached.reset();
+    EXPECT_EQ(cached.get(), nullptr);
+  }
+  {
+    folly::LazyCoreCachedSharedPtr<size_t> p;
+    EXPECT_EQ(p.get(), nullptr);
+    parallelRun([&](size_t) {
+      for (size_t i = 0; i < kIters; ++i) {
+        p.reset(std::make_shared<size_t>(i));
+        EXPECT_TRUE(p.get());
+        EXPECT_GE(*p.get(), 0);
+      }
+    });
+  }
+  {
+    // One writer thread, all other readers, verify consistency.
+    std::atomic<size_t> largestValueObserved{0};
+    folly::LazyCoreCachedSharedPtr<size_t> p{std::make_shared<size_t>(0)};
+    parallelRun([&](size_t t) {
+      if (t == 0) {
+        for (size_t i = 0; i < kIters; ++i) {
+          p.reset(std::make_shared<size_t>(i + 1));
+        }
+      } else {
+        while (true) {
+          auto exp = largestValueObserved.load();
+          auto value = *p.get();
+          EXPECT_GE(value, exp);
+          while (value > exp &&
+                 !largestValueObserved.compare_exchange_weak(exp, value)) {
+          }
+          if (exp == kIters) {
+            break;
+          }
+        }
+      }
+    });
+  }
+}
+
+TEST(CoreCachedSharedPtr, LazyCoreCachedSharedPtrReleasesOnDestruction) {
+  auto p = std::make_shared<int>(1);
+  std::weak_ptr<int> wp(p);
+  {
+    folly::LazyCoreCachedSharedPtr<int> cached(std::move(p));
+    parallelRun([&](size_t) { EXPECT_EQ(*cached.get(), 1); });
+    cached.reset();
+  }
+  EXPECT_TRUE(wp.expired());
+}
+
 namespace {
 
 template <class Holder>
@@ -172,6 +263,10 @@ TEST(CoreCachedSharedPtr, AliasingCornerCasesAtomic) {
   testAliasingCornerCases<folly::AtomicCoreCachedSharedPtr<int>>();
 }
 
+TEST(CoreCachedSharedPtr, AliasingCornerCasesLazy) {
+  testAliasingCornerCases<folly::LazyCoreCachedSharedPtr<int>>();
+}
+
 namespace {
 
 template <class Operation>
@@ -228,6 +323,12 @@ size_t benchmarkAtomicSharedPtrAcquire(size_t numThreads) {
   return benchmarkParallelRun([&] { return p.load(); }, numThreads);
 }
 
+size_t benchmarkAtomicSharedPtrBorrow(size_t numThreads) {
+  folly::read_cached_atomic_shared_ptr<int> p(std::make_shared<int>(1));
+  return benchmarkParallelRun(
+      [&] { return *p.load_borrowed(); }, numThreads);
+}
+
 size_t benchmarkCoreCachedSharedPtrAcquire(size_t numThreads) {
   folly::CoreCachedSharedPtr<int> p(std::make_shared<int>(1));
   return benchmarkParallelRun([&] { return p.get(); }, numThreads);
@@ -244,6 +345,11 @@ size_t benchmarkAtomicCoreCachedSharedPtrAcquire(size_t numThreads) {
   return benchmarkParallelRun([&] { return p.get(); }, numThreads);
 }
 
+size_t benchmarkLazyCoreCachedSharedPtrAcquire(size_t numThreads) {
+  folly::LazyCoreCachedSharedPtr<int> p(std::make_shared<int>(1));
+  return benchmarkParallelRun([&] { return p.get(); }, numThreads);
+}
+
 size_t benchmarkReadMostlySharedPtrAcquire(size_t numThreads) {
   folly::ReadMostlyMainPtr<int> p{std::make_shared<int>(1)};
   return benchmarkParallelRun([&] { return p.getShared(); }, numThreads);
@@ -273,6 +379,9 @@ size_t benchmarkThreadCachedSynchronizedAcquire(size_t numThreads) {
   BENCHMARK_MULTI(AtomicSharedPtrAcquire_##THREADS##Threads) {           \
     return benchmarkAtomicSharedPtrAcquire(THREADS);                     \
   }                                                                      \
+  BENCHMARK_MULTI(AtomicSharedPtrBorrow_##THREADS##Threads) {            \
+    return benchmarkAtomicSharedPtrBorrow(THREADS);                      \
+  }                                                                      \
   BENCHMARK_MULTI(ThreadCachedSynchronizedAcquire_##THREADS##Threads) {  \
     return benchmarkThreadCachedSynchronizedAcquire(THREADS);            \
   }                                                                      \
@@ -285,6 +394,9 @@ size_t benchmarkThreadCachedSynchronizedAcquire(size_t numThreads) {
   BENCHMARK_MULTI(AtomicCoreCachedSharedPtrAcquire_##THREADS##Threads) { \
     return benchmarkAtomicCoreCachedSharedPtrAcquire(THREADS);           \
   }                                                                      \
+  BENCHMARK_MULTI(LazyCoreCachedSharedPtrAcquire_##THREADS##Threads) {   \
+    return benchmarkLazyCoreCachedSharedPtrAcquire(THREADS);             \
+  }                                                                      \
   BENCHMARK_MULTI(ReadMostlySharedPtrAcquire_##THREADS##Threads) {       \
     return benchmarkReadMostlySharedPtrAcquire(THREADS);                 \
   }                                                                      \
@@ -318,6 +430,10 @@ BENCHMARK_MULTI(AtomicCoreCachedSharedPtrSingleThreadReset) {
   folly::AtomicCoreCachedSharedPtr<int> p(std::make_shared<int>(1));
   return benchmarkParallelRun([&] { p.reset(std::make_shared<int>(1)); }, 1);
 }
+BENCHMARK_MULTI(LazyCoreCachedSharedPtrSingleThreadReset) {
+  folly::LazyCoreCachedSharedPtr<int> p(std::make_shared<int>(1));
+  return benchmarkParallelRun([&] { p.reset(std::make_shared<int>(1)); }, 1);
+}
 
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
@@ -24,7 +24,10 @@
 #include <glog/logging.h>
 
 #include <atomic>
+#include <iterator>
+#include <stdexcept>
 #include <thread>
+#include <vector>
 
 DEFINE_bool(bench, false, "run benchmark");
 DEFINE_int32(reps, 10, "number of reps");
@@ -182,6 +185,84 @@ TEST(DynamicBoundedQueue, capacity) {
   capacity_test<DMPMC, true>();
 }
 
+template <template <typename, bool, typename> class Q, bool MayBlock>
+void bulk_test() {
+  struct CustomWeightFn {
+    uint64_t operator()(int val) { return val; }
+  };
+
+  Q<int, MayBlock, CustomWeightFn> q(1000);
+  std::vector<int> in{100, 200, 300};
+  q.enqueue_bulk(in.begin(), in.end());
+  ASSERT_EQ(q.size(), 3);
+  ASSERT_EQ(q.weight(), 600);
+  // All or nothing.
+  std::vector<int> big{100, 200, 300, 400};
+  ASSERT_FALSE(q.try_enqueue_bulk(big.begin(), big.end()));
+  ASSERT_FALSE(q.try_enqueue_bulk_until(
+      big.begin(),
+      big.end(),
+      std::chrono::steady_clock::now() + std::chrono::microseconds(100)));
+  ASSERT_EQ(q.size(), 3);
+  ASSERT_TRUE(q.try_enqueue_bulk(big.begin(), big.begin() + 2));
+  ASSERT_EQ(q.weight(), 900);
+
+  std::vector<int> out;
+  ASSERT_EQ(q.try_dequeue_bulk(std::back_inserter(out), 4), 4);
+  ASSERT_EQ(out, (std::vector<int>{100, 200, 300, 100}));
+  ASSERT_EQ(q.weight(), 200);
+  ASSERT_EQ(q.try_dequeue_bulk(std::back_inserter(out), 4), 1);
+  ASSERT_EQ(out.back(), 200);
+  ASSERT_EQ(q.weight(), 0);
+  ASSERT_EQ(q.try_dequeue_bulk(std::back_inserter(out), 4), 0);
+  ASSERT_TRUE(q.empty());
+
+  // Credit from bulk dequeues makes room for bulk enqueues.
+  ASSERT_TRUE(q.try_enqueue_bulk(big.begin(), big.end()));
+  ASSERT_EQ(q.weight(), 1000);
+}
+
+TEST(DynamicBoundedQueue, bulkThrowKeepsCredit) {
+  struct CustomWeightFn {
+    uint64_t operator()(int val) { return val; }
+  };
+
+  DMPMC<int, false, CustomWeightFn> q(1000);
+  std::vector<int> in{100, 200, 300, 400};
+  ASSERT_TRUE(q.try_enqueue_bulk(in.begin(), in.end()));
+  ASSERT_EQ(q.weight(), 1000);
+  struct Throwing {
+    std::vector<int>& out;
+    Throwing& operator*() { return *this; }
+    Throwing& operator++() { return *this; }
+    Throwing& operator=(int v) {
+      if (out.size() == 2) {
+        throw std::runtime_error("full");
+      }
+      out.push_back(v);
+      return *this;
+    }
+  };
+  std::vector<int> out;
+  EXPECT_THROW(q.try_dequeue_bulk(Throwing{out}, 4), std::runtime_error);
+  ASSERT_EQ(out, (std::vector<int>{100, 200}));
+  ASSERT_TRUE(q.empty());
+  // The weight of the dropped elements is credited too.
+  ASSERT_EQ(q.weight(), 0);
+  ASSERT_TRUE(q.try_enqueue_bulk(in.begin(), in.end()));
+}
+
+TEST(DynamicBoundedQueue, bulk) {
+  bulk_test<DSPSC, false>();
+  bulk_test<DMPSC, false>();
+  bulk_test<DSPMC, false>();
+  bulk_test<DMPMC, false>();
+  bulk_test<DSPSC, true>();
+  bulk_test<DMPSC, true>();
+  bulk_test<DSPMC, true>();
+  bulk_test<DMPMC, true>();
+}
+
 template <typename ProdFunc, typename ConsFunc, typename EndFunc>
 inline uint64_t run_once(
     int nprod,
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/concurrency/RcuMap.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(RcuMap, basic) {
+  RcuMap<int, std::string> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.get(1).has_value());
+
+  map.insert_or_assign(1, "one");
+  map.insert_or_assign(2, "two");
+  EXPECT_EQ(2, map.size());
+  EXPECT_EQ("one", map.get(1).value());
+  EXPECT_TRUE(map.contains(2));
+
+  map.insert_or_assign(1, "uno");
+  EXPECT_EQ("uno", map.get(1).value());
+  map.erase(2);
+  EXPECT_FALSE(map.contains(2));
+  map.update([](auto& m) { m[3] = "three"; });
+  EXPECT_EQ(2, map.withSnapshot([](const auto& m) { return m.size(); }));
+  EXPECT_EQ(5, map.numRebuilds());
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(RcuMap, snapshotIsImmutable) {
+  RcuMap<int, int> map(F14FastMap<int, int>{{1, 10}});
+  std::thread writer;
+  std::atomic<bool> updated{false};
+  {
+    auto snapshot = map.snapshot();
+    EXPECT_EQ(10, snapshot->at(1));
+    // The writer has to wait for this snapshot to be released before
+    // reclaiming it, but readers see its update right away.
+    writer = std::thread([&] {
+      map.insert_or_assign(1, 11);
+      updated = true;
+    });
+    while (map.withSnapshot([](const auto& m) { return m.at(1); }) != 11) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(10, snapshot->at(1));
+    EXPECT_EQ(1, (*snapshot).size());
+    EXPECT_FALSE(updated.load());
+  }
+  writer.join();
+  EXPECT_TRUE(updated.load());
+  EXPECT_EQ(11, map.get(1).value());
+}
+
+TEST(RcuMap, throwingUpdate) {
+  RcuMap<int, int> map;
+  map.insert_or_assign(1, 1);
+  EXPECT_THROW(
+      map.update([](auto& m) {
+        m[2] = 2;
+        throw std::runtime_error("update");
+      }),
+      std::runtime_error);
+  EXPECT_FALSE(map.contains(2));
+  EXPECT_EQ(1, map.size());
+  map.insert_or_assign(2, 2);
+  EXPECT_EQ(2, map.size());
+}
+
+TEST(RcuMap, writesCoalesceWhileWaitingForGracePeriod) {
+  constexpr int kWriters = 10;
+  RcuMap<int, int> map;
+  std::vector<std::thread> writers;
+  std::atomic<int> started{0};
+  {
+    auto snapshot = map.snapshot();
+    // Publishes, then waits for the snapshot above to be released.
+    writers.emplace_back([&] { map.insert_or_assign(0, 0); });
+    while (!map.contains(0)) {
+      std::this_thread::yield();
+    }
+    for (int i = 1; i <= kWriters; ++i) {
+      writers.emplace_back([&, i] {
+        ++started;
+        map.insert_or_assign(i, i);
+      });
+    }
+    while (started.load() < kWriters) {
+      std::this_thread::yield();
+    }
+    /* sleep override */ std::this_thread::sleep_for(
+        std::chrono::milliseconds(20));
+    EXPECT_EQ(1, map.numRebuilds());
+    EXPECT_TRUE(snapshot->empty());
+  }
+  for (auto& w : writers) {
+    w.join();
+  }
+  EXPECT_EQ(kWriters + 1, map.size());
+  // All the queued writes share one rebuild, unless a late one missed it.
+  EXPECT_LE(map.numRebuilds(), 3);
+}
+
+TEST(RcuMap, concurrentWritersCombine) {
+  constexpr int kWriters = 8;
+  constexpr int kWritesPerThread = 200;
+  constexpr int kReaders = 4;
+  RcuMap<int, int> map;
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> readers;
+  for (int t = 0; t < kReaders; ++t) {
+    readers.emplace_back([&] {
+      size_t last = 0;
+      while (!done.load()) {
+        // Each writer only adds keys, so snapshots only grow.
+        auto size = map.size();
+        EXPECT_GE(size, last);
+        last = size;
+        auto snapshot = map.snapshot();
+        for (auto& [k, v] : *snapshot) {
+          EXPECT_EQ(k * 2, v);
+        }
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kWriters; ++t) {
+    writers.emplace_back([&, t] {
+      for (int i = 0; i < kWritesPerThread; ++i) {
+        int key = t * kWritesPerThread + i;
+        map.insert_or_assign(key, key * 2);
+        EXPECT_TRUE(map.contains(key));
+      }
+    });
+  }
+  for (auto& w : writers) {
+    w.join();
+  }
+  done = true;
+  for (auto& r : readers) {
+    r.join();
+  }
+
+  EXPECT_EQ(kWriters * kWritesPerThread, map.size());
+  for (int key = 0; key < kWriters * kWritesPerThread; ++key) {
+    EXPECT_EQ(key * 2, map.get(key).value());
+  }
+  EXPECT_LE(map.numRebuilds(), kWriters * kWritesPerThread);
+}
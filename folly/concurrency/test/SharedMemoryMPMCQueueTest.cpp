@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/concurrency/SharedMemoryMPMCQueue.h>
+
+#include <sys/wait.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/ScopeGuard.h>
+#include <folly/portability/GTest.h>
+#include <folly/portability/Unistd.h>
+
+using namespace folly;
+
+namespace {
+
+struct Message {
+  uint64_t seq;
+  uint32_t producer;
+  char tag[4];
+};
+
+std::string uniqueName(const char* test) {
+  return to<std::string>("/folly_shm_mpmc_", test, "_", ::getpid());
+}
+
+} // namespace
+
+TEST(SharedMemoryMPMCQueue, createAndOpen) {
+  auto name = uniqueName("createAndOpen");
+  SharedMemoryMPMCQueue<Message>::unlink(name);
+  auto q = SharedMemoryMPMCQueue<Message>::create(name, 10);
+  SCOPE_EXIT {
+    SharedMemoryMPMCQueue<Message>::unlink(name);
+  };
+  EXPECT_EQ(10, q.capacity());
+  EXPECT_TRUE(q.isEmpty());
+
+  EXPECT_THROW(
+      SharedMemoryMPMCQueue<Message>::create(name, 10), std::system_error);
+  EXPECT_THROW(
+      SharedMemoryMPMCQueue<uint32_t>::open(name), std::invalid_argument);
+  EXPECT_THROW(
+      SharedMemoryMPMCQueue<Message>::open(name + "_missing"),
+      std::system_error);
+  EXPECT_THROW(
+      SharedMemoryMPMCQueue<Message>::create(name + "_empty", 0),
+      std::invalid_argument);
+
+  // Both mappings see the same queue, at different addresses.
+  auto other = SharedMemoryMPMCQueue<Message>::open(name);
+  EXPECT_EQ(10, other.capacity());
+  EXPECT_TRUE(q.write(Message{1, 2, "abc"}));
+  EXPECT_EQ(1, other.size());
+  Message m;
+  EXPECT_TRUE(other.read(m));
+  EXPECT_EQ(1, m.seq);
+  EXPECT_EQ(2, m.producer);
+  EXPECT_STREQ("abc", m.tag);
+  EXPECT_FALSE(q.read(m));
+
+  EXPECT_TRUE(SharedMemoryMPMCQueue<Message>::unlink(name));
+  EXPECT_FALSE(SharedMemoryMPMCQueue<Message>::unlink(name));
+  // Existing mappings outlive the name.
+  EXPECT_TRUE(other.writeIfNotFull(Message{3, 4, "xyz"}));
+  EXPECT_TRUE(q.readIfNotEmpty(m));
+  EXPECT_EQ(3, m.seq);
+}
+
+TEST(SharedMemoryMPMCQueue, fullAndEmpty) {
+  auto name = uniqueName("fullAndEmpty");
+  SharedMemoryMPMCQueue<uint64_t>::unlink(name);
+  auto q = SharedMemoryMPMCQueue<uint64_t>::create(name, 3);
+  SCOPE_EXIT {
+    SharedMemoryMPMCQueue<uint64_t>::unlink(name);
+  };
+  for (uint64_t i = 0; i < 3; ++i) {
+    EXPECT_TRUE(q.write(i));
+  }
+  EXPECT_TRUE(q.isFull());
+  EXPECT_FALSE(q.write(3));
+  EXPECT_FALSE(q.writeIfNotFull(3));
+  EXPECT_FALSE(q.tryWriteFor(std::chrono::milliseconds(1), 3));
+  uint64_t v;
+  for (uint64_t i = 0; i < 3; ++i) {
+    q.blockingRead(v);
+    EXPECT_EQ(i, v);
+  }
+  EXPECT_FALSE(q.tryReadFor(std::chrono::milliseconds(1), v));
+  EXPECT_TRUE(q.tryWriteFor(std::chrono::milliseconds(1), 7));
+  EXPECT_TRUE(q.tryReadFor(std::chrono::milliseconds(1), v));
+  EXPECT_EQ(7, v);
+}
+
+TEST(SharedMemoryMPMCQueue, threads) {
+  constexpr int kThreads = 4;
+  constexpr uint64_t kPerThread = 10000;
+  auto name = uniqueName("threads");
+  SharedMemoryMPMCQueue<uint64_t>::unlink(name);
+  auto q = SharedMemoryMPMCQueue<uint64_t>::create(name, 8);
+  SharedMemoryMPMCQueue<uint64_t>::unlink(name);
+
+  std::atomic<uint64_t> sum{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&] {
+      for (uint64_t i = 1; i <= kPerThread; ++i) {
+        q.blockingWrite(i);
+      }
+    });
+    threads.emplace_back([&] {
+      uint64_t v;
+      for (uint64_t i = 0; i < kPerThread; ++i) {
+        q.blockingRead(v);
+        sum += v;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(kThreads * kPerThread * (kPerThread + 1) / 2, sum.load());
+  EXPECT_TRUE(q.isEmpty());
+}
+
+TEST(SharedMemoryMPMCQueue, processes) {
+  // Small queues in both directions, so that each process keeps blocking
+  // on the other one.
+  constexpr uint64_t kCount = 20000;
+  auto requests = uniqueName("processes_requests");
+  auto replies = uniqueName("processes_replies");
+  SharedMemoryMPMCQueue<uint64_t>::unlink(requests);
+  SharedMemoryMPMCQueue<uint64_t>::unlink(replies);
+  auto out = SharedMemoryMPMCQueue<uint64_t>::create(requests, 4);
+  auto in = SharedMemoryMPMCQueue<uint64_t>::create(replies, 2);
+  SCOPE_EXIT {
+    SharedMemoryMPMCQueue<uint64_t>::unlink(requests);
+    SharedMemoryMPMCQueue<uint64_t>::unlink(replies);
+  };
+
+  pid_t pid = ::fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    int status = 1;
+    try {
+      auto childIn = SharedMemoryMPMCQueue<uint64_t>::open(requests);
+      auto childOut = SharedMemoryMPMCQueue<uint64_t>::open(replies);
+      uint64_t v;
+      uint64_t expected = 0;
+      status = 0;
+      for (uint64_t i = 0; i < kCount; ++i) {
+        childIn.blockingRead(v);
+        status |= v != expected++;
+        childOut.blockingWrite(2 * v);
+      }
+    } catch (...) {
+    }
+    ::_exit(status);
+  }
+
+  std::thread writer([&] {
+    for (uint64_t i = 0; i < kCount; ++i) {
+      out.blockingWrite(i);
+    }
+  });
+  uint64_t v;
+  for (uint64_t i = 0; i < kCount; ++i) {
+    in.blockingRead(v);
+    EXPECT_EQ(2 * i, v);
+  }
+  writer.join();
+
+  int status = 0;
+  ASSERT_EQ(pid, ::waitpid(pid, &status, 0));
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+}
@@ -26,7 +26,10 @@
 #include <glog/logging.h>
 
 #include <atomic>
+#include <memory>
+#include <stdexcept>
 #include <thread>
+#include <vector>
 
 DEFINE_bool(bench, false, "run benchmark");
 DEFINE_int32(reps, 10, "number of reps");
@@ -395,6 +398,145 @@ TEST(UnboundedQueue, enqDeq) {
   enq_deq_test<false, false, true>(10, 10);
 }
 
+template <template <typename, bool> class Q, bool MayBlock>
+void bulk_test() {
+  Q<int, MayBlock> q;
+  std::vector<int> out(1000, -1);
+  ASSERT_EQ(q.try_dequeue_bulk(out.begin(), out.size()), 0);
+
+  // Spans several segments.
+  std::vector<int> in(1000);
+  for (int i = 0; i < 1000; ++i) {
+    in[i] = i;
+  }
+  q.enqueue_bulk(in.begin(), in.begin() + 600);
+  q.enqueue(600);
+  q.enqueue_bulk(in.begin() + 601, in.end());
+  q.enqueue_bulk(in.end(), in.end());
+  ASSERT_EQ(q.size(), 1000);
+
+  int v = -1;
+  ASSERT_TRUE(q.try_dequeue(v));
+  ASSERT_EQ(v, 0);
+  ASSERT_EQ(q.try_dequeue_bulk(out.begin() + 1, 0), 0);
+  ASSERT_EQ(q.try_dequeue_bulk(out.begin() + 1, 300), 300);
+  ASSERT_EQ(q.try_dequeue_bulk(out.begin() + 301, 1000), 699);
+  ASSERT_TRUE(q.empty());
+  for (int i = 1; i < 1000; ++i) {
+    ASSERT_EQ(out[i], i);
+  }
+  ASSERT_EQ(q.try_dequeue_bulk(out.begin(), out.size()), 0);
+}
+
+TEST(UnboundedQueue, bulk) {
+  bulk_test<USPSC, false>();
+  bulk_test<UMPSC, false>();
+  bulk_test<USPMC, false>();
+  bulk_test<UMPMC, false>();
+  bulk_test<USPSC, true>();
+  bulk_test<UMPSC, true>();
+  bulk_test<USPMC, true>();
+  bulk_test<UMPMC, true>();
+}
+
+template <typename T>
+struct ThrowingOutputIterator {
+  std::vector<T>* out;
+  size_t limit;
+
+  ThrowingOutputIterator& operator*() { return *this; }
+  ThrowingOutputIterator& operator++() { return *this; }
+  ThrowingOutputIterator& operator=(T&& elem) {
+    if (out->size() == limit) {
+      throw std::runtime_error("full");
+    }
+    out->push_back(std::move(elem));
+    return *this;
+  }
+};
+
+template <template <typename, bool> class Q, bool MayBlock>
+void bulk_throw_test() {
+  using T = std::shared_ptr<int>;
+  Q<T, MayBlock> q;
+  auto item = std::make_shared<int>(7);
+  for (int i = 0; i < 300; ++i) {
+    q.enqueue(item);
+  }
+  std::vector<T> out;
+  EXPECT_THROW(
+      q.try_dequeue_bulk(ThrowingOutputIterator<T>{&out, 100}, 200),
+      std::runtime_error);
+  ASSERT_EQ(out.size(), 100);
+  // The other 100 claimed elements were destroyed, not left behind.
+  out.clear();
+  ASSERT_EQ(item.use_count(), 101);
+  ASSERT_EQ(q.size(), 100);
+  ASSERT_EQ(
+      q.try_dequeue_bulk(ThrowingOutputIterator<T>{&out, 200}, 200), 100);
+  ASSERT_TRUE(q.empty());
+  out.clear();
+  ASSERT_EQ(item.use_count(), 1);
+}
+
+TEST(UnboundedQueue, bulkThrow) {
+  bulk_throw_test<USPSC, false>();
+  bulk_throw_test<UMPSC, false>();
+  bulk_throw_test<USPMC, false>();
+  bulk_throw_test<UMPMC, false>();
+  bulk_throw_test<USPSC, true>();
+  bulk_throw_test<UMPMC, true>();
+}
+
+template <bool SingleProducer, bool SingleConsumer, bool MayBlock>
+void bulk_enq_deq_test(const int nprod, const int ncons) {
+  using Q = folly::
+      UnboundedQueue<uint64_t, SingleProducer, SingleConsumer, MayBlock, 4>;
+  Q q;
+  constexpr uint64_t kBatch = 37;
+  uint64_t ops = 1000 * kBatch;
+  std::atomic<uint64_t> consumed{0};
+  std::atomic<uint64_t> sum{0};
+
+  auto prod = [&](int tid) {
+    std::vector<uint64_t> batch(kBatch);
+    for (uint64_t i = tid * kBatch; i < ops; i += nprod * kBatch) {
+      for (uint64_t j = 0; j < kBatch; ++j) {
+        batch[j] = i + j;
+      }
+      q.enqueue_bulk(batch.begin(), batch.end());
+    }
+  };
+  auto cons = [&](int /* tid */) {
+    std::vector<uint64_t> batch(kBatch);
+    uint64_t mysum = 0;
+    while (consumed.load() < ops) {
+      auto n = q.try_dequeue_bulk(batch.begin(), batch.size());
+      for (size_t j = 0; j < n; ++j) {
+        mysum += batch[j];
+      }
+      consumed += n;
+    }
+    sum += mysum;
+  };
+  auto endfn = [&] {
+    ASSERT_EQ(sum.load(), ops * (ops - 1) / 2);
+    ASSERT_TRUE(q.empty());
+  };
+  run_once(nprod, ncons, prod, cons, endfn);
+}
+
+TEST(UnboundedQueue, bulkEnqDeq) {
+  bulk_enq_deq_test<true, true, false>(1, 1);
+  bulk_enq_deq_test<true, true, true>(1, 1);
+  bulk_enq_deq_test<false, true, false>(4, 1);
+  bulk_enq_deq_test<false, true, true>(4, 1);
+  bulk_enq_deq_test<true, false, false>(1, 4);
+  bulk_enq_deq_test<true, false, true>(1, 4);
+  bulk_enq_deq_test<false, false, false>(4, 4);
+  bulk_enq_deq_test<false, false, true>(4, 4);
+}
+
 template <typename RepFunc>
 uint64_t runBench(const std::string& name, int ops, const RepFunc& repFn) {
   uint64_t reps = FLAGS_reps;
@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <folly/SharedMutex.h>
+#include <folly/SpinLock.h>
+#include <folly/concurrency/CacheLocality.h>
+#include <folly/container/EvictingCacheMap.h>
+#include <folly/hash/Hash.h>
+#include <folly/lang/Align.h>
+
+namespace folly {
+
+/**
+ * A thread-safe, sharded variant of EvictingCacheMap.
+ *
+ * The key space is split into 1 << ShardBits shards by hash. Each shard owns
+ * an EvictingCacheMap with its own LRU list and a 1 / NumShards share of the
+ * total capacity, guarded by its own SharedMutex. Eviction order is therefore
+ * LRU within a shard and only approximately LRU across the whole map.
+ *
+ * Lookups take the shard lock in shared mode. Rather than promoting the found
+ * entry right away (which would need the exclusive lock), the key is appended
+ * to a cpu-local promotion buffer of the shard. Once a buffer holds
+ * `promotionBatchSize` keys, the thread filling it takes the exclusive lock
+ * once and applies all buffered promotions. Buffered promotions are also
+ * applied before any insertion that may evict, so recently read entries are
+ * not pruned ahead of colder ones. As a result, mostly-read workloads scale
+ * with the number of readers instead of serializing on a single mutex.
+ *
+ * A `promotionBatchSize` of 0 or 1 disables buffering: every hit takes the
+ * exclusive lock and promotes immediately, as EvictingCacheMap does.
+ *
+ * Values are returned by copy, since references into a shard cannot outlive
+ * the shard lock. Large values are best stored behind a std::shared_ptr.
+ *
+ * If a prune hook is set, it is invoked while the evicting shard is locked
+ * exclusively, so it must not call back into the map.
+ *
+ * NOTE: maxSize==0 disables automatic evictions, as for EvictingCacheMap.
+ */
+template <
+    class TKey,
+    class TValue,
+    class THash = HeterogeneousAccessHash<TKey>,
+    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>,
+    uint8_t ShardBits = 4>
+class ConcurrentEvictingCacheMap {
+  using ShardMap = EvictingCacheMap<TKey, TValue, THash, TKeyEqual>;
+
+ public:
+  using key_type = TKey;
+  using mapped_type = TValue;
+  using hasher = THash;
+  using PruneHookCall = typename ShardMap::PruneHookCall;
+
+  static constexpr std::size_t NumShards = std::size_t(1) << ShardBits;
+  static constexpr std::size_t kDefaultPromotionBatchSize = 32;
+
+  /**
+   * Construct a ConcurrentEvictingCacheMap
+   * @param maxSize maximum size of the cache map, split evenly (rounding up)
+   *     between the shards.
+   * @param clearSize the number of elements to clear at a time from a shard
+   *     when automatic eviction on insert is triggered.
+   * @param promotionBatchSize the number of buffered promotions per cpu-local
+   *     buffer that triggers applying them under the exclusive shard lock.
+   */
+  explicit ConcurrentEvictingCacheMap(
+      std::size_t maxSize,
+      std::size_t clearSize = 1,
+      std::size_t promotionBatchSize = kDefaultPromotionBatchSize,
+      const THash& keyHash = THash(),
+      const TKeyEqual& keyEqual = TKeyEqual())
+      : keyHash_(keyHash),
+        maxSize_(maxSize),
+        promotionBatchSize_(promotionBatchSize),
+        numStripes_(std::min(
+            CacheLocality::system().numCpus, kMaxPromotionStripes)) {
+    shards_.reserve(NumShards);
+    for (std::size_t i = 0; i < NumShards; ++i) {
+      shards_.push_back(std::make_unique<Shard>(
+          shardMaxSize(maxSize), clearSize, keyHash, keyEqual, numStripes_));
+    }
+  }
+
+  ConcurrentEvictingCacheMap(const ConcurrentEvictingCacheMap&) = delete;
+  ConcurrentEvictingCacheMap& operator=(const ConcurrentEvictingCacheMap&) =
+      delete;
+
+  /**
+   * Adjust the max size, evicting from each shard as needed to ensure the
+   * new max is not exceeded. 0 removes the limit.
+   */
+  void setMaxSize(std::size_t maxSize) {
+    for (auto& shard : shards_) {
+      std::unique_lock g(shard->mutex);
+      applyAllPromotions(*shard);
+      shard->map.setMaxSize(shardMaxSize(maxSize));
+    }
+    maxSize_.store(maxSize, std::memory_order_relaxed);
+  }
+
+  std::size_t getMaxSize() const {
+    return maxSize_.load(std::memory_order_relaxed);
+  }
+
+  void setClearSize(std::size_t clearSize) {
+    for (auto& shard : shards_) {
+      std::unique_lock g(shard->mutex);
+      shard->map.setClearSize(clearSize);
+    }
+  }
+
+  /**
+   * Set the prune hook of every shard. The hook runs under the exclusive
+   * lock of the shard being pruned.
+   */
+  void setPruneHook(PruneHookCall pruneHook) {
+    for (auto& shard : shards_) {
+      std::unique_lock g(shard->mutex);
+      shard->map.setPruneHook(pruneHook);
+    }
+  }
+
+  /**
+   * Check for existence of a specific key. This has no effect on LRU order.
+   */
+  bool exists(const TKey& key) const {
+    auto& shard = shardFor(key);
+    std::shared_lock g(shard.mutex);
+    return shard.map.exists(key);
+  }
+
+  /**
+   * Get a copy of the value associated with key, or none if it does not
+   * exist. A found entry is (eventually) promoted to the head of its shard's
+   * LRU.
+   */
+  Optional<TValue> get(const TKey& key) {
+    auto& shard = shardFor(key);
+    if (promotionBatchSize_ <= 1) {
+      std::unique_lock g(shard.mutex);
+      auto it = shard.map.find(key);
+      if (it == shard.map.end()) {
+        return none;
+      }
+      return it->second;
+    }
+
+    Optional<TValue> result;
+    {
+      std::shared_lock g(shard.mutex);
+      auto it = shard.map.findWithoutPromotion(key);
+      if (it == shard.map.end()) {
+        return none;
+      }
+      result = it->second;
+    }
+    recordPromotion(shard, key);
+    return result;
+  }
+
+  /**
+   * Get a copy of the value associated with key, or none if it does not
+   * exist. This never promotes the entry.
+   */
+  Optional<TValue> getWithoutPromotion(const TKey& key) const {
+    auto& shard = shardFor(key);
+    std::shared_lock g(shard.mutex);
+    auto it = shard.map.findWithoutPromotion(key);
+    if (it == shard.map.end()) {
+      return none;
+    }
+    return it->second;
+  }
+
+  /**
+   * Set a key-value pair, replacing the value of an existing entry.
+   * @param promote whether to move an existing entry to the front of the LRU
+   */
+  void set(const TKey& key, TValue value, bool promote = true) {
+    auto& shard = shardFor(key);
+    std::unique_lock g(shard.mutex);
+    prepareForInsert(shard);
+    shard.map.set(key, std::move(value), promote);
+  }
+
+  /**
+   * Insert a new key-value pair if no element exists for key.
+   * @return true if the insertion took place
+   */
+  bool insert(const TKey& key, TValue value) {
+    auto& shard = shardFor(key);
+    std::unique_lock g(shard.mutex);
+    prepareForInsert(shard);
+    return shard.map.insert(key, std::move(value)).second;
+  }
+
+  /**
+   * Erase the entry associated with key if it exists. The prune hook is not
+   * called.
+   * @return true if the key existed and was erased
+   */
+  bool erase(const TKey& key) {
+    auto& shard = shardFor(key);
+    std::unique_lock g(shard.mutex);
+    return shard.map.erase(key);
+  }
+
+  /**
+   * Get the number of elements. Shards are visited one at a time, so under
+   * concurrent modification the result is only a snapshot-free estimate.
+   */
+  std::size_t size() const {
+    std::size_t result = 0;
+    for (auto& shard : shards_) {
+      std::shared_lock g(shard->mutex);
+      result += shard->map.size();
+    }
+    return result;
+  }
+
+  bool empty() const {
+    for (auto& shard : shards_) {
+      std::shared_lock g(shard->mutex);
+      if (!shard->map.empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Remove all entries (as if all evicted)
+   */
+  void clear() {
+    for (auto& shard : shards_) {
+      std::unique_lock g(shard->mutex);
+      dropAllPromotions(*shard);
+      shard->map.clear();
+    }
+  }
+
+  /**
+   * Apply all buffered promotions in every shard.
+   */
+  void flushPromotions() {
+    for (auto& shard : shards_) {
+      std::unique_lock g(shard->mutex);
+      applyAllPromotions(*shard);
+    }
+  }
+
+ private:
+  static constexpr std::size_t kMaxPromotionStripes = 16;
+
+  struct alignas(hardware_destructive_interference_size) PromotionStripe {
+    SpinLock mutex;
+    std::vector<TKey> keys;
+  };
+
+  struct alignas(hardware_destructive_interference_size) Shard {
+    Shard(
+        std::size_t maxSize,
+        std::size_t clearSize,
+        const THash& keyHash,
+        const TKeyEqual& keyEqual,
+        std::size_t numStripes)
+        : map(maxSize, clearSize, keyHash, keyEqual), stripes(numStripes) {}
+
+    mutable SharedMutex mutex;
+    ShardMap map;
+    std::vector<PromotionStripe> stripes;
+  };
+
+  static std::size_t shardMaxSize(std::size_t maxSize) {
+    return (maxSize + NumShards - 1) / NumShards;
+  }
+
+  Shard& shardFor(const TKey& key) const {
+    // Remix the hash so that shard selection does not correlate with the bits
+    // used for chunk selection by the F14 index inside each shard.
+    auto h = hash::twang_mix64(keyHash_(key));
+    return *shards_[h & (NumShards - 1)];
+  }
+
+  void recordPromotion(Shard& shard, const TKey& key) {
+    std::vector<TKey> batch;
+    {
+      auto* stripe =
+          &shard.stripes[AccessSpreader<>::cachedCurrent(numStripes_)];
+      auto g = std::unique_lock(stripe->mutex, std::try_to_lock);
+      if (FOLLY_UNLIKELY(!g.owns_lock())) {
+        // Either a drain is in progress or this thread has a stale stripe, see
+        // DigestBuilder::append.
+        AccessSpreader<>::invalidateCachedCurrent();
+        stripe = &shard.stripes[AccessSpreader<>::cachedCurrent(numStripes_)];
+        g = std::unique_lock(stripe->mutex);
+      }
+      stripe->keys.push_back(key);
+      if (FOLLY_LIKELY(stripe->keys.size() < promotionBatchSize_)) {
+        return;
+      }
+      batch.swap(stripe->keys);
+    }
+    std::unique_lock g(shard.mutex);
+    applyPromotions(shard, batch);
+  }
+
+  // Requires the exclusive shard lock.
+  static void applyPromotions(Shard& shard, const std::vector<TKey>& keys) {
+    for (auto& key : keys) {
+      // find() promotes the entry if it is still present
+      shard.map.find(key);
+    }
+  }
+
+  // Requires the exclusive shard lock.
+  static void applyAllPromotions(Shard& shard) {
+    for (auto& stripe : shard.stripes) {
+      std::vector<TKey> batch;
+      {
+        std::unique_lock g(stripe.mutex);
+        batch.swap(stripe.keys);
+      }
+      applyPromotions(shard, batch);
+    }
+  }
+
+  // Requires the exclusive shard lock.
+  static void dropAllPromotions(Shard& shard) {
+    for (auto& stripe : shard.stripes) {
+      std::unique_lock g(stripe.mutex);
+      stripe.keys.clear();
+    }
+  }
+
+  // Requires the exclusive shard lock.
+  static void prepareForInsert(Shard& shard) {
+    auto maxSize = shard.map.getMaxSize();
+    if (maxSize > 0 && shard.map.size() >= maxSize) {
+      // The insertion may evict, so make the LRU order reflect recent reads
+      // before picking victims.
+      applyAllPromotions(shard);
+    }
+  }
+
+  THash keyHash_;
+  std::atomic<std::size_t> maxSize_;
+  const std::size_t promotionBatchSize_;
+  const std::size_t numStripes_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace folly
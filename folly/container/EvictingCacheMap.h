@@ -17,18 +17,283 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <deque>
 #include <exception>
 #include <functional>
+#include <iterator>
+#include <utility>
 
 #include <boost/intrusive/list.hpp>
 #include <boost/iterator/iterator_adaptor.hpp>
 
+#include <folly/CppAttributes.h>
 #include <folly/container/F14Set.h>
 #include <folly/container/HeterogeneousAccess.h>
 #include <folly/lang/Exception.h>
 
 namespace folly {
 
+/**
+ * Eviction policies for EvictingCacheMap (and the weighted variants built on
+ * top of it). All entries of a map live on a single intrusive list; a policy
+ * decides where new entries are linked, what a hit does, and which entry is
+ * evicted next. A policy is a type providing:
+ *
+ *  - `NodeState`: per-entry state, stored in each entry.
+ *  - `template <typename Node> class Queue`: per-map state, default
+ *    constructible and movable (leaving the source empty), with
+ *      - `insert(list, node, hasher)`: link a new entry into the list.
+ *      - `touch(list, node)`: record a hit on the entry.
+ *      - `evict(list, protect, hasher)`: pick the next victim, which must not
+ *        be `protect` (possibly nullptr). The list has at least two entries
+ *        if `protect` is set, and at least one otherwise. The victim is
+ *        unlinked by the caller.
+ *      - `erase(list, node)`: account for an entry about to be unlinked by
+ *        an explicit erase.
+ *    where `hasher(&node)` returns the hash of the entry's key.
+ */
+
+/**
+ * Strict LRU (the default): every hit moves the entry to the front of the
+ * list and eviction takes the back.
+ */
+struct LruEvictionPolicy {
+  struct NodeState {};
+
+  template <typename Node>
+  class Queue {
+   public:
+    template <typename List, typename Hasher>
+    void insert(List& list, Node& node, const Hasher&) {
+      list.push_front(node);
+    }
+
+    template <typename List>
+    void touch(List& list, Node& node) {
+      list.splice(list.begin(), list, list.iterator_to(node));
+    }
+
+    template <typename List, typename Hasher>
+    Node& evict(List& list, const Node* protect, const Hasher&) {
+      Node* node = &*list.rbegin();
+      if (node == protect) {
+        touch(list, *node);
+        node = &*list.rbegin();
+      }
+      return *node;
+    }
+
+    template <typename List>
+    void erase(List&, Node&) {}
+  };
+};
+
+/**
+ * CLOCK (second chance): a hit only sets a reference bit on the entry, so
+ * hits do no pointer surgery on the list. Eviction scans from the back of
+ * the list; referenced entries have their bit cleared and go back to the
+ * front, and the first unreferenced entry is evicted.
+ */
+struct ClockEvictionPolicy {
+  struct NodeState {
+    bool referenced = false;
+  };
+
+  template <typename Node>
+  class Queue {
+   public:
+    template <typename List, typename Hasher>
+    void insert(List& list, Node& node, const Hasher&) {
+      list.push_front(node);
+    }
+
+    template <typename List>
+    void touch(List&, Node& node) {
+      // Avoid dirtying the cache line on repeated hits
+      if (!node.policyState.referenced) {
+        node.policyState.referenced = true;
+      }
+    }
+
+    template <typename List, typename Hasher>
+    Node& evict(List& list, const Node* protect, const Hasher&) {
+      while (true) {
+        Node& node = *list.rbegin();
+        if (!node.policyState.referenced && &node != protect) {
+          return node;
+        }
+        node.policyState.referenced = false;
+        list.splice(list.begin(), list, list.iterator_to(node));
+      }
+    }
+
+    template <typename List>
+    void erase(List&, Node&) {}
+  };
+};
+
+/**
+ * S3-FIFO (Yang et al., SOSP '23): entries are admitted into a small FIFO
+ * queue holding about 10% of the entries, and only entries hit while in the
+ * small queue move on to the main FIFO queue. Entries evicted from the small
+ * queue leave their key hash in a bounded ghost queue, and a new entry whose
+ * key is found there is admitted directly into the main queue. Entries in
+ * the main queue are reinserted at its head while they have been hit since
+ * they were last considered for eviction (up to 3 times). A hit only bumps a
+ * small counter, and one-hit wonders from scans are evicted from the small
+ * queue without disturbing the main queue.
+ *
+ * Both queues share the map's list: the small queue is at the front, the main
+ * queue at the back, and the boundary is tracked with a pointer to the head
+ * of the main queue.
+ */
+struct S3FifoEvictionPolicy {
+  struct NodeState {
+    uint8_t freq = 0;
+    bool inMain = false;
+  };
+
+  template <typename Node>
+  class Queue {
+   public:
+    Queue() = default;
+
+    Queue(Queue&& that) noexcept
+        : smallSize_(std::exchange(that.smallSize_, 0)),
+          mainHead_(std::exchange(that.mainHead_, nullptr)),
+          ghost_(std::move(that.ghost_)),
+          ghostFifo_(std::move(that.ghostFifo_)) {
+      that.ghost_.clear();
+      that.ghostFifo_.clear();
+    }
+
+    Queue& operator=(Queue&& that) noexcept {
+      smallSize_ = std::exchange(that.smallSize_, 0);
+      mainHead_ = std::exchange(that.mainHead_, nullptr);
+      ghost_ = std::move(that.ghost_);
+      that.ghost_.clear();
+      ghostFifo_ = std::move(that.ghostFifo_);
+      that.ghostFifo_.clear();
+      return *this;
+    }
+
+    template <typename List, typename Hasher>
+    void insert(List& list, Node& node, const Hasher& hasher) {
+      node.policyState = NodeState();
+      if (!ghost_.empty() && ghost_.count(hasher(&node)) > 0) {
+        // Evicted from the small queue recently enough to be remembered
+        pushMain(list, node);
+      } else {
+        list.push_front(node);
+        ++smallSize_;
+      }
+    }
+
+    template <typename List>
+    void touch(List&, Node& node) {
+      if (node.policyState.freq < kMaxFreq) {
+        ++node.policyState.freq;
+      }
+    }
+
+    template <typename List, typename Hasher>
+    Node& evict(List& list, const Node* protect, const Hasher& hasher) {
+      while (true) {
+        std::size_t mainSize = list.size() - smallSize_;
+        bool fromSmall = smallSize_ > 0 &&
+            (smallSize_ * 10 >= list.size() || mainSize == 0 ||
+             (mainSize == 1 && mainHead_ == protect));
+        if (fromSmall) {
+          Node& tail = smallTail(list);
+          if (tail.policyState.freq > 0) {
+            // Hit while in the small queue: it is already adjacent to the
+            // main queue, so moving it just moves the boundary. It starts
+            // over in main and must be hit again to survive a main pass.
+            --smallSize_;
+            tail.policyState.freq = 0;
+            tail.policyState.inMain = true;
+            mainHead_ = &tail;
+            continue;
+          }
+          if (&tail != protect) {
+            --smallSize_;
+            addGhost(hasher(&tail), mainSize);
+            return tail;
+          }
+          if (mainSize == 0) {
+            // Skip over the protected entry
+            list.splice(list.begin(), list, list.iterator_to(tail));
+            continue;
+          }
+          // Otherwise evict from the main queue instead
+        }
+
+        Node& tail = *list.rbegin();
+        if (tail.policyState.freq == 0 && &tail != protect) {
+          erase(list, tail);
+          return tail;
+        }
+        if (tail.policyState.freq > 0) {
+          --tail.policyState.freq;
+        }
+        if (&tail != mainHead_) {
+          list.splice(
+              list.iterator_to(*mainHead_), list, list.iterator_to(tail));
+          mainHead_ = &tail;
+        }
+      }
+    }
+
+    template <typename List>
+    void erase(List& list, Node& node) {
+      if (!node.policyState.inMain) {
+        --smallSize_;
+      } else if (&node == mainHead_) {
+        auto next = std::next(list.iterator_to(node));
+        mainHead_ = next == list.end() ? nullptr : &*next;
+      }
+    }
+
+   private:
+    static constexpr uint8_t kMaxFreq = 3;
+
+    template <typename List>
+    Node& smallTail(List& list) {
+      return mainHead_ ? *std::prev(list.iterator_to(*mainHead_))
+                       : *list.rbegin();
+    }
+
+    template <typename List>
+    void pushMain(List& list, Node& node) {
+      node.policyState.inMain = true;
+      if (mainHead_) {
+        list.insert(list.iterator_to(*mainHead_), node);
+      } else {
+        list.push_back(node);
+      }
+      mainHead_ = &node;
+    }
+
+    void addGhost(std::size_t hash, std::size_t maxGhostSize) {
+      if (!ghost_.insert(hash).second) {
+        return;
+      }
+      ghostFifo_.push_back(hash);
+      maxGhostSize = std::max<std::size_t>(maxGhostSize, 1);
+      while (ghostFifo_.size() > maxGhostSize) {
+        ghost_.erase(ghostFifo_.front());
+        ghostFifo_.pop_front();
+      }
+    }
+
+    std::size_t smallSize_ = 0;
+    Node* mainHead_ = nullptr;
+    F14FastSet<std::size_t> ghost_;
+    std::deque<std::size_t> ghostFifo_;
+  };
+};
+
 /**
  * A general purpose LRU evicting cache designed to support constant time
  * set/get/insert/erase ops. The only required configuration parameter is the
@@ -55,6 +320,11 @@ namespace folly {
  * of list on a get, and adding to the front on insert. Assuming quality
  * hashing, set/get are both constant time operations.
  *
+ * The LRU order can be relaxed by choosing another TEvictionPolicy, such as
+ * ClockEvictionPolicy or S3FifoEvictionPolicy, which avoid list updates on
+ * hits. With those, "promotion" only records the hit for the policy, and
+ * iteration order is the policy's queue order rather than recency.
+ *
  * NOTE: Previous versions of this structure used a hash table size that was
  * fixed at creation time, but that limitation is no longer present.
  */
@@ -62,7 +332,8 @@ template <
     class TKey,
     class TValue,
     class THash = HeterogeneousAccessHash<TKey>,
-    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>>
+    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>,
+    class TEvictionPolicy = LruEvictionPolicy>
 class EvictingCacheMap {
  private:
   // typedefs for brevity
@@ -413,6 +684,25 @@ class EvictingCacheMap {
    */
   bool empty() const { return index_.empty(); }
 
+  /**
+   * Get the number of bytes allocated by the map: its index and a node per
+   * entry, including the shallow bits (sizeof) of TKey and TValue, but not
+   * the deep bits.
+   */
+  std::size_t getAllocatedMemorySize() const {
+    return index_.getAllocatedMemorySize() + size() * sizeof(Node);
+  }
+
+  /**
+   * Calls visitor(allocationSize, allocationCount) for each class of memory
+   * blocks allocated by the map, like F14's visitAllocationClasses().
+   */
+  template <typename V>
+  void visitAllocationClasses(V&& visitor) const {
+    index_.visitAllocationClasses(visitor);
+    visitor(sizeof(Node), size());
+  }
+
   /**
    * Remove all entries (as if all evicted)
    * @param pruneHook eviction callback to use INSTEAD OF the configured one
@@ -437,19 +727,21 @@ class EvictingCacheMap {
    * @param pruneHook eviction callback to use INSTEAD OF the configured one
    */
   void prune(std::size_t pruneSize, PruneHookCall pruneHook = nullptr) {
-    auto& ph = (nullptr == pruneHook) ? pruneHook_ : pruneHook;
-
-    for (std::size_t i = 0; i < pruneSize && !lru_.empty(); i++) {
-      auto* node = &(*lru_.rbegin());
-      std::unique_ptr<Node> node_owner(node);
+    pruneImpl(pruneSize, nullptr, pruneHook);
+  }
 
-      lru_.erase(lru_.iterator_to(*node));
-      index_.erase(node);
-      if (ph) {
-        // NOTE: might throw, so we are in an exception-safe state
-        ph(node->pr.first, std::move(node->pr.second));
-      }
-    }
+  /**
+   * Like prune(), but never evicts the entry at `protect`, even if that means
+   * pruning fewer than pruneSize elements.
+   * @param pruneSize minimum number of elements to prune
+   * @param protect iterator to an entry of this map to keep
+   * @param pruneHook eviction callback to use INSTEAD OF the configured one
+   */
+  void pruneExcept(
+      std::size_t pruneSize,
+      const_iterator protect,
+      PruneHookCall pruneHook = nullptr) {
+    pruneImpl(pruneSize, &(*protect.base()), pruneHook);
   }
 
   // Iterators and such
@@ -484,6 +776,8 @@ class EvictingCacheMap {
     template <typename K>
     Node(const K& key, TValue&& value) : pr(key, std::move(value)) {}
     TPair pr;
+    FOLLY_ATTR_NO_UNIQUE_ADDRESS typename TEvictionPolicy::NodeState
+        policyState;
   };
   using NodePtr = Node*;
 
@@ -573,7 +867,7 @@ class EvictingCacheMap {
     if (!ptr) {
       return self.end();
     }
-    self.lru_.splice(self.lru_.begin(), self.lru_, self.lru_.iterator_to(*ptr));
+    self.policy_.touch(self.lru_, *ptr);
     return self_iterator_t<Self>(self.lru_.iterator_to(*ptr));
   }
 
@@ -593,12 +887,31 @@ class EvictingCacheMap {
                : self.end();
   }
 
+  void pruneImpl(
+      std::size_t pruneSize, const Node* protect, PruneHookCall pruneHook) {
+    auto& ph = (nullptr == pruneHook) ? pruneHook_ : pruneHook;
+    const std::size_t minSize = protect ? 1 : 0;
+
+    for (std::size_t i = 0; i < pruneSize && lru_.size() > minSize; i++) {
+      auto* node = &policy_.evict(lru_, protect, keyHash_);
+      std::unique_ptr<Node> node_owner(node);
+
+      lru_.erase(lru_.iterator_to(*node));
+      index_.erase(node);
+      if (ph) {
+        // NOTE: might throw, so we are in an exception-safe state
+        ph(node->pr.first, std::move(node->pr.second));
+      }
+    }
+  }
+
   typename NodeList::iterator eraseImpl(
       Node* ptr,
       typename NodeList::const_iterator base_iter,
       PruneHookCall eraseHook) {
     std::unique_ptr<Node> node_owner(ptr);
     index_.erase(ptr);
+    policy_.erase(lru_, *ptr);
     auto next_base_iter = lru_.erase(base_iter);
     if (eraseHook) {
       // NOTE: might throw, so we are in an exception-safe state
@@ -624,16 +937,16 @@ class EvictingCacheMap {
     if (ptr) {
       ptr->pr.second = std::move(value);
       if (promote) {
-        lru_.splice(lru_.begin(), lru_, lru_.iterator_to(*ptr));
+        policy_.touch(lru_, *ptr);
       }
     } else {
       auto node = new Node(key, std::move(value));
       index_.insert(node);
-      lru_.push_front(*node);
+      policy_.insert(lru_, *node, keyHash_);
 
       // no evictions if maxSize_ is 0 i.e. unlimited capacity
       if (maxSize_ > 0 && size() > maxSize_) {
-        prune(clearSize_, pruneHook);
+        pruneImpl(clearSize_, node, pruneHook);
       }
     }
   }
@@ -654,11 +967,11 @@ class EvictingCacheMap {
     }
 
     // Complete insertion
-    lru_.push_front(*node_owner.release());
+    policy_.insert(lru_, *node_owner.release(), keyHash_);
 
     // no evictions if maxSize_ is 0 i.e. unlimited capacity
     if (maxSize_ > 0 && size() > maxSize_) {
-      prune(clearSize_, pruneHook);
+      pruneImpl(clearSize_, node, pruneHook);
     }
 
     return std::pair<iterator, bool>(lru_.iterator_to(*node), true);
@@ -679,6 +992,8 @@ class EvictingCacheMap {
   KeyValueEqual keyEqual_;
   NodeMap index_;
   NodeList lru_;
+  FOLLY_ATTR_NO_UNIQUE_ADDRESS
+  typename TEvictionPolicy::template Queue<Node> policy_;
   std::size_t maxSize_;
   std::size_t clearSize_;
 };
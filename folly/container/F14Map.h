@@ -395,6 +395,56 @@ class F14BasicMap {
     bulkInsert(std::move(first), std::move(last), autoReserve);
   }
 
+  /**
+   * Add elements, overlapping the cache misses of consecutive insertions.
+   * @methodset Modifiers
+   *
+   * Equivalent to insert(first, last), but the input is processed in small
+   * blocks: every key of a block is prehashed and its first probe location
+   * is prefetched before any of the block is inserted.  This pays off when
+   * the map is much larger than the CPU cache.  Dereferencing an iterator
+   * must yield something with a .first usable as a key and from which a
+   * value_type can be constructed (use std::make_move_iterator to move the
+   * elements in).  The range is traversed twice, so FwdIt must be a forward
+   * iterator.
+   *
+   * Returns the number of elements that were actually inserted.
+   */
+  template <typename FwdIt>
+  std::size_t insertBatch(FwdIt first, FwdIt last) {
+    constexpr std::size_t kBlock = decltype(table_)::kBatchBlockSize;
+    if constexpr (std::is_base_of<
+                      std::random_access_iterator_tag,
+                      typename std::iterator_traits<
+                          FwdIt>::iterator_category>::value) {
+      auto n = std::distance(first, last);
+      if (n == 0) {
+        return 0;
+      }
+      table_.reserveForInsert(n);
+    }
+    std::size_t inserted = 0;
+    F14HashToken tokens[kBlock];
+    while (first != last) {
+      FwdIt blockFirst = first;
+      std::size_t n = 0;
+      for (; n < kBlock && first != last; ++n, ++first) {
+        tokens[n] = table_.prehash((*first).first);
+        table_.prefetch(tokens[n]);
+      }
+      for (std::size_t i = 0; i < n; ++i, ++blockFirst) {
+        auto&& elem = *blockFirst;
+        inserted += table_
+                        .tryEmplaceValueWithToken(
+                            tokens[i],
+                            elem.first,
+                            std::forward<decltype(elem)>(elem))
+                        .second;
+      }
+    }
+    return inserted;
+  }
+
   /// Add elements from an initializer list
   void insert(std::initializer_list<value_type> ilist) {
     insert(ilist.begin(), ilist.end());
@@ -848,6 +898,44 @@ class F14BasicMap {
    */
   void prefetch(F14HashToken const& token) const { table_.prefetch(token); }
 
+  /**
+   * @overloadbrief Look up many keys at once.
+   * @methodset Lookup
+   *
+   * findBatch(first, last, out) writes find(key) to out for every key in
+   * [first, last), in order, and returns the advanced output iterator.
+   *
+   * Lookups on a cold map are dominated by cache misses.  findBatch
+   * processes the keys in small blocks, computing the hashes of a whole
+   * block and prefetching its probe locations before searching any of them,
+   * so the misses of a block are serviced in parallel.  This is the
+   * prehash()/prefetch() pipelining described above, done for you.  The
+   * keys may be of key_type or of any type supported by heterogeneous
+   * find().  The range is traversed twice, so FwdIt must be a forward
+   * iterator.
+   *
+   *   std::vector<iterator> hits;
+   *   map.findBatch(keys.begin(), keys.end(), std::back_inserter(hits));
+   */
+  template <typename FwdIt, typename OutIt>
+  OutIt findBatch(FwdIt first, FwdIt last, OutIt out) {
+    table_.findBatch(first, last, [&](auto iter) {
+      *out = table_.makeIter(iter);
+      ++out;
+    });
+    return out;
+  }
+
+  /// @copydoc findBatch
+  template <typename FwdIt, typename OutIt>
+  OutIt findBatch(FwdIt first, FwdIt last, OutIt out) const {
+    table_.findBatch(first, last, [&](auto iter) {
+      *out = table_.makeConstIter(iter);
+      ++out;
+    });
+    return out;
+  }
+
   /// @overloadbrief Get the iterator for a key.
   /// @methodset Lookup
   FOLLY_ALWAYS_INLINE iterator find(key_type const& key) {
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * F14MappedView is a read-only hash map from strings to trivially copyable
+ * values that is looked up in place in a memory-mapped file.
+ *
+ * writeF14MappedView() serializes a map (typically an F14FastMap<std::string,
+ * T>) into an F14-style chunk array followed by a packed key/value heap.
+ * F14MappedView then maps that file and answers find() with no parsing,
+ * allocation or rehashing, so "loading" costs only the page faults of the
+ * lookups actually made, and every process mapping the file shares the same
+ * physical pages.
+ *
+ * The chunk array uses the F14 probing scheme: 14 slots per chunk, a 7-bit
+ * tag per slot derived from the high bits of the hash, a per-chunk overflow
+ * count to terminate unsuccessful searches early, and a tag-dependent probe
+ * stride. A chunk is 128 bytes, two cache lines after the 64-byte header:
+ * 16 bytes of tags and counts, then 14 8-byte slot offsets. The first line
+ * thus holds the tags and the offsets of slots 0-5, and the second one the
+ * offsets of slots 6-13, so a typical hit touches one or two chunk lines and
+ * the entry itself.
+ *
+ * The file format is fixed-layout and uses SpookyHashV2 with a seed stored in
+ * the file, so it is independent of the build that wrote it. It is however
+ * stored in native byte order; a file written on a machine of the other
+ * endianness is rejected as having a bad magic number.
+ *
+ *   F14FastMap<std::string, uint64_t> m = ...;
+ *   File f("/path/to/index", O_WRONLY | O_CREAT | O_TRUNC);
+ *   writeF14MappedView(f.fd(), m);
+ *
+ *   F14MappedView<uint64_t> view("/path/to/index");
+ *   if (auto* v = view.find("key")) { use(*v); }
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <folly/Bits.h>
+#include <folly/Exception.h>
+#include <folly/FileUtil.h>
+#include <folly/Likely.h>
+#include <folly/Range.h>
+#include <folly/hash/SpookyHashV2.h>
+#include <folly/lang/Exception.h>
+#include <folly/system/MemoryMapping.h>
+
+namespace folly {
+
+namespace detail {
+
+struct F14MappedViewHeader {
+  static constexpr uint64_t kMagic = 0x5745495650414d46; // "FMAPVIEW"
+  static constexpr uint32_t kVersion = 1;
+
+  uint64_t magic;
+  uint32_t version;
+  uint32_t valueSize;
+  uint64_t seed;
+  uint64_t size;
+  uint64_t chunkCount;
+  uint64_t heapOffset;
+  uint64_t heapSize;
+  uint64_t reserved;
+};
+static_assert(sizeof(F14MappedViewHeader) == 64, "");
+
+struct F14MappedViewChunk {
+  static constexpr std::size_t kCapacity = 14;
+  // Same maximum average fill as F14 tables, leaves room to probe.
+  static constexpr std::size_t kDesiredCapacity = 12;
+
+  // 0 marks an empty slot, otherwise the high bit is always set
+  uint8_t tags[kCapacity];
+  uint8_t reserved;
+  // Number of keys whose probe sequence passed through this chunk because
+  // it was full, saturating.  Zero means that an unsuccessful search can
+  // stop here.
+  uint8_t outboundOverflowCount;
+  // Entry offsets relative to the start of the heap. Those of slots 0-5
+  // share the first cache line of the chunk with the tags.
+  uint64_t offsets[kCapacity];
+};
+static_assert(sizeof(F14MappedViewChunk) == 16 + 14 * 8, "");
+
+// Each heap entry is: uint32_t keySize, uint32_t padding, the value padded
+// to 8 bytes, then the key bytes padded to 8 bytes.
+constexpr std::size_t kF14MappedViewEntryHeaderSize = 8;
+
+constexpr std::size_t f14MappedViewPad(std::size_t n) {
+  return (n + 7) & ~std::size_t(7);
+}
+
+inline uint64_t f14MappedViewHash(StringPiece key, uint64_t seed) {
+  return hash::SpookyHashV2::Hash64(key.data(), key.size(), seed);
+}
+
+inline uint8_t f14MappedViewTag(uint64_t hash) {
+  return static_cast<uint8_t>((hash >> 56) | 0x80);
+}
+
+// Same stride as F14Table::probeDelta, odd so every chunk is visited.
+inline std::size_t f14MappedViewProbeDelta(uint8_t tag) {
+  return 2 * std::size_t(tag) + 1;
+}
+
+} // namespace detail
+
+/**
+ * Write the entries of map (a range of pairs whose .first converts to
+ * StringPiece and whose .second is a trivially copyable T) to fd in the
+ * format read by F14MappedView<T>. Keys must be unique. The file is written
+ * sequentially starting at the current offset of fd; only the chunk array is
+ * held in memory. Throws std::system_error on write failure.
+ */
+template <typename Map>
+void writeF14MappedView(int fd, Map const& map, uint64_t seed = 0) {
+  using Header = detail::F14MappedViewHeader;
+  using Chunk = detail::F14MappedViewChunk;
+  using Value = std::decay_t<decltype(std::begin(map)->second)>;
+  static_assert(std::is_trivially_copyable<Value>::value, "");
+  static_assert(alignof(Value) <= 8, "");
+  constexpr std::size_t kValueSize = detail::f14MappedViewPad(sizeof(Value));
+
+  std::size_t size = std::distance(std::begin(map), std::end(map));
+  std::size_t chunkCount = nextPowTwo(std::max<std::size_t>(
+      1,
+      (size + Chunk::kDesiredCapacity - 1) / Chunk::kDesiredCapacity));
+  std::vector<Chunk> chunks(chunkCount);
+
+  uint64_t heapSize = 0;
+  for (auto const& entry : map) {
+    StringPiece key(entry.first);
+    auto hash = detail::f14MappedViewHash(key, seed);
+    auto tag = detail::f14MappedViewTag(hash);
+    std::size_t index = hash & (chunkCount - 1);
+    while (true) {
+      auto& chunk = chunks[index];
+      auto it = std::find(chunk.tags, chunk.tags + Chunk::kCapacity, 0);
+      if (it != chunk.tags + Chunk::kCapacity) {
+        *it = tag;
+        chunk.offsets[it - chunk.tags] = heapSize;
+        break;
+      }
+      if (chunk.outboundOverflowCount != 255) {
+        ++chunk.outboundOverflowCount;
+      }
+      index = (index + detail::f14MappedViewProbeDelta(tag)) &
+          (chunkCount - 1);
+    }
+    heapSize += detail::kF14MappedViewEntryHeaderSize + kValueSize +
+        detail::f14MappedViewPad(key.size());
+  }
+
+  Header header{};
+  header.magic = Header::kMagic;
+  header.version = Header::kVersion;
+  header.valueSize = sizeof(Value);
+  header.seed = seed;
+  header.size = size;
+  header.chunkCount = chunkCount;
+  header.heapOffset = sizeof(Header) + chunkCount * sizeof(Chunk);
+  header.heapSize = heapSize;
+
+  auto writeOrThrow = [fd](const void* data, std::size_t n) {
+    auto ret = writeFull(fd, data, n);
+    checkUnixError(ret, "writeF14MappedView: write failed");
+  };
+  writeOrThrow(&header, sizeof(header));
+  writeOrThrow(chunks.data(), chunkCount * sizeof(Chunk));
+  chunks = {};
+
+  constexpr std::size_t kFlushSize = 1 << 20;
+  std::string buf;
+  buf.reserve(kFlushSize);
+  for (auto const& entry : map) {
+    StringPiece key(entry.first);
+    auto pos = buf.size();
+    buf.resize(
+        pos + detail::kF14MappedViewEntryHeaderSize + kValueSize +
+        detail::f14MappedViewPad(key.size()));
+    auto* out = &buf[pos];
+    auto keySize = static_cast<uint32_t>(key.size());
+    std::memcpy(out, &keySize, sizeof(keySize));
+    out += detail::kF14MappedViewEntryHeaderSize;
+    std::memcpy(out, &entry.second, sizeof(Value));
+    out += kValueSize;
+    std::memcpy(out, key.data(), key.size());
+    if (buf.size() >= kFlushSize) {
+      writeOrThrow(buf.data(), buf.size());
+      buf.clear();
+    }
+  }
+  writeOrThrow(buf.data(), buf.size());
+}
+
+/**
+ * Read-only view of a file written by writeF14MappedView(). See the top of
+ * this file.
+ */
+template <typename T>
+class F14MappedView {
+  static_assert(std::is_trivially_copyable<T>::value, "");
+  static_assert(alignof(T) <= 8, "");
+
+  using Header = detail::F14MappedViewHeader;
+  using Chunk = detail::F14MappedViewChunk;
+
+ public:
+  using key_type = StringPiece;
+  using mapped_type = T;
+
+  /**
+   * Takes ownership of the mapping. Throws std::runtime_error if it does
+   * not hold a valid table for values of type T.
+   */
+  explicit F14MappedView(MemoryMapping mapping) : mapping_(std::move(mapping)) {
+    auto data = mapping_.range();
+    if (data.size() < sizeof(Header)) {
+      throw_exception<std::runtime_error>("F14MappedView: file too small");
+    }
+    header_ = reinterpret_cast<const Header*>(data.data());
+    if (header_->magic != Header::kMagic) {
+      throw_exception<std::runtime_error>("F14MappedView: bad magic");
+    }
+    if (header_->version != Header::kVersion) {
+      throw_exception<std::runtime_error>("F14MappedView: bad version");
+    }
+    if (header_->valueSize != sizeof(T)) {
+      throw_exception<std::runtime_error>("F14MappedView: value size mismatch");
+    }
+    auto chunkCount = header_->chunkCount;
+    if (chunkCount == 0 || !isPowTwo(chunkCount) ||
+        chunkCount > (data.size() - sizeof(Header)) / sizeof(Chunk) ||
+        header_->heapOffset != sizeof(Header) + chunkCount * sizeof(Chunk) ||
+        header_->heapSize > data.size() - header_->heapOffset) {
+      throw_exception<std::runtime_error>("F14MappedView: corrupt header");
+    }
+    chunks_ = reinterpret_cast<const Chunk*>(data.data() + sizeof(Header));
+    heap_ = data.data() + header_->heapOffset;
+  }
+
+  /// Maps the file at path.
+  explicit F14MappedView(const char* path)
+      : F14MappedView(MemoryMapping(path)) {}
+
+  F14MappedView(F14MappedView&&) noexcept = default;
+  F14MappedView& operator=(F14MappedView&&) = default;
+
+  std::size_t size() const { return header_->size; }
+
+  bool empty() const { return size() == 0; }
+
+  /**
+   * Returns a pointer to the value stored for key inside the mapping, or
+   * nullptr if there is none. The pointer is valid as long as the view.
+   */
+  const T* find(StringPiece key) const {
+    auto hash = detail::f14MappedViewHash(key, header_->seed);
+    auto tag = detail::f14MappedViewTag(hash);
+    std::size_t mask = header_->chunkCount - 1;
+    std::size_t index = hash & mask;
+    for (std::size_t tries = 0; tries <= mask; ++tries) {
+      auto const& chunk = chunks_[index];
+      for (std::size_t i = 0; i < Chunk::kCapacity; ++i) {
+        if (chunk.tags[i] != tag) {
+          continue;
+        }
+        if (auto* value = valueIfKeyMatches(chunk.offsets[i], key)) {
+          return value;
+        }
+      }
+      if (FOLLY_LIKELY(chunk.outboundOverflowCount == 0)) {
+        break;
+      }
+      index = (index + detail::f14MappedViewProbeDelta(tag)) & mask;
+    }
+    return nullptr;
+  }
+
+  bool contains(StringPiece key) const { return find(key) != nullptr; }
+
+  const MemoryMapping& mapping() const { return mapping_; }
+
+ private:
+  static constexpr std::size_t kValueSize = detail::f14MappedViewPad(sizeof(T));
+  static constexpr std::size_t kEntryFixedSize =
+      detail::kF14MappedViewEntryHeaderSize + kValueSize;
+
+  const T* valueIfKeyMatches(uint64_t offset, StringPiece key) const {
+    auto heapSize = header_->heapSize;
+    if (offset > heapSize || heapSize - offset < kEntryFixedSize) {
+      return nullptr; // corrupt entry, treat as absent
+    }
+    auto* entry = heap_ + offset;
+    uint32_t keySize;
+    std::memcpy(&keySize, entry, sizeof(keySize));
+    if (keySize != key.size() ||
+        keySize > heapSize - offset - kEntryFixedSize ||
+        (keySize != 0 &&
+         std::memcmp(entry + kEntryFixedSize, key.data(), keySize) != 0)) {
+      return nullptr;
+    }
+    return reinterpret_cast<const T*>(
+        entry + detail::kF14MappedViewEntryHeaderSize);
+  }
+
+  MemoryMapping mapping_;
+  const Header* header_{nullptr};
+  const Chunk* chunks_{nullptr};
+  const uint8_t* heap_{nullptr};
+};
+
+} // namespace folly
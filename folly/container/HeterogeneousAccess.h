@@ -23,6 +23,15 @@
 #include <folly/Traits.h>
 #include <folly/container/HeterogeneousAccess-fwd.h>
 #include <folly/hash/Hash.h>
+#include <folly/hash/RapidHash.h>
+
+// When set, HeterogeneousAccessHash of strings hashes with hash::rapidhash
+// instead of std::hash, for every container that uses it (which includes
+// the default Hasher of F14 maps and sets keyed by std::string). It changes
+// hash values, so it must be the same in every translation unit.
+#ifndef FOLLY_HETEROGENEOUS_ACCESS_RAPIDHASH
+#define FOLLY_HETEROGENEOUS_ACCESS_RAPIDHASH 0
+#endif
 
 namespace folly {
 
@@ -110,7 +119,9 @@ struct TransparentRangeHash {
   }
 
   static std::size_t hashImpl(StringPiece piece) {
-#if defined(_GLIBCXX_STRING)
+#if FOLLY_HETEROGENEOUS_ACCESS_RAPIDHASH
+    return RapidStringHash{}(piece);
+#elif defined(_GLIBCXX_STRING)
     return std::_Hash_impl::hash(piece.begin(), piece.size());
 #elif defined(_LIBCPP_STRING)
     return std::__do_string_hash(piece.begin(), piece.end());
@@ -135,7 +146,9 @@ struct TransparentRangeHash {
   // of std::hash<std::string> then we should consider using it all of
   // the time.
   std::size_t operator()(std::string const& str) const {
-#if defined(_GLIBCXX_STRING) || defined(_LIBCPP_STRING)
+#if FOLLY_HETEROGENEOUS_ACCESS_RAPIDHASH
+    return RapidStringHash{}(str);
+#elif defined(_GLIBCXX_STRING) || defined(_LIBCPP_STRING)
     return std::hash<std::string>{}(str);
 #else
     return hasher<StringPiece>{}(str);
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+namespace folly {
+
+/**
+ * Reports the memory that a container has allocated, uniformly across
+ * folly's containers: F14 maps and sets, ConcurrentHashMap,
+ * EvictingCacheMap, fbvector and small_vector, or any type with a
+ * visitAllocationClasses(visitor) member.
+ *
+ * visitMemoryUsage(c, visitor) calls visitor(allocationSize,
+ * allocationCount) for each class of memory blocks that c owns, with the
+ * semantics of F14's visitAllocationClasses(): the same size may be
+ * visited more than once, and counts may be zero. This is the hook for
+ * accounting that is more accurate than a sum, such as rounding each size
+ * up with jemalloc's nallocx.
+ *
+ * memoryUsage(c) is the sum of allocationSize * allocationCount.
+ *
+ * Only the container's own allocations are counted: the shallow bits
+ * (sizeof) of its elements, but not memory that they own in turn.
+ *
+ *        size_t bytes = folly::memoryUsage(map);
+ *
+ *        size_t rounded = 0;
+ *        folly::visitMemoryUsage(map, [&](size_t size, size_t count) {
+ *          rounded += nallocx(size, 0) * count;
+ *        });
+ */
+struct visit_memory_usage_fn {
+  template <typename C, typename V>
+  void operator()(C const& c, V&& visitor) const {
+    c.visitAllocationClasses(std::forward<V>(visitor));
+  }
+};
+
+inline constexpr visit_memory_usage_fn visitMemoryUsage{};
+
+struct memory_usage_fn {
+  template <typename C>
+  std::size_t operator()(C const& c) const {
+    std::size_t bytes = 0;
+    visitMemoryUsage(c, [&](std::size_t size, std::size_t count) {
+      bytes += size * count;
+    });
+    return bytes;
+  }
+};
+
+inline constexpr memory_usage_fn memoryUsage{};
+
+} // namespace folly
@@ -24,8 +24,8 @@ namespace folly {
 
 /**
  * A variant of EvictingCacheMap that assigns weights to entries and
- * evicts entries in LRU order to ensure the total weight of all entries
- * stays below some set maximum. ImplicitlyWeighted means this variant
+ * evicts entries in eviction policy order to ensure the total weight of all
+ * entries stays below some set maximum. ImplicitlyWeighted means this variant
  * derives the weights from the key-values using a chosen function. TWeightFn
  * must be a type implementing `size_t operator()(const TKey&, const Tvalue&)`
  *
@@ -51,6 +51,14 @@ namespace folly {
  * constraints from EvictingCacheMap. (Must either match TKey or
  * EligibleForHeterogeneousFind/Insert.)
  *
+ * TEvictionPolicy selects the eviction order, see EvictingCacheMap. With the
+ * default LruEvictionPolicy, entries are evicted in LRU order. With
+ * ClockEvictionPolicy or S3FifoEvictionPolicy, hits do not reorder the list
+ * and scans are less likely to flush frequently used entries. A "hit" is
+ * what the policy does on a lookup: with LRU it moves the entry to the
+ * front. set(), replace() and updateWeight() always protect the entry they
+ * modify.
+ *
  * This implementation has not been highly optimized and is a wrapper around
  * EvictingCacheMap.
  */
@@ -59,10 +67,11 @@ template <
     class TValue,
     class TWeightFn,
     class THash = HeterogeneousAccessHash<TKey>,
-    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>>
+    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>,
+    class TEvictionPolicy = LruEvictionPolicy>
 class ImplicitlyWeightedEvictingCacheMap {
  private: // typedefs
-  using ECM = EvictingCacheMap<TKey, TValue, THash, TKeyEqual>;
+  using ECM = EvictingCacheMap<TKey, TValue, THash, TKeyEqual, TEvictionPolicy>;
 
  public:
   using PruneHookCall = std::function<void(TKey, TValue&&)>;
@@ -165,7 +174,7 @@ class ImplicitlyWeightedEvictingCacheMap {
 
   /**
    * Check for existence of a specific key in the map.  This operation has
-   *     no effect on LRU order.
+   *     no effect on eviction order.
    * @param key key to search for
    * @return true if exists, false otherwise
    */
@@ -176,7 +185,7 @@ class ImplicitlyWeightedEvictingCacheMap {
 
   /**
    * Get the value associated with a specific key.  This function always
-   * promotes a found value to the head of the LRU. The returned reference
+   * records a hit on a found value. The returned reference
    * is const and might be inavlidated by many subsequent operations. See
    * IMPORTANT NOTES above. See also replace().
    *
@@ -189,7 +198,7 @@ class ImplicitlyWeightedEvictingCacheMap {
     return ecm_.get(key);
   }
 
-  // Same but without LRU promotion
+  // Same but without recording a hit
   template <typename K>
   const TValue& getWithoutPromotion(const K& key) const {
     return ecm_.getWithoutPromotion(key);
@@ -200,8 +209,8 @@ class ImplicitlyWeightedEvictingCacheMap {
    * is more than maxTotalWeight, the entry is inserted anyway and all other
    * entries are evicted, so that get() after set() always succeeds. The
    * structure can be temporarily over max weight until the next modification.
-   * The new or modified entry is always inserted at or promoted to the head
-   * of the LRU.
+   * The new entry is inserted, or the modified entry hit, as with any
+   * insertion or lookup.
    *
    * @param key key to associate with value
    * @param value value to associate with the key
@@ -228,10 +237,10 @@ class ImplicitlyWeightedEvictingCacheMap {
       new (ptr) TValue(std::move(value));
     } else {
       // No existing entry
-      ecm_.insert(key, std::move(value));
+      it = ecm_.insert(key, std::move(value)).first;
     }
-    // Protect the entry we just put at the head of the LRU
-    entryWeightUpdated(old_weight, new_weight, /*protect_one*/ true);
+    // Protect the entry we just set
+    entryWeightUpdated(old_weight, new_weight, it);
   }
 
   template <typename K>
@@ -258,7 +267,7 @@ class ImplicitlyWeightedEvictingCacheMap {
 
   /**
    * Get the iterator associated with a specific key.  This function always
-   * promotes a found value to the head of the LRU. See IMPORTANT NOTES above
+   * records a hit on a found value. See IMPORTANT NOTES above
    * for why this only returns a const_iterator. See also replace().
    * @param key key to associate with value
    * @return the const_iterator of the object (a std::pair of const TKey,
@@ -269,7 +278,7 @@ class ImplicitlyWeightedEvictingCacheMap {
     return const_iterator(ecm_.find(key).base());
   }
 
-  // Same but without LRU promotion
+  // Same but without recording a hit
   template <typename K>
   const_iterator findWithoutPromotion(const K& key) const {
     return ecm_.findWithoutPromotion(key);
@@ -279,12 +288,8 @@ class ImplicitlyWeightedEvictingCacheMap {
    * Replace the value associated with an entry from a const_iterator, in a
    * safe way that tracks any modification to the weight. Entries are evicted
    * so that max total weight it not exceeded, except this function protects
-   * the entry at the head of the LRU list from eviction. Thus, for find()
-   * immediately followed by replace(), the modified entry is protected
-   * against eviction even if exceeding max total weight (like set(), iterator
-   * remains valid). The iterator also remains valid if the weight does not
-   * increase. Otherwise, the iterator is potentially invalidated by eviction
-   * during this operation.
+   * the modified entry from eviction, even if it exceeds max total weight
+   * (like set()), so the iterator remains valid.
    *
    * If TValue is a const type, this function is invalid.
    * @param it const_iterator for the entry to modify, which must come from
@@ -297,8 +302,8 @@ class ImplicitlyWeightedEvictingCacheMap {
     size_t new_weight = weightFn_(it->first, value);
     // Overwrite in place
     const_cast<TValue&>(it->second) = std::move(value);
-    // Evict as needed (possibly including this entry, unless it's LRU head)
-    entryWeightUpdated(old_weight, new_weight, /*protect_one*/ true);
+    // Evict as needed, except this entry
+    entryWeightUpdated(old_weight, new_weight, it);
   }
 
   void replace(const_iterator it, const TValue& value) {
@@ -336,23 +341,31 @@ class ImplicitlyWeightedEvictingCacheMap {
   }
 
   void entryWeightUpdated(
-      std::size_t old_weight,
-      std::size_t new_weight,
-      bool protect_one = false) {
+      std::size_t old_weight, std::size_t new_weight, const_iterator protect) {
     assert(old_weight <= currentTotalWeight_);
     currentTotalWeight_ += new_weight - old_weight;
-    pruneToMaxTotalWeight(protect_one);
+    pruneToMaxTotalWeight(protect);
   }
 
-  void pruneToMaxTotalWeight(bool protect_one = false) {
-    // NOTE: Avoid infinite loop even in the case of weight tracking bug
-    size_t min_count = protect_one ? 1 : 0;
-    while (currentTotalWeight_ > maxTotalWeight_ && ecm_.size() > min_count) {
+  // NOTE: Avoid infinite loops below even in the case of weight tracking bug
+  void pruneToMaxTotalWeight() {
+    while (currentTotalWeight_ > maxTotalWeight_ && !ecm_.empty()) {
       ecm_.prune(1);
     }
   }
 
-  template <class _TKey, class _TValue, class _THash, class _TKeyEqual>
+  void pruneToMaxTotalWeight(const_iterator protect) {
+    while (currentTotalWeight_ > maxTotalWeight_ && ecm_.size() > 1) {
+      ecm_.pruneExcept(1, protect);
+    }
+  }
+
+  template <
+      class _TKey,
+      class _TValue,
+      class _THash,
+      class _TKeyEqual,
+      class _TEvictionPolicy>
   friend class WeightedEvictingCacheMap;
 
  private: // data
@@ -365,9 +378,9 @@ class ImplicitlyWeightedEvictingCacheMap {
 
 /**
  * A variant of EvictingCacheMap that tracks weights for entries and
- * evicts entries in LRU order to ensure the total weight of all entries
- * stays below some set maximum. Weights are stored as a size_t with each
- * entry.
+ * evicts entries in eviction policy order to ensure the total weight of all
+ * entries stays below some set maximum. Weights are stored as a size_t with
+ * each entry.
  *
  * Example usage: if TKey is std::string and TValue is some large, complex
  * object type, the weight could be the estimated memory size of the key
@@ -387,13 +400,17 @@ class ImplicitlyWeightedEvictingCacheMap {
  * constraints from EvictingCacheMap. (Must either match TKey or
  * EligibleForHeterogeneousFind/Insert.)
  *
+ * As for ImplicitlyWeightedEvictingCacheMap, TEvictionPolicy selects the
+ * eviction order (LRU by default).
+ *
  * This implementation has not been highly optimized.
  */
 template <
     class TKey,
     class TValue,
     class THash = HeterogeneousAccessHash<TKey>,
-    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>>
+    class TKeyEqual = HeterogeneousAccessEqualTo<TKey>,
+    class TEvictionPolicy = LruEvictionPolicy>
 class WeightedEvictingCacheMap {
  public: // types
   struct ValueAndWeight {
@@ -416,7 +433,8 @@ class WeightedEvictingCacheMap {
       ValueAndWeight,
       WeightFn,
       THash,
-      TKeyEqual>;
+      TKeyEqual,
+      TEvictionPolicy>;
 
  public:
   using PruneHookCall = std::function<void(TKey, TValue&&, size_t)>;
@@ -495,7 +513,7 @@ class WeightedEvictingCacheMap {
 
   /**
    * Check for existence of a specific key in the map.  This operation has
-   *     no effect on LRU order.
+   *     no effect on eviction order.
    * @param key key to search for
    * @return true if exists, false otherwise
    */
@@ -506,7 +524,7 @@ class WeightedEvictingCacheMap {
 
   /**
    * Get the value associated with a specific key.  This function always
-   * promotes a found value to the head of the LRU. The TValue can be
+   * records a hit on a found value. The TValue can be
    * modified in place through the reference, keeping in mind the reference
    * can easily be invalidated (IMPORTANT NOTES above).
    * @param key key to search for
@@ -517,7 +535,7 @@ class WeightedEvictingCacheMap {
   TValue& get(const K& key) {
     return const_cast<TValue&>(iwecm_.get(key).value);
   }
-  // Same but without LRU promotion
+  // Same but without recording a hit
   template <typename K>
   TValue& getWithoutPromotion(const K& key) {
     return const_cast<TValue&>(iwecm_.getWithoutPromotion(key).value);
@@ -532,8 +550,8 @@ class WeightedEvictingCacheMap {
    * is more than maxTotalWeight, the entry is inserted anyway and all other
    * entries are evicted, so that get() after set() always succeeds. The
    * structure can be temporarily over max weight until the next modification.
-   * The new or modified entry is always inserted at or promoted to the head
-   * of the LRU.
+   * The new entry is inserted, or the modified entry hit, as with any
+   * insertion or lookup.
    *
    * @param key key to associate with value
    * @param value value to associate with the key
@@ -568,7 +586,7 @@ class WeightedEvictingCacheMap {
 
   /**
    * Get the iterator associated with a specific key. This function always
-   * promotes a found value to the head of the LRU. Although values can be
+   * records a hit on a found value. Although values can be
    * modified through iterators, weights are const. See updateWeight().
    * @param key key to associate with value
    * @return the iterator of std::pair<const TKey, ValueAndWeight>, or
@@ -579,7 +597,7 @@ class WeightedEvictingCacheMap {
     return iwecm_.ecm_.find(key);
   }
 
-  // Same but without LRU promotion
+  // Same but without recording a hit
   template <typename K>
   iterator findWithoutPromotion(const K& key) {
     return iwecm_.ecm_.findWithoutPromotion(key);
@@ -592,12 +610,8 @@ class WeightedEvictingCacheMap {
   /**
    * Overwrite the weight associated with a specific entry. As usual, entries
    * are evicted so that max total weight it not exceeded, except this
-   * function protects the entry at the head of the LRU list from eviction.
-   * Thus, for find() immediately followed by updateWeight(), the modified
-   * entry is protected against eviction even if exceeding max total weight
-   * (like set(), iterator remains valid). The iterator also remains valid if
-   * the weight does not increase. Otherwise, the iterator is potentially
-   * invalidated by eviction during this operation.
+   * function protects the modified entry from eviction, even if it exceeds
+   * max total weight (like set()), so the iterator remains valid.
    *
    * @param it iterator for the entry to modify, which must come from
    * this cache map
@@ -640,8 +654,8 @@ class WeightedEvictingCacheMap {
     size_t old_weight = it->second.weight;
     // Overwrite in place
     const_cast<std::size_t&>(it->second.weight) = new_weight;
-    // Evict as needed (possibly including this entry, unless it's LRU head)
-    iwecm_.entryWeightUpdated(old_weight, new_weight, /*protect_one*/ true);
+    // Evict as needed, except this entry
+    iwecm_.entryWeightUpdated(old_weight, new_weight, it);
   }
 
   PruneHookCall pruneHook_;
@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * buffered_sorted_vector_map is a sorted_vector_map with a small unsorted
+ * insertion buffer in front of it.
+ *
+ * sorted_vector_map has excellent lookup and iteration locality, but every
+ * insertion of a new key shifts the tail of the vector, so building one
+ * incrementally is quadratic. buffered_sorted_vector_map instead appends new
+ * keys to an unsorted tail. Once the tail holds mergeThreshold() elements it
+ * is sorted into a run, and runs are merged in single linear passes (see
+ * folly/container/Merge.h) as in a log-structured merge tree: a run is merged
+ * into the next one of about the same size, and into the sorted body once
+ * it is at least half as large as the body. Each element is moved
+ * O(log(n / threshold)) times, so n insertions cost O(n log(n / threshold))
+ * moves instead of O(n^2).
+ *
+ * Lookups binary search the body and the O(log(n / threshold)) runs, and
+ * then scan the tail linearly, so the threshold trades insertion cost
+ * against lookup cost; the default keeps the tail within a few cache lines
+ * for small value types. Call flush() at the end of an ingest phase to make
+ * subsequent lookups as cheap as on a plain sorted_vector_map.
+ *
+ * Iteration is in key order. The non-const begin() flushes first, so that
+ * iteration is a plain walk over the body. Const access never modifies the
+ * map: a const begin() on a map that is not flushed merges the body, the
+ * runs and the tail on the fly, each increment costing a lookup. sorted()
+ * gives read-only access to the body, which holds every element after a
+ * flush.
+ *
+ * Like sorted_vector_map, concurrent const access is safe, but not
+ * concurrent with modification. Any insertion may merge, and flush() and
+ * the non-const begin() do, which invalidates all references, pointers and
+ * iterators.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <folly/container/Merge.h>
+#include <folly/sorted_vector_types.h>
+
+namespace folly {
+
+template <
+    class Key,
+    class Value,
+    class Compare = std::less<Key>,
+    class Allocator = std::allocator<std::pair<Key, Value>>>
+class buffered_sorted_vector_map {
+  using Body = sorted_vector_map<Key, Value, Compare, Allocator>;
+  using Container = typename Body::container_type;
+
+  template <bool Const>
+  class iterator_impl;
+
+ public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = typename Body::value_type;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using size_type = typename Body::size_type;
+  using iterator = iterator_impl<false>;
+  using const_iterator = iterator_impl<true>;
+
+  static constexpr size_type kDefaultMergeThreshold = 64;
+
+  explicit buffered_sorted_vector_map(
+      size_type mergeThreshold = kDefaultMergeThreshold,
+      const Compare& comp = Compare())
+      : body_(comp),
+        tail_(body_.get_allocator()),
+        mergeThreshold_(std::max<size_type>(1, mergeThreshold)) {}
+
+  size_type mergeThreshold() const { return mergeThreshold_; }
+
+  size_type size() const {
+    auto result = body_.size() + tail_.size();
+    for (auto& run : runs_) {
+      result += run.size();
+    }
+    return result;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  void clear() {
+    body_.clear();
+    runs_.clear();
+    tail_.clear();
+  }
+
+  void reserve(size_type n) {
+    body_.reserve(n);
+    tail_.reserve(mergeThreshold_);
+  }
+
+  /**
+   * Insert value if its key is not present.
+   * @return an iterator to the element with that key, and whether the
+   *     insertion took place.
+   */
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return emplace(value.first, value.second);
+  }
+
+  std::pair<iterator, bool> insert(value_type&& value) {
+    return emplace(std::move(value.first), std::move(value.second));
+  }
+
+  template <class InputIt>
+  void insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+
+  template <class K, class... Args>
+  std::pair<iterator, bool> emplace(K&& key, Args&&... args) {
+    if (auto* found = findPtr(key)) {
+      return {iterator(this, found), false};
+    }
+    tail_.emplace_back(
+        std::piecewise_construct,
+        std::forward_as_tuple(std::forward<K>(key)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+    if (tail_.size() < mergeThreshold_) {
+      return {iterator(this, &tail_.back()), true};
+    }
+    return {iterator(this, mergeTail()), true};
+  }
+
+  template <class K, class V>
+  std::pair<iterator, bool> insert_or_assign(K&& key, V&& value) {
+    if (auto* found = findPtr(key)) {
+      found->second = std::forward<V>(value);
+      return {iterator(this, found), false};
+    }
+    return emplace(std::forward<K>(key), std::forward<V>(value));
+  }
+
+  mapped_type& operator[](const key_type& key) {
+    return emplace(key).first->second;
+  }
+
+  /// Returns an iterator to the element with key, or end().
+  iterator find(const key_type& key) { return iterator(this, findPtr(key)); }
+
+  const_iterator find(const key_type& key) const {
+    return const_iterator(this, findPtr(key));
+  }
+
+  bool contains(const key_type& key) const { return findPtr(key) != nullptr; }
+
+  size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+  size_type erase(const key_type& key) {
+    for (auto it = tail_.begin(); it != tail_.end(); ++it) {
+      if (keyEqual(it->first, key)) {
+        if (it != tail_.end() - 1) {
+          *it = std::move(tail_.back());
+        }
+        tail_.pop_back();
+        return 1;
+      }
+    }
+    for (auto& run : runs_) {
+      auto pos = lowerBound(run, key);
+      if (pos != run.end() && keyEqual(pos->first, key)) {
+        run.erase(pos);
+        return 1;
+      }
+    }
+    return body_.erase(key);
+  }
+
+  /**
+   * Merge the tail and the runs into the sorted body. After this, lookups
+   * only search the body and sorted() holds every element.
+   */
+  void flush() {
+    if (tail_.empty() && runs_.empty()) {
+      return;
+    }
+    auto valueComp = body_.value_comp();
+    std::sort(tail_.begin(), tail_.end(), valueComp);
+    // Smallest runs first, so that each element is moved about once before
+    // the final merge into the body.
+    Container carry(std::move(tail_));
+    tail_ = Container(body_.get_allocator());
+    for (auto& run : runs_) {
+      carry = mergeRuns(run, carry);
+    }
+    runs_.clear();
+    mergeIntoBody(carry);
+  }
+
+  /// The sorted body. Only holds every element right after flush().
+  const Body& sorted() const { return body_; }
+
+  /// Flushes, then returns an iterator to the first element.
+  iterator begin() {
+    flush();
+    return iterator(this, body_.empty() ? nullptr : &*body_.begin());
+  }
+
+  iterator end() { return iterator(this, nullptr); }
+
+  /// Returns an iterator to the first element, without flushing.
+  const_iterator begin() const { return const_iterator(this, next(nullptr)); }
+
+  const_iterator end() const { return const_iterator(this, nullptr); }
+
+  const_iterator cbegin() const { return begin(); }
+
+  const_iterator cend() const { return end(); }
+
+ private:
+  value_type* findPtr(const key_type& key) {
+    auto it = body_.find(key);
+    if (it != body_.end()) {
+      return &*it;
+    }
+    for (auto& run : runs_) {
+      auto pos = lowerBound(run, key);
+      if (pos != run.end() && keyEqual(pos->first, key)) {
+        return &*pos;
+      }
+    }
+    for (auto& value : tail_) {
+      if (keyEqual(value.first, key)) {
+        return &value;
+      }
+    }
+    return nullptr;
+  }
+
+  const value_type* findPtr(const key_type& key) const {
+    return const_cast<buffered_sorted_vector_map*>(this)->findPtr(key);
+  }
+
+  bool flushed() const {
+    return tail_.empty() &&
+        std::all_of(runs_.begin(), runs_.end(), [](auto& run) {
+             return run.empty();
+           });
+  }
+
+  // The element with the smallest key greater than that of prev, or the
+  // first element if prev is null. Returns nullptr past the last element.
+  const value_type* next(const value_type* prev) const {
+    if (prev != nullptr && flushed()) {
+      ++prev;
+      return prev == &*body_.begin() + body_.size() ? nullptr : prev;
+    }
+    auto const& comp = body_.key_comp();
+    const value_type* best = nullptr;
+    auto consider = [&](const value_type& v) {
+      if (best == nullptr || comp(v.first, best->first)) {
+        best = &v;
+      }
+    };
+    auto bodyIt =
+        prev != nullptr ? body_.upper_bound(prev->first) : body_.begin();
+    if (bodyIt != body_.end()) {
+      consider(*bodyIt);
+    }
+    for (auto& run : runs_) {
+      auto it = prev == nullptr ? run.begin()
+                                : std::upper_bound(
+                                      run.begin(),
+                                      run.end(),
+                                      prev->first,
+                                      [&](const Key& k, auto const& v) {
+                                        return comp(k, v.first);
+                                      });
+      if (it != run.end()) {
+        consider(*it);
+      }
+    }
+    for (auto& value : tail_) {
+      if (prev == nullptr || comp(prev->first, value.first)) {
+        consider(value);
+      }
+    }
+    return best;
+  }
+
+  bool keyEqual(const key_type& a, const key_type& b) const {
+    auto const& comp = body_.key_comp();
+    return !comp(a, b) && !comp(b, a);
+  }
+
+  typename Container::iterator lowerBound(Container& run, const Key& key) {
+    auto const& comp = body_.key_comp();
+    return std::lower_bound(
+        run.begin(), run.end(), key, [&](auto const& v, const Key& k) {
+          return comp(v.first, k);
+        });
+  }
+
+  // Merges two sorted runs of distinct keys, emptying them.
+  Container mergeRuns(Container& a, Container& b) const {
+    Container merged(body_.get_allocator());
+    merged.reserve(a.size() + b.size());
+    folly::merge(
+        std::make_move_iterator(a.begin()),
+        std::make_move_iterator(a.end()),
+        std::make_move_iterator(b.begin()),
+        std::make_move_iterator(b.end()),
+        std::back_inserter(merged),
+        body_.value_comp());
+    a.clear();
+    b.clear();
+    return merged;
+  }
+
+  void mergeIntoBody(Container& run) {
+    auto guard = body_.get_container_for_direct_mutation(sorted_unique_t{});
+    auto& cont = guard.get();
+    auto merged = mergeRuns(cont, run);
+    cont.swap(merged);
+  }
+
+  // Sorts the full tail into a run and merges it down, returning the new
+  // position of the last element of the tail.
+  value_type* mergeTail() {
+    auto const& comp = body_.key_comp();
+    auto valueComp = body_.value_comp();
+    // The position of the new element in the sorted tail.
+    size_type pos = std::count_if(tail_.begin(), tail_.end(), [&](auto& v) {
+      return comp(v.first, tail_.back().first);
+    });
+    std::sort(tail_.begin(), tail_.end(), valueComp);
+    Container carry(std::move(tail_));
+    tail_ = Container(body_.get_allocator());
+    tail_.reserve(mergeThreshold_);
+
+    for (size_type level = 0;; ++level) {
+      if (2 * carry.size() >= body_.size()) {
+        pos += body_.lower_bound(carry[pos].first) - body_.begin();
+        mergeIntoBody(carry);
+        return &*(body_.begin() + pos);
+      }
+      if (level == runs_.size()) {
+        runs_.emplace_back(body_.get_allocator());
+      }
+      auto& run = runs_[level];
+      if (run.empty()) {
+        run = std::move(carry);
+        return &run[pos];
+      }
+      pos += lowerBound(run, carry[pos].first) - run.begin();
+      carry = mergeRuns(run, carry);
+    }
+  }
+
+  Body body_;
+  // Sorted runs, about mergeThreshold_ << i elements in runs_[i], if any.
+  std::vector<Container> runs_;
+  Container tail_;
+  size_type mergeThreshold_;
+};
+
+/**
+ * A forward iterator over the elements in key order. Increments are plain
+ * pointer increments on a flushed map, and lookups in the body, the runs
+ * and the tail otherwise.
+ */
+template <class Key, class Value, class Compare, class Allocator>
+template <bool Const>
+class buffered_sorted_vector_map<Key, Value, Compare, Allocator>::
+    iterator_impl {
+  using Map = std::conditional_t<
+      Const,
+      const buffered_sorted_vector_map,
+      buffered_sorted_vector_map>;
+
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = typename buffered_sorted_vector_map::value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+  using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+  iterator_impl() = default;
+
+  template <bool OtherConst, std::enable_if_t<Const && !OtherConst, int> = 0>
+  /* implicit */ iterator_impl(const iterator_impl<OtherConst>& other) noexcept
+      : map_(other.map_), cur_(other.cur_) {}
+
+  reference operator*() const { return *cur_; }
+  pointer operator->() const { return cur_; }
+
+  iterator_impl& operator++() {
+    cur_ = const_cast<pointer>(map_->next(cur_));
+    return *this;
+  }
+
+  iterator_impl operator++(int) {
+    auto copy = *this;
+    ++*this;
+    return copy;
+  }
+
+  friend bool operator==(const iterator_impl& a, const iterator_impl& b) {
+    return a.cur_ == b.cur_;
+  }
+
+  friend bool operator!=(const iterator_impl& a, const iterator_impl& b) {
+    return a.cur_ != b.cur_;
+  }
+
+ private:
+  friend class buffered_sorted_vector_map;
+  template <bool>
+  friend class iterator_impl;
+
+  iterator_impl(Map* map, pointer cur) noexcept : map_(map), cur_(cur) {}
+
+  Map* map_ = nullptr;
+  pointer cur_ = nullptr;
+};
+
+} // namespace folly
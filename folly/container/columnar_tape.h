@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/Likely.h>
+#include <folly/Traits.h>
+#include <folly/container/Iterator.h>
+#include <folly/container/tape.h>
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace folly {
+
+/* # columnar_tape
+ *
+ * A structure-of-arrays table of `NColumns` variable-length columns: one tape
+ * per column, all with the same number of records (rows).
+ *
+ * Compared to a tape of rows (or a vector of structs of strings), a scan over
+ * one column only touches that column's bytes, and every column is a single
+ * contiguous allocation.
+ *
+ *   columnar_tape<2> t;
+ *   t.push_back("key", "value");
+ *   for (auto key : t.column<0>()) { ... }
+ *   auto [key, value] = t[0];
+ */
+template <std::size_t NColumns, typename Tape = string_tape>
+class columnar_tape {
+  static_assert(NColumns > 0, "columnar_tape needs at least one column");
+
+ public:
+  using tape_type = Tape;
+  using column_reference = typename tape_type::const_reference;
+  using scalar_value_type = typename tape_type::scalar_value_type;
+
+  // A row: one record per column.
+  using const_reference = std::array<column_reference, NColumns>;
+  using reference = const_reference;
+  using value_type = const_reference;
+
+  using size_type = typename tape_type::size_type;
+  using difference_type = typename tape_type::difference_type;
+
+  using iterator = folly::index_iterator<const columnar_tape>;
+  using const_iterator = iterator;
+
+  static constexpr std::size_t num_columns() noexcept { return NColumns; }
+
+  // access ------
+
+  [[nodiscard]] const_reference operator[](size_type i) const noexcept {
+    return row(i, std::make_index_sequence<NColumns>{});
+  }
+
+  [[nodiscard]] const_reference at(size_type i) const {
+    if (FOLLY_UNLIKELY(i >= size())) {
+      throw std::out_of_range("columnar_tape");
+    }
+    return operator[](i);
+  }
+
+  template <std::size_t Column>
+  [[nodiscard]] const tape_type& column() const noexcept {
+    static_assert(Column < NColumns, "column out of range");
+    return columns_[Column];
+  }
+
+  [[nodiscard]] const tape_type& column(std::size_t c) const noexcept {
+    assert(c < NColumns);
+    return columns_[c];
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+  [[nodiscard]] size_type size() const noexcept { return columns_[0].size(); }
+
+  [[nodiscard]] const_iterator begin() const noexcept { return {*this, 0}; }
+  [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+  [[nodiscard]] const_iterator end() const noexcept { return {*this, size()}; }
+  [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+  // modifiers -----
+
+  // Appends a row; takes one record per column, in column order. Each record
+  // can be anything the column tape's push_back accepts.
+  template <
+      typename... Records,
+      typename = std::enable_if_t<
+          sizeof...(Records) == NColumns &&
+          !std::conjunction_v<
+              std::is_same<remove_cvref_t<Records>, const_reference>...>>>
+  void push_back(Records&&... records) {
+    std::size_t c = 0;
+    (columns_[c++].push_back(std::forward<Records>(records)), ...);
+  }
+
+  void push_back(const const_reference& row) {
+    for (std::size_t c = 0; c != NColumns; ++c) {
+      columns_[c].push_back(row[c]);
+    }
+  }
+
+  template <typename... Records>
+  void emplace_back(Records&&... records) {
+    push_back(std::forward<Records>(records)...);
+  }
+
+  void pop_back() noexcept {
+    assert(!empty());
+    for (auto& column : columns_) {
+      column.pop_back();
+    }
+  }
+
+  // elements_per_column: expected flat size of each column
+  void reserve(
+      size_type rows,
+      const std::array<size_type, NColumns>& elements_per_column) {
+    for (std::size_t c = 0; c != NColumns; ++c) {
+      columns_[c].reserve(rows, elements_per_column[c]);
+    }
+  }
+
+  void reserve(size_type rows) {
+    for (auto& column : columns_) {
+      column.reserve(rows);
+    }
+  }
+
+  void clear() noexcept {
+    for (auto& column : columns_) {
+      column.clear();
+    }
+  }
+
+  friend bool operator==(const columnar_tape& x, const columnar_tape& y) {
+    return x.columns_ == y.columns_;
+  }
+  friend bool operator!=(const columnar_tape& x, const columnar_tape& y) {
+    return !(x == y);
+  }
+
+ private:
+  template <std::size_t... Is>
+  const_reference row(size_type i, std::index_sequence<Is...>) const noexcept {
+    return {{columns_[Is][i]...}};
+  }
+
+  std::array<tape_type, NColumns> columns_;
+};
+
+} // namespace folly
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/Likely.h>
+#include <folly/Range.h>
+#include <folly/Varint.h>
+#include <folly/container/Iterator.h>
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace folly {
+
+/* # compact_string_tape
+ *
+ * An append-only sibling of `string_tape` for large tapes, where the offsets
+ * vector (8 bytes per record) dominates memory for short records.
+ *
+ * Instead of absolute offsets, record lengths are stored varint-encoded
+ * (usually 1 byte per record). Every `kBlockSize` records we sample an
+ * absolute position, so random access decodes at most `kBlockSize` lengths
+ * while the index costs 12 bytes per block. Sequential iteration decodes each
+ * length once.
+ *
+ * Records cannot be erased or mutated; build the tape once and read it many
+ * times.
+ */
+class compact_string_tape {
+ public:
+  static constexpr std::size_t kBlockSize = 32;
+
+  using value_type = StringPiece;
+  using reference = StringPiece;
+  using const_reference = StringPiece;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  class const_iterator;
+  using iterator = const_iterator;
+
+  compact_string_tape() = default;
+
+  template <
+      typename R,
+      typename = std::enable_if_t<std::is_convertible_v<
+          decltype(*std::begin(std::declval<const R&>())),
+          StringPiece>>>
+  explicit compact_string_tape(const R& records) {
+    for (const auto& r : records) {
+      push_back(r);
+    }
+  }
+
+  explicit compact_string_tape(std::initializer_list<StringPiece> records) {
+    for (auto r : records) {
+      push_back(r);
+    }
+  }
+
+  // access ------
+
+  [[nodiscard]] const_reference operator[](size_type i) const noexcept {
+    assert(i < size_);
+    const auto& block = blocks_[i / kBlockSize];
+    ByteRange lengths{
+        reinterpret_cast<const uint8_t*>(lengths_.data()) + block.lengths,
+        reinterpret_cast<const uint8_t*>(lengths_.data()) + lengths_.size()};
+    auto offset = block.data;
+    for (auto n = i % kBlockSize; n != 0; --n) {
+      offset += decodeVarint(lengths);
+    }
+    auto length = decodeVarint(lengths);
+    return {data_.data() + offset, length};
+  }
+
+  [[nodiscard]] const_reference at(size_type i) const {
+    if (FOLLY_UNLIKELY(i >= size())) {
+      throw std::out_of_range("compact_string_tape");
+    }
+    return operator[](i);
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+  [[nodiscard]] size_type size() const noexcept { return size_; }
+  [[nodiscard]] size_type size_flat() const noexcept { return data_.size(); }
+
+  // bytes used by the record boundaries (lengths and sampled offsets).
+  [[nodiscard]] size_type size_index() const noexcept {
+    return lengths_.size() + blocks_.size() * sizeof(block);
+  }
+
+  [[nodiscard]] const_reference front() const noexcept { return (*this)[0]; }
+  [[nodiscard]] const_reference back() const noexcept {
+    return (*this)[size_ - 1];
+  }
+
+  [[nodiscard]] StringPiece scalars() const noexcept { return data_; }
+
+  // iterators ----
+
+  [[nodiscard]] const_iterator begin() const noexcept;
+  [[nodiscard]] const_iterator cbegin() const noexcept;
+  [[nodiscard]] const_iterator end() const noexcept;
+  [[nodiscard]] const_iterator cend() const noexcept;
+
+  // modifiers ------
+
+  void push_back(StringPiece record) {
+    if (size_ % kBlockSize == 0) {
+      blocks_.push_back(
+          {data_.size(), static_cast<uint32_t>(lengths_.size())});
+    }
+    uint8_t buf[kMaxVarintLength64];
+    auto n = encodeVarint(record.size(), buf);
+    lengths_.append(reinterpret_cast<const char*>(buf), n);
+    data_.append(record.data(), record.size());
+    ++size_;
+  }
+
+  void emplace_back(StringPiece record) { push_back(record); }
+
+  void reserve(size_type records, size_type elements) {
+    blocks_.reserve((records + kBlockSize - 1) / kBlockSize);
+    lengths_.reserve(records);
+    data_.reserve(elements);
+  }
+
+  void clear() noexcept {
+    blocks_.clear();
+    lengths_.clear();
+    data_.clear();
+    size_ = 0;
+  }
+
+  friend bool operator==(
+      const compact_string_tape& x, const compact_string_tape& y) {
+    return x.lengths_ == y.lengths_ && x.data_ == y.data_;
+  }
+  friend bool operator!=(
+      const compact_string_tape& x, const compact_string_tape& y) {
+    return !(x == y);
+  }
+
+ private:
+  struct block {
+    std::size_t data; // offset of the block's first record in data_
+    uint32_t lengths; // offset of its length in lengths_
+  };
+
+  std::vector<block> blocks_;
+  std::string lengths_;
+  std::string data_;
+  size_type size_ = 0;
+};
+
+// Forward iterator that decodes lengths incrementally.
+class compact_string_tape::const_iterator {
+ public:
+  using value_type = StringPiece;
+  using reference = StringPiece;
+  using pointer = const StringPiece*;
+  using difference_type = std::ptrdiff_t;
+  using iterator_category = std::forward_iterator_tag;
+
+  const_iterator() = default;
+
+  reference operator*() const noexcept { return current_; }
+  pointer operator->() const noexcept { return &current_; }
+
+  const_iterator& operator++() noexcept {
+    ++index_;
+    decode();
+    return *this;
+  }
+  const_iterator operator++(int) noexcept {
+    auto copy = *this;
+    ++*this;
+    return copy;
+  }
+
+  [[nodiscard]] size_type get_index() const noexcept { return index_; }
+
+  friend bool operator==(
+      const const_iterator& x, const const_iterator& y) noexcept {
+    return x.index_ == y.index_;
+  }
+  friend bool operator!=(
+      const const_iterator& x, const const_iterator& y) noexcept {
+    return !(x == y);
+  }
+
+ private:
+  friend class compact_string_tape;
+
+  const_iterator(const compact_string_tape& self, size_type index) noexcept
+      : self_(&self),
+        index_(index),
+        lengths_(
+            reinterpret_cast<const uint8_t*>(self.lengths_.data()),
+            self.lengths_.size()),
+        current_(self.data_.data(), std::size_t(0)) {
+    decode();
+  }
+
+  void decode() noexcept {
+    if (index_ >= self_->size_) {
+      return;
+    }
+    auto length = decodeVarint(lengths_);
+    current_ = {current_.end(), length};
+  }
+
+  const compact_string_tape* self_ = nullptr;
+  size_type index_ = 0;
+  ByteRange lengths_;
+  StringPiece current_;
+};
+
+inline auto compact_string_tape::begin() const noexcept -> const_iterator {
+  return const_iterator{*this, 0};
+}
+
+inline auto compact_string_tape::end() const noexcept -> const_iterator {
+  const_iterator it;
+  it.index_ = size_;
+  return it;
+}
+
+inline auto compact_string_tape::cbegin() const noexcept -> const_iterator {
+  return begin();
+}
+
+inline auto compact_string_tape::cend() const noexcept -> const_iterator {
+  return end();
+}
+
+} // namespace folly
@@ -579,6 +579,31 @@ class F14BasicMap : public std::unordered_map<K, M, H, E, A> {
 
   void prefetch(F14HashToken const&) const {}
 
+  template <typename FwdIt, typename OutIt>
+  OutIt findBatch(FwdIt first, FwdIt last, OutIt out) {
+    for (; first != last; ++first, ++out) {
+      *out = find(*first);
+    }
+    return out;
+  }
+
+  template <typename FwdIt, typename OutIt>
+  OutIt findBatch(FwdIt first, FwdIt last, OutIt out) const {
+    for (; first != last; ++first, ++out) {
+      *out = find(*first);
+    }
+    return out;
+  }
+
+  template <typename FwdIt>
+  std::size_t insertBatch(FwdIt first, FwdIt last) {
+    std::size_t inserted = 0;
+    for (; first != last; ++first) {
+      inserted += this->insert(*first).second;
+    }
+    return inserted;
+  }
+
   iterator find(F14HashToken const&, key_type const& key) { return find(key); }
 
   const_iterator find(F14HashToken const&, key_type const& key) const {
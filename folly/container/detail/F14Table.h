@@ -48,6 +48,7 @@
 #include <folly/container/detail/F14Defaults.h>
 #include <folly/container/detail/F14IntrinsicsAvailability.h>
 #include <folly/container/detail/F14Mask.h>
+#include <folly/hash/HashBatch.h>
 
 #if FOLLY_F14_VECTOR_INTRINSICS_AVAILABLE
 
@@ -1595,6 +1596,56 @@ class F14Table : public Policy {
     return findImpl(static_cast<HashPair>(token), key, Prefetch::DISABLED);
   }
 
+  // Looks up each key in [first, last), calling func(ItemIter) for
+  // each of them in order.  The keys are processed in blocks: the hashes
+  // of all keys in a block are computed and the first chunk of each probe
+  // sequence is prefetched before any of them is searched, so that the
+  // cache misses of a block overlap instead of being paid one at a time.
+  // This is the loop pipelining that prehash() and prefetch() enable,
+  // applied to a whole batch.
+  static constexpr std::size_t kBatchBlockSize = 16;
+
+  // folly::hasher of a 32- or 64-bit integer is what hash::hash_batch()
+  // computes, so the hashes of a block of such keys are mixed together.
+  template <typename FwdIt, typename Key = typename Policy::Key>
+  static constexpr bool kBatchHashable = std::is_integral<Key>::value &&
+      (sizeof(Key) == 4 || sizeof(Key) == 8) &&
+      std::is_same<Hasher, folly::hasher<Key>>::value &&
+      std::is_same<remove_cvref_t<decltype(*std::declval<FwdIt&>())>, Key>::
+          value;
+
+  template <typename FwdIt, typename F>
+  void findBatch(FwdIt first, FwdIt last, F&& func) const {
+    HashPair hps[kBatchBlockSize];
+    while (first != last) {
+      FwdIt blockFirst = first;
+      std::size_t n = 0;
+      if constexpr (kBatchHashable<FwdIt>) {
+        using Word = std::conditional_t<
+            sizeof(typename Policy::Key) == 8,
+            uint64_t,
+            uint32_t>;
+        Word words[kBatchBlockSize];
+        for (; n < kBatchBlockSize && first != last; ++n, ++first) {
+          words[n] = static_cast<Word>(*first);
+        }
+        hash::hash_batch(range(words, words + n), range(words, words + n));
+        for (std::size_t i = 0; i < n; ++i) {
+          hps[i] = splitHash(words[i]);
+          prefetchAddr(chunks_ + moduloByChunkCount(hps[i].first));
+        }
+      } else {
+        for (; n < kBatchBlockSize && first != last; ++n, ++first) {
+          hps[n] = splitHash(this->computeKeyHash(*first));
+          prefetchAddr(chunks_ + moduloByChunkCount(hps[n].first));
+        }
+      }
+      for (std::size_t i = 0; i < n; ++i, ++blockFirst) {
+        func(findImpl(hps[i], *blockFirst, Prefetch::ENABLED));
+      }
+    }
+  }
+
   // Searches for a key using a key predicate that is a refinement
   // of key equality.  func(k) should return true only if k is equal
   // to key according to key_eq(), but is allowed to apply additional
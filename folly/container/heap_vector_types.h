@@ -54,6 +54,10 @@
  * penalty while using heap lookup search the branch can be avoided by using
  * cmov instruction. We observerd look up operations are up to 2X faster than
  * sorted_vector_map.
+ * 3. Descendants a few levels down are contiguous, so lookups in containers
+ * too large for the CPU caches prefetch the cache line they will reach a few
+ * steps later. The layout is still one element per node: there is no
+ * block layout with SIMD compares.
  *
  * However, Insertion/deletion operations are much slower. If insertions and
  * deletions are rare operations for your use case then heap containers might
@@ -100,6 +104,7 @@
 #include <folly/Utility.h>
 #include <folly/container/Iterator.h>
 #include <folly/functional/Invoke.h>
+#include <folly/lang/Align.h>
 #include <folly/lang/Exception.h>
 #include <folly/memory/MemoryResource.h>
 #include <folly/portability/Builtins.h>
@@ -466,15 +471,47 @@ size_type erase(size_type offset, Container& cont) {
   return offset;
 }
 
+// In heap order the 2^L descendants that are L levels below the element at
+// offset are stored contiguously, starting at offset (offset + 1) * 2^L - 1.
+// Picking L so that they fill one cache line, a search can prefetch the line
+// it will reach L levels later, which hides most of the memory latency of
+// the descent once the container no longer fits in the CPU caches.
+template <typename T>
+constexpr std::size_t heapPrefetchLevels() {
+  std::size_t levels = 0;
+  while ((std::size_t(2) << levels) * sizeof(T) <=
+         hardware_constructive_interference_size) {
+    ++levels;
+  }
+  return levels;
+}
+
+// Containers smaller than this are assumed to be cache resident, where the
+// prefetches would only cost instructions.
+constexpr std::size_t kHeapPrefetchMinBytes = std::size_t(1) << 18;
+
+template <typename Container>
+FOLLY_ALWAYS_INLINE void heapPrefetchDescendants(
+    Container& cont, typename Container::size_type offset) {
+  constexpr auto kLevels = heapPrefetchLevels<typename Container::value_type>();
+  auto target = ((offset + 1) << kLevels) - 1;
+  if (target < cont.size()) {
+    __builtin_prefetch(static_cast<void const*>(&cont[target]));
+  }
+}
+
 // Search lower bound in a container sorted in heap order.
 // To speed up lower_bound for small containers, peel four iterations and use
 // reverse compare to exit quickly.
 // The branch inside the loop is converted to a cmov by the compiler. cmov are
 // more efficient when the branch is unpredictable.
+// Large containers prefetch the elements a few levels ahead of the search,
+// see heapPrefetchDescendants.
 template <typename Compare, typename RCompare, typename Container>
 typename Container::size_type lower_bound(
     Container& cont, Compare cmp, RCompare reverseCmp) {
   using size_type = typename Container::size_type;
+  using value_type = typename Container::value_type;
   size_type size = cont.size();
   auto last = size;
   size_type offset = 0;
@@ -518,6 +555,18 @@ typename Container::size_type lower_bound(
             last = offset;
             offset = 2 * offset + 1;
           }
+          if (heapPrefetchLevels<value_type>() > 1 &&
+              size * sizeof(value_type) >= kHeapPrefetchMinBytes) {
+            for (; offset < size; offset++) {
+              heapPrefetchDescendants(cont, offset);
+              if (cmp(cont[offset])) {
+                offset = 2 * offset + 1;
+              } else {
+                last = offset;
+                offset = 2 * offset;
+              }
+            }
+          }
           for (; offset < size; offset++) {
             if (cmp(cont[offset])) {
               offset = 2 * offset + 1;
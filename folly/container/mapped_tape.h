@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/Likely.h>
+#include <folly/Range.h>
+#include <folly/container/Iterator.h>
+#include <folly/container/tape.h>
+#include <folly/lang/Bits.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace folly {
+
+/* # mapped_string_tape
+ *
+ * A read-only `string_tape` over a flat byte image, typically a file mapped
+ * with folly::MemoryMapping. Nothing is copied or parsed on open: records are
+ * sliced out of the image on access.
+ *
+ * Image format (all integers little-endian uint64):
+ *
+ *   [magic "FTAPE\0\0\1"][record count n][markers 0..n][data]
+ *
+ * where record i spans data[markers[i], markers[i + 1]). Markers need not be
+ * aligned. Produce an image with `mapped_string_tape::serialize()`.
+ *
+ * The constructor validates the header and the total size. Individual markers
+ * are trusted (checking them would touch every page of a large mapping); use
+ * `validate()` for images from untrusted sources.
+ */
+class mapped_string_tape {
+ public:
+  using value_type = StringPiece;
+  using reference = StringPiece;
+  using const_reference = StringPiece;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  using iterator = folly::index_iterator<const mapped_string_tape>;
+  using const_iterator = iterator;
+
+  static constexpr char kMagic[8] = {'F', 'T', 'A', 'P', 'E', 0, 0, 1};
+  static constexpr std::size_t kHeaderSize = 16;
+
+  mapped_string_tape() = default;
+
+  // Throws std::invalid_argument if the image is malformed.
+  explicit mapped_string_tape(ByteRange image) {
+    if (image.size() < kHeaderSize + sizeof(uint64_t) ||
+        std::memcmp(image.data(), kMagic, sizeof(kMagic)) != 0) {
+      throw std::invalid_argument("mapped_string_tape: bad header");
+    }
+    auto n = load(image.data() + sizeof(kMagic));
+    auto markersSize = image.size() - kHeaderSize;
+    if (n >= markersSize / sizeof(uint64_t)) {
+      throw std::invalid_argument("mapped_string_tape: truncated markers");
+    }
+    size_ = static_cast<size_type>(n);
+    markers_ = image.data() + kHeaderSize;
+    data_ = markers_ + (size_ + 1) * sizeof(uint64_t);
+    auto dataSize = static_cast<std::size_t>(image.end() - data_);
+    if (marker(0) != 0 || marker(size_) > dataSize) {
+      throw std::invalid_argument("mapped_string_tape: truncated data");
+    }
+  }
+
+  explicit mapped_string_tape(StringPiece image)
+      : mapped_string_tape(ByteRange(image)) {}
+
+  // Checks that every marker is in order and in bounds.
+  [[nodiscard]] bool validate() const noexcept {
+    for (size_type i = 0; i < size_; ++i) {
+      if (marker(i) > marker(i + 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // access ------
+
+  [[nodiscard]] const_reference operator[](size_type i) const noexcept {
+    auto b = marker(i);
+    auto e = marker(i + 1);
+    return {reinterpret_cast<const char*>(data_) + b, e - b};
+  }
+
+  [[nodiscard]] const_reference at(size_type i) const {
+    if (FOLLY_UNLIKELY(i >= size())) {
+      throw std::out_of_range("mapped_string_tape");
+    }
+    return operator[](i);
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+  [[nodiscard]] size_type size() const noexcept { return size_; }
+  [[nodiscard]] size_type size_flat() const noexcept {
+    return size_ == 0 ? 0 : marker(size_);
+  }
+
+  [[nodiscard]] const_reference front() const noexcept { return (*this)[0]; }
+  [[nodiscard]] const_reference back() const noexcept {
+    return (*this)[size_ - 1];
+  }
+
+  [[nodiscard]] StringPiece scalars() const noexcept {
+    return {reinterpret_cast<const char*>(data_), size_flat()};
+  }
+
+  // iterators ----
+
+  [[nodiscard]] const_iterator begin() const noexcept { return {*this, 0}; }
+  [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+  [[nodiscard]] const_iterator end() const noexcept { return {*this, size()}; }
+  [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+  // serialization ------
+
+  // Appends the image of `tape` to `out`.
+  static void serialize(const string_tape& tape, std::string& out) {
+    auto markers = tape.markers();
+    out.reserve(
+        out.size() + kHeaderSize + markers.size() * sizeof(uint64_t) +
+        tape.size_flat());
+    out.append(kMagic, sizeof(kMagic));
+    store(out, tape.size());
+    for (auto m : markers) {
+      store(out, static_cast<uint64_t>(m));
+    }
+    auto scalars = tape.scalars();
+    out.append(scalars.data(), scalars.size());
+  }
+
+  [[nodiscard]] static std::string serialize(const string_tape& tape) {
+    std::string out;
+    serialize(tape, out);
+    return out;
+  }
+
+ private:
+  static uint64_t load(const uint8_t* p) noexcept {
+    return Endian::little(loadUnaligned<uint64_t>(p));
+  }
+
+  static void store(std::string& out, uint64_t v) {
+    v = Endian::little(v);
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+  }
+
+  std::size_t marker(size_type i) const noexcept {
+    return static_cast<std::size_t>(load(markers_ + i * sizeof(uint64_t)));
+  }
+
+  const uint8_t* markers_ = nullptr;
+  const uint8_t* data_ = nullptr;
+  size_type size_ = 0;
+};
+
+} // namespace folly
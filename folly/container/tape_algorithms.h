@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/container/tape.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace folly {
+
+/* # tape algorithms
+ *
+ * Sorting and reordering helpers for tapes. Records on a tape cannot be
+ * swapped in place, so sorting works on a permutation of record indexes which
+ * is then applied in one pass that rebuilds the tape contiguously.
+ *
+ *   auto perm = tape_sort_permutation(t);   // t[perm[0]] <= t[perm[1]] ...
+ *   t = tape_permute(t, perm);
+ */
+
+// Returns a tape whose i-th record is `t[perm[i]]`. `perm` may repeat or omit
+// indexes, so this also implements gather/select.
+template <typename Tape, typename Perm>
+[[nodiscard]] Tape tape_permute(const Tape& t, const Perm& perm) {
+  std::size_t flat = 0;
+  for (auto i : perm) {
+    flat += t[i].size();
+  }
+  Tape res;
+  res.reserve(std::size(perm), flat);
+  for (auto i : perm) {
+    res.push_back_unsafe(t[i]);
+  }
+  return res;
+}
+
+namespace detail {
+
+template <typename Tape>
+constexpr bool tape_has_byte_scalars_v =
+    sizeof(typename Tape::scalar_value_type) == 1 &&
+    std::is_integral_v<typename Tape::scalar_value_type>;
+
+// Stable MSD radix sort of record indexes, one byte per pass. Records are
+// ordered as unsigned bytes (memcmp order), with a record ordering before
+// all of its extensions. Small buckets fall back to a comparison sort.
+template <typename Tape>
+void tape_radix_sort_indexes(const Tape& t, std::vector<std::size_t>& idx) {
+  constexpr std::size_t kSmall = 32;
+
+  auto byte_at = [&](std::size_t record, std::size_t depth) -> std::size_t {
+    auto r = t[record];
+    return depth < r.size()
+        ? static_cast<unsigned char>(r.begin()[depth]) + 1
+        : 0;
+  };
+
+  auto less_from = [&](std::size_t depth) {
+    return [&t, depth](std::size_t a, std::size_t b) {
+      auto ra = t[a];
+      auto rb = t[b];
+      auto la = ra.size() - std::min(depth, ra.size());
+      auto lb = rb.size() - std::min(depth, rb.size());
+      auto n = std::min(la, lb);
+      int c = n == 0
+          ? 0
+          : std::memcmp(&ra.begin()[depth], &rb.begin()[depth], n);
+      return c < 0 || (c == 0 && la < lb);
+    };
+  };
+
+  struct task {
+    std::size_t begin;
+    std::size_t end;
+    std::size_t depth;
+  };
+
+  std::vector<std::size_t> tmp(idx.size());
+  std::vector<task> stack{{0, idx.size(), 0}};
+  while (!stack.empty()) {
+    auto [b, e, depth] = stack.back();
+    stack.pop_back();
+
+    if (e - b <= kSmall) {
+      std::stable_sort(idx.begin() + b, idx.begin() + e, less_from(depth));
+      continue;
+    }
+
+    // bucket 0: records that end at this depth; bucket c + 1: byte c.
+    std::array<std::size_t, 258> offsets{};
+    for (auto i = b; i != e; ++i) {
+      ++offsets[byte_at(idx[i], depth) + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    for (auto i = b; i != e; ++i) {
+      tmp[b + offsets[byte_at(idx[i], depth)]++] = idx[i];
+    }
+    std::copy(tmp.begin() + b, tmp.begin() + e, idx.begin() + b);
+
+    // offsets[c] now holds the end of bucket c. Records that ended are done.
+    for (std::size_t c = 1; c != 257; ++c) {
+      auto cb = b + offsets[c - 1];
+      auto ce = b + offsets[c];
+      if (ce - cb > 1) {
+        stack.push_back({cb, ce, depth + 1});
+      }
+    }
+  }
+}
+
+} // namespace detail
+
+// Returns the permutation that sorts the records of `t`. The sort is stable.
+// For tapes of bytes (e.g. string_tape) this is an MSD radix sort and
+// records compare as unsigned bytes, like std::string and StringPiece;
+// otherwise records compare lexicographically with `operator<`.
+template <typename Tape>
+[[nodiscard]] std::vector<std::size_t> tape_sort_permutation(const Tape& t) {
+  std::vector<std::size_t> idx(t.size());
+  std::iota(idx.begin(), idx.end(), std::size_t(0));
+  if constexpr (detail::tape_has_byte_scalars_v<Tape>) {
+    detail::tape_radix_sort_indexes(t, idx);
+  } else {
+    std::stable_sort(idx.begin(), idx.end(), [&](std::size_t a, std::size_t b) {
+      auto ra = t[a];
+      auto rb = t[b];
+      return std::lexicographical_compare(
+          ra.begin(), ra.end(), rb.begin(), rb.end());
+    });
+  }
+  return idx;
+}
+
+// Sorts the records of `t`, see tape_sort_permutation().
+template <typename Tape>
+void tape_sort(Tape& t) {
+  t = tape_permute(t, tape_sort_permutation(t));
+}
+
+} // namespace folly
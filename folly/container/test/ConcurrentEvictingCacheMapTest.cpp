@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/ConcurrentEvictingCacheMap.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+// A single shard makes eviction order globally LRU.
+using SingleShardMap = ConcurrentEvictingCacheMap<
+    int,
+    int,
+    HeterogeneousAccessHash<int>,
+    HeterogeneousAccessEqualTo<int>,
+    0>;
+} // namespace
+
+TEST(ConcurrentEvictingCacheMap, SanityTest) {
+  ConcurrentEvictingCacheMap<int, int> map(0);
+
+  EXPECT_EQ(0, map.size());
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.exists(1));
+  EXPECT_FALSE(map.get(1).has_value());
+
+  map.set(1, 1);
+  EXPECT_EQ(1, map.size());
+  EXPECT_FALSE(map.empty());
+  EXPECT_TRUE(map.exists(1));
+  EXPECT_EQ(1, *map.get(1));
+
+  map.set(1, 2);
+  EXPECT_EQ(1, map.size());
+  EXPECT_EQ(2, *map.get(1));
+  EXPECT_EQ(2, *map.getWithoutPromotion(1));
+
+  EXPECT_FALSE(map.insert(1, 3));
+  EXPECT_EQ(2, *map.get(1));
+  EXPECT_TRUE(map.insert(2, 3));
+  EXPECT_EQ(2, map.size());
+  EXPECT_EQ(3, *map.get(2));
+
+  EXPECT_TRUE(map.erase(1));
+  EXPECT_FALSE(map.erase(1));
+  EXPECT_EQ(1, map.size());
+  EXPECT_FALSE(map.exists(1));
+
+  map.clear();
+  EXPECT_EQ(0, map.size());
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(ConcurrentEvictingCacheMap, Eviction) {
+  using Map = ConcurrentEvictingCacheMap<int, int>;
+  constexpr std::size_t kPerShard = 4;
+  Map map(kPerShard * Map::NumShards);
+
+  for (int i = 0; i < 1000; ++i) {
+    map.set(i, i);
+  }
+  EXPECT_LE(map.size(), kPerShard * Map::NumShards);
+  // Most recent insert is always kept.
+  EXPECT_EQ(999, *map.get(999));
+}
+
+TEST(ConcurrentEvictingCacheMap, PruneHook) {
+  SingleShardMap map(2);
+  std::vector<int> pruned;
+  map.setPruneHook([&](int key, int&&) { pruned.push_back(key); });
+
+  map.set(1, 1);
+  map.set(2, 2);
+  map.set(3, 3);
+  ASSERT_EQ(1, pruned.size());
+  EXPECT_EQ(1, pruned[0]);
+
+  map.setMaxSize(1);
+  EXPECT_EQ(1, map.size());
+  EXPECT_TRUE(map.exists(3));
+}
+
+TEST(ConcurrentEvictingCacheMap, BufferedPromotion) {
+  SingleShardMap map(3, 1, /* promotionBatchSize */ 1000);
+
+  map.set(1, 1);
+  map.set(2, 2);
+  map.set(3, 3);
+  // Promotion is buffered, but must be applied before the eviction below.
+  EXPECT_EQ(1, *map.get(1));
+  map.set(4, 4);
+  EXPECT_TRUE(map.exists(1));
+  EXPECT_FALSE(map.exists(2));
+  EXPECT_TRUE(map.exists(3));
+  EXPECT_TRUE(map.exists(4));
+}
+
+TEST(ConcurrentEvictingCacheMap, UnbufferedPromotion) {
+  SingleShardMap map(3, 1, /* promotionBatchSize */ 0);
+
+  map.set(1, 1);
+  map.set(2, 2);
+  map.set(3, 3);
+  EXPECT_EQ(1, *map.get(1));
+  map.set(4, 4);
+  EXPECT_TRUE(map.exists(1));
+  EXPECT_FALSE(map.exists(2));
+}
+
+TEST(ConcurrentEvictingCacheMap, StringKeys) {
+  ConcurrentEvictingCacheMap<std::string, std::string> map(100);
+  map.set("foo", "bar");
+  EXPECT_EQ("bar", *map.get("foo"));
+  EXPECT_FALSE(map.get("baz").has_value());
+}
+
+TEST(ConcurrentEvictingCacheMap, MultiThreaded) {
+  constexpr int kThreads = 8;
+  constexpr int kOps = 10000;
+  constexpr int kKeys = 512;
+  ConcurrentEvictingCacheMap<int, int> map(256, 1, 8);
+  std::atomic<std::size_t> pruned{0};
+  map.setPruneHook([&](int, int&&) { ++pruned; });
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kOps; ++i) {
+        int key = (i * 7 + t) % kKeys;
+        if (i % 4 == 0) {
+          map.set(key, key);
+        } else if (auto v = map.get(key)) {
+          EXPECT_EQ(key, *v);
+        }
+        if (i % 1000 == 0) {
+          map.erase(key);
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  map.flushPromotions();
+  EXPECT_LE(map.size(), 256);
+  EXPECT_GT(pruned.load(), 0);
+}
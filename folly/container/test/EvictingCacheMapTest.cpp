@@ -832,3 +832,139 @@ TEST(EvictingCacheMap, ApproximateEntryMemUsage) {
            kApproximateEntryMemUsage),
       48U);
 }
+
+TEST(EvictingCacheMap, ClockEvictionPolicy) {
+  using Map = EvictingCacheMap<
+      int,
+      int,
+      HeterogeneousAccessHash<int>,
+      HeterogeneousAccessEqualTo<int>,
+      ClockEvictionPolicy>;
+  Map map(3);
+  map.set(1, 1);
+  map.set(2, 2);
+  map.set(3, 3);
+
+  // Hits don't reorder the list
+  EXPECT_EQ(1, map.get(1));
+  EXPECT_EQ(3, map.begin()->first);
+  EXPECT_EQ(1, map.rbegin()->first);
+
+  // 1 gets a second chance, 2 is evicted
+  map.set(4, 4);
+  EXPECT_TRUE(map.exists(1));
+  EXPECT_FALSE(map.exists(2));
+  EXPECT_TRUE(map.exists(3));
+  EXPECT_TRUE(map.exists(4));
+
+  // The new entry is never evicted by its own insertion
+  for (auto& kv : map) {
+    map.find(kv.first);
+  }
+  auto res = map.insert(5, 5);
+  EXPECT_TRUE(res.second);
+  EXPECT_EQ(5, res.first->second);
+  EXPECT_EQ(3, map.size());
+
+  map.erase(5);
+  map.clear();
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(EvictingCacheMap, S3FifoEvictionPolicyScanResistance) {
+  using Map = EvictingCacheMap<
+      int,
+      int,
+      HeterogeneousAccessHash<int>,
+      HeterogeneousAccessEqualTo<int>,
+      S3FifoEvictionPolicy>;
+  using LruMap = EvictingCacheMap<int, int>;
+  Map map(10);
+  LruMap lruMap(10);
+
+  for (int i = 0; i < 8; i++) {
+    map.set(i, i);
+    lruMap.set(i, i);
+  }
+  for (int i = 0; i < 8; i++) {
+    EXPECT_EQ(i, map.get(i));
+    EXPECT_EQ(i, lruMap.get(i));
+  }
+  // One-hit wonders are evicted from the small queue
+  for (int i = 100; i < 200; i++) {
+    map.set(i, i);
+    lruMap.set(i, i);
+    EXPECT_TRUE(map.exists(i));
+  }
+  EXPECT_EQ(10, map.size());
+  for (int i = 0; i < 8; i++) {
+    EXPECT_TRUE(map.exists(i));
+    EXPECT_FALSE(lruMap.exists(i));
+  }
+}
+
+TEST(EvictingCacheMap, S3FifoEvictionPolicyPromotionResetsFreq) {
+  using Map = EvictingCacheMap<
+      int,
+      int,
+      HeterogeneousAccessHash<int>,
+      HeterogeneousAccessEqualTo<int>,
+      S3FifoEvictionPolicy>;
+  Map map(3);
+  for (int i = 0; i < 4; i++) {
+    map.set(i, i);
+  }
+  // 0 is admitted into the main queue from the ghost queue, evicting 1
+  map.set(0, 0);
+  EXPECT_FALSE(map.exists(1));
+  EXPECT_EQ(0, map.get(0));
+  EXPECT_EQ(2, map.get(2));
+  EXPECT_EQ(3, map.get(3));
+
+  // 2 and 3 are promoted to the main queue. The hit that promoted them
+  // does not count there, so 2 goes before 0, which was hit in main.
+  map.set(4, 4);
+  EXPECT_TRUE(map.exists(0));
+  EXPECT_FALSE(map.exists(2));
+  EXPECT_TRUE(map.exists(3));
+  EXPECT_TRUE(map.exists(4));
+}
+
+TEST(EvictingCacheMap, S3FifoEvictionPolicyGhost) {
+  using Map = EvictingCacheMap<
+      int,
+      int,
+      HeterogeneousAccessHash<int>,
+      HeterogeneousAccessEqualTo<int>,
+      S3FifoEvictionPolicy>;
+  Map map(10);
+  for (int i = 0; i <= 10; i++) {
+    map.set(i, i);
+  }
+  EXPECT_FALSE(map.exists(0));
+
+  // Recently evicted from the small queue, so admitted into the main queue
+  map.set(0, 0);
+  for (int i = 100; i < 150; i++) {
+    map.set(i, i);
+  }
+  EXPECT_TRUE(map.exists(0));
+  EXPECT_FALSE(map.exists(1));
+
+  // Erase from both queues
+  EXPECT_TRUE(map.erase(0));
+  EXPECT_TRUE(map.erase(149));
+  EXPECT_EQ(8, map.size());
+  for (int i = 200; i < 220; i++) {
+    map.set(i, i);
+    EXPECT_EQ(i, map.get(i));
+  }
+  EXPECT_EQ(10, map.size());
+
+  Map moved = std::move(map);
+  EXPECT_EQ(10, moved.size());
+  moved.setMaxSize(1);
+  EXPECT_EQ(1, moved.size());
+  moved.clear();
+  EXPECT_TRUE(moved.empty());
+}
@@ -18,6 +18,8 @@
 
 #include <algorithm>
 #include <chrono>
+#include <iterator>
+#include <list>
 #include <random>
 #include <string>
 #include <type_traits>
@@ -205,6 +207,92 @@ TEST(F14FastMap, visitContiguousRanges) {
   runVisitContiguousRangesTest<F14FastMap<int, int>>();
 }
 
+template <typename M>
+void runBatchTest() {
+  M m;
+  std::vector<std::pair<std::string, int>> values;
+  for (int i = 0; i < 1000; ++i) {
+    values.emplace_back(folly::to<std::string>(i), i);
+  }
+  // duplicates are not inserted and keep the first value
+  values.emplace_back("7", -1);
+  EXPECT_EQ(1000, m.insertBatch(values.begin(), values.end()));
+  EXPECT_EQ(1000, m.size());
+  EXPECT_EQ(7, m.at("7"));
+
+  std::list<std::string> keys;
+  for (int i = 0; i < 1100; i += 3) {
+    keys.push_back(folly::to<std::string>(i));
+  }
+  std::vector<typename M::iterator> found;
+  m.findBatch(keys.begin(), keys.end(), std::back_inserter(found));
+  ASSERT_EQ(keys.size(), found.size());
+  auto k = keys.begin();
+  for (std::size_t i = 0; i < found.size(); ++i, ++k) {
+    auto expected = m.find(*k);
+    EXPECT_TRUE(found[i] == expected);
+    if (expected != m.end()) {
+      EXPECT_EQ(*k, found[i]->first);
+    }
+  }
+
+  M const& cm = m;
+  std::vector<typename M::const_iterator> cfound(keys.size());
+  auto end = cm.findBatch(keys.begin(), keys.end(), cfound.begin());
+  EXPECT_TRUE(end == cfound.end());
+  EXPECT_TRUE(cfound.back() == cm.find(keys.back()));
+
+  std::vector<std::pair<std::string, int>> more{{"a", 1}, {"b", 2}};
+  EXPECT_EQ(
+      2,
+      m.insertBatch(
+          std::make_move_iterator(more.begin()),
+          std::make_move_iterator(more.end())));
+  EXPECT_EQ(2, m.at("b"));
+}
+
+TEST(F14ValueMap, batch) {
+  runBatchTest<F14ValueMap<std::string, int>>();
+}
+
+TEST(F14NodeMap, batch) {
+  runBatchTest<F14NodeMap<std::string, int>>();
+}
+
+TEST(F14VectorMap, batch) {
+  runBatchTest<F14VectorMap<std::string, int>>();
+}
+
+TEST(F14FastMap, batch) {
+  runBatchTest<F14FastMap<std::string, int>>();
+}
+
+template <typename K>
+void runIntegralBatchTest() {
+  // findBatch hashes these keys with hash::hash_batch().
+  F14FastMap<K, int, folly::hasher<K>> m;
+  for (int i = 0; i < 1000; ++i) {
+    m.emplace(static_cast<K>(i * 7), i);
+  }
+  std::vector<K> keys;
+  for (int i = -50; i < 8000; i += 3) {
+    keys.push_back(static_cast<K>(i));
+  }
+  std::vector<typename decltype(m)::iterator> found;
+  m.findBatch(keys.begin(), keys.end(), std::back_inserter(found));
+  ASSERT_EQ(keys.size(), found.size());
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_TRUE(found[i] == m.find(keys[i]));
+  }
+}
+
+TEST(F14FastMap, integralBatch) {
+  runIntegralBatchTest<uint64_t>();
+  runIntegralBatchTest<int64_t>();
+  runIntegralBatchTest<uint32_t>();
+  runIntegralBatchTest<int32_t>();
+}
+
 #if FOLLY_HAS_MEMORY_RESOURCE
 TEST(F14Map, pmrEmpty) {
   pmr::F14ValueMap<int, int> m1;
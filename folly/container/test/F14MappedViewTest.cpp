@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/F14MappedView.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/container/F14Map.h>
+#include <folly/experimental/TestUtil.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+template <typename Map>
+F14MappedView<typename Map::mapped_type> writeAndMap(
+    test::TemporaryFile& file, Map const& map, uint64_t seed = 0) {
+  writeF14MappedView(file.fd(), map, seed);
+  return F14MappedView<typename Map::mapped_type>(
+      file.path().string().c_str());
+}
+} // namespace
+
+TEST(F14MappedView, empty) {
+  test::TemporaryFile file;
+  auto view = writeAndMap(file, F14FastMap<std::string, uint64_t>{});
+  EXPECT_TRUE(view.empty());
+  EXPECT_EQ(0, view.size());
+  EXPECT_EQ(nullptr, view.find("abc"));
+  EXPECT_EQ(nullptr, view.find(""));
+}
+
+TEST(F14MappedView, findAll) {
+  F14FastMap<std::string, uint64_t> map;
+  for (uint64_t i = 0; i < 10000; ++i) {
+    map[to<std::string>("key", i)] = i * 3;
+  }
+  map[""] = 42;
+
+  test::TemporaryFile file;
+  auto view = writeAndMap(file, map, /* seed */ 12345);
+  EXPECT_EQ(map.size(), view.size());
+  for (auto const& [key, value] : map) {
+    auto* found = view.find(key);
+    ASSERT_NE(nullptr, found) << key;
+    EXPECT_EQ(value, *found);
+  }
+  for (uint64_t i = 10000; i < 20000; ++i) {
+    EXPECT_FALSE(view.contains(to<std::string>("key", i)));
+  }
+}
+
+TEST(F14MappedView, manySizes) {
+  // Small tables are the most likely to have full chunks, exercising the
+  // overflow probing.
+  for (uint32_t n = 1; n < 100; ++n) {
+    std::vector<std::pair<std::string, uint32_t>> entries;
+    for (uint32_t i = 0; i < n; ++i) {
+      entries.emplace_back(std::string(i, 'x'), i);
+    }
+    test::TemporaryFile file;
+    writeF14MappedView(file.fd(), entries);
+    F14MappedView<uint32_t> view(file.path().string().c_str());
+    EXPECT_EQ(n, view.size());
+    for (auto const& [key, value] : entries) {
+      auto* found = view.find(key);
+      ASSERT_NE(nullptr, found) << n << " " << key.size();
+      EXPECT_EQ(value, *found);
+    }
+    EXPECT_EQ(nullptr, view.find(std::string(n, 'x')));
+  }
+}
+
+TEST(F14MappedView, structValue) {
+  struct Value {
+    uint32_t a;
+    double b;
+  };
+  F14FastMap<std::string, Value> map{{"one", {1, 1.5}}, {"two", {2, 2.5}}};
+  test::TemporaryFile file;
+  writeF14MappedView(file.fd(), map);
+  F14MappedView<Value> view(MemoryMapping(file.path().string().c_str()));
+  ASSERT_TRUE(view.contains("two"));
+  EXPECT_EQ(2, view.find("two")->a);
+  EXPECT_EQ(2.5, view.find("two")->b);
+}
+
+TEST(F14MappedView, rejectsBadFiles) {
+  test::TemporaryFile file;
+  writeF14MappedView(file.fd(), F14FastMap<std::string, uint64_t>{{"a", 1}});
+  auto path = file.path().string();
+  EXPECT_THROW(F14MappedView<uint32_t>(path.c_str()), std::runtime_error);
+
+  std::string contents;
+  ASSERT_TRUE(readFile(path.c_str(), contents));
+  contents[0] ^= 1;
+  test::TemporaryFile corrupt;
+  ASSERT_TRUE(writeFull(corrupt.fd(), contents.data(), contents.size()) > 0);
+  EXPECT_THROW(
+      F14MappedView<uint64_t>(corrupt.path().string().c_str()),
+      std::runtime_error);
+
+  test::TemporaryFile truncated;
+  ASSERT_TRUE(writeFull(truncated.fd(), contents.data(), 10) > 0);
+  EXPECT_THROW(
+      F14MappedView<uint64_t>(truncated.path().string().c_str()),
+      std::runtime_error);
+}
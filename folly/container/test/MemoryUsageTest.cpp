@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/MemoryUsage.h>
+
+#include <string>
+
+#include <folly/FBVector.h>
+#include <folly/concurrency/ConcurrentHashMap.h>
+#include <folly/container/EvictingCacheMap.h>
+#include <folly/container/F14Map.h>
+#include <folly/portability/GTest.h>
+#include <folly/small_vector.h>
+#include <folly/synchronization/Hazptr.h>
+
+namespace {
+
+template <typename C>
+std::size_t visitedBytes(C const& c) {
+  std::size_t bytes = 0;
+  folly::visitMemoryUsage(
+      c, [&](std::size_t size, std::size_t count) { bytes += size * count; });
+  return bytes;
+}
+
+} // namespace
+
+TEST(MemoryUsage, F14) {
+  folly::F14NodeMap<int, std::string> map;
+  EXPECT_EQ(0, folly::memoryUsage(map));
+  for (int i = 0; i < 100; ++i) {
+    map[i];
+  }
+  EXPECT_EQ(map.getAllocatedMemorySize(), folly::memoryUsage(map));
+  EXPECT_GE(folly::memoryUsage(map), 100 * sizeof(std::pair<int, std::string>));
+}
+
+TEST(MemoryUsage, FBVector) {
+  folly::fbvector<int64_t> vec;
+  EXPECT_EQ(0, folly::memoryUsage(vec));
+  vec.resize(100);
+  EXPECT_EQ(vec.capacity() * sizeof(int64_t), folly::memoryUsage(vec));
+  EXPECT_EQ(vec.getAllocatedMemorySize(), visitedBytes(vec));
+}
+
+TEST(MemoryUsage, SmallVector) {
+  folly::small_vector<int64_t, 4> vec(4);
+  EXPECT_EQ(0, folly::memoryUsage(vec));
+  vec.resize(100);
+  EXPECT_GE(folly::memoryUsage(vec), vec.capacity() * sizeof(int64_t));
+  EXPECT_EQ(vec.getAllocatedMemorySize(), visitedBytes(vec));
+
+  // Large enough that the capacity is stored on the heap
+  folly::small_vector<char, 1> chars(1 << 20);
+  EXPECT_GT(folly::memoryUsage(chars), chars.capacity());
+}
+
+TEST(MemoryUsage, EvictingCacheMap) {
+  folly::EvictingCacheMap<int, int> map(1000);
+  auto empty = folly::memoryUsage(map);
+  for (int i = 0; i < 100; ++i) {
+    map.set(i, i);
+  }
+  EXPECT_GE(folly::memoryUsage(map), empty + 100 * 2 * sizeof(int));
+  EXPECT_EQ(map.getAllocatedMemorySize(), visitedBytes(map));
+}
+
+TEST(MemoryUsage, ConcurrentHashMap) {
+  folly::ConcurrentHashMap<int, int> map;
+  EXPECT_EQ(0, folly::memoryUsage(map));
+  for (int i = 0; i < 1000; ++i) {
+    map.insert(i, i);
+  }
+  EXPECT_GE(folly::memoryUsage(map), 1000 * 2 * sizeof(int));
+  EXPECT_EQ(map.getAllocatedMemorySize(), visitedBytes(map));
+}
+
+TEST(MemoryUsage, ConcurrentHashMapRetired) {
+  // A single shard
+  folly::ConcurrentHashMap<
+      int,
+      int,
+      std::hash<int>,
+      std::equal_to<int>,
+      std::allocator<uint8_t>,
+      0>
+      map;
+  EXPECT_TRUE(map.countRetiredNodes());
+  map.insert(1, 1);
+  auto before = folly::memoryUsage(map);
+  {
+    auto it = map.find(1);
+    map.erase(1);
+    folly::hazptr_cleanup();
+    // The node is retired, but can't be reclaimed while the iterator
+    // protects it, so it is still counted.
+    EXPECT_EQ(1, it->second);
+    EXPECT_EQ(0, map.size());
+    EXPECT_EQ(before, folly::memoryUsage(map));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    map.insert(i, i);
+  }
+  EXPECT_GT(folly::memoryUsage(map), before + 1000 * 2 * sizeof(int));
+}
+
+TEST(MemoryUsage, ConcurrentHashMapRetiredNotCounted) {
+  folly::ConcurrentHashMap<int, int> map;
+  map.insert(1, 1);
+  // Too late to count nodes.
+  EXPECT_FALSE(map.countRetiredNodes());
+  auto before = folly::memoryUsage(map);
+  auto it = map.find(1);
+  map.erase(1);
+  folly::hazptr_cleanup();
+  EXPECT_EQ(1, it->second);
+  // Only the live nodes are reported.
+  EXPECT_GT(before, folly::memoryUsage(map));
+}
+
+TEST(MemoryUsage, ConcurrentHashMapSIMD) {
+  folly::ConcurrentHashMapSIMD<int, int> map;
+  for (int i = 0; i < 1000; ++i) {
+    map.insert(i, i);
+  }
+  EXPECT_GE(folly::memoryUsage(map), 1000 * 2 * sizeof(int));
+  EXPECT_EQ(map.getAllocatedMemorySize(), visitedBytes(map));
+}
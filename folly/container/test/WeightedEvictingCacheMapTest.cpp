@@ -477,20 +477,21 @@ TEST(WeightedEvictingCacheMap, OverMaxWeight) {
   map.set("y", {}, 5);
   map.set("z", {}, 5);
 
-  // Setting weight too high evicts the entry (if it's not most recently used)
-  // and anything used less recently
+  // Setting weight too high evicts everything else, even if the entry is
+  // not the most recently used: it is protected from immediate eviction
   map.updateWeight(map.findWithoutPromotion("y"), 100);
 
   EXPECT_FALSE(map.exists("x"));
-  EXPECT_FALSE(map.exists("y"));
-  EXPECT_TRUE(map.exists("z"));
+  EXPECT_TRUE(map.exists("y"));
+  EXPECT_FALSE(map.exists("z"));
   EXPECT_EQ(1, map.size());
 
   map.set("x", {}, 5);
+  EXPECT_EQ(1, map.size()); // over-weight entry evicted
   map.set("y", {}, 5);
   map.set("z", {}, 5);
 
-  // If it's most recently used, it is protected from immediate eviction
+  // Likewise if it's most recently used
   map.updateWeight(map.findWithoutPromotion("z"), 100);
 
   EXPECT_FALSE(map.exists("x"));
@@ -503,7 +504,7 @@ TEST(WeightedEvictingCacheMap, OverMaxWeight) {
   map.set("y", {}, 5);
   map.set("z", {}, 5);
 
-  // If it's most recently used, it is protected from immediate eviction
+  // Or was just found
   map.updateWeight(map.find("y"), 100);
 
   EXPECT_FALSE(map.exists("x"));
@@ -798,3 +799,61 @@ TEST(WeightedEvictingCacheMap, PruneHook) {
   EXPECT_EQ(std::get<1>(prunedValues[1]), 5);
   EXPECT_EQ(std::get<2>(prunedValues[1]), 6);
 }
+
+TEST(WeightedEvictingCacheMap, EvictionPolicies) {
+  auto check = [](auto& map) {
+    for (size_t i = 0; i < 8; i++) {
+      map.set(i, size_t(i), 1);
+    }
+    for (size_t i = 0; i < 8; i++) {
+      EXPECT_EQ(i, map.get(i));
+    }
+    for (size_t i = 100; i < 200; i++) {
+      map.set(i, size_t(i), 1);
+      EXPECT_TRUE(map.exists(i));
+    }
+    EXPECT_EQ(10, map.getCurrentTotalWeight());
+
+    // Over max weight: the new entry is kept, everything else evicted
+    map.set(42, 42, 20);
+    EXPECT_EQ(1, map.size());
+    EXPECT_EQ(42, map.get(42));
+
+    // Weight update protects the updated entry
+    map.set(1, 1, 5);
+    map.set(2, 2, 5);
+    map.updateWeight(map.findWithoutPromotion(1), 9);
+    EXPECT_TRUE(map.exists(1));
+    EXPECT_FALSE(map.exists(2));
+    EXPECT_EQ(9, map.getCurrentTotalWeight());
+  };
+
+  WeightedEvictingCacheMap<
+      size_t,
+      size_t,
+      HeterogeneousAccessHash<size_t>,
+      HeterogeneousAccessEqualTo<size_t>,
+      ClockEvictionPolicy>
+      clockMap{10};
+  check(clockMap);
+
+  WeightedEvictingCacheMap<
+      size_t,
+      size_t,
+      HeterogeneousAccessHash<size_t>,
+      HeterogeneousAccessEqualTo<size_t>,
+      S3FifoEvictionPolicy>
+      s3FifoMap{10};
+  check(s3FifoMap);
+  // S3-FIFO keeps the frequently used entries through the scan
+  for (size_t i = 0; i < 8; i++) {
+    s3FifoMap.set(i, size_t(i), 1);
+    s3FifoMap.get(i);
+  }
+  for (size_t i = 100; i < 200; i++) {
+    s3FifoMap.set(i, size_t(i), 1);
+  }
+  for (size_t i = 0; i < 8; i++) {
+    EXPECT_TRUE(s3FifoMap.exists(i));
+  }
+}
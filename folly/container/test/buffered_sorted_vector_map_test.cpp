@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/buffered_sorted_vector_map.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(BufferedSortedVectorMap, basic) {
+  buffered_sorted_vector_map<int, std::string> m(4);
+  EXPECT_TRUE(m.empty());
+  EXPECT_TRUE(m.find(1) == m.end());
+
+  auto r = m.insert({3, "three"});
+  EXPECT_TRUE(r.second);
+  EXPECT_EQ("three", r.first->second);
+  EXPECT_FALSE(m.insert({3, "other"}).second);
+  EXPECT_EQ("three", m.find(3)->second);
+
+  m.emplace(1, "one");
+  m[2] = "two";
+  EXPECT_EQ(3, m.size());
+  // still buffered
+  EXPECT_EQ(0, m.sorted().size());
+
+  // the fourth insert reaches the threshold and merges
+  r = m.emplace(0, "zero");
+  EXPECT_TRUE(r.second);
+  EXPECT_EQ(0, r.first->first);
+  EXPECT_EQ("zero", r.first->second);
+  EXPECT_EQ(4, m.sorted().size());
+
+  EXPECT_FALSE(m.insert_or_assign(2, "TWO").second);
+  EXPECT_EQ("TWO", m.find(2)->second);
+
+  int expected = 0;
+  for (auto& [k, v] : m) {
+    EXPECT_EQ(expected++, k);
+  }
+  EXPECT_EQ(4, expected);
+
+  EXPECT_EQ(1, m.erase(1));
+  EXPECT_EQ(0, m.erase(1));
+  m.emplace(7, "seven");
+  EXPECT_EQ(1, m.erase(7));
+  EXPECT_EQ(3, m.size());
+  EXPECT_FALSE(m.contains(7));
+  EXPECT_EQ(1, m.count(3));
+
+  m.clear();
+  EXPECT_TRUE(m.empty());
+}
+
+TEST(BufferedSortedVectorMap, matchesStdMap) {
+  std::mt19937 rng(42);
+  for (size_t threshold : {1, 2, 7, 64}) {
+    buffered_sorted_vector_map<int, int> m(threshold);
+    std::map<int, int> ref;
+    for (int i = 0; i < 5000; ++i) {
+      int key = rng() % 1000;
+      switch (rng() % 4) {
+        case 0:
+          EXPECT_EQ(ref.erase(key), m.erase(key));
+          break;
+        case 1: {
+          auto r = m.insert_or_assign(key, i);
+          EXPECT_EQ(key, r.first->first);
+          ref[key] = i;
+          break;
+        }
+        default: {
+          auto r = m.emplace(key, i);
+          EXPECT_EQ(key, r.first->first);
+          EXPECT_EQ(ref.emplace(key, i).second, r.second);
+          EXPECT_EQ(ref[key], r.first->second);
+        }
+      }
+      ASSERT_EQ(ref.size(), m.size());
+    }
+    for (auto& [k, v] : ref) {
+      ASSERT_TRUE(m.contains(k));
+      EXPECT_EQ(v, m.find(k)->second);
+    }
+    m.flush();
+    std::vector<std::pair<int, int>> expected(ref.begin(), ref.end());
+    EXPECT_TRUE(std::equal(
+        expected.begin(),
+        expected.end(),
+        m.sorted().begin(),
+        m.sorted().end()));
+  }
+}
+
+TEST(BufferedSortedVectorMap, bulkInsert) {
+  std::vector<std::pair<std::string, int>> values;
+  for (int i = 999; i >= 0; --i) {
+    values.emplace_back(to<std::string>(i), i);
+  }
+  buffered_sorted_vector_map<std::string, int> m;
+  m.insert(values.begin(), values.end());
+  EXPECT_EQ(1000, m.size());
+  EXPECT_EQ(500, m.find("500")->second);
+  EXPECT_TRUE(std::is_sorted(m.begin(), m.end()));
+}
+
+TEST(BufferedSortedVectorMap, constIteration) {
+  buffered_sorted_vector_map<int, int> m(8);
+  for (int i = 0; i < 1000; ++i) {
+    m.emplace((i * 7919) % 1000, i);
+  }
+  const auto& cm = m;
+  EXPECT_EQ(1000, cm.size());
+  auto sortedSize = m.sorted().size();
+  EXPECT_LT(sortedSize, 1000);
+  EXPECT_EQ(1000, std::distance(cm.begin(), cm.end()));
+  // Const iteration merges on the fly rather than flushing.
+  EXPECT_EQ(sortedSize, m.sorted().size());
+  int expected = 0;
+  for (auto it = cm.cbegin(); it != cm.cend(); ++it) {
+    EXPECT_EQ(expected++, it->first);
+  }
+  EXPECT_EQ(1000, expected);
+  EXPECT_EQ(7, cm.find(7)->first);
+  EXPECT_TRUE(cm.find(1000) == cm.end());
+
+  // Iterators into the tail and the runs can be advanced too.
+  auto it = m.find(998);
+  ASSERT_TRUE(it != m.end());
+  EXPECT_EQ(999, (++it)->first);
+  EXPECT_TRUE(++it == m.end());
+  buffered_sorted_vector_map<int, int>::const_iterator cit = m.find(500);
+  EXPECT_EQ(501, std::next(cit)->first);
+}
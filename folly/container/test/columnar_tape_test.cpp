@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/columnar_tape.h>
+
+#include <string>
+#include <vector>
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+namespace folly {
+
+TEST(ColumnarTape, Basic) {
+  columnar_tape<2> t;
+  t.push_back("a", "first");
+  t.push_back(std::string("bb"), std::vector<char>{'2'});
+  ASSERT_EQ(2, t.size());
+
+  auto [key, value] = t[1];
+  EXPECT_EQ("bb", key);
+  EXPECT_EQ("2", value);
+
+  EXPECT_THAT(t.column<0>(), ::testing::ElementsAre("a", "bb"));
+  EXPECT_THAT(t.column(1), ::testing::ElementsAre("first", "2"));
+  EXPECT_EQ(3, t.column<0>().size_flat());
+  EXPECT_THROW((void)t.at(2), std::out_of_range);
+
+  std::size_t rows = 0;
+  for (const auto& row : t) {
+    EXPECT_EQ(row[0], t[rows][0]);
+    ++rows;
+  }
+  EXPECT_EQ(2, rows);
+
+  auto copy = t;
+  copy.push_back(t[0]);
+  EXPECT_NE(t, copy);
+  copy.pop_back();
+  EXPECT_EQ(t, copy);
+
+  t.clear();
+  EXPECT_TRUE(t.empty());
+  EXPECT_TRUE(t.column<1>().empty());
+}
+
+} // namespace folly
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/compact_tape.h>
+
+#include <string>
+#include <vector>
+
+#include <folly/container/tape.h>
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+namespace folly {
+
+TEST(CompactTape, Basic) {
+  compact_string_tape t{"ab", "", "cde"};
+  ASSERT_EQ(3, t.size());
+  EXPECT_EQ(5, t.size_flat());
+  EXPECT_EQ("ab", t[0]);
+  EXPECT_EQ("", t[1]);
+  EXPECT_EQ("cde", t[2]);
+  EXPECT_EQ("cde", t.back());
+  EXPECT_THROW((void)t.at(3), std::out_of_range);
+  EXPECT_THAT(t, ::testing::ElementsAre("ab", "", "cde"));
+
+  t.clear();
+  EXPECT_TRUE(t.empty());
+  EXPECT_EQ(t.begin(), t.end());
+}
+
+TEST(CompactTape, ManyBlocks) {
+  std::vector<std::string> expected;
+  for (std::size_t i = 0; i < 10 * compact_string_tape::kBlockSize + 7; ++i) {
+    expected.push_back(std::string(i % 300, char('a' + i % 26)));
+  }
+  compact_string_tape t(expected);
+  ASSERT_EQ(expected.size(), t.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i], t[i]) << i;
+  }
+  std::size_t i = 0;
+  for (auto r : t) {
+    EXPECT_EQ(expected[i++], r);
+  }
+  EXPECT_EQ(expected.size(), i);
+
+  // lengths < 128 take one byte, longer ones two.
+  string_tape plain(expected.begin(), expected.end());
+  EXPECT_LT(t.size_index(), plain.markers().size() * sizeof(std::ptrdiff_t));
+}
+
+} // namespace folly
@@ -1768,3 +1768,35 @@ TEST(HeapVectorTypes, TestGetContainer) {
   heap_vector_set<int> s;
   EXPECT_TRUE(s.get_container().empty());
 }
+
+TEST(HeapVectorTypes, TestLowerBoundLarge) {
+  // Large enough to take the prefetching search path.
+  constexpr uint64_t kSize = 1 << 17;
+  std::vector<std::pair<uint64_t, uint64_t>> values;
+  for (uint64_t i = 0; i < kSize; ++i) {
+    values.emplace_back(2 * i, i);
+  }
+  heap_vector_map<uint64_t, uint64_t> m(values.begin(), values.end());
+  heap_vector_set<uint64_t> s;
+  {
+    std::vector<uint64_t> keys;
+    for (auto& v : values) {
+      keys.push_back(v.first);
+    }
+    s = heap_vector_set<uint64_t>(keys.begin(), keys.end());
+  }
+  for (int i = 0; i < 10000; ++i) {
+    auto key = folly::Random::rand64(2 * kSize + 2);
+    auto it = m.lower_bound(key);
+    auto sit = s.lower_bound(key);
+    if (key >= 2 * kSize - 1) {
+      EXPECT_TRUE(it == m.end());
+      EXPECT_TRUE(sit == s.end());
+      continue;
+    }
+    ASSERT_TRUE(it != m.end());
+    EXPECT_EQ((key + 1) / 2 * 2, it->first);
+    EXPECT_EQ((key + 1) / 2 * 2, *sit);
+    EXPECT_EQ(key % 2 == 0, m.find(key) != m.end());
+  }
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/mapped_tape.h>
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+namespace folly {
+
+TEST(MappedTape, RoundTrip) {
+  string_tape t{"ab", "", "cde"};
+  auto image = mapped_string_tape::serialize(t);
+
+  mapped_string_tape m(image);
+  EXPECT_TRUE(m.validate());
+  ASSERT_EQ(3, m.size());
+  EXPECT_EQ(5, m.size_flat());
+  EXPECT_EQ("abcde", m.scalars());
+  EXPECT_THAT(m, ::testing::ElementsAre("ab", "", "cde"));
+  EXPECT_THROW((void)m.at(3), std::out_of_range);
+
+  // Records point into the image.
+  EXPECT_EQ(image.data() + image.size() - 3, m[2].data());
+}
+
+TEST(MappedTape, Unaligned) {
+  string_tape t{"x", "yz"};
+  std::string image = "?";
+  mapped_string_tape::serialize(t, image);
+  mapped_string_tape m(StringPiece(image).subpiece(1));
+  EXPECT_THAT(m, ::testing::ElementsAre("x", "yz"));
+}
+
+TEST(MappedTape, Empty) {
+  auto image = mapped_string_tape::serialize(string_tape{});
+  mapped_string_tape m(image);
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(m.begin(), m.end());
+}
+
+TEST(MappedTape, Malformed) {
+  auto image = mapped_string_tape::serialize(string_tape{"abc", "de"});
+  EXPECT_THROW(
+      mapped_string_tape(StringPiece(image).subpiece(0, 8)),
+      std::invalid_argument);
+  EXPECT_THROW(
+      mapped_string_tape(StringPiece(image).subpiece(0, image.size() - 1)),
+      std::invalid_argument);
+
+  auto badMagic = image;
+  badMagic[0] = 'X';
+  EXPECT_THROW(mapped_string_tape{badMagic}, std::invalid_argument);
+
+  // Markers are {0, 3, 5}; make them {0, 6, 5}.
+  auto unordered = image;
+  unordered[mapped_string_tape::kHeaderSize + 8] = 6;
+  mapped_string_tape m(unordered);
+  EXPECT_FALSE(m.validate());
+}
+
+} // namespace folly
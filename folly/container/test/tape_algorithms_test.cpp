@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/container/tape_algorithms.h>
+
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+namespace folly {
+
+TEST(TapeAlgorithms, Permute) {
+  string_tape t{"a", "bb", "ccc"};
+  std::vector<std::size_t> perm{2, 0, 2};
+  EXPECT_THAT(tape_permute(t, perm), ::testing::ElementsAre("ccc", "a", "ccc"));
+}
+
+TEST(TapeAlgorithms, SortSmall) {
+  string_tape t{"b", "", "ab", "a", "\xff", "b"};
+  auto perm = tape_sort_permutation(t);
+  EXPECT_THAT(perm, ::testing::ElementsAre(1, 3, 2, 0, 5, 4));
+  tape_sort(t);
+  EXPECT_THAT(t, ::testing::ElementsAre("", "a", "ab", "b", "b", "\xff"));
+}
+
+TEST(TapeAlgorithms, RadixSortMatchesStdSort) {
+  std::mt19937 rng(42);
+  std::vector<std::string> strings;
+  for (int i = 0; i < 5000; ++i) {
+    // Short alphabet and shared prefixes exercise deep buckets.
+    std::string s(rng() % 12, 'x');
+    for (auto& c : s) {
+      c = static_cast<char>("ab\x80\xff"[rng() % 4]);
+    }
+    strings.push_back(std::move(s));
+  }
+  string_tape t(strings.begin(), strings.end());
+
+  auto perm = tape_sort_permutation(t);
+  std::vector<std::size_t> expected(strings.size());
+  std::iota(expected.begin(), expected.end(), std::size_t(0));
+  std::stable_sort(expected.begin(), expected.end(), [&](auto a, auto b) {
+    return strings[a] < strings[b];
+  });
+  EXPECT_EQ(expected, perm);
+}
+
+TEST(TapeAlgorithms, SortNonByteScalars) {
+  std::vector<std::vector<int>> records{{3}, {1, 2}, {-1}, {1}};
+  tape<std::vector<int>> t(records.begin(), records.end());
+  tape_sort(t);
+  ASSERT_EQ(4, t.size());
+  EXPECT_THAT(t[0], ::testing::ElementsAre(-1));
+  EXPECT_THAT(t[1], ::testing::ElementsAre(1));
+  EXPECT_THAT(t[2], ::testing::ElementsAre(1, 2));
+  EXPECT_THAT(t[3], ::testing::ElementsAre(3));
+}
+
+} // namespace folly
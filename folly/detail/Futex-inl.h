@@ -70,6 +70,15 @@ FutexResult futexWaitImpl(
     std::chrono::steady_clock::time_point const* absSteadyTime,
     uint32_t waitMask);
 
+int futexWakeImpl(
+    const Futex<SharedFutexAtomic>* futex, int count, uint32_t wakeMask);
+FutexResult futexWaitImpl(
+    const Futex<SharedFutexAtomic>* futex,
+    uint32_t expected,
+    std::chrono::system_clock::time_point const* absSystemTime,
+    std::chrono::steady_clock::time_point const* absSteadyTime,
+    uint32_t waitMask);
+
 template <typename Futex, typename Deadline>
 typename std::enable_if<Deadline::clock::is_steady, FutexResult>::type
 futexWaitImpl(
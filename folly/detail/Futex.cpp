@@ -60,11 +60,14 @@ namespace {
 #define FUTEX_CLOCK_REALTIME 256
 #endif
 
-int nativeFutexWake(const void* addr, int count, uint32_t wakeMask) {
+// Futexes in memory shared between processes must not use the private
+// operations, which the kernel keys by address space.
+int nativeFutexWake(
+    const void* addr, int count, uint32_t wakeMask, bool shared = false) {
   int rv = syscall(
       __NR_futex,
       addr, /* addr1 */
-      FUTEX_WAKE_BITSET | FUTEX_PRIVATE_FLAG, /* op */
+      FUTEX_WAKE_BITSET | (shared ? 0 : FUTEX_PRIVATE_FLAG), /* op */
       count, /* val */
       nullptr, /* timeout */
       nullptr, /* addr2 */
@@ -105,10 +108,11 @@ FutexResult nativeFutexWaitImpl(
     uint32_t expected,
     system_clock::time_point const* absSystemTime,
     steady_clock::time_point const* absSteadyTime,
-    uint32_t waitMask) {
+    uint32_t waitMask,
+    bool shared = false) {
   assert(absSystemTime == nullptr || absSteadyTime == nullptr);
 
-  int op = FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG;
+  int op = FUTEX_WAIT_BITSET | (shared ? 0 : FUTEX_PRIVATE_FLAG);
   struct timespec ts;
   struct timespec* timeout = nullptr;
 
@@ -192,8 +196,10 @@ FutexResult emulatedFutexWaitImpl(
     uint32_t waitMask) {
   static_assert(
       std::is_same<F, const Futex<std::atomic>>::value ||
-          std::is_same<F, const Futex<EmulatedFutexAtomic>>::value,
-      "Type F must be either Futex<std::atomic> or Futex<EmulatedFutexAtomic>");
+          std::is_same<F, const Futex<EmulatedFutexAtomic>>::value ||
+          std::is_same<F, const Futex<SharedFutexAtomic>>::value,
+      "Type F must be Futex<std::atomic>, Futex<EmulatedFutexAtomic> or "
+      "Futex<SharedFutexAtomic>");
   ParkResult res;
   if (absSystemTime) {
     res = parkingLot.park_until(
@@ -269,5 +275,34 @@ FutexResult futexWaitImpl(
       futex, expected, absSystemTime, absSteadyTime, waitMask);
 }
 
+int futexWakeImpl(
+    const Futex<SharedFutexAtomic>* futex, int count, uint32_t wakeMask) {
+#ifdef __linux__
+  return nativeFutexWake(futex, count, wakeMask, /* shared = */ true);
+#else
+  return emulatedFutexWake(futex, count, wakeMask);
+#endif
+}
+
+FutexResult futexWaitImpl(
+    const Futex<SharedFutexAtomic>* futex,
+    uint32_t expected,
+    system_clock::time_point const* absSystemTime,
+    steady_clock::time_point const* absSteadyTime,
+    uint32_t waitMask) {
+#ifdef __linux__
+  return nativeFutexWaitImpl(
+      futex,
+      expected,
+      absSystemTime,
+      absSteadyTime,
+      waitMask,
+      /* shared = */ true);
+#else
+  return emulatedFutexWaitImpl(
+      futex, expected, absSystemTime, absSteadyTime, waitMask);
+#endif
+}
+
 } // namespace detail
 } // namespace folly
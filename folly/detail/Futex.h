@@ -103,6 +103,20 @@ struct EmulatedFutexAtomic : public std::atomic<T> {
   EmulatedFutexAtomic(EmulatedFutexAtomic&& rhs) = delete;
 };
 
+/** A std::atomic subclass whose futex operations also work when the atomic
+ *  lives in memory shared between processes, by using the shared rather
+ *  than the process-private futex() operations on Linux. Other platforms
+ *  only emulate futex() within a process, so there waiters and wakers must
+ *  be in the same process. */
+template <typename T>
+struct SharedFutexAtomic : public std::atomic<T> {
+  SharedFutexAtomic() noexcept = default;
+  constexpr /* implicit */ SharedFutexAtomic(T init) noexcept
+      : std::atomic<T>(init) {}
+  // It doesn't copy or move
+  SharedFutexAtomic(SharedFutexAtomic&& rhs) = delete;
+};
+
 } // namespace detail
 } // namespace folly
 
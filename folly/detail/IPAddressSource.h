@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstring>
 #include <string>
 #include <type_traits>
@@ -274,5 +275,179 @@ inline void fastIpv6AppendToString(const in6_addr& in6Addr, std::string& out) {
   char str[sizeof("2001:0db8:0000:0000:0000:ff00:0042:8329")];
   out.append(str, fastIpv6ToBufferUnsafe(in6Addr, str));
 }
+
+// Writes the address in the form inet_ntop(AF_INET6) uses (RFC 5952): groups
+// without leading zeros, the first longest run of two or more zero groups
+// replaced by "::", and IPv4-compatible and IPv4-mapped addresses ending in
+// dotted-quad form. Returns the number of characters written, at most
+// sizeof("ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255") - 1.
+inline size_t fastIpv6ToCompressedBufferUnsafe(
+    const in6_addr& in6Addr, char* str) {
+  const uint8_t* bytes = in6Addr.s6_addr;
+  uint16_t words[8];
+  for (int i = 0; i < 8; ++i) {
+    words[i] = uint16_t((bytes[2 * i] << 8) | bytes[2 * i + 1]);
+  }
+
+  int bestBase = -1;
+  int bestLen = 0;
+  for (int i = 0; i < 8;) {
+    if (words[i] != 0) {
+      ++i;
+      continue;
+    }
+    int j = i;
+    while (j < 8 && words[j] == 0) {
+      ++j;
+    }
+    if (j - i > bestLen) {
+      bestBase = i;
+      bestLen = j - i;
+    }
+    i = j;
+  }
+  if (bestLen < 2) {
+    bestBase = -1;
+  }
+
+  char* buf = str;
+  for (int i = 0; i < 8; ++i) {
+    if (i == bestBase) {
+      *(buf++) = ':';
+      i += bestLen - 1;
+      if (i == 7) {
+        *(buf++) = ':';
+      }
+      continue;
+    }
+    if (i != 0) {
+      *(buf++) = ':';
+    }
+    if (i == 6 && bestBase == 0 &&
+        (bestLen == 6 || (bestLen == 5 && words[5] == 0xffff))) {
+      in_addr inAddr;
+      std::memcpy(&inAddr, bytes + 12, 4);
+      buf += fastIpV4ToBufferUnsafe(inAddr, buf);
+      break;
+    }
+    writeIntegerString<uint16_t, 4, 16>(words[i], &buf);
+  }
+
+  return buf - str;
+}
+
+// Parses a dotted-quad IPv4 address into `out`, in network byte order, with
+// the same rules as inet_pton(AF_INET): four decimal octets of at most 255
+// without leading zeros, and nothing else. Unlike inet_pton(), the input
+// doesn't need to be NUL-terminated.
+inline bool tryParseIpv4(
+    const char* begin, const char* end, uint8_t* out) noexcept {
+  size_t octets = 0;
+  while (octets < 4) {
+    if (begin == end || *begin < '0' || *begin > '9') {
+      return false;
+    }
+    unsigned value = unsigned(*begin++ - '0');
+    size_t digits = 1;
+    while (begin != end && *begin >= '0' && *begin <= '9') {
+      if (value == 0 || ++digits > 3) {
+        return false;
+      }
+      value = value * 10 + unsigned(*begin++ - '0');
+    }
+    if (value > 255) {
+      return false;
+    }
+    out[octets++] = uint8_t(value);
+    if (octets < 4 && (begin == end || *begin++ != '.')) {
+      return false;
+    }
+  }
+  return begin == end;
+}
+
+// Parses an IPv6 address into `out` with the same rules as
+// inet_pton(AF_INET6): up to eight groups of one to four hex digits, at most
+// one "::" standing for one or more zero groups, and optionally a trailing
+// dotted-quad IPv4 address for the last two groups. Scope ids ("%eth0") and
+// brackets are not accepted. The input doesn't need to be NUL-terminated.
+inline bool tryParseIpv6(
+    const char* begin, const char* end, uint8_t* out) noexcept {
+  uint8_t tmp[16] = {};
+  size_t pos = 0;
+  ptrdiff_t gap = -1;
+
+  const char* p = begin;
+  if (p != end && *p == ':') {
+    // A leading colon must be the start of "::".
+    if (++p == end || *p != ':') {
+      return false;
+    }
+  }
+  const char* group = p;
+  unsigned value = 0;
+  size_t digits = 0;
+  while (p != end) {
+    char ch = *p++;
+    int digit = ch >= '0' && ch <= '9' ? ch - '0'
+        : ch >= 'a' && ch <= 'f'       ? ch - 'a' + 10
+        : ch >= 'A' && ch <= 'F'       ? ch - 'A' + 10
+                                       : -1;
+    if (digit >= 0) {
+      if (++digits > 4) {
+        return false;
+      }
+      value = (value << 4) | unsigned(digit);
+      continue;
+    }
+    if (ch == ':') {
+      group = p;
+      if (digits == 0) {
+        if (gap >= 0) {
+          return false;
+        }
+        gap = ptrdiff_t(pos);
+        continue;
+      }
+      if (p == end || pos + 2 > sizeof(tmp)) {
+        return false;
+      }
+      tmp[pos++] = uint8_t(value >> 8);
+      tmp[pos++] = uint8_t(value);
+      value = 0;
+      digits = 0;
+      continue;
+    }
+    if (ch == '.' && pos + 4 <= sizeof(tmp) &&
+        tryParseIpv4(group, end, tmp + pos)) {
+      pos += 4;
+      digits = 0;
+      break;
+    }
+    return false;
+  }
+  if (digits > 0) {
+    if (pos + 2 > sizeof(tmp)) {
+      return false;
+    }
+    tmp[pos++] = uint8_t(value >> 8);
+    tmp[pos++] = uint8_t(value);
+  }
+  if (gap >= 0) {
+    if (pos == sizeof(tmp)) {
+      return false;
+    }
+    // Move the groups after "::" to the end, leaving zeros in the gap.
+    size_t tail = pos - size_t(gap);
+    std::memmove(tmp + sizeof(tmp) - tail, tmp + gap, tail);
+    std::memset(tmp + gap, 0, sizeof(tmp) - tail - size_t(gap));
+    pos = sizeof(tmp);
+  }
+  if (pos != sizeof(tmp)) {
+    return false;
+  }
+  std::memcpy(out, tmp, sizeof(tmp));
+  return true;
+}
 } // namespace detail
 } // namespace folly
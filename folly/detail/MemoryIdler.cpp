@@ -19,12 +19,14 @@
 #include <climits>
 #include <cstdio>
 #include <cstring>
+#include <string>
 #include <utility>
 
 #include <folly/GLog.h>
 #include <folly/Portability.h>
 #include <folly/ScopeGuard.h>
 #include <folly/concurrency/CacheLocality.h>
+#include <folly/lang/Bits.h>
 #include <folly/memory/MallctlHelper.h>
 #include <folly/memory/Malloc.h>
 #include <folly/portability/GFlags.h>
@@ -45,6 +47,133 @@ namespace detail {
 AtomicStruct<std::chrono::steady_clock::duration>
     MemoryIdler::defaultIdleTimeout(std::chrono::seconds(5));
 
+AtomicStruct<std::chrono::steady_clock::duration>
+    MemoryIdler::minArenaPurgeInterval(std::chrono::seconds(1));
+
+namespace {
+
+// Arenas whose threads went idle since the last purge, as a bitmap
+constexpr size_t kMaxPendingArenas = 4096;
+std::atomic<uint64_t> pendingArenas[kMaxPendingArenas / 64];
+
+std::atomic<bool> purgingArenas{false};
+std::atomic<std::chrono::steady_clock::rep> lastArenaPurge{0};
+std::atomic<size_t> purgedBytes{0};
+
+size_t purgeArenasLocked() {
+  size_t mib[3];
+  size_t miblen = 3;
+  if (mallctlnametomib("arena.0.purge", mib, &miblen) != 0) {
+    return 0;
+  }
+  // Refresh the stats, to count the dirty pages that each purge returns.
+  size_t pageSize = 0;
+  try {
+    mallctlWrite<uint64_t>("epoch", 1);
+    mallctlRead("arenas.page", &pageSize);
+  } catch (const std::runtime_error&) {
+    pageSize = 0;
+  }
+  size_t bytes = 0;
+  for (size_t word = 0; word < kMaxPendingArenas / 64; ++word) {
+    auto bits = pendingArenas[word].exchange(0, std::memory_order_acq_rel);
+    while (bits) {
+      auto arena = word * 64 + findFirstSet(bits) - 1;
+      bits &= bits - 1;
+      if (pageSize) {
+        size_t dirty = 0;
+        auto const name = "stats.arenas." + std::to_string(arena) + ".pdirty";
+        try {
+          mallctlRead(name.c_str(), &dirty);
+        } catch (const std::runtime_error&) {
+        }
+        bytes += dirty * pageSize;
+      }
+      mib[1] = arena;
+      mallctlbymib(mib, miblen, nullptr, nullptr, nullptr, 0);
+    }
+  }
+  purgedBytes.fetch_add(bytes, std::memory_order_relaxed);
+  return bytes;
+}
+
+bool anyPendingArenas() {
+  for (auto& word : pendingArenas) {
+    if (word.load(std::memory_order_relaxed) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Purges the pending arenas if none were purged within
+// minArenaPurgeInterval.
+void purgePendingArenasIfDue() {
+  auto const now = std::chrono::steady_clock::now().time_since_epoch().count();
+  auto const interval =
+      MemoryIdler::minArenaPurgeInterval.load(std::memory_order_relaxed)
+          .count();
+  auto last = lastArenaPurge.load(std::memory_order_relaxed);
+  if (now - last >= interval &&
+      lastArenaPurge.compare_exchange_strong(
+          last, now, std::memory_order_relaxed)) {
+    MemoryIdler::purgePendingArenas();
+  }
+}
+
+// Marks the arena as pending, and purges the pending arenas if due.
+void purgeArenaBatched(unsigned arena) {
+  if (arena >= kMaxPendingArenas) {
+    // Not tracked, so purged right away
+    size_t mib[3];
+    size_t miblen = 3;
+    if (mallctlnametomib("arena.0.purge", mib, &miblen) == 0) {
+      mib[1] = arena;
+      mallctlbymib(mib, miblen, nullptr, nullptr, nullptr, 0);
+    }
+    return;
+  }
+  pendingArenas[arena / 64].fetch_or(
+      uint64_t(1) << (arena % 64), std::memory_order_release);
+  purgePendingArenasIfDue();
+}
+
+} // namespace
+
+std::chrono::steady_clock::time_point MemoryIdler::pendingArenaPurgeTime() {
+  if (!anyPendingArenas()) {
+    return std::chrono::steady_clock::time_point::max();
+  }
+  return std::chrono::steady_clock::time_point(
+             std::chrono::steady_clock::duration(
+                 lastArenaPurge.load(std::memory_order_relaxed))) +
+      minArenaPurgeInterval.load(std::memory_order_relaxed);
+}
+
+void MemoryIdler::purgeDueArenas() {
+  if (anyPendingArenas()) {
+    purgePendingArenasIfDue();
+  }
+}
+
+size_t MemoryIdler::purgePendingArenas() {
+  if (!usingJEMalloc() || !mallctl || !mallctlnametomib || !mallctlbymib) {
+    return 0;
+  }
+  if (purgingArenas.exchange(true, std::memory_order_acquire)) {
+    // Arenas pending now are purged by the thread that is purging, or next
+    return 0;
+  }
+  SCOPE_EXIT {
+    purgingArenas.store(false, std::memory_order_release);
+  };
+  return purgeArenasLocked();
+}
+
+size_t MemoryIdler::arenaPurgedBytes() noexcept {
+  return purgedBytes.load(std::memory_order_relaxed);
+}
+
 bool MemoryIdler::isUnmapUnusedStackAvailable() noexcept {
   // Linux uses an automatic stack expansion mechanism to expand the main thread
   // stack on demand. Before the main thread stack grows to its full extent, the
@@ -87,17 +216,14 @@ void MemoryIdler::flushLocalMallocCaches() {
       // purging the arenas is counter-productive.  We use the heuristic
       // that if narenas <= 2 * num_cpus then we shouldn't do anything here,
       // which detects when the narenas has been reduced from the default
+      // Purges are batched across threads, see minArenaPurgeInterval.
       unsigned narenas;
       unsigned arenaForCurrent;
-      size_t mib[3];
-      size_t miblen = 3;
 
       mallctlRead("opt.narenas", &narenas);
       mallctlRead("thread.arena", &arenaForCurrent);
-      if (narenas > 2 * CacheLocality::system().numCpus &&
-          mallctlnametomib("arena.0.purge", mib, &miblen) == 0) {
-        mib[1] = static_cast<size_t>(arenaForCurrent);
-        mallctlbymib(mib, miblen, nullptr, nullptr, nullptr, 0);
+      if (narenas > 2 * CacheLocality::system().numCpus) {
+        purgeArenaBatched(arenaForCurrent);
       }
     } catch (const std::runtime_error& ex) {
       FB_LOG_EVERY_MS(WARNING, 10000) << ex.what();
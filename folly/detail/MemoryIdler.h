@@ -65,6 +65,24 @@ struct MemoryIdler {
   /// avoid synchronizing their flushes.
   static AtomicStruct<std::chrono::steady_clock::duration> defaultIdleTimeout;
 
+  /// With --folly_memory_idler_purge_arenas, the minimum time between two
+  /// purges of jemalloc arenas, process-wide. A thread that goes idle in
+  /// between only marks its arena as pending, and the pending arenas are
+  /// purged together once the interval expires, by the first thread to go
+  /// idle or by a futexWait() waiter that marked its arena, so that wide
+  /// thread pools going idle at once don't each madvise.
+  /// The default is 1 second; zero purges whenever a thread goes idle.
+  static AtomicStruct<std::chrono::steady_clock::duration>
+      minArenaPurgeInterval;
+
+  /// Purges the pending arenas now, regardless of minArenaPurgeInterval.
+  /// Returns the bytes of dirty pages returned to the system, as counted
+  /// by jemalloc stats, or 0 if those are unavailable.
+  static size_t purgePendingArenas();
+
+  /// The total bytes returned to the system by arena purges.
+  static size_t arenaPurgedBytes() noexcept;
+
   /// Selects a timeout pseudo-randomly chosen to be between
   /// idleTimeout and idleTimeout * (1 + timeoutVariationFraction), to
   /// smooth out the behavior in a bursty system
@@ -208,8 +226,34 @@ struct MemoryIdler {
     // flush, then wait
     flushLocalMallocCaches();
     unmapUnusedStack(stackToRetain);
+
+    // If the flush left arenas pending, purge them once they are due,
+    // unless woken up before
+    auto const purgeTime = pendingArenaPurgeTime();
+    if (purgeTime != std::chrono::steady_clock::time_point::max()) {
+      auto const purgeDeadline = Deadline::clock::now() +
+          std::max(
+              std::chrono::steady_clock::duration::zero(),
+              purgeTime - std::chrono::steady_clock::now());
+      if (purgeDeadline < deadline) {
+        using folly::detail::futexWaitUntil;
+        auto rv = futexWaitUntil(&fut, expected, purgeDeadline, waitMask);
+        if (rv != FutexResult::TIMEDOUT) {
+          _ret = rv;
+          return true;
+        }
+        purgeDueArenas();
+      }
+    }
     return false;
   }
+
+  /// When the arenas that are pending are due to be purged, or
+  /// time_point::max() if there are none.
+  static std::chrono::steady_clock::time_point pendingArenaPurgeTime();
+
+  /// Purges the pending arenas if minArenaPurgeInterval has expired.
+  static void purgeDueArenas();
 };
 
 } // namespace detail
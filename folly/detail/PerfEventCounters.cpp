@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/detail/PerfEventCounters.h>
+
+#include <folly/Indestructible.h>
+
+#if FOLLY_PERF_IS_SUPPORTED
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace folly {
+namespace detail {
+
+// static
+const std::vector<std::string>& PerfEventCounters::allNames() {
+  static const Indestructible<std::vector<std::string>> names{
+      std::vector<std::string>{
+          "cycles", "instructions", "L1d-misses", "LLC-misses", "br-misses"}};
+  return *names;
+}
+
+#if FOLLY_PERF_IS_SUPPORTED
+
+namespace {
+
+constexpr uint64_t cacheReadMisses(uint64_t cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+struct EventConfig {
+  uint32_t type;
+  uint64_t config;
+};
+
+// In the order of allNames().
+constexpr EventConfig kEvents[] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, cacheReadMisses(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, cacheReadMisses(PERF_COUNT_HW_CACHE_LL)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int openEvent(const EventConfig& event, int groupFd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = event.type;
+  attr.config = event.config;
+  attr.disabled = groupFd == -1 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+      PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(
+      syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+} // namespace
+
+PerfEventCounters::PerfEventCounters() {
+  static_assert(
+      sizeof(kEvents) / sizeof(kEvents[0]) == 5, "One event for each name");
+  for (size_t i = 0; i < sizeof(kEvents) / sizeof(kEvents[0]); ++i) {
+    int fd = openEvent(kEvents[i], fds_.empty() ? -1 : fds_[0]);
+    if (fd == -1) {
+      continue;
+    }
+    fds_.push_back(fd);
+    names_.push_back(allNames()[i]);
+  }
+}
+
+PerfEventCounters::~PerfEventCounters() {
+  for (int fd : fds_) {
+    close(fd);
+  }
+}
+
+void PerfEventCounters::start() {
+  if (fds_.empty()) {
+    return;
+  }
+  ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+std::vector<double> PerfEventCounters::stop() {
+  if (fds_.empty()) {
+    return {};
+  }
+  ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+  // nr, time_enabled, time_running, then one value per counter.
+  std::vector<uint64_t> data(3 + fds_.size());
+  auto size = data.size() * sizeof(data[0]);
+  if (read(fds_[0], data.data(), size) != static_cast<ssize_t>(size) ||
+      data[0] != fds_.size() || data[2] == 0) {
+    return {};
+  }
+  double scale = double(data[1]) / double(data[2]);
+  std::vector<double> values(fds_.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = double(data[3 + i]) * scale;
+  }
+  return values;
+}
+
+#else // FOLLY_PERF_IS_SUPPORTED
+
+PerfEventCounters::PerfEventCounters() = default;
+PerfEventCounters::~PerfEventCounters() = default;
+
+void PerfEventCounters::start() {}
+
+std::vector<double> PerfEventCounters::stop() {
+  return {};
+}
+
+#endif // FOLLY_PERF_IS_SUPPORTED
+
+} // namespace detail
+} // namespace folly
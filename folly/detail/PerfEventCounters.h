@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <folly/detail/PerfScoped.h>
+
+namespace folly {
+namespace detail {
+
+/*
+ * Hardware performance counters of the calling thread, read through
+ * perf_event_open(2), for folly::benchmark's --bm_perf_counters.
+ *
+ * The counters are opened as one group, so that they are scheduled on the
+ * PMU together and their values are comparable. They only count user-space
+ * events of the thread that constructed the object, not of threads it starts.
+ * Counters that the kernel or the hardware doesn't support (e.g. in some
+ * virtual machines) are left out, and if none is, names() is empty and the
+ * other methods do nothing.
+ *
+ * Only available on linux.
+ */
+class PerfEventCounters {
+ public:
+  // The counters to open, in the order they are reported in: cpu cycles,
+  // retired instructions, L1 data cache and last level cache load misses, and
+  // mispredicted branches.
+  static const std::vector<std::string>& allNames();
+
+  PerfEventCounters();
+  ~PerfEventCounters();
+
+  PerfEventCounters(const PerfEventCounters&) = delete;
+  PerfEventCounters& operator=(const PerfEventCounters&) = delete;
+
+  // The counters that could be opened, a subsequence of allNames().
+  const std::vector<std::string>& names() const { return names_; }
+
+  // Resets the counters to zero and starts counting.
+  void start();
+
+  // Stops counting and returns the values of names(), in the same order.
+  // If the kernel had to multiplex the group with other events, they are
+  // scaled up to the whole time it was enabled. Returns an empty vector if
+  // the group was never scheduled.
+  std::vector<double> stop();
+
+ private:
+  std::vector<int> fds_;
+  std::vector<std::string> names_;
+};
+
+} // namespace detail
+} // namespace folly
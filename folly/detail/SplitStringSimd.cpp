@@ -80,5 +80,16 @@ template struct SimdSplitByCharImplToStrings<std::vector<std::string>>;
 template struct SimdSplitByCharImplToStrings<std::vector<fbstring>>;
 template struct SimdSplitByCharImplToStrings<fbvector<std::string>>;
 template struct SimdSplitByCharImplToStrings<fbvector<fbstring>>;
+
+std::size_t simdFindSubstr(folly::StringPiece what, folly::StringPiece delim) {
+  return PlatformSimdFindDelim<simd_detail::SimdCharPlatform>::substr(
+      what, delim);
+}
+
+std::size_t simdFindAnyOf(folly::StringPiece what, folly::StringPiece chars) {
+  return PlatformSimdFindDelim<simd_detail::SimdCharPlatform>::anyOf(
+      what, chars);
+}
+
 } // namespace detail
 } // namespace folly
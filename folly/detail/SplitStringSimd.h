@@ -147,5 +147,12 @@ extern template struct SimdSplitByCharImplToStrings<
 
 #undef FOLLY_DETAIL_DECLARE_ALL_SIMD_SPLIT_OVERLOADS
 
+// The first occurrence in `what` of `delim`, a string of at least two
+// characters, or npos.
+std::size_t simdFindSubstr(folly::StringPiece what, folly::StringPiece delim);
+
+// The first occurrence in `what` of any of `chars`, or npos.
+std::size_t simdFindAnyOf(folly::StringPiece what, folly::StringPiece chars);
+
 } // namespace detail
 } // namespace folly
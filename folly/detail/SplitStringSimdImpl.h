@@ -16,6 +16,10 @@
 
 #pragma once
 
+#include <array>
+#include <cstring>
+#include <string>
+
 #include <folly/Portability.h>
 #include <folly/Range.h>
 #include <folly/detail/SimdCharPlatform.h>
@@ -135,5 +139,112 @@ struct PlatformSimdSplitByChar<void, ignoreEmpty> {
   }
 };
 
+FOLLY_ALWAYS_INLINE std::size_t findAnyOfScalar(
+    folly::StringPiece what, folly::StringPiece chars) {
+  std::array<bool, 256> isDelim{};
+  for (char c : chars) {
+    isDelim[static_cast<unsigned char>(c)] = true;
+  }
+  for (std::size_t i = 0; i != what.size(); ++i) {
+    if (isDelim[static_cast<unsigned char>(what[i])]) {
+      return i;
+    }
+  }
+  return std::string::npos;
+}
+
+// Finding the delimiters of split() other than single characters: substrings
+// of at least two characters and sets of characters. Both return the
+// position of the first match, or npos.
+template <typename Platform>
+struct PlatformSimdFindDelim {
+  using mmask_t = typename Platform::mmask_t;
+
+  // More characters in a set are looked up in a table instead.
+  static constexpr std::size_t kMaxSimdAnyOf = 8;
+
+  // Returns the element of the lowest bit set and clears its bits.
+  FOLLY_ALWAYS_INLINE static int popFirstElement(mmask_t& mmask) {
+    auto element = (folly::findFirstSet(mmask) - 1) /
+        Platform::kMmaskBitsPerElement;
+    mmask &= ~Platform::template setLowerNBits<mmask_t>(
+        (element + 1) * Platform::kMmaskBitsPerElement);
+    return element;
+  }
+
+  // Candidates are the positions where both the first and the last
+  // character of the delimiter match, and are then compared in full.
+  FOLLY_ALWAYS_INLINE static std::size_t substr(
+      folly::StringPiece what, folly::StringPiece delim) {
+    const std::size_t n = delim.size();
+    if (what.size() < n) {
+      return std::string::npos;
+    }
+    const char* f = what.data();
+    const char* p = f;
+    const char* last = f + what.size() - n;
+    for (; last - p >= Platform::kCardinal - 1; p += Platform::kCardinal) {
+      auto firsts = Platform::movemask(Platform::equal(
+          Platform::loadu(p, simd_detail::ignore_none{}), delim.front()));
+      auto lasts = Platform::movemask(Platform::equal(
+          Platform::loadu(p + n - 1, simd_detail::ignore_none{}),
+          delim.back()));
+      mmask_t mmask = firsts & lasts;
+      while (mmask) {
+        const char* candidate = p + popFirstElement(mmask);
+        if (std::memcmp(candidate + 1, delim.data() + 1, n - 2) == 0) {
+          return std::size_t(candidate - f);
+        }
+      }
+    }
+    for (; p <= last; ++p) {
+      if (*p == delim.front() && std::memcmp(p, delim.data(), n) == 0) {
+        return std::size_t(p - f);
+      }
+    }
+    return std::string::npos;
+  }
+
+  FOLLY_ALWAYS_INLINE static std::size_t anyOf(
+      folly::StringPiece what, folly::StringPiece chars) {
+    if (chars.empty() || chars.size() > kMaxSimdAnyOf) {
+      return findAnyOfScalar(what, chars);
+    }
+    const char* f = what.data();
+    const char* p = f;
+    const char* l = f + what.size();
+    for (; l - p >= Platform::kCardinal; p += Platform::kCardinal) {
+      auto reg = Platform::loadu(p, simd_detail::ignore_none{});
+      auto matches = Platform::equal(reg, chars[0]);
+      for (std::size_t i = 1; i < chars.size(); ++i) {
+        matches = Platform::logical_or(matches, Platform::equal(reg, chars[i]));
+      }
+      mmask_t mmask = Platform::movemask(matches);
+      if (mmask) {
+        return std::size_t(p - f) + popFirstElement(mmask);
+      }
+    }
+    for (; p != l; ++p) {
+      if (chars.find(*p) != std::string::npos) {
+        return std::size_t(p - f);
+      }
+    }
+    return std::string::npos;
+  }
+};
+
+template <>
+struct PlatformSimdFindDelim<void> {
+  FOLLY_ALWAYS_INLINE static std::size_t substr(
+      folly::StringPiece what, folly::StringPiece delim) {
+    return what.find(delim);
+  }
+
+  FOLLY_ALWAYS_INLINE static std::size_t anyOf(
+      folly::StringPiece what, folly::StringPiece chars) {
+    return findAnyOfScalar(what, chars);
+  }
+};
+
 } // namespace detail
 } // namespace folly
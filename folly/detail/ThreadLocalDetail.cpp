@@ -480,6 +480,57 @@ void StaticMetaBase::pushBackUnlocked(ThreadEntry* t, uint32_t id) noexcept {
   }
 }
 
+void StaticMetaBase::forEachElementBatched(
+    uint32_t id,
+    size_t batchSize,
+    FunctionRef<void(void* const* elements, size_t count)> visit) {
+  DCHECK_GT(batchSize, 0u);
+
+  // Nodes are reached through ThreadEntry::elements[id], so the placeholder
+  // needs an elements array that covers id.
+  ThreadEntry cursor;
+  cursor.elements =
+      static_cast<ElementWrapper*>(calloc(id + 1, sizeof(ElementWrapper)));
+  if (!cursor.elements) {
+    throw_exception<std::bad_alloc>();
+  }
+  SCOPE_EXIT { free(cursor.elements); };
+  cursor.setElementsCapacity(id + 1);
+  cursor.meta = this;
+  auto& cursorNode = cursor.elements[id].node;
+  cursorNode.initZero(&cursor, id);
+
+  std::vector<void*> batch;
+  batch.reserve(batchSize);
+  for (bool done = false; !done;) {
+    batch.clear();
+    std::unique_lock wlock(accessAllThreadsLock_);
+    std::lock_guard<std::mutex> g(lock_);
+
+    // The placeholder is unlinked on every pass, so that it is never left
+    // in the list if visit() throws.
+    auto* e =
+        cursorNode.zero() ? head_.elements[id].node.next : cursorNode.next;
+    cursorNode.eraseZero();
+    while (e != &head_ && batch.size() < batchSize) {
+      auto& element = e->elements[id];
+      if (element.ptr) {
+        batch.push_back(element.ptr);
+      }
+      e = element.node.next;
+    }
+    if (!batch.empty()) {
+      visit(batch.data(), batch.size());
+    }
+
+    done = e == &head_;
+    if (!done) {
+      // Link the placeholder in front of the first entry not visited yet.
+      cursorNode.push_back(e);
+    }
+  }
+}
+
 FOLLY_STATIC_CTOR_PRIORITY_MAX
 PthreadKeyUnregister PthreadKeyUnregister::instance_;
 #if defined(__GLIBC__)
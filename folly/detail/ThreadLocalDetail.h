@@ -365,6 +365,17 @@ struct StaticMetaBase {
   void pushBackLocked(ThreadEntry* t, uint32_t id) noexcept;
   void pushBackUnlocked(ThreadEntry* t, uint32_t id) noexcept;
 
+  // Calls visit() with the non-null elements for id of all threads, at most
+  // batchSize of them at a time. Both locks are held while a batch is
+  // collected and visited, and released between batches, so that threads
+  // can start and exit during a long walk. The position in the list is kept
+  // across batches by a placeholder entry linked into it, which has no
+  // element and is skipped by everything else that walks the list.
+  void forEachElementBatched(
+      uint32_t id,
+      size_t batchSize,
+      FunctionRef<void(void* const* elements, size_t count)> visit);
+
   // static helper method to reallocate the ThreadEntry::elements
   // returns != nullptr if the ThreadEntry::elements was reallocated
   // nullptr if the ThreadEntry::elements was just extended
@@ -18,10 +18,34 @@
 #include <folly/Portability.h>
 #include <folly/detail/base64_detail/Base64Api.h>
 #include <folly/detail/base64_detail/Base64SWAR.h>
+#include <folly/detail/base64_detail/Base64_AVX2.h>
+#include <folly/detail/base64_detail/Base64_AVX512.h>
+#include <folly/detail/base64_detail/Base64_NEON.h>
 #include <folly/detail/base64_detail/Base64_SSE4_2.h>
 
 namespace folly::detail::base64_detail {
 Base64RuntimeImpl base64EncodeSelectImplementation() {
+#if FOLLY_BASE64_AVX512 || FOLLY_BASE64_AVX2
+  folly::CpuId cpuId;
+#endif
+#if FOLLY_BASE64_AVX512
+  if (cpuId.avx512bw() && cpuId.avx512vbmi()) {
+    return {
+        base64Encode_AVX512,
+        base64URLEncode_AVX512,
+        base64Decode_AVX512,
+        base64URLDecodeSWAR};
+  }
+#endif
+#if FOLLY_BASE64_AVX2
+  if (cpuId.avx2()) {
+    return {
+        base64Encode_AVX2,
+        base64URLEncode_AVX2,
+        base64Decode_AVX2,
+        base64URLDecodeSWAR};
+  }
+#endif
 #if FOLLY_SSE_PREREQ(4, 2)
   if (folly::CpuId().sse42()) {
     return {
@@ -31,10 +55,18 @@ Base64RuntimeImpl base64EncodeSelectImplementation() {
         base64URLDecodeSWAR};
   }
 #endif
+#if FOLLY_BASE64_NEON
+  return {
+      base64Encode_NEON,
+      base64URLEncode_NEON,
+      base64Decode_NEON,
+      base64URLDecodeSWAR};
+#else
   return {
       base64EncodeScalar,
       base64URLEncodeScalar,
       base64DecodeSWAR,
       base64URLDecodeSWAR};
+#endif
 }
 } // namespace folly::detail::base64_detail
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <folly/Portability.h>
+#include <folly/detail/base64_detail/Base64Common.h>
+
+// Base64_AVX2.cpp is built on x86_64 with AVX2 enabled only for its kernels,
+// by target attributes. Callers must check CpuId().avx2() before using it.
+#if FOLLY_X64
+#define FOLLY_BASE64_AVX2 1
+#else
+#define FOLLY_BASE64_AVX2 0
+#endif
+
+#if FOLLY_BASE64_AVX2
+namespace folly::detail::base64_detail {
+
+char* base64Encode_AVX2(const char* f, const char* l, char* o) noexcept;
+char* base64URLEncode_AVX2(const char* f, const char* l, char* o) noexcept;
+
+Base64DecodeResult base64Decode_AVX2(
+    const char* f, const char* l, char* o) noexcept;
+
+} // namespace folly::detail::base64_detail
+#endif
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/detail/base64_detail/Base64_AVX512.h>
+
+#include <folly/Portability.h>
+
+// The generic loops of Base64Simd.h have no target attribute and pass
+// vectors around, which GCC warns about although they are always inlined
+// into the kernels below.
+FOLLY_PUSH_WARNING
+FOLLY_GCC_DISABLE_WARNING("-Wpsabi")
+
+#include <folly/detail/base64_detail/Base64Simd.h>
+#include <folly/detail/base64_detail/Base64_AVX512_Platform.h>
+
+#if FOLLY_BASE64_AVX512
+
+namespace folly::detail::base64_detail {
+
+FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+char* base64Encode_AVX512(const char* f, const char* l, char* o) noexcept {
+  return base64SimdEncode<Base64_AVX512_Platform>(f, l, o);
+}
+
+FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+char* base64URLEncode_AVX512(const char* f, const char* l, char* o) noexcept {
+  return base64URLSimdEncode<Base64_AVX512_Platform>(f, l, o);
+}
+
+FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+Base64DecodeResult base64Decode_AVX512(
+    const char* f, const char* l, char* o) noexcept {
+  return base64SimdDecode<Base64_AVX512_Platform>(f, l, o);
+}
+
+} // namespace folly::detail::base64_detail
+
+#endif // FOLLY_BASE64_AVX512
+
+FOLLY_POP_WARNING
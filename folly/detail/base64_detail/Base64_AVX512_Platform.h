@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <folly/Portability.h>
+#include <folly/detail/base64_detail/Base64_AVX512.h>
+#include <folly/detail/base64_detail/Base64HiddenConstants.h>
+
+#if FOLLY_BASE64_AVX512
+#include <immintrin.h>
+
+namespace folly::detail::base64_detail {
+
+/*
+ *  NOTE: PLEASE SEE README FOR A DETAILED EXPLANATIONS
+ *        VIRTUALLY IMPOSSIBLE TO DECIPHER OTHERWISE.
+ *
+ *  Requires AVX-512 BW and VBMI. VBMI's byte permute (vpermb) moves bytes
+ *  freely across the whole register, and its multishift (vpmultishiftqb)
+ *  extracts all four 6 bit fields of a dword in one instruction, replacing
+ *  the multiplication trick of the SSE4.2 version.
+ *
+ *  As in Base64_AVX2_Platform, the instruction sets are enabled per function
+ *  with target attributes.
+ */
+
+struct Base64_AVX512_Platform {
+  using reg_t = __m512i;
+  static constexpr std::size_t kRegisterSize = 64;
+
+  // Encode ------------------------------
+
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static reg_t encodeToIndexesPermuteMask() {
+    // Output dword g gets input bytes 3g + (1, 0, 2, 1), as in SSE4.2.
+    alignas(64) static constexpr std::uint8_t kMask[64] = {
+#define FOLLY_BASE64_X(g) 3 * g + 1, 3 * g, 3 * g + 2, 3 * g + 1
+        FOLLY_BASE64_X(0),  FOLLY_BASE64_X(1),  FOLLY_BASE64_X(2),
+        FOLLY_BASE64_X(3),  FOLLY_BASE64_X(4),  FOLLY_BASE64_X(5),
+        FOLLY_BASE64_X(6),  FOLLY_BASE64_X(7),  FOLLY_BASE64_X(8),
+        FOLLY_BASE64_X(9),  FOLLY_BASE64_X(10), FOLLY_BASE64_X(11),
+        FOLLY_BASE64_X(12), FOLLY_BASE64_X(13), FOLLY_BASE64_X(14),
+        FOLLY_BASE64_X(15),
+#undef FOLLY_BASE64_X
+    };
+    return _mm512_load_si512(kMask);
+  }
+
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static reg_t encodeToIndexes(reg_t in) {
+    in = _mm512_permutexvar_epi8(encodeToIndexesPermuteMask(), in);
+
+    // Each dword is now b2b3c1c2'c3d1d2d3'a1a2a3b1'b2b3c1c2, the fields
+    // start at bits 10 (aaa), 4 (bbb), 22 (ccc) and 16 (ddd).
+    const reg_t shifted = _mm512_multishift_epi64_epi8(
+        _mm512_set1_epi64(0x3036242a1016040a), in);
+    return _mm512_and_si512(shifted, _mm512_set1_epi8(0x3f));
+  }
+
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static reg_t lookupByIndex(reg_t in, std::int8_t const* offsetTablePtr) {
+    const reg_t offsetTable = loadTable(offsetTablePtr);
+
+    // 0-51 become 0, 52 and bigger map to 1 and bigger
+    const reg_t reduceTooMuch = _mm512_subs_epu8(in, _mm512_set1_epi8(51));
+
+    // A-Z stays as is, everything else looks one entry further.
+    const reg_t offsetLookup = _mm512_mask_add_epi8(
+        reduceTooMuch,
+        _mm512_cmpgt_epi8_mask(in, _mm512_set1_epi8(25)),
+        reduceTooMuch,
+        _mm512_set1_epi8(1));
+
+    return _mm512_add_epi8(in, _mm512_shuffle_epi8(offsetTable, offsetLookup));
+  }
+
+  // Decode ------------------------------------------------------------
+
+  // See Base64_SSE4_2_Platform::separatePlusAndSlash.
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static reg_t separatePlusAndSlash(reg_t reg) {
+    const reg_t plusAndBelowOffset = _mm512_maskz_mov_epi8(
+        _mm512_cmplt_epi8_mask(reg, _mm512_set1_epi8('+' + 1)),
+        _mm512_set1_epi8(0x0f));
+    return _mm512_subs_epi8(reg, plusAndBelowOffset);
+  }
+
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static reg_t initError() { return _mm512_set1_epi8(static_cast<char>(0xff)); }
+
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static bool hasErrors(reg_t errorAccumulator) {
+    return _mm512_cmpeq_epi8_mask(errorAccumulator, _mm512_setzero_si512()) !=
+        0;
+  }
+
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static reg_t decodeErrorDetection(reg_t reg, reg_t higherNibbles) {
+    // clang-format off
+    const std::int8_t s1_7 = static_cast<std::int8_t>(1 << 7);
+    const reg_t pows2 = _mm512_broadcast_i32x4(_mm_set_epi8(
+        0, 0, 0, 0,
+        0, 0, 0, 0,
+        s1_7,   1 << 6, 1 << 5, 1 << 4,
+        1 << 3, 1 << 2, 1 << 1, 1 << 0));
+    // clang-format on
+
+    reg_t higherNibbleBit = _mm512_shuffle_epi8(pows2, higherNibbles);
+
+    // See Base64_SSE4_2_Platform::decodeErrorDetection.
+    reg_t legalHigherNibblesBits = _mm512_shuffle_epi8(
+        loadTable(constants::kValidHighByLowNibble.data()), reg);
+
+    return _mm512_and_si512(higherNibbleBit, legalHigherNibblesBits);
+  }
+
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static reg_t decodeComputeIndexes(reg_t reg, reg_t higherNibbles) {
+    reg_t offset = _mm512_shuffle_epi8(
+        loadTable(constants::kOffsetByHighNibbleDecodeTable.data()),
+        higherNibbles);
+    return _mm512_add_epi8(offset, reg);
+  }
+
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static reg_t decodeToIndex(reg_t reg, reg_t& errorAccumulator) {
+    reg = separatePlusAndSlash(reg);
+
+    reg_t higherNibbles =
+        _mm512_and_si512(_mm512_srli_epi32(reg, 4), _mm512_set1_epi8(0x0f));
+
+    errorAccumulator = _mm512_min_epu8(
+        decodeErrorDetection(reg, higherNibbles), errorAccumulator);
+
+    return decodeComputeIndexes(reg, higherNibbles);
+  }
+
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static reg_t packIndexesToBytesPermuteMask() {
+    // Output bytes 3g, 3g + 1, 3g + 2 are bytes 2, 1, 0 of dword g.
+    alignas(64) static constexpr std::uint8_t kMask[64] = {
+#define FOLLY_BASE64_X(g) 4 * g + 2, 4 * g + 1, 4 * g
+        FOLLY_BASE64_X(0),  FOLLY_BASE64_X(1),  FOLLY_BASE64_X(2),
+        FOLLY_BASE64_X(3),  FOLLY_BASE64_X(4),  FOLLY_BASE64_X(5),
+        FOLLY_BASE64_X(6),  FOLLY_BASE64_X(7),  FOLLY_BASE64_X(8),
+        FOLLY_BASE64_X(9),  FOLLY_BASE64_X(10), FOLLY_BASE64_X(11),
+        FOLLY_BASE64_X(12), FOLLY_BASE64_X(13), FOLLY_BASE64_X(14),
+        FOLLY_BASE64_X(15),
+#undef FOLLY_BASE64_X
+    };
+    return _mm512_load_si512(kMask);
+  }
+
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static reg_t packIndexesToBytes(reg_t reg) {
+    // ccc << 6 + ddd  aaa << 6 + bbb  (<< 6 == * 0x40)
+    reg_t cccddd_aaabbb = _mm512_maddubs_epi16(reg, _mm512_set1_epi16(0x01'40));
+
+    // Combine the whole epi32 aaabbb << 12 + cccddd (<< 12 == 0x1000)
+    reg_t aaabbbcccddd =
+        _mm512_madd_epi16(cccddd_aaabbb, _mm512_set1_epi32(0x1'1000));
+
+    // 48 bytes of output, zero out the last 16.
+    return _mm512_maskz_permutexvar_epi8(
+        0x0000'ffff'ffff'ffffULL,
+        packIndexesToBytesPermuteMask(),
+        aaabbbcccddd);
+  }
+
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static reg_t loadu(const void* ptr) { return _mm512_loadu_si512(ptr); }
+
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static void storeu(void* ptr, reg_t reg) { _mm512_storeu_si512(ptr, reg); }
+
+  // 16 byte table repeated in all lanes.
+  FOLLY_TARGET_ATTRIBUTE("avx512f,avx512bw,avx512vbmi")
+  static reg_t loadTable(const void* ptr) {
+    return _mm512_broadcast_i32x4(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)));
+  }
+};
+
+} // namespace folly::detail::base64_detail
+
+#endif // FOLLY_BASE64_AVX512
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <folly/Portability.h>
+#include <folly/detail/base64_detail/Base64_NEON.h>
+#include <folly/detail/base64_detail/Base64HiddenConstants.h>
+
+#if FOLLY_BASE64_NEON
+#include <arm_neon.h>
+
+namespace folly::detail::base64_detail {
+
+/*
+ *  NOTE: PLEASE SEE README FOR A DETAILED EXPLANATIONS
+ *        VIRTUALLY IMPOSSIBLE TO DECIPHER OTHERWISE.
+ *
+ *  NEON has per byte variable shifts (vshlq_u8 with negative counts shifting
+ *  right), so instead of the multiplication tricks of the SSE4.2 version
+ *  every output byte is assembled from two shuffled input bytes.
+ *  Unlike pshufb, vqtbl1q_u8 does not ignore the high nibble of the index:
+ *  every index >= 16 yields 0.
+ */
+
+struct Base64_NEON_Platform {
+  using reg_t = uint8x16_t;
+  static constexpr std::size_t kRegisterSize = 16;
+
+  // Encode ------------------------------
+
+  static reg_t encodeToIndexes(reg_t in) {
+    // For input bytes A B C, the indexes are
+    //   A >> 2, A << 4 | B >> 4, B << 2 | C >> 6, C
+    // each masked to 6 bits.
+    // clang-format off
+    alignas(16) static constexpr std::uint8_t kHi[16] = {
+      0, 0, 1, 2,   3, 3, 4, 5,   6, 6, 7, 8,   9, 9, 10, 11,
+    };
+    alignas(16) static constexpr std::uint8_t kLo[16] = {
+      0xff, 1, 2, 0xff,   0xff, 4, 5, 0xff,
+      0xff, 7, 8, 0xff,   0xff, 10, 11, 0xff,
+    };
+    alignas(16) static constexpr std::int8_t kHiShift[16] = {
+      -2, 4, 2, 0,   -2, 4, 2, 0,   -2, 4, 2, 0,   -2, 4, 2, 0,
+    };
+    alignas(16) static constexpr std::int8_t kLoShift[16] = {
+      0, -4, -6, 0,   0, -4, -6, 0,   0, -4, -6, 0,   0, -4, -6, 0,
+    };
+    // clang-format on
+
+    const reg_t hi =
+        vshlq_u8(vqtbl1q_u8(in, vld1q_u8(kHi)), vld1q_s8(kHiShift));
+    const reg_t lo =
+        vshlq_u8(vqtbl1q_u8(in, vld1q_u8(kLo)), vld1q_s8(kLoShift));
+    return vandq_u8(vorrq_u8(hi, lo), vdupq_n_u8(0x3f));
+  }
+
+  static reg_t lookupByIndex(reg_t in, std::int8_t const* offsetTablePtr) {
+    const reg_t offsetTable =
+        vld1q_u8(reinterpret_cast<const std::uint8_t*>(offsetTablePtr));
+
+    // 0-51 become 0, 52 and bigger map to 1 and bigger
+    const reg_t reduceTooMuch = vqsubq_u8(in, vdupq_n_u8(51));
+
+    // 0 when should map to A-Z, otherwise -1.
+    const reg_t biggerThan25 = vcgtq_u8(in, vdupq_n_u8(25));
+
+    const reg_t offsetLookup = vsubq_u8(reduceTooMuch, biggerThan25);
+
+    return vaddq_u8(in, vqtbl1q_u8(offsetTable, offsetLookup));
+  }
+
+  // Decode ------------------------------------------------------------
+
+  // See Base64_SSE4_2_Platform::separatePlusAndSlash.
+  static reg_t separatePlusAndSlash(reg_t reg) {
+    const int8x16_t sreg = vreinterpretq_s8_u8(reg);
+    const reg_t leThanPlus = vcleq_s8(sreg, vdupq_n_s8('+'));
+    const reg_t plusAndBelowOffset = vandq_u8(leThanPlus, vdupq_n_u8(0x0f));
+    return vreinterpretq_u8_s8(
+        vqsubq_s8(sreg, vreinterpretq_s8_u8(plusAndBelowOffset)));
+  }
+
+  static reg_t initError() { return vdupq_n_u8(0xff); }
+
+  static bool hasErrors(reg_t errorAccumulator) {
+    return vminvq_u8(errorAccumulator) == 0;
+  }
+
+  static reg_t decodeErrorDetection(reg_t reg, reg_t higherNibbles) {
+    // clang-format off
+    alignas(16) static constexpr std::uint8_t kPows2[16] = {
+      1 << 0, 1 << 1, 1 << 2, 1 << 3,
+      1 << 4, 1 << 5, 1 << 6, 1 << 7,
+      0, 0, 0, 0,
+      0, 0, 0, 0,
+    };
+    // clang-format on
+
+    reg_t higherNibbleBit = vqtbl1q_u8(vld1q_u8(kPows2), higherNibbles);
+
+    // Negative input bytes have no bit set in higherNibbleBit, so their
+    // lower nibble lookup does not matter.
+    reg_t legalHigherNibblesBits = vqtbl1q_u8(
+        vld1q_u8(constants::kValidHighByLowNibble.data()),
+        vandq_u8(reg, vdupq_n_u8(0x0f)));
+
+    return vandq_u8(higherNibbleBit, legalHigherNibblesBits);
+  }
+
+  static reg_t decodeComputeIndexes(reg_t reg, reg_t higherNibbles) {
+    reg_t offset = vqtbl1q_u8(
+        vld1q_u8(reinterpret_cast<const std::uint8_t*>(
+            constants::kOffsetByHighNibbleDecodeTable.data())),
+        higherNibbles);
+    return vaddq_u8(offset, reg);
+  }
+
+  static reg_t decodeToIndex(reg_t reg, reg_t& errorAccumulator) {
+    reg = separatePlusAndSlash(reg);
+
+    reg_t higherNibbles = vshrq_n_u8(reg, 4);
+
+    errorAccumulator = vminq_u8(
+        decodeErrorDetection(reg, higherNibbles), errorAccumulator);
+
+    return decodeComputeIndexes(reg, higherNibbles);
+  }
+
+  static reg_t packIndexesToBytes(reg_t reg) {
+    // For indexes a b c d, the bytes are
+    //   a << 2 | b >> 4, b << 4 | c >> 2, c << 6 | d
+    // clang-format off
+    alignas(16) static constexpr std::uint8_t kHi[16] = {
+      0, 1, 2,   4, 5, 6,   8, 9, 10,   12, 13, 14,   0xff, 0xff, 0xff, 0xff,
+    };
+    alignas(16) static constexpr std::uint8_t kLo[16] = {
+      1, 2, 3,   5, 6, 7,   9, 10, 11,   13, 14, 15,   0xff, 0xff, 0xff, 0xff,
+    };
+    alignas(16) static constexpr std::int8_t kHiShift[16] = {
+      2, 4, 6,   2, 4, 6,   2, 4, 6,   2, 4, 6,   0, 0, 0, 0,
+    };
+    alignas(16) static constexpr std::int8_t kLoShift[16] = {
+      -4, -2, 0,   -4, -2, 0,   -4, -2, 0,   -4, -2, 0,   0, 0, 0, 0,
+    };
+    // clang-format on
+
+    const reg_t hi =
+        vshlq_u8(vqtbl1q_u8(reg, vld1q_u8(kHi)), vld1q_s8(kHiShift));
+    const reg_t lo =
+        vshlq_u8(vqtbl1q_u8(reg, vld1q_u8(kLo)), vld1q_s8(kLoShift));
+    return vorrq_u8(hi, lo);
+  }
+
+  static reg_t loadu(const void* ptr) {
+    return vld1q_u8(static_cast<const std::uint8_t*>(ptr));
+  }
+
+  static void storeu(void* ptr, reg_t reg) {
+    vst1q_u8(static_cast<std::uint8_t*>(ptr), reg);
+  }
+};
+
+} // namespace folly::detail::base64_detail
+
+#endif // FOLLY_BASE64_NEON
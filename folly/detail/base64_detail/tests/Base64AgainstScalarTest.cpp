@@ -20,9 +20,14 @@
 #include <optional>
 #include <random>
 #include <string_view>
+#include <vector>
+#include <folly/CpuId.h>
 #include <folly/detail/base64_detail/Base64Common.h>
 #include <folly/detail/base64_detail/Base64SWAR.h>
 #include <folly/detail/base64_detail/Base64Scalar.h>
+#include <folly/detail/base64_detail/Base64_AVX2.h>
+#include <folly/detail/base64_detail/Base64_AVX512.h>
+#include <folly/detail/base64_detail/Base64_NEON.h>
 #include <folly/detail/base64_detail/Base64_SSE4_2.h>
 #include <folly/portability/GTest.h>
 
@@ -69,27 +74,79 @@ auto callDecode(std::string_view encoded, Decode decode)
   return buf;
 }
 
-constexpr Encode kEncodes[] = {
-    base64EncodeScalar,
+// The AVX kernels are built on every x86_64 machine but can only run on
+// some of them.
+bool hasAVX2() {
+  return folly::CpuId().avx2();
+}
+
+bool hasAVX512() {
+  folly::CpuId cpuId;
+  return cpuId.avx512bw() && cpuId.avx512vbmi();
+}
+
+const std::vector<Encode> kEncodes = [] {
+  std::vector<Encode> res = {base64EncodeScalar};
 #if FOLLY_SSE_PREREQ(4, 2)
-    base64Encode_SSE4_2,
+  res.push_back(base64Encode_SSE4_2);
 #endif
-};
+#if FOLLY_BASE64_AVX2
+  if (hasAVX2()) {
+    res.push_back(base64Encode_AVX2);
+  }
+#endif
+#if FOLLY_BASE64_AVX512
+  if (hasAVX512()) {
+    res.push_back(base64Encode_AVX512);
+  }
+#endif
+#if FOLLY_BASE64_NEON
+  res.push_back(base64Encode_NEON);
+#endif
+  return res;
+}();
 
-constexpr Encode kEncodesURL[] = {
-    base64URLEncodeScalar,
+const std::vector<Encode> kEncodesURL = [] {
+  std::vector<Encode> res = {base64URLEncodeScalar};
 #if FOLLY_SSE_PREREQ(4, 2)
-    base64URLEncode_SSE4_2,
+  res.push_back(base64URLEncode_SSE4_2);
 #endif
-};
+#if FOLLY_BASE64_AVX2
+  if (hasAVX2()) {
+    res.push_back(base64URLEncode_AVX2);
+  }
+#endif
+#if FOLLY_BASE64_AVX512
+  if (hasAVX512()) {
+    res.push_back(base64URLEncode_AVX512);
+  }
+#endif
+#if FOLLY_BASE64_NEON
+  res.push_back(base64URLEncode_NEON);
+#endif
+  return res;
+}();
 
-constexpr Decode kDecodes[] = {
-    base64DecodeScalar,
-    base64DecodeSWAR,
+const std::vector<Decode> kDecodes = [] {
+  std::vector<Decode> res = {base64DecodeScalar, base64DecodeSWAR};
 #if FOLLY_SSE_PREREQ(4, 2)
-    base64Decode_SSE4_2,
+  res.push_back(base64Decode_SSE4_2);
 #endif
-};
+#if FOLLY_BASE64_AVX2
+  if (hasAVX2()) {
+    res.push_back(base64Decode_AVX2);
+  }
+#endif
+#if FOLLY_BASE64_AVX512
+  if (hasAVX512()) {
+    res.push_back(base64Decode_AVX512);
+  }
+#endif
+#if FOLLY_BASE64_NEON
+  res.push_back(base64Decode_NEON);
+#endif
+  return res;
+}();
 
 constexpr Decode kDecodesURL[] = {
     base64URLDecodeScalar,
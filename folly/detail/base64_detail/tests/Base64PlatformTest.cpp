@@ -22,11 +22,16 @@
 #include <vector>
 #include <folly/portability/GTest.h>
 
+#include <folly/detail/base64_detail/Base64_NEON_Platform.h>
 #include <folly/detail/base64_detail/Base64_SSE4_2_Platform.h>
 
+// The AVX2 and AVX-512 platforms need their instruction sets enabled for the
+// whole translation unit; they are covered through the compiled kernels in
+// Base64AgainstScalarTest and Base64SpecialCasesTest instead.
+
 namespace folly::detail::base64_detail {
 namespace {
-#if FOLLY_SSE_PREREQ(4, 2)
+#if FOLLY_SSE_PREREQ(4, 2) || FOLLY_BASE64_NEON
 
 std::array<std::uint8_t, 16> expectedEncodeToIndexes(
     std::array<std::uint8_t, 16> in) {
@@ -161,7 +166,13 @@ struct Base64PlatformTest : ::testing::Test {
   }
 };
 
-TYPED_TEST_SUITE(Base64PlatformTest, ::testing::Types<Base64_SSE4_2_Platform>);
+#if FOLLY_SSE_PREREQ(4, 2)
+using Base64Platforms = ::testing::Types<Base64_SSE4_2_Platform>;
+#else
+using Base64Platforms = ::testing::Types<Base64_NEON_Platform>;
+#endif
+
+TYPED_TEST_SUITE(Base64PlatformTest, Base64Platforms);
 
 TYPED_TEST(Base64PlatformTest, EncodeToIndexes) {
   using RegBytes = typename TestFixture::RegBytesArray;
@@ -267,7 +278,7 @@ TYPED_TEST(Base64PlatformTest, packIndexesToBytes) {
     ASSERT_EQ(expected, actual);
   }
 }
-#endif // FOLLY_SSE_PREREQ(4, 2)
+#endif // FOLLY_SSE_PREREQ(4, 2) || FOLLY_BASE64_NEON
 
 } // namespace
 } // namespace folly::detail::base64_detail
@@ -19,8 +19,12 @@
 #include <sstream>
 #include <string_view>
 #include <type_traits>
+#include <folly/CpuId.h>
 #include <folly/detail/base64_detail/Base64Scalar.h>
 #include <folly/detail/base64_detail/Base64Simd.h>
+#include <folly/detail/base64_detail/Base64_AVX2.h>
+#include <folly/detail/base64_detail/Base64_AVX512.h>
+#include <folly/detail/base64_detail/Base64_NEON.h>
 #include <folly/detail/base64_detail/Base64_SSE4_2.h>
 #include <folly/portability/Constexpr.h>
 #include <folly/portability/GTest.h>
@@ -404,6 +408,31 @@ TEST(Base64, SpecialCases) {
       base64Decode_SSE4_2,
       base64URLDecodeSWAR}));
 #endif
+#if FOLLY_BASE64_AVX2
+  if (folly::CpuId().avx2()) {
+    ASSERT_TRUE(runEncodeTests(SimdTester{
+        base64Encode_AVX2,
+        base64URLEncode_AVX2,
+        base64Decode_AVX2,
+        base64URLDecodeSWAR}));
+  }
+#endif
+#if FOLLY_BASE64_AVX512
+  if (folly::CpuId().avx512bw() && folly::CpuId().avx512vbmi()) {
+    ASSERT_TRUE(runEncodeTests(SimdTester{
+        base64Encode_AVX512,
+        base64URLEncode_AVX512,
+        base64Decode_AVX512,
+        base64URLDecodeSWAR}));
+  }
+#endif
+#if FOLLY_BASE64_NEON
+  ASSERT_TRUE(runEncodeTests(SimdTester{
+      base64Encode_NEON,
+      base64URLEncode_NEON,
+      base64Decode_NEON,
+      base64URLDecodeSWAR}));
+#endif
 }
 
 constexpr char kHasNegative0[] = {'A', 'b', 'c', -15, '\0'};
@@ -549,6 +578,19 @@ TEST(Base64, DecodingErrorDeteciton) {
 #if FOLLY_SSE_PREREQ(4, 2)
   ASSERT_TRUE(decodingErrorDectionTest<false>(base64Decode_SSE4_2));
 #endif
+#if FOLLY_BASE64_AVX2
+  if (folly::CpuId().avx2()) {
+    ASSERT_TRUE(decodingErrorDectionTest<false>(base64Decode_AVX2));
+  }
+#endif
+#if FOLLY_BASE64_AVX512
+  if (folly::CpuId().avx512bw() && folly::CpuId().avx512vbmi()) {
+    ASSERT_TRUE(decodingErrorDectionTest<false>(base64Decode_AVX512));
+  }
+#endif
+#if FOLLY_BASE64_NEON
+  ASSERT_TRUE(decodingErrorDectionTest<false>(base64Decode_NEON));
+#endif
 }
 
 } // namespace
@@ -235,5 +235,50 @@ TEST(SplitStringSimd, ByCharTestDifferentOffsets) {
   }
 }
 
+template <typename Platform>
+void runTestFindDelim(folly::StringPiece s) {
+  std::string_view sv(s.data(), s.size());
+  for (std::string_view delim : {"ab", "aba", "abba", "bbbbbbbbbbbbbbbbba"}) {
+    folly::StringPiece d(delim.data(), delim.size());
+    ASSERT_EQ(sv.find(delim), PlatformSimdFindDelim<Platform>::substr(s, d))
+        << s << " : " << delim;
+  }
+  for (std::string_view chars : {"", "b", "bc", "cdefghib", "cdefghijb"}) {
+    folly::StringPiece c(chars.data(), chars.size());
+    ASSERT_EQ(
+        sv.find_first_of(chars), PlatformSimdFindDelim<Platform>::anyOf(s, c))
+        << s << " : " << chars;
+  }
+}
+
+void runTestFindDelim(folly::StringPiece s) {
+  runTestFindDelim<void>(s);
+#if FOLLY_X64
+  runTestFindDelim<simd_detail::SimdCharSse2Platform>(s);
+#if defined(__AVX2__)
+  runTestFindDelim<simd_detail::SimdCharAvx2Platform>(s);
+#endif
+#endif
+#if FOLLY_AARCH64
+  runTestFindDelim<simd_detail::SimdCharAarch64Platform>(s);
+#endif
+}
+
+TEST(SplitStringSimd, FindDelimDifferentOffsets) {
+  alignas(32) std::array<char, 100> buf;
+
+  std::mt19937 gen;
+  std::uniform_int_distribution<> dis(0, 3);
+  for (auto& c : buf) {
+    c = dis(gen) ? 'b' : 'a';
+  }
+
+  for (auto f = buf.begin(); f != buf.end(); ++f) {
+    for (auto l = f; l != buf.end(); ++l) {
+      runTestFindDelim({f, l});
+    }
+  }
+}
+
 } // namespace detail
 } // namespace folly
@@ -18,12 +18,15 @@
 #include <folly/executors/CPUThreadPoolExecutor.h>
 
 #include <atomic>
+#include <vector>
 #include <folly/Memory.h>
 #include <folly/Optional.h>
 #include <folly/executors/QueueObserver.h>
+#include <folly/executors/task_queue/NumaBlockingQueue.h>
 #include <folly/executors/task_queue/PriorityLifoSemMPMCQueue.h>
 #include <folly/executors/task_queue/PriorityUnboundedBlockingQueue.h>
 #include <folly/executors/task_queue/UnboundedBlockingQueue.h>
+#include <folly/executors/task_queue/WorkStealingBlockingQueue.h>
 #include <folly/portability/GFlags.h>
 #include <folly/synchronization/ThrottledLifoSem.h>
 
@@ -79,6 +82,21 @@ CPUThreadPoolExecutor::CPUTask::CPUTask()
       numPriorities, opts);
 }
 
+/* static */ auto CPUThreadPoolExecutor::makeWorkStealingQueue(
+    size_t numThreads, bool lifoSlot)
+    -> std::unique_ptr<BlockingQueue<CPUTask>> {
+  return std::make_unique<WorkStealingBlockingQueue<CPUTask>>(
+      numThreads,
+      WorkStealingBlockingQueue<CPUTask>::kDefaultDequeCapacity,
+      LifoSem::Options{},
+      lifoSlot);
+}
+
+/* static */ auto CPUThreadPoolExecutor::makeNumaQueue(
+    const NumaTopology& topology) -> std::unique_ptr<BlockingQueue<CPUTask>> {
+  return std::make_unique<NumaBlockingQueue<CPUTask>>(topology);
+}
+
 CPUThreadPoolExecutor::CPUThreadPoolExecutor(
     size_t numThreads,
     std::unique_ptr<BlockingQueue<CPUTask>> taskQueue,
@@ -267,6 +285,50 @@ void CPUThreadPoolExecutor::addImpl(
   }
 }
 
+void CPUThreadPoolExecutor::addBatch(Range<Func*> funcs) {
+  std::vector<CPUTask> tasks;
+  tasks.reserve(funcs.size());
+  for (auto& func : funcs) {
+    if (!func) {
+      invokeCatchingExns("ThreadPoolExecutor: func", std::move(func));
+      continue;
+    }
+    tasks.emplace_back(
+        std::move(func), std::chrono::milliseconds(0), Func(), int8_t(0));
+    auto& task = tasks.back();
+    if (auto queueObserver = getQueueObserver(0)) {
+      task.queueObserverPayload_ =
+          queueObserver->onEnqueued(task.context_.get());
+    }
+    registerTaskEnqueue(task);
+  }
+  if (tasks.empty()) {
+    return;
+  }
+
+  // As in addImpl(), the executor may be gone once the tasks are queued.
+  bool mayNeedToAddThreads = minThreads_.load(std::memory_order_relaxed) == 0 ||
+      activeThreads_.load(std::memory_order_relaxed) <
+          maxThreads_.load(std::memory_order_relaxed);
+  folly::Executor::KeepAlive<> ka = mayNeedToAddThreads
+      ? getKeepAliveToken(this)
+      : folly::Executor::KeepAlive<>{};
+
+  auto numTasks = tasks.size();
+  auto result = taskQueue_->addBatch(range(tasks));
+
+  if (mayNeedToAddThreads && !result.reusedThread) {
+    // Start up to one thread per task, as that many add()s would.
+    for (size_t i = 0; i < numTasks; ++i) {
+      if (activeThreads_.load(std::memory_order_relaxed) >=
+          maxThreads_.load(std::memory_order_relaxed)) {
+        break;
+      }
+      ensureActiveThreads();
+    }
+  }
+}
+
 uint8_t CPUThreadPoolExecutor::getNumPriorities() const {
   return taskQueue_->getNumPriorities();
 }
@@ -22,6 +22,7 @@
 
 #include <folly/executors/QueueObserver.h>
 #include <folly/executors/ThreadPoolExecutor.h>
+#include <folly/system/NumaTopology.h>
 
 FOLLY_GFLAGS_DECLARE_bool(dynamic_cputhreadpoolexecutor);
 
@@ -98,6 +99,20 @@ class CPUThreadPoolExecutor : public ThreadPoolExecutor,
   makeThrottledLifoSemPriorityQueue(
       int8_t numPriorities, std::chrono::nanoseconds wakeUpInterval = {});
 
+  // Returns a WorkStealingBlockingQueue with a deque for each of up to
+  // numThreads worker threads. Tasks added from a worker thread stay on
+  // that worker unless stolen by an idle one. With lifoSlot, the last one
+  // runs next, e.g. the continuation of a coroutine woken up by the
+  // current task.
+  static std::unique_ptr<BlockingQueue<CPUTask>> makeWorkStealingQueue(
+      size_t numThreads, bool lifoSlot = false);
+
+  // Returns a NumaBlockingQueue with one queue per node of the topology.
+  // Use it with a NumaThreadFactory for the same topology, so that worker
+  // threads are bound to the nodes whose tasks they run.
+  static std::unique_ptr<BlockingQueue<CPUTask>> makeNumaQueue(
+      const NumaTopology& topology = NumaTopology::system());
+
   CPUThreadPoolExecutor(
       size_t numThreads,
       std::unique_ptr<BlockingQueue<CPUTask>> taskQueue,
@@ -149,6 +164,10 @@ class CPUThreadPoolExecutor : public ThreadPoolExecutor,
       Func expireCallback = nullptr) override;
 
   void addWithPriority(Func func, int8_t priority) override;
+
+  /// Enqueues the whole batch at once, so that with the default queues
+  /// idle threads are woken up only once for all of it.
+  void addBatch(Range<Func*> funcs) override;
   virtual void add(
       Func func,
       int8_t priority,
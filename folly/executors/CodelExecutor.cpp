@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/CodelExecutor.h>
+
+#include <glog/logging.h>
+
+#include <folly/ScopeGuard.h>
+
+namespace folly {
+
+namespace {
+Codel::Options toCodelOptions(const CodelExecutor::Options& options) {
+  CHECK_LT(options.targetDelay, options.interval);
+  return Codel::Options()
+      .setTargetDelay(options.targetDelay)
+      .setInterval(options.interval);
+}
+} // namespace
+
+CodelExecutor::CodelExecutor(
+    std::unique_ptr<Executor> executor, Options options)
+    : CodelExecutor(getKeepAliveToken(*executor), std::move(options)) {
+  ownedExecutor_ = std::move(executor);
+}
+
+CodelExecutor::CodelExecutor(KeepAlive<> executor, Options options)
+    : executor_(std::move(executor)),
+      shedOverloaded_(options.shedOverloaded),
+      rejectLoad_(options.rejectLoad),
+      codel_(toCodelOptions(options)) {}
+
+CodelExecutor::~CodelExecutor() {
+  joinKeepAlive();
+}
+
+void CodelExecutor::add(Func func) {
+  executor_->add(wrap(std::move(func), Func()));
+}
+
+void CodelExecutor::addWithPriority(Func func, int8_t priority) {
+  executor_->addWithPriority(wrap(std::move(func), Func()), priority);
+}
+
+uint8_t CodelExecutor::getNumPriorities() const {
+  return executor_->getNumPriorities();
+}
+
+void CodelExecutor::addWithShedCallback(Func func, Func onShed) {
+  executor_->add(wrap(std::move(func), std::move(onShed)));
+}
+
+bool CodelExecutor::tryAdd(Func&& func, Func onShed) {
+  // Codel only learns about queueing delay as tasks are dequeued, so its load
+  // estimate goes stale once the queue drains. Never reject while nothing is
+  // pending, otherwise a saturated reading could lock out new work forever.
+  if (pendingTasks() > 0 && getLoad() >= rejectLoad_) {
+    numRejected_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  addWithShedCallback(std::move(func), std::move(onShed));
+  return true;
+}
+
+Func CodelExecutor::wrap(Func func, Func onShed) {
+  pending_.fetch_add(1, std::memory_order_relaxed);
+  return [ka = getKeepAliveToken(this),
+          func = std::move(func),
+          onShed = std::move(onShed),
+          enqueueTime = std::chrono::steady_clock::now()]() mutable {
+    ka->runOrShed(func, onShed, enqueueTime);
+  };
+}
+
+void CodelExecutor::runOrShed(
+    Func& func,
+    Func& onShed,
+    std::chrono::steady_clock::time_point enqueueTime) {
+  SCOPE_EXIT {
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+  };
+  auto now = std::chrono::steady_clock::now();
+  if (codel_.overloaded_explicit_now(now - enqueueTime, now)) {
+    numShed_.fetch_add(1, std::memory_order_relaxed);
+    if (shedOverloaded_) {
+      if (onShed) {
+        onShed();
+      }
+      return;
+    }
+  }
+  func();
+}
+
+} // namespace folly
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include <folly/DefaultKeepAliveExecutor.h>
+#include <folly/executors/Codel.h>
+
+namespace folly {
+
+/// An executor adapter that applies Codel admission control to any wrapped
+/// executor.
+///
+/// Every task is stamped with its enqueue time. When the wrapped executor
+/// finally runs it, the time the task spent queued is fed to Codel; if Codel
+/// reports that the queue is overloaded (every task during the last interval
+/// waited longer than the target delay) and this task has waited longer than
+/// the slough timeout, the task is shed instead of run. Callers that need to
+/// know may supply an onShed callback, which runs in place of the task on the
+/// wrapped executor.
+///
+/// Codel's load estimate is also exposed through getLoad(), and tryAdd()
+/// rejects work up front while the queue is saturated, which lets a server
+/// fail fast at admission rather than queue work that will be shed later.
+///
+/// Example:
+///   auto pool = std::make_unique<CPUThreadPoolExecutor>(8);
+///   CodelExecutor codel(std::move(pool));
+///   if (!codel.tryAdd([] { handleRequest(); }, [] { replyOverloaded(); })) {
+///     replyOverloaded();
+///   }
+class CodelExecutor : public DefaultKeepAliveExecutor {
+ public:
+  struct Options {
+    Options() {}
+    /// Codel target queueing delay; must be smaller than interval.
+    std::chrono::milliseconds targetDelay{5};
+    /// Codel measurement interval.
+    std::chrono::milliseconds interval{100};
+    /// If false, overloaded tasks are still run and only counted; useful to
+    /// observe load without changing behavior.
+    bool shedOverloaded{true};
+    /// tryAdd() rejects new work while getLoad() is at least this value.
+    int rejectLoad{100};
+  };
+
+  // owning constructor
+  explicit CodelExecutor(
+      std::unique_ptr<Executor> executor, Options options = Options());
+  // non-owning constructor
+  explicit CodelExecutor(KeepAlive<> executor, Options options = Options());
+
+  ~CodelExecutor() override;
+
+  void add(Func func) override;
+  void addWithPriority(Func func, int8_t priority) override;
+  uint8_t getNumPriorities() const override;
+
+  /// Like add(), but runs onShed instead of func if the task is shed.
+  void addWithShedCallback(Func func, Func onShed);
+
+  /// Admission-controlled add. Returns false, leaving func untouched, if the
+  /// executor is currently saturated. Otherwise behaves like
+  /// addWithShedCallback().
+  bool tryAdd(Func&& func, Func onShed = {});
+
+  /// Codel load estimate: 0 = no queueing delay, 100 = at the queueing limit.
+  int getLoad() { return codel_.getLoad(); }
+
+  /// Number of tasks added but not yet run or shed.
+  size_t pendingTasks() const {
+    return pending_.load(std::memory_order_relaxed);
+  }
+
+  /// Number of tasks whose queueing delay Codel judged excessive. When
+  /// shedOverloaded is false these tasks were run anyway.
+  uint64_t numShed() const { return numShed_.load(std::memory_order_relaxed); }
+
+  /// Number of tasks rejected by tryAdd().
+  uint64_t numRejected() const {
+    return numRejected_.load(std::memory_order_relaxed);
+  }
+
+  Codel& getCodel() { return codel_; }
+
+ private:
+  Func wrap(Func func, Func onShed);
+  void runOrShed(
+      Func& func,
+      Func& onShed,
+      std::chrono::steady_clock::time_point enqueueTime);
+
+  std::unique_ptr<Executor> ownedExecutor_;
+  KeepAlive<> executor_;
+  const bool shedOverloaded_;
+  const int rejectLoad_;
+  Codel codel_;
+  std::atomic<size_t> pending_{0};
+  std::atomic<uint64_t> numShed_{0};
+  std::atomic<uint64_t> numRejected_{0};
+};
+
+} // namespace folly
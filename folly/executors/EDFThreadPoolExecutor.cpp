@@ -76,10 +76,31 @@ class EDFThreadPoolExecutor::Task {
       fs_[i]();
       std::exchange(fs_[i], nullptr);
     }
+    expireCallback_ = nullptr;
+  }
+
+  // Drops iteration i instead of running it.
+  void expire(int i) {
+    folly::RequestContextScopeGuard guard(context_);
+    if (f_) {
+      if (i >= total_ - 1) {
+        std::exchange(f_, nullptr);
+      }
+    } else {
+      DCHECK(0 <= i && i < total_);
+      std::exchange(fs_[i], nullptr);
+    }
+    if (expireCallback_) {
+      invokeCatchingExns(
+          "EDFThreadPoolExecutor: expireCallback",
+          std::exchange(expireCallback_, {}));
+    }
   }
 
   Func f_;
   std::vector<Func> fs_;
+  // Only set for single tasks.
+  Func expireCallback_;
   std::atomic<int> iter_{0};
   int total_;
   uint64_t deadline_;
@@ -267,11 +288,29 @@ EDFThreadPoolExecutor::makeThrottledLifoSemSemaphore(
   return std::make_unique<EDFThreadPoolSemaphoreImpl<ThrottledLifoSem>>(opts);
 }
 
+/* static */ uint64_t EDFThreadPoolExecutor::steadyClockNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 EDFThreadPoolExecutor::EDFThreadPoolExecutor(
     std::size_t numThreads,
     std::shared_ptr<ThreadFactory> threadFactory,
     std::unique_ptr<EDFThreadPoolSemaphore> semaphore)
+    : EDFThreadPoolExecutor(
+          numThreads,
+          Options{},
+          std::move(threadFactory),
+          std::move(semaphore)) {}
+
+EDFThreadPoolExecutor::EDFThreadPoolExecutor(
+    std::size_t numThreads,
+    Options options,
+    std::shared_ptr<ThreadFactory> threadFactory,
+    std::unique_ptr<EDFThreadPoolSemaphore> semaphore)
     : ThreadPoolExecutor(numThreads, numThreads, std::move(threadFactory)),
+      options_(std::move(options)),
       taskQueue_(std::make_unique<TaskQueue>()),
       sem_(std::move(semaphore)) {
   setNumThreads(numThreads);
@@ -292,16 +331,7 @@ void EDFThreadPoolExecutor::add(Func f, std::size_t total, uint64_t deadline) {
     return;
   }
 
-  auto task = std::make_shared<Task>(std::move(f), total, deadline);
-  registerTaskEnqueue(*task);
-  taskQueue_->push(std::move(task));
-
-  auto numIdleThreads = numIdleThreads_.load(std::memory_order_seq_cst);
-  if (numIdleThreads > 0) {
-    // If idle threads are available notify them, otherwise all worker threads
-    // are running and will get around to this task in time.
-    sem_->post(std::min(total, numIdleThreads));
-  }
+  addTask(std::make_shared<Task>(std::move(f), total, deadline), total);
 }
 
 void EDFThreadPoolExecutor::add(std::vector<Func> fs, uint64_t deadline) {
@@ -310,7 +340,22 @@ void EDFThreadPoolExecutor::add(std::vector<Func> fs, uint64_t deadline) {
   }
 
   auto total = fs.size();
-  auto task = std::make_shared<Task>(std::move(fs), deadline);
+  addTask(std::make_shared<Task>(std::move(fs), deadline), total);
+}
+
+void EDFThreadPoolExecutor::addWithDeadline(
+    Func f, uint64_t deadline, Func expireCallback) {
+  if (FOLLY_UNLIKELY(isJoin_.load(std::memory_order_relaxed))) {
+    return;
+  }
+
+  auto task = std::make_shared<Task>(std::move(f), 1, deadline);
+  task->expireCallback_ = std::move(expireCallback);
+  addTask(std::move(task), 1);
+}
+
+void EDFThreadPoolExecutor::addTask(
+    std::shared_ptr<Task> task, std::size_t total) {
   registerTaskEnqueue(*task);
   taskQueue_->push(std::move(task));
 
@@ -365,10 +410,15 @@ void EDFThreadPoolExecutor::threadRun(ThreadPtr thread) {
     forEachTaskObserver(
         [&](auto& observer) { observer.taskDequeued(taskInfo); });
 
-    invokeCatchingExns("EDFThreadPoolExecutor: func", [&] {
-      std::exchange(task, {})->run(iter);
-    });
-    taskInfo.runTime = std::chrono::steady_clock::now() - startTime;
+    if (FOLLY_UNLIKELY(isExpired(*task))) {
+      taskInfo.expired = true;
+      std::exchange(task, {})->expire(iter);
+    } else {
+      invokeCatchingExns("EDFThreadPoolExecutor: func", [&] {
+        std::exchange(task, {})->run(iter);
+      });
+      taskInfo.runTime = std::chrono::steady_clock::now() - startTime;
+    }
 
     FOLLY_SDT(
         folly,
@@ -453,6 +503,23 @@ std::shared_ptr<EDFThreadPoolExecutor::Task> EDFThreadPoolExecutor::take() {
   }
 }
 
+bool EDFThreadPoolExecutor::isExpired(const Task& task) {
+  if (!options_.clock) {
+    return false;
+  }
+  auto now = options_.clock();
+  auto deadline = task.getDeadline();
+  if (now <= deadline) {
+    return false;
+  }
+  numDeadlineMisses_.fetch_add(1, std::memory_order_relaxed);
+  if (now - deadline <= options_.expirySlack) {
+    return false;
+  }
+  numExpiredTasks_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
 void EDFThreadPoolExecutor::fillTaskInfo(const Task& task, TaskInfo& info) {
   info.priority = 0; // Priorities are not supported.
   if (task.context_) {
@@ -22,6 +22,7 @@
 #include <memory>
 #include <vector>
 
+#include <folly/Function.h>
 #include <folly/executors/SoftRealTimeExecutor.h>
 #include <folly/executors/ThreadPoolExecutor.h>
 
@@ -52,6 +53,13 @@ class EDFThreadPoolSemaphoreImpl : public EDFThreadPoolSemaphore {
  * `EDFThreadPoolExecutor` is a `SoftRealTimeExecutor` that implements the
  * earliest-deadline-first scheduling policy. Deadline ties are resolved by
  * submission order.
+ *
+ * Deadlines are abstract, so by default tasks run however late they are. If
+ * Options::clock is set, deadlines are taken to be in its unit, and a task
+ * that a thread only gets to after its deadline is counted as a miss. One
+ * that is late by more than Options::expirySlack is expired instead: it is
+ * not run, and its expireCallback, if any, is invoked instead. Under
+ * overload this keeps the threads on the work that can still make it.
  */
 class EDFThreadPoolExecutor : public SoftRealTimeExecutor,
                               public ThreadPoolExecutor {
@@ -63,6 +71,17 @@ class EDFThreadPoolExecutor : public SoftRealTimeExecutor,
   static constexpr uint64_t kLatestDeadline =
       std::numeric_limits<uint64_t>::max();
 
+  struct Options {
+    // Returns the current time in the unit of the deadlines, e.g.
+    // steadyClockNs(). Deadlines are not checked unless this is set.
+    Function<uint64_t() const> clock;
+    // How late a task can be and still run.
+    uint64_t expirySlack = kLatestDeadline;
+  };
+
+  // Nanoseconds of std::chrono::steady_clock, for Options::clock.
+  static uint64_t steadyClockNs();
+
   // Default semaphore is LifoSem.
   static std::unique_ptr<EDFThreadPoolSemaphore> makeDefaultSemaphore();
   static std::unique_ptr<EDFThreadPoolSemaphore> makeThrottledLifoSemSemaphore(
@@ -75,6 +94,14 @@ class EDFThreadPoolExecutor : public SoftRealTimeExecutor,
       std::unique_ptr<EDFThreadPoolSemaphore> semaphore =
           makeDefaultSemaphore());
 
+  EDFThreadPoolExecutor(
+      std::size_t numThreads,
+      Options options,
+      std::shared_ptr<ThreadFactory> threadFactory =
+          std::make_shared<NamedThreadFactory>("EDFThreadPool"),
+      std::unique_ptr<EDFThreadPoolSemaphore> semaphore =
+          makeDefaultSemaphore());
+
   ~EDFThreadPoolExecutor() override;
 
   using SoftRealTimeExecutor::add;
@@ -84,6 +111,23 @@ class EDFThreadPoolExecutor : public SoftRealTimeExecutor,
   void add(Func f, std::size_t total, uint64_t deadline) override;
   void add(std::vector<Func> fs, uint64_t deadline) override;
 
+  /**
+   * Adds a task that is expired, rather than run, if it is still queued
+   * Options::expirySlack after its deadline; expireCallback is then invoked
+   * in its place.
+   */
+  void addWithDeadline(Func f, uint64_t deadline, Func expireCallback);
+
+  // Tasks started after their deadline, expired ones included.
+  uint64_t getNumDeadlineMisses() const {
+    return numDeadlineMisses_.load(std::memory_order_relaxed);
+  }
+
+  // Tasks dropped because they were too late to run.
+  uint64_t getNumExpiredTasks() const {
+    return numExpiredTasks_.load(std::memory_order_relaxed);
+  }
+
  protected:
   void threadRun(ThreadPtr thread) override;
   void stopThreads(std::size_t numThreads) override;
@@ -95,10 +139,16 @@ class EDFThreadPoolExecutor : public SoftRealTimeExecutor,
 
   void fillTaskInfo(const Task& task, TaskInfo& info);
   void registerTaskEnqueue(const Task& task);
+  void addTask(std::shared_ptr<Task> task, std::size_t total);
+  bool isExpired(const Task& task);
+
+  const Options options_;
 
   std::unique_ptr<TaskQueue> taskQueue_;
   std::unique_ptr<EDFThreadPoolSemaphore> sem_;
   std::atomic<int> threadsToStop_{0};
+  std::atomic<uint64_t> numDeadlineMisses_{0};
+  std::atomic<uint64_t> numExpiredTasks_{0};
 
   // All operations performed on `numIdleThreads_` explicitly specify memory
   // ordering of `std::memory_order_seq_cst`. This is due to `numIdleThreads_`
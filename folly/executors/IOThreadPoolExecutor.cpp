@@ -117,7 +117,8 @@ IOThreadPoolExecutor::IOThreadPoolExecutor(
           maxThreads, minThreads, std::move(threadFactory)),
       isWaitForAll_(options.waitForAll),
       nextThread_(0),
-      eventBaseManager_(ebm) {
+      eventBaseManager_(ebm),
+      backendFactory_(std::move(options.backendFactory)) {
   setNumThreads(maxThreads);
   registerThreadPoolExecutor(this);
   if (options.enableThreadIdCollection) {
@@ -154,6 +155,57 @@ void IOThreadPoolExecutor::add(
   ioThread->eventBase->runInEventBaseThread(std::move(wrappedFunc));
 }
 
+void IOThreadPoolExecutor::addBatch(Range<Func*> funcs) {
+  if (funcs.empty()) {
+    return;
+  }
+  // Start up to one thread per task, as that many add()s would.
+  for (size_t i = 0; i < funcs.size(); ++i) {
+    if (activeThreads_.load(std::memory_order_relaxed) >=
+        maxThreads_.load(std::memory_order_relaxed)) {
+      break;
+    }
+    ensureActiveThreads();
+  }
+  std::shared_lock r{threadListLock_};
+  if (threadList_.get().empty()) {
+    throw std::runtime_error("No threads available");
+  }
+
+  struct Batch {
+    std::shared_ptr<IOThread> ioThread;
+    std::vector<Task> tasks;
+  };
+  std::vector<Batch> batches;
+  auto maxBatches = std::min(funcs.size(), threadList_.get().size());
+  while (batches.size() < maxBatches) {
+    auto ioThread = pickThread();
+    // pickThread() keeps returning the current thread on a pool thread.
+    if (!batches.empty() && ioThread == batches.front().ioThread) {
+      break;
+    }
+    batches.push_back({std::move(ioThread), {}});
+  }
+  for (size_t i = 0; i < funcs.size(); ++i) {
+    auto& tasks = batches[i % batches.size()].tasks;
+    tasks.emplace_back(
+        std::move(funcs[i]), std::chrono::milliseconds(0), Func());
+    registerTaskEnqueue(tasks.back());
+  }
+
+  for (auto& batch : batches) {
+    auto ioThread = batch.ioThread;
+    ioThread->pendingTasks += batch.tasks.size();
+    ioThread->eventBase->runInEventBaseThread(
+        [this, ioThread, tasks = std::move(batch.tasks)]() mutable {
+          for (auto& task : tasks) {
+            runTask(ioThread, std::move(task));
+            ioThread->pendingTasks--;
+          }
+        });
+  }
+}
+
 std::shared_ptr<IOThreadPoolExecutor::IOThread>
 IOThreadPoolExecutor::pickThread() {
   auto& me = *thisThread_;
@@ -215,6 +267,16 @@ void IOThreadPoolExecutor::threadRun(ThreadPtr thread) {
   this->threadPoolHook_.registerThread();
 
   const auto ioThread = std::static_pointer_cast<IOThread>(thread);
+  if (backendFactory_) {
+    // Configured as the EventBaseManager would, but for the backend.
+    auto options = eventBaseManager_->getOptions();
+    options.setBackendFactory(backendFactory_);
+    auto evb = std::make_unique<EventBase>(std::move(options));
+    if (const auto& observer = eventBaseManager_->getObserver()) {
+      evb->setObserver(observer);
+    }
+    eventBaseManager_->setEventBase(evb.release(), true /* takeOwnership */);
+  }
   ioThread->eventBase = eventBaseManager_->getEventBase();
   thisThread_.reset(new std::shared_ptr<IOThread>(ioThread));
 
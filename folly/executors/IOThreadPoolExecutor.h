@@ -90,9 +90,18 @@ class IOThreadPoolExecutor : public IOThreadPoolExecutorBase {
       this->enableThreadIdCollection = b;
       return *this;
     }
+    // Creates the backends of the EventBases of the threads, which are then
+    // installed in the EventBaseManager, instead of letting the manager
+    // create them. This is for instance how to make all the threads share
+    // an io_uring SQ poll thread: see IoUringBackend::Options::setSQPollGroup.
+    Options& setBackendFactory(EventBase::Options::BackendFactory f) {
+      this->backendFactory = std::move(f);
+      return *this;
+    }
 
     bool waitForAll;
     bool enableThreadIdCollection;
+    EventBase::Options::BackendFactory backendFactory;
   };
 
   explicit IOThreadPoolExecutor(
@@ -118,6 +127,10 @@ class IOThreadPoolExecutor : public IOThreadPoolExecutorBase {
       std::chrono::milliseconds expiration,
       Func expireCallback = nullptr) override;
 
+  /// Spreads the batch over the threads as add() would, but with a single
+  /// EventBase callback per thread for all the tasks it gets.
+  void addBatch(Range<Func*> funcs) override;
+
   folly::EventBase* getEventBase() override;
 
   // Ensures that the maximum number of active threads is running and returns
@@ -157,6 +170,7 @@ class IOThreadPoolExecutor : public IOThreadPoolExecutorBase {
   relaxed_atomic<size_t> nextThread_;
   folly::ThreadLocal<std::shared_ptr<IOThread>> thisThread_;
   folly::EventBaseManager* eventBaseManager_;
+  const EventBase::Options::BackendFactory backendFactory_;
   std::unique_ptr<ThreadIdWorkerProvider> threadIdCollector_;
 };
 
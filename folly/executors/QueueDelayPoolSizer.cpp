@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/QueueDelayPoolSizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <folly/lang/Bits.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+
+class QueueDelayPoolSizer::Observer : public ThreadPoolExecutor::TaskObserver {
+ public:
+  Observer(std::shared_ptr<Histogram> histogram, uint32_t sampleEvery)
+      : histogram_(std::move(histogram)), sampleEvery_(sampleEvery) {}
+
+  void taskDequeued(
+      const ThreadPoolExecutor::DequeuedTaskInfo& info) noexcept override {
+    if (info.taskId % sampleEvery_ == 0) {
+      histogram_->record(info.waitTime);
+    }
+  }
+
+ private:
+  const std::shared_ptr<Histogram> histogram_;
+  const uint32_t sampleEvery_;
+};
+
+void QueueDelayPoolSizer::Histogram::record(
+    std::chrono::nanoseconds delay) noexcept {
+  auto ns = uint64_t(std::max<int64_t>(0, delay.count()));
+  buckets[findLastSet(ns)].fetch_add(1, std::memory_order_relaxed);
+}
+
+namespace {
+
+QueueDelayPoolSizer::Options withMaxThreads(
+    QueueDelayPoolSizer::Options options, size_t numThreads) {
+  if (options.maxThreads == 0) {
+    options.maxThreads = numThreads;
+  }
+  return options;
+}
+
+} // namespace
+
+QueueDelayPoolSizer::QueueDelayPoolSizer(
+    ThreadPoolExecutor& executor, Options options)
+    : executor_(executor),
+      options_(withMaxThreads(std::move(options), executor.numThreads())),
+      histogram_(std::make_shared<Histogram>()) {
+  if (options_.minThreads == 0 || options_.maxThreads < options_.minThreads ||
+      !(options_.quantile > 0 && options_.quantile <= 1) ||
+      options_.targetDelay <= std::chrono::microseconds::zero() ||
+      options_.interval <= std::chrono::microseconds::zero() ||
+      options_.growFactor < 0 || options_.shrinkThreshold < 0 ||
+      options_.shrinkThreshold > 1) {
+    throw_exception<std::invalid_argument>(
+        "Invalid QueueDelayPoolSizer options");
+  }
+  executor_.addTaskObserver(std::make_unique<Observer>(
+      histogram_, std::max<uint32_t>(1, options_.sampleEvery)));
+  scheduler_.setThreadName("PoolSizer");
+  scheduler_.addFunction(
+      [this] { update(); }, options_.interval, "QueueDelayPoolSizer");
+}
+
+QueueDelayPoolSizer::~QueueDelayPoolSizer() {
+  stop();
+}
+
+void QueueDelayPoolSizer::start() {
+  scheduler_.start();
+}
+
+void QueueDelayPoolSizer::stop() {
+  scheduler_.shutdown();
+}
+
+size_t QueueDelayPoolSizer::update() {
+  std::lock_guard<std::mutex> guard(updateMutex_);
+  auto pending = executor_.getPendingTaskCount();
+  auto quantile = takeQuantile();
+  auto delay = quantile.value_or(std::chrono::nanoseconds(0));
+  // Nothing dequeued is only quiet if nothing is waiting either: a pool
+  // whose threads are all stuck dequeues nothing while its queue grows.
+  bool stalled = !quantile && pending > 0;
+  if (stalled && pendingAtLastUpdate_ > 0) {
+    // The tasks already queued at the last update are still there, so the
+    // oldest has waited at least an interval.
+    delay = options_.interval;
+  }
+  pendingAtLastUpdate_ = pending;
+  lastDelayNs_.store(delay.count(), std::memory_order_relaxed);
+
+  auto current = executor_.numThreads();
+  auto next = std::clamp(current, options_.minThreads, options_.maxThreads);
+  if (delay > options_.targetDelay) {
+    quietIntervals_ = 0;
+    auto step = std::max<size_t>(1, size_t(double(next) * options_.growFactor));
+    next = std::min(options_.maxThreads, next + step);
+  } else if (
+      !stalled &&
+      delay.count() <=
+      double(std::chrono::nanoseconds(options_.targetDelay).count()) *
+          options_.shrinkThreshold) {
+    if (++quietIntervals_ >= options_.shrinkIntervals) {
+      quietIntervals_ = 0;
+      next = std::max(options_.minThreads, next - 1);
+    }
+  } else {
+    quietIntervals_ = 0;
+  }
+  if (next != current) {
+    executor_.setNumThreads(next);
+  }
+  return next;
+}
+
+std::optional<std::chrono::nanoseconds> QueueDelayPoolSizer::takeQuantile() {
+  std::array<uint64_t, kNumBuckets> counts;
+  uint64_t total = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    auto count = histogram_->buckets[i].load(std::memory_order_relaxed);
+    counts[i] = count - lastCounts_[i];
+    lastCounts_[i] = count;
+    total += counts[i];
+  }
+  if (total == 0) {
+    return std::nullopt;
+  }
+  // Bucket i > 0 holds the delays in [2^(i-1), 2^i) ns; interpolate in it.
+  auto rank = options_.quantile * double(total);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    if (counts[i] == 0 || double(seen + counts[i]) < rank) {
+      seen += counts[i];
+      continue;
+    }
+    if (i == 0) {
+      return std::chrono::nanoseconds(0);
+    }
+    auto low = std::ldexp(1.0, int(i) - 1);
+    auto fraction = (rank - double(seen)) / double(counts[i]);
+    return std::chrono::nanoseconds(int64_t(low + low * fraction));
+  }
+  return std::chrono::nanoseconds(std::numeric_limits<int64_t>::max());
+}
+
+} // namespace folly
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include <folly/executors/ThreadPoolExecutor.h>
+#include <folly/experimental/FunctionScheduler.h>
+
+namespace folly {
+
+/**
+ * Grows and shrinks the number of threads of a ThreadPoolExecutor to keep a
+ * quantile (by default the p95) of the time tasks wait in its queue around a
+ * target delay.
+ *
+ * The dynamic behavior of ThreadPoolExecutor starts threads whenever there
+ * is pending work, up to numThreads(), and stops them after they have been
+ * idle for the thread timeout; bursty load therefore makes the pool keep a
+ * lot of threads around to have them at the peaks. Here numThreads() itself
+ * is adjusted instead, from the queue delay (the sojourn time that Codel
+ * also acts upon) of the tasks dequeued during each interval:
+ *
+ *  - if the quantile is above targetDelay, the pool grows by growFactor of
+ *    its size (at least one thread), up to maxThreads;
+ *  - if it stayed under targetDelay * shrinkThreshold for shrinkIntervals
+ *    consecutive intervals, the pool shrinks by one thread, down to
+ *    minThreads; intervals without any task count as such, unless tasks
+ *    were left waiting in the queue, which is what a pool whose threads are
+ *    all blocked looks like.
+ *
+ * Growth is fast and shrinking slow and only from well below the target, so
+ * that the pool does not oscillate around the target.
+ *
+ * Queue delays are collected by a TaskObserver added to the executor, into
+ * a histogram with one bucket per power of two nanoseconds, and
+ * sampleEvery can reduce that to one task out of every so many. start()
+ * runs update() every interval on a FunctionScheduler thread, since
+ * setNumThreads() may have to join pool threads. The QueueDelayPoolSizer
+ * must be destroyed before the executor.
+ */
+class QueueDelayPoolSizer {
+ public:
+  struct Options {
+    Options() {}
+
+    std::chrono::microseconds targetDelay{std::chrono::milliseconds(5)};
+    double quantile{0.95};
+    std::chrono::microseconds interval{std::chrono::milliseconds(100)};
+    size_t minThreads{1};
+    /// 0 is the number of threads of the executor when the
+    /// QueueDelayPoolSizer is created.
+    size_t maxThreads{0};
+    double growFactor{0.25};
+    double shrinkThreshold{0.25};
+    size_t shrinkIntervals{10};
+    /// Record the delay of one task out of this many. 0 and 1 record all.
+    uint32_t sampleEvery{1};
+  };
+
+  /// Throws std::invalid_argument if the options are inconsistent.
+  QueueDelayPoolSizer(ThreadPoolExecutor& executor, Options options);
+  ~QueueDelayPoolSizer();
+
+  QueueDelayPoolSizer(const QueueDelayPoolSizer&) = delete;
+  QueueDelayPoolSizer& operator=(const QueueDelayPoolSizer&) = delete;
+
+  /// Starts calling update() every interval.
+  void start();
+  /// Stops calling update(), waiting for a running one to be done.
+  void stop();
+
+  /// Resizes the pool from the delays recorded since the previous call and
+  /// returns the new number of threads.
+  size_t update();
+
+  /// The delay quantile computed by the last update(). If no task was
+  /// dequeued in that interval, this is zero, or the interval itself if the
+  /// tasks pending at the previous update were still waiting.
+  std::chrono::nanoseconds lastQueueDelay() const {
+    return std::chrono::nanoseconds(
+        lastDelayNs_.load(std::memory_order_relaxed));
+  }
+
+  const Options& options() const { return options_; }
+
+ private:
+  static constexpr size_t kNumBuckets = 64;
+
+  // Shared with the TaskObserver, which the executor owns and which may
+  // therefore outlive this.
+  struct Histogram {
+    void record(std::chrono::nanoseconds delay) noexcept;
+    std::array<std::atomic<uint64_t>, kNumBuckets> buckets{};
+  };
+
+  class Observer;
+
+  // The given quantile of the delays recorded since the last call, none if
+  // nothing was recorded.
+  std::optional<std::chrono::nanoseconds> takeQuantile();
+
+  ThreadPoolExecutor& executor_;
+  const Options options_;
+  std::shared_ptr<Histogram> histogram_;
+  std::array<uint64_t, kNumBuckets> lastCounts_{};
+  size_t quietIntervals_{0};
+  size_t pendingAtLastUpdate_{0};
+  std::atomic<int64_t> lastDelayNs_{0};
+  std::mutex updateMutex_;
+  FunctionScheduler scheduler_;
+};
+
+} // namespace folly
@@ -44,8 +44,9 @@ class SerialExecutorImpl<Queue>::Worker {
 };
 
 template <template <typename> typename Queue>
-SerialExecutorImpl<Queue>::SerialExecutorImpl(KeepAlive<Executor> parent)
-    : parent_(std::move(parent)) {}
+SerialExecutorImpl<Queue>::SerialExecutorImpl(
+    KeepAlive<Executor> parent, SerialRunQuantum quantum)
+    : parent_(std::move(parent)), quantum_(quantum) {}
 
 template <template <typename> typename Queue>
 SerialExecutorImpl<Queue>::~SerialExecutorImpl() {
@@ -55,15 +56,22 @@ SerialExecutorImpl<Queue>::~SerialExecutorImpl() {
 template <template <typename> typename Queue>
 Executor::KeepAlive<SerialExecutorImpl<Queue>>
 SerialExecutorImpl<Queue>::create(KeepAlive<Executor> parent) {
+  return create(std::move(parent), SerialRunQuantum{});
+}
+
+template <template <typename> typename Queue>
+Executor::KeepAlive<SerialExecutorImpl<Queue>>
+SerialExecutorImpl<Queue>::create(
+    KeepAlive<Executor> parent, SerialRunQuantum quantum) {
   return makeKeepAlive<SerialExecutorImpl<Queue>>(
-      new SerialExecutorImpl<Queue>(std::move(parent)));
+      new SerialExecutorImpl<Queue>(std::move(parent), quantum));
 }
 
 template <template <typename> typename Queue>
 typename SerialExecutorImpl<Queue>::UniquePtr
 SerialExecutorImpl<Queue>::createUnique(std::shared_ptr<Executor> parent) {
-  auto executor =
-      new SerialExecutorImpl<Queue>(getKeepAliveToken(parent.get()));
+  auto executor = new SerialExecutorImpl<Queue>(
+      getKeepAliveToken(parent.get()), SerialRunQuantum{});
   return {executor, Deleter{std::move(parent)}};
 }
 
@@ -112,12 +120,16 @@ void SerialExecutorImpl<Queue>::worker() {
   std::size_t queueSize = scheduled_.load(std::memory_order_acquire);
   DCHECK_NE(queueSize, 0);
 
+  const auto start = quantum_.start();
+  std::size_t ran = 0;
   std::size_t processed = 0;
   while (true) {
-    Task task;
-    queue_.dequeue(task);
-    folly::RequestContextScopeGuard ctxGuard(std::move(task.ctx));
-    invokeCatchingExns("SerialExecutor: func", std::exchange(task.func, {}));
+    {
+      Task task;
+      queue_.dequeue(task);
+      folly::RequestContextScopeGuard ctxGuard(std::move(task.ctx));
+      invokeCatchingExns("SerialExecutor: func", std::exchange(task.func, {}));
+    }
 
     if (++processed == queueSize) {
       // NOTE: scheduled_ must be decremented after the task has been processed,
@@ -130,6 +142,16 @@ void SerialExecutorImpl<Queue>::worker() {
       }
       processed = 0;
     }
+
+    if (quantum_.exhausted(++ran, start)) {
+      // Yield, leaving the rest of the queue scheduled so that add() does
+      // not start another worker concurrently with the one added here.
+      if (processed != 0) {
+        scheduled_.fetch_sub(processed, std::memory_order_acq_rel);
+      }
+      parent_->add(Worker{getKeepAliveToken(this)});
+      return;
+    }
   }
 }
 
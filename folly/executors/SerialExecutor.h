@@ -64,6 +64,15 @@ class SerialExecutorImpl : public SerializedExecutor {
   static KeepAlive<SerialExecutorImpl> create(
       KeepAlive<Executor> parent = getGlobalCPUExecutor());
 
+  /**
+   * As above, but each task of the parent executor runs queued tasks only
+   * within the given quantum before yielding to the parent (see
+   * SerialRunQuantum). Without a quantum, a task of the parent keeps running
+   * tasks as long as the queue is not empty.
+   */
+  static KeepAlive<SerialExecutorImpl> create(
+      KeepAlive<Executor> parent, SerialRunQuantum quantum);
+
   class Deleter {
    public:
     Deleter() {}
@@ -97,7 +106,9 @@ class SerialExecutorImpl : public SerializedExecutor {
    * guaranteed, the priority given here does not necessarily reflect the
    * execution priority of the task submitted with this call to
    * `addWithPriority`. The given priority is passed on to the parent executor
-   * for the execution of one of the SerialExecutor's tasks.
+   * for the execution of one of the SerialExecutor's tasks. Tasks added to
+   * the parent when yielding at the end of a quantum use the default
+   * priority.
    */
   void addWithPriority(Func func, int8_t priority) override;
   uint8_t getNumPriorities() const override {
@@ -112,7 +123,7 @@ class SerialExecutorImpl : public SerializedExecutor {
 
   class Worker;
 
-  explicit SerialExecutorImpl(KeepAlive<Executor> parent);
+  SerialExecutorImpl(KeepAlive<Executor> parent, SerialRunQuantum quantum);
   ~SerialExecutorImpl() override;
 
   bool keepAliveAcquire() noexcept override;
@@ -124,6 +135,7 @@ class SerialExecutorImpl : public SerializedExecutor {
   void drain();
 
   KeepAlive<Executor> parent_;
+  const SerialRunQuantum quantum_;
   std::atomic<std::size_t> scheduled_{0};
   Queue<Task> queue_;
 
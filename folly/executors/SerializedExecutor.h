@@ -16,6 +16,10 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
 #include <folly/executors/SequencedExecutor.h>
 
 namespace folly {
@@ -28,4 +32,35 @@ class SerializedExecutor : public SequencedExecutor {
   virtual ~SerializedExecutor() override {}
 };
 
+// Bounds the work that a serializing executor running on a parent executor,
+// such as SerialExecutor or StrandExecutor, does in one task of the parent:
+// once it has run maxTasks of its own tasks, or has been running them for at
+// least maxTime, it yields by adding the rest of its queue to the parent as
+// a new task, so that other work of the parent gets to run in between.
+//
+// Draining many tasks per activation keeps a busy queue on one thread with
+// warm caches, but delays everything else queued to the parent. At least
+// one task is run per activation. The defaults place no bound.
+struct SerialRunQuantum {
+  using Clock = std::chrono::steady_clock;
+
+  std::size_t maxTasks = std::numeric_limits<std::size_t>::max();
+  std::chrono::microseconds maxTime = std::chrono::microseconds::max();
+
+  // The start of an activation, only read from the clock if maxTime bounds
+  // activations.
+  Clock::time_point start() const {
+    return maxTime == std::chrono::microseconds::max() ? Clock::time_point{}
+                                                        : Clock::now();
+  }
+
+  // Whether an activation that started at start, and has run tasks tasks so
+  // far, should yield.
+  bool exhausted(std::size_t tasks, Clock::time_point start) const {
+    return tasks >= maxTasks ||
+        (maxTime != std::chrono::microseconds::max() &&
+         Clock::now() - start >= maxTime);
+  }
+};
+
 } // namespace folly
@@ -56,7 +56,12 @@ class StrandContext::Task {
 };
 
 std::shared_ptr<StrandContext> StrandContext::create() {
-  return std::make_shared<StrandContext>(PrivateTag{});
+  return create(kDefaultRunQuantum);
+}
+
+std::shared_ptr<StrandContext> StrandContext::create(
+    SerialRunQuantum quantum) {
+  return std::make_shared<StrandContext>(PrivateTag{}, quantum);
 }
 
 void StrandContext::add(Func func, Executor::KeepAlive<> executor) {
@@ -85,10 +90,11 @@ void StrandContext::addImpl(QueueItem&& item) {
 
 void StrandContext::executeNext(
     std::shared_ptr<StrandContext> thisPtr) noexcept {
-  // Put a cap on the number of items we process in one batch before
-  // rescheduling on to the executor to avoid starvation of other
-  // items queued to the current executor.
-  const std::size_t maxItemsToProcessSynchronously = 32;
+  // Put a cap on the work we process in one batch before rescheduling on
+  // to the executor to avoid starvation of other items queued to the
+  // current executor.
+  const SerialRunQuantum& quantum = thisPtr->quantum_;
+  const auto start = quantum.start();
 
   std::size_t queueSize = thisPtr->scheduled_.load(std::memory_order_acquire);
   DCHECK(queueSize != 0u);
@@ -96,7 +102,7 @@ void StrandContext::executeNext(
   const QueueItem* nextItem = nullptr;
 
   std::size_t pendingCount = 0;
-  for (std::size_t i = 0; i < maxItemsToProcessSynchronously; ++i) {
+  for (std::size_t ran = 1;; ++ran) {
     QueueItem item = thisPtr->queue_.dequeue();
     Executor::invokeCatchingExns(
         "StrandExecutor: func", std::exchange(item.func, {}));
@@ -121,7 +127,8 @@ void StrandContext::executeNext(
     // Check if the next item has the same executor.
     // If so we'll go around the loop again, otherwise
     // we'll dispatch to the other executor and return.
-    if (nextItem->executor.get() != item.executor.get()) {
+    if (nextItem->executor.get() != item.executor.get() ||
+        quantum.exhausted(ran, start)) {
       break;
     }
   }
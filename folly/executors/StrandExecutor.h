@@ -81,6 +81,14 @@ class StrandContext : public std::enable_shared_from_this<StrandContext> {
   // function.
   static std::shared_ptr<StrandContext> create();
 
+  // As above, but each task added to an executor runs queued functions only
+  // within the given quantum before yielding to that executor (see
+  // SerialRunQuantum). The default quantum is kDefaultRunQuantum. Functions
+  // for different executors are never run in the same task.
+  static std::shared_ptr<StrandContext> create(SerialRunQuantum quantum);
+
+  static constexpr SerialRunQuantum kDefaultRunQuantum{32};
+
   // Schedule 'func()' to be called on 'executor' after all prior functions
   // scheduled to this context have completed.
   void add(Func func, Executor::KeepAlive<> executor);
@@ -101,7 +109,7 @@ class StrandContext : public std::enable_shared_from_this<StrandContext> {
   // Public to allow construction using std::make_shared() but a logically
   // private constructor. Try to enforce this by forcing use of a private
   // tag-type as a parameter.
-  explicit StrandContext(PrivateTag) {}
+  StrandContext(PrivateTag, SerialRunQuantum quantum) : quantum_(quantum) {}
 
  private:
   struct QueueItem {
@@ -115,6 +123,7 @@ class StrandContext : public std::enable_shared_from_this<StrandContext> {
   static void dispatchFrontQueueItem(
       std::shared_ptr<StrandContext> thisPtr) noexcept;
 
+  const SerialRunQuantum quantum_;
   std::atomic<std::size_t> scheduled_{0};
   UMPSCQueue<QueueItem, /*MayBlock=*/false, /*LgSegmentSize=*/6> queue_;
 };
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/TaskLatencyObserver.h>
+
+#include <algorithm>
+#include <new>
+
+#include <folly/Utility.h>
+
+namespace folly {
+
+TaskLatencyObserver::Stats::Stats(const Options& options)
+    : waitTime(options.windowDuration, options.numWindows),
+      runTime(options.windowDuration, options.numWindows) {}
+
+TaskLatencyObserver::TaskLatencyObserver(Options options)
+    : options_(std::move(options)),
+      sampleEvery_(std::max<uint32_t>(1, options_.sampleEvery)) {}
+
+TaskLatencyObserver::~TaskLatencyObserver() {
+  for (auto& stats : stats_) {
+    delete stats.load(std::memory_order_relaxed);
+  }
+}
+
+/* static */ TaskLatencyObserver& TaskLatencyObserver::install(
+    ThreadPoolExecutor& executor, Options options) {
+  auto observer = std::make_unique<TaskLatencyObserver>(std::move(options));
+  auto& ref = *observer;
+  executor.addTaskObserver(std::move(observer));
+  return ref;
+}
+
+void TaskLatencyObserver::taskProcessed(
+    const ThreadPoolExecutor::ProcessedTaskInfo& info) noexcept {
+  if (info.taskId % sampleEvery_ != 0) {
+    return;
+  }
+  // Creating the stats of a new priority and merging a full buffer both
+  // allocate. On failure the sample is dropped: it must not take down the
+  // worker thread.
+  try {
+    auto& stats = getOrCreateStats(info.priority);
+    // Timestamp the samples from the task info rather than reading the clock.
+    auto dequeueTime = info.enqueueTime + info.waitTime;
+    stats.waitTime.addValue(double(info.waitTime.count()), dequeueTime);
+    if (!info.expired) {
+      stats.runTime.addValue(
+          double(info.runTime.count()), dequeueTime + info.runTime);
+    }
+  } catch (const std::bad_alloc&) {
+  }
+}
+
+TaskLatencyObserver::Estimates TaskLatencyObserver::estimate(
+    int8_t priority,
+    Range<const double*> quantiles,
+    std::chrono::steady_clock::time_point now) const {
+  auto stats = getStats(priority);
+  if (!stats) {
+    auto empty = detail::estimatesFromDigest(TDigest(), quantiles);
+    return {empty, empty};
+  }
+  return {
+      stats->waitTime.estimateQuantiles(quantiles, now),
+      stats->runTime.estimateQuantiles(quantiles, now)};
+}
+
+TaskLatencyObserver::Estimates TaskLatencyObserver::estimateAll(
+    Range<const double*> quantiles,
+    std::chrono::steady_clock::time_point now) const {
+  std::vector<TDigest> waitTimes;
+  std::vector<TDigest> runTimes;
+  for (auto& slot : stats_) {
+    if (auto stats = slot.load(std::memory_order_acquire)) {
+      waitTimes.push_back(stats->waitTime.getDigest(now));
+      runTimes.push_back(stats->runTime.getDigest(now));
+    }
+  }
+  return {
+      detail::estimatesFromDigest(TDigest::merge(waitTimes), quantiles),
+      detail::estimatesFromDigest(TDigest::merge(runTimes), quantiles)};
+}
+
+std::vector<int8_t> TaskLatencyObserver::priorities() const {
+  std::vector<int8_t> result;
+  for (size_t i = 0; i < stats_.size(); ++i) {
+    if (stats_[i].load(std::memory_order_acquire)) {
+      result.push_back(int8_t(uint8_t(i)));
+    }
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+void TaskLatencyObserver::flush() {
+  for (auto& slot : stats_) {
+    if (auto stats = slot.load(std::memory_order_acquire)) {
+      stats->waitTime.flush();
+      stats->runTime.flush();
+    }
+  }
+}
+
+TaskLatencyObserver::Stats* TaskLatencyObserver::getStats(
+    int8_t priority) const {
+  return stats_[to_unsigned(priority)].load(std::memory_order_acquire);
+}
+
+TaskLatencyObserver::Stats& TaskLatencyObserver::getOrCreateStats(
+    int8_t priority) {
+  auto& slot = stats_[to_unsigned(priority)];
+  if (auto stats = slot.load(std::memory_order_acquire)) {
+    return *stats;
+  }
+  auto created = std::make_unique<Stats>(options_);
+  Stats* expected = nullptr;
+  if (slot.compare_exchange_strong(
+          expected, created.get(), std::memory_order_acq_rel)) {
+    return *created.release();
+  }
+  return *expected;
+}
+
+} // namespace folly
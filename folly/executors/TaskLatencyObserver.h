@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <folly/Range.h>
+#include <folly/executors/ThreadPoolExecutor.h>
+#include <folly/stats/QuantileEstimator.h>
+
+namespace folly {
+
+/**
+ * A ThreadPoolExecutor::TaskObserver that aggregates, per task priority,
+ * how long tasks waited in the queue and how long they ran, into sliding
+ * window quantile estimators (TDigest based, see QuantileEstimator.h).
+ *
+ * It works with every ThreadPoolExecutor, e.g. CPUThreadPoolExecutor,
+ * IOThreadPoolExecutor and EDFThreadPoolExecutor, without wrapping the tasks:
+ * install() it on a pool and query it with estimate() at any time, from any
+ * thread.
+ *
+ * Only one task out of every Options::sampleEvery is recorded, based on its
+ * task id, so the cost of the others is a virtual call and a division. The
+ * recorded samples go to per-cpu buffers that are merged into the digests
+ * once per window, so that recording does not contend either. Expired tasks
+ * only contribute to the wait times, since they did not run.
+ */
+class TaskLatencyObserver : public ThreadPoolExecutor::TaskObserver {
+ public:
+  struct Options {
+    Options() {}
+
+    /// Record one task out of this many. 0 and 1 record all of them.
+    uint32_t sampleEvery{1};
+    /// The estimates cover the last numWindows * windowDuration.
+    std::chrono::steady_clock::duration windowDuration{std::chrono::seconds(1)};
+    size_t numWindows{60};
+  };
+
+  /// Quantiles of the sampled wait and run times, in nanoseconds.
+  struct Estimates {
+    QuantileEstimates waitTime;
+    QuantileEstimates runTime;
+  };
+
+  explicit TaskLatencyObserver(Options options = Options());
+  ~TaskLatencyObserver() override;
+
+  /// Adds a TaskLatencyObserver to the executor, which owns it: the
+  /// reference is valid until the executor is destroyed.
+  static TaskLatencyObserver& install(
+      ThreadPoolExecutor& executor, Options options = Options());
+
+  void taskProcessed(
+      const ThreadPoolExecutor::ProcessedTaskInfo& info) noexcept override;
+
+  /// The estimates for the tasks of the given priority.
+  Estimates estimate(
+      int8_t priority,
+      Range<const double*> quantiles,
+      std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now()) const;
+
+  /// The estimates for the tasks of all the priorities together.
+  Estimates estimateAll(
+      Range<const double*> quantiles,
+      std::chrono::steady_clock::time_point now =
+          std::chrono::steady_clock::now()) const;
+
+  /// The priorities of the tasks recorded so far, in increasing order.
+  std::vector<int8_t> priorities() const;
+
+  /// Makes the samples recorded so far visible to estimate() right away,
+  /// rather than at the end of the current window.
+  void flush();
+
+  const Options& options() const { return options_; }
+
+ private:
+  using Estimator = SlidingWindowQuantileEstimator<std::chrono::steady_clock>;
+
+  struct Stats {
+    explicit Stats(const Options& options);
+
+    Estimator waitTime;
+    Estimator runTime;
+  };
+
+  Stats* getStats(int8_t priority) const;
+  Stats& getOrCreateStats(int8_t priority);
+
+  const Options options_;
+  const uint32_t sampleEvery_;
+  std::array<std::atomic<Stats*>, UCHAR_MAX + 1> stats_{};
+};
+
+} // namespace folly
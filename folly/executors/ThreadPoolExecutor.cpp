@@ -22,6 +22,7 @@
 #include <folly/executors/GlobalThreadPoolList.h>
 #include <folly/portability/PThread.h>
 #include <folly/synchronization/AsymmetricThreadFence.h>
+#include <folly/tracing/ScopedTraceSection.h>
 #include <folly/tracing/StaticTracepoint.h>
 
 namespace folly {
@@ -128,6 +129,7 @@ void ThreadPoolExecutor::runTask(const ThreadPtr& thread, Task&& task) {
   forEachTaskObserver([&](auto& observer) { observer.taskDequeued(taskInfo); });
 
   {
+    FOLLY_SCOPED_TRACE_SECTION("folly::ThreadPoolExecutor::runTask");
     folly::RequestContextScopeGuard rctx(task.context_);
     if (task.expiration_ != nullptr &&
         taskInfo.waitTime >= task.expiration_->expiration) {
@@ -24,6 +24,7 @@
 
 #include <folly/CPortability.h>
 #include <folly/Optional.h>
+#include <folly/Range.h>
 
 namespace folly {
 
@@ -55,6 +56,17 @@ class BlockingQueue {
       T item, int8_t /* priority */) {
     return add(std::move(item));
   }
+  // Adds all the items, which are moved from, as add() would, but possibly
+  // more efficiently, e.g. with a single post for the whole batch.
+  //
+  // Returns true if existing threads were able to work on all of them.
+  virtual BlockingQueueAddResult addBatch(Range<T*> items) {
+    bool reusedThreads = true;
+    for (auto& item : items) {
+      reusedThreads &= add(std::move(item)).reusedThread;
+    }
+    return reusedThreads;
+  }
   virtual uint8_t getNumPriorities() { return 1; }
   virtual T take() = 0;
   virtual folly::Optional<T> try_take_for(std::chrono::milliseconds time) = 0;
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <folly/MPMCQueue.h>
+#include <folly/ScopeGuard.h>
 #include <folly/executors/task_queue/BlockingQueue.h>
 #include <folly/synchronization/LifoSem.h>
 
@@ -48,6 +49,30 @@ class LifoSemMPMCQueue : public BlockingQueue<T> {
     return sem_.post();
   }
 
+  BlockingQueueAddResult addBatch(Range<T*> items) override {
+    uint32_t added = 0;
+    SCOPE_EXIT {
+      // Items added before a QueueFullException must be consumable.
+      if (added != items.size() && added > 0) {
+        sem_.post(added);
+      }
+    };
+    for (auto& item : items) {
+      switch (kBehavior) { // static
+        case QueueBehaviorIfFull::THROW:
+          if (!queue_.writeIfNotFull(std::move(item))) {
+            throw QueueFullException("LifoSemMPMCQueue full, can't add item");
+          }
+          break;
+        case QueueBehaviorIfFull::BLOCK:
+          queue_.blockingWrite(std::move(item));
+          break;
+      }
+      ++added;
+    }
+    return added == 0 || sem_.post(added);
+  }
+
   T take() override {
     T item;
     while (!queue_.readIfNotEmpty(item)) {
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <folly/concurrency/UnboundedQueue.h>
+#include <folly/executors/task_queue/BlockingQueue.h>
+#include <folly/lang/Align.h>
+#include <folly/synchronization/LifoSem.h>
+#include <folly/system/NumaTopology.h>
+
+namespace folly {
+
+/**
+ * A BlockingQueue with one FIFO queue per NUMA node.
+ *
+ * add() enqueues to the queue of the node the calling thread is on, as
+ * reported by NumaTopology::currentNode(). A consumer takes from the queue
+ * of its own node, and only steals from the queues of other nodes, in node
+ * order starting after its own, when that one is empty.
+ *
+ * Each node also has its own semaphore for its idle consumers. add() wakes
+ * up an idle consumer of its node if there is one, and otherwise an idle
+ * consumer of another node, since that one has no local work left. Adding
+ * only touches a semaphore when some consumer is idle.
+ *
+ * Consumers should be bound to their node, e.g. by creating the threads
+ * with NumaThreadFactory; unbound threads use the node of the cpu they are
+ * running on at the time of the call.
+ */
+template <class T, class Semaphore = folly::LifoSem>
+class NumaBlockingQueue : public BlockingQueue<T> {
+ public:
+  explicit NumaBlockingQueue(
+      NumaTopology topology = NumaTopology::system(),
+      const typename Semaphore::Options& semaphoreOptions = {})
+      : topology_(std::move(topology)) {
+    nodes_.reserve(topology_.numNodes());
+    for (size_t i = 0; i < topology_.numNodes(); ++i) {
+      nodes_.push_back(std::make_unique<Node>(semaphoreOptions));
+    }
+  }
+
+  BlockingQueueAddResult add(T item) override {
+    auto node = topology_.currentNode();
+    nodes_[node]->queue.enqueue(std::move(item));
+    // Pairs with the fence in waitForTask(): either an idle consumer is
+    // seen here, or the consumer sees the task before it sleeps.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      auto& n = *nodes_[(node + i) % nodes_.size()];
+      if (claimIdle(n)) {
+        return n.sem.post();
+      }
+    }
+    return false;
+  }
+
+  T take() override {
+    auto node = topology_.currentNode();
+    while (true) {
+      if (auto item = tryTake(node)) {
+        return std::move(*item);
+      }
+      if (auto item = waitForTask(node, nullptr)) {
+        return std::move(*item);
+      }
+    }
+  }
+
+  folly::Optional<T> try_take_for(std::chrono::milliseconds time) override {
+    auto node = topology_.currentNode();
+    if (auto item = tryTake(node)) {
+      return item;
+    }
+    auto deadline = std::chrono::steady_clock::now() + time;
+    while (true) {
+      bool timedOut = false;
+      if (auto item = waitForTask(node, &deadline, &timedOut)) {
+        return item;
+      }
+      if (timedOut) {
+        return tryTake(node);
+      }
+      if (auto item = tryTake(node)) {
+        return item;
+      }
+    }
+  }
+
+  size_t size() override {
+    size_t result = 0;
+    for (auto& node : nodes_) {
+      result += node->queue.size();
+    }
+    return result;
+  }
+
+  /// Number of tasks waiting in the queue of the given node.
+  size_t sizeOfNode(size_t node) const {
+    return nodes_.at(node)->queue.size();
+  }
+
+  const NumaTopology& topology() const { return topology_; }
+
+ private:
+  struct alignas(hardware_destructive_interference_size) Node {
+    explicit Node(const typename Semaphore::Options& semaphoreOptions)
+        : sem(semaphoreOptions) {}
+
+    UMPMCQueue<T, false, 6> queue;
+    Semaphore sem;
+    alignas(hardware_destructive_interference_size)
+        std::atomic<size_t> idle{0};
+  };
+
+  folly::Optional<T> tryTake(size_t node) {
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      auto& n = *nodes_[(node + i) % nodes_.size()];
+      if (auto item = n.queue.try_dequeue()) {
+        return item;
+      }
+    }
+    return folly::none;
+  }
+
+  // Takes one of the idle consumers of the node off the count, so that
+  // every post() to its semaphore is matched by exactly one sleeper:
+  // several adds in a row then wake up as many consumers, possibly on
+  // different nodes, rather than piling up on the first node seen idle.
+  static bool claimIdle(Node& n) {
+    auto idle = n.idle.load(std::memory_order_relaxed);
+    while (idle > 0) {
+      if (n.idle.compare_exchange_weak(
+              idle, idle - 1, std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Registers as idle, looks for a task one last time and otherwise sleeps
+  // until woken up by add() or until the deadline, if any, has passed. A
+  // consumer that stops waiting on its own has to claim itself back, or,
+  // if an add() got there first, consume the post() meant for it.
+  folly::Optional<T> waitForTask(
+      size_t node,
+      const std::chrono::steady_clock::time_point* deadline,
+      bool* timedOut = nullptr) {
+    auto& n = *nodes_[node];
+    n.idle.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto item = tryTake(node);
+    if (item) {
+      if (!claimIdle(n)) {
+        n.sem.wait();
+      }
+    } else if (deadline) {
+      auto now = std::chrono::steady_clock::now();
+      *timedOut = *deadline <= now || !n.sem.try_wait_for(*deadline - now);
+      if (*timedOut && !claimIdle(n)) {
+        n.sem.wait();
+        *timedOut = false;
+      }
+    } else {
+      n.sem.wait();
+    }
+    return item;
+  }
+
+  const NumaTopology topology_;
+  std::vector<std::unique_ptr<Node>> nodes_;
+};
+
+} // namespace folly
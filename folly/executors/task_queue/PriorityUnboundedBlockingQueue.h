@@ -42,6 +42,18 @@ class PriorityUnboundedBlockingQueue : public BlockingQueue<T> {
     return addWithPriority(std::move(item), folly::Executor::MID_PRI);
   }
 
+  BlockingQueueAddResult addBatch(Range<T*> items) override {
+    if (items.empty()) {
+      return true;
+    }
+    auto& queue =
+        queue_.at_priority(translatePriority(folly::Executor::MID_PRI));
+    for (auto& item : items) {
+      queue.enqueue(std::move(item));
+    }
+    return sem_.post(static_cast<uint32_t>(items.size()));
+  }
+
   BlockingQueueAddResult addWithPriority(T item, int8_t priority) override {
     queue_.at_priority(translatePriority(priority)).enqueue(std::move(item));
     return sem_.post();
@@ -34,6 +34,16 @@ class UnboundedBlockingQueue : public BlockingQueue<T> {
     return sem_.post();
   }
 
+  BlockingQueueAddResult addBatch(Range<T*> items) override {
+    if (items.empty()) {
+      return true;
+    }
+    for (auto& item : items) {
+      queue_.enqueue(std::move(item));
+    }
+    return sem_.post(static_cast<uint32_t>(items.size()));
+  }
+
   T take() override {
     sem_.wait();
     return queue_.dequeue();
@@ -0,0 +1,596 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <folly/Bits.h>
+#include <folly/Optional.h>
+#include <folly/Random.h>
+#include <folly/ThreadLocal.h>
+#include <folly/concurrency/UnboundedQueue.h>
+#include <folly/executors/task_queue/BlockingQueue.h>
+#include <folly/lang/Align.h>
+#include <folly/synchronization/LifoSem.h>
+
+namespace folly {
+
+namespace detail {
+
+/**
+ * Fixed-capacity Chase-Lev work-stealing deque of pointers, following
+ * "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al.,
+ * PPoPP 2013). Only the owner may push() and pop(), at the bottom; any
+ * thread may steal() from the top.
+ */
+template <typename T>
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(size_t capacity)
+      : top_(0),
+        bottom_(0),
+        mask_(nextPowTwo(std::max<size_t>(capacity, 2)) - 1),
+        slots_(new std::atomic<T*>[mask_ + 1]) {}
+
+  size_t capacity() const noexcept { return mask_ + 1; }
+
+  /// Returns false if the deque is full. Owner only.
+  bool push(T* item) noexcept {
+    auto b = bottom_.load(std::memory_order_relaxed);
+    auto t = top_.load(std::memory_order_acquire);
+    if (b - t > int64_t(mask_)) {
+      return false;
+    }
+    slots_[b & mask_].store(item, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// Takes the most recently pushed item, or returns nullptr. Owner only.
+  T* pop() noexcept {
+    auto b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = top_.load(std::memory_order_relaxed);
+    T* item = nullptr;
+    if (t <= b) {
+      item = slots_[b & mask_].load(std::memory_order_relaxed);
+      if (t == b) {
+        // Last item, race stealers for it.
+        if (!top_.compare_exchange_strong(
+                t,
+                t + 1,
+                std::memory_order_seq_cst,
+                std::memory_order_relaxed)) {
+          item = nullptr;
+        }
+        bottom_.store(b + 1, std::memory_order_relaxed);
+      }
+    } else {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  /**
+   * Takes the least recently pushed item, or returns nullptr if the deque
+   * was observed empty. Losing a race only means that another thread took
+   * that item, so the steal is retried until the deque is empty.
+   */
+  T* steal() noexcept {
+    auto t = top_.load(std::memory_order_acquire);
+    while (true) {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto b = bottom_.load(std::memory_order_acquire);
+      if (t >= b) {
+        return nullptr;
+      }
+      T* item = slots_[t & mask_].load(std::memory_order_relaxed);
+      if (top_.compare_exchange_strong(
+              t, t + 1, std::memory_order_seq_cst, std::memory_order_acquire)) {
+        return item;
+      }
+    }
+  }
+
+  size_t size() const noexcept {
+    auto b = bottom_.load(std::memory_order_relaxed);
+    auto t = top_.load(std::memory_order_relaxed);
+    return b > t ? size_t(b - t) : 0;
+  }
+
+ private:
+  alignas(hardware_destructive_interference_size) std::atomic<int64_t> top_;
+  alignas(hardware_destructive_interference_size) std::atomic<int64_t> bottom_;
+  const size_t mask_;
+  std::unique_ptr<std::atomic<T*>[]> slots_;
+};
+
+} // namespace detail
+
+/**
+ * A BlockingQueue that gives each worker thread its own work-stealing deque.
+ *
+ * Every thread that calls take() or try_take_for() becomes a worker and owns
+ * one of the numWorkers deques, as long as one is free; a deque is released
+ * when its thread exits. Tasks added by a worker go to the bottom of its own
+ * deque, and a worker takes tasks from the bottom of its deque first, so
+ * tasks spawned by a task tend to run next on the same core, with their data
+ * still in cache. Tasks added by other threads go to a shared injection
+ * queue. A worker whose deque is empty takes from the injection queue, and
+ * then steals from the top of the other deques, starting at a random one.
+ * Workers also poll the injection queue every kInjectionPollInterval takes,
+ * so that a worker busy with its own tasks does not starve external ones.
+ *
+ * Unlike UnboundedBlockingQueue, which posts to a shared semaphore on every
+ * add(), adding only touches the semaphore when some worker is idle.
+ *
+ * With lifoSlot, each worker also has a LIFO slot, as in Tokio's scheduler:
+ * the last task added by a worker skips its deque and is the next one it
+ * runs, displacing the previous one, if any, to the deque. This is the
+ * common case of a task waking up a coroutine, e.g. by posting a baton it
+ * awaits: the continuation then runs right after the current task, on the
+ * same thread, with no synchronization and while its data is still in
+ * cache. At most kMaxLifoSlotRuns tasks in a row run from the slot before it
+ * is flushed to the deque, so that two tasks waking each other up cannot
+ * monopolize a worker.
+ *
+ * A task may add another one and then block until it has run, so a slot
+ * must not be stuck behind its blocked owner. As with the runnext slot of
+ * Go's scheduler, slots can be stolen, but only by an idle worker, and only
+ * once the same task has stayed in a slot for kLifoSlotStealDelay. While any
+ * slot is occupied, one idle worker watches the slots with a timed wait
+ * instead of sleeping; filling a slot wakes up an idle worker only if none
+ * is watching yet.
+ *
+ * Tasks in deques and slots are boxed, so that they can be handed over
+ * atomically. Each worker caches up to kMaxCachedBoxes freed boxes, and
+ * reuses them for the tasks it adds; in steady state, adding does not
+ * allocate.
+ *
+ * Tasks are only FIFO within the injection queue. Priorities are not
+ * supported. A full deque overflows into the injection queue.
+ */
+template <class T, class Semaphore = folly::LifoSem>
+class WorkStealingBlockingQueue : public BlockingQueue<T> {
+ public:
+  static constexpr size_t kDefaultDequeCapacity = 1024;
+  static constexpr uint32_t kInjectionPollInterval = 61;
+  static constexpr uint32_t kMaxLifoSlotRuns = 3;
+  static constexpr std::chrono::microseconds kLifoSlotStealDelay{100};
+  static constexpr size_t kMaxCachedBoxes = 64;
+
+  explicit WorkStealingBlockingQueue(
+      size_t numWorkers,
+      size_t dequeCapacity = kDefaultDequeCapacity,
+      const typename Semaphore::Options& semaphoreOptions = {},
+      bool lifoSlot = false)
+      : lifoSlot_(lifoSlot),
+        lifoSlots_(std::make_unique<LifoSlot[]>(numWorkers)),
+        watchedSeqs_(std::make_unique<uint64_t[]>(numWorkers)),
+        sem_(semaphoreOptions) {
+    deques_.reserve(numWorkers);
+    freeDeques_.reserve(numWorkers);
+    for (size_t i = 0; i < numWorkers; ++i) {
+      deques_.push_back(std::make_unique<Deque>(dequeCapacity));
+      freeDeques_.push_back(numWorkers - 1 - i);
+    }
+    numFreeDeques_.store(numWorkers, std::memory_order_relaxed);
+  }
+
+  // Workers still registered are destroyed after this, along with worker_,
+  // and move the task in their slot, if any, to the injection queue.
+  ~WorkStealingBlockingQueue() override {
+    for (auto& deque : deques_) {
+      while (auto item = deque->steal()) {
+        destroyBox(item);
+      }
+    }
+  }
+
+  BlockingQueueAddResult add(T item) override {
+    auto worker = worker_.get();
+    if (worker && lifoSlot_) {
+      auto& slot = worker->lifoSlot;
+      slot.seq.store(
+          slot.seq.load(std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
+      // Counted before it can be stolen, so that the count never wraps.
+      numInLifoSlots_.fetch_add(1, std::memory_order_relaxed);
+      auto displaced = slot.item.exchange(
+          box(*worker, std::move(item)), std::memory_order_acq_rel);
+      if (!displaced) {
+        return notifyLifoSlotWatcher();
+      }
+      numInLifoSlots_.fetch_sub(1, std::memory_order_relaxed);
+      // The displaced task goes where it can be stolen.
+      pushLocal(*worker, displaced);
+      return notifyIdle();
+    }
+    if (worker && worker->deque.size() < worker->deque.capacity()) {
+      // Only the owner pushes, so the deque cannot fill up concurrently.
+      bool pushed = worker->deque.push(box(*worker, std::move(item)));
+      DCHECK(pushed);
+    } else {
+      injection_.enqueue(std::move(item));
+    }
+    return notifyIdle();
+  }
+
+  T take() override {
+    auto worker = registerWorker();
+    while (true) {
+      if (auto item = tryTake(worker)) {
+        return std::move(*item);
+      }
+      if (auto item = waitForTask(worker, nullptr)) {
+        return std::move(*item);
+      }
+    }
+  }
+
+  folly::Optional<T> try_take_for(std::chrono::milliseconds time) override {
+    auto worker = registerWorker();
+    if (auto item = tryTake(worker)) {
+      return item;
+    }
+    auto deadline = std::chrono::steady_clock::now() + time;
+    while (true) {
+      bool timedOut = false;
+      if (auto item = waitForTask(worker, &deadline, &timedOut)) {
+        return item;
+      }
+      if (timedOut) {
+        return tryTake(worker);
+      }
+      if (auto item = tryTake(worker)) {
+        return item;
+      }
+    }
+  }
+
+  size_t size() override {
+    size_t result =
+        injection_.size() + numInLifoSlots_.load(std::memory_order_relaxed);
+    for (auto& deque : deques_) {
+      result += deque->size();
+    }
+    return result;
+  }
+
+ private:
+  using Deque = detail::WorkStealingDeque<T>;
+
+  // Written by its owner only, except that an idle worker may steal the item.
+  struct alignas(hardware_destructive_interference_size) LifoSlot {
+    std::atomic<T*> item{nullptr};
+    // Bumped on every fill, so that a watcher can tell a task that has been
+    // waiting for a while from a new one.
+    std::atomic<uint64_t> seq{0};
+  };
+
+  struct Worker {
+    Worker(WorkStealingBlockingQueue& q, size_t i)
+        : queue(q),
+          index(i),
+          deque(*q.deques_[i]),
+          lifoSlot(q.lifoSlots_[i]),
+          rng(Random::rand32()) {
+      cachedBoxes.reserve(kMaxCachedBoxes);
+    }
+
+    ~Worker() {
+      if (auto item = queue.takeLifoSlot(lifoSlot, this)) {
+        queue.injection_.enqueue(std::move(*item));
+        queue.notifyIdle();
+      }
+      for (auto p : cachedBoxes) {
+        std::allocator<T>().deallocate(p, 1);
+      }
+      queue.releaseDeque(index);
+    }
+
+    WorkStealingBlockingQueue& queue;
+    const size_t index;
+    Deque& deque;
+    LifoSlot& lifoSlot;
+    uint32_t ticks{0};
+    uint32_t rng;
+    uint32_t lifoSlotRuns{0};
+    // Uninitialized storage for tasks, freed by this worker.
+    std::vector<T*> cachedBoxes;
+  };
+
+  Worker* registerWorker() {
+    auto worker = worker_.get();
+    if (FOLLY_LIKELY(worker != nullptr) ||
+        numFreeDeques_.load(std::memory_order_relaxed) == 0) {
+      return worker;
+    }
+    std::unique_lock g(freeDequesMutex_);
+    if (freeDeques_.empty()) {
+      return nullptr;
+    }
+    size_t index = freeDeques_.back();
+    freeDeques_.pop_back();
+    numFreeDeques_.store(freeDeques_.size(), std::memory_order_relaxed);
+    g.unlock();
+    worker_.reset(new Worker(*this, index));
+    return worker_.get();
+  }
+
+  void releaseDeque(size_t index) {
+    // Tasks left in the deque can still be stolen until a new worker takes
+    // it over.
+    std::unique_lock g(freeDequesMutex_);
+    freeDeques_.push_back(index);
+    numFreeDeques_.store(freeDeques_.size(), std::memory_order_relaxed);
+  }
+
+  static T* box(Worker& worker, T&& item) {
+    T* p;
+    if (!worker.cachedBoxes.empty()) {
+      p = worker.cachedBoxes.back();
+      worker.cachedBoxes.pop_back();
+    } else {
+      p = std::allocator<T>().allocate(1);
+    }
+    return new (p) T(std::move(item));
+  }
+
+  // The box goes to the cache of worker, if any, whichever worker boxed the
+  // task.
+  static folly::Optional<T> unbox(Worker* worker, T* item) {
+    folly::Optional<T> result(std::move(*item));
+    item->~T();
+    if (worker && worker->cachedBoxes.size() < kMaxCachedBoxes) {
+      worker->cachedBoxes.push_back(item);
+    } else {
+      std::allocator<T>().deallocate(item, 1);
+    }
+    return result;
+  }
+
+  static void destroyBox(T* item) {
+    item->~T();
+    std::allocator<T>().deallocate(item, 1);
+  }
+
+  folly::Optional<T> tryTake(Worker* worker) {
+    if (worker &&
+        worker->lifoSlot.item.load(std::memory_order_relaxed) != nullptr) {
+      if (worker->lifoSlotRuns++ < kMaxLifoSlotRuns) {
+        if (auto item = takeLifoSlot(worker->lifoSlot, worker)) {
+          return item;
+        }
+        // Stolen in the meantime.
+      } else {
+        // Give the other tasks a turn.
+        worker->lifoSlotRuns = 0;
+        if (auto item = tryTakeQueued(worker)) {
+          flushLifoSlot(*worker);
+          return item;
+        }
+        return takeLifoSlot(worker->lifoSlot, worker);
+      }
+    }
+    if (worker) {
+      worker->lifoSlotRuns = 0;
+    }
+    return tryTakeQueued(worker);
+  }
+
+  folly::Optional<T> takeLifoSlot(LifoSlot& slot, Worker* worker) {
+    if (slot.item.load(std::memory_order_relaxed) == nullptr) {
+      return folly::none;
+    }
+    auto item = slot.item.exchange(nullptr, std::memory_order_acq_rel);
+    if (!item) {
+      return folly::none;
+    }
+    numInLifoSlots_.fetch_sub(1, std::memory_order_relaxed);
+    return unbox(worker, item);
+  }
+
+  folly::Optional<T> tryTakeQueued(Worker* worker) {
+    if (worker) {
+      if (++worker->ticks % kInjectionPollInterval == 0) {
+        if (auto item = injection_.try_dequeue()) {
+          return item;
+        }
+      }
+      if (auto item = worker->deque.pop()) {
+        return unbox(worker, item);
+      }
+    }
+    if (auto item = injection_.try_dequeue()) {
+      return item;
+    }
+    return trySteal(worker);
+  }
+
+  void flushLifoSlot(Worker& worker) {
+    auto item =
+        worker.lifoSlot.item.exchange(nullptr, std::memory_order_acq_rel);
+    if (!item) {
+      return;
+    }
+    numInLifoSlots_.fetch_sub(1, std::memory_order_relaxed);
+    pushLocal(worker, item);
+    notifyIdle();
+  }
+
+  void pushLocal(Worker& worker, T* item) {
+    if (worker.deque.size() < worker.deque.capacity()) {
+      bool pushed = worker.deque.push(item);
+      DCHECK(pushed);
+    } else {
+      injection_.enqueue(std::move(*unbox(&worker, item)));
+    }
+  }
+
+  // Pairs with the fence in waitForTask(): either an idle worker is seen
+  // here, or the worker sees the task before it sleeps.
+  bool notifyIdle() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (idle_.load(std::memory_order_relaxed) > 0) {
+      return sem_.post();
+    }
+    return false;
+  }
+
+  // Called after filling an empty slot. Pairs with the fence in
+  // waitForTask(): either a sleeping idle worker is seen here, and woken up
+  // to watch the slots, or the worker sees the slot before it sleeps.
+  bool notifyLifoSlotWatcher() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (lifoSlotWatchers_.load(std::memory_order_relaxed) == 0 &&
+        idle_.load(std::memory_order_relaxed) > 0) {
+      return sem_.post();
+    }
+    return false;
+  }
+
+  // Waits for kLifoSlotStealDelay, or until the deadline, then steals a task
+  // that has stayed in the same slot all along. Only called by the one
+  // watcher, which owns watchedSeqs_ until it decrements lifoSlotWatchers_.
+  folly::Optional<T> watchLifoSlots(
+      Worker* worker,
+      const std::chrono::steady_clock::time_point* deadline,
+      bool* timedOut) {
+    size_t n = deques_.size();
+    for (size_t i = 0; i < n; ++i) {
+      watchedSeqs_[i] = lifoSlots_[i].seq.load(std::memory_order_relaxed);
+    }
+    auto delay =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            kLifoSlotStealDelay);
+    if (deadline) {
+      auto now = std::chrono::steady_clock::now();
+      if (*deadline <= now) {
+        lifoSlotWatchers_.fetch_sub(1, std::memory_order_release);
+        *timedOut = true;
+        return folly::none;
+      }
+      delay = std::min(delay, *deadline - now);
+    }
+    folly::Optional<T> item;
+    if (!sem_.try_wait_for(delay)) {
+      for (size_t i = 0; i < n && !item; ++i) {
+        auto& slot = lifoSlots_[i];
+        if (slot.seq.load(std::memory_order_relaxed) == watchedSeqs_[i]) {
+          item = takeLifoSlot(slot, worker);
+        }
+      }
+      if (!item && deadline && *deadline <= std::chrono::steady_clock::now()) {
+        *timedOut = true;
+      }
+    }
+    lifoSlotWatchers_.fetch_sub(1, std::memory_order_release);
+    // Hand off watching the remaining slots, if any.
+    if (item && numInLifoSlots_.load(std::memory_order_relaxed) > 0) {
+      notifyLifoSlotWatcher();
+    }
+    return item;
+  }
+
+  folly::Optional<T> trySteal(Worker* worker) {
+    size_t n = deques_.size();
+    if (n == 0) {
+      return folly::none;
+    }
+    size_t start;
+    if (worker) {
+      // xorshift32
+      worker->rng ^= worker->rng << 13;
+      worker->rng ^= worker->rng >> 17;
+      worker->rng ^= worker->rng << 5;
+      start = worker->rng % n;
+    } else {
+      start = Random::rand32(uint32_t(n));
+    }
+    for (size_t i = 0; i < n; ++i) {
+      size_t index = (start + i) % n;
+      if (worker && index == worker->index) {
+        continue;
+      }
+      if (auto item = deques_[index]->steal()) {
+        return unbox(worker, item);
+      }
+    }
+    return folly::none;
+  }
+
+  // Registers as idle, looks for a task one last time and otherwise sleeps
+  // until woken up by add() or until the deadline, if any, has passed.
+  folly::Optional<T> waitForTask(
+      Worker* worker,
+      const std::chrono::steady_clock::time_point* deadline,
+      bool* timedOut = nullptr) {
+    idle_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto item = tryTake(worker);
+    if (!item) {
+      size_t noWatchers = 0;
+      if (lifoSlot_ && numInLifoSlots_.load(std::memory_order_relaxed) > 0 &&
+          lifoSlotWatchers_.compare_exchange_strong(
+              noWatchers,
+              1,
+              std::memory_order_acquire,
+              std::memory_order_relaxed)) {
+        item = watchLifoSlots(worker, deadline, timedOut);
+      } else if (deadline) {
+        auto now = std::chrono::steady_clock::now();
+        *timedOut = *deadline <= now || !sem_.try_wait_for(*deadline - now);
+      } else {
+        sem_.wait();
+      }
+    }
+    idle_.fetch_sub(1, std::memory_order_relaxed);
+    return item;
+  }
+
+  const bool lifoSlot_;
+  std::unique_ptr<LifoSlot[]> lifoSlots_;
+  // The slots' seq when the current watcher started to wait.
+  std::unique_ptr<uint64_t[]> watchedSeqs_;
+  std::vector<std::unique_ptr<Deque>> deques_;
+  UMPMCQueue<T, false, 6> injection_;
+  Semaphore sem_;
+  alignas(hardware_destructive_interference_size) std::atomic<size_t> idle_{0};
+  std::atomic<size_t> numInLifoSlots_{0};
+  std::atomic<size_t> lifoSlotWatchers_{0};
+
+  std::mutex freeDequesMutex_;
+  std::vector<size_t> freeDeques_;
+  std::atomic<size_t> numFreeDeques_{0};
+
+  // Declared last, so that workers release their deques before the rest of
+  // the queue is destroyed.
+  ThreadLocalPtr<Worker> worker_;
+};
+
+} // namespace folly
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/task_queue/NumaBlockingQueue.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/executors/thread_factory/NumaThreadFactory.h>
+#include <folly/portability/GTest.h>
+#include <folly/portability/Sched.h>
+#include <folly/synchronization/Baton.h>
+#include <folly/synchronization/Latch.h>
+
+using namespace folly;
+
+namespace {
+
+// Two nodes sharing whatever cpu the test runs on, so that binding threads
+// to either node always succeeds.
+NumaTopology makeTwoNodes() {
+  size_t cpu = 0;
+#if defined(__linux__) && !defined(__ANDROID__)
+  cpu = size_t(std::max(0, ::sched_getcpu()));
+#endif
+  return NumaTopology({{cpu}, {cpu}});
+}
+
+template <typename F>
+void runOnNode(const NumaTopology& topology, size_t node, F f) {
+  std::thread t([&] {
+    topology.bindCurrentThread(node);
+    f();
+  });
+  t.join();
+}
+
+} // namespace
+
+TEST(NumaTopology, parseCpuList) {
+  EXPECT_EQ(
+      (std::vector<size_t>{0, 1, 2, 3, 8, 10, 11}),
+      NumaTopology::parseCpuList("0-3,8,10-11\n"));
+  EXPECT_TRUE(NumaTopology::parseCpuList("\n").empty());
+  EXPECT_THROW(NumaTopology::parseCpuList("3-1"), std::invalid_argument);
+  EXPECT_ANY_THROW(NumaTopology::parseCpuList("x"));
+}
+
+TEST(NumaTopology, nodes) {
+  NumaTopology topology({{0, 2}, {}, {1, 3}});
+  EXPECT_EQ(2, topology.numNodes());
+  EXPECT_EQ((std::vector<size_t>{1, 3}), topology.cpusOfNode(1));
+  EXPECT_EQ(0, topology.nodeOfCpu(2));
+  EXPECT_EQ(1, topology.nodeOfCpu(3));
+  EXPECT_EQ(0, topology.nodeOfCpu(100));
+
+  NumaTopology single({});
+  EXPECT_EQ(1, single.numNodes());
+  EXPECT_FALSE(single.cpusOfNode(0).empty());
+
+  auto& system = NumaTopology::system();
+  EXPECT_GE(system.numNodes(), 1);
+  EXPECT_LT(system.currentNode(), system.numNodes());
+}
+
+TEST(NumaTopology, fromCacheLocality) {
+  CacheLocality locality;
+  locality.numCpus = 4;
+  locality.numCachesByLevel = {4, 2};
+  locality.localityIndexByCpu = {0, 2, 1, 3};
+  auto topology = NumaTopology::fromCacheLocality(locality);
+  EXPECT_EQ(2, topology.numNodes());
+  EXPECT_EQ((std::vector<size_t>{0, 2}), topology.cpusOfNode(0));
+  EXPECT_EQ((std::vector<size_t>{1, 3}), topology.cpusOfNode(1));
+}
+
+TEST(NumaTopology, bindCurrentThread) {
+  auto topology = makeTwoNodes();
+  runOnNode(topology, 1, [&] {
+    EXPECT_EQ(1, topology.currentNode());
+    topology.bindCurrentThread(0);
+    EXPECT_EQ(0, topology.currentNode());
+  });
+}
+
+TEST(NumaTopology, bindingIsPerTopology) {
+  auto topology = makeTwoNodes();
+  auto cpu = topology.cpusOfNode(0)[0];
+  NumaTopology other({{cpu}, {cpu + 1}, {cpu + 2}});
+  runOnNode(topology, 1, [&] {
+    // Unbound for other, so that's the node of the cpu.
+    EXPECT_EQ(0, other.currentNode());
+    auto copy = topology;
+    EXPECT_EQ(1, copy.currentNode());
+  });
+}
+
+TEST(NumaBlockingQueue, localFirst) {
+  auto topology = makeTwoNodes();
+  NumaBlockingQueue<int> q(topology);
+  runOnNode(topology, 0, [&] {
+    q.add(1);
+    q.add(2);
+  });
+  runOnNode(topology, 1, [&] { q.add(3); });
+  EXPECT_EQ(2, q.sizeOfNode(0));
+  EXPECT_EQ(1, q.sizeOfNode(1));
+  EXPECT_EQ(3, q.size());
+
+  runOnNode(topology, 1, [&] {
+    EXPECT_EQ(3, q.take());
+    // Local work ran dry, steal from node 0.
+    EXPECT_EQ(1, q.take());
+    EXPECT_EQ(2, q.try_take_for(std::chrono::milliseconds(0)));
+    EXPECT_FALSE(q.try_take_for(std::chrono::milliseconds(1)).has_value());
+  });
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(NumaBlockingQueue, wakesRemoteConsumer) {
+  auto topology = makeTwoNodes();
+  NumaBlockingQueue<int> q(topology);
+  Baton<> started;
+  std::thread consumer([&] {
+    topology.bindCurrentThread(1);
+    started.post();
+    EXPECT_EQ(42, q.take());
+  });
+  started.wait();
+  runOnNode(topology, 0, [&] { q.add(42); });
+  consumer.join();
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(NumaBlockingQueue, executor) {
+  constexpr int kThreads = 4;
+  constexpr int kTasks = 1000;
+  constexpr int kChildren = 10;
+  auto topology = makeTwoNodes();
+  CPUThreadPoolExecutor ex(
+      kThreads,
+      CPUThreadPoolExecutor::makeNumaQueue(topology),
+      std::make_shared<NumaThreadFactory>(
+          std::make_shared<NamedThreadFactory>("NumaPool"), topology));
+  std::atomic<int> ran{0};
+  std::atomic<int> ranByNode[2] = {{0}, {0}};
+  Latch done(kTasks * (kChildren + 1));
+  auto task = [&] {
+    ++ranByNode[topology.currentNode()];
+    ++ran;
+    done.count_down();
+  };
+  for (int i = 0; i < kTasks; ++i) {
+    ex.add([&] {
+      for (int j = 0; j < kChildren; ++j) {
+        ex.add(task);
+      }
+      task();
+    });
+  }
+  done.wait();
+  EXPECT_EQ(kTasks * (kChildren + 1), ran.load());
+  EXPECT_EQ(ran.load(), ranByNode[0].load() + ranByNode[1].load());
+  ex.join();
+}
@@ -101,3 +101,17 @@ TEST_F(PriorityUnboundedBlockingQueueTest, invalid_priorities_edge) {
   EXPECT_EQ(q.take(), 2);
   EXPECT_EQ(q.take(), 1);
 }
+
+TEST_F(PriorityUnboundedBlockingQueueTest, add_batch) {
+  PriorityUnboundedBlockingQueue<int> q(3);
+  std::vector<int> items{1, 2, 3};
+  q.addWithPriority(0, Executor::LO_PRI);
+  q.addBatch(range(items));
+  q.addWithPriority(4, Executor::HI_PRI);
+  EXPECT_EQ(5, q.size());
+
+  // The batch goes in at medium priority, in order.
+  for (int expected : {4, 1, 2, 3, 0}) {
+    EXPECT_EQ(expected, q.take());
+  }
+}
@@ -17,6 +17,7 @@
 #include <folly/executors/task_queue/UnboundedBlockingQueue.h>
 
 #include <thread>
+#include <vector>
 
 #include <folly/portability/GTest.h>
 #include <folly/synchronization/Baton.h>
@@ -52,3 +53,24 @@ TEST(UnboundedBlockingQueue, concurrentPushPop) {
   EXPECT_EQ(0, q.size());
   t.join();
 }
+
+TEST(UnboundedBlockingQueue, addBatch) {
+  UnboundedBlockingQueue<int> q;
+  std::vector<int> items{1, 2, 3};
+  EXPECT_TRUE(q.addBatch({}).reusedThread);
+  // Nobody is waiting.
+  EXPECT_FALSE(q.addBatch(range(items)).reusedThread);
+  EXPECT_EQ(3, q.size());
+  for (int i : {1, 2, 3}) {
+    EXPECT_EQ(i, q.take());
+  }
+
+  std::thread t([&] {
+    EXPECT_EQ(4, q.take());
+    EXPECT_EQ(5, q.take());
+  });
+  items = {4, 5};
+  q.addBatch(range(items));
+  t.join();
+  EXPECT_EQ(0, q.size());
+}
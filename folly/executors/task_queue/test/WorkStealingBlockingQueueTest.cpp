@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/task_queue/WorkStealingBlockingQueue.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/experimental/coro/Baton.h>
+#include <folly/experimental/coro/BlockingWait.h>
+#include <folly/experimental/coro/Collect.h>
+#include <folly/experimental/coro/Task.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+#include <folly/synchronization/Latch.h>
+
+using namespace folly;
+
+TEST(WorkStealingDeque, pushPopSteal) {
+  detail::WorkStealingDeque<int> d(4);
+  int items[5] = {0, 1, 2, 3, 4};
+  EXPECT_EQ(nullptr, d.pop());
+  EXPECT_EQ(nullptr, d.steal());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(d.push(&items[i]));
+  }
+  EXPECT_FALSE(d.push(&items[4]));
+  EXPECT_EQ(4, d.size());
+  // LIFO for the owner, FIFO for thieves.
+  EXPECT_EQ(&items[3], d.pop());
+  EXPECT_EQ(&items[0], d.steal());
+  EXPECT_TRUE(d.push(&items[4]));
+  EXPECT_EQ(&items[4], d.pop());
+  EXPECT_EQ(&items[1], d.steal());
+  EXPECT_EQ(&items[2], d.pop());
+  EXPECT_EQ(nullptr, d.pop());
+  EXPECT_EQ(0, d.size());
+}
+
+TEST(WorkStealingDeque, concurrentSteal) {
+  constexpr int kItems = 100000;
+  constexpr int kThieves = 4;
+  detail::WorkStealingDeque<int> d(256);
+  std::vector<int> items(kItems);
+  std::vector<std::atomic<int>> taken(kItems);
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < kThieves; ++i) {
+    thieves.emplace_back([&] {
+      while (!done.load() || d.size() > 0) {
+        if (auto p = d.steal()) {
+          ++taken[p - items.data()];
+        }
+      }
+    });
+  }
+  for (int i = 0; i < kItems; ++i) {
+    while (!d.push(&items[i])) {
+      if (auto p = d.pop()) {
+        ++taken[p - items.data()];
+      }
+    }
+    if (i % 3 == 0) {
+      if (auto p = d.pop()) {
+        ++taken[p - items.data()];
+      }
+    }
+  }
+  done = true;
+  for (auto& t : thieves) {
+    t.join();
+  }
+  while (auto p = d.pop()) {
+    ++taken[p - items.data()];
+  }
+  for (int i = 0; i < kItems; ++i) {
+    EXPECT_EQ(1, taken[i].load()) << i;
+  }
+}
+
+TEST(WorkStealingBlockingQueue, pushPop) {
+  WorkStealingBlockingQueue<int> q(2);
+  q.add(42);
+  EXPECT_EQ(1, q.size());
+  EXPECT_EQ(42, q.take());
+  EXPECT_EQ(0, q.size());
+  EXPECT_FALSE(q.try_take_for(std::chrono::milliseconds(1)).has_value());
+}
+
+TEST(WorkStealingBlockingQueue, workerAddsStayLocal) {
+  WorkStealingBlockingQueue<int> q(2);
+  q.add(0);
+  // take() registers this thread as a worker, so its adds go to its own
+  // deque and come back most recent first.
+  EXPECT_EQ(0, q.take());
+  for (int i = 1; i <= 3; ++i) {
+    q.add(i);
+  }
+  EXPECT_EQ(3, q.size());
+  EXPECT_EQ(3, q.take());
+  EXPECT_EQ(2, q.take());
+
+  // Another worker steals the oldest one.
+  std::thread t([&] { EXPECT_EQ(1, q.take()); });
+  t.join();
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(WorkStealingBlockingQueue, lifoSlot) {
+  WorkStealingBlockingQueue<int> q(
+      2,
+      WorkStealingBlockingQueue<int>::kDefaultDequeCapacity,
+      LifoSem::Options{},
+      /* lifoSlot = */ true);
+  q.add(0);
+  EXPECT_EQ(0, q.take());
+  // The last add stays in the slot, the previous ones go to the deque.
+  for (int i = 1; i <= 3; ++i) {
+    q.add(i);
+  }
+  EXPECT_EQ(3, q.size());
+  EXPECT_EQ(3, q.take());
+  EXPECT_EQ(2, q.take());
+
+  // Another worker can steal from the deque, but not right away from the
+  // slot.
+  q.add(4);
+  std::thread t([&] {
+    EXPECT_EQ(1, q.take());
+    EXPECT_FALSE(q.try_take_for(std::chrono::milliseconds(0)).has_value());
+  });
+  t.join();
+  EXPECT_EQ(4, q.take());
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(WorkStealingBlockingQueue, lifoSlotIsStolenFromBlockedOwner) {
+  WorkStealingBlockingQueue<int> q(
+      2,
+      WorkStealingBlockingQueue<int>::kDefaultDequeCapacity,
+      LifoSem::Options{},
+      /* lifoSlot = */ true);
+  q.add(0);
+  EXPECT_EQ(0, q.take());
+  // This worker fills its slot and then never takes again, as if its task
+  // were blocked waiting for the new one.
+  q.add(1);
+  std::thread t([&] { EXPECT_EQ(1, q.take()); });
+  t.join();
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(WorkStealingBlockingQueue, lifoSlotRunsAreBounded) {
+  WorkStealingBlockingQueue<int> q(
+      1,
+      WorkStealingBlockingQueue<int>::kDefaultDequeCapacity,
+      LifoSem::Options{},
+      /* lifoSlot = */ true);
+  q.add(0);
+  EXPECT_EQ(0, q.take());
+  q.add(1);
+  q.add(2);
+  // Tasks that keep waking each other up run from the slot...
+  for (int i = 2; i < 2 + int(q.kMaxLifoSlotRuns); ++i) {
+    EXPECT_EQ(i, q.take());
+    q.add(i + 1);
+  }
+  // ...but only so many times in a row.
+  EXPECT_EQ(1, q.take());
+  EXPECT_EQ(2 + int(q.kMaxLifoSlotRuns), q.take());
+  EXPECT_EQ(0, q.size());
+}
+
+TEST(WorkStealingBlockingQueue, concurrentPushPop) {
+  WorkStealingBlockingQueue<int> q(1);
+  Baton<> b1, b2;
+  std::thread t([&] {
+    b1.post();
+    EXPECT_EQ(42, q.take());
+    EXPECT_EQ(0, q.size());
+    b2.post();
+  });
+  b1.wait();
+  q.add(42);
+  b2.wait();
+  EXPECT_EQ(0, q.size());
+  t.join();
+}
+
+TEST(WorkStealingBlockingQueue, destroyWithPendingTasks) {
+  auto count = std::make_shared<int>(0);
+  {
+    WorkStealingBlockingQueue<std::shared_ptr<int>> q(1);
+    q.add(count);
+    q.try_take_for(std::chrono::milliseconds(0));
+    q.add(count);
+    q.add(count);
+    EXPECT_EQ(3, count.use_count());
+  }
+  EXPECT_EQ(1, count.use_count());
+}
+
+TEST(WorkStealingBlockingQueue, destroyWithTaskInLifoSlot) {
+  auto count = std::make_shared<int>(0);
+  {
+    WorkStealingBlockingQueue<std::shared_ptr<int>> q(
+        1,
+        WorkStealingBlockingQueue<std::shared_ptr<int>>::kDefaultDequeCapacity,
+        LifoSem::Options{},
+        /* lifoSlot = */ true);
+    q.add(count);
+    q.take();
+    q.add(count);
+    EXPECT_EQ(2, count.use_count());
+  }
+  EXPECT_EQ(1, count.use_count());
+}
+
+TEST(WorkStealingBlockingQueue, cachedBoxes) {
+  auto count = std::make_shared<int>(0);
+  for (bool lifoSlot : {false, true}) {
+    WorkStealingBlockingQueue<std::shared_ptr<int>> q(
+        1,
+        WorkStealingBlockingQueue<std::shared_ptr<int>>::kDefaultDequeCapacity,
+        LifoSem::Options{},
+        lifoSlot);
+    q.add(count);
+    q.take();
+    // More boxes than a worker caches, freed and then reused.
+    for (int round = 0; round < 3; ++round) {
+      for (int i = 0; i < 100; ++i) {
+        q.add(count);
+      }
+      EXPECT_EQ(101, count.use_count());
+      for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(count, q.take());
+      }
+      EXPECT_EQ(1, count.use_count());
+    }
+    q.add(count);
+    q.add(count);
+  }
+  EXPECT_EQ(1, count.use_count());
+}
+
+namespace {
+void runExecutor(bool lifoSlot) {
+  constexpr int kThreads = 8;
+  constexpr int kTasks = 1000;
+  constexpr int kChildren = 10;
+  CPUThreadPoolExecutor ex(
+      kThreads,
+      CPUThreadPoolExecutor::makeWorkStealingQueue(kThreads, lifoSlot));
+  std::atomic<int> ran{0};
+  Latch done(kTasks * (kChildren + 1));
+  for (int i = 0; i < kTasks; ++i) {
+    ex.add([&] {
+      // Spawned from a worker, so these go to its own deque.
+      for (int j = 0; j < kChildren; ++j) {
+        ex.add([&] {
+          ++ran;
+          done.count_down();
+        });
+      }
+      ++ran;
+      done.count_down();
+    });
+  }
+  done.wait();
+  EXPECT_EQ(kTasks * (kChildren + 1), ran.load());
+  ex.join();
+}
+} // namespace
+
+TEST(WorkStealingBlockingQueue, executor) {
+  runExecutor(false);
+}
+
+TEST(WorkStealingBlockingQueue, executorLifoSlot) {
+  runExecutor(true);
+}
+
+TEST(WorkStealingBlockingQueue, executorAddThenWait) {
+  constexpr int kThreads = 2;
+  CPUThreadPoolExecutor ex(
+      kThreads, CPUThreadPoolExecutor::makeWorkStealingQueue(kThreads, true));
+  for (int i = 0; i < 100; ++i) {
+    Baton<> done;
+    ex.add([&] {
+      // The child lands in this worker's slot while it blocks on it.
+      Baton<> child;
+      ex.add([&] { child.post(); });
+      child.wait();
+      done.post();
+    });
+    done.wait();
+  }
+  ex.join();
+}
+
+TEST(WorkStealingBlockingQueue, coroutineContinuation) {
+  // A single worker, so that nothing can be stolen and the order in which
+  // the tasks run is deterministic.
+  CPUThreadPoolExecutor ex(
+      1, CPUThreadPoolExecutor::makeWorkStealingQueue(1, true));
+  folly::coro::Baton baton;
+  std::vector<int> order;
+  auto waiter = [&]() -> folly::coro::Task<void> {
+    co_await baton;
+    order.push_back(2);
+  };
+  auto poster = [&]() -> folly::coro::Task<void> {
+    ex.add([&] { order.push_back(3); });
+    // The waiter is rescheduled from this worker, into its slot, and runs
+    // right after this task, ahead of the one added above.
+    baton.post();
+    order.push_back(1);
+    co_return;
+  };
+  folly::coro::blockingWait(
+      folly::coro::collectAll(waiter(), poster()).scheduleOn(&ex));
+  ex.join();
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), order);
+}
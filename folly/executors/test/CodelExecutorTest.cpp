@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/CodelExecutor.h>
+
+#include <chrono>
+#include <thread>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/ManualExecutor.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+
+using namespace folly;
+using std::chrono::milliseconds;
+using std::this_thread::sleep_for;
+
+namespace {
+CodelExecutor::Options fastOptions() {
+  CodelExecutor::Options options;
+  options.targetDelay = milliseconds(1);
+  options.interval = milliseconds(10);
+  return options;
+}
+} // namespace
+
+TEST(CodelExecutorTest, RunsWhenNotOverloaded) {
+  ManualExecutor inner;
+  int ran = 0;
+  {
+    CodelExecutor codel(getKeepAliveToken(inner), fastOptions());
+    for (int i = 0; i < 5; ++i) {
+      codel.add([&] { ++ran; });
+    }
+    EXPECT_EQ(5, codel.pendingTasks());
+    inner.drain();
+    EXPECT_EQ(0, codel.pendingTasks());
+    EXPECT_EQ(0, codel.numShed());
+  }
+  EXPECT_EQ(5, ran);
+}
+
+TEST(CodelExecutorTest, ShedsOverloadedTasks) {
+  ManualExecutor inner;
+  CodelExecutor codel(getKeepAliveToken(inner), fastOptions());
+  int ran = 0;
+  int shed = 0;
+  for (int i = 0; i < 5; ++i) {
+    codel.addWithShedCallback([&] { ++ran; }, [&] { ++shed; });
+  }
+  sleep_for(milliseconds(15));
+  inner.drain();
+
+  // Codel needs two requests in an interval before it starts shedding.
+  EXPECT_EQ(2, ran);
+  EXPECT_EQ(3, shed);
+  EXPECT_EQ(3, codel.numShed());
+  EXPECT_EQ(100, codel.getLoad());
+}
+
+TEST(CodelExecutorTest, CountsWithoutShedding) {
+  ManualExecutor inner;
+  auto options = fastOptions();
+  options.shedOverloaded = false;
+  CodelExecutor codel(getKeepAliveToken(inner), options);
+  int ran = 0;
+  for (int i = 0; i < 5; ++i) {
+    codel.add([&] { ++ran; });
+  }
+  sleep_for(milliseconds(15));
+  inner.drain();
+  EXPECT_EQ(5, ran);
+  EXPECT_EQ(3, codel.numShed());
+}
+
+TEST(CodelExecutorTest, TryAddRejectsWhileSaturated) {
+  ManualExecutor inner;
+  CodelExecutor codel(getKeepAliveToken(inner), fastOptions());
+  for (int i = 0; i < 3; ++i) {
+    codel.add([] {});
+  }
+  sleep_for(milliseconds(15));
+  inner.drain();
+  ASSERT_EQ(100, codel.getLoad());
+
+  // Nothing is pending, so a stale load reading must not reject work.
+  int ran = 0;
+  Func func = [&] { ++ran; };
+  EXPECT_TRUE(codel.tryAdd(std::move(func)));
+  EXPECT_EQ(1, codel.pendingTasks());
+
+  Func rejected = [&] { ++ran; };
+  EXPECT_FALSE(codel.tryAdd(std::move(rejected)));
+  EXPECT_TRUE(rejected);
+  EXPECT_EQ(1, codel.numRejected());
+
+  inner.drain();
+  EXPECT_EQ(0, codel.pendingTasks());
+}
+
+TEST(CodelExecutorTest, OwnsExecutor) {
+  std::atomic<int> ran{0};
+  {
+    CodelExecutor codel(std::make_unique<CPUThreadPoolExecutor>(2));
+    EXPECT_EQ(1, codel.getNumPriorities());
+    for (int i = 0; i < 100; ++i) {
+      codel.add([&] { ++ran; });
+    }
+    Baton<> done;
+    codel.add([&] { done.post(); });
+    done.wait();
+  }
+  EXPECT_EQ(100, ran);
+}
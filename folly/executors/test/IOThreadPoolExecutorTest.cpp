@@ -15,11 +15,61 @@
  */
 
 #include <folly/executors/IOThreadPoolExecutor.h>
+
+#include <atomic>
+
 #include <folly/executors/test/IOThreadPoolExecutorBaseTestLib.h>
 
 namespace folly {
 namespace test {
 
+TEST(IOThreadPoolExecutor, BackendFactory) {
+  static constexpr size_t kNumThreads = 4;
+  std::atomic<size_t> backends{0};
+  {
+    IOThreadPoolExecutor ex(
+        kNumThreads,
+        std::make_shared<NamedThreadFactory>("IOThreadPool"),
+        EventBaseManager::get(),
+        IOThreadPoolExecutor::Options().setBackendFactory([&] {
+          ++backends;
+          return EventBase::getDefaultBackend();
+        }));
+    auto evbs = ex.getAllEventBases();
+    EXPECT_EQ(kNumThreads, evbs.size());
+    EXPECT_EQ(kNumThreads, backends.load());
+    for (auto& evb : evbs) {
+      evb->runInEventBaseThreadAndWait([&] {
+        EXPECT_EQ(evb.get(), ex.getEventBaseManager()->getExistingEventBase());
+      });
+    }
+  }
+  EXPECT_EQ(kNumThreads, backends.load());
+}
+
+TEST(IOThreadPoolExecutor, BackendFactoryKeepsEventBaseManagerConfig) {
+  struct Observer : EventBaseObserver {
+    uint32_t getSampleRate() const override { return 1; }
+    void loopSample(int64_t, int64_t) override {}
+  };
+  auto observer = std::make_shared<Observer>();
+  EventBaseManager ebm(
+      EventBase::Options().setTimerTickInterval(std::chrono::milliseconds(7)),
+      observer);
+  IOThreadPoolExecutor ex(
+      2,
+      std::make_shared<NamedThreadFactory>("IOThreadPool"),
+      &ebm,
+      IOThreadPoolExecutor::Options().setBackendFactory(
+          [] { return EventBase::getDefaultBackend(); }));
+  for (auto& evb : ex.getAllEventBases()) {
+    evb->runInEventBaseThreadAndWait([&] {
+      EXPECT_EQ(std::chrono::milliseconds(7), evb->timer().getTickInterval());
+      EXPECT_EQ(observer, evb->getObserver());
+    });
+  }
+}
+
 INSTANTIATE_TYPED_TEST_SUITE_P(
     IOThreadPoolExecutorTest,
     IOThreadPoolExecutorBaseTest,
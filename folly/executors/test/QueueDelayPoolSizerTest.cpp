@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/QueueDelayPoolSizer.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Latch.h>
+#include <folly/synchronization/SaturatingSemaphore.h>
+
+using namespace folly;
+using namespace std::chrono;
+
+namespace {
+
+// Runs n tasks that wait in the queue for at least delay, by first blocking
+// all the threads of the pool.
+void runDelayedTasks(ThreadPoolExecutor& ex, size_t n, nanoseconds delay) {
+  auto numThreads = ex.numThreads();
+  Latch started(numThreads);
+  SaturatingSemaphore<true> blocked;
+  Latch done(numThreads + n);
+  for (size_t i = 0; i < numThreads; ++i) {
+    ex.add([&] {
+      started.count_down();
+      blocked.wait();
+      done.count_down();
+    });
+  }
+  started.wait();
+  for (size_t i = 0; i < n; ++i) {
+    ex.add([&] { done.count_down(); });
+  }
+  /* sleep override */ std::this_thread::sleep_for(delay);
+  blocked.post();
+  done.wait();
+}
+
+QueueDelayPoolSizer::Options makeOptions() {
+  QueueDelayPoolSizer::Options options;
+  options.targetDelay = milliseconds(1);
+  options.minThreads = 1;
+  options.maxThreads = 4;
+  options.shrinkIntervals = 3;
+  return options;
+}
+
+} // namespace
+
+TEST(QueueDelayPoolSizer, growsAndShrinks) {
+  CPUThreadPoolExecutor ex(1);
+  QueueDelayPoolSizer sizer(ex, makeOptions());
+
+  runDelayedTasks(ex, 10, milliseconds(5));
+  EXPECT_EQ(2, sizer.update());
+  EXPECT_EQ(2, ex.numThreads());
+  EXPECT_GE(sizer.lastQueueDelay(), milliseconds(1));
+
+  // Shrinking only happens after shrinkIntervals quiet intervals.
+  EXPECT_EQ(2, sizer.update());
+  EXPECT_EQ(nanoseconds(0), sizer.lastQueueDelay());
+  EXPECT_EQ(2, sizer.update());
+  EXPECT_EQ(1, sizer.update());
+  EXPECT_EQ(1, ex.numThreads());
+  // And never below minThreads.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(1, sizer.update());
+  }
+  ex.join();
+}
+
+TEST(QueueDelayPoolSizer, overloadResetsQuietIntervals) {
+  CPUThreadPoolExecutor ex(2);
+  QueueDelayPoolSizer sizer(ex, makeOptions());
+  EXPECT_EQ(2, sizer.update());
+  EXPECT_EQ(2, sizer.update());
+  runDelayedTasks(ex, 10, milliseconds(5));
+  EXPECT_EQ(3, sizer.update());
+  EXPECT_EQ(3, sizer.update());
+  EXPECT_EQ(3, sizer.update());
+  EXPECT_EQ(2, sizer.update());
+  ex.join();
+}
+
+TEST(QueueDelayPoolSizer, stalledPoolIsNotQuiet) {
+  CPUThreadPoolExecutor ex(2);
+  auto options = makeOptions();
+  options.minThreads = 2;
+  QueueDelayPoolSizer sizer(ex, options);
+  Latch started(2);
+  SaturatingSemaphore<true> blocked;
+  for (int i = 0; i < 2; ++i) {
+    ex.add([&] {
+      started.count_down();
+      blocked.wait();
+    });
+  }
+  started.wait();
+  Latch done(1);
+  ex.add([&] { done.count_down(); });
+  // This interval saw the blocking tasks dequeued without delay.
+  EXPECT_EQ(2, sizer.update());
+  // Nothing is dequeued in the next one, but a task has been waiting all
+  // along: that is an overload, not a quiet interval.
+  EXPECT_EQ(3, sizer.update());
+  EXPECT_GE(sizer.lastQueueDelay(), options.interval);
+  blocked.post();
+  done.wait();
+  ex.join();
+}
+
+TEST(QueueDelayPoolSizer, growsUpToMax) {
+  CPUThreadPoolExecutor ex(1);
+  auto options = makeOptions();
+  options.growFactor = 1;
+  QueueDelayPoolSizer sizer(ex, options);
+  for (size_t expected : {2, 4, 4}) {
+    runDelayedTasks(ex, 10, milliseconds(5));
+    EXPECT_EQ(expected, sizer.update());
+    EXPECT_EQ(expected, ex.numThreads());
+  }
+  ex.join();
+}
+
+TEST(QueueDelayPoolSizer, defaultMaxThreads) {
+  CPUThreadPoolExecutor ex(3);
+  QueueDelayPoolSizer sizer(ex, {});
+  EXPECT_EQ(3, sizer.options().maxThreads);
+  ex.join();
+}
+
+TEST(QueueDelayPoolSizer, invalidOptions) {
+  CPUThreadPoolExecutor ex(1);
+  auto options = makeOptions();
+  options.minThreads = 5;
+  EXPECT_THROW(QueueDelayPoolSizer(ex, options), std::invalid_argument);
+  options = makeOptions();
+  options.quantile = 0;
+  EXPECT_THROW(QueueDelayPoolSizer(ex, options), std::invalid_argument);
+  ex.join();
+}
+
+TEST(QueueDelayPoolSizer, startStop) {
+  CPUThreadPoolExecutor ex(1);
+  auto options = makeOptions();
+  options.interval = milliseconds(1);
+  QueueDelayPoolSizer sizer(ex, options);
+  sizer.start();
+  runDelayedTasks(ex, 100, milliseconds(20));
+  sizer.stop();
+  EXPECT_GE(ex.numThreads(), 1);
+  EXPECT_LE(ex.numThreads(), 4);
+  sizer.start();
+  sizer.stop();
+  ex.join();
+}
@@ -17,11 +17,13 @@
 #include <folly/executors/SerialExecutor.h>
 
 #include <chrono>
+#include <numeric>
 
 #include <folly/Random.h>
 #include <folly/ScopeGuard.h>
 #include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/executors/InlineExecutor.h>
+#include <folly/executors/ManualExecutor.h>
 #include <folly/io/async/Request.h>
 #include <folly/portability/GTest.h>
 #include <folly/synchronization/Baton.h>
@@ -237,6 +239,72 @@ TYPED_TEST(SerialExecutorTest, Stress) {
   EXPECT_EQ(tasksRan, kNumProducers * (kNumIterations + 1));
 }
 
+TYPED_TEST(SerialExecutorTest, RunQuantum) {
+  folly::ManualExecutor parent;
+  auto se = TypeParam::create(&parent, folly::SerialRunQuantum{3});
+  std::vector<int> values;
+  for (int i = 0; i < 10; ++i) {
+    se->add([i, &values] { values.push_back(i); });
+  }
+
+  // Each activation runs three tasks and yields by adding the next one.
+  for (size_t expected : {3, 6, 9, 10}) {
+    EXPECT_EQ(1, parent.run());
+    EXPECT_EQ(expected, values.size());
+  }
+  EXPECT_EQ(0, parent.run());
+
+  // Adding while an activation is pending does not add another one.
+  se->add([&] { values.push_back(10); });
+  se->add([&] { values.push_back(11); });
+  EXPECT_EQ(1, parent.run());
+  EXPECT_EQ(0, parent.run());
+  std::vector<int> expected(12);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(expected, values);
+}
+
+TYPED_TEST(SerialExecutorTest, RunQuantumTime) {
+  folly::ManualExecutor parent;
+  folly::SerialRunQuantum quantum;
+  quantum.maxTime = std::chrono::microseconds(100);
+  auto se = TypeParam::create(&parent, quantum);
+  size_t ran = 0;
+  for (int i = 0; i < 3; ++i) {
+    se->add([&] {
+      sleepMs(1);
+      ++ran;
+    });
+  }
+  for (size_t expected = 1; expected <= 3; ++expected) {
+    EXPECT_EQ(1, parent.run());
+    EXPECT_EQ(expected, ran);
+  }
+  EXPECT_EQ(0, parent.run());
+}
+
+TYPED_TEST(SerialExecutorTest, RunQuantumStress) {
+  folly::CPUThreadPoolExecutor parent{4};
+  auto se = TypeParam::create(&parent, folly::SerialRunQuantum{4});
+
+  size_t tasksRan = 0;
+  constexpr size_t kNumProducers = 8;
+  static constexpr size_t kNumIterations = 1024;
+  folly::CPUThreadPoolExecutor producers{kNumProducers};
+  for (size_t i = 0; i < kNumProducers; ++i) {
+    producers.add([se, &tasksRan] {
+      for (size_t j = 0; j < kNumIterations; ++j) {
+        se->add([&tasksRan] { ++tasksRan; });
+      }
+    });
+  }
+
+  producers.join();
+  se = {};
+  parent.join();
+  EXPECT_EQ(tasksRan, kNumProducers * kNumIterations);
+}
+
 // Basic test for SerialExecutorMPSCQueue, does not exercise concurrent access
 // but just ensure that the state stays consistent under different
 // enqueue/dequeue patterns.
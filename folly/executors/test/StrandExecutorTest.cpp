@@ -62,6 +62,40 @@ TEST(StrandExecutor, SimpleTest) {
   }
 }
 
+TEST(StrandExecutor, RunQuantum) {
+  ManualExecutor ex1;
+  ManualExecutor ex2;
+  auto strand = StrandContext::create(SerialRunQuantum{2});
+  auto exec1 = StrandExecutor::create(strand, getKeepAliveToken(ex1));
+  auto exec2 = StrandExecutor::create(strand, getKeepAliveToken(ex2));
+  std::vector<int> v;
+  for (int i = 0; i < 5; ++i) {
+    exec1->add([&, i] { v.push_back(i); });
+  }
+  exec2->add([&] { v.push_back(5); });
+
+  // Two functions per task, and functions for another executor are run in
+  // a task of that executor.
+  for (size_t expected : {2, 4, 5}) {
+    EXPECT_EQ(1, ex1.run());
+    EXPECT_EQ(expected, v.size());
+  }
+  EXPECT_EQ(0, ex1.run());
+  EXPECT_EQ(1, ex2.run());
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5}), v);
+
+  // The default quantum caps a task at 32 functions.
+  auto defaultExec =
+      StrandExecutor::create(StrandContext::create(), getKeepAliveToken(ex1));
+  for (int i = 0; i < 40; ++i) {
+    defaultExec->add([&] { v.push_back(0); });
+  }
+  EXPECT_EQ(1, ex1.run());
+  EXPECT_EQ(6 + StrandContext::kDefaultRunQuantum.maxTasks, v.size());
+  EXPECT_EQ(1, ex1.run());
+  EXPECT_EQ(46, v.size());
+}
+
 TEST(StrandExecutor, ThreadSafetyTest) {
   auto strandContext = StrandContext::create();
 
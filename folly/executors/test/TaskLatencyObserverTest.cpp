@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/executors/TaskLatencyObserver.h>
+
+#include <array>
+#include <chrono>
+#include <thread>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/IOThreadPoolExecutor.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+
+using namespace folly;
+using namespace std::chrono;
+
+namespace {
+
+constexpr std::array<double, 3> kQuantiles{{0.5, 0.9, 0.99}};
+
+void spinFor(nanoseconds duration) {
+  auto end = steady_clock::now() + duration;
+  while (steady_clock::now() < end) {
+  }
+}
+
+} // namespace
+
+TEST(TaskLatencyObserver, perPriority) {
+  CPUThreadPoolExecutor ex(1, 2);
+  auto& observer = TaskLatencyObserver::install(ex);
+  // Hold the only thread, so that the tasks below wait in the queue.
+  Baton<> started;
+  Baton<> blocked;
+  ex.addWithPriority(
+      [&] {
+        started.post();
+        blocked.wait();
+      },
+      Executor::LO_PRI);
+  started.wait();
+  for (int i = 0; i < 20; ++i) {
+    ex.addWithPriority([] { spinFor(microseconds(200)); }, Executor::HI_PRI);
+    ex.addWithPriority([] {}, Executor::LO_PRI);
+  }
+  /* sleep override */ std::this_thread::sleep_for(milliseconds(5));
+  blocked.post();
+  ex.join();
+  observer.flush();
+
+  EXPECT_EQ(
+      (std::vector<int8_t>{Executor::LO_PRI, Executor::HI_PRI}),
+      observer.priorities());
+
+  auto hi = observer.estimate(Executor::HI_PRI, kQuantiles);
+  EXPECT_EQ(20, hi.waitTime.count);
+  EXPECT_EQ(20, hi.runTime.count);
+  EXPECT_GE(hi.runTime.quantiles[0].second, 200000);
+  EXPECT_GE(hi.waitTime.quantiles[0].second, 5000000);
+
+  auto lo = observer.estimate(Executor::LO_PRI, kQuantiles);
+  EXPECT_EQ(21, lo.waitTime.count);
+  EXPECT_EQ(21, lo.runTime.count);
+  // The low priority ones also waited for all the high priority ones.
+  EXPECT_GE(lo.waitTime.quantiles[0].second, 5000000 + 20 * 200000);
+
+  auto all = observer.estimateAll(kQuantiles);
+  EXPECT_EQ(41, all.waitTime.count);
+  EXPECT_EQ(hi.runTime.sum + lo.runTime.sum, all.runTime.sum);
+
+  auto none = observer.estimate(0, kQuantiles);
+  EXPECT_EQ(0, none.waitTime.count);
+  EXPECT_EQ(kQuantiles.size(), none.runTime.quantiles.size());
+}
+
+TEST(TaskLatencyObserver, sampling) {
+  constexpr int kTasks = 1000;
+  constexpr uint32_t kSampleEvery = 10;
+  CPUThreadPoolExecutor ex(2);
+  TaskLatencyObserver::Options options;
+  options.sampleEvery = kSampleEvery;
+  auto& observer = TaskLatencyObserver::install(ex, options);
+  for (int i = 0; i < kTasks; ++i) {
+    ex.add([] {});
+  }
+  ex.join();
+  observer.flush();
+  // Tasks added from one thread get consecutive ids.
+  auto estimates = observer.estimate(0, kQuantiles);
+  EXPECT_NEAR(kTasks / kSampleEvery, estimates.waitTime.count, 1);
+  EXPECT_EQ(estimates.waitTime.count, estimates.runTime.count);
+}
+
+TEST(TaskLatencyObserver, expired) {
+  CPUThreadPoolExecutor ex(1);
+  auto& observer = TaskLatencyObserver::install(ex);
+  Baton<> blocked;
+  ex.add([&] { blocked.wait(); });
+  ex.add([] {}, milliseconds(1), [] {});
+  /* sleep override */ std::this_thread::sleep_for(milliseconds(5));
+  blocked.post();
+  ex.join();
+  observer.flush();
+  auto estimates = observer.estimate(0, kQuantiles);
+  EXPECT_EQ(2, estimates.waitTime.count);
+  EXPECT_EQ(1, estimates.runTime.count);
+}
+
+TEST(TaskLatencyObserver, ioPool) {
+  IOThreadPoolExecutor ex(2);
+  auto& observer = TaskLatencyObserver::install(ex);
+  for (int i = 0; i < 100; ++i) {
+    ex.add([] {});
+  }
+  ex.join();
+  observer.flush();
+  EXPECT_EQ(std::vector<int8_t>{0}, observer.priorities());
+  EXPECT_EQ(100, observer.estimateAll(kQuantiles).runTime.count);
+}
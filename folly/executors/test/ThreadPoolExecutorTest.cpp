@@ -24,6 +24,7 @@
 #include <atomic>
 #include <memory>
 #include <thread>
+#include <vector>
 
 #include <boost/thread.hpp>
 
@@ -430,6 +431,49 @@ TEST(ThreadPoolExecutorTest, GetUsedCpuTime) {
 #endif
 }
 
+template <class TPE>
+static void addBatch() {
+  static constexpr size_t kNumTasks = 100;
+  TPE tpe(4);
+  std::atomic<size_t> ran{0};
+  std::vector<Func> funcs;
+  for (size_t i = 0; i < kNumTasks; ++i) {
+    funcs.push_back([&] { ++ran; });
+  }
+  tpe.addBatch(range(funcs));
+  tpe.addBatch({});
+
+  // Also from one of the pool threads.
+  folly::Baton<> nested;
+  tpe.add([&] {
+    std::vector<Func> more;
+    for (size_t i = 0; i < kNumTasks; ++i) {
+      more.push_back([&] { ++ran; });
+    }
+    tpe.addBatch(range(more));
+    nested.post();
+  });
+  nested.wait();
+  tpe.join();
+  EXPECT_EQ(2 * kNumTasks, ran.load());
+}
+
+TYPED_TEST(ThreadPoolExecutorTypedTest, AddBatch) {
+  addBatch<TypeParam>();
+}
+
+TEST(ThreadPoolExecutorTest, CPUAddBatchPriorityQueue) {
+  CPUThreadPoolExecutor tpe(2, 3);
+  std::atomic<size_t> ran{0};
+  std::vector<Func> funcs;
+  for (size_t i = 0; i < 10; ++i) {
+    funcs.push_back([&] { ++ran; });
+  }
+  tpe.addBatch(range(funcs));
+  tpe.join();
+  EXPECT_EQ(10, ran.load());
+}
+
 template <class TPE>
 static void expiration() {
   TPE tpe(1);
@@ -461,6 +505,52 @@ TEST(ThreadPoolExecutorTest, IOExpiration) {
   expiration<IOThreadPoolExecutor>();
 }
 
+TEST(ThreadPoolExecutorTest, EDFExpiration) {
+  std::atomic<uint64_t> now{0};
+  EDFThreadPoolExecutor::Options options;
+  options.clock = [&] { return now.load(); };
+  options.expirySlack = 30;
+  EDFThreadPoolExecutor tpe(1, std::move(options));
+
+  std::atomic<int> expired{0};
+  tpe.subscribeToTaskStats([&](const ThreadPoolExecutor::TaskStats& stats) {
+    expired += stats.expired;
+  });
+
+  Baton<> started;
+  Baton<> unblock;
+  tpe.add(
+      [&] {
+        started.post();
+        unblock.wait();
+      },
+      EDFThreadPoolExecutor::kEarliestDeadline);
+  started.wait();
+
+  std::vector<int> ran;
+  int expireCbCount = 0;
+  tpe.addWithDeadline(
+      [&] { ran.push_back(10); }, 10, [&] { ++expireCbCount; });
+  tpe.add([&] { ran.push_back(100); }, 100);
+  std::vector<Func> fs;
+  fs.push_back([&] { ran.push_back(50); });
+  fs.push_back([&] { ran.push_back(50); });
+  tpe.add(std::move(fs), 50);
+  tpe.addWithDeadline(
+      [&] { ran.push_back(200); }, 200, [&] { ++expireCbCount; });
+
+  // Everything but the tasks due at 100 and 200 is more than 30 late.
+  now = 120;
+  unblock.post();
+  tpe.join();
+
+  EXPECT_EQ((std::vector<int>{100, 200}), ran);
+  EXPECT_EQ(1, expireCbCount);
+  EXPECT_EQ(4, tpe.getNumDeadlineMisses());
+  EXPECT_EQ(3, tpe.getNumExpiredTasks());
+  EXPECT_EQ(3, expired.load());
+}
+
 template <typename TPE>
 static void futureExecutor() {
   FutureExecutor<TPE> fe(2);
@@ -787,6 +877,17 @@ TEST(ThreadPoolExecutorTest, LifoSemMPMCQueueBugD3527722) {
   bugD3527722_test<LifoSemMPMCQueue<SlowMover>>();
 }
 
+TEST(ThreadPoolExecutorTest, LifoSemMPMCQueueAddBatchFull) {
+  LifoSemMPMCQueue<int> q(2);
+  std::vector<int> items{1, 2, 3};
+  EXPECT_THROW(q.addBatch(range(items)), QueueFullException);
+  // What made it into the queue before it was full can still be taken.
+  EXPECT_EQ(2, q.size());
+  EXPECT_EQ(1, q.take());
+  EXPECT_EQ(2, q.take());
+  EXPECT_FALSE(q.try_take_for(milliseconds(1)).has_value());
+}
+
 template <typename T>
 struct UBQ : public UnboundedBlockingQueue<T> {
   explicit UBQ(int) {}
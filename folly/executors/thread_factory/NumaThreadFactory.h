@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <folly/executors/thread_factory/ThreadFactory.h>
+#include <folly/system/NumaTopology.h>
+
+namespace folly {
+
+/**
+ * A ThreadFactory that binds each new thread to a NUMA node, going round
+ * robin over the nodes of the topology, so that a pool of threads is spread
+ * evenly across nodes. Meant to be used with NumaBlockingQueue, which keeps
+ * tasks on the node of the thread that added them.
+ */
+class NumaThreadFactory : public ThreadFactory {
+ public:
+  explicit NumaThreadFactory(
+      std::shared_ptr<ThreadFactory> threadFactory,
+      NumaTopology topology = NumaTopology::system())
+      : threadFactory_(std::move(threadFactory)),
+        topology_(std::make_shared<const NumaTopology>(std::move(topology))) {}
+
+  std::thread newThread(Func&& func) override {
+    auto node = nextNode_.fetch_add(1, std::memory_order_relaxed) %
+        topology_->numNodes();
+    return threadFactory_->newThread(
+        [func = std::move(func), topology = topology_, node]() mutable {
+          topology->bindCurrentThread(node);
+          func();
+        });
+  }
+
+  const std::string& getNamePrefix() const override {
+    return threadFactory_->getNamePrefix();
+  }
+
+  const NumaTopology& topology() const { return *topology_; }
+
+ private:
+  std::shared_ptr<ThreadFactory> threadFactory_;
+  std::shared_ptr<const NumaTopology> topology_;
+  std::atomic<size_t> nextNode_{0};
+};
+
+} // namespace folly
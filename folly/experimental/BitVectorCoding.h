@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdlib>
 #include <limits>
 #include <type_traits>
@@ -281,6 +282,44 @@ class BitVectorReader : detail::ForwardPointers<Encoder::forwardQuantum>,
     return setValue(inner);
   }
 
+  /**
+   * Reads the next (up to) n elements into out, leaving the reader on the
+   * last one as n calls to next() would. Returns the number read, which is
+   * less than n only if the end of the list is reached.
+   */
+  size_t nextBatch(ValueType* out, size_t n) {
+    size_t count = n;
+    if (!kUnchecked) {
+      // Also right after the end, when position() + 1 > size().
+      const SizeType next = position() + 1;
+      count = next < size_ ? std::min<size_t>(n, size_ - next) : 0;
+    }
+    // Work on locals: stores to out could otherwise alias the members.
+    uint64_t block = block_;
+    SizeType outer = outer_;
+    size_t i = 0;
+    while (i < count) {
+      while (block == 0) {
+        outer += sizeof(uint64_t);
+        block = folly::loadUnaligned<uint64_t>(bits_ + outer);
+      }
+      // All the 1-bits of the block, without going back to the outer loop.
+      do {
+        out[i++] = static_cast<ValueType>(8 * outer + Instructions::ctz(block));
+        block = Instructions::blsr(block);
+      } while (block != 0 && i < count);
+    }
+    block_ = block;
+    outer_ = outer;
+    position_ += static_cast<SizeType>(count);
+    if (count < n) {
+      setDone();
+    } else if (count > 0) {
+      value_ = out[count - 1];
+    }
+    return count;
+  }
+
   bool skip(SizeType n) {
     if (n == 0) {
       return valid();
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Intersection of sorted lists read through the readers of
+ * EliasFanoCoding.h and BitVectorCoding.h, in any combination.
+ */
+
+#pragma once
+
+namespace folly {
+namespace compression {
+
+/**
+ * Writes the values present in both lists to out, in increasing order, and
+ * returns the advanced output iterator. A value repeated in both lists is
+ * written as many times as it is in the list that has it fewer times.
+ *
+ * Both readers are reset() first. The reader that is behind leapfrogs to
+ * the other's value with skipTo(), which uses the skip pointers of the list
+ * if it has them, so long runs of values present in only one list cost a
+ * few pointer lookups instead of a scan.
+ */
+template <class ReaderA, class ReaderB, class OutputIterator>
+OutputIterator intersect(ReaderA& a, ReaderB& b, OutputIterator out) {
+  a.reset();
+  b.reset();
+  if (!a.next() || !b.next()) {
+    return out;
+  }
+  while (true) {
+    if (a.value() < b.value()) {
+      if (!a.skipTo(b.value())) {
+        break;
+      }
+    } else if (b.value() < a.value()) {
+      if (!b.skipTo(a.value())) {
+        break;
+      }
+    } else {
+      *out++ = a.value();
+      if (!a.next() || !b.next()) {
+        break;
+      }
+    }
+  }
+  return out;
+}
+
+} // namespace compression
+} // namespace folly
@@ -437,6 +437,45 @@ class UpperBitsReader : ForwardPointers<Encoder::forwardQuantum>,
     return setValue(inner);
   }
 
+  // Writes the next (up to) n values to out, decoding a block at a time:
+  // out[i] = decode(i, upper bits of the i-th value). Returns how many were
+  // written; if fewer than n, the reader is done.
+  template <class Decode>
+  FOLLY_ALWAYS_INLINE size_t
+  nextBatch(ValueType* out, size_t n, Decode&& decode) {
+    size_t count = n;
+    if (!kUnchecked) {
+      // Also right after the end, when position() + 1 > size().
+      const SizeType next = addT(position(), 1);
+      count = next < size() ? std::min<size_t>(n, size() - next) : 0;
+    }
+    // Work on locals: stores to out could otherwise alias the members.
+    block_t block = block_;
+    OuterType outer = outer_;
+    SizeType position = position_;
+    ValueType upper = value_;
+    for (size_t i = 0; i < count; ++i) {
+      while (block == 0) {
+        outer += sizeof(block_t);
+        block = loadUnaligned<block_t>(start_ + outer);
+      }
+      ++position;
+      upper = static_cast<ValueType>(
+          8 * outer + Instructions::ctz(block) - position);
+      out[i] = decode(i, upper);
+      block = Instructions::blsr(block);
+    }
+    block_ = block;
+    outer_ = outer;
+    position_ = position;
+    if (count < n) {
+      setDone();
+    } else {
+      value_ = upper;
+    }
+    return count;
+  }
+
   FOLLY_ALWAYS_INLINE bool skip(SizeType n) {
     DCHECK_GT(n, 0);
     if (!kUnchecked && FOLLY_UNLIKELY(addT(position_, n) >= size())) {
@@ -708,6 +747,32 @@ class EliasFanoReader {
     return false;
   }
 
+  /**
+   * Reads the next (up to) n elements into out, leaving the reader on the
+   * last one as n calls to next() would. Returns the number read, which is
+   * less than n only if the end of the list is reached. The upper and lower
+   * bits of the whole batch are decoded in one loop, which keeps the reader
+   * state in registers instead of updating it per element.
+   */
+  size_t nextBatch(ValueType* out, size_t n) {
+    const uint8_t* const lower = lower_;
+    const size_t numLowerBits = numLowerBits_;
+    assume(numLowerBits < sizeof(ValueType) * 8);
+    const size_t first = size_t(detail::addT(position(), 1)) * numLowerBits;
+    const size_t count = upper_.nextBatch(
+        out, n, [&](size_t i, ValueType upper) {
+          const size_t pos = first + i * numLowerBits;
+          const auto ptrv = loadUnaligned<uint64_t>(lower + pos / 8);
+          return static_cast<ValueType>(
+              Instructions::bextr(ptrv, pos % 8, numLowerBits) |
+              (uint64_t(upper) << numLowerBits));
+        });
+    if (count == n && count > 0) {
+      setValue(out[count - 1]);
+    }
+    return count;
+  }
+
   /**
    * Advances by n elements. n = 0 is allowed and has no effect. Returns false
    * if the end of the list is reached. position() + n must be representable by
@@ -32,14 +32,18 @@ ExecutionObserverScopeGuard::ExecutionObserverScopeGuard(
       execution_observer_callbacks_starting,
       id_,
       static_cast<int>(callbackType_));
-  for (auto& observer : *observerList_) {
-    observer.starting(id_, callbackType_);
+  if (observerList_) {
+    for (auto& observer : *observerList_) {
+      observer.starting(id_, callbackType_);
+    }
   }
 }
 
 ExecutionObserverScopeGuard::~ExecutionObserverScopeGuard() {
-  for (auto& observer : *observerList_) {
-    observer.stopped(id_, callbackType_);
+  if (observerList_) {
+    for (auto& observer : *observerList_) {
+      observer.stopped(id_, callbackType_);
+    }
   }
 
   FOLLY_SDT(
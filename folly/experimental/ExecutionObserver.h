@@ -36,6 +36,7 @@ class ExecutionObserver
     Event,
     Loop,
     NotificationQueue,
+    Timeout,
     // Owned by FiberManager.
     Fiber,
   };
@@ -62,6 +63,9 @@ class ExecutionObserver
   virtual void stopped(uintptr_t id, CallbackType callbackType) noexcept = 0;
 };
 
+/**
+ * Notifies the observers in observerList, if not nullptr, around a task.
+ */
 class ExecutionObserverScopeGuard {
  public:
   ExecutionObserverScopeGuard(
@@ -248,7 +248,7 @@ void FunctionScheduler::addFunctionToHeapChecked(
         "FunctionScheduler: a function named \"", nameID, "\" already exists"));
   }
 
-  if (currentFunction_ && currentFunction_->name == nameID) {
+  if (runningFunctions_.count(nameID)) {
     throw std::invalid_argument(to<std::string>(
         "FunctionScheduler: a function named \"", nameID, "\" already exists"));
   }
@@ -286,18 +286,20 @@ void FunctionScheduler::addFunctionInternal(
       std::move(cb), std::move(fn), nameID, intervalDescr, startDelay, runOnce);
 }
 
-bool FunctionScheduler::cancelFunctionWithLock(
+FunctionScheduler::RepeatFunc* FunctionScheduler::cancelFunctionWithLock(
     std::unique_lock<std::mutex>& lock, StringPiece nameID) {
   CHECK_EQ(lock.owns_lock(), true);
-  if (currentFunction_ && currentFunction_->name == nameID) {
-    functionsMap_.erase(currentFunction_->name);
-    // This function is currently being run. Clear currentFunction_
+  auto it = runningFunctions_.find(nameID);
+  if (it != runningFunctions_.end()) {
+    auto* func = it->second;
+    // This function is currently being run. Remove it from runningFunctions_
     // The running thread will see this and won't reschedule the function.
-    currentFunction_ = nullptr;
-    cancellingCurrentFunction_ = true;
-    return true;
+    runningFunctions_.erase(it);
+    functionsMap_.erase(func->name);
+    cancellingFunctions_.insert(func);
+    return func;
   }
-  return false;
+  return nullptr;
 }
 
 bool FunctionScheduler::cancelFunction(StringPiece nameID) {
@@ -317,8 +319,9 @@ bool FunctionScheduler::cancelFunction(StringPiece nameID) {
 bool FunctionScheduler::cancelFunctionAndWait(StringPiece nameID) {
   std::unique_lock<std::mutex> l(mutex_);
 
-  if (cancelFunctionWithLock(l, nameID)) {
-    runningCondvar_.wait(l, [this]() { return !cancellingCurrentFunction_; });
+  if (auto* func = cancelFunctionWithLock(l, nameID)) {
+    runningCondvar_.wait(
+        l, [&]() { return !cancellingFunctions_.count(func); });
     return true;
   }
 
@@ -344,11 +347,11 @@ bool FunctionScheduler::cancelAllFunctionsWithLock(
   CHECK_EQ(lock.owns_lock(), true);
   functions_.clear();
   functionsMap_.clear();
-  if (currentFunction_) {
-    cancellingCurrentFunction_ = true;
+  for (auto& running : runningFunctions_) {
+    cancellingFunctions_.insert(running.second);
   }
-  currentFunction_ = nullptr;
-  return cancellingCurrentFunction_;
+  runningFunctions_.clear();
+  return !cancellingFunctions_.empty();
 }
 
 void FunctionScheduler::cancelAllFunctions() {
@@ -359,17 +362,18 @@ void FunctionScheduler::cancelAllFunctions() {
 void FunctionScheduler::cancelAllFunctionsAndWait() {
   std::unique_lock<std::mutex> l(mutex_);
   if (cancelAllFunctionsWithLock(l)) {
-    runningCondvar_.wait(l, [this]() { return !cancellingCurrentFunction_; });
+    runningCondvar_.wait(l, [this]() { return cancellingFunctions_.empty(); });
   }
 }
 
 bool FunctionScheduler::resetFunctionTimer(StringPiece nameID) {
   std::unique_lock<std::mutex> l(mutex_);
-  if (currentFunction_ && currentFunction_->name == nameID) {
-    if (cancellingCurrentFunction_ || currentFunction_->runOnce) {
+  auto running = runningFunctions_.find(nameID);
+  if (running != runningFunctions_.end()) {
+    if (running->second->runOnce) {
       return false;
     }
-    currentFunction_->resetNextRunTime(steady_clock::now());
+    running->second->resetNextRunTime(steady_clock::now());
     return true;
   }
 
@@ -424,6 +428,12 @@ bool FunctionScheduler::shutdown() {
     runningCondvar_.notify_one();
   }
   thread_.join();
+
+  // Wait for the functions still running on the executor, if any.
+  std::unique_lock<std::mutex> l(mutex_);
+  runningCondvar_.wait(l, [this]() {
+    return runningFunctions_.empty() && cancellingFunctions_.empty();
+  });
   return true;
 }
 
@@ -477,7 +487,7 @@ void FunctionScheduler::runOneFunction(
     VLOG(5) << func->name << "function has been canceled while waiting";
     return;
   }
-  currentFunction_ = func.get();
+  runningFunctions_.emplace(func->name, func.get());
   // Update the function's next run time.
   if (steady_) {
     // This allows scheduler to catch up
@@ -491,31 +501,60 @@ void FunctionScheduler::runOneFunction(
     func->setNextRunTimeStrict(now);
   }
 
-  // Release the lock while we invoke the user's function
+  // Release the lock while we invoke the user's function, or hand it to the
+  // executor, which may run it inline.
   lock.unlock();
 
-  // Invoke the function
+  if (executor_) {
+    executor_->add([this, func_2 = std::move(func)]() mutable {
+      invokeFunction(*func_2);
+      std::unique_lock<std::mutex> l(mutex_);
+      finishFunction(l, std::move(func_2));
+      // Wake up the running thread, which may need to run this function
+      // sooner than whatever it is waiting for, and any cancel or shutdown
+      // waiting for the function to complete.
+      runningCondvar_.notify_all();
+    });
+    lock.lock();
+    return;
+  }
+
+  invokeFunction(*func);
+
+  // Re-acquire the lock
+  lock.lock();
+
+  finishFunction(lock, std::move(func));
+}
+
+void FunctionScheduler::invokeFunction(RepeatFunc& func) {
   try {
-    VLOG(5) << "Now running " << func->name;
-    func->cb();
+    VLOG(5) << "Now running " << func.name;
+    func.cb();
   } catch (const std::exception& ex) {
-    LOG(ERROR) << "Error running the scheduled function <" << func->name
+    LOG(ERROR) << "Error running the scheduled function <" << func.name
                << ">: " << exceptionStr(ex);
   }
+}
 
-  // Re-acquire the lock
-  lock.lock();
+void FunctionScheduler::finishFunction(
+    const std::unique_lock<std::mutex>& lock,
+    std::unique_ptr<RepeatFunc> func) {
+  // This function should only be called with mutex_ already locked.
+  DCHECK(lock.mutex() == &mutex_);
+  DCHECK(lock.owns_lock());
 
-  if (!currentFunction_) {
+  auto it = runningFunctions_.find(func->name);
+  if (it == runningFunctions_.end() || it->second != func.get()) {
     // The function was cancelled while we were running it.
     // We shouldn't reschedule it;
-    cancellingCurrentFunction_ = false;
+    cancellingFunctions_.erase(func.get());
     return;
   }
-  if (currentFunction_->runOnce) {
+  runningFunctions_.erase(it);
+  if (func->runOnce) {
     // Don't reschedule if the function only needed to run once.
-    functionsMap_.erase(currentFunction_->name);
-    currentFunction_ = nullptr;
+    functionsMap_.erase(func->name);
     return;
   }
 
@@ -524,9 +563,6 @@ void FunctionScheduler::runOneFunction(
   // have been cleared while we were invoking the user's function.)
   functions_.push_back(std::move(func));
 
-  // Clear currentFunction_
-  currentFunction_ = nullptr;
-
   if (running_) {
     std::push_heap(functions_.begin(), functions_.end(), fnCmp_);
   }
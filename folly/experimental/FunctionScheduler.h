@@ -22,9 +22,11 @@
 #include <thread>
 #include <vector>
 
+#include <folly/Executor.h>
 #include <folly/Function.h>
 #include <folly/Range.h>
 #include <folly/container/F14Map.h>
+#include <folly/container/F14Set.h>
 #include <folly/hash/Hash.h>
 
 namespace folly {
@@ -44,9 +46,10 @@ namespace folly {
  *   fs.shutdown();
  *
  *
- * Note: the class uses only one thread - if you want to use more than one
- *       thread, either use multiple FunctionScheduler objects, or check out
- *       ThreadedRepeatingFunctionRunner.h for a much simpler contract of
+ * Note: by default the class uses only one thread - if you want to use more
+ *       than one thread, either give it an executor to run the functions on
+ *       (see setExecutor()), use multiple FunctionScheduler objects, or check
+ *       out ThreadedRepeatingFunctionRunner.h for a much simpler contract of
  *       "run each function periodically in its own thread".
  *
  * start() schedules the functions, while shutdown() terminates further
@@ -74,6 +77,22 @@ class FunctionScheduler {
    */
   void setSteady(bool steady) { steady_ = steady; }
 
+  /**
+   * By default functions run on the scheduler's own thread, one at a time, so
+   * a slow function delays all the others. With an executor set, the
+   * scheduler thread only keeps time and hands every function that is due to
+   * the executor, so functions run concurrently with each other (but never
+   * with themselves: a function is rescheduled when its run completes).
+   *
+   * The executor must run every function added to it; shutdown() waits for
+   * the runs it started to complete.
+   *
+   * NOTE: it's only safe to set this before calling start()
+   */
+  void setExecutor(Executor::KeepAlive<> executor) {
+    executor_ = std::move(executor);
+  }
+
   /*
    * Parameters to control the function interval.
    *
@@ -329,6 +348,10 @@ class FunctionScheduler {
   void runOneFunction(
       std::unique_lock<std::mutex>& lock,
       std::chrono::steady_clock::time_point now);
+  void invokeFunction(RepeatFunc& func);
+  void finishFunction(
+      const std::unique_lock<std::mutex>& lock,
+      std::unique_ptr<RepeatFunc> func);
   void cancelFunction(const std::unique_lock<std::mutex>& lock, RepeatFunc* it);
   void addFunctionToHeap(
       const std::unique_lock<std::mutex>& lock,
@@ -358,9 +381,10 @@ class FunctionScheduler {
       std::chrono::microseconds startDelay,
       bool runOnce);
 
-  // Return true if the current function is being canceled
+  // Return true if any running function is being canceled
   bool cancelAllFunctionsWithLock(std::unique_lock<std::mutex>& lock);
-  bool cancelFunctionWithLock(
+  // Return the function if it is running and now being canceled
+  RepeatFunc* cancelFunctionWithLock(
       std::unique_lock<std::mutex>& lock, StringPiece nameID);
 
   std::thread thread_;
@@ -375,9 +399,12 @@ class FunctionScheduler {
   FunctionMap functionsMap_;
   RunTimeOrder fnCmp_;
 
-  // The function currently being invoked by the running thread.
-  // This is null when the running thread is idle
-  RepeatFunc* currentFunction_{nullptr};
+  // The functions currently being invoked, which are not in the heap. There is
+  // at most one unless an executor is set.
+  FunctionMap runningFunctions_;
+  // Functions that were canceled while being invoked, until the invocation
+  // completes.
+  folly::F14FastSet<RepeatFunc*> cancellingFunctions_;
 
   // Condition variable that is signalled whenever a new function is added
   // or when the FunctionScheduler is stopped.
@@ -385,7 +412,7 @@ class FunctionScheduler {
 
   std::string threadName_{"FuncSched"};
   bool steady_{false};
-  bool cancellingCurrentFunction_{false};
+  Executor::KeepAlive<> executor_;
 };
 
 } // namespace folly
@@ -16,6 +16,8 @@
 
 #include <folly/experimental/JemallocHugePageAllocator.h>
 
+#include <algorithm>
+#include <atomic>
 #include <sstream>
 
 #include <folly/portability/Malloc.h>
@@ -76,16 +78,28 @@ void print_error(int err, const char* msg) {
 
 class HugePageArena {
  public:
-  int init(int initial_nr_pages, int max_nr_pages);
+  int init(int initial_nr_pages, int max_nr_pages, bool growable);
 
   /* forces the system to actually back more pages */
   void init_more(int nr_pages);
 
+  /* grows by max(nr_pages, 1) huge pages when the reserved area is used up */
+  void enable_growth(int nr_pages);
+
   void* reserve(size_t size, size_t alignment);
 
   bool addressInArena(void* address) {
     auto addr = reinterpret_cast<uintptr_t>(address);
-    return addr >= start_ && addr < protEnd_;
+    if (addr >= start_ && addr < protEnd_) {
+      return true;
+    }
+    auto nrFull = nrFull_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < nrFull; ++i) {
+      if (addr >= full_[i].start && addr < full_[i].end) {
+        return true;
+      }
+    }
+    return false;
   }
 
   size_t freeSpace() { return end_ - freePtr_; }
@@ -93,8 +107,21 @@ class HugePageArena {
   unsigned arenaIndex() { return arenaIndex_; }
 
  private:
+  struct Range {
+    uintptr_t start;
+    uintptr_t end;
+  };
+
+  // Upper bound on the number of times a growable arena grows, so that the
+  // ranges it has used up fit in a fixed array that the hook can append to.
+  static constexpr size_t kMaxRanges = 64;
+
   void map_pages(size_t initial_nr_pages, size_t max_nr_pages);
 
+  static uintptr_t map_range(size_t len);
+
+  bool grow(size_t size, size_t alignment);
+
   bool setup_next_pages(uintptr_t nextFreePtr);
 
   static void* allocHook(
@@ -110,6 +137,11 @@ class HugePageArena {
   uintptr_t end_{0};
   uintptr_t freePtr_{0};
   uintptr_t protEnd_{0};
+  // Bytes to reserve when the range above is used up, or 0 if it is fixed
+  std::atomic<size_t> growSize_{0};
+  // The ranges used up before the current one, up to their protEnd_
+  Range full_[kMaxRanges];
+  std::atomic<size_t> nrFull_{0};
   extent_alloc_t* originalAlloc_{nullptr};
   extent_hooks_t extentHooks_;
   unsigned arenaIndex_{0};
@@ -126,23 +158,20 @@ static inline T align_up(T val, U alignment) {
   return (val + alignment - 1) & ~(alignment - 1);
 }
 
-// mmap enough memory to hold the aligned huge pages, then use madvise
-// to get huge pages. This can be checked in /proc/<pid>/smaps.
-// If successful, sets the arena member pointers to reflect the mapped memory.
-// Otherwise, leaves them unchanged (zeroed).
-void HugePageArena::map_pages(size_t initial_nr_pages, size_t max_nr_pages) {
-  // Initial mmapped area is large enough to contain the aligned huge pages
-  size_t initial_alloc_size = initial_nr_pages * kHugePageSize;
-  size_t max_alloc_size = max_nr_pages * kHugePageSize;
+// Reserve len bytes of address space, aligned to a huge page, and return
+// its start, or 0 on failure. len must be a multiple of kHugePageSize.
+// Warning: This can be called inside malloc(). Check the comments in
+// HugePageArena::allocHook before making any change to this function.
+uintptr_t HugePageArena::map_range(size_t len) {
+  // The mmapped area is large enough to contain the aligned huge pages
   int mflags = MAP_PRIVATE | MAP_ANONYMOUS;
 #if defined(__FreeBSD__)
   mflags |= MAP_ALIGNED_SUPER;
 #endif
-  void* p =
-      mmap(nullptr, max_alloc_size + kHugePageSize, PROT_NONE, mflags, -1, 0);
+  void* p = mmap(nullptr, len + kHugePageSize, PROT_NONE, mflags, -1, 0);
 
   if (p == MAP_FAILED) {
-    return;
+    return 0;
   }
 
   // Aligned start address
@@ -156,21 +185,62 @@ void HugePageArena::map_pages(size_t initial_nr_pages, size_t max_nr_pages) {
     munmap(p, excess_head);
   }
   if (excess_tail != 0) {
-    munmap((void*)(first_page + max_alloc_size), excess_tail);
+    munmap((void*)(first_page + len), excess_tail);
   }
 #endif
 
-  start_ = freePtr_ = protEnd_ = first_page;
-  end_ = start_ + max_alloc_size;
-
 #if defined(MADV_DONTDUMP) && defined(MADV_DODUMP)
   // Exclude (possibly large) unused portion of the mapping from coredumps.
-  madvise((void*)start_, end_ - start_, MADV_DONTDUMP);
+  madvise((void*)first_page, len, MADV_DONTDUMP);
 #endif
 
+  return first_page;
+}
+
+// mmap enough memory to hold the aligned huge pages, then use madvise
+// to get huge pages. This can be checked in /proc/<pid>/smaps.
+// If successful, sets the arena member pointers to reflect the mapped memory.
+// Otherwise, leaves them unchanged (zeroed).
+void HugePageArena::map_pages(size_t initial_nr_pages, size_t max_nr_pages) {
+  size_t initial_alloc_size = initial_nr_pages * kHugePageSize;
+  size_t max_alloc_size = max_nr_pages * kHugePageSize;
+  uintptr_t first_page = map_range(max_alloc_size);
+  if (first_page == 0) {
+    return;
+  }
+
+  start_ = freePtr_ = protEnd_ = first_page;
+  end_ = start_ + max_alloc_size;
+
   setup_next_pages(start_ + initial_alloc_size);
 }
 
+// Reserve another range, large enough for an extent of size bytes, and
+// continue from there. The rest of the current range is left unused.
+// Warning: Check the comments in HugePageArena::allocHook before making any
+// change to this function.
+bool HugePageArena::grow(size_t size, size_t alignment) {
+  auto nrFull = nrFull_.load(std::memory_order_relaxed);
+  auto growSize = growSize_.load(std::memory_order_relaxed);
+  if (growSize == 0 || nrFull == kMaxRanges) {
+    return false;
+  }
+  // Ranges start on a huge page, so only larger alignments need padding.
+  size_t needed = align_up(
+      size + (alignment > kHugePageSize ? alignment : 0), kHugePageSize);
+  size_t len = std::max(growSize, needed);
+  uintptr_t start = map_range(len);
+  if (start == 0) {
+    return false;
+  }
+
+  full_[nrFull] = {start_, protEnd_};
+  nrFull_.store(nrFull + 1, std::memory_order_release);
+  start_ = freePtr_ = protEnd_ = start;
+  end_ = start + len;
+  return true;
+}
+
 void HugePageArena::init_more(int nr_pages) {
   setup_next_pages(start_ + nr_pages * kHugePageSize);
 }
@@ -265,7 +335,8 @@ void* HugePageArena::allocHook(
   return res;
 }
 
-int HugePageArena::init(int initial_nr_pages, int max_nr_pages) {
+int HugePageArena::init(
+    int initial_nr_pages, int max_nr_pages, bool growable) {
   DCHECK(start_ == 0);
   DCHECK(usingJEMalloc());
 
@@ -283,9 +354,8 @@ int HugePageArena::init(int initial_nr_pages, int max_nr_pages) {
   // forever increasing the requested size after failed allocations.
   // Normally jemalloc asks for maps of increasing size in order to avoid
   // hitting the limit of allowed mmaps per process.
-  // Since this arena is backed by a single mmap and is using huge pages,
+  // Since this arena is backed by a few large mmaps and is using huge pages,
   // this is not a concern here.
-  // TODO: Support growth of the huge page arena.
   size_t mib[3];
   size_t miblen = sizeof(mib) / sizeof(size_t);
   std::ostringstream rtl_key;
@@ -362,16 +432,29 @@ int HugePageArena::init(int initial_nr_pages, int max_nr_pages) {
   if (start_ == 0) {
     return false;
   }
+  if (growable) {
+    enable_growth(max_nr_pages);
+  }
   return MALLOCX_ARENA(arenaIndex_) | MALLOCX_TCACHE_NONE;
 }
 
+void HugePageArena::enable_growth(int nr_pages) {
+  growSize_.store(
+      std::max<size_t>(nr_pages, 1) * kHugePageSize,
+      std::memory_order_relaxed);
+}
+
 // Warning: Check the comments in HugePageArena::allocHook before making any
 // change to this function.
 void* HugePageArena::reserve(size_t size, size_t alignment) {
   uintptr_t res = align_up(freePtr_, alignment);
   uintptr_t newFreePtr = res + size;
   if (newFreePtr > end_) {
-    return nullptr;
+    if (!grow(size, alignment)) {
+      return nullptr;
+    }
+    res = align_up(freePtr_, alignment);
+    newFreePtr = res + size;
   }
   if (newFreePtr > protEnd_) {
     if (!setup_next_pages(newFreePtr)) {
@@ -392,13 +475,24 @@ bool JemallocHugePageAllocator::default_init() {
   return init(0, 512);
 }
 
-bool JemallocHugePageAllocator::init(int initial_nr_pages, int max_nr_pages) {
+bool JemallocHugePageAllocator::default_init_once() {
+  // Like default_init(), but growing 1GB at a time.
+  static const bool kInitialized =
+      initialized() || init(0, 512, /* growable = */ true);
+  return kInitialized;
+}
+
+bool JemallocHugePageAllocator::init(
+    int initial_nr_pages, int max_nr_pages, bool growable) {
   if (hugePagesAllocSupported()) {
     if (flags_ == 0) {
-      flags_ = arena.init(initial_nr_pages, max_nr_pages);
+      flags_ = arena.init(initial_nr_pages, max_nr_pages, growable);
     } else {
       /* was already initialized, let's just init the requested pages */
       arena.init_more(initial_nr_pages);
+      if (growable) {
+        arena.enable_growth(max_nr_pages);
+      }
     }
   } else {
     LOG(WARNING) << "Huge Page Allocator not supported";
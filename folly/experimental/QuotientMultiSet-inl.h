@@ -391,6 +391,22 @@ bool QuotientMultiSet<Instructions>::Iterator::skipTo(uint64_t key) {
   return true;
 }
 
+template <class Instructions>
+size_t QuotientMultiSet<Instructions>::Iterator::nextBatch(
+    uint64_t* keys, size_t n, uint64_t end, size_t* positions) {
+  DCHECK_NE(pos_, size_t(-1)) << "Iterator must be positioned";
+  size_t count = 0;
+  while (count < n && !done() && key_ < end) {
+    keys[count] = key_;
+    if (positions != nullptr) {
+      positions[count] = pos_;
+    }
+    ++count;
+    next();
+  }
+  return count;
+}
+
 template <class Instructions>
 bool QuotientMultiSet<Instructions>::Iterator::nextOccupied() {
   while (FOLLY_UNLIKELY(occWord_ == 0)) {
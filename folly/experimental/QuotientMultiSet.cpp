@@ -16,32 +16,68 @@
 
 #include <folly/experimental/QuotientMultiSet.h>
 
+#include <algorithm>
 #include <cmath>
+#include <exception>
+#include <mutex>
+#include <thread>
 
+#include <folly/Executor.h>
 #include <folly/Math.h>
+#include <folly/synchronization/Latch.h>
 
 #if FOLLY_QUOTIENT_MULTI_SET_SUPPORTED
 
 namespace folly {
 
-QuotientMultiSetBuilder::QuotientMultiSetBuilder(
+auto QuotientMultiSetBuilder::computeParameters(
     size_t keyBits, size_t expectedElements, double loadFactor)
-    : keyBits_(keyBits), maxKey_(qms_detail::maxValue(keyBits_)) {
+    -> Parameters {
+  Parameters params;
+  params.maxKey = qms_detail::maxValue(keyBits);
   expectedElements = std::max<size_t>(expectedElements, 1);
   uint64_t numSlots = to_integral(ceil(expectedElements / loadFactor));
 
   // Make sure 1:1 mapping between key space and <divisor, remainder> pairs.
-  divisor_ = divCeil(maxKey_, numSlots);
-  remainderBits_ = findLastSet(divisor_ - 1);
+  params.divisor = divCeil(params.maxKey, numSlots);
+  params.remainderBits = findLastSet(params.divisor - 1);
 
   // We only support remainders as long as 56 bits. If the set is very
   // sparse, force the maximum allowed remainder size. This will waste
   // up to 3 extra blocks (because of 8-bit quotients) but be correct.
-  if (remainderBits_ > 56) {
-    remainderBits_ = 56;
-    divisor_ = uint64_t(1) << remainderBits_;
+  if (params.remainderBits > 56) {
+    params.remainderBits = 56;
+    params.divisor = uint64_t(1) << params.remainderBits;
   }
+  return params;
+}
+
+void QuotientMultiSetBuilder::appendMetadata(
+    IOBufQueue& buff,
+    size_t numBlocks,
+    size_t numKeys,
+    uint64_t divisor,
+    size_t keyBits,
+    uint64_t remainderBits) {
+  // Add metadata trailer. This will also allows getRemainder() to access whole
+  // 64-bits at any position without bounds-checking.
+  static_assert(sizeof(Metadata) > 7, "getRemainder() is not safe");
+  auto metadata = reinterpret_cast<Metadata*>(calloc(1, sizeof(Metadata)));
+  metadata->numBlocks = numBlocks;
+  metadata->numKeys = numKeys;
+  metadata->divisor = divisor;
+  metadata->keyBits = keyBits;
+  metadata->remainderBits = remainderBits;
+  VLOG(2) << "Metadata: " << metadata->debugString();
+  buff.append(IOBuf::takeOwnership(metadata, sizeof(Metadata)));
+}
 
+QuotientMultiSetBuilder::QuotientMultiSetBuilder(
+    size_t keyBits, size_t expectedElements, double loadFactor)
+    : keyBits_(keyBits), maxKey_(qms_detail::maxValue(keyBits_)) {
+  const auto params = computeParameters(keyBits, expectedElements, loadFactor);
+  divisor_ = params.divisor;
+  remainderBits_ = params.remainderBits;
   blockSize_ = Block::blockSize(remainderBits_);
   fraction_ = qms_detail::getInverse(divisor_);
 }
@@ -165,18 +201,252 @@ void QuotientMultiSetBuilder::close(IOBufQueue& buff) {
   }
 
   moveReadyBlocks(buff);
+  appendMetadata(
+      buff, numBlocks_, numKeys_, divisor_, keyBits_, remainderBits_);
+}
 
-  // Add metadata trailer. This will also allows getRemainder() to access whole
-  // 64-bits at any position without bounds-checking.
-  static_assert(sizeof(Metadata) > 7, "getRemainder() is not safe");
-  auto metadata = reinterpret_cast<Metadata*>(calloc(1, sizeof(Metadata)));
-  metadata->numBlocks = numBlocks_;
-  metadata->numKeys = numKeys_;
-  metadata->divisor = divisor_;
-  metadata->keyBits = keyBits_;
-  metadata->remainderBits = remainderBits_;
-  VLOG(2) << "Metadata: " << metadata->debugString();
-  buff.append(IOBuf::takeOwnership(metadata, sizeof(Metadata)));
+struct QuotientMultiSetParallelBuilder::Segment {
+  // Index of the first block in blocks.
+  size_t firstBlock = 0;
+  std::vector<BlockPtr> blocks;
+  // Number of keys stored in the slots of each block.
+  std::vector<uint32_t> numKeys;
+};
+
+QuotientMultiSetParallelBuilder::QuotientMultiSetParallelBuilder(
+    size_t keyBits, Executor* executor, double loadFactor, size_t numSegments)
+    : keyBits_(keyBits),
+      executor_(executor),
+      loadFactor_(loadFactor),
+      numSegments_(
+          numSegments != 0
+              ? numSegments
+              : 4 * std::max<size_t>(std::thread::hardware_concurrency(), 1)) {
+}
+
+template <class F>
+void QuotientMultiSetParallelBuilder::parallelFor(size_t n, F&& fn) {
+  if (executor_ == nullptr || n <= 1) {
+    for (size_t i = 0; i < n; ++i) {
+      fn(i);
+    }
+    return;
+  }
+  Latch latch(n);
+  std::mutex mutex;
+  std::exception_ptr error;
+  for (size_t i = 0; i < n; ++i) {
+    executor_->add([&, i] {
+      try {
+        fn(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+      latch.count_down();
+    });
+  }
+  latch.wait();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void QuotientMultiSetParallelBuilder::build(
+    std::vector<uint64_t> keys, IOBufQueue& buff) {
+  const size_t numKeys = keys.size();
+  const auto params = QuotientMultiSetBuilder::computeParameters(
+      keyBits_, numKeys, loadFactor_);
+  const uint64_t divisor = params.divisor;
+  const auto fraction = qms_detail::getInverse(divisor);
+  const size_t remainderBits = params.remainderBits;
+  const size_t blockSize = Block::blockSize(remainderBits);
+  auto quotientAndRemainder = [&](uint64_t key) {
+    return qms_detail::getQuotientAndRemainder(key, divisor, fraction);
+  };
+
+  // Quotient blocks are split evenly across segments. A segment boundary is
+  // always a block boundary, so no run is shared by two segments.
+  const uint64_t numQuotientBlocks =
+      quotientAndRemainder(params.maxKey).first / kBlockSize + 1;
+  const size_t numSegments =
+      std::max<size_t>(std::min<uint64_t>(numSegments_, numQuotientBlocks), 1);
+  auto segmentOf = [&](uint64_t key) {
+    const uint64_t blockIndex = quotientAndRemainder(key).first / kBlockSize;
+    return static_cast<size_t>(
+        qms_detail::UInt64InverseType(blockIndex) * numSegments /
+        numQuotientBlocks);
+  };
+
+  // Partition the keys by segment: histogram and scatter each chunk of the
+  // input in parallel, then sort each segment in parallel.
+  const size_t numChunks = numSegments;
+  const size_t chunkSize = divCeil(numKeys, numChunks);
+  auto chunkBegin = [&](size_t chunk) {
+    return std::min(chunk * chunkSize, numKeys);
+  };
+  std::vector<size_t> counts(numChunks * numSegments, 0);
+  parallelFor(numChunks, [&](size_t chunk) {
+    auto* chunkCounts = &counts[chunk * numSegments];
+    for (size_t i = chunkBegin(chunk); i < chunkBegin(chunk + 1); ++i) {
+      FOLLY_SAFE_CHECK(keys[i] <= params.maxKey, "Invalid key");
+      ++chunkCounts[segmentOf(keys[i])];
+    }
+  });
+  std::vector<size_t> segmentBegin(numSegments + 1, 0);
+  {
+    size_t offset = 0;
+    for (size_t seg = 0; seg < numSegments; ++seg) {
+      segmentBegin[seg] = offset;
+      for (size_t chunk = 0; chunk < numChunks; ++chunk) {
+        auto& count = counts[chunk * numSegments + seg];
+        const size_t chunkCount = count;
+        count = offset;
+        offset += chunkCount;
+      }
+    }
+    segmentBegin[numSegments] = offset;
+  }
+  std::vector<uint64_t> sorted(numKeys);
+  parallelFor(numChunks, [&](size_t chunk) {
+    auto* chunkOffsets = &counts[chunk * numSegments];
+    for (size_t i = chunkBegin(chunk); i < chunkBegin(chunk + 1); ++i) {
+      sorted[chunkOffsets[segmentOf(keys[i])]++] = keys[i];
+    }
+  });
+  keys = {};
+  parallelFor(numSegments, [&](size_t seg) {
+    std::sort(
+        sorted.begin() + segmentBegin[seg],
+        sorted.begin() + segmentBegin[seg + 1]);
+  });
+
+  // A run starts at max(nextSlot, quotient block start), so the slot after
+  // a segment is max(startSlot + numKeys, localEnd), where localEnd is the
+  // slot after the segment when encoded from slot 0. Compute localEnd in
+  // parallel, then resolve the start slots sequentially.
+  std::vector<size_t> segmentEnd(numSegments, 0);
+  parallelFor(numSegments, [&](size_t seg) {
+    size_t nextSlot = 0;
+    uint64_t prevQuotient = 0;
+    for (size_t i = segmentBegin[seg]; i < segmentBegin[seg + 1]; ++i) {
+      const uint64_t quotient = quotientAndRemainder(sorted[i]).first;
+      if (i == segmentBegin[seg] || quotient != prevQuotient) {
+        nextSlot = std::max<size_t>(
+            nextSlot, quotient / kBlockSize * kBlockSize);
+        prevQuotient = quotient;
+      }
+      ++nextSlot;
+    }
+    segmentEnd[seg] = nextSlot;
+  });
+  std::vector<size_t> segmentStart(numSegments, 0);
+  size_t numSlots = 0;
+  for (size_t seg = 0; seg < numSegments; ++seg) {
+    segmentStart[seg] = numSlots;
+    const size_t segmentKeys = segmentBegin[seg + 1] - segmentBegin[seg];
+    if (segmentKeys != 0) {
+      numSlots = std::max(numSlots + segmentKeys, segmentEnd[seg]);
+    }
+  }
+
+  // Encode each segment into its own blocks.
+  std::vector<Segment> segments(numSegments);
+  parallelFor(numSegments, [&](size_t seg) {
+    const size_t begin = segmentBegin[seg];
+    const size_t end = segmentBegin[seg + 1];
+    if (begin == end) {
+      return;
+    }
+    auto& segment = segments[seg];
+    segment.firstBlock =
+        quotientAndRemainder(sorted[begin]).first / kBlockSize;
+    const size_t lastSlot =
+        std::max(segmentStart[seg] + (end - begin), segmentEnd[seg]) - 1;
+    const size_t numBlocks = lastSlot / kBlockSize - segment.firstBlock + 1;
+    segment.blocks.reserve(numBlocks);
+    for (size_t i = 0; i < numBlocks; ++i) {
+      segment.blocks.push_back(Block::make(remainderBits));
+    }
+    segment.numKeys.resize(numBlocks, 0);
+    auto blockAt = [&](size_t blockIndex) {
+      return segment.blocks[blockIndex - segment.firstBlock].get();
+    };
+
+    size_t nextSlot = segmentStart[seg];
+    uint64_t prevQuotient = 0;
+    auto closeRun = [&] {
+      const size_t runEnd = nextSlot - 1;
+      blockAt(runEnd / kBlockSize)->setRunend(runEnd % kBlockSize);
+      // Set the offset if this run is the first one in its occupied block.
+      auto occupiedBlock = blockAt(prevQuotient / kBlockSize);
+      if (isPowTwo(occupiedBlock->occupieds)) {
+        occupiedBlock->offset = runEnd;
+      }
+    };
+    for (size_t i = begin; i < end; ++i) {
+      const auto qr = quotientAndRemainder(sorted[i]);
+      const auto& quotient = qr.first;
+      const auto& remainder = qr.second;
+      if (i == begin || quotient != prevQuotient) {
+        if (i != begin) {
+          closeRun();
+        }
+        nextSlot = std::max<size_t>(
+            nextSlot, quotient / kBlockSize * kBlockSize);
+        prevQuotient = quotient;
+      }
+      blockAt(nextSlot / kBlockSize)
+          ->setRemainder(nextSlot % kBlockSize, remainderBits, remainder);
+      ++segment.numKeys[nextSlot / kBlockSize - segment.firstBlock];
+      blockAt(quotient / kBlockSize)->setOccupied(quotient % kBlockSize);
+      ++nextSlot;
+    }
+    closeRun();
+  });
+  sorted = {};
+
+  // Stitch the segments. A block written by two segments holds disjoint
+  // bits from each, so the copies are merged with a bitwise or.
+  const size_t numBlocks = divCeil(numSlots, kBlockSize);
+  std::vector<BlockPtr> blocks;
+  blocks.reserve(numBlocks);
+  for (size_t i = 0; i < numBlocks; ++i) {
+    blocks.emplace_back(nullptr, free);
+  }
+  std::vector<size_t> blockKeys(numBlocks, 0);
+  for (auto& segment : segments) {
+    for (size_t i = 0; i < segment.blocks.size(); ++i) {
+      const size_t blockIndex = segment.firstBlock + i;
+      blockKeys[blockIndex] += segment.numKeys[i];
+      auto& block = blocks[blockIndex];
+      if (!block) {
+        block = std::move(segment.blocks[i]);
+        continue;
+      }
+      auto dst = reinterpret_cast<char*>(block.get());
+      auto src = reinterpret_cast<const char*>(segment.blocks[i].get());
+      for (size_t b = 0; b < blockSize; ++b) {
+        dst[b] |= src[b];
+      }
+    }
+    segment.blocks.clear();
+  }
+
+  size_t keysBefore = 0;
+  for (size_t i = 0; i < numBlocks; ++i) {
+    if (!blocks[i]) {
+      blocks[i] = Block::make(remainderBits);
+    }
+    blocks[i]->payload = keysBefore;
+    keysBefore += blockKeys[i];
+    buff.append(IOBuf::takeOwnership(blocks[i].release(), blockSize));
+  }
+  DCHECK_EQ(keysBefore, numKeys);
+  QuotientMultiSetBuilder::appendMetadata(
+      buff, numBlocks, numKeys, divisor, keyBits_, remainderBits);
 }
 
 } // namespace folly
@@ -17,7 +17,9 @@
 #pragma once
 
 #include <deque>
+#include <limits>
 #include <utility>
+#include <vector>
 
 #include <folly/Portability.h>
 #include <folly/Range.h>
@@ -32,6 +34,8 @@
 
 namespace folly {
 
+class Executor;
+
 namespace qms_detail {
 
 using UInt64InverseType = __uint128_t;
@@ -137,6 +141,7 @@ class QuotientMultiSet final {
   uint64_t getBlockPayload(uint64_t blockIndex) const;
 
   friend class QuotientMultiSetBuilder;
+  friend class QuotientMultiSetParallelBuilder;
 
  private:
   // Metadata to describe a quotient table.
@@ -183,6 +188,20 @@ class QuotientMultiSet<Instructions>::Iterator {
   // Skip forward to the first key >= the given key.
   bool skipTo(uint64_t key);
 
+  // Copy up to n keys that are < end, starting with the current one, into
+  // keys (and their positions into positions, if not null), advancing past
+  // them. Returns the number of keys copied; fewer than n means that the
+  // iterator is done or positioned at a key >= end. The iterator must be
+  // positioned by next() or skipTo(). A range query for [lo, hi) is:
+  //   if (iter.skipTo(lo)) {
+  //     while ((n = iter.nextBatch(buf, kBatch, hi)) > 0) { ... }
+  //   }
+  size_t nextBatch(
+      uint64_t* keys,
+      size_t n,
+      uint64_t end = std::numeric_limits<uint64_t>::max(),
+      size_t* positions = nullptr);
+
   bool done() const { return pos_ == qms_->numSlots_; }
 
   // Return current key.
@@ -274,8 +293,29 @@ class QuotientMultiSetBuilder final {
   size_t numReadyBlocks() { return readyBlocks_; }
 
  private:
+  friend class QuotientMultiSetParallelBuilder;
+
   using BlockPtr = QuotientMultiSet<>::BlockPtr;
 
+  struct Parameters {
+    uint64_t maxKey;
+    uint64_t divisor;
+    uint64_t remainderBits;
+  };
+
+  // Derive the table geometry shared by both builders.
+  static Parameters computeParameters(
+      size_t keyBits, size_t expectedElements, double loadFactor);
+
+  // Append the metadata trailer that terminates the serialized set.
+  static void appendMetadata(
+      IOBufQueue& buff,
+      size_t numBlocks,
+      size_t numKeys,
+      uint64_t divisor,
+      size_t keyBits,
+      uint64_t remainderBits);
+
   struct BlockWithState {
     BlockWithState(BlockPtr ptr, size_t idx)
         : block(std::move(ptr)), index(idx), ready(false) {}
@@ -334,6 +374,60 @@ class QuotientMultiSetBuilder final {
   IOBufQueue buff_;
 };
 
+/**
+ * Class to build a QuotientMultiSet from keys in arbitrary order, sorting
+ * and encoding disjoint quotient ranges concurrently on an executor.
+ *
+ * Keys are partitioned by quotient block into segments, which are sorted and
+ * encoded independently. Since a run can spill past the end of its segment,
+ * the start slot of each segment is resolved by a sequential pass over
+ * per-segment summaries, and the few blocks written by two adjacent segments
+ * are merged when stitching the output.
+ *
+ * The result is identical to what QuotientMultiSetBuilder produces from the
+ * sorted keys, except for the block payloads: each payload is set to the
+ * number of keys stored in the preceding blocks, so the rank of the key at
+ * position pos is getBlockPayload(pos / kBlockSize) + pos % kBlockSize.
+ *
+ * Peak memory is about twice the size of the keys, plus the output.
+ *
+ * Example usage:
+ *   QuotientMultiSetParallelBuilder builder(keyBits, &executor);
+ *   builder.build(std::move(keys), buff);
+ */
+class QuotientMultiSetParallelBuilder final {
+ public:
+  // If executor is null all the work runs on the calling thread. If
+  // numSegments is 0 it is derived from the hardware concurrency.
+  QuotientMultiSetParallelBuilder(
+      size_t keyBits,
+      Executor* executor,
+      double loadFactor = QuotientMultiSetBuilder::kDefaultMaxLoadFactor,
+      size_t numSegments = 0);
+
+  constexpr static size_t kBlockSize = QuotientMultiSet<>::kBlockSize;
+
+  // Build a set containing all the given keys, in any order, and append it
+  // to buff. The set is sized for keys.size() elements.
+  void build(std::vector<uint64_t> keys, IOBufQueue& buff);
+
+ private:
+  using Block = QuotientMultiSet<>::Block;
+  using BlockPtr = QuotientMultiSet<>::BlockPtr;
+
+  // Blocks touched while encoding one segment.
+  struct Segment;
+
+  // Run fn(i) for i in [0, n), on the executor if there is one.
+  template <class F>
+  void parallelFor(size_t n, F&& fn);
+
+  const size_t keyBits_;
+  Executor* const executor_;
+  const double loadFactor_;
+  const size_t numSegments_;
+};
+
 } // namespace folly
 
 #include <folly/experimental/QuotientMultiSet-inl.h>
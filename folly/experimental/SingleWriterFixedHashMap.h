@@ -17,6 +17,8 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
+#include <vector>
 
 #include <folly/lang/Bits.h>
 
@@ -43,8 +45,16 @@ namespace folly {
 ///   map. This is to guarantee that when readers iterate over the map
 ///   they do not encounter any key more than once.
 ///
+/// Batched inserts:
+/// - insertBatch() writes every new element first and then publishes
+///   them all with one release fence and one update of size(). Per
+///   element, readers never see a valid slot with an unwritten key
+///   or value. Readers may observe part of a batch before size()
+///   includes it.
+///
 /// Writer-only operations:
 /// - insert()
+/// - insertBatch()
 /// - erase()
 /// - used()
 /// - available()
@@ -67,7 +77,9 @@ class SingleWriterFixedHashMap {
 
   class Elem;
 
-  enum class State : uint8_t { EMPTY, VALID, TOMBSTONE };
+  // PENDING marks a slot claimed by an unpublished insertBatch(). Readers
+  // treat it like a tombstone.
+  enum class State : uint8_t { EMPTY, VALID, TOMBSTONE, PENDING };
 
   size_t capacity_;
   size_t used_{0};
@@ -161,6 +173,63 @@ class SingleWriterFixedHashMap {
     folly::assume_unreachable();
   }
 
+  /// Inserts the (key, value) pairs in [first, last), skipping keys that are
+  /// already present, and returns the number inserted. There must be enough
+  /// available() slots for every new key.
+  template <typename Iter>
+  size_t insertBatch(Iter first, Iter last) {
+    if (!elem_) {
+      elem_ = std::make_unique<Elem[]>(capacity_);
+    }
+    size_t mask = capacity_ - 1;
+    std::vector<size_t> pending;
+    for (; first != last; ++first) {
+      const auto& [key, value] = *first;
+      if (writer_find(key) < capacity_) {
+        continue;
+      }
+      size_t index = hash(key);
+      auto attempts = capacity_;
+      bool claimed = false;
+      while (attempts--) {
+        Elem& e = elem_[index];
+        auto state = e.state();
+        if (state == State::PENDING && e.key() == key) {
+          // duplicate within this batch
+          claimed = true;
+          break;
+        }
+        if (state == State::EMPTY ||
+            (state == State::TOMBSTONE && e.key() == key)) {
+          if (state == State::EMPTY) {
+            e.setKey(key);
+            ++used_;
+            DCHECK_LE(used_, capacity_);
+          }
+          e.setValue(value);
+          e.setPending();
+          pending.push_back(index);
+          claimed = true;
+          break;
+        }
+        index = (index + 1) & mask;
+      }
+      CHECK(claimed) << "No available slots";
+    }
+    if (pending.empty()) {
+      return 0;
+    }
+    // One fence orders every key and value write above before the relaxed
+    // state stores below.
+    std::atomic_thread_fence(std::memory_order_release);
+    for (auto index : pending) {
+      elem_[index].setValidRelaxed();
+    }
+    setSize(size() + pending.size());
+    DCHECK_LE(size(), used_);
+    return pending.size();
+  }
+
   void erase(Iterator& it) {
     DCHECK_NE(it, end());
     Elem& e = elem_[it.index_];
@@ -257,6 +326,14 @@ class SingleWriterFixedHashMap {
 
     void setValid() { state_.store(State::VALID, std::memory_order_release); }
 
+    void setValidRelaxed() {
+      state_.store(State::VALID, std::memory_order_relaxed);
+    }
+
+    void setPending() {
+      state_.store(State::PENDING, std::memory_order_relaxed);
+    }
+
     void erase() { state_.store(State::TOMBSTONE, std::memory_order_release); }
   }; // Elem
 
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <utility>
+
+#include <folly/Optional.h>
+#include <folly/experimental/SingleWriterFixedHashMap.h>
+#include <folly/lang/Bits.h>
+#include <folly/synchronization/Hazptr.h>
+
+namespace folly {
+
+/// SingleWriterGrowableHashMap:
+///
+/// Single-writer, multi-reader hash map that grows on demand, built on
+/// SingleWriterFixedHashMap.
+///
+/// The current table is published through an atomic pointer protected by
+/// hazard pointers. When an insert would push the table past its maximum
+/// load factor (tombstones included), the writer builds the next
+/// generation table privately, copying only valid elements, and then
+/// swaps it in with a single release store. The old table is retired to
+/// the hazptr library. Readers are never blocked by the writer. Protecting
+/// the table pointer retries only while a swap is in flight, and lookups
+/// then proceed exactly as in SingleWriterFixedHashMap.
+///
+/// insertBatch() reserves room for the whole batch up front (at most one
+/// table swap) and publishes the batch with one release fence and one size
+/// update, see SingleWriterFixedHashMap::insertBatch().
+///
+/// Writer-only operations:
+/// - insert()
+/// - insertBatch()
+/// - erase()
+/// - reserve()
+/// - capacity()
+///
+/// Reader operations (also safe for the writer):
+/// - size()
+/// - contains()
+/// - find()
+/// - forEach()
+///
+template <typename Key, typename Value>
+class SingleWriterGrowableHashMap {
+  using Map = SingleWriterFixedHashMap<Key, Value>;
+
+  struct Table : hazptr_obj_base<Table> {
+    Map map;
+    explicit Table(size_t capacity) : map(capacity) {}
+  };
+
+  // Maximum fraction of used slots (valid or tombstone), in quarters.
+  static constexpr size_t kMaxLoadQuarters = 3;
+
+  size_t minCapacity_;
+  std::atomic<Table*> table_;
+
+ public:
+  explicit SingleWriterGrowableHashMap(size_t initialCapacity = 8)
+      : minCapacity_(folly::nextPowTwo(std::max<size_t>(initialCapacity, 2))),
+        table_(new Table(minCapacity_)) {}
+
+  SingleWriterGrowableHashMap(const SingleWriterGrowableHashMap&) = delete;
+  SingleWriterGrowableHashMap& operator=(const SingleWriterGrowableHashMap&) =
+      delete;
+
+  /* Readers must have finished before destruction. */
+  ~SingleWriterGrowableHashMap() {
+    delete table_.load(std::memory_order_relaxed);
+  }
+
+  /* data-race-free, can be called by readers */
+  size_t size() const {
+    hazptr_local<1> h;
+    return h[0].protect(table_)->map.size();
+  }
+
+  bool empty() const { return size() == 0; }
+
+  bool contains(Key key) const {
+    hazptr_local<1> h;
+    return h[0].protect(table_)->map.contains(key);
+  }
+
+  Optional<Value> find(Key key) const {
+    hazptr_local<1> h;
+    const Map& map = h[0].protect(table_)->map;
+    auto it = map.find(key);
+    if (it == map.end()) {
+      return none;
+    }
+    return it.value();
+  }
+
+  /// Calls f(key, value) for each element of one generation of the table.
+  /// f may itself use hazard pointers.
+  template <typename F>
+  void forEach(F&& f) const {
+    // Don't use hazptr_local because f may use hazptr
+    hazptr_holder<> h = make_hazard_pointer<>();
+    const Map& map = h.protect(table_)->map;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+      f(it.key(), it.value());
+    }
+  }
+
+  /* not data-race-free, to be called only by the single writer */
+  size_t capacity() const { return writerMap().capacity(); }
+
+  bool insert(Key key, Value value) {
+    reserve(1);
+    return writerMap().insert(key, value);
+  }
+
+  /// Inserts the (key, value) pairs in [first, last), skipping keys that
+  /// are already present. Returns the number inserted.
+  template <typename Iter>
+  size_t insertBatch(Iter first, Iter last) {
+    static_assert(
+        std::is_base_of<
+            std::forward_iterator_tag,
+            typename std::iterator_traits<Iter>::iterator_category>::value,
+        "insertBatch needs forward iterators to size the batch");
+    reserve(static_cast<size_t>(std::distance(first, last)));
+    return writerMap().insertBatch(first, last);
+  }
+
+  bool erase(Key key) { return writerMap().erase(key); }
+
+  /// Makes room for n new keys without another table swap.
+  void reserve(size_t n) {
+    Map& map = writerMap();
+    if ((map.used() + n) * 4 <= map.capacity() * kMaxLoadQuarters) {
+      return;
+    }
+    grow(map.size() + n);
+  }
+
+ private:
+  Map& writerMap() const {
+    return table_.load(std::memory_order_relaxed)->map;
+  }
+
+  void grow(size_t elements) {
+    // Size the next generation so that it is at most half full, which
+    // leaves room for as many inserts again before the next swap.
+    auto capacity = std::max(minCapacity_, folly::nextPowTwo(elements * 2));
+    auto* next = new Table(capacity);
+    Map& map = writerMap();
+    for (auto it = map.begin(); it != map.end(); ++it) {
+      next->map.insert(it.key(), it.value());
+    }
+    auto* prev = table_.exchange(next, std::memory_order_acq_rel);
+    prev->retire();
+  }
+};
+
+} // namespace folly
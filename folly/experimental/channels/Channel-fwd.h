@@ -19,6 +19,7 @@
 #include <folly/experimental/channels/detail/ChannelBridge.h>
 
 #include <optional>
+#include <vector>
 
 namespace folly {
 namespace channels {
@@ -43,6 +44,10 @@ detail::IChannelCallback* cancelReceiverWait(Receiver<TValue>& receiver);
 template <typename TValue>
 std::optional<Try<TValue>> receiverGetValue(Receiver<TValue>& receiver);
 
+template <typename TValue>
+void receiverGetBufferedValues(
+    Receiver<TValue>& receiver, std::vector<TValue>& values, size_t maxValues);
+
 template <typename TValue>
 std::pair<detail::ChannelBridgePtr<TValue>, detail::ReceiverQueue<TValue>>
 receiverUnbuffer(Receiver<TValue>&& receiver);
@@ -57,6 +57,25 @@ std::optional<Try<TValue>> receiverGetValue(Receiver<TValue>& receiver) {
   return result;
 }
 
+template <typename TValue>
+void receiverGetBufferedValues(
+    Receiver<TValue>& receiver, std::vector<TValue>& values, size_t maxValues) {
+  while (values.size() < maxValues) {
+    if (receiver.buffer_.empty()) {
+      receiver.buffer_ = receiver.bridge_->receiverGetValues();
+      if (receiver.buffer_.empty()) {
+        return;
+      }
+    }
+    if (!receiver.buffer_.front().hasValue()) {
+      // Leave the close for the next call, after these values are consumed.
+      return;
+    }
+    values.push_back(std::move(receiver.buffer_.front().value()));
+    receiver.buffer_.pop();
+  }
+}
+
 template <typename TValue>
 std::pair<detail::ChannelBridgePtr<TValue>, detail::ReceiverQueue<TValue>>
 receiverUnbuffer(Receiver<TValue>&& receiver) {
@@ -173,6 +192,43 @@ class Receiver<TValue>::Waiter : public detail::IChannelCallback {
   std::unique_ptr<folly::CancellationCallback> cancelCallback_;
 };
 
+template <typename TValue>
+class Receiver<TValue>::BatchWaiter : public Receiver<TValue>::Waiter {
+ public:
+  BatchWaiter(
+      Receiver<TValue>* receiver,
+      size_t maxValues,
+      folly::CancellationToken cancelToken,
+      bool closeOnCancel)
+      : Waiter(receiver, std::move(cancelToken), closeOnCancel),
+        maxValues_(maxValues) {}
+
+  std::vector<TValue> await_resume() {
+    return await_resume_try().value();
+  }
+
+  Try<std::vector<TValue>> await_resume_try() {
+    auto result = this->getResult();
+    if (result.hasException()) {
+      return Try<std::vector<TValue>>(std::move(result.exception()));
+    }
+    std::vector<TValue> values;
+    if (!result.hasValue()) {
+      return Try<std::vector<TValue>>(std::move(values));
+    }
+    values.push_back(std::move(result.value()));
+    this->state_.withWLock([&](typename Waiter::State& state) {
+      if (state.receiver) {
+        detail::receiverGetBufferedValues(*state.receiver, values, maxValues_);
+      }
+    });
+    return Try<std::vector<TValue>>(std::move(values));
+  }
+
+ private:
+  size_t maxValues_;
+};
+
 template <typename TValue>
 struct Receiver<TValue>::NextSemiAwaitable {
  public:
@@ -205,5 +261,46 @@ struct Receiver<TValue>::NextSemiAwaitable {
   bool closeOnCancel_;
   std::optional<folly::CancellationToken> cancelToken_;
 };
+
+template <typename TValue>
+struct Receiver<TValue>::NextBatchSemiAwaitable {
+ public:
+  NextBatchSemiAwaitable(
+      Receiver<TValue>* receiver,
+      size_t maxValues,
+      bool closeOnCancel,
+      std::optional<folly::CancellationToken> cancelToken = std::nullopt)
+      : receiver_(receiver),
+        maxValues_(maxValues),
+        closeOnCancel_(closeOnCancel),
+        cancelToken_(std::move(cancelToken)) {}
+
+  [[nodiscard]] BatchWaiter operator co_await() {
+    return BatchWaiter(
+        receiver_,
+        maxValues_,
+        cancelToken_.value_or(folly::CancellationToken()),
+        closeOnCancel_);
+  }
+
+  friend NextBatchSemiAwaitable co_withCancellation(
+      folly::CancellationToken cancelToken,
+      NextBatchSemiAwaitable&& awaitable) {
+    if (awaitable.cancelToken_.has_value()) {
+      return std::move(awaitable);
+    }
+    return NextBatchSemiAwaitable(
+        awaitable.receiver_,
+        awaitable.maxValues_,
+        awaitable.closeOnCancel_,
+        std::move(cancelToken));
+  }
+
+ private:
+  Receiver<TValue>* receiver_;
+  size_t maxValues_;
+  bool closeOnCancel_;
+  std::optional<folly::CancellationToken> cancelToken_;
+};
 } // namespace channels
 } // namespace folly
@@ -175,7 +175,9 @@ class Sender {
 template <typename TValue>
 class Receiver {
   class Waiter;
+  class BatchWaiter;
   struct NextSemiAwaitable;
+  struct NextBatchSemiAwaitable;
 
  public:
   friend Channel<TValue>;
@@ -253,6 +255,27 @@ class Receiver {
     return NextSemiAwaitable(*this ? this : nullptr, closeOnCancel);
   }
 
+  /**
+   * Returns up to maxValues values sent by a sender, resuming the caller once
+   * for the whole batch. This waits only until at least one value is
+   * available; it then returns that value together with any others that were
+   * already sent, without waiting for more.
+   *
+   * The end of the channel is reported as with next(), but with an empty
+   * vector in place of an empty optional or Try. Values sent before the
+   * channel was closed are always returned by an earlier call, so a close or
+   * exception is only seen once every value before it has been received.
+   *
+   * closeOnCancel has the same meaning as for next(). maxValues must be
+   * positive.
+   */
+  NextBatchSemiAwaitable nextBatch(
+      size_t maxValues, bool closeOnCancel = true) {
+    DCHECK_GT(maxValues, 0);
+    return NextBatchSemiAwaitable(
+        *this ? this : nullptr, maxValues, closeOnCancel);
+  }
+
   /**
    * Cancels this receiver. If the receiver is currently being consumed, the
    * consumer will receive a folly::OperationCancelled exception.
@@ -276,6 +299,9 @@ class Receiver {
   friend std::optional<Try<TValue>> detail::receiverGetValue<>(
       Receiver<TValue>&);
 
+  friend void detail::receiverGetBufferedValues<>(
+      Receiver<TValue>&, std::vector<TValue>&, size_t);
+
   friend std::
       pair<detail::ChannelBridgePtr<TValue>, detail::ReceiverQueue<TValue>>
       detail::receiverUnbuffer<>(Receiver<TValue>&& receiver);
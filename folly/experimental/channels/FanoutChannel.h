@@ -80,6 +80,11 @@ struct NoContext {
  *   auto receiver2 = fanoutChannel.subscribe(
  *       [](const Context& context) { return {context.latestValue}; });
  *   std::move(fanoutChannel).close();
+ *
+ * Each output receiver gets its own copy of every value. For large values and
+ * many subscribers, use a ValueType of std::shared_ptr<const T> so that all
+ * subscribers share one immutable value and a write costs a refcount increment
+ * per subscriber.
  */
 template <typename ValueType, typename ContextType = NoContext<ValueType>>
 class FanoutChannel {
@@ -46,13 +46,19 @@ class FanoutSenderProcessor : public IChannelCallback {
   }
 
   /**
-   * Sends the given value to all corresponding receivers.
+   * Sends the given value to all corresponding receivers. Every receiver but
+   * the last gets a copy; the last one gets the value itself.
    */
   template <typename U = ValueType>
   void write(U&& element) {
     auto state = state_.wlock();
+    auto remaining = state->senders_.size();
     for (auto* sender : state->senders_) {
-      sender->senderPush(element);
+      if (--remaining == 0) {
+        sender->senderPush(std::forward<U>(element));
+      } else {
+        sender->senderPush(element);
+      }
     }
   }
 
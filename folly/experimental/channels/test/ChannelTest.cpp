@@ -253,6 +253,39 @@ TEST(Channel, CancelNextWithoutClose) {
   EXPECT_EQ(folly::coro::blockingWait(receiver.next()).value(), 2);
 }
 
+TEST(Channel, NextBatch) {
+  auto [receiver, sender] = Channel<int>::create();
+
+  sender.write(1);
+  sender.write(2);
+  sender.write(3);
+  EXPECT_EQ(
+      folly::coro::blockingWait(receiver.nextBatch(2)),
+      std::vector<int>({1, 2}));
+  EXPECT_EQ(
+      folly::coro::blockingWait(receiver.nextBatch(2)), std::vector<int>({3}));
+
+  sender.write(4);
+  std::move(sender).close();
+  EXPECT_EQ(
+      folly::coro::blockingWait(receiver.nextBatch(10)),
+      std::vector<int>({4}));
+  EXPECT_TRUE(folly::coro::blockingWait(receiver.nextBatch(10)).empty());
+  EXPECT_FALSE(receiver);
+}
+
+TEST(Channel, NextBatchException) {
+  auto [receiver, sender] = Channel<int>::create();
+
+  sender.write(1);
+  std::move(sender).close(std::runtime_error("Error"));
+  EXPECT_EQ(
+      folly::coro::blockingWait(receiver.nextBatch(10)),
+      std::vector<int>({1}));
+  EXPECT_THROW(
+      folly::coro::blockingWait(receiver.nextBatch(10)), std::runtime_error);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     Channel_Coro_WithTry,
     ChannelFixture,
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/experimental/coro/AdaptiveConcurrencyLimit.h>
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+namespace folly {
+namespace coro {
+
+AdaptiveConcurrencyLimit::AdaptiveConcurrencyLimit(const Options& options)
+    : options_(options), limit_(double(options.initialLimit)) {
+  CHECK_GE(options_.minLimit, 1);
+  CHECK_LE(options_.minLimit, options_.initialLimit);
+  CHECK_LE(options_.initialLimit, options_.maxLimit);
+  CHECK(options_.decreaseFactor > 0 && options_.decreaseFactor < 1);
+}
+
+std::size_t AdaptiveConcurrencyLimit::limit() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::size_t(limit_);
+}
+
+void AdaptiveConcurrencyLimit::onSuccess(std::chrono::nanoseconds latency) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (options_.latencyTarget.count() > 0 &&
+      latency > options_.latencyTarget) {
+    decrease();
+    return;
+  }
+  if (holdOff_ > 0) {
+    --holdOff_;
+  }
+  limit_ = std::min(limit_ + 1 / limit_, double(options_.maxLimit));
+}
+
+void AdaptiveConcurrencyLimit::onError() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  decrease();
+}
+
+void AdaptiveConcurrencyLimit::decrease() {
+  if (holdOff_ > 0) {
+    --holdOff_;
+    return;
+  }
+  holdOff_ = std::size_t(limit_);
+  limit_ = std::max(
+      limit_ * options_.decreaseFactor, double(options_.minLimit));
+}
+
+} // namespace coro
+} // namespace folly
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace folly {
+namespace coro {
+
+/**
+ * A concurrency limit that adapts to the outcome of the operations run
+ * under it, by additive increase and multiplicative decrease (AIMD).
+ *
+ * Each success raises the limit by 1 / limit, that is by one for every
+ * limit's worth of successes. An error, or a success slower than the
+ * latency target if one is set, multiplies the limit by decreaseFactor.
+ * Once decreased, the limit is not decreased again before another limit's
+ * worth of operations have completed, since those were started under the
+ * old limit.
+ *
+ * Thread-safe; a limit may be shared by several collectAllTryWindowed()
+ * calls to the same downstream.
+ */
+class AdaptiveConcurrencyLimit {
+ public:
+  struct Options {
+    Options()
+        : initialLimit(4),
+          minLimit(1),
+          maxLimit(256),
+          latencyTarget(0),
+          decreaseFactor(0.5) {}
+    std::size_t initialLimit;
+    std::size_t minLimit;
+    std::size_t maxLimit;
+    /// Successes slower than this count as congestion; 0 for none
+    std::chrono::nanoseconds latencyTarget;
+    /// In (0, 1)
+    double decreaseFactor;
+  };
+
+  explicit AdaptiveConcurrencyLimit(const Options& options = Options());
+
+  std::size_t limit() const;
+
+  void onSuccess(std::chrono::nanoseconds latency);
+  void onError();
+
+ private:
+  void decrease();
+
+  const Options options_;
+  mutable std::mutex mutex_;
+  double limit_;
+  // Completions to go before the limit may decrease again.
+  std::size_t holdOff_{0};
+};
+
+} // namespace coro
+} // namespace folly
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <folly/MPMCQueue.h>
 #include <folly/ProducerConsumerQueue.h>
 #include <folly/experimental/coro/Task.h>
@@ -62,6 +64,27 @@ class BoundedQueue {
     return true;
   }
 
+  // Enqueues the items of [first, last) in order, waiting for space as
+  // needed. Each wait is followed by as many items as there is space for
+  // then, so a consumer woken by the first of them can take the others
+  // without suspending again. If cancelled, a prefix of the items may have
+  // been enqueued.
+  template <typename InputIt>
+  folly::coro::Task<void> enqueue_batch(InputIt first, InputIt last) {
+    while (first != last) {
+      co_await folly::coro::co_nothrow(enqueueSemaphore_.co_wait());
+      size_t count = 0;
+      do {
+        enqueueReady(*first);
+        ++first;
+        ++count;
+      } while (first != last && enqueueSemaphore_.try_wait());
+      for (; count > 0; --count) {
+        dequeueSemaphore_.signal();
+      }
+    }
+  }
+
   folly::coro::Task<T> dequeue() {
     co_await folly::coro::co_nothrow(dequeueSemaphore_.co_wait());
     T item;
@@ -76,6 +99,23 @@ class BoundedQueue {
     enqueueSemaphore_.signal();
   }
 
+  // Waits for an item, then dequeues it along with those available without
+  // waiting, up to maxItems in all: one resumption for the whole batch.
+  folly::coro::Task<std::vector<T>> dequeue_batch(size_t maxItems) {
+    DCHECK_GT(maxItems, 0);
+    co_await folly::coro::co_nothrow(dequeueSemaphore_.co_wait());
+    size_t count = 1;
+    while (count < maxItems && dequeueSemaphore_.try_wait()) {
+      ++count;
+    }
+    std::vector<T> items(count);
+    for (auto& item : items) {
+      dequeueReady(item);
+      enqueueSemaphore_.signal();
+    }
+    co_return items;
+  }
+
   std::optional<T> try_dequeue() {
     T item;
     if (try_dequeue(item)) {
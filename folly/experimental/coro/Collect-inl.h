@@ -15,12 +15,15 @@
  */
 
 #include <atomic>
+#include <chrono>
+#include <deque>
 #include <utility>
 
 #include <folly/CancellationToken.h>
 #include <folly/ExceptionWrapper.h>
 #include <folly/experimental/coro/AsyncPipe.h>
 #include <folly/experimental/coro/AsyncScope.h>
+#include <folly/experimental/coro/Baton.h>
 #include <folly/experimental/coro/Mutex.h>
 #include <folly/experimental/coro/detail/Barrier.h>
 #include <folly/experimental/coro/detail/BarrierTask.h>
@@ -44,6 +47,17 @@ inline Unit getValueOrUnit([[maybe_unused]] Try<void>&& value) {
   return Unit{};
 }
 
+// Restores the context saved before starting the tasks of a collect
+// operation. Most tasks leave the context alone, and checking first saves
+// the two reference count updates setContext() would make for nothing,
+// once per task.
+inline void restoreRequestContext(
+    const std::shared_ptr<RequestContext>& context) {
+  if (RequestContext::try_get() != context.get()) {
+    RequestContext::setContext(context);
+  }
+}
+
 template <
     typename InputRange,
     typename Make,
@@ -131,7 +145,7 @@ auto collectAllTryImpl(
     const auto context = RequestContext::saveContext();
     (void)std::initializer_list<int>{
         (tasks[Indices].start(&barrier, asyncFrame),
-         RequestContext::setContext(context),
+         detail::restoreRequestContext(context),
          0)...};
 
     // Wait for all of the sub-tasks to finish execution.
@@ -208,7 +222,7 @@ auto collectAllImpl(
     // in the order they appear in the parameter pack.
     (void)std::initializer_list<int>{
         (tasks[Indices].start(&barrier, asyncFrame),
-         RequestContext::setContext(context),
+         detail::restoreRequestContext(context),
          0)...};
 
     // Wait for all of the sub-tasks to finish execution.
@@ -266,7 +280,7 @@ auto makeUnorderedAsyncGeneratorImpl(
         scopeParam.add(std::move(task).scheduleOn(ex), cancelSource.getToken());
       }
       ++expected;
-      RequestContext::setContext(context);
+      detail::restoreRequestContext(context);
     }
 
     while (expected > 0) {
@@ -418,6 +432,16 @@ auto collectAllRange(InputRange awaitables)
   const CancellationToken cancelToken = CancellationToken::merge(
       co_await co_current_cancellation_token, cancelSource.getToken());
 
+  using result_type = detail::collect_all_range_component_t<
+      detail::range_reference_t<InputRange>>;
+  // Results that can be default-constructed are written straight into the
+  // vector returned; others are collected into tryResults first, and moved
+  // into it once all the tasks are done.
+  constexpr bool kDirectResults =
+      std::is_nothrow_default_constructible_v<result_type> &&
+      std::is_nothrow_move_assignable_v<result_type>;
+
+  std::vector<result_type> results;
   std::vector<detail::collect_all_try_range_component_t<
       detail::range_reference_t<InputRange>>>
       tryResults;
@@ -427,12 +451,18 @@ auto collectAllRange(InputRange awaitables)
   using awaitable_type = remove_cvref_t<detail::range_reference_t<InputRange>>;
   auto makeTask = [&](awaitable_type semiAwaitable,
                       std::size_t index) -> detail::BarrierTask {
-    assert(index < tryResults.size());
-
     try {
-      tryResults[index].emplace(co_await co_viaIfAsync(
-          executor.get_alias(),
-          co_withCancellation(cancelToken, std::move(semiAwaitable))));
+      if constexpr (kDirectResults) {
+        assert(index < results.size());
+        results[index] = co_await co_viaIfAsync(
+            executor.get_alias(),
+            co_withCancellation(cancelToken, std::move(semiAwaitable)));
+      } else {
+        assert(index < tryResults.size());
+        tryResults[index].emplace(co_await co_viaIfAsync(
+            executor.get_alias(),
+            co_withCancellation(cancelToken, std::move(semiAwaitable))));
+      }
     } catch (...) {
       if (!cancelSource.requestCancellation()) {
         firstException = exception_wrapper{std::current_exception()};
@@ -442,7 +472,11 @@ auto collectAllRange(InputRange awaitables)
 
   auto tasks = detail::collectMakeInnerTaskVec(awaitables, makeTask);
 
-  tryResults.resize(tasks.size());
+  if constexpr (kDirectResults) {
+    results.resize(tasks.size());
+  } else {
+    tryResults.resize(tasks.size());
+  }
 
   // Save the initial context and restore it after starting each task
   // as the task may have modified the context before suspending and we
@@ -457,7 +491,7 @@ auto collectAllRange(InputRange awaitables)
     detail::Barrier barrier{tasks.size() + 1};
     for (auto&& task : tasks) {
       task.start(&barrier, asyncFrame);
-      RequestContext::setContext(context);
+      detail::restoreRequestContext(context);
     }
     co_await detail::UnsafeResumeInlineSemiAwaitable{barrier.arriveAndWait()};
   }
@@ -467,12 +501,11 @@ auto collectAllRange(InputRange awaitables)
     co_yield co_error(std::move(firstException));
   }
 
-  std::vector<detail::collect_all_range_component_t<
-      detail::range_reference_t<InputRange>>>
-      results;
-  results.reserve(tryResults.size());
-  for (auto& result : tryResults) {
-    results.emplace_back(std::move(result).value());
+  if constexpr (!kDirectResults) {
+    results.reserve(tryResults.size());
+    for (auto& result : tryResults) {
+      results.emplace_back(std::move(result).value());
+    }
   }
 
   co_return results;
@@ -521,7 +554,7 @@ auto collectAllRange(InputRange awaitables) -> folly::coro::Task<void> {
     detail::Barrier barrier{tasks.size() + 1};
     for (auto&& task : tasks) {
       task.start(&barrier, asyncFrame);
-      RequestContext::setContext(context);
+      detail::restoreRequestContext(context);
     }
     co_await detail::UnsafeResumeInlineSemiAwaitable{barrier.arriveAndWait()};
   }
@@ -587,7 +620,7 @@ auto collectAllTryRange(InputRange awaitables)
     detail::Barrier barrier{tasks.size() + 1};
     for (auto&& task : tasks) {
       task.start(&barrier, asyncFrame);
-      RequestContext::setContext(context);
+      detail::restoreRequestContext(context);
     }
     co_await detail::UnsafeResumeInlineSemiAwaitable{barrier.arriveAndWait()};
   }
@@ -690,7 +723,7 @@ auto collectAllWindowed(InputRange awaitables, std::size_t maxConcurrency)
       barrier.add(1);
       workerTasks.back().start(&barrier, asyncFrame);
 
-      RequestContext::setContext(context);
+      detail::restoreRequestContext(context);
 
       lock = co_await mutex.co_scoped_lock();
     }
@@ -825,7 +858,7 @@ auto collectAllWindowed(InputRange awaitables, std::size_t maxConcurrency)
       barrier.add(1);
       workerTasks.back().start(&barrier, asyncFrame);
 
-      RequestContext::setContext(context);
+      detail::restoreRequestContext(context);
 
       lock = co_await mutex.co_scoped_lock();
     }
@@ -959,7 +992,7 @@ auto collectAllTryWindowed(InputRange awaitables, std::size_t maxConcurrency)
       barrier.add(1);
       workerTasks.back().start(&barrier, asyncFrame);
 
-      RequestContext::setContext(context);
+      detail::restoreRequestContext(context);
 
       lock = co_await mutex.co_scoped_lock();
     }
@@ -981,6 +1014,87 @@ auto collectAllTryWindowed(InputRange awaitables, std::size_t maxConcurrency)
   co_return results;
 }
 
+template <typename InputRange>
+auto collectAllTryWindowed(
+    InputRange awaitables, AdaptiveConcurrencyLimit& limit)
+    -> folly::coro::Task<std::vector<detail::collect_all_try_range_component_t<
+        detail::range_reference_t<InputRange>>>> {
+  using result_t = detail::collect_all_try_range_component_t<
+      detail::range_reference_t<InputRange>>;
+  using awaitable_t = remove_cvref_t<detail::range_reference_t<InputRange>>;
+
+  // A deque, so that adding results keeps those of the running awaitables
+  // in place.
+  std::deque<result_t> results;
+  exception_wrapper iterationException;
+
+  const Executor::KeepAlive<> executor = co_await co_current_executor;
+  const CancellationToken& cancelToken = co_await co_current_cancellation_token;
+
+  std::atomic<std::size_t> running{0};
+  // Posted each time an awaitable completes.
+  Baton completed;
+  AsyncScope scope;
+
+  auto run = [&](awaitable_t awaitable, result_t& result) -> Task<void> {
+    const auto start = std::chrono::steady_clock::now();
+    try {
+      if constexpr (std::is_void_v<semi_await_result_t<awaitable_t>>) {
+        co_await co_withCancellation(cancelToken, std::move(awaitable));
+        result.emplace();
+      } else {
+        result.emplace(
+            co_await co_withCancellation(cancelToken, std::move(awaitable)));
+      }
+    } catch (...) {
+      result.emplaceException(std::current_exception());
+    }
+    if (result.hasException()) {
+      limit.onError();
+    } else {
+      limit.onSuccess(std::chrono::steady_clock::now() - start);
+    }
+    running.fetch_sub(1, std::memory_order_acq_rel);
+    completed.post();
+  };
+
+  // Save the initial context and restore it after starting each task
+  // as the task may have modified the context before suspending and we
+  // want to make sure the next task is started with the same initial
+  // context.
+  const auto context = RequestContext::saveContext();
+
+  try {
+    for (auto iter = access::begin(awaitables); iter != access::end(awaitables);
+         ++iter) {
+      while (running.load(std::memory_order_acquire) >= limit.limit()) {
+        completed.reset();
+        // Check again, as the last completion may have come before reset().
+        if (running.load(std::memory_order_acquire) < limit.limit()) {
+          break;
+        }
+        co_await completed;
+      }
+      results.emplace_back();
+      running.fetch_add(1, std::memory_order_relaxed);
+      scope.add(run(*iter, results.back()).scheduleOn(executor));
+      detail::restoreRequestContext(context);
+    }
+  } catch (...) {
+    iterationException = exception_wrapper{std::current_exception()};
+  }
+
+  co_await scope.joinAsync();
+
+  if (iterationException) {
+    co_yield co_error(std::move(iterationException));
+  }
+
+  co_return std::vector<result_t>(
+      std::make_move_iterator(results.begin()),
+      std::make_move_iterator(results.end()));
+}
+
 template <typename InputRange>
 auto makeUnorderedAsyncGenerator(AsyncScope& scope, InputRange awaitables)
     -> AsyncGenerator<detail::async_generator_from_awaitable_range_item_t<
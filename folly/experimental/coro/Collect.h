@@ -20,6 +20,7 @@
 #include <folly/Unit.h>
 #include <folly/container/Access.h>
 #include <folly/container/Iterator.h>
+#include <folly/experimental/coro/AdaptiveConcurrencyLimit.h>
 #include <folly/experimental/coro/AsyncGenerator.h>
 #include <folly/experimental/coro/AsyncScope.h>
 #include <folly/experimental/coro/Coroutine.h>
@@ -402,6 +403,22 @@ auto collectAllTryWindowed(InputRange awaitables, std::size_t maxConcurrency)
     -> folly::coro::Task<std::vector<detail::collect_all_try_range_component_t<
         detail::range_reference_t<InputRange>>>>;
 
+///////////////////////////////////////////////////////////////////////////////
+// collectAllTryWindowed(RangeOf<SemiAwaitable<T>>&,
+//                       AdaptiveConcurrencyLimit& limit)
+//   -> SemiAwaitable<std::vector<folly::Try<T>>>
+//
+// Like collectAllTryWindowed() with a maxConcurrency, except that the
+// concurrency follows limit.limit(), which each result feeds back into:
+// its latency on success, or its exception. Awaitables are started while
+// fewer than limit.limit() are in flight, so a lowered limit takes effect
+// as the ones in flight complete.
+template <typename InputRange>
+auto collectAllTryWindowed(
+    InputRange awaitables, AdaptiveConcurrencyLimit& limit)
+    -> folly::coro::Task<std::vector<detail::collect_all_try_range_component_t<
+        detail::range_reference_t<InputRange>>>>;
+
 // collectAllWindowed()/collectAllTryWindowed() overloads that simplify the
 // use of these functions with std::vector<SemiAwaitable>.
 template <typename SemiAwaitable>
@@ -422,6 +439,14 @@ auto collectAllTryWindowed(
       detail::MoveRange(awaitables), maxConcurrency);
 }
 
+template <typename SemiAwaitable>
+auto collectAllTryWindowed(
+    std::vector<SemiAwaitable> awaitables, AdaptiveConcurrencyLimit& limit)
+    -> decltype(collectAllTryWindowed(detail::MoveRange(awaitables), limit)) {
+  co_return co_await collectAllTryWindowed(
+      detail::MoveRange(awaitables), limit);
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // collectAny(SemiAwaitable<Ts>...) -> SemiAwaitable<
 //   std::pair<std::size_t, folly::Try<std::common_type<Ts...>>>>
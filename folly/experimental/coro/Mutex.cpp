@@ -31,6 +31,49 @@ Mutex::~Mutex() {
 }
 
 void Mutex::unlock() noexcept {
+  if (auto* waiter = unlockOrGetNextWaiter()) {
+    waiter->resumeViaExecutor();
+  }
+}
+
+coroutine_handle<> Mutex::UnlockAwaiter::await_suspend(
+    coroutine_handle<> awaitingCoroutine) noexcept {
+  auto* waiter = mutex_.unlockOrGetNextWaiter();
+  if (waiter == nullptr) {
+    return awaitingCoroutine;
+  }
+  if (waiter->executor_.get() != executor_.get()) {
+    waiter->resumeViaExecutor();
+    return awaitingCoroutine;
+  }
+
+  // Hand the lock off: the waiter runs now and the awaiting coroutine, in
+  // whose frame *this lives, is the one to go through the executor.
+  auto next = waiter->awaitingCoroutine_;
+  auto nextContext = std::move(waiter->context_);
+  auto executor = std::move(executor_);
+  executor->add([awaitingCoroutine,
+                 context = RequestContext::saveContext()]() mutable noexcept {
+    RequestContextScopeGuard contextScope{std::move(context)};
+    awaitingCoroutine.resume();
+  });
+  RequestContext::setContext(std::move(nextContext));
+  return next;
+}
+
+void Mutex::LockAwaiter::resumeViaExecutor() noexcept {
+  // Pass the waiter's RequestContext to Executor::add(), as co_viaIfAsync()
+  // does.
+  PinnedRequestContextScopeGuard contextScope{context_};
+  auto executor = std::move(executor_);
+  executor->add([awaitingCoroutine = awaitingCoroutine_,
+                 context = std::move(context_)]() mutable noexcept {
+    RequestContextScopeGuard contextScope{std::move(context)};
+    awaitingCoroutine.resume();
+  });
+}
+
+Mutex::LockAwaiter* Mutex::unlockOrGetNextWaiter() noexcept {
   assert(state_.load(std::memory_order_relaxed) != unlockedState());
 
   auto* waitersHead = waiters_;
@@ -46,7 +89,7 @@ void Mutex::unlock() noexcept {
           std::memory_order_release,
           std::memory_order_relaxed);
       if (releasedLock) {
-        return;
+        return nullptr;
       }
     }
 
@@ -69,8 +112,7 @@ void Mutex::unlock() noexcept {
   assert(waitersHead != nullptr);
 
   waiters_ = waitersHead->next_;
-
-  waitersHead->awaitingCoroutine_.resume();
+  return waitersHead;
 }
 
 bool Mutex::lockAsyncImpl(LockAwaiter* awaiter) {
@@ -19,6 +19,7 @@
 #include <folly/Executor.h>
 #include <folly/experimental/coro/Coroutine.h>
 #include <folly/experimental/coro/ViaIfAsync.h>
+#include <folly/io/async/Request.h>
 
 #include <atomic>
 #include <mutex>
@@ -69,6 +70,13 @@ namespace coro {
 ///     m.unlock();
 ///   }
 ///
+///   folly::coro::Task<> asyncLockAndHandOff()
+///   {
+///     co_await m.co_lock();
+///     ...
+///     co_await m.co_unlock();
+///   }
+///
 ///   void nonAsyncTryLock()
 ///   {
 ///     if (m.try_lock())
@@ -93,6 +101,8 @@ class Mutex {
   class LockAwaiter;
   template <typename Awaiter>
   class LockOperation;
+  class UnlockAwaiter;
+  class UnlockOperation;
 
  public:
   /// Construct a new async mutex that is initially unlocked.
@@ -157,17 +167,33 @@ class Mutex {
   /// schedule the resumption of the next coroutine in the queue.
   void unlock() noexcept;
 
+  /// Unlock the mutex from a coroutine, handing it off to the next waiter.
+  ///
+  /// If the next coroutine in the queue is to resume on the same executor as
+  /// the awaiting coroutine, then it is resumed right away on this thread,
+  /// by symmetric transfer, and it is the awaiting coroutine that is
+  /// scheduled on the executor instead. This takes a trip through the
+  /// executor's queue off the critical section of a contended mutex.
+  /// Otherwise this behaves as unlock(), and the awaiting coroutine
+  /// continues without suspending.
+  ///
+  /// Note that the executor will be passed implicitly if awaiting from a
+  /// Task or AsyncGenerator coroutine.
+  [[nodiscard]] UnlockOperation co_unlock() noexcept;
+
  private:
   using folly_coro_aware_mutex = std::true_type;
 
   class LockAwaiter {
    public:
-    explicit LockAwaiter(Mutex& mutex) noexcept : mutex_(mutex) {}
+    LockAwaiter(Mutex& mutex, folly::Executor::KeepAlive<> executor) noexcept
+        : mutex_(mutex), executor_(std::move(executor)) {}
 
     bool await_ready() noexcept { return mutex_.try_lock(); }
 
     bool await_suspend(coroutine_handle<> awaitingCoroutine) noexcept {
       awaitingCoroutine_ = awaitingCoroutine;
+      context_ = RequestContext::saveContext();
       return mutex_.lockAsyncImpl(this);
     }
 
@@ -179,6 +205,12 @@ class Mutex {
    private:
     friend Mutex;
 
+    // Schedules the awaiting coroutine, which now holds the lock, on its
+    // executor.
+    void resumeViaExecutor() noexcept;
+
+    folly::Executor::KeepAlive<> executor_;
+    std::shared_ptr<RequestContext> context_;
     coroutine_handle<> awaitingCoroutine_;
     LockAwaiter* next_;
   };
@@ -197,8 +229,37 @@ class Mutex {
    public:
     explicit LockOperation(Mutex& mutex) noexcept : mutex_(mutex) {}
 
-    auto viaIfAsync(folly::Executor::KeepAlive<> executor) const {
-      return folly::coro::co_viaIfAsync(std::move(executor), Awaiter{mutex_});
+    Awaiter viaIfAsync(folly::Executor::KeepAlive<> executor) const {
+      return Awaiter{mutex_, std::move(executor)};
+    }
+
+   private:
+    Mutex& mutex_;
+  };
+
+  class UnlockAwaiter {
+   public:
+    UnlockAwaiter(Mutex& mutex, folly::Executor::KeepAlive<> executor) noexcept
+        : mutex_(mutex), executor_(std::move(executor)) {}
+
+    bool await_ready() noexcept { return false; }
+
+    coroutine_handle<> await_suspend(
+        coroutine_handle<> awaitingCoroutine) noexcept;
+
+    void await_resume() noexcept {}
+
+   private:
+    Mutex& mutex_;
+    folly::Executor::KeepAlive<> executor_;
+  };
+
+  class UnlockOperation {
+   public:
+    explicit UnlockOperation(Mutex& mutex) noexcept : mutex_(mutex) {}
+
+    UnlockAwaiter viaIfAsync(folly::Executor::KeepAlive<> executor) const {
+      return UnlockAwaiter{mutex_, std::move(executor)};
     }
 
    private:
@@ -217,6 +278,10 @@ class Mutex {
   // suspending.
   bool lockAsyncImpl(LockAwaiter* awaiter);
 
+  // Unlock the mutex if there are no waiters, and return nullptr. Otherwise
+  // dequeue the next waiter, which now holds the lock, and return it.
+  LockAwaiter* unlockOrGetNextWaiter() noexcept;
+
   // This contains either:
   // - this    => Not locked
   // - nullptr => Locked, no newly queued waiters (ie. empty list of waiters)
@@ -238,6 +303,10 @@ inline Mutex::LockOperation<Mutex::LockAwaiter> Mutex::co_lock() noexcept {
   return LockOperation<LockAwaiter>{*this};
 }
 
+inline Mutex::UnlockOperation Mutex::co_unlock() noexcept {
+  return UnlockOperation{*this};
+}
+
 } // namespace coro
 } // namespace folly
 
@@ -16,6 +16,8 @@
 
 #include <folly/experimental/coro/SharedMutex.h>
 
+#include <folly/executors/SequencedExecutor.h>
+
 #if FOLLY_HAS_COROUTINES
 
 using namespace folly::coro;
@@ -53,7 +55,7 @@ void SharedMutexFair::unlock() noexcept {
     awaitersToResume = unlockOrGetNextWaitersToResume(*lockedState);
   }
 
-  resumeWaiters(awaitersToResume);
+  resumeWaiters(awaitersToResume, resumeMode_);
 }
 
 void SharedMutexFair::unlock_shared() noexcept {
@@ -69,7 +71,7 @@ void SharedMutexFair::unlock_shared() noexcept {
     awaitersToResume = unlockOrGetNextWaitersToResume(*lockedState);
   }
 
-  resumeWaiters(awaitersToResume);
+  resumeWaiters(awaitersToResume, resumeMode_);
 }
 
 SharedMutexFair::LockAwaiterBase*
@@ -107,9 +109,34 @@ SharedMutexFair::unlockOrGetNextWaitersToResume(
   return head;
 }
 
-void SharedMutexFair::resumeWaiters(LockAwaiterBase* awaiters) noexcept {
+void SharedMutexFair::resumeWaiters(
+    LockAwaiterBase* awaiters, ResumeMode resumeMode) noexcept {
   while (awaiters != nullptr) {
-    std::exchange(awaiters, awaiters->nextAwaiter_)->resume();
+    auto* first = awaiters;
+    auto* last = first;
+    // Split off the run of waiters that resume on the same executor, if it
+    // runs its tasks one after the other anyway.
+    if (resumeMode == ResumeMode::kBatched &&
+        dynamic_cast<folly::SequencedExecutor*>(first->executor_.get())) {
+      while (last->nextAwaiter_ != nullptr &&
+             last->nextAwaiter_->executor_.get() == first->executor_.get()) {
+        last = last->nextAwaiter_;
+      }
+    }
+    awaiters = std::exchange(last->nextAwaiter_, nullptr);
+
+    PinnedRequestContextScopeGuard contextScope{first->context_};
+    auto executor = std::move(first->executor_);
+    executor->add([first]() noexcept {
+      for (auto* awaiter = first; awaiter != nullptr;) {
+        // The awaiter lives in the frame of the coroutine being resumed.
+        auto* next = awaiter->nextAwaiter_;
+        auto continuation = awaiter->continuation_;
+        RequestContextScopeGuard contextScope{std::move(awaiter->context_)};
+        continuation.resume();
+        awaiter = next;
+      }
+    });
   }
 }
 
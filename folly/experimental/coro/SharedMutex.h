@@ -28,6 +28,7 @@
 #include <folly/experimental/coro/Coroutine.h>
 #include <folly/experimental/coro/SharedLock.h>
 #include <folly/experimental/coro/ViaIfAsync.h>
+#include <folly/io/async/Request.h>
 
 #if FOLLY_HAS_COROUTINES
 
@@ -95,8 +96,24 @@ class SharedMutexFair : private folly::NonCopyableNonMovable {
   class ScopedLockSharedAwaiter;
 
  public:
+  /// How the waiters granted the lock together, such as a run of readers,
+  /// are scheduled on their executors.
+  enum class ResumeMode : std::uint8_t {
+    /// One Executor::add() per waiter, so that readers resumed on a thread
+    /// pool run in parallel. This is the default.
+    kIndividual,
+    /// One Executor::add() per run of waiters on the same executor, when
+    /// that executor is a SequencedExecutor, which would run them one after
+    /// the other anyway. Waiters on other executors are resumed
+    /// individually.
+    kBatched,
+  };
+
   SharedMutexFair() noexcept = default;
 
+  explicit SharedMutexFair(ResumeMode resumeMode) noexcept
+      : resumeMode_(resumeMode) {}
+
   ~SharedMutexFair();
 
   /// Try to acquire an exclusive lock on the mutex synchronously.
@@ -196,26 +213,42 @@ class SharedMutexFair : private folly::NonCopyableNonMovable {
 
   enum class LockType : std::uint8_t { EXCLUSIVE, SHARED };
 
+  struct State;
+
   class LockAwaiterBase {
    protected:
     friend class SharedMutexFair;
 
-    explicit LockAwaiterBase(SharedMutexFair& mutex, LockType lockType) noexcept
-        : mutex_(&mutex), nextAwaiter_(nullptr), lockType_(lockType) {}
+    LockAwaiterBase(
+        SharedMutexFair& mutex,
+        folly::Executor::KeepAlive<> executor,
+        LockType lockType) noexcept
+        : mutex_(&mutex),
+          nextAwaiter_(nullptr),
+          executor_(std::move(executor)),
+          lockType_(lockType) {}
 
-    void resume() noexcept { continuation_.resume(); }
+    void enqueue(State& state, coroutine_handle<> continuation) noexcept {
+      continuation_ = continuation;
+      context_ = RequestContext::saveContext();
+      *state.waitersTailNext_ = this;
+      state.waitersTailNext_ = &nextAwaiter_;
+    }
 
     SharedMutexFair* mutex_;
     LockAwaiterBase* nextAwaiter_;
     LockAwaiterBase* nextReader_;
+    folly::Executor::KeepAlive<> executor_;
+    std::shared_ptr<RequestContext> context_;
     coroutine_handle<> continuation_;
     LockType lockType_;
   };
 
   class LockAwaiter : public LockAwaiterBase {
    public:
-    explicit LockAwaiter(SharedMutexFair& mutex) noexcept
-        : LockAwaiterBase(mutex, LockType::EXCLUSIVE) {}
+    LockAwaiter(
+        SharedMutexFair& mutex, folly::Executor::KeepAlive<> executor) noexcept
+        : LockAwaiterBase(mutex, std::move(executor), LockType::EXCLUSIVE) {}
 
     bool await_ready() noexcept { return mutex_->try_lock(); }
 
@@ -230,9 +263,7 @@ class SharedMutexFair : private folly::NonCopyableNonMovable {
       }
 
       // Append to the end of the waiters queue.
-      continuation_ = continuation;
-      *lock->waitersTailNext_ = this;
-      lock->waitersTailNext_ = &nextAwaiter_;
+      enqueue(*lock, continuation);
       return true;
     }
 
@@ -241,8 +272,9 @@ class SharedMutexFair : private folly::NonCopyableNonMovable {
 
   class LockSharedAwaiter : public LockAwaiterBase {
    public:
-    explicit LockSharedAwaiter(SharedMutexFair& mutex) noexcept
-        : LockAwaiterBase(mutex, LockType::SHARED) {}
+    LockSharedAwaiter(
+        SharedMutexFair& mutex, folly::Executor::KeepAlive<> executor) noexcept
+        : LockAwaiterBase(mutex, std::move(executor), LockType::SHARED) {}
 
     bool await_ready() noexcept { return mutex_->try_lock_shared(); }
 
@@ -261,9 +293,7 @@ class SharedMutexFair : private folly::NonCopyableNonMovable {
 
       // Lock not available immediately.
       // Queue up for later resumption.
-      continuation_ = continuation;
-      *lock->waitersTailNext_ = this;
-      lock->waitersTailNext_ = &nextAwaiter_;
+      enqueue(*lock, continuation);
       return true;
     }
 
@@ -297,8 +327,8 @@ class SharedMutexFair : private folly::NonCopyableNonMovable {
    public:
     explicit LockOperation(SharedMutexFair& mutex) noexcept : mutex_(mutex) {}
 
-    auto viaIfAsync(folly::Executor::KeepAlive<> executor) const {
-      return folly::coro::co_viaIfAsync(std::move(executor), Awaiter{mutex_});
+    Awaiter viaIfAsync(folly::Executor::KeepAlive<> executor) const {
+      return Awaiter{mutex_, std::move(executor)};
     }
 
    private:
@@ -321,13 +351,17 @@ class SharedMutexFair : private folly::NonCopyableNonMovable {
 
   static LockAwaiterBase* unlockOrGetNextWaitersToResume(State& state) noexcept;
 
-  static void resumeWaiters(LockAwaiterBase* awaiters) noexcept;
+  // Schedules the given list of waiters, which now hold the lock, on their
+  // executors, see ResumeMode.
+  static void resumeWaiters(
+      LockAwaiterBase* awaiters, ResumeMode resumeMode) noexcept;
 
   static constexpr std::size_t kUnlocked = 0;
   static constexpr std::size_t kExclusiveLockFlag = 1;
   static constexpr std::size_t kSharedLockCountIncrement = 2;
 
   folly::Synchronized<State, folly::SpinLock> state_;
+  const ResumeMode resumeMode_{ResumeMode::kIndividual};
 };
 
 inline SharedMutexFair::LockOperation<SharedMutexFair::LockAwaiter>
@@ -25,6 +25,17 @@
 namespace folly {
 namespace coro {
 
+namespace detail {
+
+class SleepCallback : public HHWheelTimer::Callback {
+ public:
+  folly::coro::Baton baton;
+
+  void timeoutExpired() noexcept override { baton.post(); }
+};
+
+} // namespace detail
+
 inline Task<void> sleep(HighResDuration d, Timekeeper* tk) {
   bool cancelled{false};
   folly::coro::Baton baton;
@@ -53,6 +64,28 @@ inline Task<void> sleep(HighResDuration d, Timekeeper* tk) {
   co_yield co_result(std::move(result));
 }
 
+inline Task<void> sleep(HighResDuration d, HHWheelTimer& timer) {
+  DCHECK(timer.getTimeoutManager()->isInTimeoutManagerThread());
+  bool cancelled{false};
+  detail::SleepCallback callback;
+  timer.scheduleTimeout(
+      &callback, std::chrono::ceil<std::chrono::milliseconds>(d));
+
+  {
+    CancellationCallback cancelCallback(
+        co_await co_current_cancellation_token, [&]() noexcept {
+          cancelled = true;
+          callback.baton.post();
+        });
+    co_await callback.baton;
+  }
+  // Back on the timer's thread: the timer may only be cancelled from there.
+  callback.cancelTimeout();
+  if (cancelled) {
+    co_yield co_cancelled;
+  }
+}
+
 inline Task<void> sleepReturnEarlyOnCancel(HighResDuration d, Timekeeper* tk) {
   auto result = co_await co_awaitTry(sleep(d, tk));
   if (result.hasException<OperationCancelled>()) {
@@ -19,6 +19,7 @@
 #include <folly/experimental/coro/Coroutine.h>
 #include <folly/experimental/coro/Task.h>
 #include <folly/futures/Future.h>
+#include <folly/io/async/HHWheelTimer.h>
 
 #if FOLLY_HAS_COROUTINES
 
@@ -38,6 +39,19 @@ Task<void> sleep(HighResDuration d, Timekeeper* tk = nullptr);
 Task<void> sleepReturnEarlyOnCancel(
     HighResDuration d, Timekeeper* tk = nullptr);
 
+/// Return a task that, when awaited, will sleep for the specified duration
+/// using the given HHWheelTimer, e.g. evb.timer().
+///
+/// Unlike sleep() on a Timekeeper this allocates no future and doesn't hop
+/// to a timekeeper thread: the task must be awaited from a coroutine running
+/// on the EventBase that drives the timer, and it is on that thread that the
+/// timer is scheduled, fires and is cancelled. The duration is rounded up to
+/// the timer's resolution.
+///
+/// Throws folly::OperationCancelled if cancellation is requested on the
+/// awaiting coroutine's associated CancellationToken.
+Task<void> sleep(HighResDuration d, HHWheelTimer& timer);
+
 } // namespace coro
 } // namespace folly
 
@@ -20,7 +20,10 @@
 
 #pragma once
 
+#include <cstddef>
 #include <exception>
+#include <memory>
+#include <new>
 #include <type_traits>
 
 #include <glog/logging.h>
@@ -197,8 +200,8 @@ class TaskPromiseBase {
 };
 
 template <typename T>
-class TaskPromise final : public TaskPromiseBase,
-                          public ExtendedCoroutinePromiseImpl<TaskPromise<T>> {
+class TaskPromise : public TaskPromiseBase,
+                   public ExtendedCoroutinePromiseImpl<TaskPromise<T>> {
  public:
   static_assert(
       !std::is_rvalue_reference_v<T>,
@@ -272,7 +275,7 @@ class TaskPromise final : public TaskPromiseBase,
 };
 
 template <>
-class TaskPromise<void> final
+class TaskPromise<void>
     : public TaskPromiseBase,
       public ExtendedCoroutinePromiseImpl<TaskPromise<void>> {
  public:
@@ -330,6 +333,70 @@ class TaskPromise<void> final
   Try<void> result_;
 };
 
+template <typename Arena>
+using detect_frame_arena = decltype(static_cast<void*>(
+    std::declval<Arena&>().allocate(std::size_t())),
+    std::declval<Arena&>().deallocate(
+        static_cast<void*>(nullptr), std::size_t()));
+
+template <typename Arena>
+constexpr bool is_frame_arena_v = is_detected_v<detect_frame_arena, Arena>;
+
+// The promise of Task coroutines that allocate their frame from an arena.
+// Only these frames carry a header, to tell operator delete where the frame
+// came from. It adds no members, so the frame can still be handled through
+// coroutine_handle<TaskPromise<T>>.
+template <typename T>
+class ArenaTaskPromise final : public TaskPromise<T> {
+  struct alignas(alignof(std::max_align_t)) FrameHeader {
+    void* arena;
+    void (*deallocate)(void* arena, void* p, std::size_t size);
+  };
+
+  template <typename Arena>
+  static void* allocate(std::size_t size, Arena& arena) {
+    auto header = new (arena.allocate(size + sizeof(FrameHeader)))
+        FrameHeader{std::addressof(arena), &deallocate<Arena>};
+    return header + 1;
+  }
+
+  template <typename Arena>
+  static void deallocate(void* arena, void* p, std::size_t size) {
+    static_cast<Arena*>(arena)->deallocate(p, size);
+  }
+
+ public:
+  template <
+      typename Arena,
+      typename... Args,
+      std::enable_if_t<is_frame_arena_v<Arena>, int> = 0>
+  static void* operator new(
+      std::size_t size, std::allocator_arg_t, Arena& arena, Args&...) {
+    return allocate(size, arena);
+  }
+
+  template <
+      typename Self,
+      typename Arena,
+      typename... Args,
+      std::enable_if_t<is_frame_arena_v<Arena>, int> = 0>
+  static void* operator new(
+      std::size_t size, Self&, std::allocator_arg_t, Arena& arena, Args&...) {
+    return allocate(size, arena);
+  }
+
+  static void operator delete(void* ptr, std::size_t size) {
+    auto header = static_cast<FrameHeader*>(ptr) - 1;
+    header->deallocate(header->arena, header, size + sizeof(FrameHeader));
+  }
+};
+
+template <typename T, typename Arena>
+using task_promise_for_t = std::conditional_t<
+    is_frame_arena_v<Arena>,
+    ArenaTaskPromise<T>,
+    TaskPromise<T>>;
+
 } // namespace detail
 
 /// Represents an allocated but not yet started coroutine that has already
@@ -899,4 +966,34 @@ inline Task<void> detail::TaskPromise<void>::get_return_object() noexcept {
 } // namespace coro
 } // namespace folly
 
+/**
+ * Task coroutines whose first parameters are std::allocator_arg and an arena,
+ * e.g. a SysArena, have their frame allocated from the arena:
+ *
+ *   Task<Response> handle(std::allocator_arg_t, SysArena&, Request req);
+ *
+ * The arena only needs allocate(size) and deallocate(p, size), and has to
+ * outlive the coroutine. The frame is allocated on the thread calling the
+ * coroutine and deallocated on the thread that finishes or destroys it.
+ * Member coroutines and lambdas are covered too.
+ */
+template <typename T, typename Arena, typename... Args>
+struct folly::coro::impl::coroutine_traits<
+    folly::coro::Task<T>,
+    std::allocator_arg_t,
+    Arena&,
+    Args...> {
+  using promise_type = folly::coro::detail::task_promise_for_t<T, Arena>;
+};
+
+template <typename T, typename Self, typename Arena, typename... Args>
+struct folly::coro::impl::coroutine_traits<
+    folly::coro::Task<T>,
+    Self&,
+    std::allocator_arg_t,
+    Arena&,
+    Args...> {
+  using promise_type = folly::coro::detail::task_promise_for_t<T, Arena>;
+};
+
 #endif // FOLLY_HAS_COROUTINES
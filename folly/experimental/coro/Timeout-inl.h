@@ -121,6 +121,63 @@ Task<typename semi_await_try_result_t<SemiAwaitable>::element_type> timeoutImpl(
   co_yield folly::coro::co_error(std::move(error));
 }
 
+class TimeoutCallback : public HHWheelTimer::Callback {
+ public:
+  explicit TimeoutCallback(CancellationSource cancelSource) noexcept
+      : cancelSource_(std::move(cancelSource)) {}
+
+  bool fired() const noexcept { return fired_; }
+
+  void timeoutExpired() noexcept override {
+    fired_ = true;
+    cancelSource_.requestCancellation();
+  }
+
+ private:
+  CancellationSource cancelSource_;
+  bool fired_{false};
+};
+
+template <typename SemiAwaitable, bool discard>
+Task<typename semi_await_try_result_t<SemiAwaitable>::element_type>
+wheelTimeoutImpl(
+    SemiAwaitable semiAwaitable,
+    std::chrono::milliseconds timeoutDuration,
+    HHWheelTimer& timer) {
+  DCHECK(timer.getTimeoutManager()->isInTimeoutManagerThread());
+  CancellationSource cancelSource;
+  TimeoutCallback timeoutCallback{cancelSource};
+  timer.scheduleTimeout(&timeoutCallback, timeoutDuration);
+
+  bool parentCancelled = false;
+  std::optional<CancellationCallback> cancelCallback{
+      std::in_place, co_await co_current_cancellation_token, [&]() noexcept {
+        parentCancelled = true;
+        cancelSource.requestCancellation();
+      }};
+
+  auto resultTry =
+      co_await folly::coro::co_awaitTry(folly::coro::co_withCancellation(
+          cancelSource.getToken(), std::move(semiAwaitable)));
+
+  cancelCallback.reset();
+  // Back on the timer's thread, where the timer fires and may be cancelled,
+  // so there is no race with timeoutExpired().
+  timeoutCallback.cancelTimeout();
+
+  if constexpr (discard) {
+    if (timeoutCallback.fired() && !parentCancelled) {
+      co_yield folly::coro::co_error(FutureTimeout());
+    }
+  }
+
+  if (resultTry.hasException()) {
+    co_yield folly::coro::co_error(std::move(resultTry).exception());
+  }
+
+  co_return std::move(resultTry).value();
+}
+
 } // namespace detail
 
 template <typename SemiAwaitable, typename Duration>
@@ -138,6 +195,25 @@ timeoutNoDiscard(
       std::move(semiAwaitable), timeoutDuration, tk);
 }
 
+template <typename SemiAwaitable, typename Duration>
+Task<typename semi_await_try_result_t<SemiAwaitable>::element_type> timeout(
+    SemiAwaitable semiAwaitable, Duration timeoutDuration, HHWheelTimer& timer) {
+  return detail::wheelTimeoutImpl<SemiAwaitable, /*discard=*/true>(
+      std::move(semiAwaitable),
+      std::chrono::ceil<std::chrono::milliseconds>(timeoutDuration),
+      timer);
+}
+
+template <typename SemiAwaitable, typename Duration>
+Task<typename semi_await_try_result_t<SemiAwaitable>::element_type>
+timeoutNoDiscard(
+    SemiAwaitable semiAwaitable, Duration timeoutDuration, HHWheelTimer& timer) {
+  return detail::wheelTimeoutImpl<SemiAwaitable, /*discard=*/false>(
+      std::move(semiAwaitable),
+      std::chrono::ceil<std::chrono::milliseconds>(timeoutDuration),
+      timer);
+}
+
 } // namespace folly::coro
 
 #endif // FOLLY_HAS_COROUTINES
@@ -20,6 +20,7 @@
 #include <folly/experimental/coro/Task.h>
 #include <folly/experimental/coro/Traits.h>
 #include <folly/futures/Future.h>
+#include <folly/io/async/HHWheelTimer.h>
 
 #if FOLLY_HAS_COROUTINES
 
@@ -80,6 +81,23 @@ timeoutNoDiscard(
     Duration timeoutDuration,
     Timekeeper* tk = nullptr);
 
+/// Like timeout() and timeoutNoDiscard() above, but use the given
+/// HHWheelTimer, e.g. evb.timer(), for the timer instead of a Timekeeper.
+///
+/// This allocates no future and doesn't hop to a timekeeper thread, and the
+/// timer is cancelled in O(1) when the operation completes first: the
+/// returned Task must be awaited from a coroutine running on the EventBase
+/// that drives the timer. The duration is rounded up to the timer's
+/// resolution.
+template <typename SemiAwaitable, typename Duration>
+Task<typename semi_await_try_result_t<SemiAwaitable>::element_type> timeout(
+    SemiAwaitable semiAwaitable, Duration timeoutDuration, HHWheelTimer& timer);
+
+template <typename SemiAwaitable, typename Duration>
+Task<typename semi_await_try_result_t<SemiAwaitable>::element_type>
+timeoutNoDiscard(
+    SemiAwaitable semiAwaitable, Duration timeoutDuration, HHWheelTimer& timer);
+
 } // namespace folly::coro
 
 #endif // FOLLY_HAS_COROUTINES
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <folly/concurrency/UnboundedQueue.h>
 #include <folly/experimental/coro/Coroutine.h>
 #include <folly/experimental/coro/Task.h>
@@ -37,6 +39,20 @@ class UnboundedQueue {
     sem_.signal();
   }
 
+  // Enqueues the items of [first, last) in order before waking any
+  // consumer, so that one woken by the first item may take the others with
+  // dequeue_batch() without suspending again.
+  template <typename InputIt>
+  void enqueue_batch(InputIt first, InputIt last) {
+    size_t count = 0;
+    for (; first != last; ++first, ++count) {
+      queue_.enqueue(*first);
+    }
+    for (; count > 0; --count) {
+      sem_.signal();
+    }
+  }
+
   folly::coro::Task<T> dequeue() {
     folly::Try<void> result = co_await folly::coro::co_awaitTry(sem_.co_wait());
     if (result.hasException()) {
@@ -51,6 +67,23 @@ class UnboundedQueue {
     queue_.dequeue(out);
   }
 
+  // Waits for an item, then dequeues it along with those available without
+  // waiting, up to maxItems in all: one resumption for the whole batch.
+  folly::coro::Task<std::vector<T>> dequeue_batch(size_t maxItems) {
+    DCHECK_GT(maxItems, 0);
+    folly::Try<void> result = co_await folly::coro::co_awaitTry(sem_.co_wait());
+    if (result.hasException()) {
+      co_yield co_error(std::move(result).exception());
+    }
+
+    std::vector<T> items;
+    items.push_back(queue_.dequeue());
+    while (items.size() < maxItems && sem_.try_wait()) {
+      items.push_back(queue_.dequeue());
+    }
+    co_return items;
+  }
+
   folly::Optional<T> try_dequeue() {
     return sem_.try_wait() ? queue_.try_dequeue() : folly::none;
   }
@@ -78,7 +78,7 @@ class ViaCoroutinePromiseBase {
   void scheduleContinuation() noexcept {
     // Pass the coroutine's RequestContext to Executor::add(), in case the
     // Executor implementation wants to know what runs on it (e.g. for stats).
-    RequestContextScopeGuard contextScope{context_};
+    PinnedRequestContextScopeGuard contextScope{context_};
 
     executor_->add([this]() noexcept { this->executeContinuation(); });
   }
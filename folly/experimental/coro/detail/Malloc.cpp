@@ -17,13 +17,15 @@
 #include <folly/experimental/coro/detail/Malloc.h>
 
 #include <folly/lang/Hint.h>
-#include <folly/lang/New.h>
+#include <folly/memory/detail/SizeClassCache.h>
 
 extern "C" {
 
 FOLLY_NOINLINE
 void* folly_coro_async_malloc(std::size_t size) {
-  auto p = folly::operator_new(size);
+  // Small frames are recycled through the per-thread free lists of
+  // SizeClassCache.
+  void* p = folly::detail::sizeClassCacheAllocate(size);
 
   // Add this after the call to prevent the compiler from
   // turning the call to operator new() into a tailcall.
@@ -34,7 +36,7 @@ void* folly_coro_async_malloc(std::size_t size) {
 
 FOLLY_NOINLINE
 void folly_coro_async_free(void* ptr, std::size_t size) {
-  folly::operator_delete(ptr, size);
+  folly::detail::sizeClassCacheDeallocate(ptr, size);
 
   // Add this after the call to prevent the compiler from
   // turning the call to operator delete() into a tailcall.
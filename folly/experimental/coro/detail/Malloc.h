@@ -25,6 +25,9 @@ extern "C" {
 // Heap allocations for coroutine-frames for all async coroutines
 // (Task, AsyncGenerator, etc.) should be funneled through these
 // functions to allow better tracing/profiling of coroutine allocations.
+//
+// Small frames are recycled through per-thread free lists, so size must be
+// the size the frame was allocated with.
 FOLLY_NOINLINE
 void* folly_coro_async_malloc(std::size_t size);
 
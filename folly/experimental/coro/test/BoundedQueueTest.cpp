@@ -240,6 +240,41 @@ CO_TEST(BoundedQueueTest, TryDequeue) {
   EXPECT_TRUE(queue.try_dequeue().has_value());
 }
 
+CO_TEST(BoundedQueueTest, Batch) {
+  folly::coro::BoundedQueue<int> queue(4);
+  std::vector<int> in{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  std::vector<int> out;
+  // The batch only fits in the queue a few items at a time.
+  co_await folly::coro::collectAll(
+      queue.enqueue_batch(in.begin(), in.end()),
+      [&]() -> folly::coro::Task<void> {
+        while (out.size() < in.size()) {
+          auto items = co_await queue.dequeue_batch(3);
+          EXPECT_GE(items.size(), 1);
+          EXPECT_LE(items.size(), 3);
+          out.insert(out.end(), items.begin(), items.end());
+        }
+      }());
+  EXPECT_EQ(in, out);
+  EXPECT_TRUE(queue.empty());
+}
+
+CO_TEST(BoundedQueueTest, DequeueBatchWhileBlocking) {
+  folly::coro::BoundedQueue<int> queue(5);
+  folly::ManualExecutor ex;
+
+  auto fut = queue.dequeue_batch(10).scheduleOn(&ex).start();
+  ex.drain();
+  EXPECT_FALSE(fut.isReady());
+  std::vector<int> in{1, 2, 3};
+  co_await queue.enqueue_batch(in.begin(), in.end());
+
+  // Woken once, for all of the batch.
+  ex.drain();
+  EXPECT_TRUE(fut.isReady());
+  EXPECT_EQ(in, std::move(fut).get());
+}
+
 TEST(BoundedQueueTest, UnorderedEnqueueCompletion) {
   // Use optional to verify we're not accidentally dequeueing
   // default-constructed values.
@@ -715,6 +715,33 @@ TEST_F(CollectAllRangeTest, RangeOfNonVoid) {
   }());
 }
 
+TEST_F(CollectAllRangeTest, RangeOfNonDefaultConstructible) {
+  struct Value {
+    explicit Value(int v) : value(std::make_unique<int>(v)) {}
+    std::unique_ptr<int> value;
+  };
+  folly::coro::blockingWait([]() -> folly::coro::Task<void> {
+    constexpr int taskCount = 50;
+    std::vector<folly::coro::Task<Value>> tasks;
+    for (int i = 0; i < taskCount; ++i) {
+      tasks.push_back(folly::coro::co_invoke([i]() -> folly::coro::Task<Value> {
+        if ((i % 20) == 0) {
+          co_await folly::coro::co_reschedule_on_current_executor;
+        }
+        co_return Value(i);
+      }));
+    }
+
+    std::vector<Value> results =
+        co_await folly::coro::collectAllRange(std::move(tasks));
+
+    EXPECT_EQ(taskCount, results.size());
+    for (int i = 0; i < taskCount; ++i) {
+      EXPECT_EQ(i, *results[i].value);
+    }
+  }());
+}
+
 TEST_F(CollectAllRangeTest, SubtasksCancelledWhenASubtaskFails) {
   using namespace std::chrono_literals;
 
@@ -1889,6 +1916,86 @@ TEST_F(CollectAllTryWindowedTest, CancellationTokenRemainsActiveAfterReturn) {
   }());
 }
 
+TEST_F(CollectAllTryWindowedTest, AdaptiveLimit) {
+  folly::CPUThreadPoolExecutor threadPool{
+      4, std::make_shared<folly::NamedThreadFactory>("TestThreadPool")};
+  folly::coro::AdaptiveConcurrencyLimit::Options options;
+  options.initialLimit = 2;
+  options.maxLimit = 8;
+  folly::coro::AdaptiveConcurrencyLimit limit(options);
+
+  std::atomic<std::size_t> running{0};
+  std::atomic<std::size_t> maxRunning{0};
+  auto results = folly::coro::blockingWait(
+      folly::coro::collectAllTryWindowed(
+          [&]() -> folly::coro::Generator<folly::coro::Task<int>&&> {
+            for (int i = 0; i < 1000; ++i) {
+              co_yield [&](int idx) -> folly::coro::Task<int> {
+                auto now = ++running;
+                auto prev = maxRunning.load();
+                while (prev < now &&
+                       !maxRunning.compare_exchange_weak(prev, now)) {
+                }
+                co_await folly::coro::co_reschedule_on_current_executor;
+                --running;
+                if (idx % 100 == 99) {
+                  throw ErrorA{};
+                }
+                co_return idx;
+              }(i);
+            }
+          }(),
+          limit)
+          .scheduleOn(&threadPool));
+
+  EXPECT_EQ(1000, results.size());
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 100 == 99) {
+      EXPECT_TRUE(results[i].exception().is_compatible_with<ErrorA>());
+    } else {
+      EXPECT_EQ(i, results[i].value());
+    }
+  }
+  // Successes grew the limit from 2; it never went past maxLimit.
+  EXPECT_GT(maxRunning.load(), 2);
+  EXPECT_LE(maxRunning.load(), 8);
+}
+
+TEST(AdaptiveConcurrencyLimitTest, Aimd) {
+  using namespace std::literals::chrono_literals;
+  folly::coro::AdaptiveConcurrencyLimit::Options options;
+  options.initialLimit = 4;
+  options.maxLimit = 16;
+  options.latencyTarget = 10ms;
+  folly::coro::AdaptiveConcurrencyLimit limit(options);
+
+  // About one more for every limit's worth of successes.
+  for (int i = 0; i < 5; ++i) {
+    limit.onSuccess(1ms);
+  }
+  EXPECT_EQ(5, limit.limit());
+
+  // Halved, then held for the operations started under the old limit.
+  limit.onError();
+  EXPECT_EQ(2, limit.limit());
+  for (int i = 0; i < 5; ++i) {
+    limit.onSuccess(20ms);
+  }
+  EXPECT_EQ(2, limit.limit());
+  limit.onSuccess(20ms);
+  EXPECT_EQ(1, limit.limit());
+
+  // Never below minLimit nor above maxLimit.
+  for (int i = 0; i < 100; ++i) {
+    limit.onError();
+  }
+  EXPECT_EQ(1, limit.limit());
+  for (int i = 0; i < 1000; ++i) {
+    limit.onSuccess(1ms);
+  }
+  EXPECT_EQ(16, limit.limit());
+}
+
 class CollectAnyTest : public testing::Test {};
 
 TEST_F(CollectAnyTest, OneTaskWithValue) {
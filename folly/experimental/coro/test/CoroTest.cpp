@@ -643,6 +643,42 @@ TEST_F(CoroTest, CancellableSleep) {
   CHECK((end - start) < 1s);
 }
 
+TEST_F(CoroTest, WheelTimerSleep) {
+  using namespace std::chrono;
+  using namespace std::chrono_literals;
+
+  ScopedEventBaseThread evbThread;
+  auto* evb = evbThread.getEventBase();
+
+  auto sleepTask = [&]() -> coro::Task<void> {
+    co_await coro::sleep(50ms, evb->timer());
+  };
+  auto start = steady_clock::now();
+  coro::blockingWait(sleepTask().scheduleOn(evb));
+  EXPECT_GE(steady_clock::now() - start, 50ms);
+
+  // Cancellation wakes the sleeper up and cancels the timer.
+  CancellationSource cancelSrc;
+  auto cancelledSleepTask = [&]() -> coro::Task<void> {
+    co_await coro::collectAll(
+        [&]() -> coro::Task<void> {
+          co_await coro::co_withCancellation(
+              cancelSrc.getToken(), coro::sleep(10s, evb->timer()));
+        }(),
+        [&]() -> coro::Task<void> {
+          co_await coro::co_reschedule_on_current_executor;
+          cancelSrc.requestCancellation();
+        }());
+  };
+  start = steady_clock::now();
+  EXPECT_THROW(
+      coro::blockingWait(cancelledSleepTask().scheduleOn(evb)),
+      OperationCancelled);
+  EXPECT_LT(steady_clock::now() - start, 1s);
+  evb->runInEventBaseThreadAndWait(
+      [&] { EXPECT_EQ(0, evb->timer().count()); });
+}
+
 TEST_F(CoroTest, DefaultConstructible) {
   coro::blockingWait([]() -> coro::Task<void> {
     struct S {
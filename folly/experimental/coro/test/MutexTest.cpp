@@ -26,6 +26,7 @@
 #include <folly/portability/GTest.h>
 
 #include <mutex>
+#include <vector>
 
 #if FOLLY_HAS_COROUTINES
 
@@ -140,6 +141,49 @@ TEST_F(MutexTest, ScopedLockAsync) {
   CHECK(m.try_lock());
 }
 
+TEST_F(MutexTest, UnlockHandOff) {
+  coro::Mutex m;
+  coro::Baton b;
+  std::vector<int> order;
+
+  auto holder = [&]() -> coro::Task<void> {
+    co_await m.co_lock();
+    co_await b;
+    co_await m.co_unlock();
+    order.push_back(1);
+  };
+  auto waiter = [&]() -> coro::Task<void> {
+    co_await m.co_lock();
+    order.push_back(2);
+    co_await m.co_unlock();
+  };
+
+  ManualExecutor executor;
+
+  auto f1 = holder().scheduleOn(&executor).start();
+  executor.drain();
+  auto f2 = waiter().scheduleOn(&executor).start();
+  executor.drain();
+  CHECK(order.empty());
+
+  // The waiter is resumed directly by co_unlock(), before the holder gets
+  // to continue.
+  b.post();
+  executor.drain();
+  EXPECT_EQ((std::vector<int>{2, 1}), order);
+  CHECK(m.try_lock());
+  m.unlock();
+
+  // Without waiters co_unlock() doesn't suspend.
+  order.clear();
+  b.reset();
+  b.post();
+  auto f3 = holder().scheduleOn(&executor).start();
+  executor.drain();
+  EXPECT_EQ((std::vector<int>{1}), order);
+  CHECK(m.try_lock());
+}
+
 TEST_F(MutexTest, ThreadSafety) {
   CPUThreadPoolExecutor threadPool{
       2, std::make_shared<NamedThreadFactory>("CPUThreadPool")};
@@ -24,7 +24,11 @@
 #include <folly/experimental/coro/Task.h>
 #include <folly/portability/GTest.h>
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #if FOLLY_HAS_COROUTINES
 
@@ -113,6 +117,74 @@ TEST_F(SharedMutexTest, ManualLockAsync) {
   }
 }
 
+TEST_F(SharedMutexTest, ResumeReadersTogether) {
+  coro::SharedMutex mutex{coro::SharedMutex::ResumeMode::kBatched};
+  int readers = 0;
+
+  auto makeReaderTask = [&]() -> coro::Task<void> {
+    co_await mutex.co_lock_shared();
+    ++readers;
+    mutex.unlock_shared();
+  };
+
+  ManualExecutor executor;
+
+  CHECK(mutex.try_lock());
+  auto r1 = makeReaderTask().scheduleOn(&executor).start();
+  auto r2 = makeReaderTask().scheduleOn(&executor).start();
+  auto r3 = makeReaderTask().scheduleOn(&executor).start();
+  executor.drain();
+  CHECK_EQ(0, readers);
+
+  // Readers waiting on the same executor are all resumed by a single task.
+  mutex.unlock();
+  EXPECT_EQ(1, executor.step());
+  EXPECT_EQ(3, readers);
+  executor.drain();
+  CHECK(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST_F(SharedMutexTest, ResumeReadersTogetherOnThreadPool) {
+  coro::SharedMutex mutex{coro::SharedMutex::ResumeMode::kBatched};
+  constexpr int kReaders = 3;
+  std::atomic<int> started{0};
+  std::atomic<int> inside{0};
+  std::atomic<bool> overlapped{true};
+
+  // Each reader waits for all of them to hold the lock at the same time,
+  // which only happens if they run in parallel.
+  auto makeReaderTask = [&]() -> coro::Task<void> {
+    ++started;
+    co_await mutex.co_lock_shared();
+    ++inside;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (inside.load() < kReaders) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        overlapped = false;
+        break;
+      }
+      std::this_thread::yield();
+    }
+    mutex.unlock_shared();
+  };
+
+  CPUThreadPoolExecutor executor{kReaders};
+  CHECK(mutex.try_lock());
+  std::vector<SemiFuture<Unit>> readers;
+  for (int i = 0; i < kReaders; ++i) {
+    readers.push_back(makeReaderTask().scheduleOn(&executor).start());
+  }
+  // Wait for all the readers to queue up behind the writer.
+  while (started.load() < kReaders ||
+         executor.getPoolStats().activeThreadCount > 0) {
+    std::this_thread::yield();
+  }
+  mutex.unlock();
+  collectAll(std::move(readers)).get();
+  EXPECT_TRUE(overlapped.load());
+}
+
 TEST_F(SharedMutexTest, ScopedLockAsync) {
   coro::SharedMutex mutex;
   int value = 0;
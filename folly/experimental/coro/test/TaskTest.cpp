@@ -26,10 +26,13 @@
 #include <folly/experimental/coro/SharedMutex.h>
 #include <folly/experimental/coro/Task.h>
 #include <folly/experimental/coro/detail/InlineTask.h>
+#include <folly/experimental/coro/detail/Malloc.h>
 #include <folly/futures/Future.h>
 #include <folly/io/async/ScopedEventBaseThread.h>
+#include <folly/memory/Arena.h>
 #include <folly/portability/GTest.h>
 
+#include <memory>
 #include <stdexcept>
 #include <type_traits>
 
@@ -769,4 +772,73 @@ TEST_F(TaskTest, CoYieldCoErrorSameExecutor) {
   EXPECT_THROW(
       folly::coro::blockingWait(scopeAndThrowWrapper()), ExpectedException);
 }
+
+TEST_F(TaskTest, FrameRecycling) {
+  if (folly::kIsSanitizeAddress) {
+    GTEST_SKIP() << "Frames are not recycled under ASAN";
+  }
+  auto frame = folly_coro_async_malloc(200);
+  folly_coro_async_free(frame, 200);
+  // Same size class, same thread.
+  auto next = folly_coro_async_malloc(250);
+  EXPECT_EQ(frame, next);
+  folly_coro_async_free(next, 250);
+}
+
+namespace {
+folly::coro::Task<int> addInArena(
+    std::allocator_arg_t, folly::SysArena&, int a, int b) {
+  co_return a + b;
+}
+
+struct Adder {
+  folly::coro::Task<int> add(std::allocator_arg_t, folly::SysArena&, int a) {
+    co_return base + a;
+  }
+
+  int base;
+};
+
+struct NotAnArena {};
+
+folly::coro::Task<int> addNotInArena(
+    std::allocator_arg_t, NotAnArena&, int a, int b) {
+  co_return a + b;
+}
+} // namespace
+
+static_assert(std::is_same_v<
+              folly::coro::coroutine_traits<
+                  folly::coro::Task<int>,
+                  std::allocator_arg_t,
+                  NotAnArena&,
+                  int,
+                  int>::promise_type,
+              folly::coro::detail::TaskPromise<int>>);
+
+TEST_F(TaskTest, ArenaFrame) {
+  folly::SysArena arena;
+  auto used = arena.bytesUsed();
+  auto task = addInArena(std::allocator_arg, arena, 1, 2);
+  EXPECT_GT(arena.bytesUsed(), used);
+  EXPECT_EQ(3, folly::coro::blockingWait(std::move(task)));
+
+  Adder adder{10};
+  used = arena.bytesUsed();
+  auto memberTask = adder.add(std::allocator_arg, arena, 5);
+  EXPECT_GT(arena.bytesUsed(), used);
+  EXPECT_EQ(15, folly::coro::blockingWait(std::move(memberTask)));
+
+  // Frames of other tasks are unaffected.
+  used = arena.bytesUsed();
+  EXPECT_EQ(42, folly::coro::blockingWait([]() -> folly::coro::Task<int> {
+    co_return 42;
+  }()));
+  NotAnArena notAnArena;
+  EXPECT_EQ(
+      7,
+      folly::coro::blockingWait(
+          addNotInArena(std::allocator_arg, notAnArena, 3, 4)));
+  EXPECT_EQ(used, arena.bytesUsed());
+}
 #endif
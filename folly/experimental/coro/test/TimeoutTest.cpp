@@ -23,6 +23,7 @@
 #include <folly/experimental/coro/Timeout.h>
 #include <folly/futures/Future.h>
 #include <folly/io/async/Request.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
 #include <folly/portability/GTest.h>
 
 #include <chrono>
@@ -113,6 +114,34 @@ TYPED_TEST(TimeoutFixture, CompletesWithinTimeout) {
   }());
 }
 
+TYPED_TEST(TimeoutFixture, WheelTimer) {
+  ScopedEventBaseThread evbThread;
+  auto* evb = evbThread.getEventBase();
+
+  auto task = [&fn = this->fn, evb]() -> coro::Task<> {
+    auto& timer = evb->timer();
+
+    // Completing before the timeout cancels the timer.
+    auto result =
+        co_await fn([]() -> coro::Task<int> { co_return 42; }(), 1s, timer);
+    EXPECT_EQ(42, result);
+    EXPECT_EQ(0, timer.count());
+
+    // Timing out cancels the operation.
+    auto start = std::chrono::steady_clock::now();
+    auto tryResult = co_await coro::co_awaitTry(fn(
+        [&]() -> coro::Task<void> { co_await coro::sleep(10s, timer); }(),
+        50ms,
+        timer));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_TRUE(tryResult.template hasException<typename TypeParam::ExType>());
+    EXPECT_GE(elapsed, 50ms);
+    EXPECT_LT(elapsed, 1s);
+    EXPECT_EQ(0, timer.count());
+  };
+  coro::blockingWait(task().scheduleOn(evb));
+}
+
 TEST(TimeoutNoDiscard, ResultOnTimeout) {
   coro::blockingWait([]() -> coro::Task<> {
     co_await coro::timeoutNoDiscard(
@@ -213,6 +213,27 @@ TEST(UnboundedQueueTest, TryDequeue) {
   EXPECT_EQ(std::move(fut).get(), 13);
 }
 
+TEST(UnboundedQueueTest, DequeueBatch) {
+  folly::coro::UnboundedQueue<int> queue;
+  folly::ManualExecutor ex;
+
+  auto fut = queue.dequeue_batch(2).scheduleOn(&ex).start();
+  ex.drain();
+  EXPECT_FALSE(fut.isReady());
+
+  std::vector<int> in{1, 2, 3};
+  queue.enqueue_batch(in.begin(), in.end());
+  ex.drain();
+  EXPECT_TRUE(fut.isReady());
+  EXPECT_EQ(std::vector<int>({1, 2}), std::move(fut).get());
+
+  folly::coro::blockingWait([&]() -> folly::coro::Task<void> {
+    auto items = co_await queue.dequeue_batch(2);
+    EXPECT_EQ(std::vector<int>({3}), items);
+  }());
+  EXPECT_TRUE(queue.empty());
+}
+
 TEST(UnboundedQueueTest, TryPeekSingleConsumer) {
   folly::coro::UnboundedQueue<int, false, true> queue;
   EXPECT_EQ(nullptr, queue.try_peek());
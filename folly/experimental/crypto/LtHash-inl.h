@@ -14,13 +14,17 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cstring>
+#include <exception>
+#include <mutex>
 #include <stdexcept>
 
 #include <sodium.h>
 
 #include <folly/experimental/crypto/detail/LtHashInternal.h>
 #include <folly/lang/Bits.h>
+#include <folly/synchronization/Latch.h>
 
 namespace folly {
 namespace crypto {
@@ -402,6 +406,79 @@ LtHash<B, N>& LtHash<B, N>::removeObject(
   return *this;
 }
 
+template <std::size_t B, std::size_t N>
+LtHash<B, N>& LtHash<B, N>::addObjects(
+    folly::Range<const folly::ByteRange*> objects, folly::Executor* executor) {
+  if (executor == nullptr || objects.size() < 2 * kMinObjectsPerTask) {
+    for (auto object : objects) {
+      addObject(object);
+    }
+    return *this;
+  }
+  return *this += sumObjects(objects, *executor);
+}
+
+template <std::size_t B, std::size_t N>
+LtHash<B, N>& LtHash<B, N>::removeObjects(
+    folly::Range<const folly::ByteRange*> objects, folly::Executor* executor) {
+  if (executor == nullptr || objects.size() < 2 * kMinObjectsPerTask) {
+    for (auto object : objects) {
+      removeObject(object);
+    }
+    return *this;
+  }
+  return *this -= sumObjects(objects, *executor);
+}
+
+template <std::size_t B, std::size_t N>
+LtHash<B, N> LtHash<B, N>::sumObjects(
+    folly::Range<const folly::ByteRange*> objects,
+    folly::Executor& executor) const {
+  size_t const tasks =
+      std::min(kMaxTasks, objects.size() / kMinObjectsPerTask);
+  std::vector<LtHash<B, N>> partials(tasks);
+  std::exception_ptr error;
+  std::mutex errorMutex;
+  folly::Latch done(static_cast<ptrdiff_t>(tasks));
+  for (size_t t = 0; t < tasks; ++t) {
+    auto& partial = partials[t];
+    partial.key_ = key_;
+    // Shard t is objects [t * size / tasks, (t + 1) * size / tasks).
+    auto shard = objects.subpiece(
+        t * objects.size() / tasks,
+        (t + 1) * objects.size() / tasks - t * objects.size() / tasks);
+    auto task = [&, shard] {
+      try {
+        for (auto object : shard) {
+          partial.addObject(object);
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+      done.count_down();
+    };
+    try {
+      executor.add(std::move(task));
+    } catch (...) {
+      // The tasks already added still refer to this frame.
+      done.count_down(static_cast<ptrdiff_t>(tasks - t));
+      done.wait();
+      throw;
+    }
+  }
+  done.wait();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  for (size_t t = 1; t < tasks; ++t) {
+    partials[0] += partials[t];
+  }
+  return std::move(partials[0]);
+}
+
 /* static */
 template <std::size_t B, std::size_t N>
 constexpr size_t LtHash<B, N>::getChecksumSizeBytes() {
@@ -20,6 +20,7 @@
 #include <memory>
 #include <vector>
 
+#include <folly/Executor.h>
 #include <folly/Optional.h>
 #include <folly/Range.h>
 #include <folly/experimental/crypto/Blake2xb.h>
@@ -152,6 +153,28 @@ class LtHash {
   template <typename... Args>
   LtHash<B, N>& removeObject(folly::ByteRange firstRange, Args&&... moreRanges);
 
+  /**
+   * Adds (removes) every object in objects, with the same result as calling
+   * addObject() (removeObject()) on each of them.
+   *
+   * For large sets, hashing the objects dominates. Given an executor, the
+   * objects are split into shards of at least kMinObjectsPerTask, each shard
+   * is summed into its own LtHash by a task on the executor, and the partial
+   * sums are then added to this one. The call blocks until all tasks are
+   * done, so don't make it from a task of an executor that may have no
+   * other thread free to run them. If a task throws, the exception is
+   * rethrown here and this LtHash is left unchanged.
+   */
+  LtHash<B, N>& addObjects(
+      folly::Range<const folly::ByteRange*> objects,
+      folly::Executor* executor = nullptr);
+  LtHash<B, N>& removeObjects(
+      folly::Range<const folly::ByteRange*> objects,
+      folly::Executor* executor = nullptr);
+
+  static constexpr size_t kMinObjectsPerTask = 256;
+  static constexpr size_t kMaxTasks = 256;
+
   /**
    * Because the addObject() operation in LtHash is commutative and transitive,
    * it's possible to break down a large LtHash computation (i.e. adding 100k
@@ -285,6 +308,11 @@ class LtHash {
 
   void updateDigest(Blake2xb& digest);
 
+  // Returns the sum of the hashes of objects, computed on executor.
+  LtHash<B, N> sumObjects(
+      folly::Range<const folly::ByteRange*> objects,
+      folly::Executor& executor) const;
+
   static bool keysEqual(const LtHash<B, N>& h1, const LtHash<B, N>& h2);
 
   // current checksum
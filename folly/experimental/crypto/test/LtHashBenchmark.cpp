@@ -18,6 +18,7 @@
 
 #include <folly/Benchmark.h>
 #include <folly/Random.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/experimental/crypto/LtHash.h>
 #include <folly/init/Init.h>
 #include <folly/io/IOBuf.h>
@@ -101,6 +102,32 @@ BENCHMARK_RELATIVE(calculateChecksumFor100KObjects_B32_N1024) {
   }
 }
 
+template <std::size_t B, std::size_t N>
+void addObjectsBenchmark(size_t threads) {
+  folly::BenchmarkSuspender suspender;
+  std::vector<folly::ByteRange> ranges;
+  for (auto i = 0; i < 100000; ++i) {
+    const folly::IOBuf& obj = *(kObjects[i % kObjects.size()]);
+    ranges.emplace_back(obj.data(), obj.length());
+  }
+  folly::CPUThreadPoolExecutor executor(threads);
+  LtHash<B, N> ltHash;
+  suspender.dismiss();
+  ltHash.addObjects(folly::range(ranges), &executor);
+}
+
+BENCHMARK(addObjectsFor100KObjects_B20_N1008_1Thread) {
+  addObjectsBenchmark<20, 1008>(1);
+}
+
+BENCHMARK_RELATIVE(addObjectsFor100KObjects_B20_N1008_4Threads) {
+  addObjectsBenchmark<20, 1008>(4);
+}
+
+BENCHMARK_RELATIVE(addObjectsFor100KObjects_B20_N1008_16Threads) {
+  addObjectsBenchmark<20, 1008>(16);
+}
+
 BENCHMARK(subtractChecksumFor100KObjects_B20_N1008) {
   LtHash<20, 1008> ltHash;
   for (auto i = 0; i < 100000; ++i) {
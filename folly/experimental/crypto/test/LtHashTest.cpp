@@ -26,6 +26,7 @@
 
 #include <folly/Random.h>
 #include <folly/String.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/io/IOBuf.h>
 #include <folly/portability/GTest.h>
 
@@ -348,6 +349,40 @@ TYPED_TEST(LtHashTest, addObjectRandomShuffle) {
   EXPECT_EQ(h1, h2);
 }
 
+TYPED_TEST(LtHashTest, addObjects) {
+  // addObjects() and removeObjects() match addObject() and removeObject(),
+  // whether or not they run on an executor.
+  std::vector<std::unique_ptr<folly::IOBuf>> objects;
+  std::vector<folly::ByteRange> ranges;
+  for (int i = 0; i < 3000; i++) {
+    objects.push_back(makeRandomData((folly::Random::rand32() % 100) + 1));
+    ranges.emplace_back(objects.back()->data(), objects.back()->length());
+  }
+  folly::CPUThreadPoolExecutor executor(4);
+  std::vector<uint8_t> key(crypto_generichash_blake2b_KEYBYTES_MIN, 'k');
+
+  for (bool keyed : {false, true}) {
+    TypeParam expected;
+    TypeParam serial;
+    TypeParam parallel;
+    if (keyed) {
+      expected.setKey(folly::range(key));
+      serial.setKey(folly::range(key));
+      parallel.setKey(folly::range(key));
+    }
+    for (auto range : ranges) {
+      expected.addObject(range);
+    }
+    serial.addObjects(folly::range(ranges));
+    parallel.addObjects(folly::range(ranges), &executor);
+    EXPECT_EQ(expected, serial);
+    EXPECT_EQ(expected, parallel);
+
+    parallel.removeObjects(folly::range(ranges), &executor);
+    EXPECT_EQ(TestFixture::kEmptyHash(), parallel);
+  }
+}
+
 TYPED_TEST(LtHashTest, addAndremoveObjectRandom) {
   // 1) generate random objects
   // 2) adds them to LtHash while storing the checksum after each add
@@ -16,12 +16,18 @@
 
 #include <folly/experimental/exception_tracer/ExceptionCounterLib.h>
 
+#include <atomic>
 #include <iosfwd>
+#include <memory>
 #include <unordered_map>
 
+#include <glog/logging.h>
+
+#include <folly/Indestructible.h>
 #include <folly/Range.h>
 #include <folly/Synchronized.h>
 #include <folly/ThreadLocal.h>
+#include <folly/concurrency/ConcurrentHashMap.h>
 #include <folly/hash/SpookyHashV2.h>
 #include <folly/synchronization/RWSpinLock.h>
 
@@ -64,6 +70,25 @@ class Tag {};
 
 folly::ThreadLocal<ExceptionStatsStorage, Tag> gExceptionStats;
 
+struct ThrowSite {
+  explicit ThrowSite(ExceptionInfo&& i) : info(std::move(i)) {}
+
+  std::atomic<uint64_t> count{0};
+  const ExceptionInfo info;
+};
+
+using ThrowSites =
+    folly::ConcurrentHashMap<ExceptionId, std::unique_ptr<ThrowSite>>;
+
+// Never destroyed, as exceptions may be thrown during static destruction.
+ThrowSites& throwSites() {
+  static folly::Indestructible<ThrowSites> sites;
+  return *sites;
+}
+
+std::atomic<ExceptionCountingMode> gCountingMode{
+    ExceptionCountingMode::PerThread};
+
 } // namespace
 
 namespace folly {
@@ -74,6 +99,17 @@ std::vector<ExceptionStats> getExceptionStatistics() {
   for (auto& threadStats : gExceptionStats.accessAllThreads()) {
     threadStats.appendTo(accumulator);
   }
+  for (auto const& [exceptionId, site] : throwSites()) {
+    auto count = site->count.exchange(0, std::memory_order_relaxed);
+    if (count == 0) {
+      continue;
+    }
+    auto inserted =
+        accumulator.emplace(exceptionId, ExceptionStats{count, site->info});
+    if (!inserted.second) {
+      inserted.first->second.count += count;
+    }
+  }
 
   std::vector<ExceptionStats> result;
   result.reserve(accumulator.size());
@@ -99,6 +135,45 @@ std::ostream& operator<<(std::ostream& out, const ExceptionStats& stats) {
   return out;
 }
 
+void setExceptionCountingMode(ExceptionCountingMode mode) {
+  gCountingMode.store(mode, std::memory_order_relaxed);
+}
+
+ExceptionCountingMode getExceptionCountingMode() {
+  return gCountingMode.load(std::memory_order_relaxed);
+}
+
+ExceptionStatisticsReporter::ExceptionStatisticsReporter(
+    std::chrono::milliseconds interval, size_t maxThrowSites, Report report) {
+  scheduler_.setThreadName("ExceptionStats");
+  scheduler_.addFunction(
+      [maxThrowSites, report = std::move(report)]() mutable {
+        auto stats = getExceptionStatistics();
+        if (stats.empty()) {
+          return;
+        }
+        if (stats.size() > maxThrowSites) {
+          stats.resize(maxThrowSites);
+        }
+        report(stats);
+      },
+      interval,
+      "ExceptionStatisticsReporter",
+      interval);
+  scheduler_.start();
+}
+
+ExceptionStatisticsReporter::~ExceptionStatisticsReporter() {
+  scheduler_.shutdown();
+}
+
+void ExceptionStatisticsReporter::logExceptionStatistics(
+    const std::vector<ExceptionStats>& stats) {
+  for (auto const& stat : stats) {
+    LOG(INFO) << stat;
+  }
+}
+
 } // namespace exception_tracer
 } // namespace folly
 
@@ -113,7 +188,8 @@ void throwHandler(void*, std::type_info* exType, void (**)(void*)) noexcept {
   // pointers so they get all hashed together.
   uintptr_t frames[kMaxFrames + 1];
   frames[0] = reinterpret_cast<uintptr_t>(exType);
-  auto n = folly::symbolizer::getStackTrace(frames + 1, kMaxFrames);
+  auto n = folly::symbolizer::getStackTrace(
+      frames + 1, kMaxFrames, folly::symbolizer::getFastestStackTraceMode());
 
   if (n == -1) {
     // If we fail to collect the stack trace for this exception we
@@ -124,6 +200,28 @@ void throwHandler(void*, std::type_info* exType, void (**)(void*)) noexcept {
   auto exceptionId =
       folly::hash::SpookyHashV2::Hash64(frames, (n + 1) * sizeof(frames[0]), 0);
 
+  if (getExceptionCountingMode() == ExceptionCountingMode::ThrowSites) {
+    auto& sites = throwSites();
+    auto it = sites.find(exceptionId);
+    if (it == sites.cend()) {
+      try {
+        ExceptionInfo info;
+        info.type = exType;
+        info.frames.assign(frames + 1, frames + 1 + n);
+        // If another thread inserts the site first, count in that one.
+        it = sites
+                 .try_emplace(
+                     std::move(exceptionId),
+                     std::make_unique<ThrowSite>(std::move(info)))
+                 .first;
+      } catch (const std::bad_alloc&) {
+        return;
+      }
+    }
+    it->second->count.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
   gExceptionStats->statsHolder.withWLock([&](auto& holder) {
     auto it = holder.find(exceptionId);
     if (it != holder.end()) {
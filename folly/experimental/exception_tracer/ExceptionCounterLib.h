@@ -16,9 +16,12 @@
 
 #pragma once
 
+#include <chrono>
 #include <ostream>
 #include <vector>
 
+#include <folly/Function.h>
+#include <folly/experimental/FunctionScheduler.h>
 #include <folly/experimental/exception_tracer/ExceptionTracer.h>
 
 #if FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF
@@ -43,6 +46,50 @@ std::vector<ExceptionStats> getExceptionStatistics();
 
 std::ostream& operator<<(std::ostream& out, const ExceptionStats& stats);
 
+enum class ExceptionCountingMode {
+  // Each thread counts in its own table, behind a lock that
+  // getExceptionStatistics() also takes. The counts of threads that have
+  // exited are lost. This is the default.
+  PerThread,
+  // All threads count in one lock-free table of throw sites, keyed by the hash
+  // of the exception type and the unsymbolized stack trace. Only the first
+  // throw from a site allocates and stores its stack trace; the others find
+  // it and increment its count. The counts of exited threads are kept.
+  ThrowSites,
+};
+
+/**
+ * Sets how the exceptions thrown from now on are counted.
+ * getExceptionStatistics() reports the counts of both modes.
+ */
+void setExceptionCountingMode(ExceptionCountingMode mode);
+ExceptionCountingMode getExceptionCountingMode();
+
+/**
+ * Every interval, reports the statistics of the throw sites with the most
+ * throws since the previous report, from a thread of its own, until
+ * destroyed.
+ *
+ * Each report takes the statistics with getExceptionStatistics(), so they are
+ * not also returned by other calls to it. By default, the report logs the
+ * symbolized stack traces.
+ */
+class ExceptionStatisticsReporter {
+ public:
+  using Report = Function<void(const std::vector<ExceptionStats>&)>;
+
+  explicit ExceptionStatisticsReporter(
+      std::chrono::milliseconds interval,
+      size_t maxThrowSites = 10,
+      Report report = logExceptionStatistics);
+  ~ExceptionStatisticsReporter();
+
+  static void logExceptionStatistics(const std::vector<ExceptionStats>& stats);
+
+ private:
+  FunctionScheduler scheduler_;
+};
+
 } // namespace exception_tracer
 } // namespace folly
 
@@ -66,7 +66,9 @@ void throwCallback(
       lockedMeta.deleter = std::exchange(*deleter, metaDeleter);
 
       ssize_t n = folly::symbolizer::getStackTrace(
-          lockedMeta.trace.addresses, kMaxFrames);
+          lockedMeta.trace.addresses,
+          kMaxFrames,
+          folly::symbolizer::getFastestStackTraceMode());
       if (n != -1) {
         lockedMeta.trace.frameCount = n;
       }
@@ -53,7 +53,10 @@ bool StackTraceStack::pushCurrent() {
     return false;
   }
 
-  ssize_t n = folly::symbolizer::getStackTrace(node->addresses, kMaxFrames);
+  ssize_t n = folly::symbolizer::getStackTrace(
+      node->addresses,
+      kMaxFrames,
+      folly::symbolizer::getFastestStackTraceMode());
   if (n == -1) {
     node->deallocate();
     return false;
@@ -20,8 +20,10 @@
 #include <stdexcept>
 #include <thread>
 
+#include <folly/ScopeGuard.h>
 #include <folly/experimental/exception_tracer/ExceptionCounterLib.h>
 #include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
 
 #if FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF
 
@@ -134,4 +136,71 @@ TEST(ExceptionCounter, multyThreads) {
   }
 }
 
+TEST(ExceptionCounter, throwSites) {
+  setExceptionCountingMode(ExceptionCountingMode::ThrowSites);
+  SCOPE_EXIT {
+    setExceptionCountingMode(ExceptionCountingMode::PerThread);
+  };
+  EXPECT_EQ(ExceptionCountingMode::ThrowSites, getExceptionCountingMode());
+
+  constexpr size_t kNumIterations = 10000;
+  constexpr size_t kNumThreads = 10;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([] {
+      for (size_t i = 0; i < kNumIterations; ++i) {
+        throwAndCatch(foo);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  throwAndCatch(bar);
+
+  // Unlike with per-thread counting, the throws of exited threads count.
+  auto stats = getExceptionStatistics();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats[0].count, kNumIterations * kNumThreads);
+  EXPECT_EQ(*(stats[0].info.type), typeid(MyException));
+  EXPECT_FALSE(stats[0].info.frames.empty());
+  EXPECT_EQ(stats[1].count, 1);
+  EXPECT_EQ(*(stats[1].info.type), typeid(std::runtime_error));
+  EXPECT_EQ(getExceptionStatistics().size(), 0);
+
+  // Both modes count in the same sites.
+  for (auto mode :
+       {ExceptionCountingMode::PerThread, ExceptionCountingMode::ThrowSites}) {
+    setExceptionCountingMode(mode);
+    for (volatile int i = 0; i < 2; ++i) {
+      throwAndCatch(bar);
+    }
+  }
+  stats = getExceptionStatistics();
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(stats[0].count, 4);
+}
+
+TEST(ExceptionCounter, reporter) {
+  throwAndCatch(foo);
+  for (volatile int i = 0; i < 2; ++i) {
+    throwAndCatch(bar);
+  }
+
+  folly::Baton<> reported;
+  std::vector<ExceptionStats> stats;
+  {
+    ExceptionStatisticsReporter reporter(
+        std::chrono::milliseconds(10), 1, [&](const auto& s) {
+          if (!reported.ready()) {
+            stats = s;
+            reported.post();
+          }
+        });
+    reported.wait();
+  }
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(*(stats[0].info.type), typeid(std::runtime_error));
+}
+
 #endif // FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF
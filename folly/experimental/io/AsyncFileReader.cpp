@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/experimental/io/AsyncFileReader.h>
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <folly/Exception.h>
+#include <folly/Memory.h>
+#include <folly/experimental/coro/Baton.h>
+#include <folly/lang/Exception.h>
+#include <folly/portability/SysStat.h>
+
+namespace folly {
+
+struct AsyncFileReader::Chunk {
+  off_t offset{0};
+  // Bytes to read, rounded up to the alignment
+  size_t readSize{0};
+  // Bytes to hand back, if the file doesn't end first
+  size_t size{0};
+  std::unique_ptr<IOBuf> buf;
+  int rc{0};
+  bool done{false};
+#if FOLLY_HAS_COROUTINES
+  folly::coro::Baton baton;
+#endif
+};
+
+struct AsyncFileReader::State
+    : public std::enable_shared_from_this<AsyncFileReader::State> {
+  State(SimpleAsyncIO& aioIn, int fdIn, const Config& cfg)
+      : aio(aioIn),
+        fd(fdIn),
+        chunkSize(cfg.chunkSize_),
+        readahead(cfg.readahead_),
+        alignment(cfg.alignment_),
+        nextOffset(cfg.offset_) {
+    CHECK_GT(chunkSize, 0u);
+    CHECK_GT(readahead, 0u);
+    if (alignment > 1) {
+      CHECK_EQ(chunkSize % alignment, 0u)
+          << "chunk size must be a multiple of the alignment";
+      CHECK_EQ(size_t(nextOffset) % alignment, 0u)
+          << "offset must be a multiple of the alignment";
+    }
+    if (cfg.length_) {
+      endOffset = nextOffset + off_t(*cfg.length_);
+    } else {
+      struct stat st;
+      checkUnixError(fstat(fd, &st), "AsyncFileReader: fstat() failed");
+      endOffset = std::max(nextOffset, off_t(st.st_size));
+    }
+  }
+
+  std::unique_ptr<IOBuf> allocate(size_t capacity) {
+    if (alignment <= 1) {
+      return IOBuf::create(capacity);
+    }
+    void* buf = folly::aligned_malloc(capacity, alignment);
+    if (!buf) {
+      throw_exception<std::bad_alloc>();
+    }
+    return IOBuf::takeOwnership(
+        buf, capacity, 0, [](void* p, void*) { folly::aligned_free(p); });
+  }
+
+  // Queue up chunks for the reads to issue, up to the readahead. Must be
+  // called with the mutex held; the reads are issued by submit(), once the
+  // mutex is released.
+  std::vector<std::shared_ptr<Chunk>> issueLocked() {
+    std::vector<std::shared_ptr<Chunk>> toSubmit;
+    while (!finished && chunks.size() < readahead && nextOffset < endOffset) {
+      auto chunk = std::make_shared<Chunk>();
+      chunk->offset = nextOffset;
+      chunk->size = std::min(chunkSize, size_t(endOffset - nextOffset));
+      chunk->readSize = chunk->size;
+      if (alignment > 1) {
+        chunk->readSize = (chunk->size + alignment - 1) / alignment * alignment;
+      }
+      chunk->buf = allocate(chunk->readSize);
+      nextOffset += off_t(chunk->size);
+      chunks.push_back(chunk);
+      toSubmit.push_back(std::move(chunk));
+    }
+    return toSubmit;
+  }
+
+  void submit(std::vector<std::shared_ptr<Chunk>> toSubmit) {
+    for (auto& chunk : toSubmit) {
+      auto* data = chunk->buf->writableData();
+      auto readSize = chunk->readSize;
+      auto offset = chunk->offset;
+      aio.pread(
+          fd,
+          data,
+          readSize,
+          offset,
+          [self = shared_from_this(), chunk = std::move(chunk)](int rc) {
+            self->readDone(*chunk, rc);
+          });
+    }
+  }
+
+  void readDone(Chunk& chunk, int rc) {
+    if (callback) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        chunk.rc = rc;
+        chunk.done = true;
+      }
+      deliver();
+      return;
+    }
+    chunk.rc = rc;
+#if FOLLY_HAS_COROUTINES
+    chunk.baton.post();
+#endif
+  }
+
+  // Hand the completed chunks at the head of the queue to the callback.
+  // Only one thread delivers at a time; the others leave their chunks to it.
+  void deliver() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (delivering) {
+      return;
+    }
+    delivering = true;
+    while (!finished) {
+      std::shared_ptr<Chunk> chunk;
+      if (!chunks.empty()) {
+        if (!chunks.front()->done) {
+          break;
+        }
+        chunk = std::move(chunks.front());
+        chunks.pop_front();
+      }
+
+      // A short read means the file ended early.
+      bool eof = !chunk || chunk->rc < 0 || size_t(chunk->rc) < chunk->size;
+      finished = eof;
+      auto toSubmit = issueLocked();
+      lock.unlock();
+
+      submit(std::move(toSubmit));
+      if (chunk && chunk->rc < 0) {
+        callback->onError(makeSystemErrorExplicit(
+            -chunk->rc, "AsyncFileReader: read failed"));
+      } else {
+        if (chunk && chunk->rc > 0) {
+          chunk->buf->append(std::min(size_t(chunk->rc), chunk->size));
+          callback->onChunk(std::move(chunk->buf));
+        }
+        if (eof) {
+          callback->onEOF();
+        }
+      }
+
+      lock.lock();
+    }
+    delivering = false;
+  }
+
+  SimpleAsyncIO& aio;
+  const int fd;
+  const size_t chunkSize;
+  const size_t readahead;
+  const size_t alignment;
+  off_t nextOffset;
+  off_t endOffset;
+  // Set before any read is issued, null for read()
+  Callback* callback{nullptr};
+
+  std::mutex mutex;
+  // Chunks being read or not handed back yet, in file order
+  std::deque<std::shared_ptr<Chunk>> chunks;
+  bool finished{false};
+  bool delivering{false};
+};
+
+AsyncFileReader::AsyncFileReader(SimpleAsyncIO& aio, int fd, Config cfg)
+    : state_(std::make_shared<State>(aio, fd, cfg)) {}
+
+// In-flight reads keep the state alive until they complete.
+AsyncFileReader::~AsyncFileReader() = default;
+
+void AsyncFileReader::start(Callback* callback) {
+  CHECK(callback);
+  CHECK(!state_->callback) << "AsyncFileReader already started";
+  state_->callback = callback;
+
+  std::vector<std::shared_ptr<Chunk>> toSubmit;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    toSubmit = state_->issueLocked();
+  }
+  state_->submit(std::move(toSubmit));
+  // Handles an empty range, which issues no read.
+  state_->deliver();
+}
+
+#if FOLLY_HAS_COROUTINES
+folly::coro::AsyncGenerator<std::unique_ptr<IOBuf>&&> AsyncFileReader::read() {
+  CHECK(!state_->callback) << "AsyncFileReader already started";
+  auto state = state_;
+
+  std::vector<std::shared_ptr<Chunk>> toSubmit;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    toSubmit = state->issueLocked();
+  }
+  state->submit(std::move(toSubmit));
+
+  while (true) {
+    std::shared_ptr<Chunk> chunk;
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (!state->chunks.empty()) {
+        chunk = state->chunks.front();
+      }
+    }
+    if (!chunk) {
+      co_return;
+    }
+    co_await chunk->baton;
+
+    // A short read means the file ended early.
+    bool eof = chunk->rc < 0 || size_t(chunk->rc) < chunk->size;
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->chunks.pop_front();
+      state->finished = eof;
+      toSubmit = state->issueLocked();
+    }
+    state->submit(std::move(toSubmit));
+
+    if (chunk->rc < 0) {
+      throw_exception(makeSystemErrorExplicit(
+          -chunk->rc, "AsyncFileReader: read failed"));
+    }
+    if (chunk->rc > 0) {
+      chunk->buf->append(std::min(size_t(chunk->rc), chunk->size));
+      co_yield std::move(chunk->buf);
+    }
+    if (eof) {
+      co_return;
+    }
+  }
+}
+#endif // FOLLY_HAS_COROUTINES
+
+} // namespace folly
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <system_error>
+
+#include <folly/Optional.h>
+#include <folly/experimental/coro/AsyncGenerator.h>
+#include <folly/experimental/io/SimpleAsyncIO.h>
+#include <folly/io/IOBuf.h>
+
+namespace folly {
+
+/**
+ * AsyncFileReader streams a file, or a range of it, through SimpleAsyncIO
+ * (and so through libaio or io_uring). It keeps up to `readahead` chunk reads
+ * in flight and hands the chunks back as IOBufs, in file order.
+ *
+ * Usage, with the callback interface:
+ *
+ *        SimpleAsyncIO aio(SimpleAsyncIO::Config()
+ *            .setMode(SimpleAsyncIO::Mode::IOURING));
+ *        AsyncFileReader reader(aio, fd, AsyncFileReader::Config()
+ *            .setChunkSize(1 << 20)
+ *            .setReadahead(8));
+ *        reader.start(&callback);
+ *
+ * or with the coroutine one:
+ *
+ *        auto chunks = reader.read();
+ *        while (auto chunk = co_await chunks.next()) {
+ *          process(std::move(*chunk));
+ *        }
+ *
+ * Only one of start() and read() may be called, once per reader.
+ *
+ * For a file opened with O_DIRECT, set the alignment (typically the logical
+ * block size of the device): chunk buffers are then allocated with that
+ * alignment and reads are rounded up to it. The chunk size and the offset
+ * must be multiples of the alignment.
+ *
+ * The SimpleAsyncIO instance must outlive the reader, and must allow at least
+ * `readahead` requests; reads above its limit fail with -EBUSY.
+ */
+class AsyncFileReader {
+ public:
+  struct Config {
+    Config()
+        : chunkSize_(1 << 20), readahead_(4), alignment_(0), offset_(0) {}
+    /// Size of each read, and of the chunks handed back (except the last one)
+    Config& setChunkSize(size_t chunkSize) {
+      chunkSize_ = chunkSize;
+      return *this;
+    }
+    /// Maximum number of reads in flight
+    Config& setReadahead(size_t readahead) {
+      readahead_ = readahead;
+      return *this;
+    }
+    /// Buffer and read size alignment, for O_DIRECT; 0 for none
+    Config& setAlignment(size_t alignment) {
+      alignment_ = alignment;
+      return *this;
+    }
+    /// Offset to start reading from
+    Config& setOffset(off_t offset) {
+      offset_ = offset;
+      return *this;
+    }
+    /// Number of bytes to read; up to the end of the file if not set
+    Config& setLength(size_t length) {
+      length_ = length;
+      return *this;
+    }
+
+   private:
+    size_t chunkSize_;
+    size_t readahead_;
+    size_t alignment_;
+    off_t offset_;
+    Optional<size_t> length_;
+
+    friend class AsyncFileReader;
+  };
+
+  class Callback {
+   public:
+    virtual ~Callback() = default;
+
+    /**
+     * Invoked with each chunk, in file order. Chunks are delivered on the
+     * completion executor of the SimpleAsyncIO instance, one at a time.
+     */
+    virtual void onChunk(std::unique_ptr<IOBuf> chunk) noexcept = 0;
+
+    /**
+     * Invoked once all the chunks have been delivered.
+     */
+    virtual void onEOF() noexcept = 0;
+
+    /**
+     * Invoked if a read fails. No more chunks are delivered after this.
+     */
+    virtual void onError(const std::system_error& ex) noexcept = 0;
+  };
+
+  /**
+   * Throws std::system_error if the file size can't be determined, when the
+   * config doesn't set the length.
+   */
+  AsyncFileReader(SimpleAsyncIO& aio, int fd, Config cfg = Config());
+  ~AsyncFileReader();
+
+  AsyncFileReader(const AsyncFileReader&) = delete;
+  AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+  /**
+   * Start reading, delivering the chunks to the callback, which must remain
+   * valid until onEOF() or onError() is invoked.
+   */
+  void start(Callback* callback);
+
+#if FOLLY_HAS_COROUTINES
+  /**
+   * Coroutine version of start().
+   *
+   * Yields the chunks in file order, and throws std::system_error if a read
+   * fails. Reads are only issued as the chunks are consumed, so at most
+   * `readahead` chunks are buffered.
+   */
+  folly::coro::AsyncGenerator<std::unique_ptr<IOBuf>&&> read();
+#endif
+
+ private:
+  struct Chunk;
+  struct State;
+
+  std::shared_ptr<State> state_;
+};
+
+} // namespace folly
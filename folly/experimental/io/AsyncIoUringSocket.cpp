@@ -572,8 +572,21 @@ void AsyncIoUringSocket::ReadSqe::callback(const io_uring_cqe* cqe) noexcept {
           << " parent=" << parent_ << " cb=" << readCallback_ << " res=" << res
           << " max=" << maxSize_ << " inflight=" << inFlight()
           << " has_buffer=" << !!(flags & IORING_CQE_F_BUFFER)
-          << " bytes_received=" << bytesReceived_;
+          << " bytes_received=" << bytesReceived_
+          << " polling=" << pollingForData_;
   DestructorGuard dg(this);
+  if (pollingForData_) {
+    pollingForData_ = false;
+    if (res >= 0) {
+      // Data (or EOF) is there, so a buffer taken for it is not left idle.
+      socketReadable_ = true;
+      if (readCallback_ && parent_ && !inFlight()) {
+        parent_->submitRead();
+      }
+      return;
+    }
+    // Errors and cancellation are reported as they would be for a recv.
+  }
   auto buffer_guard = makeGuard([&, bp = lastUsedBufferProvider_] {
     if (flags & IORING_CQE_F_BUFFER) {
       DCHECK(bp);
@@ -689,6 +702,7 @@ void AsyncIoUringSocket::ReadSqe::processSubmit(
   VLOG(4) << "AsyncIoUringSocket::ReadSqe::processSubmit() this=" << this
           << " parent=" << parent_ << " cb=" << readCallback_;
   lastUsedBufferProvider_ = nullptr;
+  bool const socketReadable = std::exchange(socketReadable_, false);
   CHECK(!waitingForOldEventBaseRead());
   processOldEventBaseRead();
 
@@ -724,6 +738,15 @@ void AsyncIoUringSocket::ReadSqe::processSubmit(
         sqe->ioprio |= ioprio_flags;
         VLOG(9)
             << "AsyncIoUringSocket::readProcessSubmit bufferprovider multishot";
+      } else if (supportsMultishotRecv_ && !socketReadable) {
+        // Out of provided buffers: rather than have every idle socket pin a
+        // buffer of its own until data arrives, wait for the socket to be
+        // readable and only then allocate one (or use a provided buffer, if
+        // some were returned in the meantime).
+        pollingForData_ = true;
+        maxSize_ = 0;
+        ::io_uring_prep_poll_add(sqe, fd, POLLIN);
+        VLOG(9) << "AsyncIoUringSocket::readProcessSubmit out of buffers, poll";
       } else {
         // todo: it's possible the callback can hint to us how much data to use.
         // naively you could use getReadBuffer, however it turns out that many
@@ -868,7 +891,25 @@ void AsyncIoUringSocket::WriteSqe::processSubmit(
           << " length=" << totalLength_ << " ptr=" << msg_.msg_iov
           << " zc=" << zerocopy_ << " fd = " << parent_->usedFd_
           << " flags=" << parent_->mbFixedFileFlags_;
-  if (zerocopy_) {
+  if (msg_.msg_iovlen == 1 && !msg_.msg_name) {
+    // A single buffer does not need a msghdr to be copied in by the kernel.
+    if (zerocopy_) {
+      ::io_uring_prep_send_zc(
+          sqe,
+          parent_->usedFd_,
+          msg_.msg_iov->iov_base,
+          msg_.msg_iov->iov_len,
+          sendMsgFlags() | MSG_WAITALL,
+          0);
+    } else {
+      ::io_uring_prep_send(
+          sqe,
+          parent_->usedFd_,
+          msg_.msg_iov->iov_base,
+          msg_.msg_iov->iov_len,
+          sendMsgFlags());
+    }
+  } else if (zerocopy_) {
     ::io_uring_prep_sendmsg_zc(
         sqe, parent_->usedFd_, &msg_, sendMsgFlags() | MSG_WAITALL);
   } else {
@@ -1209,9 +1250,10 @@ void AsyncIoUringSocket::FastOpenSqe::processSubmit(
           << " iovs=" << initialWrite->msg_.msg_iovlen
           << " length=" << initialWrite->totalLength_
           << " ptr=" << initialWrite->msg_.msg_iov;
-  initialWrite->processSubmit(sqe);
+  // The address must be set first, so that processSubmit() uses sendmsg.
   initialWrite->msg_.msg_name = &addrStorage;
   initialWrite->msg_.msg_namelen = addrLen_;
+  initialWrite->processSubmit(sqe);
   sqe->msg_flags |= MSG_FASTOPEN;
 }
 
@@ -1336,6 +1378,17 @@ void AsyncIoUringSocket::WriteSqe::callback(const io_uring_cqe* cqe) noexcept {
 
   DestructorGuard dg(parent_);
 
+  if (res == -ENOBUFS && zerocopy_) {
+    // The kernel could not pin the pages (e.g. because of RLIMIT_MEMLOCK),
+    // so send this write by copying instead. The notification for the
+    // failed attempt, if any, is accounted for in refs_ as usual.
+    VLOG(2) << "zerocopy write failed with ENOBUFS, retrying with a copy";
+    zerocopy_ = false;
+    prepareForReuse();
+    parent_->doReSubmitWrite();
+    return;
+  }
+
   if (res > 0 && (size_t)res < totalLength_) {
     // todo clean out the iobuf
     size_t toRemove = res;
@@ -1436,6 +1489,10 @@ bool AsyncIoUringSocket::canZC(std::unique_ptr<IOBuf> const& buf) const {
   if (!options_.zeroCopyEnable) {
     return false;
   }
+  if (options_.zeroCopyThreshold > 0 &&
+      buf->computeChainDataLength() < options_.zeroCopyThreshold) {
+    return false;
+  }
   return (*options_.zeroCopyEnable)(buf);
 }
 
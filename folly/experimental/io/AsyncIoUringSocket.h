@@ -61,12 +61,17 @@ class AsyncIoUringSocket : public AsyncSocketTransport {
   struct Options {
     Options()
         : allocateNoBufferPoolBuffer(defaultAllocateNoBufferPoolBuffer),
-          multishotRecv(true) {}
+          multishotRecv(true),
+          zeroCopyThreshold(0) {}
 
     static std::unique_ptr<IOBuf> defaultAllocateNoBufferPoolBuffer();
     folly::Function<std::unique_ptr<IOBuf>()> allocateNoBufferPoolBuffer;
     folly::Optional<AsyncWriter::ZeroCopyEnableFunc> zeroCopyEnable;
     bool multishotRecv;
+    // Writes of fewer bytes than this are copied even if zeroCopyEnable
+    // accepts them: pinning the pages and waiting for the notification cost
+    // more than copying a small buffer.
+    size_t zeroCopyThreshold;
   };
 
   using UniquePtr = std::unique_ptr<AsyncIoUringSocket, Destructor>;
@@ -344,6 +349,10 @@ class AsyncIoUringSocket : public AsyncSocketTransport {
     std::unique_ptr<IOBuf> tmpBuffer_;
     bool supportsMultishotRecv_ =
         false; // todo: this can be per process instead of per socket
+    // Set while waiting for the socket to become readable because the
+    // provided buffers ran out, and once it did, until the next read.
+    bool pollingForData_{false};
+    bool socketReadable_{false};
 
     folly::Optional<folly::SemiFuture<std::unique_ptr<IOBuf>>>
         oldEventBaseRead_;
@@ -1105,6 +1105,17 @@ void IoUringBackend::initSubmissionLinked() {
       throw NotAvailable(ex.what());
     }
   }
+
+  if (options_.registeredBuffersCount) {
+    try {
+      registeredBuffers_.reset(new IoUringRegisteredBuffers(
+          this->ioRingPtr(),
+          options_.registeredBuffersCount,
+          options_.registeredBuffersEachSize));
+    } catch (const IoUringRegisteredBuffers::LibUringCallError& ex) {
+      throw NotAvailable(ex.what());
+    }
+  }
 }
 
 void IoUringBackend::delayedInit() {
@@ -1714,6 +1725,9 @@ void IoUringBackend::queueRead(
   };
   auto* ioSqe = new ReadIoSqe(this, fd, &iov, offset, std::move(cb));
   ioSqe->backendCb_ = processFileOpCB;
+  if (registeredBuffers_) {
+    ioSqe->bufIndex_ = registeredBuffers_->bufferIndex(buf, nbytes);
+  }
 
   submitImmediateIoSqe(*ioSqe);
 }
@@ -1729,6 +1743,9 @@ void IoUringBackend::queueWrite(
   };
   auto* ioSqe = new WriteIoSqe(this, fd, &iov, offset, std::move(cb));
   ioSqe->backendCb_ = processFileOpCB;
+  if (registeredBuffers_) {
+    ioSqe->bufIndex_ = registeredBuffers_->bufferIndex(buf, nbytes);
+  }
 
   submitImmediateIoSqe(*ioSqe);
 }
@@ -35,6 +35,7 @@
 #include <folly/Function.h>
 #include <folly/Range.h>
 #include <folly/experimental/io/IoUringBase.h>
+#include <folly/experimental/io/IoUringRegisteredBuffers.h>
 #include <folly/experimental/io/Liburing.h>
 #include <folly/io/IOBuf.h>
 #include <folly/io/async/EventBaseBackendBase.h>
@@ -151,12 +152,31 @@ class IoUringBackend : public EventBaseBackendBase {
       return *this;
     }
 
+    // Enables POLL_SQ, sharing numThreads SQ poll threads between all the
+    // backends with the same group name, e.g. those of an IO thread pool.
+    // The threads can be placed on dedicated cores with setSQCpus().
+    Options& setSQPollGroup(const std::string& name, size_t numThreads = 1) {
+      flags |= Flags::POLL_SQ;
+      sqGroupName = name;
+      sqGroupNumThreads = numThreads;
+
+      return *this;
+    }
+
     Options& setInitialProvidedBuffers(size_t eachSize, size_t count) {
       initialProvidedBuffersCount = count;
       initialProvidedBuffersEachSize = eachSize;
       return *this;
     }
 
+    // Registers count buffers of (at least) eachSize bytes with the ring,
+    // see allocRegisteredBuffer().
+    Options& setRegisteredBuffers(size_t eachSize, size_t count) {
+      registeredBuffersCount = count;
+      registeredBuffersEachSize = eachSize;
+      return *this;
+    }
+
     Options& setRegisterRingFd(bool v) {
       registerRingFd = v;
 
@@ -197,6 +217,8 @@ class IoUringBackend : public EventBaseBackendBase {
     size_t sqGroupNumThreads{1};
     size_t initialProvidedBuffersCount{0};
     size_t initialProvidedBuffersEachSize{0};
+    size_t registeredBuffersCount{0};
+    size_t registeredBuffersEachSize{0};
 
     uint32_t flags{0};
 
@@ -273,6 +295,18 @@ class IoUringBackend : public EventBaseBackendBase {
     cqPollLoopCallback_ = std::move(cb);
   }
 
+  // Returns an empty buffer from the pool of registered buffers, or nullptr
+  // if there is no such pool or all its buffers are in use. queueRead() and
+  // queueWrite() use IORING_OP_READ_FIXED / IORING_OP_WRITE_FIXED for
+  // buffers in the pool, which saves pinning their pages for every I/O.
+  std::unique_ptr<IOBuf> allocRegisteredBuffer() noexcept {
+    return registeredBuffers_ ? registeredBuffers_->allocate() : nullptr;
+  }
+
+  IoUringRegisteredBuffers* registeredBuffers() {
+    return registeredBuffers_.get();
+  }
+
   // read/write/fsync/fdatasync file operation callback
   // int param is the io_uring_cqe res field
   // i.e. the result of the file operation
@@ -793,13 +827,26 @@ class IoUringBackend : public EventBaseBackendBase {
     static constexpr size_t kNumInlineIoVec = 4;
     folly::small_vector<struct iovec> iov_;
     off_t offset_;
+    // index of the registered buffer that iov_[0] lies within, if any
+    int bufIndex_{-1};
   };
 
   struct ReadIoSqe : public ReadWriteIoSqe {
     using ReadWriteIoSqe::ReadWriteIoSqe;
 
     void processSubmit(struct io_uring_sqe* sqe) noexcept override {
-      prepRead(sqe, fd_, iov_.data(), offset_, false);
+      if (bufIndex_ >= 0) {
+        ::io_uring_prep_read_fixed(
+            sqe,
+            fd_,
+            iov_[0].iov_base,
+            (unsigned int)iov_[0].iov_len,
+            offset_,
+            bufIndex_);
+        ::io_uring_sqe_set_data(sqe, this);
+      } else {
+        prepRead(sqe, fd_, iov_.data(), offset_, false);
+      }
     }
   };
 
@@ -807,7 +854,18 @@ class IoUringBackend : public EventBaseBackendBase {
     using ReadWriteIoSqe::ReadWriteIoSqe;
 
     void processSubmit(struct io_uring_sqe* sqe) noexcept override {
-      prepWrite(sqe, fd_, iov_.data(), offset_, false);
+      if (bufIndex_ >= 0) {
+        ::io_uring_prep_write_fixed(
+            sqe,
+            fd_,
+            iov_[0].iov_base,
+            (unsigned int)iov_[0].iov_len,
+            offset_,
+            bufIndex_);
+        ::io_uring_sqe_set_data(sqe, this);
+      } else {
+        prepWrite(sqe, fd_, iov_.data(), offset_, false);
+      }
     }
   };
 
@@ -1054,6 +1112,7 @@ class IoUringBackend : public EventBaseBackendBase {
   IoSqeBaseList submitList_;
   uint16_t bufferProviderGidNext_{0};
   IoUringBufferProviderBase::UniquePtr bufferProvider_;
+  IoUringRegisteredBuffers::UniquePtr registeredBuffers_;
 
   // loop related
   bool loopBreak_{false};
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/experimental/io/IoUringNetOpsDispatcher.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include <folly/String.h>
+#include <folly/small_vector.h>
+
+#if FOLLY_HAS_LIBURING
+
+namespace folly {
+
+IoUringNetOpsDispatcher::IoUringNetOpsDispatcher(unsigned entries)
+    : entries_(std::max(entries, 1u)) {
+  int ret = ::io_uring_queue_init(entries_, &ring_, 0);
+  if (ret < 0) {
+    throw LibUringCallError("io_uring_queue_init failed: " + errnoStr(-ret));
+  }
+}
+
+IoUringNetOpsDispatcher::~IoUringNetOpsDispatcher() {
+  ::io_uring_queue_exit(&ring_);
+}
+
+int IoUringNetOpsDispatcher::sendmmsg(
+    NetworkSocket socket, mmsghdr* msgvec, unsigned int vlen, int flags) {
+  return submitMmsg(socket, msgvec, vlen, flags, Kind::Send);
+}
+
+int IoUringNetOpsDispatcher::recvmmsg(
+    NetworkSocket s,
+    mmsghdr* msgvec,
+    unsigned int vlen,
+    unsigned int flags,
+    timespec* /* timeout */) {
+  // MSG_WAITFORONE only makes sense to recvmmsg() itself, and the timeout
+  // can't expire since no message waits.
+  return submitMmsg(
+      s, msgvec, vlen, int(flags & ~unsigned(MSG_WAITFORONE)), Kind::Recv);
+}
+
+void IoUringNetOpsDispatcher::sendmsgBatch(MsgOp* ops, size_t count) {
+  submit(ops, count, Kind::Send, false);
+}
+
+void IoUringNetOpsDispatcher::recvmsgBatch(MsgOp* ops, size_t count) {
+  submit(ops, count, Kind::Recv, false);
+}
+
+int IoUringNetOpsDispatcher::submitMmsg(
+    NetworkSocket socket,
+    mmsghdr* msgvec,
+    unsigned int vlen,
+    int flags,
+    Kind kind) {
+  small_vector<MsgOp, 16> ops(vlen);
+  for (unsigned int i = 0; i < vlen; ++i) {
+    ops[i].socket = socket;
+    ops[i].message = &msgvec[i].msg_hdr;
+    ops[i].flags = flags;
+  }
+  submit(ops.data(), ops.size(), kind, true);
+
+  // Like the system calls, report the messages done up to the first
+  // failure, or the failure if there are none.
+  unsigned int done = 0;
+  for (; done < vlen && ops[done].result >= 0; ++done) {
+    msgvec[done].msg_len = static_cast<unsigned int>(ops[done].result);
+  }
+  if (done == 0 && vlen > 0) {
+    errno = ops[0].error;
+    return -1;
+  }
+  return int(done);
+}
+
+void IoUringNetOpsDispatcher::submit(
+    MsgOp* ops, size_t count, Kind kind, bool linked) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool cancelled = false;
+  while (count > 0) {
+    size_t n = std::min<size_t>(count, entries_);
+    if (cancelled) {
+      for (size_t i = 0; i < n; ++i) {
+        ops[i].result = -1;
+        ops[i].error = ECANCELED;
+      }
+      ops += n;
+      count -= n;
+      continue;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      auto& op = ops[i];
+      // The ring is empty between rounds, so there is always an entry.
+      auto* sqe = ::io_uring_get_sqe(&ring_);
+      int fd = op.socket.toFd();
+      if (kind == Kind::Send) {
+        ::io_uring_prep_sendmsg(sqe, fd, op.message, op.flags | MSG_DONTWAIT);
+      } else {
+        ::io_uring_prep_recvmsg(sqe, fd, op.message, op.flags | MSG_DONTWAIT);
+      }
+      if (linked && i + 1 < n) {
+        sqe->flags |= IOSQE_IO_LINK;
+      }
+      ::io_uring_sqe_set_data(sqe, &op);
+    }
+
+    size_t submitted = 0;
+    while (submitted < n) {
+      int ret = ::io_uring_submit_and_wait(&ring_, unsigned(n - submitted));
+      if (ret == -EINTR || ret == -EAGAIN) {
+        continue;
+      }
+      if (ret < 0) {
+        throw LibUringCallError(
+            "io_uring_submit_and_wait failed: " + errnoStr(-ret));
+      }
+      submitted += size_t(ret);
+    }
+
+    size_t reaped = 0;
+    while (reaped < n) {
+      io_uring_cqe* cqe = nullptr;
+      int ret = ::io_uring_wait_cqe(&ring_, &cqe);
+      if (ret == -EINTR || ret == -EAGAIN) {
+        continue;
+      }
+      if (ret < 0) {
+        throw LibUringCallError("io_uring_wait_cqe failed: " + errnoStr(-ret));
+      }
+      unsigned head;
+      unsigned seen = 0;
+      io_uring_for_each_cqe(&ring_, head, cqe) {
+        auto& op = *static_cast<MsgOp*>(::io_uring_cqe_get_data(cqe));
+        op.result = cqe->res < 0 ? -1 : cqe->res;
+        op.error = cqe->res < 0 ? -cqe->res : 0;
+        cancelled = cancelled || (linked && cqe->res < 0);
+        ++seen;
+      }
+      ::io_uring_cq_advance(&ring_, seen);
+      reaped += seen;
+    }
+
+    ops += n;
+    count -= n;
+  }
+}
+
+} // namespace folly
+
+#endif
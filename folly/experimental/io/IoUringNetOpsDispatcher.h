@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+
+#include <folly/experimental/io/Liburing.h>
+#include <folly/net/NetOpsDispatcher.h>
+
+#if FOLLY_HAS_LIBURING
+
+#include <liburing.h> // @manual
+
+namespace folly {
+
+/**
+ * A netops::Dispatcher that submits batches of messages to an io_uring, so
+ * that a batch costs a single io_uring_enter() whatever its size and however
+ * many sockets it spans: sendmsgBatch() and recvmsgBatch() submit one
+ * IORING_OP_SENDMSG or IORING_OP_RECVMSG per op, and sendmmsg() and
+ * recvmmsg() one per message. The other calls go to the default
+ * implementation.
+ *
+ * Every message is sent or received with MSG_DONTWAIT, so that it completes
+ * or fails with EAGAIN during the submission, as the system calls do on a
+ * non-blocking socket, instead of being deferred until the socket is ready.
+ * The messages of sendmmsg() and recvmmsg() are linked, so that the ones
+ * after a failure are not performed, as with the system calls.
+ *
+ * The dispatcher can be shared by sockets on different threads, batches are
+ * serialized on its ring.
+ *
+ * Example:
+ *   auto dispatcher = std::make_shared<IoUringNetOpsDispatcher>();
+ *   udpSocket.setOverrideNetOpsDispatcher(dispatcher);
+ */
+class IoUringNetOpsDispatcher : public netops::Dispatcher {
+ public:
+  class LibUringCallError : public std::runtime_error {
+   public:
+    using std::runtime_error::runtime_error;
+  };
+
+  /**
+   * Creates a ring with room for `entries` messages; larger batches are
+   * submitted in several rounds.
+   *
+   * @throws LibUringCallError if the ring can't be created.
+   */
+  explicit IoUringNetOpsDispatcher(unsigned entries = 256);
+  ~IoUringNetOpsDispatcher() override;
+
+  IoUringNetOpsDispatcher(const IoUringNetOpsDispatcher&) = delete;
+  IoUringNetOpsDispatcher& operator=(const IoUringNetOpsDispatcher&) = delete;
+
+  int sendmmsg(
+      NetworkSocket socket,
+      mmsghdr* msgvec,
+      unsigned int vlen,
+      int flags) override;
+  int recvmmsg(
+      NetworkSocket s,
+      mmsghdr* msgvec,
+      unsigned int vlen,
+      unsigned int flags,
+      timespec* timeout) override;
+
+  void sendmsgBatch(MsgOp* ops, size_t count) override;
+  void recvmsgBatch(MsgOp* ops, size_t count) override;
+
+ private:
+  enum class Kind { Send, Recv };
+
+  // Performs the ops, a ring-full at a time. If `linked`, an op failing
+  // cancels the following ones, which then fail with ECANCELED.
+  void submit(MsgOp* ops, size_t count, Kind kind, bool linked);
+
+  // sendmmsg() and recvmmsg() on top of submit().
+  int submitMmsg(
+      NetworkSocket socket,
+      mmsghdr* msgvec,
+      unsigned int vlen,
+      int flags,
+      Kind kind);
+
+  const unsigned entries_;
+  std::mutex mutex_;
+  io_uring ring_;
+};
+
+} // namespace folly
+
+#endif
@@ -16,6 +16,8 @@
 
 #include <folly/experimental/io/IoUringProvidedBufferRing.h>
 
+#include <thread>
+
 #include <folly/Conv.h>
 #include <folly/ExceptionString.h>
 #include <folly/String.h>
@@ -212,9 +214,14 @@ void IoUringProvidedBufferRing::returnBuffer(uint16_t i) noexcept {
   r->len = buffer_.sizePerBuffer();
   r->bid = i;
 
-  if (tryPublish(this_idx, next_tail)) {
-    enobuf_.store(false, std::memory_order_relaxed);
+  // Buffers can be freed on any thread. The kernel only looks at the
+  // entries before the tail, so this one can only be published once all the
+  // ones before it have been: wait for their (short) turn rather than give
+  // up, otherwise this entry, and every later one, would never be published.
+  while (!tryPublish(this_idx, next_tail)) {
+    std::this_thread::yield();
   }
+  enobuf_.store(false, std::memory_order_relaxed);
   VLOG(9) << "returnBuffer(" << i << ")@" << this_idx;
 }
 
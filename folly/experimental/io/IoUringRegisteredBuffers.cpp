@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/experimental/io/IoUringRegisteredBuffers.h>
+
+#include <sys/uio.h>
+
+#include <algorithm>
+
+#include <folly/Conv.h>
+#include <folly/String.h>
+#include <folly/portability/SysMman.h>
+#include <folly/portability/Unistd.h>
+
+#if FOLLY_HAS_LIBURING
+
+namespace folly {
+
+namespace {
+
+// IORING_MAX_REG_BUFFERS in the kernel.
+constexpr size_t kMaxBuffers = 1 << 14;
+
+size_t roundUpToPage(size_t size) {
+  static const auto pagesize = size_t(sysconf(_SC_PAGESIZE));
+  return (std::max<size_t>(size, 1) + pagesize - 1) / pagesize * pagesize;
+}
+
+} // namespace
+
+IoUringRegisteredBuffers::IoUringRegisteredBuffers(
+    io_uring* ioRingPtr, size_t count, size_t sizePerBuffer)
+    : count_(count),
+      sizePerBuffer_(roundUpToPage(sizePerBuffer)),
+      allSize_(count_ * sizePerBuffer_) {
+  if (count_ == 0 || count_ > kMaxBuffers) {
+    throw std::runtime_error(folly::to<std::string>(
+        "invalid number of registered buffers: ", count_));
+  }
+
+  void* p = ::mmap(
+      nullptr,
+      allSize_,
+      PROT_READ | PROT_WRITE,
+      MAP_ANONYMOUS | MAP_PRIVATE,
+      -1,
+      0);
+  if (p == MAP_FAILED) {
+    auto errnoCopy = errno;
+    throw std::runtime_error(folly::to<std::string>(
+        "unable to allocate registered buffers of size ",
+        allSize_,
+        ": ",
+        folly::errnoStr(errnoCopy)));
+  }
+  buffer_ = static_cast<char*>(p);
+
+  std::vector<struct iovec> iovs(count_);
+  for (size_t i = 0; i < count_; ++i) {
+    iovs[i].iov_base = buffer_ + i * sizePerBuffer_;
+    iovs[i].iov_len = sizePerBuffer_;
+  }
+  int ret = ::io_uring_register_buffers(ioRingPtr, iovs.data(), count_);
+  if (ret) {
+    ::munmap(buffer_, allSize_);
+    throw LibUringCallError(folly::to<std::string>(
+        "unable to register buffers ", -ret, ": ", folly::errnoStr(-ret)));
+  }
+
+  // Hand out the first buffers first.
+  free_.reserve(count_);
+  for (size_t i = count_; i > 0; --i) {
+    free_.push_back(static_cast<uint32_t>(i - 1));
+  }
+}
+
+IoUringRegisteredBuffers::~IoUringRegisteredBuffers() {
+  ::munmap(buffer_, allSize_);
+}
+
+std::unique_ptr<IOBuf> IoUringRegisteredBuffers::allocate() noexcept {
+  uint32_t index;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (free_.empty()) {
+      return nullptr;
+    }
+    index = free_.back();
+    free_.pop_back();
+  }
+  refs_.fetch_add(1, std::memory_order_relaxed);
+
+  auto freeFn = [](void* buffer, void* userData) {
+    static_cast<IoUringRegisteredBuffers*>(userData)->release(buffer);
+  };
+  try {
+    return IOBuf::takeOwnership(
+        buffer_ + size_t(index) * sizePerBuffer_,
+        sizePerBuffer_,
+        0,
+        freeFn,
+        this);
+  } catch (const std::bad_alloc&) {
+    // freeFn has already given the buffer back.
+    return nullptr;
+  }
+}
+
+size_t IoUringRegisteredBuffers::available() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return free_.size();
+}
+
+void IoUringRegisteredBuffers::release(void* buffer) noexcept {
+  auto index = static_cast<uint32_t>(
+      (static_cast<char*>(buffer) - buffer_) / sizePerBuffer_);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    free_.push_back(index);
+  }
+  decRef();
+}
+
+void IoUringRegisteredBuffers::destroy() noexcept {
+  // The buffers are unregistered when the ring goes away; the memory itself
+  // has to outlive the IOBufs that still use it.
+  decRef();
+}
+
+void IoUringRegisteredBuffers::decRef() noexcept {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+} // namespace folly
+
+#endif
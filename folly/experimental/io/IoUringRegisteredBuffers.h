@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <folly/experimental/io/Liburing.h>
+#include <folly/io/IOBuf.h>
+
+#if FOLLY_HAS_LIBURING
+
+#include <liburing.h> // @manual
+
+namespace folly {
+
+/**
+ * A pool of fixed size buffers registered with an io_uring through
+ * io_uring_register_buffers(). The kernel pins their pages once, at
+ * registration, instead of on every read or write: reads and writes into
+ * them can use IORING_OP_READ_FIXED and IORING_OP_WRITE_FIXED.
+ *
+ * Buffers are handed out as IOBufs, and go back to the pool when these are
+ * freed, which can happen on any thread. Their memory stays valid until the
+ * last one is freed, even if the pool (and its ring) was destroyed by then.
+ */
+class IoUringRegisteredBuffers {
+ public:
+  class LibUringCallError : public std::runtime_error {
+   public:
+    using std::runtime_error::runtime_error;
+  };
+
+  struct Deleter {
+    void operator()(IoUringRegisteredBuffers* buffers) {
+      if (buffers) {
+        buffers->destroy();
+      }
+    }
+  };
+
+  using UniquePtr = std::unique_ptr<IoUringRegisteredBuffers, Deleter>;
+
+  // sizePerBuffer is rounded up to a multiple of the page size, so that the
+  // buffers can be used for O_DIRECT I/O. The kernel registers at most 16384
+  // buffers per ring.
+  IoUringRegisteredBuffers(
+      io_uring* ioRingPtr, size_t count, size_t sizePerBuffer);
+
+  IoUringRegisteredBuffers(IoUringRegisteredBuffers const&) = delete;
+  IoUringRegisteredBuffers& operator=(IoUringRegisteredBuffers const&) = delete;
+
+  /// Returns an empty IOBuf with a capacity of sizePerBuffer(), or nullptr
+  /// if all the buffers are in use or the IOBuf could not be allocated.
+  std::unique_ptr<IOBuf> allocate() noexcept;
+
+  /// The index of the registered buffer that [data, data + length) lies
+  /// within, to pass to the *_fixed operations, or -1 if there is none.
+  int bufferIndex(const void* data, size_t length) const noexcept {
+    auto p = reinterpret_cast<uintptr_t>(data);
+    auto base = reinterpret_cast<uintptr_t>(buffer_);
+    if (p < base || p - base >= count_ * sizePerBuffer_) {
+      return -1;
+    }
+    size_t index = (p - base) / sizePerBuffer_;
+    size_t offset = (p - base) % sizePerBuffer_;
+    return length <= sizePerBuffer_ - offset ? int(index) : -1;
+  }
+
+  size_t count() const noexcept { return count_; }
+  size_t sizePerBuffer() const noexcept { return sizePerBuffer_; }
+
+  /// Number of buffers that are not in use.
+  size_t available() const;
+
+ private:
+  ~IoUringRegisteredBuffers();
+
+  void destroy() noexcept;
+  void release(void* buffer) noexcept;
+  void decRef() noexcept;
+
+  char* buffer_;
+  size_t const count_;
+  size_t const sizePerBuffer_;
+  size_t const allSize_;
+
+  mutable std::mutex mutex_;
+  std::vector<uint32_t> free_;
+
+  // One for the pool itself, and one for each buffer in use.
+  std::atomic<size_t> refs_{1};
+};
+
+} // namespace folly
+
+#endif
@@ -38,7 +38,11 @@ ThrottledLifoSem::Options throttledLifoSemOptions(
 } // namespace
 
 struct MuxIOThreadPoolExecutor::EvbState {
-  EvbState() : evb(evbOptions()) {}
+  explicit EvbState(const EventBase::Options::BackendFactory& backendFactory)
+      : evb(
+            backendFactory
+                ? EventBase::Options{}.setBackendFactory(backendFactory)
+                : evbOptions()) {}
 
   EventBase evb;
   std::unique_ptr<EventBasePoller::Handle> handle;
@@ -82,7 +86,8 @@ MuxIOThreadPoolExecutor::MuxIOThreadPoolExecutor(
   evbStates_.reserve(numEventBases_);
   Latch allEvbsRunning(numEventBases_);
   for (size_t i = 0; i < numEventBases_; ++i) {
-    auto& evbState = evbStates_.emplace_back(std::make_unique<EvbState>());
+    auto& evbState = evbStates_.emplace_back(
+        std::make_unique<EvbState>(options_.backendFactory));
     evbState->evb.setStrictLoopThread();
     evbState->evb.runInEventBaseThread([&] { allEvbsRunning.count_down(); });
     // Keep the loop running until shutdown.
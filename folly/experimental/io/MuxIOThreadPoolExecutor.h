@@ -82,12 +82,22 @@ class MuxIOThreadPoolExecutor : public IOThreadPoolExecutorBase {
       return *this;
     }
 
+    // Creates the backends of the EventBases, by default EpollBackends. The
+    // backend's pollable fd must be usable with epoll, e.g. IoUringBackend,
+    // possibly sharing an SQ poll thread: see
+    // IoUringBackend::Options::setSQPollGroup.
+    Options& setBackendFactory(EventBase::Options::BackendFactory f) {
+      backendFactory = std::move(f);
+      return *this;
+    }
+
     bool enableThreadIdCollection{false};
     // If 0, the number of EventBases is set to the number of threads.
     size_t numEventBases{0};
     std::chrono::nanoseconds wakeUpInterval{std::chrono::microseconds{100}};
     // Max spin for an idle thread waiting for work before going to sleep.
     std::chrono::nanoseconds idleSpinMax = std::chrono::microseconds{10};
+    EventBase::Options::BackendFactory backendFactory;
   };
 
   explicit MuxIOThreadPoolExecutor(
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/experimental/io/AsyncFileReader.h>
+
+#include <folly/File.h>
+#include <folly/FileUtil.h>
+#include <folly/Random.h>
+#include <folly/experimental/coro/BlockingWait.h>
+#include <folly/io/IOBuf.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Baton.h>
+
+using namespace folly;
+
+namespace {
+
+class AsyncFileReaderTest
+    : public ::testing::TestWithParam<SimpleAsyncIO::Mode> {
+ public:
+  void SetUp() override {
+    config_.setMode(GetParam());
+    content_.resize(kFileSize);
+    for (auto& c : content_) {
+      c = char(folly::Random::rand32());
+    }
+    ASSERT_EQ(
+        writeFull(tmpfile_.fd(), content_.data(), content_.size()),
+        content_.size());
+  }
+
+  static std::string testTypeToString(
+      testing::TestParamInfo<SimpleAsyncIO::Mode> const& setting) {
+    switch (setting.param) {
+      case SimpleAsyncIO::Mode::AIO:
+        return "aio";
+      case SimpleAsyncIO::Mode::IOURING:
+        return "iouring";
+    }
+  }
+
+ protected:
+  // Not a multiple of the chunk size, so the last chunk is short.
+  static constexpr size_t kFileSize = 100 * 1000 + 123;
+  static constexpr size_t kChunkSize = 4096;
+
+  SimpleAsyncIO::Config config_;
+  File tmpfile_{File::temporary()};
+  std::string content_;
+};
+
+class ChunkCallback : public AsyncFileReader::Callback {
+ public:
+  void onChunk(std::unique_ptr<IOBuf> chunk) noexcept override {
+    EXPECT_FALSE(finished);
+    sizes.push_back(chunk->length());
+    data.append(chunk->moveToFbString().toStdString());
+  }
+
+  void onEOF() noexcept override {
+    finished = true;
+    done.post();
+  }
+
+  void onError(const std::system_error& ex) noexcept override {
+    ADD_FAILURE() << ex.what();
+    finished = true;
+    done.post();
+  }
+
+  std::vector<size_t> sizes;
+  std::string data;
+  bool finished{false};
+  Baton<> done;
+};
+
+} // namespace
+
+TEST_P(AsyncFileReaderTest, ReadInOrder) {
+  SimpleAsyncIO aio(config_);
+  AsyncFileReader reader(
+      aio,
+      tmpfile_.fd(),
+      AsyncFileReader::Config().setChunkSize(kChunkSize).setReadahead(8));
+  ChunkCallback cb;
+  reader.start(&cb);
+  ASSERT_TRUE(cb.done.try_wait_for(std::chrono::seconds(10)));
+
+  EXPECT_EQ(cb.data, content_);
+  ASSERT_EQ(cb.sizes.size(), (kFileSize + kChunkSize - 1) / kChunkSize);
+  EXPECT_EQ(cb.sizes.front(), kChunkSize);
+  EXPECT_EQ(cb.sizes.back(), kFileSize % kChunkSize);
+}
+
+TEST_P(AsyncFileReaderTest, ReadRange) {
+  SimpleAsyncIO aio(config_);
+  AsyncFileReader reader(
+      aio,
+      tmpfile_.fd(),
+      AsyncFileReader::Config()
+          .setChunkSize(kChunkSize)
+          .setOffset(kChunkSize)
+          .setLength(3 * kChunkSize + 10));
+  ChunkCallback cb;
+  reader.start(&cb);
+  ASSERT_TRUE(cb.done.try_wait_for(std::chrono::seconds(10)));
+
+  EXPECT_EQ(cb.data, content_.substr(kChunkSize, 3 * kChunkSize + 10));
+  EXPECT_EQ(cb.sizes.size(), 4);
+}
+
+TEST_P(AsyncFileReaderTest, EmptyRange) {
+  SimpleAsyncIO aio(config_);
+  AsyncFileReader reader(
+      aio, tmpfile_.fd(), AsyncFileReader::Config().setOffset(kFileSize));
+  ChunkCallback cb;
+  reader.start(&cb);
+  ASSERT_TRUE(cb.done.try_wait_for(std::chrono::seconds(10)));
+  EXPECT_TRUE(cb.data.empty());
+}
+
+#if FOLLY_HAS_COROUTINES
+TEST_P(AsyncFileReaderTest, CoroutineRead) {
+  SimpleAsyncIO aio(config_);
+  AsyncFileReader reader(
+      aio,
+      tmpfile_.fd(),
+      AsyncFileReader::Config().setChunkSize(kChunkSize).setReadahead(4));
+  std::string data = folly::coro::blockingWait(
+      [&]() -> folly::coro::Task<std::string> {
+        std::string result;
+        auto chunks = reader.read();
+        while (auto chunk = co_await chunks.next()) {
+          result.append((*chunk)->moveToFbString().toStdString());
+        }
+        co_return result;
+      }());
+  EXPECT_EQ(data, content_);
+}
+#endif // FOLLY_HAS_COROUTINES
+
+INSTANTIATE_TEST_SUITE_P(
+    AsyncFileReaderTests,
+    AsyncFileReaderTest,
+    ::testing::Values(
+        SimpleAsyncIO::Mode::AIO /*, SimpleAsyncIO::Mode::IOURING */),
+    AsyncFileReaderTest::testTypeToString);
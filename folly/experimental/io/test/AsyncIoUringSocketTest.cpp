@@ -647,6 +647,21 @@ TEST_P(AsyncIoUringSocketTest, FastOpen) {
   }
 }
 
+TEST_P(AsyncIoUringSocketTest, ZeroCopyThreshold) {
+  MAYBE_SKIP();
+  AsyncIoUringSocket::Options options;
+  options.zeroCopyEnable = [](auto&&) { return true; };
+  options.zeroCopyThreshold = 1000;
+  AsyncIoUringSocket::UniquePtr socket(
+      new AsyncIoUringSocket(base.get(), std::move(options)));
+  EXPECT_FALSE(socket->canZC(IOBuf::copyBuffer(std::string(999, 'a'))));
+  auto chain = IOBuf::copyBuffer(std::string(500, 'a'));
+  chain->appendToChain(IOBuf::copyBuffer(std::string(500, 'b')));
+  EXPECT_TRUE(socket->canZC(chain));
+  socket->setZeroCopy(false);
+  EXPECT_FALSE(socket->canZC(chain));
+}
+
 class AsyncIoUringSocketTestAll : public AsyncIoUringSocketTest {};
 
 TEST_P(AsyncIoUringSocketTestAll, WriteChain2) {
@@ -0,0 +1,646 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// End-to-end loopback echo benchmark of the IO layer: clients on their own
+// IO threads send fixed size messages to an echo server and wait for them to
+// come back. Every combination of the flags below is a benchmark; one
+// iteration is one request, so iters/s is the number of requests per second
+// over all connections, and the p50_ns..max_ns counters are the latencies of
+// single requests, from writing them to reading their last byte.
+//
+// In the rr mode each connection has a single request in flight; in the
+// pipeline mode it keeps --echo_pipeline_depth of them in flight, which
+// measures throughput rather than round trips.
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <folly/Benchmark.h>
+#include <folly/Conv.h>
+#include <folly/SocketAddress.h>
+#include <folly/String.h>
+#include <folly/chrono/Hardware.h>
+#include <folly/experimental/coro/BlockingWait.h>
+#include <folly/experimental/coro/Task.h>
+#include <folly/experimental/io/AsyncIoUringSocket.h>
+#include <folly/experimental/io/EpollBackend.h>
+#include <folly/experimental/io/IoUringBackend.h>
+#include <folly/futures/Future.h>
+#include <folly/init/Init.h>
+#include <folly/io/async/AsyncServerSocket.h>
+#include <folly/io/async/AsyncSocket.h>
+#include <folly/io/async/ScopedEventBaseThread.h>
+#include <folly/io/coro/Transport.h>
+#include <folly/net/NetOps.h>
+#include <folly/portability/GFlags.h>
+#include <folly/portability/Sockets.h>
+#include <folly/synchronization/Baton.h>
+#include <folly/synchronization/Latch.h>
+
+DEFINE_string(
+    echo_backends, "epoll,io_uring", "EventBase backends: epoll, io_uring");
+DEFINE_string(
+    echo_transports,
+    "async_socket,io_uring_socket,coro",
+    "Transports: async_socket, io_uring_socket (io_uring backend only), and "
+    "coro (folly::coro::Transport over AsyncSocket)");
+DEFINE_string(echo_modes, "rr,pipeline", "Modes: rr, pipeline");
+DEFINE_int32(
+    echo_pipeline_depth,
+    16,
+    "Requests in flight on each connection in the pipeline mode");
+DEFINE_string(echo_connections, "1,16,64", "Numbers of connections");
+DEFINE_string(echo_message_sizes, "64,4096", "Message sizes in bytes");
+DEFINE_string(
+    echo_io_threads,
+    "1,4",
+    "Numbers of IO threads, each of the server and of the clients");
+
+using namespace folly;
+
+namespace {
+
+enum class Backend { Epoll, IoUring };
+enum class TransportType { AsyncSocket, IoUringSocket, Coro };
+
+struct EchoParams {
+  Backend backend;
+  TransportType transport;
+  size_t depth;
+  size_t connections;
+  size_t messageSize;
+  size_t ioThreads;
+};
+
+constexpr size_t kReadBufferSize = 64 * 1024;
+
+const SocketOptionMap& noDelay() {
+  static const SocketOptionMap options{
+      {SocketOptionKey{IPPROTO_TCP, TCP_NODELAY}, 1}};
+  return options;
+}
+
+EventBase::Options eventBaseOptions(Backend backend) {
+  if (backend == Backend::Epoll) {
+    EpollBackend::Options opts;
+    opts.setNumLoopEvents(256);
+    return EventBase::Options().setBackendFactory(
+        [opts] { return std::make_unique<EpollBackend>(opts); });
+  }
+#if FOLLY_HAS_LIBURING
+  IoUringBackend::Options opts;
+  opts.setCapacity(32 * 1024).setMaxSubmit(256);
+  // AsyncIoUringSocket reads into buffers provided to the kernel.
+  opts.setInitialProvidedBuffers(kReadBufferSize, 64);
+  return EventBase::Options().setBackendFactory(
+      [opts] { return std::make_unique<IoUringBackend>(opts); });
+#else
+  throw std::runtime_error("io_uring is not supported");
+#endif
+}
+
+bool backendAvailable(Backend backend) {
+  try {
+    EventBase evb(eventBaseOptions(backend));
+    return true;
+  } catch (const std::exception& ex) {
+    LOG(WARNING) << "Skipping unavailable backend: " << ex.what();
+    return false;
+  }
+}
+
+std::vector<std::unique_ptr<ScopedEventBaseThread>> makeThreads(
+    Backend backend, size_t n, StringPiece name) {
+  std::vector<std::unique_ptr<ScopedEventBaseThread>> threads;
+  for (size_t i = 0; i < n; ++i) {
+    threads.push_back(std::make_unique<ScopedEventBaseThread>(
+        eventBaseOptions(backend), nullptr, fmt::format("{}{}", name, i)));
+  }
+  return threads;
+}
+
+AsyncTransport::UniquePtr newTransport(
+    [[maybe_unused]] TransportType type, EventBase* evb, NetworkSocket fd) {
+#if FOLLY_HAS_LIBURING
+  if (type == TransportType::IoUringSocket) {
+    return AsyncTransport::UniquePtr(new AsyncIoUringSocket(evb, fd));
+  }
+#endif
+  return AsyncSocket::newSocket(evb, fd);
+}
+
+// Writes back whatever it reads until the peer closes.
+class EchoConnection : public AsyncTransport::ReadCallback,
+                       public AsyncTransport::WriteCallback {
+ public:
+  explicit EchoConnection(AsyncTransport::UniquePtr transport)
+      : transport_(std::move(transport)) {
+    transport_->setReadCB(this);
+  }
+
+  ~EchoConnection() override {
+    if (transport_->getReadCallback() == this) {
+      transport_->setReadCB(nullptr);
+    }
+  }
+
+  void getReadBuffer(void** bufReturn, size_t* lenReturn) override {
+    *bufReturn = buf_;
+    *lenReturn = sizeof(buf_);
+  }
+
+  void readDataAvailable(size_t len) noexcept override {
+    transport_->writeChain(this, IOBuf::copyBuffer(buf_, len));
+  }
+
+  void readEOF() noexcept override { transport_->setReadCB(nullptr); }
+
+  void readErr(const AsyncSocketException&) noexcept override {
+    transport_->setReadCB(nullptr);
+  }
+
+  void writeSuccess() noexcept override {}
+
+  void writeErr(size_t, const AsyncSocketException&) noexcept override {}
+
+ private:
+  AsyncTransport::UniquePtr transport_;
+  char buf_[kReadBufferSize];
+};
+
+#if FOLLY_HAS_COROUTINES
+coro::Task<void> echoLoop(std::unique_ptr<coro::Transport> transport) {
+  std::vector<uint8_t> buf(kReadBufferSize);
+  while (true) {
+    auto n = co_await transport->read(
+        MutableByteRange(buf.data(), buf.size()), std::chrono::seconds(0));
+    if (n == 0) {
+      break;
+    }
+    co_await transport->write(ByteRange(buf.data(), n));
+  }
+}
+#endif
+
+// Accepts on the first EventBase and spreads connections over all of them.
+class EchoServer {
+ public:
+  EchoServer(const std::vector<EventBase*>& evbs, TransportType type)
+      : type_(type) {
+    for (auto evb : evbs) {
+      acceptors_.push_back(std::make_unique<Acceptor>(this, evb));
+    }
+    auto evb = evbs.front();
+    evb->runInEventBaseThreadAndWait([&] {
+      socket_ = AsyncServerSocket::newSocket(evb);
+      socket_->bind(SocketAddress("127.0.0.1", 0));
+      for (auto& acceptor : acceptors_) {
+        socket_->addAcceptCallback(acceptor.get(), acceptor->evb);
+      }
+      socket_->listen(1024);
+      socket_->startAccepting();
+      address_ = socket_->getAddress();
+    });
+  }
+
+  // The clients must have closed their connections first.
+  ~EchoServer() {
+    socket_->getEventBase()->runInEventBaseThreadAndWait(
+        [&] { socket_.reset(); });
+    for (auto& acceptor : acceptors_) {
+      std::vector<SemiFuture<Unit>> loops;
+      acceptor->evb->runInEventBaseThreadAndWait([&] {
+        acceptor->connections.clear();
+        loops = std::move(acceptor->loops);
+      });
+      collectAll(std::move(loops)).get();
+    }
+  }
+
+  const SocketAddress& address() const { return address_; }
+
+ private:
+  struct Acceptor : AsyncServerSocket::AcceptCallback {
+    Acceptor(EchoServer* s, EventBase* e) : server(s), evb(e) {}
+
+    void connectionAccepted(
+        NetworkSocket fd, const SocketAddress&, AcceptInfo) noexcept override {
+      int one = 1;
+      netops::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#if FOLLY_HAS_COROUTINES
+      if (server->type_ == TransportType::Coro) {
+        loops.push_back(
+            echoLoop(std::make_unique<coro::Transport>(
+                         evb, AsyncSocket::newSocket(evb, fd)))
+                .scheduleOn(evb)
+                .start());
+        return;
+      }
+#endif
+      connections.push_back(std::make_unique<EchoConnection>(
+          newTransport(server->type_, evb, fd)));
+    }
+
+    void acceptError(exception_wrapper ew) noexcept override {
+      LOG(ERROR) << "Echo server accept failed: " << ew.what();
+    }
+
+    EchoServer* server;
+    EventBase* evb;
+    std::vector<std::unique_ptr<EchoConnection>> connections;
+    std::vector<SemiFuture<Unit>> loops;
+  };
+
+  TransportType type_;
+  std::vector<std::unique_ptr<Acceptor>> acceptors_;
+  std::shared_ptr<AsyncServerSocket> socket_;
+  SocketAddress address_;
+};
+
+// Keeps up to depth requests of messageSize bytes in flight and records the
+// latency of each in hardware_timestamp() ticks. Since the server echoes
+// the bytes in order, a request is answered once messageSize more bytes
+// have been read.
+class EchoClient {
+ public:
+  EchoClient(EventBase* evb, size_t messageSize, size_t depth)
+      : evb_(evb), message_(messageSize, 'x'), depth_(depth) {}
+
+  virtual ~EchoClient() = default;
+
+  // Blocks until the connection is established.
+  virtual void connect(const SocketAddress& address) = 0;
+
+  // Sends the requests on the client's EventBase, and counts down done once
+  // they have all been answered.
+  void start(size_t requests, Latch& done) {
+    latencies_.reserve(requests);
+    evb_->runInEventBaseThread([this, requests, &done] {
+      if (requests == 0) {
+        done.count_down();
+      } else {
+        run(requests, done);
+      }
+    });
+  }
+
+  // Blocks until the connection is closed.
+  virtual void close() = 0;
+
+  const std::vector<uint64_t>& latencies() const { return latencies_; }
+
+ protected:
+  virtual void run(size_t requests, Latch& done) = 0;
+
+  void onSend() { sendTicks_.push_back(hardware_timestamp()); }
+
+  // Returns the number of requests that len more bytes answered.
+  size_t onReceive(size_t len) {
+    size_t answered = 0;
+    pendingBytes_ += len;
+    auto const now = hardware_timestamp();
+    while (pendingBytes_ >= message_.size()) {
+      pendingBytes_ -= message_.size();
+      latencies_.push_back(now - sendTicks_.front());
+      sendTicks_.pop_front();
+      ++answered;
+    }
+    return answered;
+  }
+
+  EventBase* const evb_;
+  const std::string message_;
+  const size_t depth_;
+
+ private:
+  std::deque<uint64_t> sendTicks_;
+  size_t pendingBytes_{0};
+  std::vector<uint64_t> latencies_;
+};
+
+class CallbackEchoClient : public EchoClient,
+                           public AsyncSocket::ConnectCallback,
+                           public AsyncTransport::ReadCallback,
+                           public AsyncTransport::WriteCallback {
+ public:
+  CallbackEchoClient(
+      TransportType type, EventBase* evb, size_t messageSize, size_t depth)
+      : EchoClient(evb, messageSize, depth), type_(type) {}
+
+  void connect(const SocketAddress& address) override {
+    evb_->runInEventBaseThread([this, address] {
+#if FOLLY_HAS_LIBURING
+      if (type_ == TransportType::IoUringSocket) {
+        auto socket = new AsyncIoUringSocket(evb_);
+        transport_.reset(socket);
+        socket->connect(
+            this, address, std::chrono::milliseconds(0), noDelay());
+        return;
+      }
+#endif
+      // connectSuccess() may run before connect() returns.
+      auto socket = new AsyncSocket(evb_);
+      transport_.reset(socket);
+      socket->connect(this, address, 0, noDelay());
+    });
+    connected_.wait();
+  }
+
+  void close() override {
+    evb_->runInEventBaseThreadAndWait([&] {
+      transport_->setReadCB(nullptr);
+      transport_.reset();
+    });
+  }
+
+  void connectSuccess() noexcept override {
+    transport_->setReadCB(this);
+    connected_.post();
+  }
+
+  void connectErr(const AsyncSocketException& ex) noexcept override {
+    LOG(FATAL) << "Echo client connect failed: " << ex.what();
+  }
+
+  void getReadBuffer(void** bufReturn, size_t* lenReturn) override {
+    *bufReturn = buf_;
+    *lenReturn = sizeof(buf_);
+  }
+
+  void readDataAvailable(size_t len) noexcept override {
+    for (auto n = onReceive(len); n > 0; --n) {
+      if (sent_ < requests_) {
+        send();
+      }
+      if (++received_ == requests_) {
+        done_->count_down();
+      }
+    }
+  }
+
+  void readEOF() noexcept override {
+    LOG(FATAL) << "Echo server closed the connection";
+  }
+
+  void readErr(const AsyncSocketException& ex) noexcept override {
+    LOG(FATAL) << "Echo client read failed: " << ex.what();
+  }
+
+  void writeSuccess() noexcept override {}
+
+  void writeErr(size_t, const AsyncSocketException& ex) noexcept override {
+    LOG(FATAL) << "Echo client write failed: " << ex.what();
+  }
+
+ protected:
+  void run(size_t requests, Latch& done) override {
+    requests_ = requests;
+    sent_ = received_ = 0;
+    done_ = &done;
+    while (sent_ < std::min(depth_, requests_)) {
+      send();
+    }
+  }
+
+ private:
+  void send() {
+    onSend();
+    ++sent_;
+    transport_->write(this, message_.data(), message_.size());
+  }
+
+  TransportType type_;
+  AsyncTransport::UniquePtr transport_;
+  Baton<> connected_;
+  size_t requests_{0};
+  size_t sent_{0};
+  size_t received_{0};
+  Latch* done_{nullptr};
+  char buf_[kReadBufferSize];
+};
+
+#if FOLLY_HAS_COROUTINES
+class CoroEchoClient : public EchoClient {
+ public:
+  using EchoClient::EchoClient;
+
+  void connect(const SocketAddress& address) override {
+    transport_ = std::make_unique<coro::Transport>(coro::blockingWait(
+        coro::Transport::newConnectedSocket(
+            evb_, address, std::chrono::milliseconds(0), noDelay())
+            .scheduleOn(evb_)));
+  }
+
+  void close() override {
+    evb_->runInEventBaseThreadAndWait([&] { transport_.reset(); });
+  }
+
+ protected:
+  void run(size_t requests, Latch& done) override {
+    loop(requests).scheduleOn(evb_).start([&done](Try<Unit>&& result) {
+      if (result.hasException()) {
+        LOG(FATAL) << "Echo client failed: " << result.exception().what();
+      }
+      done.count_down();
+    });
+  }
+
+ private:
+  coro::Task<void> loop(size_t requests) {
+    std::vector<uint8_t> buf(kReadBufferSize);
+    auto const message = StringPiece(message_);
+    size_t sent = 0;
+    for (; sent < std::min(depth_, requests); ++sent) {
+      onSend();
+      co_await transport_->write(ByteRange(message));
+    }
+    for (size_t received = 0; received < requests;) {
+      auto n = co_await transport_->read(
+          MutableByteRange(buf.data(), buf.size()), std::chrono::seconds(0));
+      if (n == 0) {
+        LOG(FATAL) << "Echo server closed the connection";
+      }
+      for (auto answered = onReceive(n); answered > 0; --answered) {
+        ++received;
+        if (sent < requests) {
+          ++sent;
+          onSend();
+          co_await transport_->write(ByteRange(message));
+        }
+      }
+    }
+  }
+
+  std::unique_ptr<coro::Transport> transport_;
+};
+#endif
+
+std::unique_ptr<EchoClient> newClient(const EchoParams& p, EventBase* evb) {
+#if FOLLY_HAS_COROUTINES
+  if (p.transport == TransportType::Coro) {
+    return std::make_unique<CoroEchoClient>(evb, p.messageSize, p.depth);
+  }
+#endif
+  return std::make_unique<CallbackEchoClient>(
+      p.transport, evb, p.messageSize, p.depth);
+}
+
+void runEcho(UserCounters& counters, unsigned iters, const EchoParams& p) {
+  // Constructed before the suspender, which must not nest in its own.
+  BenchmarkLatencyRecorder latency(counters);
+  BenchmarkSuspender suspender;
+
+  auto serverThreads = makeThreads(p.backend, p.ioThreads, "EchoServer");
+  auto clientThreads = makeThreads(p.backend, p.ioThreads, "EchoClient");
+  std::vector<EventBase*> serverEvbs;
+  for (auto& thread : serverThreads) {
+    serverEvbs.push_back(thread->getEventBase());
+  }
+
+  EchoServer server(serverEvbs, p.transport);
+  std::vector<std::unique_ptr<EchoClient>> clients;
+  for (size_t i = 0; i < p.connections; ++i) {
+    auto evb = clientThreads[i % clientThreads.size()]->getEventBase();
+    clients.push_back(newClient(p, evb));
+    clients.back()->connect(server.address());
+  }
+
+  Latch done(static_cast<std::ptrdiff_t>(clients.size()));
+  suspender.dismissing([&] {
+    for (size_t i = 0; i < clients.size(); ++i) {
+      clients[i]->start(
+          iters / clients.size() + (i < iters % clients.size() ? 1 : 0),
+          done);
+    }
+    done.wait();
+  });
+
+  for (auto& client : clients) {
+    for (auto ticks : client->latencies()) {
+      latency.record(ticks);
+    }
+    client->close();
+  }
+}
+
+template <class T, class F>
+std::vector<T> parseList(StringPiece flag, F&& parse) {
+  std::vector<StringPiece> pieces;
+  split(',', flag, pieces, /* ignoreEmpty */ true);
+  std::vector<T> values;
+  for (auto piece : pieces) {
+    values.push_back(parse(trimWhitespace(piece)));
+  }
+  return values;
+}
+
+std::vector<size_t> parseSizes(StringPiece flag) {
+  return parseList<size_t>(flag, [](StringPiece s) { return to<size_t>(s); });
+}
+
+void registerEchoBenchmarks() {
+  auto const backends = parseList<Backend>(FLAGS_echo_backends, [](auto s) {
+    if (s == "epoll") {
+      return Backend::Epoll;
+    }
+    if (s == "io_uring") {
+      return Backend::IoUring;
+    }
+    throw std::invalid_argument(fmt::format("Unknown backend: {}", s));
+  });
+  auto const transports =
+      parseList<TransportType>(FLAGS_echo_transports, [](auto s) {
+        if (s == "async_socket") {
+          return TransportType::AsyncSocket;
+        }
+        if (s == "io_uring_socket") {
+          return TransportType::IoUringSocket;
+        }
+        if (s == "coro") {
+          return TransportType::Coro;
+        }
+        throw std::invalid_argument(fmt::format("Unknown transport: {}", s));
+      });
+  auto const modes = parseList<std::string>(FLAGS_echo_modes, [](auto s) {
+    if (s != "rr" && s != "pipeline") {
+      throw std::invalid_argument(fmt::format("Unknown mode: {}", s));
+    }
+    return s.str();
+  });
+  auto const connections = parseSizes(FLAGS_echo_connections);
+  auto const messageSizes = parseSizes(FLAGS_echo_message_sizes);
+  auto const ioThreads = parseSizes(FLAGS_echo_io_threads);
+
+  for (auto transport : transports) {
+    auto const transportName = transport == TransportType::AsyncSocket
+        ? "async_socket"
+        : transport == TransportType::IoUringSocket ? "io_uring_socket"
+                                                    : "coro";
+#if !FOLLY_HAS_COROUTINES
+    if (transport == TransportType::Coro) {
+      LOG(WARNING) << "Skipping coro: coroutines are not supported";
+      continue;
+    }
+#endif
+    for (auto backend : backends) {
+      if ((transport == TransportType::IoUringSocket &&
+           backend != Backend::IoUring) ||
+          !backendAvailable(backend)) {
+        continue;
+      }
+      auto const backendName = backend == Backend::Epoll ? "epoll" : "io_uring";
+      for (auto const& mode : modes) {
+        size_t const depth =
+            mode == "rr" ? 1 : to<size_t>(FLAGS_echo_pipeline_depth);
+        for (auto threads : ioThreads) {
+          for (auto conns : connections) {
+            for (auto size : messageSizes) {
+              EchoParams params{
+                  backend, transport, depth, conns, size, threads};
+              addBenchmark(
+                  __FILE__,
+                  fmt::format(
+                      "{}_{}_{}_threads{}_conns{}_size{}",
+                      transportName,
+                      backendName,
+                      mode,
+                      threads,
+                      conns,
+                      size),
+                  [params](UserCounters& counters, unsigned iters) {
+                    runEcho(counters, iters, params);
+                    return iters;
+                  });
+            }
+          }
+        }
+      }
+      addBenchmark(__FILE__, "-", []() -> unsigned { return 0; });
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::Init init(&argc, &argv, true);
+  registerEchoBenchmarks();
+  runBenchmarks();
+}
@@ -1460,6 +1460,66 @@ TEST(IoUringBackend, ProvidedBuffers) {
   EXPECT_EQ("56", toString(bufferProvider->getIoBuf(cqes[0].second >> 16, 2)));
 }
 
+TEST(IoUringBackend, RegisteredBuffers) {
+  static constexpr size_t kBlockSize = 4096;
+  folly::PollIoBackend::Options options;
+  options.setCapacity(32).setMaxSubmit(16).setMaxGet(8).setRegisteredBuffers(
+      kBlockSize, 2);
+  auto evbPtr = getEventBase(options);
+  SKIP_IF(!evbPtr) << "Backend not available";
+  auto* backendPtr = dynamic_cast<folly::IoUringBackend*>(evbPtr->getBackend());
+  CHECK(!!backendPtr);
+  ASSERT_NE(nullptr, backendPtr->registeredBuffers());
+
+  auto tempFile = folly::test::TempFileUtil::getTempFile(kBlockSize);
+  int fd = ::open(tempFile.path().c_str(), O_DIRECT | O_RDWR);
+  if (fd == -1) {
+    fd = ::open(tempFile.path().c_str(), O_RDWR);
+  }
+  SKIP_IF(fd == -1) << "Tempfile can't be opened: " << folly::errnoStr(errno);
+  SCOPE_EXIT {
+    ::close(fd);
+  };
+
+  auto writeBuf = backendPtr->allocRegisteredBuffer();
+  auto readBuf = backendPtr->allocRegisteredBuffer();
+  ASSERT_TRUE(writeBuf && readBuf);
+  EXPECT_EQ(kBlockSize, writeBuf->capacity());
+  EXPECT_EQ(nullptr, backendPtr->allocRegisteredBuffer());
+  EXPECT_EQ(0, backendPtr->registeredBuffers()->bufferIndex(
+                   writeBuf->data(), kBlockSize));
+  EXPECT_EQ(-1, backendPtr->registeredBuffers()->bufferIndex(
+                    writeBuf->data() + 1, kBlockSize));
+
+  memset(writeBuf->writableData(), 'A', kBlockSize);
+  writeBuf->append(kBlockSize);
+  int writeRes = 0;
+  backendPtr->queueWrite(
+      fd, writeBuf->data(), kBlockSize, 0, [&](int res) { writeRes = res; });
+  evbPtr->loop();
+  EXPECT_EQ(kBlockSize, writeRes);
+
+  int readRes = 0;
+  backendPtr->queueRead(
+      fd, readBuf->writableData(), kBlockSize, 0, [&](int res) {
+        readRes = res;
+      });
+  evbPtr->loop();
+  ASSERT_EQ(kBlockSize, readRes);
+  readBuf->append(kBlockSize);
+  EXPECT_EQ(
+      std::string(kBlockSize, 'A'),
+      std::string(reinterpret_cast<const char*>(readBuf->data()), kBlockSize));
+
+  // freed buffers go back to the pool, even once the backend is gone
+  writeBuf.reset();
+  EXPECT_EQ(1, backendPtr->registeredBuffers()->available());
+  auto last = backendPtr->allocRegisteredBuffer();
+  ASSERT_NE(nullptr, last);
+  evbPtr.reset();
+  last.reset();
+}
+
 TEST(IoUringBackend, ProvidedBufferRing) {
   auto evbPtr = getEventBase();
   int constexpr kBuffs = 3;
@@ -18,9 +18,11 @@
 
 #if FOLLY_HAS_EPOLL
 
+#include <atomic>
 #include <thread>
 
 #include <folly/executors/test/IOThreadPoolExecutorBaseTestLib.h>
+#include <folly/experimental/io/EpollBackend.h>
 #include <folly/experimental/io/MuxIOThreadPoolExecutor.h>
 #include <folly/portability/GTest.h>
 #include <folly/synchronization/Latch.h>
@@ -33,6 +35,26 @@ TEST(MuxIOThreadPoolExecutor, SingleEpollLoopCreateDestroy) {
   folly::MuxIOThreadPoolExecutor ex(kNumThreads);
 }
 
+TEST(MuxIOThreadPoolExecutor, BackendFactory) {
+  static constexpr size_t kNumThreads = 2;
+  static constexpr size_t kNumEventBases = 4;
+  std::atomic<size_t> backends{0};
+  folly::MuxIOThreadPoolExecutor ex(
+      kNumThreads,
+      folly::MuxIOThreadPoolExecutor::Options()
+          .setNumEventBases(kNumEventBases)
+          .setBackendFactory([&] {
+            ++backends;
+            return std::make_unique<EpollBackend>(EpollBackend::Options{});
+          }));
+  EXPECT_EQ(kNumEventBases, backends.load());
+  folly::Latch latch(kNumEventBases);
+  for (auto evb : ex.getAllEventBases()) {
+    evb->runInEventBaseThread([&] { latch.count_down(); });
+  }
+  latch.wait();
+}
+
 TEST(MuxIOThreadPoolExecutor, SingleEpollLoopRun) {
   static constexpr size_t kNumThreads = 16;
   static constexpr size_t kNumEventBases = 64;
@@ -66,8 +66,10 @@ namespace observer {
  * Notice that a + b will be only called when either a or b is changed. Getting
  * a snapshot from sumObserver won't trigger any re-computation.
  *
- * Getting an Observer snapshot involves acquiring a shared_ptr, which can be
- * expensive, especially if several threads do so concurrently. If the cost of
+ * Getting an Observer snapshot involves copying a shared_ptr, which can be
+ * expensive, especially if several threads do so concurrently. Each thread
+ * keeps the last few snapshots it read, so the observed object itself is only
+ * looked up under a lock after it changed. If the cost of
  * getSnapshot() is noticeable, alternative Observer implementations are
  * available, offering different trade-offs:
  *
@@ -16,15 +16,39 @@
 
 #include <folly/experimental/observer/detail/Core.h>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+
 #include <folly/ExceptionString.h>
 #include <folly/experimental/observer/detail/ObserverManager.h>
 
 namespace folly {
 namespace observer_detail {
 
+namespace {
+
+uint64_t nextCoreId() {
+  static std::atomic<uint64_t> nextId{1};
+  return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+struct DataCacheEntry {
+  uint64_t coreId{0};
+  Core::VersionedData data;
+};
+
+// Direct-mapped by Core id. Small on purpose: every entry may keep an old
+// view alive until the thread reads another Core that maps to the same slot.
+constexpr size_t kDataCacheSize = 16;
+
+thread_local std::array<DataCacheEntry, kDataCacheSize> dataCache;
+
+} // namespace
+
 Core::VersionedData Core::getData() {
   if (!ObserverManager::DependencyRecorder::isActive()) {
-    return data_.copy();
+    return getDataCached();
   }
 
   ObserverManager::DependencyRecorder::markDependency(shared_from_this());
@@ -41,6 +65,21 @@ Core::VersionedData Core::getData() {
   return data_.copy();
 }
 
+Core::VersionedData Core::getDataCached() {
+  auto& entry = dataCache[id_ % kDataCacheSize];
+  // data_ is swapped before versionLastChange_ is bumped, so a matching
+  // version means the cached view is still the current one.
+  auto const versionLastChange =
+      versionLastChange_.load(std::memory_order_acquire);
+  if (entry.coreId == id_ && entry.data.version == versionLastChange) {
+    return entry.data;
+  }
+  auto data = data_.copy();
+  entry.coreId = id_;
+  entry.data = data;
+  return data;
+}
+
 size_t Core::refresh(size_t version) {
   CHECK(ObserverManager::inManagerThread());
 
@@ -90,6 +129,11 @@ size_t Core::refresh(size_t version) {
     }
 
     try {
+      auto const start = std::chrono::steady_clock::now();
+      SCOPE_EXIT {
+        ObserverManager::recordRecompute(
+            std::chrono::steady_clock::now() - start);
+      };
       VersionedData newData{creator_(), version};
       if (!newData.data) {
         throw std::logic_error("Observer creator returned nullptr.");
@@ -148,7 +192,7 @@ void Core::setForceRefresh() {
 }
 
 Core::Core(folly::Function<std::shared_ptr<const void>()> creator)
-    : creator_(std::move(creator)) {}
+    : id_(nextCoreId()), creator_(std::move(creator)) {}
 
 Core::~Core() {
   dependencies_.withWLock([](const Dependencies& dependencies) {
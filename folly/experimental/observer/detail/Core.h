@@ -63,6 +63,11 @@ class Core : public std::enable_shared_from_this<Core> {
    * Gets current view of the observed object.
    * This is safe to call from any thread. If this is called from other Observer
    * functor then that Observer is marked as dependent on current Observer.
+   *
+   * Outside of Observer functors, the view is served from a small per-thread
+   * cache, which is revalidated with a single load of the version of the last
+   * change. Each thread may hold on to a few of the views it read last, until
+   * they are replaced by newer ones.
    */
   VersionedData getData();
 
@@ -101,6 +106,12 @@ class Core : public std::enable_shared_from_this<Core> {
   using Dependents = std::vector<WeakPtr>;
   using Dependencies = std::unordered_set<Ptr>;
 
+  VersionedData getDataCached();
+
+  // Unique among all Cores ever created, so that the per-thread cache of
+  // getData() can't mistake a new Core for a destroyed one.
+  const uint64_t id_;
+
   folly::Synchronized<Dependents> dependents_;
   folly::Synchronized<Dependencies> dependencies_;
 
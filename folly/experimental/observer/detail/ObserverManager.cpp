@@ -26,6 +26,12 @@
 #include <folly/portability/GFlags.h>
 #include <folly/system/ThreadName.h>
 
+FOLLY_GFLAGS_DEFINE_int32(
+    observer_manager_batch_window_ms,
+    0,
+    "How long ObserverManager should keep collecting Observable updates "
+    "after the first one before propagating them together");
+
 namespace folly {
 namespace observer_detail {
 
@@ -124,6 +130,19 @@ class ObserverManager::UpdatesManager::NextQueueProcessor {
         } while (!stop_ && cores.size() < kNextBatchSize &&
                  queue_.try_dequeue(queueCoreFunc));
 
+        // Let a burst of updates land in the same version, so that their
+        // dependents are re-computed once for all of them.
+        if (!cores.empty() && FLAGS_observer_manager_batch_window_ms > 0) {
+          auto const deadline = std::chrono::steady_clock::now() +
+              std::chrono::milliseconds(FLAGS_observer_manager_batch_window_ms);
+          while (!stop_ && cores.size() < kNextBatchSize &&
+                 queue_.try_dequeue_until(queueCoreFunc, deadline)) {
+            if (auto queueCore = queueCoreFunc()) {
+              cores.emplace_back(std::move(queueCore));
+            }
+          }
+        }
+
         {
           std::unique_lock wh(manager.versionMutex_);
 
@@ -136,6 +155,7 @@ class ObserverManager::UpdatesManager::NextQueueProcessor {
 
           ++manager.version_;
         }
+        manager.versions_.fetch_add(1, std::memory_order_relaxed);
 
         for (auto& core : cores) {
           manager.scheduleRefresh(std::move(core), manager.version_);
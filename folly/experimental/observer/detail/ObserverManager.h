@@ -24,8 +24,11 @@
 #include <folly/fibers/FiberManager.h>
 #include <folly/functional/Invoke.h>
 #include <folly/futures/Future.h>
+#include <folly/portability/GFlags.h>
 #include <folly/synchronization/SanitizeThread.h>
 
+FOLLY_GFLAGS_DECLARE_int32(observer_manager_batch_window_ms);
+
 namespace folly {
 namespace observer_detail {
 
@@ -52,9 +55,54 @@ namespace observer_detail {
  * version is bumped and all updates from the ObserverManager::NextQueue are
  * performed. If leaf Observer gets updated more then once before being picked
  * from the ObserverManager::NextQueue, then only the last update is processed.
+ *
+ * Every Observer is re-computed at most once per version, after the
+ * dependencies it reads are up to date. With --observer_manager_batch_window_ms
+ * set, the NextQueue keeps collecting leaf updates for that long after the
+ * first one before bumping the version, so a burst of updates costs one
+ * re-computation of the Observers that depend on them instead of one per
+ * update.
  */
 class ObserverManager {
  public:
+  /**
+   * Counters of the work done by ObserverManager since the process started.
+   */
+  struct Stats {
+    // Number of times the global version was bumped.
+    uint64_t versions{0};
+    // Number of times an Observer's creator was run.
+    uint64_t recomputes{0};
+    // Total time spent running Observer creators.
+    std::chrono::nanoseconds recomputeTime{0};
+    // Longest single run of an Observer creator.
+    std::chrono::nanoseconds maxRecomputeTime{0};
+  };
+
+  static Stats getStats() {
+    auto& instance = getInstance();
+    Stats stats;
+    stats.versions = instance.versions_.load(std::memory_order_relaxed);
+    stats.recomputes = instance.recomputes_.load(std::memory_order_relaxed);
+    stats.recomputeTime = std::chrono::nanoseconds(
+        instance.recomputeTimeNs_.load(std::memory_order_relaxed));
+    stats.maxRecomputeTime = std::chrono::nanoseconds(
+        instance.maxRecomputeTimeNs_.load(std::memory_order_relaxed));
+    return stats;
+  }
+
+  static void recordRecompute(std::chrono::nanoseconds time) {
+    auto& instance = getInstance();
+    auto const ns = static_cast<uint64_t>(time.count());
+    instance.recomputes_.fetch_add(1, std::memory_order_relaxed);
+    instance.recomputeTimeNs_.fetch_add(ns, std::memory_order_relaxed);
+    auto max = instance.maxRecomputeTimeNs_.load(std::memory_order_relaxed);
+    while (max < ns &&
+           !instance.maxRecomputeTimeNs_.compare_exchange_weak(
+               max, ns, std::memory_order_relaxed)) {
+    }
+  }
+
   static size_t getVersion() { return getInstance().version_; }
 
   static bool inManagerThread() { return inManagerThread_; }
@@ -248,6 +296,11 @@ class ObserverManager {
   mutable SharedMutexReadPriority versionMutex_;
   std::atomic<size_t> version_{1};
 
+  std::atomic<uint64_t> versions_{0};
+  std::atomic<uint64_t> recomputes_{0};
+  std::atomic<uint64_t> recomputeTimeNs_{0};
+  std::atomic<uint64_t> maxRecomputeTimeNs_{0};
+
   using CycleDetector = GraphCycleDetector<const Core*>;
   folly::Synchronized<CycleDetector, std::mutex> cycleDetector_;
 };
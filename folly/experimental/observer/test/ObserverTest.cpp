@@ -20,6 +20,7 @@
 #include <thread>
 
 #include <utility>
+#include <folly/ScopeGuard.h>
 #include <folly/Singleton.h>
 #include <folly/experimental/observer/CoreCachedObserver.h>
 #include <folly/experimental/observer/HazptrObserver.h>
@@ -480,6 +481,61 @@ TEST(Observer, WaitForAllUpdates) {
   folly::observer_detail::ObserverManager::waitForAllUpdates();
 }
 
+TEST(Observer, BatchWindow) {
+  auto const batchWindowMs = FLAGS_observer_manager_batch_window_ms;
+  SCOPE_EXIT {
+    FLAGS_observer_manager_batch_window_ms = batchWindowMs;
+  };
+  FLAGS_observer_manager_batch_window_ms = 1000;
+
+  SimpleObservable<int> observable(0);
+  auto left = makeObserver([o = observable.getObserver()] { return **o; });
+  auto right = makeObserver([o = observable.getObserver()] { return **o; });
+  std::atomic<size_t> sumComputations{0};
+  auto sum = makeObserver([&] {
+    ++sumComputations;
+    return **left + **right;
+  });
+  EXPECT_EQ(0, **sum);
+  EXPECT_EQ(1, sumComputations);
+
+  auto const before = folly::observer_detail::ObserverManager::getStats();
+  for (int i = 1; i <= 10; ++i) {
+    observable.setValue(i);
+  }
+  folly::observer_detail::ObserverManager::waitForAllUpdates();
+  auto const after = folly::observer_detail::ObserverManager::getStats();
+
+  EXPECT_EQ(20, **sum);
+  EXPECT_EQ(2, sumComputations);
+  EXPECT_EQ(1, after.versions - before.versions);
+  EXPECT_GE(after.recomputes - before.recomputes, 3);
+  EXPECT_GE(after.recomputeTime, before.recomputeTime);
+  EXPECT_GE(after.maxRecomputeTime, before.maxRecomputeTime);
+}
+
+TEST(Observer, SnapshotCache) {
+  std::vector<std::unique_ptr<SimpleObservable<int>>> observables;
+  std::vector<Observer<int>> observers;
+  for (int i = 0; i < 100; ++i) {
+    observables.push_back(std::make_unique<SimpleObservable<int>>(i));
+    observers.push_back(observables.back()->getObserver());
+  }
+
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 100; ++i) {
+      auto snapshot = observers[i].getSnapshot();
+      EXPECT_EQ(i + round, *snapshot);
+      // A repeated read sees the same object.
+      EXPECT_EQ(snapshot.get(), observers[i].getSnapshot().get());
+    }
+    for (int i = 0; i < 100; ++i) {
+      observables[i]->setValue(i + round + 1);
+    }
+    folly::observer_detail::ObserverManager::waitForAllUpdates();
+  }
+}
+
 TEST(Observer, IgnoreUpdates) {
   int callbackCalled = 0;
   folly::observer::SimpleObservable<int> observable(42);
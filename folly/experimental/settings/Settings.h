@@ -308,6 +308,16 @@ class SnapshotSettingWrapper {
  *   // or choose to publish:
  *   snapshot.publish();
  *   assert(*FOLLY_SETTING(project, name) == new_snapshot_value);
+ *
+ * A snapshot can also pin a consistent view of the settings for the duration
+ * of a request. Creating one is a single version read and registration; the
+ * first read of each setting through it looks the value up and pins it, and
+ * later reads of that setting are a single hash lookup that keep returning the
+ * same value, whatever happens to the global one in the meantime:
+ *
+ *   folly::settings::Snapshot snapshot;
+ *   handleRequest(FOLLY_SETTING(project, a).value(snapshot),
+ *                 FOLLY_SETTING(project, b).value(snapshot));
  */
 class Snapshot final : public detail::SnapshotBase {
  public:
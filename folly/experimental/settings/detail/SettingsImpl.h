@@ -28,6 +28,7 @@
 #include <folly/SharedMutex.h>
 #include <folly/ThreadLocal.h>
 #include <folly/Utility.h>
+#include <folly/container/F14Map.h>
 #include <folly/container/F14Set.h>
 #include <folly/experimental/settings/Immutables.h>
 #include <folly/experimental/settings/Types.h>
@@ -104,6 +105,13 @@ class BoxedValue {
   explicit BoxedValue(const SettingContents<T>& value)
       : value_(std::make_shared<SettingContents<T>>(value)) {}
 
+  /**
+   * Shares a value that can be retrieved later
+   */
+  template <class T>
+  explicit BoxedValue(std::shared_ptr<const SettingContents<T>> value)
+      : value_(std::const_pointer_cast<SettingContents<T>>(std::move(value))) {}
+
   /**
    * Stores a value that can be both retrieved later and optionally
    * applied globally
@@ -228,7 +236,10 @@ class SnapshotBase {
 
  protected:
   detail::SettingCoreBase::Version at_;
-  std::unordered_map<detail::SettingCoreBase::Key, detail::BoxedValue>
+  /* Values set in this snapshot, and values read through it, which are pinned
+     on first read so that later reads are a single lookup and keep seeing the
+     same value. Only the former have anything to publish. */
+  mutable F14FastMap<detail::SettingCoreBase::Key, detail::BoxedValue>
       snapshotValues_;
 
   template <typename T>
@@ -248,10 +259,9 @@ class SnapshotBase {
       return it->second.template unbox<T>();
     }
     auto savedValue = detail::getSavedValue(core.getKey(), at_);
-    if (savedValue) {
-      return savedValue->template unbox<T>();
-    }
-    return core.getSlow();
+    auto& pinned = snapshotValues_[core.getKey()];
+    pinned = savedValue ? *savedValue : detail::BoxedValue(core.getShared());
+    return pinned.template unbox<T>();
   }
 
   template <class T>
@@ -317,6 +327,9 @@ class SettingCore : public SettingCoreBase {
     return getImpl(IsSmallPOD<T>(), trivialStorage);
   }
   const SettingContents<T>& getSlow() const { return *tlValue(); }
+  std::shared_ptr<const SettingContents<T>> getShared() const {
+    return tlValue();
+  }
   /***
    * SmallPOD version: just read the global atomic
    */
@@ -547,6 +547,28 @@ TEST(Settings, snapshot) {
   }
 }
 
+TEST(Settings, snapshotPinsReads) {
+  some_ns::FOLLY_SETTING(follytest, some_flag).set("pinned");
+  folly::settings::Snapshot snapshot;
+
+  auto& value = *snapshot(some_ns::FOLLY_SETTING(follytest, some_flag));
+  EXPECT_EQ(value, "pinned");
+
+  // Later global updates, and reads of them on this thread, neither change
+  // nor invalidate the value read through the snapshot.
+  some_ns::FOLLY_SETTING(follytest, some_flag).set("updated");
+  EXPECT_EQ(*some_ns::FOLLY_SETTING(follytest, some_flag), "updated");
+  some_ns::FOLLY_SETTING(follytest, some_flag).set("updated_again");
+  EXPECT_EQ(*some_ns::FOLLY_SETTING(follytest, some_flag), "updated_again");
+  EXPECT_EQ(value, "pinned");
+  EXPECT_EQ(
+      &value, &*snapshot(some_ns::FOLLY_SETTING(follytest, some_flag)));
+
+  // Pinned reads are not published.
+  snapshot.publish();
+  EXPECT_EQ(*some_ns::FOLLY_SETTING(follytest, some_flag), "updated_again");
+}
+
 TEST(SettingsTest, callback) {
   size_t callbackInvocations = 0;
   std::string lastCallbackValue;
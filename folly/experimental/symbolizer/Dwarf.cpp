@@ -16,7 +16,9 @@
 
 #include <folly/experimental/symbolizer/Dwarf.h>
 
+#include <algorithm>
 #include <array>
+#include <iterator>
 #include <type_traits>
 
 #include <folly/Optional.h>
@@ -32,8 +34,10 @@
 namespace folly {
 namespace symbolizer {
 
-Dwarf::Dwarf(ElfCacheBase* elfCache, const ElfFile* elf)
+Dwarf::Dwarf(
+    ElfCacheBase* elfCache, const ElfFile* elf, const DwarfIndex* index)
     : elfCache_(elfCache),
+      index_(index),
       defaultDebugSections_{
           .elf = elf,
           .debugCuIndex = getElfSection(elf, ".debug_cu_index"),
@@ -66,11 +70,12 @@ Dwarf::Dwarf(ElfCacheBase* elfCache, const ElfFile* elf)
 namespace {
 
 /**
- * Find @address in .debug_aranges and return the offset in
- * .debug_info for compilation unit to which this address belongs.
+ * Call @f(start, length, offset) for each address range in .debug_aranges,
+ * with the offset in .debug_info of its compilation unit, until it returns
+ * true. Returns whether it did.
  */
-bool findDebugInfoOffset(
-    uintptr_t address, StringPiece aranges, uint64_t& offset) {
+template <typename F>
+bool forEachAddressRange(StringPiece aranges, F&& f) {
   DwarfSection section(aranges);
   folly::StringPiece chunk;
   while (section.next(chunk)) {
@@ -80,7 +85,7 @@ bool findDebugInfoOffset(
       return false;
     }
 
-    offset = readOffset(chunk, section.is64Bit());
+    uint64_t offset = readOffset(chunk, section.is64Bit());
     auto addressSize = read<uint8_t>(chunk);
     if (addressSize != sizeof(uintptr_t)) {
       FOLLY_SAFE_DFATAL("invalid address size: ", addressSize);
@@ -121,8 +126,7 @@ bool findDebugInfoOffset(
         break;
       }
 
-      // Is our address in this range?
-      if (address >= start && address < start + length) {
+      if (f(start, length, offset)) {
         return true;
       }
     }
@@ -130,6 +134,23 @@ bool findDebugInfoOffset(
   return false;
 }
 
+/**
+ * Find @address in .debug_aranges and return the offset in
+ * .debug_info for compilation unit to which this address belongs.
+ */
+bool findDebugInfoOffset(
+    uintptr_t address, StringPiece aranges, uint64_t& offset) {
+  return forEachAddressRange(
+      aranges, [&](uintptr_t start, uintptr_t length, uint64_t unitOffset) {
+        // Is our address in this range?
+        if (address >= start && address < start + length) {
+          offset = unitOffset;
+          return true;
+        }
+        return false;
+      });
+}
+
 } // namespace
 
 bool Dwarf::findAddress(
@@ -151,8 +172,9 @@ bool Dwarf::findAddress(
     // Fast path: find the right .debug_info entry by looking up the
     // address in .debug_aranges.
     uint64_t offset = 0;
-    if (findDebugInfoOffset(
-            address, defaultDebugSections_.debugAranges, offset)) {
+    if (index_ ? index_->findDebugInfoOffset(address, offset)
+               : findDebugInfoOffset(
+                     address, defaultDebugSections_.debugAranges, offset)) {
       // Read compilation unit header from .debug_info
       auto unit = getCompilationUnits(
           elfCache_,
@@ -163,7 +185,7 @@ bool Dwarf::findAddress(
           unit.mainCompilationUnit.unitType != DW_UT_skeleton) {
         return false;
       }
-      DwarfImpl impl(elfCache_, unit, mode);
+      DwarfImpl impl(elfCache_, unit, mode, index_);
       return impl.findLocation(
           address,
           frame,
@@ -199,7 +221,7 @@ bool Dwarf::findAddress(
         unit.mainCompilationUnit.unitType != DW_UT_skeleton) {
       continue;
     }
-    DwarfImpl impl(elfCache_, unit, mode);
+    DwarfImpl impl(elfCache_, unit, mode, index_);
     if (impl.findLocation(
             address,
             frame,
@@ -212,6 +234,79 @@ bool Dwarf::findAddress(
   return false;
 }
 
+DwarfIndex::DwarfIndex(const ElfFile* elf)
+    : debugAranges_(getElfSection(elf, ".debug_aranges")) {}
+
+bool DwarfIndex::findDebugInfoOffset(
+    uintptr_t address, uint64_t& offset) const {
+  std::call_once(rangesOnce_, [&] {
+    forEachAddressRange(
+        debugAranges_,
+        [&](uintptr_t start, uintptr_t length, uint64_t unitOffset) {
+          if (length > 0) {
+            ranges_.push_back({start, start + length, unitOffset});
+          }
+          return false;
+        });
+    std::sort(
+        ranges_.begin(),
+        ranges_.end(),
+        [](const AddressRange& a, const AddressRange& b) {
+          return a.start < b.start;
+        });
+  });
+
+  // Ranges of different compilation units do not overlap, so only the last
+  // range starting at or before address can contain it.
+  auto it = std::upper_bound(
+      ranges_.begin(),
+      ranges_.end(),
+      address,
+      [](uintptr_t addr, const AddressRange& range) {
+        return addr < range.start;
+      });
+  if (it == ranges_.begin() || address >= std::prev(it)->end) {
+    return false;
+  }
+  offset = std::prev(it)->debugInfoOffset;
+  return true;
+}
+
+bool DwarfIndex::findLine(
+    uint64_t lineOffset,
+    DwarfLineNumberVM& lineVM,
+    uintptr_t address,
+    Path& file,
+    uint64_t& line) const {
+  auto table = lineTables_.withRLock([&](auto& tables) {
+    auto it = tables.find(lineOffset);
+    return it == tables.end() ? nullptr : it->second;
+  });
+  if (!table) {
+    // Threads may compile the same table concurrently; one of them wins.
+    auto compiled = std::make_shared<LineTable>();
+    lineVM.compile(*compiled);
+    table = lineTables_.withWLock([&](auto& tables) {
+      return tables.emplace(lineOffset, std::move(compiled)).first->second;
+    });
+  }
+
+  auto it = std::upper_bound(
+      table->begin(),
+      table->end(),
+      address,
+      [](uintptr_t addr, const DwarfLineNumberVM::Row& row) {
+        return addr < row.address;
+      });
+  if (it == table->begin() ||
+      std::prev(it)->file == DwarfLineNumberVM::kNoFile) {
+    return false;
+  }
+  file = lineVM.getFullFileName(std::prev(it)->file);
+  line = std::prev(it)->line;
+  return true;
+}
+
 } // namespace symbolizer
 } // namespace folly
 
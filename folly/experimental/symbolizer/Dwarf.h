@@ -18,8 +18,15 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include <folly/Function.h>
 #include <folly/Range.h>
+#include <folly/Synchronized.h>
+#include <folly/experimental/symbolizer/DwarfLineNumberVM.h>
 #include <folly/experimental/symbolizer/DwarfUtil.h>
 #include <folly/experimental/symbolizer/Elf.h>
 #include <folly/experimental/symbolizer/ElfCache.h>
@@ -30,6 +37,51 @@ namespace symbolizer {
 
 #if FOLLY_HAVE_DWARF && FOLLY_HAVE_ELF
 
+/**
+ * Lookup tables for the DWARF records of one ELF file, for symbolizing many
+ * addresses: the address ranges of .debug_aranges, and the line number matrix
+ * of each compilation unit, as sorted arrays. Each is built on first use.
+ *
+ * Unlike Dwarf, this allocates, so it may not be used in signal handlers. It
+ * is thread-safe.
+ */
+class DwarfIndex {
+ public:
+  explicit DwarfIndex(const ElfFile* elf);
+
+  /**
+   * Finds the offset in .debug_info of the compilation unit containing
+   * address, if .debug_aranges lists it.
+   */
+  bool findDebugInfoOffset(uintptr_t address, uint64_t& offset) const;
+
+  /**
+   * Finds the file and line of address in the line number program at
+   * lineOffset in .debug_line, which lineVM runs.
+   */
+  bool findLine(
+      uint64_t lineOffset,
+      DwarfLineNumberVM& lineVM,
+      uintptr_t address,
+      Path& file,
+      uint64_t& line) const;
+
+ private:
+  struct AddressRange {
+    uintptr_t start;
+    uintptr_t end;
+    uint64_t debugInfoOffset;
+  };
+  using LineTable = std::vector<DwarfLineNumberVM::Row>;
+
+  folly::StringPiece debugAranges_;
+  mutable std::once_flag rangesOnce_;
+  mutable std::vector<AddressRange> ranges_;
+  mutable folly::Synchronized<
+      std::unordered_map<uint64_t, std::shared_ptr<const LineTable>>>
+      lineTables_;
+};
+
 /**
  * DWARF record parser.
  *
@@ -60,8 +112,14 @@ class Dwarf {
    * be live for as long as the passed-in ElfFile is live.
    */
  public:
-  /** Create a DWARF parser around an ELF file. */
-  Dwarf(ElfCacheBase* elfCache, const ElfFile* elf);
+  /**
+   * Create a DWARF parser around an ELF file. If index is given, it must be
+   * built from the same file, and is used instead of scanning sections.
+   */
+  Dwarf(
+      ElfCacheBase* elfCache,
+      const ElfFile* elf,
+      const DwarfIndex* index = nullptr);
 
   /**
    * Find the file and line number information corresponding to address.
@@ -78,6 +136,7 @@ class Dwarf {
 
  private:
   ElfCacheBase* elfCache_;
+  const DwarfIndex* index_;
   DebugSections defaultDebugSections_;
 };
 
@@ -21,6 +21,7 @@
 #include <type_traits>
 
 #include <folly/Optional.h>
+#include <folly/experimental/symbolizer/Dwarf.h>
 #include <folly/experimental/symbolizer/DwarfUtil.h>
 #include <folly/lang/SafeAssert.h>
 #include <folly/portability/Config.h>
@@ -46,8 +47,11 @@ struct CallLocation {
 };
 
 DwarfImpl::DwarfImpl(
-    ElfCacheBase* elfCache, CompilationUnits& cu, LocationInfoMode mode)
-    : elfCache_(elfCache), cu_(cu), mode_(mode) {}
+    ElfCacheBase* elfCache,
+    CompilationUnits& cu,
+    LocationInfoMode mode,
+    const DwarfIndex* index)
+    : elfCache_(elfCache), cu_(cu), mode_(mode), index_(index) {}
 
 /**
  * Find the @locationInfo for @address in the compilation unit @cu_.
@@ -186,8 +190,14 @@ bool DwarfImpl::findLocation(
       lineSection, compilationDirectory, mainCu.debugSections);
 
   // Execute line number VM program to find file and line
-  frame.location.hasFileAndLine =
-      lineVM.findAddress(address, frame.location.file, frame.location.line);
+  frame.location.hasFileAndLine = index_
+      ? index_->findLine(
+            *lineOffset,
+            lineVM,
+            address,
+            frame.location.file,
+            frame.location.line)
+      : lineVM.findAddress(address, frame.location.file, frame.location.line);
   if (!frame.location.hasFileAndLine) {
     return false;
   }
@@ -35,11 +35,15 @@ namespace symbolizer {
 #if FOLLY_HAVE_DWARF && FOLLY_HAVE_ELF
 
 struct CallLocation;
+class DwarfIndex;
 
 class DwarfImpl {
  public:
   explicit DwarfImpl(
-      ElfCacheBase* elfCache, CompilationUnits& cu, LocationInfoMode mode);
+      ElfCacheBase* elfCache,
+      CompilationUnits& cu,
+      LocationInfoMode mode,
+      const DwarfIndex* index = nullptr);
 
   /**
    * Find the @locationInfo for @address in the compilation unit @cu.
@@ -123,6 +127,7 @@ class DwarfImpl {
   ElfCacheBase* elfCache_;
   CompilationUnits& cu_;
   const LocationInfoMode mode_;
+  const DwarfIndex* index_;
 };
 
 #endif
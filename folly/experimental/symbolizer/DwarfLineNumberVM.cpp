@@ -16,6 +16,8 @@
 
 #include <folly/experimental/symbolizer/DwarfLineNumberVM.h>
 
+#include <algorithm>
+
 #include <folly/Optional.h>
 #include <folly/experimental/symbolizer/DwarfSection.h>
 
@@ -712,6 +714,37 @@ bool DwarfLineNumberVM::findAddress(
   return false;
 }
 
+bool DwarfLineNumberVM::compile(std::vector<Row>& rows) {
+  rows.clear();
+  if (!initializationSuccess_) {
+    return false;
+  }
+  folly::StringPiece program = data_;
+  reset();
+  while (!program.empty()) {
+    bool seqEnd = !next(program);
+    if (seqEnd) {
+      // The end of a sequence is one past its last address.
+      rows.push_back({address_, kNoFile, 0});
+      reset();
+    } else {
+      // See findAddress() about the file register in DWARF <= 4.
+      bool noFile = version_ <= 4 && file_ == 0;
+      rows.push_back({address_, noFile ? kNoFile : file_, line_});
+    }
+  }
+  // Sequences may appear in any order, and one may start where another
+  // ends, so ends go first among rows at an address. Keep rows in program
+  // order otherwise, since the last of several rows at an address is the one
+  // findAddress() settles on.
+  std::stable_sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+    return a.address != b.address
+        ? a.address < b.address
+        : (a.file == kNoFile && b.file != kNoFile);
+  });
+  return true;
+}
+
 } // namespace symbolizer
 } // namespace folly
 
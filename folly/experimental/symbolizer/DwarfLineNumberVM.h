@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <folly/Range.h>
 #include <folly/experimental/symbolizer/DwarfUtil.h>
 #include <folly/experimental/symbolizer/SymbolizedFrame.h>
@@ -34,6 +36,22 @@ class DwarfLineNumberVM {
 
   bool findAddress(uintptr_t target, Path& file, uint64_t& line);
 
+  // A row of the line number matrix, covering the addresses from its own to
+  // the next row's. Rows with file kNoFile map their addresses to nothing.
+  struct Row {
+    uint64_t address;
+    uint64_t file;
+    uint64_t line;
+  };
+  static constexpr uint64_t kNoFile = ~uint64_t(0);
+
+  /**
+   * Runs the whole program and returns its rows sorted by address, so that
+   * the row for an address is the last one at or before it, as findAddress()
+   * would find it. Allocates.
+   */
+  bool compile(std::vector<Row>& rows);
+
   /** Gets full file name at given index including directory. */
   Path getFullFileName(uint64_t index) const;
 
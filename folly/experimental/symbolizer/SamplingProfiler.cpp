@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/experimental/symbolizer/SamplingProfiler.h>
+
+#include <signal.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+#include <folly/Conv.h>
+#include <folly/Demangle.h>
+#include <folly/Exception.h>
+#include <folly/Indestructible.h>
+#include <folly/experimental/symbolizer/StackTrace.h>
+#include <folly/experimental/symbolizer/Symbolizer.h>
+#include <folly/lang/Exception.h>
+#include <folly/lang/Hint.h>
+#include <folly/portability/SysTime.h>
+#include <folly/tracing/AsyncStack.h>
+
+namespace folly {
+namespace symbolizer {
+
+namespace {
+
+struct ProfilerState {
+  // Serializes start(), stop() and reads of the samples.
+  std::mutex mutex;
+
+  // Written by signal handlers while running. A sample is claimed by
+  // incrementing next, and published by storing its frame count plus one.
+  std::unique_ptr<uintptr_t[]> frames;
+  std::unique_ptr<std::atomic<size_t>[]> sizes;
+  size_t maxSamples{0};
+  size_t maxFrames{0};
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> dropped{0};
+
+  std::atomic<bool> running{false};
+  std::atomic<size_t> activeHandlers{0};
+
+#ifndef _WIN32
+  struct sigaction oldAction;
+#endif
+};
+
+ProfilerState& profilerState() {
+  static Indestructible<ProfilerState> state;
+  return *state;
+}
+
+#ifndef _WIN32
+
+void profilerSignalHandler(int, siginfo_t*, void*) {
+  // getAsyncStackTraceSafe() walks frame pointers up from its own frame, which
+  // passes through this one, so this function must keep a frame pointer even
+  // when they are omitted otherwise.
+  compiler_must_not_elide(FOLLY_ASYNC_STACK_FRAME_POINTER());
+  auto& state = profilerState();
+  state.activeHandlers.fetch_add(1, std::memory_order_seq_cst);
+  if (state.running.load(std::memory_order_seq_cst)) {
+    auto savedErrno = errno;
+    auto index = state.next.fetch_add(1, std::memory_order_relaxed);
+    if (index < state.maxSamples) {
+      auto addresses = state.frames.get() + index * state.maxFrames;
+      auto n = getAsyncStackTraceSafe(addresses, state.maxFrames);
+      if (n <= 0) {
+        n = getStackTraceSafe(addresses, state.maxFrames);
+      }
+      state.sizes[index].store(
+          n > 0 ? size_t(n) + 1 : 1, std::memory_order_release);
+    } else {
+      state.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    errno = savedErrno;
+  }
+  state.activeHandlers.fetch_sub(1, std::memory_order_release);
+}
+
+void setProfilingTimer(std::chrono::microseconds interval) {
+  struct itimerval timer = {};
+  timer.it_interval.tv_sec = interval.count() / 1000000;
+  timer.it_interval.tv_usec = interval.count() % 1000000;
+  timer.it_value = timer.it_interval;
+  checkUnixError(
+      setitimer(ITIMER_PROF, &timer, nullptr), "setitimer(ITIMER_PROF)");
+}
+
+#endif
+
+std::vector<std::vector<uintptr_t>> readSamples(ProfilerState& state) {
+  std::vector<std::vector<uintptr_t>> samples;
+  auto count = std::min(
+      state.next.load(std::memory_order_acquire), state.maxSamples);
+  samples.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto size = state.sizes[i].load(std::memory_order_acquire);
+    if (size == 0) {
+      // Still being recorded.
+      continue;
+    }
+    auto addresses = state.frames.get() + i * state.maxFrames;
+    samples.emplace_back(addresses, addresses + size - 1);
+  }
+  return samples;
+}
+
+std::unordered_map<uintptr_t, std::string> symbolizeAddresses(
+    const std::vector<std::vector<uintptr_t>>& samples) {
+  std::unordered_map<uintptr_t, std::string> names;
+  std::vector<uintptr_t> addresses;
+  for (auto const& sample : samples) {
+    for (auto address : sample) {
+      if (names.emplace(address, std::string()).second) {
+        addresses.push_back(address);
+      }
+    }
+  }
+#if FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF
+  std::vector<SymbolizedFrame> frames(addresses.size());
+  Symbolizer symbolizer(LocationInfoMode::DISABLED);
+  symbolizer.symbolize(range(addresses), range(frames));
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    if (frames[i].found && frames[i].name != nullptr) {
+      names[addresses[i]] = demangle(frames[i].name).toStdString();
+    }
+  }
+#endif
+  for (auto& [address, name] : names) {
+    if (name.empty()) {
+      name = fmt::format("{:#x}", address);
+    }
+  }
+  return names;
+}
+
+} // namespace
+
+void SamplingProfiler::start(const SamplingProfilerOptions& options) {
+#ifdef _WIN32
+  (void)options;
+  throw_exception<std::runtime_error>(
+      "SamplingProfiler is not supported on this platform");
+#else
+  auto& state = profilerState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.running.load(std::memory_order_relaxed)) {
+    throw_exception<std::logic_error>("SamplingProfiler is already running");
+  }
+  if (options.interval.count() <= 0 || options.maxFrames == 0) {
+    throw_exception<std::invalid_argument>(
+        "SamplingProfiler needs a positive interval and maxFrames");
+  }
+
+  state.frames =
+      std::make_unique<uintptr_t[]>(options.maxSamples * options.maxFrames);
+  state.sizes = std::make_unique<std::atomic<size_t>[]>(options.maxSamples);
+  for (size_t i = 0; i < options.maxSamples; ++i) {
+    state.sizes[i].store(0, std::memory_order_relaxed);
+  }
+  state.maxSamples = options.maxSamples;
+  state.maxFrames = options.maxFrames;
+  state.next.store(0, std::memory_order_relaxed);
+  state.dropped.store(0, std::memory_order_relaxed);
+
+  struct sigaction action = {};
+  action.sa_sigaction = profilerSignalHandler;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  checkUnixError(
+      sigaction(SIGPROF, &action, &state.oldAction), "sigaction(SIGPROF)");
+  state.running.store(true, std::memory_order_seq_cst);
+  try {
+    setProfilingTimer(options.interval);
+  } catch (...) {
+    state.running.store(false, std::memory_order_seq_cst);
+    sigaction(SIGPROF, &state.oldAction, nullptr);
+    throw;
+  }
+#endif
+}
+
+void SamplingProfiler::stop() {
+#ifndef _WIN32
+  auto& state = profilerState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (!state.running.load(std::memory_order_relaxed)) {
+    return;
+  }
+  setProfilingTimer(std::chrono::microseconds(0));
+  state.running.store(false, std::memory_order_seq_cst);
+  // A signal already being handled may still be recording a sample; the
+  // buffer must outlive it.
+  while (state.activeHandlers.load(std::memory_order_acquire) != 0) {
+    std::this_thread::yield();
+  }
+  // Pending SIGPROFs are still delivered, so keep ignoring them rather than
+  // letting the default action terminate the process.
+  auto oldAction = state.oldAction;
+  if (oldAction.sa_handler == SIG_DFL) {
+    oldAction.sa_handler = SIG_IGN;
+  }
+  sigaction(SIGPROF, &oldAction, nullptr);
+#endif
+}
+
+bool SamplingProfiler::isRunning() {
+  return profilerState().running.load(std::memory_order_relaxed);
+}
+
+size_t SamplingProfiler::numSamples() {
+  auto& state = profilerState();
+  return std::min(state.next.load(std::memory_order_relaxed), state.maxSamples);
+}
+
+size_t SamplingProfiler::numDroppedSamples() {
+  return profilerState().dropped.load(std::memory_order_relaxed);
+}
+
+std::vector<std::vector<uintptr_t>> SamplingProfiler::getSamples() {
+  auto& state = profilerState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  return readSamples(state);
+}
+
+std::string SamplingProfiler::getFoldedStacks() {
+  auto samples = getSamples();
+  auto names = symbolizeAddresses(samples);
+
+  std::map<std::string, size_t> stacks;
+  std::string stack;
+  for (auto const& sample : samples) {
+    // Leave out the frames of the signal handler and its trampoline.
+    size_t first = 0;
+    for (size_t i = 0; i < sample.size(); ++i) {
+      auto const& name = names[sample[i]];
+      if (name == "__restore_rt" || name == "__kernel_rt_sigreturn" ||
+          name.find("profilerSignalHandler") != std::string::npos) {
+        first = i + 1;
+      }
+    }
+    stack.clear();
+    for (size_t i = sample.size(); i > first; --i) {
+      if (!stack.empty()) {
+        stack += ';';
+      }
+      stack += names[sample[i - 1]];
+    }
+    if (!stack.empty()) {
+      ++stacks[stack];
+    }
+  }
+
+  std::string out;
+  for (auto const& [folded, count] : stacks) {
+    out += folded;
+    out += ' ';
+    toAppend(count, &out);
+    out += '\n';
+  }
+  return out;
+}
+
+} // namespace symbolizer
+} // namespace folly
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace folly {
+namespace symbolizer {
+
+struct SamplingProfilerOptions {
+  // CPU time between samples.
+  std::chrono::microseconds interval{10000};
+  // Samples beyond this are dropped.
+  size_t maxSamples{10000};
+  size_t maxFrames{64};
+};
+
+/**
+ * An in-process sampling profiler.
+ *
+ * While running, an ITIMER_PROF timer raises SIGPROF every interval of CPU
+ * time used by the process, and the signal handler records the stack of the
+ * interrupted thread into a buffer allocated by start(). When the thread is
+ * running a coroutine, the recorded stack is its async stack trace (see
+ * getAsyncStackTraceSafe()), which continues through the coroutines awaiting
+ * it instead of into the executor that resumed it; like that function, this
+ * needs code built with frame pointers. The handler takes no locks and does
+ * not allocate.
+ *
+ * Samples are symbolized and aggregated only on request, by getFoldedStacks().
+ *
+ * The profiler owns SIGPROF and ITIMER_PROF while running, so there is only
+ * one, and its members are static.
+ */
+class SamplingProfiler {
+ public:
+  /**
+   * Starts sampling, discarding the samples of any previous run.
+   *
+   * Throws std::logic_error if the profiler is already running, and
+   * std::system_error if the handler or timer cannot be installed.
+   */
+  static void start(const SamplingProfilerOptions& options = {});
+
+  /**
+   * Stops sampling, and waits for signal handlers still recording a sample.
+   * The previous SIGPROF handler is restored.
+   */
+  static void stop();
+
+  static bool isRunning();
+
+  /**
+   * Returns the number of samples recorded, and the number dropped because
+   * the buffer was full.
+   */
+  static size_t numSamples();
+  static size_t numDroppedSamples();
+
+  /**
+   * Returns the recorded stacks as return addresses, innermost first.
+   */
+  static std::vector<std::vector<uintptr_t>> getSamples();
+
+  /**
+   * Returns the recorded stacks symbolized and aggregated in the folded
+   * format of flamegraph.pl: one line per distinct stack, with the frames
+   * outermost first and separated by ';', followed by a space and the number
+   * of samples. Frames of the signal handler itself are left out.
+   */
+  static std::string getFoldedStacks();
+};
+
+} // namespace symbolizer
+} // namespace folly
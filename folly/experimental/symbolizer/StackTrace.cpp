@@ -17,6 +17,7 @@
 #include <folly/experimental/symbolizer/StackTrace.h>
 #include <folly/tracing/AsyncStack.h>
 
+#include <atomic>
 #include <memory>
 
 #include <folly/CppAttributes.h>
@@ -44,36 +45,6 @@ static uintptr_t sAddr = 0;
 static ssize_t sInit = getStackTrace(&sAddr, 0);
 } // namespace
 
-ssize_t getStackTrace(
-    [[maybe_unused]] uintptr_t* addresses,
-    [[maybe_unused]] size_t maxAddresses) {
-  static_assert(
-      sizeof(uintptr_t) == sizeof(void*), "uintptr_t / pointer size mismatch");
-  std::ignore = sInit;
-  // The libunwind documentation says that unw_backtrace is
-  // async-signal-safe but, as of libunwind 1.0.1, it isn't
-  // (tdep_trace allocates memory on x86_64)
-  //
-  // There are two major variants of libunwind. libunwind on Linux
-  // (https://www.nongnu.org/libunwind/) provides unw_backtrace, and
-  // Apache/LLVM libunwind (notably used on Apple platforms)
-  // doesn't. They can be distinguished with the UNW_VERSION #define.
-  //
-  // When unw_backtrace is not available, fall back on the standard
-  // `backtrace` function from execinfo.h.
-#if FOLLY_HAVE_LIBUNWIND && defined(UNW_VERSION)
-  int r = unw_backtrace(reinterpret_cast<void**>(addresses), maxAddresses);
-  return r < 0 ? -1 : r;
-#elif FOLLY_HAVE_BACKTRACE
-  int r = backtrace(reinterpret_cast<void**>(addresses), maxAddresses);
-  return r < 0 ? -1 : r;
-#elif FOLLY_HAVE_LIBUNWIND
-  return getStackTraceSafe(addresses, maxAddresses);
-#else
-  return -1;
-#endif
-}
-
 namespace {
 
 // Heuristic for guessing the maximum stack frame size. This is needed to ensure
@@ -85,6 +56,71 @@ constexpr size_t kMaxExpectedStackFrameSizeLg2 = sizeof(size_t) == 8
 constexpr size_t kMaxExpectedStackFrameSize //
     = size_t(1) << kMaxExpectedStackFrameSizeLg2;
 
+// Helper struct for manually walking the stack using stack frame pointers
+struct StackFrame {
+  StackFrame* parentFrame;
+  void* returnAddress;
+};
+
+FOLLY_DISABLE_THREAD_SANITIZER size_t walkNormalStack(
+    uintptr_t* addresses,
+    size_t maxAddresses,
+    StackFrame* normalStackFrame,
+    StackFrame* normalStackFrameStop) {
+  size_t numFrames = 0;
+  while (numFrames < maxAddresses && normalStackFrame != nullptr) {
+    auto* normalStackFrameNext = normalStackFrame->parentFrame;
+    if (!(normalStackFrameNext > normalStackFrame &&
+          normalStackFrameNext <
+              normalStackFrame + kMaxExpectedStackFrameSize)) {
+      // Stack frame addresses should increase as we traverse the stack.
+      // If it doesn't, it means we have stack corruption, or an unusual calling
+      // convention. Ensure that each subsequent frame's address is within a
+      // valid range. If it does not, stop walking the stack early to avoid
+      // incorrect stack walking.
+      break;
+    }
+    if (normalStackFrameStop != nullptr &&
+        normalStackFrameNext == normalStackFrameStop) {
+      // Reached end of normal stack, need to transition to the async stack.
+      // Do not include the return address in the stack trace that points
+      // to the frame that registered the AsyncStackRoot.
+      // Use the return address from the AsyncStackFrame as the current frame's
+      // return address rather than the return address from the normal
+      // stack frame, which would be the address of the executor function
+      // that invoked the callback.
+      break;
+    }
+    addresses[numFrames++] =
+        reinterpret_cast<std::uintptr_t>(normalStackFrame->returnAddress);
+    normalStackFrame = normalStackFrameNext;
+  }
+  return numFrames;
+}
+
+// Walks the frames from the caller's up; the first address is in the caller.
+FOLLY_NOINLINE ssize_t walkFramePointers(
+    uintptr_t* addresses, size_t maxAddresses) {
+  auto* frame = static_cast<StackFrame*>(FOLLY_ASYNC_STACK_FRAME_POINTER());
+  if (frame == nullptr) {
+    return -1;
+  }
+  return walkNormalStack(addresses, maxAddresses, frame, nullptr);
+}
+
+// Like getFrameInfo() below, point into the call instruction rather than
+// after it, since no frame walked through frame pointers is a signal frame.
+// Kept out of walkFramePointers() so that its callers do not tail-call it.
+FOLLY_ALWAYS_INLINE ssize_t
+adjustReturnAddresses(uintptr_t* addresses, ssize_t numFrames) {
+  for (ssize_t i = 0; i < numFrames; ++i) {
+    --addresses[i];
+  }
+  return numFrames;
+}
+
+std::atomic<StackTraceMode> sStackTraceMode{StackTraceMode::Unwind};
+
 #if FOLLY_HAVE_LIBUNWIND
 
 inline bool getFrameInfo(unw_cursor_t* cursor, uintptr_t& ip) {
@@ -143,8 +179,84 @@ ssize_t getStackTraceInPlace(
 }
 
 #endif // FOLLY_HAVE_LIBUNWIND
+
+#if FOLLY_HAVE_LIBUNWIND && defined(UNW_VERSION)
+void enablePerThreadUnwindCache() {
+  static const int r =
+      unw_set_caching_policy(unw_local_addr_space, UNW_CACHE_PER_THREAD);
+  std::ignore = r;
+}
+#endif
+
+// Inlined in the public functions so that the first frame is in them.
+FOLLY_ALWAYS_INLINE ssize_t getStackTraceImpl(
+    [[maybe_unused]] uintptr_t* addresses,
+    [[maybe_unused]] size_t maxAddresses,
+    StackTraceMode mode) {
+  static_assert(
+      sizeof(uintptr_t) == sizeof(void*), "uintptr_t / pointer size mismatch");
+  std::ignore = sInit;
+  if (mode == StackTraceMode::FramePointer) {
+    return adjustReturnAddresses(
+        addresses, walkFramePointers(addresses, maxAddresses));
+  }
+  // The libunwind documentation says that unw_backtrace is
+  // async-signal-safe but, as of libunwind 1.0.1, it isn't
+  // (tdep_trace allocates memory on x86_64)
+  //
+  // There are two major variants of libunwind. libunwind on Linux
+  // (https://www.nongnu.org/libunwind/) provides unw_backtrace, and
+  // Apache/LLVM libunwind (notably used on Apple platforms)
+  // doesn't. They can be distinguished with the UNW_VERSION #define.
+  //
+  // When unw_backtrace is not available, fall back on the standard
+  // `backtrace` function from execinfo.h.
+#if FOLLY_HAVE_LIBUNWIND && defined(UNW_VERSION)
+  if (mode == StackTraceMode::CachedUnwind) {
+    enablePerThreadUnwindCache();
+  }
+  int r = unw_backtrace(reinterpret_cast<void**>(addresses), maxAddresses);
+  return r < 0 ? -1 : r;
+#elif FOLLY_HAVE_BACKTRACE
+  int r = backtrace(reinterpret_cast<void**>(addresses), maxAddresses);
+  return r < 0 ? -1 : r;
+#elif FOLLY_HAVE_LIBUNWIND
+  return getStackTraceSafe(addresses, maxAddresses);
+#else
+  return -1;
+#endif
+}
+
 } // namespace
 
+void setStackTraceMode(StackTraceMode mode) {
+  sStackTraceMode.store(mode, std::memory_order_relaxed);
+}
+
+StackTraceMode getStackTraceMode() {
+  return sStackTraceMode.load(std::memory_order_relaxed);
+}
+
+StackTraceMode getFastestStackTraceMode() {
+  auto mode = getStackTraceMode();
+  return mode == StackTraceMode::FramePointer ? mode
+                                              : StackTraceMode::CachedUnwind;
+}
+
+ssize_t getStackTrace(uintptr_t* addresses, size_t maxAddresses) {
+  return getStackTraceImpl(addresses, maxAddresses, getStackTraceMode());
+}
+
+ssize_t getStackTrace(
+    uintptr_t* addresses, size_t maxAddresses, StackTraceMode mode) {
+  return getStackTraceImpl(addresses, maxAddresses, mode);
+}
+
+ssize_t getStackTraceFramePointer(uintptr_t* addresses, size_t maxAddresses) {
+  return adjustReturnAddresses(
+      addresses, walkFramePointers(addresses, maxAddresses));
+}
+
 ssize_t getStackTraceSafe(
     [[maybe_unused]] uintptr_t* addresses,
     [[maybe_unused]] size_t maxAddresses) {
@@ -188,47 +300,6 @@ ssize_t getStackTraceHeap(
 }
 
 namespace {
-// Helper struct for manually walking the stack using stack frame pointers
-struct StackFrame {
-  StackFrame* parentFrame;
-  void* returnAddress;
-};
-
-FOLLY_DISABLE_THREAD_SANITIZER size_t walkNormalStack(
-    uintptr_t* addresses,
-    size_t maxAddresses,
-    StackFrame* normalStackFrame,
-    StackFrame* normalStackFrameStop) {
-  size_t numFrames = 0;
-  while (numFrames < maxAddresses && normalStackFrame != nullptr) {
-    auto* normalStackFrameNext = normalStackFrame->parentFrame;
-    if (!(normalStackFrameNext > normalStackFrame &&
-          normalStackFrameNext <
-              normalStackFrame + kMaxExpectedStackFrameSize)) {
-      // Stack frame addresses should increase as we traverse the stack.
-      // If it doesn't, it means we have stack corruption, or an unusual calling
-      // convention. Ensure that each subsequent frame's address is within a
-      // valid range. If it does not, stop walking the stack early to avoid
-      // incorrect stack walking.
-      break;
-    }
-    if (normalStackFrameStop != nullptr &&
-        normalStackFrameNext == normalStackFrameStop) {
-      // Reached end of normal stack, need to transition to the async stack.
-      // Do not include the return address in the stack trace that points
-      // to the frame that registered the AsyncStackRoot.
-      // Use the return address from the AsyncStackFrame as the current frame's
-      // return address rather than the return address from the normal
-      // stack frame, which would be the address of the executor function
-      // that invoked the callback.
-      break;
-    }
-    addresses[numFrames++] =
-        reinterpret_cast<std::uintptr_t>(normalStackFrame->returnAddress);
-    normalStackFrame = normalStackFrameNext;
-  }
-  return numFrames;
-}
 
 struct WalkAsyncStackResult {
   // Number of frames added in this walk
@@ -271,8 +342,17 @@ WalkAsyncStackResult walkAsyncStack(
         // stack and not try to walk any further.
         break;
       }
-      // Skip to the parent stack-frame pointer
-      result.normalStackFrame = result.normalStackFrame->parentFrame;
+      // Skip to the parent stack-frame pointer, checking it as
+      // walkNormalStack() checks the frames it walks: code built without
+      // frame pointers may have left anything there.
+      auto* parentFrame = result.normalStackFrame->parentFrame;
+      if (!(parentFrame > result.normalStackFrame &&
+            parentFrame <
+                result.normalStackFrame + kMaxExpectedStackFrameSize)) {
+        result.normalStackFrame = nullptr;
+        break;
+      }
+      result.normalStackFrame = parentFrame;
 
       // Check if there is a higher-level AsyncStackRoot that defines
       // the stop point we should stop walking normal stack frames at.
@@ -25,6 +25,37 @@
 namespace folly {
 namespace symbolizer {
 
+/**
+ * How getStackTrace() walks the stack.
+ */
+enum class StackTraceMode {
+  // Unwind with libunwind (or backtrace() where libunwind has no
+  // unw_backtrace()), using the unwind tables. This is the default.
+  Unwind,
+  // As Unwind, but libunwind caches the unwind info it looks up per thread,
+  // rather than in one cache behind a lock. Using this mode switches libunwind
+  // to per-thread caches for the whole process. Same as Unwind where libunwind
+  // is not available.
+  CachedUnwind,
+  // Follow the chain of frame pointers, which is much faster than unwinding,
+  // but stops early or is wrong if any code on the stack was built without
+  // frame pointers (-fno-omit-frame-pointer).
+  FramePointer,
+};
+
+/**
+ * Set the mode that getStackTrace() uses when not given one, for all threads.
+ */
+void setStackTraceMode(StackTraceMode mode);
+StackTraceMode getStackTraceMode();
+
+/**
+ * The fastest mode that is correct in this process: FramePointer if it was
+ * chosen with setStackTraceMode(), as that asserts that all code keeps frame
+ * pointers, and CachedUnwind otherwise.
+ */
+StackTraceMode getFastestStackTraceMode();
+
 /**
  * Get the current stack trace into addresses, which has room for at least
  * maxAddresses frames.
@@ -35,6 +66,20 @@ namespace symbolizer {
  * NOT async-signal-safe, but fast.
  */
 ssize_t getStackTrace(uintptr_t* addresses, size_t maxAddresses);
+ssize_t getStackTrace(
+    uintptr_t* addresses, size_t maxAddresses, StackTraceMode mode);
+
+/**
+ * Get the current stack trace into addresses, which has room for at least
+ * maxAddresses frames, by following the frame pointers (see
+ * StackTraceMode::FramePointer).
+ *
+ * Returns the number of frames written in the array.
+ * Returns -1 on failure.
+ *
+ * Async-signal-safe, and the fastest.
+ */
+ssize_t getStackTraceFramePointer(uintptr_t* addresses, size_t maxAddresses);
 
 /**
  * Get the current stack trace into addresses, which has room for at least
@@ -16,11 +16,16 @@
 
 #include <folly/experimental/symbolizer/Symbolizer.h>
 
+#include <algorithm>
+#include <atomic>
 #include <climits>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <map>
+#include <mutex>
 
+#include <folly/Executor.h>
 #include <folly/FileUtil.h>
 #include <folly/Memory.h>
 #include <folly/ScopeGuard.h>
@@ -38,6 +43,7 @@
 #include <folly/portability/Config.h>
 #include <folly/portability/SysMman.h>
 #include <folly/portability/Unistd.h>
+#include <folly/synchronization/Latch.h>
 #include <folly/tracing/AsyncStack.h>
 
 #if FOLLY_HAVE_SWAPCONTEXT
@@ -98,23 +104,145 @@ ElfCache* defaultElfCache() {
   return cache;
 }
 
+// The symbol that ElfFile::getDefinitionByAddress() finds for each address of
+// an ELF file, as ranges sorted by address, built on first use.
+class ElfSymbolIndex {
+ public:
+  ElfFile::Symbol find(const ElfFile& file, uintptr_t address) const {
+    std::call_once(once_, [&] { build(file); });
+    auto it = std::upper_bound(
+        ranges_.begin(),
+        ranges_.end(),
+        address,
+        [](uintptr_t addr, const Range& range) { return addr < range.start; });
+    if (it == ranges_.begin() || address >= std::prev(it)->end) {
+      return {nullptr, nullptr};
+    }
+    return std::prev(it)->symbol;
+  }
+
+ private:
+  struct Range {
+    uintptr_t start;
+    uintptr_t end;
+    ElfFile::Symbol symbol;
+  };
+
+  void build(const ElfFile& file) const {
+    // Symbols may overlap; getDefinitionByAddress() returns the first one it
+    // iterates over, .dynsym before .symtab.
+    struct Candidate {
+      uintptr_t start;
+      uintptr_t end;
+      size_t rank;
+      ElfFile::Symbol symbol;
+    };
+    std::vector<Candidate> candidates;
+    auto addSection = [&](const ElfShdr& section) {
+      file.iterateSymbolsWithTypes(
+          section, {STT_OBJECT, STT_FUNC, STT_GNU_IFUNC}, [&](auto& sym) {
+            if (sym.st_shndx != SHN_UNDEF && sym.st_size > 0) {
+              candidates.push_back(
+                  {sym.st_value,
+                   sym.st_value + sym.st_size,
+                   candidates.size(),
+                   {&section, &sym}});
+            }
+            return false;
+          });
+      return false;
+    };
+    file.iterateSectionsWithType(SHT_DYNSYM, addSection);
+    file.iterateSectionsWithType(SHT_SYMTAB, addSection);
+    std::sort(
+        candidates.begin(),
+        candidates.end(),
+        [](const Candidate& a, const Candidate& b) {
+          return a.start < b.start;
+        });
+
+    // Sweep over the boundaries of the symbols, keeping those that contain
+    // the current address in a heap by rank.
+    std::vector<uintptr_t> bounds;
+    for (auto const& candidate : candidates) {
+      bounds.push_back(candidate.start);
+      bounds.push_back(candidate.end);
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    auto byRank = [](const Candidate* a, const Candidate* b) {
+      return a->rank > b->rank;
+    };
+    std::vector<const Candidate*> active;
+    size_t next = 0;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+      for (; next < candidates.size() && candidates[next].start == bounds[i];
+           ++next) {
+        active.push_back(&candidates[next]);
+        std::push_heap(active.begin(), active.end(), byRank);
+      }
+      while (!active.empty() && active.front()->end <= bounds[i]) {
+        std::pop_heap(active.begin(), active.end(), byRank);
+        active.pop_back();
+      }
+      if (active.empty()) {
+        continue;
+      }
+      auto const& symbol = active.front()->symbol;
+      if (!ranges_.empty() && ranges_.back().end == bounds[i] &&
+          ranges_.back().symbol == symbol) {
+        ranges_.back().end = bounds[i + 1];
+      } else {
+        ranges_.push_back({bounds[i], bounds[i + 1], symbol});
+      }
+    }
+  }
+
+  mutable std::once_flag once_;
+  mutable std::vector<Range> ranges_;
+};
+
+// The indexes that symbolizeBatch() keeps for an ELF file.
+struct ElfFileIndex {
+  explicit ElfFileIndex(const ElfFile* file) : dwarf(file) {}
+
+  DwarfIndex dwarf;
+  ElfSymbolIndex symbols;
+};
+
 void setSymbolizedFrame(
     ElfCacheBase* const elfCache,
     SymbolizedFrame& frame,
     const std::shared_ptr<ElfFile>& file,
     uintptr_t address,
     LocationInfoMode mode,
-    folly::Range<SymbolizedFrame*> extraInlineFrames = {}) {
+    folly::Range<SymbolizedFrame*> extraInlineFrames = {},
+    const ElfFileIndex* index = nullptr) {
   frame.clear();
   frame.found = true;
   frame.addr = address;
   frame.file = file;
-  frame.name = file->getSymbolName(file->getDefinitionByAddress(address));
+  frame.name = file->getSymbolName(
+      index ? index->symbols.find(*file, address)
+            : file->getDefinitionByAddress(address));
 
-  Dwarf(elfCache, file.get())
+  Dwarf(elfCache, file.get(), index ? &index->dwarf : nullptr)
       .findAddress(address, mode, frame, extraInlineFrames);
 }
 
+// Addresses symbolized by each task of symbolizeBatch().
+constexpr size_t kBatchChunkSize = 256;
+
+// Reads the path of the executable into selfPath; returns false on failure.
+bool readSelfPath(const std::string& exePath, char (&selfPath)[PATH_MAX + 8]) {
+  ssize_t selfSize;
+  if ((selfSize = readlink(exePath.c_str(), selfPath, PATH_MAX + 1)) == -1) {
+    return false;
+  }
+  selfPath[selfSize] = '\0';
+  return true;
+}
+
 // SymbolCache contains mapping between an address and its frames. The first
 // frame is the normal function call, and the following are stacked inline
 // function calls if any.
@@ -130,6 +258,11 @@ struct Symbolizer::SymbolCache : public Synchronized<UnsyncSymbolCache> {
   using Super::Super;
 };
 
+struct Symbolizer::ElfFileIndexes
+    : public Synchronized<
+          std::map<std::shared_ptr<ElfFile>, std::shared_ptr<ElfFileIndex>>> {
+};
+
 bool Symbolizer::isAvailable() {
   return detail::get_r_debug();
 }
@@ -175,12 +308,10 @@ size_t Symbolizer::symbolize(
   }
 
   char selfPath[PATH_MAX + 8];
-  ssize_t selfSize;
-  if ((selfSize = readlink(exePath_.c_str(), selfPath, PATH_MAX + 1)) == -1) {
+  if (!readSelfPath(exePath_, selfPath)) {
     // Something has gone terribly wrong.
     return 0;
   }
-  selfPath[selfSize] = '\0';
 
   for (size_t i = 0; i < addrCount; i++) {
     frames[i].addr = addrs[i];
@@ -292,6 +423,114 @@ size_t Symbolizer::symbolize(
   return addrCount;
 }
 
+std::vector<SymbolizedFrame> Symbolizer::symbolizeBatch(
+    folly::Range<const uintptr_t*> addrs, Executor* executor) {
+  // Shared with the tasks on executor, which may run after this returns.
+  struct State {
+    explicit State(size_t numChunks)
+        : done(static_cast<ptrdiff_t>(numChunks)) {}
+
+    struct Object {
+      uintptr_t base;
+      std::shared_ptr<ElfFile> file;
+      std::shared_ptr<ElfFileIndex> index;
+    };
+    std::vector<Object> objects;
+    std::vector<uintptr_t> addresses;
+    std::vector<SymbolizedFrame> frames;
+    std::atomic<size_t> nextChunk{0};
+    Latch done;
+  };
+
+  std::vector<uintptr_t> addresses(addrs.begin(), addrs.end());
+  std::sort(addresses.begin(), addresses.end());
+  addresses.erase(
+      std::unique(addresses.begin(), addresses.end()), addresses.end());
+  size_t numChunks = (addresses.size() + kBatchChunkSize - 1) / kBatchChunkSize;
+  auto state = std::make_shared<State>(numChunks);
+  state->addresses = std::move(addresses);
+  state->frames.resize(state->addresses.size());
+  for (size_t i = 0; i < state->addresses.size(); ++i) {
+    state->frames[i].addr = state->addresses[i];
+  }
+
+  auto const dbg = detail::get_r_debug();
+  char selfPath[PATH_MAX + 8];
+  if (dbg != nullptr && dbg->r_version == 1 &&
+      readSelfPath(exePath_, selfPath)) {
+    {
+      static std::mutex initMutex;
+      std::lock_guard<std::mutex> lock(initMutex);
+      if (!elfFileIndexes_) {
+        elfFileIndexes_ = std::make_unique<ElfFileIndexes>();
+      }
+    }
+    auto indexes = elfFileIndexes_->wlock();
+    for (auto lmap = dbg->r_map; lmap != nullptr; lmap = lmap->l_next) {
+      // See symbolize() about the empty name.
+      auto const objPath = lmap->l_name[0] != '\0' ? lmap->l_name : selfPath;
+      auto elfFile = cache_->getFile(objPath);
+      if (!elfFile) {
+        continue;
+      }
+      auto& index = (*indexes)[elfFile];
+      if (!index) {
+        index = std::make_shared<ElfFileIndex>(elfFile.get());
+      }
+      state->objects.push_back(
+          {reinterpret_cast<uintptr_t>(lmap->l_addr), elfFile, index});
+    }
+  }
+
+  // The calling thread and the tasks take chunks of addresses until none is
+  // left, so the work completes even if the executor runs no task.
+  auto work = [elfCache = cache_, mode = mode_](State& st) {
+    size_t chunk;
+    while ((chunk = st.nextChunk.fetch_add(1)) * kBatchChunkSize <
+           st.addresses.size()) {
+      size_t end = std::min((chunk + 1) * kBatchChunkSize, st.addresses.size());
+      for (size_t i = chunk * kBatchChunkSize; i < end; ++i) {
+        for (auto const& object : st.objects) {
+          auto const adjusted = st.addresses[i] - object.base;
+          if (object.file->getSectionContainingAddress(adjusted)) {
+            try {
+              setSymbolizedFrame(
+                  elfCache,
+                  st.frames[i],
+                  object.file,
+                  adjusted,
+                  mode,
+                  {},
+                  object.index.get());
+            } catch (...) {
+              st.frames[i].clear();
+              st.frames[i].addr = st.addresses[i];
+            }
+            break;
+          }
+        }
+      }
+      st.done.count_down();
+    }
+  };
+  if (executor != nullptr) {
+    for (size_t i = 1; i < numChunks; ++i) {
+      executor->add([state, work] { work(*state); });
+    }
+  }
+  work(*state);
+  state->done.wait();
+
+  std::vector<SymbolizedFrame> frames;
+  frames.reserve(addrs.size());
+  for (auto addr : addrs) {
+    auto it = std::lower_bound(
+        state->addresses.begin(), state->addresses.end(), addr);
+    frames.push_back(state->frames[it - state->addresses.begin()]);
+  }
+  return frames;
+}
+
 FastStackTracePrinter::FastStackTracePrinter(
     std::unique_ptr<SymbolizePrinter> printer, size_t symbolCacheSize)
     : printer_(std::move(printer)),
@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <folly/FBString.h>
 #include <folly/Optional.h>
@@ -35,6 +36,9 @@
 #include <folly/portability/Unistd.h>
 
 namespace folly {
+
+class Executor;
+
 namespace symbolizer {
 
 /**
@@ -149,6 +153,22 @@ class Symbolizer {
     return frame.found;
   }
 
+  /**
+   * Symbolize many addresses, such as all the stacks of a profile, and return
+   * a frame for each, without inline frames.
+   *
+   * Each distinct address is symbolized once, in parallel on @executor if
+   * given. The symbols, address ranges and line tables of each ELF file are
+   * indexed on first use (see DwarfIndex), and the indexes are kept by this
+   * Symbolizer for later calls.
+   *
+   * Not async-signal-safe. With an @executor, the ElfCache must be MT-safe,
+   * as ElfCache is. The calling thread takes part in the work, so it may be a
+   * thread of @executor.
+   */
+  std::vector<SymbolizedFrame> symbolizeBatch(
+      folly::Range<const uintptr_t*> addrs, Executor* executor = nullptr);
+
  private:
   ElfCacheBase* const cache_;
   const LocationInfoMode mode_;
@@ -157,6 +177,10 @@ class Symbolizer {
   // Details in cpp file to minimize header dependencies
   struct SymbolCache;
   std::unique_ptr<SymbolCache> symbolCache_;
+  // Created by the first symbolizeBatch(), so that constructing a Symbolizer
+  // does not allocate.
+  struct ElfFileIndexes;
+  std::unique_ptr<ElfFileIndexes> elfFileIndexes_;
 };
 
 /**
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/experimental/symbolizer/SamplingProfiler.h>
+
+#include <chrono>
+#include <stdexcept>
+
+#include <folly/String.h>
+#include <folly/experimental/coro/BlockingWait.h>
+#include <folly/experimental/coro/Task.h>
+#include <folly/lang/Hint.h>
+#include <folly/portability/GTest.h>
+
+using folly::symbolizer::SamplingProfiler;
+
+#ifndef _WIN32
+
+namespace {
+
+FOLLY_NOINLINE void spinFor(std::chrono::milliseconds duration) {
+  auto deadline = std::chrono::steady_clock::now() + duration;
+  uint64_t x = 0;
+  while (std::chrono::steady_clock::now() < deadline) {
+    folly::compiler_must_not_elide(++x);
+  }
+}
+
+void expectFolded(const std::string& folded, size_t numSamples) {
+  std::vector<folly::StringPiece> lines;
+  folly::split('\n', folded, lines, true);
+  size_t total = 0;
+  for (auto line : lines) {
+    auto space = line.rfind(' ');
+    ASSERT_NE(folly::StringPiece::npos, space) << line;
+    total += folly::to<size_t>(line.subpiece(space + 1));
+  }
+  EXPECT_LE(total, numSamples);
+}
+
+} // namespace
+
+TEST(SamplingProfiler, samples) {
+  SamplingProfiler::start({std::chrono::milliseconds(1), 10000, 64});
+  EXPECT_TRUE(SamplingProfiler::isRunning());
+  EXPECT_THROW(SamplingProfiler::start(), std::logic_error);
+  spinFor(std::chrono::milliseconds(300));
+  SamplingProfiler::stop();
+  EXPECT_FALSE(SamplingProfiler::isRunning());
+
+  auto numSamples = SamplingProfiler::numSamples();
+  EXPECT_GT(numSamples, 0);
+  EXPECT_EQ(0, SamplingProfiler::numDroppedSamples());
+  EXPECT_EQ(numSamples, SamplingProfiler::getSamples().size());
+
+  auto folded = SamplingProfiler::getFoldedStacks();
+  expectFolded(folded, numSamples);
+#if FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF && FOLLY_HAVE_LIBUNWIND
+  EXPECT_NE(std::string::npos, folded.find("spinFor")) << folded;
+#endif
+
+  // Samples beyond maxSamples are counted, not recorded.
+  SamplingProfiler::start({std::chrono::milliseconds(1), 2, 64});
+  spinFor(std::chrono::milliseconds(100));
+  SamplingProfiler::stop();
+  EXPECT_EQ(2, SamplingProfiler::numSamples());
+  EXPECT_GT(SamplingProfiler::numDroppedSamples(), 0);
+}
+
+#if FOLLY_HAS_COROUTINES
+
+namespace {
+
+FOLLY_NOINLINE folly::coro::Task<void> co_spinInner() {
+  spinFor(std::chrono::milliseconds(300));
+  co_return;
+}
+
+FOLLY_NOINLINE folly::coro::Task<void> co_spinOuter() {
+  co_await co_spinInner();
+}
+
+} // namespace
+
+TEST(SamplingProfiler, asyncStacks) {
+  SamplingProfiler::start({std::chrono::milliseconds(1), 10000, 64});
+  folly::coro::blockingWait(co_spinOuter());
+  SamplingProfiler::stop();
+
+  auto numSamples = SamplingProfiler::numSamples();
+  EXPECT_GT(numSamples, 0);
+  auto folded = SamplingProfiler::getFoldedStacks();
+  expectFolded(folded, numSamples);
+#if FOLLY_HAVE_ELF && FOLLY_HAVE_DWARF
+  // The awaiting coroutine is a caller of the one it awaits.
+  std::vector<folly::StringPiece> lines;
+  folly::split('\n', folded, lines, true);
+  bool found = false;
+  for (auto line : lines) {
+    auto outer = line.find("co_spinOuter");
+    auto inner = line.find("co_spinInner");
+    auto spin = line.find("spinFor");
+    if (outer != folly::StringPiece::npos &&
+        inner != folly::StringPiece::npos && spin != folly::StringPiece::npos) {
+      EXPECT_LT(outer, inner);
+      EXPECT_LT(inner, spin);
+      found = true;
+    }
+  }
+  EXPECT_TRUE(found) << folded;
+#endif
+}
+
+#endif // FOLLY_HAS_COROUTINES
+
+#endif // _WIN32
@@ -16,6 +16,7 @@
 
 #include <cstring>
 
+#include <folly/ScopeGuard.h>
 #include <folly/experimental/TestUtil.h>
 #include <folly/experimental/coro/BlockingWait.h>
 #include <folly/experimental/coro/Task.h>
@@ -49,8 +50,15 @@ void verifyStackTraces() {
   FrameArray<kMaxAddresses> faHeap;
   CHECK(getStackTraceHeap(faHeap));
 
+  FrameArray<kMaxAddresses> faCached;
+  CHECK(detail::fixFrameArray(
+      faCached,
+      getStackTrace(
+          faCached.addresses, kMaxAddresses, StackTraceMode::CachedUnwind)));
+
   CHECK_EQ(fa.frameCount, faSafe.frameCount);
   CHECK_EQ(fa.frameCount, faHeap.frameCount);
+  CHECK_EQ(fa.frameCount, faCached.frameCount);
 
   if (VLOG_IS_ON(1)) {
     Symbolizer symbolizer;
@@ -73,9 +81,11 @@ void verifyStackTraces() {
   // getStackTraceSafe), the stack traces should be identical
   for (size_t i = 2; i < fa.frameCount; ++i) {
     LOG(INFO) << "i=" << i << " " << std::hex << "0x" << fa.addresses[i]
-              << " 0x" << faSafe.addresses[i] << " 0x" << faHeap.addresses[i];
+              << " 0x" << faSafe.addresses[i] << " 0x" << faHeap.addresses[i]
+              << " 0x" << faCached.addresses[i];
     EXPECT_EQ(fa.addresses[i], faSafe.addresses[i]);
     EXPECT_EQ(fa.addresses[i], faHeap.addresses[i]);
+    EXPECT_EQ(fa.addresses[i], faCached.addresses[i]);
   }
 }
 
@@ -114,6 +124,49 @@ TEST(StackTraceTest, Signal) {
   EXPECT_TRUE(handled);
 }
 
+FOLLY_NOINLINE void verifyFramePointerStackTrace() {
+  constexpr size_t kMaxAddresses = 100;
+  uintptr_t unwound[kMaxAddresses];
+  uintptr_t walked[kMaxAddresses];
+  ssize_t n = getStackTraceSafe(unwound, kMaxAddresses);
+  ssize_t m = getStackTraceFramePointer(walked, kMaxAddresses);
+  if (n < 0 || m < 0) {
+    SKIP() << "Stack traces are not supported";
+  }
+  // The walk misses the outermost frames, whose frame pointer is null, and
+  // goes astray after code built without frame pointers.
+  if (m > n || m + 2 < n) {
+    SKIP() << "Not all the code on the stack keeps frame pointers";
+  }
+  // Other than the top 2 frames, the stack traces should be identical.
+  for (ssize_t i = 2; i < m; ++i) {
+    EXPECT_EQ(unwound[i], walked[i]) << "i=" << i;
+  }
+}
+
+TEST(StackTraceTest, FramePointer) {
+  verifyFramePointerStackTrace();
+}
+
+TEST(StackTraceTest, Mode) {
+  EXPECT_EQ(StackTraceMode::Unwind, getStackTraceMode());
+  EXPECT_EQ(StackTraceMode::CachedUnwind, getFastestStackTraceMode());
+  SCOPE_EXIT {
+    setStackTraceMode(StackTraceMode::Unwind);
+  };
+  setStackTraceMode(StackTraceMode::CachedUnwind);
+  EXPECT_EQ(StackTraceMode::CachedUnwind, getFastestStackTraceMode());
+  setStackTraceMode(StackTraceMode::FramePointer);
+  EXPECT_EQ(StackTraceMode::FramePointer, getStackTraceMode());
+  EXPECT_EQ(StackTraceMode::FramePointer, getFastestStackTraceMode());
+
+  constexpr size_t kMaxAddresses = 100;
+  uintptr_t addresses[kMaxAddresses];
+  EXPECT_EQ(
+      getStackTraceFramePointer(addresses, kMaxAddresses) >= 0,
+      getStackTrace(addresses, kMaxAddresses) >= 0);
+}
+
 ssize_t read_all(int fd, uint8_t* buffer, size_t size) {
   uint8_t* pos = buffer;
   ssize_t bytes_read;
@@ -25,6 +25,7 @@
 #include <folly/Range.h>
 #include <folly/ScopeGuard.h>
 #include <folly/String.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/experimental/symbolizer/ElfCache.h>
 #include <folly/experimental/symbolizer/SymbolizedFrame.h>
 #include <folly/experimental/symbolizer/detail/Debug.h>
@@ -196,6 +197,37 @@ TEST(SymbolizerTest, SymbolCache) {
   }
 }
 
+TEST(SymbolizerTest, SymbolizeBatch) {
+  SKIP_IF(!Symbolizer::isAvailable());
+
+  // Every address twice, and enough distinct ones to take several chunks.
+  std::vector<uintptr_t> addrs;
+  for (size_t i = 0; i < 2048; ++i) {
+    addrs.push_back(reinterpret_cast<uintptr_t>(bar) + i / 2);
+  }
+  addrs.push_back(reinterpret_cast<uintptr_t>(foo));
+
+  Symbolizer symbolizer(LocationInfoMode::FAST);
+  CPUThreadPoolExecutor executor(4);
+  std::array<Executor*, 2> executors = {{nullptr, &executor}};
+  for (auto* ex : executors) {
+    auto frames = symbolizer.symbolizeBatch(range(addrs), ex);
+    ASSERT_EQ(addrs.size(), frames.size());
+    EXPECT_EQ("folly::symbolizer::test::bar()", demangle(frames[0].name));
+    EXPECT_EQ("folly::symbolizer::test::foo()", demangle(frames.back().name));
+    for (size_t i = 0; i < addrs.size(); ++i) {
+      SymbolizedFrame expected;
+      symbolizer.symbolize(addrs[i], expected);
+      EXPECT_EQ(expected.found, frames[i].found);
+      EXPECT_STREQ(expected.name, frames[i].name);
+      EXPECT_EQ(expected.location.line, frames[i].location.line);
+      EXPECT_EQ(
+          expected.location.file.toString(),
+          frames[i].location.file.toString());
+    }
+  }
+}
+
 namespace {
 
 void expectFrameEq(
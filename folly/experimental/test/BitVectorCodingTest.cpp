@@ -106,6 +106,13 @@ BENCHMARK(Next, iters) {
   });
 }
 
+BENCHMARK_RELATIVE(NextBatch, iters) {
+  dispatchInstructions([&](auto instructions) {
+    bmNextBatch<BitVectorReader<bm::Encoder, decltype(instructions)>>(
+        bm::list, bm::data, iters);
+  });
+}
+
 size_t Skip_ForwardQ128(size_t iters, size_t logAvgSkip) {
   dispatchInstructions([&](auto instructions) {
     bmSkip<BitVectorReader<bm::Encoder, decltype(instructions)>>(
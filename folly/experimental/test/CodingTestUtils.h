@@ -142,6 +142,40 @@ void testNext(const std::vector<uint64_t>& data, const List& list) {
   EXPECT_EQ(reader.position(), reader.size());
 }
 
+template <class Reader, class List>
+void testNextBatch(const std::vector<uint64_t>& data, const List& list) {
+  using ValueType = typename Reader::ValueType;
+  for (size_t batch : {1, 3, 64, 1000}) {
+    Reader reader(list);
+    std::vector<ValueType> out(batch);
+    size_t i = 0;
+    while (i < data.size()) {
+      size_t n = reader.nextBatch(out.data(), batch);
+      ASSERT_EQ(std::min(batch, data.size() - i), n) << batch << " " << i;
+      for (size_t j = 0; j < n; ++j) {
+        EXPECT_EQ(data[i + j], out[j]) << batch << " " << i + j;
+      }
+      i += n;
+      if (n < batch) {
+        EXPECT_FALSE(reader.valid());
+        break;
+      }
+      EXPECT_TRUE(reader.valid());
+      EXPECT_EQ(i - 1, reader.position());
+      EXPECT_EQ(data[i - 1], reader.value());
+      // Single steps still work after a batch.
+      if (i < data.size() && i % 2 == 0) {
+        EXPECT_TRUE(reader.next());
+        EXPECT_EQ(data[i], reader.value());
+        ++i;
+      }
+    }
+    EXPECT_EQ(0, reader.nextBatch(out.data(), batch));
+    EXPECT_FALSE(reader.valid());
+    EXPECT_EQ(reader.position(), reader.size());
+  }
+}
+
 template <class Reader, class List>
 void testSkip(
     const std::vector<uint64_t>& data, const List& list, size_t skipStep) {
@@ -385,6 +419,7 @@ void testAll(
   }
   auto list = encoder.finish();
   testNext<Reader>(data, list);
+  testNextBatch<Reader>(data, list);
   testSkip<Reader>(data, list);
   testSkipTo<Reader>(data, list);
   testJump<Reader>(data, list);
@@ -408,6 +443,24 @@ void bmNext(const List& list, const std::vector<uint64_t>& data, size_t iters) {
   }
 }
 
+template <class Reader, class List>
+void bmNextBatch(
+    const List& list, const std::vector<uint64_t>& data, size_t iters) {
+  if (data.empty()) {
+    return;
+  }
+
+  Reader reader(list);
+  typename Reader::ValueType out[64];
+  for (size_t i = 0; i < iters; i += 64) {
+    if (FOLLY_LIKELY(reader.nextBatch(out, 64) == 64)) {
+      folly::doNotOptimizeAway(out[63]);
+    } else {
+      reader.reset();
+    }
+  }
+}
+
 template <class Reader, class List>
 void bmSkip(
     const List& list,
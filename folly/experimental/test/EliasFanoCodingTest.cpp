@@ -22,6 +22,8 @@
 
 #include <folly/Benchmark.h>
 #include <folly/Random.h>
+#include <folly/experimental/BitVectorCoding.h>
+#include <folly/experimental/CodingIntersection.h>
 #include <folly/experimental/EliasFanoCoding.h>
 #include <folly/experimental/Select64.h>
 #include <folly/experimental/test/CodingTestUtils.h>
@@ -231,6 +233,57 @@ TEST_F(EliasFanoCodingTest, BugLargeGapInUpperBits) { // t16274876
   list.free();
 }
 
+TEST(EliasFanoCoding, intersect) {
+  using EFEncoder = EliasFanoEncoder<uint32_t, uint32_t, 128, 128>;
+  using EFReader = EliasFanoReader<EFEncoder, instructions::Default>;
+  using BVEncoder = BitVectorEncoder<uint32_t, uint32_t, 128, 128>;
+  using BVReader = BitVectorReader<BVEncoder, instructions::Default>;
+
+  std::mt19937 gen;
+  // A dense list and a sparse one, so both directions of skipTo() run.
+  auto dense = generateRandomList(100 * 1000, 1000 * 1000, gen);
+  auto sparse = generateRandomList(1000, 1000 * 1000, gen);
+  sparse.push_back(dense.back()); // The last values match.
+  std::sort(sparse.begin(), sparse.end());
+  // BitVector lists can't hold duplicates.
+  sparse.erase(std::unique(sparse.begin(), sparse.end()), sparse.end());
+
+  std::vector<uint64_t> expected;
+  std::set_intersection(
+      dense.begin(),
+      dense.end(),
+      sparse.begin(),
+      sparse.end(),
+      std::back_inserter(expected));
+  ASSERT_FALSE(expected.empty());
+
+  auto efDense = EFEncoder::encode(dense.begin(), dense.end());
+  auto efSparse = EFEncoder::encode(sparse.begin(), sparse.end());
+  auto bvSparse = BVEncoder::encode(sparse.begin(), sparse.end());
+
+  {
+    EFReader a(efDense);
+    EFReader b(efSparse);
+    std::vector<uint64_t> actual;
+    intersect(a, b, std::back_inserter(actual));
+    EXPECT_EQ(expected, actual);
+    actual.clear();
+    intersect(b, a, std::back_inserter(actual));
+    EXPECT_EQ(expected, actual);
+  }
+  {
+    EFReader a(efDense);
+    BVReader b(bvSparse);
+    std::vector<uint64_t> actual;
+    intersect(a, b, std::back_inserter(actual));
+    EXPECT_EQ(expected, actual);
+  }
+
+  efDense.free();
+  efSparse.free();
+  bvSparse.free();
+}
+
 namespace bm {
 
 typedef EliasFanoEncoder<uint32_t, uint32_t, 128, 128> Encoder;
@@ -279,6 +332,13 @@ BENCHMARK(Next, iters) {
   });
 }
 
+BENCHMARK_RELATIVE(NextBatch, iters) {
+  dispatchInstructions([&](auto instructions) {
+    bmNextBatch<EliasFanoReader<bm::Encoder, decltype(instructions)>>(
+        bm::list, bm::data, iters);
+  });
+}
+
 size_t Skip_ForwardQ128(size_t iters, size_t logAvgSkip) {
   dispatchInstructions([&](auto instructions) {
     bmSkip<EliasFanoReader<bm::Encoder, decltype(instructions)>>(
@@ -16,9 +16,14 @@
 
 #include <folly/experimental/FlatCombiningPriorityQueue.h>
 
+#include <algorithm>
 #include <condition_variable>
 #include <mutex>
+#include <numeric>
 #include <queue>
+#include <random>
+#include <thread>
+#include <vector>
 
 #include <folly/Benchmark.h>
 #include <folly/portability/GTest.h>
@@ -246,6 +251,112 @@ TEST(FCPriQueue, timeout) {
   CHECK(pq.empty());
 }
 
+TEST(FCPriQueue, bulk) {
+  FCPQ pq;
+  std::vector<int> in(1000);
+  std::iota(in.begin(), in.end(), 0);
+  std::shuffle(in.begin(), in.end(), std::mt19937{});
+  // A small batch is sifted in, a large one rebuilds the heap.
+  EXPECT_EQ(pq.try_push_bulk(in.begin(), in.begin() + 3), 3);
+  pq.push_bulk(in.begin() + 3, in.end());
+  EXPECT_EQ(pq.size(), 1000);
+
+  std::vector<int> out;
+  // A few items are popped one by one, many are selected and sorted.
+  EXPECT_EQ(pq.try_pop_bulk(out, 3), 3);
+  EXPECT_EQ(pq.pop_bulk(out, 900), 900);
+  EXPECT_EQ(pq.try_pop_bulk(out, 1000), 97);
+  EXPECT_EQ(pq.try_pop_bulk(out, 1), 0);
+  EXPECT_EQ(pq.pop_bulk(out, 0), 0);
+  ASSERT_EQ(out.size(), 1000);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(out[i], 999 - i);
+  }
+  CHECK(pq.empty());
+  // An unbounded request only reserves what the queue holds.
+  pq.push_bulk(in.begin(), in.begin() + 10);
+  out.clear();
+  EXPECT_EQ(pq.try_pop_bulk(out, SIZE_MAX), 10);
+  EXPECT_EQ(out.size(), 10);
+}
+
+TEST(FCPriQueue, bulkBounded) {
+  FCPQ pq(4);
+  std::vector<int> in = {5, 1, 4, 2, 3, 6};
+  EXPECT_EQ(pq.try_push_bulk(in.begin(), in.end()), 4);
+  EXPECT_EQ(pq.size(), 4);
+  auto dur = std::chrono::microseconds(1000);
+  EXPECT_EQ(
+      pq.try_push_bulk_until(
+          in.begin(), in.end(), std::chrono::steady_clock::now() + dur),
+      0);
+
+  std::thread consumer([&] {
+    std::vector<int> out;
+    while (out.size() < 6) {
+      pq.pop_bulk(out, 2);
+    }
+    std::sort(out.begin(), out.end());
+    EXPECT_EQ(out, (std::vector<int>{1, 2, 3, 4, 5, 6}));
+  });
+  pq.push_bulk(in.begin() + 4, in.end());
+  consumer.join();
+  CHECK(pq.empty());
+}
+
+TEST(FCPriQueue, bulkTimeout) {
+  FCPQ pq;
+  std::vector<int> out;
+  auto dur = std::chrono::microseconds(1000);
+  EXPECT_EQ(pq.try_pop_bulk_for(out, 10, dur), 0);
+  EXPECT_EQ(
+      pq.try_pop_bulk_until(out, 10, std::chrono::steady_clock::now() + dur),
+      0);
+  EXPECT_TRUE(out.empty());
+
+  std::thread producer([&] {
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pq.push(7);
+  });
+  EXPECT_EQ(
+      pq.try_pop_bulk_until(
+          out, 10, std::chrono::steady_clock::now() + std::chrono::hours(1)),
+      1);
+  EXPECT_EQ(out, std::vector<int>{7});
+  producer.join();
+}
+
+TEST(FCPriQueue, bulkEarliestDeadlineFirst) {
+  using Deadline = std::chrono::steady_clock::time_point;
+  folly::FlatCombiningPriorityQueue<
+      Deadline,
+      std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>>>
+      pq;
+  auto now = std::chrono::steady_clock::now();
+  std::vector<Deadline> in;
+  for (int i = 100; i > 0; --i) {
+    in.push_back(now + std::chrono::milliseconds(i));
+  }
+  pq.push_bulk(in.begin(), in.end());
+  std::vector<Deadline> out;
+  EXPECT_EQ(pq.try_pop_bulk(out, 60), 60);
+  EXPECT_TRUE(std::is_sorted(out.begin(), out.end()));
+  EXPECT_EQ(out.front(), now + std::chrono::milliseconds(1));
+  EXPECT_EQ(out.back(), now + std::chrono::milliseconds(60));
+}
+
+TEST(FCPriQueue, bulkOtherPriorityQueue) {
+  // Not a std::priority_queue: bulk operations fall back to push and pop.
+  struct PQ : std::priority_queue<int> {};
+  folly::FlatCombiningPriorityQueue<int, PQ> pq;
+  std::vector<int> in = {3, 1, 2};
+  EXPECT_EQ(pq.try_push_bulk(in.begin(), in.end()), 3);
+  std::vector<int> out;
+  EXPECT_EQ(pq.try_pop_bulk(out, 5), 3);
+  EXPECT_EQ(out, (std::vector<int>{3, 2, 1}));
+}
+
 TEST(FCPriQueue, pushPop) {
   int ops = 1000;
   int work = 0;
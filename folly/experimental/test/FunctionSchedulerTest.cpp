@@ -23,6 +23,7 @@
 #include <glog/logging.h>
 
 #include <folly/Random.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/experimental/FunctionScheduler.h>
 #include <folly/portability/GTest.h>
 #include <folly/synchronization/Baton.h>
@@ -715,3 +716,50 @@ TEST(FunctionScheduler, ConcurrentCancelFunctionAndWait) {
   th1.join();
   th2.join();
 }
+
+TEST(FunctionScheduler, Executor) {
+  CPUThreadPoolExecutor executor(2);
+  atomic<int> fast{0};
+  atomic<int> slow{0};
+  FunctionScheduler fs;
+  fs.setExecutor(getKeepAliveToken(executor));
+  // Never runs concurrently with itself, so it runs once in this test.
+  fs.addFunction(
+      [&] {
+        ++slow;
+        delay(6);
+      },
+      testInterval(1),
+      "slow");
+  fs.addFunction([&] { ++fast; }, testInterval(1), "fast");
+
+  fs.start();
+  delay(3.5);
+  EXPECT_EQ(1, slow);
+  // The slow function doesn't hold the fast one back.
+  EXPECT_GE(fast, 3);
+
+  EXPECT_TRUE(fs.cancelFunctionAndWait("slow"));
+  EXPECT_EQ(1, slow);
+  EXPECT_TRUE(fs.shutdown());
+}
+
+TEST(FunctionScheduler, ExecutorShutdownWaitsForRunningFunctions) {
+  CPUThreadPoolExecutor executor(1);
+  atomic<int> total{0};
+  FunctionScheduler fs;
+  fs.setExecutor(getKeepAliveToken(executor));
+  fs.addFunction(
+      [&] {
+        delay(2);
+        total += 2;
+      },
+      testInterval(100),
+      "add2");
+
+  fs.start();
+  delay(1);
+  EXPECT_EQ(0, total);
+  EXPECT_TRUE(fs.shutdown());
+  EXPECT_EQ(2, total);
+}
@@ -16,11 +16,13 @@
 
 #include <folly/experimental/JemallocHugePageAllocator.h>
 
+#include <folly/concurrency/ConcurrentHashMap.h>
 #include <folly/container/F14Map.h>
 
 #include <folly/memory/Malloc.h>
 #include <folly/portability/GTest.h>
 
+#include <limits>
 #include <vector>
 
 using jha = folly::JemallocHugePageAllocator;
@@ -339,3 +341,61 @@ TEST(JemallocHugePageAllocatorTest, Grow) {
   jha::deallocate(ptr4);
   jha::deallocate(ptr5);
 }
+
+TEST(JemallocHugePageAllocatorTest, Growable) {
+  // Only one page at a time, so that the arena has to grow
+  bool initialized = jha::init(0, 1, /* growable = */ true);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; i++) {
+    ptrs.push_back(jha::allocate(mb(3)));
+    EXPECT_NE(nullptr, ptrs.back());
+    if (initialized) {
+      EXPECT_TRUE(jha::addressInArena(ptrs.back()));
+    }
+  }
+  for (auto ptr : ptrs) {
+    jha::deallocate(ptr);
+  }
+}
+
+TEST(JemallocHugePageAllocatorTest, HugePageAllocator) {
+  folly::HugePageAllocator<int> intAlloc;
+  folly::HugePageAllocator<char> charAlloc = intAlloc;
+  EXPECT_TRUE(intAlloc == charAlloc);
+  EXPECT_THROW(
+      intAlloc.allocate(std::numeric_limits<size_t>::max() / sizeof(int)),
+      std::bad_alloc);
+  EXPECT_THROW(
+      intAlloc.allocate(std::numeric_limits<size_t>::max() / 2),
+      std::bad_array_new_length);
+
+  folly::F14FastMap<
+      int,
+      int,
+      folly::f14::DefaultHasher<int>,
+      folly::f14::DefaultKeyEqual<int>,
+      folly::HugePageAllocator<std::pair<int const, int>>>
+      map;
+  folly::ConcurrentHashMap<
+      int,
+      int,
+      std::hash<int>,
+      std::equal_to<int>,
+      folly::HugePageAllocator<uint8_t>>
+      chm;
+  for (int i = 0; i < 100000; i++) {
+    map[i] = i;
+    chm.insert(i, i);
+  }
+  if (jha::initialized()) {
+    EXPECT_TRUE(jha::addressInArena(&map[0]));
+    EXPECT_TRUE(jha::addressInArena(&map[99999]));
+  }
+  EXPECT_EQ(100000, map.size());
+  EXPECT_EQ(100000, chm.size());
+  EXPECT_EQ(12345, chm.find(12345)->second);
+
+  auto copy = map;
+  EXPECT_EQ(map, copy);
+}
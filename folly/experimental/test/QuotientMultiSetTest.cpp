@@ -21,6 +21,7 @@
 #include <folly/Format.h>
 #include <folly/Random.h>
 #include <folly/container/Enumerate.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/io/IOBufQueue.h>
 #include <folly/portability/GTest.h>
 
@@ -52,14 +53,62 @@ class QuotientMultiSetTest : public ::testing::Test {
     builder.close(buff);
     auto spBuf = buff.move();
 
-    folly::StringPiece data(spBuf->coalesce());
+    validate(keys, keyBits, folly::StringPiece(spBuf->coalesce()));
+  }
+
+  // Builds the keys in parallel from a shuffled order and checks that the
+  // layout matches the sequential builder.
+  void parallelBuildAndValidate(
+      std::vector<uint64_t>& keys,
+      uint64_t keyBits,
+      double loadFactor,
+      size_t numSegments) {
+    std::shuffle(keys.begin(), keys.end(), rng);
+    folly::QuotientMultiSetParallelBuilder parallelBuilder(
+        keyBits, &executor, loadFactor, numSegments);
+    folly::IOBufQueue parallelBuff;
+    parallelBuilder.build(keys, parallelBuff);
+    auto parallelBuf = parallelBuff.move();
+    folly::StringPiece parallelData(parallelBuf->coalesce());
+
+    std::sort(keys.begin(), keys.end());
+    folly::QuotientMultiSetBuilder builder(keyBits, keys.size(), loadFactor);
+    folly::IOBufQueue buff;
+    for (const auto key : keys) {
+      builder.insert(key);
+    }
+    builder.close(buff);
+    auto buf = buff.move();
+    folly::StringPiece data(buf->coalesce());
+
+    ASSERT_EQ(data.size(), parallelData.size());
+    folly::QuotientMultiSet<> reader(data);
+    folly::QuotientMultiSet<> parallelReader(parallelData);
+    folly::QuotientMultiSet<>::Iterator iter(&reader);
+    folly::QuotientMultiSet<>::Iterator parallelIter(&parallelReader);
+    while (iter.next()) {
+      ASSERT_TRUE(parallelIter.next());
+      ASSERT_EQ(iter.key(), parallelIter.key());
+      ASSERT_EQ(iter.pos(), parallelIter.pos());
+    }
+    EXPECT_FALSE(parallelIter.next());
+
+    if (!keys.empty()) {
+      validate(keys, keyBits, parallelData);
+    }
+  }
+
+  void validate(
+      const std::vector<uint64_t>& keys,
+      uint64_t keyBits,
+      folly::StringPiece data) {
     folly::QuotientMultiSet<> reader(data);
 
     size_t index = 0;
     folly::QuotientMultiSet<>::Iterator iter(&reader);
     while (index < keys.size()) {
       uint64_t start = index;
-      uint64_t& key = keys[start];
+      const uint64_t& key = keys[start];
       auto debugInfo = [&] {
         return folly::sformat("Index: {} Key: {}", index, key);
       };
@@ -131,6 +180,7 @@ class QuotientMultiSetTest : public ::testing::Test {
   }
 
   std::mt19937 rng;
+  folly::CPUThreadPoolExecutor executor{4};
 };
 
 } // namespace
@@ -291,4 +341,111 @@ TEST_F(QuotientMultiSetTest, RunendRightBeforeFirstOccupiedRunend) {
   buildAndValidate(keys, 8, 0.95);
 }
 
+TEST_F(QuotientMultiSetTest, ParallelBuilder) {
+  auto randomKeys = [&](size_t size, uint64_t keyBits) {
+    std::vector<uint64_t> keys;
+    for (size_t idx = 0; idx < size; idx++) {
+      keys.push_back(
+          folly::Random::rand64(rng) & folly::qms_detail::maxValue(keyBits));
+    }
+    return keys;
+  };
+  std::vector<std::tuple<int, uint64_t, double, size_t>> testCases = {
+      {32, 0, 0.95, 8},
+      {32, 1, 0.95, 8},
+      {8, 1 << 10, 0.95, 3},
+      {12, 3800, 0.95, 16},
+      {32, 1 << 16, 0.95, 7},
+      {32, 1 << 16, 1, 64},
+      {64, 1 << 14, 0.95, 5},
+      {64, 16, 0.95, 4},
+      {32, 1 << 12, 0.95, 1},
+  };
+  for (const auto& testCase : testCases) {
+    const auto& [keyBits, size, loadFactor, numSegments] = testCase;
+    SCOPED_TRACE(folly::sformat(
+        "Key bits: {} Size: {} Load factor: {} Segments: {}",
+        keyBits,
+        size,
+        loadFactor,
+        numSegments));
+    auto keys = randomKeys(size, keyBits);
+    parallelBuildAndValidate(keys, keyBits, loadFactor, numSegments);
+  }
+}
+
+TEST_F(QuotientMultiSetTest, ParallelBuilderRunsAcrossSegments) {
+  // Long runs of duplicates overflow well past the segment boundaries.
+  std::vector<uint64_t> keys;
+  for (uint64_t idx = 0; idx < (1 << 10); idx++) {
+    keys.emplace_back(idx);
+    keys.emplace_back(idx);
+    keys.emplace_back(idx);
+  }
+  parallelBuildAndValidate(keys, 12, 0.95, 16);
+
+  keys.clear();
+  for (uint64_t idx = 0; idx < (1 << 6); idx++) {
+    uint64_t key = folly::Random::rand32(rng);
+    for (uint64_t k = 0; k < 137; k++) {
+      keys.emplace_back(key + k);
+    }
+  }
+  parallelBuildAndValidate(keys, 32, 0.95, 32);
+}
+
+TEST_F(QuotientMultiSetTest, ParallelBuilderWithoutExecutor) {
+  std::vector<uint64_t> keys;
+  for (uint64_t idx = 0; idx < (1 << 12); idx++) {
+    keys.push_back(folly::Random::rand32(rng));
+  }
+  folly::QuotientMultiSetParallelBuilder builder(32, nullptr);
+  folly::IOBufQueue buff;
+  builder.build(keys, buff);
+  auto buf = buff.move();
+  std::sort(keys.begin(), keys.end());
+  validate(keys, 32, folly::StringPiece(buf->coalesce()));
+}
+
+TEST_F(QuotientMultiSetTest, NextBatch) {
+  std::vector<uint64_t> keys;
+  for (uint64_t idx = 0; idx < (1 << 12); idx++) {
+    keys.push_back(folly::Random::rand32(rng) >> 12);
+  }
+  std::sort(keys.begin(), keys.end());
+  folly::QuotientMultiSetBuilder builder(20, keys.size());
+  folly::IOBufQueue buff;
+  for (const auto key : keys) {
+    builder.insert(key);
+  }
+  builder.close(buff);
+  auto buf = buff.move();
+  folly::QuotientMultiSet<> reader(folly::StringPiece(buf->coalesce()));
+
+  for (size_t trial = 0; trial < 64; trial++) {
+    uint64_t lo = folly::Random::rand32(1 << 20, rng);
+    uint64_t hi = folly::Random::rand32(lo, 1 << 20, rng);
+    std::vector<uint64_t> expected(
+        std::lower_bound(keys.begin(), keys.end(), lo),
+        std::lower_bound(keys.begin(), keys.end(), hi));
+
+    std::vector<uint64_t> actual;
+    folly::QuotientMultiSet<>::Iterator iter(&reader);
+    if (iter.skipTo(lo)) {
+      uint64_t batch[7];
+      size_t positions[7];
+      size_t n;
+      while ((n = iter.nextBatch(batch, 7, hi, positions)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+          EXPECT_TRUE(reader.equalRange(batch[i]));
+          EXPECT_LE(reader.equalRange(batch[i]).begin, positions[i]);
+          EXPECT_GT(reader.equalRange(batch[i]).end, positions[i]);
+        }
+        actual.insert(actual.end(), batch, batch + n);
+      }
+    }
+    EXPECT_EQ(expected, actual) << lo << " " << hi;
+  }
+}
+
 #endif // FOLLY_QUOTIENT_MULTI_SET_SUPPORTED
@@ -169,6 +169,83 @@ TEST(SingleWriterFixedHashMap, copyTombstones) {
   copy_tombstones_test();
 }
 
+void batch_test() {
+  SWFHM m(32);
+  ASSERT_TRUE(m.insert(1, 10));
+  ASSERT_TRUE(m.erase(1));
+  ASSERT_TRUE(m.insert(2, 20));
+
+  // Key 1 reuses its tombstone, key 2 is present, key 3 repeats.
+  std::vector<std::pair<int, int>> batch{
+      {1, 1}, {2, 2}, {3, 3}, {3, 4}, {4, 4}};
+  ASSERT_EQ(m.insertBatch(batch.begin(), batch.end()), 3);
+  ASSERT_EQ(m.size(), 4);
+  ASSERT_EQ(m.used(), 4);
+  ASSERT_EQ(m.find(1).value(), 1);
+  ASSERT_EQ(m.find(2).value(), 20);
+  ASSERT_EQ(m.find(3).value(), 3);
+  ASSERT_EQ(m.find(4).value(), 4);
+  ASSERT_EQ(m.insertBatch(batch.begin(), batch.end()), 0);
+
+  int sum = 0;
+  for (auto it = m.begin(); it != m.end(); ++it) {
+    sum += it.value();
+  }
+  ASSERT_EQ(sum, 28);
+}
+
+TEST(SingleWriterFixedHashMap, batch) {
+  batch_test();
+}
+
+void batch_drf_test() {
+  SWFHM m(32);
+  int nthr = 5;
+  folly::test::Barrier b1(nthr + 1);
+  std::atomic<bool> stop{false};
+
+  std::vector<std::pair<int, int>> batch;
+  for (int j = 0; j < 10; ++j) {
+    batch.emplace_back(j, j);
+  }
+
+  auto writer = std::thread([&] {
+    b1.wait();
+    for (int i = 0; i < 10000; ++i) {
+      m.insertBatch(batch.begin(), batch.end());
+      for (int j = 0; j < 10; ++j) {
+        m.erase(j);
+      }
+    }
+    stop.store(true);
+  });
+
+  std::vector<std::thread> readers(nthr - 1);
+  for (int i = 0; i < nthr - 1; ++i) {
+    readers[i] = std::thread([&] {
+      b1.wait();
+      while (!stop) {
+        int sum = 0;
+        for (auto it = m.begin(); it != m.end(); ++it) {
+          ASSERT_EQ(it.key(), it.value());
+          sum += it.value();
+        }
+        ASSERT_LE(sum, 45);
+      }
+    });
+  }
+
+  b1.wait();
+  writer.join();
+  for (int i = 0; i < nthr - 1; ++i) {
+    readers[i].join();
+  }
+}
+
+TEST(SingleWriterFixedHashMap, batchDrf) {
+  batch_drf_test();
+}
+
 // Benchmarks
 
 template <typename Func>
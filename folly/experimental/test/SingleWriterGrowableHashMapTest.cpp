@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/experimental/SingleWriterGrowableHashMap.h>
+
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/test/Barrier.h>
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using SWGHM = folly::SingleWriterGrowableHashMap<int, int>;
+
+TEST(SingleWriterGrowableHashMap, basic) {
+  SWGHM m(4);
+  ASSERT_TRUE(m.empty());
+  ASSERT_FALSE(m.find(1).has_value());
+  ASSERT_EQ(m.capacity(), 4);
+
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(m.insert(i, i * 2));
+  }
+  ASSERT_FALSE(m.insert(5, 0));
+  ASSERT_EQ(m.size(), 100);
+  ASSERT_GE(m.capacity(), 128);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(m.find(i).value(), i * 2);
+  }
+
+  for (int i = 0; i < 50; ++i) {
+    ASSERT_TRUE(m.erase(i));
+  }
+  ASSERT_FALSE(m.erase(0));
+  ASSERT_EQ(m.size(), 50);
+  ASSERT_FALSE(m.contains(0));
+  ASSERT_TRUE(m.contains(50));
+
+  int sum = 0;
+  m.forEach([&](int, int value) { sum += value; });
+  ASSERT_EQ(sum, 2 * (50 + 99) * 50 / 2);
+}
+
+TEST(SingleWriterGrowableHashMap, tombstonesTriggerRebuild) {
+  SWGHM m(8);
+  // Churn through distinct keys: the live size stays small, so rebuilds
+  // drop tombstones instead of growing the table.
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(m.insert(i, i));
+    ASSERT_TRUE(m.erase(i));
+  }
+  ASSERT_TRUE(m.empty());
+  ASSERT_EQ(m.capacity(), 8);
+}
+
+TEST(SingleWriterGrowableHashMap, batch) {
+  SWGHM m(4);
+  std::vector<std::pair<int, int>> batch;
+  for (int i = 0; i < 100; ++i) {
+    batch.emplace_back(i % 60, i);
+  }
+  ASSERT_EQ(m.insertBatch(batch.begin(), batch.end()), 60);
+  ASSERT_EQ(m.size(), 60);
+  for (int i = 0; i < 60; ++i) {
+    ASSERT_EQ(m.find(i).value(), i);
+  }
+}
+
+TEST(SingleWriterGrowableHashMap, concurrentReaders) {
+  SWGHM m(4);
+  int nthr = 4;
+  folly::test::Barrier b1(nthr + 1);
+  std::atomic<bool> stop{false};
+
+  auto writer = std::thread([&] {
+    b1.wait();
+    for (int round = 0; round < 100; ++round) {
+      std::vector<std::pair<int, int>> batch;
+      for (int i = 0; i < 64; ++i) {
+        batch.emplace_back(round * 64 + i, round * 64 + i);
+      }
+      m.insertBatch(batch.begin(), batch.end());
+      for (int i = 0; i < 32; ++i) {
+        m.erase(round * 64 + i);
+      }
+    }
+    stop.store(true);
+  });
+
+  std::vector<std::thread> readers(nthr - 1);
+  for (int i = 0; i < nthr - 1; ++i) {
+    readers[i] = std::thread([&] {
+      b1.wait();
+      while (!stop) {
+        m.forEach([](int key, int value) { ASSERT_EQ(key, value); });
+        auto v = m.find(63);
+        if (v) {
+          ASSERT_EQ(*v, 63);
+        }
+      }
+    });
+  }
+
+  b1.wait();
+  writer.join();
+  for (int i = 0; i < nthr - 1; ++i) {
+    readers[i].join();
+  }
+  ASSERT_EQ(m.size(), 100 * 32);
+}
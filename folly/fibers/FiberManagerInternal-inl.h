@@ -29,6 +29,7 @@
 #include <folly/fibers/LoopController.h>
 #include <folly/fibers/Promise.h>
 #include <folly/tracing/AsyncStack.h>
+#include <folly/tracing/ScopedTraceSection.h>
 
 namespace folly {
 namespace fibers {
@@ -130,8 +131,15 @@ inline void FiberManager::runReadyFiber(Fiber* fiber) {
       fiber->state_ == Fiber::NOT_STARTED ||
       fiber->state_ == Fiber::READY_TO_RUN);
   currentFiber_ = fiber;
-  // Note: resetting the context is handled by the loop
-  RequestContext::setContext(std::move(fiber->rcontext_));
+  // Note: resetting the context is handled by the loop. The fiber keeps its
+  // reference to the context while it runs, so that fibers of the same
+  // request can switch without touching the reference count.
+  RequestContext::setContextIfChanged(fiber->rcontext_);
+
+  bool const timeSliced = options_.timeSlice.count() != 0;
+  if (timeSliced) {
+    timeSliceDeadline_ = std::chrono::steady_clock::now() + options_.timeSlice;
+  }
 
   (void)folly::exchangeCurrentAsyncStackRoot(
       std::exchange(fiber->asyncRoot_, nullptr));
@@ -149,6 +157,7 @@ inline void FiberManager::runReadyFiber(Fiber* fiber) {
 
   while (fiber->state_ == Fiber::NOT_STARTED ||
          fiber->state_ == Fiber::READY_TO_RUN) {
+    FOLLY_SCOPED_TRACE_SECTION("folly::fibers::FiberManager::runReadyFiber");
     activateFiber(fiber);
     if (fiber->state_ == Fiber::AWAITING_IMMEDIATE) {
       try {
@@ -161,12 +170,19 @@ inline void FiberManager::runReadyFiber(Fiber* fiber) {
     }
   }
 
+  if (timeSliced) {
+    if (!std::exchange(timeSliceYield_, false) &&
+        std::chrono::steady_clock::now() > timeSliceDeadline_) {
+      ++timeSliceOverruns_;
+    }
+  }
+
   if (fiber->state_ == Fiber::AWAITING) {
     awaitFunc_(*fiber);
     awaitFunc_ = nullptr;
     observersGuard.reset();
     currentFiber_ = nullptr;
-    fiber->rcontext_ = RequestContext::saveContext();
+    RequestContext::saveContextIfChanged(fiber->rcontext_);
     fiber->asyncRoot_ = folly::exchangeCurrentAsyncStackRoot(nullptr);
   } else if (fiber->state_ == Fiber::INVALID) {
     assert(fibersActive_.load(std::memory_order_relaxed) > 0);
@@ -211,7 +227,7 @@ inline void FiberManager::runReadyFiber(Fiber* fiber) {
   } else if (fiber->state_ == Fiber::YIELDED) {
     observersGuard.reset();
     currentFiber_ = nullptr;
-    fiber->rcontext_ = RequestContext::saveContext();
+    RequestContext::saveContextIfChanged(fiber->rcontext_);
     fiber->asyncRoot_ = folly::exchangeCurrentAsyncStackRoot(nullptr);
     fiber->state_ = Fiber::READY_TO_RUN;
     yieldedFibers_->push_back(*fiber);
@@ -587,6 +603,15 @@ inline void FiberManager::yield() {
   activeFiber_->preempt(Fiber::YIELDED);
 }
 
+inline void FiberManager::maybeYield() {
+  assert(getCurrentFiberManager() == this);
+  if (options_.timeSlice.count() != 0 && activeFiber_ != nullptr &&
+      std::chrono::steady_clock::now() > timeSliceDeadline_) {
+    timeSliceYield_ = true;
+    yield();
+  }
+}
+
 template <typename T>
 T& FiberManager::local() {
   if (std::type_index(typeid(T)) == localType_ && currentFiber_) {
@@ -615,7 +640,7 @@ FiberManager::FiberManager(
     std::unique_ptr<LoopController> loopController__,
     Options options)
     : loopController_(std::move(loopController__)),
-      stackAllocator_(options.guardPagesPerStack),
+      stackAllocator_(options.guardPagesPerStack, options.useSharedStackPool),
       options_(preprocessOptions(std::move(options))),
       exceptionCallback_(defaultExceptionCallback),
       fibersPoolResizer_(*this),
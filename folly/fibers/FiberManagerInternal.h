@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <queue>
@@ -124,6 +125,15 @@ class FiberManager : public ::folly::Executor {
      */
     size_t guardPagesPerStack{1};
 
+    /**
+     * Take fiber stacks from the process-wide SharedStackPool, rather than
+     * mapping them per FiberManager. The stacks come from huge-page-backed
+     * regions and are reused across FiberManagers. Every stack then has
+     * guardPagesPerStack guard pages, which split huge pages: set it to 0 to
+     * get the most out of them.
+     */
+    bool useSharedStackPool{false};
+
     /**
      * Free unnecessary fibers in the fibers pool every fibersPoolResizePeriodMs
      * milliseconds. If value is 0, periodic resizing of the fibers pool is
@@ -131,6 +141,14 @@ class FiberManager : public ::folly::Executor {
      */
     uint32_t fibersPoolResizePeriodMs{0};
 
+    /**
+     * How long a fiber may run before maybeYield() yields. Fibers that run
+     * longer than this without going through maybeYield() are counted in
+     * timeSliceOverruns(). If value is 0, time slicing is disabled and
+     * maybeYield() never yields.
+     */
+    std::chrono::microseconds timeSlice{0};
+
     constexpr Options() {}
 
     auto hash() const {
@@ -140,7 +158,9 @@ class FiberManager : public ::folly::Executor {
           recordStackEvery,
           maxFibersPoolSize,
           guardPagesPerStack,
-          fibersPoolResizePeriodMs);
+          useSharedStackPool,
+          fibersPoolResizePeriodMs,
+          timeSlice.count());
     }
   };
 
@@ -406,6 +426,22 @@ class FiberManager : public ::folly::Executor {
    */
   void yield();
 
+  /**
+   * Yield execution of the currently running fiber if it has been running for
+   * longer than Options::timeSlice, and return right away otherwise. This is
+   * cheap enough to call often from long-running computations, so that they
+   * don't starve the other fibers and the event loop. Must only be called
+   * from a fiber executing on this FiberManager.
+   */
+  void maybeYield();
+
+  /**
+   * @return How many times a fiber ran for longer than Options::timeSlice
+   * before it gave up the thread other than from maybeYield(), e.g. by
+   * blocking, finishing or calling yield().
+   */
+  size_t timeSliceOverruns() const { return timeSliceOverruns_; }
+
   /**
    * Setup fibers execution observation/instrumentation. Fiber locals are
    * available to observer.
@@ -498,6 +534,13 @@ class FiberManager : public ::folly::Executor {
                                       yielded execution */
   FiberTailQueue fibersPool_; /**< pool of uninitialized Fiber objects */
 
+  /**
+   * When the running fiber's time slice ends, if Options::timeSlice is set.
+   */
+  std::chrono::steady_clock::time_point timeSliceDeadline_;
+  bool timeSliceYield_{false}; /**< the running fiber is in maybeYield() */
+  size_t timeSliceOverruns_{0};
+
   GlobalFiberTailQueue allFibers_; /**< list of all Fiber objects owned */
 
   // total number of fibers allocated
@@ -725,6 +768,18 @@ inline void yield() {
     std::this_thread::yield();
   }
 }
+
+/**
+ * Preemption point for long-running fibers: yields if the calling fiber has
+ * used up the time slice of its FiberManager (see Options::timeSlice). Does
+ * nothing when not called from a fiber.
+ */
+inline void maybeYield() {
+  auto fm = FiberManager::getFiberManagerUnsafe();
+  if (fm && fm->currentFiber()) {
+    fm->maybeYield();
+  }
+}
 } // namespace fibers
 } // namespace folly
 
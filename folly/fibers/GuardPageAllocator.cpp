@@ -29,6 +29,7 @@
 #include <folly/Singleton.h>
 #include <folly/SpinLock.h>
 #include <folly/Synchronized.h>
+#include <folly/fibers/SharedStackPool.h>
 #include <folly/portability/SysMman.h>
 #include <folly/portability/Unistd.h>
 
@@ -148,6 +149,16 @@ class StackCache {
     PCHECK(0 == ::munmap(storage_, allocSize_ * kNumGuarded));
   }
 
+  static void addProtectedRange(const void* begin, size_t size) {
+    auto b = reinterpret_cast<intptr_t>(begin);
+    protectedRanges().wlock()->insert(std::make_pair(b, b + intptr_t(size)));
+  }
+
+  static void removeProtectedRange(const void* begin, size_t size) {
+    auto b = reinterpret_cast<intptr_t>(begin);
+    protectedRanges().wlock()->erase(std::make_pair(b, b + intptr_t(size)));
+  }
+
   static bool isProtected(intptr_t addr) {
     // Use a read lock for reading.
     return protectedRanges().withRLock([&](auto const& ranges) {
@@ -271,6 +282,21 @@ void installSignalHandler() {
 
 #endif
 
+namespace detail {
+
+void registerGuardPages(const void* begin, size_t size) {
+#ifndef _WIN32
+  installSignalHandler();
+#endif
+  StackCache::addProtectedRange(begin, size);
+}
+
+void unregisterGuardPages(const void* begin, size_t size) {
+  StackCache::removeProtectedRange(begin, size);
+}
+
+} // namespace detail
+
 /*
  * RAII Wrapper around a StackCache that calls
  * CacheManager::giveBack() on destruction.
@@ -331,8 +357,10 @@ StackCacheEntry::~StackCacheEntry() {
   CacheManager::instance().giveBack(std::move(stackCache_));
 }
 
-GuardPageAllocator::GuardPageAllocator(size_t guardPagesPerStack)
-    : guardPagesPerStack_(guardPagesPerStack) {
+GuardPageAllocator::GuardPageAllocator(
+    size_t guardPagesPerStack, bool useSharedStackPool)
+    : guardPagesPerStack_(guardPagesPerStack),
+      useSharedStackPool_(useSharedStackPool) {
 #ifndef _WIN32
   installSignalHandler();
 #endif
@@ -341,6 +369,10 @@ GuardPageAllocator::GuardPageAllocator(size_t guardPagesPerStack)
 GuardPageAllocator::~GuardPageAllocator() = default;
 
 unsigned char* GuardPageAllocator::allocate(size_t size) {
+  if (useSharedStackPool_) {
+    return SharedStackPool::instance().allocate(size, guardPagesPerStack_);
+  }
+
   if (guardPagesPerStack_ && !stackCache_) {
     stackCache_ =
         CacheManager::instance().getStackCache(size, guardPagesPerStack_);
@@ -356,6 +388,10 @@ unsigned char* GuardPageAllocator::allocate(size_t size) {
 }
 
 void GuardPageAllocator::deallocate(unsigned char* limit, size_t size) {
+  if (useSharedStackPool_) {
+    SharedStackPool::instance().deallocate(limit, size, guardPagesPerStack_);
+    return;
+  }
   if (!(stackCache_ && stackCache_->cache().giveBack(limit, size))) {
     fallbackAllocator_.deallocate(limit, size);
   }
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 namespace folly {
@@ -23,6 +24,19 @@ namespace fibers {
 
 class StackCacheEntry;
 
+namespace detail {
+
+/**
+ * Registers [begin, begin + size), which must be mprotected, as the guard
+ * pages of a fiber stack allocated elsewhere, so that a fault in it is
+ * reported as a fiber stack overflow, as for the stacks of
+ * GuardPageAllocator.
+ */
+void registerGuardPages(const void* begin, size_t size);
+void unregisterGuardPages(const void* begin, size_t size);
+
+} // namespace detail
+
 /**
  * Stack allocator that protects an extra memory page after
  * the end of the stack.
@@ -34,8 +48,12 @@ class GuardPageAllocator {
   /**
    * @param guardPagesPerStack  Protect a small number of fiber stacks
    *   with this many guard pages.  If 0, acts as std::allocator.
+   * @param useSharedStackPool  Take all the stacks from
+   *   SharedStackPool::instance() instead, each with guardPagesPerStack
+   *   guard pages.
    */
-  explicit GuardPageAllocator(size_t guardPagesPerStack);
+  explicit GuardPageAllocator(
+      size_t guardPagesPerStack, bool useSharedStackPool = false);
   ~GuardPageAllocator();
 
   /**
@@ -52,6 +70,7 @@ class GuardPageAllocator {
   std::unique_ptr<StackCacheEntry> stackCache_;
   std::allocator<unsigned char> fallbackAllocator_;
   size_t guardPagesPerStack_{0};
+  bool useSharedStackPool_{false};
 };
 } // namespace fibers
 } // namespace folly
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <folly/Executor.h>
+#include <folly/Function.h>
+#include <folly/Optional.h>
+#include <folly/futures/Future.h>
+#include <folly/futures/Promise.h>
+
+namespace folly {
+namespace fibers {
+
+/**
+ * SharedBatchDispatcher batches values added from any number of threads,
+ * e.g. by fibers running on the FiberManagers of several EventBases, and
+ * passes each batch to a single dispatch function.
+ *
+ * Where BatchDispatcher relies on the order in which one executor runs its
+ * tasks to decide when a batch is complete, and so only batches within one
+ * FiberManager, SharedBatchDispatcher is thread safe and dispatches the
+ * pending values when either
+ *  - options.maxBatchSize values are pending, or
+ *  - options.maxDelay has passed since the first pending value was added,
+ * whichever comes first.
+ *
+ * The dispatch function consumes a vector of values and returns a vector of
+ * results in the same order, as for BatchDispatcher. It runs on the executor
+ * given to the constructor, and may run concurrently with itself if that
+ * executor is multithreaded. add() returns a SemiFuture for the result of
+ * its value; a fiber that waits on it with get() is suspended, not its
+ * thread, and resumes on its own FiberManager once the batch is dispatched.
+ *
+ * Example:
+ *   SharedBatchDispatcher<Key, Row> dispatcher(
+ *       getGlobalCPUExecutor(),
+ *       [&](std::vector<Key>&& keys) { return storage.multiGet(keys); });
+ *
+ *   // From fibers on any IO thread:
+ *   Row row = dispatcher.add(key).get();
+ *
+ * Values still pending when the SharedBatchDispatcher is destroyed are
+ * dispatched right away.
+ */
+template <typename ValueT, typename ResultT>
+class SharedBatchDispatcher {
+ public:
+  using ValueBatchT = std::vector<ValueT>;
+  using ResultBatchT = std::vector<ResultT>;
+  using PromiseBatchT = std::vector<folly::Promise<ResultT>>;
+  using DispatchFunctionT = folly::Function<ResultBatchT(ValueBatchT&&)>;
+
+  struct Options {
+    // Dispatch as soon as this many values are pending.
+    size_t maxBatchSize{100};
+    // Dispatch the pending values at most this long after the first of them
+    // was added.
+    std::chrono::microseconds maxDelay{std::chrono::milliseconds(1)};
+  };
+
+  SharedBatchDispatcher(
+      Executor::KeepAlive<> executor,
+      DispatchFunctionT dispatchFunc,
+      Options options = Options())
+      : state_(std::make_shared<DispatchState>(
+            std::move(executor), std::move(dispatchFunc), options)) {
+    if (options.maxBatchSize == 0) {
+      throw std::invalid_argument("maxBatchSize must be positive");
+    }
+  }
+
+  SharedBatchDispatcher(const SharedBatchDispatcher&) = delete;
+  SharedBatchDispatcher& operator=(const SharedBatchDispatcher&) = delete;
+
+  ~SharedBatchDispatcher() { flush(); }
+
+  SemiFuture<ResultT> add(ValueT value) {
+    folly::Promise<ResultT> resultPromise;
+    auto resultFuture = resultPromise.getSemiFuture();
+
+    ValueBatchT values;
+    PromiseBatchT promises;
+    bool startTimer = false;
+    uint64_t batchId;
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      startTimer = state_->values.empty();
+      batchId = state_->batchId;
+      state_->values.emplace_back(std::move(value));
+      state_->promises.emplace_back(std::move(resultPromise));
+      if (state_->values.size() >= state_->options.maxBatchSize) {
+        state_->takeBatch(values, promises);
+        startTimer = false;
+      }
+    }
+
+    if (!values.empty()) {
+      auto& executor = state_->executor;
+      executor->add([state = state_,
+                     values = std::move(values),
+                     promises = std::move(promises)]() mutable {
+        state->dispatch(std::move(values), promises);
+      });
+    } else if (startTimer) {
+      // The timer only holds a weak reference, so that it doesn't keep the
+      // executor alive past the SharedBatchDispatcher, which flushes on
+      // destruction anyway.
+      folly::futures::sleep(state_->options.maxDelay)
+          .toUnsafeFuture()
+          .thenTry([weakState = std::weak_ptr<DispatchState>(state_),
+                    batchId](Try<Unit>&&) {
+            // Whether the timer fired or failed (e.g. at shutdown), the batch
+            // must not be left pending.
+            if (auto state = weakState.lock()) {
+              state->executor->add([state, batchId] {
+                state->flushBatch(batchId);
+              });
+            }
+          });
+    }
+
+    return resultFuture;
+  }
+
+  // Dispatches the pending values now, on the calling thread.
+  void flush() { state_->flushBatch(folly::none); }
+
+ private:
+  struct DispatchState {
+    DispatchState(
+        Executor::KeepAlive<>&& executor_,
+        DispatchFunctionT&& dispatchFunction,
+        const Options& options_)
+        : executor(std::move(executor_)),
+          dispatchFunc(std::move(dispatchFunction)),
+          options(options_) {}
+
+    // Moves the pending values out and starts a new batch. Called under the
+    // mutex.
+    void takeBatch(ValueBatchT& outValues, PromiseBatchT& outPromises) {
+      values.swap(outValues);
+      promises.swap(outPromises);
+      ++batchId;
+    }
+
+    // Dispatches the pending values if they are still the batch with the
+    // given id, or whatever is pending if none is given.
+    void flushBatch(folly::Optional<uint64_t> id) {
+      ValueBatchT batchValues;
+      PromiseBatchT batchPromises;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if ((id && *id != batchId) || values.empty()) {
+          return;
+        }
+        takeBatch(batchValues, batchPromises);
+      }
+      dispatch(std::move(batchValues), batchPromises);
+    }
+
+    void dispatch(ValueBatchT&& batchValues, PromiseBatchT& batchPromises) {
+      try {
+        auto results = dispatchFunc(std::move(batchValues));
+        if (results.size() != batchPromises.size()) {
+          throw std::logic_error(
+              "Unexpected number of results returned from dispatch function");
+        }
+
+        for (size_t i = 0; i < batchPromises.size(); i++) {
+          batchPromises[i].setValue(std::move(results[i]));
+        }
+      } catch (...) {
+        for (size_t i = 0; i < batchPromises.size(); i++) {
+          batchPromises[i].setException(
+              exception_wrapper(std::current_exception()));
+        }
+      }
+    }
+
+    const Executor::KeepAlive<> executor;
+    DispatchFunctionT dispatchFunc;
+    const Options options;
+
+    std::mutex mutex;
+    ValueBatchT values;
+    PromiseBatchT promises;
+    // Incremented whenever the pending values are taken, so that a timer
+    // started for an earlier batch doesn't flush a later one early.
+    uint64_t batchId{0};
+  };
+
+  std::shared_ptr<DispatchState> state_;
+};
+
+} // namespace fibers
+} // namespace folly
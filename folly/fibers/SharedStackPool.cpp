@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/fibers/SharedStackPool.h>
+
+#include <glog/logging.h>
+
+#include <folly/fibers/GuardPageAllocator.h>
+#include <folly/portability/SysMman.h>
+#include <folly/portability/Unistd.h>
+
+namespace folly {
+namespace fibers {
+
+namespace {
+
+size_t pagesize() {
+  static const auto pagesize = size_t(sysconf(_SC_PAGESIZE));
+  return pagesize;
+}
+
+// Maps bytes, a multiple of align, at an address aligned on align.
+unsigned char* mapAligned(size_t bytes, size_t align) {
+#ifdef _WIN32
+  // Mappings cannot be trimmed, and are only aligned on the allocation
+  // granularity.
+  auto p = ::mmap(
+      nullptr,
+      bytes,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0);
+  PCHECK(p != MAP_FAILED);
+  return static_cast<unsigned char*>(p);
+#else
+  auto p = ::mmap(
+      nullptr,
+      bytes + align,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0);
+  PCHECK(p != MAP_FAILED);
+  auto begin = static_cast<unsigned char*>(p);
+  auto aligned = reinterpret_cast<unsigned char*>(
+      (reinterpret_cast<uintptr_t>(begin) + align - 1) & ~(align - 1));
+  if (aligned != begin) {
+    PCHECK(0 == ::munmap(begin, size_t(aligned - begin)));
+  }
+  auto tail = size_t(begin + bytes + align - (aligned + bytes));
+  if (tail != 0) {
+    PCHECK(0 == ::munmap(aligned + bytes, tail));
+  }
+  return aligned;
+#endif
+}
+
+} // namespace
+
+/* static */ SharedStackPool& SharedStackPool::instance() {
+  static auto inst = new SharedStackPool();
+  return *inst;
+}
+
+SharedStackPool::SharedStackPool() : SharedStackPool(Options{}) {}
+
+SharedStackPool::SharedStackPool(Options options, NumaTopology topology)
+    : options_(std::move(options)), topology_(std::move(topology)) {
+  CHECK_GE(options_.regionSize, pagesize());
+  CHECK_EQ(0, options_.regionSize & (options_.regionSize - 1))
+      << "regionSize must be a power of two";
+  nodes_.reserve(topology_.numNodes());
+  for (size_t i = 0; i < topology_.numNodes(); ++i) {
+    nodes_.push_back(std::make_unique<Node>());
+  }
+}
+
+SharedStackPool::~SharedStackPool() {
+  for (auto& guard : guards_) {
+    detail::unregisterGuardPages(guard.first, guard.second);
+  }
+  for (auto& region : regions_) {
+    PCHECK(0 == ::munmap(region.first, region.second));
+  }
+}
+
+/* static */ size_t SharedStackPool::allocSize(size_t size, size_t guardPages) {
+  return pagesize() * ((size + pagesize() - 1) / pagesize() + guardPages);
+}
+
+unsigned char* SharedStackPool::allocate(size_t size, size_t guardPages) {
+  auto as = allocSize(size, guardPages);
+  auto& node = currentNode();
+  numAllocations_.fetch_add(1, std::memory_order_relaxed);
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(node.mutex);
+      auto& freeList = node.freeLists[std::make_pair(as, guardPages)];
+      if (!freeList.empty()) {
+        auto stack = freeList.back();
+        freeList.pop_back();
+        if (stack.resident) {
+          node.residentBytes.fetch_sub(as, std::memory_order_relaxed);
+          numReused_.fetch_add(1, std::memory_order_relaxed);
+        }
+        // As for GuardPageAllocator, the stack is aligned at the top of its
+        // pages and the guard pages are at the bottom.
+        return stack.base + as - size;
+      }
+    }
+    carveRegion(node, as, guardPages);
+  }
+}
+
+void SharedStackPool::deallocate(
+    unsigned char* limit, size_t size, size_t guardPages) {
+  auto as = allocSize(size, guardPages);
+  auto base = limit + size - as;
+  auto& node = currentNode();
+  // Racy, so the limit may be slightly overshot.
+  bool resident = node.residentBytes.load(std::memory_order_relaxed) + as <=
+      options_.maxResidentBytesPerNode;
+  if (resident) {
+    node.residentBytes.fetch_add(as, std::memory_order_relaxed);
+  } else {
+    auto guardBytes = pagesize() * guardPages;
+    PCHECK(0 == ::madvise(base + guardBytes, as - guardBytes, MADV_DONTNEED));
+  }
+  std::lock_guard<std::mutex> lock(node.mutex);
+  node.freeLists[std::make_pair(as, guardPages)].push_back({base, resident});
+}
+
+SharedStackPool::Stats SharedStackPool::stats() const {
+  Stats stats;
+  stats.mappedBytes = mappedBytes_.load(std::memory_order_relaxed);
+  stats.numAllocations = numAllocations_.load(std::memory_order_relaxed);
+  stats.numReused = numReused_.load(std::memory_order_relaxed);
+  for (auto& node : nodes_) {
+    std::lock_guard<std::mutex> lock(node->mutex);
+    for (auto& entry : node->freeLists) {
+      stats.freeStacks += entry.second.size();
+    }
+    stats.residentFreeBytes +=
+        node->residentBytes.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+SharedStackPool::Node& SharedStackPool::currentNode() {
+  return *nodes_[topology_.currentNode()];
+}
+
+void SharedStackPool::carveRegion(
+    Node& node, size_t allocSize, size_t guardPages) {
+  auto regionSize = options_.regionSize;
+  auto bytes = (allocSize + regionSize - 1) / regionSize * regionSize;
+  auto region = mapAligned(bytes, regionSize);
+#ifdef MADV_HUGEPAGE
+  if (options_.useHugePages) {
+    // Only a hint: transparent huge pages may be disabled.
+    ::madvise(region, bytes, MADV_HUGEPAGE);
+  }
+#endif
+  auto count = bytes / allocSize;
+  auto guardBytes = pagesize() * guardPages;
+  std::vector<FreeStack> stacks;
+  stacks.reserve(count);
+  // Pushed in reverse so that the lowest addresses are used first.
+  for (size_t i = count; i-- > 0;) {
+    auto base = region + allocSize * i;
+    if (guardPages != 0) {
+      PCHECK(0 == ::mprotect(base, guardBytes, PROT_NONE));
+      detail::registerGuardPages(base, guardBytes);
+    }
+    stacks.push_back({base, /* resident= */ false});
+  }
+  {
+    std::lock_guard<std::mutex> lock(regionsMutex_);
+    regions_.emplace_back(region, bytes);
+    if (guardPages != 0) {
+      for (auto& stack : stacks) {
+        guards_.emplace_back(stack.base, guardBytes);
+      }
+    }
+  }
+  mappedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(node.mutex);
+  auto& freeList = node.freeLists[std::make_pair(allocSize, guardPages)];
+  freeList.insert(freeList.begin(), stacks.begin(), stacks.end());
+}
+
+} // namespace fibers
+} // namespace folly
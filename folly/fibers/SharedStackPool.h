@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <folly/system/NumaTopology.h>
+
+namespace folly {
+namespace fibers {
+
+/**
+ * A process-wide cache of fiber stacks, shared by all the FiberManagers
+ * created with Options::useSharedStackPool.
+ *
+ * Stacks are carved out of large anonymous mappings, aligned on and sized in
+ * multiples of Options::regionSize (2MB), which are madvised MADV_HUGEPAGE
+ * so that the kernel can back them with transparent huge pages. Freed
+ * stacks go back to a free list instead of being unmapped, so managers that
+ * come and go reuse the same memory, and many small stacks share a few TLB
+ * entries, instead of paying for a mapping per stack or per manager.
+ *
+ * Free lists are per NUMA node, both for allocation and deallocation the
+ * node being the one of the calling thread: with first-touch placement, a
+ * reused stack is most likely backed by memory local to that node.
+ *
+ * Guard pages are optional: the bottom guardPages pages of each stack are
+ * mprotected when its region is carved, and stay so. They are registered
+ * with the SIGSEGV handler of GuardPageAllocator, so that overflowing into
+ * them is reported as a fiber stack overflow. Note that protecting
+ * a page splits the huge page it is part of, so guard pages and huge pages
+ * only go together for stacks of several megabytes.
+ *
+ * Each node keeps up to Options::maxResidentBytesPerNode of free stacks
+ * resident, for quick reuse. Stacks freed past that are madvised
+ * MADV_DONTNEED, giving their memory back to the system while keeping the
+ * address space for later reuse. Regions are only unmapped when the pool is
+ * destroyed, which instance() never is.
+ */
+class SharedStackPool {
+ public:
+  struct Options {
+    size_t regionSize{size_t(2) << 20};
+    bool useHugePages{true};
+    size_t maxResidentBytesPerNode{size_t(64) << 20};
+  };
+
+  struct Stats {
+    size_t mappedBytes{0};
+    size_t freeStacks{0};
+    size_t residentFreeBytes{0};
+    uint64_t numAllocations{0};
+    uint64_t numReused{0};
+  };
+
+  static SharedStackPool& instance();
+
+  SharedStackPool();
+  explicit SharedStackPool(
+      Options options, NumaTopology topology = NumaTopology::system());
+
+  SharedStackPool(const SharedStackPool&) = delete;
+  SharedStackPool& operator=(const SharedStackPool&) = delete;
+
+  /// All the stacks must have been deallocated.
+  ~SharedStackPool();
+
+  /**
+   * @return pointer to the bottom of a stack of `size' bytes, preceded by
+   *   guardPages protected pages.
+   */
+  unsigned char* allocate(size_t size, size_t guardPages);
+
+  /**
+   * Gives back the previous result of an `allocate(size, guardPages)' call.
+   */
+  void deallocate(unsigned char* limit, size_t size, size_t guardPages);
+
+  Stats stats() const;
+
+  /// Bytes taken by a stack of size bytes with guardPages guard pages.
+  static size_t allocSize(size_t size, size_t guardPages);
+
+ private:
+  struct FreeStack {
+    unsigned char* base;
+    bool resident;
+  };
+
+  struct Node {
+    std::mutex mutex;
+    // Keyed by (allocSize, guardPages), LIFO.
+    std::map<std::pair<size_t, size_t>, std::vector<FreeStack>> freeLists;
+    std::atomic<size_t> residentBytes{0};
+  };
+
+  Node& currentNode();
+  void carveRegion(Node& node, size_t allocSize, size_t guardPages);
+
+  const Options options_;
+  const NumaTopology topology_;
+  std::vector<std::unique_ptr<Node>> nodes_;
+
+  mutable std::mutex regionsMutex_;
+  std::vector<std::pair<void*, size_t>> regions_;
+  // Registered guard pages, as (begin, size).
+  std::vector<std::pair<void*, size_t>> guards_;
+  std::atomic<size_t> mappedBytes_{0};
+  std::atomic<uint64_t> numAllocations_{0};
+  std::atomic<uint64_t> numReused_{0};
+};
+
+} // namespace fibers
+} // namespace folly
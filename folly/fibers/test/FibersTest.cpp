@@ -17,6 +17,7 @@
 #include <array>
 #include <atomic>
 #include <chrono>
+#include <cstring>
 #include <thread>
 #include <vector>
 
@@ -35,6 +36,8 @@
 #include <folly/fibers/FiberManagerMap.h>
 #include <folly/fibers/GenericBaton.h>
 #include <folly/fibers/Semaphore.h>
+#include <folly/fibers/SharedBatchDispatcher.h>
+#include <folly/fibers/SharedStackPool.h>
 #include <folly/fibers/SimpleLoopController.h>
 #include <folly/fibers/TimedMutex.h>
 #include <folly/fibers/WhenN.h>
@@ -1422,6 +1425,73 @@ TEST(FiberManager, yieldTest) {
   EXPECT_TRUE(checkRan);
 }
 
+TEST(FiberManager, maybeYieldTest) {
+  FiberManager::Options opts;
+  opts.timeSlice = std::chrono::milliseconds(1);
+  FiberManager manager(std::make_unique<SimpleLoopController>(), opts);
+  auto& loopController =
+      dynamic_cast<SimpleLoopController&>(manager.loopController());
+
+  // A fiber that spins until another one runs, which it lets in through
+  // maybeYield() once its time slice is used up.
+  bool otherRan = false;
+  size_t yieldChecks = 0;
+  manager.addTask([&]() {
+    while (!otherRan) {
+      ++yieldChecks;
+      maybeYield();
+    }
+  });
+  manager.addTask([&]() { otherRan = true; });
+
+  loopController.loop([&]() {
+    if (!manager.hasTasks()) {
+      loopController.stop();
+    }
+  });
+
+  EXPECT_TRUE(otherRan);
+  EXPECT_GT(yieldChecks, 1);
+  EXPECT_EQ(0, manager.timeSliceOverruns());
+
+  // Spinning without yield points is recorded as an overrun.
+  manager.addTask([&]() {
+    auto const end =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+    while (std::chrono::steady_clock::now() < end) {
+    }
+  });
+  loopController.loop([&]() {
+    if (!manager.hasTasks()) {
+      loopController.stop();
+    }
+  });
+  EXPECT_EQ(1, manager.timeSliceOverruns());
+}
+
+TEST(FiberManager, maybeYieldWithoutTimeSliceTest) {
+  FiberManager manager(std::make_unique<SimpleLoopController>());
+  auto& loopController =
+      dynamic_cast<SimpleLoopController&>(manager.loopController());
+
+  bool otherRan = false;
+  manager.addTask([&]() {
+    for (int i = 0; i < 1000; ++i) {
+      maybeYield();
+      EXPECT_FALSE(otherRan);
+    }
+  });
+  manager.addTask([&]() { otherRan = true; });
+
+  loopController.loop([&]() {
+    if (!manager.hasTasks()) {
+      loopController.stop();
+    }
+  });
+  EXPECT_TRUE(otherRan);
+  EXPECT_EQ(0, manager.timeSliceOverruns());
+}
+
 TEST(FiberManager, RequestContext) {
   FiberManager fm(std::make_unique<SimpleLoopController>());
 
@@ -2201,6 +2271,85 @@ TEST(FiberManager, batchDispatchExceptionHandlingTest) {
   evb.loop();
 }
 
+TEST(FiberManager, sharedBatchDispatchTest) {
+  constexpr int kThreads = 4;
+  constexpr int kFibersPerThread = 25;
+  std::atomic<int> dispatches{0};
+  folly::CPUThreadPoolExecutor dispatchExecutor(1);
+  SharedBatchDispatcher<int, std::string>::Options options;
+  options.maxBatchSize = kThreads * kFibersPerThread / 4;
+  options.maxDelay = std::chrono::seconds(60);
+  SharedBatchDispatcher<int, std::string> batchDispatcher(
+      &dispatchExecutor,
+      [&](std::vector<int>&& batch) {
+        EXPECT_EQ(kThreads * kFibersPerThread / 4, batch.size());
+        ++dispatches;
+        std::vector<std::string> results;
+        for (auto& it : batch) {
+          results.push_back(folly::to<std::string>(it));
+        }
+        return results;
+      },
+      options);
+
+  // Fibers on several EventBases fill shared batches, and each gets back
+  // the result for its own value.
+  std::vector<std::unique_ptr<folly::ScopedEventBaseThread>> threads;
+  std::vector<folly::Future<folly::Unit>> done;
+  for (int t = 0; t < kThreads; t++) {
+    threads.push_back(std::make_unique<folly::ScopedEventBaseThread>());
+    auto& fm = getFiberManager(*threads.back()->getEventBase());
+    for (int i = 0; i < kFibersPerThread; i++) {
+      auto value = t * kFibersPerThread + i;
+      done.push_back(fm.addTaskRemoteFuture([&, value] {
+        EXPECT_EQ(
+            folly::to<std::string>(value), batchDispatcher.add(value).get());
+      }));
+    }
+  }
+  folly::collectAll(done).get();
+  EXPECT_EQ(4, dispatches.load());
+}
+
+TEST(FiberManager, sharedBatchDispatchTimeoutTest) {
+  folly::CPUThreadPoolExecutor dispatchExecutor(1);
+  SharedBatchDispatcher<int, int>::Options options;
+  options.maxDelay = std::chrono::milliseconds(10);
+  SharedBatchDispatcher<int, int> batchDispatcher(
+      &dispatchExecutor,
+      [](std::vector<int>&& batch) {
+        EXPECT_EQ(3, batch.size());
+        return std::move(batch);
+      },
+      options);
+
+  // Fewer values than maxBatchSize are dispatched once maxDelay passes.
+  folly::EventBase evb;
+  auto& fm = getFiberManager(evb);
+  for (int i = 0; i < 3; i++) {
+    fm.addTask([&, i] { EXPECT_EQ(i, batchDispatcher.add(i).get()); });
+  }
+  evb.loop();
+}
+
+TEST(FiberManager, sharedBatchDispatchExceptionHandlingTest) {
+  folly::CPUThreadPoolExecutor dispatchExecutor(1);
+  auto values = std::vector<folly::SemiFuture<int>>();
+  {
+    SharedBatchDispatcher<int, int> batchDispatcher(
+        &dispatchExecutor, [](std::vector<int>&&) -> std::vector<int> {
+          throw std::runtime_error("Surprise!!");
+        });
+    for (int i = 0; i < 5; i++) {
+      values.push_back(batchDispatcher.add(i));
+    }
+    // Pending values are dispatched on destruction.
+  }
+  for (auto& value : values) {
+    EXPECT_THROW(std::move(value).get(), std::runtime_error);
+  }
+}
+
 namespace AtomicBatchDispatcherTesting {
 
 using ValueT = size_t;
@@ -2983,3 +3132,101 @@ TEST(FiberManager, EventBaseMigratingThreads) {
 
   EXPECT_TRUE(f.isReady());
 }
+
+TEST(SharedStackPool, reuse) {
+  SharedStackPool::Options options;
+  options.maxResidentBytesPerNode = size_t(1) << 20;
+  SharedStackPool pool(options, folly::NumaTopology({}));
+  constexpr size_t kSize = 16 * 1024;
+
+  auto a = pool.allocate(kSize, 1);
+  auto b = pool.allocate(kSize, 1);
+  EXPECT_NE(a, b);
+  std::memset(a, 'a', kSize);
+  std::memset(b, 'b', kSize);
+  auto stats = pool.stats();
+  EXPECT_EQ(options.regionSize, stats.mappedBytes);
+  EXPECT_EQ(
+      options.regionSize / SharedStackPool::allocSize(kSize, 1) - 2,
+      stats.freeStacks);
+
+  pool.deallocate(a, kSize, 1);
+  EXPECT_EQ(
+      SharedStackPool::allocSize(kSize, 1), pool.stats().residentFreeBytes);
+  // Freed stacks are reused first, with their contents.
+  EXPECT_EQ(a, pool.allocate(kSize, 1));
+  EXPECT_EQ('a', a[0]);
+  EXPECT_EQ(1, pool.stats().numReused);
+
+  // Stacks of another size or with other guard pages are kept apart.
+  auto c = pool.allocate(kSize, 0);
+  EXPECT_NE(a, c);
+  EXPECT_NE(b, c);
+  EXPECT_EQ(2 * options.regionSize, pool.stats().mappedBytes);
+
+  pool.deallocate(a, kSize, 1);
+  pool.deallocate(b, kSize, 1);
+  pool.deallocate(c, kSize, 0);
+  EXPECT_EQ(4, pool.stats().numAllocations);
+}
+
+TEST(SharedStackPool, releaseMemory) {
+  SharedStackPool::Options options;
+  options.maxResidentBytesPerNode = 0;
+  SharedStackPool pool(options, folly::NumaTopology({}));
+  constexpr size_t kSize = 64 * 1024;
+
+  auto a = pool.allocate(kSize, 0);
+  std::memset(a, 'a', kSize);
+  pool.deallocate(a, kSize, 0);
+  EXPECT_EQ(0, pool.stats().residentFreeBytes);
+  // The memory was given back, so the stack reads as zeros again.
+  EXPECT_EQ(a, pool.allocate(kSize, 0));
+  EXPECT_EQ(0, a[0]);
+  EXPECT_EQ(0, a[kSize - 1]);
+  EXPECT_EQ(0, pool.stats().numReused);
+  pool.deallocate(a, kSize, 0);
+}
+
+TEST(SharedStackPool, guardPageOverflow) {
+  SharedStackPool pool(SharedStackPool::Options{}, folly::NumaTopology({}));
+  constexpr size_t kSize = 16 * 1024;
+
+  auto a = pool.allocate(kSize, 1);
+  EXPECT_DEATH(
+      { static_cast<volatile unsigned char*>(a)[-1] = 0; },
+      "Fiber stack overflow detected");
+  pool.deallocate(a, kSize, 1);
+}
+
+TEST(FiberManager, sharedStackPool) {
+  FiberManager::Options opts;
+  opts.useSharedStackPool = true;
+  opts.guardPagesPerStack = 0;
+  auto& pool = SharedStackPool::instance();
+
+  auto runTasks = [&] {
+    folly::EventBase evb;
+    auto& fm = getFiberManager(evb, opts);
+    int ran = 0;
+    for (int i = 0; i < 10; ++i) {
+      fm.addTask([&] {
+        folly::fibers::yield();
+        ++ran;
+      });
+    }
+    evb.loop();
+    EXPECT_EQ(10, ran);
+  };
+
+  runTasks();
+  auto before = pool.stats();
+  EXPECT_GT(before.numAllocations, 0);
+  EXPECT_GE(before.freeStacks, 10);
+
+  // A new FiberManager gets the stacks of the previous one.
+  runTasks();
+  auto after = pool.stats();
+  EXPECT_EQ(before.mappedBytes, after.mappedBytes);
+  EXPECT_GT(after.numReused, before.numReused);
+}
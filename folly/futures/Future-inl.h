@@ -1437,6 +1437,89 @@ void stealDeferredExecutors(
     }
   }
 }
+
+// Context of collectAll() and collectAny() over a range of futures.
+//
+// A single atomic serves both as the countdown of the input futures and as
+// the reference count of the context: it starts with one reference per
+// input, plus one for the caller while the callbacks are installed. Each
+// callback owns its reference, and releases it when it is invoked or, for
+// callbacks that executors drop without invoking them, when destroyed.
+// Whoever releases the last reference calls Derived::finish() and deletes
+// the context. Unlike a shared_ptr copied into every callback, this costs
+// one atomic update per input.
+template <typename Derived>
+class CollectRangeContext {
+ public:
+  explicit CollectRangeContext(size_t n) : refs_(n + 1) {}
+
+  void release(size_t n, Executor::KeepAlive<>&& ka = {}) {
+    if (refs_.fetch_sub(n, std::memory_order_acq_rel) == n) {
+      auto derived = static_cast<Derived*>(this);
+      derived->finish(std::move(ka));
+      delete derived;
+    }
+  }
+
+ private:
+  std::atomic<size_t> refs_;
+};
+
+// Callback for the input future at index i of a CollectRangeContext. f is
+// called with the context, i and the result of the input future.
+template <typename Context, typename F>
+class CollectRangeCallback {
+ public:
+  CollectRangeCallback(Context* ctx, size_t i, F f) noexcept
+      : ctx_(ctx), i_(i), f_(std::move(f)) {}
+
+  CollectRangeCallback(CollectRangeCallback&& that) noexcept
+      : ctx_(std::exchange(that.ctx_, nullptr)),
+        i_(that.i_),
+        f_(std::move(that.f_)) {}
+  CollectRangeCallback& operator=(CollectRangeCallback&&) = delete;
+
+  ~CollectRangeCallback() {
+    if (ctx_) {
+      ctx_->release(1);
+    }
+  }
+
+  template <typename T>
+  void operator()(Executor::KeepAlive<>&& ka, Try<T>&& t) {
+    f_(*ctx_, i_, std::move(t));
+    std::exchange(ctx_, nullptr)->release(1, std::move(ka));
+  }
+
+ private:
+  Context* ctx_;
+  size_t i_;
+  F f_;
+};
+
+// Installs the callbacks of a CollectRangeContext created for the n futures
+// in [first, last), and then releases the reference of the caller, which
+// may finish the context right away. f is as for CollectRangeCallback.
+template <typename Context, typename InputIterator, typename F>
+void installCollectRangeCallbacks(
+    Context* ctx,
+    size_t n,
+    InputIterator first,
+    InputIterator last,
+    F f,
+    InlineContinuation allowInline) {
+  size_t installed = 0;
+  // If installing a callback throws, that callback releases its reference
+  // when destroyed, but the inputs after it never get one.
+  auto guard = makeGuard([&] { ctx->release(n - installed); });
+  for (; first != last; ++first) {
+    first->setCallback_(
+        CollectRangeCallback<Context, F>(ctx, installed, f), allowInline);
+    ++installed;
+  }
+  guard.dismiss();
+  ctx->release(1);
+}
 } // namespace detail
 } // namespace futures
 
@@ -1491,35 +1574,31 @@ collectAll(InputIterator first, InputIterator last) {
   using F = typename std::iterator_traits<InputIterator>::value_type;
   using T = typename F::value_type;
 
-  struct Context {
-    explicit Context(size_t n) : results(n), count(n) {}
-    ~Context() {
+  struct Context : futures::detail::CollectRangeContext<Context> {
+    explicit Context(size_t n)
+        : futures::detail::CollectRangeContext<Context>(n), results(n) {}
+    void finish(Executor::KeepAlive<>&& ka) {
       futures::detail::setTry(
           p, std::move(ka), Try<std::vector<Try<T>>>(std::move(results)));
     }
     Promise<std::vector<Try<T>>> p;
-    Executor::KeepAlive<> ka;
     std::vector<Try<T>> results;
-    std::atomic<size_t> count;
   };
 
   std::vector<futures::detail::DeferredWrapper> executors;
   futures::detail::stealDeferredExecutors(executors, first, last);
 
-  auto ctx = std::make_shared<Context>(size_t(std::distance(first, last)));
-
-  for (size_t i = 0; first != last; ++first, ++i) {
-    first->setCallback_(
-        [i, ctx](Executor::KeepAlive<>&& ka, Try<T>&& t) {
-          ctx->results[i] = std::move(t);
-          if (ctx->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
-            ctx->ka = std::move(ka);
-          }
-        },
-        futures::detail::InlineContinuation::permit);
-  }
-
+  auto n = size_t(std::distance(first, last));
+  auto ctx = new Context(n);
   auto future = ctx->p.getSemiFuture();
+  futures::detail::installCollectRangeCallbacks(
+      ctx,
+      n,
+      first,
+      last,
+      [](Context& c, size_t i, Try<T>&& t) { c.results[i] = std::move(t); },
+      futures::detail::InlineContinuation::permit);
+
   if (!executors.empty()) {
     future = std::move(future).defer(
         [](Try<typename decltype(future)::value_type>&& t) {
@@ -1702,7 +1781,9 @@ collectAny(InputIterator first, InputIterator last) {
   using F = typename std::iterator_traits<InputIterator>::value_type;
   using T = typename F::value_type;
 
-  struct Context {
+  struct Context : futures::detail::CollectRangeContext<Context> {
+    using futures::detail::CollectRangeContext<Context>::CollectRangeContext;
+    void finish(Executor::KeepAlive<>&&) {}
     Promise<std::pair<size_t, Try<T>>> p;
     std::atomic<bool> done{false};
   };
@@ -1710,15 +1791,24 @@ collectAny(InputIterator first, InputIterator last) {
   std::vector<futures::detail::DeferredWrapper> executors;
   futures::detail::stealDeferredExecutors(executors, first, last);
 
-  auto ctx = std::make_shared<Context>();
-  for (size_t i = 0; first != last; ++first, ++i) {
-    first->setCallback_([i, ctx](Executor::KeepAlive<>&&, Try<T>&& t) {
-      if (!ctx->done.exchange(true, std::memory_order_relaxed)) {
-        ctx->p.setValue(std::make_pair(i, std::move(t)));
-      }
-    });
-  }
+  auto n = size_t(std::distance(first, last));
+  auto ctx = new Context(n);
   auto future = ctx->p.getSemiFuture();
+  futures::detail::installCollectRangeCallbacks(
+      ctx,
+      n,
+      first,
+      last,
+      [](Context& c, size_t i, Try<T>&& t) {
+        // Most inputs complete after the first one, and only need to read
+        // the flag.
+        if (!c.done.load(std::memory_order_relaxed) &&
+            !c.done.exchange(true, std::memory_order_relaxed)) {
+          c.p.setValue(std::make_pair(i, std::move(t)));
+        }
+      },
+      futures::detail::InlineContinuation::forbid);
+
   if (!executors.empty()) {
     future = std::move(future).defer(
         [](Try<typename decltype(future)::value_type>&& t) {
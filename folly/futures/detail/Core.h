@@ -17,8 +17,11 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
 #include <mutex>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -34,6 +37,7 @@
 #include <folly/io/async/Request.h>
 #include <folly/lang/Assume.h>
 #include <folly/lang/Exception.h>
+#include <folly/memory/detail/SizeClassCache.h>
 #include <folly/synchronization/AtomicUtil.h>
 
 namespace folly {
@@ -206,6 +210,149 @@ class InterruptHandlerImpl final : public InterruptHandler {
   F f_;
 };
 
+class CoreBase;
+
+/// The type-erased callback of a Core, i.e. a move-only
+/// `void(CoreBase&, Executor::KeepAlive<>&&, exception_wrapper*)` function.
+///
+/// Same as folly::Function, but with a larger inline buffer: the callbacks
+/// set by `then()` and friends hold the Promise of the next Core next to the
+/// user's function, so with folly::Function any lambda capturing more than a
+/// couple of pointers would cost a heap allocation per continuation. Larger
+/// callbacks are stored out of line, in memory from the per-thread
+/// SizeClassCache.
+class CoreCallback {
+ public:
+  static constexpr std::size_t kInlineSize = 8 * sizeof(void*);
+
+  CoreCallback() noexcept = default;
+
+  template <
+      typename F,
+      typename Fun = std::decay_t<F>,
+      std::enable_if_t<!std::is_same<Fun, CoreCallback>::value, int> = 0>
+  /* implicit */ CoreCallback(F&& f) : ops_(&OpsFor<Fun>::kOps) {
+    OpsFor<Fun>::construct(storage_, static_cast<F&&>(f));
+  }
+
+  CoreCallback(CoreCallback&& that) noexcept : ops_(that.ops_) {
+    if (ops_) {
+      ops_->move(that.storage_, storage_);
+      that.ops_ = nullptr;
+    }
+  }
+
+  CoreCallback& operator=(CoreCallback&& that) noexcept {
+    if (this != &that) {
+      reset();
+      if (that.ops_) {
+        that.ops_->move(that.storage_, storage_);
+        ops_ = std::exchange(that.ops_, nullptr);
+      }
+    }
+    return *this;
+  }
+
+  ~CoreCallback() { reset(); }
+
+  explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+  void operator()(
+      CoreBase& core, Executor::KeepAlive<>&& ka, exception_wrapper* ew) {
+    ops_->call(storage_, core, std::move(ka), ew);
+  }
+
+  /// Whether callbacks of type F are stored inline.
+  template <typename F>
+  static constexpr bool isInline() {
+    return OpsFor<F>::kInline;
+  }
+
+ private:
+  using Storage = std::aligned_storage_t<kInlineSize, alignof(void*)>;
+
+  struct Ops {
+    void (*call)(
+        Storage&, CoreBase&, Executor::KeepAlive<>&&, exception_wrapper*);
+    // Move-constructs into `to` and destroys `from`.
+    void (*move)(Storage& from, Storage& to) noexcept;
+    void (*destroy)(Storage&) noexcept;
+  };
+
+  template <typename Fun>
+  struct OpsFor {
+    static constexpr bool kInline = sizeof(Fun) <= kInlineSize &&
+        alignof(Fun) <= alignof(Storage) &&
+        std::is_nothrow_move_constructible<Fun>::value;
+    // Out-of-line callbacks use the cache when it provides enough alignment.
+    static constexpr bool kCached =
+        alignof(Fun) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    static Fun& get(Storage& s) noexcept {
+      if constexpr (kInline) {
+        return *reinterpret_cast<Fun*>(&s);
+      } else {
+        return **reinterpret_cast<Fun**>(&s);
+      }
+    }
+
+    template <typename F>
+    static void construct(Storage& s, F&& f) {
+      if constexpr (kInline) {
+        ::new (&s) Fun(static_cast<F&&>(f));
+      } else if constexpr (kCached) {
+        void* p = folly::detail::sizeClassCacheAllocate(sizeof(Fun));
+        auto guard = makeGuard(
+            [&] { folly::detail::sizeClassCacheDeallocate(p, sizeof(Fun)); });
+        ::new (&s) Fun*(::new (p) Fun(static_cast<F&&>(f)));
+        guard.dismiss();
+      } else {
+        ::new (&s) Fun*(new Fun(static_cast<F&&>(f)));
+      }
+    }
+
+    static void call(
+        Storage& s,
+        CoreBase& core,
+        Executor::KeepAlive<>&& ka,
+        exception_wrapper* ew) {
+      get(s)(core, std::move(ka), ew);
+    }
+
+    static void move(Storage& from, Storage& to) noexcept {
+      if constexpr (kInline) {
+        ::new (&to) Fun(std::move(get(from)));
+        get(from).~Fun();
+      } else {
+        ::new (&to) Fun*(&get(from));
+      }
+    }
+
+    static void destroy(Storage& s) noexcept {
+      if constexpr (kInline) {
+        get(s).~Fun();
+      } else if constexpr (kCached) {
+        auto& fun = get(s);
+        fun.~Fun();
+        folly::detail::sizeClassCacheDeallocate(&fun, sizeof(Fun));
+      } else {
+        delete &get(s);
+      }
+    }
+
+    static constexpr Ops kOps{&call, &move, &destroy};
+  };
+
+  void reset() noexcept {
+    if (auto ops = std::exchange(ops_, nullptr)) {
+      ops->destroy(storage_);
+    }
+  }
+
+  Storage storage_;
+  const Ops* ops_{nullptr};
+};
+
 /// The shared state object for Future and Promise.
 ///
 /// Nomenclature:
@@ -340,8 +487,7 @@ class InterruptHandlerImpl final : public InterruptHandler {
 class CoreBase {
  protected:
   using Context = std::shared_ptr<RequestContext>;
-  using Callback = folly::Function<void(
-      CoreBase&, Executor::KeepAlive<>&&, exception_wrapper* ew)>;
+  using Callback = CoreCallback;
 
  public:
   // not copyable
@@ -489,6 +635,22 @@ class CoreBase {
 
   virtual ~CoreBase();
 
+  // Cores are short-lived and most often freed by the thread that allocated
+  // them, so they are recycled through the per-thread SizeClassCache.
+  static void* operator new(std::size_t size) {
+    return folly::detail::sizeClassCacheAllocate(size);
+  }
+  static void operator delete(void* ptr, std::size_t size) noexcept {
+    folly::detail::sizeClassCacheDeallocate(ptr, size);
+  }
+  static void* operator new(std::size_t size, std::align_val_t align) {
+    return ::operator new(size, align);
+  }
+  static void operator delete(
+      void* ptr, std::size_t size, std::align_val_t align) noexcept {
+    ::operator delete(ptr, size, align);
+  }
+
   // Helper class that stores a pointer to the `Core` object and calls
   // `derefCallback` and `detachOne` in the destructor.
   class CoreAndCallbackReference;
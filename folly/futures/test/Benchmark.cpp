@@ -16,6 +16,10 @@
 
 #include <folly/Benchmark.h>
 
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include <vector>
 
 #include <folly/executors/InlineExecutor.h>
@@ -30,6 +34,30 @@ using namespace folly;
 
 namespace {
 
+// Number of calls to the global operator new, which is replaced below, for
+// the allocation-count benchmarks.
+std::atomic<uint64_t> gAllocations{0};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+  gAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+
 template <class T>
 T incr(Try<T>&& t) {
   return t.value() + 1;
@@ -124,6 +152,53 @@ BENCHMARK_RELATIVE(hundredThensOnThreadInline) {
   someThensOnThread(100, true);
 }
 
+// Allocations per then() hop, once the per-thread caches are warm. The
+// captures are sized like those of typical continuations: a couple of
+// pointers, a handful of them (which no longer fit inline in a
+// folly::Function once the Promise of the next Core is added), and more than
+// fit inline in a Core.
+BENCHMARK_DRAW_LINE();
+
+template <size_t N>
+void thenChainAllocations(UserCounters& counters, unsigned iters) {
+  constexpr size_t kHops = 8;
+  std::array<int*, N> captures{};
+  auto run = [&] {
+    Promise<int> p;
+    auto f = p.getFuture();
+    for (size_t i = 0; i < kHops; ++i) {
+      f = std::move(f).thenValue(
+          [captures](int x) { return x + (captures[0] == nullptr); });
+    }
+    p.setValue(0);
+    return std::move(f).get();
+  };
+  BENCHMARK_SUSPEND {
+    run();
+  }
+  auto before = gAllocations.load(std::memory_order_relaxed);
+  for (unsigned i = 0; i < iters; ++i) {
+    doNotOptimizeAway(run());
+  }
+  BENCHMARK_SUSPEND {
+    auto allocations = gAllocations.load(std::memory_order_relaxed) - before;
+    counters["allocs_per_1k_hops"] =
+        UserMetric(int64_t(allocations * 1000 / (kHops * iters)));
+  }
+}
+
+BENCHMARK_COUNTERS(thenChainAllocationsCapture2, counters, iters) {
+  thenChainAllocations<2>(counters, iters);
+}
+
+BENCHMARK_COUNTERS(thenChainAllocationsCapture5, counters, iters) {
+  thenChainAllocations<5>(counters, iters);
+}
+
+BENCHMARK_COUNTERS(thenChainAllocationsCapture16, counters, iters) {
+  thenChainAllocations<16>(counters, iters);
+}
+
 // Lock contention. Although in practice fulfills tend to be temporally
 // separate from then()s, still sometimes they will be concurrent. So the
 // higher this number is, the better.
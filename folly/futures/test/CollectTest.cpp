@@ -1102,3 +1102,74 @@ TEST(Collect, CollectRangeWithDestroyedWeakRef) {
 
   EXPECT_THROW(std::move(future).get(), folly::BrokenPromise);
 }
+
+TEST(Collect, collectAllLargeFanOut) {
+  constexpr size_t kNumPromises = 10000;
+  std::vector<Promise<size_t>> promises(kNumPromises);
+  std::vector<Promise<size_t>> anyPromises(kNumPromises);
+  std::vector<SemiFuture<size_t>> futures;
+  std::vector<SemiFuture<size_t>> anyFutures;
+  for (size_t i = 0; i < kNumPromises; ++i) {
+    futures.push_back(promises[i].getSemiFuture());
+    anyFutures.push_back(anyPromises[i].getSemiFuture());
+  }
+  auto all = collectAll(futures.begin(), futures.end());
+  auto any = collectAny(anyFutures.begin(), anyFutures.end());
+  EXPECT_FALSE(all.isReady());
+  EXPECT_FALSE(any.isReady());
+
+  std::thread producer([&] {
+    for (size_t i = kNumPromises; i-- > 0;) {
+      if (i % 2) {
+        promises[i].setValue(i);
+      } else {
+        promises[i].setException(eggs);
+      }
+      anyPromises[i].setValue(i);
+    }
+  });
+  auto results = std::move(all).get();
+  producer.join();
+  ASSERT_EQ(kNumPromises, results.size());
+  for (size_t i = 0; i < kNumPromises; ++i) {
+    if (i % 2) {
+      EXPECT_EQ(i, results[i].value());
+    } else {
+      EXPECT_TRUE(results[i].hasException());
+    }
+  }
+  auto first = std::move(any).get();
+  EXPECT_EQ(kNumPromises - 1, first.first);
+  EXPECT_EQ(kNumPromises - 1, first.second.value());
+}
+
+TEST(Collect, collectAllRangeWithDestroyedWeakRef) {
+  auto one = std::make_unique<folly::CPUThreadPoolExecutor>(1);
+  auto two = std::make_unique<folly::CPUThreadPoolExecutor>(1);
+  auto reachedFirstCallback = folly::Baton<>{};
+  auto hasExecutorBeenDestroyed = folly::Baton<>{};
+
+  auto futures = std::vector<folly::SemiFuture<folly::Unit>>{};
+  futures.push_back(folly::makeSemiFuture());
+  futures.push_back(folly::makeSemiFuture()
+                        .via(one.get())
+                        .thenValue([&](auto) {
+                          reachedFirstCallback.post();
+                          hasExecutorBeenDestroyed.wait();
+                        })
+                        .via(two->weakRef())
+                        .thenValue([](auto) {}));
+  futures.push_back(folly::makeSemiFuture());
+  auto future = folly::collectAll(futures.begin(), futures.end());
+
+  reachedFirstCallback.wait();
+  two.reset();
+  hasExecutorBeenDestroyed.post();
+
+  // The continuation dropped by the executor breaks its promise.
+  auto results = std::move(future).get();
+  ASSERT_EQ(3, results.size());
+  EXPECT_TRUE(results[0].hasValue());
+  EXPECT_TRUE(results[1].hasException<BrokenPromise>());
+  EXPECT_TRUE(results[2].hasValue());
+}
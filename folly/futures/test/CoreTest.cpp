@@ -16,6 +16,9 @@
 
 #include <folly/futures/detail/Core.h>
 
+#include <array>
+#include <memory>
+
 #include <folly/futures/Future.h>
 #include <folly/portability/GTest.h>
 
@@ -32,7 +35,10 @@ TEST(Core, size) {
     virtual ~CoreBaseGold() = 0;
 
    private:
-    folly::Function<void(Try<Unit>&&)> callback_;
+    struct CoreCallbackGold {
+      void* storage_[8];
+      const void* ops_;
+    } callback_;
     std::atomic<futures::detail::State> state_;
     std::atomic<unsigned char> attached_;
     std::atomic<unsigned char> callbackReferences_;
@@ -47,3 +53,68 @@ TEST(Core, size) {
   EXPECT_EQ(sizeof(CoreGold), sizeof(futures::detail::Core<Unit>));
   EXPECT_EQ(alignof(CoreGold), alignof(futures::detail::Core<Unit>));
 }
+
+namespace {
+
+template <size_t N>
+struct CountingCallback {
+  explicit CountingCallback(std::shared_ptr<int> calls) : calls_(calls) {}
+
+  void operator()(
+      futures::detail::CoreBase&, Executor::KeepAlive<>&&, exception_wrapper*) {
+    ++*calls_;
+  }
+
+  std::shared_ptr<int> calls_;
+  std::array<char, N> padding_{};
+};
+
+template <size_t N>
+void testCoreCallback(bool expectInline) {
+  using futures::detail::CoreCallback;
+  EXPECT_EQ(expectInline, CoreCallback::isInline<CountingCallback<N>>());
+
+  auto calls = std::make_shared<int>(0);
+  auto core = futures::detail::Core<Unit>::make(Try<Unit>(unit));
+  {
+    CoreCallback cb{CountingCallback<N>(calls)};
+    EXPECT_TRUE(cb);
+    CoreCallback moved{std::move(cb)};
+    EXPECT_FALSE(cb);
+    moved(*core, Executor::KeepAlive<>{}, nullptr);
+    cb = std::move(moved);
+    cb(*core, Executor::KeepAlive<>{}, nullptr);
+    EXPECT_EQ(2, *calls);
+    EXPECT_EQ(2, calls.use_count());
+    cb = {};
+    EXPECT_FALSE(cb);
+    EXPECT_EQ(1, calls.use_count());
+  }
+  core->detachFuture();
+}
+
+} // namespace
+
+TEST(Core, callbackStorage) {
+  constexpr auto kInlineSize = futures::detail::CoreCallback::kInlineSize;
+  testCoreCallback<8>(true);
+  testCoreCallback<kInlineSize - sizeof(std::shared_ptr<int>)>(true);
+  testCoreCallback<kInlineSize>(false);
+  testCoreCallback<4096>(false);
+}
+
+TEST(Core, thenWithLargeCaptures) {
+  std::array<int, 8> small{};
+  std::array<int, 64> large{};
+  small[0] = 1;
+  large[0] = 2;
+  Promise<int> p;
+  auto f = p.getFuture()
+               .thenValue([small](int x) { return x + small[0]; })
+               .thenValue([large](int x) { return x + large[0]; })
+               .thenValue([small, large](int x) {
+                 return x + small[0] + large[0];
+               });
+  p.setValue(1);
+  EXPECT_EQ(7, std::move(f).get());
+}
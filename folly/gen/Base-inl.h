@@ -113,6 +113,26 @@ namespace detail {
 
 // Classes used for the implementation of Sources, Operators, and Sinks
 
+// A slice of consecutive values, as passed to foreachSpan().
+template <class T>
+using Span = Range<const T*>;
+
+// How many values the operators that make spans of their own, like map and
+// filter, buffer at a time.
+constexpr size_t kSpanSize = 256;
+
+// Whether the values of Container are arithmetic and stored consecutively
+// at access::data(container).
+template <class Container, class = void>
+struct HasArithmeticData : std::false_type {};
+
+template <class Container>
+struct HasArithmeticData<
+    Container,
+    void_t<decltype(access::data(std::declval<Container&>()))>>
+    : std::is_arithmetic<typename std::remove_pointer<
+          decltype(access::data(std::declval<Container&>()))>::type> {};
+
 /*
  ******************************* Sources ***************************************
  */
@@ -154,8 +174,16 @@ class ReferencedSource
     return true;
   }
 
+  template <class Body>
+  void foreachSpan(Body&& body) const {
+    auto data = access::data(*container_);
+    body(Span<typename std::decay<Value>::type>(
+        data, data + access::size(*container_)));
+  }
+
   // from takes in a normal stl structure, which are all finite
   static constexpr bool infinite = false;
+  static constexpr bool spans = HasArithmeticData<Container>::value;
 };
 
 /**
@@ -221,8 +249,15 @@ class CopiedSource
     return true;
   }
 
+  template <class Body>
+  void foreachSpan(Body&& body) const {
+    auto data = access::data(*copy_);
+    body(Span<StorageType>(data, data + access::size(*copy_)));
+  }
+
   // from takes in a normal stl structure, which are all finite
   static constexpr bool infinite = false;
+  static constexpr bool spans = HasArithmeticData<const Container>::value;
 };
 
 /**
@@ -263,8 +298,16 @@ class RangeSource : public GenImpl<
     }
   }
 
+  template <class Body>
+  void foreachSpan(Body&& body) const {
+    body(Span<typename std::decay<decltype(*range_.begin())>::type>(
+        range_.begin(), range_.end()));
+  }
+
   // folly::Range only supports finite ranges
   static constexpr bool infinite = false;
+  static constexpr bool spans = std::is_pointer<Iterator>::value &&
+      std::is_arithmetic<typename std::remove_pointer<Iterator>::type>::value;
 };
 
 /**
@@ -524,7 +567,31 @@ class Map : public Operator<Map<Predicate>> {
       });
     }
 
+    template <class Body>
+    void foreachSpan(Body&& body) const {
+      using Output = typename std::decay<Result>::type;
+      Output buffer[kSpanSize];
+      source_.foreachSpan([&](auto span) {
+        while (!span.empty()) {
+          const size_t n = std::min(span.size(), kSpanSize);
+          const auto* in = span.data();
+          const auto& pred = pred_;
+          for (size_t i = 0; i < n; ++i) {
+            buffer[i] = pred(in[i]);
+          }
+          body(Span<Output>(buffer, n));
+          span.advance(n);
+        }
+      });
+    }
+
     static constexpr bool infinite = Source::infinite;
+    // The predicate must also take the values as const references.
+    static constexpr bool spans = Source::spans &&
+        std::is_arithmetic<typename std::decay<Result>::type>::value &&
+        is_invocable_v<
+            const Predicate&,
+            const typename std::decay<Value>::type&>;
   };
 
   template <
@@ -591,7 +658,36 @@ class Filter : public Operator<Filter<Predicate>> {
       });
     }
 
+    template <class Body>
+    void foreachSpan(Body&& body) const {
+      using StorageType = typename std::decay<Value>::type;
+      StorageType buffer[kSpanSize];
+      source_.foreachSpan([&](auto span) {
+        while (!span.empty()) {
+          const size_t n = std::min(span.size(), kSpanSize);
+          const auto* in = span.data();
+          const auto& pred = pred_;
+          // Without a branch per value: every value is written, and kept by
+          // moving past it only if it passes.
+          size_t kept = 0;
+          for (size_t i = 0; i < n; ++i) {
+            buffer[kept] = in[i];
+            kept += bool(pred(in[i]));
+          }
+          if (kept > 0) {
+            body(Span<StorageType>(buffer, kept));
+          }
+          span.advance(n);
+        }
+      });
+    }
+
     static constexpr bool infinite = Source::infinite;
+    // The predicate must also take the values as const references.
+    static constexpr bool spans = Source::spans &&
+        is_invocable_v<
+            const Predicate&,
+            const typename std::decay<Value>::type&>;
   };
 
   template <class Source, class Value, class Gen = Generator<Value, Source>>
@@ -2230,6 +2326,37 @@ class Min : public Operator<Min<Selector, Comparer>> {
   }
 };
 
+// Whether collection.insert(collection.end(), first, last) can insert a span
+// of T into Collection.
+template <class Collection, class T, class = void>
+struct CanInsertSpan : std::false_type {};
+
+template <class Collection, class T>
+struct CanInsertSpan<
+    Collection,
+    T,
+    void_t<decltype(std::declval<Collection&>().insert(
+        std::declval<Collection&>().end(),
+        std::declval<const T*>(),
+        std::declval<const T*>()))>> : std::true_type {};
+
+// Inserts the values of source at the end of collection, a span at a time
+// if possible.
+template <class Collection, class Value, class Source>
+void insertAtEnd(Collection& collection, const GenImpl<Value, Source>& source) {
+  using StorageType = typename std::decay<Value>::type;
+  if constexpr (
+      Source::spans && CanInsertSpan<Collection, StorageType>::value) {
+    source.self().foreachSpan([&](auto span) {
+      collection.insert(collection.end(), span.begin(), span.end());
+    });
+  } else {
+    source | [&](Value v) {
+      collection.insert(collection.end(), std::forward<Value>(v));
+    };
+  }
+}
+
 /**
  * Append - For collecting values from a source into a given output container
  * by appending.
@@ -2250,9 +2377,7 @@ class Append : public Operator<Append<Collection>> {
   template <class Value, class Source>
   Collection& compose(const GenImpl<Value, Source>& source) const {
     static_assert(!Source::infinite, "Cannot appendTo with infinite source");
-    source | [&](Value v) {
-      collection_->insert(collection_->end(), std::forward<Value>(v));
-    };
+    insertAtEnd(*collection_, source);
     return *collection_;
   }
 };
@@ -2280,9 +2405,7 @@ class Collect : public Operator<Collect<Collection>> {
     static_assert(
         !Source::infinite, "Cannot convert infinite source to object with as.");
     Collection collection;
-    source | [&](Value v) {
-      collection.insert(collection.end(), std::forward<Value>(v));
-    };
+    insertAtEnd(collection, source);
     return collection;
   }
 };
@@ -2320,9 +2443,7 @@ class CollectTemplate : public Operator<CollectTemplate<Container, Allocator>> {
     static_assert(
         !Source::infinite, "Cannot convert infinite source to object with as.");
     Collection collection;
-    source | [&](Value v) {
-      collection.insert(collection.end(), std::forward<Value>(v));
-    };
+    insertAtEnd(collection, source);
     return collection;
   }
 };
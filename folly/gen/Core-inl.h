@@ -186,6 +186,15 @@ class GenImpl : public FBounded<Self> {
   // outer generators to be finite to make a finite one), and most sinks
   // cannot accept and infinite generators (first being the expection).
   static constexpr bool infinite = false;
+
+  // Child classes should override if they can also pass their values to
+  // foreachSpan(body) as spans, folly::Range<const StorageType*> slices of
+  // consecutive values. Sinks that collect values, like as() and appendTo(),
+  // insert a span at a time, which for a vector is one copy. Only sequences
+  // of arithmetic values are produced as spans; operators that produce them
+  // may apply their predicates a span at a time rather than one value at a
+  // time through the whole pipeline.
+  static constexpr bool spans = false;
 };
 
 template <
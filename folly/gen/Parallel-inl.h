@@ -18,10 +18,16 @@
 #error This file may only be included from folly/gen/Parallel.h
 #endif
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
 #include <thread>
 #include <vector>
 
+#include <folly/Executor.h>
 #include <folly/MPMCQueue.h>
 #include <folly/ScopeGuard.h>
 #include <folly/experimental/EventCount.h>
@@ -384,6 +390,211 @@ class Parallel : public Operator<Parallel<Ops>> {
   }
 };
 
+template <class Ops>
+class ParallelOn : public Operator<ParallelOn<Ops>> {
+  Ops ops_;
+  folly::Executor* executor_;
+  size_t grain_;
+  bool ordered_;
+
+ public:
+  ParallelOn(Ops ops, folly::Executor* executor, size_t grain, bool ordered)
+      : ops_(std::move(ops)),
+        executor_(executor),
+        grain_(std::max<size_t>(1, grain)),
+        ordered_(ordered) {
+    CHECK(executor_);
+  }
+
+  template <
+      class Input,
+      class Source,
+      class InputDecayed = typename std::decay<Input>::type,
+      class Composed =
+          decltype(std::declval<Ops>().compose(Empty<InputDecayed&&>())),
+      class Output = typename Composed::ValueType,
+      class OutputDecayed = typename std::decay<Output>::type>
+  class Generator : public GenImpl<
+                        OutputDecayed&&,
+                        Generator<
+                            Input,
+                            Source,
+                            InputDecayed,
+                            Composed,
+                            Output,
+                            OutputDecayed>> {
+    Source source_;
+    Ops ops_;
+    folly::Executor* executor_;
+    size_t grain_;
+    bool ordered_;
+
+    struct Batch {
+      std::vector<InputDecayed> input;
+      std::vector<OutputDecayed> output;
+      std::exception_ptr error;
+      bool done = false;
+    };
+
+    // The batches in flight, in input order. Only the client thread adds and
+    // removes them; the tasks running them mark them done. The tasks refer to
+    // *this, so the destructor waits for all of them.
+    class Batches {
+      const Ops* ops_;
+      folly::Executor* executor_;
+      const bool ordered_;
+      const size_t capacity_;
+      std::deque<std::unique_ptr<Batch>> inFlight_;
+      std::mutex mutex_;
+      std::condition_variable cv_;
+      size_t running_ = 0; // guarded by mutex_
+      std::deque<Batch*> finished_; // guarded by mutex_, if !ordered_
+
+      void run(Batch* batch) {
+        try {
+          (from(batch->input) | move | *ops_).foreach([&](Output output) {
+            batch->output.emplace_back(std::forward<Output>(output));
+          });
+        } catch (...) {
+          batch->error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch->done = true;
+        if (!ordered_) {
+          finished_.push_back(batch);
+        }
+        --running_;
+        cv_.notify_all();
+      }
+
+     public:
+      Batches(const Ops* ops, folly::Executor* executor, bool ordered)
+          : ops_(ops),
+            executor_(executor),
+            ordered_(ordered),
+            capacity_(4 * std::max(1u, std::thread::hardware_concurrency())) {}
+
+      ~Batches() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return running_ == 0; });
+      }
+
+      bool empty() const { return inFlight_.empty(); }
+
+      bool full() const { return inFlight_.size() >= capacity_; }
+
+      void add(std::vector<InputDecayed> input) {
+        inFlight_.push_back(std::make_unique<Batch>());
+        auto batch = inFlight_.back().get();
+        batch->input = std::move(input);
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          ++running_;
+        }
+        try {
+          executor_->add([this, batch] { run(batch); });
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          --running_;
+          inFlight_.pop_back();
+          throw;
+        }
+      }
+
+      // Waits for the next batch to yield: the oldest one if ordered_, else
+      // the first to finish.
+      std::unique_ptr<Batch> next() {
+        DCHECK(!empty());
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (ordered_) {
+          auto& front = inFlight_.front();
+          cv_.wait(lock, [&] { return front->done; });
+          auto batch = std::move(front);
+          inFlight_.pop_front();
+          return batch;
+        }
+        cv_.wait(lock, [&] { return !finished_.empty(); });
+        auto it = std::find_if(
+            inFlight_.begin(), inFlight_.end(), [&](const auto& batch) {
+              return batch.get() == finished_.front();
+            });
+        finished_.pop_front();
+        auto batch = std::move(*it);
+        inFlight_.erase(it);
+        return batch;
+      }
+    };
+
+   public:
+    Generator(
+        Source source,
+        Ops ops,
+        folly::Executor* executor,
+        size_t grain,
+        bool ordered)
+        : source_(std::move(source)),
+          ops_(std::move(ops)),
+          executor_(executor),
+          grain_(grain),
+          ordered_(ordered) {}
+
+    template <class Handler>
+    bool apply(Handler&& handler) const {
+      Batches batches(&ops_, executor_, ordered_);
+      auto yield = [&](Batch& batch) {
+        if (batch.error) {
+          std::rethrow_exception(batch.error);
+        }
+        for (auto& output : batch.output) {
+          if (!handler(std::move(output))) {
+            return false;
+          }
+        }
+        return true;
+      };
+
+      bool more = true;
+      std::vector<InputDecayed> input;
+      input.reserve(grain_);
+      source_.apply([&](Input value) {
+        input.push_back(std::forward<Input>(value));
+        if (input.size() < grain_) {
+          return true;
+        }
+        batches.add(std::move(input));
+        input.clear();
+        input.reserve(grain_);
+        while (batches.full()) {
+          if (!yield(*batches.next())) {
+            more = false;
+            return false;
+          }
+        }
+        return true;
+      });
+      if (more && !input.empty()) {
+        batches.add(std::move(input));
+      }
+      while (more && !batches.empty()) {
+        more = yield(*batches.next());
+      }
+      return more;
+    }
+  };
+
+  template <class Value, class Source>
+  Generator<Value, Source> compose(const GenImpl<Value, Source>& source) const {
+    return Generator<Value, Source>(
+        source.self(), ops_, executor_, grain_, ordered_);
+  }
+
+  template <class Value, class Source>
+  Generator<Value, Source> compose(GenImpl<Value, Source>&& source) const {
+    return Generator<Value, Source>(
+        std::move(source.self()), ops_, executor_, grain_, ordered_);
+  }
+};
+
 /**
  * ChunkedRangeSource - For slicing up ranges into a sequence of chunks given a
  * maximum chunk size.
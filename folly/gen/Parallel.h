@@ -22,12 +22,18 @@
 #include <folly/gen/Base.h>
 
 namespace folly {
+
+class Executor;
+
 namespace gen {
 namespace detail {
 
 template <class Ops>
 class Parallel;
 
+template <class Ops>
+class ParallelOn;
+
 template <class Sink>
 class Sub;
 
@@ -89,6 +95,35 @@ Parallel parallel(Ops ops, size_t threads = 0) {
   return Parallel(std::move(ops), threads);
 }
 
+/**
+ * parallelOn - Like 'parallel', but runs the operations on an executor
+ * instead of on threads of its own.
+ *
+ * 'parallelOn(ops, executor, grain)' groups the input sequence into batches
+ * of 'grain' values and adds a task per batch to 'executor'. Each task
+ * applies 'ops' to its batch, and the client thread yields the results of
+ * the batches in input order, or in the order the batches finish if
+ * 'ordered' is false. A CPUThreadPoolExecutor hands each task to the next
+ * idle thread, so uneven batches balance themselves, and the pipeline can
+ * share the process thread pool:
+ *
+ *   auto matches
+ *     = chunked(docs)
+ *     | parallelOn(concat | filter(expensiveTest) | sub(count), &pool)
+ *     | sum;
+ *
+ * As with 'parallel', 'ops' must yield a sequence. At most a few batches per
+ * hardware thread are in flight at once. An exception thrown by 'ops' is
+ * rethrown on the client thread when its batch's turn comes. Tasks must not
+ * block on each other: if every thread of 'executor' is busy with other
+ * work, the client thread waits until one is free.
+ */
+template <class Ops, class ParallelOn = detail::ParallelOn<Ops>>
+ParallelOn parallelOn(
+    Ops ops, Executor* executor, size_t grain = 1, bool ordered = true) {
+  return ParallelOn(std::move(ops), executor, grain, ordered);
+}
+
 /**
  * sub - For sub-summarization of a sequence.
  *
@@ -142,6 +142,35 @@ BENCHMARK_RELATIVE(Count_Vector_Gen, iters) {
 
 BENCHMARK_DRAW_LINE();
 
+BENCHMARK(Collect_Vector_NoGen, iters) {
+  size_t s = 0;
+  while (iters--) {
+    vector<int> odd;
+    for (auto& i : testVector) {
+      if (i % 2) {
+        odd.push_back(i * 3);
+      }
+    }
+    s += odd.size();
+  }
+  folly::doNotOptimizeAway(s);
+}
+
+BENCHMARK_RELATIVE(Collect_Vector_Gen, iters) {
+  size_t s = 0;
+  while (iters--) {
+    // clang-format off
+    s += (from(testVector)
+        | filter([](int i) { return i % 2; })
+        | map([](int i) { return i * 3; })
+        | as<vector>()).size();
+    // clang-format on
+  }
+  folly::doNotOptimizeAway(s);
+}
+
+BENCHMARK_DRAW_LINE();
+
 BENCHMARK(Fib_Sum_NoGen, iters) {
   int s = 0;
   while (iters--) {
@@ -16,6 +16,7 @@
 
 #include <folly/gen/Base.h>
 
+#include <deque>
 #include <iosfwd>
 #include <memory>
 #include <random>
@@ -283,6 +284,48 @@ TEST(Gen, FilterSink) {
   EXPECT_FALSE(from(actual) | rconcat | isEmpty);
 }
 
+TEST(Gen, Spans) {
+  // Longer than a span, so that map and filter buffer several.
+  auto values = seq(1, 1000) | as<vector>();
+  auto const odd = [](int x) { return x % 2; };
+
+  auto mapped = from(values) | map(square);
+  auto filtered = from(values) | filter(odd);
+  auto both = from(values) | filter(odd) | map(square);
+  static_assert(decltype(mapped)::spans, "");
+  static_assert(decltype(filtered)::spans, "");
+  static_assert(decltype(both)::spans, "");
+  // Only arithmetic values, through predicates that take const references.
+  auto strings = from(values) | map([](int x) { return to<std::string>(x); });
+  auto mutating = from(values) | map([](int& x) { return x; });
+  static_assert(!decltype(strings)::spans, "");
+  static_assert(!decltype(mutating)::spans, "");
+  static_assert(!decltype(seq(1, 10))::spans, "");
+
+  vector<int> expected;
+  for (int x : values) {
+    if (odd(x)) {
+      expected.push_back(square(x));
+    }
+  }
+  EXPECT_EQ(values, from(values) | as<vector>());
+  EXPECT_EQ(values, fromCopy(values) | as<vector>());
+  EXPECT_EQ(expected, both | as<vector>());
+  EXPECT_EQ(expected, from(both | as<std::deque<int>>()) | as<vector>());
+  EXPECT_EQ(expected, from(both | as<set<int>>()) | as<vector>());
+  EXPECT_EQ(500, (filtered | as<vector>()).size());
+
+  vector<int> appended{0};
+  mapped | appendTo(appended);
+  ASSERT_EQ(1001, appended.size());
+  EXPECT_EQ(0, appended.front());
+  EXPECT_EQ(1000 * 1000, appended.back());
+
+  string const name = "gen";
+  EXPECT_EQ(name, from(name) | as<string>());
+  EXPECT_TRUE((from(vector<int>()) | filter(odd) | as<vector>()).empty());
+}
+
 TEST(Gen, Contains) {
   {
     auto gen = seq(1, 9) | map(square);
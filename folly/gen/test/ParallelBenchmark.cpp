@@ -21,6 +21,7 @@
 
 #include <glog/logging.h>
 
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/gen/Base.h>
 #include <folly/gen/Parallel.h>
 #include <folly/gen/test/Bench.h>
@@ -88,6 +89,11 @@ auto medium = from(v) | take(1 << 14);
 auto large = from(v) | take(1 << 18);
 auto huge = from(v);
 auto chunks = chunked(v);
+
+folly::Executor* pool() {
+  static folly::CPUThreadPoolExecutor executor(FLAGS_threads);
+  return &executor;
+}
 } // namespace
 
 BENCH_GEN(small | map(factorsSlow) | sum);
@@ -108,6 +114,8 @@ BENCH_GEN(huge | filter(isPrime) | count);
 BENCH_GEN_REL(ch | cat | filter(isPrime) | count);
 BENCH_GEN_REL(ch | parallel(cat | filter(isPrime)) | count);
 BENCH_GEN_REL(ch | parallel(cat | filter(isPrime) | sub(count)) | sum);
+BENCH_GEN_REL(
+    ch | parallelOn(cat | filter(isPrime) | sub(count), pool()) | sum);
 BENCHMARK_DRAW_LINE();
 
 BENCH_GEN(small | map(sleepAndWork) | sum);
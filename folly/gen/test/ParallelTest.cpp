@@ -19,10 +19,12 @@
 #include <array>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 #include <glog/logging.h>
 
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/gen/Base.h>
 #include <folly/portability/GFlags.h>
 #include <folly/portability/GTest.h>
@@ -105,3 +107,51 @@ TEST(ParallelTest, PSum) {
       from(primes) | map(sleepyWork) | sum,
       from(primes) | parallel(map(sleepyWork) | sub(sum)) | sum);
 }
+
+TEST(ParallelTest, On) {
+  folly::CPUThreadPoolExecutor pool(4);
+  for (size_t grain : {1, 7, 1000}) {
+    EXPECT_EQ(
+        seq(1, 1000) | map(square) | filter(even) | as<vector>(),
+        seq(1, 1000) | parallelOn(map(square) | filter(even), &pool, grain) |
+            as<vector>());
+    EXPECT_EQ(
+        from(primes) | map(sleepyWork) | sum,
+        from(primes) |
+            parallelOn(map(sleepyWork) | sub(sum), &pool, grain, false) |
+            sum);
+  }
+}
+
+TEST(ParallelTest, OnChunked) {
+  folly::CPUThreadPoolExecutor pool(4);
+  auto const values = seq(1, 1 << 12) | as<vector>();
+  EXPECT_EQ(
+      from(values) | heavyWork | sum,
+      chunked(values, 64) | parallelOn(concat | heavyWork | sub(sum), &pool) |
+          sum);
+}
+
+TEST(ParallelTest, OnTake) {
+  folly::CPUThreadPoolExecutor pool(4);
+  EXPECT_EQ(
+      seq(1, 100) | as<vector>(),
+      seq(1) | parallelOn(map([](int i) { return i; }), &pool, 3) | take(100) |
+          as<vector>());
+}
+
+TEST(ParallelTest, OnException) {
+  folly::CPUThreadPoolExecutor pool(4);
+  auto throwAt = [](int i) {
+    if (i == 500) {
+      throw std::runtime_error("500");
+    }
+    return i;
+  };
+  EXPECT_THROW(
+      seq(1, 1000) | parallelOn(map(throwAt), &pool, 10) | sum,
+      std::runtime_error);
+  EXPECT_EQ(
+      seq(1, 100) | sum,
+      seq(1, 1000) | parallelOn(map(throwAt), &pool, 10) | take(100) | sum);
+}
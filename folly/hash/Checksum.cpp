@@ -17,6 +17,7 @@
 #include <folly/hash/Checksum.h>
 
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 #include <boost/crc.hpp>
@@ -26,6 +27,7 @@
 #include <folly/external/fast-crc32/avx512_crc32c_v8s3x4.h> // @manual
 #include <folly/external/fast-crc32/sse_crc32c_v8s3x3.h> // @manual
 #include <folly/hash/detail/ChecksumDetail.h>
+#include <folly/io/IOBuf.h>
 
 #if FOLLY_SSE_PREREQ(4, 2)
 #include <emmintrin.h>
@@ -163,6 +165,114 @@ uint32_t crc32c(const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
   }
 }
 
+namespace {
+
+// Below these lengths, the cost of combining the three streams outweighs
+// the gain of interleaving them.
+constexpr size_t kCrc32cCopyInterleaveMin = 4096;
+constexpr size_t kCrc32cChainInterleaveMin = 4096;
+// Chains of buffers this long on average are checksummed faster buffer by
+// buffer, as crc32c() already interleaves within large buffers.
+constexpr size_t kCrc32cChainBufferMax = 4096;
+
+// One of the three segments of a chain, as it is being checksummed.
+struct ChainSegment {
+  const IOBuf* buf;
+  const uint8_t* data;
+  size_t avail; // bytes left in buf
+  size_t left; // bytes left in the segment
+
+  void advance(size_t n) {
+    data += n;
+    avail -= n;
+    left -= n;
+    while (left != 0 && avail == 0) {
+      buf = buf->next();
+      data = buf->data();
+      avail = buf->length();
+    }
+  }
+};
+
+ChainSegment chainSegment(const IOBuf& head, size_t offset, size_t length) {
+  const IOBuf* cur = &head;
+  while (offset >= cur->length()) {
+    offset -= cur->length();
+    cur = cur->next();
+  }
+  return {cur, cur->data() + offset, cur->length() - offset, length};
+}
+
+} // namespace
+
+uint32_t crc32c_iobuf(const IOBuf& buf, uint32_t startingChecksum) {
+  size_t total = 0;
+  size_t count = 0;
+  for (auto range : buf) {
+    total += range.size();
+    ++count;
+  }
+  if (!detail::crc32c_hw_supported() || total < kCrc32cChainInterleaveMin ||
+      total / count >= kCrc32cChainBufferMax) {
+    uint32_t sum = startingChecksum;
+    for (auto range : buf) {
+      sum = crc32c(range.data(), range.size(), sum);
+    }
+    return sum;
+  }
+
+  // The first two segments have the same length, the last one takes the
+  // remainder.
+  size_t const part = total / 3;
+  ChainSegment segments[3] = {
+      chainSegment(buf, 0, part),
+      chainSegment(buf, part, part),
+      chainSegment(buf, 2 * part, total - 2 * part)};
+  uint32_t crcs[3] = {startingChecksum, 0, 0};
+  while (segments[0].left != 0) {
+    size_t n = std::min(
+        {segments[0].left,
+         segments[0].avail,
+         segments[1].avail,
+         segments[2].avail});
+    const uint8_t* const data[3] = {
+        segments[0].data, segments[1].data, segments[2].data};
+    detail::crc32c_hw_x3(crcs, data, n);
+    for (auto& segment : segments) {
+      segment.advance(n);
+    }
+  }
+  for (auto& last = segments[2]; last.left != 0;) {
+    size_t n = std::min(last.left, last.avail);
+    crcs[2] = crc32c(last.data, n, crcs[2]);
+    last.advance(n);
+  }
+  return crc32c_combine(
+      crc32c_combine(crcs[0], crcs[1], part), crcs[2], total - 2 * part);
+}
+
+uint32_t crc32c_copy(
+    uint8_t* dst, const uint8_t* src, size_t nbytes, uint32_t startingChecksum) {
+  if (!detail::crc32c_hw_supported() || nbytes < kCrc32cCopyInterleaveMin) {
+    if (nbytes != 0) {
+      std::memcpy(dst, src, nbytes);
+    }
+    return crc32c(dst, nbytes, startingChecksum);
+  }
+
+  size_t const part = nbytes / 3;
+  uint8_t* const dsts[3] = {dst, dst + part, dst + 2 * part};
+  const uint8_t* const srcs[3] = {src, src + part, src + 2 * part};
+  uint32_t crcs[3] = {startingChecksum, 0, 0};
+  detail::crc32c_copy_hw_x3(crcs, dsts, srcs, part);
+  // Up to two bytes are left over for the last segment.
+  size_t const rest = nbytes - 3 * part;
+  std::memcpy(dst + 3 * part, src + 3 * part, rest);
+  crcs[2] = crc32c(src + 3 * part, rest, crcs[2]);
+  return crc32c_combine(
+      crc32c_combine(crcs[0], crcs[1], part), crcs[2], part + rest);
+}
+
 uint32_t crc32(const uint8_t* data, size_t nbytes, uint32_t startingChecksum) {
   if (detail::crc32_hw_supported()) {
     return detail::crc32_hw(data, nbytes, startingChecksum);
@@ -26,6 +26,8 @@
 
 namespace folly {
 
+class IOBuf;
+
 /**
  * Compute the CRC-32C checksum of a buffer, using a hardware-accelerated
  * implementation if available or a portable software implementation as
@@ -38,6 +40,28 @@ namespace folly {
 uint32_t crc32c(
     const uint8_t* data, size_t nbytes, uint32_t startingChecksum = ~0U);
 
+/**
+ * Compute the CRC-32C checksum of the data in an IOBuf chain; the result is
+ * the same as that of crc32c() over the coalesced data.
+ *
+ * Chains of many small buffers, which a buffer-by-buffer pass would
+ * checksum one dependent instruction at a time, are split into three
+ * segments of equal length that are checksummed as interleaved streams and
+ * then combined with crc32c_combine().
+ */
+uint32_t crc32c_iobuf(const IOBuf& buf, uint32_t startingChecksum = ~0U);
+
+/**
+ * Copy nbytes from src to dst and return the CRC-32C checksum of the data,
+ * as crc32c() would, in a single pass over the source. The buffers must
+ * not overlap.
+ */
+uint32_t crc32c_copy(
+    uint8_t* dst,
+    const uint8_t* src,
+    size_t nbytes,
+    uint32_t startingChecksum = ~0U);
+
 /**
  * Compute the CRC-32 checksum of a buffer, using a hardware-accelerated
  * implementation if available or a portable software implementation as
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/hash/ContentDefinedChunker.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+namespace hash {
+
+namespace {
+
+// splitmix64, seeded with 0. Changing this table moves every boundary.
+constexpr std::array<uint64_t, 256> makeGearTable() {
+  std::array<uint64_t, 256> table{};
+  uint64_t state = 0;
+  for (auto& word : table) {
+    state += 0x9e3779b97f4a7c15;
+    uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    word = z ^ (z >> 31);
+  }
+  return table;
+}
+
+constexpr std::array<uint64_t, 256> kGearTable = makeGearTable();
+
+// The top bits of the Gear hash depend on the most bytes, so test those.
+uint64_t topBitsMask(int bits) {
+  if (bits < 1 || bits > 63) {
+    throw_exception<std::invalid_argument>(
+        "ContentDefinedChunker: avgSize or normalization out of range");
+  }
+  return ~uint64_t(0) << (64 - bits);
+}
+
+} // namespace
+
+ContentDefinedChunker::ContentDefinedChunker(Options options)
+    : options_(options) {
+  if (options_.minSize == 0 || options_.minSize > options_.avgSize ||
+      options_.avgSize > options_.maxSize) {
+    throw_exception<std::invalid_argument>(
+        "ContentDefinedChunker: need 0 < minSize <= avgSize <= maxSize");
+  }
+  int const bits = findLastSet(options_.avgSize) - 1;
+  maskSmall_ = topBitsMask(bits + options_.normalization);
+  maskLarge_ = topBitsMask(bits - options_.normalization);
+}
+
+FOLLY_DISABLE_UNDEFINED_BEHAVIOR_SANITIZER("unsigned-integer-overflow")
+std::optional<size_t> ContentDefinedChunker::scan(ByteRange data) {
+  auto const n = data.size();
+  size_t i = 0;
+  if (pending_ < options_.minSize) {
+    i = std::min(options_.minSize - pending_, n);
+    pending_ += i;
+  }
+
+  // Looks for a boundary where the hash has none of mask's bits set, until
+  // the chunk reaches limit bytes.
+  uint64_t h = hash_;
+  auto find = [&](size_t limit, uint64_t mask) {
+    if (pending_ >= limit) {
+      return false;
+    }
+    auto const start = i;
+    auto const end = std::min(n, i + (limit - pending_));
+    bool found = false;
+    while (i < end) {
+      h = (h << 1) + kGearTable[data[i++]];
+      if (!(h & mask)) {
+        found = true;
+        break;
+      }
+    }
+    pending_ += i - start;
+    return found;
+  };
+
+  if (find(options_.avgSize, maskSmall_) ||
+      find(options_.maxSize, maskLarge_) || pending_ == options_.maxSize) {
+    reset();
+    return i;
+  }
+  hash_ = h;
+  return std::nullopt;
+}
+
+bool ContentDefinedChunker::scan(io::Cursor& cursor) {
+  for (auto bytes = cursor.peekBytes(); !bytes.empty();
+       bytes = cursor.peekBytes()) {
+    if (auto const cut = scan(bytes)) {
+      cursor.skip(*cut);
+      return true;
+    }
+    cursor.skip(bytes.size());
+  }
+  return false;
+}
+
+std::vector<size_t> chunkSizes(
+    const IOBuf& buf, ContentDefinedChunker::Options options) {
+  ContentDefinedChunker chunker(options);
+  std::vector<size_t> sizes;
+  for (ByteRange range : buf) {
+    while (true) {
+      auto const pending = chunker.pendingSize();
+      auto const cut = chunker.scan(range);
+      if (!cut) {
+        break;
+      }
+      sizes.push_back(pending + *cut);
+      range.advance(*cut);
+    }
+  }
+  if (chunker.pendingSize() > 0) {
+    sizes.push_back(chunker.pendingSize());
+  }
+  return sizes;
+}
+
+} // namespace hash
+} // namespace folly
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Content-defined chunking, for deduplication and delta sync.
+ *
+ * ContentDefinedChunker splits a byte stream into chunks whose boundaries
+ * depend only on the bytes near them, so an insertion or deletion moves
+ * the boundaries of the chunks around it and no others. It follows FastCDC
+ * (Xia et al., USENIX ATC 2016):
+ *
+ * - A Gear rolling hash, h = (h << 1) + gear[byte], finds boundaries. It
+ *   depends on the last 64 bytes, and costs a shift, an add and a lookup
+ *   per byte.
+ * - No boundary is looked for in the first minSize bytes of a chunk.
+ * - Normalized chunking: up to avgSize, a boundary needs more hash bits to
+ *   be zero than after it, which makes chunk sizes cluster around avgSize.
+ * - A chunk that reaches maxSize ends there.
+ *
+ * The Gear table and masks are fixed, so a given stream and Options are cut
+ * at the same places by every build on every platform.
+ *
+ * The chunker only reads the data it is given and never copies it. It keeps
+ * its state between calls, so a stream can arrive in any number of pieces,
+ * including the buffers of an IOBuf chain through a Cursor.
+ *
+ * @file hash/ContentDefinedChunker.h
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <folly/CPortability.h>
+#include <folly/Range.h>
+
+namespace folly {
+
+class IOBuf;
+
+namespace io {
+class Cursor;
+} // namespace io
+
+namespace hash {
+
+class ContentDefinedChunker {
+ public:
+  struct Options {
+    size_t minSize = 2 * 1024;
+    // Where normalized chunking switches masks. The masks are sized for the
+    // largest power of two that is not above it.
+    size_t avgSize = 8 * 1024;
+    size_t maxSize = 64 * 1024;
+    // How many more (fewer) hash bits must be zero for a boundary before
+    // (after) avgSize; 0 disables normalized chunking. FastCDC recommends
+    // 1 to 3.
+    int normalization = 2;
+  };
+
+  ContentDefinedChunker() : ContentDefinedChunker(Options{}) {}
+
+  /**
+   * Throws std::invalid_argument unless 0 < minSize <= avgSize <= maxSize
+   * and the normalization leaves both masks between 1 and 63 bits.
+   */
+  explicit ContentDefinedChunker(Options options);
+
+  /**
+   * Scans data, the next bytes of the stream. If the current chunk ends in
+   * data, returns the number of bytes of data that belong to it and starts
+   * a new chunk with the rest, which the caller passes in again. Otherwise
+   * all of data joins the current chunk and nullopt is returned.
+   */
+  std::optional<size_t> scan(ByteRange data);
+
+  /**
+   * Advances cursor to the end of the current chunk, or to the end of its
+   * data if the chunk doesn't end in it. Returns whether the chunk ended.
+   * Nothing is copied; the chunk can be cloned out of the IOBuf chain from
+   * a copy of the cursor made before the call.
+   */
+  bool scan(io::Cursor& cursor);
+
+  /**
+   * The number of bytes scanned into the current, unfinished chunk.
+   */
+  size_t pendingSize() const { return pending_; }
+
+  /**
+   * Discards the current chunk, to start on a new stream.
+   */
+  void reset() {
+    hash_ = 0;
+    pending_ = 0;
+  }
+
+  const Options& options() const { return options_; }
+
+ private:
+  Options options_;
+  uint64_t maskSmall_; // up to avgSize
+  uint64_t maskLarge_; // after avgSize
+  uint64_t hash_ = 0;
+  size_t pending_ = 0;
+};
+
+/**
+ * Returns the sizes of the content-defined chunks of the data in buf. The
+ * last chunk ends with the data, whether or not there is a boundary there.
+ */
+std::vector<size_t> chunkSizes(
+    const IOBuf& buf,
+    ContentDefinedChunker::Options options = ContentDefinedChunker::Options());
+
+} // namespace hash
+} // namespace folly
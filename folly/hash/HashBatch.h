@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <folly/CPortability.h>
+#include <folly/Portability.h>
+#include <folly/Range.h>
+#include <folly/hash/Hash.h>
+#include <folly/lang/SafeAssert.h>
+
+#if FOLLY_SSE_PREREQ(2, 0)
+#include <immintrin.h>
+#endif
+
+/**
+ * Hashing of many integer keys at once, for batched lookups and hash joins.
+ *
+ * hash_batch(keys, out) sets out[i] to the hash of keys[i], the same value
+ * that folly::hasher gives for the key type: twang_mix64() for 64-bit keys and
+ * jenkins_rev_mix32() for 32-bit keys. Both mixers are only shifts, adds and
+ * xors, so the keys are mixed a vector register at a time: 8 or 16 keys with
+ * AVX-512, 4 or 8 with AVX2 and 2 or 4 with SSE2, whichever the target is
+ * compiled for. The keys that don't fill a register are mixed one at a time.
+ *
+ * out must be at least as long as keys. It may be the same array, to hash in
+ * place.
+ *
+ * @file HashBatch.h
+ */
+
+namespace folly {
+namespace hash {
+
+namespace detail {
+
+#if FOLLY_SSE_PREREQ(2, 0)
+
+struct HashBatchSse2 {
+  using reg = __m128i;
+  static constexpr std::size_t kBytes = 16;
+
+  static reg load(const void* p) {
+    return _mm_loadu_si128(static_cast<const reg*>(p));
+  }
+  static void store(void* p, reg v) {
+    _mm_storeu_si128(static_cast<reg*>(p), v);
+  }
+  static reg bitXor(reg a, reg b) { return _mm_xor_si128(a, b); }
+  static reg bitNot(reg a) { return _mm_xor_si128(a, _mm_set1_epi32(-1)); }
+  static reg add64(reg a, reg b) { return _mm_add_epi64(a, b); }
+  static reg add32(reg a, reg b) { return _mm_add_epi32(a, b); }
+  template <int N>
+  static reg shl64(reg a) {
+    return _mm_slli_epi64(a, N);
+  }
+  template <int N>
+  static reg shr64(reg a) {
+    return _mm_srli_epi64(a, N);
+  }
+  template <int N>
+  static reg shl32(reg a) {
+    return _mm_slli_epi32(a, N);
+  }
+  template <int N>
+  static reg shr32(reg a) {
+    return _mm_srli_epi32(a, N);
+  }
+};
+
+#endif
+
+#if defined(__AVX2__)
+
+struct HashBatchAvx2 {
+  using reg = __m256i;
+  static constexpr std::size_t kBytes = 32;
+
+  static reg load(const void* p) {
+    return _mm256_loadu_si256(static_cast<const reg*>(p));
+  }
+  static void store(void* p, reg v) {
+    _mm256_storeu_si256(static_cast<reg*>(p), v);
+  }
+  static reg bitXor(reg a, reg b) { return _mm256_xor_si256(a, b); }
+  static reg bitNot(reg a) {
+    return _mm256_xor_si256(a, _mm256_set1_epi32(-1));
+  }
+  static reg add64(reg a, reg b) { return _mm256_add_epi64(a, b); }
+  static reg add32(reg a, reg b) { return _mm256_add_epi32(a, b); }
+  template <int N>
+  static reg shl64(reg a) {
+    return _mm256_slli_epi64(a, N);
+  }
+  template <int N>
+  static reg shr64(reg a) {
+    return _mm256_srli_epi64(a, N);
+  }
+  template <int N>
+  static reg shl32(reg a) {
+    return _mm256_slli_epi32(a, N);
+  }
+  template <int N>
+  static reg shr32(reg a) {
+    return _mm256_srli_epi32(a, N);
+  }
+};
+
+#endif
+
+#if defined(__AVX512F__)
+
+struct HashBatchAvx512 {
+  using reg = __m512i;
+  static constexpr std::size_t kBytes = 64;
+
+  static reg load(const void* p) { return _mm512_loadu_si512(p); }
+  static void store(void* p, reg v) { _mm512_storeu_si512(p, v); }
+  static reg bitXor(reg a, reg b) { return _mm512_xor_si512(a, b); }
+  static reg bitNot(reg a) {
+    return _mm512_xor_si512(a, _mm512_set1_epi32(-1));
+  }
+  static reg add64(reg a, reg b) { return _mm512_add_epi64(a, b); }
+  static reg add32(reg a, reg b) { return _mm512_add_epi32(a, b); }
+  template <int N>
+  static reg shl64(reg a) {
+    return _mm512_slli_epi64(a, N);
+  }
+  template <int N>
+  static reg shr64(reg a) {
+    return _mm512_srli_epi64(a, N);
+  }
+  template <int N>
+  static reg shl32(reg a) {
+    return _mm512_slli_epi32(a, N);
+  }
+  template <int N>
+  static reg shr32(reg a) {
+    return _mm512_srli_epi32(a, N);
+  }
+};
+
+using HashBatchNative = HashBatchAvx512;
+#define FOLLY_DETAIL_HASH_BATCH_SIMD 1
+#elif defined(__AVX2__)
+using HashBatchNative = HashBatchAvx2;
+#define FOLLY_DETAIL_HASH_BATCH_SIMD 1
+#elif FOLLY_SSE_PREREQ(2, 0)
+using HashBatchNative = HashBatchSse2;
+#define FOLLY_DETAIL_HASH_BATCH_SIMD 1
+#else
+#define FOLLY_DETAIL_HASH_BATCH_SIMD 0
+#endif
+
+#if FOLLY_DETAIL_HASH_BATCH_SIMD
+
+// twang_mix64 and jenkins_rev_mix32, step for step, in every lane.
+template <typename V>
+FOLLY_ALWAYS_INLINE typename V::reg twangMix64Lanes(typename V::reg key) {
+  key = V::add64(V::bitNot(key), V::template shl64<21>(key));
+  key = V::bitXor(key, V::template shr64<24>(key));
+  key = V::add64(
+      V::add64(key, V::template shl64<3>(key)), V::template shl64<8>(key));
+  key = V::bitXor(key, V::template shr64<14>(key));
+  key = V::add64(
+      V::add64(key, V::template shl64<2>(key)), V::template shl64<4>(key));
+  key = V::bitXor(key, V::template shr64<28>(key));
+  key = V::add64(key, V::template shl64<31>(key));
+  return key;
+}
+
+template <typename V>
+FOLLY_ALWAYS_INLINE typename V::reg jenkinsRevMix32Lanes(typename V::reg key) {
+  key = V::add32(key, V::template shl32<12>(key));
+  key = V::bitXor(key, V::template shr32<22>(key));
+  key = V::add32(key, V::template shl32<4>(key));
+  key = V::bitXor(key, V::template shr32<9>(key));
+  key = V::add32(key, V::template shl32<10>(key));
+  key = V::bitXor(key, V::template shr32<2>(key));
+  key = V::add32(key, V::template shl32<7>(key));
+  key = V::add32(key, V::template shl32<12>(key));
+  return key;
+}
+
+#endif
+
+} // namespace detail
+
+/**
+ * Sets out[i] to twang_mix64(keys[i]), i.e. folly::hasher<uint64_t>.
+ */
+FOLLY_DISABLE_UNDEFINED_BEHAVIOR_SANITIZER("unsigned-integer-overflow")
+inline void hash_batch(
+    Range<const uint64_t*> keys, Range<uint64_t*> out) noexcept {
+  FOLLY_SAFE_DCHECK(out.size() >= keys.size(), "output is too short");
+  std::size_t i = 0;
+#if FOLLY_DETAIL_HASH_BATCH_SIMD
+  using V = detail::HashBatchNative;
+  constexpr std::size_t kLanes = V::kBytes / sizeof(uint64_t);
+  for (; i + kLanes <= keys.size(); i += kLanes) {
+    V::store(&out[i], detail::twangMix64Lanes<V>(V::load(&keys[i])));
+  }
+#endif
+  for (; i < keys.size(); ++i) {
+    out[i] = twang_mix64(keys[i]);
+  }
+}
+
+/**
+ * Sets out[i] to jenkins_rev_mix32(keys[i]), i.e. folly::hasher<uint32_t>.
+ */
+FOLLY_DISABLE_UNDEFINED_BEHAVIOR_SANITIZER("unsigned-integer-overflow")
+inline void hash_batch(
+    Range<const uint32_t*> keys, Range<uint32_t*> out) noexcept {
+  FOLLY_SAFE_DCHECK(out.size() >= keys.size(), "output is too short");
+  std::size_t i = 0;
+#if FOLLY_DETAIL_HASH_BATCH_SIMD
+  using V = detail::HashBatchNative;
+  constexpr std::size_t kLanes = V::kBytes / sizeof(uint32_t);
+  for (; i + kLanes <= keys.size(); i += kLanes) {
+    V::store(&out[i], detail::jenkinsRevMix32Lanes<V>(V::load(&keys[i])));
+  }
+#endif
+  for (; i < keys.size(); ++i) {
+    out[i] = jenkins_rev_mix32(keys[i]);
+  }
+}
+
+} // namespace hash
+} // namespace folly
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * A fast 64-bit hash for byte strings, built the way wyhash and rapidhash
+ * are: input words are xor-ed with secrets and folded together with a full
+ * 64x64->128-bit multiply, whose halves are xor-ed back into one word.
+ *
+ * Keys of up to 16 bytes are read with at most four overlapping loads and
+ * no loop, which is what makes it fast for the short strings that dominate
+ * string-keyed maps. Longer keys are consumed 48 bytes at a time in three
+ * independent lanes.
+ *
+ * Reads are little-endian, so the result is the same on every platform. It
+ * is not a cryptographic hash, and is not hardened against hash flooding.
+ *
+ * RapidStringHash is a transparent, avalanching hasher for string-like
+ * keys, for use as the Hasher of a single container. To hash the default
+ * HeterogeneousAccessHash<std::string> of every container with it, build
+ * with FOLLY_HETEROGENEOUS_ACCESS_RAPIDHASH=1; see HeterogeneousAccess.h.
+ *
+ * @file hash/RapidHash.h
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <folly/CPortability.h>
+#include <folly/Likely.h>
+#include <folly/Portability.h>
+#include <folly/Range.h>
+#include <folly/lang/Bits.h>
+
+namespace folly {
+namespace hash {
+
+namespace detail {
+
+constexpr uint64_t kRapidHashSecret[3] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull};
+
+// Replaces a and b with the low and high halves of their 128-bit product.
+FOLLY_ALWAYS_INLINE void rapidMum(uint64_t& a, uint64_t& b) noexcept {
+#if FOLLY_HAVE_INT128_T
+  auto const r = static_cast<unsigned __int128>(a) * b;
+  a = static_cast<uint64_t>(r);
+  b = static_cast<uint64_t>(r >> 64);
+#else
+  uint64_t const ha = a >> 32, hb = b >> 32;
+  uint64_t const la = a & 0xffffffff, lb = b & 0xffffffff;
+  uint64_t const rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t const t = rl + (rm0 << 32);
+  uint64_t const lo = t + (rm1 << 32);
+  uint64_t const c = (t < rl) + (lo < t);
+  a = lo;
+  b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+FOLLY_ALWAYS_INLINE uint64_t rapidMix(uint64_t a, uint64_t b) noexcept {
+  rapidMum(a, b);
+  return a ^ b;
+}
+
+FOLLY_ALWAYS_INLINE uint64_t rapidRead64(const uint8_t* p) noexcept {
+  return Endian::little(loadUnaligned<uint64_t>(p));
+}
+
+FOLLY_ALWAYS_INLINE uint64_t rapidRead32(const uint8_t* p) noexcept {
+  return Endian::little(loadUnaligned<uint32_t>(p));
+}
+
+} // namespace detail
+
+constexpr uint64_t kRapidHashDefaultSeed = 0xbdd89aa982704029ull;
+
+/**
+ * Returns a 64-bit hash of the len bytes at data.
+ */
+FOLLY_DISABLE_UNDEFINED_BEHAVIOR_SANITIZER("unsigned-integer-overflow")
+inline uint64_t rapidhash(
+    const void* data,
+    std::size_t len,
+    uint64_t seed = kRapidHashDefaultSeed) noexcept {
+  using namespace detail;
+  constexpr auto& s = kRapidHashSecret;
+  auto p = static_cast<const uint8_t*>(data);
+  seed ^= rapidMix(seed ^ s[0], s[1]) ^ len;
+  uint64_t a;
+  uint64_t b;
+  if (FOLLY_LIKELY(len <= 16)) {
+    if (len >= 4) {
+      // Two pairs of 4-byte reads, from both ends, overlapping as needed.
+      auto const last = p + len - 4;
+      auto const delta = (len & 24) >> (len >> 3);
+      a = (rapidRead32(p) << 32) | rapidRead32(last);
+      b = (rapidRead32(p + delta) << 32) | rapidRead32(last - delta);
+    } else if (len > 0) {
+      a = (uint64_t(p[0]) << 56) | (uint64_t(p[len >> 1]) << 32) | p[len - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    std::size_t i = len;
+    if (FOLLY_UNLIKELY(i > 48)) {
+      uint64_t see1 = seed;
+      uint64_t see2 = seed;
+      do {
+        seed = rapidMix(rapidRead64(p) ^ s[0], rapidRead64(p + 8) ^ seed);
+        see1 = rapidMix(rapidRead64(p + 16) ^ s[1], rapidRead64(p + 24) ^ see1);
+        see2 = rapidMix(rapidRead64(p + 32) ^ s[2], rapidRead64(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (FOLLY_LIKELY(i >= 48));
+      seed ^= see1 ^ see2;
+    }
+    if (i > 16) {
+      seed = rapidMix(rapidRead64(p) ^ s[2], rapidRead64(p + 8) ^ seed ^ s[1]);
+      if (i > 32) {
+        seed = rapidMix(rapidRead64(p + 16) ^ s[2], rapidRead64(p + 24) ^ seed);
+      }
+    }
+    // The last 16 bytes of the key, which may overlap bytes already mixed.
+    a = rapidRead64(p + i - 16);
+    b = rapidRead64(p + i - 8);
+  }
+  a ^= s[1];
+  b ^= seed;
+  rapidMum(a, b);
+  return rapidMix(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+} // namespace hash
+
+/**
+ * Transparent hasher for anything convertible to StringPiece: std::string,
+ * std::string_view, StringPiece, fbstring and string literals all hash
+ * alike, so a container keyed by std::string can be searched with any of
+ * them when paired with a transparent KeyEqual such as
+ * HeterogeneousAccessEqualTo<std::string>.
+ */
+struct RapidStringHash {
+  using is_transparent = void;
+  using folly_is_avalanching = std::true_type;
+
+  std::size_t operator()(StringPiece key) const noexcept {
+    return static_cast<std::size_t>(hash::rapidhash(key.data(), key.size()));
+  }
+};
+
+} // namespace folly
@@ -42,6 +42,24 @@ namespace detail {
 uint32_t crc32c_hw(
     const uint8_t* data, size_t nbytes, uint32_t startingChecksum = ~0U);
 
+/**
+ * Advance three independent CRC-32C computations at once, each over
+ * `nbytes` bytes of its own buffer, using the hardware instruction. The
+ * three streams are interleaved to hide the latency of the instruction.
+ *
+ * crc32c_copy_hw_x3() also copies each source buffer to its destination
+ * while it is being read.
+ *
+ * @note Like crc32c_hw(), only to be called if crc32c_hw_supported().
+ */
+void crc32c_hw_x3(
+    uint32_t crcs[3], const uint8_t* const data[3], size_t nbytes);
+void crc32c_copy_hw_x3(
+    uint32_t crcs[3],
+    uint8_t* const dst[3],
+    const uint8_t* const src[3],
+    size_t nbytes);
+
 /**
  * Check whether a SSE4.2 hardware-accelerated CRC-32C implementation is
  * supported on the current CPU.
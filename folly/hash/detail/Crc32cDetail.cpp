@@ -29,6 +29,7 @@
  * other code cleanup
  */
 
+#include <cstring>
 #include <stdexcept>
 
 #include <boost/preprocessor/arithmetic/add.hpp>
@@ -235,8 +236,64 @@ void triplet_loop(
   next = (const unsigned char*)next2;
 }
 
+// Three independent streams, one word of each per iteration, so that the
+// crc32 instructions of different streams overlap.
+template <bool Copy>
+FOLLY_TARGET_ATTRIBUTE("sse4.2")
+void x3_loop(
+    uint32_t crcs[3],
+    uint8_t* const dst[3],
+    const uint8_t* const src[3],
+    size_t nbytes) {
+  uint64_t crc0 = crcs[0], crc1 = crcs[1], crc2 = crcs[2];
+  size_t i = 0;
+  for (; i + 8 <= nbytes; i += 8) {
+    uint64_t word0, word1, word2;
+    std::memcpy(&word0, src[0] + i, 8);
+    std::memcpy(&word1, src[1] + i, 8);
+    std::memcpy(&word2, src[2] + i, 8);
+    crc0 = _mm_crc32_u64(crc0, word0);
+    crc1 = _mm_crc32_u64(crc1, word1);
+    crc2 = _mm_crc32_u64(crc2, word2);
+    if constexpr (Copy) {
+      std::memcpy(dst[0] + i, &word0, 8);
+      std::memcpy(dst[1] + i, &word1, 8);
+      std::memcpy(dst[2] + i, &word2, 8);
+    }
+  }
+  auto c0 = static_cast<uint32_t>(crc0);
+  auto c1 = static_cast<uint32_t>(crc1);
+  auto c2 = static_cast<uint32_t>(crc2);
+  for (; i < nbytes; ++i) {
+    c0 = _mm_crc32_u8(c0, src[0][i]);
+    c1 = _mm_crc32_u8(c1, src[1][i]);
+    c2 = _mm_crc32_u8(c2, src[2][i]);
+    if constexpr (Copy) {
+      dst[0][i] = src[0][i];
+      dst[1][i] = src[1][i];
+      dst[2][i] = src[2][i];
+    }
+  }
+  crcs[0] = c0;
+  crcs[1] = c1;
+  crcs[2] = c2;
+}
+
 } // namespace crc32_detail
 
+void crc32c_hw_x3(
+    uint32_t crcs[3], const uint8_t* const data[3], size_t nbytes) {
+  crc32_detail::x3_loop<false>(crcs, nullptr, data, nbytes);
+}
+
+void crc32c_copy_hw_x3(
+    uint32_t crcs[3],
+    uint8_t* const dst[3],
+    const uint8_t* const src[3],
+    size_t nbytes) {
+  crc32_detail::x3_loop<true>(crcs, dst, src, nbytes);
+}
+
 /* Compute CRC-32C using the Intel hardware instruction. */
 FOLLY_TARGET_ATTRIBUTE("sse4.2")
 uint32_t crc32c_hw(const uint8_t* buf, size_t len, uint32_t crc) {
@@ -293,6 +350,21 @@ uint32_t crc32c_hw(
   throw std::runtime_error("crc32_hw is not implemented on this platform");
 }
 
+void crc32c_hw_x3(
+    uint32_t* /* crcs */,
+    const uint8_t* const* /* data */,
+    size_t /* nbytes */) {
+  throw std::runtime_error("crc32_hw is not implemented on this platform");
+}
+
+void crc32c_copy_hw_x3(
+    uint32_t* /* crcs */,
+    uint8_t* const* /* dst */,
+    const uint8_t* const* /* src */,
+    size_t /* nbytes */) {
+  throw std::runtime_error("crc32_hw is not implemented on this platform");
+}
+
 #endif
 
 } // namespace detail
@@ -24,6 +24,7 @@
 #include <folly/external/fast-crc32/sse_crc32c_v8s3x3.h>
 #include <folly/hash/Hash.h>
 #include <folly/hash/detail/ChecksumDetail.h>
+#include <folly/io/IOBuf.h>
 #include <folly/portability/GFlags.h>
 #include <folly/portability/GTest.h>
 
@@ -311,6 +312,41 @@ TEST(Checksum, crc32cCombine) {
   }
 }
 
+TEST(Checksum, crc32cIOBuf) {
+  // Chains of small buffers, of large ones, and mixed, with empty buffers
+  for (size_t maxLength : {0, 17, 300, 5000, 100000}) {
+    auto chain = folly::IOBuf::create(0);
+    size_t offset = 0;
+    while (offset < BUFFER_SIZE / 16) {
+      size_t length = folly::Random::rand64(0, maxLength + 1);
+      chain->prependChain(folly::IOBuf::wrapBuffer(&buffer[offset], length));
+      offset += length;
+      if (maxLength == 0) {
+        break;
+      }
+    }
+    auto expected = folly::crc32c(&buffer[0], offset);
+    EXPECT_EQ(expected, folly::crc32c_iobuf(*chain)) << maxLength;
+    EXPECT_EQ(
+        folly::crc32c(&buffer[0], offset, 1234),
+        folly::crc32c_iobuf(*chain, 1234))
+        << maxLength;
+  }
+}
+
+TEST(Checksum, crc32cCopy) {
+  std::vector<uint8_t> copy(BUFFER_SIZE);
+  for (size_t length : {0, 1, 7, 4095, 4096, 4097, 4098, 12345, 65536}) {
+    std::fill(copy.begin(), copy.end(), 0);
+    auto expected = folly::crc32c(&buffer[3], length, 5678);
+    EXPECT_EQ(
+        expected, folly::crc32c_copy(&copy[1], &buffer[3], length, 5678))
+        << length;
+    EXPECT_EQ(0, memcmp(&copy[1], &buffer[3], length)) << length;
+    EXPECT_EQ(0, copy[length + 1]) << length;
+  }
+}
+
 void benchmarkHardwareCRC32C(unsigned long iters, size_t blockSize) {
   if (folly::detail::crc32c_hw_supported()) {
     uint32_t checksum;
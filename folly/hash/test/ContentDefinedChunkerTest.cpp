@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/hash/ContentDefinedChunker.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBuf.h>
+#include <folly/portability/GTest.h>
+
+using folly::ByteRange;
+using folly::IOBuf;
+using folly::hash::chunkSizes;
+using folly::hash::ContentDefinedChunker;
+
+namespace {
+
+std::vector<uint8_t> randomBytes(size_t n, uint32_t seed = 1729) {
+  std::vector<uint8_t> ret(n);
+  std::mt19937 rng(seed);
+  for (auto& b : ret) {
+    b = static_cast<uint8_t>(rng());
+  }
+  return ret;
+}
+
+// The buffers of a chain, each of the given size, over data.
+std::unique_ptr<IOBuf> split(const std::vector<uint8_t>& data, size_t piece) {
+  auto chain = IOBuf::create(0);
+  for (size_t i = 0; i < data.size(); i += piece) {
+    chain->prependChain(IOBuf::wrapBuffer(
+        data.data() + i, std::min(piece, data.size() - i)));
+  }
+  return chain;
+}
+
+} // namespace
+
+TEST(ContentDefinedChunker, sizes) {
+  auto const data = randomBytes(4 << 20);
+  ContentDefinedChunker::Options options;
+  auto const sizes = chunkSizes(*IOBuf::wrapBuffer(data.data(), data.size()));
+
+  EXPECT_EQ(
+      data.size(), std::accumulate(sizes.begin(), sizes.end(), size_t(0)));
+  for (size_t i = 0; i + 1 < sizes.size(); ++i) {
+    EXPECT_GE(sizes[i], options.minSize);
+    EXPECT_LE(sizes[i], options.maxSize);
+  }
+  auto const mean = data.size() / sizes.size();
+  EXPECT_GT(mean, options.avgSize / 2);
+  EXPECT_LT(mean, options.avgSize * 2);
+}
+
+TEST(ContentDefinedChunker, independentOfSplits) {
+  auto const data = randomBytes(1 << 20);
+  auto const expected =
+      chunkSizes(*IOBuf::wrapBuffer(data.data(), data.size()));
+  for (size_t piece : {1, 7, 4096, 100000}) {
+    EXPECT_EQ(expected, chunkSizes(*split(data, piece))) << piece;
+  }
+}
+
+TEST(ContentDefinedChunker, boundariesAreLocal) {
+  // Inserting bytes near the start of the stream only moves the boundaries
+  // of the first few chunks.
+  auto const data = randomBytes(1 << 20);
+  auto edited = data;
+  auto const extra = randomBytes(100, 42);
+  edited.insert(edited.begin() + 5000, extra.begin(), extra.end());
+
+  auto const before = chunkSizes(*IOBuf::wrapBuffer(data.data(), data.size()));
+  auto const after =
+      chunkSizes(*IOBuf::wrapBuffer(edited.data(), edited.size()));
+  ASSERT_GT(before.size(), 10);
+  ASSERT_GT(after.size(), 10);
+  EXPECT_TRUE(std::equal(before.end() - 10, before.end(), after.end() - 10));
+}
+
+TEST(ContentDefinedChunker, cursor) {
+  auto const data = randomBytes(1 << 20);
+  auto const chain = split(data, 3000);
+  auto const expected = chunkSizes(*chain);
+
+  ContentDefinedChunker chunker;
+  folly::io::Cursor cursor(chain.get());
+  std::vector<size_t> sizes;
+  size_t offset = 0;
+  while (!cursor.isAtEnd()) {
+    auto start = cursor;
+    bool const ended = chunker.scan(cursor);
+    auto const size = cursor - start;
+    std::unique_ptr<IOBuf> chunk;
+    start.clone(chunk, size);
+    EXPECT_EQ(ByteRange(data.data() + offset, size), chunk->coalesce());
+    offset += size;
+    sizes.push_back(size);
+    if (!ended) {
+      EXPECT_TRUE(cursor.isAtEnd());
+    }
+  }
+  EXPECT_EQ(expected, sizes);
+}
+
+TEST(ContentDefinedChunker, maxSize) {
+  // Constant data has no boundaries, so every chunk ends at maxSize.
+  std::vector<uint8_t> const zeros(100000);
+  ContentDefinedChunker::Options options;
+  options.minSize = 1000;
+  options.avgSize = 4096;
+  options.maxSize = 10000;
+  auto const sizes =
+      chunkSizes(*IOBuf::wrapBuffer(zeros.data(), zeros.size()), options);
+  EXPECT_EQ(std::vector<size_t>(10, 10000), sizes);
+}
+
+TEST(ContentDefinedChunker, options) {
+  ContentDefinedChunker::Options options;
+  options.minSize = 0;
+  EXPECT_THROW(ContentDefinedChunker{options}, std::invalid_argument);
+  options = {};
+  options.avgSize = options.maxSize + 1;
+  EXPECT_THROW(ContentDefinedChunker{options}, std::invalid_argument);
+  options = {};
+  options.normalization = 64;
+  EXPECT_THROW(ContentDefinedChunker{options}, std::invalid_argument);
+
+  options = {};
+  options.normalization = 0;
+  auto const data = randomBytes(1 << 20);
+  auto const sizes =
+      chunkSizes(*IOBuf::wrapBuffer(data.data(), data.size()), options);
+  EXPECT_GT(sizes.size(), 1);
+}
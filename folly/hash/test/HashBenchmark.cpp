@@ -15,10 +15,13 @@
  */
 
 #include <folly/hash/Hash.h>
+#include <folly/hash/HashBatch.h>
+#include <folly/hash/RapidHash.h>
 
 #include <stdint.h>
 
 #include <deque>
+#include <memory>
 #include <random>
 #include <string>
 #include <vector>
@@ -77,12 +80,55 @@ struct SpookyHashV2 {
   }
 };
 
+struct RapidHash {
+  uint64_t operator()(const uint8_t* data, size_t size) const {
+    return folly::hash::rapidhash(data, size);
+  }
+};
+
 struct FNV64 {
   uint64_t operator()(const uint8_t* data, size_t size) const {
     return folly::hash::fnv64_buf(data, size);
   }
 };
 
+template <class Int>
+void addHashBatchBenchmark(const std::string& name) {
+  static std::deque<std::string> names;
+
+  // 4KiB of keys, so the loop is bound by the mixing and not by memory.
+  auto keys = std::make_shared<std::vector<Int>>(4096 / sizeof(Int));
+  std::mt19937_64 rng(1729);
+  std::generate(keys->begin(), keys->end(), [&] { return Int(rng()); });
+  auto out = std::make_shared<std::vector<Int>>(keys->size());
+
+  names.emplace_back(fmt::format("{}: hasher", name));
+  folly::addBenchmark(__FILE__, names.back().c_str(), [=](unsigned iters) {
+    folly::hasher<Int> hasher;
+    for (unsigned i = 0; i < iters; ++i) {
+      for (size_t j = 0; j < keys->size(); ++j) {
+        (*out)[j] = static_cast<Int>(hasher((*keys)[j]));
+      }
+      folly::doNotOptimizeAway(out->data());
+    }
+    return iters * keys->size();
+  });
+
+  names.emplace_back(fmt::format("{}: hash_batch", name));
+  folly::addBenchmark(__FILE__, names.back().c_str(), [=](unsigned iters) {
+    for (unsigned i = 0; i < iters; ++i) {
+      folly::hash::hash_batch(
+          folly::Range<const Int*>(keys->data(), keys->size()),
+          folly::range(*out));
+      folly::doNotOptimizeAway(out->data());
+    }
+    return iters * keys->size();
+  });
+
+  /* Draw line. */
+  folly::addBenchmark(__FILE__, "-", []() { return 0; });
+}
+
 } // namespace detail
 
 int main(int argc, char** argv) {
@@ -96,9 +142,13 @@ int main(int argc, char** argv) {
 
   BENCHMARK_HASH(SpookyHashV2);
   BENCHMARK_HASH(FNV64);
+  BENCHMARK_HASH(RapidHash);
 
 #undef BENCHMARK_HASH
 
+  detail::addHashBatchBenchmark<uint64_t>("uint64_t");
+  detail::addHashBatchBenchmark<uint32_t>("uint32_t");
+
   folly::runBenchmarks();
 
   return 0;
@@ -15,6 +15,7 @@
  */
 
 #include <folly/hash/Hash.h>
+#include <folly/hash/HashBatch.h>
 
 #include <stdint.h>
 
@@ -22,6 +23,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <folly/Conv.h>
 #include <folly/MapUtil.h>
@@ -190,6 +192,38 @@ TEST(Hash, JenkinsRevUnmix32) {
   }
 }
 
+TEST(Hash, hashBatch) {
+  // Long enough for full registers of every width, plus a remainder.
+  std::mt19937_64 rng(1234);
+  std::vector<uint64_t> keys64(37);
+  std::vector<uint32_t> keys32(keys64.size());
+  for (size_t i = 0; i < keys64.size(); ++i) {
+    keys64[i] = rng();
+    keys32[i] = static_cast<uint32_t>(keys64[i]);
+  }
+  keys64[0] = 0;
+  keys64[1] = ~uint64_t(0);
+
+  for (size_t n = 0; n <= keys64.size(); ++n) {
+    std::vector<uint64_t> out64(n);
+    hash_batch(
+        folly::Range<const uint64_t*>(keys64.data(), n), folly::range(out64));
+    std::vector<uint32_t> out32(n);
+    hash_batch(
+        folly::Range<const uint32_t*>(keys32.data(), n), folly::range(out32));
+    for (size_t i = 0; i < n; ++i) {
+      EXPECT_EQ(folly::hasher<uint64_t>()(keys64[i]), out64[i]);
+      EXPECT_EQ(folly::hasher<uint32_t>()(keys32[i]), out32[i]);
+    }
+  }
+
+  auto inPlace = keys64;
+  hash_batch(folly::range(inPlace), folly::range(inPlace));
+  for (size_t i = 0; i < keys64.size(); ++i) {
+    EXPECT_EQ(twang_mix64(keys64[i]), inPlace[i]);
+  }
+}
+
 TEST(Hash, hasher) {
   // Basically just confirms that things compile ok.
   std::unordered_map<int32_t, int32_t, folly::hasher<int32_t>> m;
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/hash/RapidHash.h>
+
+#include <bitset>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <folly/FBString.h>
+#include <folly/container/F14Map.h>
+#include <folly/container/HeterogeneousAccess.h>
+#include <folly/portability/GTest.h>
+
+using folly::hash::rapidhash;
+
+namespace {
+
+std::vector<uint8_t> randomBytes(size_t n) {
+  std::vector<uint8_t> ret(n);
+  std::mt19937 rng(1729);
+  for (auto& b : ret) {
+    b = static_cast<uint8_t>(rng());
+  }
+  return ret;
+}
+
+} // namespace
+
+TEST(RapidHash, simple) {
+  EXPECT_NE(rapidhash("foo", 3), rapidhash("bar", 3));
+  EXPECT_NE(rapidhash("foo", 3), rapidhash("foo", 3, 1));
+  EXPECT_NE(rapidhash("", 0), rapidhash("\0", 1));
+  EXPECT_EQ(rapidhash("foo", 3), rapidhash(std::string("foo").data(), 3));
+}
+
+TEST(RapidHash, everyByteMatters) {
+  // Flipping any bit of any byte, at every length through both the short
+  // key path and the 48-byte blocks, changes the hash. Bytes outside the
+  // key must not.
+  auto bytes = randomBytes(300);
+  for (size_t len = 0; len < 200; ++len) {
+    auto const h = rapidhash(bytes.data() + 50, len);
+    for (size_t i = 0; i < len; ++i) {
+      for (int bit = 0; bit < 8; ++bit) {
+        bytes[50 + i] ^= uint8_t(1 << bit);
+        EXPECT_NE(h, rapidhash(bytes.data() + 50, len)) << len << " " << i;
+        bytes[50 + i] ^= uint8_t(1 << bit);
+      }
+    }
+    bytes[49] ^= 1;
+    bytes[50 + len] ^= 1;
+    EXPECT_EQ(h, rapidhash(bytes.data() + 50, len)) << len;
+    bytes[49] ^= 1;
+    bytes[50 + len] ^= 1;
+  }
+}
+
+TEST(RapidHash, distinctLengths) {
+  std::string zeros(200, '\0');
+  std::set<uint64_t> seen;
+  for (size_t len = 0; len <= zeros.size(); ++len) {
+    EXPECT_TRUE(seen.insert(rapidhash(zeros.data(), len)).second) << len;
+  }
+}
+
+TEST(RapidHash, avalanche) {
+  // Every output bit flips for roughly half of all single-bit input changes.
+  std::mt19937_64 rng(1234);
+  constexpr int kTrials = 2000;
+  for (size_t len : {3, 8, 13, 16, 24, 40, 64, 100}) {
+    std::vector<int> flips(64);
+    for (int t = 0; t < kTrials; ++t) {
+      auto bytes = randomBytes(len);
+      for (auto& b : bytes) {
+        b ^= static_cast<uint8_t>(rng());
+      }
+      auto const h = rapidhash(bytes.data(), len);
+      auto const bit = rng() % (len * 8);
+      bytes[bit / 8] ^= uint8_t(1 << (bit % 8));
+      std::bitset<64> diff(h ^ rapidhash(bytes.data(), len));
+      for (int i = 0; i < 64; ++i) {
+        flips[i] += diff[i];
+      }
+    }
+    for (int i = 0; i < 64; ++i) {
+      EXPECT_GT(flips[i], kTrials * 4 / 10) << len << " " << i;
+      EXPECT_LT(flips[i], kTrials * 6 / 10) << len << " " << i;
+    }
+  }
+}
+
+TEST(RapidStringHash, heterogeneous) {
+  folly::RapidStringHash h;
+  std::string s = "a string long enough not to be inlined";
+  EXPECT_EQ(h(s), rapidhash(s.data(), s.size()));
+  EXPECT_EQ(h(s), h(std::string_view(s)));
+  EXPECT_EQ(h(s), h(folly::StringPiece(s)));
+  EXPECT_EQ(h(s), h(folly::fbstring(s)));
+  EXPECT_EQ(h(s), h(s.c_str()));
+
+  folly::F14FastMap<
+      std::string,
+      int,
+      folly::RapidStringHash,
+      folly::HeterogeneousAccessEqualTo<std::string>>
+      m;
+  m[s] = 1;
+  m["short"] = 2;
+  EXPECT_EQ(1, m.at(std::string_view(s)));
+  EXPECT_EQ(2, m.at(folly::StringPiece("short")));
+  EXPECT_TRUE(m.find("missing") == m.end());
+}
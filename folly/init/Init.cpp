@@ -22,6 +22,7 @@
 
 #include <folly/Singleton.h>
 #include <folly/init/Phase.h>
+#include <folly/init/StartupTimes.h>
 #include <folly/logging/Init.h>
 #include <folly/portability/Config.h>
 #include <folly/synchronization/HazptrThreadPoolExecutor.h>
@@ -64,46 +65,63 @@ wrapped_abort() {
 #endif
 
 void initImpl(int* argc, char*** argv, InitOptions options) {
+  {
+    StartupTimer timer("folly::Init");
+
 #if !defined(_WIN32)
-  // Install the handler now, to trap errors received during startup.
-  // The callbacks, if any, can be installed later
-  folly::symbolizer::installFatalSignalHandler(options.fatal_signals);
+    {
+      // Install the handler now, to trap errors received during startup.
+      // The callbacks, if any, can be installed later
+      StartupTimer phase("folly::Init: fatal signal handler");
+      folly::symbolizer::installFatalSignalHandler(options.fatal_signals);
+    }
 #endif
 
-  // Indicate ProcessPhase::Regular and register handler to
-  // indicate ProcessPhase::Exit.
-  folly::set_process_phases();
-
-  // Move from the registration phase to the "you can actually instantiate
-  // things now" phase.
-  folly::SingletonVault::singleton()->registrationComplete();
-
-#if !FOLLY_HAVE_LIBGFLAGS
-  (void)options;
-#else
-  if (options.use_gflags) {
-    gflags::ParseCommandLineFlags(argc, argv, options.remove_flags);
-  }
+    // Indicate ProcessPhase::Regular and register handler to
+    // indicate ProcessPhase::Exit.
+    folly::set_process_phases();
+
+    {
+      // Move from the registration phase to the "you can actually
+      // instantiate things now" phase.
+      StartupTimer phase("folly::Init: singleton registration");
+      folly::SingletonVault::singleton()->registrationComplete();
+    }
+
+#if FOLLY_HAVE_LIBGFLAGS
+    if (options.use_gflags) {
+      StartupTimer phase("folly::Init: gflags");
+      gflags::ParseCommandLineFlags(argc, argv, options.remove_flags);
+    }
 #endif
 
-  auto const follyLoggingEnv = std::getenv(kLoggingEnvVarName);
-  auto const follyLoggingEnvOr = follyLoggingEnv ? follyLoggingEnv : "";
-  folly::initLoggingOrDie({follyLoggingEnvOr, FLAGS_logging});
-  auto programName = argc && argv && *argc > 0 ? (*argv)[0] : "unknown";
-  google::InitGoogleLogging(programName);
+    {
+      StartupTimer phase("folly::Init: logging");
+      auto const follyLoggingEnv = std::getenv(kLoggingEnvVarName);
+      auto const follyLoggingEnvOr = follyLoggingEnv ? follyLoggingEnv : "";
+      folly::initLoggingOrDie({follyLoggingEnvOr, FLAGS_logging});
+      auto programName = argc && argv && *argc > 0 ? (*argv)[0] : "unknown";
+      google::InitGoogleLogging(programName);
+    }
 
 #if FOLLY_USE_SYMBOLIZER
-  // Don't use glog's DumpStackTraceAndExit; rely on our signal handler.
-  google::InstallFailureFunction(wrapped_abort);
+    // Don't use glog's DumpStackTraceAndExit; rely on our signal handler.
+    google::InstallFailureFunction(wrapped_abort);
+
+    if (options.install_fatal_signal_callbacks) {
+      // Actually install the callbacks into the handler.
+      StartupTimer phase("folly::Init: fatal signal callbacks");
+      folly::symbolizer::installFatalSignalCallbacks();
+    }
+#endif
+    // Set the default hazard pointer domain to use a thread pool executor
+    // for asynchronous reclamation
+    folly::enable_hazptr_thread_pool_executor();
+  }
 
-  if (options.install_fatal_signal_callbacks) {
-    // Actually install the callbacks into the handler.
-    folly::symbolizer::installFatalSignalCallbacks();
+  if (options.log_startup_report) {
+    LOG(INFO) << getStartupReport();
   }
-#endif
-  // Set the default hazard pointer domain to use a thread pool executor
-  // for asynchronous reclamation
-  folly::enable_hazptr_thread_pool_executor();
 }
 
 } // namespace
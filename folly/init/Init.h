@@ -41,6 +41,10 @@ class InitOptions {
   // Defaults to all signal in `symbolizer::kAllFatalSignals`
   std::bitset<64> fatal_signals;
 
+  // Log a breakdown of the time spent so far in startup, including each
+  // phase of init, at the end of init. See folly/init/StartupTimes.h.
+  bool log_startup_report{false};
+
   InitOptions& removeFlags(bool remove) {
     remove_flags = remove;
     return *this;
@@ -60,6 +64,11 @@ class InitOptions {
     install_fatal_signal_callbacks = installFatalSignalCallbacks;
     return *this;
   }
+
+  InitOptions& logStartupReport(bool logStartupReport) {
+    log_startup_report = logStartupReport;
+    return *this;
+  }
 };
 
 /*
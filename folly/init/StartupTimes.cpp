@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/init/StartupTimes.h>
+
+#include <algorithm>
+
+#include <fmt/format.h>
+
+#include <folly/Indestructible.h>
+#include <folly/Singleton.h>
+#include <folly/Synchronized.h>
+
+namespace folly {
+
+namespace {
+
+// Function-local so that it can be used from static initializers.
+Synchronized<std::vector<StartupTime>>& startupTimes() {
+  static Indestructible<Synchronized<std::vector<StartupTime>>> times;
+  return *times;
+}
+
+double toMillis(std::chrono::nanoseconds duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+void recordStartupTime(std::string name, std::chrono::nanoseconds duration) {
+  startupTimes().wlock()->push_back({std::move(name), duration});
+}
+
+StartupTimer::StartupTimer(std::string name)
+    : name_(std::move(name)), start_(std::chrono::steady_clock::now()) {}
+
+StartupTimer::~StartupTimer() {
+  recordStartupTime(
+      std::move(name_),
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start_));
+}
+
+std::vector<StartupTime> getStartupTimes() {
+  return startupTimes().copy();
+}
+
+std::string getStartupReport() {
+  std::string report = "Startup steps:\n";
+  for (auto const& step : getStartupTimes()) {
+    report +=
+        fmt::format("  {:10.3f} ms  {}\n", toMillis(step.duration), step.name);
+  }
+
+  // Creation times include the singletons created from within create
+  // functions, so they don't add up.
+  auto singletons = SingletonVault::singleton()->getCreationTimes();
+  std::sort(singletons.begin(), singletons.end(), [](auto& a, auto& b) {
+    return a.duration > b.duration;
+  });
+  report += fmt::format("Singletons ({} created):\n", singletons.size());
+  for (auto const& singleton : singletons) {
+    report += fmt::format(
+        "  {:10.3f} ms  {}\n", toMillis(singleton.duration), singleton.name);
+  }
+  return report;
+}
+
+} // namespace folly
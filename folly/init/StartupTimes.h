@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace folly {
+
+/// Timing of program startup, to find out where the time to get a program
+/// ready goes.
+///
+/// folly::Init records each of its own phases here. Programs can record
+/// their own startup steps, including static initializers, with
+/// StartupTimer or recordStartupTime(). getStartupReport() puts these
+/// together with the creation times of folly::Singletons.
+
+struct StartupTime {
+  std::string name;
+  std::chrono::nanoseconds duration;
+};
+
+/// Record that the startup step name took duration. Safe to call from
+/// static initializers and from any thread.
+void recordStartupTime(std::string name, std::chrono::nanoseconds duration);
+
+/// Records the time from its construction to its destruction as the
+/// startup step name.
+///
+///   static auto const gTable = [] {
+///     folly::StartupTimer timer("build lookup table");
+///     return buildLookupTable();
+///   }();
+class StartupTimer {
+ public:
+  explicit StartupTimer(std::string name);
+  ~StartupTimer();
+
+  StartupTimer(StartupTimer const&) = delete;
+  StartupTimer& operator=(StartupTimer const&) = delete;
+
+ private:
+  std::string name_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/// The startup steps recorded so far, in the order they finished.
+std::vector<StartupTime> getStartupTimes();
+
+/// A human-readable breakdown of startup: the recorded steps in the order
+/// they finished, then the folly::Singletons created so far, slowest first.
+std::string getStartupReport();
+
+} // namespace folly
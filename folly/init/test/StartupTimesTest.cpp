@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/init/StartupTimes.h>
+
+#include <thread>
+
+#include <folly/Singleton.h>
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+struct Slow {
+  Slow() { std::this_thread::sleep_for(1ms); }
+};
+
+struct SlowTag {};
+
+folly::Singleton<Slow, SlowTag> slow;
+
+auto const staticInit = [] {
+  folly::StartupTimer timer("static init");
+  std::this_thread::sleep_for(1ms);
+  return 0;
+}();
+
+} // namespace
+
+TEST(StartupTimes, basic) {
+  folly::recordStartupTime("explicit", 5ms);
+  auto const times = folly::getStartupTimes();
+  ASSERT_EQ(2, times.size());
+  EXPECT_EQ("static init", times[0].name);
+  EXPECT_GE(times[0].duration, 1ms);
+  EXPECT_EQ("explicit", times[1].name);
+  EXPECT_EQ(5ms, times[1].duration);
+}
+
+TEST(StartupTimes, report) {
+  folly::SingletonVault::singleton()->registrationComplete();
+  folly::Singleton<Slow, SlowTag>::try_get();
+  auto const report = folly::getStartupReport();
+  EXPECT_THAT(report, testing::HasSubstr("static init"));
+  EXPECT_THAT(report, testing::HasSubstr("SlowTag"));
+}
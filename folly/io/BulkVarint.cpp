@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/BulkVarint.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <folly/Likely.h>
+#include <folly/Varint.h>
+#include <folly/lang/Bits.h>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+namespace folly {
+namespace io {
+
+namespace {
+
+constexpr uint64_t kMsbs = 0x8080808080808080ULL;
+constexpr uint64_t kLowBits = 0x7f7f7f7f7f7f7f7fULL;
+
+// Pack the low 7 bits of each byte of word into the low 56 bits.
+FOLLY_ALWAYS_INLINE uint64_t packVarint(uint64_t word) {
+#ifdef __BMI2__
+  return _pext_u64(word, kLowBits);
+#else
+  word &= kLowBits;
+  word = ((word & 0x7f007f007f007f00ULL) >> 1) | (word & 0x007f007f007f007fULL);
+  word = ((word & 0x3fff00003fff0000ULL) >> 2) | (word & 0x00003fff00003fffULL);
+  word = ((word & 0x0fffffff00000000ULL) >> 4) | (word & 0x000000000fffffffULL);
+  return word;
+#endif
+}
+
+// The inverse of packVarint(), for values below 2^56.
+FOLLY_ALWAYS_INLINE uint64_t unpackVarint(uint64_t value) {
+#ifdef __BMI2__
+  return _pdep_u64(value, kLowBits);
+#else
+  value = (value & 0x000000000fffffffULL) |
+      ((value & 0x00fffffff0000000ULL) << 4);
+  value = (value & 0x00003fff00003fffULL) |
+      ((value & 0x0fffc0000fffc000ULL) << 2);
+  value = (value & 0x007f007f007f007fULL) |
+      ((value & 0x3f803f803f803f80ULL) << 1);
+  return value;
+#endif
+}
+
+} // namespace
+
+size_t decodeVarints(Cursor& cursor, Range<uint64_t*> out) {
+  size_t n = 0;
+  while (n < out.size()) {
+    auto bytes = cursor.peekBytes();
+    const uint8_t* p = bytes.data();
+    const uint8_t* end = p + bytes.size();
+
+    // Decode a word at a time while any varint fits in the current buffer.
+    while (n < out.size() && size_t(end - p) >= kMaxVarintLength64) {
+      uint64_t word = Endian::little(loadUnaligned<uint64_t>(p));
+      uint64_t stops = ~word & kMsbs;
+      if (FOLLY_LIKELY(stops != 0)) {
+        size_t len = findFirstSet(stops) / 8;
+        out[n++] = packVarint(word & (~uint64_t(0) >> (64 - 8 * len)));
+        p += len;
+      } else {
+        ByteRange range(p, end);
+        auto value = tryDecodeVarint(range);
+        if (!value) {
+          cursor.skip(p - bytes.data());
+          throw std::invalid_argument("Invalid varint value: too many bytes.");
+        }
+        out[n++] = *value;
+        p = range.begin();
+      }
+    }
+    cursor.skip(p - bytes.data());
+    if (n == out.size()) {
+      break;
+    }
+
+    // Close to the end of the buffer: the next varint may continue into the
+    // following ones.
+    uint8_t buf[kMaxVarintLength64];
+    size_t available = Cursor(cursor).pullAtMost(buf, sizeof(buf));
+    if (available == 0) {
+      break;
+    }
+    ByteRange range(buf, available);
+    auto value = tryDecodeVarint(range);
+    if (!value) {
+      if (value.error() == DecodeVarintError::TooFewBytes) {
+        break;
+      }
+      throw std::invalid_argument("Invalid varint value: too many bytes.");
+    }
+    out[n++] = *value;
+    cursor.skip(range.begin() - buf);
+  }
+  return n;
+}
+
+void encodeVarints(QueueAppender& appender, Range<const uint64_t*> values) {
+  while (!values.empty()) {
+    // Encode as many values as surely fit in the writable tail.
+    appender.ensure(kMaxVarintLength64);
+    size_t batch =
+        std::min(values.size(), appender.length() / kMaxVarintLength64);
+    uint8_t* start = appender.writableData();
+    uint8_t* p = start;
+    for (size_t i = 0; i < batch; ++i) {
+      uint64_t value = values[i];
+      if (FOLLY_LIKELY(value < (uint64_t(1) << 56))) {
+        // Always stores 8 bytes, which the batch size leaves room for.
+        size_t len = encodeVarintSize(value);
+        uint64_t more = kMsbs & ((uint64_t(1) << (8 * (len - 1))) - 1);
+        storeUnaligned(p, Endian::little(unpackVarint(value) | more));
+        p += len;
+      } else {
+        p += encodeVarint(value, p);
+      }
+    }
+    appender.append(p - start);
+    values.advance(batch);
+  }
+}
+
+} // namespace io
+} // namespace folly
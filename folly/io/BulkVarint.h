@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <folly/Range.h>
+#include <folly/io/Cursor.h>
+
+/**
+ * Bulk encoding and decoding of varints (see folly/Varint.h) to and from
+ * IOBuf chains.
+ *
+ * Varints of up to 8 bytes, that is values below 2^56, are converted a
+ * whole 64-bit word at a time: the 7-bit groups are packed or unpacked with
+ * PEXT / PDEP when built for BMI2, and with a few shifts and masks
+ * otherwise. Longer varints, and varints that span IOBufs, go through the
+ * scalar encodeVarint() and tryDecodeVarint().
+ */
+
+namespace folly {
+namespace io {
+
+/**
+ * Decode up to out.size() varints from the cursor into out, advancing the
+ * cursor past them. Returns the number of values decoded, which is less
+ * than out.size() if the chain ends first; a truncated varint at the end
+ * of the chain is left unread.
+ *
+ * Throws std::invalid_argument if a varint is longer than 10 bytes. The
+ * cursor is then left at the start of that varint.
+ */
+size_t decodeVarints(Cursor& cursor, Range<uint64_t*> out);
+
+/**
+ * Append the varint encoding of each value.
+ */
+void encodeVarints(QueueAppender& appender, Range<const uint64_t*> values);
+
+} // namespace io
+} // namespace folly
@@ -38,6 +38,27 @@ class CursorNoopAppender {
   void append(ByteRange) {}
 };
 
+namespace detail {
+
+// Whether the bytes at the cursor position start with needle.
+inline bool cursorStartsWith(Cursor cursor, ByteRange needle) {
+  while (!needle.empty()) {
+    auto bytes = cursor.peekBytes();
+    if (bytes.empty()) {
+      return false;
+    }
+    auto len = std::min(bytes.size(), needle.size());
+    if (std::memcmp(bytes.data(), needle.data(), len) != 0) {
+      return false;
+    }
+    needle.advance(len);
+    cursor.skip(len);
+  }
+  return true;
+}
+
+} // namespace detail
+
 template <class Derived, class BufType>
 std::string CursorBase<Derived, BufType>::readTerminatedString(
     char termChar, size_t maxLength) {
@@ -101,5 +122,64 @@ void CursorBase<Derived, BufType>::skipWhile(const Predicate& predicate) {
   readWhile(predicate, appender);
 }
 
+template <class Derived, class BufType>
+Optional<size_t> CursorBase<Derived, BufType>::findByte(uint8_t byte) const {
+  Cursor cursor(*this);
+  size_t offset = 0;
+  while (true) {
+    auto bytes = cursor.peekBytes();
+    if (bytes.empty()) {
+      return none;
+    }
+    // memchr() is vectorized by the C library.
+    if (auto p = std::memchr(bytes.data(), byte, bytes.size())) {
+      return offset + (static_cast<const uint8_t*>(p) - bytes.data());
+    }
+    offset += bytes.size();
+    cursor.skip(bytes.size());
+  }
+}
+
+template <class Derived, class BufType>
+Optional<size_t> CursorBase<Derived, BufType>::findSequence(
+    ByteRange needle) const {
+  if (needle.empty()) {
+    return size_t(0);
+  }
+  Cursor cursor(*this);
+  size_t offset = 0;
+  while (true) {
+    auto bytes = cursor.peekBytes();
+    if (bytes.empty()) {
+      return none;
+    }
+    auto pos = qfind(bytes, needle);
+    if (pos != std::string::npos) {
+      return offset + pos;
+    }
+
+    // Check the matches that start in the last needle.size() - 1 bytes and
+    // continue into the next IOBufs.
+    size_t i = bytes.size() >= needle.size() ? bytes.size() - needle.size() + 1
+                                             : 0;
+    while (i < bytes.size()) {
+      auto p = std::memchr(bytes.data() + i, needle[0], bytes.size() - i);
+      if (!p) {
+        break;
+      }
+      i = static_cast<const uint8_t*>(p) - bytes.data();
+      Cursor candidate(cursor);
+      candidate.skip(i);
+      if (detail::cursorStartsWith(candidate, needle)) {
+        return offset + i;
+      }
+      ++i;
+    }
+
+    offset += bytes.size();
+    cursor.skip(bytes.size());
+  }
+}
+
 } // namespace io
 } // namespace folly
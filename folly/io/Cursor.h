@@ -26,6 +26,7 @@
 
 #include <folly/Likely.h>
 #include <folly/Memory.h>
+#include <folly/Optional.h>
 #include <folly/Portability.h>
 #include <folly/Range.h>
 #include <folly/io/IOBuf.h>
@@ -522,6 +523,32 @@ class CursorBase {
   template <typename Predicate>
   void skipWhile(const Predicate& predicate);
 
+  /**
+   * Find the first occurrence of a byte, without advancing the cursor.
+   *
+   * @methodset Accessors
+   *
+   * Returns the offset of the byte from the cursor position, or none if it
+   * isn't found before the end of the IOBuf chain.
+   */
+  Optional<size_t> findByte(uint8_t byte) const;
+
+  /**
+   * Find the first occurrence of a sequence of bytes, such as a delimiter,
+   * without advancing the cursor or copying the data.
+   *
+   * @methodset Accessors
+   *
+   * Returns the offset of the sequence from the cursor position, or none if
+   * it isn't found before the end of the IOBuf chain. The sequence may span
+   * several IOBufs. An empty sequence is found at offset 0.
+   */
+  Optional<size_t> findSequence(ByteRange needle) const;
+
+  Optional<size_t> findSequence(StringPiece needle) const {
+    return findSequence(ByteRange(needle));
+  }
+
   /**
    * Advance the cursor by at most len bytes.
    *
@@ -1266,6 +1266,33 @@ void IOBuf::initExtBuffer(
   *infoReturn = sharedInfo;
 }
 
+unique_ptr<IOBuf> IOBuf::fromString(fbstring&& str) {
+  auto const size = str.size();
+  size_t offset;
+  size_t allocatedSize;
+  if (auto block = str.releaseMallocatedBlock(&offset, &allocatedSize)) {
+    return takeOwnership(block, allocatedSize, offset, size);
+  }
+  return copyBuffer(str.data(), size);
+}
+
+unique_ptr<IOBuf> IOBuf::fromString(std::string&& str) {
+  auto const data = reinterpret_cast<uintptr_t>(str.data());
+  auto const self = reinterpret_cast<uintptr_t>(&str);
+  if (data >= self && data < self + sizeof(str)) {
+    // Stored inline, so moving it would copy anyway
+    return copyBuffer(str.data(), str.size());
+  }
+  auto owned = new std::string(std::move(str));
+  return takeOwnership(
+      &(*owned)[0],
+      owned->capacity(),
+      0,
+      owned->size(),
+      [](void*, void* userData) { delete static_cast<std::string*>(userData); },
+      owned);
+}
+
 fbstring IOBuf::moveToFbString() {
   // we need to save useHeapFullStorage and the observerListHead since
   // sharedInfo() may not be valid after fbstring str
@@ -737,6 +737,23 @@ class IOBuf {
   static std::unique_ptr<IOBuf> maybeCopyBuffer(
       StringPiece buf, std::size_t headroom = 0, std::size_t minTailroom = 0);
 
+  /**
+   * Create an IOBuf that takes over the heap buffer of a string, without
+   * copying the bytes.
+   *
+   * An fbstring gives up its malloc()-ed block, unless it is small or
+   * shared, in which case its bytes are copied. A std::string is moved into
+   * a heap allocation which the IOBuf keeps until it frees the buffer;
+   * strings short enough to be stored inline are copied instead.
+   *
+   * The reverse conversion is moveToFbString().
+   *
+   * @methodset Makers
+   */
+  static std::unique_ptr<IOBuf> fromString(fbstring&& str);
+  /// @copydoc fromString(fbstring&&)
+  static std::unique_ptr<IOBuf> fromString(std::string&& str);
+
   /**
    * Free an IOBuf.
    *
@@ -1912,7 +1929,11 @@ class IOBuf {
    *
    * Destructively convert this IOBuf to a fbstring efficiently.
    * We rely on fbstring's AcquireMallocatedString constructor to
-   * transfer memory.
+   * transfer memory. The bytes are copied only if this IOBuf does not own
+   * its malloc()-ed buffer outright, is chained, or leaves no room for the
+   * terminator.
+   *
+   * The reverse conversion is fromString().
    *
    * @methodset Conversions
    */
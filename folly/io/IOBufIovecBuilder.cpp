@@ -15,6 +15,9 @@
  */
 
 #include <folly/io/IOBufIovecBuilder.h>
+
+#include <cstring>
+
 #include <folly/portability/IOVec.h>
 
 namespace folly {
@@ -76,4 +79,66 @@ std::unique_ptr<folly::IOBuf> IOBufIovecBuilder::extractIOBufChain(size_t len) {
 
   return ioBuf;
 }
+
+GatherToIovecsResult gatherToIovecs(
+    const IOBuf& buf,
+    IOBufIovecBuilder::IoVecVec& iovs,
+    size_t maxIovecs,
+    size_t mergeThreshold) {
+  iovs.clear();
+  GatherToIovecsResult result;
+
+  // Each entry is a single buffer, or a run of small ones to merge.
+  struct Entry {
+    const IOBuf* first;
+    size_t count;
+    size_t length;
+    bool small;
+  };
+  std::vector<Entry> entries;
+  size_t mergedLength = 0;
+  const IOBuf* cur = &buf;
+  do {
+    size_t const len = cur->length();
+    if (len > 0) {
+      bool const small = len < mergeThreshold;
+      if (small && !entries.empty() && entries.back().small) {
+        auto& run = entries.back();
+        mergedLength += run.count == 1 ? run.length + len : len;
+        ++run.count;
+        run.length += len;
+      } else if (entries.size() < maxIovecs) {
+        entries.push_back({cur, 1, len, small});
+      } else {
+        break;
+      }
+      result.length += len;
+    }
+    cur = cur->next();
+  } while (cur != &buf);
+
+  if (mergedLength > 0) {
+    result.merged = IOBuf::create(mergedLength);
+  }
+  iovs.reserve(entries.size());
+  for (auto const& entry : entries) {
+    struct iovec iov;
+    if (entry.count == 1) {
+      iov.iov_base = const_cast<uint8_t*>(entry.first->data());
+    } else {
+      iov.iov_base = result.merged->writableTail();
+      const IOBuf* part = entry.first;
+      for (size_t i = 0; i < entry.count; part = part->next()) {
+        if (part->length() > 0) {
+          memcpy(result.merged->writableTail(), part->data(), part->length());
+          result.merged->append(part->length());
+          ++i;
+        }
+      }
+    }
+    iov.iov_len = entry.length;
+    iovs.push_back(iov);
+  }
+  return result;
+}
 } // namespace folly
@@ -17,8 +17,12 @@
 #pragma once
 
 #include <deque>
+#include <memory>
+#include <vector>
+
 #include <folly/io/IOBuf.h>
 #include <folly/memory/Malloc.h>
+#include <folly/portability/IOVec.h>
 
 namespace folly {
 /**
@@ -163,4 +167,32 @@ class IOBufIovecBuilder {
   Options options_;
   std::deque<RefCountMem*> buffers_;
 };
+
+struct GatherToIovecsResult {
+  // Number of bytes of the chain that the iovecs cover
+  size_t length{0};
+  // Copy of the merged buffers, which the iovecs point into
+  std::unique_ptr<IOBuf> merged;
+};
+
+constexpr size_t kDefaultGatherMergeThreshold = 512;
+
+/**
+ * The gathering counterpart of IOBufIovecBuilder: fill iovs with the data of
+ * the chain starting at buf, for writev(), sendmsg() and such, using at most
+ * maxIovecs entries.
+ *
+ * Buffers are pointed to in place, except for runs of two or more adjacent
+ * buffers shorter than mergeThreshold, which are copied together to take a
+ * single entry. The copies are made into one allocation, which the result
+ * holds and which must be kept until the iovecs are no longer used.
+ *
+ * If the chain needs more than maxIovecs entries even so, the iovecs cover
+ * only a prefix of it, of the returned length, as for a partial write.
+ */
+GatherToIovecsResult gatherToIovecs(
+    const IOBuf& buf,
+    IOBufIovecBuilder::IoVecVec& iovs,
+    size_t maxIovecs = IOV_MAX,
+    size_t mergeThreshold = kDefaultGatherMergeThreshold);
 } // namespace folly
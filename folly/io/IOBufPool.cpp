@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/IOBufPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <folly/AtomicIntrusiveLinkedList.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+
+struct IOBufPool::Block {
+  AtomicIntrusiveLinkedListHook<Block> hook;
+  ThreadCache* cache{nullptr};
+  std::size_t sizeClass{0};
+  void* data{nullptr};
+};
+
+/**
+ * The free buffers of one thread. Only the owning thread allocates from the
+ * cache, while any thread may return buffers to it.
+ *
+ * The cache is reference counted: the owning thread holds one reference,
+ * and each buffer handed out holds another, so that the cache outlives both.
+ */
+class IOBufPool::ThreadCache {
+ public:
+  ThreadCache(std::size_t numClasses, std::size_t maxCached)
+      : freeLists_(numClasses), maxCached_(maxCached) {}
+
+  ThreadCache(const ThreadCache&) = delete;
+  ThreadCache& operator=(const ThreadCache&) = delete;
+
+  Block* get(std::size_t sizeClass, std::size_t size) {
+    auto& freeList = freeLists_[sizeClass];
+    if (freeList.empty()) {
+      reclaim();
+    }
+
+    Block* block;
+    if (!freeList.empty()) {
+      block = freeList.back();
+      freeList.pop_back();
+    } else {
+      block = new Block();
+      block->data = std::malloc(size);
+      if (!block->data) {
+        delete block;
+        throw_exception<std::bad_alloc>();
+      }
+      block->cache = this;
+      block->sizeClass = sizeClass;
+    }
+    refs_.fetch_add(1, std::memory_order_relaxed);
+    return block;
+  }
+
+  // The IOBuf free function of the pooled buffers.
+  static void release(void* /* buf */, void* userData) {
+    auto block = static_cast<Block*>(userData);
+    auto cache = block->cache;
+    cache->returned_.insertHead(block);
+    cache->unref();
+  }
+
+  // Called by the owning thread once it is done with the cache.
+  void retire() {
+    reclaim();
+    for (auto& freeList : freeLists_) {
+      for (auto block : freeList) {
+        destroy(block);
+      }
+      freeList.clear();
+    }
+    unref();
+  }
+
+ private:
+  ~ThreadCache() {
+    returned_.sweep([](Block* block) { destroy(block); });
+  }
+
+  // Move the returned buffers over to the free lists.
+  void reclaim() {
+    returned_.sweep([&](Block* block) {
+      auto& freeList = freeLists_[block->sizeClass];
+      if (freeList.size() < maxCached_) {
+        freeList.push_back(block);
+      } else {
+        destroy(block);
+      }
+    });
+  }
+
+  void unref() {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  static void destroy(Block* block) {
+    std::free(block->data);
+    delete block;
+  }
+
+  std::vector<std::vector<Block*>> freeLists_;
+  const std::size_t maxCached_;
+  std::atomic<std::size_t> refs_{1};
+  AtomicIntrusiveLinkedList<Block, &Block::hook> returned_;
+};
+
+struct IOBufPool::CacheRef {
+  explicit CacheRef(ThreadCache* c) : cache(c) {}
+  ~CacheRef() { cache->retire(); }
+
+  ThreadCache* cache;
+};
+
+IOBufPool::IOBufPool(const Options& options)
+    : options_(options),
+      numClasses_(
+          findLastSet(options.maxSize) - findLastSet(options.minSize) + 1),
+      cache_([this] {
+        return new CacheRef(
+            new ThreadCache(numClasses_, options_.maxCachedPerClass));
+      }) {
+  CHECK(isPowTwo(options_.minSize)) << "minSize must be a power of two";
+  CHECK(isPowTwo(options_.maxSize)) << "maxSize must be a power of two";
+  CHECK_GE(options_.maxSize, options_.minSize);
+}
+
+// Destroys the caches of all threads; the buffers still in use keep theirs
+// alive until they are freed.
+IOBufPool::~IOBufPool() = default;
+
+std::unique_ptr<IOBuf> IOBufPool::create(std::size_t capacity) {
+  if (capacity > options_.maxSize) {
+    return IOBuf::create(capacity);
+  }
+
+  std::size_t size = nextPowTwo(std::max(capacity, options_.minSize));
+  std::size_t sizeClass = findLastSet(size) - findLastSet(options_.minSize);
+  auto block = cache_->cache->get(sizeClass, size);
+  return IOBuf::takeOwnership(
+      block->data, size, std::size_t(0), &ThreadCache::release, block);
+}
+
+} // namespace folly
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <folly/ThreadLocal.h>
+#include <folly/io/IOBuf.h>
+
+namespace folly {
+
+/**
+ * IOBufPool recycles the data buffers of IOBufs, taking malloc() off the
+ * path of applications that create many buffers of similar sizes.
+ *
+ * Buffer capacities are rounded up to power-of-two size classes, from
+ * minSize to maxSize; larger requests fall back to IOBuf::create(). Each
+ * thread allocates from its own cache of free buffers per size class. When
+ * the last IOBuf referring to a buffer is destroyed, on any thread, the
+ * buffer is pushed onto a lock-free return list of the cache it came from,
+ * which the owning thread takes back in bulk once its cache runs empty.
+ *
+ * Only the data buffer is pooled: the IOBuf itself, with its SharedInfo,
+ * is allocated as by IOBuf::takeOwnership().
+ *
+ * Buffers may outlive the pool and the threads that allocated them.
+ *
+ * Usage:
+ *
+ *        IOBufPool pool;
+ *        auto buf = pool.create(16 * 1024);
+ */
+class IOBufPool {
+ public:
+  struct Options {
+    Options() : minSize(4096), maxSize(64 * 1024), maxCachedPerClass(64) {}
+    /// Smallest size class; must be a power of two
+    std::size_t minSize;
+    /// Largest size class; must be a power of two, and at least minSize
+    std::size_t maxSize;
+    /// Free buffers each thread keeps per size class, beyond which they are
+    /// returned to malloc()
+    std::size_t maxCachedPerClass;
+  };
+
+  explicit IOBufPool(const Options& options = Options());
+  ~IOBufPool();
+
+  IOBufPool(const IOBufPool&) = delete;
+  IOBufPool& operator=(const IOBufPool&) = delete;
+
+  /**
+   * Create an empty IOBuf with at least `capacity` bytes of tailroom.
+   *
+   * Throws std::bad_alloc on error.
+   */
+  std::unique_ptr<IOBuf> create(std::size_t capacity);
+
+  const Options& getOptions() const { return options_; }
+
+ private:
+  struct Block;
+  class ThreadCache;
+  struct CacheRef;
+
+  const Options options_;
+  const std::size_t numClasses_;
+  ThreadLocal<CacheRef> cache_;
+};
+
+} // namespace folly
@@ -19,6 +19,8 @@
 #include <cstring>
 #include <stdexcept>
 
+#include <folly/io/IOBufPool.h>
+
 using std::make_pair;
 using std::pair;
 using std::unique_ptr;
@@ -150,6 +152,10 @@ void IOBufQueue::append(
   if (!buf) {
     return;
   }
+  if (options_.packThreshold != 0) {
+    appendPacked(std::move(buf));
+    return;
+  }
   auto guard = updateGuard();
   if (options_.cacheChainLength) {
     chainLength_ += buf->computeChainDataLength();
@@ -162,6 +168,10 @@ void IOBufQueue::append(
 
 void IOBufQueue::append(
     const folly::IOBuf& buf, bool pack, bool allowTailReuse) {
+  if (options_.packThreshold != 0) {
+    appendPacked(buf);
+    return;
+  }
   if (!head_ || !pack) {
     append(buf.clone(), pack);
     return;
@@ -198,6 +208,11 @@ void IOBufQueue::append(IOBufQueue& other, bool pack, bool allowTailReuse) {
   }
   // We're going to chain other, thus we need to grab both guards.
   auto otherGuard = other.updateGuard();
+  if (options_.packThreshold != 0) {
+    appendPacked(std::move(other.head_));
+    other.chainLength_ = 0;
+    return;
+  }
   auto guard = updateGuard();
   if (options_.cacheChainLength) {
     if (other.options_.cacheChainLength) {
@@ -215,6 +230,40 @@ void IOBufQueue::append(IOBufQueue& other, bool pack, bool allowTailReuse) {
 
 void IOBufQueue::append(const void* buf, size_t len) {
   auto guard = updateGuard();
+  appendCopy(buf, len);
+}
+
+void IOBufQueue::appendPacked(unique_ptr<IOBuf>&& buf) {
+  auto guard = updateGuard();
+  while (buf) {
+    auto next = buf->pop();
+    if (buf->length() < options_.packThreshold) {
+      appendCopy(buf->data(), buf->length());
+    } else {
+      chainLength_ += buf->length();
+      appendToChain(head_, std::move(buf), false);
+    }
+    buf = std::move(next);
+  }
+}
+
+void IOBufQueue::appendPacked(const folly::IOBuf& buf) {
+  auto guard = updateGuard();
+  for (const IOBuf* cur = &buf;;) {
+    if (cur->length() < options_.packThreshold) {
+      appendCopy(cur->data(), cur->length());
+    } else {
+      chainLength_ += cur->length();
+      appendToChain(head_, cur->cloneOne(), false);
+    }
+    cur = cur->next();
+    if (cur == &buf) {
+      break;
+    }
+  }
+}
+
+void IOBufQueue::appendCopy(const void* buf, size_t len) {
   auto src = static_cast<const uint8_t*>(buf);
   while (len != 0) {
     if ((head_ == nullptr) || head_->prev()->isSharedOne() ||
@@ -251,7 +300,10 @@ pair<void*, std::size_t> IOBufQueue::preallocateSlow(
   // Avoid grabbing update guard, since we're manually setting the cache ptrs.
   flushCache();
   // Allocate a new buffer of the requested max size.
-  unique_ptr<IOBuf> newBuf(IOBuf::create(std::max(min, newAllocationSize)));
+  auto capacity = std::max(min, newAllocationSize);
+  unique_ptr<IOBuf> newBuf(
+      options_.pool ? options_.pool->create(capacity)
+                    : IOBuf::create(capacity));
 
   tailStart_ = newBuf->writableTail();
   cachePtr_->cachedRange = std::pair<uint8_t*, uint8_t*>(
@@ -24,6 +24,8 @@
 
 namespace folly {
 
+class IOBufPool;
+
 namespace io {
 enum class CursorAccess;
 template <CursorAccess>
@@ -81,16 +83,23 @@ class IOBufQueue {
 
  public:
   struct Options {
-    Options() : cacheChainLength(false) {}
+    Options() : cacheChainLength(false), pool(nullptr), packThreshold(0) {}
     bool cacheChainLength;
+    // If set, preallocate() takes its new buffers from this pool, which must
+    // outlive the queue.
+    IOBufPool* pool;
+    // If non-zero, append() of IOBufs and queues copies the buffers shorter
+    // than this into the tailroom of the queue, or into new buffers, and
+    // only links the longer ones, which keeps the chain short when appending
+    // many small buffers.
+    std::size_t packThreshold;
   };
 
   /**
    * Get Options with cacheChainLength=true.
    * @methodset Configuration
    *
-   * Commonly used Options, currently the only possible value other than
-   * the default.
+   * Commonly used Options.
    */
   static Options cacheChainLength() {
     Options options;
@@ -306,7 +315,8 @@ class IOBufQueue {
    * If pack is true, we try to reduce wastage at the end of this queue
    * by copying some data from the first buffers in the buf chain (and
    * releasing the buffers), if possible.  If pack is false, we leave
-   * the chain topology unchanged.
+   * the chain topology unchanged, unless Options::packThreshold is set, in
+   * which case all buffers of the chain shorter than it are copied.
    *
    * If allowTailReuse is true, the current writable tail is reappended at the
    * end of the chain when possible and beneficial.
@@ -619,6 +629,12 @@ class IOBufQueue {
   static constexpr size_t kMaxPackCopy = 4096;
 
  private:
+  // Appends the chain under Options::packThreshold.
+  void appendPacked(std::unique_ptr<folly::IOBuf>&& buf);
+  void appendPacked(const folly::IOBuf& buf);
+  // Copies to the end of the queue; the caller holds the update guard.
+  void appendCopy(const void* buf, size_t len);
+
   std::unique_ptr<folly::IOBuf> split(size_t n, bool throwOnUnderflow);
 
   static const size_t kChainLengthNotCached = (size_t)-1;
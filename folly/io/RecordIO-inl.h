@@ -95,6 +95,17 @@ static_assert(
     offsetof(Header, headerHash) + sizeof(Header::headerHash) == sizeof(Header),
     "invalid header layout");
 
+// Index files consist of an IndexHeader followed by the uint64_t position of
+// every interval-th record.
+FOLLY_PACK_PUSH
+struct IndexHeader {
+  static constexpr uint32_t kMagic = 0xeac313a2;
+  uint32_t magic;
+  uint32_t version; // backwards incompatible version, currently 0
+  uint64_t interval;
+} FOLLY_PACK_ATTR;
+FOLLY_PACK_POP
+
 } // namespace recordio_detail
 
 constexpr size_t headerSize() {
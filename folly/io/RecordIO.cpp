@@ -18,13 +18,18 @@
 
 #include <sys/types.h>
 
+#include <exception>
+
 #include <folly/Exception.h>
+#include <folly/Executor.h>
 #include <folly/FileUtil.h>
 #include <folly/Memory.h>
+#include <folly/Optional.h>
 #include <folly/Portability.h>
 #include <folly/ScopeGuard.h>
 #include <folly/String.h>
 #include <folly/portability/Unistd.h>
+#include <folly/synchronization/Baton.h>
 
 namespace folly {
 
@@ -45,6 +50,106 @@ RecordIOWriter::RecordIOWriter(File file, uint32_t fileId)
   filePos_ = st.st_size;
 }
 
+RecordIOWriter::RecordIOWriter(
+    File file, uint32_t fileId, File indexFile, size_t indexInterval)
+    : RecordIOWriter(std::move(file), fileId) {
+  if (indexInterval == 0) {
+    throw std::invalid_argument("RecordIOWriter: invalid index interval");
+  }
+  indexFile_ = std::move(indexFile);
+  indexInterval_ = indexInterval;
+  loadIndex();
+}
+
+void RecordIOWriter::loadIndex() {
+  using recordio_detail::IndexHeader;
+
+  struct stat st;
+  checkUnixError(fstat(indexFile_.fd(), &st), "fstat() failed");
+
+  std::vector<uint64_t> offsets;
+  if (size_t(st.st_size) >= sizeof(IndexHeader)) {
+    IndexHeader header;
+    checkUnixError(
+        preadFull(indexFile_.fd(), &header, sizeof(header), 0),
+        "pread() failed");
+    if (header.magic != IndexHeader::kMagic || header.version != 0 ||
+        header.interval == 0) {
+      throw std::runtime_error("RecordIOWriter: invalid index file");
+    }
+    indexInterval_ = size_t(header.interval);
+    offsets.resize((size_t(st.st_size) - sizeof(header)) / sizeof(uint64_t));
+    checkUnixError(
+        preadFull(
+            indexFile_.fd(),
+            offsets.data(),
+            offsets.size() * sizeof(uint64_t),
+            sizeof(header)),
+        "pread() failed");
+  }
+
+  // Bring the index up to date with the records in the file.
+  Optional<MemoryMapping> map;
+  if (filePos_ > 0) {
+    map.emplace(File(file_.fd()));
+  }
+  ByteRange data = map ? map->range() : ByteRange();
+  while (!offsets.empty() &&
+         (offsets.back() >= data.size() ||
+          validateRecord(data.subpiece(offsets.back()), fileId_)
+              .record.empty())) {
+    offsets.pop_back();
+  }
+  size_t count = offsets.empty() ? 0 : (offsets.size() - 1) * indexInterval_;
+  ByteRange rest = data.subpiece(offsets.empty() ? 0 : offsets.back());
+  while (!rest.empty()) {
+    auto record = findRecord(rest, data, fileId_).record;
+    if (record.empty()) {
+      break;
+    }
+    auto pos = uint64_t(record.begin() - data.begin()) - headerSize();
+    if (count % indexInterval_ == 0 &&
+        count / indexInterval_ == offsets.size()) {
+      offsets.push_back(pos);
+    }
+    ++count;
+    rest = ByteRange(record.end(), data.end());
+  }
+
+  IndexHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = IndexHeader::kMagic;
+  header.interval = indexInterval_;
+  checkUnixError(
+      pwriteFull(indexFile_.fd(), &header, sizeof(header), 0),
+      "pwrite() failed");
+  checkUnixError(
+      pwriteFull(
+          indexFile_.fd(),
+          offsets.data(),
+          offsets.size() * sizeof(uint64_t),
+          sizeof(header)),
+      "pwrite() failed");
+  checkUnixError(
+      ftruncate(
+          indexFile_.fd(),
+          off_t(sizeof(header) + offsets.size() * sizeof(uint64_t))),
+      "ftruncate() failed");
+
+  numRecords_ = count;
+  numIndexEntries_ = offsets.size();
+}
+
+void RecordIOWriter::writeIndexEntry(size_t entry, off_t pos) {
+  auto offset = uint64_t(pos);
+  ssize_t bytes = pwriteFull(
+      indexFile_.fd(),
+      &offset,
+      sizeof(offset),
+      off_t(sizeof(recordio_detail::IndexHeader) + entry * sizeof(offset)));
+  checkUnixError(bytes, "pwrite() failed");
+}
+
 void RecordIOWriter::write(std::unique_ptr<IOBuf> buf) {
   size_t totalLength = prependHeader(buf, fileId_);
   if (totalLength == 0) {
@@ -54,7 +159,16 @@ void RecordIOWriter::write(std::unique_ptr<IOBuf> buf) {
   DCHECK_EQ(buf->computeChainDataLength(), totalLength);
 
   // We're going to write.  Reserve space for ourselves.
-  off_t pos = filePos_.fetch_add(off_t(totalLength));
+  off_t pos;
+  if (indexInterval_ == 0) {
+    pos = filePos_.fetch_add(off_t(totalLength));
+  } else {
+    std::lock_guard<std::mutex> lock(indexMutex_);
+    pos = filePos_.fetch_add(off_t(totalLength));
+    if (numRecords_++ % indexInterval_ == 0) {
+      writeIndexEntry(numIndexEntries_++, pos);
+    }
+  }
 
 #if FOLLY_HAVE_PWRITEV
   auto iov = buf->getIov();
@@ -69,9 +183,117 @@ void RecordIOWriter::write(std::unique_ptr<IOBuf> buf) {
   DCHECK_EQ(size_t(bytes), totalLength);
 }
 
+RecordIOIndex::RecordIOIndex(File indexFile) {
+  using recordio_detail::IndexHeader;
+
+  struct stat st;
+  checkUnixError(fstat(indexFile.fd(), &st), "fstat() failed");
+  IndexHeader header;
+  if (size_t(st.st_size) < sizeof(header) ||
+      preadFull(indexFile.fd(), &header, sizeof(header), 0) !=
+          ssize_t(sizeof(header)) ||
+      header.magic != IndexHeader::kMagic || header.version != 0 ||
+      header.interval == 0) {
+    throw std::runtime_error("RecordIOIndex: invalid index file");
+  }
+  interval_ = size_t(header.interval);
+  offsets_.resize((size_t(st.st_size) - sizeof(header)) / sizeof(uint64_t));
+  checkUnixError(
+      preadFull(
+          indexFile.fd(),
+          offsets_.data(),
+          offsets_.size() * sizeof(uint64_t),
+          sizeof(header)),
+      "pread() failed");
+}
+
 RecordIOReader::RecordIOReader(File file, uint32_t fileId)
     : map_(std::move(file)), fileId_(fileId) {}
 
+auto RecordIOReader::seekToRecord(size_t n, const RecordIOIndex& index) const
+    -> Iterator {
+  auto it = begin();
+  if (index.size() > 0) {
+    size_t entry = std::min(n / index.interval(), index.size() - 1);
+    it = seek(index.offset(entry));
+    n -= entry * index.interval();
+  }
+  for (; n > 0 && it != end(); --n) {
+    ++it;
+  }
+  return it;
+}
+
+void RecordIOReader::forEachParallel(
+    Executor& executor,
+    const RecordIOIndex& index,
+    FunctionRef<void(ByteRange, off_t)> fn) const {
+  // Bounds the records found ahead of fn.
+  constexpr size_t kMaxPartsInFlight = 64;
+
+  auto range = map_.range();
+  std::vector<off_t> starts{0};
+  for (size_t i = 1; i < index.size(); ++i) {
+    auto offset = index.offset(i);
+    if (size_t(offset) >= range.size()) {
+      break;
+    }
+    if (offset > starts.back()) {
+      starts.push_back(offset);
+    }
+  }
+
+  struct Part {
+    std::vector<std::pair<ByteRange, off_t>> records;
+    std::exception_ptr error;
+    Baton<> done;
+  };
+  std::vector<Part> parts(starts.size());
+  size_t submitted = 0;
+  // The parts reference this frame, so wait for all of them on the way out.
+  SCOPE_EXIT {
+    for (size_t i = 0; i < submitted; ++i) {
+      parts[i].done.wait();
+    }
+  };
+  auto submit = [&] {
+    size_t i = submitted;
+    off_t partEnd =
+        i + 1 < starts.size() ? starts[i + 1] : off_t(range.size());
+    executor.add([&, i, partEnd] {
+      auto& part = parts[i];
+      try {
+        for (Iterator it(range, fileId_, starts[i]);
+             (*it).second != off_t(-1) && (*it).second < partEnd;
+             ++it) {
+          part.records.push_back(*it);
+        }
+      } catch (...) {
+        part.error = std::current_exception();
+      }
+      part.done.post();
+    });
+    ++submitted;
+  };
+
+  while (submitted < std::min(parts.size(), kMaxPartsInFlight)) {
+    submit();
+  }
+  for (auto& part : parts) {
+    part.done.wait();
+    if (part.error) {
+      std::rethrow_exception(part.error);
+    }
+    for (auto& record : part.records) {
+      fn(record.first, record.second);
+    }
+    std::vector<std::pair<ByteRange, off_t>>().swap(part.records);
+    if (submitted < parts.size()) {
+      submit();
+    }
+  }
+}
+
 RecordIOReader::Iterator::Iterator(ByteRange range, uint32_t fileId, off_t pos)
     : range_(range), fileId_(fileId), recordAndPos_(ByteRange(), 0) {
   if (size_t(pos) >= range_.size()) {
@@ -29,14 +29,18 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <folly/File.h>
+#include <folly/Function.h>
 #include <folly/Range.h>
 #include <folly/io/IOBuf.h>
 #include <folly/system/MemoryMapping.h>
 
 namespace folly {
 
+class Executor;
+
 /**
  * Class to write a stream of RecordIO records to a file.
  *
@@ -59,6 +63,24 @@ class RecordIOWriter {
    */
   explicit RecordIOWriter(File file, uint32_t fileId = 1);
 
+  static constexpr size_t kDefaultIndexInterval = 1024;
+
+  /**
+   * Create a RecordIOWriter that also maintains an index of the file in
+   * indexFile: the position of every indexInterval-th record with this
+   * writer's file id, which RecordIOIndex loads for readers.
+   *
+   * If the index file isn't empty, its own interval is kept, and it is
+   * brought up to date with the records already in the file: entries that
+   * don't point to a valid record are dropped, and the records past the
+   * last entry are indexed. This requires the file to be open for reading.
+   */
+  RecordIOWriter(
+      File file,
+      uint32_t fileId,
+      File indexFile,
+      size_t indexInterval = kDefaultIndexInterval);
+
   /**
    * Write a record.  We will use at most headerSize() bytes of headroom,
    * you might want to arrange that before copying your data into it.
@@ -72,10 +94,49 @@ class RecordIOWriter {
   off_t filePos() const { return filePos_; }
 
  private:
+  void loadIndex();
+  void writeIndexEntry(size_t entry, off_t pos);
+
   File file_;
   uint32_t fileId_;
   std::unique_lock<File> writeLock_;
   std::atomic<off_t> filePos_;
+
+  // Only used with an index; the mutex orders the records' positions along
+  // with their numbers.
+  File indexFile_;
+  size_t indexInterval_{0};
+  std::mutex indexMutex_;
+  size_t numRecords_{0};
+  size_t numIndexEntries_{0};
+};
+
+/**
+ * Index of a RecordIO file, as written by RecordIOWriter: the position of
+ * every interval()-th record.
+ */
+class RecordIOIndex {
+ public:
+  /**
+   * Load an index file. Throws std::runtime_error if it isn't a valid index.
+   */
+  explicit RecordIOIndex(File indexFile);
+
+  size_t interval() const { return interval_; }
+
+  /**
+   * Number of entries.
+   */
+  size_t size() const { return offsets_.size(); }
+
+  /**
+   * Position in the file of record number i * interval().
+   */
+  off_t offset(size_t i) const { return off_t(offsets_[i]); }
+
+ private:
+  size_t interval_{0};
+  std::vector<uint64_t> offsets_;
 };
 
 /**
@@ -114,6 +175,25 @@ class RecordIOReader {
    */
   Iterator seek(off_t pos) const;
 
+  /**
+   * Create an iterator to the n-th valid record, counting from 0, using the
+   * index to skip ahead. The index counts the records of the file id it was
+   * written with, which should be the file id of the reader.
+   */
+  Iterator seekToRecord(size_t n, const RecordIOIndex& index) const;
+
+  /**
+   * Call fn with every record and its position, in order, as iterating over
+   * the reader would. The file is split at the index entries, and the parts
+   * are searched for records and their checksums validated in parallel on
+   * the executor, while fn is called on the calling thread. Blocks until
+   * done, and rethrows the first exception from fn or from the parts.
+   */
+  void forEachParallel(
+      Executor& executor,
+      const RecordIOIndex& index,
+      FunctionRef<void(ByteRange, off_t)> fn) const;
+
  private:
   MemoryMapping map_;
   uint32_t fileId_;
@@ -23,6 +23,7 @@
 #include <chrono>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include <folly/Format.h>
 #include <folly/Indestructible.h>
@@ -39,6 +40,15 @@
 #include <folly/ssl/SSLSession.h>
 #include <folly/ssl/SSLSessionManager.h>
 
+// Kernel TLS offload, through OpenSSL's own support for installing the record
+// keys on a socket BIO.
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS) && \
+    defined(__linux__)
+#define FOLLY_ASYNC_SSL_SOCKET_KTLS 1
+#else
+#define FOLLY_ASYNC_SSL_SOCKET_KTLS 0
+#endif
+
 using std::shared_ptr;
 
 using folly::SpinLock;
@@ -102,6 +112,57 @@ void* initsslBioMethod() {
   return nullptr;
 }
 
+#if FOLLY_ASYNC_SSL_SOCKET_KTLS
+// Once the kernel handles the records in one direction, OpenSSL relies on the
+// socket BIO's own read and write to pass their content types alongside, so
+// AsyncSSLSocket's overrides defer to them.
+BIO_METHOD* getSocketBioMethod() {
+  return const_cast<BIO_METHOD*>(BIO_s_socket());
+}
+
+// Attaches the kernel's TLS upper layer protocol to a connected TCP socket,
+// without which OpenSSL can't install the record keys on it. Failure is fine:
+// OpenSSL then keeps encrypting in userspace.
+void attachKtlsUlp(folly::NetworkSocket fd) {
+  static constexpr char kTlsUlp[] = "tls";
+  folly::netops::setsockopt(fd, IPPROTO_TCP, TCP_ULP, kTlsUlp, sizeof(kTlsUlp));
+}
+#endif
+
+// The outcome of an SSL_accept() that the accept runner ran on another thread:
+// errno and OpenSSL's error queue are thread local, and AsyncSSLSocket needs
+// both to tell a retry from a failure once it is back on its EventBase thread.
+class SSLAcceptErrorState {
+ public:
+  // Moves the calling thread's errno and OpenSSL errors into the state.
+  static SSLAcceptErrorState take() {
+    SSLAcceptErrorState state;
+    state.errno_ = errno;
+    while (auto err = ERR_get_error()) {
+      state.errors_.push_back(err);
+    }
+    return state;
+  }
+
+  // Replaces the calling thread's errno and OpenSSL errors with the state.
+  void restore() const {
+    ERR_clear_error();
+    for (auto err : errors_) {
+#if FOLLY_OPENSSL_PREREQ(3, 0, 0)
+      ERR_raise(ERR_GET_LIB(err), ERR_GET_REASON(err));
+#else
+      ERR_put_error(
+          ERR_GET_LIB(err), 0, ERR_GET_REASON(err), __FILE__, __LINE__);
+#endif
+    }
+    errno = errno_;
+  }
+
+ private:
+  int errno_{0};
+  std::vector<unsigned long> errors_;
+};
+
 } // namespace
 
 namespace folly {
@@ -353,8 +414,15 @@ void AsyncSSLSocket::init() {
 }
 
 void AsyncSSLSocket::closeNow() {
+  if (waitingOnAccept_) {
+    // The accept runner may still be inside SSL_accept(), possibly on another
+    // thread, using ssl_ and the fd; close once it has returned.
+    closeAfterAccept_ = true;
+    return;
+  }
+
   // Close the SSL connection.
-  if (ssl_ != nullptr && fd_ != NetworkSocket() && !waitingOnAccept_) {
+  if (ssl_ != nullptr && fd_ != NetworkSocket()) {
     int rc = SSL_shutdown(ssl_.get());
     if (rc == 0) {
       rc = SSL_shutdown(ssl_.get());
@@ -705,21 +773,29 @@ void AsyncSSLSocket::timeoutExpired(
         AsyncSocketException::TIMED_OUT,
         "Fallback connect timed out during TFO");
     failHandshake(__func__, *ex);
+  } else if (waitingOnAccept_) {
+    // Same as above for the accept runner, which may still be inside
+    // SSL_accept() on another thread: fail once it has returned.
+    acceptTimedOutAfter_ = timeout;
   } else {
     assert(
         state_ == StateEnum::ESTABLISHED &&
         (sslState_ == STATE_CONNECTING || sslState_ == STATE_ACCEPTING));
-    DestructorGuard dg(this);
-    AsyncSocketException ex(
-        AsyncSocketException::TIMED_OUT,
-        folly::sformat(
-            "SSL {} timed out after {}ms",
-            (sslState_ == STATE_CONNECTING) ? "connect" : "accept",
-            timeout.count()));
-    failHandshake(__func__, ex);
+    failHandshakeTimeout(timeout);
   }
 }
 
+void AsyncSSLSocket::failHandshakeTimeout(std::chrono::milliseconds timeout) {
+  DestructorGuard dg(this);
+  AsyncSocketException ex(
+      AsyncSocketException::TIMED_OUT,
+      folly::sformat(
+          "SSL {} timed out after {}ms",
+          (sslState_ == STATE_CONNECTING) ? "connect" : "accept",
+          timeout.count()));
+  failHandshake(__func__, ex);
+}
+
 int AsyncSSLSocket::getSSLExDataIndex() {
   static auto index = SSL_get_ex_new_index(
       0, (void*)"AsyncSSLSocket data index", nullptr, nullptr, nullptr);
@@ -870,9 +946,25 @@ bool AsyncSSLSocket::setupSSLBio() {
   OpenSSLUtils::setBioAppData(sslBio, this);
   OpenSSLUtils::setBioFd(sslBio, fd_, BIO_NOCLOSE);
   SSL_set_bio(ssl_.get(), sslBio, sslBio);
+#if FOLLY_ASYNC_SSL_SOCKET_KTLS
+  if (ktlsEnabled_) {
+    attachKtlsUlp(fd_);
+    SSL_set_options(ssl_.get(), SSL_OP_ENABLE_KTLS);
+  }
+#endif
   return true;
 }
 
+void AsyncSSLSocket::enableKtls() {
+  ktlsEnabled_ = true;
+}
+
+void AsyncSSLSocket::updateKtlsState() {
+#if FOLLY_ASYNC_SSL_SOCKET_KTLS
+  ktlsTx_ = ktlsEnabled_ && BIO_get_ktls_send(SSL_get_wbio(ssl_.get()));
+#endif
+}
+
 void AsyncSSLSocket::sslConn(
     HandshakeCB* callback,
     std::chrono::milliseconds timeout,
@@ -1272,17 +1364,41 @@ void AsyncSSLSocket::handleAccept() noexcept {
   updateEventRegistration(
       EventHandler::NONE, EventHandler::READ | EventHandler::WRITE);
   DelayedDestruction::DestructorGuard dg(this);
+  waitingOnAccept_ = true;
   ctx_->sslAcceptRunner()->run(
-      [this, dg]() {
-        waitingOnAccept_ = true;
-        return SSL_accept(ssl_.get());
-      },
-      [this, dg](int ret) {
-        waitingOnAccept_ = false;
-        handleReturnFromSSLAccept(ret);
+      [this, dg]() { return SSL_accept(ssl_.get()); },
+      [this, dg, evb = getKeepAliveToken(eventBase_)](int ret) mutable {
+        if (!evb->isInEventBaseThread()) {
+          // The runner offloaded SSL_accept() to another thread; carry its
+          // outcome back to the EventBase thread, which the keep-alive token
+          // kept looping meanwhile.
+          auto evbPtr = evb.get();
+          evbPtr->runInEventBaseThread(
+              [this,
+               dg,
+               evb = std::move(evb),
+               ret,
+               state = SSLAcceptErrorState::take()] {
+                state.restore();
+                finishSSLAccept(ret);
+              });
+          return;
+        }
+        finishSSLAccept(ret);
       });
 }
 
+void AsyncSSLSocket::finishSSLAccept(int ret) {
+  waitingOnAccept_ = false;
+  if (std::exchange(closeAfterAccept_, false)) {
+    return closeNow();
+  }
+  if (auto timeout = std::exchange(acceptTimedOutAfter_, folly::none)) {
+    return failHandshakeTimeout(*timeout);
+  }
+  handleReturnFromSSLAccept(ret);
+}
+
 const char* AsyncSSLSocket::getNegotiatedGroup() const {
 #if FOLLY_OPENSSL_PREREQ(1, 1, 1)
   auto nid = SSL_get_shared_group(const_cast<SSL*>(this->getSSL()), 0);
@@ -1318,6 +1434,7 @@ void AsyncSSLSocket::handleReturnFromSSLAccept(int ret) {
   // Move into STATE_ESTABLISHED in the normal case that we are in
   // STATE_ACCEPTING.
   sslState_ = STATE_ESTABLISHED;
+  updateKtlsState();
 
   VLOG(3) << "AsyncSSLSocket " << this << ": fd " << fd_
           << " successfully accepted; state=" << int(state_)
@@ -1395,6 +1512,7 @@ void AsyncSSLSocket::handleConnect() noexcept {
   // Move into STATE_ESTABLISHED in the normal case that we are in
   // STATE_CONNECTING.
   sslState_ = STATE_ESTABLISHED;
+  updateKtlsState();
 
   VLOG(3) << "AsyncSSLSocket " << this << ": " << "fd " << fd_
           << " successfully connected; " << "state=" << int(state_)
@@ -1711,7 +1829,8 @@ AsyncSocket::WriteResult AsyncSSLSocket::performWrite(
     uint32_t* countWritten,
     uint32_t* partialWritten,
     WriteRequestTag writeTag) {
-  if (sslState_ == STATE_UNENCRYPTED) {
+  // With kTLS the kernel frames and encrypts what is written to the socket.
+  if (sslState_ == STATE_UNENCRYPTED || ktlsTx_) {
     return AsyncSocket::performWrite(
         vec, count, flags, countWritten, partialWritten, std::move(writeTag));
   }
@@ -1925,6 +2044,19 @@ int AsyncSSLSocket::bioWrite(BIO* b, const char* in, int inl) {
   AsyncSSLSocket* sslSock = reinterpret_cast<AsyncSSLSocket*>(appData);
   CHECK(sslSock);
 
+#if FOLLY_ASYNC_SSL_SOCKET_KTLS
+  if (BIO_get_ktls_send(b)) {
+    // Only records OpenSSL sends itself, such as alerts and session tickets,
+    // get here; application data is written to the socket directly.
+    static const auto socketBioWrite = BIO_meth_get_write(getSocketBioMethod());
+    int ret = socketBioWrite(b, in, inl);
+    if (ret > 0) {
+      sslSock->rawBytesWritten_ += size_t(ret);
+    }
+    return ret;
+  }
+#endif
+
   // if EOR is tracked, correct if needed
   WriteFlags flags = sslSock->currWriteFlags_;
   if (sslSock->trackEor_ &&
@@ -1974,13 +2106,20 @@ int AsyncSSLSocket::bioRead(BIO* b, char* out, int outl) {
     queue.trimStart(len);
     sslSock->preReceivedData_ = queue.move();
     return static_cast<int>(len);
-  } else {
-    auto result = int(netops::recv(OpenSSLUtils::getBioFd(b), out, outl, 0));
-    if (result <= 0 && OpenSSLUtils::getBioShouldRetryWrite(result)) {
-      BIO_set_retry_read(b);
-    }
-    return result;
   }
+
+#if FOLLY_ASYNC_SSL_SOCKET_KTLS
+  if (BIO_get_ktls_recv(b)) {
+    static const auto socketBioRead = BIO_meth_get_read(getSocketBioMethod());
+    return socketBioRead(b, out, outl);
+  }
+#endif
+
+  auto result = int(netops::recv(OpenSSLUtils::getBioFd(b), out, outl, 0));
+  if (result <= 0 && OpenSSLUtils::getBioShouldRetryWrite(result)) {
+    BIO_set_retry_read(b);
+  }
+  return result;
 }
 
 int AsyncSSLSocket::sslVerifyCallback(
@@ -2047,6 +2186,12 @@ void AsyncSSLSocket::enableByteEvents() {
         withAddr("failed to enable byte events: "
                  "not supported for SSLv3 or TLSv1")));
   }
+  if (ktlsEnabled_) {
+    // The kernel rejects the timestamping control messages on kTLS sockets.
+    return failByteEvents(AsyncSocketException(
+        AsyncSocketException::NOT_SUPPORTED,
+        withAddr("failed to enable byte events: not supported with kTLS")));
+  }
   AsyncSocket::enableByteEvents();
 }
 
@@ -425,6 +425,26 @@ class AsyncSSLSocket : public AsyncSocket {
 
   void enableClientHelloParsing();
 
+  /**
+   * Offload TLS record encryption to the kernel (kTLS) once the handshake
+   * completes. Must be called before the handshake starts.
+   *
+   * OpenSSL installs the negotiated keys on the socket if the kernel supports
+   * kTLS and the cipher suite; otherwise the socket keeps encrypting records
+   * in userspace. Once the kernel encrypts, writes skip OpenSSL and go to the
+   * socket as they would without TLS, and getRawBytesWritten() no longer
+   * counts the record overhead. Reads still go through OpenSSL.
+   *
+   * ByteEvents can't be enabled on a socket with kTLS enabled.
+   */
+  void enableKtls();
+
+  /**
+   * Whether the kernel encrypts the records written to this socket; see
+   * enableKtls().
+   */
+  bool isKtlsTxActive() const { return ktlsTx_; }
+
   /**
    * Accept an SSL connection on the socket.
    *
@@ -887,6 +907,15 @@ class AsyncSSLSocket : public AsyncSocket {
    */
   void handleReturnFromSSLAccept(int ret);
 
+  /**
+   * Called on the EventBase thread once the accept runner has returned from
+   * SSL_accept: applies a close or handshake timeout that came in while it
+   * was running, and otherwise handles its return value.
+   */
+  void finishSSLAccept(int ret);
+
+  void failHandshakeTimeout(std::chrono::milliseconds timeout);
+
   void init();
 
   ReadResult performReadSingle(void* buf, const size_t buflen);
@@ -964,6 +993,9 @@ class AsyncSSLSocket : public AsyncSocket {
    */
   bool setupSSLBio();
 
+  // Records whether OpenSSL handed the outgoing records to the kernel.
+  void updateKtlsState();
+
   // Inherit error handling methods from AsyncSocket, plus the following.
   void failHandshake(const char* fn, const AsyncSocketException& ex);
 
@@ -1021,6 +1053,10 @@ class AsyncSSLSocket : public AsyncSocket {
   static int sslVerifyCallback(int preverifyOk, X509_STORE_CTX* ctx);
 
   bool parseClientHello_{false};
+  bool ktlsEnabled_{false};
+  // Whether the kernel encrypts outgoing records, set once the handshake
+  // completes.
+  bool ktlsTx_{false};
   bool cacheAddrOnFailure_{false};
   bool certCacheHit_{false};
   std::unique_ptr<ssl::ClientHelloInfo> clientHelloInfo_;
@@ -1043,6 +1079,10 @@ class AsyncSSLSocket : public AsyncSocket {
   std::unique_ptr<ReadCallback> asyncOperationFinishCallback_;
   // Whether this socket is currently waiting on SSL_accept
   bool waitingOnAccept_{false};
+  // Whether closeNow() was called while waiting on SSL_accept
+  bool closeAfterAccept_{false};
+  // Set if the handshake timed out while waiting on SSL_accept
+  folly::Optional<std::chrono::milliseconds> acceptTimedOutAfter_;
   // Manages the session for the socket
   folly::ssl::SSLSessionManager sslSessionManager_;
 };
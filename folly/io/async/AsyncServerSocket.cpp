@@ -28,6 +28,7 @@
 #include <folly/FileUtil.h>
 #include <folly/GLog.h>
 #include <folly/Portability.h>
+#include <folly/ScopeGuard.h>
 #include <folly/SocketAddress.h>
 #include <folly/String.h>
 #include <folly/detail/SocketFastOpen.h>
@@ -109,6 +110,18 @@ AtomicNotificationQueueTaskStatus AsyncServerSocket::ErrorMessage::operator()(
   return AtomicNotificationQueueTaskStatus::CONSUMED;
 }
 
+AtomicNotificationQueueTaskStatus
+AsyncServerSocket::NewConnBatchMessage::operator()(
+    RemoteAcceptor& acceptor) noexcept {
+  auto status = AtomicNotificationQueueTaskStatus::DISCARD;
+  for (auto& conn : conns) {
+    if (conn(acceptor) == AtomicNotificationQueueTaskStatus::CONSUMED) {
+      status = AtomicNotificationQueueTaskStatus::CONSUMED;
+    }
+  }
+  return status;
+}
+
 /*
  * AsyncServerSocket::BackoffTimeout
  */
@@ -203,6 +216,10 @@ int AsyncServerSocket::stopAccepting(int shutdownFlags) {
     }
   }
 
+  // Hand over the connections accepted in the current wakeup, if any, before
+  // the acceptors are stopped.
+  flushDispatchBatches();
+
   // Destroy the backoff timout.  This will cancel it if it is running.
   delete backoffTimeout_;
   backoffTimeout_ = nullptr;
@@ -687,6 +704,10 @@ void AsyncServerSocket::removeAcceptCallback(
     eventBase_->dcheckIsInEventBaseThread();
   }
 
+  // The acceptor may have pending connections, if this is called from within
+  // an accept callback running in our own EventBase: hand them over first.
+  flushDispatchBatches();
+
   // Find the matching AcceptCallback.
   // We just do a simple linear search; we don't expect removeAcceptCallback()
   // to be called frequently, and we expect there to only be a small number of
@@ -893,6 +914,10 @@ void AsyncServerSocket::setupSocket(NetworkSocket fd, int family) {
 #endif
   }
 
+  if (incomingCpu_ >= 0) {
+    setIncomingCpuOption(fd);
+  }
+
   // Set keepalive as desired
   if (netops::setsockopt(
           fd,
@@ -959,6 +984,7 @@ void AsyncServerSocket::handlerReady(
     sa_family_t addressFamily) noexcept {
   assert(!callbacks_.empty());
   DestructorGuard dg(this);
+  SCOPE_EXIT { flushDispatchBatches(); };
 
   // Only accept up to maxAcceptAtOnce_ connections at a time,
   // to avoid starving other I/O handlers using this EventBase.
@@ -1098,7 +1124,11 @@ void AsyncServerSocket::handlerReady(
 #endif
 
     // Inform the callback about the new connection
-    dispatchSocket(clientSocket, std::move(address));
+    if (dispatchBatching_) {
+      batchSocket(clientSocket, std::move(address));
+    } else {
+      dispatchSocket(clientSocket, std::move(address));
+    }
 
     // If we aren't accepting any more, break out of the loop
     if (!accepting_ || callbacks_.empty()) {
@@ -1176,6 +1206,97 @@ void AsyncServerSocket::dispatchSocket(
   }
 }
 
+void AsyncServerSocket::batchSocket(
+    NetworkSocket socket, SocketAddress&& address) {
+  auto timeBeforeEnqueue = std::chrono::steady_clock::now();
+
+  CallbackInfo* info = nextCallback(socket);
+  if (info->eventBase == nullptr || info->eventBase == this->eventBase_) {
+    info->callback->connectionAccepted(socket, address, {timeBeforeEnqueue});
+    return;
+  }
+
+  auto queueTimeout = *queueTimeout_;
+  std::chrono::steady_clock::time_point deadline;
+  if (queueTimeout.count() != 0) {
+    deadline = timeBeforeEnqueue + queueTimeout;
+  }
+
+  auto& pending = info->consumer->getPendingConns();
+  if (pending.empty()) {
+    pendingAcceptors_.push_back(info->consumer);
+  }
+  pending.push_back(
+      NewConnMessage{socket, std::move(address), deadline, timeBeforeEnqueue});
+}
+
+void AsyncServerSocket::flushDispatchBatches() {
+  if (pendingAcceptors_.empty()) {
+    return;
+  }
+  // Dispatching may end up calling back into us: work on a copy.
+  auto acceptors = std::move(pendingAcceptors_);
+  pendingAcceptors_.clear();
+
+  for (auto* acceptor : acceptors) {
+    QueueMessage msg{
+        std::in_place_type<NewConnBatchMessage>,
+        NewConnBatchMessage{std::move(acceptor->getPendingConns())}};
+    acceptor->getPendingConns().clear();
+    auto& conns = std::get<NewConnBatchMessage>(msg).conns;
+
+    std::vector<std::pair<NetworkSocket, SocketAddress>> enqueued;
+    if (connectionEventCallback_) {
+      enqueued.reserve(conns.size());
+      for (const auto& conn : conns) {
+        enqueued.emplace_back(conn.fd, conn.clientAddr);
+      }
+    }
+
+    // tryPutMessage() leaves msg untouched when the queue is full.
+    if (acceptor->getQueue().tryPutMessage(
+            std::move(msg), maxNumMsgsInQueue_)) {
+      for (const auto& [fd, addr] : enqueued) {
+        connectionEventCallback_->onConnectionEnqueuedForAcceptorCallback(
+            fd, addr);
+      }
+      continue;
+    }
+
+    // Fall back to dispatching the connections one by one, which may pick
+    // other callbacks.
+    for (auto& conn : conns) {
+      dispatchSocket(conn.fd, std::move(conn.clientAddr));
+    }
+  }
+}
+
+void AsyncServerSocket::setIncomingCpu(int cpu) {
+  incomingCpu_ = cpu;
+  for (auto& handler : sockets_) {
+    if (handler.socket_ != NetworkSocket()) {
+      setIncomingCpuOption(handler.socket_);
+    }
+  }
+}
+
+void AsyncServerSocket::setIncomingCpuOption(NetworkSocket fd) {
+#ifdef SO_INCOMING_CPU
+  int cpu = incomingCpu_;
+  if (netops::setsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu)) !=
+      0) {
+    auto errnoCopy = errno;
+    LOG(ERROR) << "failed to set SO_INCOMING_CPU on async server socket: "
+               << errnoStr(errnoCopy);
+    folly::throwSystemErrorExplicit(
+        errnoCopy, "failed to set SO_INCOMING_CPU on async server socket");
+  }
+#else
+  (void)fd;
+  LOG(WARNING) << "SO_INCOMING_CPU is not supported on this platform";
+#endif
+}
+
 void AsyncServerSocket::dispatchError(const char* msgstr, int errnoValue) {
   uint32_t startingIndex = callbackIndex_;
   CallbackInfo* info = nextCallback();
@@ -651,6 +651,27 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
    */
   void setMaxNumMessagesInQueue(uint32_t num) { maxNumMsgsInQueue_ = num; }
 
+  /**
+   * Get whether connections for callbacks running in other EventBase threads
+   * are dispatched in batches.
+   */
+  bool getDispatchBatching() const { return dispatchBatching_; }
+
+  /**
+   * Set whether connections for callbacks running in other EventBase threads
+   * are dispatched in batches.
+   *
+   * By default every accepted connection is sent to the NotificationQueue of
+   * its callback as soon as it is accepted. With batching, the connections
+   * accepted in one wakeup (up to getMaxAcceptAtOnce()) are grouped per
+   * callback and each group is sent as a single message once the accept loop
+   * is done, which saves cross-thread traffic and wakeups during connection
+   * storms. A group counts as a single message against
+   * getMaxNumMessagesInQueue(); if it doesn't fit, its connections are
+   * dispatched one by one, as without batching.
+   */
+  void setDispatchBatching(bool enabled) { dispatchBatching_ = enabled; }
+
   /**
    * Get the speed of adjusting connection accept rate.
    */
@@ -767,6 +788,27 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
     }
   }
 
+  /**
+   * Set the cpu the server socket is meant to be served by (SO_INCOMING_CPU),
+   * or -1 for none.
+   *
+   * With SO_REUSEPORT, the kernel then hands a new connection to the
+   * listener of the group whose cpu is the one that processed the incoming
+   * SYN, if any. Binding one such listener per IO thread, each on its own
+   * EventBase, with the cpu that thread is pinned to and with the NIC
+   * interrupts steered accordingly, keeps each connection on one cpu from
+   * the device queue to the application, without any cross-thread dispatch.
+   *
+   * Throws if the option could not be set on an already bound socket;
+   * ignored, with a warning, where SO_INCOMING_CPU is not supported.
+   */
+  void setIncomingCpu(int cpu);
+
+  /**
+   * Get the SO_INCOMING_CPU value of the server socket, or -1 for none.
+   */
+  int getIncomingCpu() const { return incomingCpu_; }
+
   /**
    * Set whether or not SO_REUSEADDR should be enabled on the server socket,
    * allowing multiple sockets binds to the same <address>:<port>
@@ -863,7 +905,17 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
         RemoteAcceptor& acceptor) noexcept;
   };
 
-  using QueueMessage = std::variant<NewConnMessage, ErrorMessage>;
+  // The connections accepted for a callback in one wakeup, when dispatch
+  // batching is enabled.
+  struct NewConnBatchMessage {
+    std::vector<NewConnMessage> conns;
+
+    AtomicNotificationQueueTaskStatus operator()(
+        RemoteAcceptor& acceptor) noexcept;
+  };
+
+  using QueueMessage =
+      std::variant<NewConnMessage, ErrorMessage, NewConnBatchMessage>;
 
   /**
    * A class to receive notifications to invoke AcceptCallback objects
@@ -888,6 +940,7 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
 
     friend NewConnMessage;
     friend ErrorMessage;
+    friend NewConnBatchMessage;
 
    public:
     using Queue = EventBaseAtomicNotificationQueue<QueueMessage, Consumer>;
@@ -904,10 +957,15 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
 
     Queue& getQueue() { return queue_; }
 
+    // Connections accepted for this callback and not dispatched yet. Only
+    // used from the thread of the AsyncServerSocket.
+    std::vector<NewConnMessage>& getPendingConns() { return pendingConns_; }
+
    private:
     AcceptCallback* callback_;
     ConnectionEventCallback* connectionEventCallback_;
     Queue queue_;
+    std::vector<NewConnMessage> pendingConns_;
   };
 
   /**
@@ -938,6 +996,9 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
       bool isExistingSocket,
       const std::string& ifName);
   void dispatchSocket(NetworkSocket socket, SocketAddress&& address);
+  void batchSocket(NetworkSocket socket, SocketAddress&& address);
+  void flushDispatchBatches();
+  void setIncomingCpuOption(NetworkSocket fd);
   void dispatchError(const char* msg, int errnoValue);
   void enterBackoff();
   void backoffTimeoutExpired();
@@ -1020,6 +1081,10 @@ class AsyncServerSocket : public DelayedDestruction, public AsyncSocketBase {
   int localCallbackIndex_{-1};
   bool keepAliveEnabled_;
   bool reusePortEnabled_{false};
+  int incomingCpu_{-1};
+  bool dispatchBatching_{false};
+  // Acceptors with pending connections, in the order they got their first.
+  std::vector<RemoteAcceptor*> pendingAcceptors_;
   // SO_REUSEADDR is enabled by default
   bool enableReuseAddr_{true};
   bool closeOnExec_;
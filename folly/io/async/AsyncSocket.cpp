@@ -18,15 +18,19 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <climits>
 #include <sstream>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include <boost/preprocessor/control/if.hpp>
 
 #include <folly/Exception.h>
 #include <folly/ExceptionWrapper.h>
+#include <folly/FileUtil.h>
 #include <folly/Format.h>
 #include <folly/Portability.h>
 #include <folly/SocketAddress.h>
@@ -45,6 +49,7 @@
 #if defined(__linux__)
 #include <linux/if_packet.h>
 #include <linux/sockios.h>
+#include <sys/sendfile.h>
 #include <sys/ioctl.h>
 #endif
 
@@ -284,6 +289,13 @@ class AsyncSocket::BytesWriteRequest : public AsyncSocket::WriteRequest {
   }
 
   WriteResult performWrite() override {
+    if (coalescedWritten_) {
+      // This request was already written by flushCoalescedWrites(), along
+      // with other requests; report that write rather than doing another.
+      coalescedWritten_ = false;
+      return WriteResult(bytesWritten_);
+    }
+
     WriteFlags writeFlags = flags_;
     if (getNext() != nullptr) {
       writeFlags |= WriteFlags::CORK;
@@ -320,6 +332,30 @@ class AsyncSocket::BytesWriteRequest : public AsyncSocket::WriteRequest {
 
   bool isComplete() override { return opsWritten_ == getOpCount(); }
 
+  const struct iovec* getOps() const {
+    assert(opCount_ > opIndex_);
+    return writeOps_ + opIndex_;
+  }
+
+  uint32_t getOpCount() const {
+    assert(opCount_ > opIndex_);
+    return opCount_ - opIndex_;
+  }
+
+  /**
+   * Record that the first opsWritten ops of this request, and partialBytes
+   * of the next one, were written by flushCoalescedWrites(). The next
+   * performWrite() call will then return this write.
+   */
+  void setCoalescedWrite(
+      uint32_t opsWritten, uint32_t partialBytes, ssize_t bytesWritten) {
+    assert(!zeroCopyRequest_);
+    opsWritten_ = opsWritten;
+    partialBytes_ = partialBytes;
+    bytesWritten_ = bytesWritten;
+    coalescedWritten_ = true;
+  }
+
   void consume() override {
     // Advance opIndex_ forward by opsWritten_
     opIndex_ += opsWritten_;
@@ -380,16 +416,6 @@ class AsyncSocket::BytesWriteRequest : public AsyncSocket::WriteRequest {
   // private destructor, to ensure callers use destroy()
   ~BytesWriteRequest() override = default;
 
-  const struct iovec* getOps() const {
-    assert(opCount_ > opIndex_);
-    return writeOps_ + opIndex_;
-  }
-
-  uint32_t getOpCount() const {
-    assert(opCount_ > opIndex_);
-    return opCount_ - opIndex_;
-  }
-
   uint32_t opCount_; ///< number of entries in writeOps_
   uint32_t opIndex_; ///< current index into writeOps_
   WriteFlags flags_; ///< set for WriteFlags
@@ -401,10 +427,145 @@ class AsyncSocket::BytesWriteRequest : public AsyncSocket::WriteRequest {
   uint32_t opsWritten_; ///< complete ops written
   uint32_t partialBytes_; ///< partial bytes of incomplete op written
   ssize_t bytesWritten_; ///< bytes written altogether
+  bool coalescedWritten_{false}; ///< if setCoalescedWrite() was called
 
   struct iovec writeOps_[]; ///< write operation(s) list
 };
 
+/* The WriteRequest used by sendFile()
+ *
+ * Sends the file range with sendfile() where possible. Otherwise the range is
+ * read a chunk at a time into a buffer that goes through the socket's
+ * regular performWrite(), so that e.g. TLS still applies.
+ */
+class AsyncSocket::FileWriteRequest : public AsyncSocket::WriteRequest {
+ public:
+  FileWriteRequest(
+      AsyncSocket* socket,
+      WriteCallback* callback,
+      int fd,
+      off_t offset,
+      size_t length,
+      WriteFlags flags)
+      : AsyncSocket::WriteRequest(socket, callback),
+        fd_(fd),
+        offset_(offset),
+        remaining_(length),
+        // The chunk buffers are reused, so they can't be sent with zerocopy.
+        flags_(unSet(flags, WriteFlags::WRITE_MSG_ZEROCOPY)),
+        useSendFile_(kIsLinux && socket->getSecurityProtocol().empty()) {}
+
+  void destroy() override { delete this; }
+
+  WriteResult performWrite() override {
+    bytesWritten_ = 0;
+    if (remaining_ == 0) {
+      return WriteResult(0);
+    }
+    if (useSendFile_) {
+      auto result = performSendFile();
+      if (result.writeReturn >= 0 || useSendFile_) {
+        return result;
+      }
+      // sendfile() doesn't support this file or socket: fall back.
+    }
+    return performBufferedWrite();
+  }
+
+  bool isComplete() override { return remaining_ == 0; }
+
+  void consume() override { totalBytesWritten_ += uint32_t(bytesWritten_); }
+
+ private:
+  static constexpr size_t kChunkSize = 64 * 1024;
+
+  ~FileWriteRequest() override = default;
+
+  WriteResult performSendFile() {
+#ifdef __linux__
+    auto n = ::sendfile(
+        socket_->fd_.toFd(),
+        fd_,
+        &offset_,
+        std::min(remaining_, size_t(std::numeric_limits<int32_t>::max())));
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return WriteResult(0);
+      }
+      if ((errno == EINVAL || errno == ENOSYS) &&
+          totalBytesWritten_ == 0) {
+        useSendFile_ = false;
+      }
+      return WriteResult(WRITE_ERROR);
+    }
+    if (n == 0) {
+      return WriteResult(
+          WRITE_ERROR,
+          std::make_unique<AsyncSocketException>(
+              AsyncSocketException::INTERNAL_ERROR,
+              "sendFile(): the file ended before the requested range"));
+    }
+    socket_->appBytesWritten_ += size_t(n);
+    socket_->rawBytesWritten_ += size_t(n);
+    recordWritten(size_t(n));
+    return WriteResult(n);
+#else
+    useSendFile_ = false;
+    return WriteResult(WRITE_ERROR);
+#endif
+  }
+
+  WriteResult performBufferedWrite() {
+    if (!buf_ || buf_->empty()) {
+      auto chunk = std::min(remaining_, kChunkSize);
+      if (!buf_) {
+        buf_ = IOBuf::create(chunk);
+      }
+      buf_->clear();
+      auto n = preadFull(fd_, buf_->writableData(), chunk, offset_);
+      if (n <= 0) {
+        return WriteResult(
+            WRITE_ERROR,
+            std::make_unique<AsyncSocketException>(
+                AsyncSocketException::INTERNAL_ERROR,
+                n == 0 ? "sendFile(): the file ended before the requested range"
+                       : "sendFile(): pread() failed",
+                n == 0 ? 0 : errno));
+      }
+      buf_->append(size_t(n));
+      offset_ += n;
+    }
+
+    WriteFlags flags = flags_;
+    if (getNext() != nullptr || remaining_ > buf_->length()) {
+      flags |= WriteFlags::CORK;
+    }
+    iovec op{buf_->writableData(), buf_->length()};
+    uint32_t opsWritten = 0;
+    uint32_t partialWritten = 0;
+    auto result = socket_->performWrite(
+        &op, 1, flags, &opsWritten, &partialWritten, WriteRequestTag{nullptr});
+    if (result.writeReturn > 0) {
+      buf_->trimStart(size_t(result.writeReturn));
+      recordWritten(size_t(result.writeReturn));
+    }
+    return result;
+  }
+
+  void recordWritten(size_t n) {
+    remaining_ -= n;
+    bytesWritten_ = n;
+  }
+
+  int fd_;
+  off_t offset_; ///< file offset of the next byte to send or read
+  size_t remaining_; ///< bytes not sent yet
+  WriteFlags flags_;
+  bool useSendFile_;
+  size_t bytesWritten_{0}; ///< bytes sent by the last performWrite()
+  std::unique_ptr<IOBuf> buf_; ///< fallback chunk, read but not sent yet
+};
+
 int AsyncSocket::SendMsgParamsCallback::getDefaultFlags(
     folly::WriteFlags flags, bool zeroCopyEnabled) noexcept {
   int msg_flags = MSG_DONTWAIT;
@@ -1795,13 +1956,33 @@ void AsyncSocket::writeImpl(
     return invalidState(callback);
   }
 
+  // Writes are coalesced only while all the pending writes are coalesced
+  // ones, so that the writes stay in order.
+  const bool canCoalesce = maxCoalescedBytes_ > 0 && count > 0 &&
+      unSet(flags, WriteFlags::CORK) == WriteFlags::NONE;
+  bool coalesce = false;
+  if (numCoalescedWrites_ > 0) {
+    if (canCoalesce) {
+      coalesce = true;
+    } else {
+      flushCoalescedWrites();
+      if (shutdownFlags_ & (SHUT_WRITE | SHUT_WRITE_PENDING)) {
+        return invalidState(callback);
+      }
+    }
+  }
+
   uint32_t countWritten = 0;
   uint32_t partialWritten = 0;
   ssize_t bytesWritten = 0;
   bool mustRegister = false;
   if ((state_ == StateEnum::ESTABLISHED || state_ == StateEnum::FAST_OPEN) &&
       !connecting()) {
-    if (writeReqHead_ == nullptr) {
+    maybeSampleTcpInfo(false);
+    if (writeReqHead_ == nullptr && canCoalesce &&
+        state_ == StateEnum::ESTABLISHED) {
+      coalesce = true;
+    } else if (writeReqHead_ == nullptr) {
       // If we are established and there are no other writes pending,
       // we can attempt to perform the write immediately.
       assert(writeReqTail_ == nullptr);
@@ -1888,6 +2069,17 @@ void AsyncSocket::writeImpl(
     writeReqTail_ = req;
   }
 
+  if (coalesce) {
+    ++numCoalescedWrites_;
+    coalescedBytes_ += totalBytes;
+    if (coalescedBytes_ >= maxCoalescedBytes_) {
+      flushCoalescedWrites();
+    } else if (!writeFlushHandler_.isLoopCallbackScheduled()) {
+      eventBase_->runInLoop(&writeFlushHandler_);
+    }
+    return;
+  }
+
   if (bufferCallback_) {
     bufferCallback_->onEgressBuffered();
   }
@@ -1901,6 +2093,7 @@ void AsyncSocket::writeImpl(
       assert(state_ == StateEnum::ERROR);
       return;
     }
+    maybeSampleTcpInfo(true);
     if (sendTimeout_ > 0) {
       // Schedule a timeout to fire if the write takes too long.
       if (!writeTimeout_.scheduleTimeout(sendTimeout_)) {
@@ -1913,7 +2106,39 @@ void AsyncSocket::writeImpl(
   }
 }
 
+void AsyncSocket::sendFile(
+    WriteCallback* callback,
+    int fd,
+    off_t offset,
+    size_t length,
+    WriteFlags flags) {
+  VLOG(6) << "AsyncSocket::sendFile() this=" << this << ", fd=" << fd_
+          << ", callback=" << callback << ", file=" << fd
+          << ", offset=" << offset << ", length=" << length
+          << ", state=" << state_;
+  DestructorGuard dg(this);
+  eventBase_->dcheckIsInEventBaseThread();
+
+  totalAppBytesScheduledForWrite_ += length;
+  if ((shutdownFlags_ & (SHUT_WRITE | SHUT_WRITE_PENDING)) ||
+      (state_ != StateEnum::ESTABLISHED && !connecting())) {
+    return invalidState(callback);
+  }
+
+  auto* req =
+      new FileWriteRequest(this, callback, fd, offset, length, flags);
+  writeRequest(req);
+  // Start writing right away if nothing else is pending; otherwise the
+  // request runs when the ones ahead of it are done (or once connected).
+  if (state_ == StateEnum::ESTABLISHED && writeReqHead_ == req &&
+      (eventFlags_ & EventHandler::WRITE) == 0) {
+    handleWrite();
+  }
+}
+
 void AsyncSocket::writeRequest(WriteRequest* req) {
+  // Keep the writes in order, the coalesced ones come first.
+  flushCoalescedWrites();
   if (writeReqTail_ == nullptr) {
     assert(writeReqHead_ == nullptr);
     writeReqHead_ = writeReqTail_ = req;
@@ -1924,6 +2149,84 @@ void AsyncSocket::writeRequest(WriteRequest* req) {
   }
 }
 
+void AsyncSocket::flushCoalescedWrites() noexcept {
+  if (numCoalescedWrites_ == 0) {
+    return;
+  }
+  VLOG(5) << "AsyncSocket::flushCoalescedWrites() this=" << this
+          << ", fd=" << fd_ << ", writes=" << numCoalescedWrites_
+          << ", bytes=" << coalescedBytes_;
+  DestructorGuard dg(this);
+  if (writeFlushHandler_.isLoopCallbackScheduled()) {
+    writeFlushHandler_.cancelLoopCallback();
+  }
+  uint32_t numWrites = std::exchange(numCoalescedWrites_, 0);
+  coalescedBytes_ = 0;
+
+  assert(state_ == StateEnum::ESTABLISHED);
+  assert(writeReqHead_ != nullptr);
+  assert((eventFlags_ & EventHandler::WRITE) == 0);
+
+  // Gather the ops of the coalesced writes, as many as fit in one sendmsg().
+  // These are all BytesWriteRequests that haven't been written to yet.
+  std::vector<iovec> ops;
+  uint32_t numGathered = 0;
+  WriteRequest* req = writeReqHead_;
+  for (; numGathered < numWrites; ++numGathered, req = req->getNext()) {
+    auto* bytesReq = static_cast<BytesWriteRequest*>(req);
+    uint32_t opCount = bytesReq->getOpCount();
+    if (numGathered > 0 && ops.size() + opCount > kIovMax) {
+      break;
+    }
+    ops.insert(ops.end(), bytesReq->getOps(), bytesReq->getOps() + opCount);
+    req->getCallbackWithState().notifyOnWrite();
+  }
+
+  uint32_t countWritten = 0;
+  uint32_t partialWritten = 0;
+  auto writeResult = performWrite(
+      ops.data(),
+      uint32_t(ops.size()),
+      req != nullptr ? WriteFlags::CORK : WriteFlags::NONE,
+      &countWritten,
+      &partialWritten,
+      WriteRequestTag{WriteRequestTag::EmptyDummy()});
+  if (writeResult.writeReturn < 0) {
+    if (writeResult.exception) {
+      return failWrite(__func__, *writeResult.exception);
+    }
+    auto errnoCopy = errno;
+    AsyncSocketException ex(
+        AsyncSocketException::INTERNAL_ERROR,
+        withAddr("writev() failed"),
+        errnoCopy);
+    return failWrite(__func__, ex);
+  }
+
+  // Hand each request its share of the write, up to the first one that
+  // wasn't written completely, and let handleWrite() complete them.
+  req = writeReqHead_;
+  for (uint32_t i = 0; i < numGathered; ++i, req = req->getNext()) {
+    auto* bytesReq = static_cast<BytesWriteRequest*>(req);
+    uint32_t opCount = bytesReq->getOpCount();
+    const iovec* reqOps = bytesReq->getOps();
+    uint32_t opsWritten = std::min(opCount, countWritten);
+    ssize_t bytesWritten = 0;
+    for (uint32_t op = 0; op < opsWritten; ++op) {
+      bytesWritten += ssize_t(reqOps[op].iov_len);
+    }
+    countWritten -= opsWritten;
+    if (opsWritten == opCount) {
+      bytesReq->setCoalescedWrite(opsWritten, 0, bytesWritten);
+    } else {
+      bytesReq->setCoalescedWrite(
+          opsWritten, partialWritten, bytesWritten + partialWritten);
+      break;
+    }
+  }
+  handleWrite();
+}
+
 void AsyncSocket::close() {
   VLOG(5) << "AsyncSocket::close(): this=" << this << ", fd_=" << fd_
           << ", state=" << state_ << ", shutdownFlags=" << std::hex
@@ -2244,6 +2547,9 @@ void AsyncSocket::attachEventBase(EventBase* eventBase) {
   updateEventRegistration();
 
   writeTimeout_.attachEventBase(eventBase);
+  if (numCoalescedWrites_ > 0) {
+    eventBase_->runInLoop(&writeFlushHandler_);
+  }
   if (evbChangeCb_) {
     evbChangeCb_->evbAttached(this);
   }
@@ -2278,6 +2584,9 @@ void AsyncSocket::detachEventBase() {
 
   ioHandler_.detachEventBase();
   writeTimeout_.detachEventBase();
+  if (writeFlushHandler_.isLoopCallbackScheduled()) {
+    writeFlushHandler_.cancelLoopCallback();
+  }
   if (evbChangeCb_) {
     evbChangeCb_->evbDetached(this);
   }
@@ -2470,6 +2779,50 @@ int AsyncSocket::setRecvBufSize(size_t bufsize) {
   return 0;
 }
 
+int AsyncSocket::setBusyPoll(
+    [[maybe_unused]] std::chrono::microseconds duration) {
+  if (fd_ == NetworkSocket()) {
+    VLOG(4) << "AsyncSocket::setBusyPoll() called on non-open socket " << this
+            << "(state=" << state_ << ")";
+    return EINVAL;
+  }
+
+#ifdef SO_BUSY_POLL // Linux-only
+  int value = int(std::max<int64_t>(0, duration.count()));
+  if (netops_->setsockopt(
+          fd_, SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value)) != 0) {
+    int errnoCopy = errno;
+    VLOG(2) << "failed to update SO_BUSY_POLL option on AsyncSocket" << this
+            << "(fd=" << fd_ << ", state=" << state_
+            << "): " << errnoStr(errnoCopy);
+    return errnoCopy;
+  }
+
+  return 0;
+#else
+  return ENOSYS;
+#endif
+}
+
+folly::Optional<unsigned int> AsyncSocket::getNapiId() const {
+  if (fd_ == NetworkSocket()) {
+    return folly::none;
+  }
+
+#ifdef SO_INCOMING_NAPI_ID // Linux-only
+  unsigned int id = 0;
+  socklen_t len = sizeof(id);
+  if (netops_->getsockopt(fd_, SOL_SOCKET, SO_INCOMING_NAPI_ID, &id, &len) !=
+          0 ||
+      id == 0) {
+    return folly::none;
+  }
+  return id;
+#else
+  return folly::none;
+#endif
+}
+
 #if defined(__linux__)
 size_t AsyncSocket::getSendBufInUse() const {
   if (fd_ == NetworkSocket()) {
@@ -2690,6 +3043,15 @@ AsyncSocket::ReadResult AsyncSocket::performReadMsg(
     // `ReadAncillaryDataCallback` implementations to check this.
   }
 
+  size_t bufferBytes = 0;
+  for (size_t i = 0; i < static_cast<size_t>(msg.msg_iovlen); ++i) {
+    bufferBytes += msg.msg_iov[i].iov_len;
+  }
+  eventBase_->getSocketStats().onRead(
+      bufferBytes,
+      bytes,
+      bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+
   if (bytes < 0) {
     if (errno == EAGAIN || errno == EWOULDBLOCK) {
       // No more data to read right now.
@@ -2885,6 +3247,45 @@ folly::Expected<folly::TcpInfo, std::errc> AsyncSocket::getTcpInfo(
   return tcpInfoDispatcher_->initFromFd(fd_, options);
 }
 
+Optional<size_t> AsyncSocket::TcpInfoSample::writeBudgetBytes() const {
+  Optional<uint64_t> window;
+  auto rate = tcpInfo.deliveryRateBytesPerSecond();
+  auto srtt = tcpInfo.srtt();
+  if (rate && srtt && *rate > 0) {
+    window = *rate * uint64_t(srtt->count()) / 1000000;
+  }
+  if (!window || *window == 0) {
+    window = tcpInfo.cwndInBytes();
+  }
+  if (!window) {
+    return none;
+  }
+  auto notSent = tcpInfo.bytesNotSent().value_or(0);
+  return size_t(*window > notSent ? *window - notSent : 0);
+}
+
+const AsyncSocket::TcpInfoSample* AsyncSocket::sampleTcpInfo() {
+  if (!tcpInfoSampling_) {
+    return nullptr;
+  }
+  auto now = std::chrono::steady_clock::now();
+  auto tcpInfo = getTcpInfo(tcpInfoSampling_->lookupOptions);
+  if (tcpInfo.hasValue()) {
+    tcpInfoSample_ = TcpInfoSample{now, std::move(tcpInfo.value())};
+  }
+  return tcpInfoSample_.get_pointer();
+}
+
+void AsyncSocket::maybeSampleTcpInfoSlow(bool writeBlocked) {
+  if (!(writeBlocked && tcpInfoSampling_->sampleOnWriteBlocked) &&
+      tcpInfoSample_ &&
+      std::chrono::steady_clock::now() - tcpInfoSample_->sampledAt <
+          tcpInfoSampling_->interval) {
+    return;
+  }
+  sampleTcpInfo();
+}
+
 void AsyncSocket::addLifecycleObserver(
     AsyncSocket::LegacyLifecycleObserver* observer) {
   if (eventBase_) {
@@ -3421,6 +3822,7 @@ void AsyncSocket::handleWrite() noexcept {
           return;
         }
       }
+      maybeSampleTcpInfo(true);
 
       // Reschedule the send timeout, since we have made some write progress.
       if (sendTimeout_ > 0) {
@@ -3489,6 +3891,12 @@ void AsyncSocket::handleInitialReadWrite() noexcept {
   // However, we only process them if EventHandler::WRITE is not already set,
   // which means that we're already blocked on a write attempt.  (This can
   // happen if connectSuccess() called write() before returning.)
+  //
+  // Writes coalesced by connectSuccess() are flushed the same way, since
+  // handleWrite() would send them without resetting the coalescing state.
+  if (numCoalescedWrites_ > 0) {
+    flushCoalescedWrites();
+  }
   if (writeReqHead_ && !(eventFlags_ & EventHandler::WRITE)) {
     // Call handleWrite() to perform write processing.
     handleWrite();
@@ -3884,6 +4292,8 @@ AsyncSocket::WriteResult AsyncSocket::performWrite(
     WriteRequestTag writeTag) {
   auto writeResult = sendSocketMessage(vec, count, flags, std::move(writeTag));
   auto totalWritten = writeResult.writeReturn;
+  eventBase_->getSocketStats().onWrite(
+      totalWritten, totalWritten < 0 && errno == EAGAIN);
   if (totalWritten < 0) {
     bool tryAgain = (errno == EAGAIN);
 #ifdef __APPLE__
@@ -3914,6 +4324,7 @@ AsyncSocket::WriteResult AsyncSocket::performWrite(
     const iovec* v = vec + n;
     if (v->iov_len > bytesWritten) {
       // Partial write finished in the middle of this iovec
+      eventBase_->getSocketStats().onPartialWrite();
       *countWritten = n;
       *partialWritten = bytesWritten;
       return WriteResult(totalWritten);
@@ -4134,6 +4545,11 @@ void AsyncSocket::failAllWrites(const AsyncSocketException& ex) {
   // Invoke writeError() on all write callbacks.
   // This is used when writes are forcibly shutdown with write requests
   // pending, or when an error occurs with writes pending.
+  numCoalescedWrites_ = 0;
+  coalescedBytes_ = 0;
+  if (writeFlushHandler_.isLoopCallbackScheduled()) {
+    writeFlushHandler_.cancelLoopCallback();
+  }
   while (writeReqHead_ != nullptr) {
     WriteRequest* req = writeReqHead_;
     writeReqHead_ = req->getNext();
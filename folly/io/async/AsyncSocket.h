@@ -682,6 +682,36 @@ class AsyncSocket : public AsyncSocketTransport {
    */
   uint16_t getMaxReadsPerEvent() const { return maxReadsPerEvent_; }
 
+  /**
+   * Set the maximum number of bytes of writes to coalesce, or 0 (the
+   * default) to disable write coalescing.
+   *
+   * When enabled, writes made while no other write is pending are not sent
+   * right away but queued until the end of the current event loop iteration,
+   * at which point all the writes queued in between are sent with a single
+   * sendmsg() call, rather than one per write. This saves system calls when
+   * many handlers write small responses to the same socket in one loop
+   * iteration, e.g. for pipelined protocols, at the cost of delaying the
+   * writes until the loop callbacks run. Queued writes are sent as soon as
+   * they add up to maxBytes, to bound that delay.
+   *
+   * Write callbacks are invoked as usual, once their own data is written.
+   * Writes with flags other than WriteFlags::CORK, including zero-copy
+   * writes, are never delayed, and are sent after the queued ones.
+   */
+  void setWriteCoalescing(size_t maxBytes) { maxCoalescedBytes_ = maxBytes; }
+
+  /**
+   * Get the maximum number of bytes of writes to coalesce, or 0 if write
+   * coalescing is disabled.
+   */
+  size_t getWriteCoalescing() const { return maxCoalescedBytes_; }
+
+  /**
+   * Sends the coalesced writes right away, see setWriteCoalescing().
+   */
+  void flushCoalescedWrites() noexcept;
+
   /**
    * Set a pointer to ErrMessageCallback implementation which will be
    * receiving notifications for messages posted to the error queue
@@ -841,6 +871,23 @@ class AsyncSocket : public AsyncSocketTransport {
       std::unique_ptr<folly::IOBuf>&& buf,
       WriteFlags flags = WriteFlags::NONE) override;
 
+  /**
+   * Write length bytes of the file fd, starting at offset, without copying
+   * them through userspace: the data goes from the page cache to the socket
+   * with sendfile(). Sockets that transform what they send (e.g. TLS) and
+   * files sendfile() can't handle fall back to pread() plus a regular write,
+   * a chunk at a time. The write is ordered with all the others.
+   *
+   * fd must stay open, and the file range unchanged, until the callback is
+   * invoked. The file offset of fd is not used or changed.
+   */
+  void sendFile(
+      WriteCallback* callback,
+      int fd,
+      off_t offset,
+      size_t length,
+      WriteFlags flags = WriteFlags::NONE);
+
   class WriteRequest;
   virtual void writeRequest(WriteRequest* req);
   void writeRequestReady() { handleWrite(); }
@@ -1014,6 +1061,24 @@ class AsyncSocket : public AsyncSocketTransport {
    */
   int setRecvBufSize(size_t bufsize);
 
+  /**
+   * Sets SO_BUSY_POLL: how long a blocking receive, or a poll on the socket,
+   * busy-polls the device queue for new packets before sleeping. Spinning
+   * only pays off when the EventBase itself busy-polls, see
+   * EventBase::Options::setBusyPollMax().
+   *
+   * @return Returns 0 on success, or a non-zero errno value on error.
+   */
+  int setBusyPoll(std::chrono::microseconds duration);
+
+  /**
+   * Returns the id of the NAPI context (i.e. of the device receive queue)
+   * of the last packet received on this socket, from SO_INCOMING_NAPI_ID,
+   * or folly::none if unsupported or unknown. Sockets served by the same
+   * queue are best handled by the same busy-polling EventBase.
+   */
+  folly::Optional<unsigned int> getNapiId() const;
+
 #if defined(__linux__)
   /**
    * @brief This method is used to get the number of bytes that are currently
@@ -1188,6 +1253,70 @@ class AsyncSocket : public AsyncSocketTransport {
   folly::Expected<folly::TcpInfo, std::errc> getTcpInfo(
       const TcpInfo::LookupOptions& options);
 
+  /**
+   * Options for sampling folly::TcpInfo from the write path.
+   */
+  struct TcpInfoSamplingOptions {
+    // Minimum time between two samples. Writes issued before it elapses use
+    // the cached sample instead of calling getsockopt(TCP_INFO) again.
+    std::chrono::milliseconds interval{100};
+
+    // Whether to also sample as soon as a write cannot complete because the
+    // socket send buffer is full, regardless of interval.
+    bool sampleOnWriteBlocked{true};
+
+    TcpInfo::LookupOptions lookupOptions;
+  };
+
+  /**
+   * A folly::TcpInfo cached by the sampler, and when it was fetched.
+   */
+  struct TcpInfoSample {
+    std::chrono::steady_clock::time_point sampledAt;
+    TcpInfo tcpInfo;
+
+    /**
+     * Estimates how many more bytes the connection can take without queueing
+     * more than a round trip's worth of data in the send buffer.
+     *
+     * The budget is the bandwidth-delay product (delivery rate times smoothed
+     * RTT), or the congestion window when the delivery rate is unknown, minus
+     * the bytes already written but not yet sent. Returns folly::none if
+     * neither the delivery rate nor the congestion window is available.
+     */
+    Optional<size_t> writeBudgetBytes() const;
+  };
+
+  /**
+   * Enables sampling of folly::TcpInfo, or disables it if options is none.
+   *
+   * Samples are taken lazily from the write path: when a write is issued and
+   * the interval has elapsed since the last sample, and, if enabled, when a
+   * write blocks. A writer can then size its writes by the cached congestion
+   * window, RTT and delivery rate (see getTcpInfoSample()) without a syscall
+   * of its own per write.
+   */
+  void setTcpInfoSampling(Optional<TcpInfoSamplingOptions> options) {
+    tcpInfoSampling_ = std::move(options);
+    if (!tcpInfoSampling_) {
+      tcpInfoSample_.reset();
+    }
+  }
+
+  /**
+   * Returns the last folly::TcpInfo sampled, or nullptr if sampling is
+   * disabled or no sample has been taken yet.
+   */
+  const TcpInfoSample* getTcpInfoSample() const {
+    return tcpInfoSample_.get_pointer();
+  }
+
+  /**
+   * Samples folly::TcpInfo right away, if sampling is enabled, and returns
+   * the new sample (or the previous one if the lookup failed).
+   */
+  const TcpInfoSample* sampleTcpInfo();
+
   /**
    * writeReturn is the total number of bytes written, or WRITE_ERROR on error.
    * If no data has been written, 0 is returned.
@@ -1585,6 +1714,7 @@ class AsyncSocket : public AsyncSocketTransport {
   };
 
   class BytesWriteRequest;
+  class FileWriteRequest;
 
   class WriteTimeout : public AsyncTimeout {
    public:
@@ -1626,6 +1756,18 @@ class AsyncSocket : public AsyncSocketTransport {
     AsyncSocket* socket_;
   };
 
+  class WriteFlushCB : public folly::EventBase::LoopCallback {
+   public:
+    explicit WriteFlushCB(AsyncSocket* socket) : socket_(socket) {}
+    void runLoopCallback() noexcept override {
+      DestructorGuard dg(socket_);
+      socket_->flushCoalescedWrites();
+    }
+
+   private:
+    AsyncSocket* socket_;
+  };
+
   /**
    * Schedule checkForImmediateRead to be executed in the next loop
    * iteration.
@@ -1664,6 +1806,15 @@ class AsyncSocket : public AsyncSocketTransport {
   virtual void handleConnect() noexcept;
   void timeoutExpired() noexcept;
 
+  // Samples TcpInfo if sampling is enabled and the sample is stale, or the
+  // write blocked and sampleOnWriteBlocked is set.
+  void maybeSampleTcpInfo(bool writeBlocked) {
+    if (tcpInfoSampling_) {
+      maybeSampleTcpInfoSlow(writeBlocked);
+    }
+  }
+  void maybeSampleTcpInfoSlow(bool writeBlocked);
+
   /**
    * Handler for when the file descriptor is attached to the AsyncSocket.
 
@@ -1911,6 +2062,13 @@ class AsyncSocket : public AsyncSocketTransport {
   WriteTimeout writeTimeout_; ///< A timeout for connect and write
   IoHandler ioHandler_; ///< A EventHandler to monitor the fd
   ImmediateReadCB immediateReadHandler_; ///< LoopCallback for checking read
+  WriteFlushCB writeFlushHandler_{this}; ///< LoopCallback for coalesced writes
+
+  size_t maxCoalescedBytes_{0}; ///< Write coalescing limit, 0 if disabled
+  size_t coalescedBytes_{0}; ///< Bytes of the coalesced writes
+  // Number of write requests, at the head of the queue, that are waiting for
+  // flushCoalescedWrites().
+  uint32_t numCoalescedWrites_{0};
 
   ConnectCallback* connectCallback_; ///< ConnectCallback
   ErrMessageCallback* errMessageCallback_; ///< TimestampCallback
@@ -1999,6 +2157,9 @@ class AsyncSocket : public AsyncSocketTransport {
 
   folly::TcpInfoDispatcherContainer tcpInfoDispatcher_;
 
+  Optional<TcpInfoSamplingOptions> tcpInfoSampling_;
+  Optional<TcpInfoSample> tcpInfoSample_;
+
   // Container of observers for the socket / transport.
   //
   // This member MUST be last in the list of members (other than
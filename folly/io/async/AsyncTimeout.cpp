@@ -139,6 +139,10 @@ void AsyncTimeout::libeventCallback(libevent_fd_t fd, short events, void* arg) {
   timeout->timeoutManager_->bumpHandlingTime();
 
   RequestContextScopeGuard rctx(timeout->context_);
+  ExecutionObserverScopeGuard guard(
+      timeout->timeoutManager_->getTimeoutExecutionObserverList(),
+      timeout,
+      folly::ExecutionObserver::CallbackType::Timeout);
 
   timeout->timeoutExpired();
 }
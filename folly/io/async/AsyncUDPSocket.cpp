@@ -18,6 +18,7 @@
 #include <folly/io/async/AsyncUDPSocket.h>
 
 #include <cerrno>
+#include <vector>
 
 #include <boost/preprocessor/control/if.hpp>
 
@@ -91,6 +92,50 @@ void AsyncUDPSocket::fromMsg(
   }
 #endif
 }
+void AsyncUDPSocket::ReadCallback::onDataAvailableBatch(
+    Range<Datagram*> datagrams) noexcept {
+  for (auto& datagram : datagrams) {
+    void* buf{nullptr};
+    size_t len{0};
+    getReadBuffer(&buf, &len);
+    if (buf == nullptr || len == 0) {
+      return;
+    }
+    size_t dataLen = datagram.data->length();
+    bool truncated = datagram.truncated || dataLen > len;
+    dataLen = std::min(dataLen, len);
+    memcpy(buf, datagram.data->data(), dataLen);
+    onDataAvailable(datagram.client, dataLen, truncated, datagram.params);
+  }
+}
+
+struct AsyncUDPSocket::ReadBatch {
+  ReadBatch(uint16_t numPackets, size_t packetSizeIn)
+      : packetSize(packetSizeIn),
+        msgs(numPackets),
+        iovs(numPackets),
+        addrs(numPackets)
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+        ,
+        control(
+            numPackets * ReadCallback::OnDataAvailableParams::kCmsgSpace)
+#endif
+  {
+    datagrams.reserve(numPackets);
+  }
+
+  const size_t packetSize;
+  // numPackets * packetSize bytes, the packets are read into
+  std::unique_ptr<IOBuf> slab;
+  std::vector<mmsghdr> msgs;
+  std::vector<iovec> iovs;
+  std::vector<sockaddr_storage> addrs;
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  std::vector<char> control;
+#endif
+  std::vector<ReadCallback::Datagram> datagrams;
+};
+
 static constexpr bool msgErrQueueSupported =
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
     true;
@@ -1034,7 +1079,7 @@ int AsyncUDPSocket::writeImpl(
 }
 
 ssize_t AsyncUDPSocket::recvmsg(struct msghdr* msg, int flags) {
-  return netops::recvmsg(fd_, msg, flags);
+  return netops_->recvmsg(fd_, msg, flags);
 }
 
 int AsyncUDPSocket::recvmmsg(
@@ -1042,7 +1087,7 @@ int AsyncUDPSocket::recvmmsg(
     unsigned int vlen,
     unsigned int flags,
     struct timespec* timeout) {
-  return netops::recvmmsg(fd_, msgvec, vlen, flags, timeout);
+  return netops_->recvmmsg(fd_, msgvec, vlen, flags, timeout);
 }
 
 void AsyncUDPSocket::resumeRead(ReadCallback* cob) {
@@ -1227,6 +1272,10 @@ void AsyncUDPSocket::handleRead() noexcept {
     return readCallback_->onNotifyDataAvailable(*this);
   }
 
+  if (readBatch_) {
+    return handleReadBatch();
+  }
+
   size_t numReads = maxReadsPerEvent_ ? maxReadsPerEvent_ : size_t(-1);
   EventBase* originalEventBase = eventBase_;
   while (numReads-- && readCallback_ && eventBase_ == originalEventBase) {
@@ -1356,6 +1405,110 @@ void AsyncUDPSocket::handleRead() noexcept {
   }
 }
 
+void AsyncUDPSocket::handleReadBatch() noexcept {
+  bool useCmsgs = recvTos_;
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+  useCmsgs |= gro_.has_value() && (gro_.value() > 0);
+  useCmsgs |= ts_.has_value() && (ts_.value() > 0);
+#endif
+
+  size_t numReads = maxReadsPerEvent_ ? maxReadsPerEvent_ : size_t(-1);
+  EventBase* originalEventBase = eventBase_;
+  while (numReads-- && readCallback_ && eventBase_ == originalEventBase &&
+         readBatch_) {
+    auto& batch = *readBatch_;
+    auto numPackets = batch.msgs.size();
+
+    // Reuse the slab unless the callback still holds some of its datagrams.
+    if (!batch.slab || batch.slab->isShared()) {
+      batch.slab = IOBuf::create(numPackets * batch.packetSize);
+    }
+    uint8_t* base = batch.slab->writableBuffer();
+    for (size_t i = 0; i < numPackets; ++i) {
+      batch.iovs[i].iov_base = base + i * batch.packetSize;
+      batch.iovs[i].iov_len = batch.packetSize;
+
+      auto& msg = batch.msgs[i].msg_hdr;
+      msg = {};
+      msg.msg_iov = &batch.iovs[i];
+      msg.msg_iovlen = 1;
+      memset(&batch.addrs[i], 0, sizeof(batch.addrs[i]));
+      batch.addrs[i].ss_family = localAddress_.getFamily();
+      msg.msg_name = &batch.addrs[i];
+      msg.msg_namelen = sizeof(batch.addrs[i]);
+#ifdef FOLLY_HAVE_MSG_ERRQUEUE
+      if (useCmsgs) {
+        constexpr auto kCmsgSpace =
+            ReadCallback::OnDataAvailableParams::kCmsgSpace;
+        msg.msg_control = &batch.control[i * kCmsgSpace];
+        msg.msg_controllen = kCmsgSpace;
+      }
+#endif
+      batch.msgs[i].msg_len = 0;
+    }
+
+    int ret = recvmmsg(
+        batch.msgs.data(), (unsigned int)numPackets, MSG_TRUNC, nullptr);
+    if (ret < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // No data could be read without blocking the socket
+        return;
+      }
+
+      AsyncSocketException ex(
+          AsyncSocketException::INTERNAL_ERROR, "::recvmmsg() failed", errno);
+
+      // As in handleRead(), the caller has to resume reading.
+      auto cob = readCallback_;
+      readCallback_ = nullptr;
+
+      cob->onReadError(ex);
+      updateRegistration();
+
+      return;
+    }
+
+    for (int i = 0; i < ret; ++i) {
+      auto& msg = batch.msgs[i].msg_hdr;
+      size_t bytesRead = batch.msgs[i].msg_len;
+      if (bytesRead == 0) {
+        continue;
+      }
+
+      ReadCallback::Datagram datagram;
+      datagram.client.setFromSockaddr(
+          reinterpret_cast<sockaddr*>(msg.msg_name), msg.msg_namelen);
+      if (bytesRead > batch.packetSize) {
+        datagram.truncated = true;
+        bytesRead = batch.packetSize;
+      }
+      datagram.data = batch.slab->cloneOne();
+      datagram.data->advance(i * batch.packetSize);
+      datagram.data->append(bytesRead);
+      if (useCmsgs) {
+        fromMsg(datagram.params, msg);
+      }
+      batch.datagrams.push_back(std::move(datagram));
+    }
+
+    // The callback may disable batched reads, take the datagrams out of the
+    // batch first.
+    auto datagrams = std::move(batch.datagrams);
+    if (!datagrams.empty()) {
+      readCallback_->onDataAvailableBatch(range(datagrams));
+    }
+    datagrams.clear();
+    if (readBatch_ && readBatch_->datagrams.empty()) {
+      readBatch_->datagrams = std::move(datagrams);
+    }
+
+    if (size_t(ret) < numPackets) {
+      // The socket has been drained
+      return;
+    }
+  }
+}
+
 bool AsyncUDPSocket::updateRegistration() noexcept {
   uint16_t flags = NONE;
 
@@ -1404,6 +1557,19 @@ int AsyncUDPSocket::getGSO() {
   return gso_.value();
 }
 
+void AsyncUDPSocket::setReadBatching(uint16_t numPackets, size_t packetSize) {
+  if (numPackets == 0) {
+    readBatch_.reset();
+    return;
+  }
+  CHECK_GT(packetSize, 0u);
+  readBatch_ = std::make_unique<ReadBatch>(numPackets, packetSize);
+}
+
+uint16_t AsyncUDPSocket::getReadBatchSize() const {
+  return readBatch_ ? uint16_t(readBatch_->msgs.size()) : 0;
+}
+
 bool AsyncUDPSocket::setGRO(bool bVal) {
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
   int val = bVal ? 1 : 0;
@@ -81,6 +81,29 @@ class AsyncUDPSocket : public EventHandler {
         bool truncated,
         OnDataAvailableParams params) noexcept = 0;
 
+    /**
+     * A datagram read by a batched read, see
+     * AsyncUDPSocket::setReadBatching().
+     */
+    struct Datagram {
+      folly::SocketAddress client;
+      // Points into the slab the whole batch was read into
+      std::unique_ptr<folly::IOBuf> data;
+      bool truncated{false};
+      OnDataAvailableParams params;
+    };
+
+    /**
+     * Invoked instead of getReadBuffer() and onDataAvailable() when batched
+     * reads are enabled, with the datagrams read by one recvmmsg() call.
+     * The callback may keep the data IOBufs; the slab they point into is
+     * only reused once all of them have been released.
+     *
+     * The default implementation copies each datagram into a buffer from
+     * getReadBuffer() and passes it to onDataAvailable().
+     */
+    virtual void onDataAvailableBatch(Range<Datagram*> datagrams) noexcept;
+
     /**
      * Notifies when data is available. This is only invoked when
      * shouldNotifyOnly() returns true.
@@ -445,6 +468,29 @@ class AsyncUDPSocket : public EventHandler {
    */
   uint16_t getMaxReadsPerEvent() const { return maxReadsPerEvent_; }
 
+  /**
+   * Read up to numPackets datagrams, of up to packetSize bytes each, with
+   * every recvmmsg() call, and deliver them together to
+   * ReadCallback::onDataAvailableBatch(). The datagrams are read into a
+   * slab of numPackets * packetSize bytes, which is reused across reads,
+   * rather than into a buffer from getReadBuffer() each. maxReadsPerEvent
+   * then bounds the number of recvmmsg() calls per event.
+   *
+   * With GRO enabled, one datagram may hold several segments, so packetSize
+   * should then be large enough for a coalesced datagram (up to 64KB);
+   * anything past packetSize is dropped, as with getReadBuffer().
+   *
+   * @param numPackets  Maximum number of datagrams per read; a value of
+   *                    zero (the default) disables batched reads.
+   */
+  void setReadBatching(uint16_t numPackets, size_t packetSize = 2048);
+
+  /**
+   * Get the maximum number of datagrams per batched read, or zero if
+   * batched reads are disabled.
+   */
+  uint16_t getReadBatchSize() const;
+
   virtual void detachEventBase();
 
   virtual void attachEventBase(folly::EventBase* evb);
@@ -571,6 +617,7 @@ class AsyncUDPSocket : public EventHandler {
   void handlerReady(uint16_t events) noexcept override;
 
   void handleRead() noexcept;
+  void handleReadBatch() noexcept;
   bool updateRegistration() noexcept;
   void maybeUpdateDynamicCmsgs() noexcept;
 
@@ -611,6 +658,10 @@ class AsyncUDPSocket : public EventHandler {
   // packet timestamping
   folly::Optional<int> ts_;
 
+  // Storage for batched reads, non-null only when they are enabled
+  struct ReadBatch;
+  std::unique_ptr<ReadBatch> readBatch_;
+
   ErrMessageCallback* errMessageCallback_{nullptr};
 
   bool zeroCopyEnabled_{false};
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <folly/FileUtil.h>
+#include <folly/ScopeGuard.h>
 #include <folly/system/Pid.h>
 
 namespace folly {
@@ -133,6 +134,39 @@ bool AtomicNotificationQueue<Task>::AtomicQueue::push(
   return pushImpl(std::move(rctx), std::forward<Args>(args)...);
 }
 
+template <typename Task>
+bool AtomicNotificationQueue<Task>::AtomicQueue::pushBatch(
+    std::shared_ptr<RequestContext> rctx, Task* first, Task* last) {
+  if (first == last) {
+    return false;
+  }
+  // Link the batch newest first, like the nodes of the queue itself, and
+  // free it if allocating a node throws.
+  Node* batchHead = nullptr;
+  auto guard = makeGuard([&] { Queue::fromReversed(batchHead); });
+  Node* batchTail = new Node(rctx, std::move(*first));
+  batchHead = batchTail;
+  for (auto task = first + 1; task != last; ++task) {
+    auto node = new Node(rctx, std::move(*task));
+    node->next = batchHead;
+    batchHead = node;
+  }
+  guard.dismiss();
+
+  auto head = head_.load(std::memory_order_relaxed);
+  while (true) {
+    batchTail->next =
+        reinterpret_cast<intptr_t>(head) == kQueueArmedTag ? nullptr : head;
+    if (head_.compare_exchange_weak(
+            head,
+            batchHead,
+            std::memory_order_acq_rel,
+            std::memory_order_relaxed)) {
+      return reinterpret_cast<intptr_t>(head) == kQueueArmedTag;
+    }
+  }
+}
+
 template <typename Task>
 bool AtomicNotificationQueue<Task>::AtomicQueue::hasTasks() const {
   auto head = head_.load(std::memory_order_relaxed);
@@ -220,6 +254,12 @@ bool AtomicNotificationQueue<Task>::push(
   return atomicQueue_.push(std::move(rctx), std::forward<Args>(args)...);
 }
 
+template <typename Task>
+bool AtomicNotificationQueue<Task>::pushBatch(Task* first, Task* last) {
+  pushCount_.fetch_add(last - first, std::memory_order_relaxed);
+  return atomicQueue_.pushBatch(RequestContext::saveContext(), first, last);
+}
+
 template <typename Task>
 typename AtomicNotificationQueue<Task>::TryPushResult
 AtomicNotificationQueue<Task>::tryPush(Task&& task, uint32_t maxSize) {
@@ -20,6 +20,7 @@
 
 #include <folly/io/async/Request.h>
 #include <folly/lang/Align.h>
+#include <folly/memory/SmallObjectAllocator.h>
 
 namespace folly {
 
@@ -94,6 +95,16 @@ class AtomicNotificationQueue {
   template <typename... Args>
   bool push(std::shared_ptr<RequestContext> rctx, Args&&... args);
 
+  /*
+   * Adds a batch of tasks into the queue, moving them out of [first, last),
+   * with a single atomic operation. The tasks are consumed in order and share
+   * the current RequestContext.
+   * Can be called from any thread.
+   * Returns true iff the queue was armed, in which case producers are
+   * expected to notify consumer thread, once for the whole batch.
+   */
+  bool pushBatch(Task* first, Task* last);
+
   /*
    * Attempts adding a task into the queue.
    * Can be called from any thread.
@@ -108,6 +119,23 @@ class AtomicNotificationQueue {
     Task task;
     std::shared_ptr<RequestContext> rctx;
 
+    // Nodes are typically freed on the consumer thread, so they are a fit for
+    // SmallObjectAllocator when the global policy opts in.
+    static void* operator new(std::size_t size) {
+      if constexpr (alignof(Node) > SmallObjectAllocator::kAlign) {
+        return operator_new(size, std::align_val_t(alignof(Node)));
+      } else {
+        return detail::smallObjectAllocate(size);
+      }
+    }
+    static void operator delete(void* p, std::size_t size) noexcept {
+      if constexpr (alignof(Node) > SmallObjectAllocator::kAlign) {
+        operator_delete(p, size, std::align_val_t(alignof(Node)));
+      } else {
+        SmallObjectAllocator::deallocate(p, size);
+      }
+    }
+
    private:
     friend class AtomicNotificationQueue;
 
@@ -205,6 +233,14 @@ class AtomicNotificationQueue {
     template <typename... Args>
     bool push(std::shared_ptr<RequestContext> rctx, Args&&... args);
 
+    /*
+     * Pushes the tasks in [first, last) with a single CAS. Returns true iff
+     * the queue was armed.
+     * Can be called from any thread.
+     */
+    bool pushBatch(
+        std::shared_ptr<RequestContext> rctx, Task* first, Task* last);
+
     /*
      * Returns true if the queue has tasks.
      * Can be called from any thread.
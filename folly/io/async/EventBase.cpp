@@ -22,6 +22,7 @@
 
 #include <fcntl.h>
 
+#include <algorithm>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -35,6 +36,7 @@
 #include <folly/io/async/EventBaseLocal.h>
 #include <folly/io/async/VirtualEventBase.h>
 #include <folly/lang/Assume.h>
+#include <folly/portability/Asm.h>
 #include <folly/portability/Unistd.h>
 #include <folly/synchronization/Baton.h>
 #include <folly/system/ThreadId.h>
@@ -161,18 +163,103 @@ namespace folly {
 class EventBase::FuncRunner {
  public:
   explicit FuncRunner(EventBase& eventBase) : eventBase_(eventBase) {}
-  void operator()(Func&& func) noexcept {
-    ExecutionObserverScopeGuard guard(
-        &eventBase_.getExecutionObserverList(),
-        &func,
-        folly::ExecutionObserver::CallbackType::NotificationQueue);
-    std::exchange(func, {})();
+  void operator()(Func&& func) noexcept;
+
+ private:
+  EventBase& eventBase_;
+};
+
+class EventBase::PriorityLanes : public EventBase::LoopCallback {
+ public:
+  PriorityLanes(EventBase& eventBase, uint32_t backgroundTasksPerLoop)
+      : eventBase_(eventBase) {
+    high_.setMaxReadAtOnce(0);
+    background_.setMaxReadAtOnce(
+        std::max<uint32_t>(backgroundTasksPerLoop, 1));
+  }
+
+  // Can be called from any thread.
+  void add(Func&& fn, bool high) {
+    (high ? high_ : background_).push(std::move(fn));
+    schedule();
   }
 
+  size_t size() const { return high_.size() + background_.size(); }
+
+  // Runs the high priority functions queued so far.
+  void runHigh() noexcept {
+    if (!high_.empty()) {
+      high_.drive(Runner{eventBase_});
+    }
+  }
+
+  // Runs everything, including functions queued by the ones that ran.
+  void drain() noexcept {
+    while (high_.drive(Runner{eventBase_}) ||
+           background_.drive(Runner{eventBase_})) {
+    }
+    cancelLoopCallback();
+    scheduled_.store(false, std::memory_order_relaxed);
+  }
+
+  void runLoopCallback() noexcept override { run(true); }
+
  private:
+  struct Runner {
+    void operator()(Func&& func) noexcept {
+      ExecutionObserverScopeGuard guard(
+          &eventBase.getExecutionObserverList(),
+          &func,
+          folly::ExecutionObserver::CallbackType::NotificationQueue);
+      std::exchange(func, {})();
+    }
+    EventBase& eventBase;
+  };
+
+  // Background work runs as a loop callback, after the I/O and normal
+  // priority work of the iteration.
+  void run(bool runBackground) noexcept {
+    // Pairs with the exchange in schedule(): everything queued before a
+    // producer found the lanes scheduled is visible now.
+    scheduled_.exchange(false, std::memory_order_acq_rel);
+    runHigh();
+    if (runBackground) {
+      background_.drive(Runner{eventBase_});
+    }
+    if ((!high_.empty() || !background_.empty()) &&
+        !scheduled_.exchange(true, std::memory_order_acq_rel)) {
+      eventBase_.runInLoop(this);
+    }
+  }
+
+  // Makes sure run() gets called, once, in the EventBase thread.
+  void schedule() {
+    if (scheduled_.exchange(true, std::memory_order_acq_rel)) {
+      return;
+    }
+    if (eventBase_.inRunningEventBaseThread()) {
+      eventBase_.runInLoop(this);
+    } else {
+      eventBase_.queue_->putMessage([this] { run(false); });
+    }
+  }
+
   EventBase& eventBase_;
+  AtomicNotificationQueue<Func> high_;
+  AtomicNotificationQueue<Func> background_;
+  std::atomic<bool> scheduled_{false};
 };
 
+void EventBase::FuncRunner::operator()(Func&& func) noexcept {
+  // High priority functions jump ahead of the normal priority ones.
+  eventBase_.priorityLanes_->runHigh();
+  ExecutionObserverScopeGuard guard(
+      &eventBase_.getExecutionObserverList(),
+      &func,
+      folly::ExecutionObserver::CallbackType::NotificationQueue);
+  std::exchange(func, {})();
+}
+
 class EventBase::ThreadIdCollector : public WorkerProvider {
  public:
   explicit ThreadIdCollector(EventBase& parent) : parent_(parent) {}
@@ -244,6 +331,11 @@ EventBase::EventBase(Options options)
       ,
       latestLoopCnt_(nextLoopCnt_),
       startWork_(),
+      busyPollMax_(std::max(
+          options.busyPollMax, std::chrono::microseconds::zero())),
+      busyPollBudget_(busyPollMax_),
+      notificationQueueSpin_(std::max(
+          options.notificationQueueSpin, std::chrono::microseconds::zero())),
       observer_(nullptr),
       observerSampleCount_(0),
       evb_(
@@ -251,6 +343,8 @@ EventBase::EventBase(Options options)
                                  : getDefaultBackend()),
       threadIdCollector_(std::make_unique<ThreadIdCollector>(*this)) {
   initNotificationQueue();
+  priorityLanes_ =
+      std::make_unique<PriorityLanes>(*this, options.backgroundTasksPerLoop);
 }
 
 EventBase::~EventBase() {
@@ -305,7 +399,10 @@ EventBase::~EventBase() {
 
   runLoopCallbacks();
 
-  queue_->drain();
+  do {
+    queue_->drain();
+    priorityLanes_->drain();
+  } while (!queue_->empty());
 
   // Stop consumer before deleting NotificationQueue
   queue_->stopConsuming();
@@ -354,7 +451,7 @@ std::unique_ptr<EventBaseBackendBase> EventBase::getDefaultBackend() {
 }
 
 size_t EventBase::getNotificationQueueSize() const {
-  return queue_->size();
+  return queue_->size() + priorityLanes_->size();
 }
 
 size_t EventBase::getNumLoopCallbacks() const {
@@ -549,6 +646,9 @@ EventBase::LoopStatus EventBase::loopMain(int flags, LoopOptions options) {
         applyLoopKeepAlive();
       }
       ++nextLoopCnt_;
+      if (loopProfiling_) {
+        loopProfiler_->loopStarted();
+      }
       // Run the before loop callbacks
       LoopCallbackList callbacks;
       callbacks.swap(runBeforeLoopCallbacks_);
@@ -557,11 +657,19 @@ EventBase::LoopStatus EventBase::loopMain(int flags, LoopOptions options) {
 
     // nobody can add loop callbacks from within this thread if
     // we don't have to handle anything to start with...
+    if (loopProfiling_) {
+      loopProfiler_->waitStarted();
+    }
     if (blocking && loopCallbacks_.empty()) {
-      res = evb_->eb_event_base_loop(EVLOOP_ONCE);
+      if (busyPollMax_.count() == 0 || !busyPoll(res)) {
+        res = evb_->eb_event_base_loop(EVLOOP_ONCE);
+      }
     } else {
       res = evb_->eb_event_base_loop(EVLOOP_ONCE | EVLOOP_NONBLOCK);
     }
+    if (loopProfiling_) {
+      loopProfiler_->waitFinished();
+    }
     if (res == 2) {
       // Only backends with pollable fd support return value 2.
       DCHECK_NE(evb_->getPollableFd(), -1);
@@ -584,6 +692,9 @@ EventBase::LoopStatus EventBase::loopMain(int flags, LoopOptions options) {
     }
 
     bool ranLoopCallbacks = runLoopCallbacks();
+    if (loopProfiling_) {
+      loopProfiler_->loopFinished();
+    }
 
     if (enableTimeMeasurement_) {
       auto now = std::chrono::steady_clock::now();
@@ -600,6 +711,7 @@ EventBase::LoopStatus EventBase::loopMain(int flags, LoopOptions options) {
         if (++observerSampleCount_ >= observer_->getSampleRate()) {
           observerSampleCount_ = 0;
           observer_->loopSample(busy.count(), idle.count());
+          observer_->socketStatsSample(socketStats_.snapshot());
         }
       }
 
@@ -661,6 +773,40 @@ EventBase::LoopStatus EventBase::loopMain(int flags, LoopOptions options) {
   return LoopStatus::kDone;
 }
 
+bool EventBase::busyPoll(int& res) {
+  auto budget = busyPollBudget_;
+  if (budget.count() == 0) {
+    if (++busyPollSkipped_ < kBusyPollProbeInterval) {
+      return false;
+    }
+    busyPollSkipped_ = 0;
+    budget = busyPollMax_ / 16;
+  }
+
+  auto const handled = numHandledEvents_;
+  auto const deadline = std::chrono::steady_clock::now() + budget;
+  bool found = false;
+  do {
+    res = evb_->eb_event_base_loop(EVLOOP_ONCE | EVLOOP_NONBLOCK);
+    if (res != 0 || numHandledEvents_ != handled || !loopCallbacks_.empty() ||
+        stop_.load(std::memory_order_relaxed)) {
+      found = true;
+      break;
+    }
+    asm_volatile_pause();
+  } while (std::chrono::steady_clock::now() < deadline);
+
+  if (found) {
+    busyPollBudget_ =
+        std::min(busyPollMax_, std::max(budget * 2, busyPollMax_ / 16));
+  } else {
+    busyPollBudget_ = budget / 2 < busyPollMax_ / 16
+        ? std::chrono::nanoseconds::zero()
+        : budget / 2;
+  }
+  return found;
+}
+
 void EventBase::loopMainCleanup() {
   threadIdCollector_->awaitOutstandingKeepAlives();
   loopThread_.store({}, std::memory_order_release);
@@ -738,6 +884,7 @@ void EventBase::loopForever() {
 }
 
 void EventBase::bumpHandlingTime() {
+  ++numHandledEvents_;
   if (!enableTimeMeasurement_) {
     return;
   }
@@ -754,6 +901,22 @@ void EventBase::bumpHandlingTime() {
   }
 }
 
+void EventBase::setLoopProfiling(bool enabled) {
+  dcheckIsInEventBaseThread();
+  if (enabled == loopProfiling_) {
+    return;
+  }
+  loopProfiling_ = enabled;
+  if (enabled) {
+    if (!loopProfiler_) {
+      loopProfiler_ = std::make_unique<EventBaseLoopProfiler>();
+    }
+    addExecutionObserver(loopProfiler_.get());
+  } else {
+    removeExecutionObserver(loopProfiler_.get());
+  }
+}
+
 void EventBase::terminateLoopSoon() {
   CHECK(!strictLoopThread_)
       << "terminateLoopSoon() not allowed in strict loop thread mode";
@@ -852,6 +1015,32 @@ void EventBase::runInEventBaseThread(Func fn) noexcept {
   queue_->putMessage(std::move(fn));
 }
 
+void EventBase::runInEventBaseThreadBatch(Range<Func*> fns) noexcept {
+  if (fns.empty()) {
+    return;
+  }
+  auto isNull = [](const Func& fn) { return !fn; };
+  if (std::any_of(fns.begin(), fns.end(), isNull)) {
+    DLOG(FATAL) << "EventBase " << this
+                << ": Scheduling nullptr callbacks is not allowed";
+    for (auto& fn : fns) {
+      if (fn) {
+        runInEventBaseThread(std::move(fn));
+      }
+    }
+    return;
+  }
+
+  if (inRunningEventBaseThread()) {
+    for (auto& fn : fns) {
+      runInLoop(std::move(fn));
+    }
+    return;
+  }
+
+  queue_->putMessages(fns.begin(), fns.end());
+}
+
 void EventBase::runInEventBaseThreadAlwaysEnqueue(Func fn) noexcept {
   // Send the message.
   // It will be received by the FunctionRunner in the EventBase's thread.
@@ -866,6 +1055,19 @@ void EventBase::runInEventBaseThreadAlwaysEnqueue(Func fn) noexcept {
   queue_->putMessage(std::move(fn));
 }
 
+void EventBase::addWithPriority(Cob fn, int8_t priority) {
+  if (priority == MID_PRI) {
+    runInEventBaseThread(std::move(fn));
+    return;
+  }
+  if (!fn) {
+    DLOG(FATAL) << "EventBase " << this
+                << ": Scheduling nullptr callbacks is not allowed";
+    return;
+  }
+  priorityLanes_->add(std::move(fn), priority > MID_PRI);
+}
+
 void EventBase::runInEventBaseThreadAndWait(Func fn) noexcept {
   if (inRunningEventBaseThread()) {
     LOG(DFATAL) << "EventBase " << this << ": Waiting in the event loop is not "
@@ -951,6 +1153,7 @@ void EventBase::initNotificationQueue() {
   // Users can use loopForever() if they do care about the notification queue.
   // (This is useful for EventBase threads that do nothing but process
   // runInEventBaseThread() notifications.)
+  queue_->setSpinBeforeArm(notificationQueueSpin_);
   queue_->startConsumingInternal(this);
 }
 
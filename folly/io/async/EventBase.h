@@ -38,6 +38,7 @@
 #include <folly/Function.h>
 #include <folly/Memory.h>
 #include <folly/Portability.h>
+#include <folly/Range.h>
 #include <folly/ScopeGuard.h>
 #include <folly/Synchronized.h>
 #include <folly/container/F14Map.h>
@@ -49,9 +50,11 @@
 #include <folly/executors/SequencedExecutor.h>
 #include <folly/experimental/ExecutionObserver.h>
 #include <folly/io/async/AsyncTimeout.h>
+#include <folly/io/async/EventBaseLoopProfiler.h>
 #include <folly/io/async/HHWheelTimer.h>
 #include <folly/io/async/Request.h>
 #include <folly/io/async/TimeoutManager.h>
+#include <folly/io/async/observer/EventBaseSocketStats.h>
 #include <folly/portability/Event.h>
 #include <folly/synchronization/CallOnce.h>
 
@@ -79,6 +82,12 @@ class EventBaseObserver {
   virtual uint32_t getSampleRate() const = 0;
 
   virtual void loopSample(int64_t busyTime, int64_t idleTime) = 0;
+
+  /**
+   * Called at the same sample rate as loopSample() with the cumulative socket
+   * I/O counters of the EventBase.
+   */
+  virtual void socketStatsSample(const EventBaseSocketStats::Snapshot&) {}
 };
 
 // Helper class that sets and retrieves the EventBase associated with a given
@@ -311,8 +320,55 @@ class EventBase : public TimeoutManager,
       timerTickInterval = interval;
       return *this;
     }
+
+    /**
+     * Maximum time to busy-poll the backend (i.e. to loop over non-blocking
+     * waits) for new events before blocking in it, or zero (the default) to
+     * always block right away.
+     *
+     * The actual spin budget adapts to how often spinning finds work: it
+     * doubles, up to this maximum, every time it does, and halves every time
+     * it does not, down to zero, in which case only one blocking wait in
+     * kBusyPollProbeInterval spins for a fraction of the maximum, to notice
+     * when spinning becomes worth it again.
+     */
+    std::chrono::microseconds busyPollMax{0};
+
+    Options& setBusyPollMax(std::chrono::microseconds max) {
+      busyPollMax = max;
+      return *this;
+    }
+
+    /**
+     * How long the EventBase thread keeps polling its notification queue
+     * after running the queued functions before arming it again, or zero (the
+     * default) not to spin. While the queue isn't armed, producers calling
+     * runInEventBaseThread() don't write to its eventfd, so under sustained
+     * cross-thread fan-in a short spin saves a syscall per wakeup on both
+     * sides, at the cost of delaying other events by up to the spin time.
+     */
+    std::chrono::microseconds notificationQueueSpin{0};
+
+    Options& setNotificationQueueSpin(std::chrono::microseconds spin) {
+      notificationQueueSpin = spin;
+      return *this;
+    }
+
+    /**
+     * Maximum number of background (negative priority) functions passed to
+     * addWithPriority() that run per loop iteration, so that a flood of
+     * background work can't delay I/O, timeouts or normal priority work.
+     */
+    uint32_t backgroundTasksPerLoop{16};
+
+    Options& setBackgroundTasksPerLoop(uint32_t count) {
+      backgroundTasksPerLoop = count;
+      return *this;
+    }
   };
 
+  static constexpr size_t kBusyPollProbeInterval = 64;
+
   /**
    * Create a new EventBase object.
    *
@@ -636,6 +692,18 @@ class EventBase : public TimeoutManager,
    */
   void runInEventBaseThread(Func fn) noexcept;
 
+  /**
+   * Run the functions in [fns.begin(), fns.end()), in order, in the
+   * EventBase's thread, moving them out of the range.
+   *
+   * Equivalent to calling runInEventBaseThread() for each function, but the
+   * whole batch is enqueued with a single atomic operation and wakes the
+   * EventBase thread at most once.
+   *
+   * The functions must not throw any exceptions.
+   */
+  void runInEventBaseThreadBatch(Range<Func*> fns) noexcept;
+
   /**
    * Run the specified function in the EventBase's thread.
    *
@@ -746,6 +814,14 @@ class EventBase : public TimeoutManager,
    */
   void resetLoadAvg(double value = 0.0);
 
+  /**
+   * The current busy-poll budget, see Options::setBusyPollMax(). Should only
+   * be called from the EventBase thread.
+   */
+  std::chrono::nanoseconds getBusyPollBudget() const {
+    return busyPollBudget_;
+  }
+
   /**
    * Get the average loop time in microseconds (an exponentially-smoothed ave)
    */
@@ -890,6 +966,14 @@ class EventBase : public TimeoutManager,
 
   const std::shared_ptr<EventBaseObserver>& getObserver() { return observer_; }
 
+  /**
+   * Socket I/O counters of all AsyncSockets attached to this EventBase.
+   * Updated from the EventBase thread; snapshots may be taken from any
+   * thread.
+   */
+  EventBaseSocketStats& getSocketStats() { return socketStats_; }
+  const EventBaseSocketStats& getSocketStats() const { return socketStats_; }
+
   /**
    * Setup execution observation/instrumentation for every EventHandler
    * executed in this EventBase.
@@ -911,6 +995,29 @@ class EventBase : public TimeoutManager,
     return executionObserverList_;
   }
 
+  ExecutionObserver::List* getTimeoutExecutionObserverList() final {
+    return &executionObserverList_;
+  }
+
+  /**
+   * Enables or disables the breakdown of loop iterations into backend wait,
+   * timers, loop callbacks, notification queue and I/O handlers; see
+   * EventBaseLoopProfiler. Must be called from the EventBase thread.
+   *
+   * Profiling takes a few clock reads per callback, so it's off by default.
+   * Disabling it keeps the stats collected so far.
+   */
+  void setLoopProfiling(bool enabled);
+
+  /**
+   * The loop profiler, or nullptr if profiling was never enabled. Its stats
+   * can be read from any thread for as long as the EventBase lives.
+   */
+  const EventBaseLoopProfiler* getLoopProfiler() const {
+    return loopProfiler_.get();
+  }
+  EventBaseLoopProfiler* getLoopProfiler() { return loopProfiler_.get(); }
+
   /**
    * Set the name of the thread that runs this event base.
    */
@@ -936,6 +1043,19 @@ class EventBase : public TimeoutManager,
   /// Implements the Executor interface
   void add(Cob fn) override { runInEventBaseThread(std::move(fn)); }
 
+  /**
+   * Implements the Executor interface with three priority lanes.
+   *
+   * MID_PRI (zero) is the same as add(). Functions with a positive priority
+   * go to a high priority lane that is drained before running any further
+   * normal priority function; functions with a negative one go to a
+   * background lane, of which at most Options::backgroundTasksPerLoop run per
+   * loop iteration. Ordering is only preserved within a lane.
+   */
+  void addWithPriority(Cob fn, int8_t priority) override;
+
+  uint8_t getNumPriorities() const override { return 3; }
+
   /// Implements the DrivableExecutor interface
   void drive() override {
     loopKeepAliveCount_.fetch_add(1, std::memory_order_relaxed);
@@ -984,6 +1104,7 @@ class EventBase : public TimeoutManager,
 
  private:
   class FuncRunner;
+  class PriorityLanes;
   class ThreadIdCollector;
 
   static constexpr pid_t kNotRunningTid = -1;
@@ -1015,6 +1136,11 @@ class EventBase : public TimeoutManager,
   LoopStatus loopMain(int flags, LoopOptions options);
   void loopMainCleanup();
 
+  // Spins on the backend for up to the busy-poll budget, and returns whether
+  // that found work, in which case res holds the result of the last
+  // iteration of the backend loop.
+  bool busyPoll(int& res);
+
   void runLoopCallbacks(LoopCallbackList& currentCallbacks);
 
   // executes any callbacks queued by runInLoop(); returns false if none found
@@ -1064,6 +1190,8 @@ class EventBase : public TimeoutManager,
   // A notification queue for runInEventBaseThread() to use
   // to send function requests to the EventBase thread.
   std::unique_ptr<EventBaseAtomicNotificationQueue<Func, FuncRunner>> queue_;
+  // The high priority and background lanes of addWithPriority()
+  std::unique_ptr<PriorityLanes> priorityLanes_;
   std::atomic<size_t> loopKeepAliveCount_{0};
   bool loopKeepAliveActive_{false};
 
@@ -1090,13 +1218,26 @@ class EventBase : public TimeoutManager,
   std::size_t latestLoopCnt_;
   std::chrono::steady_clock::time_point startWork_;
 
+  // Number of events handled, to tell whether a busy-poll iteration did
+  // anything.
+  size_t numHandledEvents_{0};
+  const std::chrono::nanoseconds busyPollMax_;
+  std::chrono::nanoseconds busyPollBudget_;
+  size_t busyPollSkipped_{0};
+  const std::chrono::microseconds notificationQueueSpin_;
+
   // Observer to export counters
   std::shared_ptr<EventBaseObserver> observer_;
   uint32_t observerSampleCount_;
 
+  EventBaseSocketStats socketStats_;
+
   // EventHandler's execution observer list (in case multiple are registered)
   ExecutionObserver::List executionObserverList_;
 
+  std::unique_ptr<EventBaseLoopProfiler> loopProfiler_;
+  bool loopProfiling_{false};
+
   // Name of the thread running this EventBase
   std::string name_;
 
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <folly/FileUtil.h>
+#include <folly/portability/Asm.h>
 #include <folly/system/Pid.h>
 
 namespace folly {
@@ -135,6 +136,14 @@ void EventBaseAtomicNotificationQueue<Task, Consumer>::putMessage(
   }
 }
 
+template <typename Task, typename Consumer>
+void EventBaseAtomicNotificationQueue<Task, Consumer>::putMessages(
+    Task* first, Task* last) {
+  if (notificationQueue_.pushBatch(first, last)) {
+    notifyFd();
+  }
+}
+
 template <typename Task, typename Consumer>
 bool EventBaseAtomicNotificationQueue<Task, Consumer>::tryPutMessage(
     Task&& task, uint32_t maxSize) {
@@ -252,6 +261,10 @@ template <typename Task, typename Consumer>
 void EventBaseAtomicNotificationQueue<Task, Consumer>::
     runLoopCallback() noexcept {
   DCHECK(!armed_);
+  if (spinBeforeArm_.count() > 0 && spinForTasks()) {
+    activateEvent();
+    return;
+  }
   if (!notificationQueue_.arm()) {
     activateEvent();
   } else {
@@ -260,6 +273,18 @@ void EventBaseAtomicNotificationQueue<Task, Consumer>::
   }
 }
 
+template <typename Task, typename Consumer>
+bool EventBaseAtomicNotificationQueue<Task, Consumer>::spinForTasks() {
+  auto const deadline = std::chrono::steady_clock::now() + spinBeforeArm_;
+  do {
+    if (!notificationQueue_.empty()) {
+      return true;
+    }
+    asm_volatile_pause();
+  } while (std::chrono::steady_clock::now() < deadline);
+  return false;
+}
+
 template <typename Task, typename Consumer>
 template <typename T>
 bool EventBaseAtomicNotificationQueue<Task, Consumer>::drive(T&& consumer) {
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <chrono>
+
 #include <folly/io/async/AtomicNotificationQueue.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/io/async/EventHandler.h>
@@ -84,6 +86,13 @@ class EventBaseAtomicNotificationQueue : private EventBase::LoopCallback,
   template <typename... Args>
   void putMessage(Args&&... task);
 
+  /*
+   * Adds the tasks in [first, last) into the queue, moving them out, with at
+   * most one wakeup of the consumer thread for the whole batch.
+   * Can be called from any thread.
+   */
+  void putMessages(Task* first, Task* last);
+
   /**
    * Adds a task into the queue unless the max queue size is reached.
    * Returns true iff the task was queued.
@@ -91,6 +100,18 @@ class EventBaseAtomicNotificationQueue : private EventBase::LoopCallback,
    */
   FOLLY_NODISCARD bool tryPutMessage(Task&& task, uint32_t maxSize);
 
+  /*
+   * Sets how long the consumer polls for new tasks after running a round,
+   * before arming the queue. Producers only write to the eventfd when the
+   * queue is armed, so under a steady stream of tasks spinning saves both
+   * the writes and the event loop wakeups, at the cost of delaying other
+   * events by up to the spin time. Zero, the default, disables spinning.
+   * Can be called from consumer thread only.
+   */
+  void setSpinBeforeArm(std::chrono::nanoseconds spin) {
+    spinBeforeArm_ = spin;
+  }
+
   /*
    * Detaches the queue from an EventBase.
    * Can be called from consumer thread only.
@@ -150,6 +171,11 @@ class EventBaseAtomicNotificationQueue : private EventBase::LoopCallback,
 
   void startConsumingImpl(EventBase* evb, bool internal);
 
+  /*
+   * Polls for new tasks for up to spinBeforeArm_, returns true if any came.
+   */
+  bool spinForTasks();
+
   void handlerReady(uint16_t) noexcept override;
 
   void activateEvent();
@@ -189,6 +215,7 @@ class EventBaseAtomicNotificationQueue : private EventBase::LoopCallback,
   ssize_t writesLocal_{0};
   bool armed_{false};
   bool edgeTriggeredSet_{false};
+  std::chrono::nanoseconds spinBeforeArm_{0};
 };
 
 } // namespace folly
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/EventBaseLoopProfiler.h>
+
+namespace folly {
+
+namespace {
+
+EventBaseLoopProfiler::Phase phaseOf(
+    ExecutionObserver::CallbackType callbackType,
+    EventBaseLoopProfiler::Phase current) {
+  using Phase = EventBaseLoopProfiler::Phase;
+  switch (callbackType) {
+    case ExecutionObserver::CallbackType::Event:
+      return Phase::IoHandlers;
+    case ExecutionObserver::CallbackType::Loop:
+      return Phase::LoopCallbacks;
+    case ExecutionObserver::CallbackType::NotificationQueue:
+      return Phase::NotificationQueue;
+    case ExecutionObserver::CallbackType::Timeout:
+      return Phase::Timers;
+    case ExecutionObserver::CallbackType::Fiber:
+      break;
+  }
+  return current;
+}
+
+} // namespace
+
+const char* EventBaseLoopProfiler::getPhaseName(Phase phase) {
+  switch (phase) {
+    case Phase::Wait:
+      return "wait";
+    case Phase::Timers:
+      return "timers";
+    case Phase::LoopCallbacks:
+      return "loop_callbacks";
+    case Phase::NotificationQueue:
+      return "notification_queue";
+    case Phase::IoHandlers:
+      return "io_handlers";
+    case Phase::Other:
+      return "other";
+  }
+  return "unknown";
+}
+
+void EventBaseLoopProfiler::switchTo(Phase phase) noexcept {
+  auto now = Clock::now();
+  iterationNanos_[size_t(current_)] += uint64_t(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastSwitch_)
+          .count());
+  lastSwitch_ = now;
+  current_ = phase;
+}
+
+void EventBaseLoopProfiler::enter(Phase phase) noexcept {
+  if (depth_ < kMaxDepth) {
+    stack_[depth_] = current_;
+  }
+  ++depth_;
+  switchTo(phase);
+}
+
+void EventBaseLoopProfiler::leave() noexcept {
+  if (depth_ == 0) {
+    // Enabled from within a callback.
+    switchTo(Phase::Other);
+    return;
+  }
+  --depth_;
+  switchTo(depth_ < kMaxDepth ? stack_[depth_] : current_);
+}
+
+void EventBaseLoopProfiler::starting(
+    uintptr_t, CallbackType callbackType) noexcept {
+  enter(phaseOf(callbackType, current_));
+}
+
+void EventBaseLoopProfiler::stopped(uintptr_t, CallbackType) noexcept {
+  leave();
+}
+
+void EventBaseLoopProfiler::loopStarted() noexcept {
+  // Callbacks never span iterations; forget any left open by enabling or
+  // disabling the profiler from within one.
+  switchTo(Phase::Other);
+  depth_ = 0;
+  iterationNanos_.fill(0);
+  loopStart_ = lastSwitch_;
+}
+
+void EventBaseLoopProfiler::loopFinished() noexcept {
+  switchTo(current_);
+  for (size_t i = 0; i < kNumPhases; ++i) {
+    histograms_[i].addValue(iterationNanos_[i]);
+    totalNanos_[i].fetch_add(iterationNanos_[i], std::memory_order_relaxed);
+  }
+  auto iteration = uint64_t(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          lastSwitch_ - loopStart_)
+          .count());
+  iterationHistogram_.addValue(iteration);
+  iterationTotalNanos_.fetch_add(iteration, std::memory_order_relaxed);
+  loops_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EventBaseLoopProfiler::record(
+    const Histogram& histogram, PhaseStats& stats) {
+  auto estimate = [&](double q) {
+    return std::chrono::nanoseconds(histogram.estimateQuantile(q));
+  };
+  stats.p50 = estimate(0.5);
+  stats.p90 = estimate(0.9);
+  stats.p99 = estimate(0.99);
+  stats.max = estimate(1.0);
+}
+
+EventBaseLoopProfiler::Stats EventBaseLoopProfiler::getStats() const {
+  Stats stats;
+  stats.loops = loops_.load(std::memory_order_relaxed);
+  stats.iteration.total = std::chrono::nanoseconds(
+      iterationTotalNanos_.load(std::memory_order_relaxed));
+  record(iterationHistogram_, stats.iteration);
+  for (size_t i = 0; i < kNumPhases; ++i) {
+    stats.phases[i].total = std::chrono::nanoseconds(
+        totalNanos_[i].load(std::memory_order_relaxed));
+    record(histograms_[i], stats.phases[i]);
+  }
+  return stats;
+}
+
+void EventBaseLoopProfiler::reset() {
+  loops_.store(0, std::memory_order_relaxed);
+  iterationHistogram_.clear();
+  iterationTotalNanos_.store(0, std::memory_order_relaxed);
+  for (size_t i = 0; i < kNumPhases; ++i) {
+    histograms_[i].clear();
+    totalNanos_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+} // namespace folly
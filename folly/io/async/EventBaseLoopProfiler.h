@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <folly/experimental/ExecutionObserver.h>
+#include <folly/stats/LogLinearHistogram.h>
+
+namespace folly {
+
+/**
+ * Breaks down where the time of EventBase loop iterations goes.
+ *
+ * Enabled with EventBase::setLoopProfiling(). Each loop iteration is split
+ * into the phases below. Time spent in nested callbacks is only charged to the
+ * innermost one: functions run by the notification queue when its event fires
+ * count as NotificationQueue, not IoHandlers. The per-iteration time of every
+ * phase is recorded in a histogram, so a bad p99 loop time can be traced back
+ * to timers, cross-thread messages or I/O handlers.
+ *
+ * The profiler is updated from the EventBase thread only; getStats() and
+ * reset() may be called from any thread.
+ */
+class EventBaseLoopProfiler : public ExecutionObserver {
+ public:
+  enum class Phase : uint8_t {
+    // Waiting for events in the backend, e.g. in epoll_wait().
+    Wait,
+    // AsyncTimeout callbacks, including the HHWheelTimer ones.
+    Timers,
+    // runInLoop() and runBeforeLoop() callbacks.
+    LoopCallbacks,
+    // Functions passed to runInEventBaseThread() and friends.
+    NotificationQueue,
+    // EventHandler callbacks, e.g. socket reads and writes.
+    IoHandlers,
+    // Loop bookkeeping outside of all the above.
+    Other,
+  };
+  static constexpr size_t kNumPhases = 6;
+
+  static const char* getPhaseName(Phase phase);
+
+  struct PhaseStats {
+    std::chrono::nanoseconds total{0};
+    // Per-iteration time, estimated from the histogram.
+    std::chrono::nanoseconds p50{0};
+    std::chrono::nanoseconds p90{0};
+    std::chrono::nanoseconds p99{0};
+    std::chrono::nanoseconds max{0};
+  };
+
+  struct Stats {
+    uint64_t loops{0};
+    // Whole iterations.
+    PhaseStats iteration;
+    std::array<PhaseStats, kNumPhases> phases;
+
+    const PhaseStats& operator[](Phase phase) const {
+      return phases[size_t(phase)];
+    }
+  };
+
+  Stats getStats() const;
+
+  void reset();
+
+  // Called by EventBase around each loop iteration and backend wait.
+  void loopStarted() noexcept;
+  void loopFinished() noexcept;
+  void waitStarted() noexcept { enter(Phase::Wait); }
+  void waitFinished() noexcept { leave(); }
+
+  // ExecutionObserver
+  void starting(uintptr_t id, CallbackType callbackType) noexcept override;
+  void stopped(uintptr_t id, CallbackType callbackType) noexcept override;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  // Per-iteration times in nanoseconds, with 3% precision.
+  using Histogram = LogLinearHistogram<5>;
+
+  void enter(Phase phase) noexcept;
+  void leave() noexcept;
+  void switchTo(Phase phase) noexcept;
+  static void record(const Histogram& histogram, PhaseStats& stats);
+
+  // EventBase thread state.
+  static constexpr size_t kMaxDepth = 32;
+  Phase current_{Phase::Other};
+  Clock::time_point lastSwitch_{Clock::now()};
+  Clock::time_point loopStart_{lastSwitch_};
+  std::array<uint64_t, kNumPhases> iterationNanos_{};
+  // Phases to return to; deeper nesting than kMaxDepth stays in the
+  // innermost tracked phase.
+  std::array<Phase, kMaxDepth> stack_{};
+  size_t depth_{0};
+
+  std::atomic<uint64_t> loops_{0};
+  Histogram iterationHistogram_;
+  std::array<std::atomic<uint64_t>, kNumPhases> totalNanos_{};
+  std::array<Histogram, kNumPhases> histograms_;
+  std::atomic<uint64_t> iterationTotalNanos_{0};
+};
+
+} // namespace folly
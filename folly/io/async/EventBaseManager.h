@@ -100,6 +100,18 @@ class EventBaseManager {
    */
   void clearEventBase();
 
+  /**
+   * The options with which getEventBase() creates EventBases.
+   */
+  const folly::EventBase::Options& getOptions() const { return options_; }
+
+  /**
+   * The observer set on the EventBases created by getEventBase(), if any.
+   */
+  const std::shared_ptr<folly::EventBaseObserver>& getObserver() const {
+    return observer_;
+  }
+
  private:
   struct EventBaseInfo {
     EventBaseInfo(EventBase* evb, bool owned)
@@ -71,6 +71,14 @@ void HHWheelTimerBase<Duration>::Callback::setScheduled(
 
 template <class Duration>
 void HHWheelTimerBase<Duration>::Callback::cancelTimeoutImpl() {
+  if (timeoutBucket_) {
+    unlink();
+    wheel_->removeFromTimeoutBucket(*timeoutBucket_);
+    timeoutBucket_ = nullptr;
+    wheel_ = nullptr;
+    expiration_ = {};
+    return;
+  }
   if (--wheel_->count_ <= 0) {
     assert(wheel_->count_ == 0);
     wheel_->AsyncTimeout::cancelTimeout();
@@ -152,6 +160,16 @@ void HHWheelTimerBase<Duration>::scheduleTimeout(
     Callback* callback, Duration timeout) {
   // Make sure that the timeout is not negative.
   timeout = std::max(timeout, Duration::zero());
+  if (timeoutBucketsEnabled_) {
+    scheduleTimeoutInBucket(callback, timeout);
+  } else {
+    scheduleTimeoutInWheel(callback, timeout);
+  }
+}
+
+template <class Duration>
+void HHWheelTimerBase<Duration>::scheduleTimeoutInWheel(
+    Callback* callback, Duration timeout) {
   // Cancel the callback if it happens to be scheduled already.
   callback->cancelTimeout();
   callback->requestContext_ = RequestContext::saveContext();
@@ -195,6 +213,78 @@ void HHWheelTimerBase<Duration>::scheduleTimeout(
   }
 }
 
+template <class Duration>
+void HHWheelTimerBase<Duration>::scheduleTimeoutInBucket(
+    Callback* callback, Duration timeout) {
+  callback->cancelTimeout();
+  callback->requestContext_ = RequestContext::saveContext();
+
+  auto& bucket = timeoutBuckets_[timeout.count()];
+  if (!bucket) {
+    bucket = std::make_unique<TimeoutBucket>(*this);
+    bucket->isTimeoutBucket_ = true;
+  }
+
+  // All the callbacks in a bucket have the same timeout, so appending keeps
+  // them in expiration order.
+  callback->setScheduled(this, getCurTime() + timeout);
+  callback->timeoutBucket_ = bucket.get();
+  bucket->callbacks_.push_back(*callback);
+  ++bucketedCount_;
+
+  if (!bucket->isScheduled()) {
+    scheduleTimeoutInWheel(bucket.get(), timeout);
+    bucket->requestContext_.reset();
+    ++activeTimeoutBuckets_;
+  }
+}
+
+template <class Duration>
+void HHWheelTimerBase<Duration>::expireTimeoutBucket(TimeoutBucket& bucket) {
+  // Called from timeoutExpired(), which already took the bucket out of the
+  // wheel: move the callbacks that are due over to timeoutsToRunNow_, where
+  // it runs them, and schedule the bucket again for the next one.
+  --activeTimeoutBuckets_;
+  auto now = getCurTime();
+  auto& callbacks = bucket.callbacks_;
+  while (!callbacks.empty()) {
+    auto& cb = callbacks.front();
+    if (timeToWheelTicks(cb.getTimeRemaining(now)) > 0) {
+      break;
+    }
+    callbacks.pop_front();
+    cb.timeoutBucket_ = nullptr;
+    --bucketedCount_;
+    ++count_;
+    timeoutsToRunNow_.push_back(cb);
+  }
+
+  if (!callbacks.empty()) {
+    scheduleTimeoutInWheel(&bucket, callbacks.front().getTimeRemaining(now));
+    bucket.requestContext_.reset();
+    ++activeTimeoutBuckets_;
+  }
+}
+
+template <class Duration>
+void HHWheelTimerBase<Duration>::cancelTimeoutBucket(TimeoutBucket& bucket) {
+  // cancelAll() takes the buckets out of the wheel without cancelling them,
+  // so this is only reached if the bucket is cancelled some other way.
+  --activeTimeoutBuckets_;
+  CallbackList callbacks;
+  callbacks.swap(bucket.callbacks_);
+  cancelTimeoutsFromList(callbacks);
+}
+
+template <class Duration>
+void HHWheelTimerBase<Duration>::removeFromTimeoutBucket(TimeoutBucket& bucket) {
+  --bucketedCount_;
+  if (bucket.callbacks_.empty() && bucket.isScheduled()) {
+    bucket.cancelTimeout();
+    --activeTimeoutBuckets_;
+  }
+}
+
 template <class Duration>
 void HHWheelTimerBase<Duration>::scheduleTimeout(Callback* callback) {
   CHECK(Duration(-1) != defaultTimeout_)
@@ -304,39 +394,89 @@ void HHWheelTimerBase<Duration>::timeoutExpired() noexcept {
 
 template <class Duration>
 size_t HHWheelTimerBase<Duration>::cancelAll() {
-  size_t count = 0;
+  // Detach every list before running any callbackCanceled(), which may
+  // schedule new timeouts: those must be neither cancelled nor counted.
+  std::unique_ptr<CallbackList[]> bucketed;
+  size_t numBucketed = 0;
+  if (bucketedCount_ != 0) {
+    bucketed = std::make_unique<CallbackList[]>(timeoutBuckets_.size());
+    for (auto& entry : timeoutBuckets_) {
+      auto& bucket = *entry.second;
+      bucketed[numBucketed++].swap(bucket.callbacks_);
+      // The bucket itself is no user timeout, take it out of the wheel
+      // quietly rather than through callbackCanceled().
+      if (bucket.isScheduled()) {
+        bucket.cancelTimeout();
+        --activeTimeoutBuckets_;
+      }
+    }
+  }
 
+  std::unique_ptr<CallbackList[]> buckets;
+  size_t countBuckets = 0;
+  CallbackList timeoutsToRunNow;
   if (count_ != 0) {
     const std::size_t numElements = WHEEL_BUCKETS * WHEEL_SIZE;
     auto maxBuckets = std::min(numElements, count_);
-    auto buckets = std::make_unique<CallbackList[]>(maxBuckets);
-    size_t countBuckets = 0;
+    buckets = std::make_unique<CallbackList[]>(maxBuckets);
+    size_t seen = 0;
     for (auto& tick : buckets_) {
       for (auto& bucket : tick) {
         if (bucket.empty()) {
           continue;
         }
-        count += bucket.size();
+        seen += bucket.size();
         std::swap(bucket, buckets[countBuckets++]);
-        if (count >= count_) {
+        if (seen >= count_) {
           break;
         }
       }
     }
-
-    for (size_t i = 0; i < countBuckets; ++i) {
-      cancelTimeoutsFromList(buckets[i]);
-    }
     // Swap the list to prevent potential recursion if cancelAll is called by
     // one of the callbacks.
-    CallbackList timeoutsToRunNow;
     timeoutsToRunNow.swap(timeoutsToRunNow_);
-    count += cancelTimeoutsFromList(timeoutsToRunNow);
   }
 
+  size_t count = 0;
+  for (size_t i = 0; i < numBucketed; ++i) {
+    count += cancelTimeoutsFromList(bucketed[i]);
+  }
+  for (size_t i = 0; i < countBuckets; ++i) {
+    count += cancelTimeoutsFromList(buckets[i]);
+  }
+  count += cancelTimeoutsFromList(timeoutsToRunNow);
   return count;
 }
 
+template <class Duration>
+size_t HHWheelTimerBase<Duration>::cancelAll(
+    FunctionRef<bool(Callback&)> pred) {
+  // Collect the matching callbacks before cancelling any, as their
+  // callbackCanceled() may schedule or cancel other timeouts.
+  CallbackList matched;
+  auto extract = [&](CallbackList& list) {
+    for (auto it = list.begin(); it != list.end();) {
+      auto& cb = *it++;
+      if (!cb.isTimeoutBucket_ && pred(cb)) {
+        cb.unlink();
+        matched.push_back(cb);
+      }
+    }
+  };
+
+  for (auto& tick : buckets_) {
+    for (auto& bucket : tick) {
+      extract(bucket);
+    }
+  }
+  for (auto& entry : timeoutBuckets_) {
+    extract(entry.second->callbacks_);
+  }
+  extract(timeoutsToRunNow_);
+
+  return cancelTimeoutsFromList(matched);
+}
+
 template <class Duration>
 void HHWheelTimerBase<Duration>::scheduleNextTimeout(int64_t nextTick) {
   int64_t tick = 1;
@@ -20,11 +20,13 @@
 #include <chrono>
 #include <cstddef>
 #include <memory>
+#include <unordered_map>
 
 #include <boost/intrusive/list.hpp>
 #include <glog/logging.h>
 
 #include <folly/ExceptionString.h>
+#include <folly/Function.h>
 #include <folly/Optional.h>
 #include <folly/io/async/AsyncTimeout.h>
 #include <folly/io/async/DelayedDestruction.h>
@@ -129,6 +131,8 @@ struct HHWheelTimerDurationConst<std::chrono::microseconds> {
 template <class Duration>
 class HHWheelTimerBase : private folly::AsyncTimeout,
                          public folly::DelayedDestruction {
+  class TimeoutBucket;
+
  public:
   using UniquePtr = std::unique_ptr<HHWheelTimerBase, Destructor>;
   using SharedPtr = std::shared_ptr<HHWheelTimerBase>;
@@ -202,6 +206,10 @@ class HHWheelTimerBase : private folly::AsyncTimeout,
     HHWheelTimerBase* wheel_{nullptr};
     std::chrono::steady_clock::time_point expiration_{};
     int bucket_{-1};
+    // Set for the timeout buckets themselves, see setTimeoutBucketsEnabled()
+    bool isTimeoutBucket_{false};
+    // The timeout bucket this callback is waiting in, if any
+    TimeoutBucket* timeoutBucket_{nullptr};
 
     typedef boost::intrusive::
         list<Callback, boost::intrusive::constant_time_size<false>>
@@ -237,6 +245,13 @@ class HHWheelTimerBase : private folly::AsyncTimeout,
    */
   size_t cancelAll();
 
+  /**
+   * Cancel the outstanding timeouts for which `pred` returns true.
+   *
+   * @returns the number of timeouts that were cancelled.
+   */
+  size_t cancelAll(FunctionRef<bool(Callback&)> pred);
+
   /**
    * Get the tick interval for this HHWheelTimerBase.
    *
@@ -256,6 +271,25 @@ class HHWheelTimerBase : private folly::AsyncTimeout,
    */
   void setDefaultTimeout(Duration timeout) { defaultTimeout_ = timeout; }
 
+  /**
+   * Enable or disable timeout buckets; they are disabled by default.
+   *
+   * With timeout buckets, the callbacks scheduled with the same timeout
+   * interval share one list, in expiration order, and only the head of each
+   * list is kept in the wheel. Callbacks then never cascade between the
+   * wheel's levels, which helps with many long timeouts of a few fixed
+   * intervals, such as idle connection timeouts.
+   *
+   * Each distinct interval keeps its list for the lifetime of the timer, so
+   * this is not meant for arbitrary intervals. Enabling or disabling timeout
+   * buckets only affects the callbacks scheduled from then on.
+   */
+  void setTimeoutBucketsEnabled(bool enabled) {
+    timeoutBucketsEnabled_ = enabled;
+  }
+
+  bool getTimeoutBucketsEnabled() const { return timeoutBucketsEnabled_; }
+
   /**
    * Schedule the specified Callback to be invoked after the
    * specified timeout interval.
@@ -299,7 +333,9 @@ class HHWheelTimerBase : private folly::AsyncTimeout,
   /**
    * Return the number of currently pending timeouts
    */
-  std::size_t count() const { return count_; }
+  std::size_t count() const {
+    return count_ + bucketedCount_ - activeTimeoutBuckets_;
+  }
 
   bool isDetachable() const { return !folly::AsyncTimeout::isScheduled(); }
 
@@ -335,6 +371,7 @@ class HHWheelTimerBase : private folly::AsyncTimeout,
 
   typedef typename Callback::List CallbackList;
   CallbackList buckets_[WHEEL_BUCKETS][WHEEL_SIZE];
+
   std::array<std::size_t, (WHEEL_SIZE / sizeof(std::size_t)) / 8> bitmap_;
 
   int64_t timeToWheelTicks(Duration t) { return interval_.toWheelTicks(t); }
@@ -394,6 +431,41 @@ class HHWheelTimerBase : private folly::AsyncTimeout,
   // to cancel them.
   CallbackList timeoutsToRunNow_;
 
+  /**
+   * The callbacks scheduled with one timeout interval, in expiration order.
+   * The bucket itself is scheduled in the wheel for the head's expiration
+   * while it is not empty.
+   */
+  class TimeoutBucket : public Callback {
+   public:
+    explicit TimeoutBucket(HHWheelTimerBase& timer) : timer_(timer) {}
+
+    void timeoutExpired() noexcept override {
+      timer_.expireTimeoutBucket(*this);
+    }
+
+    void callbackCanceled() noexcept override {
+      timer_.cancelTimeoutBucket(*this);
+    }
+
+    HHWheelTimerBase& timer_;
+    CallbackList callbacks_;
+  };
+
+  bool timeoutBucketsEnabled_{false};
+  std::unordered_map<typename Duration::rep, std::unique_ptr<TimeoutBucket>>
+      timeoutBuckets_;
+  // Callbacks waiting in timeout buckets, which count_ leaves out
+  std::size_t bucketedCount_{0};
+  // Timeout buckets scheduled in the wheel, which count_ includes
+  std::size_t activeTimeoutBuckets_{0};
+
+  void scheduleTimeoutInWheel(Callback* callback, Duration timeout);
+  void scheduleTimeoutInBucket(Callback* callback, Duration timeout);
+  void expireTimeoutBucket(TimeoutBucket& bucket);
+  void cancelTimeoutBucket(TimeoutBucket& bucket);
+  void removeFromTimeoutBucket(TimeoutBucket& bucket);
+
   std::chrono::steady_clock::time_point getCurTime() {
     return std::chrono::steady_clock::now();
   }
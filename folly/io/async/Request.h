@@ -290,6 +290,25 @@ class RequestContext {
     return getStaticContext().requestContext;
   }
 
+  // Fast paths for callers that keep the context alive in a shared_ptr of
+  // their own while it is set, such as suspended fibers. When ctx already is
+  // the current context they only compare raw pointers, and no reference
+  // count is touched and no onSet()/onUnset() is called.
+  //
+  // setContextIfChanged(ctx) is setContext(ctx), discarding the previous
+  // context. saveContextIfChanged(ctx) is ctx = saveContext().
+  static void setContextIfChanged(std::shared_ptr<RequestContext> const& ctx) {
+    if (ctx.get() != getStaticContext().requestContext.get()) {
+      setContext(ctx);
+    }
+  }
+  static void saveContextIfChanged(std::shared_ptr<RequestContext>& ctx) {
+    auto& current = getStaticContext().requestContext;
+    if (ctx.get() != current.get()) {
+      ctx = current;
+    }
+  }
+
  private:
   struct Tag {};
   RequestContext(const RequestContext& ctx) = default;
@@ -364,6 +383,8 @@ class RequestContext {
   // StaticContext object is not destroyed.
   static StaticContextAccessor accessAllThreads();
 
+  friend class PinnedRequestContextScopeGuard;
+
   // Start shallow copy guard implementation details:
   // All methods are private to encourage proper use
   friend struct ShallowCopyRequestContextScopeGuard;
@@ -508,6 +529,44 @@ class RequestContextScopeGuard {
   ~RequestContextScopeGuard() { RequestContext::setContext(std::move(prev_)); }
 };
 
+/**
+ * Like RequestContextScopeGuard(ctx), for a ctx that the caller keeps alive
+ * until the guard is destroyed, e.g. in a coroutine frame. When ctx already
+ * is the current context the guard does nothing at all, so hops that stay
+ * within one request cost no reference counting.
+ *
+ * The context is only restored if the guard changed it, so the scope must
+ * leave the context as it found it.
+ */
+class PinnedRequestContextScopeGuard {
+ private:
+  std::shared_ptr<RequestContext> prev_;
+  bool changed_{false};
+
+ public:
+  PinnedRequestContextScopeGuard(const PinnedRequestContextScopeGuard&) =
+      delete;
+  PinnedRequestContextScopeGuard& operator=(
+      const PinnedRequestContextScopeGuard&) = delete;
+  PinnedRequestContextScopeGuard(PinnedRequestContextScopeGuard&&) = delete;
+  PinnedRequestContextScopeGuard& operator=(PinnedRequestContextScopeGuard&&) =
+      delete;
+
+  explicit PinnedRequestContextScopeGuard(
+      std::shared_ptr<RequestContext> const& ctx) {
+    if (ctx.get() != RequestContext::getStaticContext().requestContext.get()) {
+      prev_ = RequestContext::setContext(ctx);
+      changed_ = true;
+    }
+  }
+
+  ~PinnedRequestContextScopeGuard() {
+    if (changed_) {
+      RequestContext::setContext(std::move(prev_));
+    }
+  }
+};
+
 /**
  * This guard maintains all the RequestData pointers of the parent.
  * This allows to overwrite a specific RequestData pointer for the
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/Executor.h>
+#include <folly/Function.h>
+#include <folly/io/async/SSLContext.h>
+
+namespace folly {
+
+/**
+ * Runs SSL_accept on an executor, e.g. a CPUThreadPoolExecutor, so that the
+ * private key operations of server handshakes (RSA or ECDSA signing, a
+ * millisecond or more each) don't stall the other connections served by the
+ * socket's EventBase thread. AsyncSSLSocket carries the result, errno and the
+ * OpenSSL errors back to its EventBase thread before handling them.
+ *
+ * The callbacks that OpenSSL invokes during the handshake run on the executor
+ * too, and must be thread safe: the SSLContext's SNI, session cache and ticket
+ * callbacks, and the socket's HandshakeCB::handshakeVer().
+ *
+ * Example:
+ *   serverCtx->sslAcceptRunner(
+ *       std::make_unique<SSLAcceptExecutorRunner>(getGlobalCPUExecutor()));
+ */
+class SSLAcceptExecutorRunner : public SSLAcceptRunner {
+ public:
+  explicit SSLAcceptExecutorRunner(Executor::KeepAlive<> executor)
+      : executor_(std::move(executor)) {}
+  ~SSLAcceptExecutorRunner() override = default;
+
+  void run(Function<int()> acceptFunc, Function<void(int)> finallyFunc)
+      const override {
+    executor_->add([acceptFunc = std::move(acceptFunc),
+                    finallyFunc = std::move(finallyFunc)]() mutable {
+      finallyFunc(acceptFunc());
+    });
+  }
+
+ private:
+  Executor::KeepAlive<> executor_;
+};
+
+} // namespace folly
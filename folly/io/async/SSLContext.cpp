@@ -24,6 +24,7 @@
 #include <folly/ssl/OpenSSLTicketHandler.h>
 #include <folly/ssl/PasswordCollector.h>
 #include <folly/ssl/SSLSessionManager.h>
+#include <folly/ssl/ServerSessionCache.h>
 #include <folly/system/ThreadId.h>
 
 // ---------------------------------------------------------------------
@@ -849,6 +850,11 @@ int SSLContext::newSessionCallback(SSL* ssl, SSL_SESSION* session) {
     cb->onNewSession(ssl, std::move(sessionPtr));
   }
 
+  if (context->serverSessionCache_ && SSL_is_server(ssl)) {
+    SSL_SESSION_up_ref(session);
+    context->serverSessionCache_->add(folly::ssl::SSLSessionUniquePtr(session));
+  }
+
   // Session will either be moved to session manager or
   // freed when the unique_ptr goes out of scope
   auto sessionPtr = folly::ssl::SSLSessionUniquePtr(session);
@@ -865,6 +871,36 @@ void SSLContext::setSessionLifecycleCallbacks(
   sessionLifecycleCallbacks_ = std::move(cb);
 }
 
+void SSLContext::setServerSessionCache(
+    std::shared_ptr<ssl::ServerSessionCache> cache) {
+  serverSessionCache_ = std::move(cache);
+  SSL_CTX_sess_set_get_cb(ctx_, SSLContext::getSessionCallback);
+  SSL_CTX_sess_set_remove_cb(ctx_, SSLContext::removeSessionCallback);
+}
+
+SSL_SESSION* SSLContext::getSessionCallback(
+    SSL* ssl, const unsigned char* sessionId, int idLength, int* copy) {
+  SSLContext* context = getFromSSLCtx(SSL_get_SSL_CTX(ssl));
+  // The returned reference is handed over to OpenSSL.
+  *copy = 0;
+  if (!context->serverSessionCache_) {
+    return nullptr;
+  }
+  return context->serverSessionCache_
+      ->get(ByteRange(sessionId, size_t(idLength)))
+      .release();
+}
+
+void SSLContext::removeSessionCallback(SSL_CTX* ctx, SSL_SESSION* session) {
+  SSLContext* context = getFromSSLCtx(ctx);
+  if (!context || !context->serverSessionCache_) {
+    return;
+  }
+  unsigned int idLength = 0;
+  const unsigned char* id = SSL_SESSION_get_id(session, &idLength);
+  context->serverSessionCache_->remove(ByteRange(id, idLength));
+}
+
 
 void SSLContext::setCiphersuitesOrThrow(const std::string& ciphersuites) {
   auto rc = SSL_CTX_set_ciphersuites(ctx_, ciphersuites.c_str());
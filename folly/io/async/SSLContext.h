@@ -40,7 +40,8 @@ namespace folly {
 class OpenSSLTicketHandler;
 namespace ssl {
 class PasswordCollector;
-}
+class ServerSessionCache;
+} // namespace ssl
 
 /**
  * Run SSL_accept via a runner
@@ -52,7 +53,8 @@ class SSLAcceptRunner {
   /**
    * This is expected to run the first function and provide its return
    * value to the second function. This can be used to run the SSL_accept
-   * in different contexts.
+   * in different contexts, including on another thread: see
+   * SSLAcceptExecutorRunner.
    */
   virtual void run(
       Function<int()> acceptFunc, Function<void(int)> finallyFunc) const {
@@ -646,6 +648,20 @@ class SSLContext {
   void setSessionLifecycleCallbacks(
       std::unique_ptr<SessionLifecycleCallbacks> cb);
 
+  /**
+   * Caches the sessions of server connections in the given cache, from which
+   * clients can resume them by session ID, or by TLS 1.3 ticket if tickets
+   * are stateful (SSL_OP_NO_TICKET). Without one, server connections can
+   * only be resumed by stateless ticket. The cache may be shared by several
+   * SSLContexts.
+   */
+  void setServerSessionCache(std::shared_ptr<ssl::ServerSessionCache> cache);
+
+  const std::shared_ptr<ssl::ServerSessionCache>& getServerSessionCache()
+      const {
+    return serverSessionCache_;
+  }
+
 
   /**
    * Set the TLS 1.3 ciphersuites to be used in the SSL handshake, in
@@ -738,7 +754,12 @@ class SSLContext {
   std::unique_ptr<SessionLifecycleCallbacks> sessionLifecycleCallbacks_{
       nullptr};
 
+  std::shared_ptr<ssl::ServerSessionCache> serverSessionCache_;
+
   static int newSessionCallback(SSL* ssl, SSL_SESSION* session);
+  static SSL_SESSION* getSessionCallback(
+      SSL* ssl, const unsigned char* sessionId, int idLength, int* copy);
+  static void removeSessionCallback(SSL_CTX* ctx, SSL_SESSION* session);
 };
 
 typedef std::shared_ptr<SSLContext> SSLContextPtr;
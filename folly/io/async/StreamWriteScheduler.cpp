@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/StreamWriteScheduler.h>
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+namespace folly {
+
+StreamWriteScheduler::StreamWriteScheduler(
+    AsyncSocket* socket, Options options)
+    : socket_(socket), options_(options) {
+  DCHECK_GT(options_.quantum, 0);
+  socket_->setBufferCallback(this);
+}
+
+StreamWriteScheduler::~StreamWriteScheduler() {
+  socket_->setBufferCallback(nullptr);
+}
+
+void StreamWriteScheduler::setStreamWeight(StreamId id, uint32_t weight) {
+  DCHECK_GT(weight, 0);
+  streams_[id].weight = std::max<uint32_t>(weight, 1);
+}
+
+void StreamWriteScheduler::removeStream(StreamId id) {
+  auto it = streams_.find(id);
+  if (it == streams_.end()) {
+    return;
+  }
+  if (it->second.active) {
+    auto pos = std::find(active_.begin(), active_.end(), id);
+    if (pos == active_.begin()) {
+      inRound_ = false;
+    }
+    active_.erase(pos);
+  }
+  pendingBytes_ -= it->second.bytes;
+  streams_.erase(it);
+}
+
+void StreamWriteScheduler::enqueue(StreamId id, std::unique_ptr<IOBuf> frame) {
+  if (failed_ || !frame) {
+    return;
+  }
+  auto& stream = streams_[id];
+  size_t length = frame->computeChainDataLength();
+  stream.frames.emplace_back(std::move(frame), length);
+  stream.bytes += length;
+  pendingBytes_ += length;
+  if (!stream.active) {
+    stream.active = true;
+    active_.push_back(id);
+  }
+  scheduleFlush();
+}
+
+size_t StreamWriteScheduler::pendingBytes(StreamId id) const {
+  auto it = streams_.find(id);
+  return it == streams_.end() ? 0 : it->second.bytes;
+}
+
+void StreamWriteScheduler::flush() {
+  if (isLoopCallbackScheduled()) {
+    cancelLoopCallback();
+  }
+  // Writing stops as soon as the socket buffers, which it reports through
+  // onEgressBuffered() from within writeChain().
+  while (!blocked_ && !failed_ && !active_.empty()) {
+    socket_->writeChain(this, gather());
+  }
+}
+
+std::unique_ptr<IOBuf> StreamWriteScheduler::gather() {
+  std::unique_ptr<IOBuf> chain;
+  size_t gathered = 0;
+  while (!active_.empty()) {
+    auto id = active_.front();
+    auto& stream = streams_.at(id);
+    if (!inRound_) {
+      stream.deficit += options_.quantum * stream.weight;
+      inRound_ = true;
+    }
+    while (!stream.frames.empty()) {
+      auto& [frame, length] = stream.frames.front();
+      if (length > stream.deficit) {
+        break;
+      }
+      if (gathered > 0 && gathered + length > options_.maxGatherBytes) {
+        // The chain is full, the stream finishes its round next time.
+        return chain;
+      }
+      stream.deficit -= length;
+      stream.bytes -= length;
+      pendingBytes_ -= length;
+      gathered += length;
+      if (chain) {
+        chain->appendToChain(std::move(frame));
+      } else {
+        chain = std::move(frame);
+      }
+      stream.frames.pop_front();
+    }
+
+    inRound_ = false;
+    active_.pop_front();
+    if (stream.frames.empty()) {
+      // Idle streams don't accumulate credit.
+      stream.deficit = 0;
+      stream.active = false;
+    } else {
+      active_.push_back(id);
+    }
+  }
+  return chain;
+}
+
+void StreamWriteScheduler::scheduleFlush() {
+  if (!blocked_ && !isLoopCallbackScheduled()) {
+    socket_->getEventBase()->runInLoop(this);
+  }
+}
+
+void StreamWriteScheduler::onEgressBufferCleared() {
+  blocked_ = false;
+  if (!active_.empty()) {
+    scheduleFlush();
+  }
+}
+
+void StreamWriteScheduler::writeErr(
+    size_t, const AsyncSocketException& ex) noexcept {
+  blocked_ = false;
+  if (failed_) {
+    return;
+  }
+  failed_ = true;
+  streams_.clear();
+  active_.clear();
+  inRound_ = false;
+  pendingBytes_ = 0;
+  if (errorCallback_) {
+    errorCallback_(ex);
+  }
+}
+
+} // namespace folly
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+
+#include <folly/Function.h>
+#include <folly/container/F14Map.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/async/AsyncSocket.h>
+#include <folly/io/async/EventBase.h>
+
+namespace folly {
+
+/**
+ * Schedules the writes of the streams multiplexed on an AsyncSocket, such
+ * as those of HTTP/2 or of an RPC protocol, with deficit round robin.
+ *
+ * Each stream has a queue of frames and a weight. Frames are never split:
+ * the scheduler only decides in which order whole frames go out. On each
+ * round, a stream with pending frames earns `quantum * weight` bytes of
+ * credit, and sends the frames that fit in its credit; what it doesn't use
+ * carries over to its next round. Streams thus get bandwidth in proportion
+ * to their weights, and a stream with a lot to send can't hold back the
+ * others for more than one round.
+ *
+ * Frames are gathered into chains of up to `maxGatherBytes` (at least one
+ * frame), each written with a single writeChain(), so one sendmsg() sends
+ * frames from many streams. The scheduler installs itself as the socket's
+ * BufferCallback, and stops gathering as soon as the socket has to buffer
+ * a write: the frames stay in the stream queues, where the schedule can
+ * still take new and higher priority frames into account, until the socket
+ * becomes writable again. Frames enqueued during a loop iteration are
+ * flushed together at the end of it.
+ *
+ * Must be used from the socket's EventBase thread. Destroy it after the
+ * socket was closed, or when it has no write in progress (hasPendingWrite()
+ * is false), since the socket's write callbacks refer to it.
+ */
+class StreamWriteScheduler : private AsyncSocket::BufferCallback,
+                             private AsyncWriter::WriteCallback,
+                             private EventBase::LoopCallback {
+ public:
+  using StreamId = uint64_t;
+
+  struct Options {
+    // Credit a stream of weight 1 earns per round
+    size_t quantum{16 * 1024};
+    // Size of the chains handed to the socket, about a socket buffer's worth
+    size_t maxGatherBytes{64 * 1024};
+  };
+
+  explicit StreamWriteScheduler(AsyncSocket* socket)
+      : StreamWriteScheduler(socket, Options()) {}
+  StreamWriteScheduler(AsyncSocket* socket, Options options);
+  ~StreamWriteScheduler() override;
+
+  StreamWriteScheduler(const StreamWriteScheduler&) = delete;
+  StreamWriteScheduler& operator=(const StreamWriteScheduler&) = delete;
+
+  /**
+   * Adds a stream, or changes the weight of an existing one. Weights must
+   * be positive.
+   */
+  void setStreamWeight(StreamId id, uint32_t weight);
+
+  /**
+   * Removes a stream, discarding the frames it has queued.
+   */
+  void removeStream(StreamId id);
+
+  /**
+   * Queues a frame for a stream, adding the stream with weight 1 if it
+   * doesn't exist.
+   */
+  void enqueue(StreamId id, std::unique_ptr<IOBuf> frame);
+
+  /**
+   * Writes the queued frames right away, rather than at the end of the loop
+   * iteration, as far as the socket takes them without buffering.
+   */
+  void flush();
+
+  /**
+   * Bytes queued for one stream, or for all of them.
+   */
+  size_t pendingBytes(StreamId id) const;
+  size_t pendingBytes() const { return pendingBytes_; }
+
+  /**
+   * Whether the socket is buffering a write, which stops the scheduler
+   * until the socket drains.
+   */
+  bool hasPendingWrite() const { return blocked_; }
+
+  /**
+   * Called if a write fails. All the queued frames are discarded, and
+   * further frames are dropped.
+   */
+  void setErrorCallback(Function<void(const AsyncSocketException&)> cb) {
+    errorCallback_ = std::move(cb);
+  }
+
+ private:
+  struct Stream {
+    std::deque<std::pair<std::unique_ptr<IOBuf>, size_t>> frames;
+    size_t bytes{0};
+    uint32_t weight{1};
+    size_t deficit{0};
+    bool active{false};
+  };
+
+  // Returns the next chain of frames to write, taking them off the streams.
+  std::unique_ptr<IOBuf> gather();
+  void scheduleFlush();
+
+  void onEgressBuffered() override { blocked_ = true; }
+  void onEgressBufferCleared() override;
+  void writeSuccess() noexcept override {}
+  void writeErr(size_t, const AsyncSocketException& ex) noexcept override;
+  void runLoopCallback() noexcept override { flush(); }
+
+  AsyncSocket* const socket_;
+  const Options options_;
+  F14FastMap<StreamId, Stream> streams_;
+  // The streams with queued frames, in round robin order. The one in front
+  // is in the middle of its round if `inRound_`.
+  std::deque<StreamId> active_;
+  bool inRound_{false};
+  size_t pendingBytes_{0};
+  bool blocked_{false};
+  bool failed_{false};
+  Function<void(const AsyncSocketException&)> errorCallback_;
+};
+
+} // namespace folly
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/SubprocessExitWatcher.h>
+
+#include <stdexcept>
+
+namespace folly {
+
+SubprocessExitWatcher::SubprocessExitWatcher(
+    EventBase* eventBase, Subprocess& proc, Callback cb)
+    : EventHandler(eventBase), proc_(proc), callback_(std::move(cb)) {
+  if (proc_.pidfd() < 0) {
+    throw std::invalid_argument(
+        "SubprocessExitWatcher needs a Subprocess with a pidfd");
+  }
+  changeHandlerFD(NetworkSocket::fromFd(proc_.pidfd()));
+  if (!registerHandler(EventHandler::READ)) {
+    throw std::runtime_error("SubprocessExitWatcher: failed to register");
+  }
+}
+
+SubprocessExitWatcher::~SubprocessExitWatcher() {
+  unregisterHandler();
+}
+
+void SubprocessExitWatcher::handlerReady(uint16_t /* events */) noexcept {
+  // wait() closes the pidfd, so stop watching it first.
+  unregisterHandler();
+  auto callback = std::move(callback_);
+  callback(proc_.wait());
+}
+
+} // namespace folly
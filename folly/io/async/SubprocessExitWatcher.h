@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/Function.h>
+#include <folly/Subprocess.h>
+#include <folly/io/async/EventHandler.h>
+
+namespace folly {
+
+/**
+ * Waits for a Subprocess to exit from an EventBase loop, without blocking in
+ * waitpid() or polling it from a timer.
+ *
+ * The Subprocess must have been spawned with Subprocess::Options::usePidfd();
+ * its pidfd becomes readable when the child exits. The callback then runs in
+ * the EventBase thread with the result of Subprocess::wait(), which no longer
+ * blocks at that point.
+ *
+ * The Subprocess must outlive the watcher, and must not be waited for by
+ * anything else while it is being watched. Destroying the watcher before the
+ * child exits stops watching without calling the callback.
+ */
+class SubprocessExitWatcher : private EventHandler {
+ public:
+  using Callback = Function<void(ProcessReturnCode)>;
+
+  /**
+   * Starts watching. Throws std::invalid_argument if the Subprocess has no
+   * pidfd (it wasn't requested, the kernel doesn't support pidfds, or the
+   * child has already been waited for).
+   */
+  SubprocessExitWatcher(EventBase* eventBase, Subprocess& proc, Callback cb);
+
+  ~SubprocessExitWatcher() override;
+
+  SubprocessExitWatcher(const SubprocessExitWatcher&) = delete;
+  SubprocessExitWatcher& operator=(const SubprocessExitWatcher&) = delete;
+
+  /**
+   * Whether the child has not been seen exiting yet.
+   */
+  bool isWatching() const { return isHandlerRegistered(); }
+
+ private:
+  void handlerReady(uint16_t events) noexcept override;
+
+  Subprocess& proc_;
+  Callback callback_;
+};
+
+} // namespace folly
@@ -21,6 +21,7 @@
 
 #include <folly/Function.h>
 #include <folly/Optional.h>
+#include <folly/experimental/ExecutionObserver.h>
 
 namespace folly {
 
@@ -73,6 +74,14 @@ class TimeoutManager {
    */
   virtual void bumpHandlingTime() = 0;
 
+  /**
+   * Observers to notify around the timeouts fired by this manager, or
+   * nullptr if there are none.
+   */
+  virtual ExecutionObserver::List* getTimeoutExecutionObserverList() {
+    return nullptr;
+  }
+
   /**
    * Helper method to know whether we are running in the timeout manager
    * thread
@@ -99,6 +99,10 @@ class VirtualEventBase : public folly::TimeoutManager,
 
   void bumpHandlingTime() override { evb_->bumpHandlingTime(); }
 
+  ExecutionObserver::List* getTimeoutExecutionObserverList() override {
+    return evb_->getTimeoutExecutionObserverList();
+  }
+
   bool isInTimeoutManagerThread() override {
     return evb_->isInTimeoutManagerThread();
   }
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/fdsock/FdTakeover.h>
+
+#include <fmt/core.h>
+
+#include <folly/io/Cursor.h>
+
+namespace folly {
+
+namespace {
+
+constexpr uint8_t kLastFrame = 1;
+constexpr size_t kFrameHeaderSize = 4 + 1 + 4 + 8;
+constexpr size_t kMinReadSize = 4096;
+constexpr size_t kMaxReadSize = 64 * 1024;
+
+} // namespace
+
+void sendFdsForTakeover(
+    AsyncFdSocket& socket,
+    std::vector<NamedFdToSend> fds,
+    AsyncWriter::WriteCallback* callback) {
+  // Always send at least one frame, to mark the end.
+  size_t begin = 0;
+  do {
+    size_t end = std::min(fds.size(), begin + kMaxFdsPerTakeoverFrame);
+    bool last = end == fds.size();
+
+    SocketFds::ToSend files;
+    size_t frameSize = kFrameHeaderSize;
+    files.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+      files.push_back(std::move(fds[i].second));
+      frameSize += 4 + fds[i].first.size();
+    }
+    SocketFds socketFds{std::move(files)};
+    auto seqNum = socketFds.empty()
+        ? SocketFds::kNoSeqNum
+        : socket.injectSocketSeqNumIntoFdsToSend(&socketFds);
+
+    auto buf = IOBuf::create(frameSize);
+    io::Appender appender(buf.get(), 0);
+    appender.writeBE<uint32_t>(kFdTakeoverMagic);
+    appender.writeBE<uint8_t>(last ? kLastFrame : 0);
+    appender.writeBE<uint32_t>(uint32_t(end - begin));
+    appender.writeBE<int64_t>(seqNum);
+    for (size_t i = begin; i < end; ++i) {
+      const auto& name = fds[i].first;
+      appender.writeBE<uint32_t>(uint32_t(name.size()));
+      appender.push(ByteRange(StringPiece(name)));
+    }
+
+    // Only the last write reports back: if an earlier one fails, the socket
+    // fails all the pending writes, the last one included.
+    socket.writeChainWithFds(
+        last ? callback : nullptr, std::move(buf), std::move(socketFds));
+    begin = end;
+  } while (begin < fds.size());
+}
+
+FdTakeoverReceiver::FdTakeoverReceiver(
+    AsyncFdSocket* socket, Callback* callback)
+    : socket_(socket), callback_(callback) {
+  socket_->setReadCB(this);
+}
+
+FdTakeoverReceiver::~FdTakeoverReceiver() {
+  if (socket_->getReadCallback() == this) {
+    socket_->setReadCB(nullptr);
+  }
+}
+
+void FdTakeoverReceiver::getReadBuffer(void** bufReturn, size_t* lenReturn) {
+  std::tie(*bufReturn, *lenReturn) =
+      buf_.preallocate(kMinReadSize, kMaxReadSize);
+}
+
+void FdTakeoverReceiver::readDataAvailable(size_t len) noexcept {
+  buf_.postallocate(len);
+  processFrames();
+}
+
+void FdTakeoverReceiver::readEOF() noexcept {
+  fail(
+      AsyncSocketException::END_OF_FILE,
+      "EOF before the end of the FD takeover");
+}
+
+void FdTakeoverReceiver::readErr(const AsyncSocketException& ex) noexcept {
+  socket_->setReadCB(nullptr);
+  callback_->takeoverFdsError(ex);
+}
+
+void FdTakeoverReceiver::processFrames() {
+  while (!buf_.empty()) {
+    io::Cursor cursor(buf_.front());
+    if (!cursor.canAdvance(kFrameHeaderSize)) {
+      return;
+    }
+    auto magic = cursor.readBE<uint32_t>();
+    auto flags = cursor.readBE<uint8_t>();
+    auto numFds = cursor.readBE<uint32_t>();
+    auto seqNum = cursor.readBE<int64_t>();
+    if (magic != kFdTakeoverMagic || numFds > kMaxFdsPerTakeoverFrame) {
+      fail(AsyncSocketException::BAD_ARGS, "Invalid FD takeover frame");
+      return;
+    }
+
+    std::vector<std::string> names;
+    names.reserve(numFds);
+    for (uint32_t i = 0; i < numFds; ++i) {
+      uint32_t length;
+      if (!cursor.tryReadBE(length) || !cursor.canAdvance(length)) {
+        return; // wait for the rest of the frame
+      }
+      names.push_back(cursor.readFixedString(length));
+    }
+    buf_.trimStart(cursor.getCurrentPosition());
+
+    if (numFds > 0) {
+      // The FDs arrived with the first byte of the frame.
+      auto socketFds = socket_->popNextReceivedFds();
+      if (socketFds.size() != numFds ||
+          socketFds.getFdSocketSeqNum() != seqNum) {
+        fail(
+            AsyncSocketException::BAD_ARGS,
+            fmt::format(
+            "FD takeover frame has {} FDs with sequence number {}, "
+            "but got {} FDs with sequence number {}",
+            numFds,
+            seqNum,
+            socketFds.size(),
+            socketFds.empty() ? SocketFds::kNoSeqNum
+                              : socketFds.getFdSocketSeqNum()));
+        return;
+      }
+      auto files = socketFds.releaseReceived();
+      for (uint32_t i = 0; i < numFds; ++i) {
+        fds_.emplace_back(std::move(names[i]), std::move(files[i]));
+      }
+    }
+
+    if (flags & kLastFrame) {
+      socket_->setReadCB(nullptr);
+      callback_->takeoverFdsReceived(std::move(fds_));
+      return;
+    }
+  }
+}
+
+void FdTakeoverReceiver::fail(
+    AsyncSocketException::AsyncSocketExceptionType type,
+    const std::string& message) {
+  socket_->setReadCB(nullptr);
+  callback_->takeoverFdsError(AsyncSocketException(type, message));
+}
+
+} // namespace folly
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <folly/File.h>
+#include <folly/io/IOBufQueue.h>
+#include <folly/io/async/fdsock/AsyncFdSocket.h>
+
+namespace folly {
+
+/**
+ * Hands many FDs, such as the listening and accepted sockets of a server
+ * being restarted, to another process over an `AsyncFdSocket`.
+ *
+ * `sendFdsForTakeover()` splits the FDs into frames of up to
+ * `kMaxFdsPerTakeoverFrame` (`SCM_MAX_FD`), each written with one
+ * `sendmsg()`, and queues all of them at once: they are pipelined, without
+ * a round trip to the receiver between frames, so the transfer is bounded
+ * by the socket rather than by latency. Each frame names its FDs, so that
+ * the receiver can tell them apart, and carries the sequence number of its
+ * first FD, which `FdTakeoverReceiver` checks against the one its
+ * `AsyncFdSocket` assigned on receipt.
+ *
+ * Frame format, integers in network byte order:
+ *   uint32_t  kFdTakeoverMagic
+ *   uint8_t   flags: 1 if this is the last frame
+ *   uint32_t  number of FDs in this frame
+ *   int64_t   sequence number of the first FD, or -1 if there are none
+ *   then for each FD, a uint32_t length followed by its name.
+ *
+ * Both sides must be used from the socket's EventBase thread.
+ */
+
+constexpr size_t kMaxFdsPerTakeoverFrame = 253;
+constexpr uint32_t kFdTakeoverMagic = 0x46444b31; // "FDK1"
+
+using NamedFdToSend = std::pair<std::string, std::shared_ptr<const File>>;
+using NamedFd = std::pair<std::string, File>;
+
+/**
+ * Writes `fds` to `socket`, followed by the end of the transfer. `callback`,
+ * if not null, gets writeSuccess() once everything was written, or
+ * writeErr() if a write failed.
+ */
+void sendFdsForTakeover(
+    AsyncFdSocket& socket,
+    std::vector<NamedFdToSend> fds,
+    AsyncWriter::WriteCallback* callback);
+
+/**
+ * Reads the FDs sent by `sendFdsForTakeover()` from a socket. It installs
+ * itself as the socket's read callback, and uninstalls itself once the
+ * transfer is complete or failed, before calling its callback.
+ */
+class FdTakeoverReceiver : private AsyncReader::ReadCallback {
+ public:
+  class Callback {
+   public:
+    virtual ~Callback() = default;
+
+    // All the FDs sent, in order.
+    virtual void takeoverFdsReceived(std::vector<NamedFd> fds) noexcept = 0;
+
+    virtual void takeoverFdsError(const AsyncSocketException& ex) noexcept = 0;
+  };
+
+  FdTakeoverReceiver(AsyncFdSocket* socket, Callback* callback);
+  ~FdTakeoverReceiver() override;
+
+  FdTakeoverReceiver(const FdTakeoverReceiver&) = delete;
+  FdTakeoverReceiver& operator=(const FdTakeoverReceiver&) = delete;
+
+ private:
+  void getReadBuffer(void** bufReturn, size_t* lenReturn) override;
+  void readDataAvailable(size_t len) noexcept override;
+  void readEOF() noexcept override;
+  void readErr(const AsyncSocketException& ex) noexcept override;
+
+  // Consumes the complete frames in buf_.
+  void processFrames();
+  void fail(
+      AsyncSocketException::AsyncSocketExceptionType type,
+      const std::string& message);
+
+  AsyncFdSocket* socket_;
+  Callback* callback_;
+  IOBufQueue buf_{IOBufQueue::cacheChainLength()};
+  std::vector<NamedFd> fds_;
+};
+
+} // namespace folly
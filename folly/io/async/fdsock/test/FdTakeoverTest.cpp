@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/fdsock/FdTakeover.h>
+
+#include <fmt/core.h>
+
+#include <folly/io/async/test/AsyncSocketTest.h>
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+// `AsyncFdSocket` is just a stub on Windows because its CMSG macros are busted
+#if !defined(_WIN32)
+
+namespace {
+
+struct TakeoverCallback : FdTakeoverReceiver::Callback {
+  void takeoverFdsReceived(std::vector<NamedFd> received) noexcept override {
+    fds = std::move(received);
+    done = true;
+  }
+
+  void takeoverFdsError(const AsyncSocketException& ex) noexcept override {
+    error = ex.what();
+    errorType = ex.getType();
+    done = true;
+  }
+
+  bool done{false};
+  std::vector<NamedFd> fds;
+  std::string error;
+  AsyncSocketException::AsyncSocketExceptionType errorType{
+      AsyncSocketException::UNKNOWN};
+};
+
+ino_t inode(int fd) {
+  struct stat st;
+  PCHECK(0 == ::fstat(fd, &st));
+  return st.st_ino;
+}
+
+struct FdTakeoverTest : public testing::Test {
+  FdTakeoverTest() {
+    std::array<NetworkSocket, 2> fds;
+    PCHECK(0 == netops::socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()));
+    for (int i = 0; i < 2; ++i) {
+      PCHECK(0 == netops::set_socket_non_blocking(fds[i])) << i;
+    }
+    sendSock_ = std::make_unique<AsyncFdSocket>(&evb_, fds[0]);
+    recvSock_ = std::make_unique<AsyncFdSocket>(&evb_, fds[1]);
+  }
+
+  // Sends `n` named pipe ends, and checks that the same ones arrive.
+  void roundtrip(size_t n) {
+    std::vector<NamedFdToSend> toSend;
+    std::vector<ino_t> inodes;
+    while (toSend.size() < n) {
+      std::array<int, 2> pipeFds;
+      PCHECK(0 == ::pipe(pipeFds.data()));
+      for (int fd : pipeFds) {
+        auto file = std::make_shared<const File>(fd, /*ownsFd*/ true);
+        if (toSend.size() < n) {
+          inodes.push_back(inode(fd));
+          toSend.emplace_back(fmt::format("fd{}", toSend.size()), file);
+        }
+      }
+    }
+
+    TakeoverCallback callback;
+    FdTakeoverReceiver receiver(recvSock_.get(), &callback);
+    test::WriteCallback wcb;
+    sendFdsForTakeover(*sendSock_, std::move(toSend), &wcb);
+    while (!callback.done) {
+      evb_.loopOnce();
+    }
+
+    EXPECT_EQ(test::STATE_SUCCEEDED, wcb.state);
+    EXPECT_EQ("", callback.error);
+    ASSERT_EQ(n, callback.fds.size());
+    for (size_t i = 0; i < n; ++i) {
+      EXPECT_EQ(fmt::format("fd{}", i), callback.fds[i].first);
+      EXPECT_EQ(inodes[i], inode(callback.fds[i].second.fd()));
+    }
+    EXPECT_EQ(nullptr, recvSock_->getReadCallback());
+  }
+
+  EventBase evb_;
+  std::unique_ptr<AsyncFdSocket> sendSock_;
+  std::unique_ptr<AsyncFdSocket> recvSock_;
+};
+
+} // namespace
+
+TEST_F(FdTakeoverTest, Empty) {
+  roundtrip(0);
+}
+
+TEST_F(FdTakeoverTest, OneFrame) {
+  roundtrip(kMaxFdsPerTakeoverFrame);
+}
+
+TEST_F(FdTakeoverTest, ManyFrames) {
+  roundtrip(2 * kMaxFdsPerTakeoverFrame + 3);
+}
+
+TEST_F(FdTakeoverTest, Twice) {
+  // Sequence numbers carry on from one transfer to the next.
+  roundtrip(5);
+  roundtrip(300);
+}
+
+TEST_F(FdTakeoverTest, InvalidFrame) {
+  TakeoverCallback callback;
+  FdTakeoverReceiver receiver(recvSock_.get(), &callback);
+  test::WriteCallback wcb;
+  sendSock_->writeChain(
+      &wcb, IOBuf::copyBuffer("this is not an FD takeover frame"));
+  while (!callback.done) {
+    evb_.loopOnce();
+  }
+  EXPECT_EQ(AsyncSocketException::BAD_ARGS, callback.errorType);
+  EXPECT_THAT(callback.error, testing::HasSubstr("Invalid FD takeover frame"));
+  EXPECT_TRUE(callback.fds.empty());
+}
+
+TEST_F(FdTakeoverTest, EarlyEOF) {
+  TakeoverCallback callback;
+  FdTakeoverReceiver receiver(recvSock_.get(), &callback);
+  sendSock_->close();
+  while (!callback.done) {
+    evb_.loopOnce();
+  }
+  EXPECT_EQ(AsyncSocketException::END_OF_FILE, callback.errorType);
+}
+
+#endif
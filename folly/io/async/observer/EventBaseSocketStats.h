@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace folly {
+
+/**
+ * Socket I/O counters aggregated over every AsyncSocket attached to one
+ * EventBase.
+ *
+ * Counters are only ever written from the EventBase thread, so updates are a
+ * relaxed load and store rather than a locked read-modify-write; snapshot()
+ * may be called from any thread. The counters are cumulative: observers that
+ * want rates diff consecutive snapshots.
+ *
+ * The stats cover the plain socket syscalls issued by AsyncSocket; TLS
+ * sockets that read and write through OpenSSL are not included. To get an
+ * aggregated view over an IOThreadPoolExecutor, sum the snapshots of
+ * getAllEventBases().
+ */
+class EventBaseSocketStats {
+ public:
+  struct Snapshot {
+    uint64_t bytesRead{0};
+    uint64_t bytesWritten{0};
+    // Syscalls issued, including the ones that returned EAGAIN.
+    uint64_t readCalls{0};
+    uint64_t writeCalls{0};
+    uint64_t readEagain{0};
+    uint64_t writeEagain{0};
+    // Writes that accepted some but not all of the bytes offered.
+    uint64_t partialWrites{0};
+    // Read buffer space offered to the kernel by successful reads.
+    uint64_t readBufferBytes{0};
+
+    Snapshot& operator+=(const Snapshot& other) {
+      bytesRead += other.bytesRead;
+      bytesWritten += other.bytesWritten;
+      readCalls += other.readCalls;
+      writeCalls += other.writeCalls;
+      readEagain += other.readEagain;
+      writeEagain += other.writeEagain;
+      partialWrites += other.partialWrites;
+      readBufferBytes += other.readBufferBytes;
+      return *this;
+    }
+
+    Snapshot operator-(const Snapshot& other) const {
+      Snapshot ret;
+      ret.bytesRead = bytesRead - other.bytesRead;
+      ret.bytesWritten = bytesWritten - other.bytesWritten;
+      ret.readCalls = readCalls - other.readCalls;
+      ret.writeCalls = writeCalls - other.writeCalls;
+      ret.readEagain = readEagain - other.readEagain;
+      ret.writeEagain = writeEagain - other.writeEagain;
+      ret.partialWrites = partialWrites - other.partialWrites;
+      ret.readBufferBytes = readBufferBytes - other.readBufferBytes;
+      return ret;
+    }
+
+    /**
+     * Fraction of the read buffer space that was filled by successful reads.
+     * A persistently low value means the read callbacks hand out buffers
+     * much larger than what arrives per read.
+     */
+    double readBufferUtilization() const {
+      return readBufferBytes == 0 ? 0.0 : double(bytesRead) / readBufferBytes;
+    }
+  };
+
+  void onRead(size_t bufferBytes, ptrdiff_t result, bool wouldBlock) {
+    bump(readCalls_);
+    if (result > 0) {
+      bump(bytesRead_, uint64_t(result));
+      bump(readBufferBytes_, bufferBytes);
+    } else if (wouldBlock) {
+      bump(readEagain_);
+    }
+  }
+
+  void onWrite(ptrdiff_t result, bool wouldBlock) {
+    bump(writeCalls_);
+    if (result > 0) {
+      bump(bytesWritten_, uint64_t(result));
+    } else if (wouldBlock) {
+      bump(writeEagain_);
+    }
+  }
+
+  void onPartialWrite() { bump(partialWrites_); }
+
+  Snapshot snapshot() const {
+    Snapshot ret;
+    ret.bytesRead = bytesRead_.load(std::memory_order_relaxed);
+    ret.bytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+    ret.readCalls = readCalls_.load(std::memory_order_relaxed);
+    ret.writeCalls = writeCalls_.load(std::memory_order_relaxed);
+    ret.readEagain = readEagain_.load(std::memory_order_relaxed);
+    ret.writeEagain = writeEagain_.load(std::memory_order_relaxed);
+    ret.partialWrites = partialWrites_.load(std::memory_order_relaxed);
+    ret.readBufferBytes = readBufferBytes_.load(std::memory_order_relaxed);
+    return ret;
+  }
+
+ private:
+  // Single writer: no need for fetch_add.
+  static void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+    counter.store(
+        counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> bytesRead_{0};
+  std::atomic<uint64_t> bytesWritten_{0};
+  std::atomic<uint64_t> readCalls_{0};
+  std::atomic<uint64_t> writeCalls_{0};
+  std::atomic<uint64_t> readEagain_{0};
+  std::atomic<uint64_t> writeEagain_{0};
+  std::atomic<uint64_t> partialWrites_{0};
+  std::atomic<uint64_t> readBufferBytes_{0};
+};
+
+} // namespace folly
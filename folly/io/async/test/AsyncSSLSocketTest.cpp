@@ -30,12 +30,14 @@
 
 #include <folly/SocketAddress.h>
 #include <folly/String.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/experimental/TestUtil.h>
 #include <folly/io/Cursor.h>
 #include <folly/io/async/AsyncPipe.h>
 #include <folly/io/async/AsyncSSLSocket.h>
 #include <folly/io/async/EventBase.h>
 #include <folly/io/async/EventBaseThread.h>
+#include <folly/io/async/SSLAcceptExecutorRunner.h>
 #include <folly/io/async/SSLOptions.h>
 #include <folly/io/async/ScopedEventBaseThread.h>
 #include <folly/io/async/ssl/BasicTransportCertificate.h>
@@ -2637,6 +2639,79 @@ TEST(AsyncSSLSocketTest, SSLAcceptRunnerFiber) {
   EXPECT_FALSE(server.handshakeError_);
 }
 
+TEST(AsyncSSLSocketTest, SSLAcceptRunnerExecutor) {
+  EventBase eventBase;
+  CPUThreadPoolExecutor executor(1);
+  auto clientCtx = std::make_shared<SSLContext>();
+  auto serverCtx = std::make_shared<SSLContext>();
+  serverCtx->ciphers("ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+  serverCtx->loadPrivateKey(find_resource(kTestKey).c_str());
+  serverCtx->loadCertificate(find_resource(kTestCert).c_str());
+
+  clientCtx->setVerificationOption(SSLContext::SSLVerifyPeerEnum::VERIFY);
+  clientCtx->ciphers("ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+  clientCtx->loadTrustedCertificates(find_resource(kTestCA).c_str());
+
+  NetworkSocket fds[2];
+  getfds(fds);
+
+  AsyncSSLSocket::UniquePtr clientSock(
+      new AsyncSSLSocket(clientCtx, &eventBase, fds[0], false));
+  AsyncSSLSocket::UniquePtr serverSock(
+      new AsyncSSLSocket(serverCtx, &eventBase, fds[1], true));
+
+  serverCtx->sslAcceptRunner(
+      std::make_unique<SSLAcceptExecutorRunner>(getKeepAliveToken(executor)));
+
+  SSLHandshakeClient client(std::move(clientSock), true, true);
+  SSLHandshakeServer server(std::move(serverSock), true, true);
+
+  eventBase.loop();
+
+  EXPECT_TRUE(client.handshakeSuccess_);
+  EXPECT_FALSE(client.handshakeError_);
+  EXPECT_TRUE(server.handshakeSuccess_);
+  EXPECT_FALSE(server.handshakeError_);
+}
+
+TEST(AsyncSSLSocketTest, SSLAcceptRunnerExecutorError) {
+  EventBase eventBase;
+  CPUThreadPoolExecutor executor(1);
+  auto clientCtx = std::make_shared<SSLContext>();
+  auto serverCtx = std::make_shared<SSLContext>();
+  serverCtx->ciphers("ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+  serverCtx->loadPrivateKey(find_resource(kTestKey).c_str());
+  serverCtx->loadCertificate(find_resource(kTestCert).c_str());
+
+  // The client has no certificate to send, so SSL_accept fails on the
+  // executor.
+  serverCtx->setVerificationOption(
+      SSLContext::SSLVerifyPeerEnum::VERIFY_REQ_CLIENT_CERT);
+  serverCtx->loadTrustedCertificates(find_resource(kTestCA).c_str());
+  clientCtx->ciphers("ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+
+  NetworkSocket fds[2];
+  getfds(fds);
+
+  AsyncSSLSocket::UniquePtr clientSock(
+      new AsyncSSLSocket(clientCtx, &eventBase, fds[0], false));
+  AsyncSSLSocket::UniquePtr serverSock(
+      new AsyncSSLSocket(serverCtx, &eventBase, fds[1], true));
+
+  serverCtx->sslAcceptRunner(
+      std::make_unique<SSLAcceptExecutorRunner>(getKeepAliveToken(executor)));
+
+  SSLHandshakeClient client(std::move(clientSock), true, true);
+  SSLHandshakeServer server(std::move(serverSock), true, true);
+
+  eventBase.loop();
+
+  EXPECT_FALSE(server.handshakeSuccess_);
+  EXPECT_TRUE(server.handshakeError_);
+  // The OpenSSL error was carried back from the executor thread.
+  EXPECT_NE(server.errorString_.find("SSL routines"), std::string::npos);
+}
+
 static int newCloseCb(SSL* ssl, SSL_SESSION*) {
   AsyncSSLSocket::getFromSSL(ssl)->closeNow();
 
@@ -3976,6 +4051,34 @@ TEST(AsyncSSLSocketTest, BytesWrittenWithMove) {
   EXPECT_EQ(socket1RawBytes, socket3->getRawBytesWritten());
 }
 
+TEST(AsyncSSLSocketTest, ConnectWriteReadCloseKtls) {
+  WriteCallbackBase writeCallback;
+  ReadCallback readCallback(&writeCallback);
+  HandshakeCallback handshakeCallback(&readCallback);
+  SSLServerAcceptCallback acceptCallback(&handshakeCallback);
+  TestSSLServer server(&acceptCallback);
+
+  auto sslContext = std::make_shared<SSLContext>();
+  sslContext->ciphers("ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
+  auto socket =
+      std::make_shared<BlockingSocket>(server.getAddress(), sslContext);
+  // Whether or not the kernel can take over, the connection must work the
+  // same way.
+  socket->getSSLSocket()->enableKtls();
+  socket->open(std::chrono::milliseconds(10000));
+
+  std::vector<uint8_t> wbuf(128, 'a');
+  socket->write(wbuf.data(), wbuf.size());
+  EXPECT_EQ(128, socket->getSocket()->getAppBytesWritten());
+
+  std::vector<uint8_t> readbuf(wbuf.size());
+  uint32_t bytesRead = socket->readAll(readbuf.data(), readbuf.size());
+  EXPECT_EQ(bytesRead, wbuf.size());
+  EXPECT_EQ(wbuf, readbuf);
+
+  socket->close();
+}
+
 #ifdef SIGPIPE
 ///////////////////////////////////////////////////////////////////////////
 // init_unit_test_suite
@@ -1209,6 +1209,7 @@ class SSLHandshakeBase : public AsyncSSLSocket::HandshakeCB,
   bool handshakeError_;
   int handshakeVerifyInvocations_{};
   std::chrono::nanoseconds handshakeTime;
+  std::string errorString_;
 
  protected:
   AsyncSSLSocket::UniquePtr socket_;
@@ -1241,6 +1242,7 @@ class SSLHandshakeBase : public AsyncSSLSocket::HandshakeCB,
       AsyncSSLSocket*, const AsyncSocketException& ex) noexcept override {
     LOG(INFO) << "Handshake error " << ex.what();
     handshakeError_ = true;
+    errorString_ = ex.what();
     if (socket_) {
       handshakeTime = socket_->getHandshakeTime();
     }
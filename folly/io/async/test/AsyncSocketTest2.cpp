@@ -25,6 +25,7 @@
 #include <thread>
 
 #include <folly/ExceptionWrapper.h>
+#include <folly/FileUtil.h>
 #include <folly/Random.h>
 #include <folly/SocketAddress.h>
 #include <folly/experimental/TestUtil.h>
@@ -2002,6 +2003,338 @@ TEST(AsyncSocketTest, WriteIOBufCorked) {
   ASSERT_FALSE(socket->isClosedByPeer());
 }
 
+/**
+ * Test coalescing writes made in the same loop iteration
+ */
+TEST(AsyncSocketTest, WriteCoalescing) {
+  TestServer server;
+
+  // connect()
+  EventBase evb;
+  std::shared_ptr<AsyncSocket> socket = AsyncSocket::newSocket(&evb);
+  socket->setWriteCoalescing(1024);
+  EXPECT_EQ(1024, socket->getWriteCoalescing());
+  ConnCallback ccb;
+  socket->connect(&ccb, server.getAddress(), 30);
+
+  // Accept the connection
+  std::shared_ptr<AsyncSocket> acceptedSocket = server.acceptAsync(&evb);
+  ReadCallback rcb;
+  acceptedSocket->setReadCB(&rcb);
+
+  // Do three writes once connected. None of them is sent until the loop
+  // callbacks run, and then the reader sees them arrive together.
+  const size_t lengths[] = {5, 7, 11};
+  WriteCallback wcbs[3];
+  ccb.successCallback = [&] {
+    for (size_t i = 0; i < 3; ++i) {
+      auto buf = IOBuf::create(lengths[i]);
+      memset(buf->writableData(), 'a' + i, lengths[i]);
+      buf->append(lengths[i]);
+      socket->writeChain(&wcbs[i], std::move(buf));
+    }
+    for (const auto& wcb : wcbs) {
+      EXPECT_EQ(STATE_WAITING, wcb.state);
+    }
+    EXPECT_EQ(23, socket->getAppBytesBuffered());
+    // The reader gets EOF once the writes are sent.
+    socket->shutdownWrite();
+  };
+
+  evb.loop();
+  ASSERT_EQ(ccb.state, STATE_SUCCEEDED);
+  for (const auto& wcb : wcbs) {
+    ASSERT_EQ(wcb.state, STATE_SUCCEEDED);
+  }
+  EXPECT_EQ(0, socket->getAppBytesBuffered());
+
+  ASSERT_EQ(rcb.state, STATE_SUCCEEDED);
+  ASSERT_EQ(rcb.buffers.size(), 1);
+  ASSERT_EQ(rcb.buffers[0].length, 23);
+  rcb.verifyData("aaaaabbbbbbbccccccccccc", 23);
+
+  acceptedSocket->close();
+  socket->close();
+}
+
+/**
+ * Test that coalesced writes are sent once they reach the byte limit, and
+ * ahead of writes that can't be coalesced
+ */
+TEST(AsyncSocketTest, WriteCoalescingFlush) {
+  TestServer server;
+
+  // connect()
+  EventBase evb;
+  std::shared_ptr<AsyncSocket> socket = AsyncSocket::newSocket(&evb);
+  socket->setWriteCoalescing(10);
+  ConnCallback ccb;
+  socket->connect(&ccb, server.getAddress(), 30);
+
+  std::shared_ptr<AsyncSocket> acceptedSocket = server.acceptAsync(&evb);
+  ReadCallback rcb;
+  acceptedSocket->setReadCB(&rcb);
+
+  WriteCallback wcb1;
+  WriteCallback wcb2;
+  WriteCallback wcb3;
+  WriteCallback wcb4;
+  ccb.successCallback = [&] {
+    socket->write(&wcb1, "aaaaa", 5);
+    EXPECT_EQ(STATE_WAITING, wcb1.state);
+    socket->write(&wcb2, "bbbbbbb", 7);
+    EXPECT_EQ(STATE_SUCCEEDED, wcb1.state);
+    EXPECT_EQ(STATE_SUCCEEDED, wcb2.state);
+
+    socket->write(&wcb3, "ccc", 3);
+    EXPECT_EQ(STATE_WAITING, wcb3.state);
+    socket->write(&wcb4, "dd", 2, WriteFlags::EOR);
+    EXPECT_EQ(STATE_SUCCEEDED, wcb3.state);
+    EXPECT_EQ(STATE_SUCCEEDED, wcb4.state);
+    socket->shutdownWrite();
+  };
+
+  evb.loop();
+  ASSERT_EQ(ccb.state, STATE_SUCCEEDED);
+  ASSERT_EQ(wcb4.state, STATE_SUCCEEDED);
+  ASSERT_EQ(rcb.state, STATE_SUCCEEDED);
+  rcb.verifyData("aaaaabbbbbbbcccdd", 17);
+
+  acceptedSocket->close();
+  socket->close();
+}
+
+#if defined(FOLLY_HAVE_TCP_INFO)
+/**
+ * Test that TcpInfo is sampled from the write path, at most once per interval
+ */
+TEST(AsyncSocketTest, TcpInfoSampling) {
+  TestServer server;
+
+  EventBase evb;
+  std::shared_ptr<AsyncSocket> socket = AsyncSocket::newSocket(&evb);
+  ConnCallback ccb;
+  socket->connect(&ccb, server.getAddress(), 30);
+  std::shared_ptr<AsyncSocket> acceptedSocket = server.acceptAsync(&evb);
+  ReadCallback rcb;
+  acceptedSocket->setReadCB(&rcb);
+  evb.loopOnce();
+  ASSERT_EQ(ccb.state, STATE_SUCCEEDED);
+
+  // Disabled by default.
+  WriteCallback wcb1;
+  socket->write(&wcb1, "aaaaa", 5);
+  EXPECT_EQ(nullptr, socket->getTcpInfoSample());
+
+  AsyncSocket::TcpInfoSamplingOptions options;
+  options.interval = std::chrono::hours(1);
+  socket->setTcpInfoSampling(options);
+  WriteCallback wcb2;
+  socket->write(&wcb2, "bbbbb", 5);
+  auto sample = socket->getTcpInfoSample();
+  ASSERT_NE(nullptr, sample);
+  EXPECT_TRUE(sample->tcpInfo.cwndInBytes().has_value());
+  EXPECT_TRUE(sample->tcpInfo.srtt().has_value());
+  EXPECT_TRUE(sample->writeBudgetBytes().has_value());
+  auto sampledAt = sample->sampledAt;
+
+  // Within the interval the cached sample is kept.
+  WriteCallback wcb3;
+  socket->write(&wcb3, "ccccc", 5);
+  EXPECT_EQ(sampledAt, socket->getTcpInfoSample()->sampledAt);
+
+  // Sampling explicitly refreshes it.
+  ASSERT_NE(nullptr, socket->sampleTcpInfo());
+  EXPECT_LT(sampledAt, socket->getTcpInfoSample()->sampledAt);
+
+  socket->setTcpInfoSampling(none);
+  EXPECT_EQ(nullptr, socket->getTcpInfoSample());
+  EXPECT_EQ(nullptr, socket->sampleTcpInfo());
+
+  acceptedSocket->close();
+  socket->close();
+}
+
+TEST(AsyncSocketTest, TcpInfoSampleWriteBudget) {
+  folly::TcpInfo::tcp_info info = {};
+  auto budget = [&] {
+    return AsyncSocket::TcpInfoSample{{}, folly::TcpInfo(info)}
+        .writeBudgetBytes();
+  };
+  EXPECT_EQ(0, budget());
+
+  // Congestion window only: 10 packets of 1000 bytes.
+  info.tcpi_snd_cwnd = 10;
+  info.tcpi_snd_mss = 1000;
+  EXPECT_EQ(10000, budget());
+
+  // The bandwidth-delay product wins when known: 1MB/s over 20ms.
+  info.tcpi_delivery_rate = 1000000;
+  info.tcpi_rtt = 20000;
+  EXPECT_EQ(20000, budget());
+
+  // Bytes not sent yet use up the budget.
+  info.tcpi_notsent_bytes = 15000;
+  EXPECT_EQ(5000, budget());
+  info.tcpi_notsent_bytes = 30000;
+  EXPECT_EQ(0, budget());
+}
+#endif
+
+namespace {
+// Sends "head", a range of a large file and "tail" on socket, in that order,
+// and checks what the peer receives.
+void testSendFile(std::shared_ptr<AsyncSocket> socket, EventBase& evb) {
+  TestServer server;
+  std::string contents(3 * 1024 * 1024 + 123, '\0');
+  for (size_t i = 0; i < contents.size(); ++i) {
+    contents[i] = char('a' + i % 23);
+  }
+  test::TemporaryFile file;
+  ASSERT_EQ(
+      ssize_t(contents.size()),
+      writeFull(file.fd(), contents.data(), contents.size()));
+
+  ConnCallback ccb;
+  socket->connect(&ccb, server.getAddress(), 30);
+  std::shared_ptr<AsyncSocket> acceptedSocket = server.acceptAsync(&evb);
+  ReadCallback rcb;
+  acceptedSocket->setReadCB(&rcb);
+
+  // Queued while connecting, so sent once the connection is established.
+  const off_t offset = 10;
+  const size_t length = contents.size() - 20;
+  WriteCallback wcbs[3];
+  socket->write(&wcbs[0], "head", 4);
+  socket->sendFile(&wcbs[1], file.fd(), offset, length);
+  socket->write(&wcbs[2], "tail", 4);
+  EXPECT_EQ(length + 8, socket->getAppBytesBuffered());
+  socket->shutdownWrite();
+
+  evb.loop();
+  ASSERT_EQ(ccb.state, STATE_SUCCEEDED);
+  for (const auto& wcb : wcbs) {
+    ASSERT_EQ(wcb.state, STATE_SUCCEEDED);
+  }
+  EXPECT_EQ(0, socket->getAppBytesBuffered());
+  EXPECT_EQ(length + 8, socket->getAppBytesWritten());
+  ASSERT_EQ(rcb.state, STATE_SUCCEEDED);
+  auto expected = "head" + contents.substr(offset, length) + "tail";
+  rcb.verifyData(expected.data(), expected.size());
+
+  // The file offset is untouched.
+  EXPECT_EQ(off_t(contents.size()), lseek(file.fd(), 0, SEEK_CUR));
+  acceptedSocket->close();
+  socket->close();
+}
+} // namespace
+
+/**
+ * Test sending a file range in order with other writes
+ */
+TEST(AsyncSocketTest, SendFile) {
+  EventBase evb;
+  testSendFile(AsyncSocket::newSocket(&evb), evb);
+}
+
+/**
+ * Test that sockets which transform what they send get the file through
+ * their regular write path
+ */
+TEST(AsyncSocketTest, SendFileFallback) {
+  class TransformingSocket : public AsyncSocket {
+   public:
+    using AsyncSocket::AsyncSocket;
+    std::string getSecurityProtocol() const override { return "test"; }
+  };
+  EventBase evb;
+  testSendFile(
+      std::shared_ptr<AsyncSocket>(
+          new TransformingSocket(&evb), AsyncSocket::Destructor()),
+      evb);
+}
+
+/**
+ * Test that reading past the end of the file fails the write
+ */
+TEST(AsyncSocketTest, SendFilePastEof) {
+  TestServer server;
+  EventBase evb;
+  test::TemporaryFile file;
+  ASSERT_EQ(5, writeFull(file.fd(), "hello", 5));
+
+  std::shared_ptr<AsyncSocket> socket = AsyncSocket::newSocket(&evb);
+  ConnCallback ccb;
+  socket->connect(&ccb, server.getAddress(), 30);
+  evb.loop();
+  ASSERT_EQ(ccb.state, STATE_SUCCEEDED);
+
+  WriteCallback wcb;
+  socket->sendFile(&wcb, file.fd(), 0, 10);
+  evb.loop();
+  EXPECT_EQ(STATE_FAILED, wcb.state);
+}
+
+TEST(AsyncSocketTest, EventBaseSocketStats) {
+  class StatsObserver : public EventBaseObserver {
+   public:
+    uint32_t getSampleRate() const override { return 1; }
+    void loopSample(int64_t, int64_t) override {}
+    void socketStatsSample(
+        const EventBaseSocketStats::Snapshot& snapshot) override {
+      last = snapshot;
+    }
+    EventBaseSocketStats::Snapshot last;
+  };
+
+  TestServer server;
+  EventBase evb;
+  auto observer = std::make_shared<StatsObserver>();
+  evb.setObserver(observer);
+
+  std::shared_ptr<AsyncSocket> socket = AsyncSocket::newSocket(&evb);
+  ConnCallback ccb;
+  socket->connect(&ccb, server.getAddress(), 30);
+  std::shared_ptr<AsyncSocket> acceptedSocket = server.acceptAsync(&evb);
+  ReadCallback rcb;
+  acceptedSocket->setReadCB(&rcb);
+  evb.loopOnce();
+  ASSERT_EQ(ccb.state, STATE_SUCCEEDED);
+  auto before = evb.getSocketStats().snapshot();
+
+  std::string data(100, 'a');
+  WriteCallback wcb;
+  socket->write(&wcb, data.data(), data.size());
+  size_t received = 0;
+  while (received < data.size()) {
+    evb.loopOnce();
+    received = 0;
+    for (const auto& buffer : rcb.buffers) {
+      received += buffer.length;
+    }
+  }
+  ASSERT_EQ(STATE_SUCCEEDED, wcb.state);
+
+  auto stats = evb.getSocketStats().snapshot() - before;
+  EXPECT_EQ(data.size(), stats.bytesWritten);
+  EXPECT_EQ(1, stats.writeCalls);
+  EXPECT_EQ(0, stats.writeEagain);
+  EXPECT_EQ(0, stats.partialWrites);
+  EXPECT_EQ(data.size(), stats.bytesRead);
+  EXPECT_GE(stats.readCalls, 1);
+  EXPECT_GT(stats.readBufferBytes, data.size());
+  EXPECT_GT(stats.readBufferUtilization(), 0);
+  EXPECT_LT(stats.readBufferUtilization(), 1);
+
+  // The observer sees the cumulative counters.
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(evb.getSocketStats().snapshot().bytesRead, observer->last.bytesRead);
+  EXPECT_GE(observer->last.bytesWritten, data.size());
+
+  socket->close();
+  acceptedSocket->close();
+}
+
 /**
  * Test performing a zero-length write
  */
@@ -10046,6 +10379,88 @@ TEST(AsyncSocketTest, QueueTimeout) {
   EXPECT_EQ(connectionEventCb.getConnectionDequeuedByAcceptCallback(), 1);
 }
 
+TEST(AsyncSocketTest, DispatchBatching) {
+  EventBase eventBase;
+  std::shared_ptr<AsyncServerSocket> serverSocket(
+      AsyncServerSocket::newSocket(&eventBase));
+  serverSocket->bind(0);
+  serverSocket->listen(16);
+  folly::SocketAddress serverAddress;
+  serverSocket->getAddress(&serverAddress);
+  serverSocket->setDispatchBatching(true);
+  EXPECT_TRUE(serverSocket->getDispatchBatching());
+
+  constexpr size_t kNumConnections = 8;
+  std::atomic<size_t> accepted{0};
+  TestAcceptCallback acceptCb;
+  acceptCb.setConnectionAcceptedFn([&](auto&&...) {
+    if (++accepted == kNumConnections) {
+      eventBase.runInEventBaseThread(
+          [&] { serverSocket->removeAcceptCallback(&acceptCb, nullptr); });
+    }
+  });
+  ScopedEventBaseThread acceptThread("ioworker_test");
+
+  TestConnectionEventCallback connectionEventCb;
+  serverSocket->setConnectionEventCallback(&connectionEventCb);
+  serverSocket->addAcceptCallback(&acceptCb, acceptThread.getEventBase());
+  serverSocket->startAccepting();
+
+  std::vector<std::shared_ptr<AsyncSocket>> clientSockets;
+  for (size_t i = 0; i < kNumConnections; ++i) {
+    clientSockets.push_back(AsyncSocket::newSocket(&eventBase, serverAddress));
+  }
+
+  eventBase.loop();
+
+  EXPECT_EQ(kNumConnections, accepted.load());
+  EXPECT_EQ(
+      kNumConnections,
+      connectionEventCb.getConnectionEnqueuedForAcceptCallback());
+  EXPECT_EQ(
+      kNumConnections,
+      connectionEventCb.getConnectionDequeuedByAcceptCallback());
+}
+
+#ifdef SO_INCOMING_CPU
+TEST(AsyncSocketTest, IncomingCpu) {
+  EventBase eventBase;
+  std::shared_ptr<AsyncServerSocket> serverSocket(
+      AsyncServerSocket::newSocket(&eventBase));
+  serverSocket->setReusePortEnabled(true);
+  serverSocket->setIncomingCpu(0);
+  EXPECT_EQ(0, serverSocket->getIncomingCpu());
+  serverSocket->bind(0);
+  serverSocket->listen(16);
+
+  auto fd = serverSocket->getNetworkSocket();
+  int cpu = -1;
+  socklen_t len = sizeof(cpu);
+  ASSERT_EQ(
+      0, netops::getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len));
+  EXPECT_EQ(0, cpu);
+
+  // A second listener, for another IO thread, can share the port.
+  folly::SocketAddress serverAddress;
+  serverSocket->getAddress(&serverAddress);
+  std::shared_ptr<AsyncServerSocket> otherSocket(
+      AsyncServerSocket::newSocket(&eventBase));
+  otherSocket->setReusePortEnabled(true);
+  otherSocket->setIncomingCpu(1);
+  otherSocket->bind(serverAddress);
+  otherSocket->listen(16);
+  ASSERT_EQ(
+      0,
+      netops::getsockopt(
+          otherSocket->getNetworkSocket(),
+          SOL_SOCKET,
+          SO_INCOMING_CPU,
+          &cpu,
+          &len));
+  EXPECT_EQ(1, cpu);
+}
+#endif
+
 class TestRXTimestampsCallback
     : public folly::AsyncSocket::ReadAncillaryDataCallback {
  public:
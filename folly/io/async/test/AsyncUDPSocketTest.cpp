@@ -752,6 +752,21 @@ class MockUDPReadCallback : public AsyncUDPSocket::ReadCallback {
   void onReadClosed() noexcept override { onReadClosed_(); }
 };
 
+class BatchUDPReadCallback : public MockUDPReadCallback {
+ public:
+  void onDataAvailableBatch(
+      folly::Range<Datagram*> datagrams) noexcept override {
+    batchSizes.push_back(datagrams.size());
+    for (auto& datagram : datagrams) {
+      EXPECT_FALSE(datagram.truncated);
+      data.push_back(datagram.data->moveToFbString().toStdString());
+    }
+  }
+
+  std::vector<size_t> batchSizes;
+  std::vector<std::string> data;
+};
+
 class AsyncUDPSocketTest : public Test {
  public:
   void SetUp() override {
@@ -858,6 +873,50 @@ TEST_F(AsyncUDPSocketTest, TestNonExistentServerNoErrCb) {
   EXPECT_FALSE(errRecvd);
 }
 
+TEST_F(AsyncUDPSocketTest, TestReadBatching) {
+  socket_->setReadBatching(8);
+  EXPECT_EQ(8, socket_->getReadBatchSize());
+
+  AsyncUDPSocket writer(&evb_);
+  writer.bind(folly::SocketAddress("127.0.0.1", 0));
+  for (const auto* payload : {"one", "two", "three"}) {
+    writer.write(socket_->address(), folly::IOBuf::copyBuffer(payload));
+  }
+
+  // The datagrams are already queued, so the first read gets all of them.
+  BatchUDPReadCallback batchCb;
+  socket_->resumeRead(&batchCb);
+  evb_.loopOnce();
+  EXPECT_THAT(batchCb.batchSizes, ElementsAre(3));
+  EXPECT_THAT(batchCb.data, ElementsAre("one", "two", "three"));
+
+  socket_->pauseRead();
+  socket_->setReadBatching(0);
+  EXPECT_EQ(0, socket_->getReadBatchSize());
+}
+
+TEST_F(AsyncUDPSocketTest, TestReadBatchingDefaultCallback) {
+  socket_->setReadBatching(8, 2);
+
+  AsyncUDPSocket writer(&evb_);
+  writer.bind(folly::SocketAddress("127.0.0.1", 0));
+  writer.write(socket_->address(), folly::IOBuf::copyBuffer("a"));
+  writer.write(socket_->address(), folly::IOBuf::copyBuffer("bcd"));
+
+  // Datagrams are passed on to onDataAvailable(), truncated to packetSize.
+  char buf[16];
+  EXPECT_CALL(readCb, getReadBuffer_(_, _))
+      .WillRepeatedly(Invoke([&buf](void** data, size_t* len) {
+        *data = buf;
+        *len = sizeof(buf);
+      }));
+  EXPECT_CALL(readCb, onDataAvailable_(_, 1, false, _));
+  EXPECT_CALL(readCb, onDataAvailable_(_, 2, true, _));
+  socket_->resumeRead(&readCb);
+  evb_.loopOnce();
+  socket_->pauseRead();
+}
+
 TEST_F(AsyncUDPSocketTest, TestBound) {
   AsyncUDPSocket socket(&evb_);
   EXPECT_FALSE(socket.isBound());
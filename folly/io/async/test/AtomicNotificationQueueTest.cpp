@@ -15,6 +15,7 @@
  */
 
 #include <functional>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -177,3 +178,63 @@ TEST(AtomicNotificationQueueTest, PutMessage) {
     EXPECT_EQ(expected[i], actual[i]);
   }
 }
+
+TEST(AtomicNotificationQueueTest, PutMessages) {
+  vector<int> data;
+  AtomicNotificationQueueConsumer<int> consumer{data};
+  EventBaseAtomicNotificationQueue<int, decltype(consumer)> queue{
+      std::move(consumer)};
+
+  queue.putMessage(1);
+  vector<int> batch = {2, 3, 4};
+  queue.putMessages(batch.data(), batch.data() + batch.size());
+  queue.putMessages(batch.data(), batch.data());
+  queue.putMessage(5);
+  EXPECT_EQ(5, queue.size());
+
+  queue.drain();
+  EXPECT_EQ((vector<int>{1, 2, 3, 4, 5}), data);
+  EXPECT_EQ(0, queue.size());
+}
+
+TEST(AtomicNotificationQueueTest, PutMessagesConcurrent) {
+  constexpr int kProducers = 4;
+  constexpr int kBatches = 100;
+  constexpr int kBatchSize = 10;
+
+  vector<int> data;
+  AtomicNotificationQueueConsumer<int> consumer{data};
+  EventBaseAtomicNotificationQueue<int, decltype(consumer)> queue{
+      std::move(consumer)};
+  EventBase eventBase;
+  queue.startConsuming(&eventBase);
+  queue.setSpinBeforeArm(std::chrono::microseconds(100));
+
+  vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p] {
+      for (int b = 0; b < kBatches; ++b) {
+        vector<int> batch;
+        for (int i = 0; i < kBatchSize; ++i) {
+          batch.push_back(p * kBatches * kBatchSize + b * kBatchSize + i);
+        }
+        queue.putMessages(batch.data(), batch.data() + batch.size());
+      }
+    });
+  }
+  while (data.size() < size_t(kProducers * kBatches * kBatchSize)) {
+    eventBase.loopOnce();
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  queue.stopConsuming();
+
+  // Each producer's tasks are consumed in order.
+  vector<int> last(kProducers, -1);
+  for (auto value : data) {
+    auto p = value / (kBatches * kBatchSize);
+    EXPECT_LT(last[p], value);
+    last[p] = value;
+  }
+}
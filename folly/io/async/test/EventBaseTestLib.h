@@ -1538,6 +1538,78 @@ TYPED_TEST_P(EventBaseTest, RunInEventBaseThreadAndWait) {
   EXPECT_EQ(c, sum);
 }
 
+TYPED_TEST_P(EventBaseTest, RunInEventBaseThreadBatch) {
+  auto evbPtr = this->makeEventBase();
+  std::vector<int> ran;
+  std::vector<Func> batch;
+  for (int i = 0; i < 10; ++i) {
+    batch.push_back([&ran, i] { ran.push_back(i); });
+  }
+  std::thread([&] { evbPtr->runInEventBaseThreadBatch(range(batch)); })
+      .join();
+  EXPECT_EQ(10, evbPtr->getNotificationQueueSize());
+  evbPtr->loopOnce();
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), ran);
+
+  // From the EventBase thread the functions run in the loop.
+  ran.clear();
+  batch.clear();
+  for (int i = 0; i < 3; ++i) {
+    batch.push_back([&ran, i] { ran.push_back(i); });
+  }
+  evbPtr->runInEventBaseThread(
+      [&] { evbPtr->runInEventBaseThreadBatch(range(batch)); });
+  evbPtr->loopOnce();
+  evbPtr->loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ((std::vector<int>{0, 1, 2}), ran);
+}
+
+TYPED_TEST_P(EventBaseTest, AddWithPriority) {
+  auto evbPtr = this->makeEventBase(
+      folly::EventBase::Options().setBackgroundTasksPerLoop(2));
+  EXPECT_EQ(3, evbPtr->getNumPriorities());
+  std::vector<std::string> ran;
+  auto add = [&](std::string name, int8_t priority) {
+    evbPtr->addWithPriority(
+        [&ran, name] { ran.push_back(name); }, priority);
+  };
+  std::thread([&] {
+    add("b0", Executor::LO_PRI);
+    add("b1", Executor::LO_PRI);
+    add("b2", Executor::LO_PRI);
+    add("n0", Executor::MID_PRI);
+    add("n1", Executor::MID_PRI);
+    add("h0", Executor::HI_PRI);
+    add("h1", 1);
+  }).join();
+  // Including the wakeup of the lanes.
+  EXPECT_EQ(8, evbPtr->getNotificationQueueSize());
+
+  // High priority work jumps ahead of the normal priority work queued before
+  // it, background work is limited per iteration.
+  evbPtr->loopOnce();
+  EXPECT_EQ(
+      (std::vector<std::string>{"h0", "h1", "n0", "n1", "b0", "b1"}), ran);
+  evbPtr->loopOnce();
+  EXPECT_EQ(7, ran.size());
+  EXPECT_EQ("b2", ran.back());
+
+  // From the EventBase thread, and on destruction.
+  ran.clear();
+  evbPtr->runInEventBaseThread([&] {
+    add("b3", Executor::LO_PRI);
+    add("h2", Executor::HI_PRI);
+  });
+  evbPtr->loopOnce();
+  evbPtr->loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ((std::vector<std::string>{"h2", "b3"}), ran);
+  ran.clear();
+  add("b4", Executor::LO_PRI);
+  add("h3", Executor::HI_PRI);
+  evbPtr.reset();
+  EXPECT_EQ((std::vector<std::string>{"h3", "b4"}), ran);
+}
+
 TYPED_TEST_P(EventBaseTest, RunImmediatelyOrRunInEventBaseThreadAndWaitCross) {
   auto evbPtr = this->makeEventBase();
   folly::EventBase& eb = *evbPtr;
@@ -1670,6 +1742,47 @@ TYPED_TEST_P(EventBaseTest, RunInLoopNoTimeMeasurement) {
   ASSERT_EQ(c.getCount(), 0);
 }
 
+// Test that a busy-polling EventBase still runs work from other threads, and
+// that its busy-poll budget decays away while it is idle.
+TYPED_TEST_P(EventBaseTest, BusyPoll) {
+  auto evbPtr = this->makeEventBase(
+      EventBase::Options().setBusyPollMax(std::chrono::microseconds(100)));
+  folly::EventBase& eventBase = *evbPtr;
+  std::thread t([&] { eventBase.loopForever(); });
+  SCOPE_EXIT {
+    eventBase.terminateLoopSoon();
+    t.join();
+  };
+
+  constexpr int kNumTasks = 100;
+  int ran = 0;
+  for (int i = 0; i < kNumTasks; ++i) {
+    eventBase.runInEventBaseThreadAndWait([&] { ++ran; });
+  }
+  EXPECT_EQ(kNumTasks, ran);
+
+  // Chain timeouts so that the loop keeps waiting with nothing else to do:
+  // every such wait at least halves the budget.
+  constexpr int kNumTimeouts = 20;
+  int remaining = kNumTimeouts;
+  std::chrono::nanoseconds budget{1};
+  folly::Baton<> done;
+  folly::Function<void()> tick = [&] {
+    if (--remaining == 0) {
+      budget = eventBase.getBusyPollBudget();
+      done.post();
+    } else {
+      eventBase.runAfterDelay([&] { tick(); }, 1);
+    }
+  };
+  eventBase.runInEventBaseThread([&] { tick(); });
+  done.wait();
+  EXPECT_EQ(0, budget.count());
+
+  eventBase.runInEventBaseThreadAndWait([&] { ++ran; });
+  EXPECT_EQ(kNumTasks + 1, ran);
+}
+
 // Test runInLoop() calls with terminateLoopSoon()
 TYPED_TEST_P(EventBaseTest, RunInLoopStopLoop) {
   auto evbPtr = this->makeEventBase();
@@ -2634,6 +2747,54 @@ TYPED_TEST_P(EventBaseTest, EventBaseObserver) {
   ASSERT_EQ(1, observer2->getNumTimesCalled());
 }
 
+TYPED_TEST_P(EventBaseTest, LoopProfiling) {
+  using Phase = EventBaseLoopProfiler::Phase;
+  auto evbPtr = this->makeEventBase();
+  EXPECT_EQ(nullptr, evbPtr->getLoopProfiler());
+  evbPtr->setLoopProfiling(true);
+  auto spin = [](std::chrono::milliseconds duration) {
+    auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+    }
+  };
+  evbPtr->runInEventBaseThread([&] {
+    spin(std::chrono::milliseconds(5));
+    // Loop callbacks scheduled by a queued function are charged separately.
+    evbPtr->runInLoop([&] { spin(std::chrono::milliseconds(2)); });
+  });
+  evbPtr->runAfterDelay([&] { spin(std::chrono::milliseconds(10)); }, 1);
+  evbPtr->loop();
+
+  auto* profiler = evbPtr->getLoopProfiler();
+  ASSERT_NE(nullptr, profiler);
+  auto stats = profiler->getStats();
+  EXPECT_GE(stats.loops, 1);
+  EXPECT_GE(
+      stats[Phase::NotificationQueue].total, std::chrono::milliseconds(5));
+  EXPECT_LT(
+      stats[Phase::NotificationQueue].total, std::chrono::milliseconds(10));
+  EXPECT_GE(stats[Phase::LoopCallbacks].total, std::chrono::milliseconds(2));
+  EXPECT_GE(stats[Phase::Timers].total, std::chrono::milliseconds(10));
+  EXPECT_GE(stats[Phase::Timers].max, std::chrono::milliseconds(9));
+  EXPECT_GE(stats.iteration.max, std::chrono::milliseconds(9));
+
+  // Every nanosecond of the iterations is charged to exactly one phase.
+  std::chrono::nanoseconds sum{0};
+  for (const auto& phase : stats.phases) {
+    sum += phase.total;
+  }
+  EXPECT_EQ(stats.iteration.total, sum);
+
+  // Disabling keeps the stats, reset() clears them.
+  evbPtr->setLoopProfiling(false);
+  evbPtr->loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(stats.loops, profiler->getStats().loops);
+  profiler->reset();
+  EXPECT_EQ(0, profiler->getStats().loops);
+  EXPECT_EQ(
+      std::chrono::nanoseconds(0), profiler->getStats()[Phase::Timers].total);
+}
+
 TYPED_TEST_P(EventBaseTest, LoopRearmsNotificationQueue) {
   auto evbPtr = this->makeEventBase();
   std::atomic<size_t> n = 0;
@@ -2772,6 +2933,8 @@ REGISTER_TYPED_TEST_SUITE_P(
     ScheduledFnAt,
     RunInThread,
     RunInEventBaseThreadAndWait,
+    RunInEventBaseThreadBatch,
+    AddWithPriority,
     RunImmediatelyOrRunInEventBaseThreadAndWaitCross,
     RunImmediatelyOrRunInEventBaseThreadAndWaitWithin,
     RunImmediatelyOrRunInEventBaseThreadAndWaitNotLooping,
@@ -2806,6 +2969,7 @@ REGISTER_TYPED_TEST_SUITE_P(
     LoopKeepAliveCast,
     LastLoopKeepAliveTriggeringDestruction,
     EventBaseObserver,
+    LoopProfiling,
     LoopRearmsNotificationQueue,
     GetThreadIdCollector,
     Suspension,
@@ -2820,7 +2984,8 @@ REGISTER_TYPED_TEST_SUITE_P(
     RunOnDestructionAddCallbackWithinCallback,
     InternalExternalCallbackOrderTest,
     PidCheck,
-    EventBaseExecutionObserver);
+    EventBaseExecutionObserver,
+    BusyPoll);
 
 } // namespace test
 } // namespace folly
@@ -559,6 +559,144 @@ TEST_F(HHWheelTimerTest, NegativeTimeout) {
   T_CHECK_TIMEOUT(start, end, milliseconds(1));
 }
 
+TEST_F(HHWheelTimerTest, CancelAllPredicate) {
+  StackWheelTimer t(&eventBase, milliseconds(1));
+  TestTimeout t1;
+  TestTimeout t2;
+  TestTimeout t3;
+  t.scheduleTimeout(&t1, milliseconds(5));
+  t.scheduleTimeout(&t2, milliseconds(500));
+  t.scheduleTimeout(&t3, milliseconds(5));
+
+  EXPECT_EQ(2, t.cancelAll([&](HHWheelTimer::Callback& cb) {
+    return &cb != &t2;
+  }));
+  ASSERT_EQ(t.count(), 1);
+  EXPECT_EQ(t1.canceledTimestamps.size(), 1);
+  EXPECT_EQ(t2.canceledTimestamps.size(), 0);
+  EXPECT_EQ(t3.canceledTimestamps.size(), 1);
+
+  eventBase.loop();
+  EXPECT_EQ(t1.timestamps.size(), 0);
+  EXPECT_EQ(t2.timestamps.size(), 1);
+  EXPECT_EQ(t3.timestamps.size(), 0);
+}
+
+TEST_F(HHWheelTimerTest, TimeoutBuckets) {
+  StackWheelTimer t(&eventBase, milliseconds(1));
+  t.setTimeoutBucketsEnabled(true);
+
+  TestTimeout t1;
+  TestTimeout t2;
+  TestTimeout t3;
+  TestTimeout t4;
+  t.scheduleTimeout(&t1, milliseconds(5));
+  t.scheduleTimeout(&t2, milliseconds(5));
+  t.scheduleTimeout(&t3, milliseconds(300));
+  t.scheduleTimeout(&t4, milliseconds(300));
+  ASSERT_EQ(t.count(), 4);
+
+  // Cancelling the head of a bucket leaves the rest of it scheduled.
+  t3.cancelTimeout();
+  ASSERT_EQ(t.count(), 3);
+
+  TimePoint start;
+  eventBase.loop();
+  TimePoint end;
+
+  ASSERT_EQ(t1.timestamps.size(), 1);
+  ASSERT_EQ(t2.timestamps.size(), 1);
+  ASSERT_EQ(t3.timestamps.size(), 0);
+  ASSERT_EQ(t4.timestamps.size(), 1);
+  ASSERT_EQ(t.count(), 0);
+
+  T_CHECK_TIMEOUT(start, t1.timestamps[0], milliseconds(5));
+  T_CHECK_TIMEOUT(start, t2.timestamps[0], milliseconds(5));
+  T_CHECK_TIMEOUT(start, t4.timestamps[0], milliseconds(300));
+  T_CHECK_TIMEOUT(start, end, milliseconds(300));
+}
+
+TEST_F(HHWheelTimerTest, TimeoutBucketsReschedule) {
+  StackWheelTimer t(&eventBase, milliseconds(1));
+  t.setTimeoutBucketsEnabled(true);
+
+  // Reschedule from the callback, as a connection idle timeout would.
+  TestTimeout t1;
+  t1.fn = [&] {
+    if (t1.timestamps.size() < 3) {
+      t.scheduleTimeout(&t1, milliseconds(10));
+    }
+  };
+  t.scheduleTimeout(&t1, milliseconds(10));
+
+  TimePoint start;
+  eventBase.loop();
+  TimePoint end;
+
+  ASSERT_EQ(t1.timestamps.size(), 3);
+  ASSERT_EQ(t.count(), 0);
+  T_CHECK_TIMEOUT(start, end, milliseconds(30));
+}
+
+TEST_F(HHWheelTimerTest, TimeoutBucketsCancelAll) {
+  StackWheelTimer t(&eventBase, milliseconds(1));
+  t.setTimeoutBucketsEnabled(true);
+
+  TestTimeout t1;
+  TestTimeout t2;
+  TestTimeout t3;
+  t.scheduleTimeout(&t1, milliseconds(5));
+  t.scheduleTimeout(&t2, milliseconds(5));
+  t.scheduleTimeout(&t3, milliseconds(10));
+
+  EXPECT_EQ(1, t.cancelAll([&](HHWheelTimer::Callback& cb) {
+    return &cb == &t1;
+  }));
+  ASSERT_EQ(t.count(), 2);
+
+  EXPECT_EQ(2, t.cancelAll());
+  ASSERT_EQ(t.count(), 0);
+  EXPECT_EQ(t1.canceledTimestamps.size(), 1);
+  EXPECT_EQ(t2.canceledTimestamps.size(), 1);
+  EXPECT_EQ(t3.canceledTimestamps.size(), 1);
+
+  eventBase.loop();
+  EXPECT_EQ(t1.timestamps.size(), 0);
+  EXPECT_EQ(t2.timestamps.size(), 0);
+  EXPECT_EQ(t3.timestamps.size(), 0);
+}
+
+TEST_F(HHWheelTimerTest, TimeoutBucketsCancelAllReschedule) {
+  StackWheelTimer t(&eventBase, milliseconds(1));
+  t.setTimeoutBucketsEnabled(true);
+
+  // A callback rescheduling itself when cancelled is neither cancelled
+  // again nor counted by the same cancelAll().
+  TestTimeout t1;
+  TestTimeout t2;
+  TestTimeout t3;
+  t1.fn = [&] {
+    if (t1.canceledTimestamps.size() == 1 && t1.timestamps.empty()) {
+      t.scheduleTimeout(&t1, milliseconds(5));
+    }
+  };
+  t.scheduleTimeout(&t1, milliseconds(5));
+  t.scheduleTimeout(&t2, milliseconds(5));
+  t.scheduleTimeout(&t3, milliseconds(10));
+
+  EXPECT_EQ(3, t.cancelAll());
+  ASSERT_EQ(t.count(), 1);
+  EXPECT_EQ(t1.canceledTimestamps.size(), 1);
+  EXPECT_EQ(t2.canceledTimestamps.size(), 1);
+  EXPECT_EQ(t3.canceledTimestamps.size(), 1);
+
+  eventBase.loop();
+  EXPECT_EQ(t1.timestamps.size(), 1);
+  EXPECT_EQ(t2.timestamps.size(), 0);
+  EXPECT_EQ(t3.timestamps.size(), 0);
+  ASSERT_EQ(t.count(), 0);
+}
+
 TEST(HHWheelTimerDetailsTest, Divider) {
   auto no_overflow_add = [](uint64_t& base, int offset) -> bool {
     if (offset >= 0 || static_cast<unsigned int>(-offset) < base) {
@@ -152,6 +152,58 @@ TEST_F(RequestContextTest, RequestContextScopeGuard) {
   EXPECT_EQ(1, getData().unset_);
 }
 
+TEST_F(RequestContextTest, PinnedRequestContextScopeGuard) {
+  RequestContextScopeGuard g0;
+  setData(10);
+  auto ctx = RequestContext::saveContext();
+  auto const useCount = ctx.use_count();
+  {
+    // Already current: nothing changes.
+    PinnedRequestContextScopeGuard g1{ctx};
+    EXPECT_EQ(ctx.get(), RequestContext::get());
+    EXPECT_EQ(useCount, ctx.use_count());
+    EXPECT_EQ(1, getData().set_);
+    EXPECT_EQ(0, getData().unset_);
+  }
+  EXPECT_EQ(1, getData().set_);
+  EXPECT_EQ(0, getData().unset_);
+
+  auto other = std::make_shared<RequestContext>();
+  {
+    PinnedRequestContextScopeGuard g2{other};
+    EXPECT_EQ(other.get(), RequestContext::get());
+    EXPECT_FALSE(hasData());
+  }
+  EXPECT_EQ(ctx.get(), RequestContext::get());
+  EXPECT_EQ(10, getData().data_);
+  EXPECT_EQ(2, getData().set_);
+  EXPECT_EQ(1, getData().unset_);
+}
+
+TEST_F(RequestContextTest, IfChanged) {
+  RequestContextScopeGuard g0;
+  setData(10);
+  auto ctx = RequestContext::saveContext();
+  auto const useCount = ctx.use_count();
+
+  RequestContext::setContextIfChanged(ctx);
+  RequestContext::saveContextIfChanged(ctx);
+  EXPECT_EQ(useCount, ctx.use_count());
+  EXPECT_EQ(1, getData().set_);
+  EXPECT_EQ(0, getData().unset_);
+
+  auto other = std::make_shared<RequestContext>();
+  RequestContext::setContextIfChanged(other);
+  EXPECT_EQ(other.get(), RequestContext::get());
+  RequestContext::saveContextIfChanged(ctx);
+  EXPECT_EQ(other, ctx);
+
+  RequestContext::setContextIfChanged(nullptr);
+  EXPECT_EQ(nullptr, RequestContext::saveContext());
+  RequestContext::saveContextIfChanged(ctx);
+  EXPECT_EQ(nullptr, ctx);
+}
+
 TEST_F(RequestContextTest, defaultContext) {
   // Don't create a top level guard
   setData(10);
@@ -25,6 +25,8 @@
 #include <folly/portability/GTest.h>
 #include <folly/portability/OpenSSL.h>
 #include <folly/portability/Sockets.h>
+#include <folly/ssl/RotatingTicketHandler.h>
+#include <folly/ssl/ServerSessionCache.h>
 #include <folly/ssl/detail/OpenSSLSession.h>
 
 using folly::ssl::SSLSession;
@@ -45,6 +47,12 @@ class SSLSessionTest : public testing::Test {
 
   void TearDown() override {}
 
+  // Runs a full handshake and returns the session the client got.
+  ssl::SSLSessionUniquePtr getSessionFromHandshake();
+
+  // Connects with the given session and returns whether it was resumed.
+  bool resumeSession(ssl::SSLSessionUniquePtr session);
+
   void getfds(NetworkSocket fds[2]) {
     if (netops::socketpair(PF_LOCAL, SOCK_STREAM, 0, fds) != 0) {
       FAIL() << "failed to create socketpair: " << errnoStr(errno);
@@ -130,6 +138,46 @@ class SimpleReadCallback : public AsyncTransport::ReadCallback {
   char buffer_[1024];
 };
 
+ssl::SSLSessionUniquePtr SSLSessionTest::getSessionFromHandshake() {
+  NetworkSocket fds[2];
+  getfds(fds);
+  auto sessionCb = std::make_unique<SimpleSessionLifecycleCallback>();
+  auto sessionCbPtr = sessionCb.get();
+  clientCtx_->setSessionLifecycleCallbacks(std::move(sessionCb));
+
+  AsyncSSLSocket::UniquePtr clientSock(
+      new AsyncSSLSocket(clientCtx_, &eventBase_, fds[0], serverName_));
+  auto clientPtr = clientSock.get();
+  AsyncSSLSocket::UniquePtr serverSock(
+      new AsyncSSLSocket(dfServerCtx_, &eventBase_, fds[1], true));
+  SSLHandshakeClient client(std::move(clientSock), false, false);
+  SSLHandshakeServerParseClientHello server(
+      std::move(serverSock), false, false);
+  sessionCbPtr->socket_ = clientPtr;
+  SimpleReadCallback readCb;
+  clientPtr->setReadCB(&readCb);
+  eventBase_.loop();
+  EXPECT_TRUE(client.handshakeSuccess_);
+  return std::move(sessionCbPtr->session_);
+}
+
+bool SSLSessionTest::resumeSession(ssl::SSLSessionUniquePtr session) {
+  NetworkSocket fds[2];
+  getfds(fds);
+  AsyncSSLSocket::UniquePtr clientSock(
+      new AsyncSSLSocket(clientCtx_, &eventBase_, fds[0], serverName_));
+  auto clientPtr = clientSock.get();
+  clientPtr->setRawSSLSession(std::move(session));
+  AsyncSSLSocket::UniquePtr serverSock(
+      new AsyncSSLSocket(dfServerCtx_, &eventBase_, fds[1], true));
+  SSLHandshakeClient client(std::move(clientSock), false, false);
+  SSLHandshakeServerParseClientHello server(
+      std::move(serverSock), false, false);
+  eventBase_.loop();
+  EXPECT_TRUE(client.handshakeSuccess_);
+  return clientPtr->getSSLSessionReused();
+}
+
 TEST_F(SSLSessionTest, BasicTest) {
   ssl::SSLSessionUniquePtr sslSession;
   // Full handshake
@@ -205,3 +253,39 @@ TEST_F(SSLSessionTest, NullSessionResumptionTest) {
     ASSERT_FALSE(clientPtr->getSSLSessionReused());
   }
 }
+
+TEST_F(SSLSessionTest, ServerSessionCacheTest) {
+  // Without tickets, sessions can only be resumed from the server's cache.
+  dfServerCtx_->setOptions(SSL_OP_NO_TICKET);
+  auto cache = std::make_shared<ssl::ServerSessionCache>();
+  dfServerCtx_->setServerSessionCache(cache);
+
+  auto session = getSessionFromHandshake();
+  ASSERT_TRUE(session != nullptr);
+  EXPECT_LT(0, cache->size());
+  EXPECT_TRUE(resumeSession(std::move(session)));
+}
+
+TEST_F(SSLSessionTest, RotatingTicketHandlerTest) {
+  using TicketKey = ssl::RotatingTicketHandler::TicketKey;
+  auto keyA = TicketKey::fromSecret(ByteRange(StringPiece("secret A")));
+  auto keyB = TicketKey::fromSecret(ByteRange(StringPiece("secret B")));
+  auto handler = std::make_unique<ssl::RotatingTicketHandler>(
+      std::vector<TicketKey>{keyA});
+  auto handlerPtr = handler.get();
+  dfServerCtx_->setTicketHandler(std::move(handler));
+
+  auto session = getSessionFromHandshake();
+  ASSERT_TRUE(session != nullptr);
+  SSL_SESSION_up_ref(session.get());
+  ssl::SSLSessionUniquePtr sessionCopy(session.get());
+
+  // Tickets encrypted with a key that is rotated out but still accepted can
+  // be resumed.
+  handlerPtr->setTicketKeys({keyB, keyA});
+  EXPECT_TRUE(resumeSession(std::move(session)));
+
+  // Once the key is dropped, they can't.
+  handlerPtr->setTicketKeys({keyB});
+  EXPECT_FALSE(resumeSession(std::move(sessionCopy)));
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/StreamWriteScheduler.h>
+
+#include <folly/portability/GTest.h>
+#include <folly/portability/Sockets.h>
+
+using namespace folly;
+
+namespace {
+
+// Counts the chains the scheduler hands to the socket.
+class CountingSocket : public AsyncSocket {
+ public:
+  using AsyncSocket::AsyncSocket;
+
+  void writeChain(
+      WriteCallback* callback,
+      std::unique_ptr<IOBuf>&& buf,
+      WriteFlags flags = WriteFlags::NONE) override {
+    ++writes;
+    AsyncSocket::writeChain(callback, std::move(buf), flags);
+  }
+
+  size_t writes{0};
+};
+
+class StreamWriteSchedulerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::array<NetworkSocket, 2> fds;
+    PCHECK(0 == netops::socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()));
+    PCHECK(0 == netops::set_socket_non_blocking(fds[0]));
+    socket_.reset(new CountingSocket(&evb_, fds[0]));
+    peer_ = fds[1];
+  }
+
+  void TearDown() override { netops::close(peer_); }
+
+  // A frame of `length` copies of `c`.
+  static std::unique_ptr<IOBuf> frame(char c, size_t length) {
+    auto buf = IOBuf::create(length);
+    memset(buf->writableData(), c, length);
+    buf->append(length);
+    return buf;
+  }
+
+  // Reads what the peer received, keeping the first byte of each frame.
+  std::string readFrames(size_t frameLength, size_t count) {
+    std::string frames;
+    std::string buf(frameLength * count, '\0');
+    size_t received = 0;
+    while (received < buf.size()) {
+      auto n = netops::recv(
+          peer_, &buf[received], buf.size() - received, /* flags */ 0);
+      PCHECK(n > 0);
+      received += size_t(n);
+    }
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(
+          std::string(frameLength, buf[i * frameLength]),
+          buf.substr(i * frameLength, frameLength));
+      frames += buf[i * frameLength];
+    }
+    return frames;
+  }
+
+  EventBase evb_;
+  std::unique_ptr<CountingSocket, DelayedDestruction::Destructor> socket_;
+  NetworkSocket peer_;
+};
+
+} // namespace
+
+TEST_F(StreamWriteSchedulerTest, WeightedRoundRobin) {
+  StreamWriteScheduler::Options options;
+  options.quantum = 100;
+  StreamWriteScheduler scheduler(socket_.get(), options);
+  scheduler.setStreamWeight(2, 3);
+  for (int i = 0; i < 4; ++i) {
+    scheduler.enqueue(1, frame('a', 100));
+  }
+  for (int i = 0; i < 4; ++i) {
+    scheduler.enqueue(2, frame('b', 100));
+  }
+  EXPECT_EQ(400, scheduler.pendingBytes(1));
+  EXPECT_EQ(800, scheduler.pendingBytes());
+
+  // Nothing is written before the end of the loop iteration.
+  EXPECT_EQ(0, socket_->writes);
+  evb_.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_EQ(0, scheduler.pendingBytes());
+  // All the frames fit in one gather.
+  EXPECT_EQ(1, socket_->writes);
+  EXPECT_EQ("abbbabaa", readFrames(100, 8));
+}
+
+TEST_F(StreamWriteSchedulerTest, DeficitCarriesOver) {
+  StreamWriteScheduler::Options options;
+  options.quantum = 100;
+  StreamWriteScheduler scheduler(socket_.get(), options);
+  // A frame larger than the quantum waits until the stream earned enough.
+  scheduler.enqueue(1, frame('a', 250));
+  scheduler.enqueue(2, frame('b', 100));
+  scheduler.enqueue(2, frame('b', 100));
+  scheduler.enqueue(2, frame('b', 100));
+  scheduler.flush();
+  EXPECT_EQ(0, scheduler.pendingBytes());
+
+  std::string received(550, '\0');
+  size_t n = 0;
+  while (n < received.size()) {
+    auto ret = netops::recv(peer_, &received[n], received.size() - n, 0);
+    PCHECK(ret > 0);
+    n += size_t(ret);
+  }
+  EXPECT_EQ(
+      std::string(200, 'b') + std::string(250, 'a') + std::string(100, 'b'),
+      received);
+}
+
+TEST_F(StreamWriteSchedulerTest, GathersUpToMaxBytes) {
+  StreamWriteScheduler::Options options;
+  options.quantum = 1000;
+  options.maxGatherBytes = 250;
+  StreamWriteScheduler scheduler(socket_.get(), options);
+  for (int i = 0; i < 6; ++i) {
+    scheduler.enqueue(i % 2, frame(char('a' + i % 2), 100));
+  }
+  scheduler.flush();
+  EXPECT_EQ(3, socket_->writes);
+  EXPECT_EQ("aaabbb", readFrames(100, 6));
+}
+
+TEST_F(StreamWriteSchedulerTest, WaitsForSocketBuffer) {
+  int sndbuf = 4096;
+  PCHECK(
+      0 ==
+      netops::setsockopt(
+          socket_->getNetworkSocket(),
+          SOL_SOCKET,
+          SO_SNDBUF,
+          &sndbuf,
+          sizeof(sndbuf)));
+  StreamWriteScheduler::Options options;
+  options.quantum = 1000;
+  options.maxGatherBytes = 4000;
+  StreamWriteScheduler scheduler(socket_.get(), options);
+
+  constexpr size_t kFrames = 200;
+  for (size_t i = 0; i < kFrames; ++i) {
+    scheduler.enqueue(i % 2, frame(char('a' + i % 2), 1000));
+  }
+  scheduler.flush();
+  // The socket filled up, the rest stays queued.
+  EXPECT_TRUE(scheduler.hasPendingWrite());
+  EXPECT_GT(scheduler.pendingBytes(), 0);
+  size_t writes = socket_->writes;
+
+  // A late frame of a new stream gets its turn before the older ones.
+  scheduler.enqueue(2, frame('c', 1000));
+
+  std::string frames;
+  std::thread reader([&] { frames = readFrames(1000, kFrames + 1); });
+  while (scheduler.pendingBytes() > 0 || scheduler.hasPendingWrite()) {
+    evb_.loopOnce();
+  }
+  reader.join();
+  EXPECT_GT(socket_->writes, writes);
+
+  auto c = frames.find('c');
+  ASSERT_NE(std::string::npos, c);
+  EXPECT_LT(c, kFrames - 4);
+  frames.erase(c, 1);
+  for (size_t i = 0; i < kFrames; ++i) {
+    EXPECT_EQ(char('a' + i % 2), frames[i]) << i;
+  }
+}
+
+TEST_F(StreamWriteSchedulerTest, RemoveStream) {
+  StreamWriteScheduler scheduler(socket_.get());
+  scheduler.enqueue(1, frame('a', 10));
+  scheduler.enqueue(2, frame('b', 10));
+  scheduler.removeStream(1);
+  EXPECT_EQ(0, scheduler.pendingBytes(1));
+  EXPECT_EQ(10, scheduler.pendingBytes());
+  scheduler.flush();
+  EXPECT_EQ("b", readFrames(10, 1));
+}
+
+TEST_F(StreamWriteSchedulerTest, WriteError) {
+  StreamWriteScheduler scheduler(socket_.get());
+  bool failed = false;
+  scheduler.setErrorCallback([&](const AsyncSocketException&) {
+    failed = true;
+  });
+  socket_->shutdownWriteNow();
+  scheduler.enqueue(1, frame('a', 10));
+  scheduler.enqueue(2, frame('b', 10));
+  scheduler.flush();
+  EXPECT_TRUE(failed);
+  EXPECT_EQ(0, scheduler.pendingBytes());
+  scheduler.enqueue(1, frame('a', 10));
+  EXPECT_EQ(0, scheduler.pendingBytes());
+}
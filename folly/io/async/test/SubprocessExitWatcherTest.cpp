@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/async/SubprocessExitWatcher.h>
+
+#include <folly/io/async/EventBase.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+Subprocess spawnWithPidfd(std::vector<std::string> argv) {
+  return Subprocess(std::move(argv), Subprocess::Options().usePidfd());
+}
+} // namespace
+
+TEST(SubprocessExitWatcherTest, Exit) {
+  EventBase evb;
+  auto proc = spawnWithPidfd({"/bin/sh", "-c", "exit 3"});
+  if (proc.pidfd() < 0) {
+    proc.wait();
+    GTEST_SKIP() << "pidfd_open() is not supported";
+  }
+  Optional<ProcessReturnCode> result;
+  SubprocessExitWatcher watcher(
+      &evb, proc, [&](ProcessReturnCode rc) { result = rc; });
+  EXPECT_TRUE(watcher.isWatching());
+  evb.loop();
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(3, result->exitStatus());
+  EXPECT_FALSE(watcher.isWatching());
+  EXPECT_EQ(-1, proc.pidfd());
+}
+
+TEST(SubprocessExitWatcherTest, Killed) {
+  EventBase evb;
+  auto proc = spawnWithPidfd({"/bin/sleep", "3600"});
+  if (proc.pidfd() < 0) {
+    proc.kill();
+    proc.wait();
+    GTEST_SKIP() << "pidfd_open() is not supported";
+  }
+  Optional<ProcessReturnCode> result;
+  SubprocessExitWatcher watcher(
+      &evb, proc, [&](ProcessReturnCode rc) { result = rc; });
+  evb.runInLoop([&] { proc.kill(); });
+  evb.loop();
+  ASSERT_TRUE(result.has_value());
+  EXPECT_TRUE(result->killed());
+}
+
+TEST(SubprocessExitWatcherTest, DestroyBeforeExit) {
+  EventBase evb;
+  auto proc = spawnWithPidfd({"/bin/sleep", "3600"});
+  if (proc.pidfd() < 0) {
+    proc.kill();
+    proc.wait();
+    GTEST_SKIP() << "pidfd_open() is not supported";
+  }
+  {
+    SubprocessExitWatcher watcher(
+        &evb, proc, [](ProcessReturnCode) { ADD_FAILURE(); });
+  }
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  proc.kill();
+  EXPECT_TRUE(proc.wait().killed());
+}
+
+TEST(SubprocessExitWatcherTest, NoPidfd) {
+  EventBase evb;
+  Subprocess proc(std::vector<std::string>{"/bin/true"});
+  EXPECT_THROW(
+      SubprocessExitWatcher(&evb, proc, [](ProcessReturnCode) {}),
+      std::invalid_argument);
+  proc.wait();
+}
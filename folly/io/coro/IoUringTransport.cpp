@@ -0,0 +1,485 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/coro/IoUringTransport.h>
+
+#if FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
+
+#include <optional>
+
+#include <folly/CancellationToken.h>
+#include <folly/experimental/io/IoUringBackend.h>
+#include <folly/experimental/io/IoUringEventBaseLocal.h>
+#include <folly/io/async/HHWheelTimer.h>
+#include <folly/io/async/Request.h>
+#include <folly/net/NetOps.h>
+
+namespace folly {
+namespace coro {
+
+namespace {
+
+IoUringBackend* getBackendFromEventBase(EventBase* evb) {
+  auto* b = IoUringEventBaseLocal::try_get(evb);
+  if (!b) {
+    b = dynamic_cast<IoUringBackend*>(evb->getBackend());
+  }
+  if (!b) {
+    throw std::runtime_error("need to take a IoUringBackend event base");
+  }
+  return b;
+}
+
+int sendMsgFlags(WriteFlags flags) {
+  int msgFlags = MSG_NOSIGNAL;
+  if (isSet(flags, WriteFlags::CORK)) {
+    msgFlags |= MSG_MORE;
+  }
+  if (isSet(flags, WriteFlags::EOR)) {
+    msgFlags |= MSG_EOR;
+  }
+  return msgFlags;
+}
+
+//
+// A single operation on the socket, submitted by the coroutine that awaits
+// it, which is resumed right from the completion.
+//
+
+class IoUringOp : public IoSqeBase, private HHWheelTimer::Callback {
+ public:
+  class Awaiter {
+   public:
+    explicit Awaiter(IoUringOp& op) noexcept : op_(op) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(coroutine_handle<> awaiter) noexcept {
+      return op_.start(awaiter);
+    }
+
+    int await_resume() noexcept { return op_.result_; }
+
+   private:
+    IoUringOp& op_;
+  };
+
+  // Picks up the cancellation token and the executor of the awaiting Task.
+  class SemiAwaitable {
+   public:
+    explicit SemiAwaitable(IoUringOp& op) noexcept : op_(&op) {}
+
+    Awaiter viaIfAsync(Executor::KeepAlive<> executor) && noexcept {
+      op_->executor_ = std::move(executor);
+      return Awaiter{*op_};
+    }
+
+    friend SemiAwaitable co_withCancellation(
+        const CancellationToken& cancelToken,
+        SemiAwaitable&& awaitable) noexcept {
+      awaitable.setCancelToken(cancelToken);
+      return std::move(awaitable);
+    }
+
+   private:
+    void setCancelToken(const CancellationToken& cancelToken) noexcept {
+      op_->cancelToken_ = cancelToken;
+    }
+
+    IoUringOp* op_;
+  };
+
+  IoUringOp(
+      EventBase& evb,
+      IoUringBackend& backend,
+      IoSqeBase::Type type,
+      std::chrono::milliseconds timeout)
+      : IoSqeBase(type), evb_(evb), backend_(backend), timeout_(timeout) {}
+
+  SemiAwaitable run() noexcept { return SemiAwaitable{*this}; }
+
+  // The error to complete the awaiting Task with, when the result is < 0.
+  exception_wrapper error(const char* what) const {
+    using Error = AsyncSocketException::AsyncSocketExceptionType;
+    if (cancelRequested_) {
+      return make_exception_wrapper<OperationCancelled>();
+    }
+    if (timedOut_) {
+      return make_exception_wrapper<AsyncSocketException>(
+          Error::TIMED_OUT, std::string(what) + " timed out");
+    }
+    if (result_ == -ECANCELED) {
+      return make_exception_wrapper<AsyncSocketException>(
+          Error::NOT_OPEN, "socket closed during " + std::string(what));
+    }
+    return make_exception_wrapper<AsyncSocketException>(
+        Error::INTERNAL_ERROR, std::string(what) + " failed", -result_);
+  }
+
+ private:
+  bool start(coroutine_handle<> awaiter) noexcept {
+    DCHECK(evb_.isInEventBaseThread());
+    if (cancelToken_.isCancellationRequested()) {
+      cancelRequested_ = true;
+      result_ = -ECANCELED;
+      return false;
+    }
+    awaiter_ = awaiter;
+    context_ = RequestContext::saveContext();
+    if (timeout_.count() > 0) {
+      evb_.timer().scheduleTimeout(this, timeout_);
+    }
+    if (cancelToken_.canBeCancelled()) {
+      cancelCallback_.emplace(cancelToken_, [this] { onCancelRequested(); });
+    }
+    backend_.submitSoon(*this);
+    if (cancelRequested_) {
+      // Cancellation was requested, on this thread, before submission.
+      backend_.cancel(this);
+    }
+    return true;
+  }
+
+  void onCancelRequested() noexcept {
+    if (evb_.isInEventBaseThread()) {
+      cancelRequested_ = true;
+      if (inFlight()) {
+        backend_.cancel(this);
+      }
+      return;
+    }
+    // The completion won't resume the coroutine until this has run.
+    cancelQueued_.store(true, std::memory_order_release);
+    evb_.runInEventBaseThread([this] {
+      cancelQueued_.store(false, std::memory_order_relaxed);
+      cancelRequested_ = true;
+      if (done_) {
+        resume();
+      } else if (inFlight()) {
+        backend_.cancel(this);
+      }
+    });
+  }
+
+  void timeoutExpired() noexcept override {
+    timedOut_ = true;
+    if (inFlight()) {
+      backend_.cancel(this);
+    }
+  }
+
+  void callback(const io_uring_cqe* cqe) noexcept override {
+    complete(cqe->res);
+  }
+
+  void callbackCancelled(const io_uring_cqe* cqe) noexcept override {
+    complete(cqe->res);
+  }
+
+  void complete(int result) noexcept {
+    result_ = result;
+    done_ = true;
+    cancelTimeout();
+    // Waits for a concurrent onCancelRequested() to return, so that
+    // cancelQueued_ can be trusted below.
+    cancelCallback_.reset();
+    if (!cancelQueued_.load(std::memory_order_acquire)) {
+      resume();
+    }
+  }
+
+  void resume() noexcept {
+    auto awaiter = std::exchange(awaiter_, {});
+    auto context = std::move(context_);
+    if (!executor_ || executor_.get() == &evb_) {
+      // The awaiting coroutine may destroy *this.
+      RequestContextScopeGuard guard(std::move(context));
+      awaiter.resume();
+    } else {
+      executor_->add([awaiter, context = std::move(context)]() mutable {
+        RequestContextScopeGuard guard(std::move(context));
+        awaiter.resume();
+      });
+    }
+  }
+
+  EventBase& evb_;
+  IoUringBackend& backend_;
+  std::chrono::milliseconds timeout_;
+  Executor::KeepAlive<> executor_;
+  CancellationToken cancelToken_;
+  std::optional<CancellationCallback> cancelCallback_;
+  coroutine_handle<> awaiter_;
+  std::shared_ptr<RequestContext> context_;
+  std::atomic<bool> cancelQueued_{false};
+  bool cancelRequested_{false};
+  bool timedOut_{false};
+  bool done_{false};
+
+ protected:
+  int result_{0};
+};
+
+class RecvOp final : public IoUringOp {
+ public:
+  RecvOp(
+      EventBase& evb,
+      IoUringBackend& backend,
+      NetworkSocket fd,
+      void* buf,
+      size_t len,
+      std::chrono::milliseconds timeout)
+      : IoUringOp(evb, backend, IoSqeBase::Type::Read, timeout),
+        fd_(fd),
+        buf_(buf),
+        len_(len) {}
+
+ private:
+  void processSubmit(struct io_uring_sqe* sqe) noexcept override {
+    ::io_uring_prep_recv(sqe, fd_.toFd(), buf_, len_, 0);
+  }
+
+  NetworkSocket fd_;
+  void* buf_;
+  size_t len_;
+};
+
+class SendmsgOp final : public IoUringOp {
+ public:
+  SendmsgOp(
+      EventBase& evb,
+      IoUringBackend& backend,
+      NetworkSocket fd,
+      struct iovec* iov,
+      size_t iovlen,
+      int flags,
+      std::chrono::milliseconds timeout)
+      : IoUringOp(evb, backend, IoSqeBase::Type::Write, timeout),
+        fd_(fd),
+        flags_(flags) {
+    msg_.msg_iov = iov;
+    msg_.msg_iovlen = iovlen;
+  }
+
+ private:
+  void processSubmit(struct io_uring_sqe* sqe) noexcept override {
+    ::io_uring_prep_sendmsg(sqe, fd_.toFd(), &msg_, flags_);
+  }
+
+  NetworkSocket fd_;
+  struct msghdr msg_ {};
+  int flags_;
+};
+
+} // namespace
+
+IoUringTransport::IoUringTransport(EventBase* eventBase, NetworkSocket fd)
+    : eventBase_(eventBase),
+      backend_(getBackendFromEventBase(eventBase)),
+      fd_(fd) {}
+
+IoUringTransport::IoUringTransport(IoUringTransport&& other) noexcept
+    : eventBase_(other.eventBase_),
+      backend_(other.backend_),
+      fd_(std::exchange(other.fd_, NetworkSocket())) {
+  DCHECK(!other.reading_ && !other.writing_);
+}
+
+IoUringTransport& IoUringTransport::operator=(
+    IoUringTransport&& other) noexcept {
+  DCHECK(!other.reading_ && !other.writing_);
+  close();
+  eventBase_ = other.eventBase_;
+  backend_ = other.backend_;
+  fd_ = std::exchange(other.fd_, NetworkSocket());
+  return *this;
+}
+
+IoUringTransport::~IoUringTransport() {
+  close();
+}
+
+Task<IoUringTransport> IoUringTransport::newConnectedSocket(
+    EventBase* evb,
+    const SocketAddress& destAddr,
+    std::chrono::milliseconds connectTimeout,
+    const SocketOptionMap& options,
+    const SocketAddress& bindAddr,
+    const std::string& ifName) {
+  // Connecting happens once per socket, so it is left to AsyncSocket.
+  auto transport = co_await Transport::newConnectedSocket(
+      evb, destAddr, connectTimeout, options, bindAddr, ifName);
+  auto* socket =
+      transport.getTransport()->getUnderlyingTransport<AsyncSocket>();
+  co_return IoUringTransport(evb, socket->detachNetworkSocket());
+}
+
+Task<size_t> IoUringTransport::read(
+    MutableByteRange buf, std::chrono::milliseconds timeout) {
+  VLOG(5) << "IoUringTransport::read(), expecting max len " << buf.size();
+  co_return co_await recv(buf.begin(), buf.size(), timeout);
+}
+
+Task<size_t> IoUringTransport::read(
+    IOBufQueue& readBuf,
+    size_t minReadSize,
+    size_t newAllocationSize,
+    std::chrono::milliseconds timeout) {
+  VLOG(5) << "IoUringTransport::read(), expecting minReadSize="
+          << minReadSize;
+  auto buf = readBuf.preallocate(minReadSize, newAllocationSize);
+  auto length = co_await recv(buf.first, buf.second, timeout);
+  readBuf.postallocate(length);
+  co_return length;
+}
+
+Task<size_t> IoUringTransport::recv(
+    void* buf, size_t len, std::chrono::milliseconds timeout) {
+  DCHECK(!reading_);
+  RecvOp op{*eventBase_, *backend_, fd_, buf, len, timeout};
+  reading_ = &op;
+  auto result = co_await op.run();
+  reading_ = nullptr;
+  if (result < 0) {
+    co_yield co_error(op.error("recv"));
+  }
+  co_return size_t(result);
+}
+
+Task<Unit> IoUringTransport::write(
+    ByteRange buf,
+    std::chrono::milliseconds timeout,
+    folly::WriteFlags writeFlags,
+    WriteInfo* writeInfo) {
+  std::vector<struct iovec> iov(1);
+  iov[0].iov_base = const_cast<uint8_t*>(buf.begin());
+  iov[0].iov_len = buf.size();
+  co_return co_await sendmsg(std::move(iov), timeout, writeFlags, writeInfo);
+}
+
+Task<Unit> IoUringTransport::write(
+    IOBufQueue& ioBufQueue,
+    std::chrono::milliseconds timeout,
+    folly::WriteFlags writeFlags,
+    WriteInfo* writeInfo) {
+  auto iov = ioBufQueue.front()->getIov();
+  co_return co_await sendmsg(
+      std::vector<struct iovec>(iov.begin(), iov.end()),
+      timeout,
+      writeFlags,
+      writeInfo);
+}
+
+Task<Unit> IoUringTransport::sendmsg(
+    std::vector<struct iovec> iov,
+    std::chrono::milliseconds timeout,
+    folly::WriteFlags writeFlags,
+    WriteInfo* writeInfo) {
+  DCHECK(!writing_);
+  auto* begin = iov.data();
+  auto* const end = begin + iov.size();
+  size_t bytesWritten = 0;
+  while (begin != end) {
+    SendmsgOp op{
+        *eventBase_,
+        *backend_,
+        fd_,
+        begin,
+        size_t(end - begin),
+        sendMsgFlags(writeFlags),
+        timeout};
+    writing_ = &op;
+    auto result = co_await op.run();
+    writing_ = nullptr;
+    if (result < 0) {
+      if (writeInfo) {
+        writeInfo->bytesWritten = bytesWritten;
+      }
+      co_yield co_error(op.error("sendmsg"));
+    }
+
+    // Skip what was sent, which may end in the middle of a buffer.
+    auto sent = size_t(result);
+    bytesWritten += sent;
+    while (begin != end && sent >= begin->iov_len) {
+      sent -= begin->iov_len;
+      ++begin;
+    }
+    if (sent > 0) {
+      begin->iov_base = static_cast<uint8_t*>(begin->iov_base) + sent;
+      begin->iov_len -= sent;
+    }
+  }
+  co_return unit;
+}
+
+SocketAddress IoUringTransport::getLocalAddress() const noexcept {
+  SocketAddress addr;
+  try {
+    addr.setFromLocalAddress(fd_);
+  } catch (const std::exception& ex) {
+    VLOG(2) << "getLocalAddress failed: " << ex.what();
+  }
+  return addr;
+}
+
+SocketAddress IoUringTransport::getPeerAddress() const noexcept {
+  SocketAddress addr;
+  try {
+    addr.setFromPeerAddress(fd_);
+  } catch (const std::exception& ex) {
+    VLOG(2) << "getPeerAddress failed: " << ex.what();
+  }
+  return addr;
+}
+
+void IoUringTransport::shutdownWrite() noexcept {
+  if (fd_ != NetworkSocket()) {
+    netops::shutdown(fd_, SHUT_WR);
+  }
+}
+
+void IoUringTransport::cancelInFlight() noexcept {
+  for (auto* op : {reading_, writing_}) {
+    if (op && op->inFlight()) {
+      backend_->cancel(op);
+    }
+  }
+}
+
+void IoUringTransport::close() noexcept {
+  if (fd_ != NetworkSocket()) {
+    cancelInFlight();
+    netops::shutdown(fd_, SHUT_RDWR);
+    netops::close(std::exchange(fd_, NetworkSocket()));
+  }
+}
+
+void IoUringTransport::closeWithReset() noexcept {
+  if (fd_ != NetworkSocket()) {
+    cancelInFlight();
+    // Close with a RST rather than a FIN.
+    struct linger optLinger = {1, 0};
+    netops::setsockopt(
+        fd_, SOL_SOCKET, SO_LINGER, &optLinger, sizeof(optLinger));
+    netops::close(std::exchange(fd_, NetworkSocket()));
+  }
+}
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/experimental/io/Liburing.h>
+#include <folly/io/coro/Transport.h>
+#include <folly/net/NetworkSocket.h>
+#include <folly/portability/SysUio.h>
+
+#if FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
+
+namespace folly {
+
+class IoUringBackend;
+struct IoSqeBase;
+
+namespace coro {
+
+/**
+ * A Transport that reads and writes a connected socket with io_uring.
+ *
+ * Each read or write is a single operation submitted to the IoUringBackend
+ * of the EventBase from the awaiting coroutine, which is resumed right from
+ * the processing of its completion. There is no AsyncTransport, callback
+ * object or baton in between, and no hop through the EventBase queue when
+ * the awaiting coroutine runs on the EventBase itself.
+ *
+ * The EventBase must use an IoUringBackend, or have one attached with
+ * IoUringEventBaseLocal. All methods must be called from the EventBase
+ * thread, and there can be at most one read and one write in flight at a
+ * time, as with Transport.
+ */
+class IoUringTransport : public TransportIf {
+ public:
+  // Takes ownership of fd, which must be a connected socket.
+  IoUringTransport(folly::EventBase* eventBase, NetworkSocket fd);
+
+  IoUringTransport(IoUringTransport&& other) noexcept;
+  IoUringTransport& operator=(IoUringTransport&& other) noexcept;
+  ~IoUringTransport() override;
+
+  // Establish a TCP connection to the given address and return an
+  // IoUringTransport that wraps that socket
+  static Task<IoUringTransport> newConnectedSocket(
+      EventBase* evb,
+      const SocketAddress& destAddr,
+      std::chrono::milliseconds connectTimeout,
+      const SocketOptionMap& options = emptySocketOptionMap,
+      const SocketAddress& bindAddr = AsyncSocketTransport::anyAddress(),
+      const std::string& ifName = "");
+
+  EventBase* getEventBase() noexcept override { return eventBase_; }
+
+  using TransportIf::read;
+  Task<size_t> read(
+      MutableByteRange buf, std::chrono::milliseconds timeout) override;
+  Task<size_t> read(
+      IOBufQueue& buf,
+      size_t minReadSize,
+      size_t newAllocationSize,
+      std::chrono::milliseconds timeout) override;
+
+  Task<Unit> write(
+      ByteRange buf,
+      std::chrono::milliseconds timeout = std::chrono::milliseconds(0),
+      folly::WriteFlags writeFlags = folly::WriteFlags::NONE,
+      WriteInfo* writeInfo = nullptr) override;
+  Task<folly::Unit> write(
+      IOBufQueue& ioBufQueue,
+      std::chrono::milliseconds timeout = std::chrono::milliseconds(0),
+      folly::WriteFlags writeFlags = folly::WriteFlags::NONE,
+      WriteInfo* writeInfo = nullptr) override;
+
+  SocketAddress getLocalAddress() const noexcept override;
+  SocketAddress getPeerAddress() const noexcept override;
+
+  void shutdownWrite() noexcept override;
+  void close() noexcept override;
+  void closeWithReset() noexcept override;
+
+  // There is no AsyncTransport underneath.
+  AsyncTransport* getTransport() const override { return nullptr; }
+  const AsyncTransportCertificate* getPeerCertificate() const override {
+    return nullptr;
+  }
+
+ private:
+  IoUringTransport(const IoUringTransport&) = delete;
+  IoUringTransport& operator=(const IoUringTransport&) = delete;
+
+  Task<size_t> recv(void* buf, size_t len, std::chrono::milliseconds timeout);
+  Task<Unit> sendmsg(
+      std::vector<struct iovec> iov,
+      std::chrono::milliseconds timeout,
+      folly::WriteFlags writeFlags,
+      WriteInfo* writeInfo);
+
+  void cancelInFlight() noexcept;
+
+  EventBase* eventBase_;
+  IoUringBackend* backend_;
+  NetworkSocket fd_;
+  // The operations in flight, which close() cancels.
+  IoSqeBase* reading_{nullptr};
+  IoSqeBase* writing_{nullptr};
+};
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/coro/ReadChunks.h>
+
+#if FOLLY_HAS_COROUTINES
+
+#include <deque>
+
+#include <folly/Exception.h>
+#include <folly/FileUtil.h>
+#include <folly/experimental/coro/Task.h>
+#include <folly/futures/Future.h>
+
+namespace folly {
+namespace coro {
+
+namespace {
+
+Task<std::unique_ptr<IOBuf>> readAt(
+    std::shared_ptr<File> file,
+    std::unique_ptr<IOBuf> buf,
+    std::size_t length,
+    off_t offset) {
+  auto n = preadFull(file->fd(), buf->writableTail(), length, offset);
+  if (n < 0) {
+    throwSystemError("pread() failed");
+  }
+  buf->append(size_t(n));
+  co_return buf;
+}
+
+} // namespace
+
+AsyncGenerator<std::unique_ptr<IOBuf>> readChunks(
+    TransportIf& transport, IOBufPool& pool, ReadChunksOptions options) {
+  while (true) {
+    auto buf = pool.create(options.chunkSize);
+    auto n = co_await transport.read(
+        MutableByteRange(buf->writableTail(), options.chunkSize),
+        options.timeout);
+    if (n == 0) {
+      co_return;
+    }
+    buf->append(n);
+    co_yield std::move(buf);
+  }
+}
+
+AsyncGenerator<std::unique_ptr<IOBuf>> readFileChunks(
+    File file,
+    Executor::KeepAlive<> executor,
+    IOBufPool& pool,
+    ReadChunksOptions options) {
+  // Shared with the reads, which may outlive the generator.
+  auto sharedFile = std::make_shared<File>(std::move(file));
+  std::deque<SemiFuture<std::unique_ptr<IOBuf>>> reads;
+  off_t offset = 0;
+  while (true) {
+    while (reads.size() <= options.lookahead) {
+      reads.push_back(readAt(
+                          sharedFile,
+                          pool.create(options.chunkSize),
+                          options.chunkSize,
+                          offset)
+                          .scheduleOn(executor)
+                          .start());
+      offset += off_t(options.chunkSize);
+    }
+    auto buf = co_await std::move(reads.front());
+    reads.pop_front();
+    if (buf->empty()) {
+      co_return;
+    }
+    bool last = buf->length() < options.chunkSize;
+    co_yield std::move(buf);
+    if (last) {
+      co_return;
+    }
+  }
+}
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES
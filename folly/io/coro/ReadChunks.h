@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include <folly/Executor.h>
+#include <folly/File.h>
+#include <folly/experimental/coro/AsyncGenerator.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/IOBufPool.h>
+#include <folly/io/coro/Transport.h>
+
+#if FOLLY_HAS_COROUTINES
+
+namespace folly {
+namespace coro {
+
+struct ReadChunksOptions {
+  /// Bytes read into each chunk, at most
+  std::size_t chunkSize{64 * 1024};
+  /// Chunks of a file read ahead of the consumer, in parallel
+  std::size_t lookahead{4};
+  /// Timeout of each socket read; 0 for none
+  std::chrono::milliseconds timeout{0};
+};
+
+/**
+ * Streams what is read from a transport until EOF, as chunks taken from
+ * pool, so that the buffers the consumer is done with are reused for the
+ * next reads.
+ *
+ * Each chunk is what one read returned, up to chunkSize bytes. The next
+ * read is made once the consumer asks for the next chunk, so that a slow
+ * consumer pushes back on the peer; the socket buffer of the kernel is
+ * the lookahead. Memory is bounded by the chunks the consumer holds on to.
+ *
+ * The transport and the pool must outlive the generator.
+ */
+AsyncGenerator<std::unique_ptr<IOBuf>> readChunks(
+    TransportIf& transport,
+    IOBufPool& pool,
+    ReadChunksOptions options = ReadChunksOptions());
+
+/**
+ * Streams the contents of file from its start, as chunks of chunkSize
+ * bytes (the last one shorter) taken from pool.
+ *
+ * The reads block, so they are made on executor, lookahead of them ahead
+ * of the consumer and in parallel. At most lookahead + 1 chunks are read
+ * but not yet consumed.
+ *
+ * The pool must outlive the generator. The generator owns file, which
+ * the reads still in flight keep open once it is destroyed.
+ */
+AsyncGenerator<std::unique_ptr<IOBuf>> readFileChunks(
+    File file,
+    Executor::KeepAlive<> executor,
+    IOBufPool& pool,
+    ReadChunksOptions options = ReadChunksOptions());
+
+} // namespace coro
+} // namespace folly
+
+#endif // FOLLY_HAS_COROUTINES
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/Portability.h>
+
+#include <folly/experimental/coro/BlockingWait.h>
+#include <folly/experimental/coro/Collect.h>
+#include <folly/io/async/test/AsyncSocketTest.h>
+#include <folly/io/coro/IoUringTransport.h>
+#include <folly/portability/GTest.h>
+
+#if FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
+
+#include <folly/experimental/io/IoUringBackend.h>
+
+using namespace std::chrono_literals;
+using namespace folly;
+using namespace folly::coro;
+using namespace folly::test;
+
+class IoUringTransportTest : public testing::Test {
+ public:
+  void SetUp() override {
+    try {
+      evb = std::make_unique<EventBase>(
+          EventBase::Options{}.setBackendFactory([] {
+            return std::make_unique<IoUringBackend>(IoUringBackend::Options{});
+          }));
+    } catch (IoUringBackend::NotAvailable const&) {
+      GTEST_SKIP() << "io_uring is not available";
+    }
+  }
+
+  template <typename F>
+  void run(F f) {
+    blockingWait(co_invoke(std::move(f)), evb.get());
+  }
+
+  Task<IoUringTransport> connect() {
+    co_return co_await IoUringTransport::newConnectedSocket(
+        evb.get(), srv.getAddress(), 0ms);
+  }
+
+  Task<> requestCancellation() {
+    cancelSource.requestCancellation();
+    co_return;
+  }
+
+  std::unique_ptr<EventBase> evb;
+  CancellationSource cancelSource;
+  TestServer srv;
+};
+
+TEST_F(IoUringTransportTest, ConnectSuccess) {
+  run([&]() -> Task<> {
+    auto cs = co_await connect();
+    EXPECT_EQ(srv.getAddress(), cs.getPeerAddress());
+  });
+}
+
+TEST_F(IoUringTransportTest, SimpleIOBufRead) {
+  run([&]() -> Task<> {
+    constexpr auto kBufSize = 55 * 1184;
+    auto cs = co_await connect();
+    // produces blocking socket
+    auto ss = srv.accept(-1);
+
+    std::array<uint8_t, kBufSize> sndBuf;
+    std::memset(sndBuf.data(), 'a', sndBuf.size());
+    ss->write(sndBuf.data(), sndBuf.size());
+    ss->close();
+
+    IOBufQueue rcvBuf(IOBufQueue::cacheChainLength());
+    int totalBytes{0};
+    while (totalBytes < kBufSize) {
+      totalBytes += co_await cs.read(rcvBuf, 1000, 1000, 0ms);
+    }
+    EXPECT_EQ(0, co_await cs.read(rcvBuf, 1000, 1000, 50ms)); // closed
+
+    auto data = rcvBuf.move();
+    data->coalesce();
+    EXPECT_EQ(0, memcmp(sndBuf.data(), data->data(), data->length()));
+  });
+}
+
+TEST_F(IoUringTransportTest, ReadCancelled) {
+  run([&]() -> Task<> {
+    auto cs = co_await connect();
+    auto reader = [&cs]() -> Task<Unit> {
+      std::array<uint8_t, 1024> rcvBuf;
+      EXPECT_THROW(
+          co_await cs.read(MutableByteRange(rcvBuf.data(), rcvBuf.size()), 0ms),
+          OperationCancelled);
+      co_return unit;
+    };
+
+    co_await co_withCancellation(
+        cancelSource.getToken(),
+        folly::coro::collectAll(requestCancellation(), reader()));
+    // token was cancelled before read was called
+    co_await co_withCancellation(cancelSource.getToken(), reader());
+  });
+}
+
+TEST_F(IoUringTransportTest, ReadTimeout) {
+  run([&]() -> Task<> {
+    auto cs = co_await connect();
+    std::array<uint8_t, 1024> rcvBuf;
+    try {
+      co_await cs.read(MutableByteRange(rcvBuf.data(), rcvBuf.size()), 50ms);
+      ADD_FAILURE() << "read did not time out";
+    } catch (const AsyncSocketException& ex) {
+      EXPECT_EQ(AsyncSocketException::TIMED_OUT, ex.getType());
+    }
+  });
+}
+
+TEST_F(IoUringTransportTest, SimpleWritev) {
+  run([&]() -> Task<> {
+    auto cs = co_await connect();
+    // produces blocking socket
+    auto ss = srv.accept(-1);
+
+    IOBufQueue sndBuf;
+    constexpr auto kBufSize = 65536;
+    std::array<uint8_t, kBufSize> bufA;
+    std::memset(bufA.data(), 'a', bufA.size());
+    std::array<uint8_t, kBufSize> bufB;
+    std::memset(bufB.data(), 'b', bufB.size());
+    sndBuf.append(bufA.data(), bufA.size());
+    sndBuf.append(bufB.data(), bufB.size());
+
+    co_await cs.write(sndBuf);
+
+    // read on server side
+    std::array<uint8_t, kBufSize> rcvBuf;
+    ss->readAll(rcvBuf.data(), rcvBuf.size());
+    EXPECT_EQ(0, memcmp(bufA.data(), rcvBuf.data(), rcvBuf.size()));
+    ss->readAll(rcvBuf.data(), rcvBuf.size());
+    EXPECT_EQ(0, memcmp(bufB.data(), rcvBuf.data(), rcvBuf.size()));
+  });
+}
+
+#endif // FOLLY_HAS_COROUTINES && FOLLY_HAS_LIBURING
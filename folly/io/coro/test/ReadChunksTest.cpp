@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/coro/ReadChunks.h>
+
+#include <random>
+
+#include <folly/FileUtil.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/experimental/TestUtil.h>
+#include <folly/experimental/coro/BlockingWait.h>
+#include <folly/io/async/test/AsyncSocketTest.h>
+#include <folly/portability/GTest.h>
+
+#if FOLLY_HAS_COROUTINES
+
+using namespace std::chrono_literals;
+using namespace folly;
+using namespace folly::coro;
+using namespace folly::test;
+
+namespace {
+
+std::string randomData(size_t n) {
+  std::string data(n, '\0');
+  std::mt19937 rng(1729);
+  for (auto& c : data) {
+    c = char(rng());
+  }
+  return data;
+}
+
+// Consumes the chunks, checking that none is longer than chunkSize.
+Task<std::string> concat(
+    AsyncGenerator<std::unique_ptr<IOBuf>> chunks, size_t chunkSize) {
+  std::string data;
+  while (auto chunk = co_await chunks.next()) {
+    EXPECT_LE((*chunk)->computeChainDataLength(), chunkSize);
+    data.append((*chunk)->moveToFbString().toStdString());
+  }
+  co_return data;
+}
+
+} // namespace
+
+TEST(ReadChunks, file) {
+  CPUThreadPoolExecutor executor(4);
+  IOBufPool pool;
+  ReadChunksOptions options;
+  options.chunkSize = 4096;
+  options.lookahead = 3;
+  // A whole number of chunks, a partial last one, and no data at all.
+  for (size_t size : {0, 1, 4096, 10 * 4096, 10 * 4096 + 100}) {
+    TemporaryFile file;
+    auto const data = randomData(size);
+    writeFull(file.fd(), data.data(), data.size());
+    auto chunks = readFileChunks(
+        File(file.path().string()), getKeepAliveToken(executor), pool, options);
+    EXPECT_EQ(data, blockingWait(concat(std::move(chunks), options.chunkSize)))
+        << size;
+  }
+}
+
+TEST(ReadChunks, fileStoppedEarly) {
+  // Destroying the generator with reads in flight leaves them to finish.
+  CPUThreadPoolExecutor executor(4);
+  IOBufPool pool;
+  TemporaryFile file;
+  auto const data = randomData(1 << 20);
+  writeFull(file.fd(), data.data(), data.size());
+  blockingWait([&]() -> Task<> {
+    auto chunks = readFileChunks(
+        File(file.path().string()), getKeepAliveToken(executor), pool);
+    auto chunk = co_await chunks.next();
+    EXPECT_EQ(ReadChunksOptions().chunkSize, (*chunk)->length());
+  }());
+}
+
+TEST(ReadChunks, transport) {
+  EventBase evb;
+  TestServer srv;
+  IOBufPool pool;
+  auto const data = randomData(1 << 20);
+  blockingWait(
+      [&]() -> Task<> {
+        auto cs = co_await Transport::newConnectedSocket(
+            &evb, srv.getAddress(), 0ms);
+        // produces blocking socket
+        auto ss = srv.accept(-1);
+        std::thread writer([&] {
+          ss->write(
+              reinterpret_cast<const uint8_t*>(data.data()), data.size());
+          ss->close();
+        });
+        ReadChunksOptions options;
+        options.chunkSize = 1000;
+        EXPECT_EQ(
+            data,
+            co_await concat(readChunks(cs, pool, options), options.chunkSize));
+        writer.join();
+      }(),
+      &evb);
+}
+
+#endif // FOLLY_HAS_COROUTINES
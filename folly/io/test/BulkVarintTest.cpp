@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/BulkVarint.h>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <folly/Varint.h>
+#include <folly/io/IOBufQueue.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+using namespace folly::io;
+
+namespace {
+
+std::vector<uint64_t> makeValues(size_t count) {
+  std::mt19937_64 rng(42);
+  std::vector<uint64_t> values;
+  for (size_t i = 0; i < count; ++i) {
+    // Cover every encoded length, from 1 to 10 bytes.
+    values.push_back(rng() >> (rng() % 64));
+  }
+  values.push_back(0);
+  values.push_back(std::numeric_limits<uint64_t>::max());
+  return values;
+}
+
+std::string encodeScalar(const std::vector<uint64_t>& values) {
+  std::string out;
+  uint8_t buf[kMaxVarintLength64];
+  for (auto value : values) {
+    out.append(reinterpret_cast<char*>(buf), encodeVarint(value, buf));
+  }
+  return out;
+}
+
+} // namespace
+
+TEST(BulkVarint, EncodeMatchesScalar) {
+  auto values = makeValues(1000);
+  IOBufQueue queue(IOBufQueue::cacheChainLength());
+  // A small growth, so that the output spans many buffers.
+  QueueAppender appender(&queue, 64);
+  encodeVarints(appender, range(values));
+  EXPECT_GT(queue.front()->countChainElements(), 1);
+  EXPECT_EQ(encodeScalar(values), queue.move()->moveToFbString().toStdString());
+}
+
+TEST(BulkVarint, DecodeAcrossBuffers) {
+  auto values = makeValues(1000);
+  auto encoded = encodeScalar(values);
+
+  // Split the encoding into buffers of varying small sizes, so that many
+  // varints straddle two or more of them.
+  IOBufQueue queue;
+  for (size_t pos = 0, size = 1; pos < encoded.size(); pos += size) {
+    size = std::min(size % 23 + 1, encoded.size() - pos);
+    queue.append(IOBuf::copyBuffer(encoded.data() + pos, size));
+  }
+  auto chain = queue.move();
+
+  std::vector<uint64_t> decoded(values.size() + 1);
+  Cursor cursor(chain.get());
+  EXPECT_EQ(values.size(), decodeVarints(cursor, range(decoded)));
+  decoded.pop_back();
+  EXPECT_EQ(values, decoded);
+  EXPECT_TRUE(cursor.isAtEnd());
+}
+
+TEST(BulkVarint, DecodeInBatches) {
+  auto values = makeValues(100);
+  auto chain = IOBuf::copyBuffer(encodeScalar(values));
+
+  std::vector<uint64_t> decoded;
+  Cursor cursor(chain.get());
+  uint64_t batch[7];
+  while (size_t n = decodeVarints(cursor, range(batch))) {
+    decoded.insert(decoded.end(), batch, batch + n);
+  }
+  EXPECT_EQ(values, decoded);
+}
+
+TEST(BulkVarint, Truncated) {
+  // 300 and the first byte of another 300
+  auto chain = IOBuf::copyBuffer("\xac\x02\xac", 3);
+  Cursor cursor(chain.get());
+  uint64_t out[2];
+  EXPECT_EQ(1, decodeVarints(cursor, range(out)));
+  EXPECT_EQ(300, out[0]);
+  EXPECT_EQ(2, cursor.getCurrentPosition());
+}
+
+TEST(BulkVarint, TooLong) {
+  std::string encoded(20, '\xff');
+  auto chain = IOBuf::copyBuffer(encoded);
+  Cursor cursor(chain.get());
+  uint64_t out[1];
+  EXPECT_THROW(decodeVarints(cursor, range(out)), std::invalid_argument);
+}
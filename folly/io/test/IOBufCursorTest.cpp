@@ -1035,6 +1035,39 @@ TEST(IOBuf, ReadWhileTrue) {
   }
 }
 
+TEST(IOBuf, FindByteAndSequence) {
+  // "GET / HTTP/1.1\r\nHost: a\r\n\r\nbody", split so that the "\r\n\r\n"
+  // straddles three buffers, with an empty one in the middle.
+  auto chain = IOBuf::copyBuffer("GET / HTTP/1.1\r\nHost: a\r");
+  chain->prependChain(IOBuf::copyBuffer("\n"));
+  chain->prependChain(IOBuf::create(10));
+  chain->prependChain(IOBuf::copyBuffer("\r\nbody"));
+
+  Cursor curs(chain.get());
+  EXPECT_EQ(3, curs.findByte(' ').value());
+  EXPECT_EQ(15, curs.findByte('\n').value());
+  EXPECT_EQ(27, curs.findByte('b').value());
+  EXPECT_FALSE(curs.findByte('z').has_value());
+
+  EXPECT_EQ(14, curs.findSequence("\r\n").value());
+  EXPECT_EQ(23, curs.findSequence("\r\n\r\n").value());
+  EXPECT_EQ(24, curs.findSequence("\n\r\nbody").value());
+  EXPECT_EQ(0, curs.findSequence("").value());
+  EXPECT_FALSE(curs.findSequence("\r\n\r\n\r\n").has_value());
+  EXPECT_FALSE(curs.findSequence("bodyx").has_value());
+
+  // Offsets are relative to the cursor, which doesn't move.
+  curs.skip(16);
+  EXPECT_EQ(7, curs.findSequence("\r\n\r\n").value());
+  EXPECT_EQ(16, curs - chain.get());
+
+  // Bounded cursors stop at their limit.
+  Cursor bounded(chain.get(), 25);
+  EXPECT_EQ(14, bounded.findSequence("\r\n").value());
+  EXPECT_FALSE(bounded.findSequence("\r\n\r\n").has_value());
+  EXPECT_FALSE(bounded.findByte('b').has_value());
+}
+
 TEST(IOBuf, TestAdvanceToEndSingle) {
   std::unique_ptr<IOBuf> chain(IOBuf::create(10));
   chain->append(10);
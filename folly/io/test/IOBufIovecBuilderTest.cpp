@@ -77,3 +77,44 @@ TEST(IOBufIovecBuilder, AllocateMulti) {
     CHECK_EQ(ioBufs->computeChainDataLength(), data.postAllocateSize_);
   }
 }
+
+TEST(IOBufIovecBuilder, GatherToIovecs) {
+  auto chain = folly::IOBuf::copyBuffer("a");
+  chain->prependChain(folly::IOBuf::copyBuffer("bc"));
+  chain->prependChain(folly::IOBuf::create(0));
+  chain->prependChain(folly::IOBuf::copyBuffer("def"));
+  chain->prependChain(folly::IOBuf::copyBuffer(std::string(1000, 'x')));
+  chain->prependChain(folly::IOBuf::copyBuffer("g"));
+  chain->prependChain(folly::IOBuf::copyBuffer(std::string(1000, 'y')));
+
+  auto toString = [](const folly::IOBufIovecBuilder::IoVecVec& iovs) {
+    std::string str;
+    for (auto const& iov : iovs) {
+      str.append(static_cast<const char*>(iov.iov_base), iov.iov_len);
+    }
+    return str;
+  };
+
+  folly::IOBufIovecBuilder::IoVecVec iovs;
+  auto result = folly::gatherToIovecs(*chain, iovs);
+  EXPECT_EQ(4, iovs.size());
+  EXPECT_EQ(2007, result.length);
+  EXPECT_EQ(6, result.merged->length());
+  EXPECT_EQ(chain->next()->next()->next()->next()->data(), iovs[1].iov_base);
+  auto const all = toString(iovs);
+  EXPECT_EQ(
+      "abcdef" + std::string(1000, 'x') + "g" + std::string(1000, 'y'), all);
+
+  // Capped: covers a prefix
+  result = folly::gatherToIovecs(*chain, iovs, 2);
+  EXPECT_EQ(2, iovs.size());
+  EXPECT_EQ(1006, result.length);
+  EXPECT_EQ(all.substr(0, 1006), toString(iovs));
+
+  // Nothing to merge
+  result = folly::gatherToIovecs(*chain, iovs, IOV_MAX, 1);
+  EXPECT_EQ(6, iovs.size());
+  EXPECT_EQ(2007, result.length);
+  EXPECT_EQ(nullptr, result.merged);
+  EXPECT_EQ(all, toString(iovs));
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/io/IOBufPool.h>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <folly/io/IOBufQueue.h>
+#include <folly/portability/GTest.h>
+
+using folly::IOBuf;
+using folly::IOBufPool;
+using folly::IOBufQueue;
+
+TEST(IOBufPool, SizeClasses) {
+  IOBufPool pool;
+  auto buf = pool.create(1);
+  EXPECT_EQ(0, buf->length());
+  EXPECT_EQ(4096, buf->capacity());
+  EXPECT_EQ(4096, buf->tailroom());
+
+  EXPECT_EQ(8192, pool.create(4097)->capacity());
+  EXPECT_EQ(16384, pool.create(16384)->capacity());
+
+  // Beyond the largest size class
+  EXPECT_LE(100000, pool.create(100000)->capacity());
+}
+
+TEST(IOBufPool, Reuse) {
+  IOBufPool pool;
+  auto buf = pool.create(4096);
+  auto data = buf->data();
+  buf.reset();
+
+  buf = pool.create(4096);
+  EXPECT_EQ(data, buf->data());
+  // The buffer is only returned once all the IOBufs sharing it are gone.
+  auto clone = buf->clone();
+  buf.reset();
+  EXPECT_NE(data, pool.create(4096)->data());
+  clone.reset();
+  EXPECT_EQ(data, pool.create(4096)->data());
+}
+
+TEST(IOBufPool, ReusedBuffersComeBackEmpty) {
+  IOBufPool pool;
+  auto buf = pool.create(4096);
+  auto data = buf->data();
+  buf->append(4096);
+  EXPECT_EQ(0, buf->tailroom());
+  buf.reset();
+
+  buf = pool.create(4096);
+  EXPECT_EQ(data, buf->data());
+  EXPECT_EQ(0, buf->length());
+  EXPECT_EQ(4096, buf->tailroom());
+}
+
+TEST(IOBufPool, CrossThreadRelease) {
+  IOBufPool pool;
+  std::vector<std::unique_ptr<IOBuf>> bufs;
+  std::vector<const uint8_t*> data;
+  for (int i = 0; i < 8; ++i) {
+    bufs.push_back(pool.create(4096));
+    data.push_back(bufs.back()->data());
+    memset(bufs.back()->writableTail(), i, 4096);
+    bufs.back()->append(4096);
+  }
+
+  std::thread([&] { bufs.clear(); }).join();
+
+  // The buffers freed on the other thread come back to this one.
+  for (int i = 0; i < 8; ++i) {
+    auto buf = pool.create(4096);
+    EXPECT_NE(data.end(), std::find(data.begin(), data.end(), buf->data()));
+    bufs.push_back(std::move(buf));
+  }
+}
+
+TEST(IOBufPool, OutliveThreadAndPool) {
+  std::unique_ptr<IOBuf> buf;
+  {
+    IOBufPool pool;
+    std::thread([&] { buf = pool.create(4096); }).join();
+    auto local = pool.create(8192);
+    local->append(10);
+    buf->appendChain(std::move(local));
+  }
+  EXPECT_EQ(10, buf->computeChainDataLength());
+  buf.reset();
+}
+
+TEST(IOBufPool, Queue) {
+  IOBufPool pool;
+  IOBufQueue::Options options;
+  options.cacheChainLength = true;
+  options.pool = &pool;
+  IOBufQueue queue(options);
+
+  auto range = queue.preallocate(1000, 1000);
+  EXPECT_EQ(4096, range.second);
+  queue.postallocate(1000);
+  EXPECT_EQ(1000, queue.chainLength());
+  EXPECT_EQ(4096, queue.front()->capacity());
+}
@@ -652,3 +652,53 @@ TEST(IOBufQueue, PackWithSharedTail) {
   // buf is shared, packing should not modify it.
   EXPECT_EQ(buf->data()[6], 'X');
 }
+
+TEST(IOBufQueue, PackThreshold) {
+  IOBufQueue::Options options = clOptions;
+  options.packThreshold = 64;
+  IOBufQueue queue(options);
+
+  // Small buffers are copied together.
+  for (int i = 0; i < 100; ++i) {
+    queue.append(stringToIOBuf(SCL("abcdefgh")));
+  }
+  checkConsistency(queue);
+  EXPECT_EQ(800, queue.chainLength());
+  EXPECT_GT(10, queue.front()->countChainElements());
+
+  // Large ones are linked.
+  std::string large(1000, 'x');
+  auto buf = IOBuf::copyBuffer(large);
+  auto data = buf->data();
+  queue.append(std::move(buf));
+  checkConsistency(queue);
+  EXPECT_EQ(data, queue.front()->prev()->data());
+
+  // A chain of mixed sizes, appended by reference.
+  auto chain = stringToIOBuf(SCL("small"));
+  chain->prependChain(IOBuf::copyBuffer(large));
+  chain->prependChain(stringToIOBuf(SCL("tiny")));
+  auto elements = queue.front()->countChainElements();
+  queue.append(*chain);
+  checkConsistency(queue);
+  // The large buffer, and maybe a new buffer for each of the small ones
+  EXPECT_LE(elements + 1, queue.front()->countChainElements());
+  EXPECT_GE(elements + 3, queue.front()->countChainElements());
+  EXPECT_EQ(1800 + 5 + 1000 + 4, queue.chainLength());
+
+  // And another queue, copied into the tailroom.
+  elements = queue.front()->countChainElements();
+  IOBufQueue other;
+  other.append(stringToIOBuf(SCL("more")));
+  queue.append(other);
+  checkConsistency(queue);
+  EXPECT_EQ(elements, queue.front()->countChainElements());
+  EXPECT_TRUE(other.empty());
+
+  std::string expected;
+  for (int i = 0; i < 100; ++i) {
+    expected += "abcdefgh";
+  }
+  expected += large + "small" + large + "tinymore";
+  EXPECT_EQ(expected, queueToString(queue));
+}
@@ -1044,6 +1044,44 @@ INSTANTIATE_TEST_SUITE_P(
         ::testing::Values(
             CREATE, TAKE_OWNERSHIP_MALLOC, TAKE_OWNERSHIP_CUSTOM, USER_OWNED)));
 
+TEST(IOBuf, fromFbString) {
+  for (size_t size : {0, 10, 200, 1 << 20}) {
+    fbstring str(size, 'x');
+    auto const data = str.data();
+    auto buf = IOBuf::fromString(std::move(str));
+    EXPECT_EQ(size, buf->length());
+    EXPECT_EQ(size, strspn(reinterpret_cast<const char*>(buf->data()), "x"));
+    // Small strings are copied, others give up their buffer.
+    EXPECT_EQ(size > 23, reinterpret_cast<const char*>(buf->data()) == data)
+        << size;
+    EXPECT_EQ(size > 23 ? 0 : size, str.size()) << size;
+  }
+
+  // A shared string is copied and left alone.
+  fbstring large(1 << 20, 'x');
+  fbstring copy = large;
+  auto buf = IOBuf::fromString(std::move(large));
+  EXPECT_NE(reinterpret_cast<const char*>(buf->data()), copy.data());
+  EXPECT_EQ(1 << 20, buf->length());
+  EXPECT_EQ(1 << 20, large.size());
+}
+
+TEST(IOBuf, fromStdString) {
+  for (size_t size : {0, 10, 200, 1 << 20}) {
+    std::string str(size, 'x');
+    auto const data = str.data();
+    auto const inlined = size <= 15; // libstdc++ and libc++ hold at least 15
+    auto buf = IOBuf::fromString(std::move(str));
+    EXPECT_EQ(size, buf->length());
+    if (!inlined) {
+      EXPECT_EQ(reinterpret_cast<const char*>(buf->data()), data);
+    }
+    EXPECT_EQ(size, buf->moveToFbString().size());
+  }
+  auto buf = IOBuf::fromString(std::string(1000, 'x'));
+  EXPECT_EQ(1000, buf->cloneOne()->length());
+}
+
 TEST(IOBuf, getIov) {
   uint32_t fillSeed = 0xdeadbeef;
   std::mt19937 gen(fillSeed);
@@ -25,6 +25,7 @@
 #include <folly/Conv.h>
 #include <folly/FBString.h>
 #include <folly/Random.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/experimental/TestUtil.h>
 #include <folly/io/IOBufQueue.h>
 #include <folly/portability/GFlags.h>
@@ -328,6 +329,91 @@ TEST(RecordIOTest, validateRecordAPI) {
   }
 }
 
+TEST(RecordIOTest, Index) {
+  TemporaryFile file;
+  TemporaryFile indexFile;
+  {
+    RecordIOWriter writer(File(file.fd()), 1, File(indexFile.fd()), 4);
+    for (int i = 0; i < 10; ++i) {
+      writer.write(iobufs({to<std::string>("record", i)}));
+    }
+  }
+  {
+    RecordIOIndex index(File(indexFile.fd()));
+    EXPECT_EQ(4, index.interval());
+    EXPECT_EQ(3, index.size());
+    EXPECT_EQ(0, index.offset(0));
+
+    RecordIOReader reader(File(file.fd()));
+    for (int i = 0; i < 10; ++i) {
+      auto it = reader.seekToRecord(i, index);
+      ASSERT_FALSE(it == reader.end());
+      EXPECT_EQ(to<std::string>("record", i), sp(it->first));
+    }
+    EXPECT_TRUE(reader.seekToRecord(10, index) == reader.end());
+  }
+  {
+    // Records written without the index are picked up on reopening it,
+    // and the interval of the existing index is kept.
+    {
+      RecordIOWriter writer(File(file.fd()));
+      writer.write(iobufs({"record10"}));
+      writer.write(iobufs({"record11"}));
+    }
+    RecordIOWriter writer(File(file.fd()), 1, File(indexFile.fd()), 100);
+    writer.write(iobufs({"record12"}));
+  }
+  {
+    RecordIOIndex index(File(indexFile.fd()));
+    EXPECT_EQ(4, index.interval());
+    EXPECT_EQ(4, index.size());
+
+    RecordIOReader reader(File(file.fd()));
+    auto it = reader.seekToRecord(12, index);
+    ASSERT_FALSE(it == reader.end());
+    EXPECT_EQ("record12", sp(it->first));
+    EXPECT_EQ(it->second, index.offset(3));
+  }
+}
+
+TEST(RecordIOTest, ForEachParallel) {
+  TemporaryFile file;
+  TemporaryFile indexFile;
+  constexpr int kRecords = 1000;
+  {
+    RecordIOWriter writer(File(file.fd()), 1, File(indexFile.fd()), 16);
+    for (int i = 0; i < kRecords; ++i) {
+      writer.write(iobufs({to<std::string>("record", i)}));
+    }
+  }
+  RecordIOIndex index(File(indexFile.fd()));
+  RecordIOReader reader(File(file.fd()));
+  CPUThreadPoolExecutor executor(4);
+
+  std::vector<std::pair<std::string, off_t>> expected;
+  for (auto& record : reader) {
+    expected.emplace_back(sp(record.first).str(), record.second);
+  }
+  ASSERT_EQ(kRecords, expected.size());
+
+  std::vector<std::pair<std::string, off_t>> records;
+  reader.forEachParallel(executor, index, [&](ByteRange data, off_t pos) {
+    records.emplace_back(sp(data).str(), pos);
+  });
+  EXPECT_EQ(expected, records);
+
+  EXPECT_THROW(
+      reader.forEachParallel(
+          executor,
+          index,
+          [](ByteRange, off_t pos) {
+            if (pos > 0) {
+              throw std::runtime_error("stop");
+            }
+          }),
+      std::runtime_error);
+}
+
 } // namespace test
 } // namespace folly
 
@@ -0,0 +1,588 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/LazyView.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <folly/Conv.h>
+#include <folly/Unicode.h>
+#include <folly/lang/Exception.h>
+#include <folly/portability/Constexpr.h>
+
+namespace folly {
+namespace json {
+
+namespace {
+
+uint16_t decodeHex(char const* p) {
+  uint16_t ret = 0;
+  for (int i = 0; i < 4; ++i) {
+    auto const c = p[i];
+    ret = uint16_t(
+        ret * 16 +
+        (c <= '9' ? c - '0' : c >= 'a' ? c - 'a' + 10 : c - 'A' + 10));
+  }
+  return ret;
+}
+
+// Decodes the content of a string the Indexer has validated into out, which
+// needs no more than content.size() bytes: no escape sequence is shorter than
+// what it stands for. Returns the decoded size.
+size_t unescape(StringPiece content, char* out) {
+  char* const begin = out;
+  auto p = content.begin();
+  while (p != content.end()) {
+    auto const backslash =
+        static_cast<char const*>(std::memchr(p, '\\', content.end() - p));
+    auto const literal = backslash ? backslash : content.end();
+    std::memcpy(out, p, size_t(literal - p));
+    out += literal - p;
+    if (!backslash) {
+      break;
+    }
+    p = backslash + 2;
+    switch (backslash[1]) {
+      // clang-format off
+      case 'b': *out++ = '\b'; break;
+      case 'f': *out++ = '\f'; break;
+      case 'n': *out++ = '\n'; break;
+      case 'r': *out++ = '\r'; break;
+      case 't': *out++ = '\t'; break;
+      // clang-format on
+      case 'u': {
+        char32_t cp = decodeHex(p);
+        p += 4;
+        if (utf16_code_unit_is_high_surrogate(char16_t(cp))) {
+          cp = unicode_code_point_from_utf16_surrogate_pair(
+              char16_t(cp), char16_t(decodeHex(p + 2)));
+          p += 6;
+        }
+        auto const utf8 = codePointToUtf8(cp);
+        std::memcpy(out, utf8.data(), utf8.size());
+        out += utf8.size();
+        break;
+      }
+      default: // '"', '\\' and '/'
+        *out++ = backslash[1];
+    }
+  }
+  return size_t(out - begin);
+}
+
+} // namespace
+
+// Validates the input with the grammar of parseJson(), appending a node for
+// every value.
+class LazyView::Indexer {
+ public:
+  Indexer(
+      StringPiece input,
+      serialization_opts const& opts,
+      Nodes& nodes)
+      : input_(input), opts_(opts), nodes_(nodes) {}
+
+  void parseDocument() {
+    parseValue(0);
+    skipWhitespace();
+    if (pos_ < input_.size() && input_[pos_] != '\0') {
+      error("parsing didn't consume all input");
+    }
+  }
+
+ private:
+  int peek() const {
+    return pos_ < input_.size() ? static_cast<unsigned char>(input_[pos_])
+                                : EOF;
+  }
+
+  bool consume(StringPiece str) {
+    if (input_.subpiece(pos_).startsWith(str)) {
+      pos_ += str.size();
+      return true;
+    }
+    return false;
+  }
+
+  void skipWhitespace() {
+    while (pos_ < input_.size() &&
+           (input_[pos_] == ' ' || input_[pos_] == '\n' ||
+            input_[pos_] == '\t' || input_[pos_] == '\r')) {
+      ++pos_;
+    }
+  }
+
+  void skipDigits() {
+    while (pos_ < input_.size() && input_[pos_] >= '0' &&
+           input_[pos_] <= '9') {
+      ++pos_;
+    }
+  }
+
+  void expect(char c) {
+    if (peek() != c) {
+      error(to<std::string>("expected '", c, '\'').c_str());
+    }
+    ++pos_;
+  }
+
+  [[noreturn]] void error(char const* what) const {
+    auto line = std::count(input_.begin(), input_.begin() + pos_, '\n');
+    auto context = input_.subpiece(pos_, 16 /* arbitrary */);
+    throw_exception<parse_error>(to<std::string>(
+        "json parse error on line ",
+        line,
+        !context.empty() ? to<std::string>(" near `", context, '\'') : "",
+        ": ",
+        what));
+  }
+
+  uint32_t parseValue(unsigned depth) {
+    if (depth > opts_.recursion_limit) {
+      error("recursion limit exceeded");
+    }
+    skipWhitespace();
+    auto const index = uint32_t(nodes_.size());
+    nodes_.push_back({uint32_t(pos_), 0, 0, 0, dynamic::NULLT, false});
+    auto const c = peek();
+    dynamic::Type type;
+    bool trailingWhitespace = false;
+    if (c == '[') {
+      type = dynamic::ARRAY;
+      parseArray(index, depth);
+    } else if (c == '{') {
+      type = dynamic::OBJECT;
+      parseObject(index, depth);
+    } else if (c == '"') {
+      type = dynamic::STRING;
+      parseString(index);
+    } else if (c == '-' || (c >= '0' && c <= '9')) {
+      type = parseNumber(trailingWhitespace);
+    } else if (consume("true") || consume("false")) {
+      type = dynamic::BOOL;
+    } else if (consume("null")) {
+      type = dynamic::NULLT;
+    } else if (consume("Infinity") || consume("NaN")) {
+      type =
+          opts_.parse_numbers_as_strings ? dynamic::STRING : dynamic::DOUBLE;
+    } else {
+      error("expected json value");
+    }
+    auto& node = nodes_[index];
+    node.end = uint32_t(pos_);
+    if (trailingWhitespace) {
+      skipWhitespace();
+    }
+    node.next = uint32_t(nodes_.size());
+    node.type = type;
+    return index;
+  }
+
+  void parseArray(uint32_t index, unsigned depth) {
+    ++pos_;
+    skipWhitespace();
+    if (peek() == ']') {
+      ++pos_;
+      return;
+    }
+    uint32_t size = 0;
+    for (;;) {
+      if (opts_.allow_trailing_comma && peek() == ']') {
+        break;
+      }
+      parseValue(depth + 1);
+      ++size;
+      skipWhitespace();
+      if (peek() != ',') {
+        break;
+      }
+      ++pos_;
+      skipWhitespace();
+    }
+    expect(']');
+    nodes_[index].size = size;
+  }
+
+  void parseObject(uint32_t index, unsigned depth) {
+    ++pos_;
+    skipWhitespace();
+    if (peek() == '}') {
+      ++pos_;
+      return;
+    }
+    uint32_t size = 0;
+    for (;;) {
+      if (opts_.allow_trailing_comma && peek() == '}') {
+        break;
+      }
+      auto const key = parseValue(depth + 1);
+      if (nodes_[key].type != dynamic::STRING) {
+        error("expected string for object key");
+      }
+      skipWhitespace();
+      expect(':');
+      skipWhitespace();
+      parseValue(depth + 1);
+      ++size;
+      skipWhitespace();
+      if (peek() != ',') {
+        break;
+      }
+      ++pos_;
+      skipWhitespace();
+    }
+    expect('}');
+    nodes_[index].size = size;
+  }
+
+  void parseString(uint32_t index) {
+    ++pos_;
+    for (;;) {
+      auto const rest = input_.subpiece(pos_);
+      auto const special = std::find_if(rest.begin(), rest.end(), [](char c) {
+        return c == '"' || c == '\\' || c == '\0';
+      });
+      pos_ += size_t(special - rest.begin());
+      auto const c = peek();
+      if (c == '"') {
+        ++pos_;
+        return;
+      }
+      if (c == EOF) {
+        error("unterminated string");
+      }
+      if (c == '\0') {
+        error("null byte in string");
+      }
+      nodes_[index].escaped = true;
+      ++pos_;
+      switch (peek()) {
+        case '"':
+        case '\\':
+        case '/':
+        case 'b':
+        case 'f':
+        case 'n':
+        case 'r':
+        case 't':
+          ++pos_;
+          break;
+        case 'u':
+          ++pos_;
+          parseUnicodeEscape();
+          break;
+        default:
+          error(to<std::string>("unknown escape ", peek(), " in string")
+                    .c_str());
+      }
+    }
+  }
+
+  uint16_t readHex() {
+    if (input_.size() - pos_ < 4) {
+      error("expected 4 hex digits");
+    }
+    uint16_t ret = 0;
+    for (int i = 0; i < 4; ++i, ++pos_) {
+      auto const c = input_[pos_];
+      // clang-format off
+      ret = uint16_t(ret * 16 + (
+          c >= '0' && c <= '9' ? c - '0' :
+          c >= 'a' && c <= 'f' ? c - 'a' + 10 :
+          c >= 'A' && c <= 'F' ? c - 'A' + 10 :
+          (error("invalid hex digit"), 0)));
+      // clang-format on
+    }
+    return ret;
+  }
+
+  void parseUnicodeEscape() {
+    uint16_t const prefix = readHex();
+    if (utf16_code_unit_is_high_surrogate(prefix)) {
+      if (!consume("\\u")) {
+        error(
+            "expected another unicode escape for second half of "
+            "surrogate pair");
+      }
+      if (!utf16_code_unit_is_low_surrogate(readHex())) {
+        error("second character in surrogate pair is invalid");
+      }
+    } else if (!utf16_code_unit_is_bmp(prefix)) {
+      error("invalid unicode code point (in range [0xdc00,0xdfff])");
+    }
+  }
+
+  // Numbers are checked with the conversions of parseJson(), which throw
+  // the same exceptions. Like there, integers skip the whitespace after
+  // them, which only matters to the position of errors.
+  dynamic::Type parseNumber(bool& trailingWhitespace) {
+    auto const begin = pos_;
+    bool const negative = peek() == '-';
+    if (negative && consume("-Infinity")) {
+      return opts_.parse_numbers_as_strings ? dynamic::STRING
+                                            : dynamic::DOUBLE;
+    }
+    if (negative) {
+      ++pos_;
+    }
+    skipDigits();
+    auto const integral = input_.subpiece(begin, pos_ - begin);
+    if (negative && integral.size() < 2) {
+      error("expected digits after `-'");
+    }
+
+    bool const wasE = peek() == 'e' || peek() == 'E';
+    if (peek() != '.' && !wasE) {
+      if (opts_.parse_numbers_as_strings) {
+        return dynamic::STRING;
+      }
+      constexpr const char* maxIntStr = "9223372036854775807";
+      constexpr const char* minIntStr = "-9223372036854775808";
+      constexpr auto maxIntLen = constexpr_strlen(maxIntStr);
+      constexpr auto minIntLen = constexpr_strlen(minIntStr);
+      auto extremaLen = negative ? minIntLen : maxIntLen;
+      auto extremaStr = negative ? minIntStr : maxIntStr;
+      if (!opts_.double_fallback || integral.size() < extremaLen ||
+          (integral.size() == extremaLen && integral <= extremaStr)) {
+        (void)to<int64_t>(integral);
+        trailingWhitespace = true;
+        return dynamic::INT64;
+      }
+      (void)to<double>(integral);
+      trailingWhitespace = true;
+      return dynamic::DOUBLE;
+    }
+
+    if (!wasE) {
+      ++pos_;
+      skipDigits();
+    }
+    if (peek() == 'e' || peek() == 'E') {
+      ++pos_;
+      if (peek() == '+' || peek() == '-') {
+        ++pos_;
+      }
+      skipDigits();
+    }
+    if (opts_.parse_numbers_as_strings) {
+      return dynamic::STRING;
+    }
+    (void)to<double>(input_.subpiece(begin, pos_ - begin));
+    return dynamic::DOUBLE;
+  }
+
+  StringPiece const input_;
+  serialization_opts const& opts_;
+  Nodes& nodes_;
+  size_t pos_{0};
+};
+
+LazyView::LazyView(StringPiece input, serialization_opts const& opts)
+    : input_(input),
+      doubleFallback_(opts.double_fallback),
+      parseNumbersAsStrings_(opts.parse_numbers_as_strings) {
+  index(opts);
+}
+
+LazyView::LazyView(
+    StringPiece input, SysArena& arena, serialization_opts const& opts)
+    : input_(input),
+      doubleFallback_(opts.double_fallback),
+      parseNumbersAsStrings_(opts.parse_numbers_as_strings),
+      nodes_(FallbackSysArenaAllocator<Node>(arena)) {
+  index(opts);
+}
+
+void LazyView::index(serialization_opts const& opts) {
+  if (input_.size() >= std::numeric_limits<uint32_t>::max()) {
+    throw_exception<std::length_error>("JSON input too large for LazyView");
+  }
+  Indexer(input_, opts, nodes_).parseDocument();
+}
+
+LazyView::Value LazyView::root() const {
+  return Value(this, 0);
+}
+
+serialization_opts LazyView::decodeOpts() const {
+  serialization_opts opts;
+  opts.double_fallback = doubleFallback_;
+  opts.parse_numbers_as_strings = parseNumbersAsStrings_;
+  opts.recursion_limit = std::numeric_limits<unsigned int>::max();
+  return opts;
+}
+
+StringPiece LazyView::Value::raw() const {
+  auto const& n = node();
+  return view_->input_.subpiece(n.begin, n.end - n.begin);
+}
+
+void LazyView::Value::expectType(
+    dynamic::Type type, char const* expected) const {
+  if (node().type != type) {
+    throw_exception<TypeError>(expected, node().type);
+  }
+}
+
+std::size_t LazyView::Value::size() const {
+  if (!isArray() && !isObject()) {
+    throw_exception<TypeError>("array/object", type());
+  }
+  return node().size;
+}
+
+bool LazyView::Value::keyEquals(StringPiece key) const {
+  auto text = raw();
+  if (text.front() == '"') {
+    if (node().escaped) {
+      return getString() == key;
+    }
+    text = text.subpiece(1, text.size() - 2);
+  }
+  // Otherwise a number, read as a string with parse_numbers_as_strings
+  return text == key;
+}
+
+Optional<LazyView::Value> LazyView::Value::get_ptr(StringPiece key) const {
+  Optional<Value> found;
+  forEachMember([&](Value k, Value value) {
+    // Of duplicate keys, the last one wins.
+    if (k.keyEquals(key)) {
+      found = value;
+    }
+  });
+  return found;
+}
+
+Optional<LazyView::Value> LazyView::Value::get_ptr(std::size_t index) const {
+  expectType(dynamic::ARRAY, "array");
+  if (index >= node().size) {
+    return none;
+  }
+  Value element(view_, index_ + 1);
+  for (; index > 0; --index) {
+    element = element.sibling();
+  }
+  return element;
+}
+
+Optional<LazyView::Value> LazyView::Value::get_ptr(
+    json_pointer const& pointer) const {
+  Value current = *this;
+  auto const& tokens = pointer.tokens();
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    auto const& token = tokens[i];
+    if (current.isArray()) {
+      if (token.size() > 1 && token[0] == '0') {
+        throw_exception<std::invalid_argument>(
+            "leading zero not allowed when indexing arrays");
+      }
+      // Appending, or beyond it
+      if (token == "-") {
+        return none;
+      }
+      auto const index = tryTo<size_t>(token);
+      if (!index.hasValue()) {
+        throw_exception<std::invalid_argument>("array index is not numeric");
+      }
+      auto element = current.get_ptr(index.value());
+      if (!element) {
+        return none;
+      }
+      current = *element;
+    } else if (current.isObject()) {
+      auto value = current.get_ptr(StringPiece(token));
+      if (!value) {
+        return none;
+      }
+      current = *value;
+    } else {
+      throw_exception<TypeError>("object/array", current.type());
+    }
+  }
+  return current;
+}
+
+LazyView::Value LazyView::Value::at(StringPiece key) const {
+  auto value = get_ptr(key);
+  if (!value) {
+    throw_exception<std::out_of_range>(
+        to<std::string>("couldn't find key ", key, " in JSON object"));
+  }
+  return *value;
+}
+
+LazyView::Value LazyView::Value::at(std::size_t index) const {
+  auto element = get_ptr(index);
+  if (!element) {
+    throw_exception<std::out_of_range>("out of range in JSON array");
+  }
+  return *element;
+}
+
+std::string LazyView::Value::getString() const {
+  expectType(dynamic::STRING, "string");
+  auto text = raw();
+  if (text.front() != '"') {
+    return text.str();
+  }
+  auto const content = text.subpiece(1, text.size() - 2);
+  if (!node().escaped) {
+    return content.str();
+  }
+  std::string ret(content.size(), '\0');
+  ret.resize(unescape(content, &ret[0]));
+  return ret;
+}
+
+StringPiece LazyView::Value::getString(SysArena& arena) const {
+  expectType(dynamic::STRING, "string");
+  auto text = raw();
+  if (text.front() != '"') {
+    return text;
+  }
+  auto const content = text.subpiece(1, text.size() - 2);
+  if (!node().escaped) {
+    return content;
+  }
+  auto const out = static_cast<char*>(arena.allocate(content.size()));
+  return StringPiece(out, unescape(content, out));
+}
+
+int64_t LazyView::Value::getInt() const {
+  expectType(dynamic::INT64, "int64");
+  return to<int64_t>(raw());
+}
+
+double LazyView::Value::getDouble() const {
+  expectType(dynamic::DOUBLE, "double");
+  return toDynamic().getDouble();
+}
+
+bool LazyView::Value::getBool() const {
+  expectType(dynamic::BOOL, "bool");
+  return raw().front() == 't';
+}
+
+dynamic LazyView::Value::toDynamic() const {
+  return parseJson(raw(), view_->decodeOpts());
+}
+
+} // namespace json
+} // namespace folly
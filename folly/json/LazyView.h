@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+#include <folly/json/dynamic.h>
+#include <folly/json/json.h>
+#include <folly/json/json_pointer.h>
+#include <folly/memory/Arena.h>
+
+namespace folly {
+namespace json {
+
+/**
+ * LazyView reads values out of a JSON document without building a dynamic
+ * for all of it.
+ *
+ * The constructor validates the whole document, as parseJson() would, and
+ * records the extent of every value in a flat index. Navigation by key,
+ * index or json_pointer then walks the index, and a value is only decoded
+ * when asked for: getString(), getInt() and so on decode scalars, and
+ * toDynamic() builds a dynamic of one subtree. Subtrees that are never
+ * looked at are never allocated for.
+ *
+ * The view refers to the input, which must outlive it and its values.
+ *
+ * For parse-and-discard workloads, the index can be kept in a SysArena, and
+ * strings decoded into it, so that a request's worth of JSON costs no heap
+ * allocations and is freed in one go with the arena:
+ *
+ *        SysArena arena;
+ *        json::LazyView view(input, arena);
+ *        StringPiece name = view.root()["name"].getString(arena);
+ *
+ * Of serialization_opts, parsing honors allow_trailing_comma,
+ * double_fallback, parse_numbers_as_strings and recursion_limit. Object keys
+ * must be strings, and of duplicate keys the last one wins, as with
+ * parseJson().
+ *
+ * Usage:
+ *
+ *        json::LazyView view(input);
+ *        auto port = view.root()["server"]["port"].getInt();
+ *        if (auto user = view.root().get_ptr(
+ *                json_pointer::parse("/users/0/name"))) {
+ *          ...
+ *        }
+ */
+class LazyView {
+ public:
+  class Value;
+
+  /**
+   * Validate and index a document. Throws json::parse_error, or the
+   * exceptions of folly::to() for numbers out of range, like parseJson().
+   */
+  explicit LazyView(
+      StringPiece input,
+      serialization_opts const& opts = serialization_opts());
+
+  /**
+   * As above, but allocate the index from an arena, which must outlive the
+   * view.
+   */
+  LazyView(
+      StringPiece input,
+      SysArena& arena,
+      serialization_opts const& opts = serialization_opts());
+
+  LazyView(const LazyView&) = delete;
+  LazyView& operator=(const LazyView&) = delete;
+
+  Value root() const;
+
+  StringPiece input() const { return input_; }
+
+ private:
+  struct Node {
+    uint32_t begin; // offset of the first byte of the value
+    uint32_t end; // offset one past its last byte
+    uint32_t next; // index of the node after the value and its children
+    uint32_t size; // elements of an array, members of an object
+    dynamic::Type type;
+    bool escaped; // a string with escape sequences
+  };
+  using Nodes = std::vector<Node, FallbackSysArenaAllocator<Node>>;
+  class Indexer;
+
+  void index(serialization_opts const& opts);
+  serialization_opts decodeOpts() const;
+
+  StringPiece input_;
+  bool doubleFallback_;
+  bool parseNumbersAsStrings_;
+  Nodes nodes_;
+};
+
+/**
+ * A value within a LazyView: a cheap handle, valid as long as the view.
+ *
+ * Objects are children of their object as alternating keys and values, and
+ * looking up a key or an index walks the children in order.
+ */
+class LazyView::Value {
+ public:
+  dynamic::Type type() const { return node().type; }
+
+  bool isNull() const { return type() == dynamic::NULLT; }
+  bool isBool() const { return type() == dynamic::BOOL; }
+  bool isInt() const { return type() == dynamic::INT64; }
+  bool isDouble() const { return type() == dynamic::DOUBLE; }
+  bool isNumber() const { return isInt() || isDouble(); }
+  bool isString() const { return type() == dynamic::STRING; }
+  bool isArray() const { return type() == dynamic::ARRAY; }
+  bool isObject() const { return type() == dynamic::OBJECT; }
+
+  /**
+   * The text of the value in the input.
+   */
+  StringPiece raw() const;
+
+  /**
+   * The number of elements or members; TypeError for other types.
+   */
+  std::size_t size() const;
+
+  /**
+   * The value of a key, or none. TypeError if not an object.
+   */
+  Optional<Value> get_ptr(StringPiece key) const;
+
+  /**
+   * The element at an index, or none. TypeError if not an array.
+   */
+  Optional<Value> get_ptr(std::size_t index) const;
+
+  /**
+   * Resolve a JSON pointer, with the semantics of dynamic::get_ptr().
+   */
+  Optional<Value> get_ptr(json_pointer const& pointer) const;
+
+  /**
+   * As get_ptr(), but throw std::out_of_range if there is no such value.
+   */
+  Value at(StringPiece key) const;
+  Value at(std::size_t index) const;
+  Value operator[](StringPiece key) const { return at(key); }
+  Value operator[](std::size_t index) const { return at(index); }
+
+  /**
+   * Call fn(Value) for each element of an array, or fn(Value key, Value)
+   * for each member of an object.
+   */
+  template <typename Fn>
+  void forEachElement(Fn fn) const;
+  template <typename Fn>
+  void forEachMember(Fn fn) const;
+
+  /**
+   * Decode a scalar; TypeError if the value has another type.
+   */
+  std::string getString() const;
+  int64_t getInt() const;
+  double getDouble() const;
+  bool getBool() const;
+
+  /**
+   * As getString(), without copying: strings without escape sequences refer
+   * to the input, and others are decoded into the arena. Either way the
+   * result lives as long as the input and the arena.
+   */
+  StringPiece getString(SysArena& arena) const;
+
+  /**
+   * Decode the value and everything below it, as parseJson() would.
+   */
+  dynamic toDynamic() const;
+
+ private:
+  friend class LazyView;
+
+  Value(LazyView const* view, uint32_t index) : view_(view), index_(index) {}
+
+  Node const& node() const { return view_->nodes_[index_]; }
+  Value sibling() const { return Value(view_, node().next); }
+  void expectType(dynamic::Type type, char const* expected) const;
+  bool keyEquals(StringPiece key) const;
+
+  LazyView const* view_;
+  uint32_t index_;
+};
+
+template <typename Fn>
+void LazyView::Value::forEachElement(Fn fn) const {
+  expectType(dynamic::ARRAY, "array");
+  Value element(view_, index_ + 1);
+  for (uint32_t i = 0; i < node().size; ++i) {
+    fn(element);
+    element = element.sibling();
+  }
+}
+
+template <typename Fn>
+void LazyView::Value::forEachMember(Fn fn) const {
+  expectType(dynamic::OBJECT, "object");
+  Value key(view_, index_ + 1);
+  for (uint32_t i = 0; i < node().size; ++i) {
+    Value value(view_, key.index_ + 1);
+    fn(key, value);
+    key = value.sibling();
+  }
+}
+
+} // namespace json
+} // namespace folly
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/StreamParser.h>
+
+#include <algorithm>
+
+#include <folly/Conv.h>
+#include <folly/io/IOBuf.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+namespace json {
+
+namespace {
+
+bool isWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+// Bytes that end a number or literal.
+bool isDelimiter(char c) {
+  switch (c) {
+    case ' ':
+    case '\n':
+    case '\t':
+    case '\r':
+    case ',':
+    case ':':
+    case '[':
+    case ']':
+    case '{':
+    case '}':
+    case '"':
+      return true;
+    default:
+      return false;
+  }
+}
+
+// The options that parseJson() reads, as serialization_opts can't be copied.
+serialization_opts parseOpts(serialization_opts const& opts) {
+  serialization_opts ret;
+  ret.allow_non_string_keys = opts.allow_non_string_keys;
+  ret.convert_int_keys = opts.convert_int_keys;
+  ret.validate_keys = opts.validate_keys;
+  ret.allow_trailing_comma = opts.allow_trailing_comma;
+  ret.double_fallback = opts.double_fallback;
+  ret.parse_numbers_as_strings = opts.parse_numbers_as_strings;
+  ret.recursion_limit = opts.recursion_limit;
+  ret.simd_structural_index = opts.simd_structural_index;
+  return ret;
+}
+
+} // namespace
+
+StreamParser::StreamParser(
+    Callback callback, serialization_opts const& opts, Mode mode)
+    : callback_(std::move(callback)),
+      opts_(parseOpts(opts)),
+      mode_(mode),
+      state_(mode == Mode::ArrayElements ? State::BeforeArray
+                                         : State::BeforeValue) {}
+
+void StreamParser::feed(IOBuf const& chain) {
+  for (auto range : chain) {
+    feed(range);
+  }
+}
+
+void StreamParser::feed(StringPiece chunk) {
+  auto const n = chunk.size();
+  size_t start = 0; // of the current value within the chunk
+  size_t i = 0;
+  while (i < n) {
+    char const c = chunk[i];
+    switch (state_) {
+      case State::BeforeArray:
+        if (c == '[') {
+          state_ = State::BeforeValue;
+        } else if (c == '\n') {
+          ++line_;
+        } else if (!isWhitespace(c)) {
+          error("expected '['");
+        }
+        ++i;
+        break;
+
+      case State::BeforeValue:
+        start = i;
+        if (c == '{' || c == '[') {
+          depth_ = 1;
+          state_ = State::InContainer;
+        } else if (c == '"') {
+          state_ = State::InString;
+        } else if (mode_ == Mode::ArrayElements && c == ']') {
+          if (afterComma_ && !opts_.allow_trailing_comma) {
+            error("expected json value");
+          }
+          state_ = State::Done;
+        } else if (!isDelimiter(c)) {
+          state_ = State::InScalar;
+        } else if (c == '\n') {
+          ++line_;
+        } else if (!isWhitespace(c)) {
+          error("expected json value");
+        }
+        ++i;
+        break;
+
+      case State::InContainer:
+        for (; i < n && state_ == State::InContainer; ++i) {
+          switch (chunk[i]) {
+            case '"':
+              state_ = State::InString;
+              break;
+            case '{':
+            case '[':
+              ++depth_;
+              break;
+            case '}':
+            case ']':
+              if (--depth_ == 0) {
+                complete(chunk.subpiece(start, i + 1 - start));
+              }
+              break;
+            case '\n':
+              ++line_;
+              break;
+          }
+        }
+        break;
+
+      case State::InString:
+        if (escaped_) {
+          escaped_ = false;
+          ++i;
+          break;
+        }
+        i = size_t(
+            std::find_if(
+                chunk.begin() + i,
+                chunk.end(),
+                [](char b) { return b == '"' || b == '\\'; }) -
+            chunk.begin());
+        if (i == n) {
+          break;
+        }
+        if (chunk[i++] == '\\') {
+          escaped_ = true;
+        } else if (depth_ == 0) {
+          complete(chunk.subpiece(start, i - start));
+        } else {
+          state_ = State::InContainer;
+        }
+        break;
+
+      case State::InScalar:
+        while (i < n && !isDelimiter(chunk[i])) {
+          ++i;
+        }
+        if (i < n) {
+          // The delimiter is scanned again after the value.
+          complete(chunk.subpiece(start, i - start));
+        }
+        break;
+
+      case State::AfterValue:
+        if (c == ',') {
+          afterComma_ = true;
+          state_ = State::BeforeValue;
+        } else if (c == ']') {
+          state_ = State::Done;
+        } else if (c == '\n') {
+          ++line_;
+        } else if (!isWhitespace(c)) {
+          error("expected ',' or ']'");
+        }
+        ++i;
+        break;
+
+      case State::Done:
+        if (c == '\n') {
+          ++line_;
+        } else if (!isWhitespace(c)) {
+          error("parsing didn't consume all input");
+        }
+        ++i;
+        break;
+    }
+  }
+
+  if (state_ == State::InContainer || state_ == State::InString ||
+      state_ == State::InScalar) {
+    buffer_.append(chunk.begin() + start, chunk.end());
+  }
+}
+
+void StreamParser::finish() {
+  if (state_ == State::InScalar) {
+    complete(StringPiece());
+  }
+  switch (state_) {
+    case State::InContainer:
+    case State::InString:
+      error("unexpected end of input in json value");
+    case State::BeforeArray:
+      error("expected '['");
+    case State::BeforeValue:
+      if (mode_ == Mode::ArrayElements) {
+        error("expected json value");
+      }
+      break;
+    case State::AfterValue:
+      error("expected ',' or ']'");
+    case State::InScalar:
+    case State::Done:
+      break;
+  }
+}
+
+void StreamParser::complete(StringPiece tail) {
+  dynamic value;
+  if (buffer_.empty()) {
+    value = parseJson(tail, opts_);
+  } else {
+    buffer_.append(tail.begin(), tail.end());
+    value = parseJson(buffer_, opts_);
+    buffer_.clear();
+  }
+  state_ =
+      mode_ == Mode::ArrayElements ? State::AfterValue : State::BeforeValue;
+  afterComma_ = false;
+  callback_(std::move(value));
+}
+
+void StreamParser::error(char const* what) const {
+  throw_exception<parse_error>(
+      to<std::string>("json parse error on line ", line_, ": ", what));
+}
+
+} // namespace json
+} // namespace folly
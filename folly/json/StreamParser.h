@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <folly/Function.h>
+#include <folly/Range.h>
+#include <folly/json/dynamic.h>
+#include <folly/json/json.h>
+
+namespace folly {
+
+class IOBuf;
+
+namespace json {
+
+/**
+ * StreamParser parses JSON text that arrives in pieces, such as a body read
+ * off the network, without buffering all of it first.
+ *
+ * Each call to feed() scans one more piece, and each value that it completes
+ * is parsed, as parseJson() would, and passed to the callback. Only a value
+ * split across pieces is copied, until it completes, so memory is bounded by
+ * the largest value rather than the whole stream, and parsing keeps pace
+ * with the input.
+ *
+ * The stream is split into values in one of two ways:
+ *
+ *  - Mode::Values: a sequence of values separated by whitespace, such as
+ *    newline-delimited JSON.
+ *  - Mode::ArrayElements: a single array, whose elements are passed to the
+ *    callback one at a time, so that a large array of records is parsed in
+ *    the memory of one record.
+ *
+ * Errors are thrown as json::parse_error from feed() or finish(). Lines are
+ * counted from the start of the stream for errors between values, and from
+ * the start of the value for errors within one. After an error, or an
+ * exception from the callback, the parser must not be used again.
+ *
+ * Usage:
+ *
+ *        json::StreamParser parser([&](dynamic&& record) { ... });
+ *        while (auto buf = readChunk()) {
+ *          parser.feed(*buf);
+ *        }
+ *        parser.finish();
+ */
+class StreamParser {
+ public:
+  enum class Mode {
+    Values,
+    ArrayElements,
+  };
+
+  using Callback = Function<void(dynamic&&)>;
+
+  explicit StreamParser(
+      Callback callback,
+      serialization_opts const& opts = serialization_opts(),
+      Mode mode = Mode::Values);
+
+  StreamParser(const StreamParser&) = delete;
+  StreamParser& operator=(const StreamParser&) = delete;
+
+  /**
+   * Scan the next piece of the stream, calling the callback for each value
+   * it completes.
+   */
+  void feed(StringPiece chunk);
+  void feed(ByteRange chunk) {
+    feed(StringPiece(
+        reinterpret_cast<const char*>(chunk.data()), chunk.size()));
+  }
+  void feed(IOBuf const& chain);
+
+  /**
+   * Signal the end of the stream: parse a number or literal at its very end,
+   * which only the end can complete, and throw parse_error if a value or the
+   * array of Mode::ArrayElements is incomplete.
+   */
+  void finish();
+
+ private:
+  enum class State : uint8_t {
+    BeforeArray, // Mode::ArrayElements, before its '['
+    BeforeValue,
+    InContainer,
+    InString,
+    InScalar, // a number or literal, which ends at the next delimiter
+    AfterValue, // Mode::ArrayElements, before ',' or ']'
+    Done, // Mode::ArrayElements, after its ']'
+  };
+
+  void complete(StringPiece tail);
+  [[noreturn]] void error(char const* what) const;
+
+  Callback callback_;
+  serialization_opts const opts_;
+  Mode const mode_;
+  State state_;
+  bool escaped_{false}; // the next byte of a string is escaped
+  bool afterComma_{false}; // an array element may not be ']'
+  uint32_t depth_{0};
+  uint32_t line_{0};
+  // The beginning of a value that continues past the pieces fed so far
+  std::string buffer_;
+};
+
+} // namespace json
+} // namespace folly
@@ -17,6 +17,7 @@
 #include <folly/json/json.h>
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <iterator>
 #include <sstream>
@@ -30,6 +31,9 @@
 #include <folly/Range.h>
 #include <folly/Unicode.h>
 #include <folly/Utility.h>
+#include <folly/detail/SimdCharPlatform.h>
+#include <folly/io/Cursor.h>
+#include <folly/io/IOBufQueue.h>
 #include <folly/lang/Bits.h>
 #include <folly/portability/Constexpr.h>
 
@@ -39,6 +43,10 @@ namespace folly {
 
 namespace json {
 
+template <class Out>
+void escapeStringTo(
+    StringPiece input, Out& out, const serialization_opts& opts);
+
 namespace {
 
 parse_error make_parse_error(
@@ -53,6 +61,35 @@ parse_error make_parse_error(
       expected));
 }
 
+// Appends to the tail of an IOBufQueue, with the subset of the interface of
+// std::string that Printer and escapeStringTo() use.
+class QueueSink {
+ public:
+  QueueSink(IOBufQueue& queue, size_t growth) : appender_(&queue, growth) {}
+
+  void push_back(char c) { appender_.write(c); }
+  void append(const char* s, size_t n) {
+    appender_.push(reinterpret_cast<const uint8_t*>(s), n);
+  }
+  void append(StringPiece s) { append(s.data(), s.size()); }
+  QueueSink& operator+=(char c) {
+    push_back(c);
+    return *this;
+  }
+  QueueSink& operator+=(StringPiece s) {
+    append(s);
+    return *this;
+  }
+
+  // toAppend() formats numbers into strings only.
+  std::string& scratch() { return scratch_; }
+
+ private:
+  io::QueueAppender appender_;
+  std::string scratch_;
+};
+
+template <class Out>
 struct Printer {
   // Context class is allows to restore the path to element that we are about to
   // print so that if error happens we can throw meaningful exception.
@@ -95,7 +132,7 @@ struct Printer {
   };
 
   explicit Printer(
-      std::string& out, unsigned* indentLevel, serialization_opts const* opts)
+      Out& out, unsigned* indentLevel, serialization_opts const* opts)
       : out_(out), indentLevel_(indentLevel), opts_(*opts) {}
 
   void operator()(dynamic const& v, const Context& context) const {
@@ -116,12 +153,14 @@ struct Printer {
                 contextDescription(context));
           }
         }
-        toAppend(
-            v.asDouble(),
-            &out_,
-            opts_.double_mode,
-            opts_.double_num_digits,
-            opts_.double_flags);
+        appendFormatted([&](std::string& str) {
+          toAppend(
+              v.asDouble(),
+              &str,
+              opts_.double_mode,
+              opts_.double_num_digits,
+              opts_.double_flags);
+        });
         break;
       case dynamic::INT64: {
         auto intval = v.asInt();
@@ -130,7 +169,7 @@ struct Printer {
           // as a double without loss of precision.
           intval = int64_t(to<double>(intval));
         }
-        toAppend(intval, &out_);
+        appendFormatted([&](std::string& str) { toAppend(intval, &str); });
         break;
       }
       case dynamic::BOOL:
@@ -140,7 +179,7 @@ struct Printer {
         out_ += "null";
         break;
       case dynamic::STRING:
-        escapeString(v.stringPiece(), out_, opts_);
+        escapeStringTo(v.stringPiece(), out_, opts_);
         break;
       case dynamic::OBJECT:
         printObject(v, context);
@@ -234,7 +273,7 @@ struct Printer {
       serialization_opts opts;
       opts.allow_nan_inf = true;
       opts.allow_non_string_keys = true;
-      Printer printer(result, &indentLevel, &opts);
+      Printer<std::string> printer(result, &indentLevel, &opts);
       printer(v, nullptr);
       return result;
     } catch (...) {
@@ -291,18 +330,206 @@ struct Printer {
 
   void mapColon() const { out_ += indentLevel_ ? ": " : ":"; }
 
+  template <typename Format>
+  void appendFormatted(Format format) const {
+    if constexpr (std::is_same_v<Out, std::string>) {
+      format(out_);
+    } else {
+      auto& str = out_.scratch();
+      str.clear();
+      format(str);
+      out_.append(str.data(), str.size());
+    }
+  }
+
  private:
-  std::string& out_;
+  Out& out_;
   unsigned* const indentLevel_;
   serialization_opts const& opts_;
 };
 
 //////////////////////////////////////////////////////////////////////
 
+/*
+ * The structural index of serialization_opts::simd_structural_index.
+ *
+ * The input is classified 64 bytes at a time into bitmasks of quotes,
+ * backslashes, whitespace and structural characters, from which follow the
+ * escaped characters and the bytes inside strings. The index lists, in
+ * order, the position and line number of:
+ *
+ *  - the structural characters ({}[]:,) and quotes outside strings,
+ *  - the first byte of every run of other characters outside strings
+ *    (numbers, literals, and garbage alike),
+ *  - the closing quotes, and the backslashes inside strings.
+ *
+ * So the next entry after whitespace is the next token, and the next entry
+ * inside a string is where its plain content ends. Like the plain scan in
+ * skipStringContent(), that content may include null bytes.
+ */
+struct StructuralIndexEntry {
+  uint32_t pos;
+  uint32_t line; // the number of newlines before pos
+};
+
+struct BlockMasks {
+  uint64_t quote = 0;
+  uint64_t backslash = 0;
+  uint64_t newline = 0;
+  uint64_t whitespace = 0;
+  uint64_t op = 0;
+};
+
+#if FOLLY_DETAIL_HAS_SIMD_CHAR_PLATFORM
+
+using SimdPlatform = simd_detail::SimdCharPlatform;
+static_assert(
+    SimdPlatform::kMmaskBitsPerElement == 1 ||
+    SimdPlatform::kMmaskBitsPerElement == 4);
+
+// One bit per byte, whatever the movemask layout of the platform.
+uint64_t byteMask(typename SimdPlatform::mmask_t mmask) {
+  if constexpr (SimdPlatform::kMmaskBitsPerElement == 1) {
+    return mmask;
+  } else {
+    uint64_t x = mmask & 0x1111111111111111;
+    x = (x | (x >> 3)) & 0x0303030303030303;
+    x = (x | (x >> 6)) & 0x000F000F000F000F;
+    x = (x | (x >> 12)) & 0x000000FF000000FF;
+    return (x | (x >> 24)) & 0xFFFF;
+  }
+}
+
+void classifyBlock(const char* p, BlockMasks& masks) {
+  using P = SimdPlatform;
+  for (int i = 0; i < 64; i += P::kCardinal) {
+    auto reg = P::loadu(p + i, simd_detail::ignore_none{});
+    auto bits = [&](typename P::logical_t logical) {
+      return byteMask(P::movemask(logical)) << i;
+    };
+    auto newline = P::equal(reg, '\n');
+    masks.quote |= bits(P::equal(reg, '"'));
+    masks.backslash |= bits(P::equal(reg, '\\'));
+    masks.newline |= bits(newline);
+    masks.whitespace |= bits(P::logical_or(
+        P::logical_or(P::equal(reg, ' '), newline),
+        P::logical_or(P::equal(reg, '\t'), P::equal(reg, '\r'))));
+    masks.op |= bits(P::logical_or(
+        P::logical_or(
+            P::logical_or(P::equal(reg, '{'), P::equal(reg, '}')),
+            P::logical_or(P::equal(reg, '['), P::equal(reg, ']'))),
+        P::logical_or(P::equal(reg, ':'), P::equal(reg, ','))));
+  }
+}
+
+#else
+
+void classifyBlock(const char* p, BlockMasks& masks) {
+  for (int i = 0; i < 64; ++i) {
+    uint64_t const bit = uint64_t(1) << i;
+    switch (p[i]) {
+      case '"':
+        masks.quote |= bit;
+        break;
+      case '\\':
+        masks.backslash |= bit;
+        break;
+      case '\n':
+        masks.newline |= bit;
+        masks.whitespace |= bit;
+        break;
+      case ' ':
+      case '\t':
+      case '\r':
+        masks.whitespace |= bit;
+        break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+        masks.op |= bit;
+        break;
+    }
+  }
+}
+
+#endif
+
+// Each bit set iff an odd number of bits are set at or below it.
+uint64_t prefixXor(uint64_t x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+
+std::vector<StructuralIndexEntry> buildStructuralIndex(StringPiece input) {
+  constexpr uint64_t kOddBits = 0xAAAAAAAAAAAAAAAA;
+
+  std::vector<StructuralIndexEntry> index;
+  index.reserve(input.size() / 4);
+  uint64_t prevEscaped = 0; // the first byte is escaped
+  uint64_t prevInString = 0; // all ones if the block starts in a string
+  uint64_t prevScalar = 0; // the block follows a scalar character
+  uint32_t line = 0;
+  for (size_t offset = 0; offset < input.size(); offset += 64) {
+    const char* p = input.data() + offset;
+    char tail[64];
+    if (input.size() - offset < 64) {
+      std::memset(tail, ' ', sizeof(tail));
+      std::memcpy(tail, p, input.size() - offset);
+      p = tail;
+    }
+    BlockMasks masks;
+    classifyBlock(p, masks);
+
+    // Backslashes escape the next byte, unless escaped themselves: within
+    // each run of backslashes, every other one is an escape.
+    uint64_t const escapes = masks.backslash & ~prevEscaped;
+    uint64_t const escapeAndTerminal =
+        (((escapes << 1) | kOddBits) - escapes) ^ kOddBits;
+    uint64_t const escaped =
+        escapeAndTerminal ^ (masks.backslash | prevEscaped);
+    prevEscaped = (escapeAndTerminal & masks.backslash) >> 63;
+
+    uint64_t const quotes = masks.quote & ~escaped;
+    uint64_t const inString = prefixXor(quotes) ^ prevInString;
+    prevInString = uint64_t(int64_t(inString) >> 63);
+    uint64_t const outside = ~(inString | quotes);
+    uint64_t const scalar = outside & ~(masks.whitespace | masks.op);
+    uint64_t const scalarStart = scalar & ~((scalar << 1) | prevScalar);
+    prevScalar = scalar >> 63;
+
+    uint64_t entries = (masks.op & outside) | quotes | scalarStart |
+        (masks.backslash & inString);
+    for (; entries != 0; entries &= entries - 1) {
+      auto const bit = findFirstSet(entries) - 1;
+      index.push_back(
+          {uint32_t(offset + bit),
+           line +
+               uint32_t(popcount(
+                   masks.newline & ((uint64_t(1) << bit) - 1)))});
+    }
+    line += uint32_t(popcount(masks.newline));
+  }
+  return index;
+}
+
 // Wraps our input buffer with some helper functions.
 struct Input {
   explicit Input(StringPiece range, json::serialization_opts const* opts)
       : range_(range), opts_(*opts), lineNum_(0) {
+    if (opts_.simd_structural_index &&
+        range.size() < std::numeric_limits<uint32_t>::max()) {
+      index_ = buildStructuralIndex(range);
+      begin_ = range.begin();
+      indexed_ = true;
+    }
     storeCurrent();
   }
 
@@ -345,7 +572,24 @@ struct Input {
     });
   }
 
+  // Skip the content of a string, up to its closing quote or the next
+  // escape sequence.
+  StringPiece skipStringContent() {
+    if (indexed_) {
+      auto start = range_.begin();
+      skipToIndexEntry();
+      return StringPiece(start, range_.begin());
+    }
+    return skipWhile([](char c) { return c != '\"' && c != '\\'; });
+  }
+
   void skipWhitespace() {
+    if (indexed_ &&
+        (current_ == ' ' || current_ == '\n' || current_ == '\t' ||
+         current_ == '\r')) {
+      skipToIndexEntry();
+      return;
+    }
     unsigned index = 0;
     while (true) {
       while (index < range_.size() && range_[index] == ' ') {
@@ -429,12 +673,34 @@ struct Input {
  private:
   void storeCurrent() { current_ = range_.empty() ? EOF : range_.front(); }
 
+  // Advance to the first index entry at or after the current position, or to
+  // the end of the input.
+  void skipToIndexEntry() {
+    auto const pos = size_t(range_.begin() - begin_);
+    while (nextEntry_ < index_.size() && index_[nextEntry_].pos < pos) {
+      ++nextEntry_;
+    }
+    if (nextEntry_ < index_.size()) {
+      auto const& entry = index_[nextEntry_];
+      range_.advance(entry.pos - pos);
+      lineNum_ = entry.line;
+    } else {
+      lineNum_ += unsigned(std::count(range_.begin(), range_.end(), '\n'));
+      range_.advance(range_.size());
+    }
+    storeCurrent();
+  }
+
  private:
   StringPiece range_;
   json::serialization_opts const& opts_;
   unsigned lineNum_;
   int current_;
   unsigned int currentRecursionLevel_{0};
+  bool indexed_{false};
+  char const* begin_{nullptr};
+  std::vector<StructuralIndexEntry> index_;
+  size_t nextEntry_{0};
 };
 
 class RecursionGuard {
@@ -672,7 +938,7 @@ std::string parseString(Input& in) {
 
   std::string ret;
   for (;;) {
-    auto range = in.skipWhile([](char c) { return c != '\"' && c != '\\'; });
+    auto range = in.skipStringContent();
     ret.append(range.begin(), range.end());
 
     if (*in == '\"') {
@@ -717,6 +983,9 @@ std::string parseString(Input& in) {
     ++in;
   }
 
+  if (in.getOpts().validate_utf8 && !isValidUtf8(ret)) {
+    in.error("invalid utf8 in string");
+  }
   return ret;
 }
 
@@ -760,16 +1029,30 @@ std::array<uint64_t, 2> buildExtraAsciiToEscapeBitmap(StringPiece chars) {
 std::string serialize(dynamic const& dyn, serialization_opts const& opts) {
   std::string ret;
   unsigned indentLevel = 0;
-  Printer p(ret, opts.pretty_formatting ? &indentLevel : nullptr, &opts);
+  Printer<std::string> p(
+      ret, opts.pretty_formatting ? &indentLevel : nullptr, &opts);
   p(dyn, nullptr);
   return ret;
 }
 
+void serialize(
+    dynamic const& dyn,
+    serialization_opts const& opts,
+    IOBufQueue& out,
+    size_t growth) {
+  QueueSink sink(out, growth);
+  unsigned indentLevel = 0;
+  Printer<QueueSink> p(
+      sink, opts.pretty_formatting ? &indentLevel : nullptr, &opts);
+  p(dyn, nullptr);
+}
+
 // Fast path to determine the longest prefix that can be left
 // unescaped in a string of sizeof(T) bytes packed in an integer of
 // type T.
 template <bool EnableExtraAsciiEscapes, class T>
-size_t firstEscapableInWord(T s, const serialization_opts& opts) {
+size_t firstEscapableInWord(
+    T s, const serialization_opts& opts, bool copyNonAscii) {
   static_assert(std::is_unsigned<T>::value, "Unsigned integer required");
   static constexpr T kOnes = ~T() / 255; // 0x...0101
   static constexpr T kMsbs = kOnes * 0x80; // 0x...8080
@@ -788,7 +1071,7 @@ size_t firstEscapableInWord(T s, const serialization_opts& opts) {
 
   // The following masks have the MSB set for each byte of the word
   // that satisfies the corresponding condition.
-  auto isHigh = s & kMsbs; // >= 128
+  auto isHigh = copyNonAscii ? 0 : s & kMsbs; // >= 128
   auto isLow = isLess(s, 0x20); // <= 0x1f
   auto needsEscape = isHigh | isLow | isChar('\\') | isChar('"');
 
@@ -823,10 +1106,44 @@ size_t firstEscapableInWord(T s, const serialization_opts& opts) {
   }
 }
 
+#if FOLLY_DETAIL_HAS_SIMD_CHAR_PLATFORM
+
+namespace {
+
+// Skip whole registers of printable ASCII other than '"' and '\\', which is
+// most of the text of most strings, and of non-ASCII bytes if they are copied
+// as is. Returns the first byte that may need escaping, or a position less
+// than a register from the end.
+const unsigned char* skipUnescaped(
+    const unsigned char* p, const unsigned char* e, bool copyNonAscii) {
+  using P = SimdPlatform;
+  while (e - p >= P::kCardinal) {
+    auto reg = P::loadu(
+        reinterpret_cast<const char*>(p), simd_detail::ignore_none{});
+    auto special = P::logical_or(
+        P::le_unsigned(reg, 0x1f),
+        P::logical_or(P::equal(reg, '"'), P::equal(reg, '\\')));
+    auto escapable = byteMask(P::movemask(special));
+    if (!copyNonAscii) {
+      auto ascii = byteMask(P::movemask(P::le_unsigned(reg, 0x7f)));
+      escapable |= ~ascii & ((uint64_t(1) << P::kCardinal) - 1);
+    }
+    if (escapable) {
+      return p + findFirstSet(escapable) - 1;
+    }
+    p += P::kCardinal;
+  }
+  return p;
+}
+
+} // namespace
+
+#endif
+
 // Escape a string so that it is legal to print it in JSON text.
-template <bool EnableExtraAsciiEscapes>
+template <bool EnableExtraAsciiEscapes, class Out>
 void escapeStringImpl(
-    StringPiece input, std::string& out, const serialization_opts& opts) {
+    StringPiece input, Out& out, const serialization_opts& opts) {
   auto hexDigit = [](uint8_t c) -> char {
     return c < 10 ? c + '0' : c - 10 + 'a';
   };
@@ -837,10 +1154,25 @@ void escapeStringImpl(
   auto* q = reinterpret_cast<const unsigned char*>(input.begin());
   auto* e = reinterpret_cast<const unsigned char*>(input.end());
 
+  // Since non-ascii encoding inherently does utf8 validation
+  // we explicitly validate utf8 only if non-ascii encoding is disabled.
+  // Valid input, which is the common case, is checked in one vectorized
+  // pass, after which non-ascii bytes are copied as is with the ascii
+  // ones; only invalid input is validated a code point at a time below,
+  // to throw or replace in place.
+  bool const validate = (opts.validate_utf8 || opts.skip_invalid_utf8) &&
+      !opts.encode_non_ascii && !isValidUtf8(input);
+  bool const copyNonAscii = !opts.encode_non_ascii && !validate;
+
   while (p < e) {
     // Find the longest prefix that does not need escaping, and copy
     // it literally into the output string.
     auto firstEsc = p;
+#if FOLLY_DETAIL_HAS_SIMD_CHAR_PLATFORM
+    if constexpr (!EnableExtraAsciiEscapes) {
+      firstEsc = skipUnescaped(firstEsc, e, copyNonAscii);
+    }
+#endif
     while (firstEsc < e) {
       auto avail = to_unsigned(e - firstEsc);
       uint64_t word = 0;
@@ -849,7 +1181,8 @@ void escapeStringImpl(
       } else {
         word = folly::partialLoadUnaligned<uint64_t>(firstEsc, avail);
       }
-      auto prefix = firstEscapableInWord<EnableExtraAsciiEscapes>(word, opts);
+      auto prefix = firstEscapableInWord<EnableExtraAsciiEscapes>(
+          word, opts, copyNonAscii);
       DCHECK_LE(prefix, avail);
       firstEsc += prefix;
       if (prefix < 8) {
@@ -867,11 +1200,7 @@ void escapeStringImpl(
     }
 
     // Handle the next byte that may need escaping.
-
-    // Since non-ascii encoding inherently does utf8 validation
-    // we explicitly validate utf8 only if non-ascii encoding is disabled.
-    if ((opts.validate_utf8 || opts.skip_invalid_utf8) &&
-        !opts.encode_non_ascii) {
+    if (validate) {
       // To achieve better spatial and temporal coherence
       // we do utf8 validation progressively along with the
       // string-escaping instead of two separate passes.
@@ -959,8 +1288,9 @@ void escapeStringImpl(
   out.push_back('\"');
 }
 
-void escapeString(
-    StringPiece input, std::string& out, const serialization_opts& opts) {
+template <class Out>
+void escapeStringTo(
+    StringPiece input, Out& out, const serialization_opts& opts) {
   if (FOLLY_UNLIKELY(
           opts.extra_ascii_to_escape_bitmap[0] ||
           opts.extra_ascii_to_escape_bitmap[1])) {
@@ -970,6 +1300,11 @@ void escapeString(
   }
 }
 
+void escapeString(
+    StringPiece input, std::string& out, const serialization_opts& opts) {
+  escapeStringTo(input, out, opts);
+}
+
 std::string stripComments(StringPiece jsonC) {
   std::string result;
   enum class State {
@@ -50,6 +50,8 @@
 
 namespace folly {
 
+class IOBufQueue;
+
 //////////////////////////////////////////////////////////////////////
 
 namespace json {
@@ -86,7 +88,8 @@ struct serialization_opts {
   // - if the code point is > U+FFFF => encode as 2 UTF-16 surrogate pairs.
   bool encode_non_ascii{false};
 
-  // Check that strings are valid utf8
+  // Check that strings are valid utf8, both when serializing and, after
+  // unescaping, when parsing
   bool validate_utf8{false};
 
   // Check that keys are distinct
@@ -129,6 +132,12 @@ struct serialization_opts {
   // Recursion limit when parsing.
   unsigned int recursion_limit{100};
 
+  // Parse in two stages: a SIMD pass first indexes the structural
+  // characters, strings and scalars of the input, and the parser then jumps
+  // from one entry to the next instead of scanning whitespace and strings
+  // byte by byte. The results, errors and line numbers are the same.
+  bool simd_structural_index{false};
+
   // Bitmap representing ASCII characters to escape with unicode
   // representations. The least significant bit of the first in the pair is
   // ASCII value 0; the most significant bit of the second in the pair is ASCII
@@ -155,6 +164,20 @@ std::array<uint64_t, 2> buildExtraAsciiToEscapeBitmap(StringPiece chars);
  */
 std::string serialize(dynamic const&, serialization_opts const&);
 
+/**
+ * Serialize dynamic to json, appending it to a queue rather than a string.
+ *
+ * The output is written straight into the tail of the queue, which grows by
+ * buffers of at least `growth` bytes, so a large document can be sent
+ * without first building it in a string and copying it. If serialization
+ * throws, what was written so far is left in the queue.
+ */
+void serialize(
+    dynamic const&,
+    serialization_opts const&,
+    IOBufQueue& out,
+    std::size_t growth = 4096);
+
 /**
  * Escape a string so that it is legal to print it in JSON text.
  *
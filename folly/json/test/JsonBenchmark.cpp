@@ -240,6 +240,14 @@ BENCHMARK(PerfJson2Obj, iters) {
   }
 }
 
+BENCHMARK_RELATIVE(PerfJson2ObjStructuralIndex, iters) {
+  folly::json::serialization_opts opts;
+  opts.simd_structural_index = true;
+  for (size_t i = 0; i < iters; ++i) {
+    folly::doNotOptimizeAway(parseJson(kJsonBenchmarkString, opts));
+  }
+}
+
 BENCHMARK(PerfObj2Json, iters) {
   BenchmarkSuspender s;
   dynamic parsed = parseJson(kJsonBenchmarkString);
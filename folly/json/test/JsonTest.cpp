@@ -16,10 +16,14 @@
 
 #include <folly/json/json.h>
 
+#include <cmath>
 #include <cstdint>
 #include <iterator>
 #include <limits>
 
+#include <folly/Conv.h>
+#include <folly/io/IOBuf.h>
+#include <folly/io/IOBufQueue.h>
 #include <folly/portability/GTest.h>
 
 using folly::dynamic;
@@ -703,6 +707,45 @@ TEST(Json, UTF8Validation) {
       "\"z\\ufffd\\ufffdz\\u0800\"");
 }
 
+TEST(Json, UTF8ValidationLongStrings) {
+  folly::json::serialization_opts opts;
+  opts.validate_utf8 = true;
+
+  // Long enough for whole registers, with non-ascii text copied as is and
+  // escapes in between.
+  std::string text;
+  for (int i = 0; i < 20; ++i) {
+    text += "caf\xc3\xa9 \xe2\x82\xac\xf0\x9f\x8d\x80 \"quoted\"\n";
+  }
+  auto serialized = folly::json::serialize(text, opts);
+  EXPECT_EQ(text, parseJson(serialized).asString());
+  EXPECT_EQ(folly::json::serialize(text, {}), serialized);
+
+  for (auto bad :
+       {"\xc0\x80", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xe2\x82"}) {
+    auto invalid = text + bad + text;
+    EXPECT_ANY_THROW(folly::json::serialize(invalid, opts)) << invalid;
+    opts.skip_invalid_utf8 = true;
+    auto skipped = folly::json::serialize(invalid, opts);
+    opts.skip_invalid_utf8 = false;
+    EXPECT_NE(std::string::npos, skipped.find("\xef\xbf\xbd"));
+  }
+}
+
+TEST(Json, ParseUTF8Validation) {
+  folly::json::serialization_opts opts;
+  opts.validate_utf8 = true;
+  EXPECT_EQ("a\xc2\x80z", parseJson("\"a\xc2\x80z\"", opts).asString());
+  EXPECT_EQ(
+      "\xf0\x9f\x8d\x80",
+      parseJson("[\"\\ud83c\\udf40\"]", opts)[0].asString());
+  EXPECT_THROW(parseJson("{\"a\xc0\x80\": 1}", opts), parse_error);
+  EXPECT_THROW(parseJson("\n[\"\xed\xa0\x80\"]", opts), parse_error);
+  EXPECT_THROW(parseJson("\"truncated \xe2\x82\"", opts), parse_error);
+  // Not checked unless asked for
+  EXPECT_EQ("a\xc0\x80", parseJson("\"a\xc0\x80\"").asString());
+}
+
 TEST(Json, ParseNonStringKeys) {
   // test string keys
   EXPECT_EQ("a", parseJson("{\"a\":[]}").items().begin()->first.asString());
@@ -1151,3 +1194,131 @@ TEST(Json, CharsToUnicodeEscape) {
       (1ULL << 63) | (1ULL << 36) | (1ULL << 33),
       (1ULL << (64 - 64)) | (1ULL << (93 - 64)));
 }
+
+TEST(Json, SimdStructuralIndex) {
+  folly::json::serialization_opts opts;
+  folly::json::serialization_opts indexed;
+  indexed.simd_structural_index = true;
+  // Sorted, as the iteration order of objects is randomized in debug builds
+  folly::json::serialization_opts sorted;
+  sorted.sort_keys = true;
+  sorted.allow_non_string_keys = true;
+  sorted.allow_nan_inf = true;
+  auto parse = [&](folly::StringPiece in, auto const& o) -> std::string {
+    try {
+      return folly::json::serialize(parseJson(in, o), sorted);
+    } catch (parse_error const& e) {
+      return std::string("error: ") + e.what();
+    }
+  };
+  auto check = [&](folly::StringPiece in) {
+    EXPECT_EQ(parse(in, opts), parse(in, indexed)) << in;
+    opts.allow_trailing_comma = indexed.allow_trailing_comma = true;
+    opts.allow_non_string_keys = indexed.allow_non_string_keys = true;
+    EXPECT_EQ(parse(in, opts), parse(in, indexed)) << in;
+    opts.allow_trailing_comma = indexed.allow_trailing_comma = false;
+    opts.allow_non_string_keys = indexed.allow_non_string_keys = false;
+  };
+
+  std::string document = "{\n";
+  for (int i = 0; i < 50; ++i) {
+    document += folly::to<std::string>(
+        "  \"key", i, "\" :\t[ ", i, ", -", i, ".5e3, true, null,\r\n",
+        "    \"a \\\"quoted\\\" \\\\ string\\n\", \"\\u00e9\\ud83d\\ude00\",",
+        " \"", std::string(i, 'x'), "\" ],\n");
+  }
+  document += "  \"last\": {}\n}\n";
+  check(document);
+  check("  [1, 2 , 3 ]  ");
+  check("[1, 2, 3,]");
+  check("{\"a\": 1, \"b\": [], }");
+  check("{1: 2}");
+  check("\"\"");
+  check("[\"\\\\\", \"\\\\\\\"\", \"\\\"\\\\\"]");
+  check("Infinity");
+  check("[-Infinity, NaN]");
+  check("[1 2]");
+  check("[1, 2");
+  check("[\"unterminated]");
+  check("[\"bad \\q escape\"]");
+  check(folly::StringPiece("[\"null \0 byte\"]", 15));
+  check(folly::StringPiece("[1]\0 trailing", 13));
+  check("[1]\n\n  garbage");
+  check("[123abc]");
+  check("{\"a\" \\\"b\": 1}");
+  check("\n\n\n[\n\"a\nb\"\n,\n  x\n]");
+  check(document.substr(0, document.size() / 2));
+
+  folly::json::metadata_map map;
+  folly::json::metadata_map indexedMap;
+  auto val = parseJsonWithMetadata(document, opts, &map);
+  auto indexedVal = parseJsonWithMetadata(document, indexed, &indexedMap);
+  EXPECT_EQ(val, indexedVal);
+  for (int i = 0; i < 50; ++i) {
+    auto key = folly::to<std::string>("key", i);
+    auto const& expected = map.at(val.get_ptr(key));
+    auto const& actual = indexedMap.at(indexedVal.get_ptr(key));
+    EXPECT_EQ(expected.key_range.begin.line, actual.key_range.begin.line);
+    EXPECT_EQ(expected.value_range.begin.line, actual.value_range.begin.line);
+    EXPECT_EQ(
+        map.at(&val[key][4]).value_range.begin.line,
+        indexedMap.at(&indexedVal[key][4]).value_range.begin.line);
+  }
+}
+
+TEST(Json, EscapeLongRuns) {
+  // Runs of plain ASCII are skipped a vector register at a time; plant each
+  // kind of byte that needs escaping at every position of longer strings.
+  folly::json::serialization_opts opts;
+  for (size_t len = 1; len < 100; ++len) {
+    for (size_t i = 0; i < len; ++i) {
+      for (char c : {'"', '\\', '\n', '\x1f', '\x7f', '\x80'}) {
+        std::string s(len, 'x');
+        s[i] = c;
+        std::string expected = "\"" + s.substr(0, i);
+        if (c == '\n') {
+          expected += "\\n";
+        } else if (c == '\x1f') {
+          expected += "\\u001f";
+        } else if (c == '"' || c == '\\') {
+          expected += '\\';
+          expected += c;
+        } else {
+          expected += c;
+        }
+        expected += s.substr(i + 1) + "\"";
+        EXPECT_EQ(expected, folly::json::serialize(s, opts)) << len << i;
+      }
+    }
+  }
+}
+
+TEST(Json, SerializeToQueue) {
+  dynamic value =
+      dynamic::object("list", dynamic::array(1, -2.5, true, nullptr))(
+          "text", "a \"quoted\"\nstring \xe2\x82\xac")(
+          "empty", dynamic::object);
+  for (int i = 0; i < 100; ++i) {
+    value["list"].push_back(std::string(i, 'x'));
+  }
+  for (bool pretty : {false, true}) {
+    folly::json::serialization_opts opts;
+    opts.pretty_formatting = pretty;
+    opts.sort_keys = true;
+    for (size_t growth : {1, 100, 4096}) {
+      folly::IOBufQueue queue;
+      queue.append("prefix");
+      folly::json::serialize(value, opts, queue, growth);
+      EXPECT_EQ(
+          "prefix" + folly::json::serialize(value, opts),
+          queue.move()->moveToFbString().toStdString());
+    }
+  }
+
+  // Errors are reported as when serializing to a string.
+  folly::IOBufQueue queue;
+  folly::json::serialization_opts opts;
+  EXPECT_THROW(
+      folly::json::serialize(dynamic::array(std::nan("")), opts, queue),
+      print_error);
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/LazyView.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using folly::json_pointer;
+using folly::parseJson;
+using folly::json::LazyView;
+using folly::json::parse_error;
+
+namespace {
+const char* kDocument = R"JSON(
+{
+  "name": "server",
+  "port": 8080,
+  "ratio": 0.25,
+  "enabled": true,
+  "owner": null,
+  "escaped": "a \"quoted\" \u00e9 string",
+  "tags": ["a", "b", "c"],
+  "nested": {"list": [{"x": 1}, {"x": 2}], "a/b": 3, "m~n": 4},
+  "port": 9090
+}
+)JSON";
+} // namespace
+
+TEST(LazyView, Navigate) {
+  LazyView view(kDocument);
+  auto root = view.root();
+  EXPECT_TRUE(root.isObject());
+  EXPECT_EQ(9, root.size());
+
+  EXPECT_EQ("server", root["name"].getString());
+  // The last of duplicate keys wins, as with parseJson().
+  EXPECT_EQ(9090, root["port"].getInt());
+  EXPECT_EQ(0.25, root["ratio"].getDouble());
+  EXPECT_TRUE(root["enabled"].getBool());
+  EXPECT_TRUE(root["owner"].isNull());
+  EXPECT_EQ("a \"quoted\" \u00e9 string", root["escaped"].getString());
+  EXPECT_EQ("\"server\"", root["name"].raw());
+
+  auto tags = root["tags"];
+  EXPECT_EQ(3, tags.size());
+  EXPECT_EQ("c", tags[2].getString());
+  EXPECT_FALSE(tags.get_ptr(3).has_value());
+  EXPECT_FALSE(root.get_ptr("missing").has_value());
+  EXPECT_THROW(root.at("missing"), std::out_of_range);
+  EXPECT_THROW(tags.at(3), std::out_of_range);
+  EXPECT_THROW(tags["a"], folly::TypeError);
+  EXPECT_THROW(root["name"].getInt(), folly::TypeError);
+  EXPECT_THROW(root["port"].size(), folly::TypeError);
+
+  std::vector<std::string> elements;
+  tags.forEachElement([&](LazyView::Value v) {
+    elements.push_back(v.getString());
+  });
+  EXPECT_EQ((std::vector<std::string>{"a", "b", "c"}), elements);
+
+  std::vector<std::string> keys;
+  root["nested"].forEachMember([&](LazyView::Value k, LazyView::Value) {
+    keys.push_back(k.getString());
+  });
+  EXPECT_EQ((std::vector<std::string>{"list", "a/b", "m~n"}), keys);
+
+  EXPECT_EQ(parseJson(kDocument), root.toDynamic());
+  EXPECT_EQ(parseJson(kDocument)["nested"], root["nested"].toDynamic());
+}
+
+TEST(LazyView, JsonPointer) {
+  LazyView view(kDocument);
+  auto root = view.root();
+  auto get = [&](const char* pointer) {
+    return root.get_ptr(json_pointer::parse(pointer));
+  };
+  EXPECT_EQ(2, get("/nested/list/1/x")->getInt());
+  EXPECT_EQ(3, get("/nested/a~1b")->getInt());
+  EXPECT_EQ(4, get("/nested/m~0n")->getInt());
+  EXPECT_EQ(root.raw(), get("")->raw());
+  EXPECT_FALSE(get("/nested/list/2").has_value());
+  EXPECT_FALSE(get("/nested/list/-").has_value());
+  EXPECT_FALSE(get("/nested/missing").has_value());
+  EXPECT_THROW(get("/tags/01"), std::invalid_argument);
+  EXPECT_THROW(get("/tags/x"), std::invalid_argument);
+  EXPECT_THROW(get("/port/x"), folly::TypeError);
+}
+
+TEST(LazyView, Options) {
+  folly::json::serialization_opts opts;
+  opts.parse_numbers_as_strings = true;
+  LazyView view(R"({"n": 12.50, "i": 7, "s": NaN})", opts);
+  EXPECT_EQ("12.50", view.root()["n"].getString());
+  EXPECT_EQ("7", view.root()["i"].getString());
+  EXPECT_EQ("NaN", view.root()["s"].getString());
+
+  opts = {};
+  opts.double_fallback = true;
+  LazyView big("[123456789012345678901234567890]", opts);
+  EXPECT_TRUE(big.root()[0].isDouble());
+  EXPECT_THROW(LazyView("[123456789012345678901234567890]"), std::range_error);
+
+  EXPECT_THROW(LazyView("[1, 2,]"), parse_error);
+  opts = {};
+  opts.allow_trailing_comma = true;
+  LazyView trailing("[1, 2,]", opts);
+  EXPECT_EQ(2, trailing.root().size());
+}
+
+TEST(LazyView, Errors) {
+  // The same errors as parseJson()
+  for (const char* input :
+       {"",
+        "[1, 2",
+        "{\"a\" 1}",
+        "{1: 2}",
+        "{1 : 2}",
+        "[\"unterminated",
+        "[\"bad \\q\"]",
+        "[\"\\ud800\"]",
+        "[-]",
+        "[1] x",
+        "\n\n[tru]"}) {
+    std::string expected;
+    try {
+      parseJson(input);
+    } catch (parse_error const& e) {
+      expected = e.what();
+    }
+    ASSERT_FALSE(expected.empty()) << input;
+    try {
+      LazyView view(input);
+      ADD_FAILURE() << input;
+    } catch (parse_error const& e) {
+      EXPECT_EQ(expected, e.what());
+    }
+  }
+
+  folly::json::serialization_opts opts;
+  opts.recursion_limit = 3;
+  EXPECT_NO_THROW(LazyView("[[[1]]]", opts));
+  EXPECT_THROW(LazyView("[[[[1]]]]", opts), parse_error);
+}
+
+TEST(LazyView, Arena) {
+  folly::SysArena arena;
+  LazyView view(kDocument, arena);
+  auto root = view.root();
+  EXPECT_EQ(9090, root["port"].getInt());
+
+  // Strings without escapes refer to the input.
+  auto name = root["name"].getString(arena);
+  EXPECT_EQ("server", name);
+  auto inInput = [&](folly::StringPiece s) {
+    return std::less_equal<>()(view.input().begin(), s.begin()) &&
+        std::less_equal<>()(s.end(), view.input().end());
+  };
+  EXPECT_TRUE(inInput(name));
+
+  auto escaped = root["escaped"].getString(arena);
+  EXPECT_EQ("a \"quoted\" \u00e9 string", escaped);
+  EXPECT_FALSE(inInput(escaped));
+
+  LazyView escapes(
+      R"(["\b\f\n\r\t\/\\ \u0041\ud83d\ude00 \u00e9\u20ac"])", arena);
+  auto expected = "\b\f\n\r\t/\\ A\U0001F600 \u00e9\u20ac";
+  EXPECT_EQ(expected, escapes.root()[0].getString(arena));
+  EXPECT_EQ(expected, escapes.root()[0].getString());
+  EXPECT_EQ(parseJson(escapes.input())[0], escapes.root()[0].getString());
+  EXPECT_THROW(root["port"].getString(arena), folly::TypeError);
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/json/StreamParser.h>
+
+#include <string>
+#include <vector>
+
+#include <folly/io/IOBuf.h>
+#include <folly/portability/GTest.h>
+
+using folly::dynamic;
+using folly::parseJson;
+using folly::StringPiece;
+using folly::json::parse_error;
+using folly::json::StreamParser;
+
+namespace {
+
+// Feed the input in pieces of every size from 1 byte to all of it, checking
+// that the values come out the same each time.
+std::vector<dynamic> parseInPieces(
+    StringPiece input,
+    StreamParser::Mode mode = StreamParser::Mode::Values,
+    folly::json::serialization_opts const& opts = {}) {
+  std::vector<dynamic> first;
+  for (size_t piece = 1; piece <= input.size(); ++piece) {
+    std::vector<dynamic> values;
+    StreamParser parser(
+        [&](dynamic&& value) { values.push_back(std::move(value)); },
+        opts,
+        mode);
+    for (size_t i = 0; i < input.size(); i += piece) {
+      parser.feed(input.subpiece(i, piece));
+    }
+    parser.finish();
+    if (piece == 1) {
+      first = std::move(values);
+    } else {
+      EXPECT_EQ(first, values) << piece;
+    }
+  }
+  return first;
+}
+
+} // namespace
+
+TEST(StreamParser, Values) {
+  auto values = parseInPieces(
+      "{\"a\": [1, {\"b\": \"}]\\\\\"}], \"c\": \"\\\"[\"}\n"
+      "[]\n"
+      "\"string\" 12.5 true null -3\n"
+      "{}{}");
+  ASSERT_EQ(9, values.size());
+  EXPECT_EQ(
+      parseJson("{\"a\": [1, {\"b\": \"}]\\\\\"}], \"c\": \"\\\"[\"}"),
+      values[0]);
+  EXPECT_EQ(dynamic::array(), values[1]);
+  EXPECT_EQ("string", values[2]);
+  EXPECT_EQ(12.5, values[3]);
+  EXPECT_EQ(true, values[4]);
+  EXPECT_EQ(nullptr, values[5]);
+  // A number at the very end is only complete at finish().
+  EXPECT_EQ(-3, values[6]);
+  EXPECT_EQ(dynamic(dynamic::object), values[7]);
+  EXPECT_EQ(dynamic(dynamic::object), values[8]);
+
+  EXPECT_TRUE(parseInPieces(" \n\t ").empty());
+}
+
+TEST(StreamParser, ArrayElements) {
+  auto elements = parseInPieces(
+      " [ {\"id\": 1, \"tags\": [\"a\", \"b\"]}, \"x,]\", 42 ,[[]],null] \n",
+      StreamParser::Mode::ArrayElements);
+  ASSERT_EQ(5, elements.size());
+  EXPECT_EQ(parseJson("{\"id\": 1, \"tags\": [\"a\", \"b\"]}"), elements[0]);
+  EXPECT_EQ("x,]", elements[1]);
+  EXPECT_EQ(42, elements[2]);
+  EXPECT_EQ(parseJson("[[]]"), elements[3]);
+  EXPECT_EQ(nullptr, elements[4]);
+
+  EXPECT_TRUE(parseInPieces("[ ]", StreamParser::Mode::ArrayElements).empty());
+
+  folly::json::serialization_opts opts;
+  opts.allow_trailing_comma = true;
+  EXPECT_EQ(
+      2,
+      parseInPieces("[1, 2,]", StreamParser::Mode::ArrayElements, opts)
+          .size());
+}
+
+TEST(StreamParser, IOBuf) {
+  auto chain = folly::IOBuf::copyBuffer("[1, {\"a\"");
+  chain->appendToChain(folly::IOBuf::copyBuffer(": 2}, 3"));
+  chain->appendToChain(folly::IOBuf::copyBuffer("]"));
+  std::vector<dynamic> elements;
+  StreamParser parser(
+      [&](dynamic&& value) { elements.push_back(std::move(value)); },
+      {},
+      StreamParser::Mode::ArrayElements);
+  parser.feed(*chain);
+  parser.finish();
+  EXPECT_EQ(
+      parseJson("[1, {\"a\": 2}, 3]"),
+      dynamic(elements.begin(), elements.end()));
+}
+
+TEST(StreamParser, Errors) {
+  auto expectError = [](StringPiece input,
+                        StreamParser::Mode mode,
+                        StringPiece what) {
+    StreamParser parser([](dynamic&&) {}, {}, mode);
+    try {
+      parser.feed(input);
+      parser.finish();
+      ADD_FAILURE() << input;
+    } catch (parse_error const& e) {
+      EXPECT_EQ(what, e.what()) << input;
+    }
+  };
+  auto const values = StreamParser::Mode::Values;
+  auto const elements = StreamParser::Mode::ArrayElements;
+
+  expectError(
+      "{\"a\": 1",
+      values,
+      "json parse error on line 0: unexpected end of input in json value");
+  expectError("1 ]", values, "json parse error on line 0: expected json value");
+  expectError(
+      "[1, 2", elements, "json parse error on line 0: expected ',' or ']'");
+  expectError(
+      "\n[1, ]", elements, "json parse error on line 1: expected json value");
+  expectError("\n\n{}", elements, "json parse error on line 2: expected '['");
+  expectError(
+      "[1] 2",
+      elements,
+      "json parse error on line 0: parsing didn't consume all input");
+  expectError("", elements, "json parse error on line 0: expected '['");
+  // Errors within a value come from parseJson().
+  expectError(
+      "[1, tru]",
+      elements,
+      "json parse error on line 0 near `tru': expected json value");
+}
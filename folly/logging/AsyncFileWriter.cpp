@@ -16,6 +16,8 @@
 
 #include <folly/logging/AsyncFileWriter.h>
 
+#include <algorithm>
+
 #include <folly/Exception.h>
 #include <folly/FileUtil.h>
 #include <folly/logging/LoggerDB.h>
@@ -38,50 +40,48 @@ bool AsyncFileWriter::ttyOutput() const {
 
 void AsyncFileWriter::writeToFile(
     const std::vector<std::string>& ioQueue, size_t numDiscarded) {
-#ifndef _WIN32
-  // kNumIovecs controls the maximum number of strings we write at once in a
-  // single writev() call.
-  constexpr int kNumIovecs = 64;
-  std::array<iovec, kNumIovecs> iovecs;
-#endif // !_WIN32
+  std::string discardedMsg;
+  if (numDiscarded > 0) {
+    discardedMsg = getNumDiscardedMsg(numDiscarded);
+  }
 
-  size_t idx = 0;
-  while (idx < ioQueue.size()) {
 #ifndef _WIN32
-    // On POSIX platforms use writev() to minimize the number of system calls
-    // we use to write the data.
-    int numIovecs = 0;
-    while (numIovecs < kNumIovecs && idx < ioQueue.size()) {
-      const auto& str = ioQueue[idx];
-      iovecs[numIovecs].iov_base = const_cast<char*>(str.data());
-      iovecs[numIovecs].iov_len = str.size();
-      ++numIovecs;
-      ++idx;
+  // On POSIX platforms gather the whole batch, including the discard
+  // notification, and write it with as few writev() calls as possible.
+  // Empty messages (as enqueued by flush()) are skipped.
+  iovecs_.clear();
+  for (const auto& str : ioQueue) {
+    if (!str.empty()) {
+      iovecs_.push_back({const_cast<char*>(str.data()), str.size()});
     }
+  }
+  if (!discardedMsg.empty()) {
+    iovecs_.push_back({discardedMsg.data(), discardedMsg.size()});
+  }
 
-    auto ret = folly::writevFull(file_.fd(), iovecs.data(), numIovecs);
+  for (size_t idx = 0; idx < iovecs_.size(); idx += kIovMax) {
+    auto count = std::min(iovecs_.size() - idx, kIovMax);
+    auto ret = folly::writevFull(file_.fd(), iovecs_.data() + idx, count);
     folly::checkUnixError(ret, "writevFull() failed");
+  }
 #else // _WIN32
-    // On Windows folly's writevFull() function is just a wrapper that calls
-    // write() multiple times.  Go ahead and do that ourselves here, since there
-    // is no point constructing the iovec data structure.
-    auto ret =
-        folly::writeFull(file_.fd(), ioQueue[idx].data(), ioQueue[idx].size());
+  // On Windows folly's writevFull() function is just a wrapper that calls
+  // write() multiple times.  Go ahead and do that ourselves here, since there
+  // is no point constructing the iovec data structure.
+  for (const auto& str : ioQueue) {
+    auto ret = folly::writeFull(file_.fd(), str.data(), str.size());
     folly::checkUnixError(ret, "writeFull() failed");
-    CHECK_EQ(ret, ioQueue[idx].size());
-    ++idx;
-#endif // _WIN32
+    CHECK_EQ(ret, str.size());
   }
 
-  if (numDiscarded > 0) {
-    auto msg = getNumDiscardedMsg(numDiscarded);
-    if (!msg.empty()) {
-      auto ret = folly::writeFull(file_.fd(), msg.data(), msg.size());
-      // We currently ignore errors from writeFull() here.
-      // There's not much we can really do.
-      (void)ret;
-    }
+  if (!discardedMsg.empty()) {
+    auto ret =
+        folly::writeFull(file_.fd(), discardedMsg.data(), discardedMsg.size());
+    // We currently ignore errors from writeFull() here.
+    // There's not much we can really do.
+    (void)ret;
   }
+#endif // _WIN32
 }
 
 void AsyncFileWriter::performIO(
@@ -19,6 +19,7 @@
 #include <vector>
 
 #include <folly/logging/AsyncLogWriter.h>
+#include <folly/portability/SysUio.h>
 
 namespace folly {
 /**
@@ -62,5 +63,9 @@ class AsyncFileWriter : public AsyncLogWriter {
   std::string getNumDiscardedMsg(size_t numDiscarded);
 
   folly::File file_;
+#ifndef _WIN32
+  // Only used by the I/O thread, and kept to reuse its capacity.
+  std::vector<iovec> iovecs_;
+#endif
 };
 } // namespace folly
@@ -16,15 +16,64 @@
 
 #include <folly/logging/AsyncLogWriter.h>
 
+#include <algorithm>
+#include <chrono>
+
 #include <folly/Exception.h>
 #include <folly/FileUtil.h>
 #include <folly/Portability.h>
+#include <folly/ProducerConsumerQueue.h>
+#include <folly/lang/Align.h>
 #include <folly/logging/LoggerDB.h>
 #include <folly/system/AtFork.h>
 #include <folly/system/ThreadName.h>
 
 namespace folly {
 
+struct AsyncLogWriter::ThreadBuffer {
+  // ProducerConsumerQueue holds one fewer message than its size.
+  ProducerConsumerQueue<Message> queue{kThreadBufferMessages + 1};
+  const std::thread::id owner{std::this_thread::get_id()};
+
+  // Updated by the owning thread only.
+  uint64_t lastOrder{0};
+  std::atomic<size_t> enqueuedBytes{0};
+  std::atomic<size_t> numDiscarded{0};
+  std::atomic<bool> exited{false};
+
+  // Updated by the I/O thread only.
+  alignas(hardware_destructive_interference_size)
+      std::atomic<size_t> dequeuedBytes{0};
+  size_t numDiscardedReported{0};
+  bool retired{false};
+
+  size_t drain(std::vector<Message>& messages) {
+    // Once the thread has exited, this drains everything it wrote.
+    retired = exited.load(std::memory_order_acquire);
+    size_t bytes = 0;
+    while (auto* message = queue.frontPtr()) {
+      bytes += message->data.size();
+      messages.push_back(std::move(*message));
+      queue.popFront();
+    }
+    dequeuedBytes.store(
+        dequeuedBytes.load(std::memory_order_relaxed) + bytes,
+        std::memory_order_release);
+    auto discarded = numDiscarded.load(std::memory_order_relaxed);
+    auto newlyDiscarded = discarded - numDiscardedReported;
+    numDiscardedReported = discarded;
+    return newlyDiscarded;
+  }
+};
+
+struct AsyncLogWriter::ThreadBufferHolder {
+  std::shared_ptr<ThreadBuffer> buffer{std::make_shared<ThreadBuffer>()};
+
+  ~ThreadBufferHolder() {
+    buffer->exited.store(true, std::memory_order_release);
+  }
+};
+
 AsyncLogWriter::AsyncLogWriter() {
   folly::AtFork::registerHandler(
       this,
@@ -74,8 +123,8 @@ void AsyncLogWriter::invokeDiscardCallback(size_t numDiscarded) {
 }
 
 void AsyncLogWriter::cleanup() {
-  std::vector<std::string>* ioQueue;
-  size_t numDiscarded;
+  std::vector<Message> messages;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
   {
     // Stop the I/O thread
     auto data = data_.lock();
@@ -84,16 +133,18 @@ void AsyncLogWriter::cleanup() {
     // stopIoThread() causes the I/O thread to stop as soon as possible,
     // without waiting for all pending messages to be written.  Extract any
     // remaining messages to write them below.
-    ioQueue = data->getCurrentQueue();
-    numDiscarded = data->numDiscarded;
+    messages.swap(data->queue);
+    buffers = data->threadBuffers;
   }
+  auto numDiscarded = drainThreadBuffers(buffers, messages);
   if (numDiscarded > 0) {
     invokeDiscardCallback(numDiscarded);
   }
 
   // If there are still any pending messages, flush them now.
-  if (!ioQueue->empty()) {
-    performIO(*ioQueue, numDiscarded);
+  if (!messages.empty()) {
+    std::vector<std::string> ioQueue;
+    writeMessages(messages, ioQueue, numDiscarded);
   }
 }
 
@@ -102,19 +153,105 @@ void AsyncLogWriter::writeMessage(StringPiece buffer, uint32_t flags) {
 }
 
 void AsyncLogWriter::writeMessage(std::string&& buffer, uint32_t flags) {
-  auto data = data_.lock();
-  if ((data->currentBufferSize >= data->maxBufferBytes) &&
-      !(flags & NEVER_DISCARD)) {
-    ++data->numDiscarded;
+  auto& threadBuffer = getThreadBuffer();
+  uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+                     .count();
+  threadBuffer.lastOrder = std::max(now, threadBuffer.lastOrder + 1);
+  Message message{threadBuffer.lastOrder, std::move(buffer)};
+  auto size = message.data.size();
+
+  auto enqueuedBytes =
+      threadBuffer.enqueuedBytes.load(std::memory_order_relaxed);
+  if (!(flags & NEVER_DISCARD)) {
+    auto maxThreadBytes = maxThreadBufferBytes_.load(std::memory_order_relaxed);
+    if (bufferedBytes_.load(std::memory_order_relaxed) >=
+            maxBufferBytes_.load(std::memory_order_relaxed) ||
+        (maxThreadBytes != 0 &&
+         enqueuedBytes -
+                 threadBuffer.dequeuedBytes.load(std::memory_order_acquire) >=
+             maxThreadBytes)) {
+      threadBuffer.numDiscarded.store(
+          threadBuffer.numDiscarded.load(std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
+      return;
+    }
+  }
+
+  bufferedBytes_.fetch_add(size, std::memory_order_relaxed);
+  if (threadBuffer.queue.write(std::move(message))) {
+    threadBuffer.enqueuedBytes.store(
+        enqueuedBytes + size, std::memory_order_relaxed);
+    wakeIoThread();
     return;
   }
 
-  data->currentBufferSize += buffer.size();
-  auto* queue = data->getCurrentQueue();
-  queue->emplace_back(std::move(buffer));
+  // This thread's buffer is full.  The I/O thread drains the thread buffers
+  // after taking this queue, and sorts the messages, so this message is still
+  // written after the ones before it.
+  auto data = data_.lock();
+  data->queue.push_back(std::move(message));
   messageReady_.notify_one();
 }
 
+AsyncLogWriter::ThreadBuffer& AsyncLogWriter::getThreadBuffer() {
+  auto* holder = threadBuffer_.get();
+  if (FOLLY_UNLIKELY(!holder)) {
+    holder = new ThreadBufferHolder();
+    threadBuffer_.reset(holder);
+    data_.lock()->threadBuffers.push_back(holder->buffer);
+  }
+  return *holder->buffer;
+}
+
+void AsyncLogWriter::wakeIoThread() {
+  // Pairs with the fence in ioThread(): either the I/O thread sees the message
+  // before it waits, or this thread sees that it is waiting.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (ioThreadSleeping_.load(std::memory_order_relaxed) &&
+      ioThreadSleeping_.exchange(false, std::memory_order_relaxed)) {
+    // Take the lock so that the notification cannot arrive between the I/O
+    // thread checking the buffers and waiting.
+    auto data = data_.lock();
+    messageReady_.notify_one();
+  }
+}
+
+bool AsyncLogWriter::threadBuffersEmpty(
+    const std::vector<std::shared_ptr<ThreadBuffer>>& buffers) const {
+  return std::all_of(buffers.begin(), buffers.end(), [](const auto& buffer) {
+    return buffer->queue.isEmpty();
+  });
+}
+
+size_t AsyncLogWriter::drainThreadBuffers(
+    const std::vector<std::shared_ptr<ThreadBuffer>>& buffers,
+    std::vector<Message>& messages) {
+  size_t numDiscarded = 0;
+  for (const auto& buffer : buffers) {
+    numDiscarded += buffer->drain(messages);
+  }
+  return numDiscarded;
+}
+
+void AsyncLogWriter::writeMessages(
+    std::vector<Message>& messages,
+    std::vector<std::string>& ioQueue,
+    size_t numDiscarded) {
+  std::sort(
+      messages.begin(), messages.end(), [](const auto& a, const auto& b) {
+        return a.order < b.order;
+      });
+  ioQueue.reserve(messages.size());
+  size_t bytes = 0;
+  for (auto& message : messages) {
+    bytes += message.data.size();
+    ioQueue.push_back(std::move(message.data));
+  }
+  bufferedBytes_.fetch_sub(bytes, std::memory_order_relaxed);
+  performIO(ioQueue, numDiscarded);
+}
+
 void AsyncLogWriter::flush() {
   auto data = data_.lock();
   auto start = data->ioThreadCounter;
@@ -124,11 +261,11 @@ void AsyncLogWriter::flush() {
   // the I/O thread has swapped the queues, which is before it has actually
   // done the I/O.
   while (data->ioThreadCounter < start + 2) {
-    // Enqueue an empty string and wake the I/O thread.
-    // The empty string ensures that the I/O thread will break out of its wait
+    // Enqueue an empty message and wake the I/O thread.
+    // The empty message ensures that the I/O thread will break out of its wait
     // loop and increment the ioThreadCounter, even if there is no other work
     // to do.
-    data->getCurrentQueue()->emplace_back();
+    data->queue.push_back(Message{0, std::string()});
     messageReady_.notify_one();
 
     // Wait for notification from the I/O thread that it has done work.
@@ -137,31 +274,52 @@ void AsyncLogWriter::flush() {
 }
 
 void AsyncLogWriter::setMaxBufferSize(size_t size) {
-  auto data = data_.lock();
-  data->maxBufferBytes = size;
+  maxBufferBytes_.store(size, std::memory_order_relaxed);
 }
 
 size_t AsyncLogWriter::getMaxBufferSize() const {
-  auto data = data_.lock();
-  return data->maxBufferBytes;
+  return maxBufferBytes_.load(std::memory_order_relaxed);
+}
+
+void AsyncLogWriter::setMaxThreadBufferSize(size_t size) {
+  maxThreadBufferBytes_.store(size, std::memory_order_relaxed);
+}
+
+size_t AsyncLogWriter::getMaxThreadBufferSize() const {
+  return maxThreadBufferBytes_.load(std::memory_order_relaxed);
 }
 
 void AsyncLogWriter::ioThread() {
   folly::setThreadName("log_writer");
 
+  std::vector<Message> messages;
+  std::vector<std::string> ioQueue;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
   while (true) {
-    // With the lock held, grab a pointer to the current queue, then increment
-    // the ioThreadCounter index so that other threads will write into the
-    // other queue as we process this one.
-    std::vector<std::string>* ioQueue;
-    size_t numDiscarded;
+    // With the lock held, take the queue and the list of thread buffers, and
+    // increment the ioThreadCounter.  The thread buffers are drained after
+    // the queue is taken, so that any NEVER_DISCARD message in the queue is
+    // written with the messages its thread logged before it.
     {
       auto data = data_.lock();
-      ioQueue = data->getCurrentQueue();
-      while (ioQueue->empty() && !(data->flags & FLAG_STOP)) {
+      auto& threadBuffers = data->threadBuffers;
+      threadBuffers.erase(
+          std::remove_if(
+              threadBuffers.begin(),
+              threadBuffers.end(),
+              [](const auto& buffer) { return buffer->retired; }),
+          threadBuffers.end());
+      while (data->queue.empty() && !(data->flags & FLAG_STOP)) {
+        ioThreadSleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!threadBuffersEmpty(threadBuffers)) {
+          ioThreadSleeping_.store(false, std::memory_order_relaxed);
+          break;
+        }
         // Wait for a message or one of the above flags to be set.
         messageReady_.wait(data.as_lock());
       }
+      ioThreadSleeping_.store(false, std::memory_order_relaxed);
 
       if (data->flags & FLAG_STOP) {
         // We have been asked to stop.  We exit immediately in this case
@@ -177,22 +335,24 @@ void AsyncLogWriter::ioThread() {
       }
 
       ++data->ioThreadCounter;
-      numDiscarded = data->numDiscarded;
-      data->numDiscarded = 0;
-      data->currentBufferSize = 0;
+      messages.swap(data->queue);
+      buffers = threadBuffers;
     }
     ioCV_.notify_all();
 
     // Write the log messages now that we have released the lock
-    performIO(*ioQueue, numDiscarded);
+    auto numDiscarded = drainThreadBuffers(buffers, messages);
+    writeMessages(messages, ioQueue, numDiscarded);
 
     if (numDiscarded > 0) {
       invokeDiscardCallback(numDiscarded);
     }
 
-    // clear() empties the vector, but the allocated capacity remains so we can
-    // just reuse it without having to re-allocate in most cases.
-    ioQueue->clear();
+    // clear() empties the vectors, but the allocated capacity remains so we
+    // can just reuse it without having to re-allocate in most cases.
+    messages.clear();
+    ioQueue.clear();
+    buffers.clear();
   }
 }
 
@@ -224,10 +384,19 @@ void AsyncLogWriter::postForkParent() {
 }
 
 void AsyncLogWriter::postForkChild() {
-  // Clear any messages in the queue.  We only want them to be written once,
-  // and we let the parent process handle writing them.
-  lockedData_->queues[0].clear();
-  lockedData_->queues[1].clear();
+  // Clear any messages in the queue and the thread buffers.  We only want them
+  // to be written once, and we let the parent process handle writing them.
+  // The other threads do not exist in the child, so their buffers are retired.
+  lockedData_->queue.clear();
+  std::vector<Message> messages;
+  for (auto& buffer : lockedData_->threadBuffers) {
+    if (buffer->owner != std::this_thread::get_id()) {
+      buffer->exited.store(true, std::memory_order_relaxed);
+    }
+    buffer->drain(messages);
+  }
+  messages.clear();
+  bufferedBytes_.store(0, std::memory_order_relaxed);
 
   // Restart the I/O thread
   restartThread();
@@ -16,13 +16,17 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #include <folly/File.h>
 #include <folly/Range.h>
 #include <folly/Synchronized.h>
+#include <folly/ThreadLocal.h>
 #include <folly/logging/LogWriter.h>
 
 namespace folly {
@@ -45,6 +49,13 @@ namespace folly {
  * However, one downside is that if your program crashes, not all log messages
  * may have been written, so you may lose messages generated immediately before
  * the crash.
+ *
+ * Each thread writes its messages into a lock-free buffer of its own, so that
+ * threads logging concurrently do not contend with each other.  The I/O thread
+ * drains all the buffers each time around its loop and writes their messages
+ * in the order in which they were logged.  The messages that do not fit in
+ * their thread's buffer go through a queue shared by all threads, under a
+ * lock, so that they are not discarded because of the buffer's capacity.
  */
 class AsyncLogWriter : public LogWriter {
  public:
@@ -55,6 +66,12 @@ class AsyncLogWriter : public LogWriter {
    */
   static constexpr size_t kDefaultMaxBufferSize = 1024 * 1024;
 
+  /**
+   * The number of unwritten messages each thread buffers without taking a
+   * lock.
+   */
+  static constexpr size_t kThreadBufferMessages = 1024;
+
   explicit AsyncLogWriter();
 
   virtual ~AsyncLogWriter() override;
@@ -84,6 +101,22 @@ class AsyncLogWriter : public LogWriter {
    */
   size_t getMaxBufferSize() const;
 
+  /**
+   * Set the maximum amount of unwritten data each thread may buffer, in
+   * bytes, or 0 for no such limit, the default.
+   *
+   * When set, new messages are also discarded if they would cause the amount
+   * of data buffered by their thread to exceed this limit, so that a thread
+   * logging a lot cannot take all of getMaxBufferSize() from the others.
+   */
+  void setMaxThreadBufferSize(size_t size);
+
+  /**
+   * Get the maximum amount of unwritten data each thread may buffer, in
+   * bytes, 0 if there is no such limit.
+   */
+  size_t getMaxThreadBufferSize() const;
+
   using DiscardCallback = void (*)(size_t);
 
   /**
@@ -124,26 +157,30 @@ class AsyncLogWriter : public LogWriter {
     FLAG_IO_THREAD_JOINED = 0x10,
   };
 
+  struct Message {
+    // When the message was logged, in steady_clock nanoseconds, made unique
+    // within each thread so that sorting keeps each thread's messages in
+    // order.
+    uint64_t order;
+    std::string data;
+  };
+
+  // The lock-free buffer of one thread, defined in AsyncLogWriter.cpp.
+  struct ThreadBuffer;
+  struct ThreadBufferHolder;
+
   /*
-   * A simple implementation using two queues.
-   * All writer threads enqueue into one queue while the I/O thread is
-   * processing the other.
-   *
-   * We could potentially also provide an implementation using folly::MPMCQueue
-   * in the future, which may improve contention under very high write loads.
+   * Messages are normally written into the buffer of their thread.  queue
+   * holds only the messages that did not fit there, and the empty messages
+   * with which flush() wakes the I/O thread, which swaps it out each time
+   * around its loop.
    */
   struct Data {
-    std::array<std::vector<std::string>, 2> queues;
+    std::vector<Message> queue;
+    std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
     uint32_t flags{0};
     uint64_t ioThreadCounter{0};
-    size_t maxBufferBytes{kDefaultMaxBufferSize};
-    size_t currentBufferSize{0};
-    size_t numDiscarded{0};
     std::thread ioThread;
-
-    std::vector<std::string>* getCurrentQueue() {
-      return &queues[ioThreadCounter & 0x1];
-    }
   };
 
   /**
@@ -155,6 +192,18 @@ class AsyncLogWriter : public LogWriter {
 
   void invokeDiscardCallback(size_t numDiscarded);
 
+  ThreadBuffer& getThreadBuffer();
+  void wakeIoThread();
+  bool threadBuffersEmpty(
+      const std::vector<std::shared_ptr<ThreadBuffer>>& buffers) const;
+  size_t drainThreadBuffers(
+      const std::vector<std::shared_ptr<ThreadBuffer>>& buffers,
+      std::vector<Message>& messages);
+  void writeMessages(
+      std::vector<Message>& messages,
+      std::vector<std::string>& ioQueue,
+      size_t numDiscarded);
+
   void ioThread();
 
   bool preFork();
@@ -166,9 +215,22 @@ class AsyncLogWriter : public LogWriter {
   void restartThread();
 
   folly::Synchronized<Data, std::mutex> data_;
+  folly::ThreadLocalPtr<ThreadBufferHolder> threadBuffer_;
+  std::atomic<size_t> maxBufferBytes_{kDefaultMaxBufferSize};
+  std::atomic<size_t> maxThreadBufferBytes_{0};
+  /**
+   * bufferedBytes_ is the size of the messages written and not yet taken by
+   * the I/O thread, in all the thread buffers and the queue.
+   */
+  std::atomic<size_t> bufferedBytes_{0};
+  /**
+   * ioThreadSleeping_ is set while the I/O thread waits on messageReady_, so
+   * that writer threads know to wake it after writing into their buffers.
+   */
+  std::atomic<bool> ioThreadSleeping_{false};
   /**
-   * messageReady_ is signaled by writer threads whenever they add a new
-   * message to the current queue.
+   * messageReady_ is signaled by writer threads when they add a new message
+   * while the I/O thread is waiting.
    */
   std::condition_variable messageReady_;
   /**
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/logging/DeferredLogger.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <folly/ExceptionString.h>
+#include <folly/lang/Exception.h>
+#include <folly/logging/LoggerDB.h>
+#include <folly/system/AtFork.h>
+#include <folly/system/ThreadId.h>
+#include <folly/system/ThreadName.h>
+
+namespace folly {
+
+namespace {
+// How often the I/O thread looks for messages: every kMinPollInterval while
+// they keep arriving, backing off to kMaxPollInterval when idle.
+constexpr std::chrono::milliseconds kMinPollInterval{1};
+constexpr std::chrono::milliseconds kMaxPollInterval{64};
+} // namespace
+
+DeferredLogger::ThreadBuffer::ThreadBuffer(uint64_t threadID)
+    : data_{std::make_unique<Header[]>(kBufferSize / sizeof(Header))},
+      threadID_{threadID} {}
+
+bool DeferredLogger::ThreadBuffer::drain() noexcept {
+  auto head = head_.load(std::memory_order_acquire);
+  auto tail = tail_.load(std::memory_order_relaxed);
+  if (head == tail) {
+    return false;
+  }
+  while (tail != head) {
+    auto& header =
+        *reinterpret_cast<Header*>(data() + (tail & (kBufferSize - 1)));
+    auto size = header.size;
+    if (header.dispatch) {
+      header.dispatch(header);
+    }
+    tail += size;
+    // Release each record as soon as it is logged, so that a busy thread can
+    // reuse its space instead of logging synchronously.
+    tail_.store(tail, std::memory_order_release);
+  }
+  return true;
+}
+
+DeferredLogger::ThreadBufferHolder::~ThreadBufferHolder() {
+  if (buffer) {
+    buffer->exited.store(true, std::memory_order_release);
+  }
+}
+
+DeferredLogger& DeferredLogger::get() {
+  // Leaked, so that messages can be logged during static destruction.
+  static auto* logger = new DeferredLogger();
+  return *logger;
+}
+
+DeferredLogger::DeferredLogger() {
+  // Make sure the LoggerDB exists first, so that its log handlers are only
+  // cleaned up after the atexit() handler below has flushed the messages.
+  LoggerDB::get();
+  std::atexit([] {
+    auto& logger = get();
+    logger.synchronous_.store(true, std::memory_order_relaxed);
+    logger.stopThread();
+    logger.flush();
+  });
+
+  folly::AtFork::registerHandler(
+      this,
+      [this] { return preFork(); },
+      [this] { postForkParent(); },
+      [this] { postForkChild(); });
+  startThread();
+}
+
+DeferredLogger::ThreadBufferHolder& DeferredLogger::threadBufferHolder() {
+  static thread_local ThreadBufferHolder holder;
+  return holder;
+}
+
+DeferredLogger::ThreadBuffer& DeferredLogger::threadBuffer() {
+  auto& holder = threadBufferHolder();
+  if (FOLLY_UNLIKELY(!holder.buffer)) {
+    holder.buffer = std::make_shared<ThreadBuffer>(getOSThreadID());
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    buffers_.push_back(holder.buffer);
+  }
+  return *holder.buffer;
+}
+
+std::string DeferredLogger::vformatMessage(
+    folly::StringPiece fmt, fmt::format_args args, bool& failed) noexcept {
+  return folly::catch_exception<const std::exception&>(
+      [&] {
+        return fmt::vformat(fmt::string_view(fmt.data(), fmt.size()), args);
+      },
+      [&](const std::exception& ex) {
+        // As in LogStreamProcessor, log the format string and as much of the
+        // arguments as we can convert rather than throwing.
+        failed = true;
+        std::string result;
+        result.append("error formatting log message: ");
+        result.append(exceptionStr(ex).c_str());
+        result.append("; format string: \"");
+        result.append(fmt.data(), fmt.size());
+        result.append("\", arguments: ");
+        return result;
+      });
+}
+
+void DeferredLogger::flush() {
+  drainAll();
+}
+
+bool DeferredLogger::drainAll() {
+  std::lock_guard<std::mutex> drainLock(drainMutex_);
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    buffers = buffers_;
+  }
+
+  bool active = false;
+  for (auto& buffer : buffers) {
+    active = buffer->drain() || active;
+  }
+
+  // A buffer whose thread has exited gets no more messages once drained.
+  std::lock_guard<std::mutex> lock(buffersMutex_);
+  buffers_.erase(
+      std::remove_if(
+          buffers_.begin(),
+          buffers_.end(),
+          [](const auto& buffer) {
+            return buffer->exited.load(std::memory_order_acquire) &&
+                buffer->empty();
+          }),
+      buffers_.end());
+  return active;
+}
+
+void DeferredLogger::ioThread() {
+  folly::setThreadName("deferred_log");
+
+  auto interval = kMinPollInterval;
+  std::unique_lock<std::mutex> lock(threadMutex_);
+  while (!stop_) {
+    lock.unlock();
+    bool active = drainAll();
+    interval =
+        active ? kMinPollInterval : std::min(interval * 2, kMaxPollInterval);
+    lock.lock();
+    stopCV_.wait_for(lock, interval, [this] { return stop_; });
+  }
+}
+
+void DeferredLogger::startThread() {
+  std::lock_guard<std::mutex> lock(threadMutex_);
+  stop_ = false;
+  thread_ = std::thread([this] { ioThread(); });
+}
+
+void DeferredLogger::stopThread() {
+  {
+    std::lock_guard<std::mutex> lock(threadMutex_);
+    if (!thread_.joinable()) {
+      return;
+    }
+    stop_ = true;
+  }
+  stopCV_.notify_all();
+  thread_.join();
+}
+
+bool DeferredLogger::preFork() {
+  // Log everything buffered so far, and keep the I/O thread stopped and the
+  // buffers locked until the fork completes.
+  stopThread();
+  drainMutex_.lock();
+  buffersMutex_.lock();
+  for (auto& buffer : buffers_) {
+    buffer->drain();
+  }
+  return true;
+}
+
+void DeferredLogger::postForkParent() {
+  buffersMutex_.unlock();
+  drainMutex_.unlock();
+  startThread();
+}
+
+void DeferredLogger::postForkChild() {
+  // The other threads do not exist in the child process, and anything they
+  // logged since preFork() drained their buffers is logged by the parent.
+  // Drop their buffers, leaking the messages, rather than log them twice.
+  auto* current = threadBufferHolder().buffer.get();
+  buffers_.erase(
+      std::remove_if(
+          buffers_.begin(),
+          buffers_.end(),
+          [&](const auto& buffer) { return buffer.get() != current; }),
+      buffers_.end());
+  buffersMutex_.unlock();
+  drainMutex_.unlock();
+  startThread();
+}
+
+} // namespace folly
@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/core.h>
+#include <folly/Range.h>
+#include <folly/lang/Align.h>
+#include <folly/logging/LogCategory.h>
+#include <folly/logging/LogLevel.h>
+#include <folly/logging/LogMessage.h>
+#include <folly/logging/ObjectToString.h>
+#include <folly/logging/xlog.h>
+
+/**
+ * Log a message to this file's default log category, like XLOGF(), but
+ * format it on a background thread.
+ *
+ * The calling thread only copies the format string pointer, the call site
+ * information and the arguments into a ring buffer of its own, which takes
+ * tens of nanoseconds rather than the microseconds of formatting the message
+ * and running the log handlers.  A DeferredLogger thread later formats the
+ * message with fmt::format() and logs it as XLOGF() would, with the
+ * timestamp and thread ID of the original call.
+ *
+ * Because formatting happens later, the arguments are copied: C strings,
+ * StringPiece and std::string_view are copied into std::strings, and other
+ * arguments are copied by value.  Do not pass pointers or references to
+ * objects that may change or be destroyed before the message is formatted.
+ * The format string must outlive the program, such as a string literal.
+ *
+ * Fatal messages, messages too large for the ring buffer, and messages
+ * logged while this thread's ring buffer is full are formatted and logged
+ * immediately on the calling thread instead, after the messages still in its
+ * buffer, so no message is dropped or reordered.  Messages from different
+ * threads may be logged out of order.  Context
+ * strings (see LoggerDB::addContextCallback()) are computed on the
+ * background thread.
+ */
+#define XLOGF_DEFERRED(level, fmt, ...)                             \
+  (!XLOG_IS_ON_IMPL(::folly::LogLevel::level))                      \
+      ? static_cast<void>(0)                                        \
+      : ::folly::DeferredLogger::get().log(                         \
+            [] {                                                    \
+              static ::folly::LogCategory* const                    \
+                  folly_detail_xlog_deferred_category =             \
+                      XLOG_GET_CATEGORY();                          \
+              return folly_detail_xlog_deferred_category;           \
+            }(),                                                    \
+            ::folly::LogLevel::level,                               \
+            XLOG_FILENAME,                                          \
+            __LINE__,                                               \
+            __func__,                                               \
+            fmt,                                                    \
+            ##__VA_ARGS__)
+
+namespace folly {
+
+namespace detail {
+
+// The type in which DeferredLogger keeps an argument until it is formatted.
+template <typename T, typename D = std::decay_t<T>>
+using deferred_log_arg_t = std::conditional_t<
+    std::is_same_v<D, const char*> || std::is_same_v<D, char*> ||
+        std::is_same_v<D, StringPiece> || std::is_same_v<D, std::string_view>,
+    std::string,
+    D>;
+
+} // namespace detail
+
+/**
+ * DeferredLogger implements XLOGF_DEFERRED().
+ *
+ * Each thread that logs gets a single-producer single-consumer ring buffer,
+ * so logging takes no locks and shares no cache lines with other threads.
+ * One background thread polls the buffers, more often while messages keep
+ * arriving, and formats and logs each message.
+ */
+class DeferredLogger {
+ public:
+  /**
+   * The size of the ring buffer of each thread, in bytes.
+   */
+  static constexpr size_t kBufferSize = 64 * 1024;
+
+  static DeferredLogger& get();
+
+  template <typename... Args>
+  void log(
+      const LogCategory* category,
+      LogLevel level,
+      folly::StringPiece filename,
+      unsigned int lineNumber,
+      folly::StringPiece functionName,
+      folly::StringPiece fmt,
+      Args&&... args) noexcept;
+
+  /**
+   * Format and log, on the calling thread, every message buffered when
+   * flush() is called.  Messages still being logged by other threads may be
+   * missed.  This is called automatically when the program exits.
+   */
+  void flush();
+
+ private:
+  static constexpr size_t kAlign = 16;
+
+  struct alignas(kAlign) Header {
+    // Formats and logs the Record this heads, then destroys its arguments.
+    // nullptr for the padding that fills the end of the ring buffer when a
+    // record does not fit there.
+    void (*dispatch)(Header&) noexcept;
+    uint32_t size;
+  };
+
+  struct alignas(kAlign) Record : Header {
+    unsigned int lineNumber;
+    LogLevel level;
+    const LogCategory* category;
+    folly::StringPiece filename;
+    folly::StringPiece functionName;
+    folly::StringPiece format;
+    std::chrono::system_clock::time_point timestamp;
+    uint64_t threadID;
+
+    // The arguments follow the record, in a tuple.
+    void* args() { return this + 1; }
+  };
+
+  class ThreadBuffer {
+   public:
+    explicit ThreadBuffer(uint64_t threadID);
+
+    uint64_t threadID() const { return threadID_; }
+
+    // Returns space for a record of the given size, or nullptr if the
+    // buffer is full. Only the owning thread calls reserve() and commit().
+    void* reserve(size_t size) noexcept {
+      auto head = head_.load(std::memory_order_relaxed);
+      size_t offset = head & (kBufferSize - 1);
+      size_t contiguous = kBufferSize - offset;
+      size_t padding = size > contiguous ? contiguous : 0;
+      if (head + padding + size - tail_.load(std::memory_order_acquire) >
+          kBufferSize) {
+        return nullptr;
+      }
+      if (padding) {
+        new (data() + offset) Header{nullptr, static_cast<uint32_t>(padding)};
+        offset = 0;
+      }
+      reserved_ = padding + size;
+      return data() + offset;
+    }
+
+    void commit() noexcept {
+      head_.store(
+          head_.load(std::memory_order_relaxed) + reserved_,
+          std::memory_order_release);
+    }
+
+    // Dispatches the committed records. Returns whether there were any.
+    bool drain() noexcept;
+
+    bool empty() const {
+      return head_.load(std::memory_order_acquire) ==
+          tail_.load(std::memory_order_relaxed);
+    }
+
+    std::atomic<bool> exited{false};
+
+   private:
+    unsigned char* data() {
+      return reinterpret_cast<unsigned char*>(data_.get());
+    }
+
+    const std::unique_ptr<Header[]> data_;
+    const uint64_t threadID_;
+    size_t reserved_{0};
+    alignas(hardware_destructive_interference_size)
+        std::atomic<uint64_t> head_{0};
+    alignas(hardware_destructive_interference_size)
+        std::atomic<uint64_t> tail_{0};
+  };
+
+  // Marks the buffer of a thread as exited when the thread exits.
+  struct ThreadBufferHolder {
+    std::shared_ptr<ThreadBuffer> buffer;
+
+    ~ThreadBufferHolder();
+  };
+
+  DeferredLogger();
+
+  static ThreadBufferHolder& threadBufferHolder();
+  ThreadBuffer& threadBuffer();
+
+  template <typename Tuple>
+  static void dispatch(Header& header) noexcept;
+
+  template <typename... Args>
+  static void logNow(
+      const LogCategory* category,
+      LogLevel level,
+      std::chrono::system_clock::time_point timestamp,
+      uint64_t threadID,
+      folly::StringPiece filename,
+      unsigned int lineNumber,
+      folly::StringPiece functionName,
+      folly::StringPiece fmt,
+      const Args&... args) noexcept;
+
+  static std::string vformatMessage(
+      folly::StringPiece fmt, fmt::format_args args, bool& failed) noexcept;
+
+  bool drainAll();
+  void ioThread();
+  void startThread();
+  void stopThread();
+  bool preFork();
+  void postForkParent();
+  void postForkChild();
+
+  // Serializes draining, so that each buffer has a single consumer, and
+  // logging, so that log handlers are not called concurrently.
+  std::mutex drainMutex_;
+
+  std::mutex buffersMutex_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+  // Set when the program exits, after which messages are logged immediately.
+  std::atomic<bool> synchronous_{false};
+
+  std::mutex threadMutex_;
+  std::condition_variable stopCV_;
+  bool stop_{false};
+  std::thread thread_;
+};
+
+template <typename... Args>
+void DeferredLogger::log(
+    const LogCategory* category,
+    LogLevel level,
+    folly::StringPiece filename,
+    unsigned int lineNumber,
+    folly::StringPiece functionName,
+    folly::StringPiece fmt,
+    Args&&... args) noexcept {
+  using Tuple = std::tuple<detail::deferred_log_arg_t<Args>...>;
+  constexpr size_t size =
+      (sizeof(Record) + sizeof(Tuple) + kAlign - 1) & ~(kAlign - 1);
+  auto& buffer = threadBuffer();
+  if constexpr (alignof(Tuple) <= kAlign && size <= kBufferSize / 4) {
+    if (!isLogLevelFatal(level) &&
+        !synchronous_.load(std::memory_order_relaxed)) {
+      if (void* space = buffer.reserve(size)) {
+        auto* record = new (space) Record{
+            {&dispatch<Tuple>, static_cast<uint32_t>(size)},
+            lineNumber,
+            level,
+            category,
+            filename,
+            functionName,
+            fmt,
+            std::chrono::system_clock::now(),
+            buffer.threadID()};
+        new (record->args()) Tuple(std::forward<Args>(args)...);
+        buffer.commit();
+        return;
+      }
+    }
+  }
+  // Log the messages still in this thread's buffer first, to keep them in
+  // order.  Holding drainMutex_ also keeps the log handlers called from one
+  // thread at a time, as they are when the messages are deferred.
+  std::lock_guard<std::mutex> lock(drainMutex_);
+  buffer.drain();
+  logNow(
+      category,
+      level,
+      std::chrono::system_clock::now(),
+      buffer.threadID(),
+      filename,
+      lineNumber,
+      functionName,
+      fmt,
+      args...);
+}
+
+template <typename Tuple>
+void DeferredLogger::dispatch(Header& header) noexcept {
+  auto& record = static_cast<Record&>(header);
+  auto& args = *static_cast<Tuple*>(record.args());
+  std::apply(
+      [&](const auto&... arg) {
+        logNow(
+            record.category,
+            record.level,
+            record.timestamp,
+            record.threadID,
+            record.filename,
+            record.lineNumber,
+            record.functionName,
+            record.format,
+            arg...);
+      },
+      args);
+  args.~Tuple();
+}
+
+template <typename... Args>
+void DeferredLogger::logNow(
+    const LogCategory* category,
+    LogLevel level,
+    std::chrono::system_clock::time_point timestamp,
+    uint64_t threadID,
+    folly::StringPiece filename,
+    unsigned int lineNumber,
+    folly::StringPiece functionName,
+    folly::StringPiece fmt,
+    const Args&... args) noexcept {
+  bool failed = false;
+  std::string message =
+      vformatMessage(fmt, fmt::make_format_args(args...), failed);
+  if (failed) {
+    folly::logging::appendToString(message, args...);
+  }
+  // As in LogStreamProcessor, admitMessage() can only throw std::bad_alloc,
+  // in which case we let the noexcept specifier crash.
+  category->admitMessage(LogMessage{
+      category,
+      level,
+      timestamp,
+      threadID,
+      filename,
+      lineNumber,
+      functionName,
+      std::move(message)});
+}
+
+} // namespace folly
@@ -69,6 +69,27 @@ LogMessage::LogMessage(
   sanitizeMessage();
 }
 
+LogMessage::LogMessage(
+    const LogCategory* category,
+    LogLevel level,
+    system_clock::time_point timestamp,
+    uint64_t threadID,
+    StringPiece filename,
+    unsigned int lineNumber,
+    StringPiece functionName,
+    std::string&& msg)
+    : category_{category},
+      level_{level},
+      threadID_{threadID},
+      timestamp_{timestamp},
+      filename_{filename},
+      lineNumber_{lineNumber},
+      functionName_{functionName},
+      contextString_{getContextStringFromCategory(category_)},
+      rawMessage_{std::move(msg)} {
+  sanitizeMessage();
+}
+
 StringPiece LogMessage::getFileBaseName() const {
 #ifdef _WIN32
   // Windows allows either backwards or forwards slash as path separator
@@ -70,6 +70,20 @@ class LogMessage {
       folly::StringPiece functionName,
       std::string&& msg);
 
+  /**
+   * Construct a LogMessage with an explicit timestamp and thread ID, for
+   * messages logged on behalf of another thread, such as by DeferredLogger.
+   */
+  LogMessage(
+      const LogCategory* category,
+      LogLevel level,
+      std::chrono::system_clock::time_point timestamp,
+      uint64_t threadID,
+      folly::StringPiece filename,
+      unsigned int lineNumber,
+      folly::StringPiece functionName,
+      std::string&& msg);
+
   const LogCategory* getCategory() const { return category_; }
 
   LogLevel getLevel() const { return level_; }
@@ -16,6 +16,8 @@
 
 #include <folly/logging/RateLimiter.h>
 
+#include <folly/Random.h>
+
 namespace folly {
 namespace logging {
 
@@ -49,5 +51,11 @@ bool IntervalRateLimiter::checkSlow() {
   count_.store(1, std::memory_order_release);
   return true;
 }
+
+namespace detail {
+uint64_t sampleSeed() {
+  return folly::Random::rand64();
+}
+} // namespace detail
 } // namespace logging
 } // namespace folly
@@ -22,6 +22,8 @@
 #include <type_traits>
 
 #include <folly/Chrono.h>
+#include <folly/Likely.h>
+#include <folly/TokenBucket.h>
 
 namespace folly {
 namespace logging {
@@ -73,5 +75,57 @@ class IntervalRateLimiter {
   std::atomic<clock::rep> timestamp_{kInitialTimestamp};
 };
 
+/**
+ * A rate limiter that allows bursts of up to burstSize events, refilled at
+ * ratePerSecond events per second, and counts the events it rejects.
+ */
+class TokenBucketRateLimiter {
+ public:
+  TokenBucketRateLimiter(double ratePerSecond, double burstSize)
+      : bucket_{ratePerSecond, burstSize} {}
+
+  /**
+   * Returns whether the event is allowed.  If it is, also returns the number
+   * of events rejected since the previous allowed event in suppressed.
+   */
+  bool check(uint64_t& suppressed) {
+    if (!bucket_.consume(1)) {
+      suppressed_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    suppressed = suppressed_.load(std::memory_order_relaxed) == 0
+        ? 0
+        : suppressed_.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+
+ private:
+  TokenBucket bucket_;
+  std::atomic<uint64_t> suppressed_{0};
+};
+
+namespace detail {
+uint64_t sampleSeed();
+} // namespace detail
+
+/**
+ * Returns true with the given probability.
+ *
+ * This uses an xorshift generator local to each thread, seeded on first use,
+ * so it takes a few nanoseconds and no shared state.  It is intended for
+ * sampling log messages, not for anything requiring good randomness.
+ */
+FOLLY_ALWAYS_INLINE bool sample(double probability) {
+  static thread_local uint64_t state = 0;
+  if (FOLLY_UNLIKELY(state == 0)) {
+    state = detail::sampleSeed() | 1;
+  }
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  uint64_t bits = state * 0x2545F4914F6CDD1DULL;
+  return static_cast<double>(bits >> 11) * 0x1p-53 < probability;
+}
+
 } // namespace logging
 } // namespace folly
@@ -40,6 +40,7 @@
 #include <folly/portability/GFlags.h>
 #include <folly/portability/GMock.h>
 #include <folly/portability/GTest.h>
+#include <folly/portability/SysUio.h>
 #include <folly/portability/Unistd.h>
 #include <folly/system/ThreadId.h>
 #include <folly/system/ThreadName.h>
@@ -117,6 +118,28 @@ TEST(AsyncFileWriter, simpleMessages) {
   EXPECT_EQ(expected, data);
 }
 
+TEST(AsyncFileWriter, largeBatch) {
+  TemporaryFile tmpFile{"logging_test"};
+
+  // Write more messages than fit in one writev() call.  NEVER_DISCARD keeps
+  // them all, even if they are logged faster than they can be written.
+  std::string expected;
+  {
+    AsyncFileWriter writer{folly::File{tmpFile.fd(), false}};
+    for (size_t n = 0; n < 4 * kIovMax; ++n) {
+      auto msg = folly::to<std::string>("message ", n, "\n");
+      expected += msg;
+      writer.writeMessage(std::move(msg), LogWriter::NEVER_DISCARD);
+    }
+  }
+  tmpFile.close();
+
+  std::string data;
+  auto ret = folly::readFile(tmpFile.path().string().c_str(), data);
+  ASSERT_TRUE(ret);
+  EXPECT_EQ(expected, data);
+}
+
 namespace {
 static std::vector<std::string>* internalWarnings;
 
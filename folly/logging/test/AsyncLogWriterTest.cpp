@@ -17,7 +17,11 @@
 #include <folly/logging/AsyncLogWriter.h>
 
 #include <iostream>
+#include <thread>
 
+#include <folly/Conv.h>
+#include <folly/Synchronized.h>
+#include <folly/synchronization/Baton.h>
 #include <folly/logging/LoggerDB.h>
 #include <folly/portability/GMock.h>
 #include <folly/portability/GTest.h>
@@ -58,3 +62,124 @@ TEST(AsyncLogWriterDeathTest, cleanupWarning) {
     EXPECT_TRUE(flag);
   }
 }
+
+namespace {
+class TestLogWriter : public AsyncLogWriter {
+ public:
+  ~TestLogWriter() override { cleanup(); }
+
+  std::vector<std::string> getMessages() {
+    flush();
+    return messages_.copy();
+  }
+
+  size_t getNumDiscarded() const { return numDiscarded_; }
+
+  bool ttyOutput() const override { return false; }
+
+  // Makes the I/O thread wait for unblockIO() once it has taken the given
+  // message, so that nothing is written in the meantime.
+  void blockIO(StringPiece message) {
+    blockIO_ = true;
+    writeMessage(message);
+    ioBlocked_.wait();
+  }
+
+  void unblockIO() { unblockIO_.post(); }
+
+ private:
+  void performIO(
+      const std::vector<std::string>& logs, size_t numDiscarded) override {
+    if (blockIO_.exchange(false)) {
+      ioBlocked_.post();
+      unblockIO_.wait();
+    }
+    auto messages = messages_.wlock();
+    for (const auto& log : logs) {
+      if (!log.empty()) {
+        messages->push_back(log);
+      }
+    }
+    numDiscarded_ += numDiscarded;
+  }
+
+  folly::Synchronized<std::vector<std::string>> messages_;
+  std::atomic<size_t> numDiscarded_{0};
+  std::atomic<bool> blockIO_{false};
+  folly::Baton<> ioBlocked_;
+  folly::Baton<> unblockIO_;
+};
+} // namespace
+
+TEST(AsyncLogWriter, orderAcrossThreads) {
+  TestLogWriter writer;
+  std::vector<std::string> expected;
+  for (size_t n = 0; n < 20; ++n) {
+    auto msg = folly::to<std::string>("message ", n);
+    std::thread([&] { writer.writeMessage(StringPiece(msg)); }).join();
+    expected.push_back(msg);
+  }
+  EXPECT_EQ(expected, writer.getMessages());
+}
+
+TEST(AsyncLogWriter, discard) {
+  TestLogWriter writer;
+  writer.setMaxBufferSize(0);
+  writer.writeMessage(StringPiece("dropped 1"));
+  writer.writeMessage(StringPiece("kept 1"), LogWriter::NEVER_DISCARD);
+  writer.writeMessage(StringPiece("dropped 2"));
+  writer.writeMessage(StringPiece("kept 2"), LogWriter::NEVER_DISCARD);
+  EXPECT_THAT(writer.getMessages(), testing::ElementsAre("kept 1", "kept 2"));
+  EXPECT_EQ(2, writer.getNumDiscarded());
+
+  // A thread's buffer filling up does not discard messages, only the total
+  // size of the buffered messages does.
+  writer.setMaxBufferSize(AsyncLogWriter::kDefaultMaxBufferSize);
+  std::thread([&] {
+    for (size_t n = 0; n < 100 * AsyncLogWriter::kThreadBufferMessages; ++n) {
+      writer.writeMessage(folly::to<std::string>(n));
+    }
+  }).join();
+  auto messages = writer.getMessages();
+  EXPECT_EQ(100 * AsyncLogWriter::kThreadBufferMessages + 2, messages.size());
+  EXPECT_EQ(2, writer.getNumDiscarded());
+  EXPECT_EQ("0", messages[2]);
+  EXPECT_EQ(
+      folly::to<std::string>(100 * AsyncLogWriter::kThreadBufferMessages - 1),
+      messages.back());
+}
+
+TEST(AsyncLogWriter, maxBufferSizeIsShared) {
+  TestLogWriter writer;
+  writer.blockIO("blocked");
+  writer.setMaxBufferSize(100);
+  // The first thread takes up all of the buffer.
+  for (int t = 0; t < 2; ++t) {
+    std::thread([&] {
+      for (int n = 0; n < 20; ++n) {
+        writer.writeMessage(StringPiece("0123456789"));
+      }
+    }).join();
+  }
+  writer.unblockIO();
+  EXPECT_EQ(11, writer.getMessages().size());
+  EXPECT_EQ(30, writer.getNumDiscarded());
+}
+
+TEST(AsyncLogWriter, maxThreadBufferSize) {
+  TestLogWriter writer;
+  EXPECT_EQ(0, writer.getMaxThreadBufferSize());
+  writer.blockIO("blocked");
+  writer.setMaxThreadBufferSize(50);
+  // Each thread gets its share of the buffer.
+  for (int t = 0; t < 2; ++t) {
+    std::thread([&] {
+      for (int n = 0; n < 20; ++n) {
+        writer.writeMessage(StringPiece("0123456789"));
+      }
+    }).join();
+  }
+  writer.unblockIO();
+  EXPECT_EQ(11, writer.getMessages().size());
+  EXPECT_EQ(30, writer.getNumDiscarded());
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/logging/DeferredLogger.h>
+
+#include <string>
+#include <thread>
+
+#include <folly/logging/LogConfigParser.h>
+#include <folly/logging/LoggerDB.h>
+#include <folly/logging/test/TestLogHandler.h>
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+#include <folly/system/ThreadId.h>
+
+using namespace folly;
+
+XLOG_SET_CATEGORY_NAME("deferred_logger_test")
+
+namespace {
+class DeferredLoggerTest : public testing::Test {
+ public:
+  DeferredLoggerTest() {
+    LoggerDB::get().resetConfig(
+        parseLogConfig(".=WARN:default; default=stream:stream=stderr"));
+    handler_ = std::make_shared<TestLogHandler>();
+    auto* category = LoggerDB::get().getCategory("deferred_logger_test");
+    category->setLevel(LogLevel::DBG9);
+    category->setPropagateLevelMessagesToParent(LogLevel::MAX_LEVEL);
+    category->addHandler(handler_);
+  }
+
+ protected:
+  std::shared_ptr<TestLogHandler> handler_;
+};
+} // namespace
+
+TEST_F(DeferredLoggerTest, format) {
+  uint64_t threadID = 0;
+  auto before = std::chrono::system_clock::now();
+  std::thread([&] {
+    threadID = getOSThreadID();
+    XLOGF_DEFERRED(INFO, "{} + {} = {}", 1, 2.5, std::string("3.5"));
+    XLOGF_DEFERRED(DBG2, "name: {}", "deferred");
+    XLOGF_DEFERRED(WARN, "bad format {} {}", 1);
+  }).join();
+  DeferredLogger::get().flush();
+
+  auto& messages = handler_->getMessages();
+  ASSERT_EQ(3, messages.size());
+  EXPECT_EQ("1 + 2.5 = 3.5", messages[0].first.getMessage());
+  EXPECT_EQ(LogLevel::INFO, messages[0].first.getLevel());
+  EXPECT_EQ(threadID, messages[0].first.getThreadID());
+  EXPECT_LE(before, messages[0].first.getTimestamp());
+  EXPECT_EQ("DeferredLoggerTest.cpp", messages[0].first.getFileBaseName());
+  EXPECT_EQ("name: deferred", messages[1].first.getMessage());
+  EXPECT_EQ(LogLevel::DBG2, messages[1].first.getLevel());
+  EXPECT_THAT(
+      messages[2].first.getMessage(),
+      testing::MatchesRegex(
+          R"(error formatting log message: .*format_error.*; )"
+          R"(format string: "bad format \{\} \{\}", arguments: 1)"));
+}
+
+TEST_F(DeferredLoggerTest, copiesStrings) {
+  {
+    std::string temp(100, 'x');
+    XLOGF_DEFERRED(INFO, "{} {}", temp.c_str(), StringPiece(temp));
+    temp.assign(100, 'y');
+  }
+  DeferredLogger::get().flush();
+
+  auto& messages = handler_->getMessages();
+  ASSERT_EQ(1, messages.size());
+  EXPECT_EQ(
+      std::string(100, 'x') + " " + std::string(100, 'x'),
+      messages[0].first.getMessage());
+}
+
+TEST_F(DeferredLoggerTest, disabled) {
+  LoggerDB::get().getCategory("deferred_logger_test")->setLevel(LogLevel::INFO);
+  int evaluated = 0;
+  XLOGF_DEFERRED(DBG1, "{}", ++evaluated);
+  DeferredLogger::get().flush();
+  EXPECT_EQ(0, evaluated);
+  EXPECT_EQ(0, handler_->getMessages().size());
+}
+
+TEST_F(DeferredLoggerTest, overflow) {
+  // Log much more than fits in the buffer, from several threads, and check
+  // that every message of each thread arrives in order.
+  constexpr size_t kThreads = 4;
+  constexpr size_t kMessages = 20000;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back([t] {
+      for (size_t i = 0; i < kMessages; ++i) {
+        XLOGF_DEFERRED(INFO, "{} {} {}", t, i, std::string(40, 'z'));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  DeferredLogger::get().flush();
+
+  std::vector<size_t> next(kThreads, 0);
+  for (auto& message : handler_->getMessages()) {
+    size_t t, i;
+    ASSERT_EQ(2, sscanf(message.first.getMessage().c_str(), "%zu %zu", &t, &i));
+    ASSERT_LT(t, kThreads);
+    EXPECT_EQ(next[t], i);
+    next[t] = i + 1;
+  }
+  EXPECT_EQ(std::vector<size_t>(kThreads, kMessages), next);
+}
@@ -25,6 +25,7 @@
 #include <folly/portability/GTest.h>
 
 using folly::logging::IntervalRateLimiter;
+using folly::logging::TokenBucketRateLimiter;
 using std::chrono::duration_cast;
 using namespace std::literals::chrono_literals;
 
@@ -124,3 +125,34 @@ TEST(RateLimiter, LargeInterval) {
   IntervalRateLimiter limiter{1, std::chrono::hours{8765}}; // Just under a year
   EXPECT_TRUE(limiter.check());
 }
+
+TEST(RateLimiter, TokenBucket) {
+  TokenBucketRateLimiter limiter{0.001, 3};
+  uint64_t suppressed = 99;
+  for (int n = 0; n < 3; ++n) {
+    EXPECT_TRUE(limiter.check(suppressed));
+    EXPECT_EQ(0, suppressed);
+  }
+  for (int n = 0; n < 5; ++n) {
+    EXPECT_FALSE(limiter.check(suppressed));
+  }
+
+  TokenBucketRateLimiter fast{1e5, 1};
+  EXPECT_TRUE(fast.check(suppressed));
+  uint64_t rejected = 0;
+  while (!fast.check(suppressed)) {
+    ++rejected;
+  }
+  EXPECT_EQ(rejected, suppressed);
+}
+
+TEST(RateLimiter, Sample) {
+  size_t hits = 0;
+  for (int n = 0; n < 100000; ++n) {
+    EXPECT_FALSE(folly::logging::sample(0));
+    EXPECT_TRUE(folly::logging::sample(1));
+    hits += folly::logging::sample(0.25) ? 1 : 0;
+  }
+  EXPECT_GT(hits, 24000);
+  EXPECT_LT(hits, 26000);
+}
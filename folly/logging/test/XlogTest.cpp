@@ -585,6 +585,56 @@ TEST_F(XlogTest, rateLimitingEndOfThread) {
   handler->clearMessages();
 }
 
+TEST_F(XlogTest, sampledAndBudget) {
+  auto handler = make_shared<TestLogHandler>();
+  LoggerDB::get().getCategory(current_xlog_parent)->addHandler(handler);
+  LoggerDB::get().setLevel(current_xlog_parent, LogLevel::DBG1);
+
+  for (size_t n = 0; n < 10; ++n) {
+    XLOG_SAMPLED(DBG1, 0, "never ", n);
+    XLOG_SAMPLED(DBG1, 1, "always ", n);
+    XLOGF_SAMPLED(DBG1, 1.0, "fmt always {}", n);
+  }
+  EXPECT_EQ(20, handler->getMessages().size());
+  handler->clearMessages();
+
+  for (size_t n = 0; n < 10000; ++n) {
+    XLOG_SAMPLED(DBG1, 0.1, "sometimes ", n);
+  }
+  auto sampled = handler->getMessages().size();
+  EXPECT_GT(sampled, 700);
+  EXPECT_LT(sampled, 1300);
+  handler->clearMessages();
+
+  auto budget = [](size_t n) {
+    XLOG_BUDGET(DBG1, 100, 3, "budget ", n);
+  };
+  for (size_t n = 0; n < 10; ++n) {
+    budget(n);
+  }
+  /* sleep override */
+  std::this_thread::sleep_for(50ms);
+  budget(10);
+  EXPECT_THAT(
+      handler->getMessageValues(),
+      ElementsAreArray({
+          "budget 0",
+          "budget 1",
+          "budget 2",
+          "suppressed 7 messages over the XLOG_BUDGET() of this statement",
+          "budget 10",
+      }));
+  handler->clearMessages();
+
+  for (size_t n = 0; n < 5; ++n) {
+    XLOGF_BUDGET(DBG1, 0.001, 2, "fmt budget {}", n);
+  }
+  EXPECT_THAT(
+      handler->getMessageValues(),
+      ElementsAreArray({"fmt budget 0", "fmt budget 1"}));
+  handler->clearMessages();
+}
+
 TEST_F(XlogTest, getXlogCategoryName) {
   EXPECT_EQ("foo.cpp", getXlogCategoryNameForFile("foo.cpp"));
   EXPECT_EQ("foo.h", getXlogCategoryNameForFile("foo.h"));
@@ -686,6 +736,33 @@ TEST(Xlog, xlogStripFilename) {
   }
 }
 
+TEST(Xlog, xlogFileMinLevel) {
+  constexpr auto* list = "folly/io=INFO:folly/io/async=WARN:folly=DBG2";
+  static_assert(
+      detail::xlogFileMinLevel("folly/io/async/EventBase.cpp", list) ==
+      LogLevel::WARN);
+  EXPECT_EQ(
+      LogLevel::INFO, detail::xlogFileMinLevel("folly/io/IOBuf.cpp", list));
+  EXPECT_EQ(
+      LogLevel::DBG2, detail::xlogFileMinLevel("folly/String.cpp", list));
+  EXPECT_EQ(LogLevel::MIN_LEVEL, detail::xlogFileMinLevel("src/a.cpp", list));
+  EXPECT_EQ(
+      LogLevel::ERR,
+      detail::xlogFileMinLevel("src/a.cpp", "=ERR:folly=DBG2"))
+      << "an empty prefix matches every file";
+
+  EXPECT_EQ(LogLevel::DBG, detail::xlogFileMinLevel("a", "a=DBG"));
+  EXPECT_EQ(LogLevel::DBG5, detail::xlogFileMinLevel("a", "a=DBG5"));
+  EXPECT_EQ(LogLevel::INFO3, detail::xlogFileMinLevel("a", "a=INFO3"));
+  EXPECT_EQ(LogLevel::WARN, detail::xlogFileMinLevel("a", "a=WARNING"));
+  EXPECT_EQ(LogLevel::ERR, detail::xlogFileMinLevel("a", "a=ERROR"));
+  EXPECT_EQ(LogLevel::CRITICAL, detail::xlogFileMinLevel("a", "a=CRITICAL"));
+
+  EXPECT_EQ(LogLevel::UNINITIALIZED, detail::xlogFileMinLevel("a", "a"));
+  EXPECT_EQ(LogLevel::UNINITIALIZED, detail::xlogFileMinLevel("a", "a=DBG10"));
+  EXPECT_EQ(LogLevel::UNINITIALIZED, detail::xlogFileMinLevel("a", "a=info"));
+}
+
 TEST(Xlog, XCheckPrecedence) {
   // Ensure that XCHECK_XX() and XDCHECK_XX() avoid the common macro pitfall of
   // not wrapping arguments in parentheses and causing incorrect operator
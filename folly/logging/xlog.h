@@ -21,6 +21,7 @@
 #include <folly/Likely.h>
 #include <folly/Portability.h>
 #include <folly/Range.h>
+#include <folly/lang/Align.h>
 #include <folly/logging/LogStream.h>
 #include <folly/logging/Logger.h>
 #include <folly/logging/LoggerDB.h>
@@ -405,6 +406,81 @@ FOLLY_EXPORT FOLLY_ALWAYS_INLINE bool xlogEveryNThreadImpl(size_t n) {
       }(),                                                 \
       ##__VA_ARGS__)
 
+/**
+ * Similar to XLOG(...) except only log a message with probability @param p.
+ *
+ * The decision uses a cheap pseudo-random generator local to each thread, so
+ * unlike XLOG_EVERY_N() it touches no shared state and does not log in lock
+ * step across threads.
+ */
+#define XLOG_SAMPLED(level, p, ...) \
+  XLOG_IF(level, ::folly::logging::sample(p), ##__VA_ARGS__)
+
+/**
+ * Similar to XLOGF(...) except only log a message with probability @param p.
+ */
+#define XLOGF_SAMPLED(level, p, fmt, ...) \
+  XLOGF_IF(level, ::folly::logging::sample(p), fmt, ##__VA_ARGS__)
+
+/**
+ * Similar to XLOG(...) except only log bursts of up to @param burst messages,
+ * refilled at @param rate messages per second, from this call site.
+ *
+ * When messages are allowed again after some were suppressed, a message
+ * saying how many were suppressed is logged first, at the same level.
+ *
+ * The internal token bucket is process-global and threadsafe.  The rate and
+ * burst of the first call are used for the lifetime of the program.
+ */
+#define XLOG_BUDGET(level, rate, burst, ...)                                 \
+  XLOG_IF(                                                                   \
+      level,                                                                 \
+      [&] {                                                                  \
+        static ::folly::logging::TokenBucketRateLimiter                      \
+            folly_detail_xlog_limiter((rate), (burst));                      \
+        uint64_t folly_detail_xlog_suppressed = 0;                           \
+        if (!folly_detail_xlog_limiter.check(folly_detail_xlog_suppressed)) { \
+          return false;                                                      \
+        }                                                                    \
+        if (folly_detail_xlog_suppressed > 0) {                              \
+          XLOG(                                                              \
+              level,                                                         \
+              "suppressed ",                                                 \
+              folly_detail_xlog_suppressed,                                  \
+              " messages over the XLOG_BUDGET() of this statement");         \
+        }                                                                    \
+        return true;                                                         \
+      }(),                                                                   \
+      ##__VA_ARGS__)
+
+/**
+ * Similar to XLOGF(...) except only log bursts of up to @param burst messages,
+ * refilled at @param rate messages per second, from this call site.
+ *
+ * See XLOG_BUDGET() for details.
+ */
+#define XLOGF_BUDGET(level, rate, burst, fmt, ...)                           \
+  XLOGF_IF(                                                                  \
+      level,                                                                 \
+      [&] {                                                                  \
+        static ::folly::logging::TokenBucketRateLimiter                      \
+            folly_detail_xlog_limiter((rate), (burst));                      \
+        uint64_t folly_detail_xlog_suppressed = 0;                           \
+        if (!folly_detail_xlog_limiter.check(folly_detail_xlog_suppressed)) { \
+          return false;                                                      \
+        }                                                                    \
+        if (folly_detail_xlog_suppressed > 0) {                              \
+          XLOG(                                                              \
+              level,                                                         \
+              "suppressed ",                                                 \
+              folly_detail_xlog_suppressed,                                  \
+              " messages over the XLOG_BUDGET() of this statement");         \
+        }                                                                    \
+        return true;                                                         \
+      }(),                                                                   \
+      fmt,                                                                   \
+      ##__VA_ARGS__)
+
 namespace folly {
 namespace detail {
 
@@ -452,6 +528,26 @@ FOLLY_EXPORT FOLLY_ALWAYS_INLINE bool xlogFirstNExactImpl(std::size_t n) {
 #define XLOG_FILENAME (static_cast<char const*>(__FILE__))
 #endif
 
+/**
+ * FOLLY_XLOG_MIN_LEVEL_PREFIXES can be defined to a string containing a
+ * colon-separated list of prefix=LEVEL entries, such as
+ * "folly/io=INFO:folly/io/async=WARN".  Like FOLLY_XLOG_MIN_LEVEL, but only
+ * for files whose XLOG_FILENAME starts with the prefix, XLOG() statements
+ * below the level of the longest matching prefix are compiled out.
+ *
+ * The levels may be DBG, DBG0 to DBG9, INFO, INFO0 to INFO9, WARN, WARNING,
+ * ERR, ERROR or CRITICAL.  The list is parsed at compile time, and a malformed
+ * list fails the build.
+ */
+#ifdef FOLLY_XLOG_MIN_LEVEL_PREFIXES
+#define XLOG_FILE_MIN_LEVEL                                     \
+  (::folly::detail::XlogConstantLevel<                          \
+      ::folly::detail::xlogFileMinLevel(                        \
+          XLOG_FILENAME, FOLLY_XLOG_MIN_LEVEL_PREFIXES)>::value)
+#else
+#define XLOG_FILE_MIN_LEVEL (::folly::LogLevel::MIN_LEVEL)
+#endif
+
 #define XLOG_IMPL(level, type, ...) \
   XLOG_ACTUAL_IMPL(                 \
       level, true, ::folly::isLogLevelFatal(level), type, ##__VA_ARGS__)
@@ -539,7 +635,8 @@ FOLLY_EXPORT FOLLY_ALWAYS_INLINE bool xlogFirstNExactImpl(std::size_t n) {
  *
  * This helper macro invokes XLOG_IS_ON_IMPL_HELPER() to perform the real
  * log level check, with a couple additions:
- * - If the log level is less than FOLLY_XLOG_MIN_LEVEL it evaluates to false
+ * - If the log level is less than FOLLY_XLOG_MIN_LEVEL, or than the level
+ *   FOLLY_XLOG_MIN_LEVEL_PREFIXES gives this file, it evaluates to false
  *   to allow the compiler to completely optimize out the check and log message
  *   if the level is less than this compile-time fixed constant.
  * - If the log level is fatal, this has an extra check at the end to ensure the
@@ -550,6 +647,7 @@ FOLLY_EXPORT FOLLY_ALWAYS_INLINE bool xlogFirstNExactImpl(std::size_t n) {
  */
 #define XLOG_IS_ON_IMPL(level)                              \
   ((((level) >= ::folly::LogLevel::FOLLY_XLOG_MIN_LEVEL) && \
+    ((level) >= XLOG_FILE_MIN_LEVEL) &&                     \
     XLOG_IS_ON_IMPL_HELPER(level)) ||                       \
    ((level) >= ::folly::kMinFatalLogLevel))
 
@@ -774,7 +872,9 @@ std::unique_ptr<std::string> XCheckOpImpl(
 
 namespace folly {
 
-class XlogFileScopeInfo {
+// Kept on cache lines of its own, so that the level check of every XLOG()
+// statement in a .cpp file only reads a line that is almost never written.
+class alignas(hardware_destructive_interference_size) XlogFileScopeInfo {
  public:
   std::atomic<::folly::LogLevel> level{folly::LogLevel::UNINITIALIZED};
   ::folly::LogCategory* category{nullptr};
@@ -987,6 +1087,108 @@ FOLLY_CONSTEVAL const char* xlogStripFilename(
   return detail::xlogStripFilenameRecursive(filename, prefixes, 0, 0, true);
 }
 
+namespace detail {
+constexpr bool xlogLevelNameIs(
+    const char* name, size_t length, const char* expected) {
+  size_t i = 0;
+  for (; i < length; ++i) {
+    if (name[i] != expected[i]) {
+      return false;
+    }
+  }
+  return expected[i] == '\0';
+}
+
+// Returns LogLevel::UNINITIALIZED for an unknown name.
+constexpr LogLevel xlogParseLevelName(const char* name, size_t length) {
+  if (xlogLevelNameIs(name, length, "DBG")) {
+    return LogLevel::DBG;
+  } else if (xlogLevelNameIs(name, length, "INFO")) {
+    return LogLevel::INFO;
+  } else if (
+      xlogLevelNameIs(name, length, "WARN") ||
+      xlogLevelNameIs(name, length, "WARNING")) {
+    return LogLevel::WARN;
+  } else if (
+      xlogLevelNameIs(name, length, "ERR") ||
+      xlogLevelNameIs(name, length, "ERROR")) {
+    return LogLevel::ERR;
+  } else if (xlogLevelNameIs(name, length, "CRITICAL")) {
+    return LogLevel::CRITICAL;
+  }
+  char last = length > 0 ? name[length - 1] : '\0';
+  if (last >= '0' && last <= '9') {
+    auto verbosity = static_cast<uint32_t>(last - '0');
+    if (xlogLevelNameIs(name, length - 1, "DBG")) {
+      return static_cast<LogLevel>(
+          static_cast<uint32_t>(LogLevel::DBG0) - verbosity);
+    } else if (xlogLevelNameIs(name, length - 1, "INFO")) {
+      return static_cast<LogLevel>(
+          static_cast<uint32_t>(LogLevel::INFO0) - verbosity);
+    }
+  }
+  return LogLevel::UNINITIALIZED;
+}
+
+/**
+ * Get the minimum level that FOLLY_XLOG_MIN_LEVEL_PREFIXES gives the file:
+ * the level of the longest prefix of the filename in the list, or MIN_LEVEL
+ * if there is none.  Returns LogLevel::UNINITIALIZED if the list is
+ * malformed.
+ */
+constexpr LogLevel xlogFileMinLevel(const char* filename, const char* list) {
+  LogLevel result = LogLevel::MIN_LEVEL;
+  size_t longestMatch = 0;
+  bool matched = false;
+  size_t i = 0;
+  while (list[i] != '\0') {
+    size_t prefixStart = i;
+    while (list[i] != '=' && list[i] != ':' && list[i] != '\0') {
+      ++i;
+    }
+    if (list[i] != '=') {
+      return LogLevel::UNINITIALIZED;
+    }
+    size_t prefixLength = i - prefixStart;
+    size_t levelStart = ++i;
+    while (list[i] != ':' && list[i] != '\0') {
+      ++i;
+    }
+    auto level = xlogParseLevelName(list + levelStart, i - levelStart);
+    if (level == LogLevel::UNINITIALIZED) {
+      return LogLevel::UNINITIALIZED;
+    }
+    if (list[i] == ':') {
+      ++i;
+    }
+
+    if (matched && prefixLength <= longestMatch) {
+      continue;
+    }
+    size_t j = 0;
+    while (j < prefixLength && filename[j] == list[prefixStart + j]) {
+      ++j;
+    }
+    if (j == prefixLength) {
+      result = level;
+      longestMatch = prefixLength;
+      matched = true;
+    }
+  }
+  return result;
+}
+
+// Forces xlogFileMinLevel() to be evaluated at compile time.
+template <LogLevel Level>
+struct XlogConstantLevel {
+  static_assert(
+      Level != LogLevel::UNINITIALIZED,
+      "FOLLY_XLOG_MIN_LEVEL_PREFIXES must be a colon-separated list of "
+      "prefix=LEVEL entries");
+  static constexpr LogLevel value = Level;
+};
+} // namespace detail
+
 namespace detail {
 
 /*
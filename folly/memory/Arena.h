@@ -142,6 +142,9 @@ class Arena {
   // `bytesUsed()` will be 6KB, while `totalSize()` will be 8KB+.
   size_t bytesUsed() const { return bytesUsed_; }
 
+  // Gets the alignment of every pointer returned by `allocate`
+  size_t maxAlign() const { return maxAlign_; }
+
   // not copyable or movable
   Arena(const Arena&) = delete;
   Arena& operator=(const Arena&) = delete;
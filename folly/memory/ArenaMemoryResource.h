@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include <folly/Portability.h>
+#include <folly/lang/Exception.h>
+#include <folly/memory/Arena.h>
+#include <folly/memory/MemoryResource.h>
+#include <folly/memory/ThreadCachedArena.h>
+
+#if FOLLY_HAS_MEMORY_RESOURCE
+
+namespace folly {
+
+/**
+ * A memory_resource that allocates from an arena, so that pmr containers
+ * (folly::pmr::F14FastMap, std::pmr::vector, std::pmr::string, ...) can be
+ * put in one:
+ *
+ *        SysArena arena;
+ *        SysArenaMemoryResource resource(arena);
+ *        folly::pmr::F14FastMap<int, std::pmr::string> map(&resource);
+ *
+ * Like the arena, the resource is monotonic: deallocation is a no-op, and
+ * memory is freed only when the arena is cleared or destroyed, so containers
+ * may grow and shrink without any calls to free(). The arena must outlive
+ * the resource, which must outlive everything allocated from it.
+ *
+ * Allocations aligned to at most the arena's maxAlign() are served directly;
+ * larger alignments are padded and aligned within the arena.
+ *
+ * ArenaT is an Arena<Alloc>, SysArena or ThreadCachedArena. With the latter,
+ * each thread allocates from its own arena, so one resource may be shared by
+ * all the threads that serve a request.
+ */
+template <class ArenaT>
+class ArenaMemoryResource : public detail::std_pmr::memory_resource {
+ public:
+  explicit ArenaMemoryResource(ArenaT& arena) noexcept : arena_(arena) {}
+
+  ArenaMemoryResource(const ArenaMemoryResource&) = delete;
+  ArenaMemoryResource& operator=(const ArenaMemoryResource&) = delete;
+
+  ArenaT& arena() const noexcept { return arena_; }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    if (FOLLY_UNLIKELY(alignment & (alignment - 1))) {
+      throw_exception<std::bad_alloc>();
+    }
+    auto const maxAlign = arena_.maxAlign();
+    if (FOLLY_LIKELY(alignment <= maxAlign)) {
+      return arena_.allocate(bytes);
+    }
+    auto const pad = alignment - maxAlign;
+    if (FOLLY_UNLIKELY(bytes > std::size_t(-1) - pad)) {
+      throw_exception<std::bad_alloc>();
+    }
+    auto p = reinterpret_cast<std::uintptr_t>(arena_.allocate(bytes + pad));
+    return reinterpret_cast<void*>((p + alignment - 1) & ~(alignment - 1));
+  }
+
+  void do_deallocate(void*, std::size_t, std::size_t) noexcept override {
+    // Deallocate? Never!
+  }
+
+  // Memory from any resource on the same arena may be "deallocated" by any
+  // other, as deallocation does nothing.
+  bool do_is_equal(
+      const detail::std_pmr::memory_resource& other) const noexcept override {
+    auto* o = dynamic_cast<const ArenaMemoryResource*>(&other);
+    return o && &o->arena_ == &arena_;
+  }
+
+  ArenaT& arena_;
+};
+
+using SysArenaMemoryResource = ArenaMemoryResource<SysArena>;
+using ThreadCachedArenaMemoryResource = ArenaMemoryResource<ThreadCachedArena>;
+
+} // namespace folly
+
+#endif // FOLLY_HAS_MEMORY_RESOURCE
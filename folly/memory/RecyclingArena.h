@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <boost/intrusive/list.hpp>
+
+#include <folly/Likely.h>
+#include <folly/Memory.h>
+#include <folly/lang/Align.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/CheckedMath.h>
+#include <folly/lang/Exception.h>
+#include <folly/memory/Arena.h>
+
+namespace folly {
+
+/**
+ * Recycling arena: an Arena whose deallocate() puts memory back on a free
+ * list for its size class, for later allocations of that class to reuse.
+ *
+ * Arena never frees individual allocations, so containers with churn in a
+ * long-lived arena grow it without bound. RecyclingArena keeps the locality
+ * and cheap allocation of an arena, while bounding its footprint by the peak
+ * of live memory rather than the total ever allocated:
+ *
+ *  - Sizes up to maxRecycledSize are rounded up to a size class: multiples
+ *    of maxAlign up to 8 of them, then four classes per power of two, so
+ *    rounding wastes at most a quarter. They are carved out of the arena's
+ *    blocks, and recycled by their class on deallocate().
+ *  - Larger sizes are allocated and freed one at a time with Alloc.
+ *
+ * Memory that is on a free list is only reused by its own class. When churn
+ * moves between classes, free memory builds up; shouldCompact() reports
+ * when it makes up more than a given share of the footprint, as a hint to
+ * the owner to rebuild its containers in a fresh arena.
+ *
+ * As with Arena, all memory is freed when the arena is destroyed or
+ * cleared, and the arena is not thread-safe.
+ */
+template <class Alloc>
+class RecyclingArena {
+ public:
+  static constexpr size_t kDefaultMaxRecycledSize = 4096;
+
+  explicit RecyclingArena(
+      const Alloc& alloc,
+      size_t minBlockSize = Arena<Alloc>::kDefaultMinBlockSize,
+      size_t maxRecycledSize = kDefaultMaxRecycledSize,
+      size_t maxAlign = Arena<Alloc>::kDefaultMaxAlign)
+      : arena_(alloc, minBlockSize, Arena<Alloc>::kNoSizeLimit, maxAlign),
+        alloc_(alloc),
+        unit_(std::max(maxAlign, sizeof(FreeNode))),
+        maxRecycledSize_(maxRecycledSize),
+        freeLists_(sizeClass(maxRecycledSize) + 1, nullptr) {}
+
+  ~RecyclingArena() { freeLargeBlocks(); }
+
+  void* allocate(size_t size) {
+    if (FOLLY_UNLIKELY(size > maxRecycledSize_)) {
+      return allocateLarge(size);
+    }
+    auto cls = sizeClass(size);
+    auto classSize = sizeOfClass(cls);
+    bytesUsed_ += classSize;
+    if (FreeNode* node = freeLists_[cls]) {
+      freeLists_[cls] = node->next;
+      bytesFree_ -= classSize;
+      return node;
+    }
+    return arena_.allocate(classSize);
+  }
+
+  void deallocate(void* p, size_t size) {
+    if (FOLLY_UNLIKELY(size > maxRecycledSize_)) {
+      deallocateLarge(p);
+      return;
+    }
+    auto cls = sizeClass(size);
+    auto classSize = sizeOfClass(cls);
+    assert(bytesUsed_ >= classSize);
+    bytesUsed_ -= classSize;
+    bytesFree_ += classSize;
+    freeLists_[cls] = new (p) FreeNode{freeLists_[cls]};
+  }
+
+  // Free all memory, whether or not it was deallocated, keeping the
+  // arena's first block for reuse.
+  void clear() {
+    freeLargeBlocks();
+    arena_.clear();
+    std::fill(freeLists_.begin(), freeLists_.end(), nullptr);
+    bytesUsed_ = 0;
+    bytesFree_ = 0;
+  }
+
+  // Gets the total memory used by the arena, including free lists
+  size_t totalSize() const {
+    return arena_.totalSize() + largeSize_ + sizeof(RecyclingArena) -
+        sizeof(arena_);
+  }
+
+  // Gets the number of bytes allocated and not yet deallocated, rounded up
+  // to their size classes
+  size_t bytesUsed() const { return bytesUsed_ + largeSize_; }
+
+  // Gets the number of bytes on free lists, waiting to be reused
+  size_t bytesFree() const { return bytesFree_; }
+
+  // Whether free lists hold more than maxFreeRatio of the footprint
+  bool shouldCompact(double maxFreeRatio = 0.5) const {
+    return double(bytesFree_) > maxFreeRatio * double(totalSize());
+  }
+
+  // The size that an allocation of `size` bytes is rounded up to
+  size_t goodSize(size_t size) const {
+    return size > maxRecycledSize_ ? size : sizeOfClass(sizeClass(size));
+  }
+
+  // not copyable or movable
+  RecyclingArena(const RecyclingArena&) = delete;
+  RecyclingArena& operator=(const RecyclingArena&) = delete;
+  RecyclingArena(RecyclingArena&&) = delete;
+  RecyclingArena& operator=(RecyclingArena&&) = delete;
+
+ private:
+  using AllocTraits =
+      typename std::allocator_traits<Alloc>::template rebind_traits<char>;
+
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  struct alignas(max_align_v) LargeBlock {
+    boost::intrusive::list_member_hook<> link;
+    const size_t allocSize;
+
+    char* start() { return reinterpret_cast<char*>(this + 1); }
+
+    explicit LargeBlock(size_t s) : allocSize(s) {}
+  };
+
+  typedef boost::intrusive::list<
+      LargeBlock,
+      boost::intrusive::member_hook<
+          LargeBlock,
+          boost::intrusive::list_member_hook<>,
+          &LargeBlock::link>,
+      boost::intrusive::constant_time_size<false>>
+      LargeBlockList;
+
+  // Classes 0-7 are 1-8 units; each power of two of units after that is
+  // split into four classes.
+  size_t sizeClass(size_t size) const {
+    size_t units = std::max<size_t>(1, (size + unit_ - 1) / unit_);
+    if (units <= 8) {
+      return units - 1;
+    }
+    size_t log = findLastSet(units - 1) - 1;
+    size_t quarter = (units - 1) >> (log - 2);
+    return 8 + (log - 3) * 4 + (quarter - 4);
+  }
+
+  size_t sizeOfClass(size_t cls) const {
+    if (cls < 8) {
+      return (cls + 1) * unit_;
+    }
+    size_t log = 3 + (cls - 8) / 4;
+    size_t quarter = 4 + (cls - 8) % 4;
+    return ((quarter + 1) << (log - 2)) * unit_;
+  }
+
+  void* allocateLarge(size_t size) {
+    size_t allocSize;
+    if (!checked_add(&allocSize, size, sizeof(LargeBlock))) {
+      throw_exception<std::bad_alloc>();
+    }
+    void* mem = AllocTraits::allocate(alloc_, allocSize);
+    auto blk = new (mem) LargeBlock(allocSize);
+    largeBlocks_.push_back(*blk);
+    largeSize_ += allocSize;
+    return blk->start();
+  }
+
+  void deallocateLarge(void* p) {
+    auto blk = reinterpret_cast<LargeBlock*>(p) - 1;
+    largeBlocks_.erase(largeBlocks_.iterator_to(*blk));
+    disposeLarge(blk);
+  }
+
+  void disposeLarge(LargeBlock* blk) {
+    auto size = blk->allocSize;
+    largeSize_ -= size;
+    blk->~LargeBlock();
+    AllocTraits::deallocate(alloc_, reinterpret_cast<char*>(blk), size);
+  }
+
+  void freeLargeBlocks() {
+    largeBlocks_.clear_and_dispose([this](LargeBlock* b) { disposeLarge(b); });
+  }
+
+  Arena<Alloc> arena_;
+  Alloc alloc_;
+  const size_t unit_;
+  const size_t maxRecycledSize_;
+  std::vector<FreeNode*> freeLists_;
+  LargeBlockList largeBlocks_;
+  size_t bytesUsed_{0};
+  size_t bytesFree_{0};
+  size_t largeSize_{0};
+};
+
+/**
+ * RecyclingArena that uses the system allocator (malloc / free)
+ */
+class SysRecyclingArena : public RecyclingArena<SysAllocator<char>> {
+ public:
+  explicit SysRecyclingArena(
+      size_t minBlockSize = SysArena::kDefaultMinBlockSize,
+      size_t maxRecycledSize = kDefaultMaxRecycledSize,
+      size_t maxAlign = SysArena::kDefaultMaxAlign)
+      : RecyclingArena<SysAllocator<char>>(
+            {}, minBlockSize, maxRecycledSize, maxAlign) {}
+};
+
+template <typename T, typename Alloc>
+using RecyclingArenaAllocator = CxxAllocatorAdaptor<T, RecyclingArena<Alloc>>;
+
+template <typename T>
+using SysRecyclingArenaAllocator = CxxAllocatorAdaptor<T, SysRecyclingArena>;
+
+} // namespace folly
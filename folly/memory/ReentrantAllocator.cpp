@@ -16,6 +16,7 @@
 
 #include <folly/memory/ReentrantAllocator.h>
 
+#include <algorithm>
 #include <new>
 #include <utility>
 
@@ -79,19 +80,60 @@ reentrant_allocator_base::~reentrant_allocator_base() {
   }
 }
 
+std::size_t reentrant_allocator_base::size_class_lg(
+    std::size_t const n, std::size_t const a) const noexcept {
+  //  large requests are handled directly
+  if (n >= meta_->large_size) {
+    return 0;
+  }
+  auto const size = std::max({n, a, sizeof(free_t)});
+  auto const lg = findLastSet(size - 1);
+  //  the class must fit in a segment, after the segment header
+  if ((std::size_t(2) << lg) > meta_->block_size) {
+    return 0;
+  }
+  return lg;
+}
+
 void* reentrant_allocator_base::allocate(
     std::size_t const n, std::size_t const a) noexcept {
   if (!n) {
     return &dummy;
   }
-  //  large requests are handled directly
-  if (n >= meta_->large_size) {
+  auto const lg = size_class_lg(n, a);
+  if (!lg) {
     return reentrant_allocate(n);
   }
+  //  small requests are handled first from the free list of the size class,
+  //  unless another pop is in progress
+  auto& cls = meta_->classes[lg];
+  if (!cls.popping.exchange(true, std::memory_order_acquire)) {
+    //  as the only popper, the head cannot be popped and pushed again by
+    //  others between the load and the c/x
+    auto head = cls.head.load(std::memory_order_acquire);
+    while (head && //
+           !cls.head.compare_exchange_weak(
+               head,
+               head->next,
+               std::memory_order_acquire,
+               std::memory_order_acquire)) {
+    }
+    cls.popping.store(false, std::memory_order_release);
+    if (head) {
+      return head;
+    }
+  }
+  return allocate_from_segment(std::size_t(1) << lg);
+}
+
+void* reentrant_allocator_base::allocate_from_segment(
+    std::size_t const n) noexcept {
   //  small requests are handled from the shared arena list:
   //  * if the list is empty or the list head has insufficient space, c/x a new
   //    list head, starting over
   //  * then c/x the list head size to the new size, starting over on failure
+  //  size classes are aligned to their size
+  auto const a = n;
   auto const block_size = meta_->block_size;
   //  load head - non-const because used in c/x below
   auto head = meta_->head.load(std::memory_order_acquire);
@@ -131,7 +173,7 @@ void* reentrant_allocator_base::allocate(
 }
 
 void reentrant_allocator_base::deallocate(
-    void* const p, std::size_t const n) noexcept {
+    void* const p, std::size_t const n, std::size_t const a) noexcept {
   if (p == &dummy) {
     FOLLY_SAFE_CHECK(n == 0, "unexpected non-zero size");
     return;
@@ -139,12 +181,20 @@ void reentrant_allocator_base::deallocate(
   if (!n || !p) {
     return;
   }
-  //  large requests are handled directly
-  if (n >= meta_->large_size) {
+  auto const lg = size_class_lg(n, a);
+  if (!lg) {
     reentrant_deallocate(p, n);
     return;
   }
-  //  small requests are deferred to allocator destruction, so no-op here
+  //  small requests are pushed onto the free list of the size class, and the
+  //  memory is returned all at once at allocator destruction
+  auto& cls = meta_->classes[lg];
+  auto const block = ::new (p) free_t();
+  auto head = cls.head.load(std::memory_order_relaxed);
+  do {
+    block->next = head;
+  } while (!cls.head.compare_exchange_weak(
+      head, block, std::memory_order_release, std::memory_order_relaxed));
 }
 
 void reentrant_allocator_base::obliterate() noexcept {
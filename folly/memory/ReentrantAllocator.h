@@ -65,7 +65,7 @@ class reentrant_allocator_base {
   ~reentrant_allocator_base();
 
   void* allocate(std::size_t n, std::size_t a) noexcept;
-  void deallocate(void* p, std::size_t n) noexcept;
+  void deallocate(void* p, std::size_t n, std::size_t a) noexcept;
 
   std::size_t max_size() const noexcept {
     return std::numeric_limits<std::size_t>::max();
@@ -88,16 +88,36 @@ class reentrant_allocator_base {
   //  refcounted. When the last copy of the allocator is destroyed, segments
   //  are deallocated all at once via munmap. Node is the header data
   //  structure prefixing each segment while Meta is the data structure
-  //  representing shared ownership of the segment list. Serve allocations
-  //  from the head segment if it exists and has space, otherwise mmap and
-  //  chain a new segment and serve allocations from it. Serve deallocations
-  //  by doing nothing at all.
+  //  representing shared ownership of the segment list. Small sizes are
+  //  rounded up to power-of-two size classes. Serve allocations from the free
+  //  list of the size class if it is nonempty, otherwise from the head
+  //  segment if it exists and has space, otherwise mmap and chain a new
+  //  segment and serve allocations from it. Serve deallocations by pushing
+  //  onto the free list of the size class.
   struct node_t {
     node_t* next = nullptr;
     std::atomic<std::size_t> size{sizeof(node_t)};
     explicit node_t(node_t* next_) noexcept : next{next_} {}
   };
 
+  //  A freed small block, linked into the free list of its size class.
+  struct free_t {
+    free_t* next = nullptr;
+  };
+
+  //  The free list of a size class. Pushes are lock-free. Pops are lock-free
+  //  too, but are serialized by a flag which is only ever try-acquired, which
+  //  makes the pop immune to ABA. When the flag is held, including by a pop
+  //  interrupted by a signal handler on the same thread, allocations fall
+  //  back to the head segment instead of waiting.
+  struct class_t {
+    std::atomic<free_t*> head{nullptr};
+    std::atomic<bool> popping{false};
+  };
+
+  //  Size classes are indexed by the log2 of their size.
+  static constexpr std::size_t num_classes = sizeof(std::size_t) * 8;
+
   //  The shared state which all copies of the allocator share.
   struct meta_t {
     //  Small allocations are served from block-sized segments.
@@ -112,12 +132,20 @@ class reentrant_allocator_base {
     //  The segment list head. All small allocations happen via the head node
     //  if possible, or via a new head node otherwise.
     std::atomic<node_t*> head{nullptr};
+    //  The free lists, which are only used for classes of small sizes.
+    class_t classes[num_classes];
 
     explicit meta_t(reentrant_allocator_options const& options) noexcept
         : block_size{std::size_t(1) << options.block_size_lg()},
           large_size{std::size_t(1) << options.large_size_lg()} {}
   };
 
+  //  The size class of a small allocation, or 0 for a large allocation.
+  std::size_t size_class_lg(std::size_t n, std::size_t a) const noexcept;
+
+  //  Serves a small allocation from the head segment.
+  void* allocate_from_segment(std::size_t n) noexcept;
+
   //  Deduplicates code between dtor and copy-assignment.
   void obliterate() noexcept;
 
@@ -141,6 +169,11 @@ class reentrant_allocator_base {
 //  * For small sizes, serve allocations from a refcounted shared list of
 //    segments and defer deallocations to amortize calls to mmap and munmap - in
 //    other words, a shared arena list.
+//  * Round small sizes up to power-of-two size classes and recycle freed small
+//    allocations through lock-free free lists per size class, so that steady
+//    allocate/deallocate churn neither grows the arena nor calls mmap.
+//
+//  Small allocations are aligned to their size class.
 //
 //  Large allocations are aligned to page boundaries, even if the type's natural
 //  alignment is larger.
@@ -212,7 +245,7 @@ class reentrant_allocator : private detail::reentrant_allocator_base {
   //  deallocate
   template <typename..., typename S = T, if_is_not_void<S> = 0>
   FOLLY_ERASE void deallocate(T* p, std::size_t n) {
-    base::deallocate(p, n * sizeof(T));
+    base::deallocate(p, n * sizeof(T), alignof(T));
   }
 
   //  max_size
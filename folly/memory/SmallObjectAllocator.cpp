@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/memory/SmallObjectAllocator.h>
+
+#include <mutex>
+
+#include <folly/Likely.h>
+#include <folly/lang/Align.h>
+#include <folly/portability/SysMman.h>
+
+namespace folly {
+
+std::atomic<std::uintptr_t> SmallObjectAllocator::rangeBegin_{0};
+std::atomic<std::uintptr_t> SmallObjectAllocator::rangeEnd_{0};
+std::atomic<bool> SmallObjectAllocator::useForInternals_{false};
+
+namespace {
+
+constexpr std::size_t kSlabSize = 64 * 1024;
+constexpr std::size_t kRangeSize =
+    sizeof(void*) == 8 ? std::size_t(1) << 32 : std::size_t(1) << 26;
+constexpr std::size_t kNumSlabs = kRangeSize / kSlabSize;
+constexpr std::size_t kNumClasses =
+    SmallObjectAllocator::kMaxSize / SmallObjectAllocator::kAlign;
+
+std::size_t sizeClass(std::size_t size) {
+  return size == 0 ? 0 : (size - 1) / SmallObjectAllocator::kAlign;
+}
+
+std::size_t blockSize(std::size_t sizeClass) {
+  return (sizeClass + 1) * SmallObjectAllocator::kAlign;
+}
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+// The lists of one thread, or of an exited thread awaiting adoption.
+struct Cache {
+  // Only used by the owning thread
+  FreeBlock* local[kNumClasses]{};
+  char* bump[kNumClasses]{};
+  char* bumpEnd[kNumClasses]{};
+  Cache* nextOrphan{nullptr};
+
+  // Pushed to by other threads, taken back by the owning thread
+  struct alignas(hardware_destructive_interference_size) Remote {
+    std::atomic<FreeBlock*> head{nullptr};
+  };
+  Remote remote[kNumClasses];
+};
+
+struct Slabs {
+  std::mutex mutex;
+  std::uintptr_t begin{0}; // of the reserved range, once reserved
+  std::uintptr_t next{0}; // the next slab to hand out
+  bool reserved{false};
+  Cache* orphans{nullptr};
+  std::atomic<Cache*> owners[kNumSlabs]{};
+};
+
+Slabs slabs;
+
+thread_local Cache* tlCache{nullptr};
+thread_local bool tlExited{false};
+
+// Puts the thread's cache up for adoption when the thread exits.
+struct CacheReleaser {
+  ~CacheReleaser() {
+    if (tlCache) {
+      std::lock_guard<std::mutex> lock(slabs.mutex);
+      tlCache->nextOrphan = slabs.orphans;
+      slabs.orphans = tlCache;
+    }
+    tlCache = nullptr;
+    tlExited = true;
+  }
+};
+
+thread_local CacheReleaser tlReleaser;
+
+// Returns nullptr once the thread is exiting.
+Cache* getCache() {
+  if (tlExited) {
+    return nullptr;
+  }
+  (void)&tlReleaser; // ensure that it is destroyed with the thread
+  Cache* cache;
+  {
+    std::lock_guard<std::mutex> lock(slabs.mutex);
+    cache = slabs.orphans;
+    if (cache) {
+      slabs.orphans = cache->nextOrphan;
+      cache->nextOrphan = nullptr;
+    }
+  }
+  if (!cache) {
+    cache = new Cache();
+  }
+  tlCache = cache;
+  return cache;
+}
+
+// Hands out the next slab, or returns nullptr if there are no more.
+char* newSlab(Cache* cache) {
+  std::lock_guard<std::mutex> lock(slabs.mutex);
+  if (!slabs.reserved) {
+    slabs.reserved = true;
+    void* p = mmap(
+        nullptr,
+        kRangeSize + kSlabSize,
+        PROT_NONE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+    if (p == MAP_FAILED) {
+      return nullptr;
+    }
+    // Align the slabs, so that their index is a shift away.
+    auto addr = reinterpret_cast<std::uintptr_t>(p);
+    slabs.begin = (addr + kSlabSize - 1) & ~(kSlabSize - 1);
+    slabs.next = slabs.begin;
+  }
+  if (slabs.begin == 0 || slabs.next == slabs.begin + kRangeSize) {
+    return nullptr;
+  }
+  auto slab = reinterpret_cast<char*>(slabs.next);
+  if (mprotect(slab, kSlabSize, PROT_READ | PROT_WRITE) != 0) {
+    return nullptr;
+  }
+  slabs.owners[(slabs.next - slabs.begin) / kSlabSize].store(
+      cache, std::memory_order_release);
+  slabs.next += kSlabSize;
+  return slab;
+}
+
+FOLLY_NOINLINE void* allocateSlow(Cache* cache, std::size_t c) {
+  auto& local = cache->local[c];
+  local = cache->remote[c].head.exchange(nullptr, std::memory_order_acquire);
+  if (local) {
+    auto block = local;
+    local = block->next;
+    return block;
+  }
+  auto size = blockSize(c);
+  if (cache->bumpEnd[c] - cache->bump[c] < std::ptrdiff_t(size)) {
+    auto slab = newSlab(cache);
+    if (!slab) {
+      return nullptr;
+    }
+    cache->bump[c] = slab;
+    cache->bumpEnd[c] = slab + kSlabSize;
+  }
+  auto block = cache->bump[c];
+  cache->bump[c] += size;
+  return block;
+}
+
+} // namespace
+
+void* SmallObjectAllocator::allocate(std::size_t size) {
+  if (size <= kMaxSize) {
+    auto cache = tlCache;
+    if (FOLLY_UNLIKELY(!cache)) {
+      cache = getCache();
+    }
+    if (FOLLY_LIKELY(cache != nullptr)) {
+      auto c = sizeClass(size);
+      if (auto block = cache->local[c]) {
+        cache->local[c] = block->next;
+        return block;
+      }
+      if (auto block = allocateSlow(cache, c)) {
+        if (FOLLY_UNLIKELY(!rangeEnd_.load(std::memory_order_relaxed))) {
+          // The first slab: publish the range for owns().
+          rangeBegin_.store(slabs.begin, std::memory_order_relaxed);
+          rangeEnd_.store(slabs.begin + kRangeSize, std::memory_order_relaxed);
+        }
+        return block;
+      }
+    }
+  }
+  return operator_new(size);
+}
+
+void SmallObjectAllocator::deallocate(void* p, std::size_t size) noexcept {
+  if (!owns(p)) {
+    operator_delete(p, size);
+    return;
+  }
+  auto c = sizeClass(size);
+  auto block = static_cast<FreeBlock*>(p);
+  auto slab = (reinterpret_cast<std::uintptr_t>(p) -
+               rangeBegin_.load(std::memory_order_relaxed)) /
+      kSlabSize;
+  auto owner = slabs.owners[slab].load(std::memory_order_acquire);
+  if (owner == tlCache) {
+    block->next = owner->local[c];
+    owner->local[c] = block;
+    return;
+  }
+  auto& head = owner->remote[c].head;
+  auto next = head.load(std::memory_order_relaxed);
+  do {
+    block->next = next;
+  } while (!head.compare_exchange_weak(
+      next, block, std::memory_order_release, std::memory_order_relaxed));
+}
+
+} // namespace folly
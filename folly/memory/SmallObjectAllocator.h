@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <folly/lang/New.h>
+
+namespace folly {
+
+/**
+ * A thread-caching allocator for small objects that are often allocated on
+ * one thread and freed on another, such as the captures of a folly::Function
+ * that outgrow its inline storage, or the nodes of a task queue.
+ *
+ * Sizes up to kMaxSize are rounded up to a multiple of kAlign and served
+ * from per-thread free lists, one per size class, which are refilled from
+ * 64KB slabs that each belong to one thread. A block freed by the thread
+ * that owns its slab goes straight back on that thread's list. A block freed
+ * by any other thread is pushed onto a lock-free remote-free list of the
+ * owner, which takes the whole list back when its own list runs dry. So the
+ * fast paths never lock, and only a remote free is an atomic operation.
+ *
+ * Slabs are carved out of a range of address space that is reserved on first
+ * use, which keeps owns() cheap. Memory is kept for reuse and never returned
+ * to the system, and when a thread exits its lists are adopted by the next
+ * thread to need them. Larger sizes, and all sizes once the range is used up,
+ * go to operator new; deallocate() takes either.
+ *
+ * Blocks are aligned to kAlign, and deallocate() must be passed the size
+ * that was allocated.
+ *
+ * folly's own internals, such as folly::Function and the task queue of
+ * EventBase, use it only when the global policy setUseForInternals(true)
+ * opts in, as it holds on to memory for speed.
+ */
+class SmallObjectAllocator {
+ public:
+  static constexpr std::size_t kMaxSize = 256;
+  static constexpr std::size_t kAlign = 16;
+
+  static void* allocate(std::size_t size);
+  static void deallocate(void* p, std::size_t size) noexcept;
+
+  /* whether p was allocated from a slab, rather than by operator new */
+  static bool owns(void const* p) noexcept {
+    auto addr = reinterpret_cast<std::uintptr_t>(p);
+    return addr >= rangeBegin_.load(std::memory_order_relaxed) &&
+        addr < rangeEnd_.load(std::memory_order_relaxed);
+  }
+
+  /* the global policy for folly's internals; off by default */
+  static void setUseForInternals(bool use) noexcept {
+    useForInternals_.store(use, std::memory_order_relaxed);
+  }
+  static bool useForInternals() noexcept {
+    return useForInternals_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static std::atomic<std::uintptr_t> rangeBegin_;
+  static std::atomic<std::uintptr_t> rangeEnd_;
+  static std::atomic<bool> useForInternals_;
+};
+
+namespace detail {
+
+// Allocation for folly's internals: from SmallObjectAllocator if the global
+// policy opts in, and from operator new otherwise. Either way, the memory is
+// freed with SmallObjectAllocator::deallocate().
+inline void* smallObjectAllocate(std::size_t size) {
+  if (size <= SmallObjectAllocator::kMaxSize &&
+      SmallObjectAllocator::useForInternals()) {
+    return SmallObjectAllocator::allocate(size);
+  }
+  return operator_new(size);
+}
+
+} // namespace detail
+
+} // namespace folly
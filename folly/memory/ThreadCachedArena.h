@@ -58,6 +58,9 @@ class ThreadCachedArena {
   // Gets the total memory used by the arena
   size_t totalSize() const;
 
+  // Gets the alignment of every pointer returned by `allocate`
+  size_t maxAlign() const { return maxAlign_; }
+
  private:
   struct ThreadLocalPtrTag {};
 
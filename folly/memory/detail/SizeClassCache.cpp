@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/memory/detail/SizeClassCache.h>
+
+#include <algorithm>
+#include <array>
+#include <new>
+
+#include <folly/Portability.h>
+#include <folly/lang/New.h>
+
+namespace folly {
+namespace detail {
+
+namespace {
+
+constexpr bool kRecycle = !kIsSanitizeAddress;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct Cache {
+  struct SizeClass {
+    FreeBlock* head{nullptr};
+    std::size_t count{0};
+  };
+
+  static thread_local bool destroyed;
+
+  ~Cache() {
+    destroyed = true;
+    for (std::size_t i = 0; i < classes.size(); ++i) {
+      while (auto block = classes[i].head) {
+        classes[i].head = block->next;
+        operator_delete(block, (i + 1) * kSizeClassCacheGranularity);
+      }
+    }
+  }
+
+  std::array<SizeClass, kSizeClassCacheNumClasses> classes;
+};
+
+thread_local bool Cache::destroyed = false;
+
+// Null once the cache of the thread was destroyed, blocks freed by later
+// thread-local destructors then go straight to the allocator.
+Cache* cache() {
+  if (Cache::destroyed) {
+    return nullptr;
+  }
+  static thread_local Cache cache;
+  return &cache;
+}
+
+std::size_t sizeClassOf(std::size_t size) {
+  return (size + kSizeClassCacheGranularity - 1) / kSizeClassCacheGranularity -
+      1;
+}
+
+bool isCached(std::size_t size) {
+  return kRecycle && size != 0 && size <= kSizeClassCacheMaxSize;
+}
+
+} // namespace
+
+void* sizeClassCacheAllocate(std::size_t size) {
+  if (!isCached(size)) {
+    return operator_new(size);
+  }
+  auto sizeClass = sizeClassOf(size);
+  auto c = cache();
+  if (c && c->classes[sizeClass].head) {
+    auto& freeList = c->classes[sizeClass];
+    auto block = freeList.head;
+    freeList.head = block->next;
+    --freeList.count;
+    return block;
+  }
+  return operator_new((sizeClass + 1) * kSizeClassCacheGranularity);
+}
+
+void sizeClassCacheDeallocate(void* ptr, std::size_t size) noexcept {
+  if (!isCached(size)) {
+    operator_delete(ptr, size);
+    return;
+  }
+  auto sizeClass = sizeClassOf(size);
+  auto classSize = (sizeClass + 1) * kSizeClassCacheGranularity;
+  auto maxCount =
+      std::max<std::size_t>(1, kSizeClassCacheMaxBytesPerClass / classSize);
+  auto c = cache();
+  if (c && c->classes[sizeClass].count < maxCount) {
+    auto& freeList = c->classes[sizeClass];
+    freeList.head = new (ptr) FreeBlock{freeList.head};
+    ++freeList.count;
+  } else {
+    operator_delete(ptr, classSize);
+  }
+}
+
+} // namespace detail
+} // namespace folly
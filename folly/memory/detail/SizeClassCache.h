@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace folly {
+namespace detail {
+
+// Per-thread free lists for small, short-lived heap objects, such as
+// coroutine frames and future cores, which tend to be freed soon after being
+// allocated and often by the thread that allocated them.
+//
+// Blocks of up to kSizeClassCacheMaxSize bytes are rounded up to a multiple
+// of kSizeClassCacheGranularity and, once freed, kept on a free list of the
+// freeing thread for the next allocation of the same class, which saves a
+// trip to the allocator and reuses memory that is likely still in cache.
+// Each thread keeps at most kSizeClassCacheMaxBytesPerClass bytes per class.
+// Larger blocks go straight to the allocator, as do all blocks under ASAN,
+// where recycling would hide use-after-free bugs.
+//
+// Blocks have the alignment of ::operator new(), and must be freed with the
+// size they were allocated with.
+constexpr std::size_t kSizeClassCacheGranularity = 64;
+constexpr std::size_t kSizeClassCacheNumClasses = 32;
+constexpr std::size_t kSizeClassCacheMaxSize =
+    kSizeClassCacheGranularity * kSizeClassCacheNumClasses;
+constexpr std::size_t kSizeClassCacheMaxBytesPerClass = 64 * 1024;
+
+void* sizeClassCacheAllocate(std::size_t size);
+
+void sizeClassCacheDeallocate(void* ptr, std::size_t size) noexcept;
+
+} // namespace detail
+} // namespace folly
@@ -23,6 +23,8 @@
 #include <glog/logging.h>
 
 #include <folly/Memory.h>
+#include <folly/container/F14Map.h>
+#include <folly/memory/ArenaMemoryResource.h>
 #include <folly/memory/MallctlHelper.h>
 #include <folly/memory/Malloc.h>
 #include <folly/portability/GFlags.h>
@@ -319,6 +321,40 @@ TEST(Arena, Merge) {
   EXPECT_EQ(0, arena2.bytesUsed());
 }
 
+#if FOLLY_HAS_MEMORY_RESOURCE
+
+TEST(Arena, MemoryResource) {
+  SysArena arena;
+  SysArenaMemoryResource resource(arena);
+
+  folly::pmr::F14FastMap<int, int> map(&resource);
+  for (int i = 0; i < 1000; ++i) {
+    map[i] = i;
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(i, map[i]);
+  }
+  EXPECT_GE(arena.bytesUsed(), 1000 * sizeof(std::pair<int, int>));
+
+  for (size_t align : {1, 2, 8, 16, 64, 4096}) {
+    for (size_t size : {1, 10, 100, 10000}) {
+      void* p = resource.allocate(size, align);
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % align) << align;
+      memset(p, 0xaa, size);
+      resource.deallocate(p, size, align);
+    }
+  }
+
+  SysArenaMemoryResource sameArena(arena);
+  SysArena otherArena;
+  SysArenaMemoryResource other(otherArena);
+  EXPECT_TRUE(resource == sameArena);
+  EXPECT_FALSE(resource == other);
+  EXPECT_FALSE(resource == *folly::detail::std_pmr::new_delete_resource());
+}
+
+#endif // FOLLY_HAS_MEMORY_RESOURCE
+
 int main(int argc, char* argv[]) {
   testing::InitGoogleTest(&argc, argv);
   gflags::ParseCommandLineFlags(&argc, &argv, true);
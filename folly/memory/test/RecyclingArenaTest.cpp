@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/memory/RecyclingArena.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(RecyclingArena, SizeClasses) {
+  SysRecyclingArena arena;
+  size_t last = 0;
+  for (size_t size = 1; size <= SysRecyclingArena::kDefaultMaxRecycledSize;
+       ++size) {
+    auto good = arena.goodSize(size);
+    EXPECT_GE(good, size);
+    EXPECT_EQ(0, good % SysArena::kDefaultMaxAlign);
+    // At most a quarter is wasted past the first 8 classes.
+    if (size > 8 * SysArena::kDefaultMaxAlign) {
+      EXPECT_LE(good, size + size / 4 + SysArena::kDefaultMaxAlign) << size;
+    }
+    EXPECT_GE(good, last);
+    last = good;
+  }
+  EXPECT_EQ(SysRecyclingArena::kDefaultMaxRecycledSize, last);
+  EXPECT_EQ(100000, arena.goodSize(100000));
+}
+
+TEST(RecyclingArena, Recycle) {
+  SysRecyclingArena arena;
+  void* a = arena.allocate(100);
+  void* b = arena.allocate(100);
+  EXPECT_NE(a, b);
+  auto used = arena.bytesUsed();
+  EXPECT_EQ(2 * arena.goodSize(100), used);
+
+  arena.deallocate(a, 100);
+  EXPECT_EQ(arena.goodSize(100), arena.bytesFree());
+  // Reused by the same class only
+  void* c = arena.allocate(20);
+  EXPECT_NE(a, c);
+  EXPECT_EQ(a, arena.allocate(arena.goodSize(100)));
+  EXPECT_EQ(0, arena.bytesFree());
+
+  // Large allocations are freed one at a time.
+  auto total = arena.totalSize();
+  void* large = arena.allocate(100000);
+  memset(large, 0xaa, 100000);
+  EXPECT_GE(arena.totalSize(), total + 100000);
+  arena.deallocate(large, 100000);
+  EXPECT_EQ(total, arena.totalSize());
+
+  arena.clear();
+  EXPECT_EQ(0, arena.bytesUsed());
+  EXPECT_EQ(0, arena.bytesFree());
+}
+
+TEST(RecyclingArena, BoundedFootprint) {
+  // Random churn with a bounded number of live allocations does not grow
+  // the arena past the first rounds.
+  SysRecyclingArena arena;
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<size_t> sizes(1, 2000);
+  std::vector<std::pair<char*, size_t>> live;
+  size_t footprint = 0;
+  for (int round = 0; round < 100; ++round) {
+    while (live.size() < 200) {
+      auto size = sizes(rng);
+      auto p = static_cast<char*>(arena.allocate(size));
+      memset(p, int(live.size()), size);
+      live.emplace_back(p, size);
+    }
+    std::shuffle(live.begin(), live.end(), rng);
+    while (live.size() > 100) {
+      arena.deallocate(live.back().first, live.back().second);
+      live.pop_back();
+    }
+    if (round == 20) {
+      footprint = arena.totalSize();
+    }
+  }
+  EXPECT_LT(arena.totalSize(), footprint * 2);
+  for (auto& [p, size] : live) {
+    arena.deallocate(p, size);
+  }
+  EXPECT_EQ(0, arena.bytesUsed());
+  EXPECT_TRUE(arena.shouldCompact());
+}
+
+TEST(RecyclingArena, Allocator) {
+  using Vector = std::vector<int, SysRecyclingArenaAllocator<int>>;
+  using Map = std::map<
+      int,
+      Vector,
+      std::less<int>,
+      SysRecyclingArenaAllocator<std::pair<const int, Vector>>>;
+
+  SysRecyclingArena arena;
+  Map map{SysRecyclingArenaAllocator<int>(arena)};
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 1000; ++i) {
+      map.emplace(i, SysRecyclingArenaAllocator<int>(arena))
+          .first->second.assign(size_t(i % 50), i);
+    }
+    for (int i = 0; i < 1000; ++i) {
+      EXPECT_EQ(size_t(i % 50), map.at(i).size());
+    }
+    map.clear();
+    EXPECT_EQ(0, arena.bytesUsed());
+  }
+}
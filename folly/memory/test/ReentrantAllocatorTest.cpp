@@ -58,6 +58,46 @@ TEST_F(ReentrantAllocatorTest, small) {
   }
 }
 
+TEST_F(ReentrantAllocatorTest, recycle) {
+  folly::reentrant_allocator<char> a{folly::reentrant_allocator_options{}};
+  auto const p = a.allocate(100);
+  a.deallocate(p, 100);
+  //  the same size class
+  auto const q = a.allocate(128);
+  EXPECT_EQ(p, q);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(q) % 128);
+  //  another size class
+  auto const r = a.allocate(100);
+  EXPECT_NE(p, r);
+  a.deallocate(q, 128);
+  a.deallocate(r, 100);
+}
+
+TEST_F(ReentrantAllocatorTest, recycle_threads) {
+  folly::reentrant_allocator<void> a{folly::reentrant_allocator_options{}};
+  std::vector<std::thread> threads{4};
+  for (auto& th : threads) {
+    th = std::thread([a] {
+      folly::reentrant_allocator<char> alloc{a};
+      std::vector<char*> ptrs;
+      for (auto round = 0u; round < 100; ++round) {
+        for (auto i = 0u; i < 100; ++i) {
+          auto const p = alloc.allocate(8 + i);
+          p[0] = 'a';
+          ptrs.push_back(p);
+        }
+        for (auto i = 0u; i < 100; ++i) {
+          alloc.deallocate(ptrs[i], 8 + i);
+        }
+        ptrs.clear();
+      }
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+}
+
 TEST_F(ReentrantAllocatorTest, large) {
   constexpr size_t const large_size_lg = 6;
   struct alignas(1u << large_size_lg) type : std::tuple<size_t> {
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/memory/SmallObjectAllocator.h>
+
+#include <array>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <folly/Function.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(SmallObjectAllocator, Reuse) {
+  void* a = SmallObjectAllocator::allocate(24);
+  EXPECT_TRUE(SmallObjectAllocator::owns(a));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(a) % SmallObjectAllocator::kAlign);
+  memset(a, 0xaa, 24);
+  SmallObjectAllocator::deallocate(a, 24);
+  // The same size class
+  EXPECT_EQ(a, SmallObjectAllocator::allocate(32));
+  SmallObjectAllocator::deallocate(a, 32);
+}
+
+TEST(SmallObjectAllocator, Large) {
+  void* p = SmallObjectAllocator::allocate(SmallObjectAllocator::kMaxSize + 1);
+  EXPECT_FALSE(SmallObjectAllocator::owns(p));
+  SmallObjectAllocator::deallocate(p, SmallObjectAllocator::kMaxSize + 1);
+
+  // deallocate() also takes memory from operator new.
+  void* q = operator_new(64);
+  EXPECT_FALSE(SmallObjectAllocator::owns(q));
+  SmallObjectAllocator::deallocate(q, 64);
+}
+
+TEST(SmallObjectAllocator, RemoteFree) {
+  constexpr size_t kCount = 1000;
+  std::vector<void*> blocks;
+  for (size_t i = 0; i < kCount; ++i) {
+    blocks.push_back(SmallObjectAllocator::allocate(48));
+  }
+  std::thread([&] {
+    for (auto p : blocks) {
+      SmallObjectAllocator::deallocate(p, 48);
+    }
+  }).join();
+  // Taken back by the owner once its own list runs dry
+  std::set<void*> freed(blocks.begin(), blocks.end());
+  for (size_t i = 0; i < kCount; ++i) {
+    void* p = SmallObjectAllocator::allocate(48);
+    EXPECT_EQ(1, freed.count(p));
+    blocks[i] = p;
+  }
+  for (auto p : blocks) {
+    SmallObjectAllocator::deallocate(p, 48);
+  }
+}
+
+TEST(SmallObjectAllocator, ThreadExit) {
+  void* p = nullptr;
+  std::thread([&] { p = SmallObjectAllocator::allocate(200); }).join();
+  EXPECT_TRUE(SmallObjectAllocator::owns(p));
+  // Freed to the lists of the exited thread, which the next thread adopts
+  SmallObjectAllocator::deallocate(p, 200);
+  std::thread([&] {
+    void* q = SmallObjectAllocator::allocate(200);
+    EXPECT_TRUE(SmallObjectAllocator::owns(q));
+    SmallObjectAllocator::deallocate(q, 200);
+  }).join();
+}
+
+TEST(SmallObjectAllocator, ConcurrentRemoteFree) {
+  constexpr size_t kThreads = 4;
+  constexpr size_t kRounds = 10000;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back([] {
+      std::vector<void*> blocks;
+      for (size_t i = 0; i < kRounds; ++i) {
+        blocks.push_back(SmallObjectAllocator::allocate(16 + i % 100));
+      }
+      std::thread([&] {
+        for (size_t i = 0; i < kRounds; ++i) {
+          SmallObjectAllocator::deallocate(blocks[i], 16 + i % 100);
+        }
+      }).join();
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+TEST(SmallObjectAllocator, Function) {
+  SmallObjectAllocator::setUseForInternals(true);
+  std::array<int64_t, 8> big{};
+  big[7] = 7;
+  auto trivial = Function<int64_t()>([big] { return big[7]; });
+  std::vector<int64_t> vec{1, 2, 3};
+  auto nontrivial = Function<size_t()>([big, vec] { return vec.size(); });
+  SmallObjectAllocator::setUseForInternals(false);
+
+  EXPECT_GT(trivial.heapAllocatedMemory(), 0);
+  EXPECT_GT(nontrivial.heapAllocatedMemory(), 0);
+  // Freed on another thread
+  std::thread([&] {
+    EXPECT_EQ(7, trivial());
+    EXPECT_EQ(3, nontrivial());
+    trivial = nullptr;
+    nontrivial = nullptr;
+  }).join();
+
+  // Allocated with the policy off, freed with it on
+  auto off = Function<size_t()>([big, vec] { return vec.size(); });
+  SmallObjectAllocator::setUseForInternals(true);
+  off = nullptr;
+  SmallObjectAllocator::setUseForInternals(false);
+}
@@ -23,6 +23,7 @@
 #include <random>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <glog/logging.h>
 
@@ -30,6 +31,7 @@
 #include <folly/Memory.h>
 #include <folly/Range.h>
 #include <folly/lang/Align.h>
+#include <folly/memory/ArenaMemoryResource.h>
 #include <folly/portability/GTest.h>
 
 using namespace folly;
@@ -177,6 +179,34 @@ TEST(ThreadCachedArena, ThreadCachedArenaAllocator) {
   }
 }
 
+#if FOLLY_HAS_MEMORY_RESOURCE
+
+TEST(ThreadCachedArena, MemoryResource) {
+  ThreadCachedArena arena;
+  ThreadCachedArenaMemoryResource resource(arena);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      folly::detail::std_pmr::vector<int> v(&resource);
+      for (int i = 0; i < 10000; ++i) {
+        v.push_back(i * t);
+      }
+      for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(i * t, v[i]);
+      }
+      void* p = resource.allocate(3, 256);
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % 256);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_GE(arena.totalSize(), 4 * 10000 * sizeof(int));
+}
+
+#endif // FOLLY_HAS_MEMORY_RESOURCE
+
 namespace {
 
 static const int kNumValues = 10000;
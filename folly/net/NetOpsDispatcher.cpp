@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <cerrno>
+
 #include <folly/net/NetOps.h>
 #include <folly/net/NetOpsDispatcher.h>
 
@@ -111,6 +113,22 @@ int Dispatcher::sendmmsg(
   return folly::netops::sendmmsg(socket, msgvec, vlen, flags);
 }
 
+void Dispatcher::sendmsgBatch(MsgOp* ops, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    auto& op = ops[i];
+    op.result = sendmsg(op.socket, op.message, op.flags);
+    op.error = op.result < 0 ? errno : 0;
+  }
+}
+
+void Dispatcher::recvmsgBatch(MsgOp* ops, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    auto& op = ops[i];
+    op.result = recvmsg(op.socket, op.message, op.flags);
+    op.error = op.result < 0 ? errno : 0;
+  }
+}
+
 ssize_t Dispatcher::sendto(
     NetworkSocket s,
     const void* buf,
@@ -31,6 +31,20 @@ namespace netops {
  */
 class Dispatcher {
  public:
+  /**
+   * One sendmsg() or recvmsg() call of a batch, see sendmsgBatch().
+   */
+  struct MsgOp {
+    NetworkSocket socket;
+    msghdr* message{nullptr};
+    int flags{0};
+
+    // Set by the batch: what sendmsg() or recvmsg() returned, and errno if
+    // that is negative.
+    ssize_t result{0};
+    int error{0};
+  };
+
   static Dispatcher* getDefaultInstance();
 
   virtual NetworkSocket accept(
@@ -72,6 +86,19 @@ class Dispatcher {
       NetworkSocket socket, const msghdr* message, int flags);
   virtual int sendmmsg(
       NetworkSocket socket, mmsghdr* msgvec, unsigned int vlen, int flags);
+
+  /**
+   * Performs sendmsg() or recvmsg() for each of `ops`, which may be on
+   * different sockets, and sets their result and error.
+   *
+   * The default implementation makes one call per op. Implementations that
+   * can submit the ops together, such as IoUringNetOpsDispatcher, do so in a
+   * single system call. Ops on the same socket are performed in order, but
+   * an op failing doesn't prevent the following ones from being tried, so
+   * the sockets should be non-blocking.
+   */
+  virtual void sendmsgBatch(MsgOp* ops, size_t count);
+  virtual void recvmsgBatch(MsgOp* ops, size_t count);
   virtual int setsockopt(
       NetworkSocket s,
       int level,
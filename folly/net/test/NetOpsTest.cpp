@@ -16,8 +16,11 @@
 
 #include <folly/net/NetOps.h>
 
+#include <cerrno>
+
 #include <glog/logging.h>
 
+#include <folly/net/NetOpsDispatcher.h>
 #include <folly/net/NetworkSocket.h>
 #include <folly/portability/GTest.h>
 
@@ -55,3 +58,59 @@ TEST_F(NetOpsTest, socketpair) {
   textr.resize(textw.size());
   EXPECT_EQ(textw, textr);
 }
+
+#ifndef _WIN32
+TEST_F(NetOpsTest, dispatcherMsgBatch) {
+  using MsgOp = folly::netops::Dispatcher::MsgOp;
+  auto dispatcher = folly::netops::Dispatcher::getDefaultInstance();
+
+  // A batch spanning two sockets
+  folly::NetworkSocket pairs[2][2];
+  for (auto& pair : pairs) {
+    PCHECK(0 == folly::netops::socketpair(AF_UNIX, SOCK_DGRAM, 0, pair));
+    PCHECK(0 == folly::netops::set_socket_non_blocking(pair[1]));
+  }
+
+  std::string texts[3] = {"first", "second", "third"};
+  iovec sendIovs[3];
+  msghdr sendMsgs[3] = {};
+  MsgOp sendOps[3];
+  for (size_t i = 0; i < 3; ++i) {
+    sendIovs[i] = {&texts[i][0], texts[i].size()};
+    sendMsgs[i].msg_iov = &sendIovs[i];
+    sendMsgs[i].msg_iovlen = 1;
+    sendOps[i].socket = pairs[i == 1 ? 1 : 0][0];
+    sendOps[i].message = &sendMsgs[i];
+  }
+  dispatcher->sendmsgBatch(sendOps, 3);
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(ssize_t(texts[i].size()), sendOps[i].result);
+    EXPECT_EQ(0, sendOps[i].error);
+  }
+
+  // Receive both of the first socket's messages, then one more, which isn't
+  // there.
+  char bufs[4][16];
+  iovec recvIovs[4];
+  msghdr recvMsgs[4] = {};
+  MsgOp recvOps[4];
+  for (size_t i = 0; i < 4; ++i) {
+    recvIovs[i] = {bufs[i], sizeof(bufs[i])};
+    recvMsgs[i].msg_iov = &recvIovs[i];
+    recvMsgs[i].msg_iovlen = 1;
+    recvOps[i].socket = pairs[i == 1 ? 1 : 0][1];
+    recvOps[i].message = &recvMsgs[i];
+  }
+  dispatcher->recvmsgBatch(recvOps, 4);
+  EXPECT_EQ("first", std::string(bufs[0], size_t(recvOps[0].result)));
+  EXPECT_EQ("second", std::string(bufs[1], size_t(recvOps[1].result)));
+  EXPECT_EQ("third", std::string(bufs[2], size_t(recvOps[2].result)));
+  EXPECT_EQ(-1, recvOps[3].result);
+  EXPECT_TRUE(recvOps[3].error == EAGAIN || recvOps[3].error == EWOULDBLOCK);
+
+  for (auto& pair : pairs) {
+    folly::netops::close(pair[0]);
+    folly::netops::close(pair[1]);
+  }
+}
+#endif
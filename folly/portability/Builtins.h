@@ -51,6 +51,17 @@ FOLLY_ALWAYS_INLINE void __builtin___clear_cache(char* begin, char* end) {
   }
 }
 
+FOLLY_ALWAYS_INLINE void __builtin_prefetch(
+    const void* addr, int /* rw */ = 0, int /* locality */ = 3) {
+#if defined(_M_X64) || defined(_M_IX86)
+  _mm_prefetch(static_cast<const char*>(addr), _MM_HINT_T0);
+#elif defined(_M_ARM64) || defined(_M_ARM)
+  __prefetch(addr);
+#else
+  (void)addr;
+#endif
+}
+
 #if !defined(_MSC_VER) || !defined(FOLLY_DETAIL_MSC_BUILTIN_SUPPORT)
 FOLLY_ALWAYS_INLINE int __builtin_clz(unsigned int x) {
   unsigned long index;
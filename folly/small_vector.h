@@ -27,6 +27,7 @@
 #include <cstring>
 #include <iterator>
 #include <memory>
+#include <ratio>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
@@ -86,6 +87,15 @@ struct item_in_situ_only {
   };
 };
 
+struct item_growth_factor {
+  template <typename T>
+  using get = typename T::growth_factor;
+  template <typename T>
+  struct set {
+    using growth_factor = T;
+  };
+};
+
 template <template <typename> class F, typename... T>
 constexpr size_t last_matching_() {
   bool const values[] = {is_detected_v<F, T>..., false};
@@ -113,7 +123,8 @@ using merge =
 template <typename... Policy>
 struct merge //
     : detail::merge<detail::item_size_type, Policy...>,
-      detail::merge<detail::item_in_situ_only, Policy...> {};
+      detail::merge<detail::item_in_situ_only, Policy...>,
+      detail::merge<detail::item_growth_factor, Policy...> {};
 
 template <typename SizeType>
 struct policy_size_type {
@@ -125,6 +136,14 @@ struct policy_in_situ_only {
   using in_situ_only = std::bool_constant<Value>;
 };
 
+//  The factor by which the capacity grows when an insertion runs out of it,
+//  as a std::ratio; an extra element is always added. The default is 3/2.
+template <std::intmax_t Num, std::intmax_t Den = 1>
+struct policy_growth_factor {
+  static_assert(Num > Den && Den > 0, "must grow");
+  using growth_factor = std::ratio<Num, Den>;
+};
+
 } // namespace small_vector_policy
 
 //////////////////////////////////////////////////////////////////////
@@ -437,6 +456,7 @@ struct small_vector_base {
   using Policy = small_vector_policy::merge<
       small_vector_policy::policy_size_type<size_t>,
       small_vector_policy::policy_in_situ_only<false>,
+      small_vector_policy::policy_growth_factor<3, 2>,
       conditional_t<std::is_void<InPolicy>::value, tag_t<>, InPolicy>>;
 
   /*
@@ -457,6 +477,8 @@ struct small_vector_base {
       small_vector<Value, RequestedMaxInline, InPolicy>,
       ActualSizePolicy>
       type;
+
+  using growth_factor = typename Policy::growth_factor;
 };
 
 inline void* unshiftPointer(void* p, size_t sizeBytes) {
@@ -475,6 +497,8 @@ class small_vector
           type {
   typedef typename detail::
       small_vector_base<Value, RequestedMaxInline, Policy>::type BaseType;
+  using GrowthFactor = typename detail::
+      small_vector_base<Value, RequestedMaxInline, Policy>::growth_factor;
   typedef typename BaseType::InternalSizeType InternalSizeType;
 
   /*
@@ -831,6 +855,29 @@ class small_vector
     return MaxInline;
   }
 
+  /**
+   * Bytes allocated on the heap for the elements, or 0 while they are
+   * stored inline.
+   */
+  std::size_t getAllocatedMemorySize() const {
+    if (!this->isExtern() || !u.pdata_.heap_) {
+      return 0;
+    }
+    auto extraBytes = hasCapacity() ? u.pdata_.allocationExtraBytes() : 0;
+    return capacity() * sizeof(value_type) + extraBytes;
+  }
+
+  /**
+   * Calls visitor(allocationSize, allocationCount) for the heap allocation,
+   * if any, like F14's visitAllocationClasses().
+   */
+  template <typename V>
+  void visitAllocationClasses(V&& visitor) const {
+    if (auto bytes = getAllocatedMemorySize()) {
+      visitor(bytes, 1);
+    }
+  }
+
   void shrink_to_fit() {
     if (!this->isExtern()) {
       return;
@@ -1159,11 +1206,11 @@ class small_vector
    */
   size_type computeNewSize() const {
     size_t c = capacity();
-    if (!checked_mul(&c, c, size_t(3))) {
+    if (!checked_mul(&c, c, size_t(GrowthFactor::num))) {
       throw_exception<std::length_error>(
           "Requested new size exceeds size representable by size_type");
     }
-    c = (c / 2) + 1;
+    c = (c / size_t(GrowthFactor::den)) + 1;
     return static_cast<size_type>(std::min<size_t>(c, max_size()));
   }
 
@@ -1238,6 +1285,19 @@ class small_vector
     // a multiple of the value size we cannot use them anyway.
     const size_t sizeBytes =
         newCapacity * sizeof(value_type) + allocationExtraBytes;
+
+    if constexpr (IsRelocatable<value_type>::value) {
+      // Relocatable elements may be moved with the heap allocation itself.
+      if (this->isExtern() && u.pdata_.heap_ && hasCapacity() &&
+          u.pdata_.allocationExtraBytes() == allocationExtraBytes &&
+          reallocateRelocatable(sizeBytes, newCapacity, insert, pos)) {
+        if (insert) {
+          emplaceFunc(begin() + pos);
+        }
+        return;
+      }
+    }
+
     void* newh = checkedMalloc(sizeBytes);
     value_type* newp = static_cast<value_type*>(
         heapifyCapacity ? detail::shiftPointer(newh, kHeapifyCapacitySize)
@@ -1247,7 +1307,24 @@ class small_vector
       auto rollback = makeGuard([&] { //
         sizedFree(newh, sizeBytes);
       });
-      if (insert) {
+      if constexpr (IsRelocatable<value_type>::value) {
+        // The new element first, for the strong exception guarantee, and
+        // then the old elements relocated around it, which can't throw.
+        if (insert) {
+          emplaceFunc(newp + pos);
+        }
+        if (size()) {
+          auto const n = insert ? pos : size();
+          std::memcpy(
+              static_cast<void*>(newp),
+              static_cast<void const*>(begin()),
+              n * sizeof(value_type));
+          std::memcpy(
+              static_cast<void*>(newp + n + insert),
+              static_cast<void const*>(begin() + n),
+              (size() - n) * sizeof(value_type));
+        }
+      } else if (insert) {
         // move and insert the new element
         this->moveToUninitializedEmplace(
             begin(), end(), newp, pos, std::forward<EmplaceFunc>(emplaceFunc));
@@ -1259,7 +1336,9 @@ class small_vector
       }
       rollback.dismiss();
     }
-    std::destroy(begin(), end());
+    if constexpr (!IsRelocatable<value_type>::value) {
+      std::destroy(begin(), end());
+    }
     freeHeap();
     // Store shifted pointer if capacity is heapified
     u.pdata_.heap_ = newp;
@@ -1268,6 +1347,37 @@ class small_vector
     this->setCapacity(newCapacity);
   }
 
+  /*
+   * Grows the heap allocation of relocatable elements to sizeBytes by
+   * expanding it in place with jemalloc, or else by reallocating it, like
+   * fbvector. An insertion may only use the former, as the new element may
+   * alias an old one, and only at the end. The new element is left to the
+   * caller. Returns false if the elements weren't moved.
+   */
+  bool reallocateRelocatable(
+      size_t sizeBytes, size_type newCapacity, bool insert, size_type pos) {
+    auto const extraBytes = u.pdata_.allocationExtraBytes();
+    auto const oldBytes = capacity() * sizeof(value_type) + extraBytes;
+    void* oldh = detail::unshiftPointer(u.pdata_.heap_, extraBytes);
+    if (insert && pos != size()) {
+      return false;
+    }
+    if (usingJEMalloc() && oldBytes >= jemallocMinInPlaceExpandable &&
+        xallocx(oldh, sizeBytes, 0, 0) >= sizeBytes) {
+      setCapacity(newCapacity);
+      return true;
+    }
+    if (insert) {
+      return false;
+    }
+    void* newh = smartRealloc(
+        oldh, size() * sizeof(value_type) + extraBytes, oldBytes, sizeBytes);
+    u.pdata_.heap_ =
+        static_cast<value_type*>(detail::shiftPointer(newh, extraBytes));
+    setCapacity(newCapacity);
+    return true;
+  }
+
   /*
    * This will set the capacity field, stored inline in the storage_ field
    * if there is sufficient room to store it.
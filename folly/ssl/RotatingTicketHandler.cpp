@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/ssl/RotatingTicketHandler.h>
+
+#include <cstring>
+
+#include <folly/ssl/OpenSSLHash.h>
+
+namespace folly {
+namespace ssl {
+
+namespace {
+
+template <size_t N>
+void deriveKeyPart(
+    std::array<uint8_t, N>& out, ByteRange secret, StringPiece label) {
+  std::array<uint8_t, 32> digest;
+  OpenSSLHash::hmac_sha256(range(digest), secret, ByteRange(label));
+  static_assert(N <= sizeof(digest), "");
+  std::memcpy(out.data(), digest.data(), N);
+}
+
+} // namespace
+
+RotatingTicketHandler::TicketKey RotatingTicketHandler::TicketKey::fromSecret(
+    ByteRange secret) {
+  TicketKey key;
+  deriveKeyPart(key.name, secret, "ticket key name");
+  deriveKeyPart(key.aesKey, secret, "ticket aes key");
+  deriveKeyPart(key.hmacKey, secret, "ticket hmac key");
+  return key;
+}
+
+RotatingTicketHandler::RotatingTicketHandler(std::vector<TicketKey> keys) {
+  setTicketKeys(std::move(keys));
+}
+
+void RotatingTicketHandler::setTicketKeys(std::vector<TicketKey> keys) {
+  auto newKeys =
+      std::make_shared<const std::vector<TicketKey>>(std::move(keys));
+  keys_.wlock()->swap(newKeys);
+}
+
+int RotatingTicketHandler::ticketCallback(
+    SSL* /* ssl */,
+    unsigned char* keyName,
+    unsigned char* iv,
+    EVP_CIPHER_CTX* cipherCtx,
+    HMAC_CTX* hmacCtx,
+    int encrypt) {
+  auto keys = keys_.copy();
+  if (!keys) {
+    return 0;
+  }
+
+  const EVP_CIPHER* cipher = EVP_aes_256_cbc();
+  if (encrypt) {
+    if (keys->empty()) {
+      return 0;
+    }
+    const auto& key = keys->front();
+    if (RAND_bytes(iv, EVP_CIPHER_iv_length(cipher)) != 1) {
+      return -1;
+    }
+    std::memcpy(keyName, key.name.data(), key.name.size());
+    if (EVP_EncryptInit_ex(
+            cipherCtx, cipher, nullptr, key.aesKey.data(), iv) != 1 ||
+        HMAC_Init_ex(
+            hmacCtx,
+            key.hmacKey.data(),
+            int(key.hmacKey.size()),
+            EVP_sha256(),
+            nullptr) != 1) {
+      return -1;
+    }
+    return 1;
+  }
+
+  for (size_t i = 0; i < keys->size(); ++i) {
+    const auto& key = (*keys)[i];
+    if (std::memcmp(keyName, key.name.data(), key.name.size()) != 0) {
+      continue;
+    }
+    if (HMAC_Init_ex(
+            hmacCtx,
+            key.hmacKey.data(),
+            int(key.hmacKey.size()),
+            EVP_sha256(),
+            nullptr) != 1 ||
+        EVP_DecryptInit_ex(
+            cipherCtx, cipher, nullptr, key.aesKey.data(), iv) != 1) {
+      return -1;
+    }
+    // Renew tickets that were encrypted with a key on its way out.
+    return i == 0 ? 1 : 2;
+  }
+  return 0;
+}
+
+} // namespace ssl
+} // namespace folly
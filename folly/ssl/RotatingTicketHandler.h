@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <folly/Range.h>
+#include <folly/Synchronized.h>
+#include <folly/ssl/OpenSSLTicketHandler.h>
+
+namespace folly {
+namespace ssl {
+
+/**
+ * An OpenSSLTicketHandler that encrypts session tickets with the first of a
+ * list of keys, and accepts tickets encrypted with any of them.
+ *
+ * To rotate keys, call setTicketKeys() with the new key first, followed by
+ * the keys whose tickets should still be accepted, usually the previous
+ * first key. A ticket that was encrypted with a key other than the first one
+ * is replaced by a new ticket when the session is resumed.
+ *
+ * Unlike OpenSSLTicketHandlers in general, a RotatingTicketHandler may be
+ * used by handshakes on several threads at once, and setTicketKeys() may be
+ * called from any thread.
+ */
+class RotatingTicketHandler : public OpenSSLTicketHandler {
+ public:
+  struct TicketKey {
+    std::array<uint8_t, 16> name;
+    std::array<uint8_t, 32> aesKey;
+    std::array<uint8_t, 32> hmacKey;
+
+    /**
+     * Derives a key from a secret, e.g. one shared by all the servers that
+     * should accept each other's tickets.
+     */
+    static TicketKey fromSecret(ByteRange secret);
+  };
+
+  RotatingTicketHandler() = default;
+  explicit RotatingTicketHandler(std::vector<TicketKey> keys);
+
+  /**
+   * Sets the keys, first the one to encrypt new tickets with. No tickets are
+   * issued while there are no keys.
+   */
+  void setTicketKeys(std::vector<TicketKey> keys);
+
+  int ticketCallback(
+      SSL* ssl,
+      unsigned char* keyName,
+      unsigned char* iv,
+      EVP_CIPHER_CTX* cipherCtx,
+      HMAC_CTX* hmacCtx,
+      int encrypt) override;
+
+ private:
+  folly::Synchronized<std::shared_ptr<const std::vector<TicketKey>>> keys_;
+};
+
+} // namespace ssl
+} // namespace folly
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/ssl/ServerSessionCache.h>
+
+namespace folly {
+namespace ssl {
+
+namespace {
+
+std::string toKey(ByteRange sessionId) {
+  return std::string(
+      reinterpret_cast<const char*>(sessionId.data()), sessionId.size());
+}
+
+} // namespace
+
+ServerSessionCache::ServerSessionCache() : ServerSessionCache(Options()) {}
+
+ServerSessionCache::ServerSessionCache(Options options) : options_(options) {}
+
+void ServerSessionCache::add(SSLSessionUniquePtr session) {
+  unsigned int idLength = 0;
+  const unsigned char* id = SSL_SESSION_get_id(session.get(), &idLength);
+  if (idLength == 0) {
+    return;
+  }
+
+  auto now = Clock::now();
+  if (sessions_.size() >= options_.maxSize) {
+    removeExpired(now);
+    if (sessions_.size() >= options_.maxSize) {
+      return;
+    }
+  }
+  sessions_.insert_or_assign(
+      toKey(ByteRange(id, idLength)),
+      Entry{std::move(session), now + options_.timeout});
+}
+
+SSLSessionUniquePtr ServerSessionCache::get(ByteRange sessionId) {
+  auto key = toKey(sessionId);
+  auto it = sessions_.find(key);
+  if (it == sessions_.cend()) {
+    return nullptr;
+  }
+  if (it->second.expiry <= Clock::now()) {
+    sessions_.erase(key);
+    return nullptr;
+  }
+  SSL_SESSION* session = it->second.session.get();
+  SSL_SESSION_up_ref(session);
+  return SSLSessionUniquePtr(session);
+}
+
+void ServerSessionCache::remove(ByteRange sessionId) {
+  sessions_.erase(toKey(sessionId));
+}
+
+void ServerSessionCache::removeExpired(Clock::time_point now) {
+  if (sweeping_.exchange(true, std::memory_order_acquire)) {
+    return;
+  }
+  for (auto it = sessions_.cbegin(); it != sessions_.cend();) {
+    if (it->second.expiry <= now) {
+      it = sessions_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  sweeping_.store(false, std::memory_order_release);
+}
+
+} // namespace ssl
+} // namespace folly
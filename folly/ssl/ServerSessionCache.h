@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include <folly/Range.h>
+#include <folly/concurrency/ConcurrentHashMap.h>
+#include <folly/portability/OpenSSL.h>
+#include <folly/ssl/OpenSSLPtrTypes.h>
+
+namespace folly {
+namespace ssl {
+
+/**
+ * A server side session cache that SSLContexts can use in place of OpenSSL's
+ * internal one; see SSLContext::setServerSessionCache().
+ *
+ * OpenSSL's internal cache serializes every lookup and insertion on a single
+ * lock per SSL_CTX, which handshakes on all IO threads contend on. This cache
+ * is a ConcurrentHashMap instead: lookups don't lock, and insertions and
+ * removals only lock one of its shards.
+ *
+ * Sessions expire options.timeout after they were added. An expired session
+ * is dropped when it is looked up, and all expired sessions are swept out
+ * when the cache is full, i.e. holds options.maxSize sessions. New sessions
+ * aren't cached while the cache is still full after that.
+ */
+class ServerSessionCache {
+ public:
+  struct Options {
+    std::chrono::seconds timeout{std::chrono::hours(2)};
+    size_t maxSize{20 * 1024};
+  };
+
+  ServerSessionCache();
+  explicit ServerSessionCache(Options options);
+
+  ServerSessionCache(const ServerSessionCache&) = delete;
+  ServerSessionCache& operator=(const ServerSessionCache&) = delete;
+
+  /**
+   * Caches the session under its session ID.
+   */
+  void add(SSLSessionUniquePtr session);
+
+  /**
+   * Returns a new reference to the session with the given ID, or nullptr if
+   * there is none or it has expired.
+   */
+  SSLSessionUniquePtr get(ByteRange sessionId);
+
+  void remove(ByteRange sessionId);
+
+  size_t size() const { return sessions_.size(); }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    SSLSessionUniquePtr session;
+    Clock::time_point expiry;
+  };
+
+  void removeExpired(Clock::time_point now);
+
+  const Options options_;
+  ConcurrentHashMap<std::string, Entry> sessions_;
+  // Set while a thread is sweeping out the expired sessions, so that threads
+  // adding to a full cache don't all do it at once.
+  std::atomic<bool> sweeping_{false};
+};
+
+} // namespace ssl
+} // namespace folly
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/ssl/ServerSessionCache.h>
+
+#include <string>
+
+#include <folly/portability/GTest.h>
+#include <folly/portability/OpenSSL.h>
+#include <folly/ssl/OpenSSLPtrTypes.h>
+
+using folly::ByteRange;
+using folly::StringPiece;
+using folly::ssl::ServerSessionCache;
+using folly::ssl::SSLSessionUniquePtr;
+
+namespace {
+
+SSLSessionUniquePtr makeSession(StringPiece id) {
+  SSLSessionUniquePtr session(SSL_SESSION_new());
+  SSL_SESSION_set1_id(
+      session.get(),
+      reinterpret_cast<const unsigned char*>(id.data()),
+      static_cast<unsigned int>(id.size()));
+  return session;
+}
+
+} // namespace
+
+TEST(ServerSessionCacheTest, AddGetRemove) {
+  ServerSessionCache cache;
+  auto session = makeSession("session1");
+  auto rawSession = session.get();
+  cache.add(std::move(session));
+  EXPECT_EQ(1, cache.size());
+
+  auto found = cache.get(ByteRange(StringPiece("session1")));
+  EXPECT_EQ(rawSession, found.get());
+  // Sessions stay cached until removed.
+  EXPECT_EQ(rawSession, cache.get(ByteRange(StringPiece("session1"))).get());
+  EXPECT_EQ(nullptr, cache.get(ByteRange(StringPiece("session2"))));
+
+  cache.remove(ByteRange(StringPiece("session1")));
+  EXPECT_EQ(nullptr, cache.get(ByteRange(StringPiece("session1"))));
+  EXPECT_EQ(0, cache.size());
+  // The reference that was handed out is still valid.
+  EXPECT_EQ(rawSession, found.get());
+}
+
+TEST(ServerSessionCacheTest, SessionWithoutId) {
+  ServerSessionCache cache;
+  cache.add(SSLSessionUniquePtr(SSL_SESSION_new()));
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST(ServerSessionCacheTest, Expiry) {
+  ServerSessionCache::Options options;
+  options.timeout = std::chrono::seconds(0);
+  ServerSessionCache cache(options);
+  cache.add(makeSession("session1"));
+  EXPECT_EQ(nullptr, cache.get(ByteRange(StringPiece("session1"))));
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST(ServerSessionCacheTest, MaxSize) {
+  ServerSessionCache::Options options;
+  options.maxSize = 2;
+  ServerSessionCache cache(options);
+  cache.add(makeSession("session1"));
+  cache.add(makeSession("session2"));
+  cache.add(makeSession("session3"));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(nullptr, cache.get(ByteRange(StringPiece("session3"))));
+
+  cache.remove(ByteRange(StringPiece("session1")));
+  cache.add(makeSession("session3"));
+  EXPECT_NE(nullptr, cache.get(ByteRange(StringPiece("session3"))));
+}
+
+TEST(ServerSessionCacheTest, FullCacheDropsExpiredSessions) {
+  ServerSessionCache::Options options;
+  options.timeout = std::chrono::seconds(0);
+  options.maxSize = 2;
+  ServerSessionCache cache(options);
+  cache.add(makeSession("session1"));
+  cache.add(makeSession("session2"));
+  cache.add(makeSession("session3"));
+  // Adding the third session swept out the first two, which had expired.
+  EXPECT_EQ(1, cache.size());
+}
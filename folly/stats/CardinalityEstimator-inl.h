@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+namespace folly {
+
+template <typename ClockT>
+SlidingWindowCardinalityEstimator<ClockT>::SlidingWindowCardinalityEstimator(
+    Duration windowDuration, size_t nWindows, size_t precision)
+    : bufferedSlidingWindow_(nWindows, windowDuration, 1000, precision) {}
+
+template <typename ClockT>
+double SlidingWindowCardinalityEstimator<ClockT>::estimate(TimePoint now) {
+  return getSketch(now).estimate();
+}
+
+template <typename ClockT>
+void SlidingWindowCardinalityEstimator<ClockT>::addValue(
+    uint64_t key, TimePoint now) {
+  bufferedSlidingWindow_.append(key, now);
+}
+
+} // namespace folly
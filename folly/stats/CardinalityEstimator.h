@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/stats/HyperLogLog.h>
+#include <folly/stats/detail/BufferedStat.h>
+
+namespace folly {
+
+/*
+ * Estimates the number of distinct keys added over the last
+ * nWindows * windowDuration (see constructor), using a HyperLogLog of the
+ * given precision per window. Windows that saw few keys stay sparse, so idle
+ * windows cost little.
+ *
+ * Like SlidingWindowQuantileEstimator, keys are buffered in cpu-local buffers
+ * for windowDuration, so addValue() is cheap and scales with the number of
+ * writers, while reads merge the windows into a snapshot.
+ */
+template <typename ClockT = std::chrono::steady_clock>
+class SlidingWindowCardinalityEstimator {
+ public:
+  using TimePoint = typename ClockT::time_point;
+  using Duration = typename ClockT::duration;
+
+  SlidingWindowCardinalityEstimator(
+      Duration windowDuration, size_t nWindows = 60, size_t precision = 14);
+
+  double estimate(TimePoint now = ClockT::now());
+
+  void addValue(uint64_t key, TimePoint now = ClockT::now());
+
+  /// Flush buffered values
+  void flush() { bufferedSlidingWindow_.flush(); }
+
+  // Get point-in-time HyperLogLog
+  HyperLogLog getSketch(TimePoint now = ClockT::now()) {
+    return bufferedSlidingWindow_.getMerged(now);
+  }
+
+ private:
+  detail::BufferedSlidingWindow<HyperLogLog, ClockT> bufferedSlidingWindow_;
+};
+
+} // namespace folly
+
+#include <folly/stats/CardinalityEstimator-inl.h>
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/CountMinSketch.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <folly/hash/Hash.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+
+namespace {
+
+uint32_t saturatingAdd(uint32_t a, uint32_t b) {
+  uint32_t sum = a + b;
+  return sum < a ? std::numeric_limits<uint32_t>::max() : sum;
+}
+
+} // namespace
+
+CountMinSketch::CountMinSketch(size_t width)
+    : mask_(nextPowTwo(std::max<size_t>(width, 1)) - 1),
+      counters_(kDepth * (mask_ + 1)) {}
+
+void CountMinSketch::add(uint64_t key, uint32_t count) {
+  auto hash = hash::twang_mix64(key);
+  for (size_t row = 0; row < kDepth; ++row) {
+    auto& counter = counters_[index(row, hash)];
+    counter = saturatingAdd(counter, count);
+  }
+  count_ += count;
+}
+
+uint32_t CountMinSketch::estimate(uint64_t key) const {
+  auto hash = hash::twang_mix64(key);
+  uint32_t result = std::numeric_limits<uint32_t>::max();
+  for (size_t row = 0; row < kDepth; ++row) {
+    result = std::min(result, counters_[index(row, hash)]);
+  }
+  return result;
+}
+
+CountMinSketch CountMinSketch::merge(Range<const uint64_t*> keys) const {
+  CountMinSketch result(*this);
+  for (auto key : keys) {
+    result.add(key);
+  }
+  return result;
+}
+
+CountMinSketch CountMinSketch::merge(Range<const CountMinSketch*> sketches) {
+  const CountMinSketch* first = nullptr;
+  for (const auto& sketch : sketches) {
+    if (!sketch.empty()) {
+      first = &sketch;
+      break;
+    }
+  }
+  if (!first) {
+    return sketches.empty() ? CountMinSketch() : sketches.front();
+  }
+  CountMinSketch result(first->width());
+  for (const auto& sketch : sketches) {
+    if (sketch.empty()) {
+      continue;
+    }
+    if (sketch.width() != result.width()) {
+      throw_exception<std::invalid_argument>(
+          "Cannot merge CountMinSketches of different widths");
+    }
+    for (size_t i = 0; i < result.counters_.size(); ++i) {
+      result.counters_[i] =
+          saturatingAdd(result.counters_[i], sketch.counters_[i]);
+    }
+    result.count_ += sketch.count_;
+  }
+  return result;
+}
+
+} // namespace folly
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <folly/Range.h>
+
+namespace folly {
+
+/*
+ * A Count-Min sketch estimates how many times each key was added, in a fixed
+ * amount of memory, never underestimating. With width w, an estimate exceeds
+ * the true count by more than 2/w of all the keys added with probability at
+ * most 1/2^kDepth.
+ *
+ * Keys are 64-bit integers; hash other keys to one first. Counters saturate
+ * at the maximum uint32_t.
+ *
+ * Like TDigest, it is a mergeable digest that DigestBuilder and the stats in
+ * folly/stats/HeavyHitters.h can build from buffered keys: merge() returns a
+ * new sketch with the given keys or sketches added. Sketches to merge must
+ * have the same width, except that empty sketches are ignored.
+ */
+class CountMinSketch {
+ public:
+  using value_type = uint64_t;
+
+  static constexpr size_t kDepth = 4;
+
+  /*
+   * The width is rounded up to a power of two.
+   */
+  explicit CountMinSketch(size_t width = 1024);
+
+  void add(uint64_t key, uint32_t count = 1);
+
+  uint32_t estimate(uint64_t key) const;
+
+  CountMinSketch merge(Range<const uint64_t*> keys) const;
+
+  static CountMinSketch merge(Range<const CountMinSketch*> sketches);
+
+  size_t width() const { return mask_ + 1; }
+
+  /* The number of keys added */
+  uint64_t count() const { return count_; }
+
+  bool empty() const { return count_ == 0; }
+
+ private:
+  size_t index(size_t row, uint64_t hash) const {
+    // Double hashing from the two halves of one 64-bit hash
+    auto h1 = static_cast<uint32_t>(hash);
+    auto h2 = static_cast<uint32_t>(hash >> 32) | 1;
+    return row * width() + ((h1 + row * h2) & mask_);
+  }
+
+  size_t mask_;
+  uint64_t count_{0};
+  std::vector<uint32_t> counters_; // kDepth rows of width()
+};
+
+} // namespace folly
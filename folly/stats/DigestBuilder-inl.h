@@ -17,7 +17,9 @@
 #pragma once
 
 #include <algorithm>
+#include <thread>
 
+#include <folly/Range.h>
 #include <folly/concurrency/CacheLocality.h>
 #include <folly/lang/Bits.h>
 #include <folly/synchronization/Lock.h>
@@ -25,15 +27,21 @@
 namespace folly {
 
 template <typename DigestT>
-DigestBuilder<DigestT>::DigestBuilder(size_t bufferSize, size_t digestSize)
+DigestBuilder<DigestT>::DigestBuilder(
+    size_t bufferSize, size_t digestSize, AppendMode mode)
     : bufferSize_(bufferSize), digestSize_(digestSize) {
   auto& cl = CacheLocality::system();
   cpuLocalBuffers_.resize(cl.numCachesByLevel[0]);
+  if (mode == AppendMode::LockFree) {
+    for (auto& cpuLocalBuffer : cpuLocalBuffers_) {
+      cpuLocalBuffer.slots = std::make_unique<value_type[]>(bufferSize_);
+    }
+  }
 }
 
 template <typename DigestT>
 DigestT DigestBuilder<DigestT>::build() {
-  std::vector<std::vector<double>> valuesVec;
+  std::vector<std::vector<value_type>> valuesVec;
   std::vector<std::unique_ptr<DigestT>> digestPtrs;
   valuesVec.reserve(cpuLocalBuffers_.size());
   digestPtrs.reserve(cpuLocalBuffers_.size());
@@ -45,10 +53,32 @@ DigestT DigestBuilder<DigestT>::build() {
     // the cpuLocalBuffer in the same state it was found if it received any
     // values. The state may have changed by the time we re-acquire the lock,
     // but this does not affect correctness.
-    std::vector<double> newBuffer;
+    std::vector<value_type> newBuffer;
     std::unique_ptr<DigestT> newDigest;
+    std::vector<value_type> slotValues;
+    if (cpuLocalBuffer.slots) {
+      slotValues.reserve(bufferSize_);
+    }
 
     auto g = make_unique_lock(cpuLocalBuffer.mutex);
+    if (cpuLocalBuffer.slots) {
+      // Close the slots to new appends. If they were already full, the append
+      // that filled them merges them once we release the lock. Otherwise,
+      // wait for the appends that claimed slots to finish writing them.
+      auto claimed = cpuLocalBuffer.claimed.exchange(
+          bufferSize_, std::memory_order_acquire);
+      if (claimed < bufferSize_) {
+        while (cpuLocalBuffer.committed.load(std::memory_order_acquire) !=
+               claimed) {
+          std::this_thread::yield();
+        }
+        slotValues.assign(
+            cpuLocalBuffer.slots.get(), cpuLocalBuffer.slots.get() + claimed);
+        cpuLocalBuffer.committed.store(0, std::memory_order_relaxed);
+        cpuLocalBuffer.claimed.store(0, std::memory_order_release);
+      }
+      valuesVec.push_back(std::move(slotValues));
+    }
     bool hasDigest =
         cpuLocalBuffer.digest != nullptr && !cpuLocalBuffer.digest->empty();
     // If at least one merge happened, bufferSize_ was reached.
@@ -81,7 +111,7 @@ DigestT DigestBuilder<DigestT>::build() {
     count += vec.size();
   }
   if (count) {
-    std::vector<double> values;
+    std::vector<value_type> values;
     values.reserve(count);
     for (const auto& vec : valuesVec) {
       values.insert(values.end(), vec.begin(), vec.end());
@@ -93,7 +123,42 @@ DigestT DigestBuilder<DigestT>::build() {
 }
 
 template <typename DigestT>
-void DigestBuilder<DigestT>::append(double value) {
+void DigestBuilder<DigestT>::append(value_type value) {
+  const auto numBuffers = cpuLocalBuffers_.size();
+  auto& cpuLocalBuf =
+      cpuLocalBuffers_[AccessSpreader<>::cachedCurrent(numBuffers)];
+  if (cpuLocalBuf.slots) {
+    auto idx = cpuLocalBuf.claimed.fetch_add(1, std::memory_order_acquire);
+    if (FOLLY_LIKELY(idx < bufferSize_)) {
+      cpuLocalBuf.slots[idx] = value;
+      auto committed =
+          cpuLocalBuf.committed.fetch_add(1, std::memory_order_acq_rel) + 1;
+      if (FOLLY_UNLIKELY(committed == bufferSize_)) {
+        mergeSlots(cpuLocalBuf);
+      }
+      return;
+    }
+    // The slots are full and being merged, or being taken by build(), or
+    // this thread has migrated to a busy cpu.
+    AccessSpreader<>::invalidateCachedCurrent();
+  }
+  appendLocked(value);
+}
+
+template <typename DigestT>
+void DigestBuilder<DigestT>::mergeSlots(CpuLocalBuffer& cpuLocalBuf) {
+  auto g = make_unique_lock(cpuLocalBuf.mutex);
+  if (!cpuLocalBuf.digest) {
+    cpuLocalBuf.digest = std::make_unique<DigestT>(digestSize_);
+  }
+  *cpuLocalBuf.digest = cpuLocalBuf.digest->merge(Range<const value_type*>(
+      cpuLocalBuf.slots.get(), cpuLocalBuf.slots.get() + bufferSize_));
+  cpuLocalBuf.committed.store(0, std::memory_order_relaxed);
+  cpuLocalBuf.claimed.store(0, std::memory_order_release);
+}
+
+template <typename DigestT>
+void DigestBuilder<DigestT>::appendLocked(value_type value) {
   const auto numBuffers = cpuLocalBuffers_.size();
   auto cpuLocalBuf =
       &cpuLocalBuffers_[AccessSpreader<>::cachedCurrent(numBuffers)];
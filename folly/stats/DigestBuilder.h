@@ -16,14 +16,31 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
 #include <folly/Memory.h>
 #include <folly/SpinLock.h>
+#include <folly/Traits.h>
 
 namespace folly {
 
+namespace detail {
+
+// The type of the values that a DigestT is built from: DigestT::value_type if
+// it declares one, and double otherwise.
+template <typename DigestT, typename = void>
+struct digest_value {
+  using type = double;
+};
+template <typename DigestT>
+struct digest_value<DigestT, void_t<typename DigestT::value_type>> {
+  using type = typename DigestT::value_type;
+};
+
+} // namespace detail
+
 /*
  * Stat digests, such as TDigest, can be expensive to merge. It is faster to
  * buffer writes and merge them in larger chunks. DigestBuilder buffers writes
@@ -32,6 +49,17 @@ namespace folly {
  * Values are stored in a cpu local buffer. Hot stats will merge the cpu local
  * buffer into a cpu-local digest when the buffer size is reached.
  *
+ * In the default Locked mode, append() takes a SpinLock on the cpu local
+ * buffer. With many more threads than cpus, threads sharing a buffer contend
+ * on it, and a thread preempted while holding it stalls the others. In
+ * LockFree mode, each cpu local buffer is a preallocated array, and append()
+ * claims a slot in it with an atomic increment instead. Only the append that
+ * fills the array takes the lock, to merge it into the digest, and appends to
+ * a buffer that is being merged or built fall back to the lock.
+ *
+ * Values are doubles, unless DigestT declares another value_type, such as the
+ * integer keys of a CountMinSketch.
+ *
  * All methods in this class are thread safe, but it probably doesn't make sense
  * for multiple threads to call build simultaneously. A typical usage is to
  * buffer writes for a period of time, and then have one thread call build to
@@ -40,7 +68,14 @@ namespace folly {
 template <typename DigestT>
 class DigestBuilder {
  public:
-  explicit DigestBuilder(size_t bufferSize, size_t digestSize);
+  using value_type = typename detail::digest_value<DigestT>::type;
+
+  enum class AppendMode { Locked, LockFree };
+
+  explicit DigestBuilder(
+      size_t bufferSize,
+      size_t digestSize,
+      AppendMode mode = AppendMode::Locked);
 
   /*
    * Builds a DigestT from the buffer. All values used to build the DigestT are
@@ -51,29 +86,43 @@ class DigestBuilder {
   /*
    * Adds a value to the buffer.
    */
-  void append(double value);
+  void append(value_type value);
 
  private:
   struct alignas(hardware_destructive_interference_size) CpuLocalBuffer {
    public:
     mutable SpinLock mutex;
-    std::vector<double> buffer;
+    std::vector<value_type> buffer;
     std::unique_ptr<DigestT> digest;
 
+    // LockFree mode only: slots [0, claimed) are being written, and the
+    // writes to committed of them are done. Once claimed reaches bufferSize,
+    // appends fall back to the lock until the slots are taken and the counts
+    // reset.
+    std::unique_ptr<value_type[]> slots;
+    std::atomic<size_t> claimed{0};
+    std::atomic<size_t> committed{0};
+
     CpuLocalBuffer() noexcept = default;
 
     CpuLocalBuffer(CpuLocalBuffer&& other) noexcept
-        : buffer{std::move(other.buffer)}, digest{std::move(other.digest)} {}
+        : buffer{std::move(other.buffer)},
+          digest{std::move(other.digest)},
+          slots{std::move(other.slots)} {}
 
     CpuLocalBuffer& operator=(CpuLocalBuffer&& other) noexcept {
       if (this != &other) {
         buffer = std::move(other.buffer);
         digest = std::move(other.digest);
+        slots = std::move(other.slots);
       }
       return *this;
     }
   };
 
+  void appendLocked(value_type value);
+  void mergeSlots(CpuLocalBuffer& cpuLocalBuf);
+
   //  cpulocalbuffer_alloc custom allocator is necessary until C++17
   //    http://open-std.org/JTC1/SC22/WG21/docs/papers/2012/n3396.htm
   //    https://gcc.gnu.org/bugzilla/show_bug.cgi?id=65122
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+namespace folly {
+
+template <typename ClockT>
+SlidingWindowFrequencyEstimator<ClockT>::SlidingWindowFrequencyEstimator(
+    Duration windowDuration, size_t nWindows, size_t width)
+    : bufferedSlidingWindow_(nWindows, windowDuration, 1000, width) {}
+
+template <typename ClockT>
+uint32_t SlidingWindowFrequencyEstimator<ClockT>::estimate(
+    uint64_t key, TimePoint now) {
+  return getSketch(now).estimate(key);
+}
+
+template <typename ClockT>
+void SlidingWindowFrequencyEstimator<ClockT>::addValue(
+    uint64_t key, TimePoint now) {
+  bufferedSlidingWindow_.append(key, now);
+}
+
+template <typename ClockT>
+SlidingWindowHeavyHitters<ClockT>::SlidingWindowHeavyHitters(
+    Duration windowDuration, size_t nWindows, size_t capacity)
+    : bufferedSlidingWindow_(nWindows, windowDuration, 1000, capacity) {}
+
+template <typename ClockT>
+std::vector<SpaceSaving::Counter> SlidingWindowHeavyHitters<ClockT>::topK(
+    size_t k, TimePoint now) {
+  return getSummary(now).topK(k);
+}
+
+template <typename ClockT>
+void SlidingWindowHeavyHitters<ClockT>::addValue(uint64_t key, TimePoint now) {
+  bufferedSlidingWindow_.append(key, now);
+}
+
+} // namespace folly
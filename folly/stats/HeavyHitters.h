@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/stats/CountMinSketch.h>
+#include <folly/stats/SpaceSaving.h>
+#include <folly/stats/detail/BufferedStat.h>
+
+namespace folly {
+
+/*
+ * Estimates how often each key was added over the last
+ * nWindows * windowDuration (see constructor), using a CountMinSketch of the
+ * given width per window. Keys are 64-bit integers; hash other keys to one
+ * first.
+ *
+ * Like SlidingWindowQuantileEstimator, keys are buffered in cpu-local buffers
+ * for windowDuration, so addValue() is cheap and scales with the number of
+ * writers, while reads merge the windows into a snapshot.
+ */
+template <typename ClockT = std::chrono::steady_clock>
+class SlidingWindowFrequencyEstimator {
+ public:
+  using TimePoint = typename ClockT::time_point;
+  using Duration = typename ClockT::duration;
+
+  SlidingWindowFrequencyEstimator(
+      Duration windowDuration, size_t nWindows = 60, size_t width = 4096);
+
+  uint32_t estimate(uint64_t key, TimePoint now = ClockT::now());
+
+  void addValue(uint64_t key, TimePoint now = ClockT::now());
+
+  /// Flush buffered values
+  void flush() { bufferedSlidingWindow_.flush(); }
+
+  // Get point-in-time CountMinSketch
+  CountMinSketch getSketch(TimePoint now = ClockT::now()) {
+    return bufferedSlidingWindow_.getMerged(now);
+  }
+
+ private:
+  detail::BufferedSlidingWindow<CountMinSketch, ClockT> bufferedSlidingWindow_;
+};
+
+/*
+ * Tracks the most frequent keys over the last nWindows * windowDuration (see
+ * constructor), using a SpaceSaving summary with the given capacity per
+ * window. Any key that makes up more than 1 / capacity of the keys added in
+ * that time is reported. Buffered like SlidingWindowFrequencyEstimator.
+ */
+template <typename ClockT = std::chrono::steady_clock>
+class SlidingWindowHeavyHitters {
+ public:
+  using TimePoint = typename ClockT::time_point;
+  using Duration = typename ClockT::duration;
+
+  SlidingWindowHeavyHitters(
+      Duration windowDuration, size_t nWindows = 60, size_t capacity = 100);
+
+  /*
+   * Returns up to k of the most frequent keys, in decreasing order of their
+   * estimated counts.
+   */
+  std::vector<SpaceSaving::Counter> topK(
+      size_t k, TimePoint now = ClockT::now());
+
+  void addValue(uint64_t key, TimePoint now = ClockT::now());
+
+  /// Flush buffered values
+  void flush() { bufferedSlidingWindow_.flush(); }
+
+  // Get point-in-time SpaceSaving summary
+  SpaceSaving getSummary(TimePoint now = ClockT::now()) {
+    return bufferedSlidingWindow_.getMerged(now);
+  }
+
+ private:
+  detail::BufferedSlidingWindow<SpaceSaving, ClockT> bufferedSlidingWindow_;
+};
+
+} // namespace folly
+
+#include <folly/stats/HeavyHitters-inl.h>
@@ -293,6 +293,18 @@ class Histogram {
     }
   }
 
+  /*
+   * Add nSamples data points with the given sum to the bucket at the given
+   * index, such as to restore a histogram from the sums and counts of its
+   * buckets.
+   */
+  void addBucketAggregated(size_t idx, ValueType sum, uint64_t nSamples) {
+    Bucket& bucket = buckets_.getByIndex(idx);
+    bucket.sum = static_cast<ValueType>(
+        to_unsigned(bucket.sum) + to_unsigned(sum));
+    bucket.count += nSamples;
+  }
+
   /* Remove all data points from the histogram */
   void clear() {
     for (size_t i = 0; i < buckets_.getNumBuckets(); i++) {
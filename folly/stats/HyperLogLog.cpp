@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/HyperLogLog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <folly/hash/Hash.h>
+#include <folly/lang/Bits.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+
+namespace {
+
+constexpr uint32_t kRankBits = 6;
+constexpr uint32_t kRankMask = (1 << kRankBits) - 1;
+
+// The position of the first set bit of the bits of hash below the index,
+// counting from 1, or one more than their number if they are all zero.
+uint8_t rank(uint64_t hash, size_t precision) {
+  uint64_t rest = hash << precision;
+  return static_cast<uint8_t>(
+      rest == 0 ? 65 - precision : 65 - findLastSet(rest));
+}
+
+// sigma and tau are from Ertl, Algorithm 6.
+double sigma(double x) {
+  if (x == 1) {
+    return std::numeric_limits<double>::infinity();
+  }
+  double y = 1;
+  double z = x;
+  double zPrev;
+  do {
+    x *= x;
+    zPrev = z;
+    z += x * y;
+    y += y;
+  } while (z != zPrev);
+  return z;
+}
+
+double tau(double x) {
+  if (x == 0 || x == 1) {
+    return 0;
+  }
+  double y = 1;
+  double z = 1 - x;
+  double zPrev;
+  do {
+    x = std::sqrt(x);
+    zPrev = z;
+    y *= 0.5;
+    z -= (1 - x) * (1 - x) * y;
+  } while (z != zPrev);
+  return z / 3;
+}
+
+} // namespace
+
+HyperLogLog::HyperLogLog(size_t precision)
+    : precision_(static_cast<uint8_t>(precision)) {
+  if (precision < kMinPrecision || precision > kMaxPrecision) {
+    throw_exception<std::invalid_argument>(
+        "HyperLogLog precision must be between 4 and 18");
+  }
+}
+
+uint32_t HyperLogLog::sparseEntry(uint64_t hash) {
+  auto index = static_cast<uint32_t>(hash >> (64 - kSparsePrecision));
+  return (index << kRankBits) | rank(hash, kSparsePrecision);
+}
+
+void HyperLogLog::add(uint64_t key) {
+  auto hash = hash::twang_mix64(key);
+  if (isSparse()) {
+    addSparse(sparseEntry(hash));
+  } else {
+    addDense(hash);
+  }
+}
+
+void HyperLogLog::addSparse(uint32_t entry) {
+  sparse_.push_back(entry);
+  if (sparse_.size() - sorted_ >= std::max<size_t>(sparseLimit() / 4, 1)) {
+    compact();
+    if (sparse_.size() > sparseLimit()) {
+      toDense();
+    }
+  }
+}
+
+void HyperLogLog::addDense(uint64_t hash) {
+  auto& reg = registers_[hash >> (64 - precision_)];
+  reg = std::max(reg, rank(hash, precision_));
+}
+
+void HyperLogLog::setRegister(uint32_t entry) {
+  // Recover the rank at precision_ from the extra index bits of the entry.
+  size_t extraBits = kSparsePrecision - precision_;
+  uint32_t index = entry >> kRankBits;
+  uint32_t extra = index & ((uint32_t(1) << extraBits) - 1);
+  auto rank = static_cast<uint8_t>(
+      extra != 0 ? extraBits - findLastSet(extra) + 1
+                 : extraBits + (entry & kRankMask));
+  auto& reg = registers_[index >> extraBits];
+  reg = std::max(reg, rank);
+}
+
+void HyperLogLog::compact() {
+  if (sorted_ == sparse_.size()) {
+    return;
+  }
+  std::sort(sparse_.begin() + sorted_, sparse_.end());
+  std::inplace_merge(sparse_.begin(), sparse_.begin() + sorted_, sparse_.end());
+  // Keep the last, and so largest, rank of each register.
+  size_t out = 0;
+  for (size_t i = 0; i < sparse_.size(); ++i) {
+    uint32_t index = sparse_[i] >> kRankBits;
+    if (out > 0 && (sparse_[out - 1] >> kRankBits) == index) {
+      sparse_[out - 1] = sparse_[i];
+    } else {
+      sparse_[out++] = sparse_[i];
+    }
+  }
+  sparse_.resize(out);
+  sorted_ = out;
+}
+
+void HyperLogLog::toDense() {
+  registers_.assign(numRegisters(), 0);
+  for (auto entry : sparse_) {
+    setRegister(entry);
+  }
+  sparse_.clear();
+  sparse_.shrink_to_fit();
+  sorted_ = 0;
+}
+
+double HyperLogLog::estimate() const {
+  if (isSparse()) {
+    if (sorted_ != sparse_.size()) {
+      HyperLogLog copy(*this);
+      copy.compact();
+      return copy.estimate();
+    }
+    // Linear counting over the 2^25 sparse registers is exact to within a
+    // fraction of a key at these sizes.
+    double m = double(uint64_t(1) << kSparsePrecision);
+    return m * std::log(m / (m - double(sparse_.size())));
+  }
+  size_t q = 64 - precision_;
+  std::vector<uint32_t> histogram(q + 2);
+  for (auto reg : registers_) {
+    ++histogram[reg];
+  }
+  double m = double(numRegisters());
+  double z = m * tau(1 - histogram[q + 1] / m);
+  for (size_t k = q; k >= 1; --k) {
+    z = 0.5 * (z + histogram[k]);
+  }
+  z += m * sigma(histogram[0] / m);
+  return m * m / (2 * std::log(2.0) * z);
+}
+
+HyperLogLog HyperLogLog::merge(Range<const uint64_t*> keys) const {
+  HyperLogLog result(*this);
+  for (auto key : keys) {
+    result.add(key);
+  }
+  return result;
+}
+
+HyperLogLog HyperLogLog::merge(Range<const HyperLogLog*> sketches) {
+  const HyperLogLog* first = nullptr;
+  for (const auto& sketch : sketches) {
+    if (!sketch.empty()) {
+      first = &sketch;
+      break;
+    }
+  }
+  if (!first) {
+    return sketches.empty() ? HyperLogLog() : sketches.front();
+  }
+  HyperLogLog result(first->precision_);
+  for (const auto& sketch : sketches) {
+    if (sketch.empty()) {
+      continue;
+    }
+    if (sketch.precision_ != result.precision_) {
+      throw_exception<std::invalid_argument>(
+          "Cannot merge HyperLogLogs of different precisions");
+    }
+    if (!sketch.isSparse()) {
+      if (result.isSparse()) {
+        result.toDense();
+      }
+      // Written as a plain loop over bytes, so that it is vectorized.
+      auto* out = result.registers_.data();
+      const auto* in = sketch.registers_.data();
+      for (size_t i = 0; i < result.registers_.size(); ++i) {
+        out[i] = std::max(out[i], in[i]);
+      }
+    } else if (!result.isSparse()) {
+      for (auto entry : sketch.sparse_) {
+        result.setRegister(entry);
+      }
+    } else {
+      result.sparse_.insert(
+          result.sparse_.end(), sketch.sparse_.begin(), sketch.sparse_.end());
+      result.compact();
+      if (result.sparse_.size() > result.sparseLimit()) {
+        result.toDense();
+      }
+    }
+  }
+  return result;
+}
+
+} // namespace folly
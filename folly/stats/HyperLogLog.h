@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <folly/Range.h>
+
+namespace folly {
+
+/*
+ * HyperLogLog estimates the number of distinct keys added, in a few KB no
+ * matter how many there are, with a relative standard error of about
+ * 1.04 / sqrt(2^precision): 0.8% at the default precision of 14, which takes
+ * 16KB. Keys are 64-bit integers, mixed with hash::twang_mix64(); hash other
+ * keys to one first, for example with hash::SpookyHashV2.
+ *
+ * As in HLL++ (Heule et al., "HyperLogLog in Practice"), small sketches keep
+ * a sorted list of the registers in use at a precision of 25 bits, which is
+ * both smaller and exact up to a few thousand keys, and switch to an array
+ * of 2^precision byte registers once the list would be larger. Instead of
+ * the empirical bias correction of HLL++, the dense estimate uses the
+ * estimator of Ertl, "New cardinality estimation algorithms for HyperLogLog
+ * sketches", which is unbiased over the whole range without tables.
+ *
+ * Like TDigest, it is a mergeable digest that DigestBuilder and
+ * SlidingWindowCardinalityEstimator can build from buffered keys. The
+ * digestSize is the precision. Sketches to merge must have the same
+ * precision, except that empty sketches are ignored.
+ */
+class HyperLogLog {
+ public:
+  using value_type = uint64_t;
+
+  static constexpr size_t kMinPrecision = 4;
+  static constexpr size_t kMaxPrecision = 18;
+
+  /*
+   * Throws std::invalid_argument unless
+   * kMinPrecision <= precision <= kMaxPrecision.
+   */
+  explicit HyperLogLog(size_t precision = 14);
+
+  void add(uint64_t key);
+
+  double estimate() const;
+
+  HyperLogLog merge(Range<const uint64_t*> keys) const;
+
+  static HyperLogLog merge(Range<const HyperLogLog*> sketches);
+
+  size_t precision() const { return precision_; }
+
+  bool empty() const { return sparse_.empty() && registers_.empty(); }
+
+  bool isSparse() const { return registers_.empty(); }
+
+ private:
+  // Sparse entries are the 25-bit register index above the 6-bit rank, so
+  // that sorting them groups each register's ranks in increasing order.
+  static constexpr size_t kSparsePrecision = 25;
+
+  static uint32_t sparseEntry(uint64_t hash);
+
+  size_t numRegisters() const { return size_t(1) << precision_; }
+
+  // The sparse list is converted to registers when it would be larger.
+  size_t sparseLimit() const { return numRegisters() / sizeof(uint32_t); }
+
+  void addSparse(uint32_t entry);
+  void addDense(uint64_t hash);
+  void setRegister(uint32_t entry);
+  void compact();
+  void toDense();
+
+  uint8_t precision_;
+  // Sorted by index with one entry per register, followed by up to
+  // sparseLimit() / 4 unsorted entries added since the last compact().
+  std::vector<uint32_t> sparse_;
+  size_t sorted_{0};
+  std::vector<uint8_t> registers_; // Empty while sparse
+};
+
+} // namespace folly
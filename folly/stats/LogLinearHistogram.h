@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <folly/lang/Bits.h>
+#include <folly/stats/Histogram.h>
+
+namespace folly {
+
+/*
+ * LogLinearHistogram counts unsigned integer values, such as latencies in
+ * nanoseconds, in log-linear buckets in the style of HdrHistogram, so that
+ * values spanning many orders of magnitude are all recorded with the same
+ * relative precision.
+ *
+ * Values below 2^SubBucketBits each have their own bucket. Above that, each
+ * power-of-two range [2^k, 2^(k+1)) is split into 2^(SubBucketBits - 1)
+ * buckets of equal width, so a bucket is never wider than 2^(1 -
+ * SubBucketBits) of its lower bound: under 1.6% with the default of 7, for
+ * 3776 buckets covering all of uint64_t.
+ *
+ * addValue() is thread-safe and lock-free: it computes the bucket with a few
+ * bit operations and increments its counter with a relaxed atomic add. The
+ * queries read the counters with relaxed loads, so while values are being
+ * added they see some consistent-enough recent state. For counting from many
+ * threads on a hot path, give each thread its own histogram and merge() them
+ * when reading.
+ *
+ * To feed a TimeseriesHistogram, add the counts to a folly::Histogram with
+ * addTo() and pass that to TimeseriesHistogram::addValues().
+ */
+template <size_t SubBucketBits = 7>
+class LogLinearHistogram {
+  static_assert(
+      SubBucketBits >= 1 && SubBucketBits <= 16,
+      "SubBucketBits must be between 1 and 16");
+
+  static constexpr size_t kLinearBuckets = size_t(1) << SubBucketBits;
+  static constexpr size_t kSubBuckets = kLinearBuckets / 2;
+
+ public:
+  static constexpr size_t kNumBuckets =
+      kLinearBuckets + (64 - SubBucketBits) * kSubBuckets;
+
+  LogLinearHistogram() = default;
+
+  LogLinearHistogram(const LogLinearHistogram& other) { merge(other); }
+
+  LogLinearHistogram& operator=(const LogLinearHistogram& other) {
+    if (this != &other) {
+      clear();
+      merge(other);
+    }
+    return *this;
+  }
+
+  static size_t bucketIndex(uint64_t value) noexcept {
+    if (value < kLinearBuckets) {
+      return static_cast<size_t>(value);
+    }
+    size_t const k = findLastSet(value) - 1;
+    size_t const shift = k - SubBucketBits + 1;
+    return kLinearBuckets + (k - SubBucketBits) * kSubBuckets +
+        static_cast<size_t>(value >> shift) - kSubBuckets;
+  }
+
+  /* The smallest value in the bucket */
+  static uint64_t bucketMin(size_t idx) noexcept {
+    if (idx < kLinearBuckets) {
+      return idx;
+    }
+    size_t const j = idx - kLinearBuckets;
+    size_t const shift = j / kSubBuckets + 1;
+    return uint64_t(j % kSubBuckets + kSubBuckets) << shift;
+  }
+
+  /* The largest value in the bucket */
+  static uint64_t bucketMax(size_t idx) noexcept {
+    if (idx < kLinearBuckets) {
+      return idx;
+    }
+    size_t const shift = (idx - kLinearBuckets) / kSubBuckets + 1;
+    return bucketMin(idx) + ((uint64_t(1) << shift) - 1);
+  }
+
+  void addValue(uint64_t value) noexcept { addValue(value, 1); }
+
+  void addValue(uint64_t value, uint64_t times) noexcept {
+    counts_[bucketIndex(value)].fetch_add(times, std::memory_order_relaxed);
+  }
+
+  uint64_t bucketCount(size_t idx) const noexcept {
+    return counts_[idx].load(std::memory_order_relaxed);
+  }
+
+  uint64_t count() const noexcept {
+    uint64_t total = 0;
+    for (auto const& c : counts_) {
+      total += c.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  bool empty() const noexcept { return count() == 0; }
+
+  /* Adds the counts of other into this histogram */
+  void merge(const LogLinearHistogram& other) noexcept {
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      if (auto c = other.bucketCount(i)) {
+        counts_[i].fetch_add(c, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void clear() noexcept {
+    for (auto& c : counts_) {
+      c.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  /*
+   * Calls fn(bucketMin, bucketMax, count) for each nonempty bucket, in
+   * increasing order of values.
+   */
+  template <typename Fn>
+  void forEachBucket(Fn fn) const {
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      if (auto c = bucketCount(i)) {
+        fn(bucketMin(i), bucketMax(i), c);
+      }
+    }
+  }
+
+  /*
+   * Estimates the value at quantile q, between 0.0 and 1.0, by linear
+   * interpolation within its bucket. Returns 0 if the histogram is empty.
+   */
+  uint64_t estimateQuantile(double q) const noexcept {
+    auto const total = count();
+    if (total == 0) {
+      return 0;
+    }
+    q = std::min(std::max(q, 0.0), 1.0);
+    double const rank = q * static_cast<double>(total);
+    uint64_t seen = 0;
+    size_t last = 0;
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      auto const c = bucketCount(i);
+      if (c == 0) {
+        continue;
+      }
+      if (static_cast<double>(seen + c) >= rank) {
+        double const frac = std::max(
+            (rank - static_cast<double>(seen)) / static_cast<double>(c), 0.0);
+        auto const lo = bucketMin(i);
+        auto const width = static_cast<double>(bucketMax(i) - lo);
+        return lo + static_cast<uint64_t>(frac * width);
+      }
+      seen += c;
+      last = i;
+    }
+    // Values were removed concurrently by clear()
+    return bucketMax(last);
+  }
+
+  /*
+   * Adds the counts to hist, at the midpoints of the buckets, for instance
+   * to pass them on to TimeseriesHistogram::addValues().
+   */
+  template <typename T>
+  void addTo(Histogram<T>& hist) const {
+    forEachBucket([&](uint64_t lo, uint64_t hi, uint64_t c) {
+      hist.addRepeatedValue(static_cast<T>(lo + (hi - lo) / 2), c);
+    });
+  }
+
+ private:
+  std::atomic<uint64_t> counts_[kNumBuckets] = {};
+};
+
+} // namespace folly
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include <folly/Likely.h>
+
+namespace folly {
+
+template <typename VT, typename CT>
+MultiLevelTimeSeriesFamily<VT, CT>::Level::Level(
+    size_t numBuckets, Duration duration)
+    : clock(numBuckets, duration) {
+  bucketSums.resize(clock.numBuckets());
+  bucketCounts.resize(clock.numBuckets());
+}
+
+template <typename VT, typename CT>
+void MultiLevelTimeSeriesFamily<VT, CT>::Level::clearBucket(size_t idx) {
+  auto& sums = bucketSums[idx];
+  auto& counts = bucketCounts[idx];
+  for (size_t i = 0; i < sums.size(); ++i) {
+    totalSums[i] -= sums[i];
+    totalCounts[i] -= counts[i];
+  }
+  std::fill(sums.begin(), sums.end(), ValueType());
+  std::fill(counts.begin(), counts.end(), 0);
+}
+
+template <typename VT, typename CT>
+void MultiLevelTimeSeriesFamily<VT, CT>::Level::clearAll() {
+  for (size_t idx = 0; idx < bucketSums.size(); ++idx) {
+    std::fill(bucketSums[idx].begin(), bucketSums[idx].end(), ValueType());
+    std::fill(bucketCounts[idx].begin(), bucketCounts[idx].end(), 0);
+  }
+  std::fill(totalSums.begin(), totalSums.end(), ValueType());
+  std::fill(totalCounts.begin(), totalCounts.end(), 0);
+}
+
+template <typename VT, typename CT>
+void MultiLevelTimeSeriesFamily<VT, CT>::Level::setCurrentBucket(size_t idx) {
+  currentBucket = idx;
+  size_t bucketIdx;
+  TimePoint bucketStart;
+  TimePoint nextBucketStart;
+  clock.getBucketInfo(
+      clock.getLatestTime(), &bucketIdx, &bucketStart, &nextBucketStart);
+  earliestTime = nextBucketStart - clock.duration();
+}
+
+template <typename VT, typename CT>
+MultiLevelTimeSeriesFamily<VT, CT>::MultiLevelTimeSeriesFamily(
+    size_t numBuckets, folly::Range<const Duration*> durations) {
+  CHECK_GT(durations.size(), 0u);
+
+  levels_.reserve(durations.size());
+  size_t i = 0;
+  Duration prev{0};
+  for (auto dur : durations) {
+    if (dur == Duration(0)) {
+      CHECK_EQ(i, durations.size() - 1);
+    } else if (i > 0) {
+      CHECK(prev < dur);
+    }
+    levels_.emplace_back(numBuckets, dur);
+    prev = dur;
+    i++;
+  }
+}
+
+template <typename VT, typename CT>
+size_t MultiLevelTimeSeriesFamily<VT, CT>::addSeries() {
+  for (auto& level : levels_) {
+    for (auto& sums : level.bucketSums) {
+      sums.push_back(ValueType());
+    }
+    for (auto& counts : level.bucketCounts) {
+      counts.push_back(0);
+    }
+    level.totalSums.push_back(ValueType());
+    level.totalCounts.push_back(0);
+  }
+  return numSeries_++;
+}
+
+template <typename VT, typename CT>
+void MultiLevelTimeSeriesFamily<VT, CT>::addValueAggregated(
+    size_t series, TimePoint now, const ValueType& total, uint64_t nsamples) {
+  DCHECK_LT(series, numSeries_);
+  if (FOLLY_UNLIKELY(
+          now > getLatestTime() || levels_.front().clock.empty())) {
+    update(now);
+  }
+
+  for (auto& level : levels_) {
+    if (!level.clock.isAllTime()) {
+      size_t idx;
+      if (FOLLY_LIKELY(now == level.clock.getLatestTime())) {
+        idx = level.currentBucket;
+      } else if (now < level.earliestTime) {
+        // Too old for this level
+        continue;
+      } else {
+        idx = level.clock.getBucketIdx(now);
+      }
+      level.bucketSums[idx][series] += total;
+      level.bucketCounts[idx][series] += nsamples;
+    }
+    level.totalSums[series] += total;
+    level.totalCounts[series] += nsamples;
+  }
+}
+
+template <typename VT, typename CT>
+void MultiLevelTimeSeriesFamily<VT, CT>::update(TimePoint now) {
+  for (auto& level : levels_) {
+    auto& clock = level.clock;
+    if (clock.isAllTime()) {
+      clock.update(now);
+      continue;
+    }
+    if (clock.empty()) {
+      level.setCurrentBucket(clock.update(now));
+      continue;
+    }
+    if (now <= clock.getLatestTime()) {
+      continue;
+    }
+
+    // As in BucketedTimeSeries::updateBuckets(), but for all series at once
+    size_t currentBucket;
+    TimePoint currentBucketStart;
+    TimePoint nextBucketStart;
+    clock.getBucketInfo(
+        clock.getLatestTime(),
+        &currentBucket,
+        &currentBucketStart,
+        &nextBucketStart);
+    size_t newBucket = clock.update(now);
+
+    if (now >= currentBucketStart + clock.duration()) {
+      // All of the buckets have expired
+      level.clearAll();
+    } else if (now >= nextBucketStart) {
+      // Expire the buckets in (currentBucket, newBucket]
+      size_t idx = currentBucket;
+      while (idx != newBucket) {
+        if (++idx >= level.bucketSums.size()) {
+          idx = 0;
+        }
+        level.clearBucket(idx);
+      }
+    }
+    level.setCurrentBucket(newBucket);
+  }
+}
+
+template <typename VT, typename CT>
+void MultiLevelTimeSeriesFamily<VT, CT>::clear() {
+  for (auto& level : levels_) {
+    level.clock.clear();
+    level.clearAll();
+    level.currentBucket = 0;
+    level.earliestTime = TimePoint();
+  }
+}
+
+} // namespace folly
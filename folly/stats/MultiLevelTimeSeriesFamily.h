@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <folly/Range.h>
+#include <folly/stats/BucketedTimeSeries.h>
+
+namespace folly {
+
+/*
+ * MultiLevelTimeSeriesFamily tracks many time series, such as one per key,
+ * with the same levels and buckets as MultiLevelTimeSeries, but with a single
+ * clock for all of them.
+ *
+ * A MultiLevelTimeSeries keeps the time window and the bucket bookkeeping of
+ * each of its levels, and works out the bucket of every value it adds. Here
+ * that state is kept once for the family, as is the current bucket of each
+ * level, so adding a value at the latest time only adds it to one slot per
+ * level. The sums and counts are kept in structure-of-arrays form: each
+ * bucket of each level is an array indexed by series. When update() advances
+ * the time, expiring a bucket is one pass over its arrays for all series.
+ *
+ * As with MultiLevelTimeSeries, each level can be all-time, with a duration
+ * of 0, if it is the last. Since the series share a clock, elapsed time and
+ * rates are measured from the first update() of the family, rather than from
+ * the first value of each series; and values older than a level's window of
+ * the family are dropped from that level.
+ *
+ * This class is not thread-safe -- use your own synchronization!
+ */
+template <typename VT, typename CT = LegacyStatsClock<std::chrono::seconds>>
+class MultiLevelTimeSeriesFamily {
+ public:
+  using ValueType = VT;
+  using Clock = CT;
+  using Duration = typename Clock::duration;
+  using TimePoint = typename Clock::time_point;
+
+  MultiLevelTimeSeriesFamily(
+      size_t numBuckets, folly::Range<const Duration*> durations);
+
+  MultiLevelTimeSeriesFamily(
+      size_t numBuckets, std::initializer_list<Duration> durations)
+      : MultiLevelTimeSeriesFamily(numBuckets, folly::range(durations)) {}
+
+  /*
+   * Adds a series, initially empty, and returns its index. Indexes are
+   * assigned in order from 0.
+   */
+  size_t addSeries();
+
+  size_t numSeries() const { return numSeries_; }
+
+  size_t numLevels() const { return levels_.size(); }
+
+  Duration levelDuration(size_t level) const {
+    return getLevel(level).clock.duration();
+  }
+
+  /*
+   * Adds the value 'val' to a series at time 'now'. If now is more recent
+   * than the latest time of the family, this first calls update(now).
+   */
+  void addValue(size_t series, TimePoint now, const ValueType& val) {
+    addValueAggregated(series, now, val, 1);
+  }
+
+  void addValue(
+      size_t series, TimePoint now, const ValueType& val, uint64_t times) {
+    addValueAggregated(series, now, val * ValueType(times), times);
+  }
+
+  void addValueAggregated(
+      size_t series, TimePoint now, const ValueType& total, uint64_t nsamples);
+
+  /*
+   * Advances the time of all series to now, expiring old buckets.
+   */
+  void update(TimePoint now);
+
+  /*
+   * Removes all data from all series, and resets the clock.
+   */
+  void clear();
+
+  TimePoint getLatestTime() const {
+    return levels_.front().clock.getLatestTime();
+  }
+
+  ValueType sum(size_t series, size_t level) const {
+    return getLevel(level).totalSums[series];
+  }
+
+  uint64_t count(size_t series, size_t level) const {
+    return getLevel(level).totalCounts[series];
+  }
+
+  template <typename ReturnType = double>
+  ReturnType avg(size_t series, size_t level) const {
+    auto const& l = getLevel(level);
+    return detail::avgHelper<ReturnType>(
+        l.totalSums[series], l.totalCounts[series]);
+  }
+
+  template <typename ReturnType = double, typename Interval = Duration>
+  ReturnType rate(size_t series, size_t level) const {
+    auto const& l = getLevel(level);
+    return detail::rateHelper<ReturnType, Duration, Interval>(
+        ReturnType(l.totalSums[series]), l.clock.elapsed());
+  }
+
+  template <typename ReturnType = double, typename Interval = Duration>
+  ReturnType countRate(size_t series, size_t level) const {
+    auto const& l = getLevel(level);
+    return detail::rateHelper<ReturnType, Duration, Interval>(
+        ReturnType(l.totalCounts[series]), l.clock.elapsed());
+  }
+
+ private:
+  struct Level {
+    // Only keeps the time window and works out bucket indexes; the values
+    // are in the arrays below.
+    BucketedTimeSeries<ValueType, Clock> clock;
+    // The bucket of the latest time, and the earliest time still tracked
+    size_t currentBucket{0};
+    TimePoint earliestTime;
+    // [bucket][series]
+    std::vector<std::vector<ValueType>> bucketSums;
+    std::vector<std::vector<uint64_t>> bucketCounts;
+    // [series]
+    std::vector<ValueType> totalSums;
+    std::vector<uint64_t> totalCounts;
+
+    Level(size_t numBuckets, Duration duration);
+
+    void clearBucket(size_t idx);
+    void clearAll();
+    void setCurrentBucket(size_t idx);
+  };
+
+  const Level& getLevel(size_t level) const {
+    CHECK_LT(level, levels_.size());
+    return levels_[level];
+  }
+
+  std::vector<Level> levels_;
+  size_t numSeries_{0};
+};
+
+} // namespace folly
+
+#include <folly/stats/MultiLevelTimeSeriesFamily-inl.h>
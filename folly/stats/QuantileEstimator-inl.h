@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cmath>
+
 namespace folly {
 namespace detail {
 
@@ -48,8 +50,7 @@ SlidingWindowQuantileEstimator<ClockT>::SlidingWindowQuantileEstimator(
 template <typename ClockT>
 QuantileEstimates SlidingWindowQuantileEstimator<ClockT>::estimateQuantiles(
     Range<const double*> quantiles, TimePoint now) {
-  auto digests = bufferedSlidingWindow_.get(now);
-  auto digest = TDigest::merge(digests);
+  auto digest = bufferedSlidingWindow_.getMerged(now);
   return detail::estimatesFromDigest(digest, quantiles);
 }
 
@@ -59,4 +60,25 @@ void SlidingWindowQuantileEstimator<ClockT>::addValue(
   bufferedSlidingWindow_.append(value, now);
 }
 
+template <typename ClockT>
+DecayingQuantileEstimator<ClockT>::DecayingQuantileEstimator(
+    Duration windowDuration, Duration halfLife)
+    : bufferedDigest_(
+          windowDuration,
+          1000,
+          100,
+          std::exp2(-double(windowDuration.count()) / halfLife.count())) {}
+
+template <typename ClockT>
+QuantileEstimates DecayingQuantileEstimator<ClockT>::estimateQuantiles(
+    Range<const double*> quantiles, TimePoint now) {
+  auto digest = bufferedDigest_.get(now);
+  return detail::estimatesFromDigest(digest, quantiles);
+}
+
+template <typename ClockT>
+void DecayingQuantileEstimator<ClockT>::addValue(double value, TimePoint now) {
+  bufferedDigest_.append(value, now);
+}
+
 } // namespace folly
@@ -79,13 +79,46 @@ class SlidingWindowQuantileEstimator {
 
   // Get point-in-time TDigest
   TDigest getDigest(TimePoint now = ClockT::now()) {
-    return TDigest::merge(bufferedSlidingWindow_.get(now));
+    return bufferedSlidingWindow_.getMerged(now);
   }
 
  private:
   detail::BufferedSlidingWindow<TDigest, ClockT> bufferedSlidingWindow_;
 };
 
+/*
+ * A QuantileEstimator over all values added, where the weight of each value
+ * halves every halfLife (see constructor). Values are buffered for
+ * windowDuration, and the weights of older values decay as each window
+ * closes, so the history takes the space of a single TDigest and reads copy
+ * it rather than merging windows. The sum and count in the estimates are
+ * decayed too.
+ */
+template <typename ClockT = std::chrono::steady_clock>
+class DecayingQuantileEstimator {
+ public:
+  using TimePoint = typename ClockT::time_point;
+  using Duration = typename ClockT::duration;
+
+  DecayingQuantileEstimator(Duration windowDuration, Duration halfLife);
+
+  QuantileEstimates estimateQuantiles(
+      Range<const double*> quantiles, TimePoint now = ClockT::now());
+
+  void addValue(double value, TimePoint now = ClockT::now());
+
+  /// Flush buffered values
+  void flush() { bufferedDigest_.flush(); }
+
+  // Get point-in-time TDigest
+  TDigest getDigest(TimePoint now = ClockT::now()) {
+    return bufferedDigest_.get(now);
+  }
+
+ private:
+  detail::BufferedDecayingDigest<TDigest, ClockT> bufferedDigest_;
+};
+
 } // namespace folly
 
 #include <folly/stats/QuantileEstimator-inl.h>
@@ -86,9 +86,18 @@ class PredefinedQuantiles {
 template <class Q = PredefinedQuantiles::Default>
 class QuantileHistogram {
  public:
+  using Locations = typename std::remove_const<decltype(Q::kQuantiles)>::type;
+
   QuantileHistogram() = default;
   explicit QuantileHistogram(size_t) : QuantileHistogram() {}
 
+  /*
+   * Restores a histogram from the locations of its quantiles, in the order of
+   * quantiles(), and its count, as returned by getLocations() and count().
+   */
+  QuantileHistogram(const Locations& locations, uint64_t count)
+      : locations_(locations), count_(count) {}
+
   static constexpr decltype(Q::kQuantiles) quantiles() { return Q::kQuantiles; }
 
   /*
@@ -117,6 +126,8 @@ class QuantileHistogram {
 
   double max() const { return locations_.back(); }
 
+  const Locations& getLocations() const { return locations_; }
+
   std::string debugString() const;
 
  private:
@@ -125,7 +136,7 @@ class QuantileHistogram {
   static_assert(quantiles().back() == 1.0, "Quantile 1.0 is required.");
 
   // locations_ tracks min and max at the two ends.
-  typename std::remove_const<decltype(Q::kQuantiles)>::type locations_{};
+  Locations locations_{};
   uint64_t count_{0};
 
   inline size_t addValueImpl(
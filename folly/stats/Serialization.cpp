@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/Serialization.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <folly/io/BulkVarint.h>
+#include <folly/lang/Bits.h>
+
+namespace folly {
+
+namespace detail {
+
+namespace {
+
+// Maps doubles to integers in the same order, so that the difference between
+// two nearby values is small, by flipping the sign bit of positive values and
+// all the bits of negative ones.
+uint64_t orderedBits(double value) {
+  auto bits = bit_cast<uint64_t>(value);
+  return (bits >> 63) ? ~bits : bits | (uint64_t(1) << 63);
+}
+
+double fromOrderedBits(uint64_t bits) {
+  bits = (bits >> 63) ? bits & ~(uint64_t(1) << 63) : ~bits;
+  return bit_cast<double>(bits);
+}
+
+uint32_t orderedBits(float value) {
+  auto bits = bit_cast<uint32_t>(value);
+  return (bits >> 31) ? ~bits : bits | (uint32_t(1) << 31);
+}
+
+float fromOrderedBits(uint32_t bits) {
+  bits = (bits >> 31) ? bits & ~(uint32_t(1) << 31) : ~bits;
+  return bit_cast<float>(bits);
+}
+
+void readVarints(io::Cursor& cursor, Range<uint64_t*> out) {
+  if (io::decodeVarints(cursor, out) != out.size()) {
+    throw_exception<std::out_of_range>("Truncated stats encoding");
+  }
+}
+
+} // namespace
+
+void writeStatsHeader(
+    io::QueueAppender& appender, StatsEncodingTag tag, uint8_t flags) {
+  appender.write(static_cast<uint8_t>(tag));
+  appender.write(static_cast<uint8_t>(kStatsEncodingVersion | flags));
+}
+
+uint8_t readStatsHeader(io::Cursor& cursor, StatsEncodingTag tag) {
+  auto actualTag = cursor.read<uint8_t>();
+  auto flags = cursor.read<uint8_t>();
+  if (actualTag != static_cast<uint8_t>(tag) ||
+      (flags & 0xf) != kStatsEncodingVersion) {
+    throw_exception<std::invalid_argument>(
+        "Unexpected stats encoding type or version");
+  }
+  return flags;
+}
+
+void writeStatsVarint(io::QueueAppender& appender, uint64_t value) {
+  io::encodeVarints(appender, range(&value, &value + 1));
+}
+
+uint64_t readStatsVarint(io::Cursor& cursor) {
+  uint64_t value;
+  readVarints(cursor, range(&value, &value + 1));
+  return value;
+}
+
+void writeStatsDouble(
+    io::QueueAppender& appender, double value, StatsPrecision precision) {
+  if (precision == StatsPrecision::Float) {
+    appender.writeLE(static_cast<float>(value));
+  } else {
+    appender.writeLE(value);
+  }
+}
+
+double readStatsDouble(io::Cursor& cursor, StatsPrecision precision) {
+  return precision == StatsPrecision::Float ? cursor.readLE<float>()
+                                            : cursor.readLE<double>();
+}
+
+void writeSortedDoubles(
+    io::QueueAppender& appender,
+    Range<const double*> values,
+    StatsPrecision precision) {
+  std::vector<uint64_t> deltas(values.size());
+  uint64_t prev = 0;
+  for (size_t i = 0; i < values.size(); ++i) {
+    uint64_t bits = precision == StatsPrecision::Float
+        ? orderedBits(static_cast<float>(values[i]))
+        : orderedBits(values[i]);
+    deltas[i] = zigzagEncode(static_cast<int64_t>(bits - prev));
+    prev = bits;
+  }
+  io::encodeVarints(appender, range(deltas));
+}
+
+void readSortedDoubles(
+    io::Cursor& cursor, Range<double*> values, StatsPrecision precision) {
+  std::vector<uint64_t> deltas(values.size());
+  readVarints(cursor, range(deltas));
+  uint64_t bits = 0;
+  for (size_t i = 0; i < values.size(); ++i) {
+    bits += static_cast<uint64_t>(zigzagDecode(deltas[i]));
+    values[i] = precision == StatsPrecision::Float
+        ? fromOrderedBits(static_cast<uint32_t>(bits))
+        : fromOrderedBits(bits);
+  }
+}
+
+} // namespace detail
+
+void serializeTDigest(
+    const TDigest& digest,
+    io::QueueAppender& appender,
+    StatsPrecision precision) {
+  auto const& centroids = digest.getCentroids();
+  // Digests built from values have whole weights, which are short varints.
+  bool integral = true;
+  for (auto const& centroid : centroids) {
+    auto weight = centroid.weight();
+    integral = integral && weight == std::floor(weight) && weight < 0x1p53;
+  }
+  uint8_t flags = (precision == StatsPrecision::Float
+                       ? detail::kStatsEncodingFloat
+                       : 0) |
+      (integral ? detail::kStatsEncodingIntegralWeights : 0);
+  detail::writeStatsHeader(appender, detail::StatsEncodingTag::TDigest, flags);
+  detail::writeStatsVarint(appender, digest.maxSize());
+  detail::writeStatsVarint(appender, centroids.size());
+  appender.writeLE(digest.sum());
+  appender.writeLE(digest.count());
+  appender.writeLE(digest.min());
+  appender.writeLE(digest.max());
+
+  std::vector<double> means(centroids.size());
+  for (size_t i = 0; i < centroids.size(); ++i) {
+    means[i] = centroids[i].mean();
+  }
+  detail::writeSortedDoubles(appender, range(means), precision);
+  if (integral) {
+    std::vector<uint64_t> weights(centroids.size());
+    for (size_t i = 0; i < centroids.size(); ++i) {
+      weights[i] = static_cast<uint64_t>(centroids[i].weight());
+    }
+    io::encodeVarints(appender, range(weights));
+  } else {
+    for (auto const& centroid : centroids) {
+      detail::writeStatsDouble(appender, centroid.weight(), precision);
+    }
+  }
+}
+
+TDigest deserializeTDigest(io::Cursor& cursor) {
+  auto flags =
+      detail::readStatsHeader(cursor, detail::StatsEncodingTag::TDigest);
+  auto precision = detail::statsPrecision(flags);
+  auto maxSize = detail::readStatsVarint(cursor);
+  auto numCentroids = detail::readStatsVarint(cursor);
+  auto sum = cursor.readLE<double>();
+  auto count = cursor.readLE<double>();
+  auto min = cursor.readLE<double>();
+  auto max = cursor.readLE<double>();
+  if (maxSize == 0 && numCentroids > 0) {
+    throw_exception<std::invalid_argument>("Malformed TDigest encoding");
+  }
+  // Each centroid takes at least two bytes. Divide rather than multiply, so
+  // that a huge count can't wrap around.
+  if (numCentroids > cursor.totalLength() / 2) {
+    throw_exception<std::out_of_range>("Truncated TDigest encoding");
+  }
+
+  std::vector<double> means(numCentroids);
+  detail::readSortedDoubles(cursor, range(means), precision);
+  std::vector<double> weights(numCentroids);
+  if (flags & detail::kStatsEncodingIntegralWeights) {
+    std::vector<uint64_t> integralWeights(numCentroids);
+    if (io::decodeVarints(cursor, range(integralWeights)) != numCentroids) {
+      throw_exception<std::out_of_range>("Truncated TDigest encoding");
+    }
+    std::copy(
+        integralWeights.begin(), integralWeights.end(), weights.begin());
+  } else {
+    for (auto& weight : weights) {
+      weight = detail::readStatsDouble(cursor, precision);
+    }
+  }
+
+  std::vector<TDigest::Centroid> centroids;
+  centroids.reserve(numCentroids);
+  for (size_t i = 0; i < numCentroids; ++i) {
+    if (!(weights[i] > 0)) {
+      throw_exception<std::invalid_argument>("Malformed TDigest encoding");
+    }
+    centroids.emplace_back(means[i], weights[i]);
+  }
+  return TDigest(std::move(centroids), sum, count, max, min, maxSize);
+}
+
+} // namespace folly
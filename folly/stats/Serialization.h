@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+#include <folly/Range.h>
+#include <folly/io/Cursor.h>
+#include <folly/lang/Exception.h>
+#include <folly/stats/Histogram.h>
+#include <folly/stats/QuantileHistogram.h>
+#include <folly/stats/TDigest.h>
+#include <folly/stats/TimeseriesHistogram.h>
+
+/*
+ * A compact binary encoding of TDigest, QuantileHistogram and Histogram, for
+ * sending digests between hosts to be merged.
+ *
+ * Values that are sorted, such as the centroid means of a TDigest and the
+ * quantile locations of a QuantileHistogram, are mapped to integers in the
+ * same order, and the differences between neighbours are written as varints.
+ * Integral weights and counts are varints. With StatsPrecision::Float, the
+ * values are rounded to float first, which roughly halves their size; the
+ * totals (count, sum, min and max) are always written in full.
+ *
+ * TimeseriesHistogram is sent one level at a time, as the Histogram that
+ * TimeseriesHistogram::addValues() takes on the receiving side.
+ *
+ * The deserialize functions read directly from an IOBuf chain through a
+ * Cursor, without first copying it into contiguous memory, and advance it past
+ * the encoding. They throw std::out_of_range if the chain ends early, and
+ * std::invalid_argument if the encoding is malformed or of another type.
+ */
+
+namespace folly {
+
+enum class StatsPrecision : uint8_t {
+  Double = 0,
+  Float = 1,
+};
+
+void serializeTDigest(
+    const TDigest& digest,
+    io::QueueAppender& appender,
+    StatsPrecision precision = StatsPrecision::Double);
+
+TDigest deserializeTDigest(io::Cursor& cursor);
+
+template <class Q>
+void serializeQuantileHistogram(
+    const QuantileHistogram<Q>& hist,
+    io::QueueAppender& appender,
+    StatsPrecision precision = StatsPrecision::Double);
+
+template <class Q>
+QuantileHistogram<Q> deserializeQuantileHistogram(io::Cursor& cursor);
+
+template <class T>
+void serializeHistogram(
+    const Histogram<T>& hist,
+    io::QueueAppender& appender,
+    StatsPrecision precision = StatsPrecision::Double);
+
+/*
+ * Writes the given level of a TimeseriesHistogram in the encoding of
+ * serializeHistogram().
+ */
+template <class T, class CT, class C>
+void serializeTimeseriesHistogramLevel(
+    const TimeseriesHistogram<T, CT, C>& hist,
+    size_t level,
+    io::QueueAppender& appender,
+    StatsPrecision precision = StatsPrecision::Double);
+
+template <class T>
+Histogram<T> deserializeHistogram(io::Cursor& cursor);
+
+namespace detail {
+
+enum class StatsEncodingTag : uint8_t {
+  TDigest = 1,
+  QuantileHistogram = 2,
+  Histogram = 3,
+};
+
+// The first byte is the tag, the second a format version and flags.
+constexpr uint8_t kStatsEncodingVersion = 1;
+constexpr uint8_t kStatsEncodingFloat = 1 << 4;
+constexpr uint8_t kStatsEncodingIntegralWeights = 1 << 5;
+
+void writeStatsHeader(
+    io::QueueAppender& appender, StatsEncodingTag tag, uint8_t flags);
+uint8_t readStatsHeader(io::Cursor& cursor, StatsEncodingTag tag);
+
+void writeStatsVarint(io::QueueAppender& appender, uint64_t value);
+uint64_t readStatsVarint(io::Cursor& cursor);
+
+void writeStatsDouble(
+    io::QueueAppender& appender, double value, StatsPrecision precision);
+double readStatsDouble(io::Cursor& cursor, StatsPrecision precision);
+
+// Values in increasing order compress best, but any order round-trips.
+void writeSortedDoubles(
+    io::QueueAppender& appender,
+    Range<const double*> values,
+    StatsPrecision precision);
+void readSortedDoubles(
+    io::Cursor& cursor, Range<double*> values, StatsPrecision precision);
+
+inline uint64_t zigzagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+      static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+  return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+template <class T>
+void writeStatsValue(
+    io::QueueAppender& appender, T value, StatsPrecision precision) {
+  if constexpr (std::is_floating_point<T>::value) {
+    writeStatsDouble(appender, static_cast<double>(value), precision);
+  } else if constexpr (std::is_signed<T>::value) {
+    writeStatsVarint(appender, zigzagEncode(static_cast<int64_t>(value)));
+  } else {
+    writeStatsVarint(appender, static_cast<uint64_t>(value));
+  }
+}
+
+template <class T>
+T readStatsValue(io::Cursor& cursor, StatsPrecision precision) {
+  if constexpr (std::is_floating_point<T>::value) {
+    return static_cast<T>(readStatsDouble(cursor, precision));
+  } else if constexpr (std::is_signed<T>::value) {
+    return static_cast<T>(zigzagDecode(readStatsVarint(cursor)));
+  } else {
+    return static_cast<T>(readStatsVarint(cursor));
+  }
+}
+
+inline StatsPrecision statsPrecision(uint8_t flags) {
+  return (flags & kStatsEncodingFloat) ? StatsPrecision::Float
+                                       : StatsPrecision::Double;
+}
+
+// Each bucket is a varint of twice its count, plus one if the sum follows.
+template <class T, class SumAndCount>
+void serializeHistogramBuckets(
+    io::QueueAppender& appender,
+    T bucketSize,
+    T min,
+    T max,
+    size_t numBuckets,
+    StatsPrecision precision,
+    SumAndCount sumAndCount) {
+  writeStatsHeader(
+      appender,
+      StatsEncodingTag::Histogram,
+      precision == StatsPrecision::Float ? kStatsEncodingFloat : 0);
+  writeStatsValue(appender, bucketSize, precision);
+  writeStatsValue(appender, min, precision);
+  writeStatsValue(appender, max, precision);
+  writeStatsVarint(appender, numBuckets);
+  for (size_t i = 0; i < numBuckets; ++i) {
+    auto [sum, count] = sumAndCount(i);
+    bool hasSum = sum != T();
+    writeStatsVarint(appender, (count << 1) | (hasSum ? 1 : 0));
+    if (hasSum) {
+      writeStatsValue(appender, sum, precision);
+    }
+  }
+}
+
+} // namespace detail
+
+template <class Q>
+void serializeQuantileHistogram(
+    const QuantileHistogram<Q>& hist,
+    io::QueueAppender& appender,
+    StatsPrecision precision) {
+  detail::writeStatsHeader(
+      appender,
+      detail::StatsEncodingTag::QuantileHistogram,
+      precision == StatsPrecision::Float ? detail::kStatsEncodingFloat : 0);
+  auto const& locations = hist.getLocations();
+  detail::writeStatsVarint(appender, locations.size());
+  detail::writeStatsVarint(appender, hist.count());
+  detail::writeSortedDoubles(appender, range(locations), precision);
+}
+
+template <class Q>
+QuantileHistogram<Q> deserializeQuantileHistogram(io::Cursor& cursor) {
+  auto flags = detail::readStatsHeader(
+      cursor, detail::StatsEncodingTag::QuantileHistogram);
+  typename std::remove_const<decltype(Q::kQuantiles)>::type locations{};
+  if (detail::readStatsVarint(cursor) != locations.size()) {
+    throw_exception<std::invalid_argument>(
+        "QuantileHistogram encoding has different quantiles");
+  }
+  auto count = detail::readStatsVarint(cursor);
+  detail::readSortedDoubles(
+      cursor, range(locations), detail::statsPrecision(flags));
+  return QuantileHistogram<Q>(locations, count);
+}
+
+template <class T>
+void serializeHistogram(
+    const Histogram<T>& hist,
+    io::QueueAppender& appender,
+    StatsPrecision precision) {
+  detail::serializeHistogramBuckets(
+      appender,
+      hist.getBucketSize(),
+      hist.getMin(),
+      hist.getMax(),
+      hist.getNumBuckets(),
+      precision,
+      [&](size_t i) {
+        auto const& bucket = hist.getBucketByIndex(i);
+        return std::make_pair(bucket.sum, bucket.count);
+      });
+}
+
+template <class T, class CT, class C>
+void serializeTimeseriesHistogramLevel(
+    const TimeseriesHistogram<T, CT, C>& hist,
+    size_t level,
+    io::QueueAppender& appender,
+    StatsPrecision precision) {
+  detail::serializeHistogramBuckets(
+      appender,
+      hist.getBucketSize(),
+      hist.getMin(),
+      hist.getMax(),
+      hist.getNumBuckets(),
+      precision,
+      [&](size_t i) {
+        auto const& bucket = hist.getBucket(i);
+        return std::make_pair(
+            static_cast<T>(bucket.sum(level)), bucket.count(level));
+      });
+}
+
+template <class T>
+Histogram<T> deserializeHistogram(io::Cursor& cursor) {
+  auto flags =
+      detail::readStatsHeader(cursor, detail::StatsEncodingTag::Histogram);
+  auto precision = detail::statsPrecision(flags);
+  auto bucketSize = detail::readStatsValue<T>(cursor, precision);
+  auto min = detail::readStatsValue<T>(cursor, precision);
+  auto max = detail::readStatsValue<T>(cursor, precision);
+  if (!(bucketSize > T()) || !(max > min)) {
+    throw_exception<std::invalid_argument>("Malformed Histogram encoding");
+  }
+  Histogram<T> hist(bucketSize, min, max);
+  if (detail::readStatsVarint(cursor) != hist.getNumBuckets()) {
+    throw_exception<std::invalid_argument>("Malformed Histogram encoding");
+  }
+  for (size_t i = 0; i < hist.getNumBuckets(); ++i) {
+    auto header = detail::readStatsVarint(cursor);
+    T sum = (header & 1) ? detail::readStatsValue<T>(cursor, precision) : T();
+    hist.addBucketAggregated(i, sum, header >> 1);
+  }
+  return hist;
+}
+
+} // namespace folly
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/SpaceSaving.h>
+
+#include <algorithm>
+
+#include <folly/container/F14Map.h>
+
+namespace folly {
+
+namespace {
+
+bool greaterCount(
+    const SpaceSaving::Counter& lhs, const SpaceSaving::Counter& rhs) {
+  return lhs.count > rhs.count || (lhs.count == rhs.count && lhs.key < rhs.key);
+}
+
+} // namespace
+
+void SpaceSaving::add(uint64_t key, uint64_t count) {
+  if (capacity_ == 0) {
+    return;
+  }
+  count_ += count;
+  // Capacities are small enough that a linear scan beats maintaining a heap.
+  Counter* min = nullptr;
+  for (auto& counter : counters_) {
+    if (counter.key == key) {
+      counter.count += count;
+      return;
+    }
+    if (!min || counter.count < min->count) {
+      min = &counter;
+    }
+  }
+  if (counters_.size() < capacity_) {
+    counters_.push_back({key, count, 0});
+  } else {
+    *min = {key, min->count + count, min->count};
+  }
+}
+
+SpaceSaving SpaceSaving::merge(Range<const uint64_t*> keys) const {
+  if (keys.empty()) {
+    return *this;
+  }
+  // Count the batch exactly, then merge it in as a summary of its own.
+  F14FastMap<uint64_t, uint64_t> counts;
+  for (auto key : keys) {
+    ++counts[key];
+  }
+  SpaceSaving batch(capacity_);
+  batch.count_ = keys.size();
+  batch.counters_.reserve(counts.size());
+  for (auto [key, count] : counts) {
+    batch.counters_.push_back({key, count, 0});
+  }
+  if (batch.counters_.size() > capacity_) {
+    // Keeping the largest counts of an exact summary is itself a summary,
+    // whose error is bounded by the largest count dropped.
+    std::nth_element(
+        batch.counters_.begin(),
+        batch.counters_.begin() + capacity_,
+        batch.counters_.end(),
+        greaterCount);
+    auto dropped = batch.counters_[capacity_].count;
+    batch.counters_.resize(capacity_);
+    for (auto& counter : batch.counters_) {
+      counter.count += dropped;
+      counter.error += dropped;
+    }
+  }
+  SpaceSaving summaries[] = {*this, std::move(batch)};
+  return merge(range(summaries));
+}
+
+SpaceSaving SpaceSaving::merge(Range<const SpaceSaving*> summaries) {
+  if (summaries.empty()) {
+    return SpaceSaving();
+  }
+  SpaceSaving result(summaries.front().capacity_);
+  if (result.capacity_ == 0) {
+    return result;
+  }
+  // A key missing from a full summary may have been counted up to the
+  // smallest count in it, so it is charged that count, as error.
+  std::vector<uint64_t> mins;
+  mins.reserve(summaries.size());
+  uint64_t sumOfMins = 0;
+  F14FastMap<uint64_t, Counter> merged;
+  for (const auto& summary : summaries) {
+    uint64_t min = 0;
+    if (summary.counters_.size() >= summary.capacity_) {
+      for (const auto& counter : summary.counters_) {
+        min = (min == 0 || counter.count < min) ? counter.count : min;
+      }
+    }
+    mins.push_back(min);
+    sumOfMins += min;
+    result.count_ += summary.count_;
+    for (const auto& counter : summary.counters_) {
+      auto& c = merged.try_emplace(counter.key, Counter{counter.key, 0, 0})
+                    .first->second;
+      c.count += counter.count - min;
+      c.error += counter.error - min;
+    }
+  }
+  result.counters_.reserve(merged.size());
+  for (auto& [key, counter] : merged) {
+    counter.count += sumOfMins;
+    counter.error += sumOfMins;
+    result.counters_.push_back(counter);
+  }
+  if (result.counters_.size() > result.capacity_) {
+    std::nth_element(
+        result.counters_.begin(),
+        result.counters_.begin() + result.capacity_,
+        result.counters_.end(),
+        greaterCount);
+    result.counters_.resize(result.capacity_);
+  }
+  return result;
+}
+
+std::vector<SpaceSaving::Counter> SpaceSaving::topK(size_t k) const {
+  std::vector<Counter> result(counters_);
+  k = std::min(k, result.size());
+  std::partial_sort(
+      result.begin(), result.begin() + k, result.end(), greaterCount);
+  result.resize(k);
+  return result;
+}
+
+const SpaceSaving::Counter* SpaceSaving::find(uint64_t key) const {
+  for (const auto& counter : counters_) {
+    if (counter.key == key) {
+      return &counter;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace folly
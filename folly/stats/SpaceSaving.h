@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <folly/Range.h>
+
+namespace folly {
+
+/*
+ * SpaceSaving tracks the most frequent keys in a stream using a fixed number
+ * of counters (Metwally et al., "Efficient Computation of Frequent and Top-k
+ * Elements in Data Streams"). When a new key arrives and all counters are in
+ * use, it replaces the key with the smallest count and inherits that count as
+ * its error. Every key whose true count exceeds count() / capacity is
+ * tracked, and each counter overestimates its key's count by at most error.
+ *
+ * Like TDigest, it is a mergeable digest that DigestBuilder and the stats in
+ * folly/stats/HeavyHitters.h can build from buffered keys. Summaries are
+ * merged as in Agarwal et al., "Mergeable Summaries", which keeps the same
+ * guarantees over the union of the streams.
+ */
+class SpaceSaving {
+ public:
+  using value_type = uint64_t;
+
+  struct Counter {
+    uint64_t key;
+    uint64_t count;
+    uint64_t error;
+  };
+
+  explicit SpaceSaving(size_t capacity = 100) : capacity_(capacity) {}
+
+  void add(uint64_t key, uint64_t count = 1);
+
+  SpaceSaving merge(Range<const uint64_t*> keys) const;
+
+  static SpaceSaving merge(Range<const SpaceSaving*> summaries);
+
+  /*
+   * Returns up to k counters in decreasing order of count.
+   */
+  std::vector<Counter> topK(size_t k) const;
+
+  /* Returns the counter for key, if it is tracked, and nullptr otherwise. */
+  const Counter* find(uint64_t key) const;
+
+  size_t capacity() const { return capacity_; }
+
+  /* The number of keys added */
+  uint64_t count() const { return count_; }
+
+  bool empty() const { return count_ == 0; }
+
+ private:
+  size_t capacity_;
+  uint64_t count_{0};
+  std::vector<Counter> counters_; // Unordered, at most capacity_
+};
+
+} // namespace folly
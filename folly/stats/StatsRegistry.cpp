@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/StatsRegistry.h>
+
+#include <stdexcept>
+
+#include <folly/Conv.h>
+#include <folly/Indestructible.h>
+#include <folly/json/dynamic.h>
+#include <folly/json/json.h>
+#include <folly/lang/Exception.h>
+
+namespace folly {
+
+StatsRegistry& StatsRegistry::global() {
+  static Indestructible<StatsRegistry> registry;
+  return *registry;
+}
+
+bool StatsRegistry::contains(StringPiece name) const {
+  return counters_.count(name) || stats_.count(name) ||
+      histograms_.count(name);
+}
+
+template <typename T>
+T& StatsRegistry::getOrCreate(
+    F14NodeMap<std::string, T>& map, StringPiece name) {
+  {
+    std::shared_lock g(mutex_);
+    auto it = map.find(name);
+    if (it != map.end()) {
+      return it->second;
+    }
+  }
+  std::unique_lock g(mutex_);
+  auto it = map.find(name);
+  if (it != map.end()) {
+    return it->second;
+  }
+  if (contains(name)) {
+    throw_exception<std::invalid_argument>(to<std::string>(
+        "Stat ", name, " is already registered as another kind"));
+  }
+  return map.try_emplace(name.str()).first->second;
+}
+
+StatsRegistry::Counter& StatsRegistry::counter(StringPiece name) {
+  return getOrCreate(counters_, name);
+}
+
+StatsRegistry::Stat& StatsRegistry::stat(StringPiece name) {
+  return getOrCreate(stats_, name);
+}
+
+StatsRegistry::Histogram& StatsRegistry::histogram(StringPiece name) {
+  return getOrCreate(histograms_, name);
+}
+
+StatsRegistry::Snapshot StatsRegistry::snapshot() const {
+  Snapshot snapshot;
+  std::shared_lock g(mutex_);
+  for (const auto& [name, counter] : counters_) {
+    snapshot.counters.emplace(name, counter.read());
+  }
+  for (const auto& [name, stat] : stats_) {
+    snapshot.stats.emplace(name, Snapshot::StatValue{stat.sum(), stat.count()});
+  }
+  for (const auto& [name, histogram] : histograms_) {
+    snapshot.histograms.emplace(
+        name,
+        Snapshot::HistogramValue{
+            histogram.count(),
+            histogram.estimateQuantile(0.5),
+            histogram.estimateQuantile(0.9),
+            histogram.estimateQuantile(0.99),
+            histogram.estimateQuantile(0.999)});
+  }
+  return snapshot;
+}
+
+std::string StatsRegistry::Snapshot::toText() const {
+  std::map<std::string, std::string> lines;
+  for (const auto& [name, value] : counters) {
+    lines.emplace(name, to<std::string>(value));
+  }
+  for (const auto& [name, value] : stats) {
+    lines.emplace(name + ".sum", to<std::string>(value.sum));
+    lines.emplace(name + ".count", to<std::string>(value.count));
+    lines.emplace(name + ".avg", to<std::string>(value.avg()));
+  }
+  for (const auto& [name, value] : histograms) {
+    lines.emplace(name + ".count", to<std::string>(value.count));
+    lines.emplace(name + ".p50", to<std::string>(value.p50));
+    lines.emplace(name + ".p90", to<std::string>(value.p90));
+    lines.emplace(name + ".p99", to<std::string>(value.p99));
+    lines.emplace(name + ".p999", to<std::string>(value.p999));
+  }
+  std::string out;
+  for (const auto& [name, value] : lines) {
+    toAppend(name, ' ', value, '\n', &out);
+  }
+  return out;
+}
+
+std::string StatsRegistry::Snapshot::toJson() const {
+  dynamic counterValues = dynamic::object;
+  for (const auto& [name, value] : counters) {
+    counterValues[name] = value;
+  }
+  dynamic statValues = dynamic::object;
+  for (const auto& [name, value] : stats) {
+    statValues[name] = dynamic::object("sum", value.sum)(
+        "count", value.count)("avg", value.avg());
+  }
+  dynamic histogramValues = dynamic::object;
+  for (const auto& [name, value] : histograms) {
+    histogramValues[name] = dynamic::object(
+        "count", static_cast<int64_t>(value.count))(
+        "p50", static_cast<int64_t>(value.p50))(
+        "p90", static_cast<int64_t>(value.p90))(
+        "p99", static_cast<int64_t>(value.p99))(
+        "p999", static_cast<int64_t>(value.p999));
+  }
+  json::serialization_opts opts;
+  opts.sort_keys = true;
+  return json::serialize(
+      dynamic::object("counters", std::move(counterValues))(
+          "stats", std::move(statValues))(
+          "histograms", std::move(histogramValues)),
+      opts);
+}
+
+} // namespace folly
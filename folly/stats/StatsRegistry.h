@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include <folly/Range.h>
+#include <folly/SharedMutex.h>
+#include <folly/ThreadCachedInt.h>
+#include <folly/container/F14Map.h>
+#include <folly/stats/LogLinearHistogram.h>
+
+namespace folly {
+
+/*
+ * StatsRegistry is a shared place for libraries to export named counters,
+ * averages and histograms, and for one exporter to scrape them all.
+ *
+ * Registering a stat takes a lock, so look each one up once and keep the
+ * reference, which is valid for the lifetime of the registry:
+ *
+ *   static auto& requests = StatsRegistry::global().counter("foo.requests");
+ *   requests.increment();
+ *
+ * Updates never take the registry lock. Counters and stats are
+ * ThreadCachedInts, which add to a thread-local cache and publish it every
+ * 1000 increments; histograms are LogLinearHistograms, which increment a
+ * relaxed atomic per bucket. snapshot() reads them all without blocking
+ * writers, only registration, so values being updated concurrently may be
+ * missing from it.
+ *
+ * A name can be used by only one kind of stat; reusing it for another kind
+ * throws std::invalid_argument.
+ */
+class StatsRegistry {
+ public:
+  class Counter {
+   public:
+    void increment(int64_t n = 1) { value_.increment(n); }
+
+    int64_t read() const { return value_.readFull(); }
+
+   private:
+    ThreadCachedInt<int64_t, StatsRegistry> value_;
+  };
+
+  /* Exports the sum, count and average of the values added. */
+  class Stat {
+   public:
+    void addValue(int64_t value) {
+      sum_.increment(value);
+      count_.increment(1);
+    }
+
+    int64_t sum() const { return sum_.readFull(); }
+
+    int64_t count() const { return count_.readFull(); }
+
+   private:
+    ThreadCachedInt<int64_t, StatsRegistry> sum_;
+    ThreadCachedInt<int64_t, StatsRegistry> count_;
+  };
+
+  using Histogram = LogLinearHistogram<>;
+
+  struct Snapshot {
+    struct StatValue {
+      int64_t sum;
+      int64_t count;
+
+      double avg() const { return count ? double(sum) / count : 0.0; }
+    };
+
+    struct HistogramValue {
+      uint64_t count;
+      uint64_t p50;
+      uint64_t p90;
+      uint64_t p99;
+      uint64_t p999;
+    };
+
+    std::map<std::string, int64_t> counters;
+    std::map<std::string, StatValue> stats;
+    std::map<std::string, HistogramValue> histograms;
+
+    /*
+     * One "<name> <value>" line per value, sorted by name. Stats export
+     * <name>.sum, <name>.count and <name>.avg, and histograms <name>.count
+     * and the percentiles <name>.p50, .p90, .p99 and .p999.
+     */
+    std::string toText() const;
+
+    /*
+     * A JSON object with "counters", "stats" and "histograms" members, each
+     * an object from names to values, with sorted keys.
+     */
+    std::string toJson() const;
+  };
+
+  StatsRegistry() = default;
+
+  StatsRegistry(const StatsRegistry&) = delete;
+  StatsRegistry& operator=(const StatsRegistry&) = delete;
+
+  /* The registry shared by the whole process, which is never destroyed. */
+  static StatsRegistry& global();
+
+  /* Returns the stat with the given name, creating it if needed. */
+  Counter& counter(StringPiece name);
+  Stat& stat(StringPiece name);
+  Histogram& histogram(StringPiece name);
+
+  Snapshot snapshot() const;
+
+ private:
+  template <typename T>
+  T& getOrCreate(F14NodeMap<std::string, T>& map, StringPiece name);
+
+  bool contains(StringPiece name) const;
+
+  mutable SharedMutex mutex_;
+  F14NodeMap<std::string, Counter> counters_;
+  F14NodeMap<std::string, Stat> stats_;
+  F14NodeMap<std::string, Histogram> histograms_;
+};
+
+} // namespace folly
@@ -23,6 +23,7 @@
 #include <tuple>
 #include <type_traits>
 
+#include <folly/Range.h>
 #include <folly/lang/Exception.h>
 
 namespace folly {
@@ -30,6 +31,10 @@ namespace folly {
 // Robust and efficient online computation of statistics,
 // using Welford's method for variance.
 // https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Welford's_online_algorithm
+//
+// Contiguous batches of samples and other StreamingStats are combined using
+// the parallel algorithm of Chan et al.
+// https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Parallel_algorithm
 
 template <typename SampleDataType, typename StatsType = double>
 class StreamingStats final {
@@ -80,6 +85,17 @@ class StreamingStats final {
     m2_ += delta * delta2;
   }
 
+  /// Add a contiguous batch of samples. Much faster than adding them one at
+  /// a time: the statistics of each block are computed in two passes that
+  /// the compiler can vectorize, and then merged.
+  void add(Range<const SampleDataType*> values) noexcept {
+    while (!values.empty()) {
+      size_t const n = std::min(values.size(), kBlockSize);
+      addBlock(values.data(), n);
+      values.advance(n);
+    }
+  }
+
   /// Merge with an existing StreamingStats object
   void merge(StreamingStats const& other) {
     if (other.count_ == 0) {
@@ -87,19 +103,7 @@ class StreamingStats final {
     }
     max_ = std::max(max_, other.max_);
     min_ = std::min(min_, other.min_);
-    size_t const new_size = count_ + other.count_;
-    StatsType const new_mean =
-        (mean_ * count_ + other.mean_ * other.count_) / new_size;
-    // Each cumulant must be corrected.
-    //   * from: sum((x_i - mean_)²)
-    //   * to:   sum((x_i - new_mean)²)
-    auto delta = [&](auto const& stats) {
-      return stats.count_ *
-          (new_mean * (new_mean - 2 * stats.mean_) + stats.mean_ * stats.mean_);
-    };
-    m2_ = m2_ + delta(*this) + other.m2_ + delta(other);
-    mean_ = new_mean;
-    count_ = new_size;
+    combine(other.count_, other.mean_, other.m2_);
   }
 
   size_t count() const noexcept { return count_; }
@@ -161,6 +165,68 @@ class StreamingStats final {
     }
   }
 
+  // Large enough to amortize the merge, small enough to stay in L1 for the
+  // second pass.
+  static constexpr size_t kBlockSize = 1024;
+  // Independent accumulators, so that the sums can be vectorized without
+  // reassociating floating point additions.
+  static constexpr size_t kLanes = 8;
+
+  void addBlock(SampleDataType const* data, size_t n) noexcept {
+    StatsType sums[kLanes] = {};
+    SampleDataType mins[kLanes];
+    SampleDataType maxs[kLanes];
+    std::fill(mins, mins + kLanes, min_);
+    std::fill(maxs, maxs + kLanes, max_);
+    size_t const vectorized = n - n % kLanes;
+    for (size_t i = 0; i < vectorized; i += kLanes) {
+      for (size_t j = 0; j < kLanes; ++j) {
+        sums[j] += static_cast<StatsType>(data[i + j]);
+        mins[j] = std::min(mins[j], data[i + j]);
+        maxs[j] = std::max(maxs[j], data[i + j]);
+      }
+    }
+    for (size_t i = vectorized; i < n; ++i) {
+      sums[0] += static_cast<StatsType>(data[i]);
+      mins[0] = std::min(mins[0], data[i]);
+      maxs[0] = std::max(maxs[0], data[i]);
+    }
+    StatsType sum = 0;
+    for (size_t j = 0; j < kLanes; ++j) {
+      sum += sums[j];
+      min_ = std::min(min_, mins[j]);
+      max_ = std::max(max_, maxs[j]);
+    }
+    StatsType const mean = sum / n;
+
+    StatsType m2s[kLanes] = {};
+    for (size_t i = 0; i < vectorized; i += kLanes) {
+      for (size_t j = 0; j < kLanes; ++j) {
+        StatsType const delta = static_cast<StatsType>(data[i + j]) - mean;
+        m2s[j] += delta * delta;
+      }
+    }
+    for (size_t i = vectorized; i < n; ++i) {
+      StatsType const delta = static_cast<StatsType>(data[i]) - mean;
+      m2s[0] += delta * delta;
+    }
+    StatsType m2 = 0;
+    for (size_t j = 0; j < kLanes; ++j) {
+      m2 += m2s[j];
+    }
+    combine(n, mean, m2);
+  }
+
+  // Merges the count, mean and m2 of disjoint samples into this.
+  void combine(size_t count, StatsType mean, StatsType m2) noexcept {
+    size_t const newCount = count_ + count;
+    StatsType const delta = mean - mean_;
+    StatsType const weight = static_cast<StatsType>(count) / newCount;
+    mean_ += delta * weight;
+    m2_ += m2 + delta * delta * count_ * weight;
+    count_ = newCount;
+  }
+
   StatsType var_(size_t bias) const noexcept { return m2_ / (count_ - bias); }
 
   StatsType std_(size_t bias) const noexcept { return std::sqrt(var_(bias)); }
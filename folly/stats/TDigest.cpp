@@ -70,6 +70,32 @@ static double k_to_q(double k, double d) {
   }
 }
 
+/*
+ * Fills limits[k] = k_to_q(k, d) * count for k in [0, d], which bounds the
+ * weight seen so far while filling the centroid for k. Both sides of the
+ * scaling function are computed and one is selected, so that the loop has no
+ * branches and vectorizes, rather than evaluating k_to_q once per centroid.
+ */
+static void fill_q_limits(std::vector<double>& limits, size_t d, double count) {
+  limits.resize(d + 1);
+  double const dd = static_cast<double>(d);
+  double* out = limits.data();
+  for (size_t k = 0; k <= d; ++k) {
+    double k_div_d = static_cast<double>(k) / dd;
+    double base = 1 - k_div_d;
+    double hi = 1 - 2 * base * base;
+    double lo = 2 * k_div_d * k_div_d;
+    out[k] = (k_div_d >= 0.5 ? hi : lo) * count;
+  }
+}
+
+static double q_limit(
+    const std::vector<double>& limits, double k, size_t d, double count) {
+  auto i = static_cast<size_t>(k);
+  // Rounding can carry the weight seen so far past count, and k past d
+  return i < limits.size() ? limits[i] : k_to_q(k, d) * count;
+}
+
 static double clamp(double v, double lo, double hi) {
   if (v > hi) {
     return hi;
@@ -151,8 +177,12 @@ TDigest TDigest::merge(
   std::vector<Centroid> compressed;
   compressed.reserve(maxSize_);
 
+  std::vector<double> limits;
+  fill_q_limits(limits, maxSize_, result.count_);
+
   double k_limit = 1;
-  double q_limit_times_count = k_to_q(k_limit++, maxSize_) * result.count_;
+  double q_limit_times_count =
+      q_limit(limits, k_limit++, maxSize_, result.count_);
 
   auto it_centroids = centroids_.begin();
   auto it_sortedValues = sortedValues.begin();
@@ -194,7 +224,8 @@ TDigest TDigest::merge(
       sumsToMerge = 0;
       weightsToMerge = 0;
       compressed.push_back(cur);
-      q_limit_times_count = k_to_q(k_limit++, maxSize_) * result.count_;
+      q_limit_times_count =
+          q_limit(limits, k_limit++, maxSize_, result.count_);
       cur = next;
     }
   }
@@ -246,29 +277,30 @@ TDigest TDigest::merge(Range<const TDigest*> digests) {
     }
   }
 
+  // Merge sorted runs pairwise, doubling the run length each pass, between two
+  // buffers that are allocated once rather than once per merge.
   size_t startsSize = starts.size();
-  for (size_t digestsPerBlock = 1; digestsPerBlock < startsSize;
-       digestsPerBlock *= 2) {
-    // Each sorted block is digestPerBlock digests big. For each step, try to
-    // merge two blocks together.
-    for (size_t i = 0; i < startsSize; i += (digestsPerBlock * 2)) {
-      // It is possible that this block is incomplete (less than digestsPerBlock
-      // big). In that case, the rest of the block is sorted and leave it alone
-      if (i + digestsPerBlock < startsSize) {
+  if (startsSize > 1) {
+    std::vector<Centroid> buffer(centroids.size());
+    for (size_t digestsPerBlock = 1; digestsPerBlock < startsSize;
+         digestsPerBlock *= 2) {
+      for (size_t i = 0; i < startsSize; i += (digestsPerBlock * 2)) {
+        // The last blocks can be incomplete, and so run to the end.
         auto first = starts[i];
-        auto middle = starts[i + digestsPerBlock];
-
-        // It is possible that the next block is incomplete (less than
-        // digestsPerBlock big). In that case, merge to end. Otherwise, merge to
-        // the end of that block.
+        auto middle = (i + digestsPerBlock < startsSize)
+            ? starts[i + digestsPerBlock]
+            : centroids.size();
         auto last = (i + (digestsPerBlock * 2) < startsSize)
             ? starts[i + 2 * digestsPerBlock]
             : centroids.size();
-        std::inplace_merge(
+        std::merge(
             centroids.begin() + first,
             centroids.begin() + middle,
-            centroids.begin() + last);
+            centroids.begin() + middle,
+            centroids.begin() + last,
+            buffer.begin() + first);
       }
+      centroids.swap(buffer);
     }
   }
 
@@ -280,8 +312,11 @@ TDigest TDigest::merge(Range<const TDigest*> digests) {
   std::vector<Centroid> compressed;
   compressed.reserve(maxSize);
 
+  std::vector<double> limits;
+  fill_q_limits(limits, maxSize, count);
+
   double k_limit = 1;
-  double q_limit_times_count = k_to_q(k_limit, maxSize) * count;
+  double q_limit_times_count = q_limit(limits, k_limit, maxSize, count);
 
   Centroid cur = centroids.front();
   double weightSoFar = cur.weight();
@@ -297,7 +332,7 @@ TDigest TDigest::merge(Range<const TDigest*> digests) {
       sumsToMerge = 0;
       weightsToMerge = 0;
       compressed.push_back(cur);
-      q_limit_times_count = k_to_q(k_limit++, maxSize) * count;
+      q_limit_times_count = q_limit(limits, k_limit++, maxSize, count);
       cur = *it;
     }
   }
@@ -315,6 +350,19 @@ TDigest TDigest::merge(Range<const TDigest*> digests) {
   return result;
 }
 
+TDigest TDigest::scaled(double factor) const {
+  TDigest result(*this);
+  result.sum_ *= factor;
+  result.count_ *= factor;
+  if (!(result.count_ > 0)) {
+    return TDigest(maxSize_);
+  }
+  for (auto& centroid : result.centroids_) {
+    centroid = Centroid(centroid.mean(), centroid.weight() * factor);
+  }
+  return result;
+}
+
 double TDigest::estimateQuantile(double q) const {
   if (centroids_.empty()) {
     return 0.0;
@@ -103,6 +103,13 @@ class TDigest {
    */
   static TDigest merge(Range<const TDigest*> digests);
 
+  /*
+   * Returns a copy with the weight of every centroid, and so the count and
+   * sum, multiplied by factor, for example to decay old values. The min and
+   * max are unchanged. Returns an empty digest if no weight is left.
+   */
+  TDigest scaled(double factor) const;
+
   /*
    * Estimates the value of the given quantile.
    */
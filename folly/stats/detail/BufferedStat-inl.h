@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cmath>
+
 namespace folly {
 namespace detail {
 
@@ -29,7 +31,7 @@ BufferedStat<DigestT, ClockT>::BufferedStat(
       digestBuilder_(bufferSize, digestSize) {}
 
 template <typename DigestT, typename ClockT>
-void BufferedStat<DigestT, ClockT>::append(double value, TimePoint now) {
+void BufferedStat<DigestT, ClockT>::append(value_type value, TimePoint now) {
   if (FOLLY_UNLIKELY(now > expiry_.load(std::memory_order_relaxed))) {
     std::unique_lock<SharedMutex> g(mutex_, std::try_to_lock_t());
     if (g.owns_lock()) {
@@ -109,6 +111,7 @@ BufferedSlidingWindow<DigestT, ClockT>::BufferedSlidingWindow(
     size_t bufferSize,
     size_t digestSize)
     : BufferedStat<DigestT, ClockT>(bufferDuration, bufferSize, digestSize),
+      digestSize_(digestSize),
       slidingWindow_([=]() { return DigestT(digestSize); }, nBuckets) {}
 
 template <typename DigestT, typename ClockT>
@@ -128,12 +131,29 @@ std::vector<DigestT> BufferedSlidingWindow<DigestT, ClockT>::get(
   return digests;
 }
 
+template <typename DigestT, typename ClockT>
+DigestT BufferedSlidingWindow<DigestT, ClockT>::getMerged(TimePoint now) {
+  auto g = this->updateIfExpired(now);
+  if (!merged_) {
+    auto digests = slidingWindow_.get();
+    digests.erase(
+        std::remove_if(
+            digests.begin(),
+            digests.end(),
+            [](const DigestT& digest) { return digest.empty(); }),
+        digests.end());
+    merged_ = digests.empty() ? DigestT(digestSize_) : DigestT::merge(digests);
+  }
+  return *merged_;
+}
+
 template <typename DigestT, typename ClockT>
 void BufferedSlidingWindow<DigestT, ClockT>::onNewDigest(
     DigestT digest,
     TimePoint newExpiry,
     TimePoint oldExpiry,
     const std::unique_lock<SharedMutex>& /*g*/) {
+  merged_.reset();
   if (newExpiry > oldExpiry) {
     auto diff = newExpiry - oldExpiry;
     slidingWindow_.slide(diff / this->bufferDuration_);
@@ -146,5 +166,37 @@ void BufferedSlidingWindow<DigestT, ClockT>::onNewDigest(
   }
 }
 
+template <typename DigestT, typename ClockT>
+BufferedDecayingDigest<DigestT, ClockT>::BufferedDecayingDigest(
+    typename ClockT::duration bufferDuration,
+    size_t bufferSize,
+    size_t digestSize,
+    double decay)
+    : BufferedStat<DigestT, ClockT>(bufferDuration, bufferSize, digestSize),
+      decay_(decay),
+      digest_(digestSize) {}
+
+template <typename DigestT, typename ClockT>
+DigestT BufferedDecayingDigest<DigestT, ClockT>::get(TimePoint now) {
+  auto g = this->updateIfExpired(now);
+  return digest_;
+}
+
+template <typename DigestT, typename ClockT>
+void BufferedDecayingDigest<DigestT, ClockT>::onNewDigest(
+    DigestT digest,
+    TimePoint newExpiry,
+    TimePoint oldExpiry,
+    const std::unique_lock<SharedMutex>& /*g*/) {
+  if (newExpiry > oldExpiry) {
+    auto windows = (newExpiry - oldExpiry) / this->bufferDuration_;
+    // The new values belong to the window that closed at oldExpiry.
+    digest_ = digest_.scaled(std::pow(decay_, windows));
+    digest = digest.scaled(std::pow(decay_, windows - 1));
+  }
+  std::array<DigestT, 2> a{{std::move(digest_), std::move(digest)}};
+  digest_ = DigestT::merge(a);
+}
+
 } // namespace detail
 } // namespace folly
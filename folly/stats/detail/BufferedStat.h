@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include <folly/SharedMutex.h>
 #include <folly/stats/DigestBuilder.h>
 #include <folly/stats/detail/SlidingWindow.h>
@@ -32,6 +34,7 @@ template <typename DigestT, typename ClockT>
 class BufferedStat {
  public:
   using TimePoint = typename ClockT::time_point;
+  using value_type = typename DigestBuilder<DigestT>::value_type;
 
   BufferedStat() = delete;
 
@@ -42,7 +45,7 @@ class BufferedStat {
 
   virtual ~BufferedStat() {}
 
-  void append(double value, TimePoint now = ClockT::now());
+  void append(value_type value, TimePoint now = ClockT::now());
 
   void flush();
 
@@ -145,6 +148,13 @@ class BufferedSlidingWindow : public BufferedStat<DigestT, ClockT> {
 
   std::vector<DigestT> get(TimePoint now = ClockT::now());
 
+  /*
+   * Returns the merge of all windows. It is cached until the windows next
+   * change, so frequent reads cost a copy of one digest rather than a merge
+   * of every window.
+   */
+  DigestT getMerged(TimePoint now = ClockT::now());
+
   void onNewDigest(
       DigestT digest,
       TimePoint newExpiry,
@@ -152,7 +162,39 @@ class BufferedSlidingWindow : public BufferedStat<DigestT, ClockT> {
       const std::unique_lock<SharedMutex>& g) final;
 
  private:
+  const size_t digestSize_;
   SlidingWindow<DigestT> slidingWindow_;
+  std::optional<DigestT> merged_;
+};
+
+/*
+ * BufferedDecayingDigest is a BufferedStat that holds data in a single digest,
+ * whose weights are multiplied by decay for every window that closes, so that
+ * the digest approximates an exponentially weighted history in the space of
+ * one digest. DigestT must provide scaled(double factor), like TDigest.
+ */
+template <typename DigestT, typename ClockT>
+class BufferedDecayingDigest : public BufferedStat<DigestT, ClockT> {
+ public:
+  using TimePoint = typename ClockT::time_point;
+
+  BufferedDecayingDigest(
+      typename ClockT::duration bufferDuration,
+      size_t bufferSize,
+      size_t digestSize,
+      double decay);
+
+  DigestT get(TimePoint now = ClockT::now());
+
+  void onNewDigest(
+      DigestT digest,
+      TimePoint newExpiry,
+      TimePoint oldExpiry,
+      const std::unique_lock<SharedMutex>& g) final;
+
+ private:
+  const double decay_;
+  DigestT digest_;
 };
 
 } // namespace detail
@@ -281,3 +281,24 @@ TEST_F(BufferedSlidingWindowTest, SlidePastWindow) {
 
   EXPECT_EQ(0, digests.size());
 }
+
+TEST_F(BufferedSlidingWindowTest, GetMerged) {
+  EXPECT_TRUE(bsw->getMerged().empty());
+
+  bsw->append(0);
+  MockClock::Now += windowDuration;
+  bsw->append(1);
+  MockClock::Now += windowDuration;
+
+  auto merged = bsw->getMerged();
+  EXPECT_EQ(2, merged.getValues().size());
+  // Cached until the windows change.
+  EXPECT_EQ(merged.getValues(), bsw->getMerged().getValues());
+
+  bsw->append(2);
+  bsw->flush();
+  EXPECT_EQ(3, bsw->getMerged().getValues().size());
+
+  MockClock::Now += windowDuration * nBuckets;
+  EXPECT_TRUE(bsw->getMerged().empty());
+}
@@ -56,9 +56,16 @@ extern "C" FOLLY_KEEP void check_folly_digest_builder_append(
   builder.append(value);
 }
 
-unsigned int append(unsigned int iters, size_t bufSize, size_t nThreads) {
+using AppendMode = DigestBuilder<FreeDigest>::AppendMode;
+
+unsigned int append(
+    unsigned int iters,
+    size_t bufSize,
+    size_t nThreads,
+    AppendMode mode = AppendMode::Locked) {
   iters = 1000000;
-  auto buffer = std::make_shared<DigestBuilder<FreeDigest>>(bufSize, 100);
+  auto buffer =
+      std::make_shared<DigestBuilder<FreeDigest>>(bufSize, 100, mode);
 
   auto barrier = std::make_shared<boost::barrier>(nThreads + 1);
 
@@ -99,6 +106,15 @@ BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(append, 10000x4, 10000, 4)
 BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(append, 10000x8, 10000, 8)
 BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(append, 10000x16, 10000, 16)
 BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(append, 10000x32, 10000, 32)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM_MULTI(
+    append, lockfree_1000x1, 1000, 1, AppendMode::LockFree)
+BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(
+    append, lockfree_1000x8, 1000, 8, AppendMode::LockFree)
+BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(
+    append, lockfree_1000x32, 1000, 32, AppendMode::LockFree)
+BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(
+    append, lockfree_1000x128, 1000, 128, AppendMode::LockFree)
 
 /*
  * ./digest_buffer_benchmark
@@ -16,6 +16,7 @@
 
 #include <folly/stats/DigestBuilder.h>
 
+#include <atomic>
 #include <chrono>
 #include <random>
 #include <thread>
@@ -85,3 +86,99 @@ TEST(DigestBuilder, MultipleThreads) {
 
   EXPECT_EQ(100, builder.build().getSize());
 }
+
+TEST(DigestBuilder, LockFreeSingleThreadUnfilledBuffer) {
+  using Builder = DigestBuilder<SimpleDigest<999>>;
+  Builder builder(1000, 100, Builder::AppendMode::LockFree);
+  for (int i = 0; i < 999; ++i) {
+    builder.append(i);
+  }
+  EXPECT_EQ(100, builder.build().getSize());
+}
+
+TEST(DigestBuilder, LockFreeSingleThreadFilledBuffer) {
+  using Builder = DigestBuilder<SimpleDigest<1000>>;
+  Builder builder(1000, 100, Builder::AppendMode::LockFree);
+  for (int i = 0; i < 1000; ++i) {
+    builder.append(i);
+  }
+  EXPECT_EQ(100, builder.build().getSize());
+}
+
+TEST(DigestBuilder, LockFreeMultipleThreads) {
+  using Builder = DigestBuilder<SimpleDigest<1000>>;
+  Builder builder(1000, 100, Builder::AppendMode::LockFree);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 10; ++i) {
+    threads.push_back(std::thread([i, &builder]() {
+      for (int j = 0; j < 100; ++j) {
+        builder.append(i * 100 + j);
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(100, builder.build().getSize());
+}
+
+namespace {
+
+// Counts the values merged into it.
+class CountingDigest {
+ public:
+  explicit CountingDigest(size_t) {}
+
+  CountingDigest merge(Range<const double*> r) const {
+    CountingDigest ret(0);
+    ret.count_ = count_ + r.size();
+    return ret;
+  }
+
+  static CountingDigest merge(Range<const CountingDigest*> r) {
+    CountingDigest ret(0);
+    for (const auto& digest : r) {
+      ret.count_ += digest.count_;
+    }
+    return ret;
+  }
+
+  size_t count() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+ private:
+  size_t count_ = 0;
+};
+
+} // namespace
+
+TEST(DigestBuilder, LockFreeConcurrentBuild) {
+  using Builder = DigestBuilder<CountingDigest>;
+  Builder builder(100, 100, Builder::AppendMode::LockFree);
+  constexpr size_t kThreads = 16;
+  constexpr size_t kAppends = 100000;
+  std::atomic<bool> done{false};
+  size_t built = 0;
+  std::thread buildThread([&] {
+    while (!done.load()) {
+      built += builder.build().count();
+    }
+  });
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&builder] {
+      for (size_t j = 0; j < kAppends; ++j) {
+        builder.append(j);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  done = true;
+  buildThread.join();
+  built += builder.build().count();
+
+  EXPECT_EQ(kThreads * kAppends, built);
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/HeavyHitters.h>
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+struct MockClock {
+ public:
+  using duration = std::chrono::steady_clock::duration;
+  using time_point = std::chrono::steady_clock::time_point;
+  static constexpr auto is_steady = true;
+
+  static time_point now() { return Now; }
+
+  static time_point Now;
+};
+
+MockClock::time_point MockClock::Now = MockClock::time_point{};
+
+TEST(CountMinSketchTest, NeverUnderestimates) {
+  CountMinSketch sketch(64);
+  EXPECT_EQ(64, sketch.width());
+  for (uint64_t key = 0; key < 1000; ++key) {
+    sketch.add(key, key % 7 + 1);
+  }
+  for (uint64_t key = 0; key < 1000; ++key) {
+    EXPECT_GE(sketch.estimate(key), key % 7 + 1);
+  }
+  EXPECT_EQ(0, CountMinSketch(1 << 16).estimate(42));
+}
+
+TEST(CountMinSketchTest, Merge) {
+  std::vector<uint64_t> keys;
+  for (uint64_t i = 0; i < 500; ++i) {
+    keys.push_back(i % 10);
+  }
+  auto a = CountMinSketch(100).merge(keys);
+  EXPECT_EQ(128, a.width());
+  EXPECT_EQ(500, a.count());
+  EXPECT_EQ(50, a.estimate(3));
+
+  std::vector<CountMinSketch> sketches{CountMinSketch(16), a, a};
+  auto merged = CountMinSketch::merge(sketches);
+  EXPECT_EQ(1000, merged.count());
+  EXPECT_EQ(100, merged.estimate(3));
+
+  sketches.push_back(CountMinSketch(16).merge(keys));
+  EXPECT_THROW(CountMinSketch::merge(sketches), std::invalid_argument);
+}
+
+TEST(SpaceSavingTest, TopK) {
+  SpaceSaving summary(10);
+  // Zipf-like: key k appears 1000 / k times, with a long tail of singletons.
+  for (uint64_t key = 1; key <= 5; ++key) {
+    summary.add(key, 1000 / key);
+  }
+  for (uint64_t key = 100; key < 1100; ++key) {
+    summary.add(key);
+  }
+  auto top = summary.topK(3);
+  ASSERT_EQ(3, top.size());
+  for (uint64_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(i + 1, top[i].key);
+    EXPECT_GE(top[i].count, 1000 / (i + 1));
+    EXPECT_LE(top[i].count - top[i].error, 1000 / (i + 1));
+  }
+  EXPECT_NE(nullptr, summary.find(5));
+  EXPECT_EQ(nullptr, summary.find(6));
+}
+
+TEST(SpaceSavingTest, Merge) {
+  std::vector<uint64_t> keys;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    keys.push_back(i % 3 == 0 ? 5000 : i);
+  }
+  auto a = SpaceSaving(5).merge(keys);
+  auto b = SpaceSaving(5).merge(keys);
+  std::vector<SpaceSaving> summaries{a, SpaceSaving(5), b};
+  auto merged = SpaceSaving::merge(summaries);
+  EXPECT_EQ(2000, merged.count());
+  auto top = merged.topK(1);
+  ASSERT_EQ(1, top.size());
+  EXPECT_EQ(5000, top[0].key);
+  EXPECT_GE(top[0].count, 668);
+  EXPECT_LE(top[0].count - top[0].error, 668);
+  EXPECT_EQ(5, merged.topK(100).size());
+}
+
+TEST(SlidingWindowHeavyHittersTest, Windows) {
+  SlidingWindowHeavyHitters<MockClock> heavyHitters(
+      std::chrono::seconds{1}, 2, 10);
+  SlidingWindowFrequencyEstimator<MockClock> frequencies(
+      std::chrono::seconds{1}, 2, 256);
+  auto add = [&](uint64_t key, size_t times) {
+    for (size_t i = 0; i < times; ++i) {
+      heavyHitters.addValue(key);
+      frequencies.addValue(key);
+    }
+  };
+
+  add(1, 100);
+  add(2, 10);
+  MockClock::Now += std::chrono::seconds{1};
+  add(3, 50);
+  MockClock::Now += std::chrono::seconds{1};
+
+  auto top = heavyHitters.topK(2);
+  ASSERT_EQ(2, top.size());
+  EXPECT_EQ(1, top[0].key);
+  EXPECT_EQ(100, top[0].count);
+  EXPECT_EQ(3, top[1].key);
+  EXPECT_EQ(50, top[1].count);
+  EXPECT_EQ(100, frequencies.estimate(1));
+  EXPECT_EQ(50, frequencies.estimate(3));
+
+  // The first window slides out.
+  MockClock::Now += std::chrono::seconds{1};
+  top = heavyHitters.topK(2);
+  ASSERT_EQ(1, top.size());
+  EXPECT_EQ(3, top[0].key);
+  EXPECT_EQ(0, frequencies.estimate(1));
+  EXPECT_EQ(256, frequencies.getSketch().width());
+
+  MockClock::Now += std::chrono::seconds{1};
+  EXPECT_TRUE(heavyHitters.topK(2).empty());
+  EXPECT_EQ(10, heavyHitters.getSummary().capacity());
+}
+
+TEST(SlidingWindowHeavyHittersTest, ConcurrentAppends) {
+  SlidingWindowHeavyHitters<MockClock> heavyHitters(
+      std::chrono::seconds{1}, 10, 10);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (uint64_t i = 0; i < 10000; ++i) {
+        heavyHitters.addValue(i % 2 == 0 ? 42 : t * 100000 + i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  MockClock::Now += std::chrono::seconds{1};
+  auto summary = heavyHitters.getSummary();
+  EXPECT_EQ(40000, summary.count());
+  auto top = summary.topK(1);
+  ASSERT_EQ(1, top.size());
+  EXPECT_EQ(42, top[0].key);
+  EXPECT_GE(top[0].count, 20000);
+}
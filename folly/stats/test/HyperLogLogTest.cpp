@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/CardinalityEstimator.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+struct MockClock {
+ public:
+  using duration = std::chrono::steady_clock::duration;
+  using time_point = std::chrono::steady_clock::time_point;
+  static constexpr auto is_steady = true;
+
+  static time_point now() { return Now; }
+
+  static time_point Now;
+};
+
+MockClock::time_point MockClock::Now = MockClock::time_point{};
+
+TEST(HyperLogLogTest, Sparse) {
+  HyperLogLog hll;
+  EXPECT_TRUE(hll.empty());
+  EXPECT_EQ(0, hll.estimate());
+  for (uint64_t i = 0; i < 1000; ++i) {
+    hll.add(i);
+    hll.add(i);
+  }
+  EXPECT_TRUE(hll.isSparse());
+  EXPECT_NEAR(1000, hll.estimate(), 1);
+}
+
+TEST(HyperLogLogTest, Dense) {
+  for (size_t precision : {10, 14}) {
+    HyperLogLog hll(precision);
+    double error = 1.04 / std::sqrt(double(1 << precision));
+    uint64_t n = 0;
+    for (uint64_t target : {10000, 100000, 1000000}) {
+      for (; n < target; ++n) {
+        hll.add(n * 7919);
+      }
+      EXPECT_FALSE(hll.isSparse());
+      EXPECT_NEAR(1, hll.estimate() / n, 4 * error);
+    }
+  }
+}
+
+TEST(HyperLogLogTest, Merge) {
+  // Sparse and dense sketches merge into the sketch of the union, whichever
+  // representation each is in.
+  HyperLogLog all(12);
+  std::vector<HyperLogLog> parts;
+  for (uint64_t size : {10, 0, 100000, 500, 20000}) {
+    HyperLogLog part(12);
+    for (uint64_t i = 0; i < size; ++i) {
+      part.add(size + i);
+      all.add(size + i);
+    }
+    parts.push_back(part);
+  }
+  EXPECT_TRUE(parts[0].isSparse());
+  EXPECT_FALSE(parts[2].isSparse());
+  auto merged = HyperLogLog::merge(parts);
+  EXPECT_EQ(all.estimate(), merged.estimate());
+
+  std::vector<HyperLogLog> sparse{parts[0], parts[3]};
+  merged = HyperLogLog::merge(sparse);
+  EXPECT_TRUE(merged.isSparse());
+  EXPECT_NEAR(510, merged.estimate(), 1);
+
+  std::vector<uint64_t> keys{1, 2, 3, 2, 1};
+  EXPECT_NEAR(3, HyperLogLog().merge(keys).estimate(), 0.01);
+
+  parts.emplace_back(13);
+  parts.back().add(1);
+  EXPECT_THROW(HyperLogLog::merge(parts), std::invalid_argument);
+  EXPECT_THROW(HyperLogLog(3), std::invalid_argument);
+  EXPECT_THROW(HyperLogLog(19), std::invalid_argument);
+}
+
+TEST(SlidingWindowCardinalityEstimatorTest, Windows) {
+  SlidingWindowCardinalityEstimator<MockClock> estimator(
+      std::chrono::seconds{1}, 2);
+  for (uint64_t i = 0; i < 100; ++i) {
+    estimator.addValue(i);
+  }
+  MockClock::Now += std::chrono::seconds{1};
+  for (uint64_t i = 50; i < 200; ++i) {
+    estimator.addValue(i);
+  }
+  MockClock::Now += std::chrono::seconds{1};
+  EXPECT_NEAR(200, estimator.estimate(), 0.5);
+
+  // The first window slides out.
+  MockClock::Now += std::chrono::seconds{1};
+  EXPECT_NEAR(150, estimator.estimate(), 0.5);
+  MockClock::Now += std::chrono::seconds{1};
+  EXPECT_EQ(0, estimator.estimate());
+  EXPECT_EQ(14, estimator.getSketch().precision());
+}
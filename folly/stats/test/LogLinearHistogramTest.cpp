@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/LogLinearHistogram.h>
+
+#include <chrono>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+#include <folly/stats/TimeseriesHistogram.h>
+
+using folly::LogLinearHistogram;
+
+TEST(LogLinearHistogram, Buckets) {
+  using H = LogLinearHistogram<>;
+  EXPECT_EQ(3776, H::kNumBuckets);
+  for (size_t i = 0; i < H::kNumBuckets; ++i) {
+    EXPECT_EQ(i, H::bucketIndex(H::bucketMin(i)));
+    EXPECT_EQ(i, H::bucketIndex(H::bucketMax(i)));
+    if (i > 0) {
+      EXPECT_EQ(H::bucketMax(i - 1) + 1, H::bucketMin(i));
+    }
+    // relative precision
+    auto width = H::bucketMax(i) - H::bucketMin(i);
+    EXPECT_LE(width, H::bucketMin(i) / 64);
+  }
+  EXPECT_EQ(0, H::bucketMin(0));
+  EXPECT_EQ(
+      std::numeric_limits<uint64_t>::max(), H::bucketMax(H::kNumBuckets - 1));
+}
+
+TEST(LogLinearHistogram, SmallSubBuckets) {
+  using H = LogLinearHistogram<1>;
+  EXPECT_EQ(65, H::kNumBuckets);
+  for (size_t i = 1; i < H::kNumBuckets; ++i) {
+    EXPECT_EQ(H::bucketMax(i - 1) + 1, H::bucketMin(i));
+    EXPECT_EQ(i, H::bucketIndex(H::bucketMin(i)));
+  }
+}
+
+TEST(LogLinearHistogram, Quantiles) {
+  LogLinearHistogram<> hist;
+  EXPECT_TRUE(hist.empty());
+  EXPECT_EQ(0, hist.estimateQuantile(0.5));
+  // 1us to 100ms in ns, 5 orders of magnitude
+  for (uint64_t v = 1000; v <= 100000000; v += 1000) {
+    hist.addValue(v);
+  }
+  EXPECT_EQ(100000, hist.count());
+  for (double q : {0.01, 0.1, 0.5, 0.9, 0.99, 0.999}) {
+    double expected = q * 100000000;
+    auto estimate = static_cast<double>(hist.estimateQuantile(q));
+    EXPECT_NEAR(expected, estimate, expected / 64) << q;
+  }
+  EXPECT_EQ(
+      LogLinearHistogram<>::bucketMin(hist.bucketIndex(1000)),
+      hist.estimateQuantile(0.0));
+  EXPECT_GE(hist.estimateQuantile(1.0), 100000000);
+}
+
+TEST(LogLinearHistogram, Merge) {
+  LogLinearHistogram<> a;
+  LogLinearHistogram<> b;
+  a.addValue(10, 3);
+  b.addValue(10);
+  b.addValue(1 << 20);
+  a.merge(b);
+  EXPECT_EQ(5, a.count());
+  EXPECT_EQ(4, a.bucketCount(a.bucketIndex(10)));
+  LogLinearHistogram<> c = a;
+  EXPECT_EQ(5, c.count());
+  c.clear();
+  EXPECT_TRUE(c.empty());
+  EXPECT_EQ(5, a.count());
+}
+
+TEST(LogLinearHistogram, Concurrent) {
+  LogLinearHistogram<> hist;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937_64 rng(t);
+      for (int i = 0; i < 100000; ++i) {
+        hist.addValue(rng() >> (rng() % 64));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(400000, hist.count());
+}
+
+TEST(LogLinearHistogram, TimeseriesHistogram) {
+  LogLinearHistogram<> hist;
+  hist.addValue(5, 10);
+  hist.addValue(15000, 10);
+
+  folly::Histogram<int64_t> linear(1000, 0, 100000);
+  hist.addTo(linear);
+  EXPECT_EQ(20, linear.computeTotalCount());
+
+  using TSH = folly::TimeseriesHistogram<int64_t>;
+  TSH ts(
+      1000,
+      0,
+      100000,
+      folly::MultiLevelTimeSeries<int64_t>(60, {std::chrono::seconds(60)}));
+  ts.addValues(TSH::TimePoint(std::chrono::seconds(0)), linear);
+  ts.update(TSH::TimePoint(std::chrono::seconds(1)));
+  EXPECT_EQ(20, ts.count(0));
+  EXPECT_EQ(10, ts.getBucket(1).count(0));
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/MultiLevelTimeSeriesFamily.h>
+
+#include <random>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+#include <folly/stats/MultiLevelTimeSeries.h>
+
+using namespace std::chrono;
+
+using Family = folly::MultiLevelTimeSeriesFamily<int64_t>;
+using TimePoint = Family::TimePoint;
+
+TEST(MultiLevelTimeSeriesFamily, Basic) {
+  Family family(60, {seconds(60), seconds(3600), seconds(0)});
+  EXPECT_EQ(3, family.numLevels());
+  auto a = family.addSeries();
+  auto b = family.addSeries();
+  EXPECT_EQ(0, a);
+  EXPECT_EQ(1, b);
+  EXPECT_EQ(2, family.numSeries());
+
+  for (int i = 0; i < 120; ++i) {
+    family.addValue(a, TimePoint(seconds(i)), 10);
+  }
+  family.addValue(b, TimePoint(seconds(119)), 5, 3);
+
+  EXPECT_EQ(600, family.sum(a, 0));
+  EXPECT_EQ(60, family.count(a, 0));
+  EXPECT_EQ(1200, family.sum(a, 1));
+  EXPECT_EQ(1200, family.sum(a, 2));
+  EXPECT_EQ(10, family.avg(a, 0));
+  EXPECT_EQ(10, family.rate(a, 0));
+  EXPECT_EQ(15, family.sum(b, 0));
+  EXPECT_EQ(3, family.count(b, 0));
+
+  // One update expires the minute level of all series
+  family.update(TimePoint(seconds(200)));
+  EXPECT_EQ(0, family.sum(a, 0));
+  EXPECT_EQ(0, family.sum(b, 0));
+  EXPECT_EQ(1200, family.sum(a, 1));
+  EXPECT_EQ(15, family.sum(b, 2));
+
+  // Too old for the minute level, but not the others
+  family.addValue(b, TimePoint(seconds(100)), 1);
+  EXPECT_EQ(0, family.count(b, 0));
+  EXPECT_EQ(4, family.count(b, 1));
+  EXPECT_EQ(4, family.count(b, 2));
+
+  family.clear();
+  EXPECT_EQ(0, family.sum(a, 2));
+  EXPECT_EQ(2, family.numSeries());
+}
+
+TEST(MultiLevelTimeSeriesFamily, MatchesMultiLevelTimeSeries) {
+  const std::vector<seconds> durations{seconds(60), seconds(600), seconds(0)};
+  constexpr size_t kNumSeries = 50;
+  Family family(10, folly::range(durations));
+  std::vector<folly::MultiLevelTimeSeries<int64_t>> expected;
+  for (size_t i = 0; i < kNumSeries; ++i) {
+    family.addSeries();
+    expected.emplace_back(10, folly::range(durations));
+  }
+
+  std::mt19937 rng(0);
+  int64_t now = 1000;
+  for (int step = 0; step < 2000; ++step) {
+    now += rng() % 3 == 0 ? rng() % 40 : 0;
+    auto series = rng() % kNumSeries;
+    // Sometimes a little in the past
+    auto ago = rng() % 4 == 0 ? rng() % 5 : 0;
+    auto when = TimePoint(seconds(now - int64_t(ago)));
+    // Keep every series at the time of the family
+    if (when > family.getLatestTime()) {
+      for (auto& ts : expected) {
+        ts.update(when);
+      }
+    }
+    int64_t value = rng() % 1000;
+    family.addValue(series, when, value);
+    expected[series].addValue(when, value);
+    if (step % 50 == 0) {
+      for (size_t s = 0; s < kNumSeries; ++s) {
+        expected[s].flush();
+        for (size_t l = 0; l < durations.size(); ++l) {
+          ASSERT_EQ(expected[s].sum(l), family.sum(s, l)) << step;
+          ASSERT_EQ(expected[s].count(l), family.count(s, l)) << step;
+        }
+      }
+    }
+  }
+}
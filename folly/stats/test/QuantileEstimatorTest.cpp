@@ -86,3 +86,28 @@ TEST(SlidingWindowQuantileEstimatorTest, EstimateQuantiles) {
   EXPECT_EQ(100.0 - 0.5, estimates.quantiles[3].second);
   EXPECT_EQ(100, estimates.quantiles[4].second);
 }
+
+TEST(DecayingQuantileEstimatorTest, EstimateQuantiles) {
+  MockClock::Now = MockClock::time_point{};
+  DecayingQuantileEstimator<MockClock> estimator(
+      std::chrono::seconds{1}, std::chrono::seconds{1});
+  for (size_t i = 0; i < 300; ++i) {
+    estimator.addValue(1);
+  }
+  MockClock::Now += std::chrono::seconds{1};
+  for (size_t i = 0; i < 100; ++i) {
+    estimator.addValue(2);
+  }
+  MockClock::Now += std::chrono::seconds{1};
+
+  // The 1s are one half-life older than the 2s.
+  auto estimates =
+      estimator.estimateQuantiles(std::array<double, 2>{{.1, .99}});
+  EXPECT_DOUBLE_EQ(250, estimates.count);
+  EXPECT_DOUBLE_EQ(350, estimates.sum);
+  EXPECT_EQ(1, estimates.quantiles[0].second);
+  EXPECT_EQ(2, estimates.quantiles[1].second);
+
+  MockClock::Now += std::chrono::seconds{2};
+  EXPECT_DOUBLE_EQ(62.5, estimator.getDigest().count());
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/Serialization.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <folly/io/IOBufQueue.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+TDigest makeDigest(size_t n) {
+  std::mt19937 gen(0);
+  std::lognormal_distribution<double> dist(0.0, 1.0);
+  std::vector<double> values;
+  for (size_t i = 0; i < n; ++i) {
+    values.push_back(dist(gen));
+  }
+  return TDigest(100).merge(values);
+}
+
+template <class Serialize>
+std::unique_ptr<IOBuf> encode(Serialize serialize) {
+  IOBufQueue queue{IOBufQueue::cacheChainLength()};
+  // A small growth size so that encodings span several IOBufs
+  io::QueueAppender appender(&queue, 16);
+  serialize(appender);
+  return queue.move();
+}
+
+} // namespace
+
+TEST(StatsSerialization, TDigest) {
+  auto digest = makeDigest(100000);
+  auto buf =
+      encode([&](auto& appender) { serializeTDigest(digest, appender); });
+  EXPECT_TRUE(buf->isChained());
+  // 32 bytes of totals, and a few bytes for each centroid
+  EXPECT_LT(
+      buf->computeChainDataLength(), 34 + 10 * digest.getCentroids().size());
+
+  io::Cursor cursor(buf.get());
+  auto decoded = deserializeTDigest(cursor);
+  EXPECT_TRUE(cursor.isAtEnd());
+  EXPECT_EQ(digest.maxSize(), decoded.maxSize());
+  EXPECT_EQ(digest.sum(), decoded.sum());
+  EXPECT_EQ(digest.count(), decoded.count());
+  EXPECT_EQ(digest.min(), decoded.min());
+  EXPECT_EQ(digest.max(), decoded.max());
+  ASSERT_EQ(digest.getCentroids().size(), decoded.getCentroids().size());
+  for (size_t i = 0; i < digest.getCentroids().size(); ++i) {
+    EXPECT_EQ(
+        digest.getCentroids()[i].mean(), decoded.getCentroids()[i].mean());
+    EXPECT_EQ(
+        digest.getCentroids()[i].weight(), decoded.getCentroids()[i].weight());
+  }
+}
+
+TEST(StatsSerialization, TDigestFloat) {
+  auto digest = makeDigest(100000);
+  auto full =
+      encode([&](auto& appender) { serializeTDigest(digest, appender); });
+  auto buf = encode([&](auto& appender) {
+    serializeTDigest(digest, appender, StatsPrecision::Float);
+  });
+  EXPECT_LT(buf->computeChainDataLength(), full->computeChainDataLength());
+
+  io::Cursor cursor(buf.get());
+  auto decoded = deserializeTDigest(cursor);
+  EXPECT_EQ(digest.count(), decoded.count());
+  for (double q : {0.001, 0.01, 0.5, 0.99, 0.999}) {
+    auto expected = digest.estimateQuantile(q);
+    EXPECT_NEAR(expected, decoded.estimateQuantile(q), expected * 1e-6);
+  }
+}
+
+TEST(StatsSerialization, TDigestFractionalWeights) {
+  std::vector<TDigest::Centroid> centroids{
+      TDigest::Centroid(-1.5, 0.25), TDigest::Centroid(2.0, 1.75)};
+  TDigest digest(centroids, 3.125, 2.0, 2.0, -1.5);
+  auto buf =
+      encode([&](auto& appender) { serializeTDigest(digest, appender); });
+  io::Cursor cursor(buf.get());
+  auto decoded = deserializeTDigest(cursor);
+  ASSERT_EQ(2, decoded.getCentroids().size());
+  EXPECT_EQ(-1.5, decoded.getCentroids()[0].mean());
+  EXPECT_EQ(0.25, decoded.getCentroids()[0].weight());
+  EXPECT_EQ(1.75, decoded.getCentroids()[1].weight());
+}
+
+TEST(StatsSerialization, TDigestEmpty) {
+  TDigest digest(50);
+  auto buf =
+      encode([&](auto& appender) { serializeTDigest(digest, appender); });
+  io::Cursor cursor(buf.get());
+  auto decoded = deserializeTDigest(cursor);
+  EXPECT_TRUE(decoded.empty());
+  EXPECT_EQ(50, decoded.maxSize());
+  EXPECT_TRUE(std::isnan(decoded.min()));
+}
+
+TEST(StatsSerialization, Malformed) {
+  auto digest = makeDigest(1000);
+  auto buf =
+      encode([&](auto& appender) { serializeTDigest(digest, appender); });
+  auto length = buf->computeChainDataLength();
+
+  // Truncated
+  buf->coalesce();
+  auto truncated = IOBuf::copyBuffer(buf->data(), length - 1);
+  io::Cursor truncatedCursor(truncated.get());
+  EXPECT_THROW(deserializeTDigest(truncatedCursor), std::out_of_range);
+
+  // A centroid count so large that twice it wraps around to a small size.
+  auto huge = encode([](auto& appender) {
+    detail::writeStatsHeader(
+        appender,
+        detail::StatsEncodingTag::TDigest,
+        detail::kStatsEncodingIntegralWeights);
+    detail::writeStatsVarint(appender, 100);
+    detail::writeStatsVarint(appender, (uint64_t(1) << 63) + 1);
+    for (int i = 0; i < 4; ++i) {
+      appender.writeLE(1.0);
+    }
+    appender.template write<uint16_t>(0x0202);
+  });
+  io::Cursor hugeCursor(huge.get());
+  EXPECT_THROW(deserializeTDigest(hugeCursor), std::out_of_range);
+
+  // Another type
+  io::Cursor cursor(buf.get());
+  EXPECT_THROW(
+      deserializeQuantileHistogram<PredefinedQuantiles::Default>(cursor),
+      std::invalid_argument);
+}
+
+TEST(StatsSerialization, QuantileHistogram) {
+  QuantileHistogram<> hist;
+  for (int i = -500; i < 1000; ++i) {
+    hist.addValue(i * 0.5);
+  }
+  auto buf = encode(
+      [&](auto& appender) { serializeQuantileHistogram(hist, appender); });
+  io::Cursor cursor(buf.get());
+  auto decoded =
+      deserializeQuantileHistogram<PredefinedQuantiles::Default>(cursor);
+  EXPECT_TRUE(cursor.isAtEnd());
+  EXPECT_EQ(hist.count(), decoded.count());
+  EXPECT_EQ(hist.getLocations(), decoded.getLocations());
+
+  // The quantiles must match
+  io::Cursor otherCursor(buf.get());
+  EXPECT_THROW(
+      deserializeQuantileHistogram<PredefinedQuantiles::Median>(otherCursor),
+      std::invalid_argument);
+}
+
+TEST(StatsSerialization, Histogram) {
+  Histogram<int64_t> hist(10, -100, 1000);
+  for (int64_t i = -200; i < 2000; i += 7) {
+    hist.addValue(i);
+  }
+  auto buf =
+      encode([&](auto& appender) { serializeHistogram(hist, appender); });
+  io::Cursor cursor(buf.get());
+  auto decoded = deserializeHistogram<int64_t>(cursor);
+  EXPECT_TRUE(cursor.isAtEnd());
+  ASSERT_EQ(hist.getNumBuckets(), decoded.getNumBuckets());
+  EXPECT_EQ(hist.getMin(), decoded.getMin());
+  EXPECT_EQ(hist.getMax(), decoded.getMax());
+  EXPECT_EQ(hist.getBucketSize(), decoded.getBucketSize());
+  for (size_t i = 0; i < hist.getNumBuckets(); ++i) {
+    EXPECT_EQ(hist.getBucketByIndex(i).sum, decoded.getBucketByIndex(i).sum);
+    EXPECT_EQ(
+        hist.getBucketByIndex(i).count, decoded.getBucketByIndex(i).count);
+  }
+}
+
+TEST(StatsSerialization, TimeseriesHistogramLevel) {
+  using namespace std::chrono;
+  using Hist = TimeseriesHistogram<double>;
+  Hist hist(10.0, 0.0, 100.0, MultiLevelTimeSeries<double>(60, {seconds(60)}));
+  for (int i = 0; i < 100; ++i) {
+    hist.addValue(Hist::TimePoint(seconds(1)), i * 1.5);
+  }
+  hist.update(Hist::TimePoint(seconds(2)));
+
+  auto buf = encode([&](auto& appender) {
+    serializeTimeseriesHistogramLevel(hist, 0, appender);
+  });
+  io::Cursor cursor(buf.get());
+  auto snapshot = deserializeHistogram<double>(cursor);
+  EXPECT_TRUE(cursor.isAtEnd());
+
+  // Aggregate it into another host's histogram
+  Hist other(
+      10.0, 0.0, 100.0, MultiLevelTimeSeries<double>(60, {seconds(60)}));
+  other.addValues(Hist::TimePoint(seconds(1)), snapshot);
+  other.update(Hist::TimePoint(seconds(2)));
+  EXPECT_EQ(hist.count(0), other.count(0));
+  EXPECT_EQ(hist.sum(0), other.sum(0));
+  for (size_t i = 0; i < hist.getNumBuckets(); ++i) {
+    EXPECT_EQ(hist.getBucket(i).count(0), other.getBucket(i).count(0));
+  }
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/stats/StatsRegistry.h>
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <folly/json/json.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(StatsRegistryTest, Snapshot) {
+  StatsRegistry registry;
+  auto& requests = registry.counter("requests");
+  EXPECT_EQ(&requests, &registry.counter("requests"));
+  requests.increment();
+  requests.increment(4);
+
+  auto& size = registry.stat("size");
+  size.addValue(10);
+  size.addValue(20);
+
+  auto& latency = registry.histogram("latency_us");
+  for (uint64_t i = 1; i <= 100; ++i) {
+    latency.addValue(i);
+  }
+
+  auto snapshot = registry.snapshot();
+  EXPECT_EQ(5, snapshot.counters.at("requests"));
+  EXPECT_EQ(30, snapshot.stats.at("size").sum);
+  EXPECT_EQ(2, snapshot.stats.at("size").count);
+  EXPECT_EQ(15, snapshot.stats.at("size").avg());
+  EXPECT_EQ(100, snapshot.histograms.at("latency_us").count);
+  EXPECT_EQ(50, snapshot.histograms.at("latency_us").p50);
+  EXPECT_EQ(99, snapshot.histograms.at("latency_us").p99);
+
+  EXPECT_EQ(
+      "latency_us.count 100\n"
+      "latency_us.p50 50\n"
+      "latency_us.p90 90\n"
+      "latency_us.p99 99\n"
+      "latency_us.p999 100\n"
+      "requests 5\n"
+      "size.avg 15\n"
+      "size.count 2\n"
+      "size.sum 30\n",
+      snapshot.toText());
+
+  auto json = parseJson(snapshot.toJson());
+  EXPECT_EQ(5, json["counters"]["requests"].asInt());
+  EXPECT_EQ(15.0, json["stats"]["size"]["avg"].asDouble());
+  EXPECT_EQ(90, json["histograms"]["latency_us"]["p90"].asInt());
+}
+
+TEST(StatsRegistryTest, NameConflict) {
+  StatsRegistry registry;
+  registry.counter("x");
+  EXPECT_THROW(registry.stat("x"), std::invalid_argument);
+  EXPECT_THROW(registry.histogram("x"), std::invalid_argument);
+  EXPECT_EQ(1, registry.snapshot().counters.size());
+}
+
+TEST(StatsRegistryTest, ConcurrentUpdates) {
+  auto& registry = StatsRegistry::global();
+  auto& counter = registry.counter("stats_registry_test");
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (size_t i = 0; i < 10000; ++i) {
+        counter.increment();
+        registry.histogram("stats_registry_test_hist").addValue(i);
+      }
+    });
+  }
+  // Snapshots neither block nor break the writers.
+  for (size_t i = 0; i < 10; ++i) {
+    registry.snapshot();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto snapshot = registry.snapshot();
+  EXPECT_EQ(40000, snapshot.counters.at("stats_registry_test"));
+  EXPECT_EQ(40000, snapshot.histograms.at("stats_registry_test_hist").count);
+}
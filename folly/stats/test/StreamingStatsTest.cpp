@@ -84,3 +84,48 @@ TYPED_TEST(StreamingStatsTest, StatsCalculations) {
   EXPECT_DOUBLE_EQ(this->stats.sampleVariance(), 9.166666666666666);
   EXPECT_DOUBLE_EQ(this->stats.sampleStandardDeviation(), 3.0276503540974917);
 }
+
+TEST(StreamingStatsTest, AddBatch) {
+  // Spans several blocks and lanes, and is far from zero, where a
+  // single-pass sum of squares loses all precision.
+  std::vector<double> values;
+  for (size_t i = 0; i < 3001; ++i) {
+    values.push_back(1e9 + (i % 17) * 0.5);
+  }
+  StreamingStats<double> expected(values.begin(), values.end());
+  StreamingStats<double> stats;
+  stats.add(folly::range(values.data(), values.data() + 5));
+  stats.add(folly::range(values.data() + 5, values.data() + values.size()));
+  EXPECT_EQ(expected.count(), stats.count());
+  EXPECT_NEAR(expected.mean(), stats.mean(), 1e-6);
+  EXPECT_NEAR(expected.sampleVariance(), stats.sampleVariance(), 1e-6);
+  EXPECT_EQ(expected.minimum(), stats.minimum());
+  EXPECT_EQ(expected.maximum(), stats.maximum());
+
+  std::vector<short> shorts{5, -3, 7, 1};
+  StreamingStats<short> shortStats;
+  shortStats.add(folly::range(shorts));
+  EXPECT_EQ(-3, shortStats.minimum());
+  EXPECT_EQ(7, shortStats.maximum());
+  EXPECT_DOUBLE_EQ(2.5, shortStats.mean());
+}
+
+TEST(StreamingStatsTest, Merge) {
+  std::vector<double> values;
+  for (size_t i = 0; i < 1000; ++i) {
+    values.push_back(1e6 + (i * 7919) % 101);
+  }
+  StreamingStats<double> expected(values.begin(), values.end());
+  StreamingStats<double> merged;
+  for (size_t begin = 0; begin < values.size(); begin += 300) {
+    size_t end = std::min(begin + 300, values.size());
+    merged.merge(
+        StreamingStats<double>(values.begin() + begin, values.begin() + end));
+  }
+  merged.merge(StreamingStats<double>());
+  EXPECT_EQ(expected.count(), merged.count());
+  EXPECT_NEAR(expected.mean(), merged.mean(), 1e-6);
+  EXPECT_NEAR(expected.m2(), merged.m2(), 1e-6 * expected.m2());
+  EXPECT_EQ(expected.minimum(), merged.minimum());
+  EXPECT_EQ(expected.maximum(), merged.maximum());
+}
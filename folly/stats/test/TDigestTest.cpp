@@ -156,6 +156,59 @@ TEST(TDigest, MergeLargeAsDigests) {
   EXPECT_EQ(999.5, digest.estimateQuantile(0.999));
 }
 
+TEST(TDigest, MergeManyDigests) {
+  // An odd number of digests, some of them empty, so that the runs to merge
+  // are uneven.
+  std::vector<TDigest> digests;
+  std::vector<double> values;
+  for (int i = 1; i <= 10000; ++i) {
+    values.push_back(i);
+  }
+  std::shuffle(values.begin(), values.end(), std::mt19937(kSeed));
+  for (int i = 0; i < 1001; ++i) {
+    if (i % 7 == 0) {
+      digests.emplace_back(100);
+      continue;
+    }
+    auto begin = values.begin() + (i * 10) % values.size();
+    digests.push_back(
+        TDigest(100).merge(std::vector<double>(begin, begin + 10)));
+  }
+
+  auto digest = TDigest::merge(digests);
+  double count = 0;
+  for (const auto& d : digests) {
+    count += d.count();
+  }
+
+  EXPECT_EQ(count, digest.count());
+  EXPECT_TRUE(std::is_sorted(
+      digest.getCentroids().begin(), digest.getCentroids().end()));
+  EXPECT_NEAR(5000, digest.estimateQuantile(0.5), 200);
+  EXPECT_NEAR(9900, digest.estimateQuantile(0.99), 50);
+}
+
+TEST(TDigest, Scaled) {
+  TDigest digest(100);
+  std::vector<double> values;
+  for (int i = 1; i <= 1000; ++i) {
+    values.push_back(i);
+  }
+  digest = digest.merge(values);
+
+  auto half = digest.scaled(0.5);
+  EXPECT_EQ(250250, half.sum());
+  EXPECT_EQ(500, half.count());
+  EXPECT_EQ(1, half.min());
+  EXPECT_EQ(1000, half.max());
+  EXPECT_EQ(digest.getCentroids().size(), half.getCentroids().size());
+  EXPECT_EQ(digest.estimateQuantile(0.5), half.estimateQuantile(0.5));
+  EXPECT_EQ(digest.estimateQuantile(0.99), half.estimateQuantile(0.99));
+
+  EXPECT_TRUE(digest.scaled(0).empty());
+  EXPECT_TRUE(TDigest(100).scaled(0.5).empty());
+}
+
 TEST(TDigest, NegativeValues) {
   std::vector<TDigest> digests;
   TDigest digest(100);
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <utility>
+
+#include <folly/synchronization/AtomicNotification.h>
+
+namespace folly {
+
+/**
+ * A condition variable that works with any lock, meant to be used with
+ * DistributedMutex.
+ *
+ * std::condition_variable only accepts std::unique_lock<std::mutex>, and
+ * std::condition_variable_any serializes its waiters and notifiers on an
+ * internal std::mutex, which is exactly the kind of contended cache line
+ * DistributedMutex is meant to avoid. This one is a futex on a wake-up epoch
+ * instead, and notifying only costs an atomic increment when there are no
+ * waiters, so notify_one() and notify_all() can also be called cheaply from
+ * within a combined critical section.
+ *
+ *   folly::DistributedMutex mutex;
+ *   folly::DistributedConditionVariable cv;
+ *
+ *   // consumer
+ *   auto lock = std::unique_lock{mutex};
+ *   cv.wait(lock, [&] { return !queue.empty(); });
+ *
+ *   // producer
+ *   mutex.lock_combine([&] { queue.push_back(item); });
+ *   cv.notify_one();
+ *
+ * The lock passed to the wait functions must be held by the calling thread,
+ * so waiting is not possible from a combined critical section. With
+ * Synchronized<T, DistributedMutex>, pass LockedPtr::as_lock().
+ *
+ * As with the standard condition variables, waits can wake up spuriously,
+ * and a notification only wakes up the threads that were already waiting.
+ * A notification can occasionally wake up more waiters than asked for.
+ */
+class DistributedConditionVariable {
+ public:
+  DistributedConditionVariable() = default;
+  DistributedConditionVariable(const DistributedConditionVariable&) = delete;
+  DistributedConditionVariable& operator=(
+      const DistributedConditionVariable&) = delete;
+
+  void notify_one() noexcept {
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_seq_cst) != 0) {
+      atomic_notify_one(&epoch_);
+    }
+  }
+
+  void notify_all() noexcept {
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_seq_cst) != 0) {
+      atomic_notify_all(&epoch_);
+    }
+  }
+
+  template <typename Lock>
+  void wait(Lock& lock) {
+    Waiter<Lock> waiter(*this, lock);
+    atomic_wait(&epoch_, waiter.epoch);
+  }
+
+  template <typename Lock, typename Predicate>
+  void wait(Lock& lock, Predicate predicate) {
+    while (!predicate()) {
+      wait(lock);
+    }
+  }
+
+  template <typename Lock, typename Clock, typename Duration>
+  std::cv_status wait_until(
+      Lock& lock, const std::chrono::time_point<Clock, Duration>& deadline) {
+    Waiter<Lock> waiter(*this, lock);
+    return atomic_wait_until(&epoch_, waiter.epoch, deadline);
+  }
+
+  template <
+      typename Lock,
+      typename Clock,
+      typename Duration,
+      typename Predicate>
+  bool wait_until(
+      Lock& lock,
+      const std::chrono::time_point<Clock, Duration>& deadline,
+      Predicate predicate) {
+    while (!predicate()) {
+      if (wait_until(lock, deadline) == std::cv_status::timeout) {
+        return predicate();
+      }
+    }
+    return true;
+  }
+
+  template <typename Lock, typename Rep, typename Period>
+  std::cv_status wait_for(
+      Lock& lock, const std::chrono::duration<Rep, Period>& timeout) {
+    return wait_until(lock, std::chrono::steady_clock::now() + timeout);
+  }
+
+  template <typename Lock, typename Rep, typename Period, typename Predicate>
+  bool wait_for(
+      Lock& lock,
+      const std::chrono::duration<Rep, Period>& timeout,
+      Predicate predicate) {
+    return wait_until(
+        lock, std::chrono::steady_clock::now() + timeout, std::move(predicate));
+  }
+
+ private:
+  // Registers as a waiter and reads the epoch while the lock is still held,
+  // so that any notification that follows a change made under the lock
+  // either sees the waiter or moves the epoch past the one waited on. The
+  // lock is released for the duration of the wait and reacquired, even if
+  // the wait throws.
+  template <typename Lock>
+  struct Waiter {
+    Waiter(DistributedConditionVariable& cv, Lock& l) : cv(cv), lock(l) {
+      cv.waiters_.fetch_add(1, std::memory_order_seq_cst);
+      epoch = cv.epoch_.load(std::memory_order_seq_cst);
+      lock.unlock();
+    }
+    ~Waiter() {
+      cv.waiters_.fetch_sub(1, std::memory_order_relaxed);
+      lock.lock();
+    }
+
+    DistributedConditionVariable& cv;
+    Lock& lock;
+    uint32_t epoch;
+  };
+
+  std::atomic<uint32_t> epoch_{0};
+  std::atomic<uint32_t> waiters_{0};
+};
+
+} // namespace folly
@@ -16,12 +16,17 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
 
 #include <folly/Executor.h>
+#include <folly/Likely.h>
 #include <folly/Memory.h>
 #include <folly/Portability.h>
 #include <folly/container/F14Set.h>
+#include <folly/lang/Align.h>
+#include <folly/lang/Bits.h>
 #include <folly/synchronization/AsymmetricThreadFence.h>
 #include <folly/synchronization/Hazptr-fwd.h>
 #include <folly/synchronization/HazptrObj.h>
@@ -48,6 +53,46 @@ folly::Executor::KeepAlive<> hazptr_get_default_executor();
 
 } // namespace detail
 
+/**
+ *  hazptr_domain_stats
+ *
+ *  Snapshot of the counters of a domain, as returned by
+ *  hazptr_domain::stats(). The counters are read one at a time while the
+ *  domain may be in use, so they are only mutually consistent when the
+ *  domain is quiescent.
+ *
+ *  - retired_count: Objects retired to the domain and neither reclaimed
+ *    nor handed back to their cohort yet. Objects waiting in a cohort
+ *    before being pushed to the domain are not included.
+ *  - retired_bytes: Estimate of the memory held by those objects, from the
+ *    sizes of the objects passed to retire().
+ *  - reclaimed_count: Objects that left the domain since its construction.
+ *  - reclamation_passes: Scans of the hazard pointers, each followed by the
+ *    reclamation of the unprotected objects.
+ *  - forced_reclamations: Synchronous reclamations triggered by exceeding
+ *    the byte budget set with set_max_retired_bytes().
+ *  - scan_time_histogram: Number of passes by duration. Bucket 0 counts
+ *    passes under 1us, bucket i those in [2^(i-1), 2^i) us, and the last
+ *    bucket all the longer ones.
+ */
+struct hazptr_domain_stats {
+  static constexpr size_t kScanTimeBuckets = 16;
+
+  int64_t retired_count{0};
+  int64_t retired_bytes{0};
+  uint64_t reclaimed_count{0};
+  uint64_t reclamation_passes{0};
+  uint64_t forced_reclamations{0};
+  std::chrono::nanoseconds scan_time_total{0};
+  std::array<uint64_t, kScanTimeBuckets> scan_time_histogram{};
+
+  std::chrono::nanoseconds avg_scan_time() const {
+    return reclamation_passes == 0
+        ? std::chrono::nanoseconds(0)
+        : scan_time_total / static_cast<int64_t>(reclamation_passes);
+  }
+};
+
 /**
  *  hazptr_domain
  *
@@ -95,6 +140,20 @@ folly::Executor::KeepAlive<> hazptr_get_default_executor();
  *    tagged list shard before reclaiming objects because the sets of
  *    reclaimable objects by different synchronous reclamation
  *    operations are disjoint.
+ *
+ *  Notes on memory bounds:
+ *  - Asynchronous reclamation bounds the number of retired objects, not
+ *    their size. set_max_retired_bytes() adds a budget for the estimated
+ *    size of the retired objects: a push of retired objects that finds
+ *    the domain over budget reclaims synchronously, in the calling
+ *    thread, instead of waiting for the threshold or handing the work to
+ *    the executor. If the objects left after such a reclamation are still
+ *    over budget, because they are protected, the next one only happens
+ *    once that amount has doubled, so that long-lived hazard pointers do
+ *    not make every retire() scan the hazard pointers.
+ *  - Sizes are known for objects retired through hazptr_obj_base,
+ *    hazptr_obj_base_linked and retire(); the size of an object is
+ *    estimated as the running average of those.
  */
 template <template <typename> class Atom>
 class hazptr_domain {
@@ -134,6 +193,22 @@ class hazptr_domain {
   Atom<uint64_t> due_time_{0};
   Atom<ExecFn> exec_fn_{nullptr};
   Atom<int> exec_backlog_{0};
+  /* Statistics and byte budget */
+  /* Objects pushed, counted per shard of the retired lists so that
+     concurrent retire() calls do not all write to the same line */
+  struct alignas(hardware_destructive_interference_size) PushedCount {
+    Atom<uint64_t> count{0};
+  };
+  PushedCount pushed_[kNumShards];
+  Atom<uint64_t> removed_{0};
+  Atom<int64_t> obj_size_{0};
+  Atom<int64_t> max_bytes_{0};
+  Atom<int64_t> bytes_after_reclamation_{0};
+  Atom<bool> forced_reclaiming_{false};
+  Atom<uint64_t> num_passes_{0};
+  Atom<uint64_t> num_forced_{0};
+  Atom<uint64_t> scan_time_ns_{0};
+  Atom<uint64_t> scan_time_hist_[hazptr_domain_stats::kScanTimeBuckets] = {};
 
  public:
   /** Constructor */
@@ -162,6 +237,35 @@ class hazptr_domain {
 
   void clear_executor() { exec_fn_.store(nullptr, std::memory_order_release); }
 
+  /** set_max_retired_bytes: Budget for the estimated size of the retired
+      objects, beyond which retiring reclaims synchronously. 0, the
+      default, disables the budget. */
+  void set_max_retired_bytes(size_t bytes) {
+    max_bytes_.store(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+  }
+
+  /** max_retired_bytes */
+  size_t max_retired_bytes() const {
+    return static_cast<size_t>(max_bytes_.load(std::memory_order_relaxed));
+  }
+
+  /** stats */
+  hazptr_domain_stats stats() const {
+    hazptr_domain_stats st;
+    st.retired_count = retired_count();
+    st.retired_bytes = retired_bytes();
+    st.reclaimed_count = removed_.load(std::memory_order_relaxed);
+    st.reclamation_passes = num_passes_.load(std::memory_order_relaxed);
+    st.forced_reclamations = num_forced_.load(std::memory_order_relaxed);
+    st.scan_time_total = std::chrono::nanoseconds(
+        scan_time_ns_.load(std::memory_order_relaxed));
+    for (size_t i = 0; i < hazptr_domain_stats::kScanTimeBuckets; ++i) {
+      st.scan_time_histogram[i] =
+          scan_time_hist_[i].load(std::memory_order_relaxed);
+    }
+    return st;
+  }
+
   /** retire - nonintrusive - allocates memory */
   template <typename T, typename D = std::default_delete<T>>
   void retire(T* obj, D reclaim = {}) {
@@ -172,6 +276,7 @@ class hazptr_domain {
     };
 
     auto node = new hazptr_retire_node(obj, std::move(reclaim));
+    note_retired_size(sizeof(T));
     node->reclaim_ = [](hazptr_obj<Atom>* p, hazptr_obj_list<Atom>&) {
       delete static_cast<hazptr_retire_node*>(p);
     };
@@ -213,6 +318,7 @@ class hazptr_domain {
     List l(nomatch.head(), nomatch.tail());
     tagged_[shard].push_unlock(l);
     add_count(-match.count());
+    removed_.fetch_add(match.count(), std::memory_order_release);
     obj = match.head();
     reclaim_list_transitive(obj);
     int count = match.count() + nomatch.count();
@@ -239,6 +345,10 @@ class hazptr_domain {
   friend class hazptr_holder<Atom>;
   friend class hazptr_obj<Atom>;
   friend class hazptr_obj_cohort<Atom>;
+  template <typename, template <typename> class, typename>
+  friend class hazptr_obj_base;
+  template <typename, template <typename> class, typename>
+  friend class hazptr_obj_base_linked;
 #if FOLLY_HAZPTR_THR_LOCAL
   friend class hazptr_tc<Atom>;
 #endif
@@ -283,6 +393,33 @@ class hazptr_domain {
     num_bulk_reclaims_.fetch_sub(1, std::memory_order_release);
   }
 
+  int64_t retired_count() const {
+    // Load removed_ first, so that the difference is not transiently
+    // negative because of objects pushed and removed in between.
+    auto removed = removed_.load(std::memory_order_acquire);
+    uint64_t pushed = 0;
+    for (int s = 0; s < kNumShards; ++s) {
+      pushed += pushed_[s].count.load(std::memory_order_acquire);
+    }
+    return std::max<int64_t>(0, static_cast<int64_t>(pushed - removed));
+  }
+
+  int64_t retired_bytes() const {
+    return retired_count() * obj_size_.load(std::memory_order_relaxed);
+  }
+
+  /** note_retired_size: Running average of the sizes of retired objects.
+      Only stores when the average changes, so that retiring objects of a
+      single type does not write to the domain. */
+  void note_retired_size(size_t size) noexcept {
+    auto avg = obj_size_.load(std::memory_order_relaxed);
+    auto next = avg == 0 ? static_cast<int64_t>(size)
+                         : avg + (static_cast<int64_t>(size) - avg) / 8;
+    if (next != avg) {
+      obj_size_.store(next, std::memory_order_relaxed);
+    }
+  }
+
   uintptr_t load_avail() { return avail_.load(std::memory_order_acquire); }
 
   void store_avail(uintptr_t val) {
@@ -336,15 +473,51 @@ class hazptr_domain {
     /*** Full fence ***/ asymmetric_thread_fence_light(
         std::memory_order_seq_cst);
     List ll(l.head(), l.tail());
+    size_t shard;
     if (!tagged) {
-      untagged_[calc_shard(l.head())].push(ll, RetiredList::kMayNotBeLocked);
+      shard = calc_shard(l.head());
+      untagged_[shard].push(ll, RetiredList::kMayNotBeLocked);
     } else {
-      tagged_[calc_shard(btag)].push(ll, RetiredList::kMayBeLocked);
+      shard = calc_shard(btag);
+      tagged_[shard].push(ll, RetiredList::kMayBeLocked);
     }
+    pushed_[shard].count.fetch_add(l.count(), std::memory_order_release);
     add_count(l.count());
+    if (FOLLY_UNLIKELY(over_byte_budget())) {
+      reclaim_over_budget();
+      return;
+    }
     check_threshold_and_reclaim();
   }
 
+  /** over_byte_budget */
+  bool over_byte_budget() {
+    auto budget = max_bytes_.load(std::memory_order_relaxed);
+    if (budget == 0) {
+      return false;
+    }
+    auto left = bytes_after_reclamation_.load(std::memory_order_relaxed);
+    return retired_bytes() > std::max(budget, 2 * left);
+  }
+
+  /** reclaim_over_budget: Synchronous reclamation in the calling thread,
+      by one thread at a time. Others go on with the regular checks. */
+  void reclaim_over_budget() {
+    if (forced_reclaiming_.exchange(true, std::memory_order_acquire)) {
+      check_threshold_and_reclaim();
+      return;
+    }
+    num_forced_.fetch_add(1, std::memory_order_relaxed);
+    int rcount = exchange_count(0);
+    if (rcount < 0) {
+      add_count(rcount);
+      rcount = 0;
+    }
+    inc_num_bulk_reclaims();
+    do_reclamation(rcount);
+    forced_reclaiming_.store(false, std::memory_order_release);
+  }
+
   /** threshold */
   int threshold() {
     auto thresh = kThreshold;
@@ -472,6 +645,7 @@ class hazptr_domain {
           return hs.count(o->raw_ptr()) > 0;
         });
         count += nomatch.count();
+        removed_.fetch_add(nomatch.count(), std::memory_order_release);
         auto obj = nomatch.head();
         while (obj) {
           auto next = obj->next();
@@ -504,6 +678,8 @@ class hazptr_domain {
         done = false;
       }
       count -= children.count();
+      pushed_[s].count.fetch_add(children.count(), std::memory_order_release);
+      removed_.fetch_add(nomatch.count(), std::memory_order_release);
       not_reclaimed.splice(match);
       not_reclaimed.splice(children);
     }
@@ -520,11 +696,13 @@ class hazptr_domain {
       Obj* tagged[kNumShards];
       bool done = true;
       if (extract_retired_objects(untagged, tagged)) {
+        auto start = std::chrono::steady_clock::now();
         /*** Full fence ***/ asymmetric_thread_fence_heavy(
             std::memory_order_seq_cst);
         Set hs = load_hazptr_vals();
         rcount -= match_tagged(tagged, hs);
         rcount -= match_reclaim_untagged(untagged, hs, done);
+        record_pass(std::chrono::steady_clock::now() - start);
       }
       if (rcount) {
         add_count(rcount);
@@ -533,9 +711,22 @@ class hazptr_domain {
       if (rcount == 0 && done)
         break;
     }
+    bytes_after_reclamation_.store(retired_bytes(), std::memory_order_relaxed);
     dec_num_bulk_reclaims();
   }
 
+  /** record_pass */
+  void record_pass(std::chrono::steady_clock::duration elapsed) {
+    auto ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    auto bucket = std::min<size_t>(
+        folly::findLastSet(ns / 1000),
+        hazptr_domain_stats::kScanTimeBuckets - 1);
+    num_passes_.fetch_add(1, std::memory_order_relaxed);
+    scan_time_ns_.fetch_add(ns, std::memory_order_relaxed);
+    scan_time_hist_[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
   /** list_match_condition */
   template <typename Cond>
   void list_match_condition(
@@ -510,6 +510,7 @@ class hazptr_obj_base : public hazptr_obj<Atom>, public hazptr_deleter<T, D> {
       hazptr_domain<Atom>& domain = default_hazptr_domain<Atom>()) {
     pre_retire(std::move(deleter));
     set_reclaim();
+    domain.note_retired_size(sizeof(T));
     this->push_obj(domain); // defined in hazptr_obj
   }
 
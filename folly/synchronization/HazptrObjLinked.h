@@ -229,6 +229,7 @@ class hazptr_obj_base_linked : public hazptr_obj_linked<Atom>,
     this->pre_retire_check(); // defined in hazptr_obj
     set_reclaim();
     auto& domain = default_hazptr_domain<Atom>();
+    domain.note_retired_size(sizeof(T));
     this->push_obj(domain); // defined in hazptr_obj
   }
 
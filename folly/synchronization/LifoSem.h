@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -33,6 +34,7 @@
 #include <folly/lang/SafeAssert.h>
 #include <folly/synchronization/AtomicStruct.h>
 #include <folly/synchronization/SaturatingSemaphore.h>
+#include <folly/synchronization/detail/AdaptiveSpin.h>
 
 namespace folly {
 
@@ -93,6 +95,11 @@ struct LifoSemImpl;
 /// to remove if you want the draining behavior, which is why we have
 /// chosen the former.
 ///
+/// Blocked waiters spin for a short fixed time before going to sleep.  With
+/// Options::adaptiveSpin that time is instead tuned online per semaphore:
+/// it grows while handoffs arrive soon enough for spinning to be cheaper
+/// than sleeping, and shrinks to nothing when waiters mostly wait long.
+///
 /// All LifoSem operations except valueGuess() are guaranteed to be
 /// linearizable.
 typedef LifoSemImpl<> LifoSem;
@@ -172,7 +179,8 @@ struct LifoSemRawNode {
 /// single post() -> wait() communication.  It must have a post() method.
 /// If it has a wait() method then LifoSemBase's wait() implementation
 /// will work out of the box, otherwise you will need to specialize
-/// LifoSemBase::wait accordingly.
+/// LifoSemBase::wait accordingly.  Options::adaptiveSpin additionally
+/// requires a try_wait_until() overload that takes WaitOptions.
 template <typename Handoff, template <typename> class Atom>
 struct LifoSemNode : public LifoSemRawNode<Atom> {
   static_assert(
@@ -358,14 +366,22 @@ class LifoSemHead {
 /// See LifoSemNode for more information on how to make your own.
 template <typename Handoff, template <typename> class Atom = std::atomic>
 struct LifoSemBase {
-  /// Currently unused, only for compatibility with ThrottledLifoSem.
-  struct Options {};
+  struct Options {
+    /// If set, how long waiters spin before blocking is tuned online from
+    /// the measured handoff latency and wake-up cost, up to maxSpin, see
+    /// detail::AdaptiveSpin. Otherwise they spin for the Handoff default.
+    bool adaptiveSpin = false;
+    std::chrono::nanoseconds maxSpin = AdaptiveSpin::kDefaultMaxSpin;
+  };
 
   /// Constructor
   constexpr explicit LifoSemBase(uint32_t initialValue = 0)
       : LifoSemBase({}, initialValue) {}
-  constexpr explicit LifoSemBase(const Options&, uint32_t initialValue = 0)
-      : head_(std::in_place, LifoSemHead::fresh(initialValue)) {}
+  constexpr explicit LifoSemBase(
+      const Options& options, uint32_t initialValue = 0)
+      : head_(std::in_place, LifoSemHead::fresh(initialValue)),
+        adaptiveSpin_(options.adaptiveSpin),
+        spin_(options.maxSpin) {}
 
   LifoSemBase(LifoSemBase const&) = delete;
   LifoSemBase& operator=(LifoSemBase const&) = delete;
@@ -375,7 +391,7 @@ struct LifoSemBase {
   bool tryPost() {
     auto idx = incrOrPop(1, true);
     if (idx != 0) {
-      idxToNode(idx).handoff().post();
+      postHandoff(idx);
       return true;
     }
     return false;
@@ -385,7 +401,7 @@ struct LifoSemBase {
   bool post() {
     auto idx = incrOrPop(1);
     if (idx != 0) {
-      idxToNode(idx).handoff().post();
+      postHandoff(idx);
       return true;
     }
     return false;
@@ -400,13 +416,16 @@ struct LifoSemBase {
   /// guaranteeing exact saturation (similar to the cost of maintaining
   /// linearizability near the zero value, but without as much of
   /// a benefit).
-  void post(uint32_t n) {
+  ///
+  /// Returns true iff all n were handed off to waiters.
+  bool post(uint32_t n) {
     uint32_t idx;
     while (n > 0 && (idx = incrOrPop(n)) != 0) {
       // pop accounts for only 1
-      idxToNode(idx).handoff().post();
+      postHandoff(idx);
       --n;
     }
+    return n == 0;
   }
 
   /// Returns true iff shutdown() has been called
@@ -525,7 +544,7 @@ struct LifoSemBase {
     }
 
     if (rv == WaitResult::PUSH) {
-      if (!node->handoff().try_wait_until(deadline)) {
+      if (!waitHandoff(*node, deadline)) {
         if (tryRemoveNode(*node)) {
           return false;
         } else {
@@ -665,6 +684,35 @@ struct LifoSemBase {
  private:
   cacheline_aligned<folly::AtomicStruct<LifoSemHead, Atom>> head_;
 
+  const bool adaptiveSpin_;
+  AdaptiveSpin spin_;
+
+  void postHandoff(uint32_t idx) {
+    auto& handoff = idxToNode(idx).handoff();
+    if (!adaptiveSpin_) {
+      handoff.post();
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    handoff.post();
+    spin_.recordWake(std::chrono::steady_clock::now() - start);
+  }
+
+  template <typename Clock, typename Duration>
+  bool waitHandoff(
+      LifoSemNode<Handoff, Atom>& node,
+      const std::chrono::time_point<Clock, Duration>& deadline) {
+    if (!adaptiveSpin_) {
+      return node.handoff().try_wait_until(deadline);
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (!node.handoff().try_wait_until(deadline, spin_.waitOptions())) {
+      return false;
+    }
+    spin_.recordWait(std::chrono::steady_clock::now() - start);
+    return true;
+  }
+
   static LifoSemNode<Handoff, Atom>& idxToNode(uint32_t idx) {
     auto raw = &LifoSemRawNode<Atom>::pool()[idx];
     return *static_cast<LifoSemNode<Handoff, Atom>*>(raw);
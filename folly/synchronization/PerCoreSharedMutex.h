@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include <folly/Likely.h>
+#include <folly/concurrency/CacheLocality.h>
+#include <folly/lang/Aligned.h>
+#include <folly/synchronization/AsymmetricThreadFence.h>
+#include <folly/synchronization/AtomicNotification.h>
+#include <folly/synchronization/WaitOptions.h>
+#include <folly/synchronization/detail/Spin.h>
+
+namespace folly {
+
+/**
+ * A reader-biased shared mutex whose reader indicator is a set of per-core
+ * counters, one per cpu of CacheLocality::system() (up to
+ * AccessSpreader::maxStripeValue()), each on its own cache line.
+ *
+ * SharedMutex records readers in a global table of deferred reader slots,
+ * one per concurrent reader, and falls back to its shared state word, and
+ * the contention that comes with it, once the table is full. Here the
+ * counters are shared by all the threads running on the same core instead,
+ * so any number of threads can hold the lock in shared mode and the cost of
+ * lock_shared() does not depend on the number of threads.
+ *
+ * lock_shared() increments the counter of the calling thread's core and
+ * then checks for a writer, with only asymmetric_thread_fence_light() in
+ * between. A writer sets its flag, issues asymmetric_thread_fence_heavy()
+ * and then waits for all the counters to drain. Readers that see the flag
+ * undo their increment and wait for the writer to be done.
+ *
+ * The trade-offs are those of a reader-biased lock: writers are expensive,
+ * since the heavy fence is a system call and they have to scan all the
+ * counters, and new readers wait behind a writer that is waiting for old
+ * ones. Each mutex also takes one cache line per core, so this is meant for
+ * a few hot, read-mostly locks. Upgrade locks are not supported.
+ *
+ * A thread keeps using the counter of the core it first took such a lock
+ * on, so that unlock_shared() decrements the same counter even if the
+ * thread migrated in between. As for std::shared_mutex, unlock_shared()
+ * must be called by the thread that called lock_shared().
+ */
+class PerCoreSharedMutex {
+ public:
+  PerCoreSharedMutex()
+      : numSlots_(numSlots()), slots_(new Slot[numSlots_]()) {}
+
+  PerCoreSharedMutex(const PerCoreSharedMutex&) = delete;
+  PerCoreSharedMutex& operator=(const PerCoreSharedMutex&) = delete;
+
+  void lock_shared() {
+    auto& count = slot();
+    while (true) {
+      count.fetch_add(1, std::memory_order_relaxed);
+      asymmetric_thread_fence_light(std::memory_order_seq_cst);
+      if (FOLLY_LIKELY(!(state_.load(std::memory_order_acquire) & kWriter))) {
+        return;
+      }
+      count.fetch_sub(1, std::memory_order_release);
+      waitForNoWriter();
+    }
+  }
+
+  bool try_lock_shared() {
+    auto& count = slot();
+    count.fetch_add(1, std::memory_order_relaxed);
+    asymmetric_thread_fence_light(std::memory_order_seq_cst);
+    if (FOLLY_LIKELY(!(state_.load(std::memory_order_acquire) & kWriter))) {
+      return true;
+    }
+    count.fetch_sub(1, std::memory_order_release);
+    return false;
+  }
+
+  void unlock_shared() { slot().fetch_sub(1, std::memory_order_release); }
+
+  void lock() {
+    auto state = state_.load(std::memory_order_relaxed);
+    while (true) {
+      if (!(state & kWriter)) {
+        if (state_.compare_exchange_weak(
+                state,
+                state | kWriter,
+                std::memory_order_acquire,
+                std::memory_order_relaxed)) {
+          break;
+        }
+      } else {
+        waitForNoWriter();
+        state = state_.load(std::memory_order_relaxed);
+      }
+    }
+    asymmetric_thread_fence_heavy(std::memory_order_seq_cst);
+    for (size_t i = 0; i < numSlots_; ++i) {
+      auto& count = *slots_[i];
+      detail::spin_yield_until(
+          std::chrono::steady_clock::time_point::max(),
+          [&] { return count.load(std::memory_order_acquire) == 0; });
+    }
+  }
+
+  bool try_lock() {
+    auto state = state_.load(std::memory_order_relaxed);
+    if ((state & kWriter) ||
+        !state_.compare_exchange_strong(
+            state,
+            state | kWriter,
+            std::memory_order_acquire,
+            std::memory_order_relaxed)) {
+      return false;
+    }
+    asymmetric_thread_fence_heavy(std::memory_order_seq_cst);
+    for (size_t i = 0; i < numSlots_; ++i) {
+      if (slots_[i]->load(std::memory_order_acquire) != 0) {
+        unlock();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void unlock() {
+    if (state_.exchange(0, std::memory_order_release) & kWaiters) {
+      atomic_notify_all(&state_);
+    }
+  }
+
+  /// Number of per-core reader counters of every PerCoreSharedMutex.
+  static size_t numSlots() {
+    static const size_t n = std::max<size_t>(
+        1,
+        std::min<size_t>(
+            CacheLocality::system().numCpus,
+            AccessSpreader<>::maxStripeValue()));
+    return n;
+  }
+
+ private:
+  using Slot = cacheline_aligned<std::atomic<int64_t>>;
+
+  static constexpr uint32_t kWriter = 1;
+  static constexpr uint32_t kWaiters = 2;
+
+  std::atomic<int64_t>& slot() {
+    static thread_local size_t index = AccessSpreader<>::current(numSlots());
+    return *slots_[index];
+  }
+
+  void waitForNoWriter() {
+    auto noWriter = [&] {
+      return !(state_.load(std::memory_order_acquire) & kWriter);
+    };
+    if (detail::spin_pause_until(
+            std::chrono::steady_clock::time_point::max(),
+            WaitOptions{},
+            noWriter) == detail::spin_result::success) {
+      return;
+    }
+    auto state = state_.load(std::memory_order_relaxed);
+    while (state & kWriter) {
+      if (!(state & kWaiters) &&
+          !state_.compare_exchange_weak(
+              state, state | kWaiters, std::memory_order_relaxed)) {
+        continue;
+      }
+      atomic_wait(&state_, state | kWaiters);
+      state = state_.load(std::memory_order_acquire);
+    }
+  }
+
+  std::atomic<uint32_t> state_{0};
+  const size_t numSlots_;
+  std::unique_ptr<Slot[]> slots_;
+};
+
+} // namespace folly
@@ -26,6 +26,7 @@
 #include <folly/synchronization/DistributedMutex.h>
 #include <folly/synchronization/SaturatingSemaphore.h>
 #include <folly/synchronization/WaitOptions.h>
+#include <folly/synchronization/detail/AdaptiveSpin.h>
 #include <folly/synchronization/detail/Spin.h>
 
 namespace folly {
@@ -70,6 +71,12 @@ class ThrottledLifoSem {
  public:
   struct Options {
     std::chrono::nanoseconds wakeUpInterval = {};
+    /// If set, the initial spin of waiters is tuned online from the measured
+    /// handoff latency and wake-up cost, up to maxSpin, instead of using the
+    /// spin_max of the WaitOptions passed to the wait functions. See
+    /// detail::AdaptiveSpin.
+    bool adaptiveSpin = false;
+    std::chrono::nanoseconds maxSpin = detail::AdaptiveSpin::kDefaultMaxSpin;
   };
 
   // Setting initialValue is equivalent to calling post(initialValue)
@@ -77,7 +84,7 @@ class ThrottledLifoSem {
   explicit ThrottledLifoSem(uint32_t initialValue = 0)
       : ThrottledLifoSem(Options{}, initialValue) {}
   explicit ThrottledLifoSem(const Options& options, uint32_t initialValue = 0)
-      : options_(options), state_(initialValue) {}
+      : options_(options), spin_(options.maxSpin), state_(initialValue) {}
 
   ~ThrottledLifoSem() {
     DCHECK(!(state_.load() & kWakingBit));
@@ -139,18 +146,10 @@ class ThrottledLifoSem {
 
     state_.fetch_add(kNumWaitersInc, std::memory_order_seq_cst);
 
-    switch (detail::spin_pause_until(deadline, opt, [this] {
-      return tryWaitImpl<DecrNumWaiters::OnSuccess>();
-    })) {
-      case detail::spin_result::success:
-        return true;
-      case detail::spin_result::timeout:
-        return tryWaitOnTimeout();
-      case detail::spin_result::advance:
-        break;
+    if (options_.adaptiveSpin) {
+      return tryWaitUntilAdaptive(deadline);
     }
-
-    return tryWaitUntilSlow(deadline);
+    return tryWaitUntilNotReady(deadline, opt);
   }
 
   uint32_t valueGuess() const {
@@ -198,6 +197,46 @@ class ThrottledLifoSem {
     return false;
   }
 
+  // The part of try_wait_until() after incrementing the number of waiters.
+  template <typename Clock, typename Duration>
+  bool tryWaitUntilNotReady(
+      const std::chrono::time_point<Clock, Duration>& deadline,
+      const WaitOptions& opt) {
+    switch (detail::spin_pause_until(deadline, opt, [this] {
+      return tryWaitImpl<DecrNumWaiters::OnSuccess>();
+    })) {
+      case detail::spin_result::success:
+        return true;
+      case detail::spin_result::timeout:
+        return tryWaitOnTimeout();
+      case detail::spin_result::advance:
+        break;
+    }
+
+    return tryWaitUntilSlow(deadline);
+  }
+
+  template <typename Clock, typename Duration>
+  bool tryWaitUntilAdaptive(
+      const std::chrono::time_point<Clock, Duration>& deadline) {
+    const auto start = std::chrono::steady_clock::now();
+    if (!tryWaitUntilNotReady(deadline, spin_.waitOptions())) {
+      return false;
+    }
+    spin_.recordWait(std::chrono::steady_clock::now() - start);
+    return true;
+  }
+
+  void wakeUp(Waiter& waiter) {
+    if (!options_.adaptiveSpin) {
+      waiter.wakeup.post();
+      return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    waiter.wakeup.post();
+    spin_.recordWake(std::chrono::steady_clock::now() - start);
+  }
+
   // If timed out after incrementing the number of waiters, we may have promised
   // a waiting thread if post() returned true, so we need to give a last look.
   bool tryWaitOnTimeout() { return tryWaitImpl<DecrNumWaiters::Always>(); }
@@ -282,7 +321,7 @@ class ThrottledLifoSem {
               }
               return w;
             })) {
-          nextWaiter->wakeup.post();
+          wakeUp(*nextWaiter);
         }
 
         return success;
@@ -301,7 +340,7 @@ class ThrottledLifoSem {
           }
           return w;
         })) {
-      waiter->wakeup.post();
+      wakeUp(*waiter);
     }
   }
 
@@ -339,6 +378,7 @@ class ThrottledLifoSem {
   }
 
   const Options options_;
+  detail::AdaptiveSpin spin_;
 
   // State: [numWaiters (31 bits) | waking (1 bit) | value (32 bits)]
   // numWaiters includes the waking thread.
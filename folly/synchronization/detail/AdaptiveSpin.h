@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <folly/synchronization/WaitOptions.h>
+
+namespace folly {
+namespace detail {
+
+/**
+ * Online tuning of how long a waiter spins before blocking, for one
+ * semaphore.
+ *
+ * Waiters report how long each wait took, from the moment they started
+ * spinning to the handoff, and posters report how long it took to wake up a
+ * waiter. Spinning for longer than it costs to block and be woken up never
+ * pays off, so a wait that took under twice the wake-up cost (and under
+ * maxSpin) could have stayed in userspace: the spin budget moves towards
+ * twice that wait time, leaving some headroom. Longer waits mean that the
+ * semaphore is mostly idle, and the budget moves towards zero.
+ *
+ * So under heavy load the budget settles slightly above the typical handoff
+ * latency, while on a mostly idle semaphore waiters block right away rather
+ * than burning cpu.
+ *
+ * The wake-up cost is only known for posts that went through the kernel,
+ * but posters cannot tell those from cheap posts to a spinning waiter. It
+ * is therefore estimated from the upper envelope of the post times: it
+ * quickly rises to larger samples and slowly decays on smaller ones.
+ *
+ * All the estimates are moving averages updated with relaxed loads and
+ * stores; concurrent updates may be lost, which only slows down adaptation.
+ */
+class AdaptiveSpin {
+ public:
+  static constexpr std::chrono::nanoseconds kDefaultMaxSpin =
+      std::chrono::microseconds(20);
+  // Typical cost of a futex wait and wake-up, until measured.
+  static constexpr std::chrono::nanoseconds kInitialWakeCost =
+      std::chrono::microseconds(5);
+
+  constexpr explicit AdaptiveSpin(
+      std::chrono::nanoseconds maxSpin = kDefaultMaxSpin) noexcept
+      : maxSpinNs_(std::max<int64_t>(0, maxSpin.count())),
+        spinNs_(std::min<int64_t>(
+            maxSpinNs_, WaitOptions::Defaults::spin_max.count())),
+        wakeCostNs_(kInitialWakeCost.count()) {}
+
+  std::chrono::nanoseconds spinBudget() const noexcept {
+    return std::chrono::nanoseconds(spinNs_.load(std::memory_order_relaxed));
+  }
+
+  std::chrono::nanoseconds wakeCost() const noexcept {
+    return std::chrono::nanoseconds(
+        wakeCostNs_.load(std::memory_order_relaxed));
+  }
+
+  std::chrono::nanoseconds maxSpin() const noexcept {
+    return std::chrono::nanoseconds(maxSpinNs_);
+  }
+
+  /// The options to wait with, spinning for the current budget.
+  WaitOptions waitOptions() const noexcept {
+    return WaitOptions{}.spin_max(spinBudget());
+  }
+
+  /// Records a wait that was satisfied after elapsed, spinning included.
+  void recordWait(std::chrono::nanoseconds elapsed) noexcept {
+    auto ns = std::max<int64_t>(0, elapsed.count());
+    auto worthSpinning = std::min<int64_t>(
+        maxSpinNs_, 2 * wakeCostNs_.load(std::memory_order_relaxed));
+    auto target = ns <= worthSpinning ? std::min(2 * ns, worthSpinning) : 0;
+    auto spin = spinNs_.load(std::memory_order_relaxed);
+    spinNs_.store((7 * spin + target) / 8, std::memory_order_relaxed);
+  }
+
+  /// Records the time a post() took to hand off to a waiter.
+  void recordWake(std::chrono::nanoseconds cost) noexcept {
+    auto ns = std::max<int64_t>(0, cost.count());
+    auto wakeCost = wakeCostNs_.load(std::memory_order_relaxed);
+    auto next = ns > wakeCost ? wakeCost + (ns - wakeCost) / 2
+                              : wakeCost - (wakeCost - ns) / 64;
+    wakeCostNs_.store(next, std::memory_order_relaxed);
+  }
+
+ private:
+  const int64_t maxSpinNs_;
+  std::atomic<int64_t> spinNs_;
+  std::atomic<int64_t> wakeCostNs_;
+};
+
+} // namespace detail
+} // namespace folly
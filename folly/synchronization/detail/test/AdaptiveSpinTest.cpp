@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/synchronization/detail/AdaptiveSpin.h>
+
+#include <chrono>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly::detail;
+using namespace std::chrono_literals;
+
+TEST(AdaptiveSpin, initial) {
+  AdaptiveSpin spin;
+  EXPECT_EQ(folly::WaitOptions::Defaults::spin_max, spin.spinBudget());
+  EXPECT_EQ(spin.spinBudget(), spin.waitOptions().spin_max());
+  EXPECT_EQ(AdaptiveSpin::kInitialWakeCost, spin.wakeCost());
+  EXPECT_EQ(AdaptiveSpin::kDefaultMaxSpin, spin.maxSpin());
+
+  AdaptiveSpin noSpin(0ns);
+  EXPECT_EQ(0ns, noSpin.spinBudget());
+  noSpin.recordWait(100ns);
+  EXPECT_EQ(0ns, noSpin.spinBudget());
+}
+
+TEST(AdaptiveSpin, shortHandoffs) {
+  AdaptiveSpin spin;
+  for (int i = 0; i < 100; ++i) {
+    spin.recordWait(300ns);
+  }
+  // Settles with some headroom above the handoff latency.
+  EXPECT_GE(spin.spinBudget(), 500ns);
+  EXPECT_LE(spin.spinBudget(), 600ns);
+}
+
+TEST(AdaptiveSpin, handoffsJustAfterBlocking) {
+  AdaptiveSpin spin;
+  // Spinning a little longer than the default would have avoided blocking.
+  for (int i = 0; i < 100; ++i) {
+    spin.recordWait(3us);
+  }
+  EXPECT_GE(spin.spinBudget(), 5us);
+  EXPECT_LE(spin.spinBudget(), 6us);
+
+  // But never longer than twice the wake-up cost.
+  for (int i = 0; i < 100; ++i) {
+    spin.recordWait(8us);
+  }
+  EXPECT_LE(spin.spinBudget(), 2 * spin.wakeCost());
+  EXPECT_GE(spin.spinBudget(), 2 * spin.wakeCost() - 100ns);
+}
+
+TEST(AdaptiveSpin, mostlyIdle) {
+  AdaptiveSpin spin;
+  for (int i = 0; i < 100; ++i) {
+    spin.recordWait(1ms);
+  }
+  EXPECT_EQ(0ns, spin.spinBudget());
+
+  // Load picks up again.
+  for (int i = 0; i < 100; ++i) {
+    spin.recordWait(1us);
+  }
+  EXPECT_GE(spin.spinBudget(), 1900ns);
+}
+
+TEST(AdaptiveSpin, maxSpin) {
+  AdaptiveSpin spin(1us);
+  EXPECT_EQ(1us, spin.spinBudget());
+  for (int i = 0; i < 100; ++i) {
+    spin.recordWait(900ns);
+  }
+  EXPECT_LE(spin.spinBudget(), 1us);
+  EXPECT_GE(spin.spinBudget(), 900ns);
+}
+
+TEST(AdaptiveSpin, wakeCost) {
+  AdaptiveSpin spin;
+  // Rises quickly to expensive wake-ups.
+  for (int i = 0; i < 10; ++i) {
+    spin.recordWake(20us);
+  }
+  EXPECT_GE(spin.wakeCost(), 19us);
+  // Cheap posts to spinning waiters only slowly bring it down.
+  for (int i = 0; i < 10; ++i) {
+    spin.recordWake(100ns);
+  }
+  EXPECT_GE(spin.wakeCost(), 15us);
+  for (int i = 0; i < 1000; ++i) {
+    spin.recordWake(100ns);
+  }
+  EXPECT_LE(spin.wakeCost(), 1us);
+}
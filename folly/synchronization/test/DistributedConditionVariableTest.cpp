@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/synchronization/DistributedConditionVariable.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <folly/Synchronized.h>
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/DistributedMutex.h>
+
+using namespace folly;
+
+TEST(DistributedConditionVariable, waitForTimesOut) {
+  DistributedMutex mutex;
+  DistributedConditionVariable cv;
+  auto lock = std::unique_lock{mutex};
+  EXPECT_EQ(
+      std::cv_status::timeout, cv.wait_for(lock, std::chrono::milliseconds(1)));
+  EXPECT_TRUE(lock.owns_lock());
+  EXPECT_FALSE(cv.wait_for(lock, std::chrono::milliseconds(1), [] {
+    return false;
+  }));
+  EXPECT_TRUE(cv.wait_for(lock, std::chrono::hours(1), [] { return true; }));
+  EXPECT_TRUE(lock.owns_lock());
+}
+
+TEST(DistributedConditionVariable, notifyOne) {
+  DistributedMutex mutex;
+  DistributedConditionVariable cv;
+  bool ready = false;
+  std::thread waiter([&] {
+    auto lock = std::unique_lock{mutex};
+    cv.wait(lock, [&] { return ready; });
+    EXPECT_TRUE(lock.owns_lock());
+  });
+  mutex.lock_combine([&] { ready = true; });
+  cv.notify_one();
+  waiter.join();
+}
+
+TEST(DistributedConditionVariable, notifyAll) {
+  constexpr int kWaiters = 4;
+  DistributedMutex mutex;
+  DistributedConditionVariable cv;
+  int waiting = 0;
+  bool go = false;
+  DistributedConditionVariable started;
+  std::vector<std::thread> waiters;
+  for (int i = 0; i < kWaiters; ++i) {
+    waiters.emplace_back([&] {
+      auto lock = std::unique_lock{mutex};
+      ++waiting;
+      started.notify_one();
+      cv.wait(lock, [&] { return go; });
+    });
+  }
+  {
+    auto lock = std::unique_lock{mutex};
+    started.wait(lock, [&] { return waiting == kWaiters; });
+    go = true;
+  }
+  cv.notify_all();
+  for (auto& waiter : waiters) {
+    waiter.join();
+  }
+}
+
+TEST(DistributedConditionVariable, producerConsumer) {
+  constexpr int kProducers = 4;
+  constexpr int kConsumers = 4;
+  constexpr int kItems = 10000;
+  Synchronized<std::deque<int>, DistributedMutex> queue;
+  DistributedConditionVariable notEmpty;
+  std::atomic<int64_t> sum{0};
+  std::vector<std::thread> threads;
+  for (int c = 0; c < kConsumers; ++c) {
+    threads.emplace_back([&] {
+      while (true) {
+        auto locked = queue.lock();
+        notEmpty.wait(locked.as_lock(), [&] { return !locked->empty(); });
+        auto item = locked->front();
+        locked->pop_front();
+        if (item < 0) {
+          return;
+        }
+        sum += item;
+      }
+    });
+  }
+  for (int p = 0; p < kProducers; ++p) {
+    threads.emplace_back([&] {
+      for (int i = 1; i <= kItems; ++i) {
+        queue.withLockCombined([&](auto& q) { q.push_back(i); });
+        notEmpty.notify_one();
+      }
+    });
+  }
+  for (int p = 0; p < kProducers; ++p) {
+    threads[kConsumers + p].join();
+  }
+  queue.withLockCombined([&](auto& q) {
+    for (int c = 0; c < kConsumers; ++c) {
+      q.push_back(-1);
+    }
+  });
+  notEmpty.notify_all();
+  for (int c = 0; c < kConsumers; ++c) {
+    threads[c].join();
+  }
+  EXPECT_EQ(int64_t(kProducers) * kItems * (kItems + 1) / 2, sum.load());
+}
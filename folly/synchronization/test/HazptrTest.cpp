@@ -1346,6 +1346,66 @@ TEST(HazptrTest, reclamationWithoutCallingCleanup) {
   ASSERT_GT(c_.dtors(), 0);
 }
 
+TEST(HazptrTest, domainStats) {
+  c_.clear();
+  hazptr_domain<> domain;
+  constexpr int kObjs = 100;
+  for (int i = 0; i < kObjs; ++i) {
+    (new Node<>(i))->retire(domain);
+  }
+  // The first push may have found the time-based reclamation due.
+  auto st = domain.stats();
+  EXPECT_EQ(kObjs, st.retired_count + int64_t(st.reclaimed_count));
+  EXPECT_EQ(int64_t(sizeof(Node<>)) * st.retired_count, st.retired_bytes);
+  EXPECT_EQ(st.reclaimed_count, uint64_t(c_.dtors()));
+  EXPECT_LE(st.reclamation_passes, 1);
+
+  hazptr_cleanup(domain);
+  st = domain.stats();
+  EXPECT_EQ(kObjs, c_.dtors());
+  EXPECT_EQ(0, st.retired_count);
+  EXPECT_EQ(0, st.retired_bytes);
+  EXPECT_EQ(kObjs, st.reclaimed_count);
+  EXPECT_GE(st.reclamation_passes, 1);
+  EXPECT_EQ(0, st.forced_reclamations);
+  uint64_t passes = 0;
+  for (auto n : st.scan_time_histogram) {
+    passes += n;
+  }
+  EXPECT_EQ(st.reclamation_passes, passes);
+  EXPECT_LE(st.avg_scan_time(), st.scan_time_total);
+}
+
+TEST(HazptrTest, domainByteBudget) {
+  c_.clear();
+  hazptr_domain<> domain;
+  constexpr int kBudgetObjs = 10;
+  constexpr int kObjs = 1000;
+  domain.set_max_retired_bytes(kBudgetObjs * sizeof(Node<>));
+  EXPECT_EQ(kBudgetObjs * sizeof(Node<>), domain.max_retired_bytes());
+
+  auto protectedNode = new Node<>(-1);
+  {
+    hazptr_holder<> h = make_hazard_pointer(domain);
+    h.reset_protection(protectedNode);
+    protectedNode->retire(domain);
+    for (int i = 0; i < kObjs; ++i) {
+      (new Node<>(i))->retire(domain);
+      // Well under the count threshold, only the budget reclaims.
+      ASSERT_LE(domain.stats().retired_count, kBudgetObjs + 1);
+    }
+    auto st = domain.stats();
+    EXPECT_GE(st.forced_reclamations, kObjs / kBudgetObjs);
+    EXPECT_EQ(st.reclaimed_count, uint64_t(c_.dtors()));
+    // The protected node survives the forced reclamations.
+    EXPECT_GE(st.retired_count, 1);
+    EXPECT_EQ(-1, protectedNode->value());
+  }
+  hazptr_cleanup(domain);
+  EXPECT_EQ(kObjs + 1, c_.dtors());
+  EXPECT_EQ(0, domain.stats().retired_count);
+}
+
 TEST(HazptrTest, standardNames) {
   struct Foo : hazard_pointer_obj_base<Foo> {};
   DCHECK_EQ(&hazard_pointer_default_domain<>(), &default_hazptr_domain<>());
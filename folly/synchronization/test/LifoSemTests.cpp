@@ -80,6 +80,31 @@ TEST(LifoSem, multi) {
             << " post/wait pairs, " << blocks << " blocked";
 }
 
+TEST(LifoSem, adaptiveSpin) {
+  LifoSem::Options options;
+  options.adaptiveSpin = true;
+  LifoSem a(options);
+  LifoSem b(options);
+
+  const int iters = 10000;
+  std::thread thr([&] {
+    for (int i = 0; i < iters; ++i) {
+      a.wait();
+      b.post();
+    }
+  });
+  for (int i = 0; i < iters; ++i) {
+    a.post();
+    EXPECT_TRUE(b.try_wait_for(std::chrono::seconds(10)));
+  }
+  thr.join();
+  EXPECT_EQ(a.valueGuess(), 0);
+  EXPECT_EQ(b.valueGuess(), 0);
+
+  // Timed waits on an idle adaptive semaphore still time out.
+  EXPECT_FALSE(a.try_wait_for(std::chrono::milliseconds(1)));
+}
+
 TEST_F(LifoSemTest, pingpong) {
   DSched sched(DSched::uniform(0));
 
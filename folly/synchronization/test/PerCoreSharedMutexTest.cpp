@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/synchronization/PerCoreSharedMutex.h>
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(PerCoreSharedMutex, basic) {
+  PerCoreSharedMutex m;
+  EXPECT_GE(PerCoreSharedMutex::numSlots(), 1);
+
+  m.lock_shared();
+  EXPECT_TRUE(m.try_lock_shared());
+  EXPECT_FALSE(m.try_lock());
+  m.unlock_shared();
+  m.unlock_shared();
+
+  m.lock();
+  EXPECT_FALSE(m.try_lock());
+  EXPECT_FALSE(m.try_lock_shared());
+  m.unlock();
+
+  EXPECT_TRUE(m.try_lock());
+  m.unlock();
+  {
+    std::shared_lock<PerCoreSharedMutex> r1(m);
+    std::shared_lock<PerCoreSharedMutex> r2(m);
+  }
+  std::unique_lock<PerCoreSharedMutex> w(m);
+}
+
+TEST(PerCoreSharedMutex, writerWaitsForReaders) {
+  PerCoreSharedMutex m;
+  std::atomic<bool> locked{false};
+  m.lock_shared();
+  std::thread t([&] {
+    m.lock();
+    locked = true;
+    m.unlock();
+  });
+  /* sleep override */ std::this_thread::sleep_for(
+      std::chrono::milliseconds(10));
+  EXPECT_FALSE(locked.load());
+  m.unlock_shared();
+  t.join();
+  EXPECT_TRUE(locked.load());
+}
+
+TEST(PerCoreSharedMutex, readersWaitForWriter) {
+  PerCoreSharedMutex m;
+  std::atomic<int> readers{0};
+  m.lock();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      std::shared_lock<PerCoreSharedMutex> g(m);
+      ++readers;
+    });
+  }
+  /* sleep override */ std::this_thread::sleep_for(
+      std::chrono::milliseconds(10));
+  EXPECT_EQ(0, readers.load());
+  m.unlock();
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(4, readers.load());
+}
+
+TEST(PerCoreSharedMutex, stress) {
+  constexpr int kReaders = 8;
+  constexpr int kWriters = 2;
+  constexpr int kWrites = 100000;
+  PerCoreSharedMutex m;
+  // Only ever modified together under the exclusive lock.
+  int a = 0;
+  int b = 0;
+  std::atomic<int> writersDone{0};
+  std::atomic<int> sharedHolders{0};
+  std::atomic<int> readersStarted{0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kReaders; ++i) {
+    threads.emplace_back([&] {
+      ++readersStarted;
+      while (writersDone.load() < kWriters) {
+        {
+          std::shared_lock<PerCoreSharedMutex> g(m);
+          ++sharedHolders;
+          EXPECT_EQ(a, b);
+          --sharedHolders;
+        }
+        std::this_thread::yield();
+      }
+    });
+  }
+  for (int i = 0; i < kWriters; ++i) {
+    threads.emplace_back([&] {
+      while (readersStarted.load() < kReaders) {
+        std::this_thread::yield();
+      }
+      for (int j = 0; j < kWrites; ++j) {
+        std::unique_lock<PerCoreSharedMutex> g(m);
+        EXPECT_EQ(0, sharedHolders.load());
+        ++a;
+        ++b;
+      }
+      ++writersDone;
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(kWriters * kWrites, a);
+  EXPECT_EQ(a, b);
+}
@@ -205,6 +205,47 @@ TEST(ThrottledLifoSem, MPMCStress) {
   EXPECT_EQ(sem.valueGuess(), 0);
 }
 
+TEST(ThrottledLifoSem, AdaptiveSpin) {
+  constexpr size_t kNumThreads = 4;
+  constexpr size_t kNumPostsPerThread = 10000;
+  constexpr size_t kExpectedHandoffs = kNumThreads * kNumPostsPerThread;
+
+  folly::ThrottledLifoSem sem(
+      {.wakeUpInterval = std::chrono::microseconds(10), .adaptiveSpin = true});
+
+  std::vector<std::thread> producers;
+  std::vector<std::thread> consumers;
+  std::atomic<size_t> handoffs = 0;
+  for (size_t t = 0; t < kNumThreads; ++t) {
+    producers.emplace_back([&] {
+      for (size_t i = 0; i < kNumPostsPerThread; ++i) {
+        if (i % 100 == 0) {
+          // Let the consumers go idle once in a while.
+          /* sleep override */ std::this_thread::sleep_for(
+              std::chrono::microseconds(100));
+        }
+        sem.post();
+      }
+    });
+    consumers.emplace_back([&] {
+      for (size_t i = 0; i < kNumPostsPerThread; ++i) {
+        sem.wait();
+        ++handoffs;
+      }
+    });
+  }
+
+  for (auto& t : producers) {
+    t.join();
+  }
+  for (auto& t : consumers) {
+    t.join();
+  }
+  EXPECT_EQ(handoffs.load(), kExpectedHandoffs);
+  EXPECT_EQ(sem.valueGuess(), 0);
+  EXPECT_FALSE(sem.try_wait_for(std::chrono::milliseconds(1)));
+}
+
 namespace {
 
 // Benchmark the cost of post() under contention when no wakeup is performed (by
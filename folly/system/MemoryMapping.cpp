@@ -17,8 +17,11 @@
 #include <folly/system/MemoryMapping.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <fmt/core.h>
 #include <glog/logging.h>
@@ -65,6 +68,24 @@ enum mmap_flags : int {
 #endif
 };
 
+// Newer madvise() advice and mbind() modes, which older headers lack.
+#ifdef __linux__
+enum madvise_advice : int {
+  hugepage = 14, // MADV_HUGEPAGE, Linux 2.6.38
+  populate_read = 22, // MADV_POPULATE_READ, Linux 5.14
+  populate_write = 23, // MADV_POPULATE_WRITE, Linux 5.14
+  collapse = 25, // MADV_COLLAPSE, Linux 6.1
+};
+
+enum mbind_mode : int {
+  bind = 2, // MPOL_BIND
+  interleave = 3, // MPOL_INTERLEAVE
+};
+#endif
+
+// Unit of work handed to the prefault threads
+constexpr size_t kPrefaultChunkSize = size_t(32) << 20;
+
 } // namespace
 
 MemoryMapping::MemoryMapping(MemoryMapping&& other) noexcept {
@@ -200,7 +221,12 @@ void MemoryMapping::init(off64_t offset, off64_t length) {
     if (anon) {
       flags |= MAP_ANONYMOUS;
     }
-    if (options_.prefault) {
+    // Placement options must be applied before the pages are populated, so
+    // in that case the prefault happens after mmap() returns.
+    const bool deferPrefault = options_.prefaultThreads > 1 ||
+        options_.prefaultProgress || options_.hugePages ||
+        options_.numaPolicy != NumaPolicy::kDefault;
+    if (options_.prefault && !deferPrefault) {
       flags |= mmap_flags::populate;
     }
 
@@ -223,7 +249,53 @@ void MemoryMapping::init(off64_t offset, off64_t length) {
         << " offset=" << offset << " length=" << mapLength_;
     mapStart_ = start;
     data_.reset(start + skipStart, size_t(length));
+
+    applyPlacementOptions();
+    if (options_.prefault && deferPrefault) {
+      prefault(
+          0,
+          size_t(mapLength_),
+          options_.prefaultThreads,
+          options_.prefaultProgress);
+#ifdef __linux__
+      if (options_.hugePages && !anon &&
+          ::madvise(mapStart_, size_t(mapLength_), madvise_advice::collapse)) {
+        VLOG(1) << "madvise(MADV_COLLAPSE) failed, errno=" << errno;
+      }
+#endif
+    }
+  }
+}
+
+void MemoryMapping::applyPlacementOptions() {
+#ifdef __linux__
+  if (options_.hugePages &&
+      ::madvise(mapStart_, size_t(mapLength_), madvise_advice::hugepage)) {
+    PLOG(WARNING) << "madvise(MADV_HUGEPAGE)";
+  }
+  if (options_.numaPolicy != NumaPolicy::kDefault) {
+    const int mode = options_.numaPolicy == NumaPolicy::kBind
+        ? mbind_mode::bind
+        : mbind_mode::interleave;
+    const unsigned long nodeMask = options_.numaNodeMask;
+    // maxnode counts one past the last bit the kernel should look at.
+    if (syscall(
+            SYS_mbind,
+            mapStart_,
+            size_t(mapLength_),
+            mode,
+            &nodeMask,
+            sizeof(nodeMask) * 8 + 1,
+            0)) {
+      PLOG(WARNING) << "mbind()";
+    }
   }
+#else
+  LOG_IF(
+      WARNING,
+      options_.hugePages || options_.numaPolicy != NumaPolicy::kDefault)
+      << "MemoryMapping placement options are only supported on Linux";
+#endif
 }
 
 namespace {
@@ -414,6 +486,81 @@ void MemoryMapping::advise(int advice, size_t offset, size_t length) const {
   PLOG_IF(WARNING, ::madvise(mapStart, length, advice)) << "madvise";
 }
 
+void MemoryMapping::willNeed(size_t offset, size_t length) const {
+  advise(MADV_WILLNEED, offset, length);
+}
+
+void MemoryMapping::prefault(
+    size_t offset,
+    size_t length,
+    size_t threads,
+    const std::function<void(size_t, size_t)>& progress) const {
+  CHECK_LE(offset + length, size_t(mapLength_))
+      << " offset: " << offset << " length: " << length
+      << " mapLength_: " << mapLength_;
+  if (length == 0) {
+    return;
+  }
+  willNeed(offset, length);
+
+  const auto pageSize = size_t(options_.pageSize);
+  const auto begin = offset / pageSize * pageSize;
+  const auto end = std::min(
+      (offset + length + pageSize - 1) / pageSize * pageSize,
+      size_t(mapLength_));
+  const auto total = end - begin;
+  const auto chunkSize =
+      std::max(kPrefaultChunkSize / pageSize * pageSize, pageSize);
+  const size_t numChunks = (total + chunkSize - 1) / chunkSize;
+  auto base = static_cast<char*>(mapStart_) + begin;
+
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> done{0};
+  auto work = [&] {
+    size_t i;
+    while ((i = next.fetch_add(1, std::memory_order_relaxed)) < numChunks) {
+      auto chunk = base + i * chunkSize;
+      auto size = std::min(chunkSize, total - i * chunkSize);
+      populate(chunk, size);
+      auto populated = done.fetch_add(size, std::memory_order_relaxed) + size;
+      if (progress) {
+        progress(populated, total);
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  const auto numThreads = std::min(std::max<size_t>(threads, 1), numChunks);
+  for (size_t t = 1; t < numThreads; ++t) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void MemoryMapping::populate(char* addr, size_t length) const {
+#ifdef __linux__
+  // MAP_SHARED writable mappings must fault pages in for writing, or the
+  // first store still takes a (minor) fault.
+  const int advice = options_.writable ? madvise_advice::populate_write
+                                       : madvise_advice::populate_read;
+  if (::madvise(addr, length, advice) == 0) {
+    return;
+  }
+  // Kernels older than 5.14 fail with EINVAL; touch the pages instead.
+#endif
+  if (!options_.readable) {
+    return;
+  }
+  const auto pageSize = size_t(options_.pageSize);
+  for (size_t i = 0; i < length; i += pageSize) {
+    // Only read: writing would dirty every page of a shared mapping.
+    (void)*static_cast<volatile char*>(addr + i);
+  }
+}
+
 MemoryMapping& MemoryMapping::operator=(MemoryMapping&& other) {
   swap(other);
   return *this;
@@ -17,6 +17,8 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
+#include <functional>
 
 #include <folly/File.h>
 #include <folly/Range.h>
@@ -54,6 +56,14 @@ class MemoryMapping {
     bool lockOnFault = false;
   };
 
+  enum class NumaPolicy {
+    kDefault,
+    // Spread pages round robin across the nodes in the mask
+    kInterleave,
+    // Allocate pages only on the nodes in the mask
+    kBind,
+  };
+
   /**
    * Map a portion of the file indicated by filename in memory, causing SIGABRT
    * on error.
@@ -93,6 +103,23 @@ class MemoryMapping {
       grow = v;
       return *this;
     }
+    Options& setPrefaultThreads(size_t v) {
+      prefaultThreads = v;
+      return *this;
+    }
+    Options& setPrefaultProgress(std::function<void(size_t, size_t)> v) {
+      prefaultProgress = std::move(v);
+      return *this;
+    }
+    Options& setHugePages(bool v) {
+      hugePages = v;
+      return *this;
+    }
+    Options& setNumaPolicy(NumaPolicy policy, uint64_t nodeMask) {
+      numaPolicy = policy;
+      numaNodeMask = nodeMask;
+      return *this;
+    }
 
     // Page size. 0 = use appropriate page size.
     // (On Linux, we use a huge page size if the file is on a hugetlbfs
@@ -126,6 +153,28 @@ class MemoryMapping {
     // Fix map at this address, if not nullptr. Must be aligned to a multiple
     // of the appropriate page size.
     void* address = nullptr;
+
+    // With prefault, populate the mapping from this many threads once it is
+    // created, rather than with MAP_POPULATE inside mmap() itself.
+    size_t prefaultThreads = 1;
+
+    // With prefault, called as (bytesPopulated, totalBytes) after every
+    // populated chunk, possibly from several threads at once. Setting it
+    // implies the threaded prefault, even with a single thread.
+    std::function<void(size_t, size_t)> prefaultProgress;
+
+    // Ask for transparent huge pages (MADV_HUGEPAGE). Prefaulted file-backed
+    // mappings are also collapsed into huge pages right away (MADV_COLLAPSE,
+    // Linux >= 6.1) where the file system supports it. Both are hints.
+    bool hugePages = false;
+
+    // NUMA memory policy applied (with mbind()) before anything is
+    // populated; numaNodeMask has one bit per node. This places anonymous
+    // and private writable pages; shared pages of regular files live in the
+    // page cache and may already be resident elsewhere. A hint: failures are
+    // logged, not fatal.
+    NumaPolicy numaPolicy = NumaPolicy::kDefault;
+    uint64_t numaNodeMask = 0;
   };
 
   // Options to emulate the old WritableMemoryMapping: readable and writable,
@@ -189,6 +238,26 @@ class MemoryMapping {
    */
   void hintLinearScan();
 
+  /**
+   * Populate the page tables for [offset, offset + length) of the mapping so
+   * later accesses don't stall on page faults, using up to `threads` threads.
+   * Readahead for the whole range is requested (MADV_WILLNEED) first, so the
+   * I/O for hot ranges can be scheduled early and overlaps the population.
+   * Uses MADV_POPULATE_READ/WRITE where available and touches every page
+   * otherwise. progress, if set, is called as for Options::prefaultProgress.
+   */
+  void prefault(
+      size_t offset,
+      size_t length,
+      size_t threads = 1,
+      const std::function<void(size_t, size_t)>& progress = {}) const;
+
+  /**
+   * Start reading [offset, offset + length) in the background, without
+   * waiting for it (MADV_WILLNEED).
+   */
+  void willNeed(size_t offset, size_t length) const;
+
   /**
    * Advise the kernel about memory access.
    */
@@ -248,6 +317,8 @@ class MemoryMapping {
     kAnon = 1 << 1,
   };
   void init(off64_t offset, off64_t length);
+  void applyPlacementOptions();
+  void populate(char* addr, size_t length) const;
 
   File file_;
   void* mapStart_ = nullptr;
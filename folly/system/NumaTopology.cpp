@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/system/NumaTopology.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/String.h>
+#include <folly/lang/Exception.h>
+#include <folly/portability/Sched.h>
+#include <folly/system/HardwareConcurrency.h>
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <pthread.h>
+#endif
+
+namespace folly {
+
+namespace {
+
+constexpr size_t kUnbound = std::numeric_limits<size_t>::max();
+
+// Set by bindCurrentThread(). A thread has a single affinity, so it is bound
+// to at most one node, of the topology with the given id.
+struct Binding {
+  uint64_t topologyId{0};
+  size_t node{kUnbound};
+};
+
+thread_local Binding binding;
+
+std::atomic<uint64_t> nextTopologyId{1};
+
+} // namespace
+
+NumaTopology::NumaTopology(std::vector<std::vector<size_t>> cpusByNode)
+    : id_(nextTopologyId.fetch_add(1, std::memory_order_relaxed)) {
+  for (auto& cpus : cpusByNode) {
+    if (!cpus.empty()) {
+      cpusByNode_.push_back(std::move(cpus));
+    }
+  }
+  if (cpusByNode_.empty()) {
+    std::vector<size_t> cpus(std::max(1u, hardware_concurrency()));
+    for (size_t cpu = 0; cpu < cpus.size(); ++cpu) {
+      cpus[cpu] = cpu;
+    }
+    cpusByNode_.push_back(std::move(cpus));
+  }
+  for (size_t node = 0; node < cpusByNode_.size(); ++node) {
+    for (auto cpu : cpusByNode_[node]) {
+      if (cpu >= nodeByCpu_.size()) {
+        nodeByCpu_.resize(cpu + 1, 0);
+      }
+      nodeByCpu_[cpu] = node;
+    }
+  }
+}
+
+const NumaTopology& NumaTopology::system() {
+  static const NumaTopology* topology = [] {
+    auto sysfs = readFromSysfs();
+    return sysfs ? new NumaTopology(std::move(*sysfs))
+                 : new NumaTopology(std::vector<std::vector<size_t>>{});
+  }();
+  return *topology;
+}
+
+Optional<NumaTopology> NumaTopology::readFromSysfs() {
+  std::vector<std::vector<size_t>> cpusByNode;
+  try {
+    // Node ids can have holes, so only the listed ones are read.
+    std::string online;
+    if (!readFile("/sys/devices/system/node/online", online)) {
+      return none;
+    }
+    for (auto node : parseCpuList(online)) {
+      std::string list;
+      auto path =
+          to<std::string>("/sys/devices/system/node/node", node, "/cpulist");
+      if (!readFile(path.c_str(), list)) {
+        continue;
+      }
+      auto cpus = parseCpuList(list);
+      if (!cpus.empty()) {
+        cpusByNode.push_back(std::move(cpus));
+      }
+    }
+  } catch (const std::exception&) {
+    return none;
+  }
+  if (cpusByNode.empty()) {
+    return none;
+  }
+  return NumaTopology(std::move(cpusByNode));
+}
+
+NumaTopology NumaTopology::fromCacheLocality(const CacheLocality& locality) {
+  size_t numNodes = locality.numCachesByLevel.empty()
+      ? 1
+      : std::max<size_t>(1, locality.numCachesByLevel.back());
+  auto numCpus = locality.localityIndexByCpu.size();
+  std::vector<std::vector<size_t>> cpusByNode(numNodes);
+  for (size_t cpu = 0; cpu < numCpus; ++cpu) {
+    // Cpus sharing a last-level cache have adjacent locality indexes; this
+    // is the same split AccessSpreader uses for numNodes stripes.
+    auto index = locality.localityIndexByCpu[cpu];
+    cpusByNode[index * numNodes / numCpus].push_back(cpu);
+  }
+  return NumaTopology(std::move(cpusByNode));
+}
+
+std::vector<size_t> NumaTopology::parseCpuList(const std::string& list) {
+  std::vector<size_t> cpus;
+  std::vector<StringPiece> ranges;
+  split(',', trimWhitespace(list), ranges, /* ignoreEmpty = */ true);
+  for (auto range : ranges) {
+    StringPiece first;
+    StringPiece last;
+    if (split('-', range, first, last)) {
+      auto begin = to<size_t>(first);
+      auto end = to<size_t>(last);
+      if (end < begin) {
+        throw_exception<std::invalid_argument>(
+            to<std::string>("NumaTopology: bad cpu range ", range));
+      }
+      for (auto cpu = begin; cpu <= end; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } else {
+      cpus.push_back(to<size_t>(range));
+    }
+  }
+  return cpus;
+}
+
+size_t NumaTopology::currentNode() const {
+  if (binding.topologyId == id_ && binding.node < numNodes()) {
+    return binding.node;
+  }
+#if defined(__linux__) && !defined(__ANDROID__)
+  int cpu = ::sched_getcpu();
+  if (cpu >= 0) {
+    return nodeOfCpu(size_t(cpu));
+  }
+#endif
+  return 0;
+}
+
+bool NumaTopology::bindCurrentThread(size_t node) const {
+  auto& cpus = cpusOfNode(node);
+  binding = {id_, node};
+#if defined(__linux__) && !defined(__ANDROID__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (auto cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpuset);
+    }
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0;
+#else
+  (void)cpus;
+  return false;
+#endif
+}
+
+} // namespace folly
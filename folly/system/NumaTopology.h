@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <folly/concurrency/CacheLocality.h>
+
+namespace folly {
+
+/**
+ * Maps the cpus of the machine to NUMA nodes, for executors and pools that
+ * want to keep work or memory on the node of the thread using it.
+ *
+ * system() reads the nodes from /sys/devices/system/node. Where that is not
+ * available the whole machine is a single node. fromCacheLocality() instead
+ * treats each group of cpus sharing a last-level cache as a node, which
+ * matches the socket layout on most multi-socket machines.
+ */
+class NumaTopology {
+ public:
+  /// Node i is made of the cpus in cpusByNode[i]. Nodes without cpus are
+  /// dropped. With no nodes at all, every cpu belongs to node 0.
+  explicit NumaTopology(std::vector<std::vector<size_t>> cpusByNode);
+
+  static const NumaTopology& system();
+
+  /// Returns none if sysfs does not describe any node with cpus.
+  static Optional<NumaTopology> readFromSysfs();
+
+  static NumaTopology fromCacheLocality(const CacheLocality& locality);
+
+  /// Parses a sysfs cpu or node list such as "0-3,8,10-11". Throws on bad
+  /// input.
+  static std::vector<size_t> parseCpuList(const std::string& list);
+
+  size_t numNodes() const { return cpusByNode_.size(); }
+
+  const std::vector<size_t>& cpusOfNode(size_t node) const {
+    return cpusByNode_.at(node);
+  }
+
+  /// Returns 0 for cpus that are not part of any node.
+  size_t nodeOfCpu(size_t cpu) const {
+    return cpu < nodeByCpu_.size() ? nodeByCpu_[cpu] : 0;
+  }
+
+  /**
+   * The node of the calling thread: the node it was bound to, if
+   * bindCurrentThread() was last called on it for this topology, or a copy
+   * of it, otherwise the node of the cpu it is running on right now.
+   */
+  size_t currentNode() const;
+
+  /**
+   * Restricts the calling thread to the cpus of node, and makes node its
+   * node for currentNode() of this topology from then on, even if setting
+   * the affinity fails or is not supported on this platform. Binding to a
+   * node of another topology replaces the binding. Returns whether the
+   * affinity was set.
+   */
+  bool bindCurrentThread(size_t node) const;
+
+ private:
+  // Tells topologies apart for the per-thread binding; copies share it.
+  uint64_t id_;
+  std::vector<std::vector<size_t>> cpusByNode_;
+  std::vector<size_t> nodeByCpu_;
+};
+
+} // namespace folly
@@ -16,7 +16,9 @@
 
 #include <folly/system/MemoryMapping.h>
 
+#include <atomic>
 #include <cstdlib>
+#include <vector>
 
 #include <glog/logging.h>
 
@@ -179,4 +181,56 @@ TEST(MemoryMapping, Advise) {
   EXPECT_DEATH(m.advise(MADV_NORMAL, off, size - off + 1), "");
 }
 
+TEST(MemoryMapping, ParallelPrefault) {
+  const size_t pageSize = sysconf(_SC_PAGESIZE);
+  std::string fileData(pageSize * 20 + 7, 'x');
+  File f = File::temporary();
+  writeStringToFileOrDie(fileData, f.fd());
+
+  std::atomic<size_t> lastDone{0};
+  size_t total = 0;
+  MemoryMapping m(
+      File(f.fd()),
+      0,
+      -1,
+      MemoryMapping::Options()
+          .setPrefault(true)
+          .setPrefaultThreads(3)
+          .setHugePages(true)
+          .setPrefaultProgress([&](size_t done, size_t outOf) {
+            lastDone = std::max<size_t>(lastDone, done);
+            total = outOf;
+          }));
+  EXPECT_EQ(fileData, m.data());
+  EXPECT_EQ(fileData.size(), total);
+  EXPECT_EQ(total, lastDone.load());
+
+  // Every page is resident after prefault().
+  m.prefault(pageSize + 1, pageSize * 3, 2);
+  std::vector<unsigned char> residency(21);
+  ASSERT_EQ(
+      0,
+      mincore(
+          const_cast<unsigned char*>(m.range().data()),
+          m.range().size(),
+          residency.data()));
+  for (auto page : residency) {
+    EXPECT_TRUE(page & 1);
+  }
+}
+
+TEST(MemoryMapping, NumaInterleave) {
+  // Node 0 always exists; a failing mbind() only logs.
+  MemoryMapping m(
+      MemoryMapping::kAnonymous,
+      1 << 20,
+      MemoryMapping::Options()
+          .setWritable(true)
+          .setPrefault(true)
+          .setNumaPolicy(MemoryMapping::NumaPolicy::kInterleave, 1));
+  auto range = m.writableRange();
+  std::fill(range.begin(), range.end(), 'a');
+  EXPECT_EQ('a', m.range()[12345]);
+}
+
 } // namespace folly
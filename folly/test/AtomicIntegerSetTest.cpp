@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/AtomicIntegerSet.h>
+
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+TEST(AtomicIntegerSet, Dense) {
+  AtomicIntegerSet<uint32_t> set(1000, 1000, 16);
+  EXPECT_FALSE(set.contains(1000));
+  EXPECT_TRUE(set.insert(1000));
+  EXPECT_FALSE(set.insert(1000));
+  EXPECT_TRUE(set.contains(1000));
+  EXPECT_TRUE(set.insert(1999));
+  EXPECT_TRUE(set.contains(1999));
+  EXPECT_FALSE(set.contains(1001));
+  EXPECT_TRUE(set.erase(1000));
+  EXPECT_FALSE(set.erase(1000));
+  EXPECT_FALSE(set.contains(1000));
+  EXPECT_TRUE(set.contains(1999));
+}
+
+TEST(AtomicIntegerSet, Overflow) {
+  AtomicIntegerSet<int64_t> set(-10, 20, 100);
+  // The value used as the empty marker is in the dense range.
+  EXPECT_FALSE(set.contains(-10));
+  EXPECT_FALSE(set.contains(-9));
+  EXPECT_TRUE(set.insert(-10));
+  EXPECT_TRUE(set.contains(-10));
+
+  for (int64_t i = 0; i < 50; ++i) {
+    EXPECT_TRUE(set.insert(1000 * i + 10));
+  }
+  for (int64_t i = 0; i < 50; ++i) {
+    EXPECT_FALSE(set.insert(1000 * i + 10));
+    EXPECT_TRUE(set.contains(1000 * i + 10));
+    EXPECT_FALSE(set.contains(1000 * i + 11));
+  }
+  EXPECT_TRUE(set.insert(std::numeric_limits<int64_t>::min()));
+  EXPECT_TRUE(set.contains(std::numeric_limits<int64_t>::min()));
+
+  EXPECT_TRUE(set.erase(10));
+  EXPECT_FALSE(set.contains(10));
+  EXPECT_FALSE(set.erase(10));
+  EXPECT_TRUE(set.contains(1010));
+  EXPECT_TRUE(set.insert(10));
+  EXPECT_TRUE(set.contains(10));
+}
+
+TEST(AtomicIntegerSet, OverflowFull) {
+  AtomicIntegerSet<uint16_t> set(0, 64, 4);
+  for (uint16_t i = 0; i < 4; ++i) {
+    EXPECT_TRUE(set.insert(100 + i));
+  }
+  EXPECT_FALSE(set.insert(100));
+  EXPECT_THROW(set.insert(200), std::length_error);
+  EXPECT_TRUE(set.insert(10));
+  // Erasing and inserting a key again reuses its slot.
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(set.erase(101));
+    EXPECT_FALSE(set.contains(101));
+    EXPECT_TRUE(set.insert(101));
+  }
+  EXPECT_TRUE(set.contains(101));
+  EXPECT_TRUE(set.erase(102));
+  EXPECT_THROW(set.insert(200), std::length_error);
+}
+
+TEST(AtomicIntegerSet, InvalidDenseRange) {
+  EXPECT_THROW(AtomicIntegerSet<int>(0, 0, 4), std::invalid_argument);
+  EXPECT_TRUE(AtomicIntegerSet<int>(0, 1, 4).insert(5));
+  EXPECT_THROW(AtomicIntegerSet<uint8_t>(200, 100, 4), std::invalid_argument);
+}
+
+TEST(AtomicIntegerSet, Concurrent) {
+  constexpr int kThreads = 8;
+  constexpr uint32_t kDense = 1 << 16;
+  AtomicIntegerSet<uint32_t> set(0, kDense, 1000);
+  std::atomic<int> inserted{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&] {
+      for (uint32_t i = 0; i < kDense; i += 7) {
+        inserted += set.insert(i);
+      }
+      for (uint32_t i = 0; i < 1000; ++i) {
+        inserted += set.insert(kDense + i * 13);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ((kDense + 6) / 7 + 1000, inserted.load());
+  for (uint32_t i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(set.contains(kDense + i * 13));
+  }
+}
+
+TEST(AtomicIntegerSet, ConcurrentEraseInsert) {
+  constexpr int kThreads = 8;
+  constexpr uint32_t kKeys = 16;
+  // Only room for each key once: reinsertions must reuse their slot.
+  AtomicIntegerSet<uint32_t> set(0, 1, kKeys);
+  std::atomic<int> balance{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&] {
+      for (int round = 0; round < 1000; ++round) {
+        for (uint32_t i = 1; i <= kKeys; ++i) {
+          balance += set.insert(i);
+          balance -= set.erase(i);
+        }
+      }
+      for (uint32_t i = 1; i <= kKeys; ++i) {
+        balance += set.insert(i);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(kKeys, balance.load());
+}
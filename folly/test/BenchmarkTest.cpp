@@ -15,12 +15,19 @@
  */
 
 #include <folly/Benchmark.h>
+#include <folly/MapUtil.h>
+#include <folly/detail/PerfEventCounters.h>
 #include <folly/detail/PerfScoped.h>
+#include <folly/json/dynamic.h>
 #include <folly/portability/GFlags.h>
 #include <folly/portability/GMock.h>
 #include <folly/portability/GTest.h>
 
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
 
 namespace folly {
 namespace detail {
@@ -179,6 +186,79 @@ TEST_F(BenchmarkingStateTest, DiscardLines) {
   EXPECT_EQ(expected, state.runBenchmarksWithResults());
 }
 
+TEST_F(BenchmarkingStateTest, MultiThreaded) {
+  std::atomic<unsigned> iterations{0};
+  std::mutex mutex;
+  std::set<std::thread::id> threadIds;
+  state.addMtBenchmark(__FILE__, "mt", 6, [&](unsigned n) {
+    iterations += n;
+    std::lock_guard<std::mutex> lock(mutex);
+    threadIds.insert(std::this_thread::get_id());
+    return n;
+  });
+
+  gflags::FlagSaver _;
+  gflags::SetCommandLineOption("bm_profile", "true");
+  gflags::SetCommandLineOption("bm_profile_iters", "100");
+
+  auto results = state.runBenchmarksWithResults();
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ("mt(threads=6)", results[0].name);
+  EXPECT_EQ(600, iterations.load());
+  EXPECT_EQ(6, threadIds.size());
+  auto fairness = folly::get_ptr(results[0].counters, "fairness");
+  ASSERT_NE(nullptr, fairness);
+  EXPECT_GE(fairness->value, 0);
+  EXPECT_LE(fairness->value, 100);
+
+  iterations = 0;
+  gflags::SetCommandLineOption("bm_mt_sweep", "true");
+  results = state.runBenchmarksWithResults();
+  std::vector<std::string> names;
+  for (auto const& result : results) {
+    names.push_back(result.name);
+  }
+  EXPECT_THAT(
+      names,
+      ::testing::ElementsAre(
+          "mt(threads=1)",
+          "%mt(threads=2)",
+          "%mt(threads=4)",
+          "%mt(threads=6)"));
+  EXPECT_EQ(100 * (1 + 2 + 4 + 6), iterations.load());
+}
+
+TEST_F(BenchmarkingStateTest, LatencyRecorder) {
+  state.addBenchmark(__FILE__, "a", [&](UserCounters& counters, unsigned n) {
+    BenchmarkLatencyRecorder latency(counters);
+    for (unsigned i = 0; i < n; ++i) {
+      latency.record(i % 500 == 499 ? 1000000 : 1000);
+    }
+    EXPECT_EQ(42, latency.measure([] { return 42; }));
+    TestClock::advance(std::chrono::microseconds(1));
+    return n;
+  });
+
+  gflags::FlagSaver _;
+  gflags::SetCommandLineOption("bm_profile", "true");
+  gflags::SetCommandLineOption("bm_profile_iters", "100000");
+
+  auto results = state.runBenchmarksWithResults();
+  ASSERT_EQ(1, results.size());
+  auto const& counters = results[0].counters;
+  for (auto name : {"p50_ns", "p99_ns", "p999_ns", "max_ns"}) {
+    ASSERT_EQ(1, counters.count(name)) << name;
+  }
+  auto const p50 = counters.at("p50_ns").value;
+  auto const p99 = counters.at("p99_ns").value;
+  auto const p999 = counters.at("p999_ns").value;
+  auto const max = counters.at("max_ns").value;
+  // Within the precision of the histogram, whatever the tick rate.
+  EXPECT_NEAR(p50, p99, p99 / 50 + 1);
+  EXPECT_NEAR(1000 * p50, max, max / 50 + 1);
+  EXPECT_NEAR(max, p999, max / 50 + 1);
+}
+
 TEST_F(BenchmarkingStateTest, PerfBasic) {
   int setUpPerfCalled = 0;
   std::vector<std::string> expectedArgs;
@@ -258,6 +338,42 @@ TEST_F(BenchmarkingStateTest, PerfIntegration) {
       ::testing::HasSubstr("Performance counter stats for process id"));
 }
 
+TEST_F(BenchmarkingStateTest, PerfCounters) {
+  std::vector<int> in(1000, 0);
+
+  state.addBenchmark(__FILE__, "a", [&](unsigned n) {
+    for (unsigned i = n; i; --i) {
+      std::reverse(in.begin(), in.end());
+    }
+    TestClock::advance(std::chrono::nanoseconds(100) * n);
+    return n;
+  });
+
+  gflags::FlagSaver _;
+  gflags::SetCommandLineOption("bm_profile", "true");
+  gflags::SetCommandLineOption("bm_profile_iters", "1000");
+  auto results = state.runBenchmarksWithResults();
+  ASSERT_EQ(1, results.size());
+  EXPECT_TRUE(results[0].perfCounters.empty());
+
+  gflags::SetCommandLineOption("bm_perf_counters", "true");
+  results = state.runBenchmarksWithResults();
+  ASSERT_EQ(1, results.size());
+
+  // Hardware counters may not be available, e.g. in virtual machines.
+  PerfEventCounters counters;
+  EXPECT_EQ(counters.names().size(), results[0].perfCounters.size());
+  for (auto const& [name, value] : results[0].perfCounters) {
+    EXPECT_THAT(
+        PerfEventCounters::allNames(), ::testing::Contains(name));
+    EXPECT_GE(value, 0);
+  }
+  if (auto ptr = folly::get_ptr(results[0].perfCounters, "instructions")) {
+    // Reversing 1000 ints takes at least one instruction per pair.
+    EXPECT_GT(*ptr, 500);
+  }
+}
+
 #endif // FOLLY_PERF_IS_SUPPORTED
 
 TEST_F(BenchmarkingStateTest, SkipWarmUp) {
@@ -291,6 +407,86 @@ TEST_F(BenchmarkingStateTest, SkipWarmUp) {
   }
 }
 
+TEST(BenchmarkResultsTest, PerfCountersRoundTrip) {
+  const std::vector<BenchmarkResult> results{
+      {__FILE__, "a", 1, {}},
+      {__FILE__, "b", 2, {}, {{"cycles", 12.5}, {"instructions", 30}}},
+  };
+
+  dynamic d;
+  benchmarkResultsToDynamic(results, d);
+  ASSERT_EQ(2, d.size());
+  EXPECT_EQ(3, d[0].size());
+  // The hardware counters follow the (empty) user counters.
+  ASSERT_EQ(5, d[1].size());
+  EXPECT_TRUE(d[1][3].empty());
+  EXPECT_EQ(12.5, d[1][4]["cycles"].asDouble());
+
+  std::vector<BenchmarkResult> parsed;
+  benchmarkResultsFromDynamic(d, parsed);
+  EXPECT_EQ(results, parsed);
+}
+
+TEST(BenchmarkCompareTest, MannWhitney) {
+  // Exact: 2 of the 70 orderings are as extreme.
+  EXPECT_NEAR(2.0 / 70, mannWhitneyPValue({1, 2, 3, 4}, {5, 6, 7, 8}), 1e-9);
+  EXPECT_NEAR(2.0 / 70, mannWhitneyPValue({5, 6, 7, 8}, {1, 2, 3, 4}), 1e-9);
+  EXPECT_EQ(1, mannWhitneyPValue({1, 4, 5, 8}, {2, 3, 6, 7}));
+  EXPECT_EQ(1, mannWhitneyPValue({1, 1, 1}, {1, 1, 1}));
+  EXPECT_EQ(1, mannWhitneyPValue({}, {1}));
+
+  // Normal approximation.
+  std::vector<double> a;
+  std::vector<double> b;
+  for (int i = 0; i < 30; ++i) {
+    a.push_back(i);
+    b.push_back(i + 10);
+  }
+  EXPECT_LT(mannWhitneyPValue(a, b), 0.01);
+  EXPECT_GT(mannWhitneyPValue(a, a), 0.9);
+}
+
+TEST(BenchmarkCompareTest, CompareRuns) {
+  auto runs = [](std::initializer_list<double> times) {
+    std::vector<std::vector<BenchmarkResult>> res;
+    for (double time : times) {
+      res.push_back(
+          {{__FILE__, "a", time, {}},
+           {__FILE__, "-", 0, {}},
+           {__FILE__, "b", 50, {}}});
+    }
+    return res;
+  };
+  auto base = runs({100, 101, 99, 100.5, 99.5});
+  auto test = runs({110, 111, 109, 110.5, 109.5});
+
+  auto comparisons = compareBenchmarkRuns(base, test, 0.03);
+  ASSERT_EQ(2, comparisons.size());
+  EXPECT_EQ("a", comparisons[0].name);
+  EXPECT_DOUBLE_EQ(100, comparisons[0].baseNs);
+  EXPECT_DOUBLE_EQ(110, comparisons[0].testNs);
+  EXPECT_NEAR(0.1, comparisons[0].change, 1e-9);
+  EXPECT_LE(comparisons[0].changeLow, 0.1);
+  EXPECT_GE(comparisons[0].changeHigh, 0.1);
+  EXPECT_LT(comparisons[0].pValue, 0.05);
+  EXPECT_NEAR(0.005, comparisons[0].noise, 1e-3);
+  EXPECT_TRUE(comparisons[0].regression);
+  EXPECT_FALSE(comparisons[0].improvement);
+
+  EXPECT_EQ("b", comparisons[1].name);
+  EXPECT_EQ(0, comparisons[1].change);
+  EXPECT_FALSE(comparisons[1].regression);
+
+  // Beyond the threshold, or the other way.
+  EXPECT_FALSE(compareBenchmarkRuns(base, test, 0.2)[0].regression);
+  EXPECT_TRUE(compareBenchmarkRuns(test, base, 0.03)[0].improvement);
+
+  // Too few runs to be significant.
+  base.resize(3);
+  test.resize(3);
+  EXPECT_FALSE(compareBenchmarkRuns(base, test, 0.03)[0].regression);
+}
+
 } // namespace
 } // namespace detail
 } // namespace folly
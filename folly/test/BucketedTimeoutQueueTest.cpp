@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/BucketedTimeoutQueue.h>
+
+#include <limits>
+#include <random>
+#include <utility>
+
+#include <folly/TimeoutQueue.h>
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+typedef std::vector<BucketedTimeoutQueue::Id> EventVec;
+} // namespace
+
+TEST(BucketedTimeoutQueue, Simple) {
+  EventVec events;
+
+  BucketedTimeoutQueue q;
+  BucketedTimeoutQueue::Callback cb =
+      [&events](BucketedTimeoutQueue::Id id, int64_t /* now */) {
+        events.push_back(id);
+      };
+
+  EXPECT_EQ(1, q.add(0, 10, cb));
+  EXPECT_EQ(2, q.add(0, 11, cb));
+  EXPECT_EQ(3, q.addRepeating(0, 9, cb));
+
+  EXPECT_TRUE(events.empty());
+  EXPECT_EQ(21, q.runOnce(12)); // now+9
+
+  EXPECT_EQ((EventVec{3, 1, 2}), events);
+
+  events.clear();
+  EXPECT_EQ(49, q.runOnce(40));
+  EXPECT_EQ((EventVec{3}), events);
+}
+
+TEST(BucketedTimeoutQueue, Erase) {
+  EventVec events;
+
+  BucketedTimeoutQueue q;
+  BucketedTimeoutQueue::Callback cb =
+      [&events, &q](BucketedTimeoutQueue::Id id, int64_t /* now */) {
+        events.push_back(id);
+        if (id == 2) {
+          q.erase(1);
+        }
+      };
+
+  EXPECT_EQ(1, q.addRepeating(0, 10, cb));
+  EXPECT_EQ(2, q.add(0, 35, cb));
+
+  int64_t now = 0;
+  while (now < std::numeric_limits<int64_t>::max()) {
+    now = q.runOnce(now);
+  }
+
+  EXPECT_EQ((EventVec{1, 1, 1, 2}), events);
+  EXPECT_TRUE(q.empty());
+}
+
+TEST(BucketedTimeoutQueue, RunOnceRepeating) {
+  int count = 0;
+  BucketedTimeoutQueue q;
+  BucketedTimeoutQueue::Callback cb =
+      [&count, &q](BucketedTimeoutQueue::Id id, int64_t /* now */) {
+        if (++count == 100) {
+          EXPECT_TRUE(q.erase(id));
+        }
+      };
+
+  EXPECT_EQ(1, q.addRepeating(0, 0, cb));
+
+  EXPECT_EQ(0, q.runOnce(0));
+  EXPECT_EQ(1, count);
+  EXPECT_EQ(0, q.runOnce(0));
+  EXPECT_EQ(2, count);
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(), q.runLoop(0));
+  EXPECT_EQ(100, count);
+}
+
+TEST(BucketedTimeoutQueue, RunOnceReschedule) {
+  int count = 0;
+  BucketedTimeoutQueue q;
+  BucketedTimeoutQueue::Callback cb;
+  cb = [&count, &q, &cb](BucketedTimeoutQueue::Id id, int64_t now) {
+    if (++count < 100) {
+      EXPECT_LT(id, q.add(now, 0, cb));
+    }
+  };
+
+  EXPECT_EQ(1, q.add(0, 0, cb));
+
+  EXPECT_EQ(0, q.runOnce(0));
+  EXPECT_EQ(1, count);
+  EXPECT_EQ(0, q.runOnce(0));
+  EXPECT_EQ(2, count);
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(), q.runLoop(0));
+  EXPECT_EQ(100, count);
+}
+
+TEST(BucketedTimeoutQueue, BatchExpiration) {
+  BucketedTimeoutQueue q(/* granularity */ 10, /* numBuckets */ 4);
+  EXPECT_EQ(1, q.add(0, 25, nullptr));
+  EXPECT_EQ(2, q.add(0, 5, nullptr));
+  EXPECT_EQ(3, q.addRepeating(0, 20, nullptr));
+  EXPECT_EQ(4, q.add(0, 1000, nullptr));
+  EXPECT_EQ(5, q.nextExpiration());
+
+  EventVec expired;
+  EXPECT_EQ(5, q.runOnce(4, expired));
+  EXPECT_TRUE(expired.empty());
+  EXPECT_EQ(25, q.runOnce(20, expired));
+  EXPECT_EQ((EventVec{2, 3}), expired);
+
+  // Crossing more than a full revolution visits every bucket once.
+  expired.clear();
+  EXPECT_EQ(520, q.runOnce(500, expired));
+  EXPECT_EQ((EventVec{1, 3}), expired);
+
+  EXPECT_TRUE(q.erase(3));
+  EXPECT_FALSE(q.erase(3));
+  EXPECT_EQ(1000, q.nextExpiration());
+  EXPECT_EQ(1u, q.size());
+
+  expired.clear();
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(), q.runOnce(1000, expired));
+  EXPECT_EQ((EventVec{4}), expired);
+  EXPECT_TRUE(q.empty());
+}
+
+TEST(BucketedTimeoutQueue, MatchesTimeoutQueue) {
+  // Small wheel with coarse buckets, so that timeouts share buckets and
+  // regularly span several revolutions.
+  BucketedTimeoutQueue bucketed(7, 16);
+  TimeoutQueue reference;
+  std::vector<std::pair<int64_t, int64_t>> bucketedEvents;
+  std::vector<std::pair<int64_t, int64_t>> referenceEvents;
+  std::vector<int64_t> ids;
+
+  std::mt19937 rng(12345);
+  int64_t now = 0;
+  for (int i = 0; i < 20000; ++i) {
+    auto op = rng() % 10;
+    if (op < 5) {
+      int64_t delay = rng() % (op == 0 ? 2000 : 100);
+      bool repeating = rng() % 8 == 0;
+      auto onBucketed = [&](int64_t id, int64_t t) {
+        bucketedEvents.emplace_back(id, t);
+      };
+      auto onReference = [&](int64_t id, int64_t t) {
+        referenceEvents.emplace_back(id, t);
+      };
+      int64_t id = repeating ? bucketed.addRepeating(now, delay, onBucketed)
+                             : bucketed.add(now, delay, onBucketed);
+      EXPECT_EQ(
+          id,
+          repeating ? reference.addRepeating(now, delay, onReference)
+                    : reference.add(now, delay, onReference));
+      ids.push_back(id);
+    } else if (op < 7 && !ids.empty()) {
+      auto id = ids[rng() % ids.size()];
+      EXPECT_EQ(reference.erase(id), bucketed.erase(id));
+    } else {
+      now += rng() % (op == 9 ? 500 : 20);
+      EXPECT_EQ(reference.runOnce(now), bucketed.runOnce(now));
+    }
+    EXPECT_EQ(reference.nextExpiration(), bucketed.nextExpiration());
+  }
+  EXPECT_EQ(referenceEvents, bucketedEvents);
+}
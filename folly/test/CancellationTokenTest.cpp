@@ -293,6 +293,32 @@ TEST(CancellationTokenTest, MergedToken) {
   EXPECT_FALSE(token.canBeCancelled());
 }
 
+TEST(CancellationTokenTest, MergedTokenWithSingleCancellableToken) {
+  CancellationSource src1, src2;
+  const auto token1 = src1.getToken();
+
+  // Tokens that can't be cancelled or that are repeated don't need merging.
+  EXPECT_EQ(token1, CancellationToken::merge(token1));
+  EXPECT_EQ(token1, CancellationToken::merge(CancellationToken(), token1));
+  EXPECT_EQ(token1, CancellationToken::merge(token1, src1.getToken()));
+  EXPECT_EQ(
+      token1,
+      CancellationToken::merge(
+          CancellationSource::invalid().getToken(),
+          token1,
+          CancellationToken()));
+
+  auto merged = CancellationToken::merge(token1, src2.getToken());
+  EXPECT_NE(token1, merged);
+  EXPECT_TRUE(merged.canBeCancelled());
+
+  // A token that was already cancelled stays cancelled.
+  src2.requestCancellation();
+  EXPECT_EQ(src2.getToken(), CancellationToken::merge(token1, src2.getToken()));
+  EXPECT_TRUE(merged.isCancellationRequested());
+  EXPECT_FALSE(token1.isCancellationRequested());
+}
+
 TEST(CancellationTokenTest, TokenWithData) {
   struct Guard {
     int& counter;
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/ConcurrentHazptrSkipList.h>
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+#include <folly/synchronization/Hazptr.h>
+
+using namespace folly;
+
+namespace {
+
+std::atomic<int> liveValues{0};
+
+struct Counted {
+  Counted() : key(0) { ++liveValues; }
+  /* implicit */ Counted(int k) : key(k) { ++liveValues; }
+  Counted(const Counted& other) : key(other.key) { ++liveValues; }
+  ~Counted() { --liveValues; }
+  bool operator<(const Counted& other) const { return key < other.key; }
+  int key;
+};
+
+} // namespace
+
+TEST(ConcurrentHazptrSkipList, Basic) {
+  ConcurrentHazptrSkipList<int> list;
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(list.begin(), list.end());
+
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(list.add((i * 7919) % 1000));
+  }
+  EXPECT_FALSE(list.add(5));
+  EXPECT_EQ(1000, list.size());
+
+  auto ret = list.insert(5);
+  EXPECT_FALSE(ret.second);
+  EXPECT_EQ(5, *ret.first);
+  ret = list.insert(1000);
+  EXPECT_TRUE(ret.second);
+  EXPECT_EQ(1000, *ret.first);
+
+  int expected = 0;
+  for (auto v : list) {
+    EXPECT_EQ(expected++, v);
+  }
+  EXPECT_EQ(1001, expected);
+
+  EXPECT_TRUE(list.contains(10));
+  EXPECT_TRUE(list.remove(10));
+  EXPECT_FALSE(list.remove(10));
+  EXPECT_FALSE(list.contains(10));
+  EXPECT_EQ(0, list.erase(10));
+  EXPECT_EQ(1, list.erase(11));
+  EXPECT_EQ(999, list.size());
+
+  EXPECT_EQ(list.find(10), list.end());
+  EXPECT_EQ(12, *list.find(12));
+  EXPECT_EQ(12, *list.lower_bound(10));
+  EXPECT_EQ(list.lower_bound(1001), list.end());
+}
+
+TEST(ConcurrentHazptrSkipList, IteratorSurvivesRemoval) {
+  ConcurrentHazptrSkipList<int> list;
+  for (int i = 0; i < 10; ++i) {
+    list.add(i);
+  }
+  auto it = list.find(5);
+  auto copy = it;
+  list.remove(5);
+  list.remove(6);
+  EXPECT_EQ(5, *it);
+  ++it;
+  EXPECT_EQ(7, *it);
+  EXPECT_EQ(5, *copy);
+
+  // Start out on a removed element.
+  list.remove(8);
+  list.remove(7);
+  EXPECT_EQ(9, *++it);
+  EXPECT_EQ(++it, list.end());
+}
+
+TEST(ConcurrentHazptrSkipList, ScanDoesNotBlockReclamation) {
+  constexpr int kSize = 1000;
+  {
+    ConcurrentHazptrSkipList<Counted> list;
+    for (int i = 0; i < kSize; ++i) {
+      list.add(i);
+    }
+    // kSize values plus the head.
+    EXPECT_EQ(kSize + 1, liveValues.load());
+
+    auto it = list.begin();
+    ++it;
+    for (int i = 0; i < kSize; ++i) {
+      list.remove(i);
+    }
+    hazptr_cleanup();
+    // Only the element the iterator stands on is kept alive.
+    EXPECT_EQ(2, liveValues.load());
+    EXPECT_EQ(1, it->key);
+    ++it;
+    EXPECT_EQ(it, list.end());
+    hazptr_cleanup();
+    EXPECT_EQ(1, liveValues.load());
+  }
+  EXPECT_EQ(0, liveValues.load());
+}
+
+TEST(ConcurrentHazptrSkipList, ConcurrentScansAndUpdates) {
+  constexpr int kWriters = 4;
+  constexpr int kReaders = 4;
+  constexpr int kKeys = 2048;
+  constexpr int kOps = 50000;
+  ConcurrentHazptrSkipList<int> list;
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kWriters; ++t) {
+    writers.emplace_back([&, t] {
+      for (int i = 0; i < kOps; ++i) {
+        int key = (i * 31 + t * 977) % kKeys;
+        if ((i + t) % 3 == 0) {
+          list.remove(key);
+        } else {
+          list.add(key);
+        }
+      }
+    });
+  }
+  std::vector<std::thread> readers;
+  for (int t = 0; t < kReaders; ++t) {
+    readers.emplace_back([&] {
+      while (!done.load()) {
+        int prev = -1;
+        for (auto it = list.begin(); it != list.end(); ++it) {
+          EXPECT_LT(prev, *it);
+          prev = *it;
+        }
+        auto it = list.lower_bound(kKeys / 2);
+        if (it != list.end()) {
+          EXPECT_GE(*it, kKeys / 2);
+        }
+      }
+    });
+  }
+  for (auto& t : writers) {
+    t.join();
+  }
+  done = true;
+  for (auto& t : readers) {
+    t.join();
+  }
+
+  std::set<int> contents(list.begin(), list.end());
+  EXPECT_EQ(contents.size(), list.size());
+  for (int key = 0; key < kKeys; ++key) {
+    EXPECT_EQ(contents.count(key), list.count(key));
+  }
+}
@@ -22,7 +22,9 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <cstring>
 #include <limits>
+#include <random>
 #include <sstream>
 #include <stdexcept>
 #include <tuple>
@@ -537,11 +539,152 @@ void testDoubleToString() {
   EXPECT_EQ(to<String>(1.123e10), "11230000000");
 }
 
+TEST(Conv, ToAppendDelimVec) {
+  std::string s = "x=";
+  std::vector<int64_t> empty;
+  toAppendDelimVec(range(empty), ',', &s);
+  EXPECT_EQ("x=", s);
+
+  std::vector<int64_t> v = {
+      0,
+      -1,
+      9,
+      10,
+      -99999999,
+      100000000,
+      numeric_limits<int64_t>::min(),
+      numeric_limits<int64_t>::max()};
+  toAppendDelimVec(range(v), ',', &s);
+  EXPECT_EQ(
+      "x=0,-1,9,10,-99999999,100000000,"
+      "-9223372036854775808,9223372036854775807",
+      s);
+
+  const std::vector<uint8_t> bytes = {0, 128, 255};
+  fbstring fb;
+  toAppendDelimVec(range(bytes), ", ", &fb);
+  EXPECT_EQ("0, 128, 255", fb);
+
+  std::mt19937_64 rng;
+  std::vector<int32_t> ints(1000);
+  std::string expected;
+  for (auto& i : ints) {
+    i = int32_t(rng()) >> (rng() % 32);
+    toAppendDelim("::", i, &expected);
+    expected += "::";
+  }
+  expected.resize(expected.size() - 2);
+  s.clear();
+  toAppendDelimVec(range(ints), "::", &s);
+  EXPECT_EQ(expected, s);
+}
+
 TEST(Conv, DoubleToString) {
   testDoubleToString<string>();
   testDoubleToString<fbstring>();
 }
 
+TEST(Conv, DoubleToStringShortestLayout) {
+  using Converter = double_conversion::DoubleToStringConverter;
+  auto shortest = [](double value, int flags = Converter::NO_FLAGS) {
+    std::string out;
+    toAppend(value, &out, Converter::SHORTEST, 0, Converter::Flags(flags));
+    return out;
+  };
+  auto single = [](float value) {
+    std::string out;
+    toAppend(value, &out, Converter::SHORTEST_SINGLE, 0);
+    return out;
+  };
+
+  EXPECT_EQ("0", shortest(0.0));
+  EXPECT_EQ("-0", shortest(-0.0));
+  EXPECT_EQ("0", shortest(-0.0, Converter::UNIQUE_ZERO));
+  EXPECT_EQ("0.1", shortest(0.1));
+  EXPECT_EQ("-1.5", shortest(-1.5));
+  EXPECT_EQ("0.000001", shortest(1e-6));
+  EXPECT_EQ("1.5E-7", shortest(1.5e-7));
+  EXPECT_EQ("0.0000012345", shortest(1.2345e-6));
+  EXPECT_EQ("100000000000000000000", shortest(1e20));
+  EXPECT_EQ("123456789012345680000", shortest(1.2345678901234568e20));
+  EXPECT_EQ("1E21", shortest(1e21));
+  EXPECT_EQ("1E+21", shortest(1e21, Converter::EMIT_POSITIVE_EXPONENT_SIGN));
+  EXPECT_EQ("1.7976931348623157E308", shortest(numeric_limits<double>::max()));
+  EXPECT_EQ("5E-324", shortest(numeric_limits<double>::denorm_min()));
+  EXPECT_EQ("1", shortest(1.0));
+  EXPECT_EQ("1.", shortest(1.0, Converter::EMIT_TRAILING_DECIMAL_POINT));
+  EXPECT_EQ(
+      "1.0",
+      shortest(
+          1.0,
+          Converter::EMIT_TRAILING_DECIMAL_POINT |
+              Converter::EMIT_TRAILING_ZERO_AFTER_POINT));
+  EXPECT_EQ(
+      "1.5",
+      shortest(
+          1.5,
+          Converter::EMIT_TRAILING_DECIMAL_POINT |
+              Converter::EMIT_TRAILING_ZERO_AFTER_POINT));
+  EXPECT_EQ("Infinity", shortest(numeric_limits<double>::infinity()));
+  EXPECT_EQ("-Infinity", shortest(-numeric_limits<double>::infinity()));
+  EXPECT_EQ("NaN", shortest(numeric_limits<double>::quiet_NaN()));
+
+  EXPECT_EQ("0.1", single(0.1f));
+  EXPECT_EQ("3.14159", single(3.14159f));
+  EXPECT_EQ("3.4028235E38", single(numeric_limits<float>::max()));
+  EXPECT_EQ("1E-45", single(numeric_limits<float>::denorm_min()));
+  EXPECT_EQ("0.10000000149011612", shortest(0.1f));
+}
+
+TEST(Conv, RoundTripRandomFloatingToString) {
+  using Converter = double_conversion::DoubleToStringConverter;
+  std::mt19937_64 rng;
+  for (int i = 0; i < 100000; ++i) {
+    auto bits = rng();
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    if (std::isnan(d)) {
+      continue;
+    }
+    auto str = to<std::string>(d);
+    ASSERT_EQ(d, to<double>(str)) << str;
+    ASSERT_EQ(str, to<std::string>(to<double>(str)));
+
+    float f;
+    auto bits32 = uint32_t(bits);
+    std::memcpy(&f, &bits32, sizeof(f));
+    if (std::isnan(f)) {
+      continue;
+    }
+    std::string out;
+    toAppend(f, &out, Converter::SHORTEST_SINGLE, 0);
+    ASSERT_EQ(f, to<float>(out)) << out;
+  }
+}
+
+TEST(Conv, StringToDoubleCorrectlyRounded) {
+  // Halfway between 1 and the next double, either side of it
+  EXPECT_EQ(
+      1.0,
+      to<double>("1.00000000000000011102230246251565404236316680908203125"));
+  EXPECT_EQ(
+      1.0000000000000002,
+      to<double>("1.00000000000000011102230246251565404236316680908203126"));
+  EXPECT_EQ(0.1, to<double>("0.1"));
+  EXPECT_EQ(-0.1, to<double>("-.1"));
+  EXPECT_EQ(100.0, to<double>("1e2"));
+  EXPECT_EQ(1.0, to<double>("1."));
+  EXPECT_EQ(0.1f, to<float>("0.1"));
+  EXPECT_EQ(numeric_limits<double>::infinity(), to<double>("1e400"));
+  EXPECT_EQ(0.0, to<double>("1e-400"));
+  EXPECT_EQ(5e-324, to<double>("4.9406564584124654e-324"));
+  EXPECT_EQ(1.0, to<double>("+1"));
+  EXPECT_EQ(-1.0, to<double>("-1"));
+  EXPECT_THROW(to<double>("-"), ConversionError);
+  EXPECT_THROW(to<double>("."), ConversionError);
+  EXPECT_THROW(to<double>("-."), ConversionError);
+}
+
 TEST(Conv, FBStringToString) {
   fbstring foo("foo");
   string ret = to<string>(foo);
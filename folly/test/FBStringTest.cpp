@@ -1810,6 +1810,41 @@ TEST(FBString, convertToStringView) {
   EXPECT_EQ(sv2, "bar");
 }
 
+TEST(FBString, releaseMallocatedBlock) {
+  size_t offset = 0;
+  size_t allocatedSize = 0;
+  fbstring small("small");
+  EXPECT_EQ(nullptr, small.releaseMallocatedBlock(&offset, &allocatedSize));
+  EXPECT_EQ("small", small);
+
+  for (size_t size : {200, 1 << 20}) {
+    fbstring str(size, 'x');
+    auto const data = str.data();
+    auto block = str.releaseMallocatedBlock(&offset, &allocatedSize);
+    ASSERT_NE(nullptr, block);
+    EXPECT_TRUE(str.empty());
+    EXPECT_EQ(data, static_cast<char*>(block) + offset);
+    EXPECT_GT(allocatedSize, offset + size);
+    EXPECT_EQ('x', data[size - 1]);
+    free(block);
+  }
+
+  fbstring large(1 << 20, 'x');
+  fbstring shared = large;
+  EXPECT_EQ(nullptr, large.releaseMallocatedBlock(&offset, &allocatedSize));
+  EXPECT_EQ(shared, large);
+
+  // The other way round
+  auto p = static_cast<char*>(malloc(300));
+  memset(p, 'x', 299);
+  p[299] = '\0';
+  fbstring acquired(p, 299, 300, AcquireMallocatedString());
+  EXPECT_EQ(p, acquired.releaseMallocatedBlock(&offset, &allocatedSize));
+  EXPECT_EQ(0, offset);
+  EXPECT_EQ(300, allocatedSize);
+  free(p);
+}
+
 TEST(FBString, Format) {
   EXPECT_EQ("  foo", fmt::format("{:>5}", folly::fbstring("foo")));
 }
@@ -380,6 +380,69 @@ TEST_F(ReadFileFd, InvalidFd) {
   PLOG(INFO);
 }
 
+namespace {
+std::string makeTestData(size_t size) {
+  std::string data(size, '\0');
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = char(i * 131 + i / 7);
+  }
+  return data;
+}
+} // namespace
+
+TEST(ParallelFile, readFileParallel) {
+  const TemporaryFile file;
+  auto path = file.path().string();
+  for (size_t size : {size_t(0), size_t(1), size_t(5000), size_t(70001)}) {
+    auto data = makeTestData(size);
+    ASSERT_TRUE(writeFile(data, path.c_str()));
+    for (bool directIO : {false, true}) {
+      std::string contents;
+      EXPECT_TRUE(readFileParallel(
+          path.c_str(),
+          contents,
+          ParallelFileOptions{}.setThreads(3).setChunkSize(4096).setDirectIO(
+              directIO)));
+      EXPECT_EQ(data, contents) << size << " " << directIO;
+    }
+  }
+}
+
+TEST(ParallelFile, preadParallel) {
+  const TemporaryFile file;
+  auto data = makeTestData(50000);
+  ASSERT_TRUE(writeFile(data, file.path().string().c_str()));
+
+  auto options = ParallelFileOptions{}.setThreads(4).setChunkSize(1000);
+  std::string buf(20000, '\0');
+  auto bufRange = MutableByteRange(
+      reinterpret_cast<unsigned char*>(&buf[0]), buf.size());
+  EXPECT_EQ(20000, preadParallel(file.fd(), bufRange, 123, options));
+  EXPECT_EQ(data.substr(123, 20000), buf);
+
+  // Short read at the end of the file
+  EXPECT_EQ(5000, preadParallel(file.fd(), bufRange, 45000, options));
+  EXPECT_EQ(data.substr(45000), buf.substr(0, 5000));
+
+  EXPECT_EQ(-1, preadParallel(-1, bufRange, 0, options));
+  EXPECT_EQ(EBADF, errno);
+}
+
+TEST(ParallelFile, pwriteParallel) {
+  const TemporaryFile file;
+  auto data = makeTestData(30000);
+  EXPECT_EQ(
+      30000,
+      pwriteParallel(
+          file.fd(),
+          ByteRange(StringPiece(data)),
+          0,
+          ParallelFileOptions{}.setThreads(4).setChunkSize(1024)));
+  std::string contents;
+  EXPECT_TRUE(readFile(file.path().string().c_str(), contents));
+  EXPECT_EQ(data, contents);
+}
+
 #ifndef _WIN32
 class WriteFileAtomic : public ::testing::Test {
  protected:
@@ -436,6 +499,20 @@ TEST_F(WriteFileAtomic, writeNew) {
   EXPECT_EQ(0644, getPerms(path));
 }
 
+TEST_F(WriteFileAtomic, parallel) {
+  auto path = tmpPath("foo");
+  auto contents = makeTestData(100000);
+  for (auto syncType : {SyncType::WITHOUT_SYNC, SyncType::WITH_SYNC}) {
+    writeFileAtomic(
+        path,
+        contents,
+        WriteFileAtomicOptions{}.setSyncType(syncType).setParallel(
+            ParallelFileOptions{}.setThreads(4).setChunkSize(4096)));
+    EXPECT_EQ(set<string>{"foo"}, listTmpDir());
+    EXPECT_EQ(contents, readData(path));
+  }
+}
+
 TEST_F(WriteFileAtomic, withSync) {
   // Call writeFileAtomic() to create a new file
   auto path = tmpPath("foo");
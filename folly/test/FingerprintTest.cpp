@@ -16,6 +16,8 @@
 
 #include <folly/Fingerprint.h>
 
+#include <string>
+
 #include <glog/logging.h>
 
 #include <folly/Benchmark.h>
@@ -175,6 +177,48 @@ TEST(Fingerprint, Alignment) {
   }
 }
 
+template <int BITS>
+void checkRolling(size_t window) {
+  std::string data;
+  for (int i = 0; i < 300; i++) {
+    data.push_back(char(i * 131 + (i >> 3)));
+  }
+  RollingFingerprint<BITS> rolling(window);
+  EXPECT_EQ(window, rolling.window());
+  for (size_t end = 1; end <= data.size(); end++) {
+    rolling.roll(uint8_t(data[end - 1]));
+    size_t begin = end > window ? end - window : 0;
+    uint64_t expected[2];
+    uint64_t actual[2];
+    Fingerprint<BITS>()
+        .update(StringPiece(data).subpiece(begin, end - begin))
+        .write(expected);
+    rolling.write(actual);
+    for (int i = 0; i < rolling.size(); i++) {
+      EXPECT_EQ(expected[i], actual[i]) << window << " " << end;
+    }
+  }
+}
+
+TEST(Fingerprint, Rolling) {
+  // The rolling fingerprint matches a fingerprint of just the window.
+  for (size_t window : {0, 1, 7, 8, 48, 64, 257}) {
+    checkRolling<64>(window);
+    checkRolling<96>(window);
+    checkRolling<128>(window);
+  }
+
+  RollingFingerprint<64> a(16);
+  RollingFingerprint<64> b(16);
+  a.roll("some unrelated prefix, then the same sixteen");
+  b.roll("a different prefix, then the same sixteen");
+  uint64_t fpa;
+  uint64_t fpb;
+  a.write(&fpa);
+  b.write(&fpb);
+  EXPECT_EQ(fpa, fpb);
+}
+
 int main(int argc, char* argv[]) {
   testing::InitGoogleTest(&argc, argv);
   gflags::ParseCommandLineFlags(&argc, &argv, true);
@@ -16,7 +16,9 @@
 
 #include <folly/Format.h>
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include <folly/Utility.h>
 #include <folly/portability/GTest.h>
@@ -579,3 +581,38 @@ TEST(Format, NoncopyableArg) {
     EXPECT_EQ(fmt.str(), "1");
   }
 }
+
+TEST(Format, StaticFormat) {
+  std::vector<int> ints{1, 2, 3};
+  std::map<std::string, int> map{{"hello", 0}};
+  std::string str = "str";
+
+#define EXPECT_SAME_AS_FORMAT(fmt, ...) \
+  EXPECT_EQ(sformat(fmt, __VA_ARGS__), sformat(FOLLY_FMT(fmt), __VA_ARGS__))
+
+  EXPECT_EQ("", sformat(FOLLY_FMT("")));
+  EXPECT_EQ("{}", sformat(FOLLY_FMT("{{}}")));
+  EXPECT_SAME_AS_FORMAT("{} {:08x} {}", str, 255, "end");
+  EXPECT_SAME_AS_FORMAT("{1} {0} {0:*^7}", "a", 3);
+  EXPECT_SAME_AS_FORMAT("{:+,d} {:#o} {:b} {:c}", 1234567, 8, 5, 'x');
+  EXPECT_SAME_AS_FORMAT("{:.3f} {:e} {:>10.2%} {}", 1.5, 2.5e10, 0.25, 1.0);
+  EXPECT_SAME_AS_FORMAT("{:*} {:*^*}|", 6, 42, 5, "x");
+  EXPECT_SAME_AS_FORMAT("{2:*0} {1:*0}|", 4, "a", "b");
+  EXPECT_SAME_AS_FORMAT("{0[1]} {1[hello]} {2[1]}", ints, map, str);
+  EXPECT_SAME_AS_FORMAT("{}}}{{{}", true, nullptr);
+  EXPECT_SAME_AS_FORMAT("{} {}", format("{} {}", 1, 2), 3);
+
+#undef EXPECT_SAME_AS_FORMAT
+
+  std::string out = "x";
+  format(&out, FOLLY_FMT("{}-{}"), 1, "y");
+  EXPECT_EQ("x1-y", out);
+  auto formatter = format(FOLLY_FMT("{}:{}"), 1, 2);
+  EXPECT_EQ("1:2", formatter.str());
+  EXPECT_EQ("1:2", formatter.str());
+
+  // Dynamic widths are only known at runtime.
+  EXPECT_FORMAT_ERROR(
+      sformat(FOLLY_FMT("{:*}"), -1, 2), "dynamic field width argument");
+  EXPECT_THROW(sformat(FOLLY_FMT("{[5]}"), ints), std::out_of_range);
+}
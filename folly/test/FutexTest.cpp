@@ -236,6 +236,11 @@ TEST(Futex, basicEmulated) {
   run_wait_until_tests<EmulatedFutexAtomic>();
 }
 
+TEST(Futex, basicShared) {
+  run_basic_tests<SharedFutexAtomic>();
+  run_wait_until_tests<SharedFutexAtomic>();
+}
+
 TEST(Futex, basicDeterministic) {
   DSched sched(DSched::uniform(0));
   run_basic_tests<DeterministicAtomic>();
@@ -249,3 +254,7 @@ TEST(Futex, wakeBlockedLive) {
 TEST(Futex, wakeBlockedEmulated) {
   run_wake_blocked_test<EmulatedFutexAtomic>();
 }
+
+TEST(Futex, wakeBlockedShared) {
+  run_wake_blocked_test<SharedFutexAtomic>();
+}
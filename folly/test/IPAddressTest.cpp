@@ -1253,6 +1253,125 @@ TEST(IPAddress, StringFormat) {
   EXPECT_EQ("1.2.3.4", detail::fastIpv4ToString(a4));
 }
 
+TEST(IPAddress, ParseMatchesInetPton) {
+  const char* inputs[] = {
+      "1.2.3.4",
+      "0.0.0.0",
+      "255.255.255.255",
+      "256.1.1.1",
+      "01.2.3.4",
+      "1.2.3",
+      "1.2.3.4.",
+      "1.2.3.4.5",
+      "1..3.4",
+      " 1.2.3.4",
+      "1.2.3.4 ",
+      "1.2.3.-4",
+      "1.2.3.0x4",
+      "",
+      "::",
+      "::1",
+      "1::",
+      "1::2",
+      "::ffff:1.2.3.4",
+      "::1.2.3.4",
+      "1:2:3:4:5:6:1.2.3.4",
+      "1:2:3:4:5:6:7:1.2.3.4",
+      "1:2:3:4:5:6:7:8",
+      "1:2:3:4:5:6:7::",
+      "::2:3:4:5:6:7:8",
+      "1:2:3:4:5:6:7:8::",
+      "1:2:3:4:5:6:7:8:9",
+      "1:2:3:4:5:6:7",
+      "2001:DB8::a:B",
+      "12345::",
+      "1:::2",
+      "1::2::3",
+      ":1::2",
+      "1::2:",
+      ":",
+      ":::",
+      "::ffff:1.2.3",
+      "::ffff:01.2.3.4",
+      "::g",
+      "fe80::1%1",
+  };
+  for (auto input : inputs) {
+    SCOPED_TRACE(input);
+    in_addr a4;
+    bool valid4 = inet_pton(AF_INET, input, &a4) == 1;
+    auto v4 = IPAddressV4::tryFromString(input);
+    EXPECT_EQ(valid4, v4.hasValue());
+    if (valid4 && v4.hasValue()) {
+      EXPECT_EQ(0, memcmp(&a4, v4->bytes(), 4));
+    }
+
+    in6_addr a6;
+    bool valid6 = inet_pton(AF_INET6, input, &a6) == 1;
+    auto v6 = IPAddressV6::tryFromString(input);
+    if (strchr(input, '%') == nullptr) {
+      EXPECT_EQ(valid6, v6.hasValue());
+    }
+    if (valid6 && v6.hasValue()) {
+      EXPECT_EQ(0, memcmp(&a6, v6->bytes(), 16));
+    }
+  }
+}
+
+TEST(IPAddress, FormatMatchesInetNtop) {
+  std::vector<std::string> inputs = {
+      "::",
+      "::1",
+      "1::",
+      "1::1",
+      "1:0:1:0:1:0:1:0",
+      "1:0:0:1:0:0:1:0",
+      "1:0:0:1:0:0:0:1",
+      "::ffff:1.2.3.4",
+      "::1.2.3.4",
+      "::0.1.0.0",
+      "::ffff:0:0",
+      "::fffe:1.2.3.4",
+      "0:0:1::",
+      "2001:db8::ff00:42:8329",
+      "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff",
+  };
+  // Also every combination of zero and non-zero groups.
+  for (unsigned pattern = 0; pattern < 256; ++pattern) {
+    ByteArray16 bytes{};
+    for (int i = 0; i < 8; ++i) {
+      if (pattern & (1u << i)) {
+        bytes[2 * i + 1] = uint8_t(i + 1);
+      }
+    }
+    inputs.push_back(IPAddressV6(bytes).toFullyQualified());
+  }
+  for (const auto& input : inputs) {
+    SCOPED_TRACE(input);
+    in6_addr a6;
+    ASSERT_EQ(1, inet_pton(AF_INET6, input.c_str(), &a6));
+    char expected[INET6_ADDRSTRLEN];
+    ASSERT_NE(nullptr, inet_ntop(AF_INET6, &a6, expected, sizeof(expected)));
+    EXPECT_EQ(expected, IPAddressV6(a6).str());
+  }
+}
+
+TEST(IPAddress, ToBuffer) {
+  char buf[IPAddressV6::kMaxStrSize];
+  IPAddress v4("255.255.255.255");
+  EXPECT_EQ(IPAddressV4::kMaxToFullyQualifiedSize, v4.toBuffer(buf));
+  EXPECT_EQ("255.255.255.255", std::string(buf, v4.toBuffer(buf)));
+
+  IPAddress v6("ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255");
+  EXPECT_EQ("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff", v6.str());
+  EXPECT_EQ(v6.str(), std::string(buf, v6.toBuffer(buf)));
+
+  IPAddress mapped("::ffff:10.0.0.1");
+  EXPECT_EQ("::ffff:10.0.0.1", std::string(buf, mapped.toBuffer(buf)));
+
+  EXPECT_EQ(0, IPAddress().toBuffer(buf));
+}
+
 TEST(IPAddress, getMacAddressFromLinkLocal) {
   IPAddressV6 ip6("fe80::f652:14ff:fec5:74d8");
   EXPECT_TRUE(ip6.getMacAddressFromLinkLocal().has_value());
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/IPPrefixTable.h>
+
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <folly/portability/GTest.h>
+
+using namespace folly;
+
+namespace {
+
+CIDRNetwork net(StringPiece str) {
+  return IPAddress::createNetwork(str);
+}
+
+// The reference result: the longest of `networks` containing `addr`.
+Optional<int> bruteForce(
+    const std::map<CIDRNetwork, int>& networks, const IPAddress& addr) {
+  Optional<int> best;
+  int bestLength = -1;
+  for (const auto& [network, value] : networks) {
+    if (network.first.isV4() == addr.isV4() &&
+        addr.inSubnet(network.first, network.second) &&
+        int(network.second) > bestLength) {
+      best = value;
+      bestLength = network.second;
+    }
+  }
+  return best;
+}
+
+} // namespace
+
+TEST(IPPrefixTable, Basic) {
+  IPPrefixTable<int> table;
+  EXPECT_EQ(none, table.lookup(IPAddress("10.1.2.3")));
+
+  EXPECT_TRUE(table.insert(net("10.0.0.0/8"), 1));
+  EXPECT_TRUE(table.insert(net("10.1.0.0/16"), 2));
+  EXPECT_TRUE(table.insert(net("10.1.2.0/23"), 3));
+  EXPECT_TRUE(table.insert(net("10.1.2.3/32"), 4));
+  EXPECT_TRUE(table.insert(net("2001:db8::/32"), 5));
+  EXPECT_EQ(5, table.size());
+
+  EXPECT_EQ(4, table.lookup(IPAddress("10.1.2.3")));
+  EXPECT_EQ(3, table.lookup(IPAddress("10.1.3.3")));
+  EXPECT_EQ(2, table.lookup(IPAddress("10.1.4.3")));
+  EXPECT_EQ(1, table.lookup(IPAddress("10.2.0.1")));
+  EXPECT_EQ(none, table.lookup(IPAddress("11.0.0.1")));
+  EXPECT_EQ(5, table.lookup(IPAddress("2001:db8::1")));
+  EXPECT_EQ(none, table.lookup(IPAddress("2001:db9::1")));
+  // Families are separate.
+  EXPECT_EQ(none, table.lookup(IPAddress("::ffff:10.1.2.3")));
+  EXPECT_EQ(none, table.lookup(IPAddress()));
+
+  auto match = table.lookupNetwork(IPAddress("10.1.3.3"));
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(net("10.1.2.0/23"), match->first);
+  EXPECT_EQ(3, match->second);
+
+  // Replacing a value
+  EXPECT_FALSE(table.insert(net("10.1.0.0/16"), 20));
+  EXPECT_EQ(20, table.lookup(IPAddress("10.1.4.3")));
+
+  // Erasing falls back to shorter networks.
+  EXPECT_TRUE(table.erase(net("10.1.2.0/23")));
+  EXPECT_FALSE(table.erase(net("10.1.2.0/23")));
+  EXPECT_EQ(20, table.lookup(IPAddress("10.1.3.3")));
+  EXPECT_EQ(4, table.lookup(IPAddress("10.1.2.3")));
+  EXPECT_EQ(4, table.size());
+}
+
+TEST(IPPrefixTable, DefaultRoutes) {
+  IPPrefixTable<int> table;
+  table.insert(net("0.0.0.0/0"), 4);
+  table.insert(net("::/0"), 6);
+  EXPECT_EQ(4, table.lookup(IPAddress("1.2.3.4")));
+  EXPECT_EQ(6, table.lookup(IPAddress("::1")));
+  table.erase(net("0.0.0.0/0"));
+  EXPECT_EQ(none, table.lookup(IPAddress("1.2.3.4")));
+}
+
+TEST(IPPrefixTable, MasksAddresses) {
+  IPPrefixTable<int> table;
+  table.insert({IPAddress("10.1.2.3"), 8}, 1);
+  EXPECT_EQ(1, table.lookup(IPAddress("10.200.0.1")));
+  EXPECT_TRUE(table.erase(net("10.0.0.0/8")));
+}
+
+TEST(IPPrefixTable, InvalidNetworks) {
+  IPPrefixTable<int> table;
+  EXPECT_THROW(table.insert({IPAddress("10.0.0.0"), 33}, 1), std::exception);
+  EXPECT_THROW(table.insert({IPAddress(), 0}, 1), std::exception);
+  EXPECT_EQ(0, table.size());
+}
+
+TEST(IPPrefixTable, BatchUpdate) {
+  IPPrefixTable<int> table;
+  table.update([](auto& updater) {
+    for (int i = 0; i < 256; ++i) {
+      updater.insert({IPAddressV4::fromLongHBO(uint32_t(i) << 24), 8}, i);
+    }
+    updater.erase(net("7.0.0.0/8"));
+  });
+  EXPECT_EQ(255, table.size());
+  EXPECT_EQ(42, table.lookup(IPAddress("42.1.2.3")));
+  EXPECT_EQ(none, table.lookup(IPAddress("7.1.2.3")));
+}
+
+TEST(IPPrefixTable, MatchesBruteForce) {
+  std::mt19937 rng(1234);
+  IPPrefixTable<int> table;
+  std::map<CIDRNetwork, int> reference;
+
+  auto randomV4 = [&] {
+    // Few distinct leading bytes, so that networks nest.
+    uint32_t bits = rng();
+    bits = (bits & 0x03ffffff) | ((rng() % 4) << 24);
+    return IPAddress(IPAddressV4::fromLongHBO(bits));
+  };
+  auto randomV6 = [&] {
+    ByteArray16 bytes{};
+    bytes[0] = 0x20;
+    for (size_t i = 1; i < 16; ++i) {
+      bytes[i] = uint8_t(i < 4 ? rng() % 3 : rng());
+    }
+    return IPAddress(IPAddressV6(bytes));
+  };
+
+  for (int round = 0; round < 3000; ++round) {
+    bool v4 = rng() % 2;
+    auto addr = v4 ? randomV4() : randomV6();
+    uint8_t length = uint8_t(rng() % (addr.bitCount() + 1));
+    if (v4 && length < 6) {
+      length = uint8_t(length + 6);
+    }
+    CIDRNetwork network{addr.mask(length), length};
+    if (rng() % 4 == 0 && !reference.empty()) {
+      // Erase an existing network.
+      auto it = reference.begin();
+      std::advance(it, rng() % reference.size());
+      EXPECT_TRUE(table.erase(it->first));
+      reference.erase(it);
+    } else {
+      EXPECT_EQ(reference.count(network) == 0, table.insert(network, round));
+      reference[network] = round;
+    }
+
+    for (int i = 0; i < 10; ++i) {
+      auto probe = rng() % 2 ? randomV4() : randomV6();
+      ASSERT_EQ(bruteForce(reference, probe), table.lookup(probe))
+          << probe.str();
+    }
+  }
+  EXPECT_EQ(reference.size(), table.size());
+
+  // Erasing everything leaves an empty table.
+  for (const auto& entry : reference) {
+    EXPECT_TRUE(table.erase(entry.first));
+  }
+  EXPECT_EQ(none, table.lookup(randomV4()));
+}
+
+TEST(IPPrefixTable, ConcurrentLookupsAndUpdates) {
+  IPPrefixTable<int> table;
+  table.insert(net("10.0.0.0/8"), 0);
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      while (!done.load()) {
+        // A /8 is always there, whatever the writer does.
+        auto value = table.lookup(IPAddress("10.1.2.3"));
+        ASSERT_TRUE(value.has_value());
+      }
+    });
+  }
+
+  for (int i = 0; i < 2000; ++i) {
+    table.insert(net("10.1.0.0/16"), i);
+    table.insert(net("10.1.2.0/24"), i);
+    table.erase(net("10.1.0.0/16"));
+    table.erase(net("10.1.2.0/24"));
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+}
@@ -16,8 +16,10 @@
 
 #include <folly/IndexedMemPool.h>
 
+#include <set>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <folly/portability/GMock.h>
 #include <folly/portability/GTest.h>
@@ -382,3 +384,62 @@ TEST(IndexedMemPool, useTraitsGlobalList) {
 // Test that IndexedMemPool works with incomplete element types.
 struct IncompleteTestElement;
 using IncompleteTestPool = IndexedMemPool<IncompleteTestElement>;
+
+TEST(IndexedMemPool, numaNodes) {
+  // Two nodes with one local list each
+  typedef IndexedMemPool<int, 2, 4> Pool;
+  NumaTopology topology({{0}, {1}});
+  Pool pool(100, topology);
+  uint32_t const half = Pool::maxIndexForCapacity(100) / 2;
+
+  auto onNode = [&](size_t node, auto fn) {
+    std::thread([&] {
+      topology.bindCurrentThread(node);
+      fn();
+    }).join();
+  };
+
+  std::vector<uint32_t> fromNode[2];
+  for (size_t node = 0; node < 2; ++node) {
+    onNode(node, [&] {
+      for (int i = 0; i < 10; ++i) {
+        fromNode[node].push_back(pool.allocIndex());
+      }
+    });
+  }
+  for (auto idx : fromNode[0]) {
+    EXPECT_TRUE(idx >= 1 && idx <= half) << idx;
+  }
+  for (auto idx : fromNode[1]) {
+    EXPECT_GT(idx, half);
+  }
+  EXPECT_EQ(half + 10, pool.maxAllocatedIndex());
+
+  // Slots recycled on the other node go back to their own node.
+  onNode(1, [&] {
+    for (auto idx : fromNode[0]) {
+      pool.recycleIndex(idx);
+      EXPECT_FALSE(pool.isAllocated(idx));
+    }
+  });
+  EXPECT_EQ(10, pool.numaStats().crossNodeRecycles);
+  onNode(0, [&] {
+    std::set<uint32_t> again;
+    for (int i = 0; i < 10; ++i) {
+      again.insert(pool.allocIndex());
+    }
+    EXPECT_EQ(
+        std::set<uint32_t>(fromNode[0].begin(), fromNode[0].end()), again);
+  });
+  EXPECT_EQ(0, pool.numaStats().crossNodeAllocs);
+
+  // A node that runs out takes slots from the other one.
+  uint32_t allocated = 20;
+  onNode(1, [&] {
+    while (pool.allocIndex() != 0) {
+      ++allocated;
+    }
+  });
+  EXPECT_EQ(Pool::maxIndexForCapacity(100), allocated);
+  EXPECT_EQ(half - 10, pool.numaStats().crossNodeAllocs);
+}
@@ -121,6 +121,8 @@ BENCH_BOTH(16, 32, true, HOT)
 BENCH_BOTH(32, 256, true, HOT)
 BENCH_BOTH(256, 1024, true, HOT)
 BENCH_BOTH(1024, 8192, true, HOT)
+BENCH_BOTH(33, 128, true, HOT)
+BENCH_BOTH(129, 512, true, HOT)
 
 BENCHMARK_DRAW_LINE();
 BENCH_BOTH(0, 7, false, COLD)
@@ -137,6 +139,8 @@ BENCH_BOTH(16, 32, false, COLD)
 BENCH_BOTH(32, 256, false, COLD)
 BENCH_BOTH(256, 1024, false, COLD)
 BENCH_BOTH(1024, 8192, false, COLD)
+BENCH_BOTH(33, 128, false, COLD)
+BENCH_BOTH(129, 512, false, COLD)
 
 BENCHMARK_DRAW_LINE();
 BENCHMARK_NAMED_PARAM(
@@ -19,6 +19,7 @@
 #include <memory>
 #include <thread>
 
+#include <folly/memory/Malloc.h>
 #include <folly/portability/GMock.h>
 #include <folly/portability/GTest.h>
 #include <folly/synchronization/Baton.h>
@@ -58,6 +59,15 @@ TEST(MemoryIdler, releaseMallocTLS) {
   delete[] p;
 }
 
+TEST(MemoryIdler, purgePendingArenas) {
+  auto before = MemoryIdler::arenaPurgedBytes();
+  auto bytes = MemoryIdler::purgePendingArenas();
+  EXPECT_EQ(before + bytes, MemoryIdler::arenaPurgedBytes());
+  if (!folly::usingJEMalloc()) {
+    EXPECT_EQ(0, bytes);
+  }
+}
+
 /// MockClock is a bit tricky because we are mocking a static function
 /// (now()), so we need to find the corresponding mock instance without
 /// extending its scope beyond that of the test.  I generally avoid
@@ -30,6 +30,7 @@ DEFINE_uint32(max_size, 32768, "Maximum size to benchmark");
 DEFINE_bool(linear, false, "Test all sizes [min_size, max_size]");
 DEFINE_uint32(step, 1, "Test sizes step");
 DEFINE_uint32(page_offset, 0, "Buffer offset from page aligned size");
+DEFINE_uint32(value, 0xFF, "Byte value to fill; 0 exercises zeroing paths");
 
 uint8_t* temp_buf;
 
@@ -45,7 +46,7 @@ void bmMemset(void* buf, size_t length, size_t iters) {
 #endif
 #pragma unroll(1)
   for (size_t i = 0; i < iters; ++i) {
-    memset_impl(buf, 0xFF, length);
+    memset_impl(buf, static_cast<int>(FLAGS_value), length);
   }
 }
 
@@ -687,6 +687,87 @@ TEST(Singleton, SingletonEagerInitParallel) {
   }
 }
 
+namespace {
+struct EagerInitDependenciesTag {};
+struct DependentTag {};
+struct DependencyTag1 {};
+struct DependencyTag2 {};
+} // namespace
+template <typename T, typename Tag = detail::DefaultTag>
+using SingletonEagerInitDependencies =
+    Singleton<T, Tag, EagerInitDependenciesTag>;
+TEST(Singleton, SingletonEagerInitDependencies) {
+  auto& vault = *SingletonVault::singleton<EagerInitDependenciesTag>();
+
+  folly::Synchronized<std::vector<std::string>> created;
+  auto make = [&](std::string name) {
+    return [&created, name] {
+      created.wlock()->push_back(name);
+      return new std::string(name);
+    };
+  };
+  auto dependent =
+      SingletonEagerInitDependencies<std::string, DependentTag>(
+          make("dependent"))
+          .dependsOn<std::string, DependencyTag1>()
+          .dependsOn<std::string, DependencyTag2>()
+          .shouldEagerInit();
+  auto dependency1 =
+      SingletonEagerInitDependencies<std::string, DependencyTag1>(
+          make("dependency1"))
+          .dependsOn<std::string, DependencyTag2>();
+  auto dependency2 =
+      SingletonEagerInitDependencies<std::string, DependencyTag2>(
+          make("dependency2"));
+  vault.registrationComplete();
+
+  for (size_t i = 0; i < 100; ++i) {
+    SCOPE_EXIT {
+      vault.destroyInstances();
+      vault.reenableInstances();
+      created.wlock()->clear();
+    };
+
+    TestEagerInitParallelExecutor exe(4);
+    folly::Baton<> done;
+    vault.doEagerInitVia(exe, &done);
+    done.wait();
+
+    // The dependencies are built first, even though only the dependent is
+    // marked for eager init.
+    EXPECT_EQ(
+        std::vector<std::string>({"dependency2", "dependency1", "dependent"}),
+        *created.rlock());
+    auto const times = vault.getCreationTimes();
+    ASSERT_EQ(3, times.size());
+    EXPECT_THAT(times[0].name, testing::HasSubstr("DependencyTag2"));
+    EXPECT_THAT(times[2].name, testing::HasSubstr("DependentTag"));
+  }
+  dependent.get_weak();
+  dependency1.get_weak();
+}
+
+namespace {
+struct EagerInitCycleTag {};
+} // namespace
+template <typename T, typename Tag = detail::DefaultTag>
+using SingletonEagerInitCycle = Singleton<T, Tag, EagerInitCycleTag>;
+TEST(Singleton, SingletonEagerInitCycle) {
+  auto& vault = *SingletonVault::singleton<EagerInitCycleTag>();
+  auto sing1 = SingletonEagerInitCycle<std::string, DependencyTag1>()
+                   .dependsOn<std::string, DependencyTag2>()
+                   .shouldEagerInit();
+  auto sing2 = SingletonEagerInitCycle<std::string, DependencyTag2>()
+                   .dependsOn<std::string, DependencyTag1>();
+  vault.registrationComplete();
+  EXPECT_THROW(vault.doEagerInit(), std::logic_error);
+  folly::EventBase eb;
+  EXPECT_THROW(vault.doEagerInitVia(eb), std::logic_error);
+  EXPECT_EQ(0, vault.livingSingletonCount());
+  sing1.get_weak();
+  sing2.get_weak();
+}
+
 struct StateTestTag {};
 template <typename T, typename Tag = detail::DefaultTag>
 using SingletonVaultStateTest = Singleton<T, Tag, StateTestTag>;
@@ -61,6 +61,24 @@ TEST(SocketAddress, StringConversion) {
   EXPECT_STREQ(buf, "1");
 }
 
+TEST(SocketAddress, IpPortToBuffer) {
+  char buf[SocketAddress::kMaxIpPortStrSize];
+  SocketAddress v4("1.2.3.4", 4321);
+  EXPECT_EQ("1.2.3.4:4321", std::string(buf, v4.ipPortToBuffer(buf)));
+  EXPECT_EQ("1.2.3.4:4321", v4.describe());
+
+  SocketAddress v6("2001:db8::1", 65535);
+  EXPECT_EQ("[2001:db8::1]:65535", std::string(buf, v6.ipPortToBuffer(buf)));
+  EXPECT_EQ("[2001:db8::1]:65535", v6.describe());
+
+  SocketAddress zeroPort("::", 0);
+  EXPECT_EQ("[::]:0", std::string(buf, zeroPort.ipPortToBuffer(buf)));
+
+  SocketAddress unixAddr;
+  unixAddr.setFromPath("/tmp/foo");
+  EXPECT_THROW(unixAddr.ipPortToBuffer(buf), std::invalid_argument);
+}
+
 TEST(SocketAddress, IPv4ToStringConversion) {
   // testing addresses *.5.5.5, 5.*.5.5, 5.5.*.5, 5.5.5.*
   SocketAddress addr;
@@ -1036,6 +1036,68 @@ TEST(Split, fixedConvertCustom) {
   EXPECT_THROW(folly::split(',', "B,G", c1, c2), my::ColorError);
 }
 
+TEST(Split, multiCharDelimiter) {
+  std::vector<std::string> parts;
+  folly::split("ab", "xabyababzab", parts);
+  EXPECT_EQ((std::vector<std::string>{"x", "y", "", "z", ""}), parts);
+
+  parts.clear();
+  folly::split("ab", "xabyababzab", parts, true);
+  EXPECT_EQ((std::vector<std::string>{"x", "y", "z"}), parts);
+
+  // Long enough for the vectorized search, with partial matches.
+  std::string input;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 50; ++i) {
+    expected.push_back(std::string(i % 7, 'a') + "<=");
+    input += expected.back() + "<=>";
+  }
+  expected.emplace_back();
+  parts.clear();
+  folly::split("<=>", input, parts);
+  EXPECT_EQ(expected, parts);
+}
+
+TEST(Split, anyCharOf) {
+  std::vector<folly::StringPiece> parts;
+  folly::split(folly::AnyCharOf(",;"), "a,b;;c,", parts);
+  EXPECT_EQ((std::vector<folly::StringPiece>{"a", "b", "", "c", ""}), parts);
+
+  parts.clear();
+  folly::split(folly::AnyCharOf(",;"), "a,b;;c,", parts, true);
+  EXPECT_EQ((std::vector<folly::StringPiece>{"a", "b", "c"}), parts);
+
+  parts.clear();
+  folly::split(folly::AnyCharOf(" \t\n"), "one two\tthree\nfour", parts);
+  EXPECT_EQ(
+      (std::vector<folly::StringPiece>{"one", "two", "three", "four"}), parts);
+
+  // A set too large for the vectorized search.
+  parts.clear();
+  std::string input(100, 'x');
+  input[40] = '9';
+  input[70] = '0';
+  folly::split(folly::AnyCharOf("0123456789"), input, parts);
+  ASSERT_EQ(3, parts.size());
+  EXPECT_EQ(40, parts[0].size());
+  EXPECT_EQ(29, parts[1].size());
+  EXPECT_EQ(29, parts[2].size());
+
+  parts.clear();
+  folly::split(folly::AnyCharOf(","), "a,b", parts);
+  EXPECT_EQ((std::vector<folly::StringPiece>{"a", "b"}), parts);
+
+  folly::StringPiece key, value;
+  EXPECT_TRUE(folly::split(folly::AnyCharOf(":="), "k=v", key, value));
+  EXPECT_EQ("k", key);
+  EXPECT_EQ("v", value);
+  EXPECT_FALSE(
+      folly::split<true>(folly::AnyCharOf(":="), "k=v:w", key, value));
+  EXPECT_TRUE(
+      folly::split<false>(folly::AnyCharOf(":="), "k=v:w", key, value));
+  EXPECT_EQ("v:w", value);
+}
+
 TEST(String, join) {
   string output;
 
@@ -99,6 +99,28 @@ TEST(SimpleSubprocessTest, CloneFlagsSubprocessCtorExitsAfterExec) {
   EXPECT_TRUE(retCode.killed());
 }
 
+TEST(SimpleSubprocessTest, Pidfd) {
+  Subprocess proc(
+      std::vector<std::string>{"/bin/sleep", "3600"},
+      Subprocess::Options().usePidfd());
+  if (proc.pidfd() < 0) {
+    proc.kill();
+    proc.wait();
+    GTEST_SKIP() << "pidfd_open() is not supported";
+  }
+  // waitTimeout() sleeps on the pidfd instead of polling.
+  EXPECT_TRUE(proc.waitTimeout(std::chrono::milliseconds(10)).running());
+  proc.kill();
+  EXPECT_TRUE(proc.waitTimeout(std::chrono::seconds(60)).killed());
+  EXPECT_EQ(-1, proc.pidfd());
+}
+
+TEST(SimpleSubprocessTest, NoPidfdByDefault) {
+  Subprocess proc(std::vector<std::string>{"/bin/true"});
+  EXPECT_EQ(-1, proc.pidfd());
+  EXPECT_EQ(0, proc.wait().exitStatus());
+}
+
 TEST(SimpleSubprocessTest, ExitsWithError) {
   Subprocess proc(std::vector<std::string>{"/bin/false"});
   EXPECT_EQ(1, proc.wait().exitStatus());
@@ -1007,6 +1007,41 @@ class TestStruct {
 };
 } // namespace
 
+TEST(Synchronized, WithLockCombined) {
+  static_assert(
+      !detail::kSynchronizedMutexIsCombinable<void, std::mutex>, "");
+  static_assert(
+      detail::kSynchronizedMutexIsCombinable<void, DistributedMutex>, "");
+
+  Synchronized<std::vector<int>, DistributedMutex> obj;
+  constexpr int kThreads = 8;
+  constexpr int kIters = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < kIters; ++i) {
+        auto size = obj.withLockCombined([&](auto& v) {
+          v.push_back(i);
+          return v.size();
+        });
+        EXPECT_GE(size, 1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const auto& cobj = obj;
+  EXPECT_EQ(
+      kThreads * kIters,
+      cobj.withLockCombined([](const auto& v) { return v.size(); }));
+  EXPECT_EQ(kThreads * kIters, obj.lock()->size());
+  EXPECT_THROW(
+      obj.withLockCombined([](auto&) -> int { throw std::runtime_error(""); }),
+      std::runtime_error);
+}
+
 TEST(Synchronized, ConstexprConstructor) {
   // Make sure the folly::Synchronized constructor can be constexpr
   static FOLLY_CONSTINIT folly::Synchronized<int> i{std::in_place, 5};
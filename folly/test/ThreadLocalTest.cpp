@@ -421,6 +421,62 @@ TEST(ThreadLocalPtr, AccessAllThreadsCounter) {
   }
 }
 
+TEST(ThreadLocal, ReduceAllThreads) {
+  struct Tag {};
+  ThreadLocal<int, Tag> counter([] { return new int(0); });
+  const int kNumThreads = 100;
+  std::vector<std::thread> threads;
+  std::atomic<int> ready{0};
+  std::atomic<bool> run{true};
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&, i] {
+      *counter += i;
+      ready.fetch_add(1);
+      while (run.load()) {
+        usleep(100);
+      }
+    });
+  }
+  while (ready.load() != kNumThreads) {
+    usleep(100);
+  }
+
+  auto const expected = kNumThreads * (kNumThreads - 1) / 2;
+  for (size_t batchSize : {1, 3, 64, 1000}) {
+    auto sum = counter.reduceAllThreads(
+        0, [](int acc, int value) { return acc + value; }, batchSize);
+    EXPECT_EQ(expected, sum) << batchSize;
+  }
+
+  // Threads that start and exit during a walk don't disturb the others.
+  std::atomic<bool> churn{true};
+  std::thread churner([&] {
+    while (churn.load()) {
+      std::thread([&] { *counter += 0; }).join();
+    }
+  });
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(
+        expected,
+        counter.reduceAllThreads(
+            0, [](int acc, int value) { return acc + value; }, 2));
+  }
+  churn.store(false);
+  churner.join();
+
+  // The placeholder that keeps the position between batches is not left
+  // behind for accessors to see.
+  {
+    auto accessor = counter.accessAllThreads();
+    EXPECT_EQ(kNumThreads, std::distance(accessor.begin(), accessor.end()));
+  }
+
+  run.store(false);
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
 TEST(ThreadLocal, resetNull) {
   ThreadLocal<int> tl;
   tl.reset(new int(4));
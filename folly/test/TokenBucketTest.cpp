@@ -16,6 +16,10 @@
 
 #include <folly/test/TokenBucketTest.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include <glog/logging.h>
 
 #include <folly/String.h>
@@ -142,6 +146,72 @@ TEST(TokenBucket, consumeOrBorrowTest) {
   EXPECT_FALSE(tokenBucket.consume(1, 10, 10, 11));
 }
 
+TEST(ShardedTokenBucket, borrowsFromSharedBucket) {
+  // A single shard makes the borrowing deterministic; power-of-two rates keep
+  // the arithmetic exact.
+  ShardedTokenBucket tokenBucket(16, 16, 3 /* borrowGranularity */, 1, 0);
+  EXPECT_EQ(1, tokenBucket.numShards());
+
+  // The first consume borrows 1 + 3 tokens; the next three come from the
+  // shard's cache.
+  EXPECT_TRUE(tokenBucket.consume(1, 1));
+  EXPECT_DOUBLE_EQ(15.0, tokenBucket.available(1));
+  for (int i = 0; i < 15; ++i) {
+    EXPECT_TRUE(tokenBucket.consume(1, 1));
+  }
+  EXPECT_FALSE(tokenBucket.consume(1, 1));
+  EXPECT_DOUBLE_EQ(0.0, tokenBucket.available(1));
+
+  // A failed consume keeps whatever it managed to borrow cached.
+  EXPECT_FALSE(tokenBucket.consume(3, 1.125));
+  EXPECT_DOUBLE_EQ(2.0, tokenBucket.available(1.125));
+  EXPECT_TRUE(tokenBucket.consume(1, 1.125));
+  EXPECT_FALSE(tokenBucket.consume(2, 1.125));
+  EXPECT_TRUE(tokenBucket.consume(1, 1.125));
+}
+
+TEST(ShardedTokenBucket, flushAndReturnTokens) {
+  ShardedTokenBucket tokenBucket(10, 10, 5 /* borrowGranularity */, 1, 0);
+  EXPECT_TRUE(tokenBucket.consume(2, 1));
+  EXPECT_DOUBLE_EQ(8.0, tokenBucket.available(1));
+
+  tokenBucket.flush();
+  EXPECT_DOUBLE_EQ(8.0, tokenBucket.available(1));
+  EXPECT_TRUE(tokenBucket.consume(8, 1));
+  EXPECT_FALSE(tokenBucket.consume(1, 1));
+
+  tokenBucket.returnTokens(4);
+  EXPECT_DOUBLE_EQ(4.0, tokenBucket.available(1));
+  EXPECT_TRUE(tokenBucket.consume(4, 1));
+  EXPECT_FALSE(tokenBucket.consume(1, 1));
+}
+
+TEST(ShardedTokenBucket, concurrentConsumeRespectsBound) {
+  constexpr double kRate = 1000;
+  constexpr double kBurst = 1000;
+  constexpr double kGranularity = 10;
+  constexpr size_t kShards = 4;
+  ShardedTokenBucket tokenBucket(kRate, kBurst, kGranularity, kShards, 0);
+
+  // With time frozen, the bucket can hand out at most burstSize tokens,
+  // and every token borrowed is either consumed or still cached.
+  std::atomic<size_t> consumed{0};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 8; ++t) {
+    threads.emplace_back([&] {
+      while (tokenBucket.consume(1, 1)) {
+        consumed.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(consumed.load(), kBurst);
+  EXPECT_GE(consumed.load(), kBurst - kShards * kGranularity);
+  EXPECT_NEAR(kBurst - consumed.load(), tokenBucket.available(1), 1e-6);
+}
+
 template <typename>
 struct Wrapper;
 template <>
@@ -18,6 +18,7 @@
 
 #include <initializer_list>
 #include <stdexcept>
+#include <string>
 
 #include <folly/Range.h>
 #include <folly/portability/GTest.h>
@@ -84,6 +85,9 @@ void testValid(std::initializer_list<unsigned char> data, char32_t expected) {
         << StringPiece((const char*)data.begin(), (const char*)data.end());
   }
 
+  EXPECT_TRUE(isValidUtf8(
+      StringPiece((const char*)data.begin(), (const char*)data.end())));
+
   EXPECT_EQ(codePointToUtf8(expected), std::string(data.begin(), data.end()));
   {
     std::string out = "prefix";
@@ -106,6 +110,8 @@ void testInvalid(std::initializer_list<unsigned char> data) {
     EXPECT_EQ(utf8ToCodePoint(p, e, /* skipOnError */ true), 0xfffd)
         << StringPiece((const char*)data.begin(), (const char*)data.end());
   }
+  EXPECT_FALSE(isValidUtf8(
+      StringPiece((const char*)data.begin(), (const char*)data.end())));
 }
 
 TEST(InvalidUtf8ToCodePoint, UnicodeOutOfRangeTest) {
@@ -181,3 +187,85 @@ TEST(InvalidUtf8ToCodePoint, FourCloverLeafAsSurrogates) {
 TEST(ValidUtf8ToCodePoint, LastCodePoint) {
   testValid({0xF4, 0x8F, 0xBF, 0xBF}, 0x10FFFF); // u8"\U0010FFFF";
 }
+
+TEST(IsValidUtf8, AllPositions) {
+  // Each sequence at every offset around register boundaries, between
+  // ascii and non-ascii text, and truncated at the end.
+  std::string const valid[] = {
+      "\xc2\x80",
+      "\xdf\xbf",
+      "\xe0\xa0\x80",
+      "\xed\x9f\xbf",
+      "\xee\x80\x80",
+      "\xef\xbf\xbf",
+      "\xf0\x90\x80\x80",
+      "\xf4\x8f\xbf\xbf",
+  };
+  std::string const invalid[] = {
+      "\x80",
+      "\xbf",
+      "\xc0\x80",
+      "\xc1\xbf",
+      "\xe0\x9f\xbf",
+      "\xed\xa0\x80",
+      "\xf0\x8f\xbf\xbf",
+      "\xf4\x90\x80\x80",
+      "\xf5\x80\x80\x80",
+      "\xff",
+      "\xc2\xc2\x80",
+      "\xe2\x82\x41",
+  };
+  for (auto const& filler : {std::string("a"), std::string("\xc3\xa9")}) {
+    for (size_t offset = 0; offset < 40; ++offset) {
+      std::string prefix;
+      while (prefix.size() < offset) {
+        prefix += filler;
+      }
+      for (auto const& seq : valid) {
+        EXPECT_TRUE(isValidUtf8(prefix + seq + prefix)) << offset;
+        EXPECT_FALSE(isValidUtf8(prefix + seq.substr(0, seq.size() - 1)))
+            << offset;
+      }
+      for (auto const& seq : invalid) {
+        EXPECT_FALSE(isValidUtf8(prefix + seq + prefix)) << offset;
+        EXPECT_FALSE(isValidUtf8(prefix + seq)) << offset;
+      }
+    }
+  }
+  EXPECT_TRUE(isValidUtf8(""));
+}
+
+TEST(Utf8Transcoding, RoundTrip) {
+  std::string text;
+  std::u16string text16;
+  std::u32string text32;
+  for (char32_t cp :
+       {U'a', U'\u00e9', U'\u20ac', U'\U0001F340', U'\U0010FFFF', U'\0'}) {
+    for (int i = 0; i < 20; ++i) {
+      appendCodePointToUtf8(cp, text);
+      text32.push_back(cp);
+      if (cp >= 0x10000) {
+        text16.push_back(char16_t(0xd800 + ((cp - 0x10000) >> 10)));
+        text16.push_back(char16_t(0xdc00 + ((cp - 0x10000) & 0x3ff)));
+      } else {
+        text16.push_back(char16_t(cp));
+      }
+    }
+  }
+  EXPECT_EQ(text16, utf8ToUtf16(text));
+  EXPECT_EQ(text32, utf8ToUtf32(text));
+  EXPECT_EQ(text, utf16ToUtf8(text16));
+  EXPECT_EQ(text, utf32ToUtf8(text32));
+  EXPECT_EQ(u"", utf8ToUtf16(""));
+  EXPECT_EQ("", utf16ToUtf8(u""));
+}
+
+TEST(Utf8Transcoding, Invalid) {
+  EXPECT_THROW(utf8ToUtf16("abc\xc0\x80"), unicode_error);
+  EXPECT_THROW(utf8ToUtf32("abc\xe2\x82"), unicode_error);
+  EXPECT_THROW(utf16ToUtf8(u"a\xd800"), unicode_error);
+  EXPECT_THROW(utf16ToUtf8(std::u16string(1, 0xdc00)), unicode_error);
+  EXPECT_THROW(utf16ToUtf8(std::u16string{0xd800, 0x41}), unicode_error);
+  EXPECT_THROW(utf32ToUtf8(std::u32string(1, 0xd800)), unicode_error);
+  EXPECT_THROW(utf32ToUtf8(std::u32string(1, 0x110000)), unicode_error);
+}
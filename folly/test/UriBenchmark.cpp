@@ -82,6 +82,38 @@ BENCHMARK(init_uri_complex_with_query_parsing, iters) {
   }
 }
 
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(view_uri_simple_with_query_parsing, iters) {
+  const fbstring s("http://localhost?&key1=foo&key2=&key3&=bar&=bar=&");
+  for (size_t i = 0; i < iters; ++i) {
+    auto v = UriView::tryParse(s);
+    for (auto param : v->queryParams()) {
+      doNotOptimizeAway(param);
+    }
+  }
+}
+
+BENCHMARK(view_uri_complex_with_query_parsing, iters) {
+  const fbstring s(
+      "https://mock.example.com/farm/track.php?TmOxQUDF=uSmTS_VwhjKnh_JME&DI"
+      "h=fbbN&GRsoIm=bGshjaUqavZxQai&UMT=36k18N4dn21&3U=CD8o4A4497W152j6m0V%14"
+      "%57&Hy=t%05mpr.80JUZ7ne_%23zS8DcA%0qc_%291ymamz096%11Zfb3r%09ZqPD%311ZX"
+      "tqJd600ot&5U96U-Rh-VZ=-D_6-9xKYj%1gW6b43s1B9-j21P0oUW5-t46G4kgt&ezgj=mcW"
+      "TTQ.c&Oh=%2PblUfuC%7C997048884827569%03xnyJ%2L1pi7irBioQ6D4r7nNHNdo6v7Y%"
+      "84aurnSJ%2wCFePHMlGZmIHGfCe7392_lImWsSvN&sBeNN=Nf%80yOE%6X10M64F4gG197aX"
+      "R2B4g2533x235A0i4e%57%58uWB%04Erw.60&VMS4=Ek_%02GC0Pkx%6Ov_%207WICUz007%"
+      "04nYX8N%46zzpv%999h&KGmBt988y=q4P57C-Dh-Nz-x_7-5oPxz%1gz3N03t6c7-R67N4DT"
+      "Y6-f98W1&Lts&%02dOty%8eEYEnLz4yexQQLnL4MGU2JFn3OcmXcatBcabZgBdDdy67hdgW"
+      "tYn4");
+  for (size_t i = 0; i < iters; ++i) {
+    auto v = UriView::tryParse(s);
+    for (auto param : v->queryParams()) {
+      doNotOptimizeAway(param);
+    }
+  }
+}
+
 int main(int argc, char** argv) {
   folly::Init init(&argc, &argv);
   folly::runBenchmarks();
@@ -423,3 +423,85 @@ TEST(Uri, BadPortThrowsInvalidArgument) {
   constexpr folly::StringPiece s = "http://localhost:9999999999999999999/";
   EXPECT_THROW(Uri{s}, std::invalid_argument);
 }
+
+TEST(UriView, Components) {
+  StringPiece s("HTTP://user:pass@[::1]:8080/a/b?k1=v1&k2&=x&k3=a=b#frag");
+  auto v = UriView::tryParse(s);
+  ASSERT_TRUE(v.hasValue());
+  EXPECT_EQ("HTTP", v->scheme());
+  EXPECT_TRUE(v->hasAuthority());
+  EXPECT_EQ("user:pass@[::1]:8080", v->authority());
+  EXPECT_EQ("user", v->username());
+  EXPECT_EQ("pass", v->password());
+  EXPECT_EQ("[::1]", v->host());
+  EXPECT_EQ("::1", v->hostname());
+  EXPECT_EQ(8080, v->port());
+  EXPECT_EQ("/a/b", v->path());
+  EXPECT_EQ("k1=v1&k2&=x&k3=a=b", v->query());
+  EXPECT_EQ("frag", v->fragment());
+
+  // Components point into the input.
+  EXPECT_GE(v->path().begin(), s.begin());
+  EXPECT_LE(v->path().end(), s.end());
+
+  std::vector<std::pair<StringPiece, StringPiece>> params(
+      v->queryParams().begin(), v->queryParams().end());
+  ASSERT_EQ(2, params.size());
+  EXPECT_EQ("k1", params[0].first);
+  EXPECT_EQ("v1", params[0].second);
+  EXPECT_EQ("k2", params[1].first);
+  EXPECT_EQ("", params[1].second);
+}
+
+TEST(UriView, MatchesUri) {
+  for (StringPiece s : {
+           "http://www.facebook.com/hello/world?query#fragment",
+           "http://[::1]/",
+           "http://u@a@b:1/p",
+           "this:is@another:valid:uri",
+           "mailto:someone@example.com?subject=hi",
+           "file:///etc/hosts",
+           "http://localhost?&key1=foo&key2=&key3&=bar&=bar=&",
+       }) {
+    SCOPED_TRACE(s);
+    auto v = UriView::tryParse(s);
+    ASSERT_TRUE(v.hasValue());
+    Uri u(s);
+    EXPECT_EQ(u.scheme(), v->scheme());
+    EXPECT_EQ(u.username(), v->username());
+    EXPECT_EQ(u.password(), v->password());
+    EXPECT_EQ(u.host(), v->host());
+    EXPECT_EQ(u.hostname(), v->hostname());
+    EXPECT_EQ(u.port(), v->port());
+    EXPECT_EQ(u.path(), v->path());
+    EXPECT_EQ(u.query(), v->query());
+    EXPECT_EQ(u.fragment(), v->fragment());
+    EXPECT_EQ(u.fbstr(), s);
+
+    size_t i = 0;
+    for (auto param : v->queryParams()) {
+      ASSERT_LT(i, u.getQueryParams().size());
+      EXPECT_EQ(u.getQueryParams()[i].first, param.first);
+      EXPECT_EQ(u.getQueryParams()[i].second, param.second);
+      ++i;
+    }
+    EXPECT_EQ(u.getQueryParams().size(), i);
+  }
+}
+
+TEST(UriView, Errors) {
+  EXPECT_EQ(
+      UriFormatError::INVALID_URI, UriView::tryParse("2http://x").error());
+  EXPECT_EQ(UriFormatError::INVALID_URI, UriView::tryParse(":x").error());
+  EXPECT_EQ(UriFormatError::INVALID_URI, UriView::tryParse("nocolon").error());
+  EXPECT_EQ(
+      UriFormatError::INVALID_URI_AUTHORITY,
+      UriView::tryParse("http://[::1/").error());
+  EXPECT_EQ(
+      UriFormatError::INVALID_URI_AUTHORITY,
+      UriView::tryParse("http://host:port/").error());
+  EXPECT_EQ(
+      UriFormatError::INVALID_URI_PORT,
+      UriView::tryParse("http://host:65536/").error());
+  EXPECT_EQ(65535, UriView::tryParse("http://host:65535/")->port());
+}
@@ -30,6 +30,7 @@
 #include <fmt/format.h>
 
 #include <folly/Conv.h>
+#include <folly/FBString.h>
 #include <folly/Traits.h>
 #include <folly/container/Iterator.h>
 #include <folly/portability/GTest.h>
@@ -37,6 +38,7 @@
 
 using folly::small_vector;
 
+using folly::small_vector_policy::policy_growth_factor;
 using folly::small_vector_policy::policy_in_situ_only;
 using folly::small_vector_policy::policy_size_type;
 
@@ -1127,6 +1129,57 @@ TEST(smallVector, InsertNExponentialGrowth) {
   EXPECT_LE(capacities.size(), 25);
 }
 
+TEST(smallVector, GrowthFactorPolicy) {
+  small_vector<int, 4, policy_growth_factor<2>> test(4);
+  test.push_back(0);
+  EXPECT_GE(test.capacity(), 9);
+
+  struct Policy : policy_size_type<uint32_t>, policy_growth_factor<4, 3> {};
+  small_vector<int, 0, Policy> test2;
+  std::vector<size_t> capacities;
+  capacities.push_back(test2.capacity());
+  for (int i = 0; i < 10000; ++i) {
+    test2.push_back(i);
+    if (test2.capacity() != capacities.back()) {
+      EXPECT_GE(test2.capacity(), capacities.back() * 4 / 3 + 1);
+      capacities.push_back(test2.capacity());
+    }
+  }
+  EXPECT_GT(capacities.size(), 25);
+  EXPECT_LE(capacities.size(), 40);
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_EQ(i, test2[i]);
+  }
+}
+
+TEST(smallVector, RelocatableGrowth) {
+  // fbstring is relocatable, so growing relocates it with memcpy, including
+  // strings that are stored inline.
+  small_vector<folly::fbstring, 2> test;
+  std::vector<folly::fbstring> expected;
+  for (int i = 0; i < 10000; ++i) {
+    auto str = folly::to<folly::fbstring>(i, std::string(i % 50, 'x'));
+    if (i % 3 == 0) {
+      test.insert(test.begin() + test.size() / 2, str);
+      expected.insert(expected.begin() + expected.size() / 2, str);
+    } else {
+      test.push_back(str);
+      expected.push_back(str);
+    }
+  }
+  test.reserve(test.capacity() * 2);
+  ASSERT_EQ(expected.size(), test.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i], test[i]);
+  }
+  // The new element may alias an old one.
+  small_vector<folly::fbstring, 1> aliased(1, folly::fbstring(100, 'x'));
+  for (int i = 0; i < 100; ++i) {
+    aliased.push_back(aliased[0]);
+  }
+  EXPECT_EQ(aliased[0], aliased.back());
+}
+
 namespace {
 struct Counts {
   size_t copyCount{0};
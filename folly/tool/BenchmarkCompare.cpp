@@ -14,10 +14,26 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+
 #include <folly/Benchmark.h>
 #include <folly/FileUtil.h>
+#include <folly/String.h>
 #include <folly/init/Init.h>
 #include <folly/json/json.h>
+#include <folly/portability/GFlags.h>
+
+FOLLY_GFLAGS_DEFINE_double(
+    regression_threshold,
+    0.03,
+    "With several runs of each, a relative slowdown beyond which a "
+    "significant change is a regression, which makes the exit code 1.");
+
+FOLLY_GFLAGS_DEFINE_double(
+    confidence,
+    0.95,
+    "With several runs of each, the confidence level of the significance "
+    "test and of the intervals.");
 
 /**
  * Utility to produce a relative benchmark result from JSON result dumps
@@ -32,6 +48,14 @@
  *     $ your_benchmark_binary --benchmark --bm_json_verbose old-json
  * - compare two benchmarks & output a human-readable comparison:
  *     $ benchmark_compare old-json new-json
+ *
+ * A single run of each can't tell a small regression from noise. Given
+ * comma-separated lists of dumps of several runs of each, it instead prints
+ * the change in the median time of each benchmark with a bootstrap
+ * confidence interval, the p-value of a Mann-Whitney U test, and the noise
+ * between runs. It exits with 1 if a benchmark got slower by more than
+ * --regression_threshold with --confidence, so that it can gate changes:
+ *     $ benchmark_compare old1,old2,old3,old4,old5 new1,new2,new3,new4,new5
  */
 namespace folly {
 
@@ -44,8 +68,32 @@ std::vector<detail::BenchmarkResult> resultsFromFile(
   return ret;
 }
 
-void compareBenchmarkResults(const std::string& base, const std::string& test) {
-  printResultComparison(resultsFromFile(base), resultsFromFile(test));
+std::vector<std::vector<detail::BenchmarkResult>> runsFromFiles(
+    const std::string& filenames) {
+  std::vector<std::string> names;
+  folly::split(',', filenames, names, true);
+  std::vector<std::vector<detail::BenchmarkResult>> runs;
+  for (auto const& name : names) {
+    runs.push_back(resultsFromFile(name));
+  }
+  return runs;
+}
+
+// Returns whether there is a regression.
+bool compareBenchmarkResults(const std::string& base, const std::string& test) {
+  auto baseRuns = runsFromFiles(base);
+  auto testRuns = runsFromFiles(test);
+  CHECK(!baseRuns.empty() && !testRuns.empty());
+  if (baseRuns.size() == 1 && testRuns.size() == 1) {
+    printResultComparison(baseRuns[0], testRuns[0]);
+    return false;
+  }
+  auto comparisons = compareBenchmarkRuns(
+      baseRuns, testRuns, FLAGS_regression_threshold, FLAGS_confidence);
+  printBenchmarkComparisons(comparisons, FLAGS_confidence);
+  return std::any_of(comparisons.begin(), comparisons.end(), [](auto& c) {
+    return c.regression;
+  });
 }
 
 } // namespace folly
@@ -53,6 +101,5 @@ void compareBenchmarkResults(const std::string& base, const std::string& test) {
 int main(int argc, char** argv) {
   folly::Init init(&argc, &argv);
   CHECK_GT(argc, 2);
-  folly::compareBenchmarkResults(argv[1], argv[2]);
-  return 0;
+  return folly::compareBenchmarkResults(argv[1], argv[2]) ? 1 : 0;
 }
@@ -18,7 +18,8 @@
  * This macro enables FbSystrace usage in production for fb4a. When
  * FOLLY_SCOPED_TRACE_SECTION_HEADER is defined then a trace section is started
  * and later automatically terminated at the close of the scope it is called in.
- * In all other cases no action is taken.
+ * Otherwise the section is recorded as a span by folly::tracing::TraceRecorder
+ * while recording is enabled; arg must then be a string literal.
  */
 
 #pragma once
@@ -26,7 +27,10 @@
 #if defined(FOLLY_SCOPED_TRACE_SECTION_HEADER)
 #include FOLLY_SCOPED_TRACE_SECTION_HEADER
 #else
-#define FOLLY_SCOPED_TRACE_SECTION(arg, ...) \
-  do {                                       \
-  } while (0)
+#include <folly/Preprocessor.h>
+#include <folly/tracing/TraceRecorder.h>
+
+#define FOLLY_SCOPED_TRACE_SECTION(arg, ...)               \
+  ::folly::tracing::ScopedTraceSpan FB_ANONYMOUS_VARIABLE( \
+      follyScopedTraceSection)(arg)
 #endif
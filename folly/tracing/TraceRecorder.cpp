@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/tracing/TraceRecorder.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <folly/Conv.h>
+#include <folly/Indestructible.h>
+#include <folly/chrono/Hardware.h>
+#include <folly/json/json.h>
+#include <folly/portability/Unistd.h>
+#include <folly/system/ThreadId.h>
+#include <folly/system/ThreadName.h>
+
+namespace folly {
+namespace tracing {
+
+namespace {
+
+struct Event {
+  std::atomic<uint64_t> timestamp{0};
+  std::atomic<const char*> name{nullptr};
+  std::atomic<TraceRecorder::Phase> phase{TraceRecorder::Phase::Begin};
+};
+
+// Written only by its thread. Readers detect events overwritten while they
+// copy them in the manner of a seqlock: the writer publishes the index of an
+// event before writing it, so a reader that sees any part of the event also
+// sees the index, and discards the slot.
+struct ThreadRing {
+  std::atomic<uint64_t> head{0};
+  // Events before this index were discarded by clear().
+  std::atomic<uint64_t> floor{0};
+  std::atomic<bool> exited{false};
+  uint64_t threadId{0};
+  std::string threadName;
+  Event events[TraceRecorder::kEventsPerThread];
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadRing>> rings;
+
+  // The timestamp counter and steady clock when recording was first enabled,
+  // to convert timestamps to time.
+  std::once_flag calibrated;
+  uint64_t baseTimestamp{0};
+  std::chrono::steady_clock::time_point baseTime;
+};
+
+Registry& registry() {
+  static Indestructible<Registry> registry;
+  return *registry;
+}
+
+ThreadRing* acquireRing() {
+  auto& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  ThreadRing* ring = nullptr;
+  // Rings of exited threads are reused, so that their events stay available
+  // only until another thread needs one.
+  for (auto& candidate : reg.rings) {
+    if (candidate->exited.load(std::memory_order_relaxed)) {
+      ring = candidate.get();
+      break;
+    }
+  }
+  if (ring == nullptr) {
+    reg.rings.push_back(std::make_unique<ThreadRing>());
+    ring = reg.rings.back().get();
+  }
+  ring->head.store(0, std::memory_order_relaxed);
+  ring->floor.store(0, std::memory_order_relaxed);
+  ring->exited.store(false, std::memory_order_relaxed);
+  ring->threadId = getOSThreadID();
+  ring->threadName = getCurrentThreadName().value_or("");
+  return ring;
+}
+
+thread_local ThreadRing* currentRing = nullptr;
+
+struct RingReleaser {
+  ~RingReleaser() {
+    if (currentRing != nullptr) {
+      currentRing->exited.store(true, std::memory_order_relaxed);
+      currentRing = nullptr;
+    }
+  }
+};
+
+ThreadRing* getRingSlow() {
+  static thread_local RingReleaser releaser;
+  (void)releaser;
+  currentRing = acquireRing();
+  return currentRing;
+}
+
+struct Snapshot {
+  const char* name;
+  uint64_t timestamp;
+  TraceRecorder::Phase phase;
+};
+
+} // namespace
+
+std::atomic<bool> TraceRecorder::enabled_{false};
+
+void TraceRecorder::enable() {
+  auto& reg = registry();
+  std::call_once(reg.calibrated, [&] {
+    reg.baseTime = std::chrono::steady_clock::now();
+    reg.baseTimestamp = hardware_timestamp();
+  });
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void TraceRecorder::disable() noexcept {
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+void TraceRecorder::clear() {
+  auto& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  for (auto& ring : reg.rings) {
+    ring->floor.store(
+        ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+  }
+}
+
+void TraceRecorder::record(const char* name, Phase phase) noexcept {
+  auto ring = currentRing;
+  if (FOLLY_UNLIKELY(ring == nullptr)) {
+    try {
+      ring = getRingSlow();
+    } catch (...) {
+      return;
+    }
+  }
+  auto index = ring->head.load(std::memory_order_relaxed);
+  auto& event = ring->events[index % kEventsPerThread];
+  std::atomic_thread_fence(std::memory_order_release);
+  event.timestamp.store(hardware_timestamp(), std::memory_order_relaxed);
+  event.name.store(name, std::memory_order_relaxed);
+  event.phase.store(phase, std::memory_order_relaxed);
+  ring->head.store(index + 1, std::memory_order_release);
+}
+
+std::string TraceRecorder::toChromeTrace() {
+  auto& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+
+  // Timestamp counter ticks per microsecond since recording was enabled.
+  double ticksPerMicro = 1000.0;
+  auto elapsed = std::chrono::duration<double, std::micro>(
+                     std::chrono::steady_clock::now() - reg.baseTime)
+                     .count();
+  auto ticks = hardware_timestamp() - reg.baseTimestamp;
+  if (elapsed > 0 && ticks > 0) {
+    ticksPerMicro = static_cast<double>(ticks) / elapsed;
+  }
+
+  json::serialization_opts opts;
+  auto pid = to<std::string>(getpid());
+  std::string out = "{\"traceEvents\":[";
+  bool first = true;
+  auto appendEventPrefix = [&](StringPiece name, const char* ph, uint64_t tid) {
+    out += first ? "\n" : ",\n";
+    first = false;
+    out += "{\"name\":";
+    json::escapeString(name, out, opts);
+    out += ",\"ph\":\"";
+    out += ph;
+    out += "\",\"pid\":";
+    out += pid;
+    out += ",\"tid\":";
+    toAppend(tid, &out);
+  };
+
+  std::vector<Snapshot> snapshot;
+  for (auto& ring : reg.rings) {
+    auto head = ring->head.load(std::memory_order_acquire);
+    auto begin = std::max(
+        ring->floor.load(std::memory_order_relaxed),
+        head > kEventsPerThread ? head - kEventsPerThread : 0);
+    snapshot.clear();
+    for (auto i = begin; i < head; ++i) {
+      auto& event = ring->events[i % kEventsPerThread];
+      snapshot.push_back(
+          {event.name.load(std::memory_order_relaxed),
+           event.timestamp.load(std::memory_order_relaxed),
+           event.phase.load(std::memory_order_relaxed)});
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto headAfter = ring->head.load(std::memory_order_relaxed);
+    // Slots reused after the first load of head hold newer events now.
+    size_t overwritten = 0;
+    if (headAfter + 1 > begin + kEventsPerThread) {
+      overwritten = std::min<size_t>(
+          snapshot.size(), headAfter + 1 - begin - kEventsPerThread);
+    }
+
+    if (!ring->threadName.empty()) {
+      appendEventPrefix("thread_name", "M", ring->threadId);
+      out += ",\"args\":{\"name\":";
+      json::escapeString(ring->threadName, out, opts);
+      out += "}}";
+    }
+
+    size_t depth = 0;
+    for (size_t i = overwritten; i < snapshot.size(); ++i) {
+      auto const& event = snapshot[i];
+      if (event.phase == Phase::End) {
+        if (depth == 0) {
+          continue;
+        }
+        --depth;
+      } else {
+        ++depth;
+      }
+      appendEventPrefix(
+          event.name, event.phase == Phase::Begin ? "B" : "E", ring->threadId);
+      out += ",\"ts\":";
+      toAppend(
+          static_cast<double>(
+              static_cast<int64_t>(event.timestamp - reg.baseTimestamp)) /
+              ticksPerMicro,
+          &out);
+      out += "}";
+    }
+  }
+  out += "\n]}\n";
+  return out;
+}
+
+} // namespace tracing
+} // namespace folly
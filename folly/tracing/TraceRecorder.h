@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <folly/CPortability.h>
+#include <folly/Likely.h>
+
+/*
+ * An in-process tracer recording begin and end events of named spans into a
+ * ring buffer per thread, to look at executor, fiber and coroutine scheduling
+ * without attaching an external profiler.
+ *
+ * Recording is off by default, and then costs a relaxed load and a branch per
+ * event. Once enabled, an event is a timestamp counter read and a few stores
+ * into memory owned by the current thread; there are no locks and no shared
+ * writes. Each thread keeps its most recent kEventsPerThread events.
+ *
+ * toChromeTrace() renders the recorded events in the Chrome trace event JSON
+ * format, which chrome://tracing and the Perfetto UI both open.
+ *
+ * Span names must be string literals, or otherwise outlive the recorder: only
+ * the pointer is stored.
+ */
+
+namespace folly {
+namespace tracing {
+
+class TraceRecorder {
+ public:
+  static constexpr size_t kEventsPerThread = 8192;
+
+  enum class Phase : uint8_t {
+    Begin,
+    End,
+  };
+
+  static bool isEnabled() noexcept {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  static void enable();
+  static void disable() noexcept;
+
+  /*
+   * Discards the events recorded so far.
+   */
+  static void clear();
+
+  static void begin(const char* name) noexcept {
+    if (FOLLY_UNLIKELY(isEnabled())) {
+      record(name, Phase::Begin);
+    }
+  }
+
+  static void end(const char* name) noexcept {
+    if (FOLLY_UNLIKELY(isEnabled())) {
+      record(name, Phase::End);
+    }
+  }
+
+  /*
+   * Returns the recorded events of all threads as a Chrome trace event JSON
+   * object. Ends of spans whose beginning was overwritten are left out.
+   */
+  static std::string toChromeTrace();
+
+ private:
+  FOLLY_NOINLINE static void record(const char* name, Phase phase) noexcept;
+
+  static std::atomic<bool> enabled_;
+};
+
+/*
+ * Records a span covering its own lifetime. The span is recorded only if
+ * recording was enabled when it began.
+ */
+class ScopedTraceSpan {
+ public:
+  explicit ScopedTraceSpan(const char* name) noexcept
+      : name_(TraceRecorder::isEnabled() ? name : nullptr) {
+    if (FOLLY_UNLIKELY(name_ != nullptr)) {
+      TraceRecorder::begin(name_);
+    }
+  }
+
+  ScopedTraceSpan(const ScopedTraceSpan&) = delete;
+  ScopedTraceSpan& operator=(const ScopedTraceSpan&) = delete;
+
+  ~ScopedTraceSpan() {
+    if (FOLLY_UNLIKELY(name_ != nullptr)) {
+      TraceRecorder::end(name_);
+    }
+  }
+
+ private:
+  const char* name_;
+};
+
+} // namespace tracing
+} // namespace folly
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <folly/tracing/TraceRecorder.h>
+
+#include <thread>
+
+#include <folly/json/dynamic.h>
+#include <folly/json/json.h>
+#include <folly/portability/GTest.h>
+#include <folly/tracing/ScopedTraceSection.h>
+
+using folly::tracing::TraceRecorder;
+
+namespace {
+
+std::vector<std::string> eventsOf(
+    const folly::dynamic& trace, const char* prefix) {
+  std::vector<std::string> events;
+  for (auto const& event : trace["traceEvents"]) {
+    auto name = event["name"].asString();
+    if (name.rfind(prefix, 0) == 0) {
+      events.push_back(event["ph"].asString() + " " + name);
+    }
+  }
+  return events;
+}
+
+} // namespace
+
+TEST(TraceRecorder, disabled) {
+  TraceRecorder::disable();
+  TraceRecorder::clear();
+  {
+    FOLLY_SCOPED_TRACE_SECTION("disabled.outer");
+  }
+  auto trace = folly::parseJson(TraceRecorder::toChromeTrace());
+  EXPECT_TRUE(eventsOf(trace, "disabled.").empty());
+}
+
+TEST(TraceRecorder, spans) {
+  TraceRecorder::clear();
+  TraceRecorder::enable();
+  {
+    FOLLY_SCOPED_TRACE_SECTION("spans.outer");
+    FOLLY_SCOPED_TRACE_SECTION("spans.inner");
+  }
+  std::thread([] { FOLLY_SCOPED_TRACE_SECTION("spans.thread"); }).join();
+  TraceRecorder::disable();
+
+  auto trace = folly::parseJson(TraceRecorder::toChromeTrace());
+  auto events = eventsOf(trace, "spans.");
+  std::sort(events.begin(), events.end());
+  EXPECT_EQ(
+      (std::vector<std::string>{
+          "B spans.inner",
+          "B spans.outer",
+          "B spans.thread",
+          "E spans.inner",
+          "E spans.outer",
+          "E spans.thread"}),
+      events);
+
+  // Timestamps of a thread do not go backwards.
+  folly::dynamic tid;
+  double last = 0;
+  for (auto const& event : trace["traceEvents"]) {
+    if (event["name"] == "spans.outer" && event["ph"] == "B") {
+      tid = event["tid"];
+      last = event["ts"].asDouble();
+    } else if (event["tid"] == tid && event.count("ts")) {
+      EXPECT_GE(event["ts"].asDouble(), last);
+      last = event["ts"].asDouble();
+    }
+  }
+
+  TraceRecorder::clear();
+  trace = folly::parseJson(TraceRecorder::toChromeTrace());
+  EXPECT_TRUE(eventsOf(trace, "spans.").empty());
+}
+
+TEST(TraceRecorder, wrapAround) {
+  TraceRecorder::clear();
+  TraceRecorder::enable();
+  TraceRecorder::begin("wrap.lost");
+  for (size_t i = 0; i < TraceRecorder::kEventsPerThread; ++i) {
+    FOLLY_SCOPED_TRACE_SECTION("wrap.span");
+  }
+  TraceRecorder::end("wrap.lost");
+  TraceRecorder::disable();
+
+  auto trace = folly::parseJson(TraceRecorder::toChromeTrace());
+  auto events = eventsOf(trace, "wrap.");
+  // The oldest events were overwritten, and the end of the span whose
+  // beginning was lost is dropped.
+  ASSERT_FALSE(events.empty());
+  EXPECT_EQ("B wrap.span", events.front());
+  EXPECT_EQ("E wrap.span", events.back());
+  EXPECT_EQ(0, events.size() % 2);
+  EXPECT_LE(events.size(), TraceRecorder::kEventsPerThread);
+}